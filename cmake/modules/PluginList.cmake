@@ -31,6 +31,7 @@ SET(LMMS_PLUGIN_LIST
 	carlapatchbay
 	carlarack
 	Compressor
+	Convolver
 	CrossoverEQ
 	Delay
 	DualFilter
@@ -77,6 +77,10 @@ public:
 
 	static QString probeDevice();
 
+	//! The ring buffer holds this many periods unless configured otherwise
+	static constexpr int DefaultPeriods = 8;
+	static constexpr int MaxPeriods = 32;
+
 	static DeviceInfoCollection getAvailableDevices();
 
 private:
@@ -84,7 +88,10 @@ private:
 	void stopProcessing() override;
 	void applyQualitySettings() override;
 	void run() override;
+	//! Renders and converts right into the ring buffer of the device
+	void runMmap();
 
+	int setParams();
 	int setHWParams( const ch_cnt_t _channels, snd_pcm_access_t _access );
 	int setSWParams();
 	int handleError( int _err );
@@ -98,6 +105,12 @@ private:
 	snd_pcm_hw_params_t * m_hwParams;
 	snd_pcm_sw_params_t * m_swParams;
 
+	// how many periods the ring buffer holds, and how much of it has
+	// to be free before the thread is woken up
+	int m_periods;
+	snd_pcm_uframes_t m_availMin;
+	bool m_mmap;
+
 	bool m_convertEndian;
 
 } ;
@@ -36,6 +36,7 @@
 
 class QComboBox;
 class LcdSpinBox;
+class LedCheckBox;
 
 
 class AudioAlsaSetupWidget : public AudioDeviceSetupWidget
@@ -54,6 +55,9 @@ public slots:
 private:
 	QComboBox * m_deviceComboBox;
 	LcdSpinBox * m_channels;
+	LcdSpinBox * m_periods;
+	LcdSpinBox * m_availMin;
+	LedCheckBox * m_mmap;
 
 	int m_selectedDevice;
 	AudioAlsa::DeviceInfoCollection m_deviceInfos;
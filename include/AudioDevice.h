@@ -25,6 +25,8 @@
 #ifndef AUDIO_DEVICE_H
 #define AUDIO_DEVICE_H
 
+#include <memory>
+
 #include <QtCore/QMutex>
 #include <samplerate.h>
 
@@ -32,7 +34,9 @@
 
 
 class AudioEngine;
+class Oversampler;
 class AudioPort;
+class MixerChannel;
 class QThread;
 
 
@@ -61,6 +65,34 @@ public:
 	virtual void unregisterPort( AudioPort * _port );
 	virtual void renamePort( AudioPort * _port );
 
+	// mixer channels can have outputs of their own as well, which get
+	// the channel's buffer after its effects and fader
+	virtual bool supportsChannelOutputs() const
+	{
+		return false;
+	}
+
+	virtual void registerChannel( const MixerChannel * /* _channel */ )
+	{
+	}
+
+	virtual void unregisterChannel( const MixerChannel * /* _channel */ )
+	{
+	}
+
+	virtual void renameChannel( const MixerChannel * /* _channel */ )
+	{
+	}
+
+	// called by Mixer::masterMix() for every registered channel, on the
+	// thread rendering the period
+	virtual void writeChannel( const MixerChannel * /* _channel */,
+					const sampleFrame * /* _buf */,
+					const float /* _gain */,
+					const fpp_t /* _frames */ )
+	{
+	}
+
 
 	inline bool supportsCapture() const
 	{
@@ -86,8 +118,27 @@ public:
 
 	virtual void stopProcessing();
 
+	// true if the driver's callback can render each period itself, so
+	// that the audio engine doesn't need a FIFO thread
+	virtual bool rendersInCallback() const
+	{
+		return false;
+	}
+
 	virtual void applyQualitySettings();
 
+	// whether integer samples get TPDF dither noise before they are
+	// truncated
+	inline bool dither() const
+	{
+		return m_dither;
+	}
+
+	inline void setDither( const bool _dither )
+	{
+		m_dither = _dither;
+	}
+
 
 
 protected:
@@ -110,6 +161,18 @@ protected:
 						int_sample_t * _output_buffer,
 						const bool _convert_endian = false );
 
+	// convert to 24 bit samples in the upper bytes of 32 bit ones
+	void convertToS24( const surroundSampleFrame * _ab,
+						const fpp_t _frames,
+						const float _master_gain,
+						int32_t * _output_buffer );
+
+	// convert to interleaved float samples, which aren't clipped
+	void convertToFloat( const surroundSampleFrame * _ab,
+						const fpp_t _frames,
+						const float _master_gain,
+						float * _output_buffer );
+
 	// clear given signed-int-16-buffer
 	void clearS16Buffer( int_sample_t * _outbuf,
 							const fpp_t _frames );
@@ -131,6 +194,11 @@ protected:
 		return m_audioEngine;
 	}
 
+	const AudioEngine* audioEngine() const
+	{
+		return m_audioEngine;
+	}
+
 	bool hqAudio() const;
 
 	static void stopProcessingThread( QThread * thread );
@@ -141,6 +209,9 @@ protected:
 
 
 private:
+	// noise for _samples samples, or nullptr if there's no dither
+	const float * ditherNoise( const int _samples );
+
 	sample_rate_t m_sampleRate;
 	ch_cnt_t m_channels;
 	AudioEngine* m_audioEngine;
@@ -150,9 +221,15 @@ private:
 
 	SRC_DATA m_srcData;
 	SRC_STATE * m_srcState;
+	// takes over from libsamplerate when the processing rate is the output
+	// rate oversampled by 2, 4 or 8
+	std::unique_ptr<Oversampler> m_decimator;
 
 	surroundSampleFrame * m_buffer;
 
+	bool m_dither;
+	uint32_t m_ditherPos;
+
 } ;
 
 
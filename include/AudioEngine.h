@@ -25,6 +25,10 @@
 #ifndef AUDIO_ENGINE_H
 #define AUDIO_ENGINE_H
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include <QtCore/QMutex>
 #include <QtCore/QThread>
 #include <QtCore/QVector>
@@ -34,19 +38,40 @@
 
 #include "lmms_basics.h"
 #include "LocklessList.h"
+#include "LocklessRingBuffer.h"
+#include "MidiEvent.h"
+#include "MidiOutEvent.h"
 #include "Note.h"
-#include "FifoBuffer.h"
+#include "PeriodFifo.h"
+#include "MixHelpers.h"
 #include "AudioEngineProfiler.h"
 #include "PlayHandle.h"
+#include "RenderSnapshot.h"
+#include "VoiceLimiter.h"
 
 
 class AudioDevice;
 class MidiClient;
+class MidiPort;
 class AudioPort;
+class NoteBatch;
+class LatencyGovernor;
+class Metronome;
 
 
 const fpp_t MINIMUM_BUFFER_SIZE = 32;
 const fpp_t DEFAULT_BUFFER_SIZE = 256;
+//! Largest period for rendering only, see AudioEngine::AudioEngine()
+const fpp_t MAXIMUM_RENDER_BUFFER_SIZE = 4096;
+//! Frames of live input the engine can hold between two periods
+const f_cnt_t INPUT_RING_FRAMES = DEFAULT_BUFFER_SIZE * 100;
+//! MIDI input events the engine can hold between two periods
+const int MIDI_QUEUE_EVENTS = 1024;
+//! Play handle batches the engine can fill per period, the handles left over
+//! get jobs of their own
+const int PLAY_HANDLE_BATCHES = 256;
+//! Most periods the latency governor queues for the device by default
+const int DefaultGovernorMaxPeriods = 8;
 
 const int BYTES_PER_SAMPLE = sizeof( sample_t );
 const int BYTES_PER_INT_SAMPLE = sizeof( int_sample_t );
@@ -147,6 +172,13 @@ public:
 	} ;
 
 	void initDevices();
+
+	//! Create the metronome - needs the audio device, so call it after
+	//! initDevices()
+	void initMetronome();
+	//! Delete the metronome while the engine is stopped, before the engine
+	//! itself gets deleted
+	void destroyMetronome();
 	void clear();
 	void clearNewPlayHandles();
 
@@ -179,15 +211,24 @@ public:
 
 
 	// audio-port-stuff
+	// both never block the audio thread - removeAudioPort() waits for the
+	// current period to end before returning though, so that the port can
+	// be deleted right away
 	inline void addAudioPort(AudioPort * port)
 	{
-		requestChangeInModel();
-		m_audioPorts.push_back(port);
-		doneChangeInModel();
+		m_audioPorts.update([port](AudioPortList & ports) {
+			ports.push_back(port);
+		}, m_renderGracePeriod);
 	}
 
 	void removeAudioPort(AudioPort * port);
 
+	//! Grace period protecting the RenderSnapshots the audio thread reads
+	inline RenderGracePeriod & renderGracePeriod()
+	{
+		return m_renderGracePeriod;
+	}
+
 
 	// MIDI-client-stuff
 	inline const QString & midiClientName() const
@@ -205,6 +246,9 @@ public:
 	bool addPlayHandle( PlayHandle* handle );
 
 	void removePlayHandle( PlayHandle* handle );
+	//! Takes a recycled handle out of the engine, so that its owner can
+	//! delete it - call it while the model is locked
+	void dropPlayHandle( PlayHandle * handle );
 
 	inline PlayHandleList& playHandles()
 	{
@@ -220,12 +264,25 @@ public:
 		return m_framesPerPeriod;
 	}
 
+	//! The worker threads and the one driving the engine
+	int jobThreads() const
+	{
+		return m_numWorkers + 1;
+	}
+
 
 	AudioEngineProfiler& profiler()
 	{
 		return m_profiler;
 	}
 
+	//! Periods queued between the engine and the device, which the latency
+	//! governor may change while playing
+	int outputPeriods() const
+	{
+		return m_fifo->depth();
+	}
+
 	int cpuLoad() const
 	{
 		return m_profiler.cpuLoad();
@@ -284,28 +341,101 @@ public:
 		return m_fifoWriter != nullptr;
 	}
 
+	//! Called by the device's thread, never blocks nor allocates. Frames
+	//! which don't fit into the input ring are lost.
 	void pushInputFrames( sampleFrame * _ab, const f_cnt_t _frames );
 
+	//! The input taken from the ring for this period
 	inline const sampleFrame * inputBuffer()
 	{
-		return m_inputBuffer[ m_inputBufferRead ];
+		return m_inputBuffer;
 	}
 
 	inline f_cnt_t inputBufferFrames() const
 	{
-		return m_inputBufferFrames[ m_inputBufferRead ];
+		return m_inputBufferFrames;
+	}
+
+	//! Frames from when the input of this period was captured until the
+	//! period is heard: the frames it waited in the ring and the periods
+	//! queued for the output device. What the drivers buffer themselves
+	//! isn't known.
+	f_cnt_t inputLatency() const
+	{
+		const int periods = hasFifoWriter() ? m_fifo->depth() : 1;
+		return m_inputBufferFrames + periods * m_framesPerPeriod;
 	}
 
+	f_cnt_t lostInputFrames() const
+	{
+		return m_lostInputFrames.load( std::memory_order_relaxed );
+	}
+
+	//! Called by the MIDI clients' threads for events received at
+	//! @p timestamp (see AudioEngineProfiler::now()), never blocks nor
+	//! allocates. The events are given to the port's processor at the
+	//! frame of the next period they belong to. Events which don't fit
+	//! into the queue are lost.
+	void pushMidiEvent( MidiPort * port, const MidiEvent & event, const TimePos & time, qint64 timestamp );
+	//! Called by the MIDI ports for their output, from any thread, never
+	//! blocks nor allocates. The output of a period goes to the MIDI
+	//! client in one go at its end, sorted by @p offset. Events from
+	//! outside of the rendering go with the next period, at its start.
+	//! Events which don't fit into the queue are lost.
+	void pushMidiOutEvent( const MidiPort * port, const MidiEvent & event, const TimePos & time, f_cnt_t offset );
+	//! Drops the queued events of @p port, which is about to go away
+	void removeMidiEvents( MidiPort * port );
+
+	//! The next period, or nullptr once the FIFO writer stopped. Has to be
+	//! given back with releaseBuffer() after use.
 	inline const surroundSampleFrame * nextBuffer()
 	{
 		return hasFifoWriter() ? m_fifo->read() : renderNextBuffer();
 	}
 
+	//! Lets the FIFO writer render into the last period of nextBuffer()
+	//! again, which isn't needed for nullptr
+	inline void releaseBuffer()
+	{
+		if( hasFifoWriter() )
+		{
+			m_fifo->release();
+		}
+	}
+
 	void changeQuality(const struct qualitySettings & qs);
 
+	//! True while the engine skips rendering, as nothing can produce sound
+	bool isIdle() const
+	{
+		return m_idle;
+	}
+
 	inline bool isMetronomeActive() const { return m_metronomeActive; }
 	inline void setMetronomeActive(bool value = true) { m_metronomeActive = value; }
 
+	//! Pan law of the audio ports of all tracks
+	MixHelpers::PanLaw panLaw() const { return m_panLaw; }
+	void setPanLaw(MixHelpers::PanLaw law) { m_panLaw = law; }
+
+	//! Frames between two evaluations of the LFO shapes, the frames in
+	//! between are interpolated linearly
+	fpp_t lfoControlInterval() const { return m_lfoControlInterval; }
+	void setLfoControlInterval(fpp_t interval) { m_lfoControlInterval = qMax<fpp_t>(interval, 1); }
+
+	//! Frames between two coefficient updates of filters with automated
+	//! parameters, the parameters are sampled in the middle of each run
+	fpp_t filterControlInterval() const { return m_filterControlInterval; }
+	void setFilterControlInterval(fpp_t interval) { m_filterControlInterval = qMax<fpp_t>(interval, 1); }
+
+	//! Frames of the sub-blocks automated volumes, panning and sends are
+	//! applied in, 1 for a value per frame from the models' ValueBuffers
+	fpp_t automationControlInterval() const { return m_automationControlInterval; }
+	void setAutomationControlInterval(fpp_t interval) { m_automationControlInterval = qMax<fpp_t>(interval, 1); }
+
+	//! Keeps the notes within the global and the tracks' voice limits
+	VoiceLimiter & voiceLimiter() { return m_voiceLimiter; }
+
 	//! Block until a change in model can be done (i.e. wait for audio thread)
 	void requestChangeInModel();
 	void doneChangeInModel();
@@ -321,7 +451,7 @@ signals:
 
 
 private:
-	typedef FifoBuffer<surroundSampleFrame *> Fifo;
+	typedef PeriodFifo Fifo;
 
 	class fifoWriter : public QThread
 	{
@@ -338,11 +468,16 @@ private:
 
 		void run() override;
 
-		void write( surroundSampleFrame * buffer );
+		surroundSampleFrame * take();
 	} ;
 
 
-	AudioEngine( bool renderOnly );
+	//! renderFramesPerPeriod > 0 overrides the period size when rendering
+	//! only. It has to be known this early, as plugins size their buffers
+	//! when they get created. renderThreads > 0 overrides the number of
+	//! threads processing jobs when rendering only, including the one
+	//! calling renderNextBuffer().
+	AudioEngine( bool renderOnly, fpp_t renderFramesPerPeriod = 0, int renderThreads = 0 );
 	virtual ~AudioEngine();
 
 	void startProcessing(bool needsFifo = true);
@@ -357,25 +492,71 @@ private:
 
 	void swapBuffers();
 
+	//! Emit the output buffer, apply model changes and advance the LFOs -
+	//! done for every period, whether it was rendered or not
+	void finishPeriod();
+	bool canIdle();
+
+	//! Give the MIDI input received since the last period to its ports
+	void processMidiEvents();
+	//! Gives the MIDI output of the period to the MIDI client
+	void sendMidiOutEvents();
+
 	void handleMetronome();
 
 	void clearInternal();
 
+	// O(1) bookkeeping of m_playHandles, using the index stored in the
+	// play handle - the order of m_playHandles is not preserved
+	void appendPlayHandle( PlayHandle * handle );
+	bool takePlayHandle( PlayHandle * handle );
+	bool takeNewPlayHandle( PlayHandle * handle );
+	//! Adds @p handle to a batch of its audio port if it is cheap, returns
+	//! false if it needs a job of its own
+	bool batchPlayHandle( PlayHandle * handle );
+	//! Remove from its audio port and delete or release to the pool
+	void deletePlayHandle( PlayHandle * handle );
+	void requestPlayHandleRemoval( PlayHandle * handle );
+
 	//! Called by the audio thread to give control to other threads,
 	//! such that they can do changes in the model (like e.g. removing effects)
 	void runChangesInModel();
 
 	bool m_renderOnly;
 
-	QVector<AudioPort *> m_audioPorts;
+	typedef QVector<AudioPort *> AudioPortList;
+	RenderGracePeriod m_renderGracePeriod;
+	RenderSnapshot<AudioPortList> m_audioPorts;
 
 	fpp_t m_framesPerPeriod;
 
-	sampleFrame * m_inputBuffer[2];
-	f_cnt_t m_inputBufferFrames[2];
-	f_cnt_t m_inputBufferSize[2];
-	int m_inputBufferRead;
-	int m_inputBufferWrite;
+	// live input, written by the device's thread and taken by the audio
+	// engine at the start of every period
+	LocklessRingBuffer<sampleFrame> m_inputRing;
+	LocklessRingBufferReader<sampleFrame> m_inputReader;
+	sampleFrame * m_inputBuffer;
+	f_cnt_t m_inputBufferFrames;
+	std::atomic<f_cnt_t> m_lostInputFrames;
+
+	// MIDI input, queued by the MIDI clients' threads and taken by the
+	// audio engine at the start of every period
+	struct QueuedMidiEvent
+	{
+		MidiPort * port;
+		MidiEvent event;
+		TimePos time;
+		qint64 timestamp;
+	} ;
+	typedef LocklessList<QueuedMidiEvent>::Element QueuedMidiElement;
+	LocklessList<QueuedMidiEvent> m_midiEvents;
+	std::vector<QueuedMidiEvent> m_dueMidiEvents;
+	qint64 m_lastPeriodStart;
+
+	// MIDI output, queued by the MIDI ports and sent at the end of every
+	// period
+	typedef LocklessList<MidiOutEvent>::Element MidiOutElement;
+	LocklessList<MidiOutEvent> m_midiOutEvents;
+	std::vector<MidiOutEvent> m_dueMidiOutEvents;
 
 	surroundSampleFrame * m_outputBufferRead;
 	surroundSampleFrame * m_outputBufferWrite;
@@ -388,7 +569,13 @@ private:
 	PlayHandleList m_playHandles;
 	// place where new playhandles are added temporarily
 	LocklessList<PlayHandle *> m_newPlayHandles;
-	ConstPlayHandleList m_playHandlesToRemove;
+	PlayHandleList m_playHandlesToRemove;
+	// the note batches to be processed in this period
+	std::vector<NoteBatch *> m_noteBatches;
+	// the play handle batches, of which the first m_usedPlayHandleBatches
+	// are being filled or processed in this period
+	std::vector<std::unique_ptr<PlayHandleBatch>> m_playHandleBatches;
+	size_t m_usedPlayHandleBatches;
 
 
 	struct qualitySettings m_qualitySettings;
@@ -410,10 +597,19 @@ private:
 	// FIFO stuff
 	Fifo * m_fifo;
 	fifoWriter * m_fifoWriter;
+	// only used by the FIFO writer
+	std::unique_ptr<LatencyGovernor> m_latencyGovernor;
 
 	AudioEngineProfiler m_profiler;
 
 	bool m_metronomeActive;
+	Metronome * m_metronome;
+	bool m_idle;
+	MixHelpers::PanLaw m_panLaw;
+	fpp_t m_lfoControlInterval;
+	fpp_t m_filterControlInterval;
+	fpp_t m_automationControlInterval;
+	VoiceLimiter m_voiceLimiter;
 
 	bool m_clearSignal;
 
@@ -430,6 +626,7 @@ private:
 	friend class LmmsCore;
 	friend class AudioEngineWorkerThread;
 	friend class ProjectRenderer;
+	friend class TrackFreeze;
 } ;
 
 #endif
@@ -26,9 +26,19 @@
 #define AUDIO_ENGINE_PROFILER_H
 
 #include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 #include "lmms_basics.h"
 #include "MicroTimer.h"
+#include "ThreadableJob.h"
 
 class AudioEngineProfiler
 {
@@ -39,9 +49,20 @@ public:
 	void startPeriod()
 	{
 		m_periodTimer.reset();
+		m_periodStart = now();
+		m_stageStart = m_periodStart;
+		m_periodStageTimes.fill( 0 );
 	}
 
-	void finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPeriod );
+	//! When the current period was started, see now()
+	qint64 periodStart() const
+	{
+		return m_periodStart;
+	}
+
+	//! @p realtime tells whether the period had to be done before the
+	//! device needed it, which isn't the case while exporting
+	void finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPeriod, bool realtime );
 
 	int cpuLoad() const
 	{
@@ -51,10 +72,438 @@ public:
 	void setOutputFile( const QString& outputFile );
 
 
+	// where the time of a period went, see AudioEngine::renderNextBuffer()
+	enum class Stage
+	{
+		PlayHandles,	// the song creating and removing play handles
+		Graph,		// play handles, audio ports and mixer channels
+		MasterMix,
+		ModelChanges,	// and the LFOs and controllers after them
+		Count
+	} ;
+
+	//! Adds the time since the previous stage ended to @p stage
+	void finishStage( Stage stage )
+	{
+		const qint64 end = now();
+		m_periodStageTimes[static_cast<int>( stage )] += end - m_stageStart;
+		m_stageStart = end;
+	}
+
+	//! Microseconds spent in @p stage in the last period, only for the
+	//! thread calling AudioEngine::renderNextBuffer()
+	qint64 stageTime( Stage stage ) const
+	{
+		return m_stageTimes[static_cast<int>( stage )];
+	}
+
+	//! Microseconds the last period took, as stageTime()
+	qint64 periodTime() const
+	{
+		return m_periodTime;
+	}
+
+
+	// work which has been skipped because buffers were known to be silent
+	enum class SkippedWork
+	{
+		BufferClear,
+		Mix,
+		PeakScan,
+		FusedPeakScan,	// peak values came with the last mix instead
+		Period,		// whole periods while the engine was idle
+		EffectChain,	// periods of effect chains that were asleep
+		Count
+	} ;
+
+	void countSkipped( SkippedWork work )
+	{
+		m_skippedWork[static_cast<int>( work )].fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	quint64 skipped( SkippedWork work ) const
+	{
+		return m_skippedWork[static_cast<int>( work )].load( std::memory_order_relaxed );
+	}
+
+
+	// job queue statistics - the depth is the number of jobs queued in
+	// one stage, a growth happens when a deque was full while adding a job
+	void recordJobQueueDepth( int depth )
+	{
+		if( depth > m_periodJobQueueDepth )
+		{
+			m_periodJobQueueDepth = depth;
+		}
+	}
+
+	void countJobQueueGrowth()
+	{
+		m_jobQueueGrowths.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	//! Most jobs queued in a stage of the last period
+	int jobQueueDepth() const
+	{
+		return m_jobQueueDepth.load( std::memory_order_relaxed );
+	}
+
+	int maxJobQueueDepth() const
+	{
+		return m_maxJobQueueDepth.load( std::memory_order_relaxed );
+	}
+
+	int jobQueueGrowths() const
+	{
+		return m_jobQueueGrowths.load( std::memory_order_relaxed );
+	}
+
+
+	// per-job tracing - when enabled, the worker threads record start and
+	// end time of every ThreadableJob they process
+	void setThreadCount( int threads );
+
+	void setJobTracingEnabled( bool enabled );
+	bool jobTracingEnabled() const
+	{
+		return m_jobTracingEnabled.load( std::memory_order_relaxed );
+	}
+
+	// per-object load - when enabled, the processing time of every job is
+	// added to its LoadMeter, see ThreadableJob::loadMeter()
+	void setJobLoadEnabled( bool enabled )
+	{
+		m_jobLoadEnabled.store( enabled, std::memory_order_relaxed );
+	}
+
+	bool jobLoadEnabled() const
+	{
+		return m_jobLoadEnabled.load( std::memory_order_relaxed );
+	}
+
+	//! Microseconds since the profiler was created
+	static qint64 now();
+
+	//! Called by the thread which processed the job, never blocks
+	void recordJob( int thread, const ThreadableJob * job, qint64 start, qint64 end );
+
+	//! Hand the recorded jobs of all threads to the trace, and take the
+	//! most expensive jobs of the period for the glitch history, and the
+	//! levels of the jobs for the denormal watch. Must be
+	//! called by the audio engine while no jobs are processed and all
+	//! recorded jobs are still alive, as their labels get taken here.
+	void collectJobTraces();
+
+	void clearJobTrace();
+
+	int jobTraceSize() const;
+
+	//! Write the trace in the Chrome trace event format, which can be
+	//! loaded into chrome://tracing or Perfetto
+	bool writeJobTrace( const QString & fileName );
+
+
+	// glitch telemetry - periods which took longer than the device has
+	// frames for, and xruns reported by the device, are kept in a history
+	// together with the jobs which took longest in that period
+	static constexpr int TopJobs = 5;
+	static constexpr int MaxGlitches = 256;
+
+	struct Glitch
+	{
+		qint64 time;		// milliseconds since the epoch
+		qint64 periodTime;	// microseconds
+		qint64 deadline;	// microseconds
+		int xruns;		// reported by the device since the last period
+		int jobCount;
+		QString jobNames[TopJobs];
+		qint64 jobTimes[TopJobs];	// microseconds
+	} ;
+
+	//! Whether the worker threads should measure every job for the
+	//! history, which is only of use while playing in realtime
+	void setJobCostsEnabled( bool enabled )
+	{
+		m_jobCostsEnabled.store( enabled, std::memory_order_relaxed );
+	}
+
+	bool jobCostsEnabled() const
+	{
+		return m_jobCostsEnabled.load( std::memory_order_relaxed );
+	}
+
+	//! Called by the thread which processed the job, never blocks
+	void recordJobCost( int thread, const ThreadableJob * job, qint64 nanoseconds );
+
+	//! May be called by any thread, e.g. the device's callbacks
+	void countDeviceXrun()
+	{
+		m_deviceXruns.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	//! Microseconds of audio in the last period, which is how long it
+	//! may take to render when playing
+	qint64 deadline() const
+	{
+		return m_deadline;
+	}
+
+	//! Periods which took longer than their deadline
+	int deadlineMisses() const
+	{
+		return m_deadlineMisses.load( std::memory_order_relaxed );
+	}
+
+	int totalDeviceXruns() const
+	{
+		return m_totalDeviceXruns.load( std::memory_order_relaxed );
+	}
+
+	//! The last glitches, oldest first
+	QVector<Glitch> glitches() const;
+
+	void clearGlitches();
+
+	//! Write the glitch history as JSON
+	bool writeGlitchLog( const QString & fileName ) const;
+
+	//! Write the glitch history to @p fileName when the profiler is destroyed
+	void setGlitchLogFile( const QString & fileName )
+	{
+		m_glitchLogFile = fileName;
+	}
+
+
+	// denormal watch - when enabled, the worker threads record the time
+	// of every job rendering into a buffer of its own together with the
+	// peak it rendered, see ThreadableJob::outputPeak(). Jobs which take
+	// much longer while their output decays to almost nothing, like
+	// effects in a reverb tail, are likely processing denormals, e.g.
+	// because a plugin turns the protection of the thread off or uses
+	// instructions it doesn't cover.
+	struct DenormalSuspect
+	{
+		QString jobName;
+		int spikes;		// quiet periods which took much longer
+		float worstRatio;	// of a quiet period's time to the usual one
+		qint64 usualTime;	// microseconds, while the output is loud
+	} ;
+
+	void setDenormalWatchEnabled( bool enabled )
+	{
+		m_denormalWatchEnabled.store( enabled, std::memory_order_relaxed );
+	}
+
+	bool denormalWatchEnabled() const
+	{
+		return m_denormalWatchEnabled.load( std::memory_order_relaxed );
+	}
+
+	//! Called by the thread which processed the job, never blocks
+	void recordJobLevel( int thread, const ThreadableJob * job, qint64 nanoseconds );
+
+	//! The jobs which spiked often enough to be reported, worst first
+	QVector<DenormalSuspect> denormalSuspects() const;
+
+
 private:
+	struct JobRecord
+	{
+		const ThreadableJob * job;
+		qint64 start;
+		qint64 end;
+	} ;
+
+	// single producer (the worker thread) / single consumer (the audio
+	// engine thread) ring buffer
+	struct JobRecordRing
+	{
+		static constexpr size_t Size = 4096;
+
+		JobRecord records[Size];
+		std::atomic<size_t> written{0};
+		size_t read = 0;
+	} ;
+
+	// the most expensive jobs a worker thread processed in this period,
+	// only touched by that thread while jobs are processed
+	struct JobCosts
+	{
+		struct Cost
+		{
+			const ThreadableJob * job;
+			qint64 nanoseconds;
+		} ;
+
+		Cost costs[TopJobs];
+		int count = 0;
+
+		//! Keeps the costs sorted, the most expensive first
+		void insert( const ThreadableJob * job, qint64 nanoseconds )
+		{
+			if( count == TopJobs && costs[TopJobs - 1].nanoseconds >= nanoseconds )
+			{
+				return;
+			}
+			int i = count < TopJobs ? count++ : TopJobs - 1;
+			for( ; i > 0 && costs[i - 1].nanoseconds < nanoseconds; --i )
+			{
+				costs[i] = costs[i - 1];
+			}
+			costs[i] = { job, nanoseconds };
+		}
+	} ;
+
+	void collectJobCosts();
+
+	struct LevelRecord
+	{
+		const ThreadableJob * job;
+		qint64 nanoseconds;
+		float peak;
+	} ;
+
+	// what the denormal watch knows about a job, by its name
+	struct LevelStats
+	{
+		qint64 loudTime = 0;	// nanoseconds, averaged
+		int loudPeriods = 0;
+		int spikes = 0;
+		float worstRatio = 0.0f;
+	} ;
+
+	void collectJobLevels();
+
+	// single producer / single consumer ring with a fixed capacity, which
+	// lets the audio engine thread hand things to a thread which may
+	// block and allocate
+	template<typename T, size_t Size>
+	class HandOffRing
+	{
+	public:
+		HandOffRing() :
+			m_items( new T[Size] )
+		{
+		}
+
+		//! Returns false if the ring is full
+		bool push( T item )
+		{
+			const size_t written = m_written.load( std::memory_order_relaxed );
+			if( written - m_read.load( std::memory_order_acquire ) >= Size )
+			{
+				return false;
+			}
+			m_items[written % Size] = std::move( item );
+			m_written.store( written + 1, std::memory_order_release );
+			return true;
+		}
+
+		//! Passes every item pushed so far to @p consume
+		template<typename F>
+		void drain( F consume )
+		{
+			const size_t written = m_written.load( std::memory_order_acquire );
+			size_t read = m_read.load( std::memory_order_relaxed );
+			for( ; read < written; ++read )
+			{
+				// leaves nothing behind the producer would have to free
+				T item( std::move( m_items[read % Size] ) );
+				m_items[read % Size] = T();
+				consume( item );
+			}
+			m_read.store( read, std::memory_order_release );
+		}
+
+		size_t size() const
+		{
+			return m_written.load( std::memory_order_acquire ) - m_read.load( std::memory_order_acquire );
+		}
+
+	private:
+		std::unique_ptr<T[]> m_items;
+		std::atomic<size_t> m_written{0};
+		std::atomic<size_t> m_read{0};
+	} ;
+
+	// the name only gets put together when the trace is written
+	struct TraceEvent
+	{
+		ThreadableJob::Label label;
+		int thread;
+		qint64 start;
+		qint64 duration;
+	} ;
+
+	static constexpr int MaxTraceEvents = 1 << 20;
+
+	using TraceRing = HandOffRing<TraceEvent, 1 << 15>;
+	using PeriodRing = HandOffRing<int, 1024>;
+
+	// moves what the audio engine thread handed over into the trace and the
+	// output file, until the profiler is destroyed
+	class DrainThread;
+
+	void startDrainThread();
+	//! Must not be called by the audio engine thread
+	void drainTraces();
+	void drainPeriods();
+
 	MicroTimer m_periodTimer;
 	int m_cpuLoad;
 	QFile m_outputFile;
+
+	qint64 m_periodStart;
+	qint64 m_stageStart;
+	std::array<qint64, static_cast<int>( Stage::Count )> m_periodStageTimes;
+	std::array<qint64, static_cast<int>( Stage::Count )> m_stageTimes;
+	qint64 m_periodTime;
+	std::atomic_bool m_jobTracingEnabled;
+	std::atomic_bool m_jobLoadEnabled;
+	std::vector<std::unique_ptr<JobRecordRing>> m_jobRecords;
+	std::atomic_int m_droppedJobs;
+
+	// created by the first setJobTracingEnabled() and setOutputFile()
+	// and kept until the profiler is destroyed
+	std::atomic<TraceRing *> m_traceRing;
+	std::atomic<PeriodRing *> m_periodRing;
+	std::unique_ptr<DrainThread> m_drainThread;
+	QString m_periodName;
+
+	// only touched by the threads draining the rings
+	QVector<TraceEvent> m_traceEvents;
+	mutable QMutex m_traceMutex;
+	QMutex m_outputMutex;
+
+	std::atomic_bool m_jobCostsEnabled;
+	std::vector<JobCosts> m_jobCosts;
+	// merged from all threads and resolved by collectJobTraces()
+	int m_periodJobCount;
+	QString m_periodJobNames[TopJobs];
+	qint64 m_periodJobTimes[TopJobs];
+	qint64 m_deadline;
+
+	std::atomic_int m_deviceXruns;
+	std::atomic_int m_totalDeviceXruns;
+	std::atomic_int m_deadlineMisses;
+	QVector<Glitch> m_glitches;
+	int m_nextGlitch;
+	mutable QMutex m_glitchMutex;
+	QString m_glitchLogFile;
+
+	std::atomic_bool m_denormalWatchEnabled;
+	// one per thread, with a fixed capacity
+	std::vector<std::vector<LevelRecord>> m_jobLevels;
+	QHash<QString, LevelStats> m_levelStats;
+	mutable QMutex m_levelMutex;
+
+	std::atomic<quint64> m_skippedWork[static_cast<int>( SkippedWork::Count )];
+
+	// only touched by the audio engine thread
+	int m_periodJobQueueDepth;
+	std::atomic_int m_jobQueueDepth;
+	std::atomic_int m_maxJobQueueDepth;
+	std::atomic_int m_jobQueueGrowths;
 };
 
 #endif
@@ -28,8 +28,14 @@
 #include <QtCore/QThread>
 
 #include <atomic>
+#include <memory>
+#include <vector>
+
+#include "WorkStealingDeque.h"
 
 class AudioEngine;
+class AudioEngineProfiler;
+class QMutex;
 class QWaitCondition;
 class ThreadableJob;
 
@@ -38,6 +44,8 @@ class AudioEngineWorkerThread : public QThread
 	Q_OBJECT
 public:
 	// internal representation of the job queue - all functions are thread-safe
+	// every thread owns a work-stealing deque: jobs are pushed onto the deque
+	// of the thread adding them and idle threads steal from the others
 	class JobQueue
 	{
 	public:
@@ -47,32 +55,53 @@ public:
 			Dynamic	// jobs can be added while processing queue
 		} ;
 
-		static constexpr size_t JOB_QUEUE_SIZE = 8192;
+		//! Initial capacity of each thread's deque, it grows when needed
+		static constexpr size_t JOB_QUEUE_SIZE = 1024;
+
+		JobQueue();
 
-		JobQueue() :
-			m_items(),
-			m_writeIndex( 0 ),
-			m_itemsDone( 0 ),
-			m_opMode( Static )
+		//! Create the deque for another thread and return its index
+		int addThreadQueue();
+
+		void setProfiler( AudioEngineProfiler * profiler )
 		{
-			std::fill(m_items, m_items + JOB_QUEUE_SIZE, nullptr);
+			m_profiler = profiler;
 		}
 
 		void reset( OperationMode _opMode );
 
-		void addJob( ThreadableJob * _job );
+		//! Make room for @p jobs jobs in the deque of every thread, as in
+		//! Dynamic mode the workers push the jobs which depend on theirs.
+		//! Only between stages, while all deques are empty.
+		void reserve( size_t jobs );
+
+		//! Returns false if the job doesn't require processing
+		bool addJob( ThreadableJob * _job );
 
 		void run();
 		void wait();
 
 	private:
-		std::atomic<ThreadableJob*> m_items[JOB_QUEUE_SIZE];
-		std::atomic_int m_writeIndex;
+		typedef WorkStealingDeque<ThreadableJob, JOB_QUEUE_SIZE> Deque;
+
+		//! Take a job from the own deque or steal one from another thread
+		ThreadableJob * takeJob();
+		bool processNextJob();
+
+		// index 0 belongs to the thread driving the audio engine
+		std::vector<std::unique_ptr<Deque>> m_queues;
+		std::atomic_int m_itemsQueued;
 		std::atomic_int m_itemsDone;
 		OperationMode m_opMode;
+		AudioEngineProfiler * m_profiler;
 	} ;
 
 
+	//! How long an idle worker keeps spinning for new jobs before it goes
+	//! to sleep, in microseconds
+	static constexpr int DEFAULT_SPIN_TIME = 100;
+	static constexpr int MAX_SPIN_TIME = 2000;
+
 	AudioEngineWorkerThread( AudioEngine* audioEngine );
 	virtual ~AudioEngineWorkerThread();
 
@@ -84,9 +113,14 @@ public:
 		globalJobQueue.reset( _opMode );
 	}
 
-	static void addJob( ThreadableJob * _job )
+	static bool addJob( ThreadableJob * _job )
 	{
-		globalJobQueue.addJob( _job );
+		return globalJobQueue.addJob( _job );
+	}
+
+	static void reserveJobs( size_t jobs )
+	{
+		globalJobQueue.reserve( jobs );
 	}
 
 	// a convenient helper function allowing to pass a container with pointers
@@ -96,6 +130,7 @@ public:
 							JobQueue::OperationMode _opMode = JobQueue::Static )
 	{
 		resetJobQueue( _opMode );
+		reserveJobs( _vec.size() );
 		for( typename T::ConstIterator it = _vec.begin(); it != _vec.end(); ++it )
 		{
 			addJob( *it );
@@ -108,11 +143,27 @@ public:
 private:
 	void run() override;
 
+	//! Apply the CPU affinity and scheduling settings to the calling thread
+	void setupThread();
+
+	//! Spin and then sleep until startAndWaitForJobs() starts a stage
+	//! later than @p generation
+	void waitForJobs( unsigned generation );
+
 	static JobQueue globalJobQueue;
+	static QMutex * queueReadyMutex;
 	static QWaitCondition * queueReadyWaitCond;
 	static QList<AudioEngineWorkerThread *> workerThreads;
 
+	// incremented for every stage, workers process the queue when it changes
+	static std::atomic_uint jobsGeneration;
+	static std::atomic_int sleepingWorkers;
+
 	volatile bool m_quit;
+	int m_queueIndex;
+	int m_spinTime;
+	bool m_pinToCpu;
+	bool m_realtimePriority;
 } ;
 
 
@@ -26,11 +26,15 @@
 #ifndef AUDIO_FILE_DEVICE_H
 #define AUDIO_FILE_DEVICE_H
 
+#include <memory>
+#include <vector>
+
 #include <QtCore/QFile>
 
 #include "AudioDevice.h"
 #include "OutputSettings.h"
 
+class AudioFileEncoder;
 
 class AudioFileDevice : public AudioDevice
 {
@@ -47,6 +51,27 @@ public:
 
 	OutputSettings const & getOutputSettings() const { return m_outputSettings; }
 
+	//! Like processNextBuffer(), but hands the period to a thread of its
+	//! own for encoding and writing, so that the next period can be
+	//! rendered meanwhile. Waits while that thread is too far behind.
+	//! The same period is also encoded by each of @p copies, which have
+	//! to have the sample rate of this device.
+	//! Returns false when there is nothing more to render.
+	bool renderNextBuffer( const std::vector<AudioFileDevice *> & copies = {} );
+	//! Renders the next period into @p frames without encoding it, returns
+	//! the frames rendered
+	fpp_t renderPeriod( surroundSampleFrame * frames )
+	{
+		return getNextBuffer( frames );
+	}
+	//! Encodes @p count frames of any length which were rendered before,
+	//! the way renderNextBuffer() encodes a period
+	void encodeFrames( const surroundSampleFrame * frames, f_cnt_t count,
+				const std::vector<AudioFileDevice *> & copies = {} );
+	//! Waits until everything rendered is written, or drops it if
+	//! @p discard. Has to be called before the device is destroyed.
+	void finishEncoding( bool discard = false );
+
 
 protected:
 	int writeData( const void* data, int len );
@@ -62,8 +87,14 @@ protected:
 	}
 
 private:
+	void startEncoding();
+
 	QFile m_outputFile;
 	OutputSettings m_outputSettings;
+
+	std::unique_ptr<AudioFileEncoder> m_encoder;
+
+	friend class AudioFileEncoder;
 } ;
 
 
@@ -35,6 +35,7 @@
 #endif
 
 #include <atomic>
+#include <QtCore/QHash>
 #include <QtCore/QVector>
 #include <QtCore/QList>
 #include <QtCore/QMap>
@@ -92,23 +93,36 @@ private:
 
 	virtual void startProcessing();
 	virtual void stopProcessing();
+	bool rendersInCallback() const override;
 	virtual void applyQualitySettings();
 
 	virtual void registerPort( AudioPort * _port );
 	virtual void unregisterPort( AudioPort * _port );
 	virtual void renamePort( AudioPort * _port );
 
+	bool supportsChannelOutputs() const override;
+	void registerChannel( const MixerChannel * _channel ) override;
+	void unregisterChannel( const MixerChannel * _channel ) override;
+	void renameChannel( const MixerChannel * _channel ) override;
+	void writeChannel( const MixerChannel * _channel, const sampleFrame * _buf,
+					const float _gain, const fpp_t _frames ) override;
+
+	void writeChannelPorts( jack_nframes_t _nframes, bool aligned );
+
 	int processCallback( jack_nframes_t _nframes, void * _udata );
 
 	static int staticProcessCallback( jack_nframes_t _nframes,
 							void * _udata );
 	static void shutdownCallback( void * _udata );
+	static int xrunCallback( void * _udata );
 
 
 	jack_client_t * m_client;
 
 	bool m_active;
 	std::atomic<bool> m_stopped;
+	// while the callback may be rendering
+	std::atomic<bool> m_inCallback;
 
 	std::atomic<MidiJack *> m_midiClient;
 	QVector<jack_port_t *> m_outputPorts;
@@ -119,6 +133,20 @@ private:
 	f_cnt_t m_framesToDoInCurBuf;
 
 
+	// the outputs of mixer channels - as the audio engine hands out each
+	// period with the next one, what a channel wrote is kept for one
+	// period, so that it comes out along with the master output
+	struct ChannelOutput
+	{
+		jack_port_t * ports[DEFAULT_CHANNELS];
+		QVector<sampleFrame> buffers[2];
+	} ;
+	QHash<const MixerChannel *, ChannelOutput> m_channelOutputs;
+	// never waited for in the callback
+	QMutex m_channelMutex;
+	// the buffers written while rendering the current period
+	int m_channelBuffer;
+
 #ifdef AUDIO_PORT_SUPPORT
 	struct StereoPort
 	{
@@ -25,11 +25,14 @@
 #ifndef AUDIO_PORT_H
 #define AUDIO_PORT_H
 
+#include <atomic>
 #include <memory>
+#include <vector>
 #include <QtCore/QString>
 #include <QtCore/QMutex>
 #include <QtCore/QMutexLocker>
 
+#include "LoadMeter.h"
 #include "MemoryManager.h"
 #include "PlayHandle.h"
 
@@ -106,17 +109,91 @@ public:
 		return true;
 	}
 
+	Label jobLabel() const override
+	{
+		return { "Audio port", m_name };
+	}
+
+	//! Time spent on volume, panning and the effect chain
+	LoadMeter * loadMeter() override
+	{
+		return &m_effectsLoad;
+	}
+
+	float outputPeak() const override;
+
+	//! Time spent by the play handles, i.e. the instrument, of this port
+	LoadMeter & playHandleLoad()
+	{
+		return m_playHandleLoad;
+	}
+
+	LoadMeter & effectsLoad()
+	{
+		return m_effectsLoad;
+	}
+
 	void addPlayHandle( PlayHandle * handle );
 	void removePlayHandle( PlayHandle * handle );
 
+	// render graph stuff - the port gets queued for processing as soon as
+	// all of its play handles have been processed in the current period
+	void prepareProcessing();
+	inline void addPendingPlayHandle()
+	{
+		++m_pendingPlayHandles;
+	}
+	inline bool hasPendingPlayHandles() const
+	{
+		return m_pendingPlayHandles > 0;
+	}
+	void playHandleProcessed();
+
+	// mixer-channel the port sends to in the current period
+	inline mix_ch_t targetMixerChannel() const
+	{
+		return m_targetMixerChannel;
+	}
+
+	// track freezing - while frozen, the play handles already deliver the
+	// final output, so volume, panning and effects are skipped
+	void setFrozen( bool frozen )
+	{
+		m_frozen = frozen;
+	}
+	// record the output of each period, interleaved, while freezing
+	void setFreezeCapture( std::vector<sample_t> * capture )
+	{
+		m_freezeCapture = capture;
+	}
+	// record the input of each period, interleaved and before volume,
+	// panning and effects, while rendering a BB pattern cache
+	void setPatternCapture( std::vector<sample_t> * capture )
+	{
+		m_patternCapture = capture;
+	}
+
 private:
+	void processBuffer();
+
 	volatile bool m_bufferUsage;
 
 	sampleFrame * m_portBuffer;
+	// whether m_portBuffer is known to contain only zeros
+	bool m_portBufferSilent;
 	QMutex m_portBufferLock;
 
 	bool m_extOutputEnabled;
+	bool m_frozen;
+	std::vector<sample_t> * m_freezeCapture;
+	std::vector<sample_t> * m_patternCapture;
 	mix_ch_t m_nextMixerChannel;
+	mix_ch_t m_targetMixerChannel;
+
+	std::atomic_int m_pendingPlayHandles;
+	// the batch the audio engine is filling with the port's cheap play
+	// handles in the current period
+	PlayHandleBatch * m_playHandleBatch;
 
 	QString m_name;
 
@@ -129,6 +206,9 @@ private:
 	FloatModel * m_panningModel;
 	BoolModel * m_mutedModel;
 
+	LoadMeter m_playHandleLoad;
+	LoadMeter m_effectsLoad;
+
 	friend class AudioEngine;
 	friend class AudioEngineWorkerThread;
 
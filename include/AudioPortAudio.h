@@ -100,6 +100,7 @@ public:
 private:
 	virtual void startProcessing();
 	virtual void stopProcessing();
+	bool rendersInCallback() const override;
 	virtual void applyQualitySettings();
 
 #ifdef PORTAUDIO_V19
@@ -25,6 +25,8 @@
 #ifndef AUDIO_SOUNDIO_H
 #define AUDIO_SOUNDIO_H
 
+#include <atomic>
+
 #include <QtCore/QObject>
 
 #include "lmmsconfig.h"
@@ -100,6 +102,7 @@ public:
 private:
 	virtual void startProcessing();
 	virtual void stopProcessing();
+	bool rendersInCallback() const override;
 
 	SoundIo *m_soundio;
 	SoundIoOutStream *m_outstream;
@@ -109,13 +112,16 @@ private:
 	fpp_t m_outBufFramesTotal;
 	fpp_t m_outBufFrameIndex;
 
-	bool m_stopped;
+	std::atomic<bool> m_stopped;
+	// while the callback may be rendering
+	std::atomic<bool> m_inCallback;
 	bool m_outstreamStarted;
 
 	int m_disconnectErr;
 	void onBackendDisconnect(int err);
 
 	void writeCallback(int frame_count_min, int frame_count_max);
+	void writeFrames(int frame_count_min, int frame_count_max);
 	void errorCallback(int err);
 	void underflowCallback();
 
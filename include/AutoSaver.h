@@ -0,0 +1,78 @@
+/*
+ * AutoSaver.h - writes recovery files in the background
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef AUTO_SAVER_H
+#define AUTO_SAVER_H
+
+#include <memory>
+
+#include <QDomElement>
+#include <QHash>
+#include <QPointer>
+#include <QSet>
+#include <QThreadPool>
+
+class DataFile;
+class Track;
+
+
+//! Saves the project for recovery. Tracks whose objects haven't been
+//! changed through the journal since the last save are taken from what
+//! was saved of them then, instead of saving their instruments, effects
+//! and samples again. The snapshot is written on a thread of its own.
+class AutoSaver
+{
+public:
+	AutoSaver();
+	//! Waits until the last snapshot is written
+	~AutoSaver();
+
+	//! Returns false if the last snapshot is still being written, so
+	//! nothing was saved. Main thread.
+	bool save( const QString & fileName );
+	//! Waits until the last snapshot is written
+	void wait();
+
+private:
+	struct CachedTrack
+	{
+		QPointer<Track> track;
+		QDomElement element;
+	} ;
+
+	void collectChanges();
+	void saveTrack( Track * track, QDomDocument & doc, QDomElement & parent );
+
+	// what was saved of the tracks, and what they embedded
+	std::unique_ptr<DataFile> m_cache;
+	QHash<const Track *, CachedTrack> m_tracks;
+	QSet<const Track *> m_changed;
+	bool m_allChanged;
+	int m_saves;
+
+	QThreadPool m_pool;
+} ;
+
+
+#endif
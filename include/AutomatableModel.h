@@ -28,6 +28,10 @@
 #include <QtCore/QMap>
 #include <QtCore/QMutex>
 
+#include <atomic>
+#include <utility>
+#include <vector>
+
 #include "JournallingObject.h"
 #include "Model.h"
 #include "TimePos.h"
@@ -173,6 +177,13 @@ public:
 	//! @return pointer to model's valueBuffer when s.ex.data exists, NULL otherwise
 	ValueBuffer * valueBuffer();
 
+	//! @brief For consumers which split the period into sub-blocks instead
+	//! of using valueBuffer(), which then doesn't fill its buffer
+	//! @return false if the period's values must be read from valueBuffer(),
+	//! i.e. if a sample-exact controller drives the model - otherwise
+	//! @p ramp gets them
+	bool valueRamp( ValueRamp & ramp );
+
 	template<class T>
 	T initValue() const
 	{
@@ -282,9 +293,10 @@ public:
 	// a way to track changed values in the model and avoid using signals/slots - useful for speed-critical code.
 	// note that this method should only be called once per period since it resets the state of the variable - so if your model
 	// has to be accessed by more than one object, then this function shouldn't be used.
+	// Consumers using this together with value() work at control rate, so no ValueBuffer is calculated for them.
 	bool isValueChanged()
 	{
-		if( m_valueChanged || valueBuffer() )
+		if( m_valueChanged || hasSampleExactController() )
 		{
 			m_valueChanged = false;
 			return true;
@@ -355,6 +367,16 @@ private:
 
 	static bool mustQuoteName(const QString &name);
 
+	//! Calculates the value buffer for the current period, returns NULL
+	//! if there's no sample-exact data
+	ValueBuffer * updateValueBuffer();
+	//! Calls updateValueBuffer() once per period
+	void updatePeriod();
+
+	//! Whether a sample-exact controller drives this model, i.e. whether
+	//! valueBuffer() has new data in every period
+	bool hasSampleExactController() const;
+
 	void saveSettings( QDomDocument& doc, QDomElement& element ) override
 	{
 		saveSettings( doc, element, "value" );
@@ -404,12 +426,23 @@ private:
 
 
 	ValueBuffer m_valueBuffer;
-	long m_lastUpdatedPeriod;
+	// period m_currentValueBuffer is valid for, stored after the buffer
+	// was written
+	std::atomic<long> m_lastUpdatedPeriod;
 	static long s_periodCounter;
 
-	bool m_hasSampleExactData;
+	// what valueBuffer() returns: m_valueBuffer, a controller's shared
+	// buffer or NULL
+	ValueBuffer * m_currentValueBuffer;
+
+	// the values of the period if they're a ramp, which is written to
+	// m_valueBuffer only once valueBuffer() is asked for
+	ValueRamp m_ramp;
+	bool m_isRamp;
+	std::atomic<bool> m_rampPending;
 
-	// prevent several threads from attempting to write the same vb at the same time
+	// prevent several threads from attempting to write the same vb at the
+	// same time - only taken by the first caller in each period
 	QMutex m_valueBufferMutex;
 
 	bool m_useControllerValue;
@@ -501,6 +534,9 @@ public:
 } ;
 
 typedef QMap<AutomatableModel*, float> AutomatedValueMap;
+//! Sorted by model, every model appears once. Used during playback, where
+//! a reused vector avoids QMap's allocations.
+typedef std::vector<std::pair<AutomatableModel*, float>> AutomatedValueList;
 
 #endif
 
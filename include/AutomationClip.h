@@ -30,6 +30,9 @@
 #include <QtCore/QMap>
 #include <QtCore/QPointer>
 
+#include <utility>
+#include <vector>
+
 #include "AutomationNode.h"
 #include "Clip.h"
 
@@ -95,6 +98,14 @@ public:
 		const bool ignoreSurroundingPoints = true
 	);
 
+	//! Puts nodes with the given values at once, generating the tangents,
+	//! updating the length and emitting dataChanged() only once. Surrounding
+	//! nodes are kept like with ignoreSurroundingPoints.
+	void putValues(
+		const std::vector<std::pair<TimePos, float>> & values,
+		const bool quantPos = true
+	);
+
 	void removeNode(const TimePos & time);
 	void removeNodes(const int tick0, const int tick1);
 
@@ -179,6 +190,21 @@ private:
 	void generateTangents(timeMap::iterator it, int numToGenerate);
 	float valueAt( timeMap::const_iterator v, int offset ) const;
 
+	//! Copy of a node in the contiguous array used during playback
+	struct PlaybackNode
+	{
+		int pos;
+		float inValue;
+		float outValue;
+		float inTangent;
+		float outTangent;
+	} ;
+
+	static PlaybackNode playbackNode( timeMap::const_iterator it );
+	float interpolate( const PlaybackNode & v, const PlaybackNode & next, int offset ) const;
+	void updatePlaybackNodes() const;
+	int playbackNodeAt( int time ) const;
+
 	// Mutex to make methods involving automation clips thread safe
 	// Mutable so we can lock it from const objects
 	mutable QMutex m_clipMutex;
@@ -188,6 +214,14 @@ private:
 	objectVector m_objects;
 	timeMap m_timeMap;	// actual values
 	timeMap m_oldTimeMap;	// old values for storing the values before setDragValue() is called.
+
+	// Flattened m_timeMap which valueAt() reads from. It's rebuilt on the
+	// next lookup after the nodes changed. The cursor is the node the
+	// last lookup ended at, so monotonic playback advances from there
+	// instead of searching the nodes again.
+	mutable std::vector<PlaybackNode> m_playbackNodes;
+	mutable bool m_playbackNodesChanged;
+	mutable int m_playbackCursor;
 	float m_tension;
 	bool m_hasAutomation;
 	ProgressionTypes m_progressionType;
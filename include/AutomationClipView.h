@@ -66,7 +66,6 @@ protected:
 
 private:
 	AutomationClip * m_clip;
-	QPixmap m_paintPixmap;
 	
 	QStaticText m_staticTextName;
 	
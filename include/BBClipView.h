@@ -56,7 +56,6 @@ protected:
 
 private:
 	BBClip * m_bbClip;
-	QPixmap m_paintPixmap;
 	
 	QStaticText m_staticTextName;
 } ;
@@ -0,0 +1,156 @@
+/*
+ * BBPatternCache.h - renders a beat/bassline pattern once and replays it
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef BB_PATTERN_CACHE_H
+#define BB_PATTERN_CACHE_H
+
+#include <atomic>
+#include <vector>
+
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+
+#include "lmms_basics.h"
+
+class AudioPort;
+class BBTrack;
+class Model;
+class SampleBuffer;
+class TimePos;
+class Track;
+
+
+//! Renders the pattern of a BB track once, recording what each track of the
+//! beat/bassline editor feeds into its audio port, i.e. before volume,
+//! panning and effects. In the song editor, every repetition of the pattern
+//! which fits into its clip then plays these recordings instead of starting
+//! the notes again, while the tracks' volume, panning and effects still run
+//! live. Editing the pattern, its tracks or their instruments drops the
+//! recordings, and the pattern plays live until the user renders it again.
+//! Patterns with automated or controlled models always play live.
+class BBPatternCache : public QObject
+{
+	Q_OBJECT
+public:
+	BBPatternCache( BBTrack * bbTrack );
+	virtual ~BBPatternCache();
+
+	bool isEnabled() const
+	{
+		return m_enabled;
+	}
+
+	void setEnabled( bool enabled );
+
+	bool isRendered() const
+	{
+		return m_valid;
+	}
+
+	//! Starts rendering the pattern in a thread of its own, with the audio
+	//! device stopped, so it's only done when the user asks for it.
+	//! renderFinished() is emitted when it's done. Fails while the song
+	//! plays or gets exported, and for muted or automated patterns.
+	bool render();
+
+	bool isRendering() const
+	{
+		return m_renderer != nullptr;
+	}
+
+	//! Called from BBTrack::play() for every tick of a BB clip in the song.
+	//! Returns true if the cache plays this tick, so the pattern mustn't
+	//! be played live.
+	bool play( const TimePos & start, const TimePos & clipStart,
+			const TimePos & clipLength, f_cnt_t offset );
+
+	//! Changes whenever the repetitions already playing from the cache
+	//! have to stop, e.g. after the play position jumped
+	int generation() const
+	{
+		return m_generation.load( std::memory_order_acquire );
+	}
+
+public slots:
+	void invalidate();
+	//! Stops rendering and waits for the render thread
+	void abortRender();
+
+signals:
+	//! In percent of the pattern
+	void renderProgress( int progress );
+	void renderFinished();
+
+private slots:
+	void finishRender();
+
+private:
+	class Renderer;
+
+	struct TrackCache
+	{
+		Track * track;
+		AudioPort * port;
+		SampleBuffer * buffer;
+	} ;
+
+	static AudioPort * audioPortOf( Track * track );
+	//! Models the port applies live, or which are overridden while rendering
+	static QVector<Model *> ignoredModels( Track * track );
+
+	//! Called by the render thread
+	void renderPattern();
+	void clear();
+	bool isAutomated() const;
+	void watchForChanges();
+
+	BBTrack * m_bbTrack;
+	bool m_enabled;
+
+	// written while the audio engine doesn't render
+	bool m_valid;
+	tick_t m_patternTicks;
+	std::vector<TrackCache> m_caches;
+
+	// only used by play()
+	tick_t m_repetitionStart;
+	tick_t m_lastTick;
+	std::atomic_int m_generation;
+
+	Renderer * m_renderer;
+	std::atomic_bool m_abortRender;
+	// what the render thread works on
+	QVector<Track *> m_renderTracks;
+	tick_t m_renderPatternTicks;
+	std::vector<std::vector<sample_t>> m_renderCaptures;
+	f_cnt_t m_renderFrames;
+	// tracks which were muted while rendering and so weren't recorded
+	QVector<Track *> m_mutedTracks;
+
+	QVector<QMetaObject::Connection> m_connections;
+
+} ;
+
+
+#endif
@@ -31,6 +31,7 @@
 #include <QtCore/QMap>
 
 #include "BBClipView.h"
+#include "BBPatternCache.h"
 #include "Track.h"
 
 class TrackLabelButton;
@@ -74,6 +75,11 @@ public:
 		m_disabledTracks.removeAll( _track );
 	}
 
+	BBPatternCache * patternCache()
+	{
+		return &m_patternCache;
+	}
+
 protected:
 	inline QString nodeName() const override
 	{
@@ -83,6 +89,7 @@ protected:
 
 private:
 	QList<Track *> m_disabledTracks;
+	BBPatternCache m_patternCache;
 
 	typedef QMap<BBTrack *, int> infoMap;
 	static infoMap s_infoMap;
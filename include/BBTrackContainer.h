@@ -61,7 +61,7 @@ public:
 	void fixIncorrectPositions();
 	void createClipsForBB(int bb);
 
-	AutomatedValueMap automatedValuesAt(TimePos time, int clipNum) const override;
+	void collectAutomatedValues(TimePos time, int clipNum, AutomatedValueList & values) const override;
 
 public slots:
 	void play();
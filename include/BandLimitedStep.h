@@ -0,0 +1,79 @@
+/*
+ * BandLimitedStep.h - band-limits the steps of pulse, staircase and other
+ *                     step waveforms
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef BAND_LIMITED_STEP_H
+#define BAND_LIMITED_STEP_H
+
+
+//! Turns a naively rendered step waveform, one whose value only jumps, into
+//! a band-limited one, with a polynomial approximation of a band-limited
+//! step (polyBLEP) for the two samples around every jump. The generator
+//! renders its naive samples as before and reports each jump with
+//! addStep() before passing the first sample after it to tick(). As the
+//! sample before the jump is corrected too, the output is one sample late.
+//! Since the correction is linear, one instance can take the jumps of
+//! several waveforms that are summed up.
+class BandLimitedStep
+{
+public:
+	BandLimitedStep() :
+		m_delayed( 0.0f ),
+		m_current( 0.0f )
+	{
+	}
+
+	//! A jump by @p delta, that happened @p elapsed samples before the next
+	//! sample, which is in [0, 1]
+	void addStep( float elapsed, float delta )
+	{
+		const float remaining = 1.0f - elapsed;
+		m_delayed += 0.5f * delta * elapsed * elapsed;
+		m_current -= 0.5f * delta * remaining * remaining;
+	}
+
+	//! Takes the next naive sample and returns the previous one, corrected
+	float tick( float naive )
+	{
+		const float out = m_delayed;
+		m_delayed = naive + m_current;
+		m_current = 0.0f;
+		return out;
+	}
+
+	void reset()
+	{
+		m_delayed = m_current = 0.0f;
+	}
+
+private:
+	// the previous sample, with the corrections of the jumps around it
+	float m_delayed;
+	// the corrections of the next sample
+	float m_current;
+
+} ;
+
+
+#endif
@@ -35,6 +35,7 @@ class QString;
 #include "lmms_math.h"
 #include "Engine.h"
 #include "AudioEngine.h"
+#include "MemoryManager.h"
 
 constexpr int MAXLEN = 11;
 constexpr int MIPMAPSIZE = 2 << ( MAXLEN + 1 );
@@ -54,7 +55,7 @@ const int TLENS[MAXTBL+1] = { 2 << 0, 3 << 0, 2 << 1, 3 << 1,
 typedef struct
 {
 public:
-	inline sample_t sampleAt( int table, int ph )
+	inline sample_t sampleAt( int table, int ph ) const
 	{
 		if( table % 2 == 0 )
 		{	return m_data[ TLENS[ table ] + ph ]; }
@@ -124,39 +125,40 @@ public:
 	 *  \param _wave The wanted waveform. Options currently are saw, triangle, square and moog saw.
 	 */
 	static inline sample_t oscillate( float _ph, float _wavelen, Waveforms _wave )
+	{
+		return oscillate( s_waveforms[ _wave ], _ph, tableFor( _wavelen ) );
+	};
+
+	/*! \brief This method picks the table of a mipmap to play a wavelength with, the longest one that has
+	 *  no harmonics above the Nyquist frequency. Look it up once and use the other oscillate() if the
+	 *  wavelength doesn't change for many samples.
+	 */
+	static inline int tableFor( float _wavelen )
 	{
 		// get the next higher tlen
 		int t = 0;
 		while( t < MAXTBL && _wavelen >= TLENS[t+1] ) { t++; }
+		return t;
+	}
 
-		int tlen = TLENS[t];
+	/*! \brief This method provides interpolated samples of any mipmap, from the table tableFor() picked.
+	 */
+	static inline sample_t oscillate( const WaveMipMap & _mipmap, float _ph, int _table )
+	{
+		const int tlen = TLENS[_table];
 		const float ph = fraction( _ph );
 		const float lookupf = ph * static_cast<float>( tlen );
 		int lookup = static_cast<int>( lookupf );
 		const float ip = fraction( lookupf );
 
-		const sample_t s1 = s_waveforms[ _wave ].sampleAt( t, lookup );
-		const sample_t s2 = s_waveforms[ _wave ].sampleAt( t, ( lookup + 1 ) % tlen );
+		const sample_t s1 = _mipmap.sampleAt( _table, lookup );
+		const sample_t s2 = _mipmap.sampleAt( _table, ( lookup + 1 ) % tlen );
 
 		const int lm = lookup == 0 ? tlen - 1 : lookup - 1;
-		const sample_t s0 = s_waveforms[ _wave ].sampleAt( t, lm );
-		const sample_t s3 = s_waveforms[ _wave ].sampleAt( t, ( lookup + 2 ) % tlen );
-		const sample_t sr = optimal4pInterpolate( s0, s1, s2, s3, ip );
-
-		return sr;
-
-/*		lookup = lookup << 1;
-		tlen = tlen << 1;
-		t += 1;
-		const sample_t s3 = s_waveforms[ _wave ].sampleAt( t, lookup );
-		const sample_t s4 = s_waveforms[ _wave ].sampleAt( t, ( lookup + 1 ) % tlen );
-		const sample_t s34 = linearInterpolate( s3, s4, ip );
-
-		const float ip2 = ( ( tlen - _wavelen ) / tlen - 0.5 ) * 2.0;
-
-		return linearInterpolate( s12, s34, ip2 );
-	*/
-	};
+		const sample_t s0 = _mipmap.sampleAt( _table, lm );
+		const sample_t s3 = _mipmap.sampleAt( _table, ( lookup + 2 ) % tlen );
+		return optimal4pInterpolate( s0, s1, s2, s3, ip );
+	}
 
 
 	static void generateWaves();
@@ -169,4 +171,33 @@ public:
 };
 
 
+
+/*! \brief Band-limited mipmaps of one cycle of a drawn wave, like the ones BandLimitedWave has for its
+ *  waveforms, for an instrument to share between its voices. Making them takes a few milliseconds, so
+ *  do it when the wave changes and not in the audio thread.
+ */
+class LMMS_EXPORT UserWaveMipMap
+{
+	MM_OPERATORS
+public:
+	/*! \param _cycle _length samples of one cycle, up to half as many harmonics are kept */
+	UserWaveMipMap( const sample_t * _cycle, int _length );
+
+	/*! \brief Like BandLimitedWave::oscillate(), with a phase scale of 0 to 1 */
+	inline sample_t oscillate( float _ph, float _wavelen ) const
+	{
+		return BandLimitedWave::oscillate( m_mipmap, _ph, BandLimitedWave::tableFor( _wavelen ) );
+	}
+
+	/*! \brief With the table BandLimitedWave::tableFor() picked */
+	inline sample_t oscillate( float _ph, int _table ) const
+	{
+		return BandLimitedWave::oscillate( m_mipmap, _ph, _table );
+	}
+
+private:
+	WaveMipMap m_mipmap;
+};
+
+
 #endif
@@ -37,6 +37,11 @@
 #endif
 
 #include <math.h>
+#include <type_traits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "lmms_basics.h"
 #include "lmms_constants.h"
@@ -137,9 +142,116 @@ private:
 	
 	typedef double frame[CHANNELS];
 	frame m_z1, m_z2, m_z3, m_z4;
+
+	template<int LANES> friend class LinkwitzRileyBank; // takes the coefficients
 };
 typedef LinkwitzRiley<2> StereoLinkwitzRiley;
 
+//! LANES independent LinkwitzRiley filters with their own coefficients. All
+//! lanes of a frame are computed at once, with SSE2 two at a time. Each lane
+//! computes exactly what a LinkwitzRiley would.
+template<int LANES>
+class LinkwitzRileyBank
+{
+	MM_OPERATORS
+	static_assert( LANES % 2 == 0, "lanes are computed in pairs" );
+public:
+	LinkwitzRileyBank( float sampleRate ) :
+		m_design( sampleRate )
+	{
+		clearHistory();
+	}
+
+	inline void clearHistory()
+	{
+		for( int i = 0; i < LANES; ++i )
+		{
+			m_z1[i] = m_z2[i] = m_z3[i] = m_z4[i] = 0.0;
+		}
+	}
+
+	inline void setSampleRate( float sampleRate )
+	{
+		m_design.setSampleRate( sampleRate );
+	}
+
+	inline void setLowpass( int lane, float freq )
+	{
+		m_design.setLowpass( freq );
+		setCoeffs( lane );
+	}
+
+	inline void setHighpass( int lane, float freq )
+	{
+		m_design.setHighpass( freq );
+		setCoeffs( lane );
+	}
+
+	//! Filters one frame, @p in and @p out hold a sample for each lane
+	inline void update( const float * in, float * out )
+	{
+#ifdef __SSE2__
+		// two lanes at a time, in the same order of operations as below
+		for( int i = 0; i < LANES; i += 2 )
+		{
+			const __m128d z1 = _mm_loadu_pd( m_z1 + i );
+			const __m128d z2 = _mm_loadu_pd( m_z2 + i );
+			const __m128d z3 = _mm_loadu_pd( m_z3 + i );
+			const __m128d z4 = _mm_loadu_pd( m_z4 + i );
+			const __m128d a0 = _mm_loadu_pd( m_a0 + i );
+			const __m128d a1 = _mm_loadu_pd( m_a1 + i );
+			__m128d x = _mm_cvtps_pd( _mm_castpd_ps( _mm_load_sd( reinterpret_cast<const double *>( in + i ) ) ) );
+			x = _mm_sub_pd( x, _mm_mul_pd( z1, _mm_loadu_pd( m_b1 + i ) ) );
+			x = _mm_sub_pd( x, _mm_mul_pd( z2, _mm_loadu_pd( m_b2 + i ) ) );
+			x = _mm_sub_pd( x, _mm_mul_pd( z3, _mm_loadu_pd( m_b3 + i ) ) );
+			x = _mm_sub_pd( x, _mm_mul_pd( z4, _mm_loadu_pd( m_b4 + i ) ) );
+			__m128d y = _mm_mul_pd( a0, x );
+			y = _mm_add_pd( y, _mm_mul_pd( z1, a1 ) );
+			y = _mm_add_pd( y, _mm_mul_pd( z2, _mm_loadu_pd( m_a2 + i ) ) );
+			y = _mm_add_pd( y, _mm_mul_pd( z3, a1 ) );
+			y = _mm_add_pd( y, _mm_mul_pd( z4, a0 ) );
+			_mm_storeu_pd( m_z4 + i, z3 );
+			_mm_storeu_pd( m_z3 + i, z2 );
+			_mm_storeu_pd( m_z2 + i, z1 );
+			_mm_storeu_pd( m_z1 + i, x );
+			_mm_store_sd( reinterpret_cast<double *>( out + i ), _mm_castps_pd( _mm_cvtpd_ps( y ) ) );
+		}
+#else
+		for( int i = 0; i < LANES; ++i )
+		{
+			const double x = in[i] - ( m_z1[i] * m_b1[i] ) - ( m_z2[i] * m_b2[i] ) -
+				( m_z3[i] * m_b3[i] ) - ( m_z4[i] * m_b4[i] );
+			const double y = ( m_a0[i] * x ) + ( m_z1[i] * m_a1[i] ) + ( m_z2[i] * m_a2[i] ) +
+				( m_z3[i] * m_a1[i] ) + ( m_z4[i] * m_a0[i] );
+			m_z4[i] = m_z3[i];
+			m_z3[i] = m_z2[i];
+			m_z2[i] = m_z1[i];
+			m_z1[i] = x;
+			out[i] = y;
+		}
+#endif
+	}
+
+private:
+	inline void setCoeffs( int lane )
+	{
+		m_a0[lane] = m_design.m_a0;
+		m_a1[lane] = m_design.m_a1;
+		m_a2[lane] = m_design.m_a2;
+		m_b1[lane] = m_design.m_b1;
+		m_b2[lane] = m_design.m_b2;
+		m_b3[lane] = m_design.m_b3;
+		m_b4[lane] = m_design.m_b4;
+	}
+
+	// calculates the coefficients of a lane
+	LinkwitzRiley<1> m_design;
+
+	double m_a0[LANES], m_a1[LANES], m_a2[LANES];
+	double m_b1[LANES], m_b2[LANES], m_b3[LANES], m_b4[LANES];
+	double m_z1[LANES], m_z2[LANES], m_z3[LANES], m_z4[LANES];
+};
+
 template<ch_cnt_t CHANNELS>
 class BiQuad
 {
@@ -175,6 +287,55 @@ public:
 		m_z2[ch] = m_b2 * in - m_a2 * out;
 		return out;
 	}
+	//! Filters @p frames frames of CHANNELS interleaved samples in place,
+	//! like update() for each sample, with the state kept in registers and
+	//! both channels of a stereo frame computed at once with SSE2
+	inline void update( float * buf, fpp_t frames )
+	{
+#ifdef __SSE2__
+		if constexpr( CHANNELS == 2 )
+		{
+			__m128 z1 = _mm_castpd_ps( _mm_load_sd( reinterpret_cast<const double *>( m_z1 ) ) );
+			__m128 z2 = _mm_castpd_ps( _mm_load_sd( reinterpret_cast<const double *>( m_z2 ) ) );
+			const __m128 a1 = _mm_set1_ps( m_a1 ), a2 = _mm_set1_ps( m_a2 );
+			const __m128 b0 = _mm_set1_ps( m_b0 ), b1 = _mm_set1_ps( m_b1 ), b2 = _mm_set1_ps( m_b2 );
+			for( fpp_t f = 0; f < frames; ++f, buf += 2 )
+			{
+				const __m128 in = _mm_castpd_ps( _mm_load_sd( reinterpret_cast<const double *>( buf ) ) );
+				const __m128 out = _mm_add_ps( z1, _mm_mul_ps( b0, in ) );
+				z1 = _mm_sub_ps( _mm_add_ps( _mm_mul_ps( b1, in ), z2 ), _mm_mul_ps( a1, out ) );
+				z2 = _mm_sub_ps( _mm_mul_ps( b2, in ), _mm_mul_ps( a2, out ) );
+				_mm_store_sd( reinterpret_cast<double *>( buf ), _mm_castps_pd( out ) );
+			}
+			_mm_store_sd( reinterpret_cast<double *>( m_z1 ), _mm_castps_pd( z1 ) );
+			_mm_store_sd( reinterpret_cast<double *>( m_z2 ), _mm_castps_pd( z2 ) );
+			return;
+		}
+#endif
+		float z1[CHANNELS], z2[CHANNELS];
+		for( int ch = 0; ch < CHANNELS; ++ch )
+		{
+			z1[ch] = m_z1[ch];
+			z2[ch] = m_z2[ch];
+		}
+		const float a1 = m_a1, a2 = m_a2, b0 = m_b0, b1 = m_b1, b2 = m_b2;
+		for( fpp_t f = 0; f < frames; ++f, buf += CHANNELS )
+		{
+			for( int ch = 0; ch < CHANNELS; ++ch )
+			{
+				const float in = buf[ch];
+				const float out = z1[ch] + b0 * in;
+				z1[ch] = b1 * in + z2[ch] - a1 * out;
+				z2[ch] = b2 * in - a2 * out;
+				buf[ch] = out;
+			}
+		}
+		for( int ch = 0; ch < CHANNELS; ++ch )
+		{
+			m_z1[ch] = z1[ch];
+			m_z2[ch] = z2[ch];
+		}
+	}
 private:
 	float m_a1, m_a2, m_b0, m_b1, m_b2;
 	float m_z1 [CHANNELS], m_z2 [CHANNELS];
@@ -217,6 +378,47 @@ private:
 };
 typedef OnePole<2> StereoOnePole;
 
+//! Table for the exponential the Moog and Tripole filters map their
+//! frequency with in BasicFilters::calcFilterCoeffs(), interpolated
+//! linearly. Its relative error is below 1e-6, arguments outside of it are
+//! computed exactly. The sines and cosines of the other filters aren't
+//! tabulated, a lookup isn't faster than sinf() and cosf().
+class FilterTables
+{
+public:
+	//! e^x, tabulated for x in [0, 2]
+	static inline float exp( float x )
+	{
+		if( !( x >= 0.0f && x <= ExpRange ) )
+		{
+			return expf( x );
+		}
+		const float pos = x * ( ExpSize / ExpRange );
+		const int i = static_cast<int>( pos );
+		return linearInterpolate( s_tables.m_exp[i], s_tables.m_exp[i + 1], pos - i );
+	}
+
+private:
+	static constexpr int ExpSize = 1024;
+	static constexpr float ExpRange = 2.0f;
+
+	FilterTables()
+	{
+		for( int i = 0; i <= ExpSize + 1; ++i )
+		{
+			m_exp[i] = static_cast<float>( ::exp( ExpRange * i / (double) ExpSize ) );
+		}
+	}
+
+	static const FilterTables s_tables;
+
+	// one more entry, so the upper end needs no check
+	float m_exp[ExpSize + 2];
+} ;
+
+inline const FilterTables FilterTables::s_tables;
+
+
 template<ch_cnt_t CHANNELS>
 class BasicFilters
 {
@@ -325,12 +527,44 @@ public:
 			m_delay3[_chnl] = 0.0f;
 			m_delay4[_chnl] = 0.0f;
 		}
+
+		if( m_subFilter )
+		{
+			m_subFilter->clearHistory();
+		}
 	}
 
 	inline sample_t update( sample_t _in0, ch_cnt_t _chnl )
+	{
+		return withType( [&]( auto type )
+		{
+			return updateAs<decltype( type )::value>( _in0, _chnl );
+		} );
+	}
+
+	//! update() for all frames of a buffer, the filter type is only looked
+	//! up once instead of for every sample
+	inline void process( sampleFrame * _buf, const fpp_t _frames )
+	{
+		static_assert( CHANNELS == DEFAULT_CHANNELS, "sample frames are stereo" );
+		withType( [&]( auto type )
+		{
+			for( fpp_t f = 0; f < _frames; ++f )
+			{
+				for( ch_cnt_t ch = 0; ch < CHANNELS; ++ch )
+				{
+					_buf[f][ch] = updateAs<decltype( type )::value>( _buf[f][ch], ch );
+				}
+			}
+		} );
+	}
+
+	//! update() for a filter type known at compile time
+	template<FilterTypes Type>
+	inline sample_t updateAs( sample_t _in0, ch_cnt_t _chnl )
 	{
 		sample_t out;
-		switch( m_type )
+		switch( Type )
 		{
 			case Moog:
 			{
@@ -419,7 +653,7 @@ public:
 				}
 
 				/* mix filter output into output buffer */
-				return m_type == Lowpass_SV 
+				return Type == Lowpass_SV 
 					? m_delay4[_chnl]
 					: m_delay3[_chnl];
 			}
@@ -506,7 +740,7 @@ public:
 					m_rchp0[_chnl] = hp;
 					m_rcbp0[_chnl] = bp;
 				}
-				return m_type == Highpass_RC12 ? hp : bp;
+				return Type == Highpass_RC12 ? hp : bp;
 			}
 
 			case Lowpass_RC24:
@@ -573,7 +807,7 @@ public:
 					m_rcbp0[_chnl] = bp;
 
 					// second stage gets the output of the first stage as input...
-					in = m_type == Highpass_RC24
+					in = Type == Highpass_RC24
 						? hp + m_rcbp1[_chnl] * m_rcq
 						: bp + m_rcbp1[_chnl] * m_rcq;
 
@@ -589,7 +823,7 @@ public:
 					m_rchp1[_chnl] = hp;
 					m_rcbp1[_chnl] = bp;
 				}
-				return m_type == Highpass_RC24 ? hp : bp;
+				return Type == Highpass_RC24 ? hp : bp;
 			}
 
 			case Formantfilter:
@@ -599,7 +833,7 @@ public:
 				sample_t hp, bp, in;
 
 				out = 0;
-				const int os = m_type == FastFormant ? 1 : 4; // no oversampling for fast formant
+				const int os = Type == FastFormant ? 1 : 4; // no oversampling for fast formant
 				for( int o = 0; o < os; ++o )
 				{
 					// first formant
@@ -686,7 +920,7 @@ public:
 
 					out += bp;
 				}
-            	return m_type == FastFormant ? out * 2.0f : out * 0.5f;
+            	return Type == FastFormant ? out * 2.0f : out * 0.5f;
 			}
 
 			default:
@@ -696,7 +930,7 @@ public:
 
 		if( m_doubleFilter )
 		{
-			return m_subFilter->update( out, _chnl );
+			return m_subFilter->template updateAs<Type>( out, _chnl );
 		}
 
 		// Clipper band limited sigmoid
@@ -774,7 +1008,7 @@ public:
 			// (Empirical tunning)
 			m_p = ( 3.6f - 3.2f * f ) * f;
 			m_k = 2.0f * m_p - 1;
-			m_r = _q * powf( F_E, ( 1 - m_p ) * 1.386249f );
+			m_r = _q * FilterTables::exp( ( 1 - m_p ) * 1.386249f );
 
 			if( m_doubleFilter )
 			{
@@ -791,7 +1025,7 @@ public:
 			
 			m_p = ( 3.6f - 3.2f * f ) * f;
 			m_k = 2.0f * m_p - 1.0f;
-			m_r = _q * 0.1f * powf( F_E, ( 1 - m_p ) * 1.386249f );
+			m_r = _q * 0.1f * FilterTables::exp( ( 1 - m_p ) * 1.386249f );
 			
 			return;
 		}
@@ -871,6 +1105,31 @@ public:
 
 
 private:
+	//! Calls @p f with the filter type as std::integral_constant, so the
+	//! type is known at compile time in there. All biquads share the code.
+	template<typename F>
+	inline auto withType( F f )
+	{
+		switch( m_type )
+		{
+			case Moog: return f( std::integral_constant<FilterTypes, Moog>() );
+			case Tripole: return f( std::integral_constant<FilterTypes, Tripole>() );
+			case Lowpass_SV: return f( std::integral_constant<FilterTypes, Lowpass_SV>() );
+			case Bandpass_SV: return f( std::integral_constant<FilterTypes, Bandpass_SV>() );
+			case Highpass_SV: return f( std::integral_constant<FilterTypes, Highpass_SV>() );
+			case Notch_SV: return f( std::integral_constant<FilterTypes, Notch_SV>() );
+			case Lowpass_RC12: return f( std::integral_constant<FilterTypes, Lowpass_RC12>() );
+			case Bandpass_RC12: return f( std::integral_constant<FilterTypes, Bandpass_RC12>() );
+			case Highpass_RC12: return f( std::integral_constant<FilterTypes, Highpass_RC12>() );
+			case Lowpass_RC24: return f( std::integral_constant<FilterTypes, Lowpass_RC24>() );
+			case Bandpass_RC24: return f( std::integral_constant<FilterTypes, Bandpass_RC24>() );
+			case Highpass_RC24: return f( std::integral_constant<FilterTypes, Highpass_RC24>() );
+			case Formantfilter: return f( std::integral_constant<FilterTypes, Formantfilter>() );
+			case FastFormant: return f( std::integral_constant<FilterTypes, FastFormant>() );
+			default: return f( std::integral_constant<FilterTypes, LowPass>() );
+		}
+	}
+
 	// biquad filter
 	BiQuad<CHANNELS> m_biQuad;
 
@@ -0,0 +1,45 @@
+/*
+ * BinaryDocument.h - compact binary encoding of project documents
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef BINARY_DOCUMENT_H
+#define BINARY_DOCUMENT_H
+
+#include <QByteArray>
+#include <QDomDocument>
+
+#include "lmms_export.h"
+
+//! The DOM of a document without XML text. Tag and attribute names are
+//! stored once, attribute values as numbers wherever printing the number
+//! gives back the same text, and runs of sibling elements with the same
+//! tag and attributes and no children, like notes and automation nodes,
+//! as one typed array per attribute. Decoding gives back the same DOM.
+namespace BinaryDocument
+{
+	QByteArray LMMS_EXPORT encode(const QDomDocument & document);
+	//! Replaces @p document, returns false if @p data is broken
+	bool LMMS_EXPORT decode(const QByteArray & data, QDomDocument & document);
+}
+
+#endif
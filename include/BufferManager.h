@@ -28,10 +28,16 @@
 
 #include "lmms_export.h"
 #include "lmms_basics.h"
+#include "PlanarBuffer.h"
 
+//! Pool of period buffers, aligned to cache lines. Every thread keeps a
+//! few released buffers for itself and shares the rest with the others,
+//! so acquiring and releasing them rarely allocates or waits.
 class LMMS_EXPORT BufferManager
 {
 public:
+	//! Starts over with buffers of @p framesPerPeriod frames. Those of
+	//! the previous size are freed as they are released.
 	static void init( fpp_t framesPerPeriod );
 	static sampleFrame * acquire();
 	// audio-buffer-mgm
@@ -42,6 +48,14 @@ public:
 						const f_cnt_t offset = 0 );
 #endif
 	static void release( sampleFrame * buf );
+
+	//! Buffers allocated, in use or kept by the pool
+	static size_t allocated();
+
+	// planar buffers of one period
+	static PlanarBuffer acquirePlanar();
+	static void clear( const PlanarBuffer & buf );
+	static void release( PlanarBuffer & buf );
 };
 
 #endif
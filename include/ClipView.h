@@ -27,6 +27,7 @@
 
 
 #include <QtCore/QVector>
+#include <QPixmap>
 
 #include "ModelView.h"
 #include "Rubberband.h"
@@ -125,6 +126,7 @@ public slots:
 	virtual bool close();
 	void remove();
 	void update() override;
+	void updateLength();
 
 	void selectColor();
 	void randomizeColor();
@@ -148,6 +150,9 @@ protected:
 	bool m_marker = false;
 	int m_markerPos = 0;
 
+	//! What the view painted last time, dropped while it's hidden
+	QPixmap m_paintPixmap;
+
 	virtual void constructContextMenu( QMenu * )
 	{
 	}
@@ -164,6 +169,7 @@ protected:
 		m_needsUpdate = true;
 		selectableObject::resizeEvent( re );
 	}
+	void hideEvent( QHideEvent * he ) override;
 
 	bool unquantizedModHeld( QMouseEvent * me );
 	TimePos quantizeSplitPos( TimePos, bool shiftMode );
@@ -177,7 +183,6 @@ protected:
 
 
 protected slots:
-	void updateLength();
 	void updatePosition();
 
 
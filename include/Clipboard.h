@@ -25,9 +25,13 @@
 #ifndef CLIPBOARD_H
 #define CLIPBOARD_H
 
+#include <memory>
+
 #include <QtCore/QMap>
 #include <QDomElement>
 
+#include "DataFile.h"
+
 class QMimeData;
 
 namespace Clipboard
@@ -38,6 +42,38 @@ namespace Clipboard
 		Default
 	};
 
+	//! Content that is pasted as it is within this instance. Its text is
+	//! only written once another application or instance asks for it.
+	class Payload
+	{
+	public:
+		virtual ~Payload() = default;
+		virtual QString toString() const = 0;
+	} ;
+
+	//! Payload of a data file, which is pasted without parsing it again
+	class DataFilePayload : public Payload
+	{
+	public:
+		DataFilePayload( const DataFile & dataFile ) :
+			m_dataFile( dataFile )
+		{
+		}
+
+		const DataFile & dataFile() const
+		{
+			return m_dataFile;
+		}
+
+		QString toString() const override
+		{
+			return m_dataFile.toString();
+		}
+
+	private:
+		DataFile m_dataFile;
+	} ;
+
 	// Convenience Methods
 	const QMimeData * getMimeData();
 	bool hasFormat( MimeType mT );
@@ -51,6 +87,12 @@ namespace Clipboard
 	QString decodeKey( const QMimeData * mimeData );
 	QString decodeValue( const QMimeData * mimeData );
 
+	// Helper methods for payloads, see Payload
+	void copyPayload( std::unique_ptr<Payload> payload, MimeType mT );
+	void copyPayloadPair( const QString & key, std::unique_ptr<Payload> payload );
+	//! The payload of @p mimeData if this instance copied one, or nullptr
+	const Payload * getPayload( const QMimeData * mimeData );
+
 	inline const char * mimeType( MimeType type )
 	{
 		switch( type )
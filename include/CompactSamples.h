@@ -0,0 +1,82 @@
+/*
+ * CompactSamples.h - sample frames stored at the bit depth of their file
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef COMPACT_SAMPLES_H
+#define COMPACT_SAMPLES_H
+
+#include <cstdint>
+
+#include "lmms_basics.h"
+#include "MemoryManager.h"
+
+
+//! Frames of a sample kept as 16 or 24 bit integers and with the file's
+//! channel count, for a half to a sixth of the memory float stereo frames
+//! take. Converted back to float while playing.
+class CompactSamples
+{
+	MM_OPERATORS
+public:
+	enum class Format
+	{
+		Int16,
+		Int24
+	} ;
+
+	//! Quantizes @p frames frames of @p data. With one channel, only the
+	//! left one is kept and played on both.
+	CompactSamples(const sampleFrame * data, f_cnt_t frames, Format format, ch_cnt_t channels);
+	CompactSamples(const CompactSamples & other);
+	~CompactSamples();
+
+	CompactSamples & operator=(const CompactSamples &) = delete;
+
+	f_cnt_t frames() const
+	{
+		return m_frames;
+	}
+
+	size_t bytes() const
+	{
+		return static_cast<size_t>(m_frames) * m_frameBytes;
+	}
+
+	//! Converts @p count frames starting at @p index into @p dst
+	void read(sampleFrame * dst, f_cnt_t index, f_cnt_t count) const;
+
+	//! Converts @p count frames from @p index backwards into @p dst
+	void readBackwards(sampleFrame * dst, f_cnt_t index, f_cnt_t count) const;
+
+	void reverse();
+
+private:
+	const Format m_format;
+	const ch_cnt_t m_channels;
+	const f_cnt_t m_frames;
+	const int m_frameBytes;
+	uint8_t * m_data;
+} ;
+
+
+#endif
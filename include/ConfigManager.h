@@ -73,6 +73,9 @@ public:
 		return m_workingDir;
 	}
 
+	//! Directory of the configuration file, with a trailing slash
+	QString configDir() const;
+
 	void initPortableWorkingDir();
 
 	void initInstalledWorkingDir();
@@ -206,6 +209,21 @@ public:
 		return m_workingDir + "recover.mmp";
 	}
 
+	const QString pluginCacheFile() const
+	{
+		return m_workingDir + "plugincache.xml";
+	}
+
+	const QString ladspaCacheFile() const
+	{
+		return m_workingDir + "ladspacache.xml";
+	}
+
+	const QString lv2CacheFile() const
+	{
+		return m_workingDir + "lv2cache.xml";
+	}
+
 	inline const QStringList & recentlyOpenedProjects() const
 	{
 		return m_recentlyOpenedProjects;
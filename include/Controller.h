@@ -27,6 +27,12 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include <QtCore/QMutex>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "lmms_export.h"
 #include "Engine.h"
 #include "Model.h"
@@ -66,6 +72,11 @@ public:
 	// The per-controller get-value-in-buffers function
 	virtual ValueBuffer * valueBuffer();
 
+	//! valueBuffer() mapped onto [min, max], linearly or logarithmically.
+	//! Computed once per period for each mapping and shared by all models
+	//! which use the same one.
+	ValueBuffer * scaledValueBuffer( bool logarithmic, float min, float max );
+
 	inline bool isSampleExact() const
 	{
 		return m_sampleExact;
@@ -151,10 +162,26 @@ protected:
 	// again every time
 	ValueBuffer m_valueBuffer;
 	// when we last updated the valuebuffer - so we know if we have to update it
-	long m_bufferLastUpdated;
+	std::atomic<long> m_bufferLastUpdated;
+	// the first of the threads wanting the value of a period updates the
+	// buffer, the others wait for it and share it
+	QMutex m_valueBufferMutex;
 
 	float m_currentValue;
 	bool  m_sampleExact;
+
+	struct ScaledBuffer
+	{
+		bool logarithmic;
+		float min;
+		float max;
+		long lastUpdated;
+		ValueBuffer buffer;
+	} ;
+	// never shrinks, so the buffers handed out stay valid
+	std::vector<std::unique_ptr<ScaledBuffer>> m_scaledBuffers;
+	QMutex m_scaledBuffersMutex;
+
 	int m_connectionCount;
 
 	QString m_name;
@@ -0,0 +1,228 @@
+/*
+ * Convolver.h - partitioned FFT convolution with impulse responses
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef CONVOLVER_H
+#define CONVOLVER_H
+
+#include <memory>
+
+#include <QObject>
+#include <QString>
+
+#include <fftw3.h>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+
+
+struct FftwDeleter
+{
+	void operator()( void * p ) const
+	{
+		fftwf_free( p );
+	}
+} ;
+
+//! An array allocated with fftwf_malloc(), aligned for FFTW's SIMD code
+template<typename T>
+using FftwArray = std::unique_ptr<T[], FftwDeleter>;
+
+
+//! The spectra of a stereo impulse response, cut into the partitions a
+//! Convolver runs with. The first tailBlockSize() frames of the response
+//! are cut into partitions of blockSize() frames, which are convolved with
+//! each block as it comes in, so there's no latency. The rest is cut into
+//! partitions of tailBlockSize() frames, which are convolved once such a
+//! block of input is complete and it's played over the next one.
+//! Kernels are immutable and shared by all convolvers of the same file,
+//! sample rate and block size.
+class LMMS_EXPORT ConvolutionKernel
+{
+public:
+	using Ptr = std::shared_ptr<const ConvolutionKernel>;
+
+	//! Transforms @p frames frames of @p ir for blocks of @p blockSize
+	//! frames. Plans FFTs, so it must not run in the audio thread.
+	ConvolutionKernel( const sampleFrame * ir, f_cnt_t frames, fpp_t blockSize );
+
+	//! Returns the kernel of @p file at the engine's sample rate, shared
+	//! with other convolvers, or nullptr if the file can't be loaded.
+	//! Decodes and transforms the file if no kernel of it is in use, so
+	//! it's best called from a worker thread, see ConvolverLoader.
+	static Ptr load( const QString & file, fpp_t blockSize );
+
+	fpp_t blockSize() const
+	{
+		return m_blockSize;
+	}
+
+	fpp_t tailBlockSize() const
+	{
+		return m_tailBlockSize;
+	}
+
+	int headPartitions() const
+	{
+		return m_headPartitions;
+	}
+
+	int tailPartitions() const
+	{
+		return m_tailPartitions;
+	}
+
+	//! The bins from one spectrum of partitions of @p size frames to the
+	//! next, padded to keep each aligned for FFTW's SIMD code. Partitions
+	//! are transformed with twice their size, which gives size + 1 bins.
+	static int binStride( fpp_t size )
+	{
+		return ( size + 8 ) / 8 * 8;
+	}
+
+	//! blockSize() + 1 bins, scaled for the inverse transform
+	const fftwf_complex * headPartition( int partition, ch_cnt_t ch ) const
+	{
+		return m_head.get() + ( partition * DEFAULT_CHANNELS + ch ) * binStride( m_blockSize );
+	}
+
+	//! tailBlockSize() + 1 bins, scaled for the inverse transform
+	const fftwf_complex * tailPartition( int partition, ch_cnt_t ch ) const
+	{
+		return m_tail.get() + ( partition * DEFAULT_CHANNELS + ch ) * binStride( m_tailBlockSize );
+	}
+
+private:
+	static void transform( const sampleFrame * ir, f_cnt_t frames,
+				fpp_t partitionSize, int partitions, fftwf_complex * out );
+
+	fpp_t m_blockSize;
+	fpp_t m_tailBlockSize;
+	int m_headPartitions;
+	int m_tailPartitions;
+	FftwArray<fftwf_complex> m_head;
+	FftwArray<fftwf_complex> m_tail;
+} ;
+
+
+
+
+//! Convolves a stereo signal with a ConvolutionKernel, each channel with
+//! the same channel of the impulse response, without latency. Most of the
+//! tail is accumulated a bit with each block, but its transforms are done
+//! for a whole tail block at once, every tailBlockSize() / blockSize()
+//! blocks.
+class LMMS_EXPORT Convolver
+{
+public:
+	//! Allocates all buffers and plans the FFTs, so it must not run in the
+	//! audio thread
+	explicit Convolver( ConvolutionKernel::Ptr kernel );
+
+	Convolver( const Convolver & ) = delete;
+	Convolver & operator=( const Convolver & ) = delete;
+
+	const ConvolutionKernel & kernel() const
+	{
+		return *m_kernel;
+	}
+
+	fpp_t blockSize() const
+	{
+		return m_kernel->blockSize();
+	}
+
+	//! Writes the convolution of @p frames frames of @p in to @p out,
+	//! which may be the same. @p frames must be a multiple of blockSize().
+	void process( const sampleFrame * in, sampleFrame * out, fpp_t frames );
+
+	//! Silences everything that is still ringing
+	void clear();
+
+private:
+	void processBlock( const sampleFrame * in, sampleFrame * out );
+	void accumulateTail( int firstPartition, int lastPartition );
+	void finishTailBlock();
+
+	ConvolutionKernel::Ptr m_kernel;
+
+	// the last two blocks of input of each channel
+	FftwArray<float> m_headWindow;
+	// the spectra of the last headPartitions() blocks of each channel
+	FftwArray<fftwf_complex> m_headHistory;
+	int m_headPosition;
+	FftwArray<fftwf_complex> m_headSpectrum;
+	FftwArray<float> m_headOutput;
+	fftwf_plan m_headForward;
+	fftwf_plan m_headBackward;
+
+	// the same for the tail, which also keeps the output of the last tail
+	// block to be played over the current one
+	FftwArray<float> m_tailWindow;
+	FftwArray<fftwf_complex> m_tailHistory;
+	int m_tailPosition;
+	FftwArray<fftwf_complex> m_tailSpectrum;
+	FftwArray<float> m_tailOutput;
+	FftwArray<float> m_tailScratch;
+	fftwf_plan m_tailForward;
+	fftwf_plan m_tailBackward;
+	// blocks of the current tail block that went in
+	int m_tailStep;
+} ;
+
+
+
+
+//! Loads ConvolutionKernels and their Convolvers on a thread pool, so the
+//! GUI doesn't wait for the decoding and transforming of large files.
+//! Lives in the GUI thread, where loaded() is emitted.
+class LMMS_EXPORT ConvolverLoader : public QObject
+{
+	Q_OBJECT
+public:
+	struct Request;
+
+	ConvolverLoader();
+	~ConvolverLoader() override;
+
+	//! Starts loading @p file for blocks of @p blockSize frames. The
+	//! results of earlier loads that are still running are dropped.
+	void load( const QString & file, fpp_t blockSize );
+
+	//! Returns the convolver of the last load, once loaded() was emitted,
+	//! or nullptr if the file couldn't be loaded
+	std::unique_ptr<Convolver> take();
+
+signals:
+	void loaded();
+
+private slots:
+	void finish();
+
+private:
+	std::shared_ptr<Request> m_request;
+	std::unique_ptr<Convolver> m_convolver;
+} ;
+
+
+#endif
@@ -28,12 +28,15 @@
 #define DATA_FILE_H
 
 #include <map>
+#include <memory>
 #include <QDomDocument>
+#include <QHash>
 
 #include "lmms_export.h"
 #include "MemoryManager.h"
 #include "ProjectVersion.h"
 
+class QFile;
 class QTextStream;
 
 class LMMS_EXPORT DataFile : public QDomDocument
@@ -61,9 +64,13 @@ public:
 	DataFile( const QString& fileName );
 	DataFile( const QByteArray& data );
 	DataFile( Type type );
+	DataFile( const DataFile & other );
 
 	virtual ~DataFile();
 
+	//! A copy with a document of its own, which copies otherwise share
+	DataFile clone() const;
+
 	///
 	/// \brief validate
 	/// performs basic validation, compared to file extension.
@@ -74,6 +81,9 @@ public:
 
 	void write( QTextStream& strm );
 	bool writeFile(const QString& fn, bool withResources = false);
+	//! Writes the project as binary archive and replaces @p fn with it
+	//! at once. Shows no errors, so it can be called from any thread.
+	bool writeArchive(const QString& fn);
 	bool copyResources(const QString& resourcesDir); //!< Copies resources to the resourcesDir and changes the DataFile to use local paths to them
 	bool hasLocalPlugins(QDomElement parent = QDomElement(), bool firstCall = true) const;
 
@@ -94,6 +104,20 @@ public:
 
 	unsigned int legacyFileVersion();
 
+	//! Returns what to store in an attribute of @p doc instead of @p data.
+	//! Projects written as archives (.mmpz) keep it in an entry of its own
+	//! next to the XML, which is read without decoding when loading, while
+	//! anything else gets it base64 encoded.
+	static QString embed( QDomDocument & doc, const QByteArray & data );
+	//! The data stored into @p attribute of @p element by embed()
+	static QByteArray embedded( const QDomElement & element, const QString & attribute );
+	//! Makes what was embed()ded into @p other available to the elements
+	//! imported from it. Has to be called before anything is embedded here.
+	void embedFrom( const DataFile & other );
+
+	//! The XML of a project file's contents, whatever the format
+	static QByteArray projectXml( const QByteArray & data );
+
 private:
 	static Type type( const QString& typeName );
 	static QString typeName( Type type );
@@ -137,6 +161,16 @@ private:
 
 	void loadData( const QByteArray & _data, const QString & _sourceFile );
 
+	// project archives: a table of entries, then the entries, each aligned
+	// so that they can be read straight from the mapped file
+	static bool isArchive( const QByteArray & data );
+	static QHash<QString, QByteArray> archiveEntries( const QByteArray & archive );
+	//! Whether the document is stored as a BinaryDocument instead of XML
+	static bool isBinaryArchive( const QHash<QString, QByteArray> & entries );
+	QByteArray archive( bool binary = false );
+	//! Replaces references to embedded data by the base64 encoded data
+	void inlineEmbedded( QDomElement element );
+
 
 	struct LMMS_EXPORT typeDescStruct
 	{
@@ -145,12 +179,20 @@ private:
 	} ;
 	static typeDescStruct s_types[TypeCount];
 
+	friend class DataFileStream;
+
 	QString m_fileName; //!< The origin file name or "" if this DataFile didn't originate from a file
 	QDomElement m_content;
 	QDomElement m_head;
 	Type m_type;
 	unsigned int m_fileVersion;
 
+	// what was embed()ded, or the entries of the archive loaded, which
+	// point into m_archiveFile's mapping or m_archiveData
+	QHash<QString, QByteArray> m_embedded;
+	std::shared_ptr<QFile> m_archiveFile;
+	QByteArray m_archiveData;
+
 } ;
 
 
@@ -0,0 +1,132 @@
+/*
+ * DataFileStream.h - reads a project one element at a time
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef DATA_FILE_STREAM_H
+#define DATA_FILE_STREAM_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QDomElement>
+#include <QXmlStreamAttributes>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+#include "lmms_export.h"
+
+class DataFile;
+
+
+//! Reads a song project without building the DOM of the whole file. The
+//! elements below the content are visited one at a time, and each one is
+//! parsed into a DataFile of its own only when asked for, which is dropped
+//! when moving on. So the SerializingObjects loading them keep their
+//! DOM-based API, while only one subtree is in memory besides the XML.
+//! The subtrees are wrapped into their ancestors, without their siblings,
+//! so that loaders looking at parent nodes still find them.
+class LMMS_EXPORT DataFileStream
+{
+public:
+	//! Only isValid() if @p fileName is a well-formed song project or
+	//! template which doesn't need DataFile's upgrades
+	explicit DataFileStream(const QString & fileName);
+	~DataFileStream();
+
+	bool isValid() const
+	{
+		return m_header != nullptr;
+	}
+
+	//! The root and head elements of the file, with an empty content
+	DataFile & header()
+	{
+		return *m_header;
+	}
+
+	//! Same as DataFile::hasLocalPlugins() for the whole file
+	bool hasLocalPlugins() const
+	{
+		return m_hasLocalPlugins;
+	}
+
+	//! How many @p name elements with a @p parentName parent the file holds
+	int count(const QString & name, const QString & parentName) const;
+	//! Calls @p func for every element of the file, without building any DOM
+	void forEachElement(const std::function<void(const QString & name,
+		const QXmlStreamAttributes & attributes)> & func) const;
+
+	//! Moves to the next child element of the content, or of the element
+	//! entered last. Returns false after its last child, which leaves it.
+	bool next();
+	//! Of the element next() moved to
+	QString name() const;
+	//! The element next() moved to with everything below it. It belongs
+	//! to a DataFile, which is dropped by the next call of next().
+	QDomElement element();
+	//! Makes next() visit the children of the element it moved to. Returns
+	//! that element with its attributes only, valid until it's left.
+	QDomElement enter();
+	//! Skips the rest of the element entered last
+	void leave();
+	//! Starts over before the content's first child
+	void rewind();
+
+private:
+	struct Ancestor
+	{
+		QString name;
+		QXmlStreamAttributes attributes;
+		std::unique_ptr<DataFile> shell;
+	} ;
+
+	//! Moves m_reader onto the content element. Writes the root and the
+	//! head element into @p header, if given.
+	bool findContent(QXmlStreamWriter * header);
+	//! Parses the ancestors, and the element m_reader is at if @p withElement
+	std::unique_ptr<DataFile> parse(bool withElement, QDomElement & element);
+	std::unique_ptr<DataFile> fragment(const QByteArray & xml) const;
+
+	QByteArray m_xml;
+	// reads m_xml without the reader copying it
+	QBuffer m_buffer;
+	QXmlStreamReader m_reader;
+	std::unique_ptr<DataFile> m_header;
+	bool m_hasLocalPlugins;
+
+	QString m_rootName;
+	QXmlStreamAttributes m_rootAttributes;
+	QString m_contentName;
+	QXmlStreamAttributes m_contentAttributes;
+
+	std::vector<Ancestor> m_entered;
+	bool m_atElement;
+	bool m_atEnd;
+	std::unique_ptr<DataFile> m_element;
+} ;
+
+
+#endif
@@ -35,7 +35,8 @@ class QString;
 class DrumSynth {
     public:
         DrumSynth() {};
-        int GetDSFileSamples(QString dsfile, int16_t *&wave, int channels, sample_rate_t Fs);
+        //output is float, full scale at +-1, before the 16 bit clipping point
+        int GetDSFileSamples(QString dsfile, float *&wave, int channels, sample_rate_t Fs);
 
     private:
         float LoudestEnv(void);
@@ -26,12 +26,16 @@
 #ifndef EFFECT_H
 #define EFFECT_H
 
+#include <memory>
+
 #include "Plugin.h"
 #include "Engine.h"
 #include "AudioEngine.h"
 #include "AutomatableModel.h"
+#include "ComboBoxModel.h"
 #include "TempoSyncKnobModel.h"
 #include "MemoryManager.h"
+#include "Oversampler.h"
 
 class EffectChain;
 class EffectControls;
@@ -59,6 +63,38 @@ public:
 	virtual bool processAudioBuffer( sampleFrame * _buf,
 						const fpp_t _frames ) = 0;
 
+	// true for PlanarEffect, which effect chains then pass planar buffers
+	virtual bool processesPlanar() const
+	{
+		return false;
+	}
+
+	// true for effects which can run oversampled. They must take their
+	// sample rate from sampleRate() and update it on sampleRateChanged().
+	virtual bool supportsOversampling() const
+	{
+		return false;
+	}
+
+	//! Rate the effect processes at, the processing rate times the
+	//! oversampling factor
+	inline sample_rate_t sampleRate() const
+	{
+		return Engine::audioEngine()->processingSampleRate() * m_oversamplingFactor;
+	}
+
+	inline int oversamplingFactor() const
+	{
+		return m_oversamplingFactor;
+	}
+
+	//! Frames the oversampling delays the output by, effects delaying
+	//! it themselves add theirs
+	virtual f_cnt_t latency() const
+	{
+		return m_oversampler ? m_oversampler->latency() : 0;
+	}
+
 	inline ch_cnt_t processorCount() const
 	{
 		return m_processors;
@@ -89,6 +125,10 @@ public:
 	{ 
 		m_bufferCount = 0;
 		m_running = true; 
+		if( m_oversampler )
+		{
+			m_oversampler->reset();
+		}
 	}
 
 	inline void stopRunning()
@@ -103,10 +143,17 @@ public:
 
 	inline f_cnt_t timeout() const
 	{
-		const float samples = Engine::audioEngine()->processingSampleRate() * m_autoQuitModel.value() / 1000.0f;
+		// oversampled effects process a period in several calls
+		const float samples = sampleRate() * m_autoQuitModel.value() / 1000.0f;
 		return 1 + ( static_cast<int>( samples ) / Engine::audioEngine()->framesPerPeriod() );
 	}
 
+	//! Whether the user wants effects to keep running without input
+	inline bool autoQuitDisabled() const
+	{
+		return m_autoQuitDisabled;
+	}
+
 	inline float wetLevel() const
 	{
 		return m_wetDryModel.value();
@@ -160,6 +207,11 @@ public:
 				Descriptor::SubPluginFeatures::Key * _key );
 
 
+signals:
+	//! Emitted when the processing rate or the oversampling factor changed
+	void sampleRateChanged();
+
+
 protected:
 	/**
 		Effects should call this at the end of audio processing
@@ -196,7 +248,13 @@ protected:
 	void reinitSRC();
 
 
+private slots:
+	void updateOversampling();
+
 private:
+	// passes the buffer through processAudioBuffer(), oversampled if set up
+	bool processOversampled( sampleFrame * _buf, const fpp_t _frames );
+
 	EffectChain * m_parent;
 	void resample( int _i, const sampleFrame * _src_buf,
 					sample_rate_t _src_sr,
@@ -214,6 +272,10 @@ private:
 	FloatModel m_wetDryModel;
 	FloatModel m_gateModel;
 	TempoSyncKnobModel m_autoQuitModel;
+	ComboBoxModel m_oversamplingModel;
+
+	std::unique_ptr<Oversampler> m_oversampler;
+	int m_oversamplingFactor;
 	
 	bool m_autoQuitDisabled;
 
@@ -26,9 +26,13 @@
 #ifndef EFFECT_CHAIN_H
 #define EFFECT_CHAIN_H
 
+#include <atomic>
+
 #include "Model.h"
 #include "SerializingObject.h"
 #include "AutomatableModel.h"
+#include "PlanarBuffer.h"
+#include "RenderSnapshot.h"
 
 class Effect;
 
@@ -53,19 +57,76 @@ public:
 	void moveDown( Effect * _effect );
 	void moveUp( Effect * _effect );
 	bool processAudioBuffer( sampleFrame * _buf, const fpp_t _frames, bool hasInputNoise );
+
+	//! Wakes the effects up in the next processAudioBuffer(). Doesn't touch
+	//! the effect list, so it may be called outside the render grace period.
 	void startRunning();
 
+	//! Whether processAudioBuffer() would write to a silent buffer. Any
+	//! thread, it doesn't touch the effect list either.
+	bool hasRunningEffects() const
+	{
+		return m_enabledModel.value() && !isSleeping() &&
+			( m_wakeRequested.load( std::memory_order_acquire ) ||
+				m_running.load( std::memory_order_relaxed ) );
+	}
+
+	//! Whether the chain is asleep, because its output decayed without
+	//! input. No effect is called until there's input again. Any thread.
+	bool isSleeping() const
+	{
+		return m_sleeping.load( std::memory_order_relaxed );
+	}
+
+	//! Frames the effects delay the signal by, e.g. by oversampling
+	f_cnt_t latency() const;
+
+	//! Frames the output can still be heard after the input, going by the
+	//! decays of the enabled effects
+	f_cnt_t tailLength() const;
+
+	//! Whether processAudioBuffer() may change the buffer at all
+	bool isEnabled() const
+	{
+		return m_enabledModel.value();
+	}
+
 	void clear();
 
 
 private:
 	typedef QVector<Effect *> EffectList;
+
+	//! Hand the current m_effects to the audio thread; with @p waitForRender
+	//! set, only return once it can't be using removed effects any more
+	void publishEffects( bool waitForRender = false );
+
+	//! Whether the chain's output stayed below the gates of all running
+	//! effects for the longest of their decays, from one pass over @p buf
+	bool outputDecayed( const EffectList & effects, const sampleFrame * buf, fpp_t frames );
+
+	// m_effects belongs to the model side, the audio thread only reads the
+	// published copy in m_renderEffects
 	EffectList m_effects;
+	RenderSnapshot<EffectList> m_renderEffects;
 
 	BoolModel m_enabledModel;
 
+	// the audio while it's passed between planar effects
+	PlanarBuffer m_planarBuffer;
+
+	// periods the output was below the gates, only used by the audio thread
+	f_cnt_t m_quietPeriods;
+	std::atomic<bool> m_sleeping;
+	// set by startRunning(), handled by the next processAudioBuffer()
+	std::atomic<bool> m_wakeRequested;
+	// whether an effect was still running after the last
+	// processAudioBuffer()
+	std::atomic<bool> m_running;
+
 
 	friend class EffectRackView;
+	friend class MemoryReport;
 
 
 signals:
@@ -49,6 +49,7 @@ public:
 protected slots:
 	void acceptSelection();
 	void rowChanged( const QModelIndex &, const QModelIndex & );
+	void setFilter( const QString & filter );
 	void sortAgain();
 	void updateSelection();
 
@@ -56,10 +57,10 @@ protected slots:
 private:
 	Ui::EffectSelectDialog * ui;
 
-	EffectKeyList m_effectKeys;
+	//! Shared by all dialogs, in the order of the source model's rows
+	const EffectKeyList & m_effectKeys;
 	EffectKey m_currentSelection;
 
-	QStandardItemModel m_sourceModel;
 	QSortFilterProxyModel m_model;
 	QWidget * m_descriptionWidget;
 
@@ -80,6 +80,9 @@ protected:
 
 
 private:
+	//! Creates the control dialog and its subwindow, hidden
+	void createControlView();
+
 	QPixmap m_bg;
 	LedCheckBox * m_bypass;
 	Knob * m_wetDry;
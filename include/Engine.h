@@ -58,7 +58,8 @@ class LMMS_EXPORT LmmsCore : public QObject
 {
 	Q_OBJECT
 public:
-	static void init( bool renderOnly );
+	//! renderFramesPerPeriod, renderThreads: see AudioEngine::AudioEngine()
+	static void init( bool renderOnly, fpp_t renderFramesPerPeriod = 0, int renderThreads = 0 );
 	static void destroy();
 
 	// core
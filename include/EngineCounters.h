@@ -0,0 +1,128 @@
+/*
+ * EngineCounters.h - counters of the engine's hot paths, cheap enough to be
+ *                    always on
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef ENGINE_COUNTERS_H
+#define ENGINE_COUNTERS_H
+
+#include <array>
+#include <atomic>
+
+#include <QtGlobal>
+
+#include "lmms_export.h"
+
+
+//! Counts what the engine does, from any thread, without locks and without
+//! threads sharing cache lines: every thread adds to its own slot, which
+//! only it writes, and snapshot() sums the slots up. Gauges are values
+//! the rendering thread publishes once per period. Meant to be read by a
+//! thread of its own, see EngineStatsWriter.
+class LMMS_EXPORT EngineCounters
+{
+public:
+	enum class Counter
+	{
+		PeriodsRendered,
+		BuffersAcquired,
+		BuffersReleased,
+		RemoteRoundTrips,
+		// the sum of the round trips, to get their mean
+		RemoteRoundTripMicros,
+		// buffers of plugins with NaNs or infinite values, see
+		// Plugin::reportBadOutput()
+		BadOutputs,
+		// bars of an export through the ExportCache, rendered or taken
+		// from the cache
+		ExportBarsRendered,
+		ExportBarsCached,
+		Count
+	} ;
+
+	enum class Gauge
+	{
+		PlayHandles,
+		// periods rendered ahead, if the engine renders ahead
+		OutputFifoFill,
+		// frames recorded but not mixed yet
+		InputRingFill,
+		Count
+	} ;
+
+	struct Snapshot
+	{
+		std::array<quint64, static_cast<int>( Counter::Count )> counters{};
+		std::array<qint64, static_cast<int>( Gauge::Count )> gauges{};
+		//! The longest round trip since the last snapshot
+		qint64 maxRoundTripMicros = 0;
+
+		quint64 operator[]( Counter counter ) const
+		{
+			return counters[static_cast<int>( counter )];
+		}
+
+		qint64 operator[]( Gauge gauge ) const
+		{
+			return gauges[static_cast<int>( gauge )];
+		}
+	} ;
+
+	static void add( Counter counter, quint64 n = 1 )
+	{
+		std::atomic<quint64> & value = threadSlot().counters[static_cast<int>( counter )];
+		value.fetch_add( n, std::memory_order_relaxed );
+	}
+
+	static void set( Gauge gauge, qint64 value )
+	{
+		s_gauges[static_cast<int>( gauge )].store( value, std::memory_order_relaxed );
+	}
+
+	//! A period processed by a remote plugin, from submitting it until its
+	//! output arrived
+	static void addRoundTrip( qint64 micros );
+
+	//! Restarts the longest round trip
+	static Snapshot snapshot();
+
+private:
+	// threads beyond that share the last slot
+	static constexpr int MaxSlots = 128;
+
+	struct alignas( 64 ) Slot
+	{
+		std::array<std::atomic<quint64>, static_cast<int>( Counter::Count )> counters{};
+	} ;
+
+	static Slot & threadSlot();
+
+	static Slot s_slots[MaxSlots];
+	static std::atomic_int s_usedSlots;
+	static std::atomic<qint64> s_gauges[static_cast<int>( Gauge::Count )];
+	static std::atomic<qint64> s_maxRoundTrip;
+
+} ;
+
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * EngineStatsWriter.h - keeps a file with the engine's counters up to date
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef ENGINE_STATS_WRITER_H
+#define ENGINE_STATS_WRITER_H
+
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "EngineCounters.h"
+
+
+//! Combines the EngineCounters with the profiler's and the note play
+//! handle pool's figures and writes them to a JSON file, every interval
+//! and once more when it's destroyed. The file is replaced as a whole, so
+//! whoever polls it never reads half of it.
+class EngineStatsWriter : public QThread
+{
+public:
+	EngineStatsWriter( const QString & file, int intervalMs );
+	//! Stops the thread, which has to be done before the engine is
+	//! destroyed
+	~EngineStatsWriter() override;
+
+	//! The stats as written to the file, with the rates between @p since
+	//! and @p counters, which were taken @p micros apart
+	static QJsonObject stats( const EngineCounters::Snapshot & counters,
+				const EngineCounters::Snapshot & since, qint64 micros );
+
+protected:
+	void run() override;
+
+private:
+	//! The stats, with the rates since the last call
+	QJsonObject collect();
+	void write();
+
+	const QString m_file;
+	const int m_intervalMs;
+
+	QMutex m_stopMutex;
+	QWaitCondition m_stopCondition;
+	bool m_stop;
+
+	EngineCounters::Snapshot m_last;
+	qint64 m_lastTime;
+
+} ;
+
+
+#endif
@@ -41,7 +41,8 @@ public:
 	class LfoInstances
 	{
 	public:
-		LfoInstances()
+		LfoInstances() :
+			m_frame( 0 )
 		{
 		}
 
@@ -60,7 +61,16 @@ public:
 		void add( EnvelopeAndLfoParameters * lfo );
 		void remove( EnvelopeAndLfoParameters * lfo );
 
+		//! Frames played since the last reset. The LFOs derive their
+		//! position from it when they are used, so idle instances cost
+		//! nothing per period.
+		inline f_cnt_t frame() const
+		{
+			return m_frame;
+		}
+
 	private:
+		f_cnt_t m_frame;
 		QMutex m_lfoListMutex;
 		typedef QList<EnvelopeAndLfoParameters *> LfoList;
 		LfoList m_lfos;
@@ -157,11 +167,14 @@ private:
 	f_cnt_t m_lfoAttackFrames;
 	f_cnt_t m_lfoOscillationFrames;
 	f_cnt_t m_lfoFrame;
+	// LfoInstances::frame() when this LFO was created or reset
+	f_cnt_t m_lfoFrameOffset;
 	float m_lfoAmount;
 	bool m_lfoAmountIsZero;
 	sample_t * m_lfoShapeData;
 	sample_t m_random;
-	bool m_bad_lfoShapeData;
+	// LfoInstances::frame() m_lfoShapeData was computed for
+	f_cnt_t m_lfoShapeDataFrame;
 	SampleBuffer m_userWave;
 
 	enum LfoShapes
@@ -0,0 +1,114 @@
+/*
+ * ExportCache.h - keeps the bars of an export, so that a re-export only
+ *                 renders the ones that changed
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef EXPORT_CACHE_H
+#define EXPORT_CACHE_H
+
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDir>
+
+#include "AudioEngine.h"
+#include "lmms_basics.h"
+
+
+//! Stores what the export of every bar of the song sounded like, in files
+//! named after a hash of everything that could have changed it: the
+//! settings of the tracks, the mixer and the engine, the clips and notes
+//! playing in the bar, and the ones in the bars before it whose effect
+//! tails still reach into it. A re-export only renders the bars whose
+//! hash has no file yet, starting early enough that the notes still
+//! sounding have started and the effects have settled, and takes the
+//! others from the files.
+//! Only works for exports which play the song once, at a constant tempo,
+//! without resampling.
+class ExportCache
+{
+public:
+	struct Segment
+	{
+		tick_t begin;
+		tick_t end;
+		// the frames of the render, counted from the start of the export
+		f_cnt_t firstFrame;
+		f_cnt_t endFrame;
+		// where rendering has to start for the segment's first frame to
+		// be right, if the segment before it comes from the cache
+		tick_t preRoll;
+		f_cnt_t preRollFrame;
+		QByteArray key;
+		bool cached;
+	} ;
+
+	ExportCache( const QString & directory );
+
+	//! Starts the render of every segment at least @p ticks early, for
+	//! effects whose tails aren't known. Has to be called before plan().
+	void setMinimumPreRoll( tick_t ticks )
+	{
+		m_minimumPreRoll = ticks;
+	}
+
+	//! Splits the export just started with Song::startExport() into
+	//! segments and looks them up. Returns false if the export can't use
+	//! the cache.
+	bool plan( const AudioEngine::qualitySettings & qualitySettings, sample_rate_t outputSampleRate );
+
+	const std::vector<Segment> & segments() const
+	{
+		return m_segments;
+	}
+
+	//! The first segment of part @p part, counting from 0, if the segments
+	//! are split into @p parts parts as long as possible. The parts are
+	//! rendered by processes of their own for a distributed render, and
+	//! spliced into the file through the cache.
+	int partBegin( int part, int parts ) const
+	{
+		return static_cast<int>( m_segments.size() * part / parts );
+	}
+
+	//! The frames of a segment that is cached, or none if its file is gone
+	std::vector<surroundSampleFrame> read( const Segment & segment ) const;
+	void write( const Segment & segment, const std::vector<surroundSampleFrame> & frames ) const;
+
+	//! Drops the files of all segments but the ones of the last plan()
+	void removeUnused() const;
+
+	//! Continues the export at @p ticks, stopping everything still playing
+	static void seek( tick_t ticks );
+
+private:
+	QString fileName( const Segment & segment ) const;
+
+	QDir m_directory;
+	tick_t m_minimumPreRoll;
+	std::vector<Segment> m_segments;
+
+} ;
+
+
+#endif
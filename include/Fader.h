@@ -133,6 +133,8 @@ private:
 
 	void setPeak( float fPeak, float &targetPeak, float &persistentPeak, QElapsedTimer &lastPeakTimer );
 	int calculateDisplayPeak( float fPeak );
+	int levelHeight( float fPeak );
+	int peakMarker( float fPeak );
 
 	void updateTextFloat();
 
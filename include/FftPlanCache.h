@@ -0,0 +1,54 @@
+/*
+ * FftPlanCache.h - FFTW plans shared by the whole application
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef FFT_PLAN_CACHE_H
+#define FFT_PLAN_CACHE_H
+
+#include <fftw3.h>
+
+#include "lmms_export.h"
+
+//! FFTW plans of one size and direction are made once and shared by all
+//! users. FFTW's planner is not thread safe and measuring takes a while,
+//! so plans must be requested from a GUI or worker thread, e.g. when an
+//! effect is created or its FFT size changes, never while rendering.
+//! The returned plans are owned by the cache. They were made for other
+//! arrays, so they must be run with fftwf_execute_dft_r2c() and
+//! fftwf_execute_dft_c2r() on the arrays they were requested for.
+//! Executing a plan is thread safe, even if several threads share it.
+class LMMS_EXPORT FftPlanCache
+{
+public:
+	//! Loads the FFTW wisdom saved in the config directory
+	static void init();
+	//! Saves the wisdom and destroys all plans
+	static void cleanup();
+
+	static fftwf_plan realToComplex( int size, const float * in,
+						const fftwf_complex * out );
+	static fftwf_plan complexToReal( int size, const fftwf_complex * in,
+						const float * out );
+} ;
+
+#endif
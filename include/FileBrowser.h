@@ -28,7 +28,11 @@
 
 #include <QCheckBox>
 #include <QtCore/QDir>
+#include <QtCore/QList>
 #include <QtCore/QMutex>
+#include <QtCore/QPair>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
 #include <QTreeWidget>
 
 
@@ -37,10 +41,12 @@
 
 class QLineEdit;
 
+class FileBrowserIndex;
 class FileItem;
 class InstrumentTrack;
 class FileBrowserTreeWidget;
 class PlayHandle;
+class SampleBuffer;
 class TrackContainer;
 
 
@@ -55,7 +61,8 @@ public:
 			If a directory of factory files should be in the list it
 			must be the last one (for the factory files delimiter to work)
 		@param filter Filter as used in QDir::match
-		@param recurse *to be documented*
+		@param recurse Whether to read all directories below in the
+			background, so that filtering finds what isn't shown yet
 	*/
 	FileBrowser( const QString & directories, const QString & filter,
 			const QString & title, const QPixmap & pm,
@@ -66,20 +73,39 @@ public:
 	virtual ~FileBrowser() = default;
 
 private slots:
+	//! Reads all directories again and rebuilds the tree
 	void reloadTree( void );
+	//! Rebuilds the tree from the directories read already
+	void populateTree();
 	void expandItems( QTreeWidgetItem * item=nullptr, QList<QString> expandedDirs = QList<QString>() );
 	// call with item=NULL to filter the entire tree
 	bool filterItems( const QString & filter, QTreeWidgetItem * item=nullptr );
+	void refilter();
+	//! Filters the items just added to @p item
+	void filterAdded( QTreeWidgetItem * item );
+	void updateListed( const QStringList & paths );
 	void giveFocusToFilter();
 
 private:
 	void keyPressEvent( QKeyEvent * ke ) override;
 
 	void addItems( const QString & path );
+	void updateDirectories( QTreeWidgetItem * item, const QSet<QString> & paths );
 
 	FileBrowserTreeWidget * m_fileBrowserTreeWidget;
+	FileBrowserIndex * m_index;
 
 	QLineEdit * m_filterEdit;
+	//! The filter the tree was filtered with last, or a null string for
+	//! none. Items hidden for it stay hidden while it's only extended.
+	QString m_lastFilter;
+	bool m_filterExtended = false;
+	//! Filters again once directories read meanwhile could match
+	QTimer m_refilterTimer;
+
+	//! The directories expanded before the tree was rebuilt, which are
+	//! expanded again once they're read
+	QList<QString> m_expandedDirs;
 
 	QString m_directories; //!< Directories to search, split with '*'
 	QString m_filter; //!< Filter as used in QDir::match()
@@ -102,7 +128,7 @@ class FileBrowserTreeWidget : public QTreeWidget
 	Q_OBJECT
 public:
 	FileBrowserTreeWidget( QWidget * parent );
-	virtual ~FileBrowserTreeWidget() = default;
+	virtual ~FileBrowserTreeWidget();
 
 	//! This method returns a QList with paths (QString's) of all directories
 	//! that are expanded in the tree.
@@ -125,6 +151,12 @@ private:
 	void previewFileItem(FileItem* file);
 	//! If a preview is playing, stop it.
 	void stopPreview();
+	//! The decoded sample for previewing @p file, taken from or added to
+	//! m_previewSamples, which owns it
+	SampleBuffer * previewSample(FileItem* file);
+	//! Decodes the samples next to @p file in the background, so that
+	//! previewing them with the arrow keys doesn't have to wait
+	void prefetchNeighbours(FileItem* file);
 
 	void handleFile( FileItem * fi, InstrumentTrack * it );
 	void openInNewInstrumentTrack( TrackContainer* tc, FileItem* item );
@@ -137,6 +169,9 @@ private:
 	PlayHandle* m_previewPlayHandle;
 	QMutex m_pphMutex;
 
+	//! Samples previewed last with their file names, the most recent first
+	QList<QPair<QString, SampleBuffer*>> m_previewSamples;
+
 	QList<QAction*> getContextActions(FileItem* item, bool songEditor);
 
 
@@ -157,9 +192,16 @@ class Directory : public QTreeWidgetItem
 {
 public:
 	Directory( const QString & filename, const QString & path,
-						const QString & filter );
+						FileBrowserIndex * index );
 
 	void update( void );
+	//! Removes the items and adds them again once it's expanded
+	void reload();
+
+	//! Whether this shows any of the directories in @p paths
+	bool shows( const QSet<QString> & paths );
+	//! Whether any name below this that has been read contains @p text
+	bool hasMatch( const QString & text );
 
 	inline QString fullName( QString path = QString() )
 	{
@@ -198,8 +240,7 @@ private:
 	//! entries 'a/TripleOscillator' and 'b/TripleOscillator'
 	//! and 'xyz' in the tree widget
 	QStringList m_directories;
-	//! Filter as used in QDir::match()
-	QString m_filter;
+	FileBrowserIndex * m_index;
 
 	int m_dirCount;
 
@@ -0,0 +1,117 @@
+/*
+ * FileBrowserIndex.h - directory listings of a file browser, read in the
+ *                      background
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef FILE_BROWSER_INDEX_H
+#define FILE_BROWSER_INDEX_H
+
+#include <memory>
+
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+#include <QtCore/QStringList>
+
+
+//! The names in the directories a file browser shows. Directories are read
+//! on a thread of their own, as reading them on the main thread freezes the
+//! GUI for large or remote libraries, and the ones read are watched so they
+//! don't have to be read again unless they change.
+class FileBrowserIndex : public QObject
+{
+	Q_OBJECT
+public:
+	struct Listing
+	{
+		QStringList dirs; //!< Sorted like QDir::Name, without hidden ones
+		QStringList files; //!< Sorted like QDir::Name, without hidden ones
+		QStringList filteredFiles; //!< The files matching the filter
+		QSet<QString> unreadableDirs; //!< Dirs that can't be opened
+		bool readable = true;
+	} ;
+
+	//! @param filter Filter as used in QDir::match() for filteredFiles
+	FileBrowserIndex(const QString & filter, QObject * parent = nullptr);
+	~FileBrowserIndex() override;
+
+	//! The listing of @p path, or nullptr if it hasn't been read yet. It is
+	//! read in the background then, and listed() is emitted once it's there.
+	//! The pointer stays valid until control returns to the event loop.
+	const Listing * listing(const QString & path);
+
+	//! Reads all directories below @p path in the background, so that
+	//! hasMatch() finds names that aren't shown yet. Changes below it are
+	//! read again, too.
+	void addRecursive(const QString & path);
+
+	//! Whether the name of any directory or filtered file below @p path that
+	//! has been read contains @p text. The results of the previous text are
+	//! reused while the text is only extended.
+	bool hasMatch(const QString & path, const QString & text);
+
+	//! Whether @p path was found in a listing but couldn't be opened
+	bool isUnreadable(const QString & path) const;
+
+	//! Drops all listings, which are read again once they're needed
+	void clear();
+
+	struct Request;
+
+signals:
+	//! The listings of @p paths were read for the first time or changed
+	void listed(const QStringList & paths);
+
+private slots:
+	void addListings();
+	void directoryChanged(const QString & path);
+
+private:
+	void read(const QString & path, bool recursive);
+	bool isBelowRecursive(const QString & path) const;
+	void remove(const QString & path);
+	bool hasMatch(const QString & path);
+
+	const QString m_filter;
+
+	QHash<QString, Listing> m_listings;
+	//! Paths read at the moment, so they aren't requested twice
+	QSet<QString> m_reading;
+	QStringList m_recursive;
+	QSet<QString> m_unreadable;
+	QFileSystemWatcher m_watcher;
+
+	std::shared_ptr<Request> m_request;
+
+	QString m_matchText;
+	QHash<QString, bool> m_matches;
+	//! Paths without any match for the previous text, which can't have one
+	//! for a text containing it either
+	QString m_noMatchText;
+	QSet<QString> m_noMatches;
+} ;
+
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ * FrozenTrackPlayHandle.h - plays the cached output of a frozen track
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef FROZEN_TRACK_PLAY_HANDLE_H
+#define FROZEN_TRACK_PLAY_HANDLE_H
+
+#include "PlayHandle.h"
+
+class SampleBuffer;
+class Track;
+
+
+//! Copies the output a frozen track rendered at freeze time into its audio
+//! port, instead of running the instrument and effects again. The position
+//! in the cache follows the song via sync(), which the track calls whenever
+//! it gets played.
+class FrozenTrackPlayHandle : public PlayHandle
+{
+public:
+	FrozenTrackPlayHandle( Track * track, AudioPort * port, SampleBuffer * cache );
+	virtual ~FrozenTrackPlayHandle();
+
+	void play( sampleFrame * buffer ) override;
+
+	bool isFinished() const override
+	{
+		return false;
+	}
+
+	bool isFromTrack( const Track * track ) const override
+	{
+		return m_track == track;
+	}
+
+	//! @p position is the cache frame belonging to the start of the
+	//! current period. Small differences are rounding of frames per tick
+	//! and are ignored, anything else is a jump of the play position.
+	void sync( f_cnt_t position );
+
+	//! Stop playing until the next sync()
+	void stop()
+	{
+		m_running = false;
+	}
+
+
+private:
+	Track * m_track;
+	SampleBuffer * m_cache;
+
+	f_cnt_t m_position;
+	bool m_running;
+
+} ;
+
+
+#endif
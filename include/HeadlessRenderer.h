@@ -0,0 +1,147 @@
+/*
+ * HeadlessRenderer.h - renders projects in the process embedding it, without
+ *                      a GUI
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef HEADLESS_RENDERER_H
+#define HEADLESS_RENDERER_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+
+#include "AudioEngine.h"
+#include "EngineCounters.h"
+#include "OutputSettings.h"
+#include "ProjectRenderer.h"
+#include "lmms_export.h"
+
+class QCoreApplication;
+
+
+//! The API of the lmmsrender library, for rendering projects without
+//! starting the lmms executable. It sets up the engine the way "lmms
+//! render" does - without a GuiApplication, so no display is needed - and
+//! keeps it, so every project after the first one renders without the
+//! plugins being scanned again.
+//! There is one engine per process, so there can only be one instance at
+//! a time, and its calls have to come from the thread which created it,
+//! except for progress() and abort().
+//! The host has to export its symbols for the plugins, like the lmms
+//! executable does (ENABLE_EXPORTS in CMake).
+class LMMS_EXPORT HeadlessRenderer
+{
+public:
+	struct Options
+	{
+		AudioEngine::qualitySettings quality =
+			AudioEngine::qualitySettings( AudioEngine::qualitySettings::Mode_HighQuality );
+		//! Render as a loop, see "--loop"
+		bool loop = false;
+		//! How often the song's loop is rendered
+		int loopCount = 1;
+		//! Only render what's between the loop markers
+		bool betweenMarkers = false;
+	} ;
+
+	//! Creates a QCoreApplication if there is none. @p framesPerPeriod and
+	//! @p threads are like "--period" and "--threads", 0 for the defaults.
+	HeadlessRenderer( fpp_t framesPerPeriod = 0, int threads = 0,
+				const QString & configFile = QString() );
+	~HeadlessRenderer();
+
+	//! Returns false if the project can't be loaded or is empty
+	bool loadProject( const QString & fileName );
+	//! Loads a project from the contents of a project file. Relative paths
+	//! in it are resolved against @p fileName, which needn't exist.
+	bool loadProject( const QByteArray & data, const QString & fileName = QString() );
+
+	void setOptions( const Options & options )
+	{
+		m_options = options;
+	}
+
+	const Options & options() const
+	{
+		return m_options;
+	}
+
+	//! Renders the whole song into @p fileName, only returning when it's
+	//! done. Returns false if it failed or was aborted.
+	bool renderToFile( const QString & fileName, ProjectRenderer::ExportFileFormats format,
+				const OutputSettings & outputSettings );
+
+	//! Starts a render into the buffers passed to render(), at
+	//! @p sampleRate, which is resampled to from the processing rate
+	bool beginRender( sample_rate_t sampleRate = 44100 );
+	//! Renders up to @p frames stereo frames into @p buffer. Returns the
+	//! frames written, fewer than @p frames only at the end of the song.
+	f_cnt_t render( sampleFrame * buffer, f_cnt_t frames );
+	//! Has to be called after a render started with beginRender(), also
+	//! when it didn't get to the end
+	void endRender();
+
+	//! Of the render in progress or the last one, from 0 to 100
+	int progress() const
+	{
+		return m_progress.load( std::memory_order_relaxed );
+	}
+
+	//! Makes the render in progress stop as soon as possible
+	void abort()
+	{
+		m_aborted.store( true, std::memory_order_relaxed );
+	}
+
+	//! The counters of the engine and the profiler's figures since the
+	//! render in progress or the last one started, like "--stats" writes
+	//! them
+	QJsonObject stats() const;
+
+private:
+	void prepareSong();
+
+	std::unique_ptr<QCoreApplication> m_application;
+	Options m_options;
+
+	std::atomic_int m_progress;
+	std::atomic<bool> m_aborted;
+
+	EngineCounters::Snapshot m_statsStart;
+	qint64 m_statsStartTime;
+
+	// the render into buffers
+	class BufferDevice;
+	BufferDevice * m_device;
+	std::vector<surroundSampleFrame> m_period;
+	fpp_t m_periodFrames;
+	fpp_t m_periodUsed;
+
+} ;
+
+
+#endif
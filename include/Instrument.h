@@ -38,6 +38,7 @@
 class InstrumentTrack;
 class MidiEvent;
 class NotePlayHandle;
+class PlanarBuffer;
 class Track;
 
 
@@ -51,6 +52,8 @@ public:
 		IsSingleStreamed = 0x01,	/*! Instrument provides a single audio stream for all notes */
 		IsMidiBased = 0x02,			/*! Instrument is controlled by MIDI events rather than NotePlayHandles */
 		IsNotBendable = 0x04,		/*! Instrument can't react to pitch bend changes */
+		RendersPlanar = 0x08,		/*! Instrument implements playPlanar() instead of play() */
+		PlaysNotesBatched = 0x10,	/*! Instrument gets all its notes of a period at once through playNotes() */
 	};
 
 	Q_DECLARE_FLAGS(Flags, Flag);
@@ -71,15 +74,28 @@ public:
 	// output buffer only once per audio engine period
 	virtual void play( sampleFrame * _working_buffer );
 
+	// instruments rendering each channel on its own can set RendersPlanar
+	// and re-implement this instead of play(). The instrument-play-handle
+	// interleaves the cleared buffer afterwards and applies the track's
+	// sound shaping, which play() has to do itself.
+	virtual void playPlanar( const PlanarBuffer & _working_buffer );
+
 	// to be implemented by actual plugin
 	virtual void playNote( NotePlayHandle * /* _note_to_play */,
 					sampleFrame * /* _working_buf */ )
 	{
 	}
 
+	// instruments setting PlaysNotesBatched get all notes to be played in
+	// a period in one call, in one job, and can share the work of the
+	// period among them. Each note is played into its buffer(). The
+	// default plays one note after the other.
+	virtual void playNotes( NotePlayHandle * const * _notes, size_t _count );
+
 	// needed for deleting plugin-specific-data of a note - plugin has to
 	// cast void-ptr so that the plugin-data is deleted properly
-	// (call of dtor if it's a class etc.)
+	// (call of dtor if it's a class etc.). Plugin-data taken from a
+	// VoicePool in playNote() goes back to it here.
 	virtual void deleteNotePluginData( NotePlayHandle * _note_to_play );
 
 	// Get number of sample-frames that should be used when playing beat
@@ -140,6 +156,10 @@ protected:
 	// desiredReleaseFrames() frames are left
 	void applyRelease( sampleFrame * buf, const NotePlayHandle * _n );
 
+	// the number of voices to prepare a VoicePool for: the voice limit
+	// of the track, if it has one
+	int voicePoolSize() const;
+
 
 private:
 	InstrumentTrack * m_instrumentTrack;
@@ -26,7 +26,10 @@
 #define INSTRUMENT_PLAY_HANDLE_H
 
 #include "PlayHandle.h"
+#include "BufferManager.h"
 #include "Instrument.h"
+#include "InstrumentTrack.h"
+#include "MixHelpers.h"
 #include "NotePlayHandle.h"
 #include "lmms_export.h"
 
@@ -37,11 +40,20 @@ public:
 
 	virtual ~InstrumentPlayHandle()
 	{
+		BufferManager::release( m_planarBuffer );
 	}
 
 
 	void play( sampleFrame * _working_buffer ) override
 	{
+		// frozen tracks play a cached rendering instead, suspended ones
+		// are being loaded
+		if( m_instrument->instrumentTrack()->isFrozen() ||
+			m_instrument->instrumentTrack()->isSuspended() )
+		{
+			return;
+		}
+
 		// ensure that all our nph's have been processed first
 		ConstNotePlayHandleList nphv = NotePlayHandle::nphsOfInstrumentTrack( m_instrument->instrumentTrack(), true );
 		
@@ -62,7 +74,18 @@ public:
 		}
 		while( nphsLeft );
 		
-		m_instrument->play( _working_buffer );
+		if( m_instrument->flags().testFlag( Instrument::RendersPlanar ) )
+		{
+			BufferManager::clear( m_planarBuffer );
+			m_instrument->playPlanar( m_planarBuffer );
+			MixHelpers::interleave( _working_buffer, m_planarBuffer );
+			m_instrument->instrumentTrack()->processAudioBuffer( _working_buffer,
+								m_planarBuffer.frames(), nullptr );
+		}
+		else
+		{
+			m_instrument->play( _working_buffer );
+		}
 	}
 
 	bool isFinished() const override
@@ -78,6 +101,8 @@ public:
 
 private:
 	Instrument* m_instrument;
+	// only allocated for instruments which render planar
+	PlanarBuffer m_planarBuffer;
 
 } ;
 
@@ -26,7 +26,14 @@
 #ifndef INSTRUMENT_TRACK_H
 #define INSTRUMENT_TRACK_H
 
+#include <atomic>
+#include <vector>
+
+#include <QDomDocument>
+#include <QTimer>
+
 #include "AudioPort.h"
+#include "ComboBoxModel.h"
 #include "InstrumentFunctions.h"
 #include "InstrumentSoundShaping.h"
 #include "Microtuner.h"
@@ -38,6 +45,7 @@
 #include "Pitch.h"
 #include "Plugin.h"
 #include "Track.h"
+#include "TrackFreeze.h"
 #include "TrackView.h"
 
 
@@ -51,6 +59,15 @@ class LMMS_EXPORT InstrumentTrack : public Track, public MidiEventProcessor
 	MM_OPERATORS
 	mapPropertyFromModel(int,getVolume,setVolume,m_volumeModel);
 public:
+	//! Which voices VoiceLimiter stops first if the track plays more than
+	//! its voice limit
+	enum class VoiceStealing
+	{
+		Oldest,
+		Quietest,
+		SameKey		//!< voices of a key played again, else the oldest
+	} ;
+
 	InstrumentTrack( TrackContainer* tc );
 	virtual ~InstrumentTrack();
 
@@ -70,12 +87,32 @@ public:
 		return m_sustainPedalPressed;
 	}
 
+	//! The number of voices the track plays at most, 0 if unlimited
+	int voiceLimit() const
+	{
+		return m_voiceLimitEnabledModel.value() ? m_voiceLimitModel.value() : 0;
+	}
+
+	VoiceStealing voiceStealing() const
+	{
+		return static_cast<VoiceStealing>( m_voiceStealingModel.value() );
+	}
+
 	f_cnt_t beatLen( NotePlayHandle * _n ) const;
 
 
 	// for capturing note-play-events -> need that for arpeggio,
 	// filter and so on
 	void playNote( NotePlayHandle * _n, sampleFrame * _working_buffer );
+	// the part of playNote() before the instrument plays the note, returns
+	// whether it has to
+	bool prepareNote( NotePlayHandle * _n );
+
+	// plays the notes of instruments playing them batched
+	NoteBatch & noteBatch()
+	{
+		return m_noteBatch;
+	}
 
 	QString instrumentName() const;
 	const Instrument *instrument() const
@@ -118,6 +155,29 @@ public:
 	// create new track-content-object = clip
 	Clip* createClip(const TimePos & pos) override;
 
+	TrackFreeze * trackFreeze() override
+	{
+		return &m_freeze;
+	}
+
+	bool isFrozen() const
+	{
+		return m_freeze.isFrozen();
+	}
+
+	//! While suspended, the engine doesn't play the instrument, so that it
+	//! can be loaded without the engine waiting for its locks. Has to be
+	//! changed during a change in the model.
+	void setSuspended( bool suspended )
+	{
+		m_suspended.store( suspended, std::memory_order_relaxed );
+	}
+
+	bool isSuspended() const
+	{
+		return m_suspended.load( std::memory_order_relaxed );
+	}
+
 
 	// called by track
 	virtual void saveTrackSpecificSettings( QDomDocument & _doc,
@@ -152,6 +212,11 @@ public:
 		return &m_baseNoteModel;
 	}
 
+	BoolModel *useMasterPitchModel()
+	{
+		return &m_useMasterPitchModel;
+	}
+
 	IntModel *firstKeyModel()
 	{
 		return &m_firstKeyModel;
@@ -184,6 +249,11 @@ public:
 		return m_arpeggio.m_arpEnabledModel.value();
 	}
 
+	//! Number of notes without parent which haven't been released yet
+	int activeNoteCount() const;
+	//! The one of these notes which started first, nullptr if there's none
+	const NotePlayHandle * firstActiveNote() const;
+
 	// simple helper for removing midiport-XML-node when loading presets
 	static void removeMidiPortNode( DataFile& dataFile );
 
@@ -223,8 +293,34 @@ public:
 
 	void autoAssignMidiDevice( bool );
 
+	//! Whether the instrument is only kept as its saved state until it's
+	//! needed, see instantiateInstrument(). instrument() is null meanwhile.
+	bool isInstrumentDeferred() const
+	{
+		return m_instrumentDeferred;
+	}
+
+	//! Idle instruments aren't unloaded while their window is shown
+	void setInstrumentWindowShown( bool shown )
+	{
+		m_instrumentWindowShown = shown;
+	}
+
+	bool isInstrumentWindowShown() const
+	{
+		return m_instrumentWindowShown;
+	}
+
+public slots:
+	//! Creates a deferred instrument from its saved state. Main thread.
+	void instantiateInstrument();
+
 signals:
+	//! The instrument or its type changed
 	void instrumentChanged();
+	//! A deferred instrument was instantiated or an idle one unloaded,
+	//! while its saved state stayed the same
+	void instrumentLoaded();
 	void midiNoteOn( const Note& );
 	void midiNoteOff( const Note& );
 	void nameChanged();
@@ -247,10 +343,29 @@ protected slots:
 	void updatePitchRange();
 	void updateMixerChannel();
 
+private slots:
+	void updateIdleTimer(const QString & cls, const QString & attribute);
+	void unloadIdleInstrument();
+
 
 private:
 	void processCCEvent(int controller);
 
+	QDomElement saveInstrumentState( QDomDocument & doc );
+	//! Whether @p state of an instrument may be kept instead of the
+	//! instrument, which only pays off for heavy plugins. Nothing may refer
+	//! to its models, as automation and controllers are linked at loading.
+	bool canDeferInstrument( const QDomElement & state ) const;
+	//! Audio thread. Has instantiateInstrument() called on the main thread.
+	void requestInstrument();
+
+	//! Replaces m_instrument by an instance of @p pluginName, with the track
+	//! locked and its notes silenced. Preview tracks keep the few
+	//! instruments they replaced last warm and take them again for
+	//! presets of their type, rather than instantiating the plugin anew.
+	Instrument * switchInstrument(const QString & pluginName,
+		const Plugin::Descriptor::SubPluginFeatures::Key * key, bool keyFromDnd = false);
+
 	MidiPort m_midiPort;
 
 	NotePlayHandle* m_notes[NumKeys];
@@ -273,21 +388,42 @@ private:
 	static InstrumentTrack *s_autoAssignedTrack;
 
 	NotePlayHandleList m_processHandles;
+	// notes without parent which haven't been released yet, in the order
+	// they started, maintained by NotePlayHandle - see its index()
+	std::vector<NotePlayHandle *> m_activeNotes;
+	mutable QMutex m_activeNotesMutex;
 
 	FloatModel m_volumeModel;
 	FloatModel m_panningModel;
 
 	AudioPort m_audioPort;
+	TrackFreeze m_freeze;
 
 	FloatModel m_pitchModel;
 	IntModel m_pitchRangeModel;
 	IntModel m_mixerChannelModel;
 	BoolModel m_useMasterPitchModel;
+	BoolModel m_voiceLimitEnabledModel;
+	IntModel m_voiceLimitModel;
+	ComboBoxModel m_voiceStealingModel;
 
 	Instrument * m_instrument;
+	// replaced instruments of a preview track, the most recent first
+	std::vector<Instrument *> m_warmInstruments;
+	// an "instrument" element, while m_instrumentDeferred
+	QDomDocument m_deferredInstrument;
+	std::atomic<bool> m_instrumentDeferred;
+	std::atomic<bool> m_instrumentRequested;
+	// whether the instrument played since the last tick of m_idleTimer
+	std::atomic<bool> m_instrumentActive;
+	std::atomic<bool> m_suspended;
+	int m_idleMinutes;
+	bool m_instrumentWindowShown;
+	QTimer m_idleTimer;
 	InstrumentSoundShaping m_soundShaping;
 	InstrumentFunctionArpeggio m_arpeggio;
 	InstrumentFunctionNoteStacking m_noteStacking;
+	NoteBatch m_noteBatch;
 
 	Piano m_piano;
 
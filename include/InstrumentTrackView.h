@@ -33,6 +33,7 @@
 
 class InstrumentTrackWindow;
 class Knob;
+class LoadIndicator;
 class TrackContainerView;
 class TrackLabelButton;
 
@@ -87,6 +88,8 @@ private slots:
 
 	void handleConfigChange(QString cls, QString attr, QString value);
 
+	void updateLoad();
+
 
 private:
 	InstrumentTrackWindow * m_window;
@@ -96,6 +99,7 @@ private:
 	Knob * m_volumeKnob;
 	Knob * m_panningKnob;
 	FadeButton * m_activityIndicator;
+	LoadIndicator * m_loadIndicator;
 
 	QMenu * m_midiMenu;
 
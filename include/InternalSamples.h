@@ -0,0 +1,52 @@
+/*
+ * InternalSamples.h - pre-decoded samples played by the engine itself
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef INTERNAL_SAMPLES_H
+#define INTERNAL_SAMPLES_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+class SampleBuffer;
+
+//! Shared, pre-decoded sample buffers for sounds the engine plays on its
+//! own, like the metronome clicks. Every file is decoded once and then
+//! kept until clear() is called.
+class InternalSamples
+{
+public:
+	//! Decodes @p file on first use, so call it outside the audio thread.
+	//! The registry keeps its reference, callers that keep the buffer
+	//! beyond clear() have to add their own one.
+	static SampleBuffer * get( const QString & file );
+
+	static void clear();
+
+private:
+	static QHash<QString, SampleBuffer *> s_samples;
+	static QMutex s_mutex;
+} ;
+
+#endif
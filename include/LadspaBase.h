@@ -71,6 +71,9 @@ typedef struct PortDescription
 	//! Note however that the model can still decide to use a linear scale
 	bool suggests_logscale;
 	LADSPA_Data * buffer;
+	//! The buffer of an audio rate input holds value in each frame, so it
+	//! needs to be filled only when value changes
+	bool buffer_holds_value;
 	LadspaControl * control;
 } port_desc_t;
 
@@ -30,6 +30,8 @@
 
 #include <ladspa.h>
 
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
 #include <QtCore/QMap>
 #include <QtCore/QPair>
 #include <QtCore/QString>
@@ -72,11 +74,17 @@ enum ladspaPluginType
 
 typedef struct ladspaManagerStorage
 {
+	//! nullptr until the library is loaded if the plugin was taken from
+	//! the scan cache
 	LADSPA_Descriptor_Function descriptorFunction;
 	uint32_t index;
 	ladspaPluginType type;
 	uint16_t inputChannels;
 	uint16_t outputChannels;
+	// kept so the plugin lists can be built without loading the library
+	QString filePath;
+	QString name;
+	LADSPA_Properties properties;
 } ladspaManagerDescription;
 
 
@@ -329,8 +337,25 @@ public:
 						LADSPA_Handle _instance );
 
 private:
+	//! Plugins found in one library, as stored in the scan cache
+	struct CacheEntry
+	{
+		QString path;
+		qint64 modified = 0;
+		qint64 size = 0;
+		//! label and description of each plugin
+		QList<QPair<QString, ladspaManagerDescription> > plugins;
+
+		bool matches( const QFileInfo & _file ) const;
+	};
+
 	void  addPlugins( LADSPA_Descriptor_Function _descriptor_func,
-						const QString & _file );
+						const QFileInfo & _file,
+						CacheEntry & _entry );
+	void  addCachedPlugins( const CacheEntry & _entry );
+	bool  loadLibrary( const QString & _path );
+	QHash<QString, CacheEntry> readCache() const;
+	void  writeCache() const;
 	uint16_t  getPluginInputs( const LADSPA_Descriptor * _descriptor );
 	uint16_t  getPluginOutputs( const LADSPA_Descriptor * _descriptor );
 
@@ -343,6 +368,7 @@ private:
 						ladspaManagerMapType;
 	ladspaManagerMapType m_ladspaManagerMap;
 	l_sortable_plugin_t m_sortedPlugins;
+	QHash<QString, CacheEntry> m_cache;
 
 } ;
 
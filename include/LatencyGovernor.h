@@ -0,0 +1,71 @@
+/*
+ * LatencyGovernor.h - queues more periods for the device when needed
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LATENCY_GOVERNOR_H
+#define LATENCY_GOVERNOR_H
+
+#include <QtGlobal>
+
+
+//! Decides how many periods are queued between the audio engine and the
+//! device. One more is queued when periods have been late or the device
+//! reported xruns, or when the load is close to the limit. One less is
+//! queued after the load has been low for a while. Only the number of
+//! queued periods changes, which is safe while playing, as the period
+//! size all buffers and plugins were made for stays the same.
+class LatencyGovernor
+{
+public:
+	LatencyGovernor( int minPeriods, int maxPeriods );
+
+	//! To be called after every period with the smoothed CPU load in
+	//! percent, the number of glitches so far and the length of a period
+	//! in microseconds. Returns the number of periods to queue.
+	int update( int cpuLoad, int glitches, qint64 periodLength );
+
+	int periods() const
+	{
+		return m_periods;
+	}
+
+private:
+	static constexpr int HighLoad = 90;
+	static constexpr int LowLoad = 50;
+	// how long the load has to stay low before the latency is lowered
+	static constexpr qint64 CalmTime = 10000000;
+	// the new period needs a while to be filled, the glitches of one
+	// burst shouldn't raise the latency several times
+	static constexpr qint64 HoldTime = 1000000;
+
+	const int m_minPeriods;
+	const int m_maxPeriods;
+	int m_periods;
+	int m_lastGlitches;
+	// microseconds since the last step, and with a low load
+	qint64 m_sinceStep;
+	qint64 m_calm;
+} ;
+
+
+#endif
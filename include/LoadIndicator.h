@@ -1,7 +1,7 @@
 /*
- * monodelay.h - defination of MonoDelay class.
+ * LoadIndicator.h - small bar showing the CPU load of a track or channel
  *
- * Copyright (c) 2014 David French <dave/dot/french3/at/googlemail/dot/com>
+ * Copyright (c) 2026 LMMS Developers
  *
  * This file is part of LMMS - https://lmms.io
  *
@@ -22,39 +22,30 @@
  *
  */
 
-#ifndef MONODELAY_H
-#define MONODELAY_H
+#ifndef LOAD_INDICATOR_H
+#define LOAD_INDICATOR_H
 
-#include "lmms_basics.h"
+#include <QWidget>
 
-class MonoDelay
+
+//! Bar filling up from the bottom with the CPU load of a track or mixer
+//! channel. The owner feeds it from a LoadMeter and hides it while the
+//! profiler doesn't measure the load.
+class LoadIndicator : public QWidget
 {
+	Q_OBJECT
 public:
-	MonoDelay( int maxTime , int sampleRate );
-	~MonoDelay();
-	inline void setLength( float length )
-	{
-		if( length <= m_maxLength && length >= 0 )
-		{
-			m_length = length;
-		}
-	}
-
-	inline void setFeedback( float feedback )
-	{
-		m_feedback = feedback;
-	}
-
-	void tick( sample_t* sample );
-	void setSampleRate( int sampleRate );
+	LoadIndicator( QWidget * parent );
+
+	//! @p load in percent of one core, @p details go to the tooltip
+	void setLoad( float load, const QString & details );
+
+protected:
+	void paintEvent( QPaintEvent * pe ) override;
 
 private:
-	sample_t* m_buffer;
-	int m_maxLength;
-	float m_length;
-	int m_writeIndex;
-	float m_feedback;
-	float m_maxTime;
-};
-
-#endif // MONODELAY_H
+	float m_load;
+} ;
+
+
+#endif
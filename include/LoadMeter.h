@@ -0,0 +1,74 @@
+/*
+ * LoadMeter.h - processing time of one track or mixer channel
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LOAD_METER_H
+#define LOAD_METER_H
+
+#include <QtGlobal>
+
+#include <atomic>
+#include <chrono>
+
+//! Adds up the time the audio threads spend on the jobs of one object,
+//! e.g. a track or a mixer channel. Only fed while
+//! AudioEngineProfiler::jobLoadEnabled() is set.
+class LoadMeter
+{
+public:
+	LoadMeter() :
+		m_time( 0 ),
+		m_lastTake( now() )
+	{
+	}
+
+	//! Any audio thread
+	void add( qint64 nanoseconds )
+	{
+		m_time.fetch_add( nanoseconds, std::memory_order_relaxed );
+	}
+
+	//! Share of real time spent on the object since the last call in
+	//! percent - where 100 equals one fully loaded core. Only one thread
+	//! may call this.
+	float takeLoad()
+	{
+		const qint64 current = now();
+		const qint64 elapsed = current - m_lastTake;
+		m_lastTake = current;
+		const qint64 time = m_time.exchange( 0, std::memory_order_relaxed );
+		return elapsed > 0 ? 100.0f * time / elapsed : 0.0f;
+	}
+
+	static qint64 now()
+	{
+		using namespace std::chrono;
+		return duration_cast<nanoseconds>( steady_clock::now().time_since_epoch() ).count();
+	}
+
+private:
+	std::atomic<qint64> m_time;
+	qint64 m_lastTake;
+} ;
+
+#endif
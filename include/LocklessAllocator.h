@@ -28,6 +28,10 @@
 #include <atomic>
 #include <stddef.h>
 
+//! Fixed pool of elements. Every thread keeps a magazine of free elements
+//! of its own, which is refilled from and spilled to the shared free state
+//! in batches, so that threads allocating and freeing at the same time
+//! rarely touch the same cache lines.
 class LocklessAllocator
 {
 public:
@@ -38,6 +42,30 @@ public:
 
 
 private:
+	// threads beyond that use the shared free state only
+	static constexpr int MaxMagazines = 64;
+	static constexpr int MagazineSize = 16;
+
+	struct alignas( 64 ) Magazine
+	{
+		// taken by the owner while using it, and by other threads when
+		// they take its elements because the shared ones ran out
+		std::atomic<bool> busy{ false };
+		int count = 0;
+		void * elements[MagazineSize];
+	} ;
+
+	//! Allocates up to @p count elements from the shared free state into
+	//! @p elements and returns how many it got
+	int allocShared( void * * elements, int count );
+	void freeShared( void * const * elements, int count );
+	//! Takes the elements in the magazines of other threads
+	void * steal( int thread );
+	bool isValid( void * ptr ) const;
+
+	//! Of the calling thread, or -1 if it has no magazine
+	static int threadIndex();
+
 	char * m_pool;
 	size_t m_capacity;
 	size_t m_elementSize;
@@ -48,6 +76,8 @@ private:
 	std::atomic_int m_available;
 	std::atomic_int m_startIndex;
 
+	Magazine * m_magazines;
+
 } ;
 
 
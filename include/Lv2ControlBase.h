@@ -35,6 +35,7 @@
 #include "LinkedModelGroups.h"
 #include "lmms_export.h"
 #include "Plugin.h"
+#include "PlanarBuffer.h"
 
 class Lv2Proc;
 class PluginIssue;
@@ -115,6 +116,15 @@ protected:
 	void copyBuffersFromLmms(const sampleFrame *buf, fpp_t frames);
 	//! Copy our ports into buffers passed by LMMS
 	void copyBuffersToLmms(sampleFrame *buf, fpp_t frames) const;
+	//! Planar versions of the above
+	void copyBuffersFromLmms(const PlanarBuffer &buf, fpp_t frames);
+	void copyBuffersToLmms(const PlanarBuffer &buf, fpp_t frames) const;
+	//! Let all procs use @p in and @p out instead of their own buffers,
+	//! see Lv2Proc::connectBuffersOfCore(). Returns false, with no proc
+	//! connected to them, if the buffers have to be copied.
+	bool connectBuffersOfLmms(const PlanarBuffer &in, const PlanarBuffer &out);
+	//! Whether all procs may have input and output in the same buffer
+	bool canProcessInPlace() const;
 	//! Run the Lv2 plugin instance for @param frames frames
 	void run(fpp_t frames);
 
@@ -31,12 +31,16 @@
 
 #include <map>
 #include <set>
+#include <vector>
 #include <lilv/lilv.h>
+#include <QtCore/QHash>
+#include <QtCore/QString>
 
 #include "Lv2Basics.h"
 #include "Lv2UridCache.h"
 #include "Lv2UridMap.h"
 #include "Plugin.h"
+#include "PluginIssue.h"
 
 
 /*
@@ -92,19 +96,23 @@ public:
 		//! use only for std::map internals
 		Lv2Info() : m_plugin(nullptr) {}
 		//! ctor used inside Lv2Manager
-		Lv2Info(const LilvPlugin* plug, Plugin::PluginTypes type, bool valid) :
-			m_plugin(plug), m_type(type), m_valid(valid) {}
+		Lv2Info(const LilvPlugin* plug, Plugin::PluginTypes type, bool valid,
+			const QString& name) :
+			m_plugin(plug), m_type(type), m_valid(valid), m_name(name) {}
 		Lv2Info(Lv2Info&& other) = default;
 		Lv2Info& operator=(Lv2Info&& other) = default;
 
 		const LilvPlugin* plugin() const { return m_plugin; }
 		Plugin::PluginTypes type() const { return m_type; }
 		bool isValid() const { return m_valid; }
+		//! The plugin's name, known without loading the plugin's data
+		const QString& name() const { return m_name; }
 
 	private:
 		const LilvPlugin* m_plugin;
 		Plugin::PluginTypes m_type;
 		bool m_valid = false;
+		QString m_name;
 	};
 
 	//! Return descriptor with URI @p uri or nullptr if none exists
@@ -151,11 +159,25 @@ private:
 	// URID cache for fast URID access
 	Lv2UridCache m_uridCache;
 
+	//! What the scan cache knows about one plugin
+	struct CacheEntry
+	{
+		QString bundle;
+		qint64 modified = -1; //!< newest mtime of the bundle's files
+		Plugin::PluginTypes type = Plugin::Undefined;
+		QString name;
+		std::vector<PluginIssue> issues;
+	};
+	//! plugin URI to cache entry
+	QHash<QString, CacheEntry> m_cache;
+
 	// static
 	static const std::set<const char*, Lv2Manager::CmpStr> pluginBlacklist;
 
 	// functions
 	bool isSubclassOf(const LilvPluginClass *clvss, const char *uriStr);
+	QHash<QString, CacheEntry> readCache() const;
+	void writeCache() const;
 };
 
 #endif // LMMS_HAVE_LV2
@@ -188,6 +188,10 @@ struct Audio : public VisitablePort<Audio, PortBase>
 	//! @param channel channel index into each sample frame
 	void copyBuffersToCore(sampleFrame *lmmsBuf,
 		unsigned channel, fpp_t frames) const;
+	//! Planar versions of the above, @p lmmsBuf is a single channel
+	void copyBuffersFromCore(const sample_t *lmmsBuf, fpp_t frames);
+	void averageWithBuffersFromCore(const sample_t *lmmsBuf, fpp_t frames);
+	void copyBuffersToCore(sample_t *lmmsBuf, fpp_t frames) const;
 
 	bool isSideChain() const { return m_sidechain; }
 	bool isOptional() const { return m_optional; }
@@ -36,8 +36,10 @@
 #include "Lv2Basics.h"
 #include "Lv2Features.h"
 #include "Lv2Options.h"
+#include "Lv2Worker.h"
 #include "LinkedModelGroups.h"
 #include "MidiEvent.h"
+#include "PlanarBuffer.h"
 #include "Plugin.h"
 #include "PluginIssue.h"
 #include "../src/3rdparty/ringbuffer/include/ringbuffer/ringbuffer.h"
@@ -141,6 +143,24 @@ public:
 	 */
 	void copyBuffersToCore(sampleFrame *buf, unsigned firstChan, unsigned num,
 								fpp_t frames) const;
+	//! Planar versions of the above, @p buf holds one array per channel
+	void copyBuffersFromCore(const PlanarBuffer &buf,
+								unsigned firstChan, unsigned num, fpp_t frames);
+	void copyBuffersToCore(const PlanarBuffer &buf, unsigned firstChan,
+								unsigned num, fpp_t frames) const;
+	/**
+	 * Let the audio ports read from and write to the channels of @p in and
+	 * @p out directly, instead of copying them through our ports. This only
+	 * works if there is one input and one output port for each channel.
+	 * @p out may be @p in unless the plugin can't process in place.
+	 * @return false if the buffers have to be copied
+	 */
+	bool connectBuffersOfCore(const PlanarBuffer &in, const PlanarBuffer &out,
+								unsigned firstChan, unsigned num);
+	//! Connect the audio ports to our own buffers again
+	void disconnectBuffersOfCore();
+	//! Whether input and output may share their buffers
+	bool canProcessInPlace() const { return !m_inPlaceBroken; }
 	//! Run the Lv2 plugin instance for @param frames frames
 	void run(fpp_t frames);
 
@@ -170,11 +190,16 @@ private:
 	LilvInstance* m_instance;
 	Lv2Features m_features;
 	Lv2Options m_options;
+	std::unique_ptr<Lv2Worker> m_worker;
 
 	// full list of ports
 	std::vector<std::unique_ptr<Lv2Ports::PortBase>> m_ports;
 	// quick reference to specific, unique ports
 	StereoPortRef m_inPorts, m_outPorts;
+	//! whether the ports of m_inPorts and m_outPorts are connected to
+	//! buffers of the core
+	bool m_buffersOfCore = false;
+	bool m_inPlaceBroken = false;
 	Lv2Ports::AtomSeq *m_midiIn = nullptr, *m_midiOut = nullptr;
 
 	// MIDI
@@ -30,27 +30,47 @@
 #ifdef LMMS_HAVE_LV2
 
 #include <lv2/lv2plug.in/ns/ext/urid/urid.h>
-#include <mutex> // TODO: use semaphore, even though this is not realtime critical
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <unordered_map>
-#include <vector>
 
 /**
  * Complete implementation of the Lv2 Urid Map extension
+ *
+ * Plugins map URIs while they are instantiated, which may happen on several
+ * threads at once, and some even map them in their run thread. URIs are only
+ * added, never removed, so looking them up doesn't need any lock: the table
+ * slots and the unmap array are atomic, and are filled once. Only adding a
+ * new URI takes a mutex.
  */
 class UridMap
 {
-	std::unordered_map<std::string, LV2_URID> m_map;
-	std::vector<const char*> m_unMap;
+	struct Entry
+	{
+		std::string m_uri;
+		LV2_URID m_urid;
+	};
+
+	//! open addressing, never more than half full, so that lookups end soon
+	static constexpr std::size_t TableSize = 1 << 14;
+	static constexpr std::size_t MaxUrids = TableSize / 2;
+
+	std::unique_ptr<std::atomic<const Entry*>[]> m_table;
+	//! URID - 1 -> URI
+	std::unique_ptr<std::atomic<const char*>[]> m_unMap;
+	//! storage of the entries, which never move
+	std::deque<Entry> m_entries;
 
-	//! mutex for both m_map and m_unMap
-	//! the URID map is global, which is why a mutex is required here
+	//! for adding entries; the URID map is global
 	std::mutex m_MapMutex;
 
 	LV2_URID_Map m_mapFeature;
 	LV2_URID_Unmap m_unmapFeature;
 
-	LV2_URID m_lastUrid = 0;
+	//! @return the entry of @p uri, or nullptr, with its slot in @p slot
+	const Entry* find(const char* uri, std::size_t& slot) const;
 
 public:
 	//! constructor; will set up the features
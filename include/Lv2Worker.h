@@ -0,0 +1,106 @@
+/*
+ * Lv2Worker.h - Lv2Worker class
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef LV2WORKER_H
+#define LV2WORKER_H
+
+#include "lmmsconfig.h"
+
+#ifdef LMMS_HAVE_LV2
+
+#include <lv2/lv2plug.in/ns/ext/worker/worker.h>
+#include <memory>
+#include <vector>
+#include <QMutex>
+
+#include "../src/3rdparty/ringbuffer/include/ringbuffer/ringbuffer.h"
+
+class Lv2WorkerPool;
+
+/**
+	Worker for one Lv2 processor, implementing LV2_Worker_Schedule
+
+	The plugin schedules work in its run thread. The work is done on a pool
+	of threads shared by all Lv2 processors, and the responses are handed
+	back to the plugin in the run thread. Requests and responses go through
+	lockless ringbuffers, so the run thread never waits for the pool.
+
+	The public member functions should be called in descending order:
+
+	1. feature: pass to lilv_plugin_instantiate
+	2. setInstance: after the instance has been created
+	3. emitResponses: after each run
+*/
+class Lv2Worker
+{
+public:
+	Lv2Worker();
+	//! Waits until the work being done is done
+	~Lv2Worker();
+
+	LV2_Worker_Schedule* feature() { return &m_scheduleFeature; }
+
+	//! @param iface the worker interface of the plugin, may be nullptr
+	void setInstance(const LV2_Worker_Interface* iface, LV2_Handle handle);
+
+	//! Hand the responses to the plugin and tell it the run has ended
+	//! Must be called in the run thread
+	void emitResponses();
+
+private:
+	static LV2_Worker_Status scheduleWork(LV2_Worker_Schedule_Handle handle,
+		uint32_t size, const void* data);
+	static LV2_Worker_Status respond(LV2_Worker_Respond_Handle handle,
+		uint32_t size, const void* data);
+
+	//! Write size and data of a request or response
+	static bool write(ringbuffer_t<char>& ring, std::vector<char>& buffer,
+		uint32_t size, const void* data);
+
+	//! Do the work requested so far, in a thread of the pool, which holds
+	//! m_workMutex
+	void work();
+	bool hasRequests();
+
+	const LV2_Worker_Interface* m_iface = nullptr;
+	LV2_Handle m_handle = nullptr;
+	LV2_Worker_Schedule m_scheduleFeature;
+	std::shared_ptr<Lv2WorkerPool> m_pool;
+
+	//! each request and response is its size, followed by its data
+	ringbuffer_t<char> m_requests, m_responses;
+	ringbuffer_reader_t<char> m_requestsReader, m_responsesReader;
+	//! a request, written in the run thread and read in the pool's thread
+	std::vector<char> m_scheduled, m_request;
+	//! a response, written while m_workMutex is held and read in the run thread
+	std::vector<char> m_responded, m_response;
+	//! held while the work is being done
+	QMutex m_workMutex;
+
+	friend class Lv2WorkerPool;
+};
+
+#endif // LMMS_HAVE_LV2
+
+#endif // LV2WORKER_H
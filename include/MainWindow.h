@@ -30,6 +30,7 @@
 #include <QtCore/QList>
 #include <QMainWindow>
 
+#include "AutoSaver.h"
 #include "ConfigManager.h"
 #include "SubWindow.h"
 
@@ -105,6 +106,15 @@ public:
 		return m_autoSaveTimer.interval();
 	}
 
+	// Rate of periodicUpdate(), which meters, scopes and displays follow.
+	// SetupDialog.cpp offers these bounds.
+	static const int DEFAULT_FRAME_RATE = 60;
+	static const int MIN_FRAME_RATE = 10;
+	static const int MAX_FRAME_RATE = 120;
+
+	//! Restarts periodic updates at the rate in the "ui" "framerate" setting
+	void updateFrameRate();
+
 	enum SessionState
 	{
 		Normal,
@@ -168,6 +178,14 @@ public slots:
 
 private slots:
 	void onExportProjectMidi();
+	void onToggleJobTrace( bool enabled );
+	void onToggleJobLoad( bool enabled );
+	void onToggleDenormalWatch( bool enabled );
+	void onShowDenormalSuspects();
+	void onExportJobTrace();
+	void onShowGlitches();
+	void onExportGlitchLog();
+	void onShowMemoryUsage();
 
 protected:
 	void closeEvent( QCloseEvent * _ce ) override;
@@ -218,6 +236,7 @@ private:
 	QBasicTimer m_updateTimer;
 	QTimer m_autoSaveTimer;
 	int m_autoSaveInterval;
+	AutoSaver m_autoSaver;
 
 	friend class GuiApplication;
 
@@ -43,6 +43,9 @@ public:
 
 	static void * alloc( size_t size );
 	static void free( void * ptr );
+
+	//! Bytes currently allocated through alloc(), as rpmalloc rounded them up
+	static size_t allocatedBytes();
 };
 
 template<typename T>
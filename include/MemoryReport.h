@@ -0,0 +1,123 @@
+/*
+ * MemoryReport.h - what the tracks, plugins and samples of a project use
+ *                  of memory
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef MEMORY_REPORT_H
+#define MEMORY_REPORT_H
+
+#include <vector>
+
+#include <QJsonObject>
+#include <QString>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+
+
+class EffectChain;
+class Plugin;
+
+
+//! A snapshot of the memory the project uses, by track, mixer channel,
+//! plugin and sample file. Samples shared between buffers through the
+//! SampleCache count for every track using them, but only once in the
+//! totals.
+class LMMS_EXPORT MemoryReport
+{
+public:
+	struct PluginUsage
+	{
+		QString name;
+		//! What the plugin loaded, see Plugin::memoryUsage()
+		size_t bytes = 0;
+		//! The process of a remote plugin and its resident memory, which
+		//! may be shared with other plugins
+		qint64 process = 0;
+		size_t processBytes = 0;
+	} ;
+
+	//! A track or a mixer channel
+	struct OwnerUsage
+	{
+		QString name;
+		//! The instrument first, if there's one, then the effects
+		std::vector<PluginUsage> plugins;
+		//! Of the clips of a sample track
+		size_t sampleBytes = 0;
+
+		size_t bytes() const;
+	} ;
+
+	struct SampleUsage
+	{
+		QString file;
+		sample_rate_t sampleRate = 0;
+		size_t bytes = 0;
+		//! The buffers using the frames. 0 if they're only kept in case
+		//! they're needed again, see SampleCache::dropRetained().
+		int users = 0;
+		//! Whether the file is held more than once, e.g. decoded at
+		//! several sample rates or kept at its bit depth and as floats
+		bool duplicated = false;
+	} ;
+
+	//! Collects the report, from the GUI thread
+	static MemoryReport collect();
+
+	QJsonObject toJson() const;
+
+	//! The resident memory of the process @p pid, or of LMMS itself if it's
+	//! 0. Returns 0 if the platform doesn't tell.
+	static size_t residentBytes( qint64 pid = 0 );
+
+	//! LMMS' resident memory and what it allocated through the
+	//! MemoryManager, a part of it
+	size_t resident = 0;
+	size_t allocated = 0;
+	//! Resident memory of all remote plugin processes, each counted once
+	size_t remoteResident = 0;
+	//! Of all samples in the SampleCache, those unused, and what sharing
+	//! them between buffers saves
+	size_t sampleBytes = 0;
+	size_t unusedSampleBytes = 0;
+	size_t sharedSampleBytes = 0;
+	//! What the plugins loaded, in LMMS' process
+	size_t pluginBytes = 0;
+
+	std::vector<OwnerUsage> tracks;
+	std::vector<OwnerUsage> mixerChannels;
+	//! The largest first
+	std::vector<SampleUsage> samples;
+
+private:
+	PluginUsage pluginUsage( const Plugin * plugin );
+	void addEffects( OwnerUsage & owner, const EffectChain * chain );
+
+	// remote processes counted in remoteResident already
+	std::vector<qint64> m_processes;
+
+} ;
+
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * MemoryUsageDialog.h - shows what the tracks, plugins and samples of the
+ *                       project use of memory
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef MEMORY_USAGE_DIALOG_H
+#define MEMORY_USAGE_DIALOG_H
+
+#include <QDialog>
+
+class QLabel;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+
+//! Lists a MemoryReport: the totals, every track and mixer channel with
+//! its plugins, and the cached samples, so that the largest, unused and
+//! duplicated ones stand out. Unused samples can be purged from here.
+class MemoryUsageDialog : public QDialog
+{
+	Q_OBJECT
+public:
+	MemoryUsageDialog( QWidget * parent = nullptr );
+
+	//! In KB or MB, for the tree and the summary
+	static QString formatBytes( size_t bytes );
+
+private slots:
+	void refresh();
+	void purgeUnusedSamples();
+
+private:
+	QLabel * m_summary;
+	QTreeWidget * m_tree;
+
+} ;
+
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * Metronome.h - plays the metronome clicks without allocating
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef METRONOME_H
+#define METRONOME_H
+
+#include "AudioPort.h"
+
+class PlayHandle;
+class SamplePlayHandle;
+
+//! Owns the play handles for the metronome clicks. They are created once,
+//! play pre-decoded samples through one shared audio port and get rewound
+//! for every click, so the audio engine thread neither touches the disk
+//! nor has to wait for model changes when ticking.
+class Metronome
+{
+public:
+	Metronome();
+	~Metronome();
+
+	//! Audio engine thread only. Rewinds and returns the next handle for
+	//! a click - it may still be playing from an earlier click.
+	SamplePlayHandle * click( bool strong );
+
+	bool owns( const PlayHandle * handle ) const;
+
+private:
+	// enough for clicks overlapping at any sensible tempo
+	static constexpr int HandlesPerSound = 4;
+
+	AudioPort m_audioPort;
+	SamplePlayHandle * m_handles[2][HandlesPerSound];
+	int m_nextHandle[2];
+} ;
+
+#endif
@@ -25,6 +25,9 @@
 #ifndef MICROTUNER_H
 #define MICROTUNER_H
 
+#include <array>
+#include <memory>
+
 #include "AutomatableModel.h"
 #include "ComboBoxModel.h"
 #include "JournallingObject.h"
@@ -61,13 +64,26 @@ public:
 protected slots:
 	void updateScaleList(int index);
 	void updateKeymapList(int index);
+	void updateFrequencyTable();
 
 private:
+	//! Frequency ratios of all keys for the selected scale and keymap, relative to the same reference.
+	//! A key's frequency then only depends on the ratio of the base note.
+	struct FrequencyTable
+	{
+		std::array<double, NumKeys> ratios;	//!< 0 for keys which aren't mapped
+		int baseKey;
+		float baseFreq;
+		bool constant;						//!< octave interval is 1/1, all mapped keys play baseFreq
+	};
+
 	BoolModel m_enabledModel;               //!< Enable microtuner (otherwise using 12-TET @440 Hz)
 	ComboBoxModel m_scaleModel;
 	ComboBoxModel m_keymapModel;
 	BoolModel m_keyRangeImportModel;
 
+	//! Rebuilt in the GUI thread, read by note play handles
+	std::shared_ptr<const FrequencyTable> m_frequencyTable;
 };
 
 #endif
@@ -68,6 +68,7 @@ public:
 	virtual void processOutEvent( const MidiEvent & _me,
 						const TimePos & _time,
 						const MidiPort * _port ) override;
+	void processOutEvents( const MidiOutEvent * events, size_t count, fpp_t frames ) override;
 
 	void applyPortMode( MidiPort * _port ) override;
 	void applyPortName( MidiPort * _port ) override;
@@ -120,6 +121,9 @@ private:
 	void run() override;
 
 #ifdef LMMS_HAVE_ALSA
+	//! Fills in everything but the scheduling, false for unhandled events
+	bool prepareOutEvent( snd_seq_event_t & ev, const MidiEvent & event, const MidiPort * port ) const;
+
 	QMutex m_seqMutex;
 	snd_seq_t * m_seqHandle;
 	struct Ports
@@ -31,6 +31,7 @@
 
 #include "MidiEvent.h"
 #include "MidiEventProcessor.h"
+#include "MidiOutEvent.h"
 #include "TabWidget.h"
 
 
@@ -49,6 +50,13 @@ public:
 						const TimePos & _time,
 						const MidiPort * _port ) = 0;
 
+	//! Sends the MIDI output of the period of @p frames frames the audio
+	//! engine has just rendered, sorted by offset. Called at the end of
+	//! every period, also without events, so that clients scheduling
+	//! the events can keep time. The default sends one after the other
+	//! with processOutEvent().
+	virtual void processOutEvents( const MidiOutEvent * events, size_t count, fpp_t frames );
+
 	// inheriting classes can re-implement this for being able to update
 	// their internal port-structures etc.
 	virtual void applyPortMode( MidiPort * _port );
@@ -131,8 +139,9 @@ public:
 
 
 protected:
-	// generic raw-MIDI-parser which generates appropriate MIDI-events
-	void parseData( const unsigned char c );
+	// generic raw-MIDI-parser which generates appropriate MIDI-events,
+	// @p timestamp is when @p c was received (see MidiPort::processInEvent())
+	void parseData( const unsigned char c, qint64 timestamp = -1 );
 
 	// to be implemented by actual client-implementation
 	virtual void sendByte( const unsigned char c ) = 0;
@@ -163,6 +172,8 @@ private:
 		uint32_t m_buffer[RAW_MIDI_PARSE_BUF_SIZE];
 					// buffer for incoming data
 		MidiEvent m_midiEvent;	// midi-event
+		qint64 m_timestamp;	// when the last byte of the event
+					// was received
 	} m_midiParseData;
 
 } ;
@@ -28,6 +28,8 @@
 
 #include <QStaticText>
 
+#include <vector>
+
 #include "Note.h"
 #include "MidiClipView.h"
 #include "ClipView.h"
@@ -56,6 +58,9 @@ public:
 
 	// note management
 	Note * addNote( const Note & _new_note, const bool _quant_pos = true );
+	//! Adds all @p newNotes at once, sorting them in and updating the
+	//! length only once
+	void addNotes( const std::vector<Note> & newNotes, const bool quantPos = true );
 
 	void removeNote( Note * _note_to_del );
 
@@ -69,6 +74,16 @@ public:
 		return m_notes;
 	}
 
+	//! The notes starting exactly at @p time. Meant for playback, which
+	//! asks for consecutive ticks: the clip remembers where the last call
+	//! ended, so only jumps and loops have to search the notes.
+	std::pair<NoteVector::ConstIterator, NoteVector::ConstIterator> notesStartingAt( const TimePos & time );
+
+	inline int steps() const
+	{
+		return m_steps;
+	}
+
 	Note * addStepNote( int step );
 	void setStep( int step, bool enabled );
 
@@ -137,6 +152,9 @@ private:
 	NoteVector m_notes;
 	int m_steps;
 
+	// index of the first note after the ones the last notesStartingAt() returned
+	int m_playbackCursor;
+
 	MidiClip * adjacentMidiClipByOffset(int offset) const;
 
 	friend class MidiClipView;
@@ -84,7 +84,6 @@ private:
 	static QPixmap * s_stepBtnOffLight;
 
 	MidiClip* m_clip;
-	QPixmap m_paintPixmap;
 
 	QColor m_noteFillColor;
 	QColor m_noteBorderColor;
@@ -25,6 +25,9 @@
 #ifndef MIDI_CONTROLLER_H
 #define MIDI_CONTROLLER_H
 
+#include <array>
+#include <atomic>
+
 #include <QWidget>
 
 #include "AutomatableModel.h"
@@ -73,8 +76,29 @@ protected:
 	MidiPort m_midiPort;
 
 
-	float m_lastValue;
+	//! A control change received for the period @p period, at @p offset
+	//! frames into it
+	struct ControlEvent
+	{
+		long period;
+		f_cnt_t offset;
+		float value;
+	} ;
+
+	//! Control changes kept for one update of the value buffer, more are
+	//! dropped and only the last value is kept
+	static constexpr size_t MaxEvents = 64;
+
+	std::atomic<float> m_lastValue;
 	float m_previousValue;
+	// received since the value buffer was updated, written by
+	// processInEvent() and read by updateValueBuffer() (under
+	// m_valueBufferMutex), each only moving its own index
+	std::array<ControlEvent, MaxEvents> m_events;
+	std::atomic<size_t> m_eventsWritten;
+	std::atomic<size_t> m_eventsRead;
+	// set when events were dropped, the buffer then ends at m_lastValue
+	std::atomic<bool> m_eventsDropped;
 
 	friend class ControllerConnectionDialog;
 	friend class AutoDetectMidiController;
@@ -35,6 +35,9 @@
 #include "weak_libjack.h"
 #endif
 
+#include <array>
+#include <atomic>
+
 #include <QtCore/QThread>
 #include <QMutex>
 #include <QtCore/QFile>
@@ -66,6 +69,9 @@ public:
 	void JackMidiWrite(jack_nframes_t nframes);
 	void JackMidiRead(jack_nframes_t nframes);
 
+	//! Queues the events for the next JACK cycles, at their offsets
+	void processOutEvents(const MidiOutEvent* events, size_t count, fpp_t frames) override;
+
 
 	inline static QString configSection()
 	{
@@ -85,6 +91,27 @@ private:
 	jack_port_t *m_output_port;
 	uint8_t m_jack_buffer[JACK_MIDI_BUFFER_MAX * 4];
 
+	// the output events, from the audio engine to the JACK thread, at the
+	// frames of the engine's periods since the first one
+	struct OutMessage
+	{
+		jack_nframes_t frame;
+		uint8_t size;
+		uint8_t data[3];
+	};
+	static constexpr size_t OutMessages = 1024;
+	std::array<OutMessage, OutMessages> m_outMessages;
+	std::atomic<size_t> m_outWrite;
+	std::atomic<size_t> m_outRead;
+	// written by the audio engine only
+	jack_nframes_t m_outFrames;
+	// used by the JACK thread only - the distance between the JACK frames
+	// and the engine's, which is set with the first message
+	bool m_outSynced;
+	jack_nframes_t m_outShift;
+
+	static uint8_t toBytes(const MidiEvent& event, uint8_t* data);
+
 	void JackMidiOutEvent(uint8_t *buf, uint8_t len);
 	void lock();
 	void unlock();
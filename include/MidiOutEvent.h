@@ -0,0 +1,48 @@
+/*
+ * MidiOutEvent.h - an event of the MIDI output of a period
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef MIDI_OUT_EVENT_H
+#define MIDI_OUT_EVENT_H
+
+#include "MidiEvent.h"
+#include "TimePos.h"
+
+
+class MidiPort;
+
+
+//! What a MIDI port sends during a period, queued by the audio engine and
+//! given to the MIDI client at the end of the period, see
+//! MidiClient::processOutEvents()
+struct MidiOutEvent
+{
+	const MidiPort * port;
+	MidiEvent event;
+	TimePos time;
+	//! Frames into the period
+	f_cnt_t offset;
+} ;
+
+
+#endif
@@ -102,8 +102,15 @@ public:
 		return outputChannel() ? outputChannel() - 1 : 0;
 	}
 
-	void processInEvent( const MidiEvent& event, const TimePos& time = TimePos() );
-	void processOutEvent( const MidiEvent& event, const TimePos& time = TimePos() );
+	//! Queues @p event for the audio engine, which gives it to the event
+	//! processor at the frame it was received at. @p timestamp is when it
+	//! was received (see AudioEngineProfiler::now()), -1 for now.
+	void processInEvent( const MidiEvent& event, const TimePos& time = TimePos(), qint64 timestamp = -1 );
+	//! Called by the audio engine for the events queued by processInEvent()
+	void dispatchInEvent( const MidiEvent& event, const TimePos& time, f_cnt_t offset );
+	//! Queues the event for the MIDI client, which gets it at the end of
+	//! the period, together with its @p offset into the period
+	void processOutEvent( const MidiEvent& event, const TimePos& time = TimePos(), f_cnt_t offset = 0 );
 
 
 	void saveSettings( QDomDocument& doc, QDomElement& thisElement ) override;
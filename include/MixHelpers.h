@@ -26,11 +26,48 @@
 #define MIX_HELPERS_H
 
 #include "lmms_basics.h"
+#include "PlanarBuffer.h"
 
 class ValueBuffer;
+struct ValueRamp;
 namespace MixHelpers
 {
 
+/*! \brief Instruction sets the helpers below have implementations for */
+enum class Kernels
+{
+	Generic,
+	SSE2,
+	AVX,
+	AVX512,
+	NEON
+} ;
+
+/*! \brief Full scale of the conversions to integers. 24 bit samples are converted to the upper
+ *         bytes of 32 bit ones, so their full scale is the largest float below 2^31 with 24 significant bits */
+constexpr float S16Scale = 32767.0f;
+constexpr float S24Scale = 2147483392.0f;
+/*! \brief One LSB of the 24 bit samples in the 32 bit ones */
+constexpr float S24DitherScale = 256.0f;
+
+/*! \brief How panning distributes a signal over the left and right channel */
+enum class PanLaw
+{
+	//! Only attenuates the opposite channel, the center stays at 0 dB
+	Linear,
+	//! Keeps the power constant, the center is at -3 dB
+	ConstantPower,
+	//! Like ConstantPower, but +3 dB louder so the center stays at 0 dB
+	ConstantPowerUnityCenter
+} ;
+
+/*! \brief The kernels in use - the best ones the CPU supports, chosen at startup */
+Kernels kernels();
+
+/*! \brief Switch to the given kernels, e.g. for comparing them in tests. Returns false if
+ *         LMMS was built without them or the CPU doesn't support them */
+bool setKernels( Kernels k );
+
 bool isSilent( const sampleFrame* src, int frames );
 
 bool useNaNHandler();
@@ -39,6 +76,34 @@ void setNaNHandler( bool use );
 
 bool sanitize( sampleFrame * src, int frames );
 
+/*! \brief sanitize() for planar buffers */
+bool sanitize( const PlanarBuffer & buf );
+
+/*! \brief Copy interleaved frames from src into the channels of dst */
+void deinterleave( const PlanarBuffer & dst, const sampleFrame* src );
+
+/*! \brief Copy the channels of src into interleaved frames in dst */
+void interleave( sampleFrame* dst, const PlanarBuffer & src );
+
+/*! \brief Absolute peak values of the left and right channel, NaNs are ignored */
+sampleFrame peak( const sampleFrame* src, int frames );
+
+/*! \brief Sum of the squares of all samples of both channels */
+float energy( const sampleFrame* src, int frames );
+
+/*! \brief Sum of the squares of all samples of both channels, each with the sign of its sample */
+float signedEnergy( const sampleFrame* src, int frames );
+
+/*! \brief Multiply dst by the volume and the panning gains of the law. Volume and panning are in percent,
+ *         like the values of the models. If volumeBuf or panningBuf is given, it replaces the constant value */
+void applyVolumeAndPanning( sampleFrame* dst, float volume, ValueBuffer * volumeBuf,
+							float panning, ValueBuffer * panningBuf, PanLaw law, int frames );
+
+/*! \brief Same as applyVolumeAndPanning, but with ramping volume and panning. The frames are split into
+ *         sub-blocks of up to interval frames, which use the values of their middle */
+void applyVolumeAndPanning( sampleFrame* dst, const ValueRamp & volume, const ValueRamp & panning,
+							PanLaw law, int interval, int frames );
+
 /*! \brief Add samples from src to dst */
 void add( sampleFrame* dst, const sampleFrame* src, int frames );
 
@@ -64,6 +129,25 @@ void addSanitizedMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, f
 /*! \brief Add samples from src multiplied by coeffSrc and coeffSrcBuf to dst - sanitized version */
 void addSanitizedMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames );
 
+/*! \brief Add samples from src multiplied by coeffSrc and, if given, by coeffSrcBuf1 and coeffSrcBuf2 to dst,
+ *         sanitized if the NaN handler is on. Returns the peak values of dst afterwards, so it doesn't have to be
+ *         scanned again for them */
+sampleFrame addSanitizedMultipliedWithPeak( sampleFrame* dst, const sampleFrame* src, float coeffSrc, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames );
+
+/*! \brief Same as addSanitizedMultipliedWithPeak, but never sanitized, for sources that were sanitized
+ *         already */
+sampleFrame addMultipliedWithPeak( sampleFrame* dst, const sampleFrame* src, float coeffSrc, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames );
+
+/*! \brief Same as addMultipliedWithPeak, but with the product of two ramping coefficients, in sub-blocks
+ *         of up to interval frames like applyVolumeAndPanning */
+sampleFrame addMultipliedWithPeak( sampleFrame* dst, const sampleFrame* src, const ValueRamp & coeffSrc1,
+							const ValueRamp & coeffSrc2, int interval, int frames );
+
+/*! \brief Same as addMultiplied, but with a ramping coefficient, in sub-blocks of up to interval frames
+ *         like applyVolumeAndPanning */
+void addMultiplied( sampleFrame* dst, const sampleFrame* src, const ValueRamp & coeffSrc,
+							int interval, int frames );
+
 /*! \brief Add samples from src multiplied by coeffSrcLeft/coeffSrcRight to dst */
 void addMultipliedStereo( sampleFrame* dst, const sampleFrame* src, float coeffSrcLeft, float coeffSrcRight, int frames );
 
@@ -73,6 +157,28 @@ void multiplyAndAddMultiplied( sampleFrame* dst, const sampleFrame* src, float c
 /*! \brief Multiply dst by coeffDst and add samples from srcLeft/srcRight multiplied by coeffSrc */
 void multiplyAndAddMultipliedJoined( sampleFrame* dst, const sample_t* srcLeft, const sample_t* srcRight, float coeffDst, float coeffSrc, int frames );
 
+/*! \brief Copy samples from src multiplied by coeffSrc to dst */
+void copyMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames );
+
+/*! \brief Convert samples from src multiplied by gain to clipped 16 bit samples, interleaved in dst. If given,
+ *         dither holds noise in LSBs to add to each sample before it is truncated */
+void convertToS16( int_sample_t* dst, const sampleFrame* src, float gain, const float * dither, bool swapBytes, int frames );
+
+/*! \brief Like convertToS16(), but to 24 bit samples in the upper bytes of 32 bit ones, as libsndfile takes them */
+void convertToS24( int32_t* dst, const sampleFrame* src, float gain, const float * dither, int frames );
+
+/*! \brief Waveshape src into dst: multiply it by inputGain, clip it to -1..1 if clip is set, replace the magnitudes
+ *         by the values of table, linearly interpolated, and multiply by outputGain. table holds points + 1 values,
+ *         for the magnitudes 0, 1 / points ... 1. Beyond 1 the magnitude is scaled by the last value. If
+ *         inputGainBuf or outputGainBuf is given, it replaces the constant gain */
+void shape( sampleFrame* dst, const sampleFrame* src, const float * table, int points, float inputGain,
+		ValueBuffer * inputGainBuf, float outputGain, ValueBuffer * outputGainBuf, bool clip, int frames );
+
+/*! \brief Multiply buf by gain and add noise, multiplied by noiseAmount and the sample, then round the samples to
+ *         multiples of 1 / levels. noise holds one value per sample or is nullptr, levels 0 leaves the samples
+ *         unrounded */
+void quantize( sampleFrame* buf, const sampleFrame* noise, float gain, float noiseAmount, float levels, int frames );
+
 }
 
 #endif
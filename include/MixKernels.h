@@ -0,0 +1,753 @@
+/*
+ * MixKernels.h - vectorised implementations of the MixHelpers
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef MIX_KERNELS_H
+#define MIX_KERNELS_H
+
+#include "lmms_basics.h"
+#include "MixHelpers.h"
+
+namespace MixHelpers
+{
+
+//! One set of implementations of the MixHelpers. Coefficient buffers hold
+//! one value per frame.
+struct KernelTable
+{
+	bool (*isSilent)(const sampleFrame * src, int frames);
+	bool (*sanitize)(sampleFrame * src, int frames);
+	void (*add)(sampleFrame * dst, const sampleFrame * src, int frames);
+	void (*addMultiplied)(sampleFrame * dst, const sampleFrame * src, float coeffSrc, int frames);
+	void (*addSwappedMultiplied)(sampleFrame * dst, const sampleFrame * src, float coeffSrc, int frames);
+	void (*addMultipliedByBuffer)(sampleFrame * dst, const sampleFrame * src, float coeffSrc,
+		const float * coeffSrcBuf, int frames);
+	void (*addMultipliedByBuffers)(sampleFrame * dst, const sampleFrame * src,
+		const float * coeffSrcBuf1, const float * coeffSrcBuf2, int frames);
+	void (*addSanitizedMultiplied)(sampleFrame * dst, const sampleFrame * src, float coeffSrc, int frames);
+	void (*addSanitizedMultipliedByBuffer)(sampleFrame * dst, const sampleFrame * src, float coeffSrc,
+		const float * coeffSrcBuf, int frames);
+	void (*addSanitizedMultipliedByBuffers)(sampleFrame * dst, const sampleFrame * src,
+		const float * coeffSrcBuf1, const float * coeffSrcBuf2, int frames);
+	void (*addMultipliedStereo)(sampleFrame * dst, const sampleFrame * src,
+		float coeffSrcLeft, float coeffSrcRight, int frames);
+	void (*multiplyAndAddMultiplied)(sampleFrame * dst, const sampleFrame * src,
+		float coeffDst, float coeffSrc, int frames);
+	void (*multiplyAndAddMultipliedJoined)(sampleFrame * dst, const sample_t * srcLeft,
+		const sample_t * srcRight, float coeffDst, float coeffSrc, int frames);
+	sampleFrame (*peak)(const sampleFrame * src, int frames);
+	float (*energy)(const sampleFrame * src, int frames);
+	float (*signedEnergy)(const sampleFrame * src, int frames);
+	void (*interleave)(sampleFrame * dst, const sample_t * srcLeft, const sample_t * srcRight, int frames);
+	void (*deinterleave)(sample_t * dstLeft, sample_t * dstRight, const sampleFrame * src, int frames);
+	//! coeffSrcBuf2 may only be given together with coeffSrcBuf1
+	sampleFrame (*addMultipliedWithPeak)(sampleFrame * dst, const sampleFrame * src, float coeffSrc,
+		const float * coeffSrcBuf1, const float * coeffSrcBuf2, bool sanitized, int frames);
+	//! volume and panning in percent, the buffers replace them if given
+	void (*applyVolumeAndPanning)(sampleFrame * dst, float volume, const float * volumeBuf,
+		float panning, const float * panningBuf, PanLaw law, int frames);
+	void (*copyMultiplied)(sampleFrame * dst, const sampleFrame * src, float coeffSrc, int frames);
+	//! dither holds one value per sample, in LSBs of the output, or is nullptr
+	void (*convertToS16)(int_sample_t * dst, const sampleFrame * src, float gain, const float * dither,
+		bool swapBytes, int frames);
+	void (*convertToS24)(int32_t * dst, const sampleFrame * src, float gain, const float * dither, int frames);
+	//! the gain buffers replace the gains if given, table holds points + 1 values
+	void (*shape)(sampleFrame * dst, const sampleFrame * src, const float * table, int points,
+		float inputGain, const float * inputGainBuf, float outputGain, const float * outputGainBuf,
+		bool clip, int frames);
+	//! noise holds one value per sample or is nullptr, levels 0 doesn't quantize
+	void (*quantize)(sampleFrame * buf, const sampleFrame * noise, float gain, float noiseAmount,
+		float levels, int frames);
+} ;
+
+//! These return nullptr if LMMS was built without the instruction set.
+//! Whether the CPU supports it is up to the caller to check.
+const KernelTable * sse2Kernels();
+const KernelTable * avxKernels();
+const KernelTable * avx512Kernels();
+const KernelTable * neonKernels();
+
+
+// Everything below is only for the MixKernels*.cpp files. Each of them is
+// built for another instruction set, so nothing in here may have external
+// linkage and it must not call any inline functions from other headers
+// (those might get emitted with instructions the CPU doesn't have and then
+// be picked by the linker for the whole program). Use compiler builtins.
+namespace
+{
+
+//! "Instruction set" working on a single frame, used for the frames left
+//! over after the last full vector
+struct FrameOps
+{
+	struct Reg { float v[2]; } ;
+	static constexpr int Width = 2;
+
+	static Reg load(const float * p) { return {{p[0], p[1]}}; }
+	static void store(float * p, Reg a) { p[0] = a.v[0]; p[1] = a.v[1]; }
+	static Reg set1(float a) { return {{a, a}}; }
+	static Reg setPair(float left, float right) { return {{left, right}}; }
+	static Reg loadDup(const float * p) { return {{p[0], p[0]}}; }
+	static Reg loadJoined(const float * left, const float * right) { return {{left[0], right[0]}}; }
+	static void storeSplit(float * left, float * right, Reg a) { left[0] = a.v[0]; right[0] = a.v[1]; }
+
+	static Reg add(Reg a, Reg b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1]}}; }
+	static Reg sub(Reg a, Reg b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1]}}; }
+	static Reg mul(Reg a, Reg b) { return {{a.v[0] * b.v[0], a.v[1] * b.v[1]}}; }
+	static Reg swapPairs(Reg a) { return {{a.v[1], a.v[0]}}; }
+	static Reg abs(Reg a) { return {{__builtin_fabsf(a.v[0]), __builtin_fabsf(a.v[1])}}; }
+	static Reg sqrt(Reg a) { return {{__builtin_sqrtf(a.v[0]), __builtin_sqrtf(a.v[1])}}; }
+	//! a > b ? a : b, so a NaN in @p a is ignored
+	static Reg max(Reg a, Reg b) { return {{a.v[0] > b.v[0] ? a.v[0] : b.v[0], a.v[1] > b.v[1] ? a.v[1] : b.v[1]}}; }
+	//! a < b ? a : b, so a NaN in @p a is ignored
+	static Reg min(Reg a, Reg b) { return {{a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1]}}; }
+	//! Towards zero, for values in the range of the integers
+	static Reg truncate(Reg a) { return {{__builtin_truncf(a.v[0]), __builtin_truncf(a.v[1])}}; }
+	//! Like roundf(), halfway cases away from zero
+	static Reg round(Reg a) { return {{__builtin_roundf(a.v[0]), __builtin_roundf(a.v[1])}}; }
+	//! @p a, negated where the sign bit of @p sign is set
+	static Reg flipSign(Reg a, Reg sign)
+	{
+		return {{__builtin_signbit(sign.v[0]) ? -a.v[0] : a.v[0], __builtin_signbit(sign.v[1]) ? -a.v[1] : a.v[1]}};
+	}
+	//! The values of @p table at @p index, which holds integers
+	static Reg gather(const float * table, Reg index)
+	{
+		return {{table[static_cast<int>(index.v[0])], table[static_cast<int>(index.v[1])]}};
+	}
+
+	//! qBound(lo, a, hi) for finite values
+	static Reg clamp(Reg a, float lo, float hi)
+	{
+		for (float & v : a.v) { v = v < hi ? v : hi; v = v > lo ? v : lo; }
+		return a;
+	}
+	//! @p a where @p test is neither inf nor NaN, 0 elsewhere
+	static Reg zeroUnlessFinite(Reg test, Reg a)
+	{
+		return {{__builtin_isfinite(test.v[0]) ? a.v[0] : 0.0f,
+			__builtin_isfinite(test.v[1]) ? a.v[1] : 0.0f}};
+	}
+	static bool hasNonFinite(Reg a)
+	{
+		return !__builtin_isfinite(a.v[0]) || !__builtin_isfinite(a.v[1]);
+	}
+	//! Whether any absolute value is >= @p threshold
+	static bool hasAbove(Reg a, float threshold)
+	{
+		return __builtin_fabsf(a.v[0]) >= threshold || __builtin_fabsf(a.v[1]) >= threshold;
+	}
+
+	//! Truncates values in the range of the integers
+	static void storeS16(int_sample_t * p, Reg a, bool swapBytes)
+	{
+		for (int i = 0; i < 2; ++i)
+		{
+			const uint16_t v = static_cast<uint16_t>(static_cast<int_sample_t>(a.v[i]));
+			p[i] = static_cast<int_sample_t>(swapBytes ? (v << 8 | v >> 8) : v);
+		}
+	}
+	static void storeS32(int32_t * p, Reg a)
+	{
+		p[0] = static_cast<int32_t>(a.v[0]);
+		p[1] = static_cast<int32_t>(a.v[1]);
+	}
+} ;
+
+
+
+
+//! Implements the KernelTable on top of an instruction set I. Every
+//! operation is done in the same order as in the generic MixHelpers, so
+//! unless the compiler fuses multiplies and adds the results are identical.
+template<class I>
+struct MixKernels
+{
+	//! Runs op(ops, dst, src, coeffs...) on all frames. The coefficient
+	//! buffers are expanded to one value per sample.
+	template<class Op, class... Coeffs>
+	static void run(sampleFrame * dst, const sampleFrame * src, int frames, Op op, const Coeffs * ... coeffs)
+	{
+		float * d = reinterpret_cast<float *>(dst);
+		const float * s = reinterpret_cast<const float *>(src);
+		int f = 0;
+		for (; f + I::Width / 2 <= frames; f += I::Width / 2)
+		{
+			I::store(d + 2 * f, op(I(), I::load(d + 2 * f), I::load(s + 2 * f), I::loadDup(coeffs + f)...));
+		}
+		for (; f < frames; ++f)
+		{
+			FrameOps::store(d + 2 * f, op(FrameOps(), FrameOps::load(d + 2 * f),
+				FrameOps::load(s + 2 * f), FrameOps::loadDup(coeffs + f)...));
+		}
+	}
+
+	template<class Op>
+	static void runJoined(sampleFrame * dst, const sample_t * left, const sample_t * right, int frames, Op op)
+	{
+		float * d = reinterpret_cast<float *>(dst);
+		int f = 0;
+		for (; f + I::Width / 2 <= frames; f += I::Width / 2)
+		{
+			I::store(d + 2 * f, op(I(), I::load(d + 2 * f), I::loadJoined(left + f, right + f)));
+		}
+		for (; f < frames; ++f)
+		{
+			FrameOps::store(d + 2 * f, op(FrameOps(), FrameOps::load(d + 2 * f),
+				FrameOps::loadJoined(left + f, right + f)));
+		}
+	}
+
+	//! Like run(), returns the absolute peak values of dst afterwards
+	template<class Op, class... Coeffs>
+	static sampleFrame runWithPeak(sampleFrame * dst, const sampleFrame * src, int frames, Op op,
+		const Coeffs * ... coeffs)
+	{
+		float * d = reinterpret_cast<float *>(dst);
+		const float * s = reinterpret_cast<const float *>(src);
+		typename I::Reg peak = I::set1(0.0f);
+		FrameOps::Reg framePeak = FrameOps::set1(0.0f);
+		int f = 0;
+		for (; f + I::Width / 2 <= frames; f += I::Width / 2)
+		{
+			const typename I::Reg mixed = op(I(), I::load(d + 2 * f), I::load(s + 2 * f), I::loadDup(coeffs + f)...);
+			I::store(d + 2 * f, mixed);
+			peak = I::max(I::abs(mixed), peak);
+		}
+		for (; f < frames; ++f)
+		{
+			const FrameOps::Reg mixed = op(FrameOps(), FrameOps::load(d + 2 * f),
+				FrameOps::load(s + 2 * f), FrameOps::loadDup(coeffs + f)...);
+			FrameOps::store(d + 2 * f, mixed);
+			framePeak = FrameOps::max(FrameOps::abs(mixed), framePeak);
+		}
+		return reducePeak(peak, framePeak);
+	}
+
+	//! Passes the samples of src, scaled to +-scale and with the dither
+	//! added, to store(ops, sample index, samples)
+	template<class Store>
+	static void convert(const sampleFrame * src, float gain, float scale, const float * dither,
+		float ditherScale, int frames, Store store)
+	{
+		const float * s = reinterpret_cast<const float *>(src);
+		const float g = gain * scale;
+		auto scaled = [s, g, scale, dither, ditherScale](auto ops, int i)
+		{
+			auto v = ops.mul(ops.load(s + i), ops.set1(g));
+			if (dither) { v = ops.add(v, ops.mul(ops.load(dither + i), ops.set1(ditherScale))); }
+			return ops.clamp(v, -scale, scale);
+		};
+		int f = 0;
+		for (; f + I::Width / 2 <= frames; f += I::Width / 2)
+		{
+			store(I(), 2 * f, scaled(I(), 2 * f));
+		}
+		for (; f < frames; ++f)
+		{
+			store(FrameOps(), 2 * f, scaled(FrameOps(), 2 * f));
+		}
+	}
+
+	static sampleFrame reducePeak(typename I::Reg peak, FrameOps::Reg framePeak)
+	{
+		float lanes[I::Width];
+		I::store(lanes, peak);
+		for (int i = 0; i < I::Width; i += 2)
+		{
+			framePeak = FrameOps::max(FrameOps::load(lanes + i), framePeak);
+		}
+		return sampleFrame{framePeak.v[0], framePeak.v[1]};
+	}
+
+	static sampleFrame peak(const sampleFrame * src, int frames)
+	{
+		const float * s = reinterpret_cast<const float *>(src);
+		typename I::Reg peak = I::set1(0.0f);
+		FrameOps::Reg framePeak = FrameOps::set1(0.0f);
+		int f = 0;
+		for (; f + I::Width / 2 <= frames; f += I::Width / 2)
+		{
+			peak = I::max(I::abs(I::load(s + 2 * f)), peak);
+		}
+		for (; f < frames; ++f)
+		{
+			framePeak = FrameOps::max(FrameOps::abs(FrameOps::load(s + 2 * f)), framePeak);
+		}
+		return reducePeak(peak, framePeak);
+	}
+
+	//! Sums in one lane per sample of a vector, so the result is rounded
+	//! differently than the generic one. Signed squares keep the signs of
+	//! the samples.
+	template<bool Signed>
+	static float sumOfSquares(const sampleFrame * src, int frames)
+	{
+		const float * s = reinterpret_cast<const float *>(src);
+		typename I::Reg sum = I::set1(0.0f);
+		FrameOps::Reg frameSum = FrameOps::set1(0.0f);
+		int f = 0;
+		for (; f + I::Width / 2 <= frames; f += I::Width / 2)
+		{
+			const typename I::Reg a = I::load(s + 2 * f);
+			sum = I::add(sum, I::mul(a, Signed ? I::abs(a) : a));
+		}
+		for (; f < frames; ++f)
+		{
+			const FrameOps::Reg a = FrameOps::load(s + 2 * f);
+			frameSum = FrameOps::add(frameSum, FrameOps::mul(a, Signed ? FrameOps::abs(a) : a));
+		}
+		float lanes[I::Width];
+		I::store(lanes, sum);
+		float total = frameSum.v[0] + frameSum.v[1];
+		for (int i = 0; i < I::Width; ++i)
+		{
+			total += lanes[i];
+		}
+		return total;
+	}
+
+	static bool isSilent(const sampleFrame * src, int frames)
+	{
+		const float silenceThreshold = 0.0000001f;
+		const float * s = reinterpret_cast<const float *>(src);
+		int f = 0;
+		for (; f + I::Width / 2 <= frames; f += I::Width / 2)
+		{
+			if (I::hasAbove(I::load(s + 2 * f), silenceThreshold)) { return false; }
+		}
+		for (; f < frames; ++f)
+		{
+			if (FrameOps::hasAbove(FrameOps::load(s + 2 * f), silenceThreshold)) { return false; }
+		}
+		return true;
+	}
+
+	template<class J>
+	static bool sanitizeAt(J, float * s)
+	{
+		const typename J::Reg a = J::load(s);
+		if (J::hasNonFinite(a)) { return true; }
+		J::store(s, J::clamp(a, -1000.0f, 1000.0f));
+		return false;
+	}
+
+	static bool sanitize(sampleFrame * src, int frames)
+	{
+		float * s = reinterpret_cast<float *>(src);
+		int f = 0;
+		bool found = false;
+		for (; !found && f + I::Width / 2 <= frames; f += I::Width / 2)
+		{
+			found = sanitizeAt(I(), s + 2 * f);
+		}
+		for (; !found && f < frames; ++f)
+		{
+			found = sanitizeAt(FrameOps(), s + 2 * f);
+		}
+		if (found)
+		{
+			for (int i = 0; i < frames * 2; ++i) { s[i] = 0.0f; }
+		}
+		return found;
+	}
+
+	static void add(sampleFrame * dst, const sampleFrame * src, int frames)
+	{
+		run(dst, src, frames, [](auto ops, auto d, auto s) { return ops.add(d, s); });
+	}
+
+	static void addMultiplied(sampleFrame * dst, const sampleFrame * src, float coeffSrc, int frames)
+	{
+		run(dst, src, frames, [coeffSrc](auto ops, auto d, auto s)
+		{
+			return ops.add(d, ops.mul(s, ops.set1(coeffSrc)));
+		});
+	}
+
+	static void addSwappedMultiplied(sampleFrame * dst, const sampleFrame * src, float coeffSrc, int frames)
+	{
+		run(dst, src, frames, [coeffSrc](auto ops, auto d, auto s)
+		{
+			return ops.add(d, ops.mul(ops.swapPairs(s), ops.set1(coeffSrc)));
+		});
+	}
+
+	static void addMultipliedByBuffer(sampleFrame * dst, const sampleFrame * src, float coeffSrc,
+		const float * coeffSrcBuf, int frames)
+	{
+		run(dst, src, frames, [coeffSrc](auto ops, auto d, auto s, auto c)
+		{
+			return ops.add(d, ops.mul(ops.mul(s, ops.set1(coeffSrc)), c));
+		}, coeffSrcBuf);
+	}
+
+	static void addMultipliedByBuffers(sampleFrame * dst, const sampleFrame * src,
+		const float * coeffSrcBuf1, const float * coeffSrcBuf2, int frames)
+	{
+		run(dst, src, frames, [](auto ops, auto d, auto s, auto c1, auto c2)
+		{
+			return ops.add(d, ops.mul(ops.mul(s, c1), c2));
+		}, coeffSrcBuf1, coeffSrcBuf2);
+	}
+
+	static void addSanitizedMultiplied(sampleFrame * dst, const sampleFrame * src, float coeffSrc, int frames)
+	{
+		run(dst, src, frames, [coeffSrc](auto ops, auto d, auto s)
+		{
+			return ops.add(d, ops.zeroUnlessFinite(s, ops.mul(s, ops.set1(coeffSrc))));
+		});
+	}
+
+	static void addSanitizedMultipliedByBuffer(sampleFrame * dst, const sampleFrame * src, float coeffSrc,
+		const float * coeffSrcBuf, int frames)
+	{
+		run(dst, src, frames, [coeffSrc](auto ops, auto d, auto s, auto c)
+		{
+			return ops.add(d, ops.zeroUnlessFinite(s, ops.mul(ops.mul(s, ops.set1(coeffSrc)), c)));
+		}, coeffSrcBuf);
+	}
+
+	static void addSanitizedMultipliedByBuffers(sampleFrame * dst, const sampleFrame * src,
+		const float * coeffSrcBuf1, const float * coeffSrcBuf2, int frames)
+	{
+		run(dst, src, frames, [](auto ops, auto d, auto s, auto c1, auto c2)
+		{
+			return ops.add(d, ops.zeroUnlessFinite(s, ops.mul(ops.mul(s, c1), c2)));
+		}, coeffSrcBuf1, coeffSrcBuf2);
+	}
+
+	static void addMultipliedStereo(sampleFrame * dst, const sampleFrame * src,
+		float coeffSrcLeft, float coeffSrcRight, int frames)
+	{
+		run(dst, src, frames, [coeffSrcLeft, coeffSrcRight](auto ops, auto d, auto s)
+		{
+			return ops.add(d, ops.mul(s, ops.setPair(coeffSrcLeft, coeffSrcRight)));
+		});
+	}
+
+	static void multiplyAndAddMultiplied(sampleFrame * dst, const sampleFrame * src,
+		float coeffDst, float coeffSrc, int frames)
+	{
+		run(dst, src, frames, [coeffDst, coeffSrc](auto ops, auto d, auto s)
+		{
+			return ops.add(ops.mul(d, ops.set1(coeffDst)), ops.mul(s, ops.set1(coeffSrc)));
+		});
+	}
+
+	static void multiplyAndAddMultipliedJoined(sampleFrame * dst, const sample_t * srcLeft,
+		const sample_t * srcRight, float coeffDst, float coeffSrc, int frames)
+	{
+		runJoined(dst, srcLeft, srcRight, frames, [coeffDst, coeffSrc](auto ops, auto d, auto s)
+		{
+			return ops.add(ops.mul(d, ops.set1(coeffDst)), ops.mul(s, ops.set1(coeffSrc)));
+		});
+	}
+
+	template<bool Sanitized>
+	static sampleFrame addMultipliedWithPeak(sampleFrame * dst, const sampleFrame * src, float coeffSrc,
+		const float * coeffSrcBuf1, const float * coeffSrcBuf2, int frames)
+	{
+		auto op = [coeffSrc](auto ops, auto d, auto s, auto... c)
+		{
+			auto mixed = ops.mul(s, ops.set1(coeffSrc));
+			((mixed = ops.mul(mixed, c)), ...);
+			if constexpr (Sanitized) { mixed = ops.zeroUnlessFinite(s, mixed); }
+			return ops.add(d, mixed);
+		};
+		if (coeffSrcBuf2) { return runWithPeak(dst, src, frames, op, coeffSrcBuf1, coeffSrcBuf2); }
+		if (coeffSrcBuf1) { return runWithPeak(dst, src, frames, op, coeffSrcBuf1); }
+		return runWithPeak(dst, src, frames, op);
+	}
+
+	static sampleFrame addMultipliedWithPeak(sampleFrame * dst, const sampleFrame * src, float coeffSrc,
+		const float * coeffSrcBuf1, const float * coeffSrcBuf2, bool sanitized, int frames)
+	{
+		return sanitized
+			? addMultipliedWithPeak<true>(dst, src, coeffSrc, coeffSrcBuf1, coeffSrcBuf2, frames)
+			: addMultipliedWithPeak<false>(dst, src, coeffSrc, coeffSrcBuf1, coeffSrcBuf2, frames);
+	}
+
+	static void interleave(sampleFrame * dst, const sample_t * srcLeft, const sample_t * srcRight, int frames)
+	{
+		float * d = reinterpret_cast<float *>(dst);
+		int f = 0;
+		for (; f + I::Width / 2 <= frames; f += I::Width / 2)
+		{
+			I::store(d + 2 * f, I::loadJoined(srcLeft + f, srcRight + f));
+		}
+		for (; f < frames; ++f)
+		{
+			FrameOps::store(d + 2 * f, FrameOps::loadJoined(srcLeft + f, srcRight + f));
+		}
+	}
+
+	static void deinterleave(sample_t * dstLeft, sample_t * dstRight, const sampleFrame * src, int frames)
+	{
+		const float * s = reinterpret_cast<const float *>(src);
+		int f = 0;
+		for (; f + I::Width / 2 <= frames; f += I::Width / 2)
+		{
+			I::storeSplit(dstLeft + f, dstRight + f, I::load(s + 2 * f));
+		}
+		for (; f < frames; ++f)
+		{
+			FrameOps::storeSplit(dstLeft + f, dstRight + f, FrameOps::load(s + 2 * f));
+		}
+	}
+
+	//! Gains of the left and right channel for panning values in -1..1
+	template<PanLaw Law, class J>
+	static typename J::Reg panningGains(J ops, typename J::Reg panning)
+	{
+		// 1 - p for the left and 1 + p for the right channel
+		const auto sides = ops.add(ops.set1(1.0f), ops.mul(panning, ops.setPair(-1.0f, 1.0f)));
+		if constexpr (Law == PanLaw::Linear)
+		{
+			return ops.clamp(sides, 0.0f, 1.0f);
+		}
+		else if constexpr (Law == PanLaw::ConstantPower)
+		{
+			return ops.sqrt(ops.mul(ops.clamp(sides, 0.0f, 2.0f), ops.set1(0.5f)));
+		}
+		else
+		{
+			return ops.sqrt(ops.clamp(sides, 0.0f, 2.0f));
+		}
+	}
+
+	template<PanLaw Law>
+	static void applyVolumeAndPanning(sampleFrame * dst, float volume, const float * volumeBuf,
+		float panning, const float * panningBuf, int frames)
+	{
+		const auto gains = [](auto ops, auto v, auto p)
+		{
+			return ops.mul(panningGains<Law>(ops, ops.mul(p, ops.set1(0.01f))), ops.mul(v, ops.set1(0.01f)));
+		};
+		if (volumeBuf && panningBuf)
+		{
+			run(dst, dst, frames, [gains](auto ops, auto d, auto, auto v, auto p)
+			{
+				return ops.mul(d, gains(ops, v, p));
+			}, volumeBuf, panningBuf);
+		}
+		else if (volumeBuf)
+		{
+			run(dst, dst, frames, [gains, panning](auto ops, auto d, auto, auto v)
+			{
+				return ops.mul(d, gains(ops, v, ops.set1(panning)));
+			}, volumeBuf);
+		}
+		else if (panningBuf)
+		{
+			run(dst, dst, frames, [gains, volume](auto ops, auto d, auto, auto p)
+			{
+				return ops.mul(d, gains(ops, ops.set1(volume), p));
+			}, panningBuf);
+		}
+		else
+		{
+			const FrameOps::Reg g = gains(FrameOps(), FrameOps::set1(volume), FrameOps::set1(panning));
+			run(dst, dst, frames, [g](auto ops, auto d, auto)
+			{
+				return ops.mul(d, ops.setPair(g.v[0], g.v[1]));
+			});
+		}
+	}
+
+	static void applyVolumeAndPanning(sampleFrame * dst, float volume, const float * volumeBuf,
+		float panning, const float * panningBuf, PanLaw law, int frames)
+	{
+		switch (law)
+		{
+			case PanLaw::Linear:
+				applyVolumeAndPanning<PanLaw::Linear>(dst, volume, volumeBuf, panning, panningBuf, frames);
+				break;
+			case PanLaw::ConstantPower:
+				applyVolumeAndPanning<PanLaw::ConstantPower>(dst, volume, volumeBuf, panning, panningBuf, frames);
+				break;
+			case PanLaw::ConstantPowerUnityCenter:
+				applyVolumeAndPanning<PanLaw::ConstantPowerUnityCenter>(dst, volume, volumeBuf,
+					panning, panningBuf, frames);
+				break;
+		}
+	}
+
+	static void copyMultiplied(sampleFrame * dst, const sampleFrame * src, float coeffSrc, int frames)
+	{
+		run(dst, src, frames, [coeffSrc](auto ops, auto, auto s) { return ops.mul(s, ops.set1(coeffSrc)); });
+	}
+
+	static void convertToS16(int_sample_t * dst, const sampleFrame * src, float gain, const float * dither,
+		bool swapBytes, int frames)
+	{
+		convert(src, gain, S16Scale, dither, 1.0f, frames, [dst, swapBytes](auto ops, int i, auto v)
+		{
+			ops.storeS16(dst + i, v, swapBytes);
+		});
+	}
+
+	static void convertToS24(int32_t * dst, const sampleFrame * src, float gain, const float * dither, int frames)
+	{
+		convert(src, gain, S24Scale, dither, S24DitherScale, frames, [dst](auto ops, int i, auto v)
+		{
+			ops.storeS32(dst + i, v);
+		});
+	}
+
+	//! The table lookup of shape(), after the input gain
+	template<bool Clip, class J>
+	static typename J::Reg shapeSamples(J ops, typename J::Reg s, const float * table, int points)
+	{
+		if constexpr (Clip) { s = ops.clamp(s, -1.0f, 1.0f); }
+		const auto magnitude = ops.abs(s);
+		const auto x = ops.min(ops.mul(magnitude, ops.set1(float(points))), ops.set1(float(points)));
+		const auto index = ops.min(ops.truncate(x), ops.set1(float(points - 1)));
+		const auto lower = ops.gather(table, index);
+		const auto upper = ops.gather(table + 1, index);
+		auto shaped = ops.add(lower, ops.mul(ops.sub(upper, lower), ops.sub(x, index)));
+		// beyond 1 the magnitude is scaled by the last value
+		const auto excess = ops.max(ops.sub(magnitude, ops.set1(1.0f)), ops.set1(0.0f));
+		shaped = ops.add(shaped, ops.mul(excess, ops.set1(table[points])));
+		return ops.flipSign(shaped, s);
+	}
+
+	template<bool Clip>
+	static void shape(sampleFrame * dst, const sampleFrame * src, const float * table, int points,
+		float inputGain, const float * inputGainBuf, float outputGain, const float * outputGainBuf, int frames)
+	{
+		const auto shaped = [table, points](auto ops, auto s, auto in, auto out)
+		{
+			return ops.mul(shapeSamples<Clip>(ops, ops.mul(s, in), table, points), out);
+		};
+		if (inputGainBuf && outputGainBuf)
+		{
+			run(dst, src, frames, [shaped](auto ops, auto, auto s, auto in, auto out)
+			{
+				return shaped(ops, s, in, out);
+			}, inputGainBuf, outputGainBuf);
+		}
+		else if (inputGainBuf)
+		{
+			run(dst, src, frames, [shaped, outputGain](auto ops, auto, auto s, auto in)
+			{
+				return shaped(ops, s, in, ops.set1(outputGain));
+			}, inputGainBuf);
+		}
+		else if (outputGainBuf)
+		{
+			run(dst, src, frames, [shaped, inputGain](auto ops, auto, auto s, auto out)
+			{
+				return shaped(ops, s, ops.set1(inputGain), out);
+			}, outputGainBuf);
+		}
+		else
+		{
+			run(dst, src, frames, [shaped, inputGain, outputGain](auto ops, auto, auto s)
+			{
+				return shaped(ops, s, ops.set1(inputGain), ops.set1(outputGain));
+			});
+		}
+	}
+
+	static void shape(sampleFrame * dst, const sampleFrame * src, const float * table, int points,
+		float inputGain, const float * inputGainBuf, float outputGain, const float * outputGainBuf,
+		bool clip, int frames)
+	{
+		clip
+			? shape<true>(dst, src, table, points, inputGain, inputGainBuf, outputGain, outputGainBuf, frames)
+			: shape<false>(dst, src, table, points, inputGain, inputGainBuf, outputGain, outputGainBuf, frames);
+	}
+
+	template<bool Noise, bool Quantized>
+	static void quantize(sampleFrame * buf, const sampleFrame * noise, float gain, float noiseAmount,
+		float levels, int frames)
+	{
+		const float ratio = Quantized ? 1.0f / levels : 1.0f;
+		// without noise the second source is buf itself and ignored
+		run(buf, Noise ? noise : buf, frames, [gain, noiseAmount, levels, ratio](auto ops, auto d, auto n)
+		{
+			auto v = ops.mul(d, ops.set1(gain));
+			if constexpr (Noise) { v = ops.add(v, ops.mul(n, ops.mul(d, ops.set1(noiseAmount)))); }
+			if constexpr (Quantized) { v = ops.mul(ops.round(ops.mul(v, ops.set1(levels))), ops.set1(ratio)); }
+			return v;
+		});
+	}
+
+	static void quantize(sampleFrame * buf, const sampleFrame * noise, float gain, float noiseAmount,
+		float levels, int frames)
+	{
+		const bool quantized = levels > 0.0f;
+		if (noise)
+		{
+			quantized
+				? quantize<true, true>(buf, noise, gain, noiseAmount, levels, frames)
+				: quantize<true, false>(buf, noise, gain, noiseAmount, levels, frames);
+		}
+		else
+		{
+			quantized
+				? quantize<false, true>(buf, noise, gain, noiseAmount, levels, frames)
+				: quantize<false, false>(buf, noise, gain, noiseAmount, levels, frames);
+		}
+	}
+
+	static const KernelTable * table()
+	{
+		static const KernelTable kernels = {
+			&isSilent,
+			&sanitize,
+			&add,
+			&addMultiplied,
+			&addSwappedMultiplied,
+			&addMultipliedByBuffer,
+			&addMultipliedByBuffers,
+			&addSanitizedMultiplied,
+			&addSanitizedMultipliedByBuffer,
+			&addSanitizedMultipliedByBuffers,
+			&addMultipliedStereo,
+			&multiplyAndAddMultiplied,
+			&multiplyAndAddMultipliedJoined,
+			&peak,
+			&sumOfSquares<false>,
+			&sumOfSquares<true>,
+			&interleave,
+			&deinterleave,
+			&addMultipliedWithPeak,
+			&applyVolumeAndPanning,
+			&copyMultiplied,
+			&convertToS16,
+			&convertToS24,
+			&shape,
+			&quantize
+		};
+		return &kernels;
+	}
+} ;
+
+} // namespace
+
+} // namespace MixHelpers
+
+#endif
@@ -28,6 +28,7 @@
 #include "Model.h"
 #include "EffectChain.h"
 #include "JournallingObject.h"
+#include "LoadMeter.h"
 #include "ThreadableJob.h"
 
 #include <atomic>
@@ -50,9 +51,14 @@ class MixerChannel : public ThreadableJob
 		// set to true if any effect in the channel is enabled and running
 		bool m_stillRunning;
 
-		float m_peakLeft;
-		float m_peakRight;
+		// the highest peaks since the GUI took them, -1 if no period was
+		// processed since
+		std::atomic<float> m_peakLeft;
+		std::atomic<float> m_peakRight;
 		sampleFrame * m_buffer;
+		// set when m_buffer is known to contain only zeros, so it
+		// doesn't have to be mixed, scanned for peaks or cleared
+		bool m_bufferSilent;
 		bool m_muteBeforeSolo;
 		BoolModel m_muteModel;
 		BoolModel m_soloModel;
@@ -62,6 +68,7 @@ class MixerChannel : public ThreadableJob
 		int m_channelIndex; // what channel index are we
 		bool m_queued; // are we queued up for rendering yet?
 		bool m_muted; // are we muted? updated per period so we don't have to call m_muteModel.value() twice
+		bool m_extOutputEnabled; // also written to an output of its own by the audio device
 
 		// pointers to other channels that this one sends to
 		MixerRouteVector m_sends;
@@ -70,6 +77,9 @@ class MixerChannel : public ThreadableJob
 		MixerRouteVector m_receives;
 
 		bool requiresProcessing() const override { return true; }
+		Label jobLabel() const override { return { "Mixer channel", m_name }; }
+		LoadMeter * loadMeter() override { return &m_loadMeter; }
+		float outputPeak() const override;
 		void unmuteForSolo();
 
 
@@ -84,7 +94,12 @@ class MixerChannel : public ThreadableJob
 		bool m_hasColor;
 
 	
+		// number of inputs (sending channels and audio ports) that have
+		// to be processed before this channel can be processed
+		int m_numInputs;
 		std::atomic_int m_dependenciesMet;
+		// processing time of the channel's effects and sends
+		LoadMeter m_loadMeter;
 		void incrementDeps();
 		void processed();
 		
@@ -144,8 +159,19 @@ public:
 	void mixToChannel( const sampleFrame * _buf, mix_ch_t _ch );
 
 	void prepareMasterMix();
+
+	// render graph stuff - every mixer channel gets queued as soon as all
+	// of its inputs are ready, see AudioEngine::renderNextBuffer()
+	void prepareChannelDependencies();
+	void addAudioPortInput( mix_ch_t _ch );
+	void queueIndependentChannels();
+	void audioPortProcessed( mix_ch_t _ch );
+
 	void masterMix( sampleFrame * _buf );
 
+	//! True if an effect of any channel still produces output
+	bool hasRunningEffects() const;
+
 	void saveSettings( QDomDocument & _doc, QDomElement & _parent ) override;
 	void loadSettings( const QDomElement & _this ) override;
 
@@ -198,6 +224,10 @@ public:
 	// rename channels when moving etc. if they still have their original name
 	void validateChannelName( int index, int oldIndex );
 
+	// let the audio device write the channel to an output of its own, after
+	// its effects and fader, see AudioDevice::supportsChannelOutputs()
+	void setExtOutputEnabled( mix_ch_t index, bool enabled );
+
 	void toggledSolo();
 	void activateSolo();
 	void deactivateSolo();
@@ -216,6 +246,9 @@ private:
 	// make sure we have at least num channels
 	void allocateChannelsTo(int num);
 
+	//! Clear the buffer unless it is known to be silent already
+	void clearChannelBuffer( MixerChannel * ch );
+
 	int m_lastSoloed;
 } ;
 
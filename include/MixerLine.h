@@ -38,6 +38,7 @@
 
 
 
+class LoadIndicator;
 class MixerView;
 class SendButtonIndicator;
 
@@ -63,6 +64,7 @@ public:
 
 	Knob * m_sendKnob;
 	SendButtonIndicator * m_sendBtn;
+	LoadIndicator * m_loadIndicator;
 
 	QBrush backgroundActive() const;
 	void setBackgroundActive( const QBrush & c );
@@ -109,6 +111,7 @@ public slots:
 
 private slots:
 	void renameFinished();
+	void toggleExtOutput();
 	void removeChannel();
 	void removeUnusedChannels();
 	void moveChannelLeft();
@@ -25,6 +25,8 @@
 #ifndef MODEL_VIEW_H
 #define MODEL_VIEW_H
 
+#include <atomic>
+
 #include <QtCore/QPointer>
 #include "Model.h"
 
@@ -48,6 +50,12 @@ public:
 		return m_model;
 	}
 
+	//! Repaints the views whose models changed outside of the GUI thread
+	//! since the last call. Called once per frame by the main window, so
+	//! that automation and controllers changing a model on every period
+	//! don't queue a repaint each.
+	static void updateChangedViews();
+
 	template<class T>
 	T* castModel()
 	{
@@ -76,8 +84,11 @@ protected:
 
 
 private:
+	void modelDataChanged();
+
 	QWidget* m_widget;
 	QPointer<Model> m_model;
+	std::atomic<bool> m_changed;
 
 } ;
 
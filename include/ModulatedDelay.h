@@ -0,0 +1,105 @@
+/*
+ * ModulatedDelay.h - a stereo delay line with feedback and delays set per frame
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef MODULATED_DELAY_H
+#define MODULATED_DELAY_H
+
+#include <vector>
+
+#include "lmms_basics.h"
+
+
+//! A stereo delay line with feedback, for delays that are modulated from
+//! frame to frame, like those of the Delay and the Flanger. Both channels
+//! share one buffer of interleaved frames and are read at whole frames.
+//! The delay of each frame and channel is computed by the caller for a
+//! block at a time, e.g. from QuadratureLfo::tick() for a block.
+class ModulatedDelay
+{
+public:
+	//! @param maxTime the longest delay in seconds
+	ModulatedDelay( float maxTime, int sampleRate ) :
+		m_maxTime( maxTime ),
+		m_writeIndex( 0 )
+	{
+		setSampleRate( sampleRate );
+	}
+
+	//! Also clears the line
+	void setSampleRate( int sampleRate )
+	{
+		const int size = static_cast<int>( m_maxTime * sampleRate );
+		m_buffer.assign( size > 1 ? size : 1, sampleFrame() );
+		m_writeIndex = 0;
+		m_length[0] = m_length[1] = static_cast<float>( maxLength() );
+	}
+
+	//! The longest delay in frames
+	int maxLength() const
+	{
+		return static_cast<int>( m_buffer.size() );
+	}
+
+	//! Delays @p frames frames of @p buf in place. @p lengths holds the
+	//! delay of each frame and channel in frames; a delay outside of
+	//! [0, maxLength()] is ignored and the last one is kept. What is read
+	//! from the line is fed back into it, scaled by @p feedback of the frame.
+	void process( sampleFrame * buf, const sampleFrame * lengths,
+					const float * feedback, fpp_t frames )
+	{
+		const int size = maxLength();
+		sampleFrame * line = m_buffer.data();
+		int writeIndex = m_writeIndex;
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			writeIndex = writeIndex + 1 < size ? writeIndex + 1 : 0;
+			for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				const float length = lengths[f][ch];
+				if( length >= 0 && length <= size )
+				{
+					m_length[ch] = length;
+				}
+				int readIndex = writeIndex - m_length[ch];
+				if( readIndex < 0 )
+				{
+					readIndex += size;
+				}
+				const float out = line[readIndex][ch];
+				line[writeIndex][ch] = buf[f][ch] + out * feedback[f];
+				buf[f][ch] = out;
+			}
+		}
+		m_writeIndex = writeIndex;
+	}
+
+private:
+	float m_maxTime;
+	std::vector<sampleFrame> m_buffer;
+	int m_writeIndex;
+	float m_length[DEFAULT_CHANNELS];
+} ;
+
+
+#endif
@@ -26,7 +26,10 @@
 #ifndef NOTE_PLAY_HANDLE_H
 #define NOTE_PLAY_HANDLE_H
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "BasicFilters.h"
 #include "Note.h"
@@ -34,7 +37,6 @@
 #include "Track.h"
 #include "MemoryManager.h"
 
-class QReadWriteLock;
 class InstrumentTrack;
 class NotePlayHandle;
 
@@ -47,7 +49,8 @@ class LMMS_EXPORT NotePlayHandle : public PlayHandle, public Note
 	MM_OPERATORS
 public:
 	void * m_pluginData;
-	std::unique_ptr<BasicFilters<>> m_filter;
+	//! Set by InstrumentSoundShaping on first use, see NotePlayHandleManager::filter()
+	BasicFilters<> * m_filter;
 
 	// length of the declicking fade in
 	fpp_t m_fadeInLength;
@@ -110,6 +113,12 @@ public:
 	/*! Renders one chunk using the attached instrument into the buffer */
 	void play( sampleFrame* buffer ) override;
 
+	/*! play() in two halves, between which NoteBatch lets the instrument
+		play all notes of a period at once. Returns whether the instrument
+		has to play the note. finishPlaying() must follow in any case. */
+	bool startPlaying();
+	void finishPlaying();
+
 	/*! Returns whether playback of note is finished and thus handle can be deleted */
 	bool isFinished() const override
 	{
@@ -128,6 +137,16 @@ public:
 	/*! Releases the note (and plays release frames) */
 	void noteOff( const f_cnt_t offset = 0 );
 
+	/*! Releases the note and fades it out within a few milliseconds,
+		regardless of its release and the sustain pedal - see VoiceLimiter */
+	void steal();
+
+	/*! Returns whether the note was stolen */
+	bool isStolen() const
+	{
+		return m_stolen;
+	}
+
 	/*! Returns number of frames to be played until the note is going to be released */
 	f_cnt_t framesBeforeRelease() const
 	{
@@ -200,7 +219,7 @@ public:
 	/*! Returns whether note has children */
 	bool isMasterNote() const
 	{
-		return m_subNotes.size() > 0 || m_hadChildren;
+		return m_firstSubNote != nullptr || m_hadChildren;
 	}
 
 	void setMasterNote()
@@ -218,10 +237,19 @@ public:
 	/*! Mutes playback of note */
 	void mute();
 
-	/*! Returns index of NotePlayHandle in vector of note-play-handles
-	    belonging to this instrument track - used by arpeggiator.
-	    Ignores child note-play-handles, returns -1 when called on one */
-	int index() const;
+	/*! Returns index of NotePlayHandle in the active notes of its
+	    instrument track, i.e. the ones without parent that haven't been
+	    released yet, in the order they were started - used by arpeggiator.
+	    Returns -1 for child and released note-play-handles */
+	int index() const
+	{
+		return m_activeNoteIndex;
+	}
+
+	/*! Returns a seed for the random generators of the voice, which only
+	    depends on the note, its song position and its track, so that
+	    every render of the project gives the same noise */
+	uint32_t randomSeed() const;
 
 	/*! Returns list of note-play-handles belonging to given instrument track.
 	    If allPlayHandles = true, also released note-play-handles and children
@@ -246,7 +274,8 @@ public:
 	/*! Process note detuning automation */
 	void processTimePos( const TimePos& time );
 
-	/*! Updates total length (m_frames) depending on a new tempo */
+	/*! Updates total length (m_frames) depending on a new tempo, done by
+	    startPlaying() whenever the song's tempo epoch changed */
 	void resize( const bpm_t newTempo );
 
 	/*! Set song-global offset (relative to containing MIDI clip) in order to properly perform the note detuning */
@@ -291,6 +320,8 @@ private:
 
 	void updateFrequency();
 
+	// the state play() goes through in every period, kept together with
+	// the public members so that a period touches few cache lines per voice
 	InstrumentTrack* m_instrumentTrack;		// needed for calling
 											// InstrumentTrack::playNote
 	f_cnt_t m_frames;						// total frames to play
@@ -303,43 +334,104 @@ private:
 											// played after release
 	f_cnt_t m_releaseFramesDone;			// number of frames done after
 											// release of note
-	NotePlayHandleList m_subNotes;			// used for chords and arpeggios
+	f_cnt_t m_framesThisPeriod;
+	f_cnt_t m_stealFramesLeft;				// frames of the fade-out
+	float m_frequency;
+	float m_unpitchedFrequency;
+	int m_tempoEpoch;						// Song::tempoEpoch() m_frames is for
 	volatile bool m_released;				// indicates whether note is released
 	bool m_releaseStarted;
-	bool m_hasMidiNote;
-	bool m_hasParent;						// indicates whether note has parent
-	NotePlayHandle * m_parent;			// parent note
-	bool m_hadChildren;
 	bool m_muted;							// indicates whether note is muted
+	bool m_playing;							// between startPlaying() and
+											// finishPlaying()
+	bool m_stolen;
+	bool m_frequencyNeedsUpdate;				// used to update pitch
+
+	// only needed when the note starts, ends or changes
+	NotePlayHandle * m_firstSubNote;		// used for chords and arpeggios,
+											// linked through m_nextSubNote
+	NotePlayHandle * m_prevSubNote;			// siblings in the parent's list
+	NotePlayHandle * m_nextSubNote;
+	NotePlayHandle * m_parent;			// parent note
 	Track* m_bbTrack;						// related BB track
+	BaseDetuning* m_baseDetuning;
+	TimePos m_songGlobalParentOffset;
 
 	// tempo reaction
 	bpm_t m_origTempo;						// original tempo
 	f_cnt_t m_origFrames;					// original m_frames
 
 	int m_origBaseNote;
+	int m_midiChannel;
+	int m_activeNoteIndex;					// see index()
+	Origin m_origin;
+	bool m_hasMidiNote;
+	bool m_hasParent;						// indicates whether note has parent
+	bool m_hadChildren;
 
-	float m_frequency;
-	float m_unpitchedFrequency;
+	void fadeOutStolen();
 
-	BaseDetuning* m_baseDetuning;
-	TimePos m_songGlobalParentOffset;
+	void addToActiveNotes();
+	void removeFromActiveNotes();
+} ;
 
-	int m_midiChannel;
-	Origin m_origin;
 
-	bool m_frequencyNeedsUpdate;				// used to update pitch
+//! Plays all notes of an instrument track in one job if its instrument sets
+//! Instrument::PlaysNotesBatched, instead of one job per note. The audio
+//! engine fills it with the notes to process in each period.
+class LMMS_EXPORT NoteBatch : public ThreadableJob
+{
+public:
+	NoteBatch( InstrumentTrack * instrumentTrack );
+
+	void add( NotePlayHandle * nph )
+	{
+		m_notes.push_back( nph );
+	}
+
+	bool isEmpty() const
+	{
+		return m_notes.empty();
+	}
+
+	bool requiresProcessing() const override
+	{
+		return !m_notes.empty();
+	}
+
+	Label jobLabel() const override;
+	LoadMeter * loadMeter() override;
+
+
+protected:
+	void doProcessing() override;
+
+
+private:
+	InstrumentTrack * m_instrumentTrack;
+	std::vector<NotePlayHandle *> m_notes;
+	// the notes the instrument has to play
+	std::vector<NotePlayHandle *> m_playing;
 } ;
 
 
+
+
 const int INITIAL_NPH_CACHE = 256;
-const int NPH_CACHE_INCREMENT = 16;
+//! The pool grows in segments of this size, INITIAL_NPH_CACHE must be a multiple
+const int NPH_CACHE_INCREMENT = 64;
+const int MAX_NPH_CACHE_SEGMENTS = 4096;
 
+//! Lock-free pool of NotePlayHandles. A background thread grows the pool
+//! before it runs dry, so acquire() and release() never block or allocate
+//! in the common case.
 class NotePlayHandleManager
 {
 	MM_OPERATORS
 public:
 	static void init();
+	//! Returns nullptr (and counts the note as dropped) if the pool ran
+	//! dry, the pool is only grown by reserve()
 	static NotePlayHandle * acquire( InstrumentTrack* instrumentTrack,
 					const f_cnt_t offset,
 					const f_cnt_t frames,
@@ -348,14 +440,38 @@ public:
 					int midiEventChannel = -1,
 					NotePlayHandle::Origin origin = NotePlayHandle::OriginMidiClip );
 	static void release( NotePlayHandle * nph );
-	static void extend( int i );
+	//! A filter for @p nph with cleared history. It belongs to the slot of
+	//! the handle and is reused by the following handles in that slot, so
+	//! it's only allocated once per slot (and when the sample rate changes).
+	static BasicFilters<> * filter( NotePlayHandle * nph, sample_rate_t sampleRate );
+	//! Grows the pool if it is running low. Must not be called from an
+	//! audio thread.
+	static void reserve();
 	static void free();
 
+	static int inUse() { return s_inUse.load( std::memory_order_relaxed ); }
+	//! The most handles that were in use at once, use it to size INITIAL_NPH_CACHE
+	static int highWaterMark() { return s_highWaterMark.load( std::memory_order_relaxed ); }
+	static int capacity() { return s_segmentCount.load( std::memory_order_relaxed ) * NPH_CACHE_INCREMENT; }
+	//! How many notes weren't played because the pool ran dry
+	static int droppedNotes() { return s_droppedNotes.load( std::memory_order_relaxed ); }
+
 private:
-	static NotePlayHandle ** s_available;
-	static QReadWriteLock s_mutex;
-	static std::atomic_int s_availableIndex;
-	static int s_size;
+	struct Slot;
+
+	static Slot * slot( uint32_t index );
+	static Slot * pop();
+	static void push( Slot * s );
+	static void extend();
+
+	static std::atomic<Slot *> s_segments[MAX_NPH_CACHE_SEGMENTS];
+	static std::atomic_int s_segmentCount;
+	//! index of the first free slot in the low, ABA tag in the high 32 bits
+	static std::atomic<uint64_t> s_freeList;
+
+	static std::atomic_int s_inUse;
+	static std::atomic_int s_highWaterMark;
+	static std::atomic_int s_droppedNotes;
 };
 
 
@@ -26,6 +26,7 @@
 #ifndef OSCILLATOR_H
 #define OSCILLATOR_H
 
+#include <atomic>
 #include <cassert>
 #include <fftw3.h>
 #include <math.h>
@@ -36,6 +37,7 @@
 
 #include "Engine.h"
 #include "lmms_constants.h"
+#include "lmms_math.h"
 #include "lmmsconfig.h"
 #include "AudioEngine.h"
 #include "OscillatorConstants.h"
@@ -86,9 +88,20 @@ public:
 		delete m_subOsc;
 	}
 
+	//! Leaves the sub oscillator to the caller, e.g. to give it back to
+	//! the VoicePool it came from
+	Oscillator * takeSubOsc()
+	{
+		Oscillator * subOsc = m_subOsc;
+		m_subOsc = nullptr;
+		return subOsc;
+	}
+
 	static void waveTableInit();
 	static void destroyFFTPlans();
-	static void generateAntiAliasUserWaveTable(SampleBuffer* sampleBuffer);
+	//! Band-limits one period of a user wave, @p wave holding
+	//! WAVETABLE_LENGTH samples, into @p table. Can run on any thread.
+	static void generateAntiAliasUserWaveTable(const sample_t* wave, OscillatorConstants::waveform_t& table);
 
 	inline void setUseWaveTable(bool n)
 	{
@@ -100,6 +113,13 @@ public:
 		m_userWave = _wave;
 	}
 
+	//! Seeds the noise of this oscillator, e.g. from the note it plays,
+	//! for the same noise in every render
+	inline void setRandomSeed( uint32_t seed )
+	{
+		m_random.setSeed( seed );
+	}
+
 	void update(sampleFrame* ab, const fpp_t frames, const ch_cnt_t chnl, bool modulator = false);
 
 	// now follow the wave-shape-routines...
@@ -216,6 +236,32 @@ public:
 				table[control.band][control.f2], fraction(control.frame));
 	}
 
+	//! Band of the wavetables matching the current frequency
+	inline int waveTableBand() const
+	{
+		return waveTableBandFromFreq(
+			m_freq * m_detuning_div_samplerate * Engine::audioEngine()->processingSampleRate());
+	}
+
+	//! Same as wtSample() for a whole block of phases, reading a single
+	//! band of the wavetable. There are no branches on the oscillator's
+	//! state inside the loop, so it can be vectorised.
+	static inline void wtSamples(const sample_t* band, const float* phases, sample_t* samples, const fpp_t count)
+	{
+		assert(band != nullptr);
+		for (fpp_t i = 0; i < count; ++i)
+		{
+			const float frame = phases[i] * OscillatorConstants::WAVETABLE_LENGTH;
+			f_cnt_t f1 = static_cast<f_cnt_t>(frame) % OscillatorConstants::WAVETABLE_LENGTH;
+			if (f1 < 0)
+			{
+				f1 += OscillatorConstants::WAVETABLE_LENGTH;
+			}
+			const f_cnt_t f2 = f1 < OscillatorConstants::WAVETABLE_LENGTH - 1 ? f1 + 1 : 0;
+			samples[i] = linearInterpolate(band[f1], band[f2], fraction(frame));
+		}
+	}
+
 	static inline int waveTableBandFromFreq(float freq)
 	{
 		// Frequency bands are indexed relative to default MIDI key frequencies.
@@ -229,6 +275,12 @@ public:
 		return band <= 1 ? 1 : band >= OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT-1 ? OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT-1 : band;
 	}
 
+	//! The band-limited tables are built in the background, see waveTableInit()
+	static inline bool waveTableReady(WaveShapes shape)
+	{
+		return s_waveTableReady[shape - FirstWaveShapeTable].load(std::memory_order_acquire);
+	}
+
 	static inline float freqFromWaveTableBand(int band)
 	{
 		return 440.0f * std::pow(2.0f, (band * OscillatorConstants::SEMITONES_PER_TABLE - 69.0f) / 12.0f);
@@ -246,6 +298,7 @@ private:
 	float m_phase;
 	const SampleBuffer * m_userWave;
 	bool m_useWaveTable;
+	FastRandom m_random;
 	// There are many update*() variants; the modulator flag is stored as a member variable to avoid
 	// adding more explicit parameters to all of them. Can be converted to a parameter if needed.
 	bool m_isModulator;
@@ -255,6 +308,9 @@ private:
 	static fftwf_plan s_fftPlan;
 	static fftwf_plan s_ifftPlan;
 	static fftwf_complex * s_specBuf;
+	static std::atomic<bool> s_waveTableReady[WaveShapes::NumWaveShapeTables];
+	// seeds the oscillators nobody seeds
+	static std::atomic<uint32_t> s_oscillatorCount;
 	static float s_sampleBuffer[OscillatorConstants::WAVETABLE_LENGTH];
 
 	static void generateSawWaveTable(int bands, sample_t* table, int firstBand = 1);
@@ -303,8 +359,16 @@ private:
 	void updateFM( sampleFrame * _ab, const fpp_t _frames,
 							const ch_cnt_t _chnl );
 
+	//! Frames are rendered in blocks of this size, which keeps the
+	//! scratch buffers for phases and samples on the stack
+	static constexpr fpp_t SAMPLE_BLOCK = 64;
+
+	template<WaveShapes W, typename PhaseFn, typename WriteFn>
+	inline void renderBlocks( const fpp_t _frames, PhaseFn _phase,
+							WriteFn _write );
 	template<WaveShapes W>
-	inline sample_t getSample( const float _sample );
+	inline void getSamples( const float * _phases, sample_t * _samples,
+							const fpp_t _count );
 
 	inline void recalcPhase();
 
@@ -74,7 +74,8 @@ public:
 		m_bitRateSettings(bitRateSettings),
 		m_bitDepth(bitDepth),
 		m_stereoMode(stereoMode),
-		m_compressionLevel(0.625) // 5/8
+		m_compressionLevel(0.625), // 5/8
+		m_dither(false)
 	{
 	}
 
@@ -104,12 +105,17 @@ public:
 		m_compressionLevel = level;
 	}
 
+	//! Whether integer samples get TPDF dither noise
+	bool getDither() const { return m_dither; }
+	void setDither(bool dither) { m_dither = dither; }
+
 private:
 	sample_rate_t m_sampleRate;
 	BitRateSettings m_bitRateSettings;
 	BitDepth m_bitDepth;
 	StereoMode m_stereoMode;
 	double m_compressionLevel;
+	bool m_dither;
 };
 
 #endif
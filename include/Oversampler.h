@@ -0,0 +1,86 @@
+/*
+ * Oversampler.h - polyphase half-band up- and downsampling
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef OVERSAMPLER_H
+#define OVERSAMPLER_H
+
+#include <vector>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+
+//! Runs audio at 2, 4 or 8 times the processing rate. Each factor of two
+//! is a stage with a linear phase half-band FIR, split into its two
+//! polyphase branches. One branch is a plain delay, so only half of the
+//! taps have to be computed.
+class LMMS_EXPORT Oversampler
+{
+public:
+	static constexpr int MaxStages = 3;
+
+	//! @p maxFrames is the largest number of oversampled frames passed
+	//! through per call
+	Oversampler( int stages, fpp_t maxFrames );
+	~Oversampler();
+
+	int stages() const
+	{
+		return m_stages;
+	}
+
+	int factor() const
+	{
+		return 1 << m_stages;
+	}
+
+	//! Delay of up- and downsampling together, in frames at the
+	//! processing rate
+	static f_cnt_t latency( int stages );
+
+	f_cnt_t latency() const
+	{
+		return latency( m_stages );
+	}
+
+	//! Upsamples @p frames frames into an internal buffer, which is
+	//! returned and holds frames * factor() frames
+	sampleFrame * upsample( const sampleFrame * in, fpp_t frames );
+	//! Downsamples the buffer returned by the last upsample() call into the
+	//! @p frames frames at @p out
+	void downsample( sampleFrame * out, fpp_t frames );
+	//! Downsamples the frames * factor() frames at @p in, which weren't
+	//! upsampled by this, into the @p frames frames at @p out
+	void decimate( const sampleFrame * in, sampleFrame * out, fpp_t frames );
+
+	void reset();
+
+private:
+	class Stage;
+
+	int m_stages;
+	std::vector<Stage> m_stageList;
+	std::vector<sampleFrame> m_buffers[2];
+} ;
+
+#endif
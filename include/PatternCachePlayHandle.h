@@ -0,0 +1,68 @@
+/*
+ * PatternCachePlayHandle.h - plays one repetition of a cached BB pattern
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef PATTERN_CACHE_PLAY_HANDLE_H
+#define PATTERN_CACHE_PLAY_HANDLE_H
+
+#include "PlayHandle.h"
+
+class BBPatternCache;
+class BBTrack;
+class SampleBuffer;
+
+
+//! Copies what a track of the beat/bassline editor rendered for a pattern
+//! into the track's audio port, starting at the beginning of a repetition
+//! of the pattern. Each repetition has a handle of its own, so that the
+//! notes ringing at the end of one overlap the start of the next one.
+class PatternCachePlayHandle : public PlayHandle
+{
+public:
+	PatternCachePlayHandle( const BBPatternCache * cache, int generation, BBTrack * bbTrack,
+				Track * track, AudioPort * port, SampleBuffer * buffer, f_cnt_t offset );
+	virtual ~PatternCachePlayHandle();
+
+	void play( sampleFrame * buffer ) override;
+
+	bool isFinished() const override;
+
+	bool isFromTrack( const Track * track ) const override
+	{
+		return m_track == track || m_bbTrack == track;
+	}
+
+
+private:
+	const BBPatternCache * m_cache;
+	const int m_generation;
+	BBTrack * m_bbTrack;
+	Track * m_track;
+	SampleBuffer * m_buffer;
+
+	f_cnt_t m_position;
+
+} ;
+
+
+#endif
@@ -25,6 +25,8 @@
 #ifndef PEAK_CONTROLLER_H
 #define PEAK_CONTROLLER_H
 
+#include <vector>
+
 #include "Model.h"
 #include "Controller.h"
 #include "ControllerDialog.h"
@@ -79,6 +81,10 @@ private:
 	float m_attackCoeff;
 	float m_decayCoeff;
 	bool m_coeffNeedsUpdate;
+	// ( 1 - coefficient ) ^ ( f + 1 ) for every frame f of a period, how
+	// much of the distance to the target is left after it
+	std::vector<float> m_attackPowers;
+	std::vector<float> m_decayPowers;
 } ;
 
 
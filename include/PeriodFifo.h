@@ -0,0 +1,196 @@
+/*
+ * PeriodFifo.h - ring of period buffers between the renderer and the audio device
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef PERIOD_FIFO_H
+#define PERIOD_FIFO_H
+
+#include <atomic>
+#include <vector>
+
+#include <QtCore/QSemaphore>
+
+#include "lmms_basics.h"
+#include "MemoryHelper.h"
+
+
+//! Fixed ring of period buffers, allocated once, for one writer and one
+//! reader. The writer takes buffers to render into and writes them in the
+//! same order, the reader uses them in place until it releases them. Each
+//! side only touches its own indices, the semaphores are for waiting.
+//! The writer may use fewer buffers than there are, which lowers the
+//! latency without allocating anything when it changes.
+class PeriodFifo
+{
+public:
+	PeriodFifo( int size, fpp_t frames ) :
+		m_readSem( size ),
+		m_writeSem( size ),
+		m_periods( size ),
+		m_taken( 0 ),
+		m_takeIndex( 0 ),
+		m_writeIndex( 0 ),
+		m_readIndex( 0 ),
+		m_depth( size ),
+		m_withheld( 0 ),
+		m_filled( 0 )
+	{
+		for( Period & period : m_periods )
+		{
+			period.frames = static_cast<surroundSampleFrame *>(
+				MemoryHelper::alignedMalloc( frames * sizeof( surroundSampleFrame ) ) );
+		}
+		m_readSem.acquire( size );
+	}
+
+	~PeriodFifo()
+	{
+		for( Period & period : m_periods )
+		{
+			MemoryHelper::alignedFree( period.frames );
+		}
+	}
+
+	int size() const
+	{
+		return static_cast<int>( m_periods.size() );
+	}
+
+	//! Number of buffers the writer uses, at least the two it has
+	//! taken at once
+	int depth() const
+	{
+		return m_depth.load( std::memory_order_relaxed );
+	}
+
+	//! Buffers written but not released by the reader yet
+	int filled() const
+	{
+		return m_filled.load( std::memory_order_relaxed );
+	}
+
+	//! Writer: takes effect with the next take()
+	void setDepth( int depth )
+	{
+		m_depth.store( qBound( 2, depth, size() ), std::memory_order_relaxed );
+	}
+
+	//! Writer: the next free buffer, waits until the reader released one
+	surroundSampleFrame * take()
+	{
+		// the buffers not used are held back from the free ones, which
+		// for a lower depth means waiting until the reader caught up
+		const int withheld = size() - depth();
+		for( ; m_withheld < withheld; ++m_withheld )
+		{
+			m_writeSem.acquire();
+		}
+		if( m_withheld > withheld )
+		{
+			m_writeSem.release( m_withheld - withheld );
+			m_withheld = withheld;
+		}
+		m_writeSem.acquire();
+		surroundSampleFrame * frames = m_periods[m_takeIndex].frames;
+		m_takeIndex = ( m_takeIndex + 1 ) % size();
+		++m_taken;
+		return frames;
+	}
+
+	//! Writer: hands the oldest buffer taken to the reader
+	void write()
+	{
+		m_writeIndex = ( m_writeIndex + 1 ) % size();
+		--m_taken;
+		m_filled.fetch_add( 1, std::memory_order_relaxed );
+		m_readSem.release();
+	}
+
+	//! Writer: makes the reader get nullptr after everything written, and
+	//! gives back the buffers taken but not written
+	void writeEnd()
+	{
+		if( m_taken == 0 )
+		{
+			take();
+		}
+		m_periods[m_writeIndex].end = true;
+		write();
+		m_takeIndex = m_writeIndex;
+		m_writeSem.release( m_taken );
+		m_taken = 0;
+	}
+
+	//! Reader: the oldest buffer written, or nullptr at the end. Waits
+	//! until there is one. Has to be released after use.
+	const surroundSampleFrame * read()
+	{
+		m_readSem.acquire();
+		Period & period = m_periods[m_readIndex];
+		if( period.end )
+		{
+			period.end = false;
+			release();
+			return nullptr;
+		}
+		return period.frames;
+	}
+
+	//! Reader: the buffer of the last read() can be written again
+	void release()
+	{
+		m_readIndex = ( m_readIndex + 1 ) % size();
+		m_filled.fetch_sub( 1, std::memory_order_relaxed );
+		m_writeSem.release();
+	}
+
+	//! Writer: waits until the reader released all buffers
+	void waitUntilRead()
+	{
+		m_writeSem.acquire( size() - m_withheld );
+		m_writeSem.release( size() - m_withheld );
+	}
+
+private:
+	struct Period
+	{
+		surroundSampleFrame * frames = nullptr;
+		bool end = false;
+	} ;
+
+	QSemaphore m_readSem;
+	QSemaphore m_writeSem;
+	std::vector<Period> m_periods;
+	// taken by the writer but not written yet
+	int m_taken;
+	int m_takeIndex;
+	int m_writeIndex;
+	int m_readIndex;
+	std::atomic_int m_depth;
+	// free buffers the writer holds back
+	int m_withheld;
+	std::atomic_int m_filled;
+} ;
+
+
+#endif
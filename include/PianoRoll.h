@@ -27,9 +27,11 @@
 #ifndef PIANO_ROLL_H
 #define PIANO_ROLL_H
 
+#include <tuple>
 #include <QVector>
 #include <QWidget>
 #include <QInputDialog>
+#include <QPixmap>
 
 #include "Editor.h"
 #include "ComboBoxModel.h"
@@ -43,7 +45,6 @@
 #include "PositionLine.h"
 
 class QPainter;
-class QPixmap;
 class QScrollBar;
 class QString;
 class QMenu;
@@ -161,6 +162,7 @@ protected:
 	void mouseMoveEvent( QMouseEvent * me ) override;
 	void paintEvent( QPaintEvent * pe ) override;
 	void resizeEvent( QResizeEvent * re ) override;
+	void changeEvent(QEvent* ev) override;
 	void wheelEvent( QWheelEvent * we ) override;
 	void focusOutEvent( QFocusEvent * ) override;
 	void focusInEvent( QFocusEvent * ) override;
@@ -202,6 +204,7 @@ protected slots:
 	void updatePosition(const TimePos & t );
 	void updatePositionAccompany(const TimePos & t );
 	void updatePositionStepRecording(const TimePos & t );
+	void updatePianoKeys();
 
 	void zoomingChanged();
 	void zoomingYChanged();
@@ -279,6 +282,11 @@ private:
 
 	PositionLine * m_positionLine;
 
+	//! Everything the grid's pixmap depends on, apart from the colors
+	using GridLayout = std::tuple<QSize, qreal, int, int, int, int, int, int, int, int, int, int>;
+	GridLayout m_gridLayout;
+	QPixmap m_gridCache;
+
 	QVector<QString> m_nemStr; // gui names of each edit mode
 	QMenu * m_noteEditMenu; // when you right click below the key area
 
@@ -0,0 +1,78 @@
+/*
+ * PlanarBuffer.h - audio buffer with one array per channel
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef PLANAR_BUFFER_H
+#define PLANAR_BUFFER_H
+
+#include "lmms_basics.h"
+
+//! Audio with each channel in its own array, for DSP which processes the
+//! channels separately. The buffer doesn't own its memory, get one from
+//! BufferManager::acquirePlanar(). The channels follow each other without
+//! gaps, so sample-wise operations can treat them as one array.
+class PlanarBuffer
+{
+public:
+	PlanarBuffer() :
+		m_samples(nullptr),
+		m_frames(0)
+	{
+	}
+
+	PlanarBuffer(sample_t * samples, f_cnt_t frames) :
+		m_samples(samples),
+		m_frames(frames)
+	{
+	}
+
+	sample_t * channel(ch_cnt_t channel) const
+	{
+		return m_samples + channel * m_frames;
+	}
+
+	//! All DEFAULT_CHANNELS * frames() samples
+	sample_t * samples() const
+	{
+		return m_samples;
+	}
+
+	f_cnt_t frames() const
+	{
+		return m_frames;
+	}
+
+	//! The same memory, with @p frames (at most frames()) frames per
+	//! channel. The right channel moves, so the contents are not kept.
+	PlanarBuffer withFrames(f_cnt_t frames) const
+	{
+		return PlanarBuffer(m_samples, frames);
+	}
+
+private:
+	sample_t * m_samples;
+	f_cnt_t m_frames;
+} ;
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * PlanarEffect.h - base class for effects processing planar audio
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef PLANAR_EFFECT_H
+#define PLANAR_EFFECT_H
+
+#include "Effect.h"
+#include "PlanarBuffer.h"
+
+//! Base for effects which process each channel on its own. Effect chains
+//! pass them planar buffers directly and only convert back to interleaved
+//! audio before the next effect which isn't planar.
+class LMMS_EXPORT PlanarEffect : public Effect
+{
+public:
+	PlanarEffect( const Plugin::Descriptor * _desc,
+			Model * _parent,
+			const Descriptor::SubPluginFeatures::Key * _key );
+	~PlanarEffect() override;
+
+	bool processesPlanar() const final
+	{
+		return true;
+	}
+
+	//! Converts the buffer for processPlanarBuffer() and back, for callers
+	//! which only have interleaved audio
+	bool processAudioBuffer( sampleFrame * _buf, const fpp_t _frames ) final;
+
+	//! Same as processAudioBuffer(), buf.frames() is the number of frames
+	virtual bool processPlanarBuffer( const PlanarBuffer & buf ) = 0;
+
+private:
+	PlanarBuffer m_buffer;
+} ;
+
+#endif
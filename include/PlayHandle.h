@@ -28,6 +28,8 @@
 #include <QtCore/QList>
 #include <QtCore/QMutex>
 
+#include <vector>
+
 #include "lmms_export.h"
 
 #include "MemoryManager.h"
@@ -48,7 +50,9 @@ public:
 		TypeNotePlayHandle = 0x01,
 		TypeInstrumentPlayHandle = 0x02,
 		TypeSamplePlayHandle = 0x04,
-		TypePresetPreviewHandle = 0x08
+		TypePresetPreviewHandle = 0x08,
+		TypeFrozenTrackHandle = 0x10,
+		TypePatternCacheHandle = 0x20
 	} ;
 	typedef Types Type;
 
@@ -89,11 +93,21 @@ public:
 	// required for ThreadableJob
 	void doProcessing() override;
 
+	// doProcessing() is play( startProcessing() ) and finishProcessing(),
+	// for jobs processing several handles at once: returns the cleared
+	// buffer to play into, or nullptr if the handle doesn't use one
+	sampleFrame * startProcessing();
+	// lets the audio port know that the buffer is ready to be mixed
+	void finishProcessing();
+
 	bool requiresProcessing() const override
 	{
 		return !isFinished();
 	}
 
+	Label jobLabel() const override;
+	LoadMeter * loadMeter() override;
+
 	void lock()
 	{
 		m_processingLock.lock();
@@ -148,15 +162,109 @@ public:
 	
 	sampleFrame * buffer();
 
+	//! Whether the audio engine plays the handle or is about to
+	bool isPlaying() const
+	{
+		return m_engineIndex >= 0 || m_queued;
+	}
+
+	//! How long processing the handle took in the last periods, in
+	//! nanoseconds, or -1 if it wasn't processed yet
+	qint64 cost() const
+	{
+		return m_cost;
+	}
+
+	//! The audio engine doesn't delete recycled handles when they are done
+	//! or removed, their owners keep them to play them again
+	bool isRecycled() const
+	{
+		return m_recycled;
+	}
+
+	void setRecycled( bool recycled )
+	{
+		m_recycled = recycled;
+	}
+
 private:
+	// what the audio engine touches for every handle in every period comes
+	// first, so that it shares the cache lines of ThreadableJob
 	Type m_type;
 	f_cnt_t m_offset;
-	QThread* m_affinity;
 	QMutex m_processingLock;
 	sampleFrame* m_playHandleBuffer;
+	AudioPort * m_audioPort;
+	qint64 m_cost;
+
+	// position in the play handle list of the audio engine (-1 if not
+	// contained), allowing removal in constant time
+	int m_engineIndex;
 	bool m_bufferReleased;
 	bool m_usesBuffer;
+	// set while the handle waits for removal by the audio engine
+	bool m_removalRequested;
+	// set while the handle waits in the audio engine's list of new handles
+	bool m_queued;
+	bool m_recycled;
+
+	QThread* m_affinity;
+	// the same for the audio port's list
+	int m_audioPortIndex;
+
+	friend class AudioEngine;
+	friend class AudioPort;
+} ;
+
+
+
+
+//! Plays cheap play handles of one audio port in one job, so that e.g. the
+//! short voices of a drum track don't pay for queueing and a hop to another
+//! core each. The audio engine fills the batches from what the handles cost
+//! in the last periods.
+class LMMS_EXPORT PlayHandleBatch : public ThreadableJob
+{
+public:
+	//! Handles which cost more, in nanoseconds, get a job of their own
+	static constexpr qint64 MaxHandleCost = 20000;
+	//! What the handles of a batch may cost together, so that the voices
+	//! of a busy track still spread over the threads
+	static constexpr qint64 MaxBatchCost = 100000;
+	static constexpr int MaxHandles = 32;
+
+	PlayHandleBatch();
+
+	//! Queues @p handle, which must require processing, for the batch
+	void add( PlayHandle * handle );
+
+	bool isFull() const
+	{
+		return static_cast<int>( m_handles.size() ) >= MaxHandles || m_cost >= MaxBatchCost;
+	}
+
+	AudioPort * audioPort()
+	{
+		return m_audioPort;
+	}
+
+	bool requiresProcessing() const override
+	{
+		return !m_handles.empty();
+	}
+
+	Label jobLabel() const override;
+	LoadMeter * loadMeter() override;
+
+
+protected:
+	void doProcessing() override;
+
+
+private:
 	AudioPort * m_audioPort;
+	std::vector<PlayHandle *> m_handles;
+	qint64 m_cost;
 } ;
 
 
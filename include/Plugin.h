@@ -25,6 +25,8 @@
 #ifndef PLUGIN_H
 #define PLUGIN_H
 
+#include <atomic>
+
 #include <QtCore/QStringList>
 #include <QtCore/QMap>
 #include <QtXml/QDomDocument>
@@ -38,6 +40,7 @@ class QWidget;
 
 class PixmapLoader;
 class PluginView;
+class RemotePlugin;
 class AutomatableModel;
 
 /**
@@ -273,6 +276,31 @@ public:
 	//! reference the class header.  Should return null if not key not found.
 	virtual AutomatableModel* childModel( const QString & modelName );
 
+	//! Return the bytes of data the plugin loaded, like samples or sound
+	//! banks, for reporting memory use. Memory of a remote process isn't
+	//! counted here, see remotePlugin().
+	virtual size_t memoryUsage() const
+	{
+		return 0;
+	}
+
+	//! Return the remote plugin running this plugin in a process of its own,
+	//! if any
+	virtual const RemotePlugin * remotePlugin() const
+	{
+		return nullptr;
+	}
+
+	//! Called from the audio threads when the plugin's output had NaNs or
+	//! infinite values, which were replaced by silence
+	void reportBadOutput();
+
+	//! Whether the plugin ever produced NaNs or infinite values
+	bool hasBadOutput() const
+	{
+		return m_badOutput.load( std::memory_order_relaxed );
+	}
+
 	//! Overload if the argument passed to the plugin is a subPluginKey
 	//! If you can not pass the key and are aware that it's stored in
 	//! Engine::pickDndPluginKey(), use this function, too
@@ -295,9 +323,15 @@ protected:
 	void collectErrorForUI( QString errMsg );
 
 
+private slots:
+	void warnAboutBadOutput();
+
+
 private:
 	const Descriptor * m_descriptor;
 
+	std::atomic<bool> m_badOutput;
+
 	Descriptor::SubPluginFeatures::Key m_key;
 
 	// pointer to instantiation-function in plugin
@@ -27,11 +27,16 @@
 
 #include <memory>
 #include <string>
+#include <vector>
+#if !defined(__MINGW32__) && !defined(__MINGW64__)
+	#include <thread>
+#endif
 
 #include <QtCore/QFileInfo>
 #include <QtCore/QHash>
 #include <QtCore/QList>
 #include <QtCore/QString>
+#include <QtCore/QStringList>
 #include <QtCore/QVector>
 
 #include "lmms_export.h"
@@ -46,10 +51,13 @@ public:
 	{
 		const QString name() const;
 		QFileInfo file;
+		//! nullptr while the descriptor comes from the plugin cache and
+		//! the library has not been loaded yet, see loadPlugin()
 		std::shared_ptr<QLibrary> library = nullptr;
 		Plugin::Descriptor* descriptor = nullptr;
 
-		bool isNull() const {return ! library;}
+		bool isNull() const {return ! descriptor;}
+		bool isLoaded() const {return library != nullptr;}
 	};
 	typedef QList<PluginInfo> PluginInfoList;
 	typedef QMultiMap<Plugin::PluginTypes, Plugin::Descriptor*> DescriptorMap;
@@ -64,8 +72,8 @@ public:
 	static PluginFactory* instance();
 
 	/// Returns a list of all found plugins' descriptors.
-	const Plugin::DescriptorList descriptors() const;
-	const Plugin::DescriptorList descriptors(Plugin::PluginTypes type) const;
+	const Plugin::DescriptorList descriptors();
+	const Plugin::DescriptorList descriptors(Plugin::PluginTypes type);
 
 	struct PluginInfoAndKey
 	{
@@ -74,26 +82,104 @@ public:
 		bool isNull() const { return info.isNull(); }
 	};
 
+	/// Returns the sub plugins of @p desc, as listed when it was discovered.
+	const Plugin::Descriptor::SubPluginFeatures::KeyList subPluginKeys(
+		const Plugin::Descriptor* desc);
+
+	/// Changes whenever the found plugins changed, so that lists built from
+	/// them can be kept until then.
+	int revision();
+
 	/// Returns a list of all found plugins' PluginFactory::PluginInfo objects.
-	const PluginInfoList& pluginInfos() const;
+	const PluginInfoList& pluginInfos();
 	/// Returns a plugin that support the given file extension
 	const PluginInfoAndKey pluginSupportingExtension(const QString& ext);
 
 	/// Returns the PluginInfo object of the plugin with the given name.
 	/// If the plugin is not found, an empty PluginInfo is returned (use
 	/// PluginInfo::isNull() to check this).
-	const PluginInfo pluginInfo(const char* name) const;
+	const PluginInfo pluginInfo(const char* name);
+
+	/// Like pluginInfo(), but also loads the plugin's library if its
+	/// descriptor was taken from the plugin cache. Returns an empty
+	/// PluginInfo if the library can't be loaded.
+	const PluginInfo loadPlugin(const char* name);
 
 	/// When loading a library fails during discovery, the error string is saved.
 	/// It can be retrieved by calling this function.
-	QString errorString(QString pluginName) const;
+	QString errorString(QString pluginName);
 
 public slots:
 	void discoverPlugins();
 
 private:
+	//! What the plugin cache knows about a single library file
+	struct CacheEntry
+	{
+		QString path;
+		qint64 modified = 0;
+		qint64 size = 0;
+		//! false for libraries without an LMMS plugin (e.g. ZynAddSubFxCore)
+		bool isPlugin = false;
+		//! sub plugins can only be listed with the library loaded
+		bool hasSubPlugins = false;
+		QByteArray name;
+		QByteArray displayName;
+		QByteArray description;
+		QByteArray author;
+		int version = 0;
+		Plugin::PluginTypes type = Plugin::Undefined;
+		QString logo;
+		QByteArray supportedFileTypes;
+
+		bool matches(const QFileInfo& file) const;
+	};
+
+	//! Descriptor built from a cache entry, filled in from the library
+	//! by loadPlugin()
+	struct CachedDescriptor;
+
+	struct ScanResult
+	{
+		QFileInfo file;
+		std::shared_ptr<QLibrary> library;
+		Plugin::Descriptor* descriptor = nullptr;
+		QString error;
+	};
+
+	static std::vector<ScanResult> scanLibraries(const QStringList& dependencies,
+		const QFileInfoList& files);
+	static Plugin::Descriptor* resolveDescriptor(QLibrary& library, const QFileInfo& file);
+	static CacheEntry cacheEntry(const QFileInfo& file, const Plugin::Descriptor* descriptor);
+
+	void addPlugin(const PluginInfo& info);
+	void addScanResults(const std::vector<ScanResult>& results);
+	bool rescanPending() const;
+	void joinRescan();
+	void finishRescan();
+	bool loadLibrary(PluginInfo& info);
+	void loadDependencies();
+
+	QHash<QString, CacheEntry> readCache() const;
+	void writeCache() const;
+
 	DescriptorMap m_descriptors;
 	PluginInfoList m_pluginInfos;
+	//! listing them takes long for large LV2 or LADSPA collections
+	QHash<const Plugin::Descriptor*, Plugin::Descriptor::SubPluginFeatures::KeyList> m_subPluginKeys;
+	int m_revision = 0;
+
+	QString m_cacheFile;
+	QHash<QString, CacheEntry> m_cache;
+	std::vector<std::unique_ptr<CachedDescriptor>> m_cachedDescriptors;
+	QStringList m_dependencies;
+	bool m_dependenciesLoaded = false;
+
+#if !defined(__MINGW32__) && !defined(__MINGW64__)
+	//! loads the libraries whose cache entries are stale or missing
+	std::thread m_rescanThread;
+#endif
+	std::vector<ScanResult> m_rescanResults;
 
 	QMap<QString, PluginInfoAndKey> m_pluginByExt;
 	QVector<std::string> m_garbage; //!< cleaned up at destruction
@@ -0,0 +1,82 @@
+/*
+ * ProjectGenerator.h - builds synthetic songs of a given size
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef PROJECT_GENERATOR_H
+#define PROJECT_GENERATOR_H
+
+#include <QString>
+
+
+class EffectChain;
+class Song;
+
+
+//! "lmms generate": fills the empty song with instrument tracks playing
+//! evenly spaced notes, effects, a tree of mixer channels and automation,
+//! so that "lmms bench" can measure how rendering scales with each of them.
+class ProjectGenerator
+{
+public:
+	struct Settings
+	{
+		int tracks = 8;
+		int bars = 16;
+		//! Onsets per bar, each note lasts until the next one
+		int notesPerBar = 8;
+		//! Notes starting at every onset
+		int polyphony = 1;
+		//! Effects on every track and mixer channel
+		int effects = 0;
+		//! Levels of mixer channels between the tracks and the master,
+		//! 0 sends all tracks to the master directly
+		int mixerDepth = 0;
+		//! Tracks or channels sending to one channel of the level above
+		int mixerFanIn = 2;
+		//! Automation nodes per bar on the panning of every track
+		int automationPerBar = 0;
+		QString instrument = "tripleoscillator";
+		QString effect = "amplifier";
+	} ;
+
+	ProjectGenerator( const Settings & settings );
+
+	//! Builds the song into @p song, which should be empty. Returns false
+	//! if the plugins to use aren't there, see error().
+	bool generate( Song * song );
+
+	const QString & error() const
+	{
+		return m_error;
+	}
+
+private:
+	void addEffects( EffectChain * chain );
+
+	const Settings m_settings;
+	QString m_error;
+
+} ;
+
+
+#endif
@@ -25,7 +25,10 @@
 #ifndef PROJECT_JOURNAL_H
 #define PROJECT_JOURNAL_H
 
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QtCore/QStack>
 
 #include "lmms_basics.h"
@@ -51,6 +54,9 @@ public:
 
 	void addJournalCheckPoint( JournallingObject *jo );
 
+	//! The objects changed since the last call, whether journalling or not
+	QSet<jo_id_t> takeChangedIDs();
+
 	bool isJournalling() const
 	{
 		return m_journalling;
@@ -97,23 +103,39 @@ public:
 private:
 	typedef QHash<jo_id_t, JournallingObject *> JoIdMap;
 
+	//! The state of an object before a change. Plain values of models
+	//! are kept as such, anything else as compressed BinaryDocument.
 	struct CheckPoint
 	{
-		CheckPoint( jo_id_t initID = 0, const DataFile& initData = DataFile( DataFile::JournalData ) ) :
+		CheckPoint( jo_id_t initID = 0 ) :
 			joID( initID ),
-			data( initData )
+			value( 0 ),
+			time( 0 )
 		{
 		}
 		jo_id_t joID;
-		DataFile data;
+		QByteArray data;
+		float value;
+		qint64 time;
 	} ;
 	typedef QStack<CheckPoint> CheckPointStack;
 
+	CheckPoint checkPoint( JournallingObject * jo ) const;
+	void restore( JournallingObject * jo, const CheckPoint & c );
+	static qint64 size( const CheckPoint & c );
+	//! Drops the oldest undo steps above MAX_UNDO_STATES or the memory
+	//! configured in app/undomemory (MB)
+	void trim();
+
 	JoIdMap m_joIDs;
 
 	CheckPointStack m_undoCheckPoints;
 	CheckPointStack m_redoCheckPoints;
 
+	QSet<jo_id_t> m_changedIDs;
+	qint64 m_size;
+	QElapsedTimer m_clock;
+
 	bool m_journalling;
 
 } ;
@@ -25,6 +25,11 @@
 #ifndef PROJECT_RENDERER_H
 #define PROJECT_RENDERER_H
 
+#include <atomic>
+#include <vector>
+
+#include <QElapsedTimer>
+
 #include "AudioFileDevice.h"
 #include "lmmsconfig.h"
 #include "AudioEngine.h"
@@ -32,6 +37,8 @@
 
 #include "lmms_export.h"
 
+class ExportCache;
+
 class LMMS_EXPORT ProjectRenderer : public QThread
 {
 	Q_OBJECT
@@ -62,6 +69,44 @@ public:
 				const QString & _out_file );
 	virtual ~ProjectRenderer();
 
+	//! Also encodes the render into @p outputFilename, on a thread of its
+	//! own, at the sample rate of the first output. Returns false if the
+	//! file can't be written. Has to be called before startProcessing().
+	bool addOutput( ExportFileFormats fileFormat,
+				const OutputSettings & outputSettings,
+				const QString & outputFilename );
+
+	//! Keeps the bars of the render in @p directory, and only renders the
+	//! ones which changed since the last render into it, see ExportCache.
+	//! Has to be called before startProcessing().
+	void setCacheDirectory( const QString & directory )
+	{
+		m_cacheDirectory = directory;
+	}
+
+	//! See ExportCache::setMinimumPreRoll()
+	void setMinimumPreRoll( tick_t ticks )
+	{
+		m_minimumPreRoll = ticks;
+	}
+
+	//! Only renders the bars of part @p part, counting from 0, of @p parts
+	//! into the cache directory, and encodes nothing, see
+	//! ExportCache::partBegin(). Has to be called before startProcessing().
+	void setPart( int part, int parts )
+	{
+		m_part = part;
+		m_parts = parts;
+	}
+
+	//! After a render through the cache which was split into @p parts
+	//! parts, renders across the seams between the parts at a stretch and
+	//! warns if that doesn't sound like what was spliced together
+	void setVerifySeams( int parts )
+	{
+		m_seamParts = parts;
+	}
+
 	bool isReady() const
 	{
 		return m_fileDev != nullptr;
@@ -87,13 +132,49 @@ signals:
 
 private:
 	void run() override;
+	//! Where the engine is in the export, for renderWithCache()
+	struct RenderCursor
+	{
+		std::vector<surroundSampleFrame> period;
+		// how much of the last period rendered is used up
+		fpp_t periodFrames = 0;
+		fpp_t periodUsed = 0;
+		// the frame of the export at period[periodUsed]
+		f_cnt_t nextFrame = 0;
+	} ;
+
+	//! The loop of run() when the cache can be used
+	void renderWithCache( ExportCache & cache );
+	//! Renders the frames from @p first to @p end of the export into
+	//! @p frames, carrying on from @p cursor if it is between
+	//! @p preRollFrame and @p first, and seeking to @p preRoll otherwise.
+	//! Returns false if the render was aborted.
+	bool renderFrames( RenderCursor & cursor, tick_t preRoll, f_cnt_t preRollFrame,
+				f_cnt_t first, f_cnt_t end, std::vector<surroundSampleFrame> & frames );
+	void verifySeams( ExportCache & cache, RenderCursor & cursor );
+	void setProgress( int progress );
+
+	static AudioFileDevice * createFileDevice( ExportFileFormats fileFormat,
+				const OutputSettings & outputSettings,
+				const QString & outputFilename );
 
 	AudioFileDevice * m_fileDev;
+	// get the same periods as m_fileDev, deleted along with the renderer
+	std::vector<AudioFileDevice *> m_copies;
 	AudioEngine::qualitySettings m_qualitySettings;
+	QString m_cacheDirectory;
+	tick_t m_minimumPreRoll;
+	int m_part;
+	int m_parts;
+	int m_seamParts;
 
 	volatile int m_progress;
 	volatile bool m_abort;
 
+	// for reporting how much faster than realtime we render
+	QElapsedTimer m_renderTimer;
+	std::atomic<qint64> m_framesRendered;
+
 } ;
 
 #endif
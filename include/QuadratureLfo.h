@@ -25,6 +25,7 @@
 #ifndef QUADRATURELFO_H
 #define QUADRATURELFO_H
 
+#include "lmms_basics.h"
 #include "lmms_math.h"
 
 class QuadratureLfo
@@ -83,6 +84,28 @@ public:
 		}
 	}
 
+
+	//! Like tick() for @p frames frames. The sines are only computed at the
+	//! start of the block and then rotated by the increment for each frame.
+	void tick( float *l, float *r, fpp_t frames )
+	{
+		double sinL = sin( m_phase ), cosL = cos( m_phase );
+		double sinR = sin( m_phase + m_offset ), cosR = cos( m_phase + m_offset );
+		const double sinInc = sin( m_increment ), cosInc = cos( m_increment );
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			l[f] = sinL;
+			r[f] = sinR;
+			const double nextSinL = sinL * cosInc + cosL * sinInc;
+			cosL = cosL * cosInc - sinL * sinInc;
+			sinL = nextSinL;
+			const double nextSinR = sinR * cosInc + cosR * sinInc;
+			cosR = cosR * cosInc - sinR * sinInc;
+			sinR = nextSinR;
+		}
+		m_phase = fmod( m_phase + frames * m_increment, D_2PI );
+	}
+
 private:
 	double m_frequency;
 	double m_phase;
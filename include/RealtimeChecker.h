@@ -0,0 +1,108 @@
+/*
+ * RealtimeChecker.h - finds allocations, locks and file I/O on audio threads
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#ifndef REALTIME_CHECKER_H
+#define REALTIME_CHECKER_H
+
+#include "lmmsconfig.h"
+#include "lmms_export.h"
+
+class ThreadableJob;
+
+//! Debug helper for finding the sources of xruns. In builds with
+//! WANT_DEBUG_REALTIME, malloc(), blocking locks and file opens are hooked,
+//! and every call made while a thread renders audio is recorded with its
+//! stack trace and the job it happened in. A report grouped by job is
+//! written when the engine is destroyed. In all other builds, everything
+//! here compiles to nothing.
+class LMMS_EXPORT RealtimeChecker
+{
+public:
+	enum class Violation
+	{
+		Allocation,
+		Lock,
+		FileAccess,
+		Count
+	} ;
+
+	//! Marks the calling thread as rendering audio while the scope lives
+	class Scope
+	{
+	public:
+		Scope()
+		{
+			enter();
+		}
+
+		~Scope()
+		{
+			leave();
+		}
+	} ;
+
+	//! Suspends the checks on the calling thread while the scope lives
+	class Suspend
+	{
+	public:
+		Suspend()
+		{
+			leave();
+		}
+
+		~Suspend()
+		{
+			enter();
+		}
+	} ;
+
+#ifdef LMMS_DEBUG_REALTIME
+	static void enter();
+	static void leave();
+
+	//! Attributes the calling thread's violations to @p job (nullptr for
+	//! the audio engine itself)
+	static void setCurrentJob( const ThreadableJob * job );
+
+	static void record( Violation violation );
+
+	//! Moves the recorded violations into the report. Must be called by
+	//! the audio engine while no jobs are processed and all jobs which
+	//! violations were recorded for are still alive.
+	static void collect();
+
+	//! Writes the report to the file in LMMS_REALTIME_REPORT, or to stderr
+	static void writeReport();
+#else
+	static void enter() {}
+	static void leave() {}
+	static void setCurrentJob( const ThreadableJob * ) {}
+	static void record( Violation ) {}
+	static void collect() {}
+	static void writeReport() {}
+#endif
+} ;
+
+#endif
@@ -27,8 +27,10 @@
 
 #include "MidiEvent.h"
 #include "VstSyncData.h"
+#include "denormals.h"
 
 #include <atomic>
+#include <memory>
 #include <vector>
 #include <cstdio>
 #include <cstdlib>
@@ -287,7 +289,7 @@ public:
 			char * sc = new char[len + 1];
 			read( sc, len );
 			sc[len] = 0;
-			std::string s( sc );
+			std::string s( sc, len );
 			delete[] sc;
 			return s;
 		}
@@ -412,6 +414,96 @@ private:
 #endif
 
 
+#if defined(LMMS_BUILD_LINUX) && !defined(SYNC_WITH_SHM_FIFO) && !defined(USE_QT_SHMEM)
+#define SYNC_WITH_FUTEX
+
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/syscall.h>
+
+
+// the periods are started and finished through these counters in a shared
+// memory segment of their own, so that the messages are only needed for
+// control traffic - it isn't replaced when the processing memory is resized
+struct RemoteProcessingSync
+{
+	std::atomic<uint32_t> request;		// the last period started by the host
+	std::atomic<uint32_t> done;		// the last period finished by the plugin
+	std::atomic<uint32_t> hostSignals;	// bumped for every request and message
+	std::atomic<uint32_t> hostMessages;	// messages sent by the host
+	std::atomic<uint32_t> clientMessages;	// messages sent by the plugin
+	std::atomic<uint32_t> hostWaiting;	// the host sleeps on done
+	std::atomic<uint32_t> clientWaiting;	// the plugin sleeps on hostSignals
+	// hostMessages when a request was made, the messages before it
+	// belong to the period - there are at most two requests outstanding
+	std::atomic<uint32_t> requestMessages[2];
+	// the periods alternate between this many parts of the processing
+	// memory, two if the host collects a period while the next one is
+	// processed
+	uint32_t buffers;
+} ;
+
+
+namespace RemoteSync
+{
+
+// how often the waiting side checks before it goes to sleep - a plugin which
+// is done quickly doesn't need the kernel to wake anybody up
+const int SpinCount = 4000;
+
+
+inline void cpuRelax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#endif
+}
+
+
+// waits until @p word isn't @p value any more, but not longer than
+// @p timeoutMs - returns whether it changed
+inline bool wait( std::atomic<uint32_t> & word, uint32_t value,
+			std::atomic<uint32_t> & waiting, int timeoutMs )
+{
+	for( int i = 0; i < SpinCount; ++i )
+	{
+		if( word.load( std::memory_order_acquire ) != value )
+		{
+			return true;
+		}
+		cpuRelax();
+	}
+
+	// whoever changes the word sees this before it decides whether to
+	// wake us up, or we see the change
+	waiting.store( 1 );
+	if( word.load() == value )
+	{
+		timespec timeout = { timeoutMs / 1000, ( timeoutMs % 1000 ) * 1000000 };
+		syscall( SYS_futex, reinterpret_cast<uint32_t *>( &word ), FUTEX_WAIT,
+							value, &timeout, nullptr, 0 );
+	}
+	waiting.store( 0, std::memory_order_relaxed );
+	return word.load( std::memory_order_acquire ) != value;
+}
+
+
+// has to be called after changing @p word
+inline void wake( std::atomic<uint32_t> & word, std::atomic<uint32_t> & waiting )
+{
+	if( waiting.load() )
+	{
+		syscall( SYS_futex, reinterpret_cast<uint32_t *>( &word ), FUTEX_WAKE,
+							INT_MAX, nullptr, nullptr, 0 );
+	}
+}
+
+}
+#endif
+
+
 
 enum RemoteMessageIDs
 {
@@ -440,10 +532,18 @@ enum RemoteMessageIDs
 	IdSavePresetFile,
 	IdLoadPresetFile,
 	IdDebugMessage,
+	IdEnableSharedProcessing,
 	IdUserBase = 64
 } ;
 
 
+#ifndef SYNC_WITH_SHM_FIFO
+// followed by the path of a socket, the executable hosts several plugin
+// instances, getting the paths of their sockets through that one
+const char * const RemotePluginHostArgument = "--host";
+#endif
+
+
 
 class LMMS_EXPORT RemotePluginBase
 {
@@ -586,7 +686,7 @@ public:
 			char * sc = new char[len + 1];
 			read( sc, len );
 			sc[len] = 0;
-			std::string s( sc );
+			std::string s( sc, len );
 			delete[] sc;
 			return s;
 		}
@@ -666,6 +766,26 @@ protected:
 	int m_socket;
 #endif
 
+#ifdef SYNC_WITH_FUTEX
+#ifndef BUILD_REMOTE_PLUGIN_CLIENT
+	//! Sends @p m as the first message counted in @p sync, which the
+	//! plugin starts to wait on when it gets it
+	void setProcessingSync( RemoteProcessingSync * sync, const message & m );
+#endif
+
+	RemoteProcessingSync * m_sync;
+#ifdef BUILD_REMOTE_PLUGIN_CLIENT
+	//! Called by receiveMessage() for IdEnableSharedProcessing, so that
+	//! the thread reading the messages is the one which starts waiting
+	void attachProcessingSync( key_t _key );
+
+	// what receiveMessage() took from m_sync
+	uint32_t m_messagesRead;
+	uint32_t m_lastRequest;
+	bool m_requestPending;
+#endif
+#endif
+
 
 private:
 #ifndef BUILD_REMOTE_PLUGIN_CLIENT
@@ -733,6 +853,8 @@ private:
 	}
 
 
+	int writeMessage( const message & _m );
+
 	bool m_invalid;
 
 	pthread_mutex_t m_receiveMutex;
@@ -775,6 +897,51 @@ private:
 } ;
 
 
+#ifndef SYNC_WITH_SHM_FIFO
+//! A process of a plugin executable hosting the instances of several
+//! RemotePlugins, each on a socket and in memory of its own. The process
+//! is quit once the last instance is gone.
+class RemotePluginHost : public QThread
+{
+public:
+	//! The process hosting the instances of @p exec, started if there's
+	//! none yet
+	static std::shared_ptr<RemotePluginHost> acquire( const QString & exec );
+	virtual ~RemotePluginHost();
+
+	bool processRunning() const
+	{
+		return m_process.state() != QProcess::NotRunning;
+	}
+
+	qint64 processId() const
+	{
+		return m_process.processId();
+	}
+
+	//! Has the process connect an instance to @p plugin's socket, returns
+	//! false if it can't
+	bool addInstance( RemotePlugin * plugin, const QString & socketFile );
+	void removeInstance( RemotePlugin * plugin );
+
+private:
+	RemotePluginHost( const QString & exec );
+
+	void run() override;
+
+	QProcess m_process;
+	const QString m_exec;
+	QString m_socketFile;
+	int m_server;
+	int m_socket;
+	volatile bool m_quit;
+
+	QMutex m_instancesMutex;
+	std::vector<RemotePlugin *> m_instances;
+} ;
+#endif
+
+
 class LMMS_EXPORT RemotePlugin : public QObject, public RemotePluginBase
 {
 	Q_OBJECT
@@ -787,11 +954,34 @@ public:
 #ifdef DEBUG_REMOTE_PLUGIN
 		return true;
 #else
+#ifndef SYNC_WITH_SHM_FIFO
+		if( m_host )
+		{
+			return m_host->processRunning();
+		}
+#endif
 		return m_process.state() != QProcess::NotRunning;
 #endif
 	}
 
-	bool init( const QString &pluginExecutable, bool waitForInitDoneMsg, QStringList extraArgs = {} );
+	//! The process running the plugin, shared with other instances if it
+	//! hosts several, or 0 if it isn't running
+	qint64 processId() const
+	{
+#ifndef SYNC_WITH_SHM_FIFO
+		if( m_host )
+		{
+			return m_host->processId();
+		}
+#endif
+		return m_process.processId();
+	}
+
+	//! With @p shareProcess, the plugin may be hosted by a process of
+	//! @p pluginExecutable running other instances too, if the executable
+	//! knows to run several and the user wants it
+	bool init( const QString &pluginExecutable, bool waitForInitDoneMsg, QStringList extraArgs = {},
+			bool shareProcess = false );
 
 	inline void waitForHostInfoGotten()
 	{
@@ -810,6 +1000,10 @@ public:
 
 	void processMidiEvent( const MidiEvent&, const f_cnt_t _offset );
 
+	//! Frames process() delays the output by, one period if the plugin
+	//! is pipelined
+	f_cnt_t latency() const;
+
 	void updateSampleRate( sample_rate_t _sr )
 	{
 		lock();
@@ -864,6 +1058,14 @@ protected:
 	bool m_failed;
 private:
 	void resizeSharedProcessingMemory();
+#ifdef SYNC_WITH_FUTEX
+	void enableSharedProcessing();
+	void destroyProcessingSync();
+	//! Waits until the plugin finished @p request
+	void waitForProcessingDone( uint32_t request );
+#endif
+	//! The periods the processing memory holds
+	int processingBuffers() const;
 
 
 	QProcess m_process;
@@ -888,9 +1090,22 @@ private:
 #ifndef SYNC_WITH_SHM_FIFO
 	int m_server;
 	QString m_socketFile;
+	// the process running this instance along with others, if any
+	std::shared_ptr<RemotePluginHost> m_host;
+#endif
+
+#ifdef SYNC_WITH_FUTEX
+	int m_syncShmID;
+	// whether the plugin takes the periods from m_sync
+	bool m_sharedProcessing;
+	uint32_t m_clientMessages;
+	// whether process() returns the period of the last call, so that
+	// the plugin can process while the caller goes on
+	bool m_pipelined;
 #endif
 
 	friend class ProcessWatcher;
+	friend class RemotePluginHost;
 
 
 private slots:
@@ -914,9 +1129,17 @@ public:
 	virtual ~RemotePluginClient();
 #ifdef USE_QT_SHMEM
 	VstSyncData * getQtVSTshm();
+#endif
+#ifndef SYNC_WITH_SHM_FIFO
+	//! Returns the descriptor of a socket connected to @p socketPath
+	static int connectToSocket( const char * socketPath );
+	//! Reads the socket path of the next instance a host process is to
+	//! run from @p hostSocket, returns false once there are no more
+	static bool nextHostedInstance( int hostSocket, std::string & socketPath );
 #endif
 	virtual bool processMessage( const message & _m );
 
+	//! Has to write all outputs, the host doesn't clear them
 	virtual void process( const sampleFrame * _in_buf,
 					sampleFrame * _out_buf ) = 0;
 
@@ -1023,6 +1246,14 @@ RemotePluginBase::RemotePluginBase( shmFifo * _in, shmFifo * _out ) :
 #else
 RemotePluginBase::RemotePluginBase() :
 	m_socket( -1 ),
+#ifdef SYNC_WITH_FUTEX
+	m_sync( nullptr ),
+#ifdef BUILD_REMOTE_PLUGIN_CLIENT
+	m_messagesRead( 0 ),
+	m_lastRequest( 0 ),
+	m_requestPending( false ),
+#endif
+#endif
 	m_invalid( false )
 #endif
 {
@@ -1070,6 +1301,19 @@ int RemotePluginBase::sendMessage( const message & _m )
 	m_out->messageSent();
 #else
 	pthread_mutex_lock( &m_sendMutex );
+	const int j = writeMessage( _m );
+	pthread_mutex_unlock( &m_sendMutex );
+#endif
+
+	return j;
+}
+
+
+
+
+#ifndef SYNC_WITH_SHM_FIFO
+int RemotePluginBase::writeMessage( const message & _m )
+{
 	writeInt( _m.id );
 	writeInt( _m.data.size() );
 	int j = 8;
@@ -1078,11 +1322,38 @@ int RemotePluginBase::sendMessage( const message & _m )
 		writeString( _m.data[i] );
 		j += 4 + _m.data[i].size();
 	}
-	pthread_mutex_unlock( &m_sendMutex );
+
+#ifdef SYNC_WITH_FUTEX
+	// counted once it was written, so that whoever sees the count can
+	// read the whole message
+	if( m_sync != nullptr )
+	{
+#ifdef BUILD_REMOTE_PLUGIN_CLIENT
+		m_sync->clientMessages.fetch_add( 1, std::memory_order_release );
+#else
+		m_sync->hostMessages.fetch_add( 1, std::memory_order_release );
+		m_sync->hostSignals.fetch_add( 1 );
+		RemoteSync::wake( m_sync->hostSignals, m_sync->clientWaiting );
+#endif
+	}
 #endif
 
 	return j;
 }
+#endif
+
+
+
+
+#if defined(SYNC_WITH_FUTEX) && !defined(BUILD_REMOTE_PLUGIN_CLIENT)
+void RemotePluginBase::setProcessingSync( RemoteProcessingSync * sync, const message & m )
+{
+	pthread_mutex_lock( &m_sendMutex );
+	m_sync = sync;
+	writeMessage( m );
+	pthread_mutex_unlock( &m_sendMutex );
+}
+#endif
 
 
 
@@ -1101,6 +1372,51 @@ RemotePluginBase::message RemotePluginBase::receiveMessage()
 	}
 	m_in->unlock();
 #else
+#if defined(SYNC_WITH_FUTEX) && defined(BUILD_REMOTE_PLUGIN_CLIENT)
+	// once the host counts its messages, the socket is only read when
+	// there is one, so that the periods it starts can be waited for too
+	while( m_sync != nullptr && !isInvalid() )
+	{
+		const uint32_t signals = m_sync->hostSignals.load( std::memory_order_acquire );
+		// the periods one after another, each after the messages sent
+		// before it
+		const uint32_t request = m_sync->request.load( std::memory_order_acquire );
+		const uint32_t next = m_lastRequest + 1;
+		const bool requested = request != m_lastRequest;
+		if( requested && static_cast<int32_t>( m_sync->requestMessages[next % 2].load(
+					std::memory_order_relaxed ) - m_messagesRead ) <= 0 )
+		{
+			m_lastRequest = next;
+			m_requestPending = true;
+			return message( IdStartProcessing );
+		}
+		if( static_cast<int32_t>( m_sync->hostMessages.load( std::memory_order_acquire ) -
+								m_messagesRead ) > 0 )
+		{
+			++m_messagesRead;
+			break;
+		}
+		if( requested )
+		{
+			continue;
+		}
+		if( !RemoteSync::wait( m_sync->hostSignals, signals, m_sync->clientWaiting, 500 ) )
+		{
+			// the host may have gone away without telling
+			struct pollfd pollin;
+			pollin.fd = m_socket;
+			pollin.events = POLLIN;
+			if( poll( &pollin, 1, 0 ) > 0 && ( pollin.revents & ( POLLHUP | POLLERR ) ) )
+			{
+				invalidate();
+			}
+		}
+	}
+	if( isInvalid() )
+	{
+		return message();
+	}
+#endif
 	pthread_mutex_lock( &m_receiveMutex );
 	message m;
 	m.id = readInt();
@@ -1110,6 +1426,12 @@ RemotePluginBase::message RemotePluginBase::receiveMessage()
 		m.data.push_back( readString() );
 	}
 	pthread_mutex_unlock( &m_receiveMutex );
+#if defined(SYNC_WITH_FUTEX) && defined(BUILD_REMOTE_PLUGIN_CLIENT)
+	if( m.id == IdEnableSharedProcessing && m_sync == nullptr )
+	{
+		attachProcessingSync( m.getInt( 0 ) );
+	}
+#endif
 #endif
 	return m;
 }
@@ -1203,35 +1525,18 @@ RemotePluginClient::RemotePluginClient( const char * socketPath ) :
 	m_bufferSize( 0 )
 {
 #ifndef SYNC_WITH_SHM_FIFO
-	struct sockaddr_un sa;
-	sa.sun_family = AF_LOCAL;
-
-	size_t length = strlen( socketPath );
-	if ( length >= sizeof sa.sun_path )
-	{
-		length = sizeof sa.sun_path - 1;
-		fprintf( stderr, "Socket path too long.\n" );
-	}
-	memcpy( sa.sun_path, socketPath, length );
-	sa.sun_path[length] = '\0';
-
-	m_socket = socket( PF_LOCAL, SOCK_STREAM, 0 );
-	if ( m_socket == -1 )
-	{
-		fprintf( stderr, "Could not connect to local server.\n" );
-	}
-	if ( ::connect( m_socket, (struct sockaddr *) &sa, sizeof sa ) == -1 )
-	{
-		fprintf( stderr, "Could not connect to local server.\n" );
-	}
+	m_socket = connectToSocket( socketPath );
 #endif
 
 #ifdef USE_QT_SHMEM
 	if( m_shmQtID.attach( QSharedMemory::ReadOnly ) )
 	{
 		m_vstSyncData = (VstSyncData *) m_shmQtID.data();
-		m_bufferSize = m_vstSyncData->m_bufferSize;
-		m_sampleRate = m_vstSyncData->m_sampleRate;
+		VstSyncState state;
+		uint32_t version = VST_SNC_NO_VERSION;
+		m_vstSyncData->read( state, version );
+		m_bufferSize = state.m_bufferSize;
+		m_sampleRate = state.m_sampleRate;
 		sendMessage( IdHostInfoGotten );
 		return;
 	}
@@ -1258,8 +1563,11 @@ RemotePluginClient::RemotePluginClient( const char * socketPath ) :
 			}
 			else
 			{
-				m_bufferSize = m_vstSyncData->m_bufferSize;
-				m_sampleRate = m_vstSyncData->m_sampleRate;
+				VstSyncState state;
+				uint32_t version = VST_SNC_NO_VERSION;
+				m_vstSyncData->read( state, version );
+				m_bufferSize = state.m_bufferSize;
+				m_sampleRate = state.m_sampleRate;
 				sendMessage( IdHostInfoGotten );
 
 				// detach segment
@@ -1297,6 +1605,12 @@ RemotePluginClient::~RemotePluginClient()
 #ifndef USE_QT_SHMEM
 	shmdt( m_shm );
 #endif
+#ifdef SYNC_WITH_FUTEX
+	if( m_sync != nullptr )
+	{
+		shmdt( m_sync );
+	}
+#endif
 
 #ifndef SYNC_WITH_SHM_FIFO
 	if ( close( m_socket ) == -1)
@@ -1317,6 +1631,72 @@ VstSyncData * RemotePluginClient::getQtVSTshm()
 
 
 
+#ifndef SYNC_WITH_SHM_FIFO
+int RemotePluginClient::connectToSocket( const char * socketPath )
+{
+	struct sockaddr_un sa;
+	sa.sun_family = AF_LOCAL;
+
+	size_t length = strlen( socketPath );
+	if ( length >= sizeof sa.sun_path )
+	{
+		length = sizeof sa.sun_path - 1;
+		fprintf( stderr, "Socket path too long.\n" );
+	}
+	memcpy( sa.sun_path, socketPath, length );
+	sa.sun_path[length] = '\0';
+
+	const int s = socket( PF_LOCAL, SOCK_STREAM, 0 );
+	if ( s == -1 )
+	{
+		fprintf( stderr, "Could not connect to local server.\n" );
+	}
+	if ( ::connect( s, (struct sockaddr *) &sa, sizeof sa ) == -1 )
+	{
+		fprintf( stderr, "Could not connect to local server.\n" );
+	}
+	return s;
+}
+
+
+
+
+bool RemotePluginClient::nextHostedInstance( int hostSocket, std::string & socketPath )
+{
+	const auto readAll = [hostSocket]( void * _buf, int _len )
+	{
+		char * buf = (char *) _buf;
+		while( _len )
+		{
+			const ssize_t nread = ::read( hostSocket, buf, _len );
+			if( nread <= 0 )
+			{
+				return false;
+			}
+			buf += nread;
+			_len -= nread;
+		}
+		return true;
+	};
+
+	// the length, then the path, as written by RemotePluginHost
+	int32_t length = 0;
+	if( !readAll( &length, sizeof( length ) ) || length <= 0 )
+	{
+		return false;
+	}
+	std::vector<char> path( length );
+	if( !readAll( path.data(), length ) )
+	{
+		return false;
+	}
+	socketPath.assign( path.begin(), path.end() );
+	return true;
+}
+#endif
+
+
+
 bool RemotePluginClient::processMessage( const message & _m )
 {
 	message reply_message( _m.id );
@@ -1356,6 +1736,15 @@ bool RemotePluginClient::processMessage( const message & _m )
 
 		case IdStartProcessing:
 			doProcessing();
+#ifdef SYNC_WITH_FUTEX
+			if( m_requestPending )
+			{
+				m_requestPending = false;
+				m_sync->done.store( m_lastRequest, std::memory_order_release );
+				RemoteSync::wake( m_sync->done, m_sync->hostWaiting );
+				break;
+			}
+#endif
 			reply_message.id = IdProcessingDone;
 			reply = true;
 			break;
@@ -1364,6 +1753,12 @@ bool RemotePluginClient::processMessage( const message & _m )
 			setShmKey( _m.getInt( 0 ), _m.getInt( 1 ) );
 			break;
 
+#ifdef SYNC_WITH_FUTEX
+		case IdEnableSharedProcessing:
+			// see receiveMessage()
+			break;
+#endif
+
 		case IdInitDone:
 			break;
 
@@ -1428,12 +1823,46 @@ void RemotePluginClient::setShmKey( key_t _key, int _size )
 
 
 
+#ifdef SYNC_WITH_FUTEX
+void RemotePluginBase::attachProcessingSync( key_t _key )
+{
+	const int shm_id = shmget( _key, sizeof( RemoteProcessingSync ), 0 );
+	void * sync = shm_id != -1 ? shmat( shm_id, 0, 0 ) : (void *) -1;
+	if( sync == (void *) -1 )
+	{
+		// the host keeps sending messages then
+		fprintf( stderr, "failed getting processing sync memory\n" );
+		return;
+	}
+
+	// the message which told us about it was the first one counted
+	m_sync = static_cast<RemoteProcessingSync *>( sync );
+	m_messagesRead = 1;
+	m_lastRequest = m_sync->request.load( std::memory_order_acquire );
+	sendMessage( IdEnableSharedProcessing );
+}
+#endif
+
+
+
+
 void RemotePluginClient::doProcessing()
 {
+	// the thread calling this is up to the plugin, and the flags may be
+	// changed by the plugin itself
+	disable_denormals();
 	if( m_shm != nullptr )
 	{
-		process( (sampleFrame *)( m_inputCount > 0 ? m_shm : nullptr ),
-				(sampleFrame *)( m_shm +
+		float * shm = m_shm;
+#ifdef SYNC_WITH_FUTEX
+		if( m_requestPending )
+		{
+			shm += ( m_lastRequest % m_sync->buffers ) *
+				( m_inputCount + m_outputCount ) * m_bufferSize;
+		}
+#endif
+		process( (sampleFrame *)( m_inputCount > 0 ? shm : nullptr ),
+				(sampleFrame *)( shm +
 					( m_inputCount*m_bufferSize ) ) );
 	}
 	else
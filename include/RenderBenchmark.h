@@ -0,0 +1,79 @@
+/*
+ * RenderBenchmark.h - renders a project repeatedly and reports timings
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef RENDER_BENCHMARK_H
+#define RENDER_BENCHMARK_H
+
+#include <array>
+#include <vector>
+
+#include <QJsonObject>
+#include <QThread>
+
+#include "AudioEngine.h"
+#include "AudioEngineProfiler.h"
+
+
+//! "lmms bench": renders the loaded song a number of times into a device
+//! which throws the audio away, as fast as possible, and reports how long
+//! the periods and the stages of AudioEngine::renderNextBuffer() took.
+class RenderBenchmark : public QThread
+{
+	Q_OBJECT
+public:
+	RenderBenchmark( const AudioEngine::qualitySettings & qualitySettings, int runs );
+	//! Gives the audio engine its previous device back
+	~RenderBenchmark() override;
+
+	//! Sets up the audio engine and starts rendering. GUI thread.
+	void startProcessing();
+
+	//! The timings of all runs and the memory the project takes, see
+	//! MemoryReport, after the thread has finished. GUI thread.
+	QJsonObject report() const;
+
+private:
+	static constexpr int NumStages = static_cast<int>( AudioEngineProfiler::Stage::Count );
+
+	struct Run
+	{
+		qint64 time = 0;
+		qint64 frames = 0;
+		// microseconds per period, and per stage in total
+		std::vector<qint64> periods;
+		std::array<qint64, NumStages> stages{};
+	} ;
+
+	void run() override;
+
+	const AudioEngine::qualitySettings m_qualitySettings;
+	const int m_runs;
+	std::vector<Run> m_results;
+	sample_rate_t m_sampleRate;
+	fpp_t m_framesPerPeriod;
+
+} ;
+
+
+#endif
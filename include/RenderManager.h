@@ -27,6 +27,12 @@
 #define RENDER_MANAGER_H
 
 #include <memory>
+#include <vector>
+
+#include <QHash>
+#include <QProcess>
+#include <QStringList>
+#include <QTemporaryDir>
 
 #include "ProjectRenderer.h"
 #include "OutputSettings.h"
@@ -44,12 +50,65 @@ public:
 
 	virtual ~RenderManager();
 
+	/// Also write the render of renderProject() into outputPath, with fmt
+	/// and outputSettings. The project is only rendered once, at the
+	/// sample rate of the first output.
+	void addOutput( ProjectRenderer::ExportFileFormats fmt,
+			const OutputSettings & outputSettings, const QString & outputPath );
+
+	/// Keep the bars rendered by renderProject() in directory, so that
+	/// the next render into it only renders the ones that changed
+	void setCacheDirectory( const QString & directory )
+	{
+		m_cacheDirectory = directory;
+	}
+
+	/// Start the render of every bar at least ticks early when rendering
+	/// through the cache, see ExportCache::setMinimumPreRoll()
+	void setMinimumPreRoll( tick_t ticks )
+	{
+		m_minimumPreRoll = ticks;
+	}
+
+	/// Make renderProject() only render part part (counting from 0) of
+	/// parts into the cache directory, for a distributed render
+	void setPart( int part, int parts )
+	{
+		m_part = part;
+		m_parts = parts;
+	}
+
+	/// Have renderProjectInParts() render across the seams between the
+	/// parts again and warn if they don't match
+	void setVerifySeams( bool verify )
+	{
+		m_verifySeams = verify;
+	}
+
 	/// Export all unmuted tracks into a single file
 	void renderProject();
 
+	/// Export all unmuted tracks into a single file, rendering the song in
+	/// parts parts at once. Every part is rendered into the cache directory
+	/// (a temporary one if none was set) by a separate LMMS process, started
+	/// with workerArgs and "--part <number>", and this one puts them
+	/// together, rendering what is missing. Parts rendered on other
+	/// machines into the same directory beforehand aren't rendered again.
+	void renderProjectInParts( int parts, const QStringList & workerArgs );
+
 	/// Export all unmuted tracks into individual file
 	void renderTracks();
 
+	/// Export all unmuted tracks into individual files, rendering up to
+	/// jobs of them at once. Every track is rendered by a separate LMMS
+	/// process, started with workerArgs and "--stems <number>", so the files
+	/// are the same as the ones renderTracks() writes.
+	void renderTracksInParallel( int jobs, const QStringList & workerArgs );
+
+	/// Only render the tracks with these numbers (counting from 1, in the
+	/// order used for the file names) in renderTracks()
+	void setStemSelection( const QVector<int> & stems );
+
 	void abortProcessing();
 
 signals:
@@ -59,23 +118,54 @@ signals:
 private slots:
 	void renderNextTrack();
 	void updateConsoleProgress();
+	void workerFinished( int exitCode, QProcess::ExitStatus exitStatus );
 
 private:
+	struct Output
+	{
+		ProjectRenderer::ExportFileFormats format;
+		OutputSettings outputSettings;
+		QString path;
+	} ;
+
 	QString pathForTrack( const Track *track, int num );
+	void collectUnmutedTracks();
 	void restoreMutedState();
+	void startWorkers();
+	void workerDone( QProcess * worker, bool successful );
 
-	void render( QString outputPath );
+	void render( QString outputPath, const std::vector<Output> & moreOutputs = {},
+			const QString & cacheDirectory = QString() );
 
 	const AudioEngine::qualitySettings m_qualitySettings;
 	const AudioEngine::qualitySettings m_oldQualitySettings;
 	const OutputSettings m_outputSettings;
 	ProjectRenderer::ExportFileFormats m_format;
 	QString m_outputPath;
+	std::vector<Output> m_moreOutputs;
+	QString m_cacheDirectory;
+	tick_t m_minimumPreRoll;
 
 	std::unique_ptr<ProjectRenderer> m_activeRenderer;
 
 	QVector<Track*> m_tracksToRender;
 	QVector<Track*> m_unmuted;
+	QVector<int> m_stemSelection;
+
+	// parallel export by worker processes, of stems or of parts of the
+	// song if m_parts isn't 0
+	QStringList m_workerArgs;
+	int m_maxWorkers;
+	QVector<int> m_pendingJobs;
+	QHash<QProcess*, int> m_workers;
+	int m_jobsDone;
+	int m_jobsFailed;
+
+	// distributed export, m_part is -1 unless this renders a single part
+	int m_part;
+	int m_parts;
+	bool m_verifySeams;
+	std::unique_ptr<QTemporaryDir> m_partsDirectory;
 } ;
 
 #endif
@@ -0,0 +1,88 @@
+/*
+ * RenderServer.h - renders projects dropped into a queue directory
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef RENDER_SERVER_H
+#define RENDER_SERVER_H
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QTimer>
+
+#include "AudioEngine.h"
+#include "OutputSettings.h"
+#include "ProjectRenderer.h"
+
+class RenderManager;
+
+
+//! Long-running render mode ("lmms serve"): the engine, wavetables and
+//! plugin descriptors are set up once, then every project file that shows
+//! up in the queue directory is rendered in turn. Rendered files and the
+//! finished projects go to done/, projects that failed to load go to
+//! failed/. Creating a file named "quit" in the queue stops the server.
+class RenderServer : public QObject
+{
+	Q_OBJECT
+public:
+	RenderServer( const QString & queuePath,
+		const AudioEngine::qualitySettings & qualitySettings,
+		const OutputSettings & outputSettings,
+		ProjectRenderer::ExportFileFormats fmt,
+		bool renderLoop );
+	virtual ~RenderServer();
+
+	bool start();
+
+signals:
+	void finished();
+
+private slots:
+	void checkQueue();
+	void jobFinished();
+
+private:
+	void finishJob( const QString & dir );
+
+	const QDir m_queue;
+	const AudioEngine::qualitySettings m_qualitySettings;
+	const OutputSettings m_outputSettings;
+	const ProjectRenderer::ExportFileFormats m_format;
+	const bool m_renderLoop;
+
+	QTimer m_pollTimer;
+	QTimer m_progressTimer;
+
+	// the job being rendered
+	RenderManager * m_renderManager;
+	QString m_jobFile;
+	QElapsedTimer m_jobTimer;
+	qint64 m_loadTime;
+
+	int m_jobsDone;
+	int m_jobsFailed;
+
+} ;
+
+
+#endif
@@ -0,0 +1,174 @@
+/*
+ * RenderSnapshot.h - lists published to the render thread without locking
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <QMutex>
+#include <QThread>
+
+
+//! Tracks the part of each period in which the render thread (and the
+//! workers helping it) read RenderSnapshots. The epoch is odd while such a
+//! period is running, so a writer can tell whether the render thread can
+//! still be using a version it just replaced.
+class RenderGracePeriod
+{
+public:
+	RenderGracePeriod() :
+		m_epoch(0)
+	{
+	}
+
+	void enterPeriod()
+	{
+		m_epoch.fetch_add(1, std::memory_order_seq_cst);
+	}
+
+	void leavePeriod()
+	{
+		m_epoch.fetch_add(1, std::memory_order_release);
+	}
+
+	uint64_t epoch() const
+	{
+		return m_epoch.load(std::memory_order_seq_cst);
+	}
+
+	//! Whether a period that was running at @p epoch (if any) has ended
+	bool hasPassed(uint64_t epoch) const
+	{
+		return (epoch & 1) == 0 || m_epoch.load(std::memory_order_acquire) > epoch;
+	}
+
+	//! Blocks until hasPassed(@p epoch). Must not be called by the render
+	//! thread between enterPeriod() and leavePeriod().
+	void waitFor(uint64_t epoch) const
+	{
+		while (!hasPassed(epoch))
+		{
+			QThread::usleep(100);
+		}
+	}
+
+private:
+	std::atomic<uint64_t> m_epoch;
+} ;
+
+
+
+
+//! Immutable copy of a list the render thread iterates, replaced as a whole
+//! by writers (RCU-style). Writers only serialize among themselves, the
+//! render thread never blocks and never sees a half-modified list. Replaced
+//! versions are freed once the grace period they were retired in is over.
+template<typename T>
+class RenderSnapshot
+{
+public:
+	RenderSnapshot() :
+		m_current(new T)
+	{
+	}
+
+	~RenderSnapshot()
+	{
+		delete m_current.load(std::memory_order_relaxed);
+		for (auto & retired : m_retired)
+		{
+			delete retired.first;
+		}
+	}
+
+	RenderSnapshot(const RenderSnapshot &) = delete;
+	RenderSnapshot & operator=(const RenderSnapshot &) = delete;
+
+	//! Render thread only, between enterPeriod() and leavePeriod() - the
+	//! returned reference stays valid until leavePeriod()
+	const T & read() const
+	{
+		return *m_current.load(std::memory_order_seq_cst);
+	}
+
+	//! Publishes a copy of the current version, modified by @p modify
+	template<typename Fn>
+	void update(Fn modify, const RenderGracePeriod & grace)
+	{
+		QMutexLocker guard(&m_writeMutex);
+		T * next = new T(*m_current.load(std::memory_order_relaxed));
+		modify(*next);
+		retire(m_current.exchange(next, std::memory_order_seq_cst), grace);
+	}
+
+	void publish(const T & value, const RenderGracePeriod & grace)
+	{
+		QMutexLocker guard(&m_writeMutex);
+		retire(m_current.exchange(new T(value), std::memory_order_seq_cst), grace);
+	}
+
+	//! Waits until the render thread can't be reading any version published
+	//! before this call, e.g. before deleting an object that was removed
+	void synchronize(const RenderGracePeriod & grace)
+	{
+		grace.waitFor(grace.epoch());
+
+		QMutexLocker guard(&m_writeMutex);
+		reclaim(grace);
+	}
+
+private:
+	void retire(T * old, const RenderGracePeriod & grace)
+	{
+		m_retired.emplace_back(old, grace.epoch());
+		reclaim(grace);
+	}
+
+	void reclaim(const RenderGracePeriod & grace)
+	{
+		for (size_t i = 0; i < m_retired.size(); )
+		{
+			if (grace.hasPassed(m_retired[i].second))
+			{
+				delete m_retired[i].first;
+				m_retired[i] = m_retired.back();
+				m_retired.pop_back();
+			}
+			else
+			{
+				++i;
+			}
+		}
+	}
+
+	std::atomic<T *> m_current;
+	QMutex m_writeMutex;
+	std::vector<std::pair<T *, uint64_t>> m_retired;
+} ;
+
+#endif
@@ -0,0 +1,77 @@
+/*
+ * Resampler.h - interpolating resampler for sample playback
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+
+//! Resampler for the cheap interpolation modes, which doesn't pay for
+//! libsamplerate's generic converter on every call. The fractional read
+//! position is kept between calls, so consecutive fragments join without
+//! a seam and the pitch may change from call to call.
+class LMMS_EXPORT Resampler
+{
+public:
+	enum class Mode
+	{
+		ZeroOrderHold,
+		Linear,
+		CubicHermite
+	} ;
+
+	//! Frames needed after the last interpolated position
+	static constexpr f_cnt_t Margin = 3;
+
+	explicit Resampler( Mode mode );
+
+	Mode mode() const
+	{
+		return m_mode;
+	}
+
+	void reset();
+
+	//! Renders @p frames frames into @p out, reading @p step input frames
+	//! per output frame. @p in must hold frames * step + Margin frames.
+	//! Returns the number of input frames used up, the next call starts
+	//! reading behind them.
+	f_cnt_t process( const sampleFrame * in, sampleFrame * out,
+						fpp_t frames, double step );
+
+private:
+	template<Mode M>
+	void render( const sampleFrame * in, sampleFrame * out, fpp_t frames,
+						double step ) const;
+
+	Mode m_mode;
+	// fractional position of the next output frame behind the first input frame
+	double m_position;
+	// the input frame before the first one of the next call, cubic
+	// interpolation reads it
+	sampleFrame m_previous;
+} ;
+
+#endif
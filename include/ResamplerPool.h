@@ -0,0 +1,67 @@
+/*
+ * ResamplerPool.h - recycled libsamplerate states
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef RESAMPLER_POOL_H
+#define RESAMPLER_POOL_H
+
+#include <array>
+#include <atomic>
+
+#include <samplerate.h>
+
+#include "lmms_export.h"
+
+
+//! libsamplerate states, made in advance and recycled, so that starting a
+//! sample voice on the audio thread doesn't have to allocate. Only when more states are in use than were ever given back,
+//! new ones are allocated.
+class LMMS_EXPORT ResamplerPool
+{
+public:
+	//! Created by the AudioEngine
+	static ResamplerPool & inst();
+
+	~ResamplerPool();
+
+	//! Any thread. A state for @p mode which was reset, or nullptr if
+	//! libsamplerate fails to create one.
+	SRC_STATE * take(int mode);
+
+	//! Any thread. Returns @p state, which take() returned for @p mode.
+	void give(int mode, SRC_STATE * state);
+
+private:
+	ResamplerPool();
+
+	// SRC_SINC_BEST_QUALITY, SRC_SINC_MEDIUM_QUALITY, SRC_SINC_FASTEST,
+	// SRC_ZERO_ORDER_HOLD and SRC_LINEAR
+	static const int Modes = 5;
+	static const int Capacity = 64;
+
+	// empty slots are nullptr
+	std::array<std::atomic<SRC_STATE *>, Capacity> m_states[Modes];
+} ;
+
+
+#endif
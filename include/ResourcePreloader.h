@@ -0,0 +1,67 @@
+/*
+ * ResourcePreloader.h - reads the files of a project ahead of its plugins
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef RESOURCE_PRELOADER_H
+#define RESOURCE_PRELOADER_H
+
+#include <atomic>
+
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QXmlStreamAttributes>
+
+class QDomElement;
+class DataFileStream;
+
+
+//! Plugins open their SoundFonts, patches, GIG files and plugin libraries
+//! one after another on the main thread while a project loads. This reads
+//! those files on a few threads of its own before they get there, so they
+//! are found in the system's file cache. Samples aren't read here, as
+//! SampleBuffer decodes them in the background already.
+class ResourcePreloader
+{
+public:
+	ResourcePreloader();
+	//! Stops reading what hasn't been read yet
+	~ResourcePreloader();
+
+	//! Reads the files referred to by @p element and its children
+	void add(const QDomElement & element);
+	//! Reads the files referred to by the whole project of @p stream
+	void add(const DataFileStream & stream);
+
+private:
+	void add(const QString & tagName, const QXmlStreamAttributes & attributes);
+	void addFile(const QString & file);
+
+	QThreadPool m_pool;
+	QSet<QString> m_files;
+	qint64 m_bytes;
+	std::atomic<bool> m_cancelled;
+} ;
+
+
+#endif
@@ -26,7 +26,10 @@
 #ifndef SAMPLE_BUFFER_H
 #define SAMPLE_BUFFER_H
 
+#include <atomic>
 #include <memory>
+#include <optional>
+#include <vector>
 #include <QtCore/QReadWriteLock>
 #include <QtCore/QObject>
 
@@ -39,10 +42,15 @@
 #include "shared_object.h"
 #include "OscillatorConstants.h"
 #include "MemoryManager.h"
+#include "Resampler.h"
+#include "SampleCache.h"
 
 
 class QPainter;
 class QRect;
+class CompactSamples;
+class SampleStream;
+class WaveformOverview;
 
 // values for buffer margins, used for various libsamplerate interpolation modes
 // the array positions correspond to the converter_type parameter values in libsamplerate
@@ -65,6 +73,8 @@ public:
 		MM_OPERATORS
 	public:
 		handleState(bool varyingPitch = false, int interpolationMode = SRC_LINEAR);
+		handleState(const handleState &) = delete;
+		handleState & operator=(const handleState &) = delete;
 		virtual ~handleState();
 
 		const f_cnt_t frameIndex() const
@@ -92,12 +102,19 @@ public:
 			return m_interpolationMode;
 		}
 
+		//! Rewind to the first frame, without reallocating the resampler
+		void reset();
+
 
 	private:
 		f_cnt_t m_frameIndex;
 		const bool m_varyingPitch;
 		bool m_isBackwards;
+		// only one of them is used, depending on the interpolation mode.
+		// Neither is allocated for a voice, m_resamplingData comes from
+		// the ResamplerPool.
 		SRC_STATE * m_resamplingData;
+		std::optional<Resampler> m_resampler;
 		int m_interpolationMode;
 
 		friend class SampleBuffer;
@@ -231,16 +248,80 @@ public:
 		m_sampleRate = rate;
 	}
 
+	//! nullptr if the buffer isCompact()
 	inline const sampleFrame * data() const
 	{
 		return m_data;
 	}
 
+	//! Lets files long enough be streamed from disk rather than decoded
+	//! into memory, see SampleStream. Such buffers only play forward at
+	//! the original pitch, and data() holds just a single silent frame.
+	void setStreamingAllowed(bool allowed)
+	{
+		m_streamingAllowed = allowed;
+	}
+
+	SampleStream * stream() const
+	{
+		return m_stream.get();
+	}
+
+	//! While a project loads, lets files be decoded on SampleCache's thread
+	//! pool. Until they are, the buffer holds a single silent frame.
+	void setBackgroundDecodingAllowed(bool allowed)
+	{
+		m_backgroundDecodingAllowed = allowed;
+	}
+
+	bool isDecodingInBackground() const
+	{
+		return m_backgroundDecoding;
+	}
+
+	//! Lets 8 to 24 bit files be kept at their bit depth and channel count,
+	//! see CompactSamples. Such buffers still play, draw and save as any
+	//! other, but have no data() and can't serve as an oscillator's wave.
+	void setCompactStorageAllowed(bool allowed)
+	{
+		m_compactStorageAllowed = allowed;
+	}
+
+	bool isCompact() const
+	{
+		return m_compact != nullptr;
+	}
+
+	//! The memory the frames take, whether they're this buffer's own or
+	//! shared with others through the SampleCache
+	size_t bytes() const;
+
+	//! The frames shared through the SampleCache, nullptr if they're this
+	//! buffer's own
+	const SampleData * sharedData() const
+	{
+		return m_sharedData;
+	}
+
+	//! Blocks until the file is decoded, if it is decoded in the background
+	//! or resampled after the engine's sample rate changed
+	void waitForDecoding();
+	//! Blocks until all files decoded or resampled in the background are,
+	//! e.g. for exporting
+	static void waitForAllDecoding();
+
+	//! Decodes @p audioFile on SampleCache's thread pool and keeps it cached
+	//! for a while, so that a buffer loading it soon finds it decoded
+	static void prefetch(const QString & audioFile);
+
 	QString openAudioFile() const;
 	QString openAndSetAudioFile();
 	QString openAndSetWaveformFile();
 
 	QString & toBase64(QString & dst) const;
+	//! The frames FLAC encoded if possible, for embedding them in a
+	//! project with DataFile::embed()
+	QByteArray toData() const;
 
 
 	// protect calls from the GUI to this function with dataReadLock() and
@@ -249,6 +330,11 @@ public:
 
 	void normalizeSampleRate(const sample_rate_t srcSR, bool keepSettings = false);
 
+	//! Returns @p frames frames of @p data converted to @p dstSR, allocated
+	//! with MM_ALLOC
+	static sampleFrame * resampleFrames(const sampleFrame * data, const f_cnt_t frames,
+		const sample_rate_t srcSR, const sample_rate_t dstSR, f_cnt_t & dstFrames);
+
 	// protect calls from the GUI to this function with dataReadLock() and
 	// dataUnlock(), out of loops for efficiency
 	inline sample_t userWaveSample(const float sample) const
@@ -274,23 +360,65 @@ public:
 		m_varLock.unlock();
 	}
 
-
-	std::unique_ptr<OscillatorConstants::waveform_t> m_userAntiAliasWaveTable;
+	//! The band-limited tables of the frames as an oscillator's wave, or
+	//! nullptr while they're generated in the background
+	const OscillatorConstants::waveform_t * userAntiAliasWaveTable() const
+	{
+		return m_userAntiAliasWaveTable.load(std::memory_order_acquire);
+	}
 
 
 public slots:
 	void setAudioFile(const QString & audioFile);
 	void loadFromBase64(const QString & data);
+	//! Loads what toData() returned
+	void loadFromData(const QByteArray & data);
 	void setStartFrame(const f_cnt_t s);
 	void setEndFrame(const f_cnt_t e);
 	void setAmplification(float a);
 	void setReversed(bool on);
 	void sampleRateChanged();
 
+private slots:
+	void backgroundDecodingFinished();
+	void userWaveTableFinished();
+
 private:
+	//! Doesn't connect to any signals nor load anything
+	struct Unconnected {};
+	explicit SampleBuffer(Unconnected);
+
 	static sample_rate_t audioEngineSampleRate();
 
 	void update(bool keepSettings = false);
+	//! The file at the engine's sample rate
+	SampleCache::Key fileKey() const;
+	//! Whether setCompactStorageAllowed() and the user allow compact frames
+	bool compactStorage() const;
+
+	//! Frees m_data or m_compact, or drops the reference if it's shared
+	void releaseData();
+	//! Gives this buffer its own copy of shared data before modifying it
+	void detachData();
+	//! Shared with the buffers sharing m_data, built on first use
+	const WaveformOverview & overview();
+	//! Replaces m_data by m_compact, if the file allows it
+	void compactData();
+	//! m_data, or m_compact converted into @p storage
+	const sampleFrame * floatFrames(std::vector<sampleFrame> & storage) const;
+	//! Copies @p count frames from @p index on, or backwards from it, from
+	//! m_data or m_compact into @p dst
+	void copyFrames(sampleFrame * dst, f_cnt_t index, f_cnt_t count) const;
+	void copyFramesBackwards(sampleFrame * dst, f_cnt_t index, f_cnt_t count) const;
+
+	//! Decodes @p file into m_data, without resampling
+	f_cnt_t decode(const QString & file, sample_rate_t & samplerate, bool & fileLoadError);
+	//! Decodes the file of @p key at its sample rate, on any thread
+	static SampleData * decodeFile(const SampleCache::Key & key);
+	void stopBackgroundDecoding();
+	//! Generates the wave tables of the current frames on a thread pool
+	void generateUserWaveTable();
+	void stopUserWaveTable();
 
 	void convertIntToFloat(int_sample_t * & ibuf, f_cnt_t frames, int channels);
 	void directFloatWrite(sample_t * & fbuf, f_cnt_t frames, int channels);
@@ -309,9 +437,10 @@ private:
 		sample_rate_t & samplerate
 	);
 #endif
+	//! Renders a DrumSynth patch, or takes the render of an identical one
 	f_cnt_t decodeSampleDS(
 		QString fileName,
-		int_sample_t * & buf,
+		sample_t * & buf,
 		ch_cnt_t & channels,
 		sample_rate_t & samplerate
 	);
@@ -320,6 +449,12 @@ private:
 	sampleFrame * m_origData;
 	f_cnt_t m_origFrames;
 	sampleFrame * m_data;
+	// replaces m_data if the buffer is compact
+	CompactSamples * m_compact;
+	// set if m_data or m_compact belongs to the SampleCache
+	SampleData * m_sharedData;
+	// of the frames unless they're shared, reset whenever they change
+	std::unique_ptr<WaveformOverview> m_overview;
 	mutable QReadWriteLock m_varLock;
 	f_cnt_t m_frames;
 	f_cnt_t m_startFrame;
@@ -330,6 +465,29 @@ private:
 	bool m_reversed;
 	float m_frequency;
 	sample_rate_t m_sampleRate;
+	bool m_streamingAllowed;
+	std::unique_ptr<SampleStream> m_stream;
+	bool m_backgroundDecodingAllowed;
+	bool m_backgroundDecoding;
+	// the frames play at their old rate until those at the engine's are
+	// decoded in the background
+	bool m_resampling;
+	bool m_compactStorageAllowed;
+	// of the file decoded last, 0 bits if it holds floats
+	int m_sourceBits;
+	ch_cnt_t m_sourceChannels;
+
+	// buffers decoding or resampling on SampleCache's thread pool, only used
+	// by the GUI thread
+	static std::vector<SampleBuffer *> s_backgroundDecoding;
+
+	// owned, dropped while the audio engine is held when the frames change
+	std::atomic<OscillatorConstants::waveform_t *> m_userAntiAliasWaveTable;
+	struct UserWaveTableRequest;
+	friend class UserWaveTableJob;
+	std::shared_ptr<UserWaveTableRequest> m_userWaveTableRequest;
+	// buffers whose tables are generated, only used by the GUI thread
+	static std::vector<SampleBuffer *> s_userWaveTables;
 
 	sampleFrame * getSampleFragment(
 		f_cnt_t index,
@@ -0,0 +1,182 @@
+/*
+ * SampleCache.h - shares decoded samples between all buffers loading them
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef SAMPLE_CACHE_H
+#define SAMPLE_CACHE_H
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+#include "shared_object.h"
+
+class CompactSamples;
+class WaveformOverview;
+
+
+//! Decoded frames of a file, owned by all SampleBuffers using them.
+//! Never modified - a buffer which edits its frames copies them first.
+class LMMS_EXPORT SampleData : public QObject, public sharedObject
+{
+public:
+	//! Takes over @p frames, which must be allocated with MM_ALLOC
+	SampleData( sampleFrame * frames, f_cnt_t count );
+	//! Takes over @p compact
+	explicit SampleData( CompactSamples * compact );
+	~SampleData() override;
+
+	//! nullptr if the frames are compact()
+	sampleFrame * frames() const
+	{
+		return m_frames;
+	}
+
+	CompactSamples * compact() const
+	{
+		return m_compact.get();
+	}
+
+	f_cnt_t count() const
+	{
+		return m_count;
+	}
+
+	size_t bytes() const;
+
+	//! Built on first use. Once the data is shared, only call this from
+	//! the GUI thread.
+	const WaveformOverview & overview();
+
+private:
+	sampleFrame * m_frames;
+	std::unique_ptr<CompactSamples> m_compact;
+	const f_cnt_t m_count;
+	std::unique_ptr<WaveformOverview> m_overview;
+} ;
+
+
+
+
+//! Keeps the decoded frames of every file in use once, so that instruments
+//! and clips loading the same sample share them. Entries are dropped as
+//! soon as no buffer uses them anymore, except those decoded at another
+//! sample rate than the engine's and those prefetched: a few hundred
+//! megabytes of them are kept, so that switching back to that rate or
+//! loading the prefetched file doesn't decode again.
+//! Files can also be decoded on a thread pool, several at once.
+class LMMS_EXPORT SampleCache : public QObject
+{
+	Q_OBJECT
+public:
+	struct Key
+	{
+		QString path;
+		qint64 modified = 0;
+		sample_rate_t sampleRate = 0;
+		//! Whether the frames may be kept as CompactSamples
+		bool compact = false;
+
+		bool isValid() const
+		{
+			return !path.isEmpty();
+		}
+
+		bool operator==( const Key & other ) const
+		{
+			return path == other.path && modified == other.modified &&
+				sampleRate == other.sampleRate && compact == other.compact;
+		}
+	} ;
+
+	//! The key for @p file decoded at @p sampleRate, invalid if the
+	//! file doesn't exist
+	static Key keyOf( const QString & file, sample_rate_t sampleRate, bool compact = false );
+
+	//! Returns the cached data, referenced for the caller, or nullptr
+	static SampleData * find( const Key & key );
+
+	//! Takes over @p frames, which must be allocated with MM_ALLOC, and
+	//! returns them shared and referenced for the caller. If another buffer
+	//! cached the file meanwhile, its data is returned instead.
+	static SampleData * insert( const Key & key, sampleFrame * frames, f_cnt_t count );
+	//! Same for frames kept compact, takes over @p compact
+	static SampleData * insert( const Key & key, CompactSamples * compact );
+
+	//! Drops a reference taken by find(), insert() or sharedObject::ref()
+	static void release( SampleData * data );
+
+	//! Decodes the file of @p key at its sample rate, or returns nullptr
+	//! if it can't be decoded
+	using DecodeFunction = SampleData * (*)( const Key & key );
+
+	//! Caches the file of @p key decoded by @p decode on the thread pool,
+	//! unless it is cached or decoding already. Emits decodingFinished()
+	//! when done. With @p prefetch, it's kept even if no buffer takes it.
+	static void decodeInBackground( const Key & key, DecodeFunction decode, bool prefetch = false );
+	static bool isDecoding( const Key & key );
+	//! Blocks until @p key, or every file if it's invalid, is decoded
+	static void waitForDecoding( const Key & key = Key() );
+
+	static int files();
+	static size_t bytes();
+	//! What the buffers sharing data would need on top of bytes() otherwise
+	static size_t bytesSaved();
+
+	struct Entry
+	{
+		Key key;
+		size_t bytes;
+		//! The buffers using the frames, 0 if they're only kept for later
+		int users;
+	} ;
+	//! Every file cached, for reporting memory use
+	static std::vector<Entry> entries();
+	//! Drops the unused entries kept at other rates and prefetched, returns
+	//! the bytes freed
+	static size_t dropRetained();
+
+	//! For connecting to decodingFinished()
+	static SampleCache * inst();
+
+signals:
+	//! Emitted in the GUI thread after a file decoded in the background,
+	//! whether that succeeded or not
+	void decodingFinished();
+
+private slots:
+	//! Drops what was decoded in the background but isn't used
+	void dropUnused();
+
+private:
+	SampleCache() = default;
+
+	friend class SampleDecodeJob;
+} ;
+
+
+#endif
@@ -28,6 +28,8 @@
 #include "SampleBuffer.h"
 #include "SampleTrack.h"
 #include "Clip.h"
+
+class SamplePlayHandle;
  
 
 class SampleClip : public Clip
@@ -65,6 +67,14 @@ public:
 	bool isPlaying() const;
 	void setIsPlaying(bool isPlaying);
 
+	//! The handle playing the clip, created on demand and reused whenever
+	//! the clip starts again, after loops and seeks too. Only for the
+	//! thread playing the track.
+	SamplePlayHandle * voice();
+	//! Takes the voice out of the audio engine and deletes it - call it
+	//! while the model is locked
+	void releaseVoice();
+
 public slots:
 	void setSampleBuffer( SampleBuffer* sb );
 	void setSampleFile( const QString & _sf );
@@ -72,12 +82,14 @@ public slots:
 	void toggleRecord();
 	void playbackPositionChanged();
 	void updateTrackClips();
+	void updateStreamPosition();
 
 
 private:
 	SampleBuffer* m_sampleBuffer;
 	BoolModel m_recordModel;
 	bool m_isPlaying;
+	SamplePlayHandle * m_voice;
 
 	friend class SampleClipView;
 
@@ -56,7 +56,6 @@ protected:
 
 private:
 	SampleClip * m_clip;
-	QPixmap m_paintPixmap;
 	bool splitClip( const TimePos pos ) override;
 } ;
 
@@ -44,9 +44,11 @@ public:
 	SamplePlayHandle( SampleClip* clip );
 	virtual ~SamplePlayHandle();
 
+	// recycled handles are deleted by their owners, so the audio engine
+	// may drop them from its list in any thread
 	inline bool affinityMatters() const override
 	{
-		return true;
+		return !isRecycled();
 	}
 
 
@@ -56,6 +58,10 @@ public:
 	bool isFromTrack( const Track * _track ) const override;
 
 	f_cnt_t totalFrames() const;
+
+	//! Start playing from the beginning again
+	void rewind();
+
 	inline f_cnt_t framesDone() const
 	{
 		return( m_frame );
@@ -26,6 +26,8 @@
 #ifndef SAMPLE_RECORD_HANDLE_H
 #define SAMPLE_RECORD_HANDLE_H
 
+#include <memory>
+
 #include <QtCore/QList>
 #include <QtCore/QPair>
 
@@ -35,9 +37,14 @@
 class BBTrack;
 class SampleBuffer;
 class SampleClip;
+class SampleRecordWriter;
 class Track;
 
 
+//! Records the audio engine's input into a SampleClip. Unless disabled in
+//! the settings, the frames are written to a file in the user's
+//! recordings folder while recording, which the clip then plays like any
+//! other sample. Otherwise they are collected in memory.
 class SampleRecordHandle : public PlayHandle
 {
 public:
@@ -59,7 +66,11 @@ private:
 
 	typedef QList<QPair<sampleFrame *, f_cnt_t> > bufferList;
 	bufferList m_buffers;
+	// set if recording to a file rather than into m_buffers
+	std::unique_ptr<SampleRecordWriter> m_writer;
 	f_cnt_t m_framesRecorded;
+	// frames still to be dropped from the start, -1 until known
+	f_cnt_t m_latency;
 	TimePos m_minLength;
 
 	Track * m_track;
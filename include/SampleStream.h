@@ -0,0 +1,130 @@
+/*
+ * SampleStream.h - plays long samples from disk instead of from memory
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef SAMPLE_STREAM_H
+#define SAMPLE_STREAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <samplerate.h>
+#include <sndfile.h>
+
+#include "lmms_basics.h"
+#include "MemoryManager.h"
+
+class QFile;
+class QString;
+class SampleStreamThread;
+
+
+//! Decodes a sample file while it plays. A shared I/O thread reads ahead of
+//! the play position, resamples to the engine's rate and queues the frames in
+//! a ring buffer of a few seconds, which the audio thread reads without
+//! locking. Reading elsewhere than where the queue continues is a seek: the
+//! I/O thread restarts decoding there and the gap is played as silence.
+//! While the song isn't playing through the clip, the stream is cued to
+//! where playback will enter it, so starting the song or reaching the clip
+//! doesn't have to wait for the disk.
+class SampleStream
+{
+	MM_OPERATORS
+public:
+	//! Returns nullptr if @p file is too short to be worth streaming or
+	//! libsndfile can't seek in it
+	static std::unique_ptr<SampleStream> open(const QString & file);
+
+	~SampleStream();
+
+	//! Length at the engine's sample rate
+	f_cnt_t frames() const
+	{
+		return m_frames;
+	}
+
+	//! Audio thread. Copies @p frames frames starting at @p frame into @p dst.
+	//! What hasn't been decoded yet is filled with silence, except while
+	//! exporting, where this waits for the I/O thread.
+	void read(sampleFrame * dst, f_cnt_t frame, fpp_t frames);
+
+	//! Where the clip playing this stream lies in the song, in ticks
+	void setClipPosition(tick_t start, tick_t end, tick_t offset);
+
+private:
+	SampleStream(std::unique_ptr<QFile> file, SNDFILE * sndFile, const SF_INFO & info);
+
+	f_cnt_t tryRead(sampleFrame * dst, f_cnt_t frame, fpp_t frames);
+	void requestSeek(f_cnt_t frame);
+
+	// I/O thread
+	void cue();
+	bool service();
+	void seek(f_cnt_t frame);
+	f_cnt_t decode(sampleFrame * dst, f_cnt_t frames);
+	f_cnt_t readFile(sampleFrame * dst, f_cnt_t frames);
+
+	void registerStream();
+	void unregisterStream();
+
+	std::unique_ptr<QFile> m_file;
+	SNDFILE * m_sndFile;
+	const int m_channels;
+	const sample_rate_t m_fileRate;
+	const sample_rate_t m_engineRate;
+	const f_cnt_t m_frames;
+
+	// the queue, indices grow monotonically
+	std::vector<sampleFrame> m_ring;
+	const int64_t m_ringMask;
+	std::atomic<int64_t> m_readIndex;
+	std::atomic<int64_t> m_writeIndex;
+
+	// seek requests are a generation in the upper and a frame in the lower
+	// 32 bits. Once the I/O thread serves one, the frames queued from
+	// m_startIndex on continue at the requested frame.
+	std::atomic<uint64_t> m_request;
+	std::atomic<uint64_t> m_served;
+	std::atomic<int64_t> m_startIndex;
+	std::atomic<bool> m_endOfFile;
+
+	// decoder state, only touched by the I/O thread
+	SRC_STATE * m_resampler;
+	std::vector<float> m_fileBuffer;
+	std::vector<sampleFrame> m_input;
+	f_cnt_t m_inputFrames;
+	bool m_endOfInput;
+	std::vector<sampleFrame> m_output;
+	f_cnt_t m_decodeFrame;
+
+	std::atomic<tick_t> m_clipStart;
+	std::atomic<tick_t> m_clipEnd;
+	std::atomic<tick_t> m_clipOffset;
+
+	friend class SampleStreamThread;
+} ;
+
+
+#endif
@@ -33,6 +33,7 @@
 #include "SampleClip.h"
 #include "SampleTrackView.h"
 #include "Track.h"
+#include "TrackFreeze.h"
 
 
 class SampleTrack : public Track
@@ -47,11 +48,26 @@ public:
 	TrackView * createView( TrackContainerView* tcv ) override;
 	Clip* createClip(const TimePos & pos) override;
 
+	TrackFreeze * trackFreeze() override
+	{
+		return &m_freeze;
+	}
+
 
 	virtual void saveTrackSpecificSettings( QDomDocument & _doc,
 							QDomElement & _parent ) override;
 	void loadTrackSpecificSettings( const QDomElement & _this ) override;
 
+	inline FloatModel * volumeModel()
+	{
+		return &m_volumeModel;
+	}
+
+	inline FloatModel * panningModel()
+	{
+		return &m_panningModel;
+	}
+
 	inline IntModel * mixerChannelModel()
 	{
 		return &m_mixerChannelModel;
@@ -91,6 +107,7 @@ private:
 	FloatModel m_panningModel;
 	IntModel m_mixerChannelModel;
 	AudioPort m_audioPort;
+	TrackFreeze m_freeze;
 	bool m_isPlaying;
 
 
@@ -90,7 +90,10 @@ private slots:
 	void toggleRunningAutoSave(bool enabled);
 	void toggleSmoothScroll(bool enabled);
 	void toggleAnimateAFP(bool enabled);
+	void setFrameRate(int value);
 	void toggleSyncVSTPlugins(bool enabled);
+	void togglePipelineRemotePlugins(bool enabled);
+	void toggleShareRemoteProcesses(bool enabled);
 	void vstEmbedMethodChanged();
 	void toggleVSTAlwaysOnTop(bool en);
 	void toggleDisableAutoQuit(bool enabled);
@@ -100,6 +103,11 @@ private slots:
 	void toggleHQAudioDev(bool enabled);
 	void setBufferSize(int value);
 	void resetBufferSize();
+	void toggleLatencyGovernor(bool enabled);
+	void toggleAdaptiveVoiceLimit(bool enabled);
+	void setWorkerSpinTime(int value);
+	void toggleWorkerAffinity(bool enabled);
+	void toggleWorkerRealtime(bool enabled);
 
 	// MIDI settings widget.
 	void midiInterfaceChanged(const QString & driver);
@@ -154,12 +162,17 @@ private:
 	LedCheckBox * m_runningAutoSave;
 	bool m_smoothScroll;
 	bool m_animateAFP;
+	int m_frameRate;
+	QSlider * m_frameRateSlider;
+	QLabel * m_frameRateLbl;
 	QLabel * m_vstEmbedLbl;
 	QComboBox* m_vstEmbedComboBox;
 	QString m_vstEmbedMethod;
 	LedCheckBox * m_vstAlwaysOnTopCheckBox;
 	bool m_vstAlwaysOnTop;
 	bool m_syncVSTPlugins;
+	bool m_pipelineRemotePlugins;
+	bool m_shareRemoteProcesses;
 	bool m_disableAutoQuit;
 
 
@@ -173,9 +186,21 @@ private:
 	trMap m_audioIfaceNames;
 	bool m_NaNHandler;
 	bool m_hqAudioDev;
+	QComboBox * m_panLawComboBox;
+	QComboBox * m_lfoIntervalComboBox;
+	QComboBox * m_filterIntervalComboBox;
+	QComboBox * m_automationIntervalComboBox;
+	QComboBox * m_voiceLimitComboBox;
+	bool m_adaptiveVoiceLimit;
 	int m_bufferSize;
 	QSlider * m_bufferSizeSlider;
 	QLabel * m_bufferSizeLbl;
+	bool m_latencyGovernor;
+	int m_workerSpinTime;
+	QSlider * m_workerSpinTimeSlider;
+	QLabel * m_workerSpinTimeLbl;
+	bool m_workerAffinity;
+	bool m_workerRealtime;
 
 	// MIDI settings widgets.
 	QComboBox * m_midiInterfaces;
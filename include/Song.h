@@ -25,11 +25,14 @@
 #ifndef SONG_H
 #define SONG_H
 
+#include <atomic>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include <QtCore/QSharedMemory>
 #include <QtCore/QVector>
+#include <QDateTime>
 #include <QHash>
 #include <QString>
 
@@ -40,10 +43,12 @@
 #include "lmms_constants.h"
 #include "MeterModel.h"
 #include "Scale.h"
+#include "ThreadableJob.h"
 #include "VstSyncController.h"
 
 
 class AutomationTrack;
+class DataFile;
 class MidiClip;
 class TimeLineWidget;
 
@@ -214,6 +219,11 @@ public:
 		return m_exporting;
 	}
 
+	//! Makes sure playTracks() can spread @p tracks tracks over jobs
+	//! without allocating. Called by TrackContainer::addTrack(), not from
+	//! the audio thread.
+	void reserveTrackPlayJobs( int tracks );
+
 	inline void setExportLoop( bool exportLoop )
 	{
 		m_exportLoop = exportLoop;
@@ -246,6 +256,11 @@ public:
 		m_renderBetweenMarkers = renderBetweenMarkers;
 	}
 
+	//! While exporting, only @p track and the automation get played, without
+	//! touching the mute models of the other tracks, see TrackFreeze.
+	//! nullptr plays all tracks again.
+	void setExportTrack( Track * track );
+
 	inline PlayModes playMode() const
 	{
 		return m_playMode;
@@ -278,21 +293,32 @@ public:
 	bpm_t getTempo();
 	AutomationClip * tempoAutomationClip() override;
 
+	//! Changes with every change of the tempo, so that whatever depends on
+	//! it can catch up when it's used next instead of when the tempo
+	//! changes, see NotePlayHandle::startPlaying(). Any thread.
+	int tempoEpoch() const
+	{
+		return m_tempoEpoch.load( std::memory_order_acquire );
+	}
+
 	AutomationTrack * globalAutomationTrack()
 	{
 		return m_globalAutomationTrack;
 	}
 
-	//TODO: Add Q_DECL_OVERRIDE when Qt4 is dropped
-	AutomatedValueMap automatedValuesAt(TimePos time, int clipNum = -1) const override;
 
 	// file management
 	void createNewProject();
 	void createNewProjectFromTemplate( const QString & templ );
 	void loadProject( const QString & filename );
+	//! Like loadProject(), from the contents of a project file, which
+	//! needn't be on disk. Relative paths are resolved against @p fileName.
+	void loadProjectData( const QByteArray & data, const QString & fileName );
 	bool guiSaveProject();
 	bool guiSaveProjectAs(const QString & filename);
 	bool saveProjectFile(const QString & filename, bool withResources = false);
+	//! Saves the whole project into @p dataFile, which is of type SongProject
+	void saveProject(DataFile & dataFile);
 
 	const QString & projectFileName() const
 	{
@@ -345,6 +371,11 @@ public:
 		return m_timeSigModel;
 	}
 
+	IntModel & tempoModel()
+	{
+		return m_tempoModel;
+	}
+
 	void exportProjectMidi(QString const & exportFileName) const;
 
 	inline void setLoadOnLaunch(bool value) { m_loadOnLaunch = value; }
@@ -370,6 +401,9 @@ public slots:
 
 	void startExport();
 	void stopExport();
+	//! Rendering doesn't wait for instruments that are instantiated on
+	//! demand, so they have to be there before. Main thread.
+	void instantiateDeferredInstruments();
 
 
 	void setModified();
@@ -379,6 +413,10 @@ public slots:
 	void addBBTrack();
 
 
+protected:
+	TrackList automationSourceTracks() const override;
+
+
 private slots:
 	void insertBar();
 	void removeBar();
@@ -431,15 +469,27 @@ private:
 	void saveKeymapStates(QDomDocument &doc, QDomElement &element);
 	void restoreKeymapStates(const QDomElement &element);
 
+	//! Loads an element of the project's content other than the tracks,
+	//! the global automation and the mixer
+	void loadContentElement(const QDomElement &element);
+
+	//! The work of processNextBuffer(), which may end early
+	void playNextBuffer();
 	void processAutomations(const TrackList& tracks, TimePos timeStart, fpp_t frames);
+	//! Calls Track::play() for all tracks, spread over the worker threads
+	void playTracks(const TrackList& tracks, const TimePos& start, fpp_t frames, f_cnt_t offset, int clipNum);
 
 	void setModified(bool value);
 
 	void setProjectFileName(QString const & projectFileName);
 
+	//! Loads @p document instead of reading @p fileName if it's given
+	void loadProject( const QString & fileName, std::unique_ptr<DataFile> document );
+
 	AutomationTrack * m_globalAutomationTrack;
 
 	IntModel m_tempoModel;
+	std::atomic_int m_tempoEpoch;
 	MeterModel m_timeSigModel;
 	int m_oldTicksPerBar;
 	IntModel m_masterVolumeModel;
@@ -451,6 +501,14 @@ private:
 
 	QString m_fileName;
 	QString m_oldFileName;
+	// templates parsed and upgraded already, by file, which loading
+	// them again only has to clone
+	struct ParsedTemplate
+	{
+		QDateTime modified;
+		std::shared_ptr<DataFile> dataFile;
+	} ;
+	QHash<QString, ParsedTemplate> m_templates;
 	bool m_modified;
 	bool m_loadOnLaunch;
 
@@ -458,6 +516,7 @@ private:
 	volatile bool m_exporting;
 	volatile bool m_exportLoop;
 	volatile bool m_renderBetweenMarkers;
+	TrackList m_exportTracks;
 	volatile bool m_playing;
 	volatile bool m_paused;
 
@@ -493,12 +552,70 @@ private:
 	std::shared_ptr<Scale> m_scales[MaxScaleCount];
 	std::shared_ptr<Keymap> m_keymaps[MaxKeymapCount];
 
-	AutomatedValueMap m_oldAutomatedValues;
+	// values applied in the last tick and in the current one, kept so
+	// processAutomations() can reuse their memory
+	AutomatedValueList m_oldAutomatedValues;
+	AutomatedValueList m_automatedValues;
+	std::vector<const AutomatableModel*> m_recordedModels;
+
+	//! Plays some tracks for the current tick on a worker thread
+	class TrackPlayJob : public ThreadableJob
+	{
+	public:
+		void setTick(const TimePos& start, fpp_t frames, f_cnt_t offset, int clipNum)
+		{
+			m_start = start;
+			m_frames = frames;
+			m_offset = offset;
+			m_clipNum = clipNum;
+			m_tracks.clear();
+		}
+
+		void addTrack(Track* track)
+		{
+			m_tracks.push_back(track);
+		}
+
+		void reserve(size_t tracks)
+		{
+			m_tracks.reserve(tracks);
+		}
+
+		size_t capacity() const
+		{
+			return m_tracks.capacity();
+		}
+
+		bool requiresProcessing() const override
+		{
+			return !m_tracks.empty();
+		}
+
+	protected:
+		void doProcessing() override
+		{
+			for (Track* track : m_tracks)
+			{
+				track->play(m_start, m_frames, m_offset, m_clipNum);
+			}
+		}
+
+	private:
+		std::vector<Track*> m_tracks;
+		TimePos m_start;
+		fpp_t m_frames = 0;
+		f_cnt_t m_offset = 0;
+		int m_clipNum = -1;
+	} ;
+	// reused every tick, the first one plays all BB tracks; only grown by
+	// reserveTrackPlayJobs()
+	std::vector<std::unique_ptr<TrackPlayJob>> m_trackPlayJobs;
 
 	friend class LmmsCore;
 	friend class SongEditor;
 	friend class mainWindow;
 	friend class ControllerRackView;
+	friend class ExportCache;
 
 signals:
 	void projectLoaded();
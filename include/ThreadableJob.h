@@ -27,8 +27,12 @@
 
 #include "lmms_basics.h"
 
+#include <QtCore/QString>
+
 #include <atomic>
 
+class LoadMeter;
+
 class ThreadableJob
 {
 public:
@@ -78,6 +82,45 @@ public:
 
 	virtual bool requiresProcessing() const = 0;
 
+	//! What jobName() is made of, so that the profiler can take it on the
+	//! audio thread without formatting anything - copying the QString only
+	//! takes a reference
+	struct Label
+	{
+		const char * kind;
+		QString name;
+	} ;
+
+	virtual Label jobLabel() const
+	{
+		return { nullptr, QString() };
+	}
+
+	//! Name shown in job traces, see AudioEngineProfiler
+	QString jobName() const
+	{
+		return labelName( jobLabel() );
+	}
+
+	static QString labelName( const Label & label )
+	{
+		return label.kind ? QString( "%1: %2" ).arg( label.kind, label.name ) : QString();
+	}
+
+	//! Where the processing time gets accounted, if the profiler measures
+	//! the load of tracks and mixer channels
+	virtual LoadMeter * loadMeter()
+	{
+		return nullptr;
+	}
+
+	//! The peak of what the job rendered in this period, for the denormal
+	//! watch of the profiler, or -1 if it has no buffer of its own
+	virtual float outputPeak() const
+	{
+		return -1.0f;
+	}
+
 
 protected:
 	virtual void doProcessing() = 0;
@@ -29,6 +29,10 @@
 #include <QtCore/QVector>
 #include <QColor>
 
+#include <atomic>
+#include <utility>
+#include <vector>
+
 #include "AutomatableModel.h"
 #include "JournallingObject.h"
 #include "lmms_basics.h"
@@ -37,6 +41,7 @@
 class TimePos;
 class TrackContainer;
 class TrackContainerView;
+class TrackFreeze;
 class Clip;
 class TrackView;
 
@@ -96,6 +101,13 @@ public:
 	virtual TrackView * createView( TrackContainerView * view ) = 0;
 	virtual Clip * createClip( const TimePos & pos ) = 0;
 
+	//! Tracks that can be frozen into a cached rendering return their
+	//! freeze state here
+	virtual TrackFreeze * trackFreeze()
+	{
+		return nullptr;
+	}
+
 	virtual void saveTrackSpecificSettings( QDomDocument & doc,
 						QDomElement & parent ) = 0;
 	virtual void loadTrackSpecificSettings( const QDomElement & element ) = 0;
@@ -125,6 +137,22 @@ public:
 	}
 	void getClipsInRange( clipVector & clipV, const TimePos & start,
 							const TimePos & end );
+
+	//! Calls @p func for every clip intersecting [start, end], earliest
+	//! clips first, without copying them into a clipVector
+	template<typename Func>
+	void forEachClipInRange( const TimePos & start, const TimePos & end, Func func )
+	{
+		const int startTicks = start;
+		const auto range = clipIndexRange( startTicks, end );
+		for( auto it = range.first; it != range.second; ++it )
+		{
+			if( it->end >= startTicks )
+			{
+				func( it->clip );
+			}
+		}
+	}
 	void swapPositionOfClips( int clipNum1, int clipNum2 );
 
 	void createClipsForBB( int bb );
@@ -193,6 +221,7 @@ public:
 	}
 	
 	BoolModel* getMutedModel();
+	BoolModel* getSoloModel();
 
 public slots:
 	virtual void setName( const QString & newName )
@@ -211,7 +240,23 @@ public slots:
 	void setColor(const QColor& c);
 	void resetColor();
 
+private slots:
+	void invalidateClipIndex();
+
 private:
+	//! Position of a clip as it was when the index was built
+	struct ClipIndexEntry
+	{
+		int start;
+		int end;
+		//! Latest end of this and all earlier clips
+		int maxEnd;
+		Clip * clip;
+	} ;
+
+	void updateClipIndex();
+	std::pair<const ClipIndexEntry *, const ClipIndexEntry *> clipIndexRange( int start, int end );
+
 	TrackContainer* m_trackContainer;
 	TrackTypes m_type;
 	QString m_name;
@@ -228,6 +273,11 @@ private:
 
 	clipVector m_clips;
 
+	// m_clips sorted by start position, rebuilt on the next lookup after a
+	// clip was added, removed, moved or resized
+	std::vector<ClipIndexEntry> m_clipIndex;
+	std::atomic<bool> m_clipIndexChanged;
+
 	QMutex m_processingLock;
 	
 	QColor m_color;
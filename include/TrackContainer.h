@@ -28,11 +28,16 @@
 
 #include <QtCore/QReadWriteLock>
 
+#include <atomic>
+#include <functional>
+#include <vector>
+
 #include "Track.h"
 #include "JournallingObject.h"
 
 
 class AutomationClip;
+class DataFileStream;
 class InstrumentTrack;
 class TrackContainerView;
 
@@ -42,6 +47,8 @@ class LMMS_EXPORT TrackContainer : public Model, public JournallingObject
 	Q_OBJECT
 public:
 	typedef QVector<Track *> TrackList;
+	//! Saves @p track into @p parent in place of Track::saveState()
+	using TrackSaver = std::function<void(Track * track, QDomDocument & doc, QDomElement & parent)>;
 	enum TrackContainerTypes
 	{
 		BBContainer,
@@ -54,6 +61,16 @@ public:
 	void saveSettings( QDomDocument & _doc, QDomElement & _parent ) override;
 
 	void loadSettings( const QDomElement & _this ) override;
+	//! Loads the tracks of the trackcontainer element @p stream is at
+	//! one by one, without the DOM of the others
+	void loadTracks( DataFileStream & stream );
+
+	//! Lets saveSettings() save the tracks some other way, e.g. from
+	//! what was saved of them before, until it's reset
+	void setTrackSaver( TrackSaver saver )
+	{
+		m_trackSaver = saver;
+	}
 
 
 	virtual AutomationClip * tempoAutomationClip()
@@ -93,21 +110,64 @@ public:
 		return m_TrackContainerType;
 	}
 
-	virtual AutomatedValueMap automatedValuesAt(TimePos time, int clipNum = -1) const;
+	AutomatedValueMap automatedValuesAt(TimePos time, int clipNum = -1) const;
+
+	//! Like automatedValuesAt(), but merges the values into @p values, so
+	//! playback can reuse the same vector every tick
+	virtual void collectAutomatedValues(TimePos time, int clipNum, AutomatedValueList & values) const;
+
+	//! Calls @p func for each clip of the automation and BB tracks that
+	//! starts at or before @p time, earliest clips first
+	template<typename Func>
+	void forEachStartedClip(TimePos time, Func func) const
+	{
+		updateAutomationIndex();
+		for (auto it = m_automationClips.begin(), end = startedClipsEnd(time); it != end; ++it)
+		{
+			func(*it);
+		}
+	}
+
+public slots:
+	//! Called whenever a track or a clip is added, removed or moved
+	void invalidateAutomationIndex();
 
 signals:
 	void trackAdded( Track * _track );
 
 protected:
-	static AutomatedValueMap automatedValuesFromTracks(const TrackList &tracks, TimePos timeStart, int clipNum = -1);
+	//! The tracks which can contain automation, the song adds its global
+	//! automation track
+	virtual TrackList automationSourceTracks() const
+	{
+		return tracks();
+	}
 
 	mutable QReadWriteLock m_tracksMutex;
 
 private:
+	//! Returns whether the dialog was created, and has to be hidden
+	bool showLoadingProgress();
+	void hideLoadingProgress( bool created );
+	//! Returns false if loading was cancelled
+	bool loadTrack( const QDomElement & element );
+
+	void updateAutomationIndex() const;
+	std::vector<Clip *>::const_iterator startedClipsEnd(TimePos time) const;
+	void collectClipValues(Clip * clip, TimePos time, AutomatedValueList & values) const;
+
 	TrackList m_tracks;
 
+	// Automation and BB tracks and all their clips sorted by position,
+	// rebuilt on the next playback tick after they changed
+	mutable std::vector<Track *> m_automationTracks;
+	mutable std::vector<Clip *> m_automationClips;
+	mutable std::atomic<bool> m_automationIndexChanged;
+
 	TrackContainerTypes m_TrackContainerType;
 
+	TrackSaver m_trackSaver;
+
 
 	friend class TrackContainerView;
 	friend class Track;
@@ -26,6 +26,8 @@
 #ifndef TRACK_CONTAINER_VIEW_H
 #define TRACK_CONTAINER_VIEW_H
 
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
 #include <QtCore/QVector>
 #include <QScrollArea>
 #include <QWidget>
@@ -142,6 +144,13 @@ public slots:
 	void stopRubberBand();
 
 
+private slots:
+	//! Builds the views of the tracks added in batches, between which the
+	//! GUI stays responsive, e.g. while a large project opens
+	void queueTrackView( Track * _t );
+	void createQueuedTrackViews();
+
+
 protected:
 	static const int DEFAULT_PIXELS_PER_BAR = 16;
 
@@ -175,6 +184,9 @@ private:
 	TrackContainer* m_tc;
 	typedef QList<TrackView *> trackViewList;
 	trackViewList m_trackViews;
+	// tracks added whose views aren't built yet, in their order
+	QList<QPointer<Track>> m_queuedTracks;
+	QTimer m_trackViewTimer;
 
 	scrollArea * m_scrollArea;
 	QVBoxLayout * m_scrollLayout;
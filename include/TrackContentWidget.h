@@ -87,6 +87,7 @@ public:
 public slots:
 	void update();
 	void changePosition( const TimePos & newPos = TimePos( -1 ) );
+	void changePosition( ClipView * clipv );
 
 protected:
 	enum ContextMenuAction
@@ -123,6 +124,7 @@ protected:
 private:
 	Track * getTrack();
 	TimePos getPosition( int mouseX );
+	void placeClipView( ClipView * clipv, int begin, int end, float ppb );
 
 	TrackView * m_trackView;
 
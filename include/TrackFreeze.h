@@ -0,0 +1,131 @@
+/*
+ * TrackFreeze.h - renders a track into a cache that plays instead of it
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef TRACK_FREEZE_H
+#define TRACK_FREEZE_H
+
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+
+#include <atomic>
+#include <vector>
+
+#include "lmms_basics.h"
+#include "lmms_export.h"
+
+class AudioPort;
+class AutomationClip;
+class FrozenTrackPlayHandle;
+class Model;
+class SampleBuffer;
+class TimePos;
+class Track;
+
+
+//! Freezing renders the song with only this track audible and records what
+//! comes out of the track's audio port (after volume, panning and effects).
+//! Until the freeze is undone, the track plays that recording instead of
+//! its instrument or samples, and the port skips its own processing.
+//! Editing the track - its clips, its models or its effects - or the tempo
+//! unfreezes it.
+class LMMS_EXPORT TrackFreeze : public QObject
+{
+	Q_OBJECT
+public:
+	TrackFreeze( Track * track, AudioPort * port );
+	virtual ~TrackFreeze();
+
+	bool isFrozen() const
+	{
+		return m_cache != nullptr;
+	}
+
+	//! Starts rendering the song offline in a thread of its own, with the
+	//! audio device stopped. freezeFinished() is emitted when it's done, and
+	//! frozenChanged() as well if it wasn't aborted. Fails for tracks not in
+	//! the song editor, muted tracks, and while exporting or freezing.
+	bool freeze();
+
+	bool isFreezing() const
+	{
+		return m_renderer != nullptr;
+	}
+
+
+	//! Called from Track::play(). Returns true if the track is frozen and
+	//! mustn't play anything itself.
+	bool play( const TimePos & start, f_cnt_t offset, int clipNum );
+
+	//! Models that don't affect the cached output, e.g. the mixer channel
+	void addIgnoredModel( Model * model );
+
+public slots:
+	void unfreeze();
+	//! Stops rendering and waits for the render thread
+	void abortFreeze();
+
+signals:
+	void frozenChanged();
+	//! In percent of the song
+	void freezeProgress( int progress );
+	void freezeFinished();
+
+private slots:
+	void modelChanged();
+	void tempoChanged();
+	void renderFinished();
+
+private:
+	class Renderer;
+
+	//! Called by the render thread
+	void render();
+	void watchForChanges();
+
+	Track * m_track;
+	AudioPort * m_port;
+
+	SampleBuffer * m_cache;
+	FrozenTrackPlayHandle * m_playHandle;
+	// the cache frame each tick of the song started at, so that tempo
+	// automation doesn't move the play handle off the ticks
+	std::vector<f_cnt_t> m_tickFrames;
+
+	Renderer * m_renderer;
+	// filled by the port and Track::play() while rendering
+	std::vector<sample_t> m_renderSamples;
+	std::vector<f_cnt_t> m_renderTickFrames;
+	std::atomic_bool m_abortRender;
+
+	// what the tempo was at freeze time
+	bpm_t m_tempo;
+	QVector<AutomationClip *> m_tempoClips;
+
+	QVector<Model *> m_ignoredModels;
+	QVector<QMetaObject::Connection> m_connections;
+
+} ;
+
+
+#endif
@@ -58,6 +58,10 @@ private slots:
 	void recordingOn();
 	void recordingOff();
 	void clearTrack();
+	void freezeTrack();
+	void unfreezeTrack();
+	void togglePatternCache(bool on);
+	void renderPatternCache();
 
 private:
 	TrackView * m_trackView;
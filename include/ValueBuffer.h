@@ -50,4 +50,25 @@ public:
 	void interpolate(float start, float end);
 };
 
+
+//! Values going linearly from start to end over a period, like the ones
+//! interpolate() writes. Automation changes a model once per period, so
+//! that's all its values amount to, without a buffer.
+struct ValueRamp
+{
+	float start;
+	float end;
+
+	bool isConstant() const
+	{
+		return start == end;
+	}
+
+	//! The value @p frame frames into a period of @p frames frames
+	float valueAt(float frame, int frames) const
+	{
+		return start + (end - start) * frame / frames;
+	}
+};
+
 #endif
@@ -0,0 +1,90 @@
+/*
+ * VoiceLimiter.h - stops voices beyond the voice limits
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef VOICE_LIMITER_H
+#define VOICE_LIMITER_H
+
+#include <vector>
+
+#include "PlayHandle.h"
+
+class InstrumentTrack;
+class NotePlayHandle;
+
+
+//! Keeps the number of sounding notes within the voice limit of each
+//! instrument track and the global voice limit, by stealing the voices each
+//! track's VoiceStealing picks. Stolen notes fade out quickly, see
+//! NotePlayHandle::steal(). In adaptive mode the global limit is lowered
+//! while the CPU load is too high, and raised again once it went down.
+//! Audio thread, before the play handles are processed.
+class VoiceLimiter
+{
+public:
+	VoiceLimiter();
+
+	//! @param voices global voice limit, 0 if unlimited
+	void setLimit( int voices );
+	int limit() const
+	{
+		return m_limit;
+	}
+
+	void setAdaptive( bool adaptive );
+	bool isAdaptive() const
+	{
+		return m_adaptive;
+	}
+
+	//! @param cpuLoad the load of the last period in percent
+	void process( const PlayHandleList & playHandles, int cpuLoad );
+
+private:
+	struct Voice
+	{
+		NotePlayHandle * note;
+		const InstrumentTrack * track;
+		// voices with the highest rank and then the highest score are
+		// stolen first
+		int rank;
+		float score;
+	} ;
+
+	void rate( Voice * first, Voice * last );
+	//! Steals all but @p keep of the voices, the best to steal are moved
+	//! to the end; returns the end of the voices kept
+	Voice * steal( Voice * first, Voice * last, int keep );
+	void adapt( int voices, int cpuLoad );
+
+	int m_limit;
+	bool m_adaptive;
+	// the global limit in adaptive mode
+	int m_adaptiveLimit;
+
+	// reserved once, process() only looks at as many voices as fit
+	std::vector<Voice> m_voices;
+} ;
+
+
+#endif
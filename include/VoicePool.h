@@ -0,0 +1,131 @@
+/*
+ * VoicePool.h - storage for the voices of an instrument, allocated in advance
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef VOICE_POOL_H
+#define VOICE_POOL_H
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include <QtGlobal>
+
+#include "MemoryManager.h"
+
+
+//! Storage for the per-note data of an instrument, the NotePlayHandle's
+//! m_pluginData, allocated when the instrument is created. acquire()
+//! constructs a @p T in free storage and release() destroys it and keeps
+//! the storage for the next note, so playing a note doesn't allocate.
+//! Only when more voices play than there was storage for, some is
+//! allocated, and it is kept too once the voice is released, up to the
+//! capacity of the pool. The storage is only freed with the pool.
+//! Whatever the constructor of @p T allocates itself is not covered.
+template<typename T>
+class VoicePool
+{
+public:
+	//! Any storage is kept for at least this many voices
+	static constexpr int DefaultCapacity = 64;
+
+	//! @param prepared voices to allocate storage for now, see
+	//! Instrument::voicePoolSize()
+	explicit VoicePool( int prepared, int capacity = DefaultCapacity ) :
+		m_capacity( qMax( capacity, prepared ) ),
+		m_slots( new std::atomic<void *>[m_capacity] )
+	{
+		for( int i = 0; i < m_capacity; ++i )
+		{
+			m_slots[i].store( i < prepared ? allocate() : nullptr,
+						std::memory_order_relaxed );
+		}
+	}
+
+	~VoicePool()
+	{
+		for( int i = 0; i < m_capacity; ++i )
+		{
+			MemoryManager::free( m_slots[i].load( std::memory_order_relaxed ) );
+		}
+	}
+
+	VoicePool( const VoicePool & ) = delete;
+	VoicePool & operator=( const VoicePool & ) = delete;
+
+	//! Any thread
+	template<typename... Args>
+	T * acquire( Args &&... args )
+	{
+		void * storage = nullptr;
+		for( int i = 0; i < m_capacity && storage == nullptr; ++i )
+		{
+			// cheap test before claiming the slot
+			if( m_slots[i].load( std::memory_order_relaxed ) != nullptr )
+			{
+				storage = m_slots[i].exchange( nullptr, std::memory_order_acquire );
+			}
+		}
+		if( storage == nullptr )
+		{
+			storage = allocate();
+		}
+		return new( storage ) T( std::forward<Args>( args )... );
+	}
+
+	//! Any thread. Destroys @p voice, which acquire() returned, may be nullptr.
+	void release( T * voice )
+	{
+		if( voice == nullptr )
+		{
+			return;
+		}
+		voice->~T();
+		for( int i = 0; i < m_capacity; ++i )
+		{
+			void * empty = nullptr;
+			if( m_slots[i].load( std::memory_order_relaxed ) == nullptr &&
+				m_slots[i].compare_exchange_strong( empty, voice,
+					std::memory_order_release, std::memory_order_relaxed ) )
+			{
+				return;
+			}
+		}
+		// more voices were played at once than the pool holds
+		MemoryManager::free( voice );
+	}
+
+private:
+	static void * allocate()
+	{
+		return MemoryManager::alloc( sizeof( T ) );
+	}
+
+	const int m_capacity;
+	// free storage, empty slots are nullptr
+	std::unique_ptr<std::atomic<void *>[]> m_slots;
+} ;
+
+
+#endif
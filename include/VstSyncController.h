@@ -26,12 +26,16 @@
 #ifndef VST_SYNC_CONTROLLER_H
 #define VST_SYNC_CONTROLLER_H
 
+#include <atomic>
+
 #include <QtCore/QObject>
 #include <QtCore/QSharedMemory>
 
 #include "VstSyncData.h"
 
 
+//! Collects the transport of the song for the VST plugins, which is only
+//! written to the shared memory by publish()
 class VstSyncController : public QObject
 {
 	Q_OBJECT
@@ -43,30 +47,32 @@ public:
 
 	void setPlaybackState( bool enabled )
 	{
-		m_syncData->isPlaying = enabled;
+		change( m_state.isPlaying, enabled );
 	}
 
 	void setTempo( int newTempo );
 
 	void setTimeSignature( int num, int denom )
 	{
-		m_syncData->timeSigNumer = num;
-		m_syncData->timeSigDenom = denom;
+		change( m_state.timeSigNumer, num );
+		change( m_state.timeSigDenom, denom );
 	}
 
 	void startCycle( int startTick, int endTick );
 
 	void stopCycle()
 	{
-		m_syncData->isCycle = false;
+		change( m_state.isCycle, false );
 	}
 
 	void setPlaybackJumped( bool jumped )
 	{
-		m_syncData->m_playbackJumped = jumped;
+		change( m_state.m_playbackJumped, jumped );
 	}
 
-	void update();
+	//! Writes the state to the shared memory if it changed since the last
+	//! time, called once per period by the song
+	void publish();
 
 
 private slots:
@@ -74,7 +80,20 @@ private slots:
 
 
 private:
+	template<class T>
+	void change( T & field, T value )
+	{
+		if( field != value )
+		{
+			field = value;
+			m_changed.store( true, std::memory_order_relaxed );
+		}
+	}
+
 	VstSyncData* m_syncData;
+	// what the next publish() writes
+	VstSyncState m_state;
+	std::atomic<bool> m_changed;
 
 	int m_shmID;
 
@@ -26,6 +26,9 @@
 #ifndef VST_SYNC_DATA_H
 #define VST_SYNC_DATA_H
 
+#include <atomic>
+#include <cstdint>
+
 // VST sync frequency (in ms), how often will be VST plugin synced
 // keep it power of two if possible (not used by now)
 //#define VST_SNC_TIMER 1
@@ -39,14 +42,14 @@ constexpr const char* VST_SNC_SHM_KEY_FILE = "/dev/null";
 
 
 
-struct VstSyncData
+//! The transport of the song, as the VST plugins get it
+struct VstSyncState
 {
 	double ppqPos;
 	int timeSigNumer;
 	int timeSigDenom;
 	bool isPlaying;
 	bool isCycle;
-	bool hasSHM;
 	float cycleStart;
 	float cycleEnd;
 	bool m_playbackJumped;
@@ -59,4 +62,57 @@ struct VstSyncData
 #endif
 } ;
 
+
+
+//! Shared by the host and all RemoteVstPlugins. The host publishes the
+//! state at most once per period, and only if it changed, protected by a
+//! sequence lock: the version is odd while the state is written, so the
+//! readers only copy the state when the version changed and try again if
+//! it changed while they copied.
+struct VstSyncData
+{
+	std::atomic<uint32_t> version;
+	bool hasSHM;
+	VstSyncState state;
+
+	//! Only called by the host
+	void publish( const VstSyncState & newState )
+	{
+		const uint32_t v = version.load( std::memory_order_relaxed );
+		version.store( v + 1, std::memory_order_relaxed );
+		std::atomic_thread_fence( std::memory_order_release );
+		state = newState;
+		version.store( v + 2, std::memory_order_release );
+	}
+
+	//! Copies the state into @p copy unless its version is still
+	//! @p lastVersion, which is updated. Returns whether it copied.
+	bool read( VstSyncState & copy, uint32_t & lastVersion ) const
+	{
+		while( true )
+		{
+			const uint32_t before = version.load( std::memory_order_acquire );
+			if( before & 1 )
+			{
+				// the host is writing, which won't take long
+				continue;
+			}
+			if( before == lastVersion )
+			{
+				return false;
+			}
+			copy = state;
+			std::atomic_thread_fence( std::memory_order_acquire );
+			if( version.load( std::memory_order_relaxed ) == before )
+			{
+				lastVersion = before;
+				return true;
+			}
+		}
+	}
+} ;
+
+//! A version readers start with, as a published one is never odd
+constexpr uint32_t VST_SNC_NO_VERSION = 1;
+
 #endif
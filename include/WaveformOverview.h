@@ -0,0 +1,78 @@
+/*
+ * WaveformOverview.h - precomputed peaks of a sample for drawing it
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef WAVEFORM_OVERVIEW_H
+#define WAVEFORM_OVERVIEW_H
+
+#include <vector>
+
+#include "lmms_basics.h"
+
+class CompactSamples;
+
+
+//! Minimum, maximum and sum of squares of a sample's frames in bins of
+//! 256, 4096 and 65536 frames, so that drawing a sample costs about the
+//! same for any length when zoomed out
+class WaveformOverview
+{
+public:
+	struct Bin
+	{
+		float min;
+		float max;
+		//! Summed over the frames, averaged over the channels
+		float squares;
+	} ;
+
+	struct Level
+	{
+		f_cnt_t binFrames;
+		std::vector<Bin> bins;
+	} ;
+
+	static const f_cnt_t MinBinFrames = 256;
+
+	WaveformOverview(const sampleFrame * data, f_cnt_t frames);
+	explicit WaveformOverview(const CompactSamples & samples);
+
+	//! The coarsest level with bins of at most @p frames frames,
+	//! nullptr if @p frames is less than MinBinFrames
+	const Level * levelFor(double frames) const;
+
+	//! Combines the bins of @p level which overlap frames @p from to @p to
+	//! (inclusive)
+	static Bin combine(const Level & level, f_cnt_t from, f_cnt_t to);
+
+private:
+	//! Appends the finest bins for @p frames frames, a multiple of
+	//! MinBinFrames unless they are the last ones
+	void addBins(const sampleFrame * data, f_cnt_t frames);
+	void buildLevels();
+
+	std::vector<Level> m_levels;
+} ;
+
+
+#endif
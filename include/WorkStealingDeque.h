@@ -0,0 +1,213 @@
+/*
+ * WorkStealingDeque.h - growable lock-free work-stealing deque
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//! Chase-Lev deque holding pointers. Exactly one thread (the owner) may
+//! push() and pop() at the bottom, any number of threads may steal() from
+//! the top. Indices grow monotonically, so the deque never has to be reset.
+//! When the owner pushes onto a full deque, the items move into an array
+//! twice as large. Thieves may still read from the old arrays, so they are
+//! only freed together with the deque.
+template<typename T, size_t InitialCapacity>
+class WorkStealingDeque
+{
+	static_assert((InitialCapacity & (InitialCapacity - 1)) == 0,
+		"InitialCapacity must be a power of two");
+
+public:
+	WorkStealingDeque() :
+		m_top(0),
+		m_bottom(0),
+		m_array(nullptr),
+		m_growths(0)
+	{
+		m_arrays.emplace_back(new Array(InitialCapacity));
+		m_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+	}
+
+	//! Owner only. Grows the deque if it is full, which allocates.
+	void push(T * item)
+	{
+		const int64_t b = m_bottom.load(std::memory_order_relaxed);
+		const int64_t t = m_top.load(std::memory_order_acquire);
+		Array * a = m_array.load(std::memory_order_relaxed);
+		if (b - t >= a->capacity)
+		{
+			a = grow(a, t, b, a->capacity * 2);
+			++m_growths;
+		}
+		a->put(b, item);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	//! Owner only, or any thread while the deque is empty and its owner
+	//! doesn't push. Makes room for @p capacity items, so the following
+	//! pushes don't have to allocate.
+	void reserve(size_t capacity)
+	{
+		Array * a = m_array.load(std::memory_order_relaxed);
+		if (static_cast<int64_t>(capacity) > a->capacity)
+		{
+			int64_t newCapacity = a->capacity;
+			while (newCapacity < static_cast<int64_t>(capacity))
+			{
+				newCapacity *= 2;
+			}
+			grow(a, m_top.load(std::memory_order_acquire),
+				m_bottom.load(std::memory_order_relaxed), newCapacity);
+		}
+	}
+
+	//! Owner only. Takes the most recently pushed item, or nullptr.
+	T * pop()
+	{
+		const int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+		Array * a = m_array.load(std::memory_order_relaxed);
+		m_bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = m_top.load(std::memory_order_relaxed);
+
+		if (t > b)
+		{
+			// empty
+			m_bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		T * item = a->get(b);
+		if (t == b)
+		{
+			// last item - race against thieves for it
+			if (!m_top.compare_exchange_strong(t, t + 1,
+					std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				item = nullptr;
+			}
+			m_bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return item;
+	}
+
+	//! Any thread. Takes the oldest item, or nullptr if the deque is empty
+	//! or another thread won the race for it.
+	T * steal()
+	{
+		int64_t t = m_top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t b = m_bottom.load(std::memory_order_acquire);
+
+		if (t >= b)
+		{
+			return nullptr;
+		}
+
+		Array * a = m_array.load(std::memory_order_acquire);
+		T * item = a->get(t);
+		if (!m_top.compare_exchange_strong(t, t + 1,
+				std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return nullptr;
+		}
+		return item;
+	}
+
+	bool empty() const
+	{
+		return m_bottom.load(std::memory_order_acquire) <= m_top.load(std::memory_order_acquire);
+	}
+
+	//! Owner only
+	size_t capacity() const
+	{
+		return static_cast<size_t>(m_array.load(std::memory_order_relaxed)->capacity);
+	}
+
+	//! Owner only. How often push() found the deque full.
+	int growths() const
+	{
+		return m_growths;
+	}
+
+private:
+	struct Array
+	{
+		explicit Array(int64_t size) :
+			capacity(size),
+			mask(size - 1),
+			items(new std::atomic<T *>[size])
+		{
+			for (int64_t i = 0; i < size; ++i)
+			{
+				items[i].store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		T * get(int64_t index) const
+		{
+			return items[index & mask].load(std::memory_order_relaxed);
+		}
+
+		void put(int64_t index, T * item)
+		{
+			items[index & mask].store(item, std::memory_order_relaxed);
+		}
+
+		const int64_t capacity;
+		const int64_t mask;
+		std::unique_ptr<std::atomic<T *>[]> items;
+	} ;
+
+	Array * grow(Array * a, int64_t top, int64_t bottom, int64_t newCapacity)
+	{
+		m_arrays.emplace_back(new Array(newCapacity));
+		Array * grown = m_arrays.back().get();
+		for (int64_t i = top; i < bottom; ++i)
+		{
+			grown->put(i, a->get(i));
+		}
+		// thieves which load the new array must see the copied items
+		m_array.store(grown, std::memory_order_release);
+		return grown;
+	}
+
+	// keep the thieves' and the owner's index on separate cache lines
+	alignas(64) std::atomic<int64_t> m_top;
+	alignas(64) std::atomic<int64_t> m_bottom;
+	alignas(64) std::atomic<Array *> m_array;
+	int m_growths;
+
+	// all arrays ever used, only touched by the owner
+	std::vector<std::unique_ptr<Array>> m_arrays;
+} ;
+
+#endif
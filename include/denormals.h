@@ -4,6 +4,8 @@
 #ifndef DENORMALS_H
 #define DENORMALS_H
 
+#include "lmmsconfig.h"
+
 #ifdef __SSE__
 #include <immintrin.h>
 #ifdef __GNUC__
@@ -26,17 +28,23 @@ int inline can_we_daz() {
 }
 #endif
 
-// Set denormal protection for this thread. 
+// Set denormal protection for this thread. Cheap enough to be called for
+// every period, which also restores it if a plugin changed it.
 void inline disable_denormals() {
 #ifdef __SSE__
   /* Setting DAZ might freeze systems not supporting it */
-  if (can_we_daz()) {
+  static const bool daz = can_we_daz();
+  if (daz) {
     _MM_SET_DENORMALS_ZERO_MODE( _MM_DENORMALS_ZERO_ON );
   }
   /* FTZ flag */
   _MM_SET_FLUSH_ZERO_MODE( _MM_FLUSH_ZERO_ON );
+#elif defined(__aarch64__)
+  /* FZ flag of the FPCR, which also flushes denormal inputs */
+  unsigned long long fpcr;
+  __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+  __asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | (1ULL << 24)));
 #endif
 }
 
 #endif
-
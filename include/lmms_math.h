@@ -120,9 +120,12 @@ static inline float absFraction( float _x )
 
 
 constexpr int FAST_RAND_MAX = 32767;
+//! Every thread has its own state, so that threads neither race for it nor
+//! share its cache line. Where the sequence should be the same in every
+//! render, use a FastRandom per voice or instance instead.
 static inline int fast_rand()
 {
-	static unsigned long next = 1;
+	static thread_local unsigned long next = 1;
 	next = next * 1103515245 + 12345;
 	return( (unsigned)( next / 65536 ) % 32768 );
 }
@@ -139,6 +142,76 @@ static inline float fastRandf( float range )
 	return fast_rand() * range * fast_rand_ratio;
 }
 
+//! A small and fast pseudo random generator (xorshift32) for noise and
+//! the like, owned by a voice or an instance. Seeded from what's playing,
+//! e.g. with NotePlayHandle::randomSeed(), it gives the same sequence in
+//! every render, no matter which thread renders it when.
+class FastRandom
+{
+public:
+	explicit FastRandom( uint32_t seed = 1 )
+	{
+		setSeed( seed );
+	}
+
+	void setSeed( uint32_t seed )
+	{
+		// xorshift gets stuck at 0
+		m_state = hash( seed );
+		if( m_state == 0 )
+		{
+			m_state = 0x9e3779b9;
+		}
+	}
+
+	uint32_t next()
+	{
+		m_state ^= m_state << 13;
+		m_state ^= m_state >> 17;
+		m_state ^= m_state << 5;
+		return m_state;
+	}
+
+	//! In [0, FAST_RAND_MAX], like fast_rand()
+	int nextInt()
+	{
+		return static_cast<int>( next() >> 17 );
+	}
+
+	//! In [0, 1)
+	float nextUnipolar()
+	{
+		return ( next() >> 8 ) * ( 1.0f / 16777216.0f );
+	}
+
+	//! In [-1, 1)
+	float nextBipolar()
+	{
+		return static_cast<int32_t>( next() & 0xffffff00 ) * ( 1.0f / 2147483648.0f );
+	}
+
+	//! Mixes @p value into @p seed, e.g. to combine the identities of
+	//! a note and of one of its oscillators
+	static uint32_t combine( uint32_t seed, uint32_t value )
+	{
+		return hash( seed ^ ( value + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 ) ) );
+	}
+
+private:
+	static uint32_t hash( uint32_t x )
+	{
+		x ^= x >> 16;
+		x *= 0x7feb352d;
+		x ^= x >> 15;
+		x *= 0x846ca68b;
+		x ^= x >> 16;
+		return x;
+	}
+
+	uint32_t m_state;
+
+} ;
+
 //! @brief Takes advantage of fmal() function if present in hardware
 static inline long double fastFmal( long double a, long double b, long double c ) 
 {
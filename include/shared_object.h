@@ -78,6 +78,12 @@ public:
 		}
 	}
 
+	//! Only reliable while no other thread can take or drop references
+	int referenceCount() const
+	{
+		return m_referenceCount.load(std::memory_order_acquire);
+	}
+
 private:
 	std::atomic_int m_referenceCount;
 } ;
@@ -23,8 +23,11 @@
  *
  */
 
+#include <algorithm>
+
 #include "Bitcrush.h"
 #include "embed.h"
+#include "MixHelpers.h"
 #include "plugin_export.h"
 
 const int OS_RATE = 5;
@@ -55,10 +58,12 @@ Plugin::Descriptor PLUGIN_EXPORT bitcrush_plugin_descriptor =
 BitcrushEffect::BitcrushEffect( Model * parent, const Descriptor::SubPluginFeatures::Key * key ) :
 	Effect( &bitcrush_plugin_descriptor, parent, key ),
 	m_controls( this ),
-	m_sampleRate( Engine::audioEngine()->processingSampleRate() ),
+	m_sampleRate( sampleRate() ),
 	m_filter( m_sampleRate )
 {
 	m_buffer = MM_ALLOC<sampleFrame>( Engine::audioEngine()->framesPerPeriod() * OS_RATE );
+	m_crushed = MM_ALLOC<sampleFrame>( Engine::audioEngine()->framesPerPeriod() );
+	m_noise = MM_ALLOC<sampleFrame>( Engine::audioEngine()->framesPerPeriod() * OS_RATE );
 	m_filter.setLowpass( m_sampleRate * ( CUTOFF_RATIO * OS_RATIO ) );
 	m_needsUpdate = true;
 	
@@ -74,26 +79,32 @@ BitcrushEffect::BitcrushEffect( Model * parent, const Descriptor::SubPluginFeatu
 BitcrushEffect::~BitcrushEffect()
 {
 	MM_FREE( m_buffer );
+	MM_FREE( m_crushed );
+	MM_FREE( m_noise );
 }
 
 
-void BitcrushEffect::sampleRateChanged()
+void BitcrushEffect::updateSampleRate()
 {
-	m_sampleRate = Engine::audioEngine()->processingSampleRate();
+	m_sampleRate = sampleRate();
 	m_filter.setSampleRate( m_sampleRate );
 	m_filter.setLowpass( m_sampleRate * ( CUTOFF_RATIO * OS_RATIO ) );
 	m_needsUpdate = true;
 }
 
 
-inline float BitcrushEffect::depthCrush( float in )
-{
-	return roundf( in * (float) m_levels ) * m_levelsRatio;
-}
-
-inline float BitcrushEffect::noise( float amt )
+const sampleFrame * BitcrushEffect::noise( float amt, int frames )
 {
-	return fastRandf( amt * 2.0f ) - amt;
+	if( amt == 0.0f )
+	{
+		return nullptr;
+	}
+	for( int f = 0; f < frames; ++f )
+	{
+		m_noise[f][0] = m_random.nextBipolar();
+		m_noise[f][1] = m_random.nextBipolar();
+	}
+	return m_noise;
 }
 
 bool BitcrushEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
@@ -128,7 +139,6 @@ bool BitcrushEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 	if( m_needsUpdate || m_controls.m_levels.isValueChanged() )
 	{
 		m_levels = m_controls.m_levels.value();
-		m_levelsRatio = 1.0f / (float) m_levels;
 	}
 	if( m_needsUpdate || m_controls.m_inGain.isValueChanged() )
 	{
@@ -146,9 +156,15 @@ bool BitcrushEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 	
 	const float noiseAmt = m_controls.m_inNoise.value() * 0.01f;
 	
+	const float levels = m_depthEnabled ? m_levels : 0.0f;
+
 	// read input buffer and write it to oversampled buffer
 	if( m_rateEnabled ) // rate crushing enabled so do that
 	{
+		// crush every input frame, the sample and hold only picks some
+		std::copy( buf, buf + frames, m_crushed );
+		MixHelpers::quantize( m_crushed, noise( noiseAmt, frames ), m_inGain, noiseAmt, levels, frames );
+
 		for( int f = 0; f < frames; ++f )
 		{
 			for( int o = 0; o < OS_RATE; ++o )
@@ -160,16 +176,12 @@ bool BitcrushEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 				if( m_bitCounterL > m_rateCoeffL )
 				{
 					m_bitCounterL -= m_rateCoeffL;
-					m_left = m_depthEnabled 
-						? depthCrush( buf[f][0] * m_inGain + noise( buf[f][0] * noiseAmt ) ) 
-						: buf[f][0] * m_inGain + noise( buf[f][0] * noiseAmt );
+					m_left = m_crushed[f][0];
 				}
 				if( m_bitCounterR > m_rateCoeffR )
 				{
 					m_bitCounterR -= m_rateCoeffR;
-					m_right = m_depthEnabled 
-						? depthCrush( buf[f][1] * m_inGain + noise( buf[f][1] * noiseAmt ) ) 
-						: buf[f][1] * m_inGain + noise( buf[f][1] * noiseAmt );
+					m_right = m_crushed[f][1];
 				}
 			}
 		}
@@ -180,14 +192,12 @@ bool BitcrushEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 		{
 			for( int o = 0; o < OS_RATE; ++o )
 			{
-				m_buffer[f * OS_RATE + o][0] = m_depthEnabled
-					? depthCrush( buf[f][0] * m_inGain + noise( buf[f][0] * noiseAmt ) ) 
-					: buf[f][0] * m_inGain + noise( buf[f][0] * noiseAmt );
-				m_buffer[f * OS_RATE + o][1] = m_depthEnabled
-					? depthCrush( buf[f][1] * m_inGain + noise( buf[f][1] * noiseAmt ) ) 
-					: buf[f][1] * m_inGain + noise( buf[f][1] * noiseAmt );
+				m_buffer[f * OS_RATE + o][0] = buf[f][0];
+				m_buffer[f * OS_RATE + o][1] = buf[f][1];
 			}
 		}
+		MixHelpers::quantize( m_buffer, noise( noiseAmt, frames * OS_RATE ), m_inGain, noiseAmt, levels,
+					frames * OS_RATE );
 	}
 	
 	// the oversampled buffer is now written, so filter it to reduce aliasing
@@ -44,15 +44,23 @@ public:
 	{
 		return &m_controls;
 	}
+
+	bool supportsOversampling() const override
+	{
+		return true;
+	}
 	
 private:
-	void sampleRateChanged();
-	float depthCrush( float in );
-	float noise( float amt );
+	void updateSampleRate();
+	//! Fills m_noise, returns nullptr if there is no noise to add
+	const sampleFrame * noise( float amt, int frames );
 
 	BitcrushControls m_controls;
 	
 	sampleFrame * m_buffer;
+	// the input, crushed, for the sample and hold
+	sampleFrame * m_crushed;
+	sampleFrame * m_noise;
 	float m_sampleRate;
 	StereoLinkwitzRiley m_filter;
 	
@@ -66,7 +74,6 @@ private:
 	float m_right;
 
 	int m_levels;
-	float m_levelsRatio;
 	bool m_depthEnabled;
 	
 	float m_inGain;
@@ -77,6 +84,9 @@ private:
 	
 	int m_silenceCounter;
 
+	// the same noise in every render
+	FastRandom m_random;
+
 	friend class BitcrushControls;
 };
 
@@ -47,7 +47,7 @@ BitcrushControls::BitcrushControls( BitcrushEffect * eff ) :
 	m_rate.setStrictStepSize( true );
 	m_levels.setStrictStepSize( true );
 	
-	connect( Engine::audioEngine(), SIGNAL( sampleRateChanged() ), this, SLOT( sampleRateChanged() ) );
+	connect( m_effect, SIGNAL( sampleRateChanged() ), this, SLOT( sampleRateChanged() ) );
 }
 
 BitcrushControls::~BitcrushControls()
@@ -85,5 +85,5 @@ void BitcrushControls::loadSettings( const QDomElement & elem )
 
 void BitcrushControls::sampleRateChanged()
 {
-	m_effect->sampleRateChanged();
+	m_effect->updateSampleRate();
 }
@@ -24,6 +24,10 @@
 
 #include "Compressor.h"
 
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
 #include "embed.h"
 #include "interpolation.h"
 #include "lmms_math.h"
@@ -48,11 +52,81 @@ Plugin::Descriptor PLUGIN_EXPORT compressor_plugin_descriptor =
 }
 
 
+namespace
+{
+
+// Table approximations of log2 and exp2 for the fast mode, linearly
+// interpolated between 256 points per octave
+constexpr int FAST_TABLE_BITS = 8;
+constexpr int FAST_TABLE_SIZE = 1 << FAST_TABLE_BITS;
+constexpr int FAST_MANTISSA_SHIFT = 23 - FAST_TABLE_BITS;
+
+// 20 * log10(2), dBFS per octave
+constexpr float DBFS_PER_OCTAVE = 6.0205999f;
+
+struct FastLogTables
+{
+	FastLogTables()
+	{
+		for (int i = 0; i <= FAST_TABLE_SIZE; ++i)
+		{
+			log2Table[i] = std::log2(1.f + float(i) / FAST_TABLE_SIZE);
+			exp2Table[i] = std::exp2(float(i) / FAST_TABLE_SIZE);
+		}
+	}
+
+	float log2Table[FAST_TABLE_SIZE + 1];
+	float exp2Table[FAST_TABLE_SIZE + 1];
+};
+
+const FastLogTables fastLogTables;
+
+// x must be a normal positive number, which the levels above the noise floor are
+inline float fastLog2(float x)
+{
+	int32_t bits;
+	std::memcpy(&bits, &x, sizeof(bits));
+	const int exponent = ((bits >> 23) & 0xff) - 127;
+	const int mantissa = bits & 0x7fffff;
+	const int index = mantissa >> FAST_MANTISSA_SHIFT;
+	const float frac = (mantissa & ((1 << FAST_MANTISSA_SHIFT) - 1)) * (1.f / (1 << FAST_MANTISSA_SHIFT));
+	return exponent + linearInterpolate(fastLogTables.log2Table[index], fastLogTables.log2Table[index + 1], frac);
+}
+
+inline float fastExp2(float x)
+{
+	x = qBound(-126.f, x, 127.f);
+	const float whole = std::floor(x);
+	const float pos = (x - whole) * FAST_TABLE_SIZE;
+	const int index = qMin(static_cast<int>(pos), FAST_TABLE_SIZE - 1);
+	const float mantissa = linearInterpolate(fastLogTables.exp2Table[index], fastLogTables.exp2Table[index + 1], pos - index);
+	// 2 to the whole part, straight into the exponent bits
+	const int32_t bits = (static_cast<int32_t>(whole) + 127) << 23;
+	float scale;
+	std::memcpy(&scale, &bits, sizeof(scale));
+	return mantissa * scale;
+}
+
+inline float fastAmpToDbfs(float amp)
+{
+	return fastLog2(amp) * DBFS_PER_OCTAVE;
+}
+
+inline float fastDbfsToAmp(float dbfs)
+{
+	return fastExp2(dbfs * (1.f / DBFS_PER_OCTAVE));
+}
+
+}
+
+
+
+
 CompressorEffect::CompressorEffect(Model* parent, const Descriptor::SubPluginFeatures::Key* key) :
 	Effect(&compressor_plugin_descriptor, parent, key),
 	m_compressorControls(this)
 {
-	m_sampleRate = Engine::audioEngine()->processingSampleRate();
+	m_sampleRate = sampleRate();
 
 	m_yL[0] = m_yL[1] = COMP_NOISE_FLOOR;
 
@@ -86,7 +160,7 @@ CompressorEffect::CompressorEffect(Model* parent, const Descriptor::SubPluginFea
 	connect(&m_compressorControls.m_kneeModel, SIGNAL(dataChanged()), this, SLOT(calcAutoMakeup()), Qt::DirectConnection);
 	connect(&m_compressorControls.m_autoMakeupModel, SIGNAL(dataChanged()), this, SLOT(calcAutoMakeup()), Qt::DirectConnection);
 
-	connect(Engine::audioEngine(), SIGNAL(sampleRateChanged()), this, SLOT(changeSampleRate()));
+	connect(this, SIGNAL(sampleRateChanged()), this, SLOT(changeSampleRate()));
 	changeSampleRate();
 }
 
@@ -106,6 +180,29 @@ float CompressorEffect::msToCoeff(float ms)
 
 
 
+float CompressorEffect::autoAttackCoeff(int channel)
+{
+	// We want the "resting value" of our crest factor to be with a sine wave,
+	// which with this variable has a value of 2.
+	// So, we pull this value down to 0, and multiply it by the percentage of
+	// automatic attack control that is applied.  We then add 2 back to it.
+	const float crestFactorValTemp = ((m_crestFactorVal[channel] - 2.f) * m_autoAttVal) + 2.f;
+
+	// Calculate attack value depending on crest factor
+	return msToCoeff(2.f * m_compressorControls.m_attackModel.value() / (crestFactorValTemp));
+}
+
+
+
+float CompressorEffect::autoReleaseCoeff(int channel)
+{
+	const float crestFactorValTemp = ((m_crestFactorVal[channel] - 2.f) * m_autoRelVal) + 2.f;
+
+	return msToCoeff(2.f * m_compressorControls.m_releaseModel.value() / (crestFactorValTemp));
+}
+
+
+
 void CompressorEffect::calcAutoMakeup()
 {
 	// Formulas using the compressor's Threshold, Ratio, and Knee values to estimate a good makeup gain value
@@ -131,11 +228,13 @@ void CompressorEffect::calcAutoMakeup()
 void CompressorEffect::calcAttack()
 {
 	m_attCoeff = msToCoeff(m_compressorControls.m_attackModel.value());
+	m_blockAttCoeff[0] = m_blockAttCoeff[1] = m_attCoeff;
 }
 
 void CompressorEffect::calcRelease()
 {
 	m_relCoeff = msToCoeff(m_compressorControls.m_releaseModel.value());
+	m_blockRelCoeff[0] = m_blockRelCoeff[1] = m_relCoeff;
 }
 
 void CompressorEffect::calcAutoAttack()
@@ -290,6 +389,9 @@ bool CompressorEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 	const bool audition = m_compressorControls.m_auditionModel.value();
 	const bool feedback = m_compressorControls.m_feedbackModel.value();
 	const bool lookahead = m_compressorControls.m_lookaheadModel.value();
+	// The fast mode approximates the dBFS conversions of the gain computer and
+	// follows the crest factor at control rate, the reference mode is exact
+	const bool fast = m_compressorControls.m_fastModel.value();
 
 	for(fpp_t f = 0; f < frames; ++f)
 	{
@@ -379,29 +481,26 @@ bool CompressorEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 
 			float t = inputValue;
 
-			if (t > m_yL[i])// Attack phase
+			if (fast && f % COMP_CONTROL_INTERVAL == 0)
 			{
-				// We want the "resting value" of our crest factor to be with a sine wave,
-				// which with this variable has a value of 2.
-				// So, we pull this value down to 0, and multiply it by the percentage of
-				// automatic attack control that is applied.  We then add 2 back to it.
-				float crestFactorValTemp = ((m_crestFactorVal[i] - 2.f) * m_autoAttVal) + 2.f;
+				if (m_autoAttVal) { m_blockAttCoeff[i] = autoAttackCoeff(i); }
+				if (m_autoRelVal) { m_blockRelCoeff[i] = autoReleaseCoeff(i); }
+			}
 
-				// Calculate attack value depending on crest factor
-				const float att = m_autoAttVal
-					? msToCoeff(2.f * m_compressorControls.m_attackModel.value() / (crestFactorValTemp))
-					: m_attCoeff;
+			if (t > m_yL[i])// Attack phase
+			{
+				const float att = !m_autoAttVal
+					? m_attCoeff
+					: fast ? m_blockAttCoeff[i] : autoAttackCoeff(i);
 
 				m_yL[i] = m_yL[i] * att + (1 - att) * t;
 				m_holdTimer[i] = m_holdLength;// Reset hold timer
 			}
 			else// Release phase
 			{
-				float crestFactorValTemp = ((m_crestFactorVal[i] - 2.f) * m_autoRelVal) + 2.f;
-
-				const float rel = m_autoRelVal
-					? msToCoeff(2.f * m_compressorControls.m_releaseModel.value() / (crestFactorValTemp))
-					: m_relCoeff;
+				const float rel = !m_autoRelVal
+					? m_relCoeff
+					: fast ? m_blockRelCoeff[i] : autoReleaseCoeff(i);
 
 				if (m_holdTimer[i])// Don't change peak if hold is being applied
 				{
@@ -419,7 +518,7 @@ bool CompressorEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 			// For the visualizer
 			m_displayPeak[i] = qMax(m_yL[i], m_displayPeak[i]);
 
-			const float currentPeakDbfs = ampToDbfs(m_yL[i]);
+			const float currentPeakDbfs = fast ? fastAmpToDbfs(m_yL[i]) : ampToDbfs(m_yL[i]);
 
 			// Now find the gain change that should be applied,
 			// depending on the measured input value.
@@ -439,7 +538,10 @@ bool CompressorEffect::processAudioBuffer(sampleFrame* buf, const fpp_t frames)
 					: m_thresholdVal + (currentPeakDbfs - m_thresholdVal) * m_ratioVal;
 			}
 
-			m_gainResult[i] = dbfsToAmp(m_gainResult[i]) / m_yL[i];
+			// The fast mode takes the difference in the log domain, which saves the division
+			m_gainResult[i] = fast
+				? fastDbfsToAmp(m_gainResult[i] - currentPeakDbfs)
+				: dbfsToAmp(m_gainResult[i]) / m_yL[i];
 			m_gainResult[i] = qMax(m_rangeVal, m_gainResult[i]);
 		}
 
@@ -614,7 +716,7 @@ inline void CompressorEffect::calcTiltFilter(sample_t inputSample, sample_t &out
 
 void CompressorEffect::changeSampleRate()
 {
-	m_sampleRate = Engine::audioEngine()->processingSampleRate();
+	m_sampleRate = sampleRate();
 
 	m_coeffPrecalc = COMP_LOG / (m_sampleRate * 0.001f);
 
@@ -632,6 +734,11 @@ void CompressorEffect::changeSampleRate()
 	m_preLookaheadBuf[0].resize(m_lookaheadDelayLength);
 	m_preLookaheadBuf[1].resize(m_lookaheadDelayLength);
 
+	// the buffers may have shrunk
+	m_lookaheadBufLoc[0] = m_lookaheadBufLoc[1] = 0;
+	m_preLookaheadBufLoc[0] = m_preLookaheadBufLoc[1] = 0;
+	m_inputBufLoc = 0;
+
 	calcThreshold();
 	calcKnee();
 	calcRatio();
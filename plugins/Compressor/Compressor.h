@@ -34,6 +34,8 @@
 
 
 constexpr float COMP_LOG = -2.2;
+// How often, in frames, the fast mode updates the automatic attack and release
+constexpr int COMP_CONTROL_INTERVAL = 16;
 
 class CompressorEffect : public Effect
 {
@@ -48,6 +50,11 @@ public:
 		return &m_compressorControls;
 	}
 
+	bool supportsOversampling() const override
+	{
+		return true;
+	}
+
 private slots:
 	void calcAutoMakeup();
 	void calcAttack();
@@ -72,6 +79,9 @@ private:
 	CompressorControls m_compressorControls;
 
 	float msToCoeff(float ms);
+	// Attack and release coefficients following the crest factor of a channel
+	float autoAttackCoeff(int channel);
+	float autoReleaseCoeff(int channel);
 
 	inline void calcTiltFilter(sample_t inputSample, sample_t &outputSample, int filtNum);
 	inline int realmod(int k, int n);
@@ -93,6 +103,10 @@ private:
 	float m_autoAttVal;
 	float m_autoRelVal;
 
+	// Automatic attack and release of the fast mode, until the next update
+	float m_blockAttCoeff[2] = {0, 0};
+	float m_blockRelCoeff[2] = {0, 0};
+
 	int m_holdLength = 0;
 	int m_holdTimer[2] = {0, 0};
 
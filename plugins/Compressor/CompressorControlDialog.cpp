@@ -297,6 +297,10 @@ CompressorControlDialog::CompressorControlDialog(CompressorControls* controls) :
 	lookaheadButton->setCheckable(true);
 	lookaheadButton->setModel(&controls->m_lookaheadModel);
 
+	fastToggle = new LedCheckBox(tr("Fast"), this, tr("Fast Mode"), LedCheckBox::Green);
+	ToolTip::add(fastToggle, tr("Approximate the level and gain calculations, and update automatic attack and release less often, to save CPU"));
+	fastToggle->setModel(&controls->m_fastModel);
+
 	connect(getGUI()->mainWindow(), SIGNAL(periodicUpdate()), this, SLOT(updateDisplay()));
 
 	connect(&m_controls->m_peakmodeModel, SIGNAL(dataChanged()), this, SLOT(peakmodeChanged()));
@@ -759,4 +763,5 @@ void CompressorControlDialog::resetCompressorView()
 	m_autoAttackKnob->move(m_controlsBoxX + 460, m_controlsBoxY + 38);
 	m_autoReleaseKnob->move(m_controlsBoxX + 590, m_controlsBoxY + 38);
 	lookaheadButton->move(m_controlsBoxX + 202, m_controlsBoxY + 171);
+	fastToggle->move(m_controlsBoxX + 98, m_controlsBoxY + 184);
 }
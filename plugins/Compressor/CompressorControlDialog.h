@@ -35,6 +35,7 @@
 #include "EffectControlDialog.h"
 #include "GuiApplication.h"
 #include "Knob.h"
+#include "LedCheckbox.h"
 #include "MainWindow.h"
 #include "PixmapButton.h"
 
@@ -208,6 +209,7 @@ private:
 	PixmapButton * auditionButton;
 	PixmapButton * feedbackButton;
 	PixmapButton * lookaheadButton;
+	LedCheckBox * fastToggle;
 
 	QElapsedTimer m_timeElapsed;
 	int m_timeSinceLastUpdate = 0;
@@ -62,7 +62,8 @@ CompressorControls::CompressorControls(CompressorEffect* effect) :
 	m_tiltModel(0.0f, -6.0f, 6.0f, 0.0001f, this, tr("Tilt")),
 	m_tiltFreqModel(150.0f, 20.0f, 20000.0f, 0.1f, this, tr("Tilt Frequency")),
 	m_stereoLinkModel(1.0f, 0.0f, 4.0f, this, tr("Stereo Link")),
-	m_mixModel(100.0f, 0.f, 100.0f, 0.01f, this, tr("Mix"))
+	m_mixModel(100.0f, 0.f, 100.0f, 0.01f, this, tr("Mix")),
+	m_fastModel(false, this, tr("Fast Mode"))
 {
 	m_ratioModel.setScaleLogarithmic(true);
 	m_holdModel.setScaleLogarithmic(true);
@@ -108,6 +109,7 @@ void CompressorControls::saveSettings(QDomDocument& doc, QDomElement& _this)
 	m_tiltFreqModel.saveSettings(doc, _this, "tiltFreq");
 	m_stereoLinkModel.saveSettings(doc, _this, "stereoLink");
 	m_mixModel.saveSettings(doc, _this, "mix");
+	m_fastModel.saveSettings(doc, _this, "fast");
 }
 
 
@@ -142,6 +144,7 @@ void CompressorControls::loadSettings(const QDomElement& _this)
 	m_tiltFreqModel.loadSettings(_this, "tiltFreq");
 	m_stereoLinkModel.loadSettings(_this, "stereoLink");
 	m_mixModel.loadSettings(_this, "mix");
+	m_fastModel.loadSettings(_this, "fast");
 }
 
 
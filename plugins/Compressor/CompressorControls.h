@@ -49,7 +49,7 @@ public:
 
 	int controlCount() override
 	{
-		return 28;
+		return 29;
 	}
 
 	EffectControlDialog* createView() override
@@ -88,6 +88,7 @@ private:
 	FloatModel m_tiltFreqModel;
 	IntModel m_stereoLinkModel;
 	FloatModel m_mixModel;
+	BoolModel m_fastModel;
 
 	float m_inPeakL;
 	float m_inPeakR;
@@ -0,0 +1,85 @@
+/*
+ * ConvolverControlDialog.cpp - control dialog for the convolver effect
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <QFileInfo>
+#include <QLabel>
+#include <QPushButton>
+
+#include "ConvolverControlDialog.h"
+#include "ConvolverControls.h"
+#include "Knob.h"
+#include "SampleBuffer.h"
+
+
+
+ConvolverControlDialog::ConvolverControlDialog( ConvolverControls* controls ) :
+	EffectControlDialog( controls ),
+	m_controls( controls )
+{
+	setFixedSize( 200, 70 );
+
+	QPushButton * openButton = new QPushButton( tr( "Open" ), this );
+	openButton->move( 10, 10 );
+	openButton->resize( 60, 22 );
+	openButton->setToolTip( tr( "Open an impulse response" ) );
+	connect( openButton, SIGNAL( clicked() ), this, SLOT( openFile() ) );
+
+	m_fileLabel = new QLabel( this );
+	m_fileLabel->move( 10, 40 );
+	m_fileLabel->resize( 130, 20 );
+
+	Knob * gainKnob = new Knob( knobBright_26, this);
+	gainKnob -> move( 155, 10 );
+	gainKnob -> setVolumeKnob( true );
+	gainKnob->setModel( &controls->m_gainModel );
+	gainKnob->setLabel( tr( "GAIN" ) );
+	gainKnob->setHintText( tr( "Gain:" ) , "%" );
+
+	connect( controls, SIGNAL( fileChanged() ), this, SLOT( updateFileName() ) );
+	updateFileName();
+}
+
+
+
+
+void ConvolverControlDialog::openFile()
+{
+	const QString file = SampleBuffer().openAudioFile();
+	if( !file.isEmpty() )
+	{
+		m_controls->setFile( file );
+	}
+}
+
+
+
+
+void ConvolverControlDialog::updateFileName()
+{
+	const QString name = m_controls->file().isEmpty()
+		? tr( "No impulse response" ) : QFileInfo( m_controls->file() ).fileName();
+	m_fileLabel->setText( m_fileLabel->fontMetrics().elidedText(
+					name, Qt::ElideMiddle, m_fileLabel->width() ) );
+	m_fileLabel->setToolTip( m_controls->file() );
+}
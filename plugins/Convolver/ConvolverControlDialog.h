@@ -1,7 +1,7 @@
 /*
- * DataprocLauncher.h - QThread::create workaround for older Qt version
+ * ConvolverControlDialog.h - control dialog for the convolver effect
  *
- * Copyright (c) 2019 Martin Pavelek <he29/dot/HS/at/gmail/dot/com>
+ * Copyright (c) 2026 LMMS Developers
  *
  * This file is part of LMMS - https://lmms.io
  *
@@ -22,31 +22,33 @@
  *
  */
 
-#ifndef DATAPROCLAUNCHER_H
-#define DATAPROCLAUNCHER_H
+#ifndef CONVOLVER_CONTROL_DIALOG_H
+#define CONVOLVER_CONTROL_DIALOG_H
 
-#include <QThread>
+#include "EffectControlDialog.h"
 
-#include "SaProcessor.h"
-#include "LocklessRingBuffer.h"
 
-class DataprocLauncher : public QThread
+class QLabel;
+class ConvolverControls;
+
+
+class ConvolverControlDialog : public EffectControlDialog
 {
+	Q_OBJECT
 public:
-	explicit DataprocLauncher(SaProcessor &proc, LocklessRingBuffer<sampleFrame> &buffer)
-		: m_processor(&proc),
-		m_inputBuffer(&buffer)
+	ConvolverControlDialog( ConvolverControls* controls );
+	~ConvolverControlDialog() override
 	{
 	}
 
+private slots:
+	void openFile();
+	void updateFileName();
+
 private:
-	void run() override
-	{
-		m_processor->analyze(*m_inputBuffer);
-	}
+	ConvolverControls* m_controls;
+	QLabel* m_fileLabel;
 
-	SaProcessor *m_processor;
-	LocklessRingBuffer<sampleFrame> *m_inputBuffer;
-};
+} ;
 
-#endif // DATAPROCLAUNCHER_H
+#endif
@@ -0,0 +1,83 @@
+/*
+ * ConvolverControls.cpp - controls for the convolver effect
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include <QDomElement>
+
+#include "ConvolverControls.h"
+#include "ConvolverEffect.h"
+
+
+ConvolverControls::ConvolverControls( ConvolverEffect* effect ) :
+	EffectControls( effect ),
+	m_effect( effect ),
+	m_gainModel( 100.0f, 0.0f, 200.0f, 0.1f, this, tr( "Gain" ) )
+{
+	// the spectra are made for the engine's sample rate
+	connect( m_effect, SIGNAL( sampleRateChanged() ), this, SLOT( reload() ) );
+}
+
+
+
+
+void ConvolverControls::setFile( const QString & file )
+{
+	m_file = file;
+	m_effect->loadImpulseResponse();
+	emit fileChanged();
+}
+
+
+
+
+void ConvolverControls::convolverLoaded()
+{
+	m_effect->swapConvolver();
+}
+
+
+
+
+void ConvolverControls::reload()
+{
+	m_effect->loadImpulseResponse();
+}
+
+
+
+
+void ConvolverControls::loadSettings( const QDomElement& _this )
+{
+	m_gainModel.loadSettings( _this, "gain" );
+	setFile( _this.attribute( "file" ) );
+}
+
+
+
+
+void ConvolverControls::saveSettings( QDomDocument& doc, QDomElement& _this )
+{
+	m_gainModel.saveSettings( doc, _this, "gain" );
+	_this.setAttribute( "file", m_file );
+}
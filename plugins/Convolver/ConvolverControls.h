@@ -0,0 +1,86 @@
+/*
+ * ConvolverControls.h - controls for the convolver effect
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef CONVOLVER_CONTROLS_H
+#define CONVOLVER_CONTROLS_H
+
+#include "EffectControls.h"
+#include "ConvolverControlDialog.h"
+
+
+class ConvolverEffect;
+
+
+class ConvolverControls : public EffectControls
+{
+	Q_OBJECT
+public:
+	ConvolverControls( ConvolverEffect* effect );
+	~ConvolverControls() override
+	{
+	}
+
+	void saveSettings( QDomDocument & doc, QDomElement & parent ) override;
+	void loadSettings( const QDomElement & _this ) override;
+	inline QString nodeName() const override
+	{
+		return "ConvolverControls";
+	}
+
+	int controlCount() override
+	{
+		return 1;
+	}
+
+	EffectControlDialog* createView() override
+	{
+		return new ConvolverControlDialog( this );
+	}
+
+	const QString & file() const
+	{
+		return m_file;
+	}
+
+	//! Loads the impulse response in @p file in the background
+	void setFile( const QString & file );
+
+signals:
+	void fileChanged();
+
+private slots:
+	void convolverLoaded();
+	void reload();
+
+private:
+	ConvolverEffect* m_effect;
+	QString m_file;
+	FloatModel m_gainModel;
+
+	friend class ConvolverControlDialog;
+	friend class ConvolverEffect;
+
+} ;
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * ConvolverEffect.cpp - convolves with impulse responses, e.g. cabinets and rooms
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ConvolverEffect.h"
+
+#include "AudioEngine.h"
+#include "Engine.h"
+#include "embed.h"
+#include "plugin_export.h"
+
+extern "C"
+{
+
+Plugin::Descriptor PLUGIN_EXPORT convolver_plugin_descriptor =
+{
+	STRINGIFY( PLUGIN_NAME ),
+	"Convolver",
+	QT_TRANSLATE_NOOP( "PluginBrowser", "Convolution with impulse responses, "
+						"e.g. of cabinets or rooms" ),
+	"LMMS Developers",
+	0x0100,
+	Plugin::Effect,
+	new PluginPixmapLoader("logo"),
+	nullptr,
+	nullptr,
+} ;
+
+}
+
+
+
+ConvolverEffect::ConvolverEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key ) :
+	Effect( &convolver_plugin_descriptor, parent, key ),
+	m_controls( this ),
+	m_wet( Engine::audioEngine()->framesPerPeriod() )
+{
+	connect( &m_loader, SIGNAL( loaded() ), &m_controls, SLOT( convolverLoaded() ) );
+}
+
+
+
+
+ConvolverEffect::~ConvolverEffect()
+{
+}
+
+
+
+
+void ConvolverEffect::loadImpulseResponse()
+{
+	// the convolution keeps the block size of periods, so there's no
+	// latency. Without a file no convolver is loaded, which drops the
+	// current one.
+	m_loader.load( m_controls.m_file, Engine::audioEngine()->framesPerPeriod() );
+}
+
+
+
+
+void ConvolverEffect::swapConvolver()
+{
+	std::unique_ptr<Convolver> convolver = m_loader.take();
+	Engine::audioEngine()->requestChangeInModel();
+	m_convolver.swap( convolver );
+	Engine::audioEngine()->doneChangeInModel();
+	// the old one is deleted here, out of the audio thread
+}
+
+
+
+
+bool ConvolverEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
+{
+	if( !isEnabled() || !isRunning () )
+	{
+		return( false );
+	}
+
+	double outSum = 0.0;
+	if( m_convolver && frames % m_convolver->blockSize() == 0 &&
+				frames <= static_cast<fpp_t>( m_wet.size() ) )
+	{
+		const float d = dryLevel();
+		const float w = wetLevel() * m_controls.m_gainModel.value() * 0.01f;
+
+		m_convolver->process( buf, m_wet.data(), frames );
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			buf[f][0] = d * buf[f][0] + w * m_wet[f][0];
+			buf[f][1] = d * buf[f][1] + w * m_wet[f][1];
+			outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
+		}
+	}
+	else
+	{
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
+		}
+	}
+
+	checkGate( outSum / frames );
+
+	return isRunning();
+}
+
+
+
+
+
+extern "C"
+{
+
+// necessary for getting instance out of shared lib
+PLUGIN_EXPORT Plugin * lmms_plugin_main( Model* parent, void* data )
+{
+	return new ConvolverEffect( parent, static_cast<const Plugin::Descriptor::SubPluginFeatures::Key *>( data ) );
+}
+
+}
@@ -0,0 +1,64 @@
+/*
+ * ConvolverEffect.h - convolves with impulse responses, e.g. cabinets and rooms
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef CONVOLVER_EFFECT_H
+#define CONVOLVER_EFFECT_H
+
+#include <memory>
+#include <vector>
+
+#include "Convolver.h"
+#include "ConvolverControls.h"
+#include "Effect.h"
+
+
+class ConvolverEffect : public Effect
+{
+public:
+	ConvolverEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
+	~ConvolverEffect() override;
+
+	bool processAudioBuffer( sampleFrame* buf, const fpp_t frames ) override;
+
+	EffectControls* controls() override
+	{
+		return &m_controls;
+	}
+
+private:
+	//! Starts loading the impulse response of the controls in the background
+	void loadImpulseResponse();
+	//! Replaces the convolver by the one loaded last
+	void swapConvolver();
+
+	ConvolverControls m_controls;
+	ConvolverLoader m_loader;
+	std::unique_ptr<Convolver> m_convolver;
+	std::vector<sampleFrame> m_wet;
+
+	friend class ConvolverControls;
+
+} ;
+
+#endif
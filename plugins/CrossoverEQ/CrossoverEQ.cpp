@@ -52,35 +52,17 @@ CrossoverEQEffect::CrossoverEQEffect( Model* parent, const Descriptor::SubPlugin
 	Effect( &crossovereq_plugin_descriptor, parent, key ),
 	m_controls( this ),
 	m_sampleRate( Engine::audioEngine()->processingSampleRate() ),
-	m_lp1( m_sampleRate ),
-	m_lp2( m_sampleRate ),
-	m_lp3( m_sampleRate ),
-	m_hp2( m_sampleRate ),
-	m_hp3( m_sampleRate ),
-	m_hp4( m_sampleRate ),
+	m_split( m_sampleRate ),
+	m_bands( m_sampleRate ),
 	m_needsUpdate( true )
 {
-	m_tmp1 = MM_ALLOC<sampleFrame>( Engine::audioEngine()->framesPerPeriod() );
-	m_tmp2 = MM_ALLOC<sampleFrame>( Engine::audioEngine()->framesPerPeriod() );
-	m_work = MM_ALLOC<sampleFrame>( Engine::audioEngine()->framesPerPeriod() );
-}
-
-CrossoverEQEffect::~CrossoverEQEffect()
-{
-	MM_FREE( m_tmp1 );
-	MM_FREE( m_tmp2 );
-	MM_FREE( m_work );
 }
 
 void CrossoverEQEffect::sampleRateChanged()
 {
 	m_sampleRate = Engine::audioEngine()->processingSampleRate();
-	m_lp1.setSampleRate( m_sampleRate );
-	m_lp2.setSampleRate( m_sampleRate );
-	m_lp3.setSampleRate( m_sampleRate );
-	m_hp2.setSampleRate( m_sampleRate );
-	m_hp3.setSampleRate( m_sampleRate );
-	m_hp4.setSampleRate( m_sampleRate );
+	m_split.setSampleRate( m_sampleRate );
+	m_bands.setSampleRate( m_sampleRate );
 	m_needsUpdate = true;
 }
 
@@ -95,18 +77,27 @@ bool CrossoverEQEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 	// filters update
 	if( m_needsUpdate || m_controls.m_xover12.isValueChanged() )
 	{
-		m_lp1.setLowpass( m_controls.m_xover12.value() );
-		m_hp2.setHighpass( m_controls.m_xover12.value() );
+		for( int ch = 0; ch < 2; ++ch )
+		{
+			m_bands.setLowpass( ch, m_controls.m_xover12.value() );
+			m_bands.setHighpass( 2 + ch, m_controls.m_xover12.value() );
+		}
 	}
 	if( m_needsUpdate || m_controls.m_xover23.isValueChanged() )
 	{
-		m_lp2.setLowpass( m_controls.m_xover23.value() );
-		m_hp3.setHighpass( m_controls.m_xover23.value() );
+		for( int ch = 0; ch < 2; ++ch )
+		{
+			m_split.setLowpass( ch, m_controls.m_xover23.value() );
+			m_split.setHighpass( 2 + ch, m_controls.m_xover23.value() );
+		}
 	}
 	if( m_needsUpdate || m_controls.m_xover34.isValueChanged() )
 	{
-		m_lp3.setLowpass( m_controls.m_xover34.value() );
-		m_hp4.setHighpass( m_controls.m_xover34.value() );
+		for( int ch = 0; ch < 2; ++ch )
+		{
+			m_bands.setLowpass( 4 + ch, m_controls.m_xover34.value() );
+			m_bands.setHighpass( 6 + ch, m_controls.m_xover34.value() );
+		}
 	}
 	
 	// gain values update
@@ -135,64 +126,33 @@ bool CrossoverEQEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 	
 	m_needsUpdate = false;
 	
-	memset( m_work, 0, sizeof( sampleFrame ) * frames );
-	
-	// run temp bands
-	for( int f = 0; f < frames; ++f )
-	{
-		m_tmp1[f][0] = m_lp2.update( buf[f][0], 0 );
-		m_tmp1[f][1] = m_lp2.update( buf[f][1], 1 );
-		m_tmp2[f][0] = m_hp3.update( buf[f][0], 0 );
-		m_tmp2[f][1] = m_hp3.update( buf[f][1], 1 );
-	}
-
-	// run band 1
-	if( mute1 )
-	{
-		for( int f = 0; f < frames; ++f )
-		{
-			m_work[f][0] += m_lp1.update( m_tmp1[f][0], 0 ) * m_gain1;
-			m_work[f][1] += m_lp1.update( m_tmp1[f][1], 1 ) * m_gain1;
-		}
-	}
-	
-	// run band 2
-	if( mute2 )
-	{
-		for( int f = 0; f < frames; ++f )
-		{
-			m_work[f][0] += m_hp2.update( m_tmp1[f][0], 0 ) * m_gain2;
-			m_work[f][1] += m_hp2.update( m_tmp1[f][1], 1 ) * m_gain2;
-		}
-	}
-	
-	// run band 3
-	if( mute3 )
-	{
-		for( int f = 0; f < frames; ++f )
-		{
-			m_work[f][0] += m_lp3.update( m_tmp2[f][0], 0 ) * m_gain3;
-			m_work[f][1] += m_lp3.update( m_tmp2[f][1], 1 ) * m_gain3;
-		}
-	}
-	
-	// run band 4
-	if( mute4 )
-	{
-		for( int f = 0; f < frames; ++f )
-		{
-			m_work[f][0] += m_hp4.update( m_tmp2[f][0], 0 ) * m_gain4;
-			m_work[f][1] += m_hp4.update( m_tmp2[f][1], 1 ) * m_gain4;
-		}
-	}
+	// muted bands are still filtered, so they come back without a
+	// transient from stale filter states
+	const float gain1 = mute1 ? m_gain1 : 0.0f;
+	const float gain2 = mute2 ? m_gain2 : 0.0f;
+	const float gain3 = mute3 ? m_gain3 : 0.0f;
+	const float gain4 = mute4 ? m_gain4 : 0.0f;
 	
 	const float d = dryLevel();
 	const float w = wetLevel();
 	double outSum = 0.0;
 	for( int f = 0; f < frames; ++f )
 	{
-		buf[f][0] = d * buf[f][0] + w * m_work[f][0];
-		buf[f][1] = d * buf[f][1] + w * m_work[f][1];
+		// all filters of a frame in two passes over interleaved lanes
+		const float in[4] = { buf[f][0], buf[f][1], buf[f][0], buf[f][1] };
+		float split[4];
+		m_split.update( in, split );
+
+		const float low[8] = { split[0], split[1], split[0], split[1],
+					split[2], split[3], split[2], split[3] };
+		float bands[8];
+		m_bands.update( low, bands );
+
+		const float outL = bands[0] * gain1 + bands[2] * gain2 + bands[4] * gain3 + bands[6] * gain4;
+		const float outR = bands[1] * gain1 + bands[3] * gain2 + bands[5] * gain3 + bands[7] * gain4;
+
+		buf[f][0] = d * buf[f][0] + w * outL;
+		buf[f][1] = d * buf[f][1] + w * outR;
 		outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
 	}
 	
@@ -203,12 +163,8 @@ bool CrossoverEQEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 
 void CrossoverEQEffect::clearFilterHistories()
 {
-	m_lp1.clearHistory();
-	m_lp2.clearHistory();
-	m_lp3.clearHistory();
-	m_hp2.clearHistory();
-	m_hp3.clearHistory();
-	m_hp4.clearHistory();
+	m_split.clearHistory();
+	m_bands.clearHistory();
 }
 
 
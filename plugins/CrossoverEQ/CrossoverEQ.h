@@ -37,7 +37,6 @@ class CrossoverEQEffect : public Effect
 {
 public:
 	CrossoverEQEffect( Model* parent, const Descriptor::SubPluginFeatures::Key* key );
-	virtual ~CrossoverEQEffect();
 	virtual bool processAudioBuffer( sampleFrame* buf, const fpp_t frames );
 
 	virtual EffectControls* controls()
@@ -59,17 +58,12 @@ private:
 	float m_gain3;
 	float m_gain4;
 	
-	StereoLinkwitzRiley m_lp1;
-	StereoLinkwitzRiley m_lp2;
-	StereoLinkwitzRiley m_lp3;
-	
-	StereoLinkwitzRiley m_hp2;
-	StereoLinkwitzRiley m_hp3;
-	StereoLinkwitzRiley m_hp4;
-	
-	sampleFrame * m_tmp1;
-	sampleFrame * m_tmp2;
-	sampleFrame * m_work;
+	// the crossover at 2/3 splits the input into low and high, in the
+	// lanes lp2 left, lp2 right, hp3 left and hp3 right
+	LinkwitzRileyBank<4> m_split;
+	// then the crossovers at 1/2 and 3/4 split those into the four bands,
+	// in the lanes lp1, hp2, lp3 and hp4, each left and right
+	LinkwitzRileyBank<8> m_bands;
 	
 	bool m_needsUpdate;
 	
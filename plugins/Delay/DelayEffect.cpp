@@ -52,7 +52,7 @@ DelayEffect::DelayEffect( Model* parent, const Plugin::Descriptor::SubPluginFeat
 	m_delayControls( this )
 {
 	m_delay = 0;
-	m_delay = new StereoDelay( 20, Engine::audioEngine()->processingSampleRate() );
+	m_delay = new ModulatedDelay( MaxTime, Engine::audioEngine()->processingSampleRate() );
 	m_lfo = new Lfo( Engine::audioEngine()->processingSampleRate() );
 	m_outGain = 1.0;
 }
@@ -85,7 +85,6 @@ bool DelayEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 	const float sr = Engine::audioEngine()->processingSampleRate();
 	const float d = dryLevel();
 	const float w = wetLevel();
-	sample_t dryS[2];
 	float lPeak = 0.0;
 	float rPeak = 0.0;
 	float length = m_delayControls.m_delayTimeModel.value();
@@ -109,33 +108,58 @@ bool DelayEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 	{
 		m_outGain = dbfsToAmp( m_delayControls.m_outGainModel.value() );
 	}
-	int sampleLength;
-	for( fpp_t f = 0; f < frames; ++f )
+
+	float lfo[BlockSize];
+	sampleFrame lengths[BlockSize];
+	float feedbacks[BlockSize];
+	sampleFrame dryS[BlockSize];
+	for( fpp_t offset = 0; offset < frames; offset += BlockSize )
 	{
-		dryS[0] = buf[f][0];
-		dryS[1] = buf[f][1];
-
-		m_delay->setFeedback( *feedbackPtr );
-		m_lfo->setFrequency( *lfoTimePtr );
-		sampleLength = *lengthPtr * Engine::audioEngine()->processingSampleRate();
-		m_currentLength = sampleLength;
-		m_delay->setLength( m_currentLength + ( *amplitudePtr * ( float )m_lfo->tick() ) );
-		m_delay->tick( buf[f] );
-
-		buf[f][0] *= m_outGain;
-		buf[f][1] *= m_outGain;
-
-		lPeak = buf[f][0] > lPeak ? buf[f][0] : lPeak;
-		rPeak = buf[f][1] > rPeak ? buf[f][1] : rPeak;
-
-		buf[f][0] = ( d * dryS[0] ) + ( w * buf[f][0] );
-		buf[f][1] = ( d * dryS[1] ) + ( w * buf[f][1] );
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
-
-		lengthPtr += lengthInc;
-		amplitudePtr += amplitudeInc;
-		lfoTimePtr += lfoTimeInc;
-		feedbackPtr += feedbackInc;
+		sampleFrame * block = buf + offset;
+		const fpp_t blockFrames = qMin<fpp_t>( BlockSize, frames - offset );
+
+		// the LFO only runs a block at a time while its frequency stays
+		if( lfoTimeBuffer )
+		{
+			for( fpp_t f = 0; f < blockFrames; ++f )
+			{
+				m_lfo->setFrequency( lfoTimePtr[f] );
+				lfo[f] = m_lfo->tick();
+			}
+		}
+		else
+		{
+			m_lfo->setFrequency( *lfoTimePtr );
+			m_lfo->tick( lfo, blockFrames );
+		}
+
+		for( fpp_t f = 0; f < blockFrames; ++f )
+		{
+			const int sampleLength = lengthPtr[f * lengthInc] * sr;
+			lengths[f][0] = lengths[f][1] = sampleLength + ( amplitudePtr[f * amplitudeInc] * lfo[f] );
+			feedbacks[f] = feedbackPtr[f * feedbackInc];
+			dryS[f] = block[f];
+		}
+
+		m_delay->process( block, lengths, feedbacks, blockFrames );
+
+		for( fpp_t f = 0; f < blockFrames; ++f )
+		{
+			block[f][0] *= m_outGain;
+			block[f][1] *= m_outGain;
+
+			lPeak = block[f][0] > lPeak ? block[f][0] : lPeak;
+			rPeak = block[f][1] > rPeak ? block[f][1] : rPeak;
+
+			block[f][0] = ( d * dryS[f][0] ) + ( w * block[f][0] );
+			block[f][1] = ( d * dryS[f][1] ) + ( w * block[f][1] );
+			outSum += block[f][0]*block[f][0] + block[f][1]*block[f][1];
+		}
+
+		lengthPtr += lengthInc * blockFrames;
+		amplitudePtr += amplitudeInc * blockFrames;
+		lfoTimePtr += lfoTimeInc * blockFrames;
+		feedbackPtr += feedbackInc * blockFrames;
 	}
 	checkGate( outSum / frames );
 	m_delayControls.m_outPeakL = lPeak;
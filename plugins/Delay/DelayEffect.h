@@ -28,7 +28,7 @@
 #include "Effect.h"
 #include "DelayControls.h"
 #include "Lfo.h"
-#include "StereoDelay.h"
+#include "ModulatedDelay.h"
 #include "ValueBuffer.h"
 
 class DelayEffect : public Effect
@@ -44,11 +44,15 @@ public:
 	void changeSampleRate();
 
 private:
+	// frames processed at a time
+	static constexpr fpp_t BlockSize = 64;
+	// the longest delay time plus the LFO amount, in seconds
+	static constexpr float MaxTime = 5.5f;
+
 	DelayControls m_delayControls;
-	StereoDelay* m_delay;
+	ModulatedDelay* m_delay;
 	Lfo* m_lfo;
 	float m_outGain;
-	float m_currentLength;
 };
 
 #endif // DELAYEFFECT_H
@@ -28,7 +28,10 @@
 
 
 
-Lfo::Lfo( int samplerate )
+Lfo::Lfo( int samplerate ) :
+	m_frequency( 0 ),
+	m_phase( 0 ),
+	m_increment( 0 )
 {
 	m_samplerate = samplerate;
 	m_twoPiOverSr = F_2PI / samplerate;
@@ -44,3 +47,20 @@ float Lfo::tick()
 
 	return output;
 }
+
+
+
+
+void Lfo::tick( float * out, fpp_t frames )
+{
+	double sinPhase = sin( m_phase ), cosPhase = cos( m_phase );
+	const double sinInc = sin( m_increment ), cosInc = cos( m_increment );
+	for( fpp_t f = 0; f < frames; ++f )
+	{
+		out[f] = sinPhase;
+		const double nextSin = sinPhase * cosInc + cosPhase * sinInc;
+		cosPhase = cosPhase * cosInc - sinPhase * sinInc;
+		sinPhase = nextSin;
+	}
+	m_phase = fmod( m_phase + frames * m_increment, F_2PI );
+}
@@ -25,6 +25,7 @@
 #ifndef LFO_H
 #define LFO_H
 
+#include "lmms_basics.h"
 #include "lmms_math.h"
 
 class Lfo
@@ -67,6 +68,9 @@ public:
 
 
 	float tick();
+	//! Like tick() for @p frames frames. The sine is only computed at the
+	//! start of the block and then rotated by the increment for each frame.
+	void tick( float * out, fpp_t frames );
 
 private:
 	double m_frequency;
@@ -25,6 +25,8 @@
 
 #include "DualFilter.h"
 
+#include <algorithm>
+
 #include "embed.h"
 #include "BasicFilters.h"
 #include "plugin_export.h"
@@ -53,8 +55,8 @@ DualFilterEffect::DualFilterEffect( Model* parent, const Descriptor::SubPluginFe
 	Effect( &dualfilter_plugin_descriptor, parent, key ),
 	m_dfControls( this )
 {
-	m_filter1 = new BasicFilters<2>( Engine::audioEngine()->processingSampleRate() );
-	m_filter2 = new BasicFilters<2>( Engine::audioEngine()->processingSampleRate() );
+	m_filter1 = new BasicFilters<2>( sampleRate() );
+	m_filter2 = new BasicFilters<2>( sampleRate() );
 
 	// ensure filters get updated
 	m_filter1changed = true;
@@ -119,94 +121,107 @@ bool DualFilterEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames
 	int gain2Inc = gain2Buffer ? 1 : 0;
 	int mixInc = mixBuffer ? 1 : 0;
 
-	float *cut1Ptr = cut1Buffer ? &( cut1Buffer->values()[ 0 ] ) : &cut1;
-	float *res1Ptr = res1Buffer ? &( res1Buffer->values()[ 0 ] ) : &res1;
-	float *gain1Ptr = gain1Buffer ? &( gain1Buffer->values()[ 0 ] ) : &gain1;
-	float *cut2Ptr = cut2Buffer ? &( cut2Buffer->values()[ 0 ] ) : &cut2;
-	float *res2Ptr = res2Buffer ? &( res2Buffer->values()[ 0 ] ) : &res2;
-	float *gain2Ptr = gain2Buffer ? &( gain2Buffer->values()[ 0 ] ) : &gain2;
-	float *mixPtr = mixBuffer ? &( mixBuffer->values()[ 0 ] ) : &mix;
+	const float *cut1Ptr = cut1Buffer ? &( cut1Buffer->values()[ 0 ] ) : &cut1;
+	const float *res1Ptr = res1Buffer ? &( res1Buffer->values()[ 0 ] ) : &res1;
+	const float *gain1Ptr = gain1Buffer ? &( gain1Buffer->values()[ 0 ] ) : &gain1;
+	const float *cut2Ptr = cut2Buffer ? &( cut2Buffer->values()[ 0 ] ) : &cut2;
+	const float *res2Ptr = res2Buffer ? &( res2Buffer->values()[ 0 ] ) : &res2;
+	const float *gain2Ptr = gain2Buffer ? &( gain2Buffer->values()[ 0 ] ) : &gain2;
+	const float *mixPtr = mixBuffer ? &( mixBuffer->values()[ 0 ] ) : &mix;
 
 	const bool enabled1 = m_dfControls.m_enabled1Model.value();
 	const bool enabled2 = m_dfControls.m_enabled2Model.value();
 
-	
-	
-
-	// buffer processing loop
-	for( fpp_t f = 0; f < frames; ++f )
+	// the coefficients only have to be checked within the period if cut or
+	// res are automated, or the filter has changed since the last period
+	const bool update1 = m_filter1changed || cut1Buffer || res1Buffer ||
+				cut1 != m_currentCut1 || res1 != m_currentRes1;
+	const bool update2 = m_filter2changed || cut2Buffer || res2Buffer ||
+				cut2 != m_currentCut2 || res2 != m_currentRes2;
+
+	const fpp_t interval = Engine::audioEngine()->filterControlInterval();
+
+	// filters the frames [start, end) of the period, which were copied to
+	// out. The coefficients are recalculated once per run of the control
+	// interval, from cut and res in the middle of the run, and only when
+	// these differ from the last ones.
+	auto filterFrames = [&]( BasicFilters<2> * filter, bool & changed,
+				float & currentCut, float & currentRes,
+				const float * cut, int cutInc, const float * res, int resInc,
+				bool update, sampleFrame * out, fpp_t start, fpp_t end )
 	{
-		// get mix amounts for wet signals of both filters
-		const float mix2 = ( ( *mixPtr + 1.0f ) * 0.5f );
-		const float mix1 = 1.0f - mix2;
-		const float gain1 = *gain1Ptr * 0.01f;
-		const float gain2 = *gain2Ptr * 0.01f;
-		sample_t s[2] = { 0.0f, 0.0f };	// mix
-		sample_t s1[2] = { buf[f][0], buf[f][1] };	// filter 1
-		sample_t s2[2] = { buf[f][0], buf[f][1] };	// filter 2
-
-		// update filter 1
-		if( enabled1 )
+		if( !update )
+		{
+			filter->process( out, end - start );
+			return;
+		}
+		for( fpp_t f = start; f < end; )
 		{
-			//update filter 1 params here
-			// recalculate only when necessary: either cut/res is changed, or the changed-flag is set (filter type or samplerate changed)
-			if( ( ( *cut1Ptr != m_currentCut1 ||
-				*res1Ptr != m_currentRes1 ) ) || m_filter1changed )
+			const fpp_t runStart = f / interval * interval;
+			const fpp_t runEnd = qMin<fpp_t>( runStart + interval, end );
+			const fpp_t middle = qMin<fpp_t>( runStart + interval / 2, frames - 1 );
+			const float c = cut[middle * cutInc];
+			const float r = res[middle * resInc];
+			if( c != currentCut || r != currentRes || changed )
 			{
-				m_filter1->calcFilterCoeffs( *cut1Ptr, *res1Ptr );
-				m_filter1changed = false;
-				m_currentCut1 = *cut1Ptr;
-				m_currentRes1 = *res1Ptr;
+				filter->calcFilterCoeffs( c, r );
+				changed = false;
+				currentCut = c;
+				currentRes = r;
 			}
-			s1[0] = m_filter1->update( s1[0], 0 );
-			s1[1] = m_filter1->update( s1[1], 1 );
+			filter->process( out + ( f - start ), runEnd - f );
+			f = runEnd;
+		}
+	};
 
-			// apply gain
-			s1[0] *= gain1;
-			s1[1] *= gain1;
+	sampleFrame s1[BlockSize];	// filter 1
+	sampleFrame s2[BlockSize];	// filter 2
 
-			// apply mix
-			s[0] += ( s1[0] * mix1 );
-			s[1] += ( s1[1] * mix1 );
-		}
+	// buffer processing loop
+	for( fpp_t start = 0; start < frames; start += BlockSize )
+	{
+		const fpp_t end = qMin<fpp_t>( start + BlockSize, frames );
 
-		// update filter 2
+		if( enabled1 )
+		{
+			std::copy( buf + start, buf + end, s1 );
+			filterFrames( m_filter1, m_filter1changed, m_currentCut1, m_currentRes1,
+					cut1Ptr, cut1Inc, res1Ptr, res1Inc, update1, s1, start, end );
+		}
 		if( enabled2 )
 		{
-			//update filter 2 params here
-			if( ( ( *cut2Ptr != m_currentCut2 ||
-								*res2Ptr != m_currentRes2 ) ) || m_filter2changed )
+			std::copy( buf + start, buf + end, s2 );
+			filterFrames( m_filter2, m_filter2changed, m_currentCut2, m_currentRes2,
+					cut2Ptr, cut2Inc, res2Ptr, res2Inc, update2, s2, start, end );
+		}
+
+		for( fpp_t f = start; f < end; ++f )
+		{
+			const fpp_t i = f - start;
+			// get mix amounts for wet signals of both filters
+			const float mix2 = ( ( mixPtr[f * mixInc] + 1.0f ) * 0.5f );
+			const float mix1 = 1.0f - mix2;
+			const float gain1 = gain1Ptr[f * gain1Inc] * 0.01f;
+			const float gain2 = gain2Ptr[f * gain2Inc] * 0.01f;
+			sample_t s[2] = { 0.0f, 0.0f };	// mix
+
+			if( enabled1 )
 			{
-				m_filter2->calcFilterCoeffs( *cut2Ptr, *res2Ptr );
-				m_filter2changed = false;
-				m_currentCut2 = *cut2Ptr;
-				m_currentRes2 = *res2Ptr;
+				// apply gain and mix
+				s[0] += ( s1[i][0] * gain1 ) * mix1;
+				s[1] += ( s1[i][1] * gain1 ) * mix1;
+			}
+			if( enabled2 )
+			{
+				s[0] += ( s2[i][0] * gain2 ) * mix2;
+				s[1] += ( s2[i][1] * gain2 ) * mix2;
 			}
-			s2[0] = m_filter2->update( s2[0], 0 );
-			s2[1] = m_filter2->update( s2[1], 1 );
-
-			//apply gain
-			s2[0] *= gain2;
-			s2[1] *= gain2;
 
-			// apply mix
-			s[0] += ( s2[0] * mix2 );
-			s[1] += ( s2[1] * mix2 );
+			// do another mix with dry signal
+			buf[f][0] = d * buf[f][0] + w * s[0];
+			buf[f][1] = d * buf[f][1] + w * s[1];
+			outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
 		}
-
-		// do another mix with dry signal
-		buf[f][0] = d * buf[f][0] + w * s[0];
-		buf[f][1] = d * buf[f][1] + w * s[1];
-		outSum += buf[f][0] * buf[f][0] + buf[f][1] * buf[f][1];
-
-		//increment pointers
-		cut1Ptr += cut1Inc;
-		res1Ptr += res1Inc;
-		gain1Ptr += gain1Inc;
-		cut2Ptr += cut2Inc;
-		res2Ptr += res2Inc;
-		gain2Ptr += gain2Inc;
-		mixPtr += mixInc;
 	}
 
 	checkGate( outSum / frames );
@@ -43,8 +43,16 @@ public:
 		return &m_dfControls;
 	}
 
+	bool supportsOversampling() const override
+	{
+		return true;
+	}
+
 
 private:
+	//! frames filtered at once
+	static constexpr fpp_t BlockSize = 64;
+
 	DualFilterControls m_dfControls;
 
 	BasicFilters<2> * m_filter1;
@@ -202,3 +202,71 @@ void EqControls::saveSettings( QDomDocument &doc, QDomElement &parent )
 	m_analyseInModel.saveSettings( doc, parent, "AnalyseIn" );
 	m_analyseOutModel.saveSettings( doc, parent, "AnalyseOut" );
 }
+
+
+
+
+float EqControls::peakBand( float minF, float maxF, EqAnalyser *fft )
+{
+	float peak = -60;
+	float *b = fft->m_bands;
+	float h = 0;
+	const int sr = fft->getSampleRate();
+	for( int x = 0; x < MAX_BANDS; x++, b++ )
+	{
+		const float freq = x * sr / ( MAX_BANDS * 2 );
+		if( freq >= minF && freq <= maxF )
+		{
+			h = 20 * ( log10( *b / fft->getEnergy() ) );
+			peak = h > peak ? h : peak;
+		}
+	}
+
+	return ( peak + 60 ) / 100;
+}
+
+
+
+
+void EqControls::setBandPeaks( EqAnalyser *fft )
+{
+	m_lowShelfPeakR = m_lowShelfPeakL =
+			peakBand( m_lowShelfFreqModel.value()
+					  * ( 1 - m_lowShelfResModel.value() * 0.5 ),
+					  m_lowShelfFreqModel.value(),
+					  fft );
+
+	m_para1PeakL = m_para1PeakR =
+			peakBand( m_para1FreqModel.value()
+					  * ( 1 - m_para1BwModel.value() * 0.5 ),
+					  m_para1FreqModel.value()
+					  * ( 1 + m_para1BwModel.value() * 0.5 ),
+					  fft );
+
+	m_para2PeakL = m_para2PeakR =
+			peakBand( m_para2FreqModel.value()
+					  * ( 1 - m_para2BwModel.value() * 0.5 ),
+					  m_para2FreqModel.value()
+					  * ( 1 + m_para2BwModel.value() * 0.5 ),
+					  fft );
+
+	m_para3PeakL = m_para3PeakR =
+			peakBand( m_para3FreqModel.value()
+					  * ( 1 - m_para3BwModel.value() * 0.5 ),
+					  m_para3FreqModel.value()
+					  * ( 1 + m_para3BwModel.value() * 0.5 ),
+					  fft );
+
+	m_para4PeakL = m_para4PeakR =
+			peakBand( m_para4FreqModel.value()
+					  * ( 1 - m_para4BwModel.value() * 0.5 ),
+					  m_para4FreqModel.value()
+					  * ( 1 + m_para4BwModel.value() * 0.5 ),
+					  fft );
+
+	m_highShelfPeakL = m_highShelfPeakR =
+			peakBand( m_highShelfFreqModel.value(),
+					  m_highShelfFreqModel.value()
+					  * ( 1 + m_highShelfResModel.value() * 0.5 ),
+					  fft );
+}
@@ -126,6 +126,10 @@ private:
 	BoolModel m_analyseInModel;
 	BoolModel m_analyseOutModel;
 
+	float peakBand( float minF, float maxF, EqAnalyser * );
+	// GUI thread, after the output analyser got new bands
+	void setBandPeaks( EqAnalyser * fft );
+
 	friend class EqControlsDialog;
 	friend class EqEffect;
 };
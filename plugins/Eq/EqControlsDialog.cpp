@@ -60,6 +60,10 @@ EqControlsDialog::EqControlsDialog( EqControls *controls ) :
 	EqSpectrumView * outSpec = new EqSpectrumView( &controls->m_outFftBands, this );
 	outSpec->setColor( QColor( 0, 255, 239, 150 ) );
 	outSpec->move( 26, 17 );
+	connect( outSpec, &EqSpectrumView::spectrumUpdated, [controls]()
+	{
+		controls->setBandPeaks( &controls->m_outFftBands );
+	} );
 
 	m_parameterWidget = new EqParameterWidget( this , controls );
 	m_parameterWidget->move( 26, 17 );
@@ -76,7 +76,6 @@ bool EqEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 	//wet/dry controls
 	const float dry = dryLevel();
 	const float wet = wetLevel();
-	sample_t dryS[2];
 	// setup sample exact controls
 	float hpRes = m_eqControls.m_hpResModel.value();
 	float lowShelfRes = m_eqControls.m_lowShelfResModel.value();
@@ -164,108 +163,101 @@ bool EqEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 	const float outGain =  m_outGain;
 	sampleFrame m_inPeak = { 0, 0 };
 
-	if(m_eqControls.m_analyseInModel.value( true ) &&  outSum > 0 && m_eqControls.isViewVisible()  )
+	// the analysers are only active while their view is visible
+	if( m_eqControls.m_inFftBands.getActive() )
 	{
-		m_eqControls.m_inFftBands.analyze( buf, frames );
-	}
-	else
-	{
-		m_eqControls.m_inFftBands.clear();
+		if( m_eqControls.m_analyseInModel.value( true ) && outSum > 0 )
+		{
+			m_eqControls.m_inFftBands.write( buf, frames );
+		}
+		else
+		{
+			m_eqControls.m_inFftBands.requestClear();
+		}
 	}
 
 	gain( buf, frames, m_inGain, &m_inPeak );
 	m_eqControls.m_inPeakL = m_eqControls.m_inPeakL < m_inPeak[0] ? m_inPeak[0] : m_eqControls.m_inPeakL;
 	m_eqControls.m_inPeakR = m_eqControls.m_inPeakR < m_inPeak[1] ? m_inPeak[1] : m_eqControls.m_inPeakR;
 
-	float periodProgress = 0.0f; // percentage of period processed
-	for( fpp_t f = 0; f < frames; ++f)
+	// every active filter runs over a block before the next one does
+	for( fpp_t offset = 0; offset < frames; offset += EqFilter::MaxBlockSize )
 	{
-		periodProgress = (float)f / (float)(frames-1);
+		sampleFrame * block = buf + offset;
+		const fpp_t blockFrames = qMin<fpp_t>( EqFilter::MaxBlockSize, frames - offset );
+
 		//wet dry buffer
-		dryS[0] = buf[f][0];
-		dryS[1] = buf[f][1];
+		sampleFrame dryS[EqFilter::MaxBlockSize];
+		memcpy( dryS, block, sizeof( sampleFrame ) * blockFrames );
+
 		if( hpActive )
 		{
-			buf[f][0] = m_hp12.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_hp12.update( buf[f][1], 1, periodProgress );
+			m_hp12.processBlock( block, blockFrames, offset, frames );
 
 			if( hp24Active || hp48Active )
 			{
-				buf[f][0] = m_hp24.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_hp24.update( buf[f][1], 1, periodProgress );
+				m_hp24.processBlock( block, blockFrames, offset, frames );
 			}
 
 			if( hp48Active )
 			{
-				buf[f][0] = m_hp480.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_hp480.update( buf[f][1], 1, periodProgress );
-
-				buf[f][0] = m_hp481.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_hp481.update( buf[f][1], 1, periodProgress );
+				m_hp480.processBlock( block, blockFrames, offset, frames );
+				m_hp481.processBlock( block, blockFrames, offset, frames );
 			}
 		}
 
 		if( lowShelfActive )
 		{
-			buf[f][0] = m_lowShelf.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_lowShelf.update( buf[f][1], 1, periodProgress );
+			m_lowShelf.processBlock( block, blockFrames, offset, frames );
 		}
 
 		if( para1Active )
 		{
-			buf[f][0] = m_para1.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_para1.update( buf[f][1], 1, periodProgress );
+			m_para1.processBlock( block, blockFrames, offset, frames );
 		}
 
 		if( para2Active )
 		{
-			buf[f][0] = m_para2.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_para2.update( buf[f][1], 1, periodProgress );
+			m_para2.processBlock( block, blockFrames, offset, frames );
 		}
 
 		if( para3Active )
 		{
-			buf[f][0] = m_para3.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_para3.update( buf[f][1], 1, periodProgress );
+			m_para3.processBlock( block, blockFrames, offset, frames );
 		}
 
 		if( para4Active )
 		{
-			buf[f][0] = m_para4.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_para4.update( buf[f][1], 1, periodProgress );
+			m_para4.processBlock( block, blockFrames, offset, frames );
 		}
 
 		if( highShelfActive )
 		{
-			buf[f][0] = m_highShelf.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_highShelf.update( buf[f][1], 1, periodProgress );
+			m_highShelf.processBlock( block, blockFrames, offset, frames );
 		}
 
-		if( lpActive ){
-			buf[f][0] = m_lp12.update( buf[f][0], 0, periodProgress );
-			buf[f][1] = m_lp12.update( buf[f][1], 1, periodProgress );
+		if( lpActive )
+		{
+			m_lp12.processBlock( block, blockFrames, offset, frames );
 
 			if( lp24Active || lp48Active )
 			{
-				buf[f][0] = m_lp24.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_lp24.update( buf[f][1], 1, periodProgress );
+				m_lp24.processBlock( block, blockFrames, offset, frames );
 			}
 
 			if( lp48Active )
 			{
-				buf[f][0] = m_lp480.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_lp480.update( buf[f][1], 1, periodProgress );
-
-				buf[f][0] = m_lp481.update( buf[f][0], 0, periodProgress );
-				buf[f][1] = m_lp481.update( buf[f][1], 1, periodProgress );
+				m_lp480.processBlock( block, blockFrames, offset, frames );
+				m_lp481.processBlock( block, blockFrames, offset, frames );
 			}
 		}
 
 		//apply wet / dry levels
-		buf[f][1] = ( dry * dryS[1] ) + ( wet * buf[f][1] );
-		buf[f][0] = ( dry * dryS[0] ) + ( wet * buf[f][0] );
-
-
+		for( fpp_t f = 0; f < blockFrames; ++f )
+		{
+			block[f][1] = ( dry * dryS[f][1] ) + ( wet * block[f][1] );
+			block[f][0] = ( dry * dryS[f][0] ) + ( wet * block[f][0] );
+		}
 	}
 
 	sampleFrame outPeak = { 0, 0 };
@@ -275,86 +267,25 @@ bool EqEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 
 	checkGate( outSum / frames );
 
-	if(m_eqControls.m_analyseOutModel.value( true ) && outSum > 0 && m_eqControls.isViewVisible() )
-	{
-		m_eqControls.m_outFftBands.analyze( buf, frames );
-		setBandPeaks( &m_eqControls.m_outFftBands , ( int )( sampleRate ) );
-	}
-	else
+	if( m_eqControls.m_outFftBands.getActive() )
 	{
-		m_eqControls.m_outFftBands.clear();
-	}
-
-	m_eqControls.m_inProgress = false;
-	return isRunning();
-}
-
-
-
-
-float EqEffect::peakBand( float minF, float maxF, EqAnalyser *fft, int sr )
-{
-	float peak = -60;
-	float *b = fft->m_bands;
-	float h = 0;
-	for( int x = 0; x < MAX_BANDS; x++, b++ )
-	{
-		if( bandToFreq( x ,sr) >= minF && bandToFreq( x,sr ) <= maxF )
+		if( m_eqControls.m_analyseOutModel.value( true ) && outSum > 0 )
+		{
+			m_eqControls.m_outFftBands.write( buf, frames );
+		}
+		else
 		{
-			h = 20 * ( log10( *b / fft->getEnergy() ) );
-			peak = h > peak ? h : peak;
+			m_eqControls.m_outFftBands.requestClear();
 		}
 	}
 
-	return ( peak + 60 ) / 100;
+	m_eqControls.m_inProgress = false;
+	return isRunning();
 }
 
 
 
 
-void EqEffect::setBandPeaks( EqAnalyser *fft, int samplerate )
-{
-	m_eqControls.m_lowShelfPeakR = m_eqControls.m_lowShelfPeakL =
-			peakBand( m_eqControls.m_lowShelfFreqModel.value()
-					  * ( 1 - m_eqControls.m_lowShelfResModel.value() * 0.5 ),
-					  m_eqControls.m_lowShelfFreqModel.value(),
-					  fft , samplerate );
-
-	m_eqControls.m_para1PeakL = m_eqControls.m_para1PeakR =
-			peakBand( m_eqControls.m_para1FreqModel.value()
-					  * ( 1 - m_eqControls.m_para1BwModel.value() * 0.5 ),
-					  m_eqControls.m_para1FreqModel.value()
-					  * ( 1 + m_eqControls.m_para1BwModel.value() * 0.5 ),
-					  fft , samplerate );
-
-	m_eqControls.m_para2PeakL = m_eqControls.m_para2PeakR =
-			peakBand( m_eqControls.m_para2FreqModel.value()
-					  * ( 1 - m_eqControls.m_para2BwModel.value() * 0.5 ),
-					  m_eqControls.m_para2FreqModel.value()
-					  * ( 1 + m_eqControls.m_para2BwModel.value() * 0.5 ),
-					  fft , samplerate );
-
-	m_eqControls.m_para3PeakL = m_eqControls.m_para3PeakR =
-			peakBand( m_eqControls.m_para3FreqModel.value()
-					  * ( 1 - m_eqControls.m_para3BwModel.value() * 0.5 ),
-					  m_eqControls.m_para3FreqModel.value()
-					  * ( 1 + m_eqControls.m_para3BwModel.value() * 0.5 ),
-					  fft , samplerate );
-
-	m_eqControls.m_para4PeakL = m_eqControls.m_para4PeakR =
-			peakBand( m_eqControls.m_para4FreqModel.value()
-					  * ( 1 - m_eqControls.m_para4BwModel.value() * 0.5 ),
-					  m_eqControls.m_para4FreqModel.value()
-					  * ( 1 + m_eqControls.m_para4BwModel.value() * 0.5 ),
-					  fft , samplerate );
-
-	m_eqControls.m_highShelfPeakL = m_eqControls.m_highShelfPeakR =
-			peakBand( m_eqControls.m_highShelfFreqModel.value(),
-					  m_eqControls.m_highShelfFreqModel.value()
-					  * ( 1 + m_eqControls.m_highShelfResModel.value() * 0.5 ),
-					  fft, samplerate );
-}
-
 extern "C"
 {
 
@@ -25,14 +25,16 @@
 #ifndef EQFILTER_H
 #define EQFILTER_H
 
+#include <cstring>
+
 #include "BasicFilters.h"
 #include "lmms_math.h"
 
 ///
 /// \brief The EqFilter class.
 /// A wrapper for the StereoBiQuad class, giving it freq, res, and gain controls.
-/// Used on a per channel per frame basis with recalculation of coefficents
-/// upon parameter changes. The intention is to use this as a bass class, children override
+/// Used on blocks of frames with recalculation of coefficents upon parameter
+/// changes. The intention is to use this as a bass class, children override
 /// the calcCoefficents() function, providing the coefficents a1, a2, b0, b1, b2.
 ///
 class EqFilter
@@ -43,9 +45,11 @@ public:
 		m_freq(0),
 		m_res(0),
 		m_gain(0),
-		m_bw(0)
+		m_bw(0),
+		m_crossfading(false)
 	{
-
+		// silent until the first coefficents are set, which fade in
+		m_biQuadFrameTarget.setCoeffs( 0, 0, 0, 0, 0 );
 	}
 
 
@@ -115,28 +119,43 @@ public:
 
 
 	///
-	/// \brief update
-	/// filters using two BiQuads, then crossfades,
-	///  depending on on percentage of period processes
-	/// \param in
-	/// \param ch
-	/// \param frameProgress percentage of frame processed
-	/// \return
+	/// \brief processBlock
+	/// filters a block of frames of the period. While the coefficents change,
+	/// two BiQuads run and the output crossfades from the old to the new ones
+	/// over the period, otherwise only one runs.
+	/// \param buf frames to filter in place
+	/// \param frames number of frames in the block
+	/// \param offset index of the first frame of the block in the period
+	/// \param periodFrames number of frames in the period
 	///
-	inline float update( float in, ch_cnt_t ch, float frameProgress)
+	inline void processBlock( sampleFrame * buf, fpp_t frames, fpp_t offset, fpp_t periodFrames )
 	{
-		float initailF =  m_biQuadFrameInitial.update( in, ch );
-		float targetF = m_biQuadFrameTarget.update( in, ch );
-
-		if(frameProgress > 0.99999 )
+		if( !m_crossfading )
 		{
-			m_biQuadFrameInitial= m_biQuadFrameTarget;
+			m_biQuadFrameTarget.update( buf[0].data(), frames );
+			return;
 		}
 
-		return (1.0f-frameProgress) * initailF + frameProgress * targetF;
+		sampleFrame initial[MaxBlockSize];
+		memcpy( initial, buf, sizeof( sampleFrame ) * frames );
+		m_biQuadFrameInitial.update( initial[0].data(), frames );
+		m_biQuadFrameTarget.update( buf[0].data(), frames );
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			const float frameProgress = (float)( offset + f ) / (float)( periodFrames - 1 );
+			buf[f][0] = ( 1.0f - frameProgress ) * initial[f][0] + frameProgress * buf[f][0];
+			buf[f][1] = ( 1.0f - frameProgress ) * initial[f][1] + frameProgress * buf[f][1];
+		}
 
+		if( offset + frames >= periodFrames )
+		{
+			m_crossfading = false;
+		}
 	}
 
+	//! Blocks passed to processBlock() must not be longer
+	static constexpr fpp_t MaxBlockSize = 64;
+
 
 protected:
 	///
@@ -150,6 +169,13 @@ protected:
 
 	inline void setCoeffs( float a1, float a2, float b0, float b1, float b2 )
 	{
+		// crossfade from the coefficents used last, changes before the
+		// period is processed only replace the target
+		if( !m_crossfading )
+		{
+			m_biQuadFrameInitial = m_biQuadFrameTarget;
+			m_crossfading = true;
+		}
 		m_biQuadFrameTarget.setCoeffs( a1, a2, b0, b1, b2 );
 	}
 
@@ -165,6 +191,8 @@ protected:
 	float m_bw;
 	StereoBiQuad m_biQuadFrameInitial;
 	StereoBiQuad m_biQuadFrameTarget;
+	// whether the period crossfades from m_biQuadFrameInitial to m_biQuadFrameTarget
+	bool m_crossfading;
 };
 
 
@@ -25,6 +25,7 @@
 #include "AudioEngine.h"
 #include "Engine.h"
 #include "EqCurve.h"
+#include "FftPlanCache.h"
 #include "GuiApplication.h"
 #include "MainWindow.h"
 
@@ -32,11 +33,14 @@ EqAnalyser::EqAnalyser() :
 	m_framesFilledUp ( 0 ),
 	m_energy ( 0 ),
 	m_sampleRate ( 1 ),
-	m_active ( true )
+	m_active ( false ),
+	m_clearRequested ( false ),
+	// room for the frames of a few periods, in case the GUI thread is busy
+	m_inputBuffer ( FFT_BUFFER_SIZE * 4 ),
+	m_inputReader ( m_inputBuffer )
 {
-	m_inProgress=false;
 	m_specBuf = ( fftwf_complex * ) fftwf_malloc( ( FFT_BUFFER_SIZE + 1 ) * sizeof( fftwf_complex ) );
-	m_fftPlan = fftwf_plan_dft_r2c_1d( FFT_BUFFER_SIZE*2, m_buffer, m_specBuf, FFTW_MEASURE );
+	m_fftPlan = FftPlanCache::realToComplex( FFT_BUFFER_SIZE*2, m_buffer, m_specBuf );
 
 	//initialize Blackman-Harris window, constants taken from
 	//https://en.wikipedia.org/wiki/Window_function#A_list_of_window_functions
@@ -59,63 +63,78 @@ EqAnalyser::EqAnalyser() :
 
 EqAnalyser::~EqAnalyser()
 {
-	fftwf_destroy_plan( m_fftPlan );
 	fftwf_free( m_specBuf );
 }
 
 
 
 
-void EqAnalyser::analyze( sampleFrame *buf, const fpp_t frames )
+void EqAnalyser::write( const sampleFrame *buf, const fpp_t frames )
 {
-	//only analyse if the view is visible
-	if ( m_active )
-	{
-		m_inProgress=true;
-		const int FFT_BUFFER_SIZE = 2048;
-		fpp_t f = 0;
-		if( frames > FFT_BUFFER_SIZE )
-		{
-			m_framesFilledUp = 0;
-			f = frames - FFT_BUFFER_SIZE;
-		}
-		// meger channels
-		for( ; f < frames; ++f )
-		{
-			m_buffer[m_framesFilledUp] =
-					( buf[f][0] + buf[f][1] ) * 0.5;
-			++m_framesFilledUp;
-		}
+	m_inputBuffer.write( buf, frames );
+}
 
-		if( m_framesFilledUp < FFT_BUFFER_SIZE )
-		{
-			m_inProgress = false;
-			return;
-		}
 
-		m_sampleRate = Engine::audioEngine()->processingSampleRate();
-		const int LOWEST_FREQ = 0;
-		const int HIGHEST_FREQ = m_sampleRate / 2;
 
-		//apply FFT window
-		for( int i = 0; i < FFT_BUFFER_SIZE; i++ )
-		{
-			m_buffer[i] = m_buffer[i] * m_fftWindow[i];
-		}
 
-		fftwf_execute( m_fftPlan );
-		absspec( m_specBuf, m_absSpecBuf, FFT_BUFFER_SIZE+1 );
+void EqAnalyser::requestClear()
+{
+	m_clearRequested.store( true, std::memory_order_relaxed );
+}
+
+
 
-		compressbands( m_absSpecBuf, m_bands, FFT_BUFFER_SIZE+1,
-					   MAX_BANDS,
-					   ( int )( LOWEST_FREQ * ( FFT_BUFFER_SIZE + 1 ) / ( float )( m_sampleRate / 2 ) ),
-					   ( int )( HIGHEST_FREQ * ( FFT_BUFFER_SIZE +  1) / ( float )( m_sampleRate / 2 ) ) );
-		m_energy = maximum( m_bands, MAX_BANDS ) / maximum( m_buffer, FFT_BUFFER_SIZE );
 
+bool EqAnalyser::analyze()
+{
+	if( m_clearRequested.exchange( false, std::memory_order_relaxed ) )
+	{
+		clear();
+	}
+
+	auto frames = m_inputReader.read_max( m_inputBuffer.capacity() );
+	const std::size_t count = frames.size();
+	std::size_t f = 0;
+	// only the latest frames make it into the spectrum
+	if( count > FFT_BUFFER_SIZE )
+	{
 		m_framesFilledUp = 0;
-		m_inProgress = false;
-		m_active = false;
+		f = count - FFT_BUFFER_SIZE;
+	}
+	// meger channels
+	for( ; f < count && m_framesFilledUp < FFT_BUFFER_SIZE; ++f )
+	{
+		m_buffer[m_framesFilledUp] =
+				( frames[f][0] + frames[f][1] ) * 0.5;
+		++m_framesFilledUp;
+	}
+
+	if( m_framesFilledUp < FFT_BUFFER_SIZE )
+	{
+		return false;
+	}
+
+	m_sampleRate = Engine::audioEngine()->processingSampleRate();
+	const int LOWEST_FREQ = 0;
+	const int HIGHEST_FREQ = m_sampleRate / 2;
+
+	//apply FFT window
+	for( int i = 0; i < FFT_BUFFER_SIZE; i++ )
+	{
+		m_buffer[i] = m_buffer[i] * m_fftWindow[i];
 	}
+
+	fftwf_execute_dft_r2c( m_fftPlan, m_buffer, m_specBuf );
+	absspec( m_specBuf, m_absSpecBuf, FFT_BUFFER_SIZE+1 );
+
+	compressbands( m_absSpecBuf, m_bands, FFT_BUFFER_SIZE+1,
+				   MAX_BANDS,
+				   ( int )( LOWEST_FREQ * ( FFT_BUFFER_SIZE + 1 ) / ( float )( m_sampleRate / 2 ) ),
+				   ( int )( HIGHEST_FREQ * ( FFT_BUFFER_SIZE +  1) / ( float )( m_sampleRate / 2 ) ) );
+	m_energy = maximum( m_bands, MAX_BANDS ) / maximum( m_buffer, FFT_BUFFER_SIZE );
+
+	m_framesFilledUp = 0;
+	return true;
 }
 
 
@@ -139,7 +158,7 @@ int EqAnalyser::getSampleRate() const
 
 bool EqAnalyser::getActive() const
 {
-	return m_active;
+	return m_active.load( std::memory_order_relaxed );
 }
 
 
@@ -147,15 +166,14 @@ bool EqAnalyser::getActive() const
 
 void EqAnalyser::setActive(bool active)
 {
-	m_active = active;
-}
-
-
-
-
-bool EqAnalyser::getInProgress()
-{
-	return m_inProgress;
+	if( active && !getActive() )
+	{
+		// drop what is left from the last time the view was shown
+		m_inputReader.read_max( m_inputBuffer.capacity() );
+		m_clearRequested.store( false, std::memory_order_relaxed );
+		clear();
+	}
+	m_active.store( active, std::memory_order_relaxed );
 }
 
 
@@ -209,7 +227,7 @@ void EqSpectrumView::paintEvent(QPaintEvent *event)
 	painter.setPen( QPen( m_color, 1, Qt::SolidLine, Qt::RoundCap, Qt::BevelJoin ) );
 	painter.setRenderHint(QPainter::Antialiasing, true);
 
-	if( m_analyser->getInProgress() || m_periodicalUpdate == false )
+	if( m_periodicalUpdate == false )
 	{
 		//only paint the cached path
 		painter.fillPath( m_path, QBrush( m_color ) );
@@ -289,7 +307,11 @@ float EqSpectrumView::bandToFreq( int index )
 
 void EqSpectrumView::periodicalUpdate()
 {
-	m_periodicalUpdate = true;
 	m_analyser->setActive( isVisible() );
+	if( m_analyser->getActive() && m_analyser->analyze() )
+	{
+		emit spectrumUpdated();
+	}
+	m_periodicalUpdate = true;
 	update();
 }
@@ -23,6 +23,7 @@
 #ifndef EQSPECTRUMVIEW_H
 #define EQSPECTRUMVIEW_H
 
+#include <atomic>
 #include <QPainter>
 #include <QPainterPath>
 #include <QWidget>
@@ -30,9 +31,12 @@
 #include "fft_helpers.h"
 #include "lmms_basics.h"
 #include "lmms_math.h"
+#include "LocklessRingBuffer.h"
 
 
 const int MAX_BANDS = 2048;
+// The audio thread only hands the frames over while the view is active,
+// the FFT is done in the GUI thread
 class EqAnalyser
 {
 public:
@@ -40,15 +44,21 @@ public:
 	virtual ~EqAnalyser();
 
 	float m_bands[MAX_BANDS];
-	bool getInProgress();
 	void clear();
 
-	void analyze( sampleFrame *buf, const fpp_t frames );
+	// audio thread, only call while active
+	void write( const sampleFrame *buf, const fpp_t frames );
+	// audio thread, clears the spectrum when there is nothing to analyse
+	void requestClear();
+
+	// GUI thread, returns whether there are new bands
+	bool analyze();
 
 	float getEnergy() const;
 	int getSampleRate() const;
 	bool getActive() const;
 
+	// GUI thread
 	void setActive(bool active);
 
 private:
@@ -59,9 +69,12 @@ private:
 	int m_framesFilledUp;
 	float m_energy;
 	int m_sampleRate;
-	bool m_active;
-	bool m_inProgress;
+	std::atomic<bool> m_active;
+	std::atomic<bool> m_clearRequested;
 	float m_fftWindow[FFT_BUFFER_SIZE];
+
+	LocklessRingBuffer<sampleFrame> m_inputBuffer;
+	LocklessRingBufferReader<sampleFrame> m_inputReader;
 };
 
 
@@ -74,11 +87,16 @@ public:
 	explicit EqSpectrumView( EqAnalyser *b, QWidget *_parent = 0 );
 	virtual ~EqSpectrumView()
 	{
+		m_analyser->setActive( false );
 	}
 
 	QColor getColor() const;
 	void setColor( const QColor &value );
 
+signals:
+	// the analyser has new bands
+	void spectrumUpdated();
+
 protected:
 	virtual void paintEvent( QPaintEvent *event );
 
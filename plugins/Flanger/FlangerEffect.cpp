@@ -52,8 +52,7 @@ FlangerEffect::FlangerEffect( Model *parent, const Plugin::Descriptor::SubPlugin
 	m_flangerControls( this )
 {
 	m_lfo = new QuadratureLfo( Engine::audioEngine()->processingSampleRate() );
-	m_lDelay = new MonoDelay( 1, Engine::audioEngine()->processingSampleRate() );
-	m_rDelay = new MonoDelay( 1, Engine::audioEngine()->processingSampleRate() );
+	m_delay = new ModulatedDelay( MaxTime, Engine::audioEngine()->processingSampleRate() );
 	m_noise = new Noise;
 }
 
@@ -62,13 +61,9 @@ FlangerEffect::FlangerEffect( Model *parent, const Plugin::Descriptor::SubPlugin
 
 FlangerEffect::~FlangerEffect()
 {
-	if(m_lDelay )
+	if( m_delay )
 	{
-		delete m_lDelay;
-	}
-	if( m_rDelay )
-	{
-		delete m_rDelay;
+		delete m_delay;
 	}
 	if( m_lfo )
 	{
@@ -98,33 +93,39 @@ bool FlangerEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 	bool invertFeedback = m_flangerControls.m_invertFeedbackModel.value();
 	m_lfo->setFrequency(  1.0/m_flangerControls.m_lfoFrequencyModel.value() );
 	m_lfo->setOffset( m_flangerControls.m_lfoPhaseModel.value() / 180 * D_PI );
-	m_lDelay->setFeedback( m_flangerControls.m_feedbackModel.value() );
-	m_rDelay->setFeedback( m_flangerControls.m_feedbackModel.value() );
-	sample_t dryS[2];
-	float leftLfo;
-	float rightLfo;
-	for( fpp_t f = 0; f < frames; ++f )
+	const float feedback = m_flangerControls.m_feedbackModel.value();
+	float leftLfo[BlockSize];
+	float rightLfo[BlockSize];
+	sampleFrame lengths[BlockSize];
+	float feedbacks[BlockSize];
+	sampleFrame dryS[BlockSize];
+	for( fpp_t offset = 0; offset < frames; offset += BlockSize )
 	{
-		buf[f][0] += m_noise->tick() * noise;
-		buf[f][1] += m_noise->tick() * noise;
-		dryS[0] = buf[f][0];
-		dryS[1] = buf[f][1];
-		m_lfo->tick(&leftLfo, &rightLfo);
-		m_lDelay->setLength( ( float )length + amplitude * (leftLfo+1.0)  );
-		m_rDelay->setLength( ( float )length + amplitude * (rightLfo+1.0)  );
-		if(invertFeedback)
-		{
-			m_lDelay->tick( &buf[f][1] );
-			m_rDelay->tick(&buf[f][0] );
-		} else
+		sampleFrame * block = buf + offset;
+		const fpp_t blockFrames = qMin<fpp_t>( BlockSize, frames - offset );
+
+		m_lfo->tick( leftLfo, rightLfo, blockFrames );
+		for( fpp_t f = 0; f < blockFrames; ++f )
 		{
-			m_lDelay->tick( &buf[f][0] );
-			m_rDelay->tick( &buf[f][1] );
+			block[f][0] += m_noise->tick() * noise;
+			block[f][1] += m_noise->tick() * noise;
+			dryS[f] = block[f];
+			const float leftLength = ( float )length + amplitude * (leftLfo[f]+1.0);
+			const float rightLength = ( float )length + amplitude * (rightLfo[f]+1.0);
+			// inverted, the left delay runs on the right channel and vice versa
+			lengths[f][0] = invertFeedback ? rightLength : leftLength;
+			lengths[f][1] = invertFeedback ? leftLength : rightLength;
+			feedbacks[f] = feedback;
 		}
 
-		buf[f][0] = ( d * dryS[0] ) + ( w * buf[f][0] );
-		buf[f][1] = ( d * dryS[1] ) + ( w * buf[f][1] );
-		outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
+		m_delay->process( block, lengths, feedbacks, blockFrames );
+
+		for( fpp_t f = 0; f < blockFrames; ++f )
+		{
+			block[f][0] = ( d * dryS[f][0] ) + ( w * block[f][0] );
+			block[f][1] = ( d * dryS[f][1] ) + ( w * block[f][1] );
+			outSum += block[f][0]*block[f][0] + block[f][1]*block[f][1];
+		}
 	}
 	checkGate( outSum / frames );
 	return isRunning();
@@ -136,8 +137,7 @@ bool FlangerEffect::processAudioBuffer( sampleFrame *buf, const fpp_t frames )
 void FlangerEffect::changeSampleRate()
 {
 	m_lfo->setSampleRate( Engine::audioEngine()->processingSampleRate() );
-	m_lDelay->setSampleRate( Engine::audioEngine()->processingSampleRate() );
-	m_rDelay->setSampleRate( Engine::audioEngine()->processingSampleRate() );
+	m_delay->setSampleRate( Engine::audioEngine()->processingSampleRate() );
 }
 
 
@@ -28,8 +28,8 @@
 
 #include "Effect.h"
 #include "FlangerControls.h"
+#include "ModulatedDelay.h"
 #include "QuadratureLfo.h"
-#include "MonoDelay.h"
 #include "Noise.h"
 
 
@@ -47,9 +47,13 @@ public:
 	void restartLFO();
 
 private:
+	// frames processed at a time
+	static constexpr fpp_t BlockSize = 64;
+	// the longest delay time plus twice the LFO amount, in seconds
+	static constexpr float MaxTime = 0.06f;
+
 	FlangerControls m_flangerControls;
-	MonoDelay* m_lDelay;
-	MonoDelay* m_rDelay;
+	ModulatedDelay* m_delay;
 	QuadratureLfo* m_lfo;
 	Noise* m_noise;
 
@@ -121,11 +121,19 @@ FreeBoyInstrument::FreeBoyInstrument( InstrumentTrack * _instrument_track ) :
 
 	m_time(0)
 {
+	for( std::atomic<Gb_Apu_Buffer *> & slot : m_idleApus )
+	{
+		slot.store( nullptr, std::memory_order_relaxed );
+	}
 }
 
 
 FreeBoyInstrument::~FreeBoyInstrument()
 {
+	for( std::atomic<Gb_Apu_Buffer *> & slot : m_idleApus )
+	{
+		delete slot.load( std::memory_order_relaxed );
+	}
 }
 
 
@@ -255,8 +263,7 @@ void FreeBoyInstrument::playNote( NotePlayHandle * _n,
 
 	if ( tfp == 0 )
 	{
-		Gb_Apu_Buffer *papu = new Gb_Apu_Buffer();
-		papu->set_sample_rate( samplerate, CLOCK_RATE );
+		Gb_Apu_Buffer *papu = acquireApu( samplerate );
 
 		// Master sound circuitry power control
 		papu->write_register( fakeClock(),  0xff26, 0x80 );
@@ -424,7 +431,58 @@ void FreeBoyInstrument::playNote( NotePlayHandle * _n,
 
 void FreeBoyInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<Gb_Apu_Buffer *>( _n->m_pluginData );
+	releaseApu( static_cast<Gb_Apu_Buffer *>( _n->m_pluginData ) );
+}
+
+
+
+
+Gb_Apu_Buffer * FreeBoyInstrument::acquireApu( long sampleRate )
+{
+	for( std::atomic<Gb_Apu_Buffer *> & slot : m_idleApus )
+	{
+		// cheap test before claiming the slot
+		Gb_Apu_Buffer * papu = slot.load( std::memory_order_relaxed ) != nullptr ?
+				slot.exchange( nullptr, std::memory_order_acquire ) : nullptr;
+		if( papu == nullptr )
+		{
+			continue;
+		}
+		if( papu->sample_rate() == sampleRate )
+		{
+			papu->clear();
+			return papu;
+		}
+		// kept from before the sample rate changed
+		delete papu;
+	}
+
+	Gb_Apu_Buffer * papu = new Gb_Apu_Buffer();
+	papu->set_sample_rate( sampleRate, CLOCK_RATE );
+	return papu;
+}
+
+
+
+
+void FreeBoyInstrument::releaseApu( Gb_Apu_Buffer * papu )
+{
+	if( papu == nullptr )
+	{
+		return;
+	}
+	for( std::atomic<Gb_Apu_Buffer *> & slot : m_idleApus )
+	{
+		Gb_Apu_Buffer * empty = nullptr;
+		if( slot.load( std::memory_order_relaxed ) == nullptr &&
+			slot.compare_exchange_strong( empty, papu,
+				std::memory_order_release, std::memory_order_relaxed ) )
+		{
+			return;
+		}
+	}
+	// more notes were played at once than are kept
+	delete papu;
 }
 
 
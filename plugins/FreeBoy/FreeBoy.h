@@ -26,6 +26,9 @@
 #ifndef FREEBOY_H
 #define FREEBOY_H
 
+#include <array>
+#include <atomic>
+
 #include <QObject>
 #include "Instrument.h"
 #include "InstrumentView.h"
@@ -34,6 +37,7 @@
 #include "Gb_Apu.h"
 
 class FreeBoyInstrumentView;
+class Gb_Apu_Buffer;
 class NotePlayHandle;
 class PixmapButton;
 
@@ -107,6 +111,15 @@ private:
 	blip_time_t m_time;
 	blip_time_t fakeClock() { return m_time += 4; }
 
+	// an APU of a released note, reset, or a new one
+	Gb_Apu_Buffer * acquireApu( long sampleRate );
+	void releaseApu( Gb_Apu_Buffer * papu );
+
+	// the APUs of released notes, kept with their buffers to be reset for
+	// the next notes instead of allocating them again, empty slots are
+	// nullptr. Any thread takes and puts them.
+	std::array<std::atomic<Gb_Apu_Buffer *>, 16> m_idleApus;
+
 	friend class FreeBoyInstrumentView;
 } ;
 
@@ -51,3 +51,13 @@ void Gb_Apu_Buffer::bass_freq(int freq) {
 	m_buf.bass_freq(freq);
 }
 
+// Wrap Multi_Buffer::sample_rate()
+long Gb_Apu_Buffer::sample_rate() const {
+	return m_buf.sample_rate();
+}
+
+void Gb_Apu_Buffer::clear() {
+	Gb_Apu::reset();
+	m_buf.clear();
+}
+
@@ -40,6 +40,9 @@ public:
 	typedef blip_sample_t sample_t;
 	long read_samples(sample_t* out, long count);
 	void bass_freq(int freq);
+	long sample_rate() const;
+	// Resets the APU and drops what's buffered, to play the next note
+	void clear();
 private:
 	Stereo_Buffer m_buf;
 };
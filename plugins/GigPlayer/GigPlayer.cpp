@@ -35,6 +35,7 @@
 #include <QLayout>
 #include <QLabel>
 #include <QDomDocument>
+#include <QSet>
 
 #include "AudioEngine.h"
 #include "ConfigManager.h"
@@ -46,6 +47,7 @@
 #include "Knob.h"
 #include "NotePlayHandle.h"
 #include "PathUtil.h"
+#include "ResamplerPool.h"
 #include "SampleBuffer.h"
 #include "Song.h"
 
@@ -85,6 +87,8 @@ GigInstrument::GigInstrument( InstrumentTrack * _instrument_track ) :
 	m_bankNum( 0, 0, 999, this, tr( "Bank" ) ),
 	m_patchNum( 0, 0, 127, this, tr( "Patch" ) ),
 	m_gain( 1.0f, 0.0f, 5.0f, 0.01f, this, tr( "Gain" ) ),
+	m_preload( 0.0f, 0.0f, 10000.0f, 10.0f, this, tr( "Preload" ) ),
+	m_preloadedBytes( 0 ),
 	m_interpolation( SRC_LINEAR ),
 	m_RandomSeed( 0 ),
 	m_currentKeyDimension( 0 )
@@ -97,6 +101,7 @@ GigInstrument::GigInstrument( InstrumentTrack * _instrument_track ) :
 	connect( &m_bankNum, SIGNAL( dataChanged() ), this, SLOT( updatePatch() ) );
 	connect( &m_patchNum, SIGNAL( dataChanged() ), this, SLOT( updatePatch() ) );
 	connect( Engine::audioEngine(), SIGNAL( sampleRateChanged() ), this, SLOT( updateSampleRate() ) );
+	connect( &m_preload, SIGNAL( dataChanged() ), this, SLOT( updatePreload() ) );
 }
 
 
@@ -120,6 +125,7 @@ void GigInstrument::saveSettings( QDomDocument & _doc, QDomElement & _this )
 	m_bankNum.saveSettings( _doc, _this, "bank" );
 
 	m_gain.saveSettings( _doc, _this, "gain" );
+	m_preload.saveSettings( _doc, _this, "preload" );
 }
 
 
@@ -132,6 +138,7 @@ void GigInstrument::loadSettings( const QDomElement & _this )
 	m_bankNum.loadSettings( _this, "bank" );
 
 	m_gain.loadSettings( _this, "gain" );
+	m_preload.loadSettings( _this, "preload" );
 
 	updatePatch();
 }
@@ -194,6 +201,7 @@ void GigInstrument::freeInstance()
 		// that instrument again
 		m_instrument = nullptr;
 		m_notes.clear();
+		m_preloadedBytes = 0;
 	}
 }
 
@@ -554,8 +562,6 @@ void GigInstrument::loadSample( GigSample& sample, sampleFrame* sampleData, f_cn
 			// TODO: also implement loop_type_backward support
 		}
 
-		sample.sample->SetPos( sample.pos );
-
 		// Load the samples (based on gig::Sample::ReadAndLoop) even around the end
 		// of a loop boundary wrapping to the beginning of the loop region
 		long samplestoread = samples;
@@ -563,27 +569,29 @@ void GigInstrument::loadSample( GigSample& sample, sampleFrame* sampleData, f_cn
 		long readsamples = 0;
 		long totalreadsamples = 0;
 		long loopEnd = loopStart + loopLength;
+		f_cnt_t position = sample.pos;
 
 		do
 		{
-			samplestoloopend = loopEnd - sample.sample->GetPos();
-			readsamples = sample.sample->Read( &buffer[totalreadsamples * sample.sample->FrameSize],
+			samplestoloopend = loopEnd - position;
+			readsamples = readFrames( sample.sample, position,
+					&buffer[totalreadsamples * sample.sample->FrameSize],
 					std::min( samplestoread, samplestoloopend ) );
 			samplestoread -= readsamples;
 			totalreadsamples += readsamples;
+			position += readsamples;
 
 			if( readsamples >= samplestoloopend )
 			{
-				sample.sample->SetPos( loopStart );
+				position = loopStart;
 			}
 		}
 		while( samplestoread > 0 && readsamples > 0 );
 	}
 	else
 	{
-		sample.sample->SetPos( sample.pos );
-
-		unsigned long size = sample.sample->Read( &buffer, samples ) * sample.sample->FrameSize;
+		unsigned long size = readFrames( sample.sample, sample.pos, buffer, samples ) *
+					sample.sample->FrameSize;
 		std::memset( (int8_t*) &buffer + size, 0, allocationsize - size );
 	}
 
@@ -645,6 +653,32 @@ void GigInstrument::loadSample( GigSample& sample, sampleFrame* sampleData, f_cn
 
 
 
+unsigned long GigInstrument::readFrames( gig::Sample * sample, f_cnt_t pos, int8_t * buffer,
+		unsigned long frames )
+{
+	// The preloaded beginning of the sample
+	const gig::buffer_t cache = sample->GetCache();
+	const unsigned long cached = cache.pStart != nullptr ? cache.Size / sample->FrameSize : 0;
+	unsigned long copied = 0;
+
+	if( pos < static_cast<f_cnt_t>( cached ) )
+	{
+		copied = std::min<unsigned long>( frames, cached - pos );
+		std::memcpy( buffer, static_cast<int8_t *>( cache.pStart ) + pos * sample->FrameSize,
+				copied * sample->FrameSize );
+		if( copied == frames )
+		{
+			return copied;
+		}
+	}
+
+	sample->SetPos( pos + copied );
+	return copied + sample->Read( buffer + copied * sample->FrameSize, frames - copied );
+}
+
+
+
+
 // These two loop index functions taken from SampleBuffer.cpp
 f_cnt_t GigInstrument::getLoopedIndex( f_cnt_t index, f_cnt_t startf, f_cnt_t endf ) const
 {
@@ -890,6 +924,11 @@ void GigInstrument::getInstrument()
 			pInstrument = m_instance->gig.GetNextInstrument();
 		}
 
+		if( pInstrument != m_instrument )
+		{
+			preloadSamples( m_instrument, false );
+			preloadSamples( pInstrument, true );
+		}
 		m_instrument = pInstrument;
 	}
 }
@@ -897,6 +936,72 @@ void GigInstrument::getInstrument()
 
 
 
+void GigInstrument::updatePreload()
+{
+	QMutexLocker locker( &m_synthMutex );
+
+	if( m_instance != nullptr )
+	{
+		preloadSamples( m_instrument, true );
+	}
+}
+
+
+
+
+void GigInstrument::preloadSamples( gig::Instrument * instrument, bool preload )
+{
+	if( instrument == nullptr )
+	{
+		return;
+	}
+
+	// Samples are often shared by several dimension regions
+	QSet<gig::Sample *> samples;
+	size_t preloaded = 0;
+
+	for( gig::Region * pRegion = instrument->GetFirstRegion(); pRegion != nullptr;
+			pRegion = instrument->GetNextRegion() )
+	{
+		for( uint32_t i = 0; i < pRegion->DimensionRegions; ++i )
+		{
+			gig::Sample * pSample = pRegion->pDimensionRegions[i]->pSample;
+
+			if( pSample == nullptr || samples.contains( pSample ) )
+			{
+				continue;
+			}
+			samples.insert( pSample );
+
+			const unsigned long frames = std::min<unsigned long>( pSample->SamplesTotal,
+					m_preload.value() / 1000.0f * pSample->SamplesPerSecond );
+
+			try
+			{
+				if( preload && frames > 0 )
+				{
+					pSample->LoadSampleData( frames );
+					preloaded += pSample->GetCache().Size;
+				}
+				else
+				{
+					pSample->ReleaseSampleData();
+				}
+			}
+			catch( ... )
+			{
+				qWarning() << "GigInstrument: could not preload sample";
+			}
+		}
+	}
+
+	// the samples of the previous instrument are released first
+	m_preloadedBytes = preloaded;
+}
+
+
+
+
 // Since the sample rate changes when we start an export, clear all the
 // currently-playing notes when we get this signal. Then, the export won't
 // include leftover notes that were playing in the program.
@@ -971,6 +1076,12 @@ GigInstrumentView::GigInstrumentView( Instrument * _instrument, QWidget * _paren
 	m_gainKnob->setHintText( tr( "Gain:" ) + " ", "" );
 	m_gainKnob->move( 32, 140 );
 
+	// Preload
+	m_preloadKnob = new gigKnob( this );
+	m_preloadKnob->setHintText( tr( "Preload:" ) + " ", " ms" );
+	m_preloadKnob->move( 210, 140 );
+	ToolTip::add( m_preloadKnob, tr( "How much of each sample is kept in RAM, the rest is read from the file while playing" ) );
+
 	setAutoFillBackground( true );
 	QPalette pal;
 	pal.setBrush( backgroundRole(), PLUGIN_NAME::getIconPixmap( "artwork" ) );
@@ -996,6 +1107,7 @@ void GigInstrumentView::modelChanged()
 	m_patchNumLcd->setModel( &k->m_patchNum );
 
 	m_gainKnob->setModel( &k->m_gain );
+	m_preloadKnob->setModel( &k->m_preload );
 
 	connect( k, SIGNAL( fileChanged() ), this, SLOT( updateFilename() ) );
 	connect( k, SIGNAL( fileLoading() ), this, SLOT( invalidateFile() ) );
@@ -1134,10 +1246,7 @@ GigSample::GigSample( gig::Sample * pSample, gig::DimensionRegion * pDimRegion,
 
 GigSample::~GigSample()
 {
-	if( srcState != nullptr )
-	{
-		src_delete( srcState );
-	}
+	ResamplerPool::inst().give( interpolation, srcState );
 }
 
 
@@ -1157,6 +1266,8 @@ GigSample::GigSample( const GigSample& g )
 
 GigSample& GigSample::operator=( const GigSample& g )
 {
+	ResamplerPool::inst().give( interpolation, srcState );
+
 	sample = g.sample;
 	region= g.region;
 	attenuation = g.attenuation;
@@ -1180,15 +1291,12 @@ GigSample& GigSample::operator=( const GigSample& g )
 
 void GigSample::updateSampleRate()
 {
-	if( srcState != nullptr )
-	{
-		src_delete( srcState );
-	}
+	// Notes start on the audio thread, so the states are recycled instead of
+	// allocated for every sample of every note
+	ResamplerPool::inst().give( interpolation, srcState );
+	srcState = ResamplerPool::inst().take( interpolation );
 
-	int error = 0;
-	srcState = src_new( interpolation, DEFAULT_CHANNELS, &error );
-
-	if( srcState == nullptr || error != 0 )
+	if( srcState == nullptr )
 	{
 		qCritical( "error while creating libsamplerate data structure in GigSample" );
 	}
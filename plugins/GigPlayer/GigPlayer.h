@@ -27,6 +27,8 @@
 #ifndef GIG_PLAYER_H
 #define GIG_PLAYER_H
 
+#include <atomic>
+
 #include <QList>
 #include <QMutex>
 #include <QMutexLocker>
@@ -251,6 +253,11 @@ public:
 
 	virtual QString nodeName() const;
 
+	size_t memoryUsage() const override
+	{
+		return m_preloadedBytes;
+	}
+
 	virtual f_cnt_t desiredReleaseFrames() const
 	{
 		return 0;
@@ -273,6 +280,7 @@ public slots:
 	void openFile( const QString & _gigFile, bool updateTrackName = true );
 	void updatePatch();
 	void updateSampleRate();
+	void updatePreload();
 
 
 private:
@@ -288,6 +296,12 @@ private:
 
 	FloatModel m_gain;
 
+	// How many milliseconds of each sample of the instrument are kept in RAM,
+	// the rest is read from the file while playing
+	FloatModel m_preload;
+	// What the samples preloaded take
+	std::atomic<size_t> m_preloadedBytes;
+
 	// Locking for the data
 	QMutex m_synthMutex;
 	QMutex m_notesMutex;
@@ -315,6 +329,12 @@ private:
 
 	// Load sample data from the Gig file, looping the sample where needed
 	void loadSample( GigSample& sample, sampleFrame* sampleData, f_cnt_t samples );
+	// Read raw frames, from the preloaded part of the sample if possible
+	unsigned long readFrames( gig::Sample * sample, f_cnt_t pos, int8_t * buffer,
+		unsigned long frames );
+	// Keep the beginning of all samples of the instrument in RAM or release
+	// them, m_synthMutex has to be locked
+	void preloadSamples( gig::Instrument * instrument, bool preload );
 	f_cnt_t getLoopedIndex( f_cnt_t index, f_cnt_t startf, f_cnt_t endf ) const;
 	f_cnt_t getPingPongIndex( f_cnt_t index, f_cnt_t startf, f_cnt_t endf ) const;
 
@@ -355,6 +375,7 @@ private:
 	QLabel * m_patchLabel;
 
 	Knob * m_gainKnob;
+	Knob * m_preloadKnob;
 
 	static PatchesDialog * s_patchDialog;
 
@@ -3,6 +3,7 @@
 #include <QApplication>
 #include <QMessageBox>
 #include <QProgressDialog>
+#include <QHash>
 #include <QTextStream>
 #include <stdlib.h>
 
@@ -268,6 +269,8 @@ bool HydrogenImport::readSong()
 		pattern_length[sName] = nSize;
 		QDomNode pNoteListNode = patternNode.firstChildElement( "noteList" );
 		if ( ! pNoteListNode.isNull() ) {
+			// notes are collected per clip and added all at once
+			QHash<MidiClip*, std::vector<Note>> clipNotes;
 			QDomNode noteNode = pNoteListNode.firstChildElement( "note" );
 			while ( ! noteNode.isNull()  ) {
 				int nPosition = LocalFileMng::readXmlInt( noteNode, "position", 0 );
@@ -294,10 +297,14 @@ bool HydrogenImport::readSong()
 				n.setVolume( fVelocity * 100 );
 				n.setPanning( ( fPan_R - fPan_L ) * 100 );
 				n.setKey( NoteKey::stringToNoteKey( sKey ) );
-				p->addNote( n,false );
+				clipNotes[p].push_back( n );
 				pn = pn + 1;
 				noteNode = ( QDomNode ) noteNode.nextSiblingElement( "note" );
 			}        
+			for( auto it = clipNotes.begin(); it != clipNotes.end(); ++it )
+			{
+				it.key()->addNotes( it.value(), false );
+			}
 		}
 		patternNode = ( QDomNode ) patternNode.nextSiblingElement( "pattern" );
 	}
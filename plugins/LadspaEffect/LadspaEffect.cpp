@@ -27,6 +27,8 @@
 #include <QtCore/QVarLengthArray>
 #include <QMessageBox>
 
+#include <algorithm>
+
 #include "LadspaEffect.h"
 #include "DataFile.h"
 #include "AudioDevice.h"
@@ -39,6 +41,8 @@
 #include "AutomationClip.h"
 #include "ControllerConnection.h"
 #include "MemoryManager.h"
+#include "MixHelpers.h"
+#include "PlanarBuffer.h"
 #include "ValueBuffer.h"
 #include "Song.h"
 
@@ -72,7 +76,9 @@ LadspaEffect::LadspaEffect( Model * _parent,
 	Effect( &ladspaeffect_plugin_descriptor, _parent, _key ),
 	m_controls( nullptr ),
 	m_maxSampleRate( 0 ),
-	m_key( LadspaSubPluginFeatures::subPluginKeyToLadspaKey( _key ) )
+	m_key( LadspaSubPluginFeatures::subPluginKeyToLadspaKey( _key ) ),
+	m_inputBuffer( nullptr ),
+	m_planarInput( false )
 {
 	Ladspa2LMMS * manager = Engine::getLADSPAManager();
 	if( manager->getDescription( m_key ) == nullptr )
@@ -153,6 +159,12 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 
 	// Copy the LMMS audio buffer to the LADSPA input buffer and initialize
 	// the control ports.  
+	const fpp_t bufferSize = Engine::audioEngine()->framesPerPeriod();
+	const bool planar = m_planarInput && frames == bufferSize;
+	if( planar )
+	{
+		MixHelpers::deinterleave( PlanarBuffer( m_inputBuffer, frames ), _buf );
+	}
 	ch_cnt_t channel = 0;
 	for( ch_cnt_t proc = 0; proc < processorCount(); ++proc )
 	{
@@ -162,11 +174,14 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 			switch( pp->rate )
 			{
 				case CHANNEL_IN:
-					for( fpp_t frame = 0; 
-						frame < frames; ++frame )
+					if( !planar )
 					{
-						pp->buffer[frame] = 
-							_buf[frame][channel];
+						for( fpp_t frame = 0;
+							frame < frames; ++frame )
+						{
+							pp->buffer[frame] =
+								_buf[frame][channel];
+						}
 					}
 					++channel;
 					break;
@@ -176,19 +191,20 @@ bool LadspaEffect::processAudioBuffer( sampleFrame * _buf,
 					if( vb )
 					{
 						memcpy( pp->buffer, vb->values(), frames * sizeof(float) );
+						pp->buffer_holds_value = false;
 					}
 					else
 					{
-						pp->value = static_cast<LADSPA_Data>( 
+						const LADSPA_Data value = static_cast<LADSPA_Data>(
 											pp->control->value() / pp->scale );
 						// This only supports control rate ports, so the audio rates are
 						// treated as though they were control rate by setting the
 						// port buffer to all the same value.
-						for( fpp_t frame = 0; 
-							frame < frames; ++frame )
+						if( !pp->buffer_holds_value || value != pp->value )
 						{
-							pp->buffer[frame] = 
-								pp->value;
+							pp->value = value;
+							std::fill( pp->buffer, pp->buffer + bufferSize, value );
+							pp->buffer_holds_value = true;
 						}
 					}
 					break;
@@ -304,6 +320,9 @@ void LadspaEffect::pluginInstantiation()
 	LADSPA_Data * inbuf [2];
 	inbuf[0] = nullptr;
 	inbuf[1] = nullptr;
+	// the inputs follow each other, so that they can be filled at once
+	const fpp_t bufferSize = Engine::audioEngine()->framesPerPeriod();
+	m_inputBuffer = MM_ALLOC<LADSPA_Data>( bufferSize * DEFAULT_CHANNELS );
 	for( ch_cnt_t proc = 0; proc < processorCount(); proc++ )
 	{
 		multi_proc_t ports;
@@ -316,6 +335,7 @@ void LadspaEffect::pluginInstantiation()
 			p->port_id = port;
 			p->control = nullptr;
 			p->buffer = nullptr;
+			p->buffer_holds_value = false;
 
 			// Determine the port's category.
 			if( manager->isPortAudio( m_key, port ) )
@@ -324,7 +344,9 @@ void LadspaEffect::pluginInstantiation()
 					manager->isPortInput( m_key, port ) )
 				{
 					p->rate = CHANNEL_IN;
-					p->buffer = MM_ALLOC<LADSPA_Data>( Engine::audioEngine()->framesPerPeriod() );
+					p->buffer = inputch < DEFAULT_CHANNELS
+						? m_inputBuffer + inputch * bufferSize
+						: MM_ALLOC<LADSPA_Data>( bufferSize );
 					inbuf[ inputch ] = p->buffer;
 					inputch++;
 				}
@@ -472,6 +494,7 @@ void LadspaEffect::pluginInstantiation()
 		}
 		m_ports.append( ports );
 	}
+	m_planarInput = inputch == DEFAULT_CHANNELS;
 
 	// Instantiate the processing units.
 	m_descriptor = manager->getDescriptor( m_key );
@@ -553,7 +576,9 @@ void LadspaEffect::pluginDestruction()
 		for( int port = 0; port < m_portCount; port++ )
 		{
 			port_desc_t * pp = m_ports.at( proc ).at( port );
-			if( m_inPlaceBroken || pp->rate != CHANNEL_OUT )
+			const bool inInputBuffer = pp->buffer >= m_inputBuffer &&
+				pp->buffer < m_inputBuffer + Engine::audioEngine()->framesPerPeriod() * DEFAULT_CHANNELS;
+			if( ( m_inPlaceBroken || pp->rate != CHANNEL_OUT ) && !inInputBuffer )
 			{
 				if( pp->buffer) MM_FREE( pp->buffer );
 			}
@@ -564,6 +589,8 @@ void LadspaEffect::pluginDestruction()
 	m_ports.clear();
 	m_handles.clear();
 	m_portControls.clear();
+	MM_FREE( m_inputBuffer );
+	m_inputBuffer = nullptr;
 }
 
 
@@ -84,6 +84,11 @@ private:
 	QVector<multi_proc_t> m_ports;
 	multi_proc_t m_portControls;
 
+	//! the audio inputs of all processors, one channel after the other
+	LADSPA_Data * m_inputBuffer;
+	//! whether each channel has its input in m_inputBuffer
+	bool m_planarInput;
+
 } ;
 
 #endif
@@ -27,6 +27,7 @@
 #include <QDebug>
 #include <lv2.h>
 
+#include "BufferManager.h"
 #include "Lv2SubPluginFeatures.h"
 
 #include "embed.h"
@@ -58,21 +59,39 @@ Plugin::Descriptor PLUGIN_EXPORT lv2effect_plugin_descriptor =
 
 
 Lv2Effect::Lv2Effect(Model* parent, const Descriptor::SubPluginFeatures::Key *key) :
-	Effect(&lv2effect_plugin_descriptor, parent, key),
+	PlanarEffect(&lv2effect_plugin_descriptor, parent, key),
 	m_controls(this, key->attributes["uri"]),
-	m_tmpOutputSmps(Engine::audioEngine()->framesPerPeriod())
+	m_tmpOutput(BufferManager::acquirePlanar())
 {
 }
 
 
 
 
-bool Lv2Effect::processAudioBuffer(sampleFrame *buf, const fpp_t frames)
+Lv2Effect::~Lv2Effect()
+{
+	BufferManager::release(m_tmpOutput);
+}
+
+
+
+
+bool Lv2Effect::processPlanarBuffer(const PlanarBuffer& buf)
 {
 	if (!isEnabled() || !isRunning()) { return false; }
-	Q_ASSERT(frames <= static_cast<fpp_t>(m_tmpOutputSmps.size()));
+	const fpp_t frames = buf.frames();
+	Q_ASSERT(frames <= m_tmpOutput.frames());
 
-	m_controls.copyBuffersFromLmms(buf, frames);
+	bool corrupt = wetLevel() < 0; // #3261 - if w < 0, bash w := 0, d := 1
+	const float d = corrupt ? 1 : dryLevel();
+	const float w = corrupt ? 0 : wetLevel();
+	// without dry signal, the plugin can write its output over its input
+	const bool inPlace = d == 0 && w == 1 && m_controls.canProcessInPlace();
+	const PlanarBuffer out = inPlace ? buf : m_tmpOutput.withFrames(frames);
+
+	// the ports are connected to the buffers if the channels match
+	const bool connected = m_controls.connectBuffersOfLmms(buf, out);
+	if (!connected) { m_controls.copyBuffersFromLmms(buf, frames); }
 	m_controls.copyModelsFromLmms();
 
 //	m_pluginMutex.lock();
@@ -80,19 +99,24 @@ bool Lv2Effect::processAudioBuffer(sampleFrame *buf, const fpp_t frames)
 //	m_pluginMutex.unlock();
 
 	m_controls.copyModelsToLmms();
-	m_controls.copyBuffersToLmms(m_tmpOutputSmps.data(), frames);
+	if (!connected) { m_controls.copyBuffersToLmms(out, frames); }
 
 	double outSum = .0;
-	bool corrupt = wetLevel() < 0; // #3261 - if w < 0, bash w := 0, d := 1
-	const float d = corrupt ? 1 : dryLevel();
-	const float w = corrupt ? 0 : wetLevel();
-	for(fpp_t f = 0; f < frames; ++f)
+	for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
 	{
-		buf[f][0] = d * buf[f][0] + w * m_tmpOutputSmps[f][0];
-		buf[f][1] = d * buf[f][1] + w * m_tmpOutputSmps[f][1];
-		double l = static_cast<double>(buf[f][0]);
-		double r = static_cast<double>(buf[f][1]);
-		outSum += l*l + r*r;
+		sample_t* dst = buf.channel(ch);
+		const sample_t* wet = out.channel(ch);
+		if (!inPlace)
+		{
+			for (fpp_t f = 0; f < frames; ++f)
+			{
+				dst[f] = d * dst[f] + w * wet[f];
+			}
+		}
+		for (fpp_t f = 0; f < frames; ++f)
+		{
+			outSum += static_cast<double>(dst[f]) * dst[f];
+		}
 	}
 	checkGate(outSum / frames);
 
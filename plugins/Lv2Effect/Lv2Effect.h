@@ -25,10 +25,10 @@
 #ifndef LV2_EFFECT_H
 #define LV2_EFFECT_H
 
-#include "Effect.h"
 #include "Lv2FxControls.h"
+#include "PlanarEffect.h"
 
-class Lv2Effect : public Effect
+class Lv2Effect : public PlanarEffect
 {
 	Q_OBJECT
 
@@ -37,10 +37,11 @@ public:
 		initialization
 	*/
 	Lv2Effect(Model* parent, const Descriptor::SubPluginFeatures::Key* _key);
+	~Lv2Effect() override;
 	//! Must be checked after ctor or reload
 	bool isValid() const { return m_controls.isValid(); }
 
-	bool processAudioBuffer( sampleFrame* buf, const fpp_t frames ) override;
+	bool processPlanarBuffer(const PlanarBuffer& buf) override;
 	EffectControls* controls() override { return &m_controls; }
 
 	Lv2FxControls* lv2Controls() { return &m_controls; }
@@ -48,7 +49,7 @@ public:
 
 private:
 	Lv2FxControls m_controls;
-	std::vector<sampleFrame> m_tmpOutputSmps;
+	PlanarBuffer m_tmpOutput;
 };
 
 #endif // LMMS_HAVE_LV2
@@ -24,8 +24,8 @@
  */
 
 
-#include <QDomDocument>
 #include <QDir>
+#include <QFile>
 #include <QApplication>
 #include <QMessageBox>
 #include <QProgressDialog>
@@ -35,9 +35,8 @@
 #include "lmms_math.h"
 #include "TrackContainer.h"
 #include "BBTrack.h"
-#include "DataFile.h"
 #include "InstrumentTrack.h"
-#include "LocaleHelper.h"
+#include "MidiClip.h"
 
 #include "plugin_export.h"
 
@@ -80,16 +79,17 @@ bool MidiExport::tryExport(const TrackContainer::TrackList &tracks,
 			int tempo, int masterPitch, const QString &filename)
 {
 	QFile f(filename);
-	f.open(QIODevice::WriteOnly);
-	QDataStream midiout(&f);
+	if (!f.open(QIODevice::WriteOnly))
+	{
+		return false;
+	}
 
 	InstrumentTrack* instTrack;
 	BBTrack* bbTrack;
-	QDomElement element;
 
 
 	int nTracks = 0;
-	uint8_t buffer[BUFFER_SIZE];
+	uint8_t buffer[16];
 	uint32_t size;
 
 	for (const Track* track : tracks) if (track->type() == Track::InstrumentTrack) nTracks++;
@@ -98,14 +98,15 @@ bool MidiExport::tryExport(const TrackContainer::TrackList &tracks,
 	// midi header
 	MidiFile::MIDIHeader header(nTracks);
 	size = header.writeToBuffer(buffer);
-	midiout.writeRawData((char *)buffer, size);
+	f.write((char *)buffer, size);
 
+	// the clips of the BB tracks, by the index of their BB
 	std::vector<std::vector<std::pair<int,int>>> plists;
 
-	// midi tracks
+	// midi tracks - the notes come from the clips themselves, instead of
+	// their saved state
 	for (Track* track : tracks)
 	{
-		DataFile dataFile(DataFile::SongProject);
 		MTrack mtrack;
 
 		if (track->type() == Track::InstrumentTrack)
@@ -116,60 +117,44 @@ bool MidiExport::tryExport(const TrackContainer::TrackList &tracks,
 			mtrack.addTempo(tempo, 0);
 
 			instTrack = dynamic_cast<InstrumentTrack *>(track);
-			element = instTrack->saveState(dataFile, dataFile.content());
 
-			int base_pitch = 0;
-			double base_volume = 1.0;
-			int base_time = 0;
+			const int base_pitch = basePitch(instTrack, masterPitch);
+			const double base_volume = instTrack->volumeModel()->value() / 100.0;
 
 			MidiNoteVector midiClip;
 
-			for (QDomNode n = element.firstChild(); !n.isNull(); n = n.nextSibling())
+			for (const Clip* clip : track->getClips())
 			{
-
-				if (n.nodeName() == "instrumenttrack")
-				{
-					QDomElement it = n.toElement();
-					base_pitch = (69 - it.attribute("basenote", "69").toInt());
-					if (it.attribute("usemasterpitch", "1").toInt())
-					{
-						base_pitch += masterPitch;
-					}
-					base_volume = LocaleHelper::toDouble(it.attribute("volume", "100"))/100.0;
-				}
-
-				if (n.nodeName() == "pattern") //TODO: rename to "midiClip"
-				{
-					base_time = n.toElement().attribute("pos", "0").toInt();
-					writeMidiClip(midiClip, n, base_pitch, base_volume, base_time);
-				}
-
+				writeMidiClip(midiClip, dynamic_cast<const MidiClip *>(clip),
+						base_pitch, base_volume, clip->startPosition());
 			}
 			ProcessBBNotes(midiClip, INT_MAX);
 			writeMidiClipToTrack(mtrack, midiClip);
-			size = mtrack.writeToBuffer(buffer);
-			midiout.writeRawData((char *)buffer, size);
+			if (!writeTrack(f, mtrack))
+			{
+				return false;
+			}
 		}
 
 		if (track->type() == Track::BBTrack)
 		{
 			bbTrack = dynamic_cast<BBTrack *>(track);
-			element = bbTrack->saveState(dataFile, dataFile.content());
 
 			std::vector<std::pair<int,int>> plist;
-			for (QDomNode n = element.firstChild(); !n.isNull(); n = n.nextSibling())
+			for (const Clip* clip : track->getClips())
 			{
-
-				if (n.nodeName() == "bbclip")
-				{
-					QDomElement it = n.toElement();
-					int pos = it.attribute("pos", "0").toInt();
-					int len = it.attribute("len", "0").toInt();
-					plist.push_back(std::pair<int,int>(pos, pos+len));
-				}
+				int pos = clip->startPosition();
+				int len = clip->length();
+				plist.push_back(std::pair<int,int>(pos, pos+len));
 			}
 			std::sort(plist.begin(), plist.end());
-			plists.push_back(plist);
+
+			const size_t index = bbTrack->index();
+			if (index >= plists.size())
+			{
+				plists.resize(index + 1);
+			}
+			plists[index] = std::move(plist);
 
 		}
 	} // for each track
@@ -177,10 +162,8 @@ bool MidiExport::tryExport(const TrackContainer::TrackList &tracks,
 	// midi tracks in BB tracks
 	for (Track* track : tracks_BB)
 	{
-		DataFile dataFile(DataFile::SongProject);
 		MTrack mtrack;
 
-		auto itr = plists.begin();
 		std::vector<std::pair<int,int>> st;
 
 		if (track->type() != Track::InstrumentTrack) continue;
@@ -190,71 +173,64 @@ bool MidiExport::tryExport(const TrackContainer::TrackList &tracks,
 		mtrack.addTempo(tempo, 0);
 
 		instTrack = dynamic_cast<InstrumentTrack *>(track);
-		element = instTrack->saveState(dataFile, dataFile.content());
 
-		int base_pitch = 0;
-		double base_volume = 1.0;
+		const int base_pitch = basePitch(instTrack, masterPitch);
+		const double base_volume = instTrack->volumeModel()->value() / 100.0;
 
-		for (QDomNode n = element.firstChild(); !n.isNull(); n = n.nextSibling())
+		// the clip of every BB, by its index
+		const Track::clipVector & clips = track->getClips();
+		for (int bb = 0; bb < clips.size() && bb < static_cast<int>(plists.size()); ++bb)
 		{
-			if (n.nodeName() == "instrumenttrack")
+			const MidiClip* clip = dynamic_cast<const MidiClip *>(clips[bb]);
+			if (clip == nullptr)
 			{
-				QDomElement it = n.toElement();
-				base_pitch = (69 - it.attribute("basenote", "69").toInt());
-				if (it.attribute("usemasterpitch", "1").toInt())
-				{
-					base_pitch += masterPitch;
-				}
-				base_volume = LocaleHelper::toDouble(it.attribute("volume", "100")) / 100.0;
+				continue;
 			}
+			std::vector<std::pair<int,int>> &plist = plists[bb];
 
-			if (n.nodeName() == "pattern") //TODO: rename to "midiClip"
-			{
-				std::vector<std::pair<int,int>> &plist = *itr;
+			MidiNoteVector nv, midiClip;
+			writeMidiClip(midiClip, clip, base_pitch, base_volume, 0);
 
-				MidiNoteVector nv, midiClip;
-				writeMidiClip(midiClip, n, base_pitch, base_volume, 0);
+			// workaround for nested BBClips
+			int pos = 0;
+			int len = clip->steps() * TimePos::ticksPerBar() / TimePos::stepsPerBar();
+			for (auto it = plist.begin(); it != plist.end(); ++it)
+			{
+				while (!st.empty() && st.back().second <= it->first)
+				{
+					writeBBClip(midiClip, nv, len, st.back().first, pos, st.back().second);
+					pos = st.back().second;
+					st.pop_back();
+				}
 
-				// workaround for nested BBClips
-				int pos = 0;
-				int len = n.toElement().attribute("steps", "1").toInt() * 12;
-				for (auto it = plist.begin(); it != plist.end(); ++it)
+				if (!st.empty() && st.back().second <= it->second)
 				{
-					while (!st.empty() && st.back().second <= it->first)
+					writeBBClip(midiClip, nv, len, st.back().first, pos, it->first);
+					pos = it->first;
+					while (!st.empty() && st.back().second <= it->second)
 					{
-						writeBBClip(midiClip, nv, len, st.back().first, pos, st.back().second);
-						pos = st.back().second;
 						st.pop_back();
 					}
-
-					if (!st.empty() && st.back().second <= it->second)
-					{
-						writeBBClip(midiClip, nv, len, st.back().first, pos, it->first);
-						pos = it->first;
-						while (!st.empty() && st.back().second <= it->second)
-						{
-							st.pop_back();
-						}
-					}
-
-					st.push_back(*it);
-					pos = it->first;
 				}
 
-				while (!st.empty())
-				{
-					writeBBClip(midiClip, nv, len, st.back().first, pos, st.back().second);
-					pos = st.back().second;
-					st.pop_back();
-				}
+				st.push_back(*it);
+				pos = it->first;
+			}
 
-				ProcessBBNotes(nv, pos);
-				writeMidiClipToTrack(mtrack, nv);
-				++itr;
+			while (!st.empty())
+			{
+				writeBBClip(midiClip, nv, len, st.back().first, pos, st.back().second);
+				pos = st.back().second;
+				st.pop_back();
 			}
+
+			ProcessBBNotes(nv, pos);
+			writeMidiClipToTrack(mtrack, nv);
+		}
+		if (!writeTrack(f, mtrack))
+		{
+			return false;
 		}
-		size = mtrack.writeToBuffer(buffer);
-		midiout.writeRawData((char *)buffer, size);
 	}
 
 	return true;
@@ -263,21 +239,57 @@ bool MidiExport::tryExport(const TrackContainer::TrackList &tracks,
 
 
 
-void MidiExport::writeMidiClip(MidiNoteVector &midiClip, QDomNode n,
+int MidiExport::basePitch(InstrumentTrack *track, int masterPitch)
+{
+	int base_pitch = 69 - track->baseNoteModel()->value();
+	if (track->useMasterPitchModel()->value())
+	{
+		base_pitch += masterPitch;
+	}
+	return base_pitch;
+}
+
+
+
+bool MidiExport::writeTrack(QFile &f, MTrack &mtrack)
+{
+	// chunk ID, followed by the size, which is known once the data is
+	// written
+	const qint64 start = f.pos();
+	uint8_t header[8] = { 'M', 'T', 'r', 'k', 0, 0, 0, 0 };
+	f.write((char *)header, sizeof(header));
+
+	const uint32_t size = mtrack.writeEvents([&f](const uint8_t *data, size_t len)
+	{
+		f.write((const char *)data, len);
+	});
+
+	MidiFile::writeBigEndian4(size, header + 4);
+	if (!f.seek(start) || f.write((char *)header, sizeof(header)) != sizeof(header) || !f.seek(f.size()))
+	{
+		return false;
+	}
+	return f.error() == QFileDevice::NoError;
+}
+
+
+
+void MidiExport::writeMidiClip(MidiNoteVector &midiClip, const MidiClip *clip,
 				int base_pitch, double base_volume, int base_time)
 {
+	if (clip == nullptr) { return; }
+
 	// TODO interpret steps="12" muted="0" type="1" name="Piano1"  len="2592"
-	for (QDomNode nn = n.firstChild(); !nn.isNull(); nn = nn.nextSibling())
+	for (const Note* note : clip->notes())
 	{
-		QDomElement note = nn.toElement();
-		if (note.attribute("len", "0") == "0") continue;
+		if (note->length() == 0) continue;
 		// TODO interpret pan="0" mixch="0" pitchrange="1"
 		MidiNote mnote;
-		mnote.pitch = qMax(0, qMin(127, note.attribute("key", "0").toInt() + base_pitch));
+		mnote.pitch = qMax(0, qMin(127, note->key() + base_pitch));
 		 // Map from LMMS volume to MIDI velocity
-		mnote.volume = qMin(qRound(base_volume * LocaleHelper::toDouble(note.attribute("vol", "100")) * (127.0 / 200.0)), 127);
-		mnote.time = base_time + note.attribute("pos", "0").toInt();
-		mnote.duration = note.attribute("len", "0").toInt();
+		mnote.volume = qMin(qRound(base_volume * note->getVolume() * (127.0 / 200.0)), 127);
+		mnote.time = base_time + note->pos();
+		mnote.duration = note->length();
 		midiClip.push_back(mnote);
 	}
 }
@@ -300,7 +312,7 @@ void MidiExport::writeBBClip(MidiNoteVector &src, MidiNoteVector &dst,
 	if (start >= end) { return; }
 	start -= base;
 	end -= base;
-	std::sort(src.begin(), src.end());
+	// the order doesn't matter, ProcessBBNotes() sorts the result
 	for (auto it = src.begin(); it != src.end(); ++it)
 	{
 		for (int time = it->time  + ceil((start - it->time) / len)
@@ -28,12 +28,16 @@
 
 #include <QString>
 
+class QFile;
+
 #include "ExportFilter.h"
 #include "MidiFile.hpp"
 
 
-const int BUFFER_SIZE = 50*1024;
-typedef MidiFile::MIDITrack<BUFFER_SIZE> MTrack;
+class InstrumentTrack;
+class MidiClip;
+
+typedef MidiFile::MIDITrack MTrack;
 
 struct MidiNote
 {
@@ -70,9 +74,12 @@ public:
 				int tempo, int masterPitch, const QString &filename);
 	
 private:
-	void writeMidiClip(MidiNoteVector &midiClip, QDomNode n,
+	void writeMidiClip(MidiNoteVector &midiClip, const MidiClip *clip,
 				int base_pitch, double base_volume, int base_time);
 	void writeMidiClipToTrack(MTrack &mtrack, MidiNoteVector &nv);
+	//! Writes the track chunk to the file while it's generated
+	bool writeTrack(QFile &f, MTrack &mtrack);
+	static int basePitch(InstrumentTrack *track, int masterPitch);
 	void writeBBClip(MidiNoteVector &src, MidiNoteVector &dst,
 				int len, int base, int start, int end);
 	void ProcessBBNotes(MidiNoteVector &nv, int cutPos);
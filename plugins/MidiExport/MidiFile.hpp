@@ -186,6 +186,12 @@ struct Event
 	} // writeEventsToBuffer
 	
 	
+	// the most bytes writeToBuffer() writes
+	inline size_t maxSize() const
+	{
+		return 16 + trackName.size();
+	}
+
 	// events are sorted by their time
 	inline bool operator < (const Event& b) const {
 		return this->time < b.time ||
@@ -193,7 +199,6 @@ struct Event
 	}
 };
 
-template<const int MAX_TRACK_SIZE>
 class MIDITrack
 {
 	// A class that encapsulates a MIDI track
@@ -251,63 +256,54 @@ class MIDITrack
 		addEvent(event);
 	}
 	
-	inline int writeMIDIToBuffer(uint8_t *buffer, int start=0) const
+	// Writes the data of the track chunk, the events followed by the end of
+	// track event, in pieces through write(const uint8_t *data, size_t size)
+	// instead of the whole track at once. The events get sorted by their
+	// time. Returns the size of the data.
+	template<typename Write>
+	uint32_t writeEvents(Write write)
 	{
-		// Write the meta data and note data to the packed MIDI stream.
-		// Process the events in the eventList
-
-		start += writeEventsToBuffer(buffer, start);
+		std::stable_sort(events.begin(), events.end());
 
-		// Write MIDI close event.
-		buffer[start++] = 0x00;
-		buffer[start++] = 0xFF;
-		buffer[start++] = 0x2F;
-		buffer[start++] = 0x00;
-		
-		// return the entire length of the data and write to the header
-		
-		return start;
-	}
+		vector<uint8_t> buffer(4096);
+		size_t used = 0;
+		uint32_t total = 0;
+		const auto flush = [&]()
+		{
+			write(buffer.data(), used);
+			total += used;
+			used = 0;
+		};
 
-	inline int writeEventsToBuffer(uint8_t *buffer, int start=0) const
-	{
-		// Write the events in MIDIEvents to the MIDI stream.
-		vector<Event> _events = events;
-		std::sort(_events.begin(), _events.end());
-		vector<Event>::const_iterator it;
-		uint32_t time_last = 0, tmp;
-		for (it = _events.begin(); it!=_events.end(); ++it)
+		uint32_t time_last = 0;
+		for (vector<Event>::const_iterator it = events.begin(); it != events.end(); ++it)
 		{
-			Event e = *it;
-			if (e.time < time_last){
-				printf("error: e.time=%d  time_last=%d\n", e.time, time_last);
-				assert(false);
+			if (used + it->maxSize() > buffer.size())
+			{
+				flush();
+				if (it->maxSize() > buffer.size())
+				{
+					buffer.resize(it->maxSize());
+				}
 			}
-			tmp = e.time;
+			Event e = *it;
 			e.time -= time_last;
-			time_last = tmp;
-			start += e.writeToBuffer(buffer+start);
-			if (start >= MAX_TRACK_SIZE) {
-				break;
-			}
+			time_last = it->time;
+			used += e.writeToBuffer(buffer.data() + used);
 		}
-		return start;
-	}
-	
-	inline int writeToBuffer(uint8_t *buffer, int start=0) const
-	{
-		uint8_t eventsBuffer[MAX_TRACK_SIZE];
-		uint32_t events_size = writeMIDIToBuffer(eventsBuffer);
-		//printf(">> track %lu events took 0x%x bytes\n", events.size(), events_size);
-		
-		// chunk ID
-		buffer[start++] = 'M'; buffer[start++] = 'T'; buffer[start++] = 'r'; buffer[start++] = 'k';
-		// chunk size
-		start += writeBigEndian4(events_size, buffer+start);
-		// copy events data
-		memmove(buffer+start, eventsBuffer, events_size);
-		start += events_size;
-		return start;
+
+		if (used + 4 > buffer.size())
+		{
+			flush();
+		}
+		// Write MIDI close event.
+		buffer[used++] = 0x00;
+		buffer[used++] = 0xFF;
+		buffer[used++] = 0x2F;
+		buffer[used++] = 0x00;
+		flush();
+
+		return total;
 	}
 };
 
@@ -30,8 +30,11 @@
 #include <QMessageBox>
 #include <QProgressDialog>
 
+#include <algorithm>
 #include <sstream>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "MidiImport.h"
 #include "TrackContainer.h"
@@ -161,6 +164,8 @@ public:
 	AutomationTrack * at;
 	AutomationClip * ap;
 	TimePos lastPos;
+	// values for ap, which are put all at once
+	std::vector<std::pair<TimePos, float>> values;
 	
 	smfMidiCC & create( TrackContainer* tc, QString tn )
 	{
@@ -181,6 +186,7 @@ public:
 
 	void clear()
 	{
+		flush();
 		at = nullptr;
 		ap = nullptr;
 		lastPos = 0;
@@ -191,6 +197,7 @@ public:
 	{
 		if( !ap || time > lastPos + DefaultTicksPerBar )
 		{
+			flush();
 			TimePos pPos = TimePos( time.getBar(), 0 );
 			ap = dynamic_cast<AutomationClip*>(
 				at->createClip(pPos));
@@ -199,11 +206,21 @@ public:
 
 		lastPos = time;
 		time = time - ap->startPosition();
-		ap->putValue( time, value, false );
-		ap->changeLength( TimePos( time.getBar() + 1, 0 ) ); 
+		values.emplace_back( time, value );
 
 		return *this;
 	}
+
+
+	void flush()
+	{
+		if( ap && !values.empty() )
+		{
+			ap->putValues( values, false );
+			ap->changeLength( TimePos( values.back().first.getBar() + 1, 0 ) );
+		}
+		values.clear();
+	}
 };
 
 
@@ -226,6 +243,8 @@ public:
 	bool isSF2; 
 	bool hasNotes;
 	QString trackName;
+	// split into clips and added all at once in the end
+	std::vector<Note> notes;
 	
 	smfMidiChannel * create( TrackContainer* tc, QString tn )
 	{
@@ -271,29 +290,34 @@ public:
 		{
 			p = dynamic_cast<MidiClip*>(it->createClip(0));
 		}
-		p->addNote(n, false);
+		notes.push_back(n);
 		hasNotes = true;
 	}
 
 	void splitMidiClips()
 	{
 		MidiClip * newMidiClip = nullptr;
+		std::vector<Note> clipNotes;
 		TimePos lastEnd(0);
 
-		p->rearrangeAllNotes();
-		for (auto n : p->notes())
+		std::stable_sort(notes.begin(), notes.end(),
+			[](const Note& a, const Note& b) { return Note::lessThan(&a, &b); });
+		for (const Note& n : notes)
 		{
-			if (!newMidiClip || n->pos() > lastEnd + DefaultTicksPerBar)
+			if (!newMidiClip || n.pos() > lastEnd + DefaultTicksPerBar)
 			{
-				TimePos pPos = TimePos(n->pos().getBar(), 0);
+				if (newMidiClip) { newMidiClip->addNotes(clipNotes, false); }
+				clipNotes.clear();
+				TimePos pPos = TimePos(n.pos().getBar(), 0);
 				newMidiClip = dynamic_cast<MidiClip*>(it->createClip(pPos));
 			}
-			lastEnd = n->pos() + n->length();
+			lastEnd = n.pos() + n.length();
 
-			Note newNote(*n);
-			newNote.setPos(n->pos(newMidiClip->startPosition()));
-			newMidiClip->addNote(newNote, false);
+			clipNotes.push_back(n);
+			clipNotes.back().setPos(n.pos(newMidiClip->startPosition()));
 		}
+		if (newMidiClip) { newMidiClip->addNotes(clipNotes, false); }
+		notes.clear();
 
 		delete p;
 		p = nullptr;
@@ -351,12 +375,16 @@ bool MidiImport::readSMF( TrackContainer* tc )
 
 	// Time-sig changes
 	Alg_time_sigs * timeSigs = &seq->time_sig;
+	std::vector<std::pair<TimePos, float>> numerators;
+	std::vector<std::pair<TimePos, float>> denominators;
 	for( int s = 0; s < timeSigs->length(); ++s )
 	{
 		Alg_time_sig timeSig = (*timeSigs)[s];
-		timeSigNumeratorPat->putValue(timeSig.beat * ticksPerBeat, timeSig.num);
-		timeSigDenominatorPat->putValue(timeSig.beat * ticksPerBeat, timeSig.den);
+		numerators.emplace_back(timeSig.beat * ticksPerBeat, timeSig.num);
+		denominators.emplace_back(timeSig.beat * ticksPerBeat, timeSig.den);
 	}
+	timeSigNumeratorPat->putValues(numerators);
+	timeSigDenominatorPat->putValues(denominators);
 	// manually call otherwise the pattern shows being 1 bar
 	timeSigNumeratorPat->updateLength();
 	timeSigDenominatorPat->updateLength();
@@ -370,18 +398,20 @@ bool MidiImport::readSMF( TrackContainer* tc )
 		tap->clear();
 		Alg_time_map * timeMap = seq->get_time_map();
 		Alg_beats & beats = timeMap->beats;
+		std::vector<std::pair<TimePos, float>> tempos;
 		for( int i = 0; i < beats.len - 1; i++ )
 		{
 			Alg_beat_ptr b = &(beats[i]);
 			double tempo = ( beats[i + 1].beat - b->beat ) /
 						   ( beats[i + 1].time - beats[i].time );
-			tap->putValue( b->beat * ticksPerBeat, tempo * 60.0 );
+			tempos.emplace_back( b->beat * ticksPerBeat, tempo * 60.0 );
 		}
 		if( timeMap->last_tempo_flag )
 		{
 			Alg_beat_ptr b = &( beats[beats.len - 1] );
-			tap->putValue( b->beat * ticksPerBeat, timeMap->last_tempo * 60.0 );
+			tempos.emplace_back( b->beat * ticksPerBeat, timeMap->last_tempo * 60.0 );
 		}
+		tap->putValues( tempos );
 	}
 
 	// Update the tempo to avoid crash when playing a project imported
@@ -558,6 +588,11 @@ bool MidiImport::readSMF( TrackContainer* tc )
 		}
 	}
 
+	for( int c = 0; c < MIDI_CC_COUNT; c++ )
+	{
+		ccs[c].flush();
+	}
+
 	delete seq;
 	
 	
@@ -87,7 +87,8 @@ PLUGIN_EXPORT Plugin * lmms_plugin_main( Model *m, void * )
 }
 
 // I'd much rather do without a mutex, but it looks like
-// the emulator code isn't really ready for threads
+// the emulator code isn't really ready for threads: fmopl keeps the
+// channel pointers and LFO state of the chip being rendered in globals
 QMutex OpulenzInstrument::emulatorMutex;
 
 // Weird ordering of voice parameters
@@ -219,21 +220,25 @@ OpulenzInstrument::OpulenzInstrument( InstrumentTrack * _instrument_track ) :
 }
 
 OpulenzInstrument::~OpulenzInstrument() {
-	delete theEmulator;
 	Engine::audioEngine()->removePlayHandlesOfTypes( instrumentTrack(),
 				PlayHandle::TypeNotePlayHandle
 				| PlayHandle::TypeInstrumentPlayHandle );
+	emulatorMutex.lock();
+	delete theEmulator;
+	emulatorMutex.unlock();
 	delete [] renderbuffer;
 }
 
 // Samplerate changes when choosing oversampling, so this is more or less mandatory
 void OpulenzInstrument::reloadEmulator() {
-	delete theEmulator;
+	chipMutex.lock();
 	emulatorMutex.lock();
+	delete theEmulator;
 	theEmulator = new CTemuopl(Engine::audioEngine()->processingSampleRate(), true, false);
 	theEmulator->init();
 	theEmulator->write(0x01,0x20);
 	emulatorMutex.unlock();
+	chipMutex.unlock();
 	for(int i=0; i<OPL2_VOICES; ++i) {
 		voiceNote[i] = OPL2_VOICE_FREE;
 		voiceLRU[i] = i;
@@ -295,7 +300,7 @@ int OpulenzInstrument::pushVoice(int v) {
 
 bool OpulenzInstrument::handleMidiEvent( const MidiEvent& event, const TimePos& time, f_cnt_t offset )
 {
-	emulatorMutex.lock();
+	chipMutex.lock();
 	int key, vel, voice, tmp_pb;
 
 	switch(event.type()) {
@@ -382,7 +387,7 @@ bool OpulenzInstrument::handleMidiEvent( const MidiEvent& event, const TimePos&
 #endif
 		break;
         }
-	emulatorMutex.unlock();
+	chipMutex.unlock();
 	return true;
 }
 
@@ -399,18 +404,20 @@ PluginView * OpulenzInstrument::instantiateView( QWidget * _parent )
 
 void OpulenzInstrument::play( sampleFrame * _working_buffer )
 {
+	chipMutex.lock();
 	emulatorMutex.lock();
 	theEmulator->update(renderbuffer, frameCount);
+	emulatorMutex.unlock();
+	chipMutex.unlock();
 
+	// The render buffer is ours alone, so the conversion runs unlocked
+	const float scale = 1.0f / 8192;
 	for( fpp_t frame = 0; frame < frameCount; ++frame )
-        {
-                sample_t s = float(renderbuffer[frame]) / 8192.0;
-                for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
-                {
-                        _working_buffer[frame][ch] = s;
-                }
+	{
+		const sample_t s = renderbuffer[frame] * scale;
+		_working_buffer[frame][0] = s;
+		_working_buffer[frame][1] = s;
 	}
-	emulatorMutex.unlock();
 
 	// Throw the data to the track...
 	instrumentTrack()->processAudioBuffer( _working_buffer, frameCount, nullptr );
@@ -489,7 +496,7 @@ void OpulenzInstrument::loadSettings( const QDomElement & _this )
 
 // Load a patch into the emulator
 void OpulenzInstrument::loadPatch(const unsigned char inst[14]) {
-	emulatorMutex.lock();
+	chipMutex.lock();
 	for(int v=0; v<OPL2_VOICES; ++v) {
 		theEmulator->write(0x20+adlib_opadd[v],inst[0]); // op1 AM/VIB/EG/KSR/Multiplier
 		theEmulator->write(0x23+adlib_opadd[v],inst[1]); // op2
@@ -503,7 +510,7 @@ void OpulenzInstrument::loadPatch(const unsigned char inst[14]) {
 		theEmulator->write(0xe3+adlib_opadd[v],inst[9]); // op2
 		theEmulator->write(0xc0+v,inst[10]);             // feedback/algorithm
 	}
-	emulatorMutex.unlock();
+	chipMutex.unlock();
 }
 
 void OpulenzInstrument::tuneEqual(int center, float Hz) {
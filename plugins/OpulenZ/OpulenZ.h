@@ -133,7 +133,11 @@ private:
 	int pushVoice(int v);
 
 	int Hz2fnum(float Hz);
+	// The emulator shares its tables and rendering state between all chips,
+	// so chips are created, deleted and rendered one at a time
 	static QMutex emulatorMutex;
+	// Register writes and rendering of this instance's chip
+	QMutex chipMutex;
 	void setVoiceVelocity(int voice, int vel);
 
 	// Pitch bend range comes through RPNs.
@@ -90,6 +90,49 @@ bool ReverbSCEffect::processAudioBuffer( sampleFrame* buf, const fpp_t frames )
 	ValueBuffer * colorBuf = m_reverbSCControls.m_colorModel.valueBuffer();
 	ValueBuffer * outGainBuf = m_reverbSCControls.m_outputGainModel.valueBuffer();
 
+	if( sizeBuf == nullptr && colorBuf == nullptr )
+	{
+		// the reverb's parameters are the same for the whole period,
+		// so its delay lines are computed in blocks
+		revsc->feedback = (SPFLOAT)m_reverbSCControls.m_sizeModel.value();
+		revsc->lpfreq = (SPFLOAT)m_reverbSCControls.m_colorModel.value();
+
+		SPFLOAT inL[BlockSize], inR[BlockSize], outL[BlockSize], outR[BlockSize];
+		for( fpp_t start = 0; start < frames; start += BlockSize )
+		{
+			const int block = qMin<int>( BlockSize, frames - start );
+			for( int i = 0; i < block; ++i )
+			{
+				const fpp_t f = start + i;
+				const SPFLOAT inGain = (SPFLOAT)DB2LIN((inGainBuf ?
+					inGainBuf->values()[f]
+					: m_reverbSCControls.m_inputGainModel.value()));
+				inL[i] = buf[f][0] * inGain;
+				inR[i] = buf[f][1] * inGain;
+			}
+
+			sp_revsc_compute_block(sp, revsc, inL, inR, outL, outR, block);
+
+			for( int i = 0; i < block; ++i )
+			{
+				const fpp_t f = start + i;
+				const SPFLOAT outGain = (SPFLOAT)DB2LIN((outGainBuf ?
+					outGainBuf->values()[f]
+					: m_reverbSCControls.m_outputGainModel.value()));
+				sp_dcblock_compute(sp, dcblk[0], &outL[i], &dcblkL);
+				sp_dcblock_compute(sp, dcblk[1], &outR[i], &dcblkR);
+				buf[f][0] = d * buf[f][0] + w * dcblkL * outGain;
+				buf[f][1] = d * buf[f][1] + w * dcblkR * outGain;
+
+				outSum += buf[f][0]*buf[f][0] + buf[f][1]*buf[f][1];
+			}
+		}
+
+		checkGate( outSum / frames );
+
+		return isRunning();
+	}
+
 	for( fpp_t f = 0; f < frames; ++f )
 	{
 		sample_t s[2] = { buf[f][0], buf[f][1] };
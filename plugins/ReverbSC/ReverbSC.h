@@ -51,6 +51,9 @@ public:
 	void changeSampleRate();
 
 private:
+	//! frames computed at once by sp_revsc_compute_block()
+	static constexpr int BlockSize = 64;
+
 	ReverbSCControls m_reverbSCControls;
 	sp_data *sp;
 	sp_revsc *revsc;
@@ -274,3 +274,152 @@ int sp_revsc_compute(sp_data *sp, sp_revsc *p, SPFLOAT *in1, SPFLOAT *in2, SPFLO
     *out2 = aoutR * outputGain;
     return SP_OK;
 }
+
+/* The same as sp_revsc_compute() for a block of frames, with the feedback */
+/* and lowpass frequency held for the block. The state of the eight delay  */
+/* lines is kept in arrays side by side, so that the interpolation,        */
+/* feedback and lowpass of all lines vectorize, and the read positions     */
+/* stay in registers between the rare updates of the modulation.           */
+
+int sp_revsc_compute_block(sp_data *sp, sp_revsc *p, const SPFLOAT *in1, const SPFLOAT *in2,
+                           SPFLOAT *out1, SPFLOAT *out2, int frames)
+{
+    SPFLOAT filterState[8], frac[8], vm1[8], v0[8], v1[8], v2[8];
+    int writePos[8], readPos[8], readPosFrac[8], readPosFrac_inc[8];
+    int bufferSize[8], randLine_cnt[8];
+    SPFLOAT *buf[8];
+    const SPFLOAT feedback = p->feedback;
+    SPFLOAT dampFact = p->dampFact;
+    int i, n;
+
+    if (p->initDone <= 0) return SP_NOT_OK;
+
+    if (p->lpfreq != p->prv_LPFreq) {
+        p->prv_LPFreq = p->lpfreq;
+        dampFact = 2.0 - cos(p->prv_LPFreq * (2 * M_PI) / p->sampleRate);
+        dampFact = p->dampFact = dampFact - sqrt(dampFact * dampFact - 1.0);
+    }
+
+    for (n = 0; n < 8; n++) {
+        const sp_revsc_dl *lp = &p->delayLines[n];
+        filterState[n] = lp->filterState;
+        writePos[n] = lp->writePos;
+        readPos[n] = lp->readPos;
+        readPosFrac[n] = lp->readPosFrac;
+        readPosFrac_inc[n] = lp->readPosFrac_inc;
+        bufferSize[n] = lp->bufferSize;
+        randLine_cnt[n] = lp->randLine_cnt;
+        buf[n] = lp->buf;
+    }
+
+    i = 0;
+    while (i < frames) {
+        /* the frames until the next random line segment of any line */
+        int end, run = frames - i;
+        for (n = 0; n < 8; n++) {
+            run = randLine_cnt[n] < run ? randLine_cnt[n] : run;
+        }
+
+        for (end = i + run; i < end; i++) {
+            SPFLOAT ainL = 0.0, ainR, aoutL, aoutR;
+
+            /* "resultant junction pressure", summed in the order of sp_revsc_compute() */
+
+            for (n = 0; n < 8; n++) {
+                ainL += filterState[n];
+            }
+            ainL *= jpScale;
+            ainR = ainL + in2[i];
+            ainL = ainL + in1[i];
+
+            /* write, and gather the four samples to interpolate */
+
+            for (n = 0; n < 8; n++) {
+                int pos;
+                const int size = bufferSize[n];
+                const SPFLOAT *b = buf[n];
+
+                buf[n][writePos[n]] = (n & 1 ? ainR : ainL) - filterState[n];
+                if (++writePos[n] >= size) {
+                    writePos[n] -= size;
+                }
+
+                if (readPosFrac[n] >= DELAYPOS_SCALE) {
+                    readPos[n] += (readPosFrac[n] >> DELAYPOS_SHIFT);
+                    readPosFrac[n] &= DELAYPOS_MASK;
+                }
+                if (readPos[n] >= size)
+                    readPos[n] -= size;
+                pos = readPos[n];
+                frac[n] = (SPFLOAT) readPosFrac[n] * (SPFLOAT) (1.0 / DELAYPOS_SCALE);
+
+                if (pos > 0 && pos < (size - 2)) {
+                    vm1[n] = b[pos - 1];
+                    v0[n] = b[pos];
+                    v1[n] = b[pos + 1];
+                    v2[n] = b[pos + 2];
+                }
+                else {
+                    if (--pos < 0) pos += size;
+                    vm1[n] = b[pos];
+                    if (++pos >= size) pos -= size;
+                    v0[n] = b[pos];
+                    if (++pos >= size) pos -= size;
+                    v1[n] = b[pos];
+                    if (++pos >= size) pos -= size;
+                    v2[n] = b[pos];
+                }
+
+                readPosFrac[n] += readPosFrac_inc[n];
+            }
+
+            /* cubic interpolation, feedback gain and lowpass filter of all lines */
+
+            for (n = 0; n < 8; n++) {
+                const SPFLOAT f = frac[n];
+                SPFLOAT am1, a0, a1, a2, v;
+                a2 = f * f; a2 -= 1.0f; a2 *= (SPFLOAT) (1.0 / 6.0);
+                a1 = f; a1 += 1.0f; a1 *= 0.5f; am1 = a1 - 1.0f;
+                a0 = 3.0f * a2; a1 -= a0; am1 -= a2; a0 -= f;
+                v = (am1 * vm1[n] + a0 * v0[n] + a1 * v1[n] + a2 * v2[n]) * f + v0[n];
+                v *= feedback;
+                filterState[n] = (filterState[n] - v) * dampFact + v;
+            }
+
+            aoutL = 0.0;
+            aoutR = 0.0;
+            for (n = 0; n < 8; n += 2) {
+                aoutL += filterState[n];
+                aoutR += filterState[n + 1];
+            }
+            out1[i] = aoutL * outputGain;
+            out2[i] = aoutR * outputGain;
+        }
+
+        /* start next random line segment of the lines which reached their endpoint */
+
+        for (n = 0; n < 8; n++) {
+            randLine_cnt[n] -= run;
+            if (randLine_cnt[n] <= 0) {
+                sp_revsc_dl *lp = &p->delayLines[n];
+                lp->writePos = writePos[n];
+                lp->readPos = readPos[n];
+                lp->readPosFrac = readPosFrac[n];
+                next_random_lineseg(p, lp, n);
+                readPosFrac_inc[n] = lp->readPosFrac_inc;
+                randLine_cnt[n] = lp->randLine_cnt;
+            }
+        }
+    }
+
+    for (n = 0; n < 8; n++) {
+        sp_revsc_dl *lp = &p->delayLines[n];
+        lp->filterState = filterState[n];
+        lp->writePos = writePos[n];
+        lp->readPos = readPos[n];
+        lp->readPosFrac = readPosFrac[n];
+        lp->readPosFrac_inc = readPosFrac_inc[n];
+        lp->randLine_cnt = randLine_cnt[n];
+    }
+    return SP_OK;
+}
@@ -0,0 +1,112 @@
+/*
+ * revsc_bench - compares sp_revsc_compute_block() with sp_revsc_compute()
+ *
+ * Renders the same noise bursts through both and prints the largest
+ * difference of their outputs and the best time of each, as JSON.
+ * Build with "make reverbsc_bench".
+ *
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#include "base.h"
+#include "revsc.h"
+
+#define BENCH_SRATE  44100
+#define BENCH_FRAMES (BENCH_SRATE * 20)
+#define BENCH_BLOCK  256
+#define BENCH_PASSES 5
+
+static double seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static sp_revsc *create_reverb(sp_data *sp)
+{
+    sp_revsc *revsc;
+    sp_revsc_create(&revsc);
+    sp_revsc_init(sp, revsc);
+    revsc->feedback = 0.9;
+    revsc->lpfreq = 8000;
+    return revsc;
+}
+
+int main(void)
+{
+    sp_data *sp;
+    sp_revsc *reference, *block;
+    SPFLOAT *in1, *in2, *ref1, *ref2, *out1, *out2;
+    double start, referenceTime = 1e9, blockTime = 1e9, maxDiff = 0.0, maxOut = 0.0;
+    int i, pass;
+
+#ifdef __SSE__
+    /* like the audio threads of LMMS */
+    _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+#endif
+
+    sp_create(&sp);
+    sp->sr = BENCH_SRATE;
+    reference = create_reverb(sp);
+    block = create_reverb(sp);
+
+    in1 = malloc(sizeof(SPFLOAT) * BENCH_FRAMES);
+    in2 = malloc(sizeof(SPFLOAT) * BENCH_FRAMES);
+    ref1 = malloc(sizeof(SPFLOAT) * BENCH_FRAMES);
+    ref2 = malloc(sizeof(SPFLOAT) * BENCH_FRAMES);
+    out1 = malloc(sizeof(SPFLOAT) * BENCH_FRAMES);
+    out2 = malloc(sizeof(SPFLOAT) * BENCH_FRAMES);
+
+    /* a burst of noise every second, so that the tails are measured too */
+    srand(1);
+    for (i = 0; i < BENCH_FRAMES; i++) {
+        const int burst = i % BENCH_SRATE < BENCH_SRATE / 10;
+        in1[i] = burst ? (SPFLOAT) rand() / RAND_MAX - 0.5 : 0.0;
+        in2[i] = burst ? (SPFLOAT) rand() / RAND_MAX - 0.5 : 0.0;
+    }
+
+    /* both go on from the same state in each pass, the last ones are compared */
+    for (pass = 0; pass < BENCH_PASSES; pass++) {
+        double t;
+
+        start = seconds();
+        for (i = 0; i < BENCH_FRAMES; i++) {
+            sp_revsc_compute(sp, reference, &in1[i], &in2[i], &ref1[i], &ref2[i]);
+        }
+        t = seconds() - start;
+        referenceTime = t < referenceTime ? t : referenceTime;
+
+        start = seconds();
+        for (i = 0; i < BENCH_FRAMES; i += BENCH_BLOCK) {
+            const int frames = BENCH_FRAMES - i < BENCH_BLOCK ? BENCH_FRAMES - i : BENCH_BLOCK;
+            sp_revsc_compute_block(sp, block, &in1[i], &in2[i], &out1[i], &out2[i], frames);
+        }
+        t = seconds() - start;
+        blockTime = t < blockTime ? t : blockTime;
+    }
+
+    for (i = 0; i < BENCH_FRAMES; i++) {
+        const double d1 = fabs(ref1[i] - out1[i]);
+        const double d2 = fabs(ref2[i] - out2[i]);
+        maxDiff = d1 > maxDiff ? d1 : maxDiff;
+        maxDiff = d2 > maxDiff ? d2 : maxDiff;
+        maxOut = fabs(ref1[i]) > maxOut ? fabs(ref1[i]) : maxOut;
+    }
+
+    printf("{ \"frames\": %d, \"referenceSeconds\": %f, \"blockSeconds\": %f, "
+           "\"speedup\": %f, \"maxDifference\": %g, \"maxOutput\": %g }\n",
+           BENCH_FRAMES, referenceTime, blockTime, referenceTime / blockTime,
+           maxDiff, maxOut);
+
+    free(in1); free(in2); free(ref1); free(ref2); free(out1); free(out2);
+    sp_revsc_destroy(&reference);
+    sp_revsc_destroy(&block);
+    sp_destroy(&sp);
+    return 0;
+}
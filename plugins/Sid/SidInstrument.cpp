@@ -34,6 +34,7 @@
 
 #include "SidInstrument.h"
 #include "AudioEngine.h"
+#include "ComboBox.h"
 #include "Engine.h"
 #include "InstrumentTrack.h"
 #include "Knob.h"
@@ -42,6 +43,7 @@
 #include "ToolTip.h"
 
 #include "embed.h"
+#include "gui_templates.h"
 #include "plugin_export.h"
 
 #define C64_PAL_CYCLES_PER_SEC  985248
@@ -68,6 +70,19 @@ static const char *decRelTime[16] = { "6 ms", "24 ms", "48 ms", "72 ms",
 static const int relTime[16] = { 6, 24, 48, 72, 114, 168, 204, 240, 300, 750,
 								1500, 2400, 3000, 9000, 15000, 24000 };
 
+static const sampling_method samplingMethods[SidInstrument::NumSamplingMethods] =
+	{ SAMPLE_FAST, SAMPLE_INTERPOLATE, SAMPLE_RESAMPLE, SAMPLE_RESAMPLE_FASTMEM };
+
+
+// a chip and what its sampling was set up for
+struct SidChip
+{
+	MM_OPERATORS
+	SID sid;
+	sample_rate_t sampleRate;
+	int sampling;
+} ;
+
 
 extern "C"
 {
@@ -129,17 +144,33 @@ SidInstrument::SidInstrument( InstrumentTrack * _instrument_track ) :
 	// misc
 	m_voice3OffModel( false, this, tr( "Voice 3 off" ) ),
 	m_volumeModel( 15.0f, 0.0f, 15.0f, 1.0f, this, tr( "Volume" ) ),
-	m_chipModel( sidMOS8580, 0, NumChipModels-1, this, tr( "Chip model" ) )
+	m_chipModel( sidMOS8580, 0, NumChipModels-1, this, tr( "Chip model" ) ),
+	m_samplingModel( this, tr( "Sampling method" ) )
 {
 	for( int i = 0; i < 3; ++i )
 	{
 		m_voice[i] = new voiceObject( this, i );
 	}
+
+	m_samplingModel.addItem( tr( "Fast" ) );
+	m_samplingModel.addItem( tr( "Interpolated" ) );
+	m_samplingModel.addItem( tr( "Resampled" ) );
+	m_samplingModel.addItem( tr( "Resampled, fast" ) );
+	m_samplingModel.setValue( SamplingFast );
+
+	m_chips.reserve( ChipPoolSize );
+	updateChips();
+
+	connect( &m_samplingModel, SIGNAL( dataChanged() ),
+			this, SLOT( updateChips() ) );
+	connect( Engine::audioEngine(), SIGNAL( sampleRateChanged() ),
+			this, SLOT( updateChips() ) );
 }
 
 
 SidInstrument::~SidInstrument()
 {
+	qDeleteAll( m_chips );
 }
 
 
@@ -184,6 +215,7 @@ void SidInstrument::saveSettings( QDomDocument & _doc,
 	m_voice3OffModel.saveSettings( _doc, _this, "voice3Off" );
 	m_volumeModel.saveSettings( _doc, _this, "volume" );
 	m_chipModel.saveSettings( _doc, _this, "chipModel" );
+	m_samplingModel.saveSettings( _doc, _this, "sampling" );
 }
 
 
@@ -218,6 +250,14 @@ void SidInstrument::loadSettings( const QDomElement & _this )
 	m_voice3OffModel.loadSettings( _this, "voice3Off" );
 	m_volumeModel.loadSettings( _this, "volume" );
 	m_chipModel.loadSettings( _this, "chipModel" );
+	if( _this.hasAttribute( "sampling" ) )
+	{
+		m_samplingModel.loadSettings( _this, "sampling" );
+	}
+	else
+	{
+		m_samplingModel.setValue( SamplingFast );
+	}
 }
 
 
@@ -312,17 +352,14 @@ void SidInstrument::playNote( NotePlayHandle * _n,
 
 	if ( tfp == 0 )
 	{
-		SID *sid = new SID();
-		sid->set_sampling_parameters( clockrate, SAMPLE_FAST, samplerate );
-		sid->set_chip_model( MOS8580 );
-		sid->enable_filter( true );
-		sid->reset();
-		_n->m_pluginData = sid;
+		SidChip * chip = takeChip();
+		chip->sid.reset();
+		_n->m_pluginData = chip;
 	}
 	const fpp_t frames = _n->framesLeftForCurrentPeriod();
 	const f_cnt_t offset = _n->noteOffset();
 
-	SID *sid = static_cast<SID *>( _n->m_pluginData );
+	SID *sid = &static_cast<SidChip *>( _n->m_pluginData )->sid;
 	int delta_t = clockrate * frames / samplerate + 4;
 	// avoid variable length array for msvc compat
 	short* buf = reinterpret_cast<short*>(_working_buffer + offset);
@@ -448,7 +485,92 @@ void SidInstrument::playNote( NotePlayHandle * _n,
 
 void SidInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<SID *>( _n->m_pluginData );
+	giveChip( static_cast<SidChip *>( _n->m_pluginData ) );
+}
+
+
+
+
+SidChip * SidInstrument::createChip()
+{
+	SidChip * chip = new SidChip;
+	chip->sampleRate = Engine::audioEngine()->processingSampleRate();
+	chip->sampling = m_samplingModel.value();
+	if( !chip->sid.set_sampling_parameters( C64_PAL_CYCLES_PER_SEC,
+			samplingMethods[chip->sampling], chip->sampleRate ) )
+	{
+		// the resampling methods don't work with every sample rate
+		chip->sid.set_sampling_parameters( C64_PAL_CYCLES_PER_SEC,
+			SAMPLE_FAST, chip->sampleRate );
+	}
+	chip->sid.set_chip_model( MOS8580 );
+	chip->sid.enable_filter( true );
+	return chip;
+}
+
+
+
+
+bool SidInstrument::isCurrent( const SidChip * chip ) const
+{
+	return chip->sampleRate == Engine::audioEngine()->processingSampleRate() &&
+		chip->sampling == m_samplingModel.value();
+}
+
+
+
+
+SidChip * SidInstrument::takeChip()
+{
+	QMutexLocker lock( &m_chipsMutex );
+	while( !m_chips.isEmpty() )
+	{
+		SidChip * chip = m_chips.last();
+		m_chips.removeLast();
+		if( isCurrent( chip ) )
+		{
+			return chip;
+		}
+		delete chip;
+	}
+	lock.unlock();
+	// more notes at once than chips ready
+	return createChip();
+}
+
+
+
+
+void SidInstrument::giveChip( SidChip * chip )
+{
+	QMutexLocker lock( &m_chipsMutex );
+	if( isCurrent( chip ) && m_chips.size() < ChipPoolSize )
+	{
+		m_chips.append( chip );
+		return;
+	}
+	lock.unlock();
+	delete chip;
+}
+
+
+
+
+void SidInstrument::updateChips()
+{
+	QVector<SidChip *> chips;
+	chips.reserve( ChipPoolSize );
+	for( int i = 0; i < ChipPoolSize; ++i )
+	{
+		chips.append( createChip() );
+	}
+
+	m_chipsMutex.lock();
+	m_chips.swap( chips );
+	m_chips.reserve( ChipPoolSize );
+	m_chipsMutex.unlock();
+
+	qDeleteAll( chips );
 }
 
 
@@ -533,6 +655,11 @@ SidInstrumentView::SidInstrumentView( Instrument * _instrument,
 	m_offButton->setInactiveGraphic( PLUGIN_NAME::getIconPixmap( "3off" ) );
 	ToolTip::add( m_offButton, tr( "Voice 3 off ") );
 
+	m_samplingBox = new ComboBox( this );
+	m_samplingBox->setGeometry( 142, 34, 102, ComboBox::DEFAULT_HEIGHT );
+	m_samplingBox->setFont( pointSize<8>( m_samplingBox->font() ) );
+	ToolTip::add( m_samplingBox, tr( "Sampling method" ) );
+
 	PixmapButton * mos6581_btn = new PixmapButton( this, nullptr );
 	mos6581_btn->move( 170, 59 );
 	mos6581_btn->setActiveGraphic( PLUGIN_NAME::getIconPixmap( "6581red" ) );
@@ -731,6 +858,7 @@ void SidInstrumentView::modelChanged()
 	m_cutKnob->setModel( &k->m_filterFCModel );
 	m_passBtnGrp->setModel( &k->m_filterModeModel );
 	m_offButton->setModel(  &k->m_voice3OffModel );
+	m_samplingBox->setModel( &k->m_samplingModel );
 	m_sidTypeBtnGrp->setModel(  &k->m_chipModel );
 
 	for( int i = 0; i < 3; ++i )
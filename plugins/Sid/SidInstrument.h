@@ -27,7 +27,10 @@
 #ifndef _SID_H
 #define _SID_H
 
+#include <QMutex>
 #include <QObject>
+#include <QVector>
+#include "ComboBoxModel.h"
 #include "Instrument.h"
 #include "InstrumentView.h"
 #include "Knob.h"
@@ -35,6 +38,8 @@
 
 class SidInstrumentView;
 class NotePlayHandle;
+class ComboBox;
+struct SidChip;
 class automatableButtonGroup;
 class PixmapButton;
 
@@ -88,6 +93,14 @@ public:
 		NumChipModels
 	};
 
+	enum SamplingMethod {
+		SamplingFast = 0,
+		SamplingInterpolate,
+		SamplingResample,
+		SamplingResampleFastMem,
+		NumSamplingMethods
+	};
+
 
 	SidInstrument( InstrumentTrack * _instrument_track );
 	virtual ~SidInstrument();
@@ -111,7 +124,20 @@ public:
 	void updateKnobHint();
 	void updateKnobToolTip();*/
 
+private slots:
+	//! Set up the chips kept for new notes again, for the current sample
+	//! rate and sampling method
+	void updateChips();
+
 private:
+	// chips kept ready for new notes
+	static const int ChipPoolSize = 4;
+
+	SidChip * createChip();
+	bool isCurrent( const SidChip * chip ) const;
+	SidChip * takeChip();
+	void giveChip( SidChip * chip );
+
 	// voices
 	voiceObject * m_voice[3];
 
@@ -125,6 +151,11 @@ private:
 	FloatModel m_volumeModel;
 
 	IntModel m_chipModel;
+	ComboBoxModel m_samplingModel;
+
+	// set up chips, the setup of the resampling methods takes long
+	QMutex m_chipsMutex;
+	QVector<SidChip *> m_chips;
 
 	friend class SidInstrumentView;
 
@@ -193,6 +224,7 @@ private:
 	Knob * m_resKnob;
 	Knob * m_cutKnob;
 	PixmapButton * m_offButton;
+	ComboBox * m_samplingBox;
 
 protected slots:
 	void updateKnobHint();
@@ -44,7 +44,7 @@ extern "C" {
 		"Spectrum Analyzer",
 		QT_TRANSLATE_NOOP("PluginBrowser", "A graphical spectrum analyzer."),
 		"Martin Pavelek <he29/dot/HS/at/gmail/dot/com>",
-		0x0112,
+		0x0113,
 		Plugin::Effect,
 		new PluginPixmapLoader("logo"),
 		nullptr,
@@ -57,20 +57,18 @@ Analyzer::Analyzer(Model *parent, const Plugin::Descriptor::SubPluginFeatures::K
 	Effect(&analyzer_plugin_descriptor, parent, key),
 	m_processor(&m_controls),
 	m_controls(this),
-	m_processorThread(m_processor, m_inputBuffer),
 	// Buffer is sized to cover 4* the current maximum LMMS audio buffer size,
 	// so that it has some reserve space in case data processor is busy.
-	m_inputBuffer(4 * m_maxBufferSize)
+	m_inputBuffer(4 * m_maxBufferSize),
+	m_worker(SaWorker::acquire())
 {
-	m_processorThread.start();
+	m_worker->add(&m_processor, m_inputBuffer);
 }
 
 
 Analyzer::~Analyzer()
 {
-	m_processor.terminate();
-	m_inputBuffer.wakeAll();
-	m_processorThread.wait();
+	m_worker->remove(&m_processor);
 }
 
 // Take audio data and pass them to the spectrum processor.
@@ -95,7 +93,8 @@ bool Analyzer::processAudioBuffer(sampleFrame *buffer, const fpp_t frame_count)
 	{
 		// To avoid processing spikes on audio thread, data are stored in
 		// a lockless ringbuffer and processed in a separate thread.
-		m_inputBuffer.write(buffer, frame_count, true);
+		m_inputBuffer.write(buffer, frame_count);
+		m_worker->notify();
 	}
 	#ifdef SA_DEBUG
 		audio_time = std::chrono::high_resolution_clock::now().time_since_epoch().count() - audio_time;
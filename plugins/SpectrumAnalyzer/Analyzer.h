@@ -29,11 +29,13 @@
 
 #include <QWaitCondition>
 
-#include "DataprocLauncher.h"
+#include <memory>
+
 #include "Effect.h"
 #include "LocklessRingBuffer.h"
 #include "SaControls.h"
 #include "SaProcessor.h"
+#include "SaWorker.h"
 
 
 //! Top level class; handles LMMS interface and feeds data to the data processor.
@@ -55,14 +57,11 @@ private:
 	// Maximum LMMS buffer size (hard coded, the actual constant is hard to get)
 	const unsigned int m_maxBufferSize = 4096;
 
-	// QThread::create() workaround
-	// Replace DataprocLauncher by QThread and replace initializer in constructor
-	// with the following commented line when LMMS CI starts using Qt > 5.9
-	//m_processorThread = QThread::create([=]{m_processor.analyze(m_inputBuffer);});
-	DataprocLauncher m_processorThread;
-
 	LocklessRingBuffer<sampleFrame> m_inputBuffer;
 
+	// the thread shared by all analyzers
+	std::shared_ptr<SaWorker> m_worker;
+
 	#ifdef SA_DEBUG
 		int m_last_dump_time;
 		int m_dump_count;
@@ -60,7 +60,8 @@ SaControls::SaControls(Analyzer *effect) :
 	m_waterfallHeightModel(300.0f, 50.0f, 1000.0f, 50.0f, this, tr("Waterfall history size")),
 	m_waterfallGammaModel(0.30f, 0.10f, 1.00f, 0.05f, this, tr("Waterfall gamma correction")),
 	m_windowOverlapModel(2.0f, 1.0f, 4.0f, 1.0f, this, tr("FFT window overlap")),
-	m_zeroPaddingModel(2.0f, 0.0f, 4.0f, 1.0f, this, tr("FFT zero padding"))
+	m_zeroPaddingModel(2.0f, 0.0f, 4.0f, 1.0f, this, tr("FFT zero padding")),
+	m_decimationModel(1.0f, 1.0f, 8.0f, 1.0f, this, tr("FFT decimation"))
 {
 	// Frequency and amplitude ranges; order must match
 	// FREQUENCY_RANGES and AMPLITUDE_RANGES defined in SaControls.h
@@ -148,6 +149,7 @@ void SaControls::loadSettings(const QDomElement &_this)
 	m_waterfallGammaModel.loadSettings(_this, "WaterfallGamma");
 	m_windowOverlapModel.loadSettings(_this, "WindowOverlap");
 	m_zeroPaddingModel.loadSettings(_this, "ZeroPadding");
+	m_decimationModel.loadSettings(_this, "Decimation");
 }
 
 
@@ -172,5 +174,6 @@ void SaControls::saveSettings(QDomDocument &doc, QDomElement &parent)
 	m_waterfallGammaModel.saveSettings(doc, parent, "WaterfallGamma");
 	m_windowOverlapModel.saveSettings(doc, parent, "WindowOverlap");
 	m_zeroPaddingModel.saveSettings(doc, parent, "ZeroPadding");
+	m_decimationModel.saveSettings(doc, parent, "Decimation");
 
 }
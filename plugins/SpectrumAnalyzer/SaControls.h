@@ -79,6 +79,7 @@ private:
 	FloatModel m_waterfallGammaModel;
 	FloatModel m_windowOverlapModel;
 	FloatModel m_zeroPaddingModel;
+	FloatModel m_decimationModel;
 
 	// colors (hard-coded, values must add up to specific numbers)
 	QColor m_colorL;		//!< color of the left channel
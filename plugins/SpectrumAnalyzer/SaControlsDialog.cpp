@@ -291,6 +291,14 @@ SaControlsDialog::SaControlsDialog(SaControls *controls, SaProcessor *processor)
 	processor->reallocateBuffers();
 	connect(&controls->m_zeroPaddingModel, &FloatModel::dataChanged, [=] {processor->reallocateBuffers();});
 
+	// FFT decimation
+	Knob *decimationKnob = new Knob(knobSmall_17, this);
+	decimationKnob->setModel(&controls->m_decimationModel);
+	decimationKnob->setLabel(tr("Decimation"));
+	decimationKnob->setToolTip(tr("Increase to analyze only every n-th block and save CPU, e.g. with many analyzers open. The display updates less often."));
+	decimationKnob->setHintText(tr("One of"), tr(" blocks analyzed"));
+	advanced_layout->addWidget(decimationKnob, 0, 4, 1, 1, Qt::AlignCenter);
+
 
 	// Advanced settings button
 	PixmapButton *advancedButton = new PixmapButton(this, tr("Advanced settings"));
@@ -36,17 +36,18 @@
 #endif
 #include <QMutexLocker>
 
+#include "FftPlanCache.h"
 #include "lmms_math.h"
 #include "LocklessRingBuffer.h"
 
 
 SaProcessor::SaProcessor(const SaControls *controls) :
 	m_controls(controls),
-	m_terminate(false),
 	m_inBlockSize(FFT_BLOCK_SIZES[0]),
 	m_fftBlockSize(FFT_BLOCK_SIZES[0]),
 	m_sampleRate(Engine::audioEngine()->processingSampleRate()),
 	m_framesFilledUp(0),
+	m_blocksSkipped(0),
 	m_spectrumActive(false),
 	m_waterfallActive(false),
 	m_waterfallNotEmpty(0),
@@ -61,8 +62,8 @@ SaProcessor::SaProcessor(const SaControls *controls) :
 	m_filteredBufferR.resize(m_fftBlockSize, 0);
 	m_spectrumL = (fftwf_complex *) fftwf_malloc(binCount() * sizeof (fftwf_complex));
 	m_spectrumR = (fftwf_complex *) fftwf_malloc(binCount() * sizeof (fftwf_complex));
-	m_fftPlanL = fftwf_plan_dft_r2c_1d(m_fftBlockSize, m_filteredBufferL.data(), m_spectrumL, FFTW_MEASURE);
-	m_fftPlanR = fftwf_plan_dft_r2c_1d(m_fftBlockSize, m_filteredBufferR.data(), m_spectrumR, FFTW_MEASURE);
+	m_fftPlanL = FftPlanCache::realToComplex(m_fftBlockSize, m_filteredBufferL.data(), m_spectrumL);
+	m_fftPlanR = FftPlanCache::realToComplex(m_fftBlockSize, m_filteredBufferR.data(), m_spectrumR);
 
 	m_absSpectrumL.resize(binCount(), 0);
 	m_absSpectrumR.resize(binCount(), 0);
@@ -77,8 +78,6 @@ SaProcessor::SaProcessor(const SaControls *controls) :
 
 SaProcessor::~SaProcessor()
 {
-	if (m_fftPlanL != nullptr) {fftwf_destroy_plan(m_fftPlanL);}
-	if (m_fftPlanR != nullptr) {fftwf_destroy_plan(m_fftPlanR);}
 	if (m_spectrumL != nullptr) {fftwf_free(m_spectrumL);}
 	if (m_spectrumR != nullptr) {fftwf_free(m_spectrumR);}
 
@@ -90,222 +89,231 @@ SaProcessor::~SaProcessor()
 
 
 // Load data from audio thread ringbuffer and run FFT analysis if buffer is full enough.
-void SaProcessor::analyze(LocklessRingBuffer<sampleFrame> &ring_buffer)
+// Called by SaWorker, reads at most a quarter of the ringbuffer at once.
+void SaProcessor::analyze(LocklessRingBufferReader<sampleFrame> &reader, const LocklessRingBuffer<sampleFrame> &ring_buffer)
 {
-	LocklessRingBufferReader<sampleFrame> reader(ring_buffer);
+	// skip waterfall render if processing can't keep up with input
+	bool overload = ring_buffer.free() < ring_buffer.capacity() / 2;
 
-	// Processing thread loop
-	while (!m_terminate)
-	{
-		// If there is nothing to read, wait for notification from the writing side.
-		if (reader.empty()) {reader.waitForData();}
-
-		// skip waterfall render if processing can't keep up with input
-		bool overload = ring_buffer.free() < ring_buffer.capacity() / 2;
-
-		auto in_buffer = reader.read_max(ring_buffer.capacity() / 4);
-		std::size_t frame_count = in_buffer.size();
+	auto in_buffer = reader.read_max(ring_buffer.capacity() / 4);
+	std::size_t frame_count = in_buffer.size();
 
-		// Process received data only if any view is visible and not paused.
-		// Also, to prevent a momentary GUI freeze under high load (due to lock
-		// starvation), skip analysis when buffer reallocation is requested.
-		if ((m_spectrumActive || m_waterfallActive) && !m_controls->m_pauseModel.value() && !m_reallocating)
+	// Process received data only if any view is visible and not paused.
+	// Also, to prevent a momentary GUI freeze under high load (due to lock
+	// starvation), skip analysis when buffer reallocation is requested.
+	if ((m_spectrumActive || m_waterfallActive) && !m_controls->m_pauseModel.value() && !m_reallocating)
+	{
+		const bool stereo = m_controls->m_stereoModel.value();
+		fpp_t in_frame = 0;
+		while (in_frame < frame_count)
 		{
-			const bool stereo = m_controls->m_stereoModel.value();
-			fpp_t in_frame = 0;
-			while (in_frame < frame_count)
-			{
-				// Lock data access to prevent reallocation from changing
-				// buffers and control variables.
-				QMutexLocker data_lock(&m_dataAccess);
+			// Lock data access to prevent reallocation from changing
+			// buffers and control variables.
+			QMutexLocker data_lock(&m_dataAccess);
 
-				// Fill sample buffers and check for zero input.
-				bool block_empty = true;
-				for (; in_frame < frame_count && m_framesFilledUp < m_inBlockSize; in_frame++, m_framesFilledUp++)
+			// Fill sample buffers and check for zero input.
+			bool block_empty = true;
+			for (; in_frame < frame_count && m_framesFilledUp < m_inBlockSize; in_frame++, m_framesFilledUp++)
+			{
+				if (stereo)
 				{
-					if (stereo)
-					{
-						m_bufferL[m_framesFilledUp] = in_buffer[in_frame][0];
-						m_bufferR[m_framesFilledUp] = in_buffer[in_frame][1];
-					}
-					else
-					{
-						m_bufferL[m_framesFilledUp] =
-						m_bufferR[m_framesFilledUp] = (in_buffer[in_frame][0] + in_buffer[in_frame][1]) * 0.5f;
-					}
-					if (in_buffer[in_frame][0] != 0.f || in_buffer[in_frame][1] != 0.f)
-					{
-						block_empty = false;
-					}
+					m_bufferL[m_framesFilledUp] = in_buffer[in_frame][0];
+					m_bufferR[m_framesFilledUp] = in_buffer[in_frame][1];
 				}
-
-				// Run analysis only if buffers contain enough data.
-				if (m_framesFilledUp < m_inBlockSize) {break;}
-
-				// Print performance analysis once per 2 seconds if debug is enabled
-				#ifdef SA_DEBUG
-					unsigned int total_time = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-					if (total_time - m_last_dump_time > 2000000000)
-					{
-						std::cout << "FFT analysis: " << std::fixed << std::setprecision(2)
-							<< m_sum_execution / m_dump_count << " ms avg / "
-							<< m_max_execution << " ms peak, executing "
-							<< m_dump_count << " times per second ("
-							<< m_sum_execution / 20.0 << " % CPU usage)." << std::endl;
-						m_last_dump_time = total_time;
-						m_sum_execution = m_max_execution = m_dump_count = 0;
-					}
-				#endif
-
-				// update sample rate
-				m_sampleRate = Engine::audioEngine()->processingSampleRate();
-
-				// apply FFT window
-				for (unsigned int i = 0; i < m_inBlockSize; i++)
+				else
 				{
-					m_filteredBufferL[i] = m_bufferL[i] * m_fftWindow[i];
-					m_filteredBufferR[i] = m_bufferR[i] * m_fftWindow[i];
+					m_bufferL[m_framesFilledUp] =
+					m_bufferR[m_framesFilledUp] = (in_buffer[in_frame][0] + in_buffer[in_frame][1]) * 0.5f;
 				}
-
-				// Run FFT on left channel, convert the result to absolute magnitude
-				// spectrum and normalize it.
-				fftwf_execute(m_fftPlanL);
-				absspec(m_spectrumL, m_absSpectrumL.data(), binCount());
-				normalize(m_absSpectrumL, m_normSpectrumL, m_inBlockSize);
-
-				// repeat analysis for right channel if stereo processing is enabled
-				if (stereo)
+				if (in_buffer[in_frame][0] != 0.f || in_buffer[in_frame][1] != 0.f)
 				{
-					fftwf_execute(m_fftPlanR);
-					absspec(m_spectrumR, m_absSpectrumR.data(), binCount());
-					normalize(m_absSpectrumR, m_normSpectrumR, m_inBlockSize);
+					block_empty = false;
 				}
+			}
 
-				// count empty lines so that empty history does not have to update
-				if (block_empty && m_waterfallNotEmpty)
-				{
-					m_waterfallNotEmpty -= 1;
-				}
-				else if (!block_empty)
+			// Run analysis only if buffers contain enough data.
+			if (m_framesFilledUp < m_inBlockSize) {break;}
+
+			// With decimation, only every n-th block is analyzed, the
+			// ones in between just move through the buffer.
+			const unsigned int decimation = m_controls->m_decimationModel.value();
+			m_blocksSkipped = (m_blocksSkipped + 1) % std::max(decimation, 1u);
+			if (m_blocksSkipped != 0)
+			{
+				dropAnalyzedFrames();
+				continue;
+			}
+
+			// Print performance analysis once per 2 seconds if debug is enabled
+			#ifdef SA_DEBUG
+				unsigned int total_time = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+				if (total_time - m_last_dump_time > 2000000000)
 				{
-					m_waterfallNotEmpty = m_waterfallHeight + 2;
+					std::cout << "FFT analysis: " << std::fixed << std::setprecision(2)
+						<< m_sum_execution / m_dump_count << " ms avg / "
+						<< m_max_execution << " ms peak, executing "
+						<< m_dump_count << " times per second ("
+						<< m_sum_execution / 20.0 << " % CPU usage)." << std::endl;
+					m_last_dump_time = total_time;
+					m_sum_execution = m_max_execution = m_dump_count = 0;
 				}
+			#endif
+
+			// update sample rate
+			m_sampleRate = Engine::audioEngine()->processingSampleRate();
 
-				if (m_waterfallActive && m_waterfallNotEmpty)
+			// apply FFT window
+			for (unsigned int i = 0; i < m_inBlockSize; i++)
+			{
+				m_filteredBufferL[i] = m_bufferL[i] * m_fftWindow[i];
+				m_filteredBufferR[i] = m_bufferR[i] * m_fftWindow[i];
+			}
+
+			// Run FFT on left channel, convert the result to absolute magnitude
+			// spectrum and normalize it.
+			fftwf_execute_dft_r2c(m_fftPlanL, m_filteredBufferL.data(), m_spectrumL);
+			absspec(m_spectrumL, m_absSpectrumL.data(), binCount());
+			normalize(m_absSpectrumL, m_normSpectrumL, m_inBlockSize);
+
+			// repeat analysis for right channel if stereo processing is enabled
+			if (stereo)
+			{
+				fftwf_execute_dft_r2c(m_fftPlanR, m_filteredBufferR.data(), m_spectrumR);
+				absspec(m_spectrumR, m_absSpectrumR.data(), binCount());
+				normalize(m_absSpectrumR, m_normSpectrumR, m_inBlockSize);
+			}
+
+			// count empty lines so that empty history does not have to update
+			if (block_empty && m_waterfallNotEmpty)
+			{
+				m_waterfallNotEmpty -= 1;
+			}
+			else if (!block_empty)
+			{
+				m_waterfallNotEmpty = m_waterfallHeight + 2;
+			}
+
+			if (m_waterfallActive && m_waterfallNotEmpty)
+			{
+				// move waterfall history one line down and clear the top line
+				QRgb *pixel = (QRgb *)m_history_work.data();
+				std::copy(pixel,
+						  pixel + waterfallWidth() * m_waterfallHeight - waterfallWidth(),
+						  pixel + waterfallWidth());
+				memset(pixel, 0, waterfallWidth() * sizeof (QRgb));
+
+				// add newest result on top
+				int target;		// pixel being constructed
+				float accL = 0;	// accumulators for merging multiple bins
+				float accR = 0;
+				for (unsigned int i = 0; i < binCount(); i++)
 				{
-					// move waterfall history one line down and clear the top line
-					QRgb *pixel = (QRgb *)m_history_work.data();
-					std::copy(pixel,
-							  pixel + waterfallWidth() * m_waterfallHeight - waterfallWidth(),
-							  pixel + waterfallWidth());
-					memset(pixel, 0, waterfallWidth() * sizeof (QRgb));
-
-					// add newest result on top
-					int target;		// pixel being constructed
-					float accL = 0;	// accumulators for merging multiple bins
-					float accR = 0;
-					for (unsigned int i = 0; i < binCount(); i++)
+					// fill line with red color to indicate lost data if CPU cannot keep up
+					if (overload && i < waterfallWidth())
 					{
-						// fill line with red color to indicate lost data if CPU cannot keep up
-						if (overload && i < waterfallWidth())
-						{
-							pixel[i] = qRgb(42, 0, 0);
-							continue;
-						}
+						pixel[i] = qRgb(42, 0, 0);
+						continue;
+					}
 
-						// Every frequency bin spans a frequency range that must be
-						// partially or fully mapped to a pixel. Any inconsistency
-						// may be seen in the spectrogram as dark or white lines --
-						// play white noise to confirm your change did not break it.
-						float band_start = freqToXPixel(binToFreq(i) - binBandwidth() / 2.0, waterfallWidth());
-						float band_end = freqToXPixel(binToFreq(i + 1) - binBandwidth() / 2.0, waterfallWidth());
-						if (m_controls->m_logXModel.value())
+					// Every frequency bin spans a frequency range that must be
+					// partially or fully mapped to a pixel. Any inconsistency
+					// may be seen in the spectrogram as dark or white lines --
+					// play white noise to confirm your change did not break it.
+					float band_start = freqToXPixel(binToFreq(i) - binBandwidth() / 2.0, waterfallWidth());
+					float band_end = freqToXPixel(binToFreq(i + 1) - binBandwidth() / 2.0, waterfallWidth());
+					if (m_controls->m_logXModel.value())
+					{
+						// Logarithmic scale
+						if (band_end - band_start > 1.0)
 						{
-							// Logarithmic scale
-							if (band_end - band_start > 1.0)
-							{
-								// band spans multiple pixels: draw all pixels it covers
-								for (target = std::max((int)band_start, 0); target < band_end && target < waterfallWidth(); target++)
-								{
-									pixel[target] = makePixel(m_normSpectrumL[i], m_normSpectrumR[i]);
-								}
-								// save remaining portion of the band for the following band / pixel
-								// (in case the next band uses sub-pixel drawing)
-								accL = (band_end - (int)band_end) * m_normSpectrumL[i];
-								accR = (band_end - (int)band_end) * m_normSpectrumR[i];
-							}
-							else
+							// band spans multiple pixels: draw all pixels it covers
+							for (target = std::max((int)band_start, 0); target < band_end && target < waterfallWidth(); target++)
 							{
-								// sub-pixel drawing; add contribution of current band
-								target = (int)band_start;
-								if ((int)band_start == (int)band_end)
-								{
-									// band ends within current target pixel, accumulate
-									accL += (band_end - band_start) * m_normSpectrumL[i];
-									accR += (band_end - band_start) * m_normSpectrumR[i];
-								}
-								else
-								{
-									// Band ends in the next pixel -- finalize the current pixel.
-									// Make sure contribution is split correctly on pixel boundary.
-									accL += ((int)band_end - band_start) * m_normSpectrumL[i];
-									accR += ((int)band_end - band_start) * m_normSpectrumR[i];
-
-									if (target >= 0 && target < waterfallWidth()) {pixel[target] = makePixel(accL, accR);}
-
-									// save remaining portion of the band for the following band / pixel
-									accL = (band_end - (int)band_end) * m_normSpectrumL[i];
-									accR = (band_end - (int)band_end) * m_normSpectrumR[i];
-								}
+								pixel[target] = makePixel(m_normSpectrumL[i], m_normSpectrumR[i]);
 							}
+							// save remaining portion of the band for the following band / pixel
+							// (in case the next band uses sub-pixel drawing)
+							accL = (band_end - (int)band_end) * m_normSpectrumL[i];
+							accR = (band_end - (int)band_end) * m_normSpectrumR[i];
 						}
 						else
 						{
-							// Linear: always draws one or more pixels per band
-							for (target = std::max((int)band_start, 0); target < band_end && target < waterfallWidth(); target++)
+							// sub-pixel drawing; add contribution of current band
+							target = (int)band_start;
+							if ((int)band_start == (int)band_end)
 							{
-								pixel[target] = makePixel(m_normSpectrumL[i], m_normSpectrumR[i]);
+								// band ends within current target pixel, accumulate
+								accL += (band_end - band_start) * m_normSpectrumL[i];
+								accR += (band_end - band_start) * m_normSpectrumR[i];
+							}
+							else
+							{
+								// Band ends in the next pixel -- finalize the current pixel.
+								// Make sure contribution is split correctly on pixel boundary.
+								accL += ((int)band_end - band_start) * m_normSpectrumL[i];
+								accR += ((int)band_end - band_start) * m_normSpectrumR[i];
+
+								if (target >= 0 && target < waterfallWidth()) {pixel[target] = makePixel(accL, accR);}
+
+								// save remaining portion of the band for the following band / pixel
+								accL = (band_end - (int)band_end) * m_normSpectrumL[i];
+								accR = (band_end - (int)band_end) * m_normSpectrumR[i];
 							}
 						}
 					}
-
-					// Copy work buffer to result buffer. Done only if requested, so
-					// that time isn't wasted on updating faster than display FPS.
-					// (The copy is about as expensive as the movement.)
-					if (m_flipRequest)
+					else
 					{
-						m_history = m_history_work;
-						m_flipRequest = false;
+						// Linear: always draws one or more pixels per band
+						for (target = std::max((int)band_start, 0); target < band_end && target < waterfallWidth(); target++)
+						{
+							pixel[target] = makePixel(m_normSpectrumL[i], m_normSpectrumR[i]);
+						}
 					}
 				}
-				// clean up before checking for more data from input buffer
-				const unsigned int overlaps = m_controls->m_windowOverlapModel.value();
-				if (overlaps == 1)	// Discard buffer, each sample used only once
-				{
-					m_framesFilledUp = 0;
-				}
-				else
+
+				// Copy work buffer to result buffer. Done only if requested, so
+				// that time isn't wasted on updating faster than display FPS.
+				// (The copy is about as expensive as the movement.)
+				if (m_flipRequest)
 				{
-					// Drop only a part of the buffer from the beginning, so that new
-					// data can be added to the end. This means the older samples will
-					// be analyzed again, but in a different position in the window,
-					// making short transient signals show up better in the waterfall.
-					const unsigned int drop = m_inBlockSize / overlaps;
-					std::move(m_bufferL.begin() + drop, m_bufferL.end(), m_bufferL.begin());
-					std::move(m_bufferR.begin() + drop, m_bufferR.end(), m_bufferR.begin());
-					m_framesFilledUp -= drop;
+					m_history = m_history_work;
+					m_flipRequest = false;
 				}
+			}
+			// clean up before checking for more data from input buffer
+			dropAnalyzedFrames();
+
+			#ifdef SA_DEBUG
+				// measure overall FFT processing speed
+				total_time = std::chrono::high_resolution_clock::now().time_since_epoch().count() - total_time;
+				m_dump_count++;
+				m_sum_execution += total_time / 1000000.0;
+				if (total_time / 1000000.0 > m_max_execution) {m_max_execution = total_time / 1000000.0;}
+			#endif
+		}	// frame filler and processing
+	}	// process if active
+}
+
 
-				#ifdef SA_DEBUG
-					// measure overall FFT processing speed
-					total_time = std::chrono::high_resolution_clock::now().time_since_epoch().count() - total_time;
-					m_dump_count++;
-					m_sum_execution += total_time / 1000000.0;
-					if (total_time / 1000000.0 > m_max_execution) {m_max_execution = total_time / 1000000.0;}
-				#endif
-			}	// frame filler and processing
-		}	// process if active
-	}	// thread loop end
+// Make room for new data after a block was analyzed, m_dataAccess must be held.
+void SaProcessor::dropAnalyzedFrames()
+{
+	const unsigned int overlaps = m_controls->m_windowOverlapModel.value();
+	if (overlaps == 1)	// Discard buffer, each sample used only once
+	{
+		m_framesFilledUp = 0;
+	}
+	else
+	{
+		// Drop only a part of the buffer from the beginning, so that new
+		// data can be added to the end. This means the older samples will
+		// be analyzed again, but in a different position in the window,
+		// making short transient signals show up better in the waterfall.
+		const unsigned int drop = m_inBlockSize / overlaps;
+		std::move(m_bufferL.begin() + drop, m_bufferL.end(), m_bufferL.begin());
+		std::move(m_bufferR.begin() + drop, m_bufferR.end(), m_bufferR.begin());
+		m_framesFilledUp -= drop;
+	}
 }
 
 
@@ -389,9 +397,7 @@ void SaProcessor::reallocateBuffers()
 	QMutexLocker reloc_lock(&m_reallocationAccess);
 	QMutexLocker data_lock(&m_dataAccess);
 
-	// destroy old FFT plan and free the result buffer
-	if (m_fftPlanL != nullptr) {fftwf_destroy_plan(m_fftPlanL);}
-	if (m_fftPlanR != nullptr) {fftwf_destroy_plan(m_fftPlanR);}
+	// free the result buffer, the plans are kept by the FftPlanCache
 	if (m_spectrumL != nullptr) {fftwf_free(m_spectrumL);}
 	if (m_spectrumR != nullptr) {fftwf_free(m_spectrumR);}
 
@@ -404,8 +410,8 @@ void SaProcessor::reallocateBuffers()
 	m_filteredBufferR.resize(new_fft_size, 0);
 	m_spectrumL = (fftwf_complex *) fftwf_malloc(new_bins * sizeof (fftwf_complex));
 	m_spectrumR = (fftwf_complex *) fftwf_malloc(new_bins * sizeof (fftwf_complex));
-	m_fftPlanL = fftwf_plan_dft_r2c_1d(new_fft_size, m_filteredBufferL.data(), m_spectrumL, FFTW_MEASURE);
-	m_fftPlanR = fftwf_plan_dft_r2c_1d(new_fft_size, m_filteredBufferR.data(), m_spectrumR, FFTW_MEASURE);
+	m_fftPlanL = FftPlanCache::realToComplex(new_fft_size, m_filteredBufferL.data(), m_spectrumL);
+	m_fftPlanR = FftPlanCache::realToComplex(new_fft_size, m_filteredBufferR.data(), m_spectrumR);
 
 	if (m_fftPlanL == nullptr || m_fftPlanR == nullptr)
 	{
@@ -37,6 +37,8 @@
 
 template<class T>
 class LocklessRingBuffer;
+template<class T>
+class LocklessRingBufferReader;
 
 //! Receives audio data, runs FFT analysis and stores the result.
 class SaProcessor
@@ -45,9 +47,8 @@ public:
 	explicit SaProcessor(const SaControls *controls);
 	virtual ~SaProcessor();
 
-	// analysis thread and a method to terminate it
-	void analyze(LocklessRingBuffer<sampleFrame> &ring_buffer);
-	void terminate() {m_terminate = true;}
+	// analysis of the data read from the ring buffer, run by SaWorker
+	void analyze(LocklessRingBufferReader<sampleFrame> &reader, const LocklessRingBuffer<sampleFrame> &ring_buffer);
 
 	// inform processor if any processing is actually required
 	void setSpectrumActive(bool active);
@@ -107,9 +108,6 @@ public:
 private:
 	const SaControls *m_controls;
 
-	// thread communication and control
-	bool m_terminate;
-
 	// currently valid configuration
 	unsigned int m_zeroPadFactor = 2;		//!< use n-steps bigger FFT for given block size
 	std::atomic<unsigned int> m_inBlockSize;//!< size of input (time domain) data block
@@ -118,6 +116,7 @@ private:
 
 	// data buffers (roughly in the order of processing, from input to output)
 	unsigned int m_framesFilledUp;
+	unsigned int m_blocksSkipped;			//!< full blocks since the last analyzed one
 	std::vector<float> m_bufferL;			//!< time domain samples (left)
 	std::vector<float> m_bufferR;			//!< time domain samples (right)
 	std::vector<float> m_fftWindow;			//!< precomputed window function coefficients
@@ -146,6 +145,8 @@ private:
 	std::atomic<unsigned int> m_waterfallNotEmpty;	//!< number of lines remaining visible on display
 	bool m_reallocating;
 
+	void dropAnalyzedFrames();
+
 	// merge L and R channels and apply gamma correction to make a spectrogram pixel
 	QRgb makePixel(float left, float right) const;
 
@@ -0,0 +1,110 @@
+/*
+ * SaWorker.cpp - the thread analysing the data of all spectrum analyzers
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SaWorker.h"
+
+#include <algorithm>
+
+#include "denormals.h"
+#include "SaProcessor.h"
+
+
+SaWorker::SaWorker() :
+	m_exit(false)
+{
+	// the display can wait, the audio threads can't
+	start(QThread::LowPriority);
+}
+
+
+SaWorker::~SaWorker()
+{
+	m_exit = true;
+	m_sem.release();
+	wait();
+}
+
+
+std::shared_ptr<SaWorker> SaWorker::acquire()
+{
+	static std::mutex mutex;
+	static std::weak_ptr<SaWorker> worker;
+	std::lock_guard<std::mutex> guard(mutex);
+	std::shared_ptr<SaWorker> result = worker.lock();
+	if (!result)
+	{
+		result = std::shared_ptr<SaWorker>(new SaWorker());
+		worker = result;
+	}
+	return result;
+}
+
+
+void SaWorker::add(SaProcessor *processor, LocklessRingBuffer<sampleFrame> &buffer)
+{
+	std::lock_guard<std::mutex> guard(m_clientsMutex);
+	m_clients.push_back({processor, &buffer,
+		std::make_unique<LocklessRingBufferReader<sampleFrame>>(buffer)});
+}
+
+
+void SaWorker::remove(SaProcessor *processor)
+{
+	std::lock_guard<std::mutex> guard(m_clientsMutex);
+	m_clients.erase(std::remove_if(m_clients.begin(), m_clients.end(),
+		[processor](const Client &client) {return client.processor == processor;}),
+		m_clients.end());
+}
+
+
+void SaWorker::run()
+{
+	// the windows and FFTs of decaying signals would be full of them
+	disable_denormals();
+	while (true)
+	{
+		m_sem.acquire();
+		if (m_exit) {break;}
+
+		// the data of all notifications until now are read below
+		m_sem.tryAcquire(m_sem.available());
+
+		// One chunk per analyzer and round, so a busy analyzer can't hold
+		// up the others. Keep going until all buffers are empty.
+		bool pending = true;
+		while (pending && !m_exit)
+		{
+			pending = false;
+			std::lock_guard<std::mutex> guard(m_clientsMutex);
+			for (Client &client : m_clients)
+			{
+				if (!client.reader->empty())
+				{
+					client.processor->analyze(*client.reader, *client.buffer);
+					pending = pending || !client.reader->empty();
+				}
+			}
+		}
+	}
+}
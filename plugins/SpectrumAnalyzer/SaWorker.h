@@ -0,0 +1,80 @@
+/*
+ * SaWorker.h - the thread analysing the data of all spectrum analyzers
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef SAWORKER_H
+#define SAWORKER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <QSemaphore>
+#include <QThread>
+
+#include "LocklessRingBuffer.h"
+
+class SaProcessor;
+
+
+//! One low priority thread running the FFT analysis of all Analyzer
+//! instances in turn, so many analyzers don't start as many threads.
+//! Each Analyzer writes its input to its own ring buffer and notifies the
+//! worker, which reads from every buffer with data.
+class SaWorker : public QThread
+{
+public:
+	//! Stops the thread, once the last Analyzer released it
+	~SaWorker() override;
+
+	//! The worker of all analyzers, started for the first one
+	static std::shared_ptr<SaWorker> acquire();
+
+	void add(SaProcessor *processor, LocklessRingBuffer<sampleFrame> &buffer);
+	//! After this, the worker doesn't use @p processor or its buffer anymore
+	void remove(SaProcessor *processor);
+
+	//! New data were written, realtime safe enough for the audio thread
+	void notify() {m_sem.release();}
+
+private:
+	SaWorker();
+
+	void run() override;
+
+	struct Client
+	{
+		SaProcessor *processor;
+		LocklessRingBuffer<sampleFrame> *buffer;
+		std::unique_ptr<LocklessRingBufferReader<sampleFrame>> reader;
+	};
+
+	QSemaphore m_sem;
+	std::atomic<bool> m_exit;
+
+	//! held while the clients are analyzed
+	std::mutex m_clientsMutex;
+	std::vector<Client> m_clients;
+};
+
+#endif // SAWORKER_H
@@ -27,12 +27,42 @@
 #include <cmath>
 #include <QImage>
 #include <QPainter>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "ColorChooser.h"
 #include "GuiApplication.h"
 #include "MainWindow.h"
 
 
+namespace
+{
+
+// Multiply every color channel by scale / 256 (scale must not exceed 256).
+void dimPixels(uchar *pixels, std::size_t size, unsigned short scale)
+{
+	std::size_t i = 0;
+#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i factor = _mm_set1_epi16(scale);
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i bytes = _mm_loadu_si128((const __m128i *)(pixels + i));
+		const __m128i low = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(bytes, zero), factor), 8);
+		const __m128i high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(bytes, zero), factor), 8);
+		_mm_storeu_si128((__m128i *)(pixels + i), _mm_packus_epi16(low, high));
+	}
+#endif
+	for (; i < size; i++)
+	{
+		pixels[i] = (pixels[i] * scale) >> 8;
+	}
+}
+
+}
+
+
 VectorView::VectorView(VecControls *controls, LocklessRingBuffer<sampleFrame> *inputBuffer, unsigned short displaySize, QWidget *parent) :
 	QWidget(parent),
 	m_controls(controls),
@@ -96,10 +126,7 @@ void VectorView::paintEvent(QPaintEvent *event)
 	if (hq != m_oldHQ)
 	{
 		m_oldHQ = hq;
-		for (std::size_t i = 0; i < m_displayBuffer.size(); i++)
-		{
-			m_displayBuffer.data()[i] = 0;
-		}
+		std::fill(m_displayBuffer.begin(), m_displayBuffer.end(), 0);
 	}
 
 	// Dim stored image based on persistence setting and elapsed time.
@@ -123,10 +150,12 @@ void VectorView::paintEvent(QPaintEvent *event)
 		// Note that for simplicity and performance reasons, this implementation only dims all stored
 		// values by a given factor. A true simulation would also do the inverse of desaturation that
 		// occurs in high-intensity traces in HQ mode.
-		for (std::size_t i = 0; i < useableBuffer; i++)
-		{
-			m_displayBuffer.data()[i] *= persistPerFrame;
-		}
+		// The factor is applied in 8-bit fixed point; anything below 1 is capped at 255 / 256,
+		// so that every lit pixel still loses some intensity and eventually goes dark.
+		const unsigned short scale = persistPerFrame >= 1.f
+			? 256
+			: std::min(static_cast<int>(std::lround(persistPerFrame * 256)), 255);
+		dimPixels(m_displayBuffer.data(), useableBuffer, scale);
 	}
 
 	// Get new samples from the lockless input FIFO buffer
@@ -140,25 +169,37 @@ void VectorView::paintEvent(QPaintEvent *event)
 	const bool logScale = m_controls->m_logarithmicModel.value();
 	const unsigned short activeSize = hq ? m_displaySize : m_displaySize / 2;
 
+	// With high sample rates or when the GUI fell behind, more points arrive than the image
+	// can show apart from each other. Only every n-th one is drawn then; in HQ mode the
+	// line between the points drawn still follows the trace.
+	const std::size_t maxPoints = MaxPointsPerWidth * activeSize;
+	const std::size_t frameStep = (frameCount + maxPoints - 1) / maxPoints;
+
 	// Helper lambda functions for better readability
 	// Make sure pixel stays within display bounds:
 	auto saturate = [=](short pixelPos) {return qBound((short)0, pixelPos, (short)(activeSize - 1));};
 	// Take existing pixel and brigthen it. Very bright light should reduce saturation and become
 	// white. This effect is easily approximated by capping elementary colors to 255 individually.
-	auto updatePixel = [&](unsigned short x, unsigned short y, QColor addedColor)
+	auto updatePixel = [&](unsigned short x, unsigned short y, QRgb addedColor)
 	{
-		QColor currentColor = ((QRgb*)m_displayBuffer.data())[x + y * activeSize];
-		currentColor.setRed(std::min(currentColor.red() + addedColor.red(), 255));
-		currentColor.setGreen(std::min(currentColor.green() + addedColor.green(), 255));
-		currentColor.setBlue(std::min(currentColor.blue() + addedColor.blue(), 255));
-		((QRgb*)m_displayBuffer.data())[x + y * activeSize] = currentColor.rgb();
+		QRgb &currentColor = ((QRgb*)m_displayBuffer.data())[x + y * activeSize];
+		currentColor = qRgb(std::min(qRed(currentColor) + qRed(addedColor), 255),
+							std::min(qGreen(currentColor) + qGreen(addedColor), 255),
+							std::min(qBlue(currentColor) + qBlue(addedColor), 255));
 	};
 
 	if (hq)
 	{
+		// The trace color only depends on the number of points between samples
+		QRgb traceColors[101];
+		for (int points = 0; points <= 100; points++)
+		{
+			traceColors[points] = m_controls->m_colorFG.darker(75 + 20 * points).rgb();
+		}
+
 		// High quality mode: check distance between points and draw a line.
 		// The longer the line is, the dimmer, simulating real electron trace on luminescent screen.
-		for (std::size_t frame = 0; frame < frameCount; frame++)
+		for (std::size_t frame = 0; frame < frameCount; frame += frameStep)
 		{
 			float inLeft = inBuffer[frame][0] * m_zoom;
 			float inRight = inBuffer[frame][1] * m_zoom;
@@ -193,7 +234,7 @@ void VectorView::paintEvent(QPaintEvent *event)
 			// - one to 99 points between samples = follows a sharp "1/x" decaying curve,
 			// - 100 points between samples = returns approximately 5 % brightness.
 			// Everything else is discarded (by the 100 point cap) because there is not much to see anyway.
-			QColor addedColor = m_controls->m_colorFG.darker(75 + 20 * points).rgb();
+			const QRgb addedColor = traceColors[points];
 
 			// Draw the new pixel: the beam sweeps across area that may have been excited before
 			// → add new value to existing pixel state.
@@ -216,7 +257,8 @@ void VectorView::paintEvent(QPaintEvent *event)
 	{
 		// To improve performance, non-HQ mode uses smaller display size and only
 		// one full-color pixel per sample.
-		for (std::size_t frame = 0; frame < frameCount; frame++)
+		const QRgb color = m_controls->m_colorFG.rgb();
+		for (std::size_t frame = 0; frame < frameCount; frame += frameStep)
 		{
 			float inLeft = inBuffer[frame][0] * m_zoom;
 			float inRight = inBuffer[frame][1] * m_zoom;
@@ -233,7 +275,7 @@ void VectorView::paintEvent(QPaintEvent *event)
 			}
 			x = saturate(right - left + activeSize / 2.f);
 			y = saturate(activeSize - (right + left + activeSize / 2.f));
-			((QRgb*)m_displayBuffer.data())[x + y * activeSize] = m_controls->m_colorFG.rgb();
+			((QRgb*)m_displayBuffer.data())[x + y * activeSize] = color;
 		}
 	}
 
@@ -54,6 +54,9 @@ private slots:
 	void periodicUpdate();
 
 private:
+	// At most this many points per pixel of the image width are drawn in one repaint
+	static constexpr std::size_t MaxPointsPerWidth = 4;
+
 	VecControls *m_controls;
 
 	LocklessRingBuffer<sampleFrame> *m_inputBuffer;
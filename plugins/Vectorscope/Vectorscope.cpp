@@ -35,7 +35,7 @@ extern "C" {
 		"Vectorscope",
 		QT_TRANSLATE_NOOP("PluginBrowser", "A stereo field visualizer."),
 		"Martin Pavelek <he29/dot/HS/at/gmail/dot/com>",
-		0x0100,
+		0x0101,
 		Plugin::Effect,
 		new PluginPixmapLoader("logo"),
 		nullptr,
@@ -79,6 +79,14 @@ VstEffect::~VstEffect()
 
 
 
+f_cnt_t VstEffect::latency() const
+{
+	return Effect::latency() + ( m_plugin ? m_plugin->latency() : 0 );
+}
+
+
+
+
 bool VstEffect::processAudioBuffer( sampleFrame * _buf, const fpp_t _frames )
 {
 	if( !isEnabled() || !isRunning () )
@@ -44,6 +44,13 @@ public:
 	virtual bool processAudioBuffer( sampleFrame * _buf,
 							const fpp_t _frames );
 
+	f_cnt_t latency() const override;
+
+	const RemotePlugin * remotePlugin() const override
+	{
+		return m_plugin.data();
+	}
+
 	virtual EffectControls * controls()
 	{
 		return &m_vstControls;
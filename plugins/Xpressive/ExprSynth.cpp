@@ -35,7 +35,10 @@
 
 #include "interpolation.h"
 #include "lmms_math.h"
+#include "InstrumentTrack.h"
 #include "NotePlayHandle.h"
+#include "Song.h"
+#include "Engine.h"
 
 
 #include "exprtk.hpp"
@@ -78,6 +81,14 @@ struct IntegrateFunction : public exprtk::ifunction<T>
 		delete [] m_counters;
 	}
 
+	void reset()
+	{
+		m_nCounters = 0;
+		m_nCountersCalls = 0;
+		m_cc = 0;
+		clearArray(m_counters, m_max_counters);
+	}
+
 	IntegrateFunction(const unsigned int* frame, unsigned int sample_rate,unsigned int max_counters) :
 	exprtk::ifunction<T>(1),
 	m_frame(frame),
@@ -154,6 +165,11 @@ struct LastSampleFunction : public exprtk::ifunction<T>
 		}
 		return 0;
 	}
+	void reset()
+	{
+		clearArray(m_samples, m_history_size);
+		m_pivot_last = m_history_size - 1;
+	}
 	void setLastSample(const T& sample)
 	{
 		if (!std::isnan(sample) && !std::isinf(sample))
@@ -182,7 +198,10 @@ struct WaveValueFunction : public exprtk::ifunction<T>
 	: exprtk::ifunction<T>(1),
 	m_vec(v),
 	m_size(s)
-	{}
+	{
+		// lookups with constant indexes are folded into the expression
+		exprtk::disable_has_side_effects(*this);
+	}
 
 	inline T operator()(const T& index)
 	{
@@ -200,7 +219,9 @@ struct WaveValueFunctionInterpolate : public exprtk::ifunction<T>
 	: exprtk::ifunction<T>(1),
 	m_vec(v),
 	m_size(s)
-	{}
+	{
+		exprtk::disable_has_side_effects(*this);
+	}
 
 	inline T operator()(const T& index)
 	{
@@ -338,17 +359,19 @@ struct RandomVectorFunction : public exprtk::ifunction<float>
 {
 	using exprtk::ifunction<float>::operator();
 
+	// not folded at compile time, since the seed changes with each note
+	// the compiled expression is reused for
 	RandomVectorFunction(const unsigned int seed) :
 	exprtk::ifunction<float>(1),
 	m_rseed(seed)
-	{ exprtk::disable_has_side_effects(*this); }
+	{}
 
 	inline float operator()(const float& index)
 	{
 		return RandomVectorSeedFunction::randv(index,m_rseed);
 	}
 
-	const unsigned int m_rseed;
+	unsigned int m_rseed;
 };
 
 namespace SimpleRandom {
@@ -371,7 +394,8 @@ public:
 	ExprFrontData(int last_func_samples):
 	m_rand_vec(SimpleRandom::generator()),
 	m_integ_func(nullptr),
-	m_last_func(last_func_samples)
+	m_last_func(last_func_samples),
+	m_seed(0)
 	{}
 	~ExprFrontData()
 	{
@@ -397,6 +421,7 @@ public:
 	RandomVectorFunction m_rand_vec;
 	IntegrateFunction<float> *m_integ_func;
 	LastSampleFunction<float> m_last_func;
+	float m_seed;
 
 };
 
@@ -521,6 +546,7 @@ static freefunc1<float,harmonic_semitone,true> harmonic_semitone_func;
 ExprFront::ExprFront(const char * expr, int last_func_samples)
 {
 	m_valid = false;
+	m_constant = false;
 	try
 	{
 		m_data = new ExprFrontData(last_func_samples);
@@ -530,7 +556,8 @@ ExprFront::ExprFront(const char * expr, int last_func_samples)
 	
 		m_data->m_symbol_table.add_constant("e", F_E);
 
-		m_data->m_symbol_table.add_constant("seed", SimpleRandom::generator() & max_float_integer_mask);
+		m_data->m_seed = SimpleRandom::generator() & max_float_integer_mask;
+		m_data->m_symbol_table.add_variable("seed", m_data->m_seed);
 	
 		m_data->m_symbol_table.add_function("sinew", sin_wave_func);
 		m_data->m_symbol_table.add_function("squarew", square_wave_func);
@@ -567,6 +594,7 @@ ExprFront::~ExprFront()
 bool ExprFront::compile()
 {
 	m_valid = false;
+	m_constant = false;
 	try
 	{
 		m_data->m_expression.register_symbol_table(m_data->m_symbol_table);
@@ -577,6 +605,7 @@ bool ExprFront::compile()
 		parser_t parser(sstore);
 	
 		m_valid=parser.compile(m_data->m_expression_string, m_data->m_expression);
+		m_constant = m_valid && exprtk::expression_helper<float>::is_constant(m_data->m_expression);
 	}
 	catch(...)
 	{
@@ -688,55 +717,100 @@ void ExprFront::setIntegrate(const unsigned int* const frameCounter, const unsig
 	}
 }
 
-ExprSynth::ExprSynth(const WaveSample *gW1, const WaveSample *gW2, const WaveSample *gW3,
-	ExprFront *exprO1, ExprFront *exprO2,
-	NotePlayHandle *nph, const sample_rate_t sample_rate,
-	const FloatModel* pan1, const FloatModel* pan2, float rel_trans):
-	m_exprO1(exprO1),
-	m_exprO2(exprO2),
-	m_W1(gW1),
-	m_W2(gW2),
-	m_W3(gW3),
-	m_nph(nph),
-	m_sample_rate(sample_rate),
-	m_pan1(pan1),
-	m_pan2(pan2),
-	m_rel_transition(rel_trans)
+void ExprFront::reset()
 {
-	m_note_sample = 0;
-	m_note_rel_sample = 0;
-	m_note_rel_sec = 0;
-	m_note_sample_sec = 0;
-	m_released = 0;
-	m_frequency = m_nph->frequency();
-	m_rel_inc = 1000.0 / (m_sample_rate * m_rel_transition);//rel_transition in ms. compute how much increment in each frame
+	if (m_data->m_integ_func)
+	{
+		m_data->m_integ_func->reset();
+	}
+	m_data->m_last_func.reset();
+	m_data->m_rand_vec.m_rseed = SimpleRandom::generator();
+	m_data->m_seed = SimpleRandom::generator() & max_float_integer_mask;
+}
 
-	auto init_expression_step2 = [this](ExprFront * e) {
-		e->add_cyclic_vector("W1", m_W1->m_samples,m_W1->m_length, m_W1->m_interpolate);
-		e->add_cyclic_vector("W2", m_W2->m_samples,m_W2->m_length, m_W2->m_interpolate);
-		e->add_cyclic_vector("W3", m_W3->m_samples,m_W3->m_length, m_W3->m_interpolate);
+ExprProgram::ExprProgram(const char* exprO1, const char* exprO2, const WaveSample* gW1,
+	const WaveSample* gW2, const WaveSample* gW3, float& A1, float& A2, float& A3,
+	const sample_rate_t sample_rate, int generation) :
+	m_note_sample(0),
+	m_note_sample_sec(0),
+	m_note_rel_sec(0),
+	m_frequency(0),
+	m_released(0),
+	m_exprO1(new ExprFront(exprO1, sample_rate)),//give the "last" function a whole second
+	m_exprO2(new ExprFront(exprO2, sample_rate)),
+	m_generation(generation),
+	m_key(0),
+	m_bnote(0),
+	m_volume(0),
+	m_tempo(0)
+{
+	auto init_expression = [&](ExprFront * e) {
+		//add the constants and the variables to the expression.
+		e->add_variable("key", m_key);//the key that was pressed.
+		e->add_variable("bnote", m_bnote); // the base note
+		e->add_constant("srate", sample_rate);// sample rate of the audio engine
+		e->add_variable("v", m_volume); //volume of the note.
+		e->add_variable("tempo", m_tempo);//tempo of the song.
+		e->add_variable("A1", A1);//A1,A2,A3: general purpose input controls.
+		e->add_variable("A2", A2);
+		e->add_variable("A3", A3);
+		e->add_cyclic_vector("W1", gW1->m_samples,gW1->m_length, gW1->m_interpolate);
+		e->add_cyclic_vector("W2", gW2->m_samples,gW2->m_length, gW2->m_interpolate);
+		e->add_cyclic_vector("W3", gW3->m_samples,gW3->m_length, gW3->m_interpolate);
 		e->add_variable("t", m_note_sample_sec);
 		e->add_variable("f", m_frequency);
 		e->add_variable("rel",m_released);
 		e->add_variable("trel",m_note_rel_sec);
-		e->setIntegrate(&m_note_sample,m_sample_rate);
+		e->setIntegrate(&m_note_sample,sample_rate);
 		e->compile();
 	};
-	init_expression_step2(m_exprO1);
-	init_expression_step2(m_exprO2);
+	init_expression(m_exprO1);
+	init_expression(m_exprO2);
+}
 
+ExprProgram::~ExprProgram()
+{
+	delete m_exprO1;
+	delete m_exprO2;
+}
+
+void ExprProgram::start(const NotePlayHandle* nph)
+{
+	m_note_sample = 0;
+	m_note_sample_sec = 0;
+	m_note_rel_sec = 0;
+	m_frequency = nph->frequency();
+	m_released = 0;
+	m_key = nph->key();
+	m_bnote = nph->instrumentTrack()->baseNote();
+	m_volume = nph->getVolume() / 255.0;
+	m_tempo = Engine::getSong()->getTempo();
+	m_exprO1->reset();
+	m_exprO2->reset();
+}
+
+ExprSynth::ExprSynth(ExprProgram *program, NotePlayHandle *nph, const sample_rate_t sample_rate,
+	const FloatModel* pan1, const FloatModel* pan2, float rel_trans):
+	m_program(program),
+	m_exprO1(program->exprO1()),
+	m_exprO2(program->exprO2()),
+	m_note_sample(program->m_note_sample),
+	m_note_rel_sample(0),
+	m_note_sample_sec(program->m_note_sample_sec),
+	m_note_rel_sec(program->m_note_rel_sec),
+	m_frequency(program->m_frequency),
+	m_released(program->m_released),
+	m_nph(nph),
+	m_sample_rate(sample_rate),
+	m_pan1(pan1),
+	m_pan2(pan2),
+	m_rel_transition(rel_trans)
+{
+	m_rel_inc = 1000.0 / (m_sample_rate * m_rel_transition);//rel_transition in ms. compute how much increment in each frame
 }
 
 ExprSynth::~ExprSynth()
 {
-	if (m_exprO1)
-	{
-		delete m_exprO1;
-	}
-	if (m_exprO2)
-	{
-		delete m_exprO2;
-	}
 }
 
 void ExprSynth::renderOutput(fpp_t frames, sampleFrame *buf)
@@ -760,6 +834,11 @@ void ExprSynth::renderOutput(fpp_t frames, sampleFrame *buf)
 		expression_t *o2_rawExpr = &(m_exprO2->getData()->m_expression);
 		LastSampleFunction<float> * last_func1 = &m_exprO1->getData()->m_last_func;
 		LastSampleFunction<float> * last_func2 = &m_exprO2->getData()->m_last_func;
+		// constant outputs, e.g. "0" or "0.5*W1(0.25)", are evaluated once
+		bool o1_const = m_exprO1->isConstant();
+		const bool o2_const = m_exprO2->isConstant();
+		float o1_value = o1_const ? o1_rawExpr->value() : 0;
+		const float o2_value = o2_const ? o2_rawExpr->value() : 0;
 		if (is_released && m_note_rel_sample == 0)
 		{
 			m_note_rel_sample = m_note_sample;
@@ -772,8 +851,8 @@ void ExprSynth::renderOutput(fpp_t frames, sampleFrame *buf)
 				{
 					m_released = fmin(m_released+m_rel_inc, 1);
 				}
-				o1 = o1_rawExpr->value();
-				o2 = o2_rawExpr->value();
+				o1 = o1_const ? o1_value : o1_rawExpr->value();
+				o2 = o2_const ? o2_value : o2_rawExpr->value();
 				last_func1->setLastSample(o1);//put result in the circular buffer for the "last" function.
 				last_func2->setLastSample(o2);
 				buf[frame][0] = (-pn1 + 0.5) * o1 + (-pn2 + 0.5) * o2;
@@ -795,6 +874,8 @@ void ExprSynth::renderOutput(fpp_t frames, sampleFrame *buf)
 				o1_rawExpr = o2_rawExpr;
 				last_func1 = last_func2;
 				pn1 = pn2;
+				o1_const = o2_const;
+				o1_value = o2_value;
 			}
 			for (fpp_t frame = 0; frame < frames ; ++frame)
 			{
@@ -802,7 +883,7 @@ void ExprSynth::renderOutput(fpp_t frames, sampleFrame *buf)
 				{
 					m_released = fmin(m_released+m_rel_inc, 1);
 				}
-				o1 = o1_rawExpr->value();
+				o1 = o1_const ? o1_value : o1_rawExpr->value();
 				last_func1->setLastSample(o1);
 				buf[frame][0] = (-pn1 + 0.5) * o1;
 				buf[frame][1] = ( pn1 + 0.5) * o1;
@@ -44,15 +44,20 @@ public:
 	~ExprFront();
 	bool compile();
 	inline bool isValid() { return m_valid; }
+	//! The expression folded into a constant, which needs no evaluation per sample
+	inline bool isConstant() { return m_constant; }
 	float evaluate();
 	bool add_variable(const char* name, float & ref);
 	bool add_constant(const char* name, float  ref);
 	bool add_cyclic_vector(const char* name, const float* data, size_t length, bool interp = false);
 	void setIntegrate(const unsigned int* frameCounter, unsigned int sample_rate);
+	//! Forget the state of integrate() and last(), and pick a new seed
+	void reset();
 	ExprFrontData* getData() { return m_data; }
 private:
 	ExprFrontData *m_data;
 	bool m_valid;
+	bool m_constant;
 	
 	static const int max_float_integer_mask=(1<<(std::numeric_limits<float>::digits))-1;
 
@@ -88,26 +93,63 @@ public:
 	bool m_interpolate;
 };
 
+//! The output expressions of Xpressive, compiled, and the variables of a
+//! note they are bound to. Compiling is too slow for the audio thread, so
+//! the instrument keeps programs ready, and a note only sets the variables.
+class ExprProgram
+{
+	MM_OPERATORS
+public:
+	ExprProgram(const char* exprO1, const char* exprO2, const WaveSample* gW1, const WaveSample* gW2,
+			const WaveSample* gW3, float& A1, float& A2, float& A3, const sample_rate_t sample_rate,
+			int generation);
+	~ExprProgram();
+
+	//! Set the variables for a new note
+	void start(const NotePlayHandle* nph);
+
+	ExprFront* exprO1() { return m_exprO1; }
+	ExprFront* exprO2() { return m_exprO2; }
+	//! Programs of older generations were compiled from older expressions
+	int generation() const { return m_generation; }
+
+	// the variables, changed by ExprSynth while it plays
+	unsigned int m_note_sample;
+	float m_note_sample_sec;
+	float m_note_rel_sec;
+	float m_frequency;
+	float m_released;
+
+private:
+	ExprFront *m_exprO1, *m_exprO2;
+	const int m_generation;
+	float m_key;
+	float m_bnote;
+	float m_volume;
+	float m_tempo;
+} ;
+
 class ExprSynth
 {
 	MM_OPERATORS
 public:
-	ExprSynth(const WaveSample* gW1, const WaveSample* gW2, const WaveSample* gW3, ExprFront* exprO1, ExprFront* exprO2, NotePlayHandle* nph,
-			const sample_rate_t sample_rate, const FloatModel* pan1, const FloatModel* pan2, float rel_trans);
+	ExprSynth(ExprProgram* program, NotePlayHandle* nph, const sample_rate_t sample_rate,
+			const FloatModel* pan1, const FloatModel* pan2, float rel_trans);
 	virtual ~ExprSynth();
 
 	void renderOutput(fpp_t frames, sampleFrame* buf );
 
+	ExprProgram* program() { return m_program; }
 
 private:
+	ExprProgram *m_program;
 	ExprFront *m_exprO1, *m_exprO2;
-	const WaveSample *m_W1, *m_W2, *m_W3;
-	unsigned int m_note_sample;
+	unsigned int& m_note_sample;
 	unsigned int m_note_rel_sample;
-	float m_note_sample_sec;
-	float m_note_rel_sec;
-	float m_frequency;
-	float m_released;
+	float& m_note_sample_sec;
+	float& m_note_rel_sec;
+	float& m_frequency;
+	float& m_released;
 	NotePlayHandle* m_nph;
 	const sample_rate_t m_sample_rate;
 	const FloatModel *m_pan1,*m_pan2;
@@ -103,13 +103,23 @@ Xpressive::Xpressive(InstrumentTrack* instrument_track) :
 	m_W1(GRAPH_LENGTH),
 	m_W2(GRAPH_LENGTH),
 	m_W3(GRAPH_LENGTH),
-	m_exprValid(false, this)
+	m_exprValid(false, this),
+	m_programGeneration(0)
 {
 	m_outputExpression[0]="sinew(integrate(f*(1+0.05sinew(12t))))*(2^(-(1.1+A2)*t)*(0.4+0.1(1+A3)+0.4sinew((2.5+2A1)t))^2)";
 	m_outputExpression[1]="expw(integrate(f*atan(500t)*2/pi))*0.5+0.12";
+
+	m_programs.reserve(ProgramPoolSize);
+	updatePrograms();
+
+	connect(&m_interpolateW1, SIGNAL(dataChanged()), this, SLOT(updatePrograms()));
+	connect(&m_interpolateW2, SIGNAL(dataChanged()), this, SLOT(updatePrograms()));
+	connect(&m_interpolateW3, SIGNAL(dataChanged()), this, SLOT(updatePrograms()));
+	connect(Engine::audioEngine(), SIGNAL(sampleRateChanged()), this, SLOT(updatePrograms()));
 }
 
 Xpressive::~Xpressive() {
+	qDeleteAll(m_programs);
 }
 
 void Xpressive::saveSettings(QDomDocument & _doc, QDomElement & _this) {
@@ -190,6 +200,8 @@ void Xpressive::loadSettings(const QDomElement & _this) {
 	m_W1.copyFrom(&m_graphW1);
 	m_W2.copyFrom(&m_graphW2);
 	m_W3.copyFrom(&m_graphW3);
+
+	updatePrograms();
 }
 
 
@@ -204,27 +216,9 @@ void Xpressive::playNote(NotePlayHandle* nph, sampleFrame* working_buffer) {
 
 	if (nph->totalFramesPlayed() == 0 || nph->m_pluginData == nullptr) {
 
-		ExprFront *exprO1 = new ExprFront(m_outputExpression[0].constData(),Engine::audioEngine()->processingSampleRate());//give the "last" function a whole second
-		ExprFront *exprO2 = new ExprFront(m_outputExpression[1].constData(),Engine::audioEngine()->processingSampleRate());
-
-		auto init_expression_step1 = [this, nph](ExprFront* e) { //lambda function to init exprO1 and exprO2
-			//add the constants and the variables to the expression.
-			e->add_constant("key", nph->key());//the key that was pressed.
-			e->add_constant("bnote", nph->instrumentTrack()->baseNote()); // the base note
-			e->add_constant("srate", Engine::audioEngine()->processingSampleRate());// sample rate of the audio engine
-			e->add_constant("v", nph->getVolume() / 255.0); //volume of the note.
-			e->add_constant("tempo", Engine::getSong()->getTempo());//tempo of the song.
-			e->add_variable("A1", m_A1);//A1,A2,A3: general purpose input controls.
-			e->add_variable("A2", m_A2);
-			e->add_variable("A3", m_A3);
-		};
-		init_expression_step1(exprO1);
-		init_expression_step1(exprO2);
-
-		m_W1.setInterpolate(m_interpolateW1.value());//set interpolation according to the user selection.
-		m_W2.setInterpolate(m_interpolateW2.value());
-		m_W3.setInterpolate(m_interpolateW3.value());
-		nph->m_pluginData = new ExprSynth(&m_W1, &m_W2, &m_W3, exprO1, exprO2, nph,
+		ExprProgram *program = takeProgram();
+		program->start(nph);
+		nph->m_pluginData = new ExprSynth(program, nph,
 				Engine::audioEngine()->processingSampleRate(), &m_panning1, &m_panning2, m_relTransition.value());
 	}
 
@@ -241,7 +235,76 @@ void Xpressive::playNote(NotePlayHandle* nph, sampleFrame* working_buffer) {
 }
 
 void Xpressive::deleteNotePluginData(NotePlayHandle* nph) {
-	delete static_cast<ExprSynth *>(nph->m_pluginData);
+	ExprSynth *ps = static_cast<ExprSynth *>(nph->m_pluginData);
+	giveProgram(ps->program());
+	delete ps;
+}
+
+ExprProgram* Xpressive::createProgram(int generation) {
+	m_W1.setInterpolate(m_interpolateW1.value());//set interpolation according to the user selection.
+	m_W2.setInterpolate(m_interpolateW2.value());
+	m_W3.setInterpolate(m_interpolateW3.value());
+	QMutexLocker lock(&m_programsMutex);
+	const QByteArray exprO1 = m_programExpression[0];
+	const QByteArray exprO2 = m_programExpression[1];
+	lock.unlock();
+	return new ExprProgram(exprO1.constData(), exprO2.constData(), &m_W1, &m_W2, &m_W3,
+			m_A1, m_A2, m_A3, Engine::audioEngine()->processingSampleRate(), generation);
+}
+
+ExprProgram* Xpressive::takeProgram() {
+	QMutexLocker lock(&m_programsMutex);
+	if (!m_programs.isEmpty())
+	{
+		ExprProgram *program = m_programs.last();
+		m_programs.removeLast();
+		return program;
+	}
+	const int generation = m_programGeneration;
+	lock.unlock();
+	// more notes at once than programs ready
+	return createProgram(generation);
+}
+
+void Xpressive::giveProgram(ExprProgram* program) {
+	QMutexLocker lock(&m_programsMutex);
+	if (program->generation() == m_programGeneration && m_programs.size() < ProgramPoolSize)
+	{
+		m_programs.append(program);
+		return;
+	}
+	lock.unlock();
+	delete program;
+}
+
+void Xpressive::updatePrograms() {
+	QVector<ExprProgram*> oldPrograms;
+	m_programsMutex.lock();
+	const int generation = ++m_programGeneration;
+	m_programExpression[0] = m_outputExpression[0];
+	m_programExpression[1] = m_outputExpression[1];
+	oldPrograms.swap(m_programs);
+	m_programsMutex.unlock();
+
+	// compiling takes long, so the audio thread isn't locked out meanwhile
+	QVector<ExprProgram*> programs;
+	programs.reserve(ProgramPoolSize);
+	for (int i = 0; i < ProgramPoolSize; ++i)
+	{
+		programs.append(createProgram(generation));
+	}
+
+	m_programsMutex.lock();
+	if (generation == m_programGeneration)
+	{
+		m_programs.swap(programs);
+		m_programs.reserve(ProgramPoolSize);
+	}
+	m_programsMutex.unlock();
+
+	// the notes playing have their programs checked out, these are unused
+	qDeleteAll(oldPrograms);
+	qDeleteAll(programs);
 }
 
 PluginView * Xpressive::instantiateView(QWidget* parent) {
@@ -522,10 +585,18 @@ void XpressiveView::expressionChanged() {
 		e->wavesExpression(2) = text;
 		break;
 	case O1_EXPR:
-		e->outputExpression(0) = text;
+		if (e->outputExpression(0) != text)
+		{
+			e->outputExpression(0) = text;
+			e->updatePrograms();
+		}
 		break;
 	case O2_EXPR:
-		e->outputExpression(1) = text;
+		if (e->outputExpression(1) != text)
+		{
+			e->outputExpression(1) = text;
+			e->updatePrograms();
+		}
 		break;
 	}
 	if (m_wave_expr)
@@ -26,7 +26,9 @@
 #ifndef XPRESSIVE_H
 #define XPRESSIVE_H
 
+#include <QMutex>
 #include <QPlainTextEdit>
+#include <QVector>
 
 #include "Graph.h"
 #include "Instrument.h"
@@ -104,10 +106,20 @@ public:
 	static void smooth(float smoothness,const graphModel* in,graphModel* out);
 protected:
 	
-protected slots:
-
+public slots:
+	//! Compile the programs for new notes again, after the output
+	//! expressions or what they were compiled with changed
+	void updatePrograms();
 
 private:
+	// programs kept ready for new notes
+	static const int ProgramPoolSize = 8;
+
+	ExprProgram* createProgram(int generation);
+	//! Audio thread, compiles a program only if none is ready
+	ExprProgram* takeProgram();
+	void giveProgram(ExprProgram* program);
+
 	graphModel  m_graphO1;
 	graphModel  m_graphO2;
 	graphModel  m_graphW1;
@@ -135,6 +147,12 @@ private:
 	WaveSample m_W1, m_W2, m_W3;
 
 	BoolModel m_exprValid;
+
+	QMutex m_programsMutex;
+	QVector<ExprProgram*> m_programs;
+	// the expressions the programs of m_programGeneration are compiled from
+	QByteArray m_programExpression[2];
+	int m_programGeneration;
 	
 } ;
 
@@ -85,8 +85,12 @@ audioFileProcessor::audioFileProcessor( InstrumentTrack * _instrument_track ) :
 	m_stutterModel( false, this, tr( "Stutter" ) ),
 	m_interpolationModel( this, tr( "Interpolation mode" ) ),
 	m_nextPlayStartPoint( 0 ),
-	m_nextPlayBackwards( false )
+	m_nextPlayBackwards( false ),
+	m_voices( voicePoolSize() )
 {
+	// kits load many samples, which rarely need more than 16 or 24 bits
+	m_sampleBuffer.setCompactStorageAllowed( true );
+
 	connect( &m_reverseModel, SIGNAL( dataChanged() ),
 				this, SLOT( reverseModelChanged() ), Qt::DirectConnection );
 	connect( &m_ampModel, SIGNAL( dataChanged() ),
@@ -158,7 +162,7 @@ void audioFileProcessor::playNote( NotePlayHandle * _n,
 				srcmode = SRC_SINC_MEDIUM_QUALITY;
 				break;
 		}
-		_n->m_pluginData = new handleState( _n->hasDetuningInfo(), srcmode );
+		_n->m_pluginData = m_voices.acquire( _n->hasDetuningInfo(), srcmode );
 		((handleState *)_n->m_pluginData)->setFrameIndex( m_nextPlayStartPoint );
 		((handleState *)_n->m_pluginData)->setBackwards( m_nextPlayBackwards );
 
@@ -203,7 +207,7 @@ void audioFileProcessor::playNote( NotePlayHandle * _n,
 
 void audioFileProcessor::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete (handleState *)_n->m_pluginData;
+	m_voices.release( (handleState *)_n->m_pluginData );
 }
 
 
@@ -215,9 +219,8 @@ void audioFileProcessor::saveSettings( QDomDocument & _doc,
 	_this.setAttribute( "src", m_sampleBuffer.audioFile() );
 	if( m_sampleBuffer.audioFile() == "" )
 	{
-		QString s;
 		_this.setAttribute( "sampledata",
-						m_sampleBuffer.toBase64( s ) );
+				DataFile::embed( _doc, m_sampleBuffer.toData() ) );
 	}
 	m_reverseModel.saveSettings( _doc, _this, "reversed" );
 	m_loopModel.saveSettings( _doc, _this, "looped" );
@@ -249,7 +252,7 @@ void audioFileProcessor::loadSettings( const QDomElement & _this )
 	}
 	else if( _this.attribute( "sampledata" ) != "" )
 	{
-		m_sampleBuffer.loadFromBase64( _this.attribute( "srcdata" ) );
+		m_sampleBuffer.loadFromData( DataFile::embedded( _this, "sampledata" ) );
 	}
 
 	m_loopModel.loadSettings( _this, "looped" );
@@ -36,6 +36,7 @@
 #include "PixmapButton.h"
 #include "AutomatableButton.h"
 #include "ComboBox.h"
+#include "VoicePool.h"
 
 
 class audioFileProcessor : public Instrument
@@ -64,6 +65,11 @@ public:
 		return 128;
 	}
 
+	size_t memoryUsage() const override
+	{
+		return m_sampleBuffer.bytes();
+	}
+
 	virtual PluginView * instantiateView( QWidget * _parent );
 
 
@@ -102,6 +108,8 @@ private:
 	f_cnt_t m_nextPlayStartPoint;
 	bool m_nextPlayBackwards;
 
+	VoicePool<handleState> m_voices;
+
 	friend class AudioFileProcessorView;
 
 } ;
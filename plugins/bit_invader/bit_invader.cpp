@@ -38,13 +38,11 @@
 #include "PixmapButton.h"
 #include "ToolTip.h"
 #include "Song.h"
-#include "interpolation.h"
 
 #include "embed.h"
 
 #include "plugin_export.h"
 
-static const int wavetableSize = 200;
 static const float defaultNormalizationFactor = 1.0f;
 
 extern "C"
@@ -67,18 +65,13 @@ Plugin::Descriptor PLUGIN_EXPORT bitinvader_plugin_descriptor =
 }
 
 
-bSynth::bSynth( float * _shape, NotePlayHandle * _nph, bool _interpolation,
-				float _factor, const sample_rate_t _sample_rate ) :
-	sample_index( 0 ),
-	sample_realindex( 0 ),
-	nph( _nph ),
-	sample_rate( _sample_rate ),
-	interpolation( _interpolation)
+bWave::bWave( const float * _samples, int _length, float _factor,
+						bool _interpolation ) :
+	m_length( _length )
 {
-	sample_shape = new float[wavetableSize];
 	for (int i=0; i < wavetableSize; ++i)
 	{
-		float buf = _shape[i] * _factor;
+		float buf = _samples[i] * _factor;
 
 		/* Double check that normalization has been performed correctly,
 		i.e., the absolute value of all samples is <= 1.0 if _factor
@@ -88,21 +81,38 @@ bSynth::bSynth( float * _shape, NotePlayHandle * _nph, bool _interpolation,
 		{
 			buf = (buf < 0) ? -1.0f : 1.0f;
 		}
-		sample_shape[i] = buf;
+		m_shape[i] = buf;
 	}
+
+	if( _interpolation )
+	{
+		m_mipmap.reset( new UserWaveMipMap( m_shape, m_length ) );
+	}
+}
+
+
+
+
+bSynth::bSynth( std::shared_ptr<const bWave> _wave, NotePlayHandle * _nph,
+					const sample_rate_t _sample_rate ) :
+	sample_realindex( 0 ),
+	wave( std::move( _wave ) ),
+	nph( _nph ),
+	sample_rate( _sample_rate )
+{
 }
 
 
 bSynth::~bSynth()
 {
-	delete[] sample_shape;
 }
 
 
-sample_t bSynth::nextStringSample( float sample_length )
+sample_t bSynth::nextStringSample()
 {
-	float sample_step = 
-		static_cast<float>( sample_length / ( sample_rate / nph->frequency() ) );
+	const float sample_length = wave->length();
+	const float wavelen = sample_rate / nph->frequency();
+	const float sample_step = sample_length / wavelen;
 
 	
 	// check overflow
@@ -110,29 +120,7 @@ sample_t bSynth::nextStringSample( float sample_length )
 		sample_realindex -= sample_length;
 	}
 
-	sample_t sample;
-
-	if (interpolation) {
-
-		// find position in shape 
-		int a = static_cast<int>(sample_realindex);	
-		int b;
-		if (a < (sample_length-1)) {
-			b = static_cast<int>(sample_realindex+1);
-		} else {
-			b = 0;
-		}
-		
-		// Nachkommaanteil
-		const float frac = fraction( sample_realindex );
-		
-		sample = linearInterpolate( sample_shape[a], sample_shape[b], frac );
-
-	} else {
-		// No interpolation
-		sample_index = static_cast<int>(sample_realindex);	
-		sample = sample_shape[sample_index];
-	}
+	const sample_t sample = wave->sampleAt( sample_realindex, wavelen );
 	
 	// progress in shape
 	sample_realindex += sample_step;
@@ -154,7 +142,8 @@ bitInvader::bitInvader( InstrumentTrack * _instrument_track ) :
 	m_sampleLength(wavetableSize, 4, wavetableSize, 1, this, tr("Sample length")),
 	m_graph(-1.0f, 1.0f, wavetableSize, this),
 	m_interpolation( false, this ),
-	m_normalize( false, this )
+	m_normalize( false, this ),
+	m_voices( voicePoolSize() )
 {
 	m_graph.setWaveToSine();
 	lengthChanged();
@@ -164,6 +153,11 @@ bitInvader::bitInvader( InstrumentTrack * _instrument_track ) :
 
 	connect( &m_graph, SIGNAL( samplesChanged( int, int ) ),
 			this, SLOT( samplesChanged( int, int ) ) );
+
+	connect( &m_interpolation, SIGNAL( dataChanged( ) ),
+			this, SLOT( updateWave( ) ), Qt::DirectConnection );
+	connect( &m_normalize, SIGNAL( dataChanged( ) ),
+			this, SLOT( updateWave( ) ), Qt::DirectConnection );
 }
 
 
@@ -237,6 +231,7 @@ void bitInvader::lengthChanged()
 	m_graph.setLength( (int) m_sampleLength.value() );
 
 	normalize();
+	updateWave();
 }
 
 
@@ -245,6 +240,7 @@ void bitInvader::lengthChanged()
 void bitInvader::samplesChanged( int _begin, int _end )
 {
 	normalize();
+	updateWave();
 	//engine::getSongEditor()->setModified();
 }
 
@@ -267,6 +263,16 @@ void bitInvader::normalize()
 
 
 
+void bitInvader::updateWave()
+{
+	std::atomic_store( &m_wave, std::shared_ptr<const bWave>(
+			new bWave( m_graph.samples(), m_graph.length(),
+				normalizationFactor(), m_interpolation.value() ) ) );
+}
+
+
+
+
 QString bitInvader::nodeName() const
 {
 	return( bitinvader_plugin_descriptor.name );
@@ -278,23 +284,38 @@ QString bitInvader::nodeName() const
 void bitInvader::playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer )
 {
-	if ( _n->totalFramesPlayed() == 0 || _n->m_pluginData == nullptr )
+	playNote( _n, _working_buffer, std::atomic_load( &m_wave ) );
+}
+
+
+
+
+void bitInvader::playNotes( NotePlayHandle * const * _notes, size_t _count )
+{
+	const std::shared_ptr<const bWave> wave = std::atomic_load( &m_wave );
+	for( size_t i = 0; i < _count; ++i )
 	{
-	
-		float factor;
-		if( !m_normalize.value() )
-		{
-			factor = defaultNormalizationFactor;
-		}
-		else
-		{
-			factor = m_normalizeFactor;
-		}
+		playNote( _notes[i], _notes[i]->buffer(), wave );
+	}
+}
 
-		_n->m_pluginData = new bSynth(
-					const_cast<float*>( m_graph.samples() ),
-					_n,
-					m_interpolation.value(), factor,
+
+
+
+float bitInvader::normalizationFactor() const
+{
+	return m_normalize.value() ? m_normalizeFactor : defaultNormalizationFactor;
+}
+
+
+
+
+void bitInvader::playNote( NotePlayHandle * _n, sampleFrame * _working_buffer,
+				const std::shared_ptr<const bWave> & _wave )
+{
+	if ( _n->totalFramesPlayed() == 0 || _n->m_pluginData == nullptr )
+	{
+		_n->m_pluginData = m_voices.acquire( _wave, _n,
 				Engine::audioEngine()->processingSampleRate() );
 	}
 
@@ -304,7 +325,7 @@ void bitInvader::playNote( NotePlayHandle * _n,
 	bSynth * ps = static_cast<bSynth *>( _n->m_pluginData );
 	for( fpp_t frame = offset; frame < frames + offset; ++frame )
 	{
-		const sample_t cur = ps->nextStringSample( m_graph.length() );
+		const sample_t cur = ps->nextStringSample();
 		for( ch_cnt_t chnl = 0; chnl < DEFAULT_CHANNELS; ++chnl )
 		{
 			_working_buffer[frame][chnl] = cur;
@@ -321,7 +342,7 @@ void bitInvader::playNote( NotePlayHandle * _n,
 
 void bitInvader::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<bSynth *>( _n->m_pluginData );
+	m_voices.release( static_cast<bSynth *>( _n->m_pluginData ) );
 }
 
 
@@ -27,6 +27,9 @@
 #ifndef BIT_INVADER_H
 #define BIT_INVADER_H
 
+#include <memory>
+
+#include "BandLimitedWave.h"
 #include "Instrument.h"
 #include "InstrumentView.h"
 #include "Graph.h"
@@ -34,30 +37,61 @@
 #include "PixmapButton.h"
 #include "LedCheckbox.h"
 #include "MemoryManager.h"
+#include "VoicePool.h"
 
 class oscillator;
 class bitInvaderView;
 
+static const int wavetableSize = 200;
+
+// the wave all notes play, made again when the graph or a setting changes
+class bWave
+{
+	MM_OPERATORS
+public:
+	bWave( const float * _samples, int _length, float _factor,
+						bool _interpolation );
+
+	int length() const
+	{
+		return m_length;
+	}
+
+	// _index in 0 to length(), _wavelen in frames
+	sample_t sampleAt( float _index, float _wavelen ) const
+	{
+		if( m_mipmap )
+		{
+			return m_mipmap->oscillate( _index / m_length, _wavelen );
+		}
+		return m_shape[static_cast<int>( _index )];
+	}
+
+private:
+	int m_length;
+	float m_shape[wavetableSize];
+	// band-limited for interpolation, the plain shape is played otherwise
+	std::unique_ptr<UserWaveMipMap> m_mipmap;
+
+} ;
+
 class bSynth
 {
 	MM_OPERATORS
 public:
-	bSynth( float * sample, NotePlayHandle * _nph,
-			bool _interpolation, float factor, 
+	bSynth( std::shared_ptr<const bWave> _wave, NotePlayHandle * _nph,
 			const sample_rate_t _sample_rate );
 	virtual ~bSynth();
 	
-	sample_t nextStringSample( float sample_length );
+	sample_t nextStringSample();
 
 
 private:
-	int sample_index;
 	float sample_realindex;
-	float* sample_shape;
+	// kept as it was when the note started
+	std::shared_ptr<const bWave> wave;
 	NotePlayHandle* nph;
 	const sample_rate_t sample_rate;
-
-	bool interpolation;
 	
 } ;
 
@@ -70,6 +104,7 @@ public:
 
 	virtual void playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer );
+	virtual void playNotes( NotePlayHandle * const * _notes, size_t _count );
 	virtual void deleteNotePluginData( NotePlayHandle * _n );
 
 
@@ -79,6 +114,11 @@ public:
 
 	virtual QString nodeName() const;
 
+	virtual Flags flags() const
+	{
+		return PlaysNotesBatched;
+	}
+
 	virtual f_cnt_t desiredReleaseFrames() const
 	{
 		return( 64 );
@@ -91,9 +131,15 @@ protected slots:
 	void samplesChanged( int, int );
 
 	void normalize();
+	void updateWave();
 
 
 private:
+	float normalizationFactor() const;
+	// plays a note with the wave playNotes() looked up once for all notes
+	void playNote( NotePlayHandle * _n, sampleFrame * _working_buffer,
+				const std::shared_ptr<const bWave> & _wave );
+
 	FloatModel  m_sampleLength;
 	graphModel  m_graph;
 	
@@ -101,6 +147,11 @@ private:
 	BoolModel m_normalize;
 	
 	float m_normalizeFactor;
+
+	// swapped with std::atomic_store(), the notes playing keep the old one
+	std::shared_ptr<const bWave> m_wave;
+
+	VoicePool<bSynth> m_voices;
 	
 	friend class bitInvaderView;
 } ;
@@ -149,6 +149,7 @@ CarlaInstrument::CarlaInstrument(InstrumentTrack* const instrumentTrack, const D
       fHandle(nullptr),
       fDescriptor(isPatchbay ? carla_get_native_patchbay_plugin() : carla_get_native_rack_plugin()),
       fMidiEventCount(0),
+      fMidiQueue(kMaxMidiEvents),
       m_paramModels()
 {
     fHost.handle      = this;
@@ -201,6 +202,8 @@ CarlaInstrument::CarlaInstrument(InstrumentTrack* const instrumentTrack, const D
     // Add static amount of CarlaParamFloatModel's.
     int paramCount = fDescriptor->get_parameter_count(fHandle);
     m_paramModels.reserve(paramCount);
+    fPendingParams.reset(new PendingParam[paramCount]);
+    fParamQueue.reset(new LocklessList<uint32_t>(qMax(paramCount, 1)));
     for (int i=0; i < paramCount; ++i)
     {
         m_paramModels.push_back(new CarlaParamFloatModel(this));
@@ -455,8 +458,14 @@ void CarlaInstrument::paramModelChanged(uint32_t index)
 	{
 		if (fDescriptor->set_parameter_value != nullptr)
 		{
-			fDescriptor->set_parameter_value(fHandle, index, m_paramModels[index]->value());
-
+			// applied by play(), other threads mustn't touch the plugin
+			// while it processes
+			PendingParam& param = fPendingParams[index];
+			param.value.store(m_paramModels[index]->value(), std::memory_order_relaxed);
+			if (!param.queued.exchange(true, std::memory_order_acq_rel))
+			{
+				fParamQueue->push(index);
+			}
 		}
 
 		// TODO? Shouldn't Carla be doing this?
@@ -467,6 +476,27 @@ void CarlaInstrument::paramModelChanged(uint32_t index)
 	}
 }
 
+void CarlaInstrument::applyParamChanges()
+{
+	if (fParamQueue == nullptr)
+	{
+		return;
+	}
+
+	for (LocklessList<uint32_t>::Element* e = fParamQueue->popList(); e != nullptr; )
+	{
+		const uint32_t index = e->value;
+		LocklessList<uint32_t>::Element* next = e->next;
+		fParamQueue->free(e);
+		e = next;
+
+		// changes from now on queue the parameter again
+		PendingParam& param = fPendingParams[index];
+		param.queued.exchange(false, std::memory_order_acq_rel);
+		fDescriptor->set_parameter_value(fHandle, index, param.value.load(std::memory_order_relaxed));
+	}
+}
+
 void CarlaInstrument::updateParamModel(uint32_t index)
 { // Called on param changed (Carla -> LMMS)
 	if (fDescriptor->get_parameter_value != nullptr)
@@ -498,10 +528,9 @@ void CarlaInstrument::play(sampleFrame* workingBuffer)
 {
     const uint bufsize = Engine::audioEngine()->framesPerPeriod();
 
-    std::memset(workingBuffer, 0, sizeof(sample_t)*bufsize*DEFAULT_CHANNELS);
-
     if (fHandle == nullptr)
     {
+        std::memset(workingBuffer, 0, sizeof(sample_t)*bufsize*DEFAULT_CHANNELS);
         instrumentTrack()->processAudioBuffer(workingBuffer, bufsize, nullptr);
         return;
     }
@@ -532,18 +561,32 @@ void CarlaInstrument::play(sampleFrame* workingBuffer)
     std::memset(buf1, 0, sizeof(float)*bufsize);
     std::memset(buf2, 0, sizeof(float)*bufsize);
 
+    applyParamChanges();
+
+    // the queue is newest first
+    LocklessList<NativeMidiEvent>::Element* events = fMidiQueue.popList();
+    fMidiEventCount = 0;
+    for (LocklessList<NativeMidiEvent>::Element* e = events; e != nullptr; e = e->next)
+    {
+        ++fMidiEventCount;
+    }
+    for (uint32_t i = fMidiEventCount; events != nullptr; )
     {
-        const QMutexLocker ml(&fMutex);
+        fMidiEvents[--i] = events->value;
+        LocklessList<NativeMidiEvent>::Element* next = events->next;
+        fMidiQueue.free(events);
+        events = next;
+    }
+
 // TODO FIXME this is just here so it compiles.
 // https://github.com/falkTX/Carla/blob/8bceb9ed173a10b29038f8abb4383710c0e497c1/source/includes/CarlaNative.h
 //     FIXME for v3.0, use const for the input buffer
 #if CARLA_VERSION_HEX >= CARLA_VERSION_HEX_3
-        fDescriptor->process(fHandle, (const float**)rBuf, rBuf, bufsize, fMidiEvents, fMidiEventCount);
+    fDescriptor->process(fHandle, (const float**)rBuf, rBuf, bufsize, fMidiEvents, fMidiEventCount);
 #else
-        fDescriptor->process(fHandle, rBuf, rBuf, bufsize, fMidiEvents, fMidiEventCount);
+    fDescriptor->process(fHandle, rBuf, rBuf, bufsize, fMidiEvents, fMidiEventCount);
 #endif
-        fMidiEventCount = 0;
-    }
+    fMidiEventCount = 0;
 
     for (uint i=0; i < bufsize; ++i)
     {
@@ -556,21 +599,18 @@ void CarlaInstrument::play(sampleFrame* workingBuffer)
 
 bool CarlaInstrument::handleMidiEvent(const MidiEvent& event, const TimePos&, f_cnt_t offset)
 {
-    const QMutexLocker ml(&fMutex);
-
-    if (fMidiEventCount >= kMaxMidiEvents)
-        return false;
-
-    NativeMidiEvent& nEvent(fMidiEvents[fMidiEventCount++]);
+    NativeMidiEvent nEvent;
     std::memset(&nEvent, 0, sizeof(NativeMidiEvent));
 
     nEvent.port    = 0;
     nEvent.time    = offset;
     std::size_t written = writeToByteSeq(event, nEvent.data, sizeof(NativeMidiEvent::data));
-    if(written) { nEvent.size = written; }
-    else { --fMidiEventCount; }
+    if (!written)
+        return true;
+    nEvent.size = written;
 
-    return true;
+    // false if the queue is full
+    return fMidiQueue.push(nEvent);
 }
 
 PluginView* CarlaInstrument::instantiateView(QWidget* parent)
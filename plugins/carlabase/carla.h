@@ -36,7 +36,10 @@
 #include <QLineEdit>
 #include <QScrollArea>
 #include <QStringListModel>
-#include <QtCore/QMutex>
+
+// std
+#include <atomic>
+#include <memory>
 
 // carla/source/includes
 #include "carlabase_export.h"
@@ -55,6 +58,7 @@
 
 // lmms/include/
 #include "EffectControls.h"
+#include "LocklessList.h"
 #include "Instrument.h"
 #include "InstrumentView.h"
 #include "Knob.h"
@@ -261,8 +265,22 @@ private:
     NativeMidiEvent fMidiEvents[kMaxMidiEvents];
     NativeTimeInfo  fTimeInfo;
 
-    // this is only needed because note-offs are being sent during play
-    QMutex fMutex;
+    // note-offs are sent during play, other events come from other threads,
+    // so they're queued without locks and taken by play()
+    LocklessList<NativeMidiEvent> fMidiQueue;
+
+    // parameter changes, applied by play() before processing, so that
+    // changes from the GUI never run concurrently with the plugin. Every
+    // parameter is queued at most once, with its latest value.
+    struct PendingParam
+    {
+        std::atomic<float> value{0.0f};
+        std::atomic<bool> queued{false};
+    };
+    std::unique_ptr<PendingParam[]> fPendingParams;
+    std::unique_ptr<LocklessList<uint32_t>> fParamQueue;
+
+    void applyParamChanges();
 
     uint8_t m_paramGroupCount;
     QList<CarlaParamFloatModel*> m_paramModels;
@@ -61,12 +61,18 @@ public:
 	{
 	}
 
+	//! For the same noise in every render of the note
+	void setRandomSeed( uint32_t seed )
+	{
+		m_random.setSeed( seed );
+	}
+
 	void update( sampleFrame* buf, const fpp_t frames, const float sampleRate )
 	{
 		for( fpp_t frame = 0; frame < frames; ++frame )
 		{
 			const double gain = ( 1 - fastPow( ( m_counter < m_length ) ? m_counter / m_length : 1, m_env ) );
-			const sample_t s = ( Oscillator::sinSample( m_phase ) * ( 1 - m_noise ) ) + ( Oscillator::noiseSample( 0 ) * gain * gain * m_noise );
+			const sample_t s = ( Oscillator::sinSample( m_phase ) * ( 1 - m_noise ) ) + ( m_random.nextBipolar() * gain * gain * m_noise );
 			buf[frame][0] = s * gain;
 			buf[frame][1] = s * gain;
 			
@@ -103,6 +109,7 @@ private:
 
 	unsigned long m_counter;
 	double m_freq;
+	FastRandom m_random;
 
 };
 
@@ -24,6 +24,9 @@
  */
 
 
+#include <algorithm>
+#include <cmath>
+
 #include <QDomDocument>
 #include <QPainter>
 
@@ -33,7 +36,7 @@
 #include "InstrumentTrack.h"
 #include "Knob.h"
 #include "NotePlayHandle.h"
-#include "KickerOsc.h"
+#include "ToolTip.h"
 
 #include "embed.h"
 #include "plugin_export.h"
@@ -72,8 +75,19 @@ kickerInstrument::kickerInstrument( InstrumentTrack * _instrument_track ) :
 	m_slopeModel( 0.06f, 0.001f, 1.0f, 0.001f, this, tr( "Frequency slope" ) ),
 	m_startNoteModel( true, this, tr( "Start from note" ) ),
 	m_endNoteModel( false, this, tr( "End to note" ) ),
-	m_versionModel( KICKER_PRESET_VERSION, 0, KICKER_PRESET_VERSION, this, "" )
+	m_prerenderModel( true, this, tr( "Pre-render kicks" ) ),
+	m_versionModel( KICKER_PRESET_VERSION, 0, KICKER_PRESET_VERSION, this, "" ),
+	m_voices( voicePoolSize() ),
+	m_kicksStarted( 0 ),
+	m_renderedKicksChanged( false )
 {
+	for( Model * model : std::initializer_list<Model *>{ &m_startFreqModel, &m_endFreqModel,
+			&m_decayModel, &m_distModel, &m_distEndModel, &m_gainModel, &m_envModel,
+			&m_clickModel, &m_slopeModel, &m_startNoteModel, &m_endNoteModel, &m_prerenderModel } )
+	{
+		connect( model, SIGNAL( dataChanged() ), this, SLOT( dropRenderedKicks() ) );
+	}
+	connect( Engine::audioEngine(), SIGNAL( sampleRateChanged() ), this, SLOT( dropRenderedKicks() ) );
 }
 
 
@@ -101,6 +115,7 @@ void kickerInstrument::saveSettings( QDomDocument & _doc,
 	m_slopeModel.saveSettings( _doc, _this, "slope" );
 	m_startNoteModel.saveSettings( _doc, _this, "startnote" );
 	m_endNoteModel.saveSettings( _doc, _this, "endnote" );
+	m_prerenderModel.saveSettings( _doc, _this, "prerender" );
 	m_versionModel.saveSettings( _doc, _this, "version" );
 }
 
@@ -134,6 +149,10 @@ void kickerInstrument::loadSettings( const QDomElement & _this )
 		m_startNoteModel.setValue( false );
 	}
 	m_endNoteModel.loadSettings( _this, "endnote" );
+	if( _this.hasAttribute( "prerender" ) )
+	{
+		m_prerenderModel.loadSettings( _this, "prerender" );
+	}
 
 	// Try to maintain backwards compatibility
 	if( !_this.hasAttribute( "version" ) )
@@ -157,40 +176,103 @@ QString kickerInstrument::nodeName() const
 
 
 
-typedef DspEffectLibrary::Distortion DistFX;
-typedef KickerOsc<DspEffectLibrary::MonoToStereoAdaptor<DistFX> > SweepOsc;
-
 
 void kickerInstrument::playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer )
+{
+	const sample_rate_t sampleRate = Engine::audioEngine()->processingSampleRate();
+	playNote( _n, _working_buffer, m_decayModel.value() * sampleRate / 1000.0f, sampleRate );
+}
+
+
+
+
+void kickerInstrument::playNotes( NotePlayHandle * const * _notes, size_t _count )
+{
+	const sample_rate_t sampleRate = Engine::audioEngine()->processingSampleRate();
+	const float decfr = m_decayModel.value() * sampleRate / 1000.0f;
+	for( size_t i = 0; i < _count; ++i )
+	{
+		playNote( _notes[i], _notes[i]->buffer(), decfr, sampleRate );
+	}
+}
+
+
+
+
+void kickerInstrument::playNote( NotePlayHandle * _n, sampleFrame * _working_buffer,
+					float decfr, sample_rate_t sampleRate )
 {
 	const fpp_t frames = _n->framesLeftForCurrentPeriod();
 	const f_cnt_t offset = _n->noteOffset();
-	const float decfr = m_decayModel.value() * Engine::audioEngine()->processingSampleRate() / 1000.0f;
 	const f_cnt_t tfp = _n->totalFramesPlayed();
 
 	if ( tfp == 0 )
 	{
-		_n->m_pluginData = new SweepOsc(
-					DistFX( m_distModel.value(),
-							m_gainModel.value() ),
-					m_startNoteModel.value() ? _n->frequency() : m_startFreqModel.value(),
-					m_endNoteModel.value() ? _n->frequency() : m_endFreqModel.value(),
-					m_noiseModel.value() * m_noiseModel.value(),
-					m_clickModel.value() * 0.25f,
-					m_slopeModel.value(),
-					m_envModel.value(),
-					m_distModel.value(),
-					m_distEndModel.value(),
-					decfr );
+		const KickParameters parameters = {
+			m_startNoteModel.value() ? _n->frequency() : m_startFreqModel.value(),
+			m_endNoteModel.value() ? _n->frequency() : m_endFreqModel.value(),
+			m_clickModel.value() * 0.25f,
+			m_slopeModel.value(),
+			m_envModel.value(),
+			m_distModel.value(),
+			m_distEndModel.value(),
+			m_gainModel.value(),
+			decfr,
+			sampleRate };
+		const float noise = m_noiseModel.value() * m_noiseModel.value();
+
+		KickVoice * voice = m_voices.acquire( SweepOsc(
+					DistFX( parameters.distStart, parameters.gain ),
+					parameters.startFreq,
+					parameters.endFreq,
+					noise,
+					parameters.click,
+					parameters.slope,
+					parameters.env,
+					parameters.distStart,
+					parameters.distEnd,
+					parameters.length ) );
+		voice->osc.setRandomSeed( _n->randomSeed() );
+		// noise would sound the same in every kick
+		if( m_prerenderModel.value() && noise == 0.0f )
+		{
+			attachRenderedKick( voice, parameters );
+		}
+		_n->m_pluginData = voice;
 	}
 	else if( tfp > decfr && !_n->isReleased() )
 	{
 		_n->noteOff();
 	}
 
-	SweepOsc * so = static_cast<SweepOsc *>( _n->m_pluginData );
-	so->update( _working_buffer + offset, frames, Engine::audioEngine()->processingSampleRate() );
+	KickVoice * voice = static_cast<KickVoice *>( _n->m_pluginData );
+	RenderedKick * kick = voice->kick.get();
+	if( kick && kick->isComplete() )
+	{
+		// the same frames the oscillator would produce
+		const f_cnt_t length = kick->frames.size();
+		const f_cnt_t copied = tfp < length ? std::min<f_cnt_t>( frames, length - tfp ) : 0;
+		std::copy( kick->frames.begin() + tfp, kick->frames.begin() + tfp + copied,
+				_working_buffer + offset );
+		std::fill( _working_buffer + offset + copied, _working_buffer + offset + frames,
+				sampleFrame{ 0.0f, 0.0f } );
+	}
+	else
+	{
+		voice->osc.update( _working_buffer + offset, frames, sampleRate );
+		if( kick && kick->recorded == tfp )
+		{
+			const f_cnt_t recorded = std::min<f_cnt_t>( frames, kick->frames.size() - tfp );
+			std::copy( _working_buffer + offset, _working_buffer + offset + recorded,
+					kick->frames.begin() + tfp );
+			kick->recorded += recorded;
+			if( kick->isComplete() )
+			{
+				kick->recording = false;
+			}
+		}
+	}
 
 	if( _n->isReleased() )
 	{
@@ -210,9 +292,79 @@ void kickerInstrument::playNote( NotePlayHandle * _n,
 
 
 
+void kickerInstrument::attachRenderedKick( KickVoice * voice, const KickParameters & parameters )
+{
+	if( m_renderedKicksChanged.exchange( false ) )
+	{
+		m_renderedKicks.clear();
+	}
+
+	auto it = std::find_if( m_renderedKicks.begin(), m_renderedKicks.end(),
+		[&parameters]( const std::shared_ptr<RenderedKick> & kick ) { return kick->parameters == parameters; } );
+	if( it == m_renderedKicks.end() )
+	{
+		// the kick is silent once its length has passed
+		auto kick = std::make_shared<RenderedKick>();
+		kick->parameters = parameters;
+		kick->frames.resize( static_cast<size_t>( std::ceil( parameters.length ) ) );
+		if( m_renderedKicks.size() < MaxRenderedKicks )
+		{
+			m_renderedKicks.push_back( kick );
+			it = m_renderedKicks.end() - 1;
+		}
+		else
+		{
+			it = std::min_element( m_renderedKicks.begin(), m_renderedKicks.end(),
+				[]( const std::shared_ptr<RenderedKick> & a, const std::shared_ptr<RenderedKick> & b )
+				{ return a->lastUsed < b->lastUsed; } );
+			*it = kick;
+		}
+	}
+
+	RenderedKick * kick = it->get();
+	kick->lastUsed = ++m_kicksStarted;
+	if( kick->isComplete() )
+	{
+		voice->kick = *it;
+	}
+	else if( !kick->recording.exchange( true ) )
+	{
+		// from the start, where a note that ended too early left off
+		kick->recorded = 0;
+		voice->kick = *it;
+	}
+}
+
+
+
+
+void kickerInstrument::dropRenderedKicks()
+{
+	m_renderedKicksChanged = true;
+}
+
+
+
+
 void kickerInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<SweepOsc *>( _n->m_pluginData );
+	KickVoice * voice = static_cast<KickVoice *>( _n->m_pluginData );
+	if( voice && voice->kick && !voice->kick->isComplete() )
+	{
+		voice->kick->recording = false;
+	}
+	m_voices.release( voice );
+}
+
+
+
+
+bool kickerInstrument::KickParameters::operator==( const KickParameters & other ) const
+{
+	return startFreq == other.startFreq && endFreq == other.endFreq && click == other.click &&
+		slope == other.slope && env == other.env && distStart == other.distStart &&
+		distEnd == other.distEnd && gain == other.gain && length == other.length &&
+		sampleRate == other.sampleRate;
 }
 
 
@@ -325,6 +477,11 @@ kickerInstrumentView::kickerInstrumentView( Instrument * _instrument,
 	m_endNoteToggle = new LedCheckBox( "", this, "", LedCheckBox::Green );
 	m_endNoteToggle->move( END_COL + 8, LED_ROW );
 
+	m_prerenderToggle = new LedCheckBox( "", this, "", LedCheckBox::Green );
+	m_prerenderToggle->move( COL3 + 8, LED_ROW );
+	ToolTip::add( m_prerenderToggle, tr( "Render every kick once and play it back for the notes "
+						"after it, unless there's noise" ) );
+
 	setAutoFillBackground( true );
 	QPalette pal;
 	pal.setBrush( backgroundRole(), PLUGIN_NAME::getIconPixmap( "artwork" ) );
@@ -356,6 +513,7 @@ void kickerInstrumentView::modelChanged()
 	m_slopeKnob->setModel( &k->m_slopeModel );
 	m_startNoteToggle->setModel( &k->m_startNoteModel );
 	m_endNoteToggle->setModel( &k->m_endNoteModel );
+	m_prerenderToggle->setModel( &k->m_prerenderModel );
 }
 
 
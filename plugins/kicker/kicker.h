@@ -27,12 +27,18 @@
 #ifndef KICKER_H
 #define KICKER_H
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include <QObject>
 #include "Instrument.h"
 #include "InstrumentView.h"
 #include "Knob.h"
+#include "KickerOsc.h"
 #include "LedCheckbox.h"
 #include "TempoSyncKnob.h"
+#include "VoicePool.h"
 
 
 #define KICKER_PRESET_VERSION 1
@@ -51,6 +57,7 @@ public:
 
 	virtual void playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer );
+	virtual void playNotes( NotePlayHandle * const * _notes, size_t _count );
 	virtual void deleteNotePluginData( NotePlayHandle * _n );
 
 	virtual void saveSettings( QDomDocument & _doc, QDomElement & _parent );
@@ -60,7 +67,7 @@ public:
 
 	virtual Flags flags() const
 	{
-		return IsNotBendable;
+		return IsNotBendable | PlaysNotesBatched;
 	}
 
 	virtual f_cnt_t desiredReleaseFrames() const
@@ -71,7 +78,71 @@ public:
 	virtual PluginView * instantiateView( QWidget * _parent );
 
 
+private slots:
+	void dropRenderedKicks();
+
+
 private:
+	typedef DspEffectLibrary::Distortion DistFX;
+	typedef KickerOsc<DspEffectLibrary::MonoToStereoAdaptor<DistFX> > SweepOsc;
+
+	// renders kept for the notes with other parameters
+	static constexpr int MaxRenderedKicks = 16;
+
+	//! Everything a kick without noise depends on
+	struct KickParameters
+	{
+		float startFreq;
+		float endFreq;
+		float click;
+		float slope;
+		float env;
+		float distStart;
+		float distEnd;
+		float gain;
+		float length;
+		sample_rate_t sampleRate;
+
+		bool operator==( const KickParameters & other ) const;
+	} ;
+
+	//! A kick recorded while the first note with its parameters played,
+	//! for the notes after it to copy. The frames after it are silent.
+	struct RenderedKick
+	{
+		KickParameters parameters;
+		std::vector<sampleFrame> frames;
+		f_cnt_t recorded = 0;
+		// whether a note is recording it, a note that ends before the kick
+		// does leaves it to the next one
+		std::atomic<bool> recording{ false };
+		unsigned long lastUsed = 0;
+
+		bool isComplete() const
+		{
+			return recorded == static_cast<f_cnt_t>( frames.size() );
+		}
+	} ;
+
+	struct KickVoice
+	{
+		explicit KickVoice( const SweepOsc & osc ) :
+			osc( osc )
+		{
+		}
+
+		SweepOsc osc;
+		// played back if complete, otherwise recorded if set
+		std::shared_ptr<RenderedKick> kick;
+	} ;
+
+	// plays a note with what playNotes() looked up once for all notes
+	void playNote( NotePlayHandle * _n, sampleFrame * _working_buffer,
+					float decfr, sample_rate_t sampleRate );
+
+	//! Lets @p voice play or record the render of @p parameters
+	void attachRenderedKick( KickVoice * voice, const KickParameters & parameters );
+
 	FloatModel m_startFreqModel;
 	FloatModel m_endFreqModel;
 	TempoSyncKnobModel m_decayModel;
@@ -85,9 +156,18 @@ private:
 
 	BoolModel m_startNoteModel;
 	BoolModel m_endNoteModel;
+	BoolModel m_prerenderModel;
 
 	IntModel m_versionModel;
 
+	VoicePool<KickVoice> m_voices;
+
+	// only used by the thread playing the notes
+	std::vector<std::shared_ptr<RenderedKick>> m_renderedKicks;
+	unsigned long m_kicksStarted;
+	// set when a knob changed, the renders are dropped with the next note
+	std::atomic<bool> m_renderedKicksChanged;
+
 	friend class kickerInstrumentView;
 
 } ;
@@ -117,6 +197,7 @@ private:
 
 	LedCheckBox * m_startNoteToggle;
 	LedCheckBox * m_endNoteToggle;
+	LedCheckBox * m_prerenderToggle;
 
 } ;
 
@@ -47,9 +47,6 @@
 #include "embed.h"
 #include "plugin_export.h"
 
-// Envelope Recalculation period
-#define ENVINC 64
-
 //
 // New config
 //
@@ -76,6 +73,41 @@
 //#define engine::audioEngine()->processingSampleRate() 44100.0f
 const float sampleRateCutoff = 44100.0f;
 
+namespace
+{
+
+// tanh() sampled over the range where it isn't 1 yet, for the saturation of
+// the 3 pole filter, which would take two tanh() calls per sample
+class lb302TanhTable
+{
+public:
+	lb302TanhTable()
+	{
+		for( int i = 0; i <= Size; ++i )
+		{
+			m_table[i] = tanhf( ( i * 2.0f / Size - 1.0f ) * Range );
+		}
+	}
+
+	float operator()( float x ) const
+	{
+		const float pos = qBound( 0.0f, ( x / Range + 1.0f ) * ( Size / 2 ), static_cast<float>( Size ) - 0.001f );
+		const int i = static_cast<int>( pos );
+		const float frac = pos - i;
+		return m_table[i] + frac * ( m_table[i + 1] - m_table[i] );
+	}
+
+private:
+	static constexpr float Range = 5.0f;
+	static constexpr int Size = 2048;
+
+	float m_table[Size + 1];
+} ;
+
+const lb302TanhTable lb302Tanh;
+
+}
+
 extern "C"
 {
 
@@ -103,7 +135,8 @@ lb302Filter::lb302Filter(lb302FilterKnobState* p_fs) :
 	fs(p_fs),
 	vcf_c0(0),
 	vcf_e0(0),
-	vcf_e1(0)
+	vcf_e1(0),
+	vcf_rate(0)
 {
 };
 
@@ -112,10 +145,16 @@ void lb302Filter::recalc()
 {
 	vcf_e1 = exp(6.109 + 1.5876*(fs->envmod) + 2.1553*(fs->cutoff) - 1.2*(1.0-(fs->reso)));
 	vcf_e0 = exp(5.613 - 0.8*(fs->envmod) + 2.1553*(fs->cutoff) - 0.7696*(1.0-(fs->reso)));
-	vcf_e0*=M_PI/Engine::audioEngine()->processingSampleRate();
-	vcf_e1*=M_PI/Engine::audioEngine()->processingSampleRate();
+	vcf_e0*=M_PI/fs->sampleRate;
+	vcf_e1*=M_PI/fs->sampleRate;
 	vcf_e1 -= vcf_e0;
 
+	// keep the envelope where it is when the filter's rate changes
+	if (vcf_rate > 0 && vcf_rate != fs->sampleRate) {
+		vcf_c0 *= vcf_rate/fs->sampleRate;
+	}
+	vcf_rate = fs->sampleRate;
+
 	vcf_rescoeff = exp(-1.20 + 3.455*(fs->reso));
 };
 
@@ -239,7 +278,7 @@ void lb302Filter3Pole::envRecalc()
 
 #ifdef LB_24_IGNORE_ENVELOPE
 	// kfcn = fs->cutoff;
-	kfcn = 2.0 * kfco / Engine::audioEngine()->processingSampleRate();
+	kfcn = 2.0 * kfco / fs->sampleRate;
 #else
 	kfcn = w;
 #endif
@@ -261,12 +300,12 @@ float lb302Filter3Pole::process(const float& samp)
 	float ax1  = lastin;
 	float ay11 = ay1;
 	float ay31 = ay2;
-	lastin  = (samp) - tanh(kres*aout);
+	lastin  = (samp) - lb302Tanh(kres*aout);
 	ay1     = kp1h * (lastin+ax1) - kp*ay1;
 	ay2     = kp1h * (ay1 + ay11) - kp*ay2;
 	aout    = kp1h * (ay2 + ay31) - kp*aout;
 
-	return tanh(aout*value)*LB_24_VOL_ADJUST/(1.0+fs->dist);
+	return lb302Tanh(aout*value)*LB_24_VOL_ADJUST/(1.0+fs->dist);
 }
 
 
@@ -287,11 +326,14 @@ lb302Synth::lb302Synth( InstrumentTrack * _instrumentTrack ) :
 	accentToggle( false, this, tr( "Accent" ) ),
 	deadToggle( false, this, tr( "Dead" ) ),
 	db24Toggle( false, this, tr( "24dB/oct Filter" ) ),
+	oversampleToggle( false, this, tr( "Oversample filter" ) ),
 	vca_attack(1.0 - 0.96406088),
 	vca_decay(0.99897516),
 	vca_a0(0.5),
 	vca_a(0.),
-	vca_mode(never_played)
+	vca_mode(never_played),
+	m_oversampler( 1, 2 * ENVINC ),
+	m_oversampled( false )
 {
 
 	connect( Engine::audioEngine(), SIGNAL( sampleRateChanged( ) ),
@@ -330,6 +372,7 @@ lb302Synth::lb302Synth( InstrumentTrack * _instrumentTrack ) :
 	fs.reso = 0;
 	fs.envdecay = 0;
 	fs.dist = 0;
+	fs.sampleRate = Engine::audioEngine()->processingSampleRate();
 
 	vcf_envpos = ENVINC;
 
@@ -378,6 +421,7 @@ void lb302Synth::saveSettings( QDomDocument & _doc,
 	slideToggle.saveSettings( _doc, _this, "slide");
 	deadToggle.saveSettings( _doc, _this, "dead");
 	db24Toggle.saveSettings( _doc, _this, "db24");
+	oversampleToggle.saveSettings( _doc, _this, "oversample");
 }
 
 
@@ -394,6 +438,7 @@ void lb302Synth::loadSettings( const QDomElement & _this )
 	slideToggle.loadSettings( _this, "slide");
 	deadToggle.loadSettings( _this, "dead");
 	db24Toggle.loadSettings( _this, "db24");
+	oversampleToggle.loadSettings( _this, "oversample");
  	db24Toggled();
 
 	filterChanged();
@@ -407,6 +452,7 @@ void lb302Synth::filterChanged()
 	fs.reso   = vcf_res_knob.value();
 	fs.envmod = vcf_mod_knob.value();
 	fs.dist   = LB_DIST_RATIO*dist_knob.value();
+	fs.sampleRate = Engine::audioEngine()->processingSampleRate() * (m_oversampled ? 2 : 1);
 
 	float d = 0.2 + (2.3*vcf_dec_knob.value());
 
@@ -460,9 +506,18 @@ inline float GET_INC(float freq) {
 
 int lb302Synth::process(sampleFrame *outbuf, const int size)
 {
-	const float sampleRatio = 44100.f / Engine::audioEngine()->processingSampleRate();
+	const float sampleRate = Engine::audioEngine()->processingSampleRate();
+	const float sampleRatio = 44100.f / sampleRate;
 	float w;
-	float samp;
+
+	if( oversampleToggle.value() != m_oversampled )
+	{
+		m_oversampled = oversampleToggle.value();
+		// what's left in there is from before it was switched off
+		m_oversampler.reset();
+		// adjust the filter to its new rate
+		filterChanged();
+	}
 
 	// Hold on to the current VCF, and use it throughout this period
 	lb302Filter *filter = vcf.loadAcquire();
@@ -483,19 +538,32 @@ int lb302Synth::process(sampleFrame *outbuf, const int size)
 		new_freq = false;
 	}
 
+	// the shape doesn't change during a period
+	switch(int(rint(wave_shape.value()))) {
+		case 0: vco_shape = SAWTOOTH; break;
+		case 1: vco_shape = TRIANGLE; break;
+		case 2: vco_shape = SQUARE; break;
+		case 3: vco_shape = ROUND_SQUARE; break;
+		case 4: vco_shape = MOOG; break;
+		case 5: vco_shape = SINE; break;
+		case 6: vco_shape = EXPONENTIAL; break;
+		case 7: vco_shape = WHITE_NOISE; break;
+		case 8: vco_shape = BL_SAWTOOTH; break;
+		case 9: vco_shape = BL_SQUARE; break;
+		case 10: vco_shape = BL_TRIANGLE; break;
+		case 11: vco_shape = BL_MOOG; break;
+		default:  vco_shape = SAWTOOTH; break;
+	}
+
 
 
 	// TODO: NORMAL RELEASE
 	// vca_mode = 1;
 
-	for( int i=0; i<size; i++ ) 
+	// The oscillator and the amp are rendered up to the next update of the
+	// vcf, then the oscillator's samples are filtered in one go
+	for( int start = 0; start < size; )
 	{
-		// start decay if we're past release
-		if( i >= release_frame )
-		{
-			vca_mode = decay;
-		}
-
 		// update vcf
 		if(vcf_envpos >= ENVINC) {
 			filter->envRecalc();
@@ -510,144 +578,142 @@ int lb302Synth::process(sampleFrame *outbuf, const int size)
 			}
 		}
 
+		const int frames = qMin( size - start, ENVINC - vcf_envpos );
 
-		sample_cnt++;
-		vcf_envpos++;
-
-		//int  decay_frames = 128;
-
-		// update vco
-		vco_c += vco_inc;
-		
-		if(vco_c > 0.5)
-			vco_c -= 1.0;
-
-		switch(int(rint(wave_shape.value()))) {
-			case 0: vco_shape = SAWTOOTH; break;
-			case 1: vco_shape = TRIANGLE; break;
-			case 2: vco_shape = SQUARE; break;
-			case 3: vco_shape = ROUND_SQUARE; break;
-			case 4: vco_shape = MOOG; break;
-			case 5: vco_shape = SINE; break;
-			case 6: vco_shape = EXPONENTIAL; break;
-			case 7: vco_shape = WHITE_NOISE; break;
-			case 8: vco_shape = BL_SAWTOOTH; break;
-			case 9: vco_shape = BL_SQUARE; break;
-			case 10: vco_shape = BL_TRIANGLE; break;
-			case 11: vco_shape = BL_MOOG; break;
-			default:  vco_shape = SAWTOOTH; break;
-		}
-
-		// add vco_shape_param the changes the shape of each curve.
-		// merge sawtooths with triangle and square with round square?
-		switch (vco_shape) {
-			case SAWTOOTH: // p0: curviness of line
-				vco_k = vco_c;  // Is this sawtooth backwards?
-				break;
-
-			case TRIANGLE:  // p0: duty rev.saw<->triangle<->saw p1: curviness
-				vco_k = (vco_c*2.0)+0.5;
-				if (vco_k>0.5)
-					vco_k = 1.0- vco_k;
-				break;
-
-			case SQUARE: // p0: slope of top
-				vco_k = (vco_c<0)?0.5:-0.5;
-				break;
-
-			case ROUND_SQUARE: // p0: width of round
-				vco_k = (vco_c<0)?(sqrtf(1-(vco_c*vco_c*4))-0.5):-0.5;
-				break;
-
-			case MOOG: // Maybe the fall should be exponential/sinsoidal instead of quadric.
-				// [-0.5, 0]: Rise, [0,0.25]: Slope down, [0.25,0.5]: Low
-				vco_k = (vco_c*2.0)+0.5;
-				if (vco_k>1.0) {
-					vco_k = -0.5 ;
-				}
-				else if (vco_k>0.5) {
-					w = 2.0*(vco_k-0.5)-1.0;
-					vco_k = 0.5 - sqrtf(1.0-(w*w));
-				}
-				vco_k *= 2.0;  // MOOG wave gets filtered away
-				break;
-
-			case SINE:
-				// [-0.5, 0.5]  : [-pi, pi]
-				vco_k = 0.5f * Oscillator::sinSample( vco_c );
-				break;
-
-			case EXPONENTIAL:
-				vco_k = 0.5 * Oscillator::expSample( vco_c );
-				break;
-
-			case WHITE_NOISE:
-				vco_k = 0.5 * Oscillator::noiseSample( vco_c );
-				break;
+		for( int i = 0; i < frames; i++ )
+		{
+			// start decay if we're past release
+			if( start + i >= release_frame )
+			{
+				vca_mode = decay;
+			}
 
-			case BL_SAWTOOTH:
-				vco_k = BandLimitedWave::oscillate( vco_c + 0.5f, BandLimitedWave::pdToLen( vco_inc ), BandLimitedWave::BLSaw ) * 0.5f;
-				break;
+			sample_cnt++;
+			vcf_envpos++;
+
+			//int  decay_frames = 128;
+
+			// update vco
+			vco_c += vco_inc;
+
+			if(vco_c > 0.5)
+				vco_c -= 1.0;
+
+			// add vco_shape_param the changes the shape of each curve.
+			// merge sawtooths with triangle and square with round square?
+			switch (vco_shape) {
+				case SAWTOOTH: // p0: curviness of line
+					vco_k = vco_c;  // Is this sawtooth backwards?
+					break;
+
+				case TRIANGLE:  // p0: duty rev.saw<->triangle<->saw p1: curviness
+					vco_k = (vco_c*2.0)+0.5;
+					if (vco_k>0.5)
+						vco_k = 1.0- vco_k;
+					break;
+
+				case SQUARE: // p0: slope of top
+					vco_k = (vco_c<0)?0.5:-0.5;
+					break;
+
+				case ROUND_SQUARE: // p0: width of round
+					vco_k = (vco_c<0)?(sqrtf(1-(vco_c*vco_c*4))-0.5):-0.5;
+					break;
+
+				case MOOG: // Maybe the fall should be exponential/sinsoidal instead of quadric.
+					// [-0.5, 0]: Rise, [0,0.25]: Slope down, [0.25,0.5]: Low
+					vco_k = (vco_c*2.0)+0.5;
+					if (vco_k>1.0) {
+						vco_k = -0.5 ;
+					}
+					else if (vco_k>0.5) {
+						w = 2.0*(vco_k-0.5)-1.0;
+						vco_k = 0.5 - sqrtf(1.0-(w*w));
+					}
+					vco_k *= 2.0;  // MOOG wave gets filtered away
+					break;
+
+				case SINE:
+					// [-0.5, 0.5]  : [-pi, pi]
+					vco_k = 0.5f * Oscillator::sinSample( vco_c );
+					break;
+
+				case EXPONENTIAL:
+					vco_k = 0.5 * Oscillator::expSample( vco_c );
+					break;
+
+				case WHITE_NOISE:
+					vco_k = 0.5 * Oscillator::noiseSample( vco_c );
+					break;
+
+				case BL_SAWTOOTH:
+					vco_k = BandLimitedWave::oscillate( vco_c + 0.5f, BandLimitedWave::pdToLen( vco_inc ), BandLimitedWave::BLSaw ) * 0.5f;
+					break;
+
+				case BL_SQUARE:
+					vco_k = BandLimitedWave::oscillate( vco_c + 0.5f, BandLimitedWave::pdToLen( vco_inc ), BandLimitedWave::BLSquare ) * 0.5f;
+					break;
+
+				case BL_TRIANGLE:
+					vco_k = BandLimitedWave::oscillate( vco_c + 0.5f, BandLimitedWave::pdToLen( vco_inc ), BandLimitedWave::BLTriangle ) * 0.5f;
+					break;
+
+				case BL_MOOG:
+					vco_k = BandLimitedWave::oscillate( vco_c + 0.5f, BandLimitedWave::pdToLen( vco_inc ), BandLimitedWave::BLMoog );
+					break;
+			}
 
-			case BL_SQUARE:
-				vco_k = BandLimitedWave::oscillate( vco_c + 0.5f, BandLimitedWave::pdToLen( vco_inc ), BandLimitedWave::BLSquare ) * 0.5f;
-				break;
+			m_vcoBuffer[i][0] = vco_k;
+			m_vcoBuffer[i][1] = 0.0f;
+			m_vcaBuffer[i] = vca_a;
 
-			case BL_TRIANGLE:
-				vco_k = BandLimitedWave::oscillate( vco_c + 0.5f, BandLimitedWave::pdToLen( vco_inc ), BandLimitedWave::BLTriangle ) * 0.5f;
-				break;
+			// Handle Envelope
+			if(vca_mode==attack) {
+				vca_a+=(vca_a0-vca_a)*vca_attack;
+				if(sample_cnt>=0.5*sampleRate)
+					vca_mode = idle;
+			}
+			else if(vca_mode == decay) {
+				vca_a *= vca_decay;
 
-			case BL_MOOG:
-				vco_k = BandLimitedWave::oscillate( vco_c + 0.5f, BandLimitedWave::pdToLen( vco_inc ), BandLimitedWave::BLMoog );
-				break;
+				// the following line actually speeds up processing
+				if(vca_a < (1/65536.0)) {
+					vca_a = 0;
+					vca_mode = never_played;
+				}
+			}
 		}
 
-		//vca_a = 0.5;
-		// Write out samples.
 #ifdef LB_FILTERED
-		//samp = vcf->process(vco_k)*2.0*vca_a;
-		//samp = vcf->process(vco_k)*2.0;
-		samp = filter->process(vco_k) * vca_a;
-		//printf("%f %d\n", vco_c, sample_cnt);
-
-
-		//samp = vco_k * vca_a;
-
-		if( sample_cnt <= 4 )
+		if( m_oversampled )
 		{
-	//			vca_a = 0;
+			sampleFrame * oversampled = m_oversampler.upsample( m_vcoBuffer, frames );
+			for( int i = 0; i < 2 * frames; i++ )
+			{
+				oversampled[i][0] = filter->process( oversampled[i][0] );
+			}
+			m_oversampler.downsample( m_vcoBuffer, frames );
 		}
-
-#else
-		//samp = vco_k*vca_a;
-#endif
-		/*
-		float releaseFrames = desiredReleaseFrames();
-		samp *= (releaseFrames - catch_decay)/releaseFrames;
-		*/
-		//LB302 samp *= (float)(decay_frames - catch_decay)/(float)decay_frames;
-
-		for( int c = 0; c < DEFAULT_CHANNELS; c++ ) 
+		else
 		{
-			outbuf[i][c] = samp;
-		}
-
-		// Handle Envelope
-		if(vca_mode==attack) {
-			vca_a+=(vca_a0-vca_a)*vca_attack;
-			if(sample_cnt>=0.5*Engine::audioEngine()->processingSampleRate())
-				vca_mode = idle;
+			for( int i = 0; i < frames; i++ )
+			{
+				m_vcoBuffer[i][0] = filter->process( m_vcoBuffer[i][0] );
+			}
 		}
-		else if(vca_mode == decay) {
-			vca_a *= vca_decay;
+#endif
 
-			// the following line actually speeds up processing
-			if(vca_a < (1/65536.0)) {
-				vca_a = 0;
-				vca_mode = never_played;
+		// Write out samples.
+		for( int i = 0; i < frames; i++ )
+		{
+			const float samp = m_vcoBuffer[i][0] * m_vcaBuffer[i];
+			for( int c = 0; c < DEFAULT_CHANNELS; c++ ) 
+			{
+				outbuf[start + i][c] = samp;
 			}
 		}
 
+		start += frames;
 	}
 	return 1;
 }
@@ -851,6 +917,12 @@ lb302SynthView::lb302SynthView( Instrument * _instrument, QWidget * _parent ) :
 	ToolTip::add( m_db24Toggle,
 			tr( "303-es-que, 24dB/octave, 3 pole filter" ) );
 
+	m_oversampleToggle = new LedCheckBox( "", this );
+	m_oversampleToggle->move( 10, 220 );
+	ToolTip::add( m_oversampleToggle,
+			tr( "Run the filter at twice the sample rate, for less aliasing of "
+				"its resonance and distortion" ) );
+
 
 	m_slideDecKnob = new Knob( knobBright_26, this );
 	m_slideDecKnob->move( 210, 75 );
@@ -1030,6 +1102,7 @@ void lb302SynthView::modelChanged()
 	/*m_accentToggle->setModel( &syn->accentToggle );*/
 	m_deadToggle->setModel( &syn->deadToggle );
 	m_db24Toggle->setModel( &syn->db24Toggle );
+	m_oversampleToggle->setModel( &syn->oversampleToggle );
 }
 
 
@@ -38,10 +38,14 @@
 #include "LedCheckbox.h"
 #include "Knob.h"
 #include "NotePlayHandle.h"
+#include "Oversampler.h"
 #include <QMutex>
 
 static const int NUM_FILTERS = 2;
 
+// Envelope Recalculation period
+static const int ENVINC = 64;
+
 class lb302SynthView;
 class NotePlayHandle;
 
@@ -53,6 +57,7 @@ class lb302FilterKnobState
 	float envmod;
 	float envdecay;
 	float dist;
+	float sampleRate;	// the filter's, twice the processing rate when oversampled
 };
 
 
@@ -75,6 +80,7 @@ class lb302Filter
 	float vcf_e0,           // e0 and e1 for interpolation
 	      vcf_e1;
 	float vcf_rescoeff;     // Resonance coefficient [0.30,9.54]
+	float vcf_rate;         // Sample rate e0, e1 and c0 are adjusted for
 };
 
 class lb302FilterIIR2 : public lb302Filter
@@ -186,6 +192,7 @@ private:
 	BoolModel accentToggle;
 	BoolModel deadToggle;
 	BoolModel db24Toggle;
+	BoolModel oversampleToggle;
 
 
 public slots:
@@ -248,6 +255,16 @@ private:
 
 	int process(sampleFrame *outbuf, const int size);
 
+	// The filter runs at twice the processing rate if oversampleToggle is
+	// on, the oscillator and the amp don't
+	Oversampler m_oversampler;
+	bool m_oversampled;
+
+	// An update period of the filter, the oscillator's samples in the left
+	// channel, run through the filter after it's rendered
+	sampleFrame m_vcoBuffer[ENVINC];
+	float m_vcaBuffer[ENVINC];
+
 	friend class lb302SynthView;
 
 	NotePlayHandle * m_playingNote;
@@ -280,6 +297,7 @@ private:
 	/*LedCheckBox * m_accentToggle;*/ // removed pending accent implementation
 	LedCheckBox * m_deadToggle;
 	LedCheckBox * m_db24Toggle;
+	LedCheckBox * m_oversampleToggle;
 
 } ;
 
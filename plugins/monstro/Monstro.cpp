@@ -136,6 +136,13 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		if( mod##_l1 != 0.0f ) car += m_lfo[0][f] * mod##_l1; \
 		if( mod##_l2 != 0.0f ) car += m_lfo[1][f] * mod##_l2;
 
+// the same with the ramps of the fast modulation mode
+#define rampfreq( car, mod ) \
+		car = qBound( MIN_FREQ, car * mod, MAX_FREQ );
+
+#define rampvol( car, mod ) \
+		car = qBound( -MODCLIP, car * mod, MODCLIP );
+
 #define modulatevol( car, mod ) \
 		if( mod##_e1 > 0.0f ) car *= ( 1.0f - mod##_e1 + mod##_e1 * m_env[0][f] ); \
 		if( mod##_e1 < 0.0f ) car *= ( 1.0f + mod##_e1 * m_env[0][f] );	\
@@ -308,6 +315,34 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 	const bool o2syncr = m_parent->m_osc2SyncR.value();
 	const bool o3syncr = m_parent->m_osc3SyncR.value();
 
+	// fast modulation: the matrix is evaluated at the end of every
+	// MOD_INTERVAL frames, which the ramps reach after them
+	const bool fastmod = m_parent->m_fastMod.value();
+	const float o1pw [4] = { o1pw_e1, o1pw_e2, o1pw_l1, o1pw_l2 };
+	const float o1p [4] = { o1p_e1, o1p_e2, o1p_l1, o1p_l2 };
+	const float o1f [4] = { o1f_e1, o1f_e2, o1f_l1, o1f_l2 };
+	const float o1v [4] = { o1v_e1, o1v_e2, o1v_l1, o1v_l2 };
+	const float o2p [4] = { o2p_e1, o2p_e2, o2p_l1, o2p_l2 };
+	const float o2f [4] = { o2f_e1, o2f_e2, o2f_l1, o2f_l2 };
+	const float o2v [4] = { o2v_e1, o2v_e2, o2v_l1, o2v_l2 };
+	const float o3p [4] = { o3p_e1, o3p_e2, o3p_l1, o3p_l2 };
+	const float o3f [4] = { o3f_e1, o3f_e2, o3f_l1, o3f_l2 };
+	const float o3v [4] = { o3v_e1, o3v_e2, o3v_l1, o3v_l2 };
+	const float o3s [4] = { o3s_e1, o3s_e2, o3s_l1, o3s_l2 };
+
+	// ramps which weren't used in the last period start anew
+	m_pwRamp.valid &= fastmod && o1pw_mod;
+	m_phsRamp[0].valid &= fastmod && o1p_mod;
+	m_pitRamp[0].valid &= fastmod && o1f_mod;
+	m_volRamp[0].valid &= fastmod && o1v_mod;
+	m_phsRamp[1].valid &= fastmod && o2p_mod;
+	m_pitRamp[1].valid &= fastmod && o2f_mod;
+	m_volRamp[1].valid &= fastmod && o2v_mod;
+	m_phsRamp[2].valid &= fastmod && o3p_mod;
+	m_pitRamp[2].valid &= fastmod && o3f_mod;
+	m_volRamp[2].valid &= fastmod && o3v_mod;
+	m_subRamp.valid &= fastmod && o3s_mod;
+
 	///////////////////////////
 	//                       //
 	// 	 start buffer loop   //
@@ -350,6 +385,23 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 	// begin for loop
 	for( f_cnt_t f = 0; f < _frames; ++f )
 	{
+		if( fastmod && f % MOD_INTERVAL == 0 )
+		{
+			const int len = qMin<f_cnt_t>( MOD_INTERVAL, _frames - f );
+			const f_cnt_t e = f + len - 1;
+			if( o1pw_mod ) m_pwRamp.start( qBound( PW_MIN, pw + modSum( o1pw, e ), PW_MAX ), len );
+			if( o1p_mod ) m_phsRamp[0].start( modSum( o1p, e ), len );
+			if( o1f_mod ) m_pitRamp[0].start( powf( 2.0f, modSum( o1f, e ) ), len );
+			if( o1v_mod ) m_volRamp[0].start( modVolume( o1v, e ), len );
+			if( o2p_mod ) m_phsRamp[1].start( modSum( o2p, e ), len );
+			if( o2f_mod ) m_pitRamp[1].start( powf( 2.0f, modSum( o2f, e ) ), len );
+			if( o2v_mod ) m_volRamp[1].start( modVolume( o2v, e ), len );
+			if( o3p_mod ) m_phsRamp[2].start( modSum( o3p, e ), len );
+			if( o3f_mod ) m_pitRamp[2].start( powf( 2.0f, modSum( o3f, e ) ), len );
+			if( o3v_mod ) m_volRamp[2].start( modVolume( o3v, e ), len );
+			if( o3s_mod ) m_subRamp.start( qBound( 0.0f, o3sub + modSum( o3s, e ), 1.0f ), len );
+		}
+
 /*	// debug code
 		if( f % 10 == 0 ) {
 			qDebug( "env1 %f -- env1 phase %f", m_env1_buf[f], m_env1_phase );
@@ -367,14 +419,24 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		// calc and mod frequencies
 		o1l_f = o1lfb;
 		o1r_f = o1rfb;
-		if( o1f_mod )
+		if( o1f_mod && fastmod )
+		{
+			const float pit = m_pitRamp[0].next();
+			rampfreq( o1l_f, pit )
+			rampfreq( o1r_f, pit )
+		}
+		else if( o1f_mod )
 		{
 			modulatefreq( o1l_f, o1f )
 			modulatefreq( o1r_f, o1f )
 		}
 		// calc and modulate pulse
 		o1_pw = pw;
-		if( o1pw_mod )
+		if( o1pw_mod && fastmod )
+		{
+			o1_pw = m_pwRamp.next();
+		}
+		else if( o1pw_mod )
 		{
 			modulateabs( o1_pw, o1pw )
 			o1_pw = qBound( PW_MIN, o1_pw, PW_MAX );
@@ -383,7 +445,13 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		// calc and modulate phase
 		leftph = o1l_p;
 		rightph = o1r_p;
-		if( o1p_mod )
+		if( o1p_mod && fastmod )
+		{
+			const float phs = m_phsRamp[0].next();
+			leftph += phs;
+			rightph += phs;
+		}
+		else if( o1p_mod )
 		{
 			modulatephs( leftph, o1p )
 			modulatephs( rightph, o1p )
@@ -461,7 +529,13 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		// modulate volume
 		O1L *= o1lv;
 		O1R *= o1rv;
-		if( o1v_mod )
+		if( o1v_mod && fastmod )
+		{
+			const float vol = m_volRamp[0].next();
+			rampvol( O1L, vol )
+			rampvol( O1R, vol )
+		}
+		else if( o1v_mod )
 		{
 			modulatevol( O1L, o1v )
 			modulatevol( O1R, o1v )
@@ -480,7 +554,13 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		// calc and mod frequencies
 		o2l_f = o2lfb;
 		o2r_f = o2rfb;
-		if( o2f_mod )
+		if( o2f_mod && fastmod )
+		{
+			const float pit = m_pitRamp[1].next();
+			rampfreq( o2l_f, pit )
+			rampfreq( o2r_f, pit )
+		}
+		else if( o2f_mod )
 		{
 			modulatefreq( o2l_f, o2f )
 			modulatefreq( o2r_f, o2f )
@@ -489,7 +569,13 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		// calc and modulate phase
 		leftph = o2l_p;
 		rightph = o2r_p;
-		if( o2p_mod )
+		if( o2p_mod && fastmod )
+		{
+			const float phs = m_phsRamp[1].next();
+			leftph += phs;
+			rightph += phs;
+		}
+		else if( o2p_mod )
 		{
 			modulatephs( leftph, o2p )
 			modulatephs( rightph, o2p )
@@ -514,7 +600,13 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		// modulate volume
 		O2L *= o2lv;
 		O2R *= o2rv;
-		if( o2v_mod )
+		if( o2v_mod && fastmod )
+		{
+			const float vol = m_volRamp[1].next();
+			rampvol( O2L, vol )
+			rampvol( O2R, vol )
+		}
+		else if( o2v_mod )
 		{
 			modulatevol( O2L, o2v )
 			modulatevol( O2R, o2v )
@@ -539,7 +631,13 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		// calc and mod frequencies
 		o3l_f = o3fb;
 		o3r_f = o3fb;
-		if( o3f_mod )
+		if( o3f_mod && fastmod )
+		{
+			const float pit = m_pitRamp[2].next();
+			rampfreq( o3l_f, pit )
+			rampfreq( o3r_f, pit )
+		}
+		else if( o3f_mod )
 		{
 			modulatefreq( o3l_f, o3f )
 			modulatefreq( o3r_f, o3f )
@@ -547,7 +645,13 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		// calc and modulate phase
 		leftph = o3l_p;
 		rightph = o3r_p;
-		if( o3p_mod )
+		if( o3p_mod && fastmod )
+		{
+			const float phs = m_phsRamp[2].next();
+			leftph += phs;
+			rightph += phs;
+		}
+		else if( o3p_mod )
 		{
 			modulatephs( leftph, o3p )
 			modulatephs( rightph, o3p )
@@ -583,7 +687,11 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 
 		// calc and modulate sub
 		sub = o3sub;
-		if( o3s_mod )
+		if( o3s_mod && fastmod )
+		{
+			sub = m_subRamp.next();
+		}
+		else if( o3s_mod )
 		{
 			modulateabs( sub, o3s )
 			sub = qBound( 0.0f, sub, 1.0f );
@@ -595,7 +703,13 @@ void MonstroSynth::renderOutput( fpp_t _frames, sampleFrame * _buf  )
 		// modulate volume
 		O3L *= o3lv;
 		O3R *= o3rv;
-		if( o3v_mod )
+		if( o3v_mod && fastmod )
+		{
+			const float vol = m_volRamp[2].next();
+			rampvol( O3L, vol )
+			rampvol( O3R, vol )
+		}
+		else if( o3v_mod )
 		{
 			modulatevol( O3L, o3v )
 			modulatevol( O3R, o3v )
@@ -818,6 +932,26 @@ inline void MonstroSynth::updateModulators( float * env1, float * env2, float *
 }
 
 
+inline float MonstroSynth::modSum( const float * _amounts, f_cnt_t _f ) const
+{
+	return m_env[0][_f] * _amounts[0] + m_env[1][_f] * _amounts[1] +
+		m_lfo[0][_f] * _amounts[2] + m_lfo[1][_f] * _amounts[3];
+}
+
+
+inline float MonstroSynth::modVolume( const float * _amounts, f_cnt_t _f ) const
+{
+	float vol = 1.0f;
+	for( int i = 0; i < 2; ++i )
+	{
+		if( _amounts[i] > 0.0f ) vol *= ( 1.0f - _amounts[i] + _amounts[i] * m_env[i][_f] );
+		if( _amounts[i] < 0.0f ) vol *= ( 1.0f + _amounts[i] * m_env[i][_f] );
+		if( _amounts[i + 2] != 0.0f ) vol *= ( 1.0f + _amounts[i + 2] * m_lfo[i][_f] );
+	}
+	return vol;
+}
+
+
 inline sample_t MonstroSynth::calcSlope( int slope, sample_t s )
 {
 	if( m_parent->m_slope[slope] == 1.0f ) return s;
@@ -886,6 +1020,7 @@ MonstroInstrument::MonstroInstrument( InstrumentTrack * _instrument_track ) :
 		m_env2Slope( 0.0f, -1.0f, 1.0f, 0.001f, this, tr( "Env 2 slope" ) ),
 
 		m_o23Mod( 0, 0, NUM_MODS - 1, this, tr( "Osc 2+3 modulation" ) ),
+		m_fastMod( false, this, tr( "Fast modulation" ) ),
 
 		m_selectedView( 0, 0, 1, this, tr( "Selected view" ) ),
 
@@ -942,7 +1077,8 @@ MonstroInstrument::MonstroInstrument( InstrumentTrack * _instrument_track ) :
 		m_sub3env1( 0.0f, -1.0f, 1.0f, 0.001f, this, tr( "Osc 3 - Sub env 1" ) ),
 		m_sub3env2( 0.0f, -1.0f, 1.0f, 0.001f, this, tr( "Osc 3 - Sub env 2" ) ),
 		m_sub3lfo1( 0.0f, -1.0f, 1.0f, 0.001f, this, tr( "Osc 3 - Sub LFO 1" ) ),
-		m_sub3lfo2( 0.0f, -1.0f, 1.0f, 0.001f, this, tr( "Osc 3 - Sub LFO 2" ) )
+		m_sub3lfo2( 0.0f, -1.0f, 1.0f, 0.001f, this, tr( "Osc 3 - Sub LFO 2" ) ),
+		m_voices( voicePoolSize() )
 
 {
 
@@ -1038,7 +1174,7 @@ void MonstroInstrument::playNote( NotePlayHandle * _n,
 
 	if ( _n->totalFramesPlayed() == 0 || _n->m_pluginData == nullptr )
 	{
-		_n->m_pluginData = new MonstroSynth( this, _n );
+		_n->m_pluginData = m_voices.acquire( this, _n );
 	}
 
 	MonstroSynth * ms = static_cast<MonstroSynth *>( _n->m_pluginData );
@@ -1052,7 +1188,7 @@ void MonstroInstrument::playNote( NotePlayHandle * _n,
 
 void MonstroInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<MonstroSynth *>( _n->m_pluginData );
+	m_voices.release( static_cast<MonstroSynth *>( _n->m_pluginData ) );
 }
 
 
@@ -1116,6 +1252,7 @@ void MonstroInstrument::saveSettings( QDomDocument & _doc,
 	m_env2Slope.saveSettings( _doc, _this, "e2slo" );
 
 	m_o23Mod.saveSettings( _doc, _this, "o23mo" );
+	m_fastMod.saveSettings( _doc, _this, "fastmod" );
 
 	m_vol1env1.saveSettings( _doc, _this, "v1e1" );
 	m_vol1env2.saveSettings( _doc, _this, "v1e2" );
@@ -1233,6 +1370,7 @@ void MonstroInstrument::loadSettings( const QDomElement & _this )
 	m_env2Slope.loadSettings( _this, "e2slo" );
 
 	m_o23Mod.loadSettings( _this, "o23mo" );
+	m_fastMod.loadSettings( _this, "fastmod" );
 
 	m_vol1env1.loadSettings( _this, "v1e1" );
 	m_vol1env2.loadSettings( _this, "v1e2" );
@@ -1564,6 +1702,7 @@ void MonstroView::modelChanged()
 	m_env2SlopeKnob-> setModel( &m->  m_env2Slope );
 
 	m_o23ModGroup-> setModel( &m-> m_o23Mod );
+	m_fastModButton-> setModel( &m-> m_fastMod );
 	m_selectedViewGroup-> setModel( &m-> m_selectedView );
 
 	m_vol1env1Knob-> setModel( &m-> m_vol1env1 );
@@ -1820,6 +1959,8 @@ QWidget * MonstroView::setupMatrixView( QWidget * _parent )
 	makeknob( m_sub3lfo1Knob, MATCOL7, MATROW6, tr( "Modulation amount" ), "", "matrixKnob" )
 	makeknob( m_sub3lfo2Knob, MATCOL8, MATROW6, tr( "Modulation amount" ), "", "matrixKnob" )
 
+	maketinyled( m_fastModButton, 134, MATROW6 + 6, tr( "Fast modulation: evaluate the matrix every 16 frames and interpolate in between, which saves a lot of CPU" ) )
+
 	return( view );
 }
 
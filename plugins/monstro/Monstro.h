@@ -39,6 +39,7 @@
 #include "Oscillator.h"
 #include "lmms_math.h"
 #include "BandLimitedWave.h"
+#include "VoicePool.h"
 
 //
 //	UI Macros
@@ -143,6 +144,10 @@ const int NUM_MODS = 4;
 
 const float MODCLIP = 2.0;
 
+// frames between two evaluations of the modulation matrix in the fast
+// modulation mode
+const int MOD_INTERVAL = 16;
+
 const float MIN_FREQ = 18.0f;
 const float MAX_FREQ = 48000.0f;
 
@@ -173,6 +178,39 @@ private:
 
 	inline void updateModulators( float * env1, float * env2, float * lfo1, float * lfo2, int frames );
 
+	// a modulated value in the fast modulation mode, evaluated every
+	// MOD_INTERVAL frames and interpolated linearly in between
+	struct ModRamp
+	{
+		float value = 0.0f;
+		float step = 0.0f;
+		bool valid = false;		// false if value is stale
+
+		// reach _target after _frames frames
+		void start( float _target, int _frames )
+		{
+			if( !valid )
+			{
+				value = _target;
+				valid = true;
+			}
+			step = ( _target - value ) / _frames;
+		}
+
+		float next()
+		{
+			const float v = value;
+			value += step;
+			return v;
+		}
+	} ;
+
+	// what the modulation macros of renderOutput() add to or multiply
+	// with their carrier at frame _f, _amounts are the amounts of
+	// env 1, env 2, lfo 1 and lfo 2
+	inline float modSum( const float * _amounts, f_cnt_t _f ) const;
+	inline float modVolume( const float * _amounts, f_cnt_t _f ) const;
+
 	// linear interpolation
 /*	inline sample_t interpolate( sample_t s1, sample_t s2, float x )
 	{
@@ -290,6 +328,14 @@ private:
 	float m_ph3l_last;
 	float m_ph3r_last;
 
+	// the modulations of pitch, phase and volume of the 3 oscillators,
+	// pulse width of osc 1 and sub of osc 3 in the fast modulation mode
+	ModRamp m_pitRamp[3];
+	ModRamp m_phsRamp[3];
+	ModRamp m_volRamp[3];
+	ModRamp m_pwRamp;
+	ModRamp m_subRamp;
+
 	bool m_invert2l;
 	bool m_invert3l;
 	bool m_invert2r;
@@ -499,6 +545,7 @@ private:
 	FloatModel	m_env2Slope;
 
 	IntModel	m_o23Mod;
+	BoolModel	m_fastMod;
 
 	IntModel	m_selectedView;
 
@@ -563,6 +610,8 @@ private:
 	FloatModel	m_sub3lfo1;
 	FloatModel	m_sub3lfo2;
 
+	VoicePool<MonstroSynth> m_voices;
+
 	friend class MonstroSynth;
 	friend class MonstroView;
 
@@ -622,6 +671,8 @@ private:
 	PixmapButton * m_osc3SyncHButton;
 	PixmapButton * m_osc3SyncRButton;
 
+	PixmapButton * m_fastModButton;
+
 	ComboBox *	m_lfo1WaveBox;
 	TempoSyncKnob *	m_lfo1AttKnob;
 	TempoSyncKnob *	m_lfo1RateKnob;
@@ -105,7 +105,7 @@ NesObject::~NesObject()
 }
 
 
-void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
+void NesObject::renderOutput( sampleFrame * buf, fpp_t frames, const NesParameters & p )
 {
 	////////////////////////////////
 	//	                          //
@@ -113,21 +113,21 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 	//                            //
 	////////////////////////////////
 	
-	bool ch1Enabled = m_parent->m_ch1Enabled.value();
-	bool ch2Enabled = m_parent->m_ch2Enabled.value();
-	bool ch3Enabled = m_parent->m_ch3Enabled.value();
-	bool ch4Enabled = m_parent->m_ch4Enabled.value();
+	bool ch1Enabled = p.ch1Enabled;
+	bool ch2Enabled = p.ch2Enabled;
+	bool ch3Enabled = p.ch3Enabled;
+	bool ch4Enabled = p.ch4Enabled;
 	
-	float ch1DutyCycle = DUTY_CYCLE[ m_parent->m_ch1DutyCycle.value() ];
-	int ch1EnvLen = wavelength( floorf( 240.0 / ( m_parent->m_ch1EnvLen.value() + 1 ) ) );
-	bool ch1EnvLoop = m_parent->m_ch1EnvLooped.value();
+	float ch1DutyCycle = DUTY_CYCLE[ p.ch1DutyCycle ];
+	int ch1EnvLen = wavelength( floorf( 240.0 / ( p.ch1EnvLen + 1 ) ) );
+	bool ch1EnvLoop = p.ch1EnvLooped;
 	
-	float ch2DutyCycle = DUTY_CYCLE[ m_parent->m_ch2DutyCycle.value() ];
-	int ch2EnvLen = wavelength( floorf( 240.0 / ( m_parent->m_ch2EnvLen.value() + 1 ) ) );
-	bool ch2EnvLoop = m_parent->m_ch2EnvLooped.value();
+	float ch2DutyCycle = DUTY_CYCLE[ p.ch2DutyCycle ];
+	int ch2EnvLen = wavelength( floorf( 240.0 / ( p.ch2EnvLen + 1 ) ) );
+	bool ch2EnvLoop = p.ch2EnvLooped;
 	
-	int ch4EnvLen = wavelength( floorf( 240.0 / ( m_parent->m_ch4EnvLen.value() + 1 ) ) );
-	bool ch4EnvLoop = m_parent->m_ch4EnvLooped.value();
+	int ch4EnvLen = wavelength( floorf( 240.0 / ( p.ch4EnvLen + 1 ) ) );
+	bool ch4EnvLoop = p.ch4EnvLooped;
 	
 	// processing variables for operators
 	int ch1;
@@ -141,17 +141,17 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 	int ch3Level;
 	int ch4Level;
 	
-	int ch1SweepRate = wavelength( floorf( 120.0 / ( m_parent->m_ch1SweepRate.value() + 1 ) ) );
-	int ch2SweepRate = wavelength( floorf( 120.0 / ( m_parent->m_ch2SweepRate.value() + 1 ) ) );
-	int ch4SweepRate = wavelength( floorf( 60.0f / ( 8.0f - qAbs( m_parent->m_ch4Sweep.value() ) ) ) );
+	int ch1SweepRate = wavelength( floorf( 120.0 / ( p.ch1SweepRate + 1 ) ) );
+	int ch2SweepRate = wavelength( floorf( 120.0 / ( p.ch2SweepRate + 1 ) ) );
+	int ch4SweepRate = wavelength( floorf( 60.0f / ( 8.0f - qAbs( p.ch4Sweep ) ) ) );
 
-	int ch1Sweep = static_cast<int>( m_parent->m_ch1SweepAmt.value() * -1.0 );
-	int ch2Sweep = static_cast<int>( m_parent->m_ch2SweepAmt.value() * -1.0 );
+	int ch1Sweep = static_cast<int>( p.ch1SweepAmt * -1.0 );
+	int ch2Sweep = static_cast<int>( p.ch2SweepAmt * -1.0 );
 
 	int ch4Sweep = 0;
-	if( m_parent->m_ch4Sweep.value() != 0.0f )
+	if( p.ch4Sweep != 0.0f )
 	{
-		ch4Sweep = m_parent->m_ch4Sweep.value() > 0.0f
+		ch4Sweep = p.ch4Sweep > 0.0f
 			? -1
 			: 1;
 	}
@@ -203,9 +203,9 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		// render pulse wave
 		if( m_wlen1 <= m_maxWlen && m_wlen1 >= MIN_WLEN && ch1Enabled )
 		{
-			ch1Level = m_parent->m_ch1EnvEnabled.value()
-				? static_cast<int>( ( m_parent->m_ch1Volume.value() * m_ch1EnvValue ) / 15.0 )
-				: static_cast<int>( m_parent->m_ch1Volume.value() );
+			ch1Level = p.ch1EnvEnabled
+				? static_cast<int>( ( p.ch1Volume * m_ch1EnvValue ) / 15.0 )
+				: static_cast<int>( p.ch1Volume );
 			ch1 = m_ch1Counter > m_wlen1 * ch1DutyCycle 
 				? 0
 				: ch1Level;
@@ -217,25 +217,21 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		if( m_ch1SweepCounter >= ch1SweepRate )
 		{
 			m_ch1SweepCounter = 0;
-			if( m_parent->m_ch1SweepEnabled.value() && m_wlen1 <= m_maxWlen && m_wlen1 >= MIN_WLEN )
+			if( p.ch1SweepEnabled && m_wlen1 <= m_maxWlen && m_wlen1 >= MIN_WLEN )
 			{
 				// check if the sweep goes up or down
 				if( ch1Sweep > 0 )
 				{
-					m_wlen1 += m_wlen1 >> qAbs( ch1Sweep );
+					m_wlen1 += m_wlen1 / ( 1 << qAbs( ch1Sweep ) );
 				}
 				if( ch1Sweep < 0 )
 				{
-					m_wlen1 -= m_wlen1 >> qAbs( ch1Sweep );
+					m_wlen1 -= m_wlen1 / ( 1 << qAbs( ch1Sweep ) );
 					m_wlen1--;  // additional minus 1 for ch1 only
 				}
 			}
 		}
 					
-		// update framecounters
-		m_ch1Counter++;
-		m_ch1Counter = m_wlen1 ? m_ch1Counter % m_wlen1 : 0;
-
 		m_ch1EnvCounter++;
 		if( m_ch1EnvCounter >= ch1EnvLen )
 		{
@@ -257,9 +253,9 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		// render pulse wave
 		if( m_wlen2 <= m_maxWlen && m_wlen2 >= MIN_WLEN && ch2Enabled )
 		{
-			ch2Level = m_parent->m_ch2EnvEnabled.value()
-				? static_cast<int>( ( m_parent->m_ch2Volume.value() * m_ch2EnvValue ) / 15.0 )
-				: static_cast<int>( m_parent->m_ch2Volume.value() );
+			ch2Level = p.ch2EnvEnabled
+				? static_cast<int>( ( p.ch2Volume * m_ch2EnvValue ) / 15.0 )
+				: static_cast<int>( p.ch2Volume );
 			ch2 = m_ch2Counter > m_wlen2 * ch2DutyCycle 
 				? 0
 				: ch2Level;
@@ -271,24 +267,20 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		if( m_ch2SweepCounter >= ch2SweepRate )
 		{
 			m_ch2SweepCounter = 0;
-			if( m_parent->m_ch2SweepEnabled.value() && m_wlen2 <= m_maxWlen && m_wlen2 >= MIN_WLEN )
+			if( p.ch2SweepEnabled && m_wlen2 <= m_maxWlen && m_wlen2 >= MIN_WLEN )
 			{				
 				// check if the sweep goes up or down
 				if( ch2Sweep > 0 )
 				{
-					m_wlen2 += m_wlen2 >> qAbs( ch2Sweep );
+					m_wlen2 += m_wlen2 / ( 1 << qAbs( ch2Sweep ) );
 				}
 				if( ch2Sweep < 0 )
 				{
-					m_wlen2 -= m_wlen2 >> qAbs( ch2Sweep );
+					m_wlen2 -= m_wlen2 / ( 1 << qAbs( ch2Sweep ) );
 				}
 			}
 		}
 					
-		// update framecounters
-		m_ch2Counter++;
-		m_ch2Counter = m_wlen2 ? m_ch2Counter % m_wlen2 : 0;
-		
 		m_ch2EnvCounter++;
 		if( m_ch2EnvCounter >= ch2EnvLen )
 		{
@@ -315,7 +307,7 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		// render triangle wave
 		if( m_wlen3 <= m_maxWlen && ch3Enabled )
 		{
-			ch3Level = static_cast<int>( m_parent->m_ch3Volume.value() );
+			ch3Level = static_cast<int>( p.ch3Volume );
 			ch3 = m_wlen3 ? TRIANGLE_WAVETABLE[ ( m_ch3Counter * 32 ) / m_wlen3 ] : 0;
 			ch3 = ( ch3 * ch3Level ) / 15;
 		}
@@ -333,9 +325,9 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		// render pseudo noise 
 		if( ch4Enabled )
 		{
-			ch4Level = m_parent->m_ch4EnvEnabled.value()
-				? ( static_cast<int>( m_parent->m_ch4Volume.value() ) * m_ch4EnvValue ) / 15
-				: static_cast<int>( m_parent->m_ch4Volume.value() );
+			ch4Level = p.ch4EnvEnabled
+				? ( static_cast<int>( p.ch4Volume ) * m_ch4EnvValue ) / 15
+				: static_cast<int>( p.ch4Volume );
 			ch4 = LFSR()
 				? ch4Level
 				: 0;
@@ -347,7 +339,7 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		if( m_ch4Counter >= m_wlen4 )
 		{
 			m_ch4Counter = 0;
-			updateLFSR( m_parent->m_ch4NoiseMode.value() );
+			updateLFSR( p.ch4NoiseMode );
 		}
 		m_ch4EnvCounter++;
 		if( m_ch4EnvCounter >= ch4EnvLen )
@@ -389,7 +381,13 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		//                            //
 		////////////////////////////////			
 		
-		float pin1 = static_cast<float>( ch1 + ch2 ); 
+		// the pulses are band-limited, one sample late
+		float pin1 = m_pulseSteps.tick( static_cast<float>( ch1 + ch2 ) );
+
+		// update framecounters, which reports the edges before the next sample
+		advancePulse( m_ch1Counter, m_wlen1, ch1DutyCycle, ch1Level );
+		advancePulse( m_ch2Counter, m_wlen2, ch2DutyCycle, ch2Level );
+
 		// add dithering noise
 		pin1 *= 1.0 + ( Oscillator::noiseSample( 0.0f ) * DITHER_AMP );		
 		pin1 = pin1 / 30.0f;
@@ -426,7 +424,7 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 		
 		pin2 *= NES_MIXING_34;
 		
-		const float mixdown = ( pin1 + pin2 ) * NES_MIXING_ALL * m_parent->m_masterVol.value();
+		const float mixdown = ( pin1 + pin2 ) * NES_MIXING_ALL * p.masterVol;
 
 		buf[f][0] = mixdown;
 		buf[f][1] = mixdown;
@@ -436,6 +434,34 @@ void NesObject::renderOutput( sampleFrame * buf, fpp_t frames )
 }
 
 
+void NesObject::advancePulse( float & counter, float wlen, float dutyCycle, int level )
+{
+	if( wlen < MIN_WLEN )
+	{
+		counter = 0.0f;
+		return;
+	}
+
+	const float high = wlen * dutyCycle;
+	float next = counter + 1.0f;
+	if( counter <= high && next > high )
+	{
+		m_pulseSteps.addStep( next - high, -level );
+	}
+	if( next >= wlen )
+	{
+		// a sweep or a new pitch can shorten the wavelength below the counter
+		next = counter < wlen ? next - wlen : 0.0f;
+		m_pulseSteps.addStep( next, level );
+		if( next > high )
+		{
+			m_pulseSteps.addStep( next - high, -level );
+		}
+	}
+	counter = next;
+}
+
+
 void NesObject::updateVibrato( float * freq )
 {
 	float vibratoAmt = floorf( m_parent->m_vibrato.value() ) / 15.0f;
@@ -457,8 +483,8 @@ void NesObject::updatePitch()
 	// check if frequency has changed, if so, update wavelengths of ch1-3
 	if( freq != m_lastNoteFreq )
 	{
-		m_wlen1 = wavelength( freq * m_parent->m_freq1 );
-		m_wlen2 = wavelength( freq * m_parent->m_freq2 );
+		m_wlen1 = exactWavelength( freq * m_parent->m_freq1 );
+		m_wlen2 = exactWavelength( freq * m_parent->m_freq2 );
 		m_wlen3 = wavelength( freq * m_parent->m_freq3 );
 	}
 	// noise channel can use either note freq or preset freqs
@@ -535,7 +561,8 @@ NesInstrument::NesInstrument( InstrumentTrack * instrumentTrack ) :
 	
 	//master
 	m_masterVol( 1.0f, 0.0f, 2.0f, 0.01f, this, tr( "Master volume" ) ),
-	m_vibrato( 0.0f, 0.0f, 15.0f, 1.0f, this, tr( "Vibrato" ) )
+	m_vibrato( 0.0f, 0.0f, 15.0f, 1.0f, this, tr( "Vibrato" ) ),
+	m_voices( voicePoolSize() )
 {
 	connect( &m_ch1Crs, SIGNAL( dataChanged() ), this, SLOT( updateFreq1() ), Qt::DirectConnection );
 	connect( &m_ch2Crs, SIGNAL( dataChanged() ), this, SLOT( updateFreq2() ), Qt::DirectConnection );
@@ -554,19 +581,57 @@ NesInstrument::~NesInstrument()
 
 
 void NesInstrument::playNote( NotePlayHandle * n, sampleFrame * workingBuffer )
+{
+	playNote( n, workingBuffer, parameters() );
+}
+
+
+void NesInstrument::playNotes( NotePlayHandle * const * notes, size_t count )
+{
+	const NesParameters p = parameters();
+	for( size_t i = 0; i < count; ++i )
+	{
+		playNote( notes[i], notes[i]->buffer(), p );
+	}
+}
+
+
+NesParameters NesInstrument::parameters() const
+{
+	return NesParameters{
+		m_ch1Enabled.value(), m_ch1Volume.value(),
+		m_ch1EnvEnabled.value(), m_ch1EnvLooped.value(), m_ch1EnvLen.value(),
+		m_ch1DutyCycle.value(),
+		m_ch1SweepEnabled.value(), m_ch1SweepAmt.value(), m_ch1SweepRate.value(),
+
+		m_ch2Enabled.value(), m_ch2Volume.value(),
+		m_ch2EnvEnabled.value(), m_ch2EnvLooped.value(), m_ch2EnvLen.value(),
+		m_ch2DutyCycle.value(),
+		m_ch2SweepEnabled.value(), m_ch2SweepAmt.value(), m_ch2SweepRate.value(),
+
+		m_ch3Enabled.value(), m_ch3Volume.value(),
+
+		m_ch4Enabled.value(), m_ch4Volume.value(),
+		m_ch4EnvEnabled.value(), m_ch4EnvLooped.value(), m_ch4EnvLen.value(),
+		m_ch4NoiseMode.value(), m_ch4Sweep.value(),
+
+		m_masterVol.value() };
+}
+
+
+void NesInstrument::playNote( NotePlayHandle * n, sampleFrame * workingBuffer, const NesParameters & p )
 {
 	const fpp_t frames = n->framesLeftForCurrentPeriod();
 	const f_cnt_t offset = n->noteOffset();
 	
 	if ( n->totalFramesPlayed() == 0 || n->m_pluginData == nullptr )
 	{	
-		NesObject * nes = new NesObject( this, Engine::audioEngine()->processingSampleRate(), n );
-		n->m_pluginData = nes;
+		n->m_pluginData = m_voices.acquire( this, Engine::audioEngine()->processingSampleRate(), n );
 	}
 	
 	NesObject * nes = static_cast<NesObject *>( n->m_pluginData );
 	
-	nes->renderOutput( workingBuffer + offset, frames );
+	nes->renderOutput( workingBuffer + offset, frames, p );
 	
 	applyRelease( workingBuffer, n );
 
@@ -576,7 +641,7 @@ void NesInstrument::playNote( NotePlayHandle * n, sampleFrame * workingBuffer )
 
 void NesInstrument::deleteNotePluginData( NotePlayHandle * n )
 {
-	delete static_cast<NesObject *>( n->m_pluginData );
+	m_voices.release( static_cast<NesObject *>( n->m_pluginData ) );
 }
 
 
@@ -35,6 +35,8 @@
 #include "NotePlayHandle.h"
 #include "PixmapButton.h"
 #include "MemoryManager.h"
+#include "BandLimitedStep.h"
+#include "VoicePool.h"
 
 
 #define makeknob( name, x, y, hint, unit, oname ) 		\
@@ -81,6 +83,45 @@ const int MIN_WLEN = 4;
 
 class NesInstrument;
 
+//! The settings all notes of a period are rendered with, looked up once in
+//! NesInstrument::playNotes()
+struct NesParameters
+{
+	bool ch1Enabled;
+	float ch1Volume;
+	bool ch1EnvEnabled;
+	bool ch1EnvLooped;
+	float ch1EnvLen;
+	int ch1DutyCycle;
+	bool ch1SweepEnabled;
+	float ch1SweepAmt;
+	float ch1SweepRate;
+
+	bool ch2Enabled;
+	float ch2Volume;
+	bool ch2EnvEnabled;
+	bool ch2EnvLooped;
+	float ch2EnvLen;
+	int ch2DutyCycle;
+	bool ch2SweepEnabled;
+	float ch2SweepAmt;
+	float ch2SweepRate;
+
+	bool ch3Enabled;
+	float ch3Volume;
+
+	bool ch4Enabled;
+	float ch4Volume;
+	bool ch4EnvEnabled;
+	bool ch4EnvLooped;
+	float ch4EnvLen;
+	bool ch4NoiseMode;
+	float ch4Sweep;
+
+	float masterVol;
+};
+
+
 class NesObject
 {
 	MM_OPERATORS
@@ -88,7 +129,7 @@ public:
 	NesObject( NesInstrument * nes, const sample_rate_t samplerate, NotePlayHandle * nph );
 	virtual ~NesObject();
 	
-	void renderOutput( sampleFrame * buf, fpp_t frames );
+	void renderOutput( sampleFrame * buf, fpp_t frames, const NesParameters & p );
 	void updateVibrato( float * freq );
 	void updatePitch();
 	
@@ -128,6 +169,12 @@ public:
 	{
 		return static_cast<int>( m_samplerate / freq );
 	}
+
+	// the pulses aren't rounded to whole samples, their edges are band-limited
+	inline float exactWavelength( float freq )
+	{
+		return m_samplerate / freq;
+	}
 	
 	inline float signedPow( float f, float e )
 	{
@@ -150,6 +197,9 @@ public:
 	}
 	
 private:
+	// moves a pulse channel on by a sample and reports the edges it passes
+	void advancePulse( float & counter, float wlen, float dutyCycle, int level );
+
 	NesInstrument * m_parent;
 	const sample_rate_t m_samplerate;
 	NotePlayHandle * m_nph;
@@ -157,8 +207,8 @@ private:
 	int m_pitchUpdateCounter;
 	int m_pitchUpdateFreq;
 	
-	int m_ch1Counter;
-	int m_ch2Counter;
+	float m_ch1Counter;
+	float m_ch2Counter;
 	int m_ch3Counter;
 	int m_ch4Counter;
 	
@@ -176,6 +226,8 @@ private:
 	
 	uint16_t m_LFSR;
 	
+	BandLimitedStep m_pulseSteps;
+
 	float m_12Last;
 	float m_34Last;
 
@@ -187,8 +239,8 @@ private:
 	float m_nsf;
 
 // wavelengths	
-	int m_wlen1;
-	int m_wlen2;
+	float m_wlen1;
+	float m_wlen2;
 	int m_wlen3;
 	int m_wlen4;
 	
@@ -206,6 +258,7 @@ public:
 	
 	virtual void playNote( NotePlayHandle * n,
 						sampleFrame * workingBuffer );
+	virtual void playNotes( NotePlayHandle * const * notes, size_t count );
 	virtual void deleteNotePluginData( NotePlayHandle * n );
 
 
@@ -215,6 +268,11 @@ public:
 
 	virtual QString nodeName() const;
 
+	virtual Flags flags() const
+	{
+		return PlaysNotesBatched;
+	}
+
 	virtual f_cnt_t desiredReleaseFrames() const
 	{
 		return( 8 );
@@ -234,6 +292,10 @@ protected:
 	float m_freq3;
 	
 private:
+	NesParameters parameters() const;
+	// plays a note with the settings playNotes() looked up once for all notes
+	void playNote( NotePlayHandle * n, sampleFrame * workingBuffer, const NesParameters & p );
+
 	// channel 1
 	BoolModel	m_ch1Enabled;
 	FloatModel	m_ch1Crs;
@@ -287,6 +349,8 @@ private:
 	//master
 	FloatModel	m_masterVol;
 	FloatModel	m_vibrato;
+
+	VoicePool<NesObject> m_voices;
 	
 	
 	friend class NesObject;
@@ -77,6 +77,9 @@ float * organicInstrument::s_harmonics = nullptr;
 
 organicInstrument::organicInstrument( InstrumentTrack * _instrument_track ) :
 	Instrument( _instrument_track, &organic_plugin_descriptor ),
+	m_voices( voicePoolSize() ),
+	m_oscillators( voicePoolSize() * NUM_OSCILLATORS * 2,
+			VoicePool<Oscillator>::DefaultCapacity * NUM_OSCILLATORS * 2 ),
 	m_modulationAlgo( Oscillator::SignalMix, Oscillator::SignalMix, Oscillator::SignalMix),
 	m_fx1Model( 0.0f, 0.0f, 0.99f, 0.01f , this, tr( "Distortion" ) ),
 	m_volModel( 100.0f, 0.0f, 200.0f, 1.0f, this, tr( "Volume" ) )
@@ -235,21 +238,24 @@ void organicInstrument::playNote( NotePlayHandle * _n,
 		Oscillator * oscs_l[NUM_OSCILLATORS];
 		Oscillator * oscs_r[NUM_OSCILLATORS];
 
-		_n->m_pluginData = new oscPtr;
+		_n->m_pluginData = m_voices.acquire();
+
+		// the same phases in every render
+		FastRandom random( _n->randomSeed() );
 
 		for( int i = m_numOscillators - 1; i >= 0; --i )
 		{
 			static_cast<oscPtr *>( _n->m_pluginData )->phaseOffsetLeft[i] 
-				= rand() / ( RAND_MAX + 1.0f );
+				= random.nextUnipolar();
 			static_cast<oscPtr *>( _n->m_pluginData )->phaseOffsetRight[i] 
-				= rand() / ( RAND_MAX + 1.0f );
+				= random.nextUnipolar();
 			
 			// initialise ocillators
 			
 			if( i == m_numOscillators - 1 )
 			{
 				// create left oscillator
-				oscs_l[i] = new Oscillator(
+				oscs_l[i] = m_oscillators.acquire(
 						&m_osc[i]->m_waveShape,
 						&m_modulationAlgo,
 						_n->frequency(),
@@ -257,7 +263,7 @@ void organicInstrument::playNote( NotePlayHandle * _n,
 						static_cast<oscPtr *>( _n->m_pluginData )->phaseOffsetLeft[i],
 						m_osc[i]->m_volumeLeft );
 				// create right oscillator
-				oscs_r[i] = new Oscillator(
+				oscs_r[i] = m_oscillators.acquire(
 						&m_osc[i]->m_waveShape,
 						&m_modulationAlgo,
 						_n->frequency(),
@@ -268,7 +274,7 @@ void organicInstrument::playNote( NotePlayHandle * _n,
 			else
 			{
 				// create left oscillator
-				oscs_l[i] = new Oscillator(
+				oscs_l[i] = m_oscillators.acquire(
 						&m_osc[i]->m_waveShape,
 						&m_modulationAlgo,
 						_n->frequency(),
@@ -277,7 +283,7 @@ void organicInstrument::playNote( NotePlayHandle * _n,
 						m_osc[i]->m_volumeLeft,
 						oscs_l[i + 1] );
 				// create right oscillator
-				oscs_r[i] = new Oscillator(
+				oscs_r[i] = m_oscillators.acquire(
 						&m_osc[i]->m_waveShape,
 						&m_modulationAlgo,
 						_n->frequency(),
@@ -286,6 +292,8 @@ void organicInstrument::playNote( NotePlayHandle * _n,
 						m_osc[i]->m_volumeRight,
 						oscs_r[i + 1] );
 			}
+			oscs_l[i]->setRandomSeed( random.next() );
+			oscs_r[i]->setRandomSeed( random.next() );
 			
 				
 		}
@@ -324,12 +332,23 @@ void organicInstrument::playNote( NotePlayHandle * _n,
 
 void organicInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<Oscillator *>( static_cast<oscPtr *>(
-						_n->m_pluginData )->oscLeft );
-	delete static_cast<Oscillator *>( static_cast<oscPtr *>(
-						_n->m_pluginData )->oscRight );
-	
-	delete static_cast<oscPtr *>( _n->m_pluginData );
+	oscPtr * voice = static_cast<oscPtr *>( _n->m_pluginData );
+	releaseOscillators( voice->oscLeft );
+	releaseOscillators( voice->oscRight );
+	m_voices.release( voice );
+}
+
+
+
+
+void organicInstrument::releaseOscillators( Oscillator * osc )
+{
+	while( osc != nullptr )
+	{
+		Oscillator * subOsc = osc->takeSubOsc();
+		m_oscillators.release( osc );
+		osc = subOsc;
+	}
 }
 
 /*float inline organicInstrument::foldback(float in, float threshold)
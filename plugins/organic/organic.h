@@ -32,6 +32,7 @@
 #include "InstrumentView.h"
 #include "Oscillator.h"
 #include "AutomatableModel.h"
+#include "VoicePool.h"
 
 class QPixmap;
 
@@ -151,13 +152,17 @@ private:
 
 	struct oscPtr
 	{
-		MM_OPERATORS
 		Oscillator * oscLeft;
 		Oscillator * oscRight;
 		float phaseOffsetLeft[NUM_OSCILLATORS];
 		float phaseOffsetRight[NUM_OSCILLATORS];		
 	} ;
 
+	void releaseOscillators( Oscillator * osc );
+
+	VoicePool<oscPtr> m_voices;
+	VoicePool<Oscillator> m_oscillators;
+
 	const IntModel m_modulationAlgo;
 
 	FloatModel  m_fx1Model;
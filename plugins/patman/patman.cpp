@@ -131,6 +131,19 @@ QString patmanInstrument::nodeName( void ) const
 
 
 
+size_t patmanInstrument::memoryUsage() const
+{
+	size_t bytes = 0;
+	for( const SampleBuffer * sample : m_patchSamples )
+	{
+		bytes += sample->bytes();
+	}
+	return bytes;
+}
+
+
+
+
 void patmanInstrument::playNote( NotePlayHandle * _n,
 						sampleFrame * _working_buffer )
 {
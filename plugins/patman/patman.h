@@ -69,6 +69,8 @@ public:
 		return( 128 );
 	}
 
+	size_t memoryUsage() const override;
+
 	virtual PluginView * instantiateView( QWidget * _parent );
 
 
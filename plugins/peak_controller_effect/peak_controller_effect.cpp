@@ -30,6 +30,7 @@
 #include "PeakController.h"
 #include "peak_controller_effect.h"
 #include "lmms_math.h"
+#include "MixHelpers.h"
 
 #include "embed.h"
 #include "plugin_export.h"
@@ -103,26 +104,12 @@ bool PeakControllerEffect::processAudioBuffer( sampleFrame * _buf,
 	}
 
 	// RMS:
-	double sum = 0;
-
-	if( c.m_absModel.value() )
-	{
-		for( int i = 0; i < _frames; ++i )
-		{
-			// absolute value is achieved because the squares are > 0
-			sum += _buf[i][0]*_buf[i][0] + _buf[i][1]*_buf[i][1];
-		}
-	}
-	else
-	{
-		for( int i = 0; i < _frames; ++i )
-		{
-			// the value is absolute because of squaring,
-			// so we need to correct it
-			sum += _buf[i][0] * _buf[i][0] * sign( _buf[i][0] )
-				+ _buf[i][1] * _buf[i][1] * sign( _buf[i][1] );
-		}
-	}
+	const float sum = c.m_absModel.value()
+		// absolute value is achieved because the squares are > 0
+		? MixHelpers::energy( _buf, _frames )
+		// the value is absolute because of squaring, so we need to
+		// correct it
+		: MixHelpers::signedEnergy( _buf, _frames );
 
 	// TODO: flipping this might cause clipping
 	// this will mute the output after the values were measured
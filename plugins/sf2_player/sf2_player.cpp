@@ -31,6 +31,7 @@
 #include <QDomDocument>
 
 #include "AudioEngine.h"
+#include "BufferManager.h"
 #include "ConfigManager.h"
 #include "FileDialog.h"
 #include "ConfigManager.h"
@@ -46,6 +47,7 @@
 #include "patches_dialog.h"
 #include "ToolTip.h"
 #include "LcdSpinBox.h"
+#include "MixHelpers.h"
 
 #include "embed.h"
 #include "plugin_export.h"
@@ -95,6 +97,7 @@ sf2Instrument::sf2Instrument( InstrumentTrack * _instrument_track ) :
 	m_font( nullptr ),
 	m_fontId( 0 ),
 	m_filename( "" ),
+	m_idle( false ),
 	m_lastMidiPitch( -1 ),
 	m_lastMidiPitchRange( -1 ),
 	m_channel( 1 ),
@@ -327,6 +330,15 @@ QString sf2Instrument::nodeName() const
 
 
 
+size_t sf2Instrument::memoryUsage() const
+{
+	QMutexLocker lock( &s_fontsMutex );
+	return m_font != nullptr ? m_font->bytes : 0;
+}
+
+
+
+
 void sf2Instrument::freeFont()
 {
 	m_synthMutex.lock();
@@ -352,9 +364,9 @@ void sf2Instrument::freeFont()
 
 			fluid_synth_remove_sfont( m_synth, m_font->fluidFont );
 		}
-		s_fontsMutex.unlock();
-
+		// with the lock held for memoryUsage()
 		m_font = nullptr;
+		s_fontsMutex.unlock();
 	}
 	m_synthMutex.unlock();
 }
@@ -398,7 +410,8 @@ void sf2Instrument::openFile( const QString & _sf2File, bool updateTrackName )
 			if( fluid_synth_sfcount( m_synth ) > 0 )
 			{
 				// Grab this sf from the top of the stack and add to list
-				m_font = new sf2Font( fluid_synth_get_sfont( m_synth, 0 ) );
+				m_font = new sf2Font( fluid_synth_get_sfont( m_synth, 0 ),
+							QFileInfo( PathUtil::toAbsolute( _sf2File ) ).size() );
 				s_fonts.insert( relativePath, m_font );
 				loaded = true;
 			}
@@ -575,6 +588,7 @@ void sf2Instrument::reloadSynth()
 	}
 
 	m_synthMutex.lock();
+	m_idle = false;
 	if( Engine::audioEngine()->currentQualitySettings().interpolation >=
 			AudioEngine::qualitySettings::Interpolation_SincFastest )
 	{
@@ -686,6 +700,7 @@ void sf2Instrument::noteOn( SF2PluginData * n )
 	}
 
 	fluid_synth_noteon( m_synth, m_channel, n->midiNote, n->lastVelocity );
+	m_idle = false;
 
 	// get new voice and save it
 	fluid_synth_get_voicelist( m_synth, voices, poly, -1 );
@@ -814,6 +829,12 @@ void sf2Instrument::play( sampleFrame * _working_buffer )
 void sf2Instrument::renderFrames( f_cnt_t frames, sampleFrame * buf )
 {
 	m_synthMutex.lock();
+	if( m_idle )
+	{
+		BufferManager::clear( buf, frames );
+		m_synthMutex.unlock();
+		return;
+	}
 	if( m_internalSampleRate < Engine::audioEngine()->processingSampleRate() &&
 							m_srcState != nullptr )
 	{
@@ -849,6 +870,10 @@ void sf2Instrument::renderFrames( f_cnt_t frames, sampleFrame * buf )
 	{
 		fluid_synth_write_float( m_synth, frames, buf, 0, 2, buf, 1, 2 );
 	}
+	// an idle track of a big SoundFont setup costs nothing until it plays
+	// again, but reverb and chorus tails have to be rendered to the end
+	m_idle = fluid_synth_get_active_voice_count( m_synth ) == 0 &&
+					MixHelpers::isSilent( buf, frames );
 	m_synthMutex.unlock();
 }
 
@@ -74,6 +74,8 @@ public:
 
 	virtual QString nodeName() const;
 
+	size_t memoryUsage() const override;
+
 	virtual f_cnt_t desiredReleaseFrames() const
 	{
 		return 0;
@@ -129,6 +131,9 @@ private:
 	QMutex m_loadMutex;
 
 	int m_notesRunning[128];
+	// no voices are playing and the effects died away, so rendering can be
+	// skipped until the next note, protected by m_synthMutex
+	bool m_idle;
 	sample_rate_t m_internalSampleRate;
 	int m_lastMidiPitch;
 	int m_lastMidiPitchRange;
@@ -176,13 +181,17 @@ class sf2Font
 {
 	MM_OPERATORS
 public:
-	sf2Font( fluid_sfont_t * f ) :
+	sf2Font( fluid_sfont_t * f, size_t fileSize ) :
 		fluidFont( f ),
-		refCount( 1 )
+		refCount( 1 ),
+		bytes( fileSize )
 	{};
 
 	fluid_sfont_t * fluidFont;
 	int refCount;
+	// FluidSynth loads all samples of the font, which make up nearly all
+	// of the file
+	size_t bytes;
 };
 
 
@@ -79,7 +79,10 @@ Plugin::Descriptor PLUGIN_EXPORT sfxr_plugin_descriptor =
 
 SfxrSynth::SfxrSynth( const sfxrInstrument * s ):
 	s(s),
-	playing_sample( true )
+	playing_sample( true ),
+	prev_sample( 0.0f ),
+	next_sample( 0.0f ),
+	resample_pos( 0.0f )
 {
     resetSample( false );
 }
@@ -163,154 +166,159 @@ void SfxrSynth::resetSample( bool restart )
 
 
 
-void SfxrSynth::update( sampleFrame * buffer, const int32_t frameNum )
+void SfxrSynth::update( sampleFrame * buffer, const fpp_t frames, const float rate )
 {
-	for(int i=0;i<frameNum;i++)
+	for( fpp_t f = 0; f < frames; ++f )
 	{
-        if(!playing_sample)
-        {
-            for( ch_cnt_t j=0; j < DEFAULT_CHANNELS; j++ )
-            {
-                buffer[i][j]=0.0f;
-            }
-        }
-
-		rep_time++;
-		if(rep_limit!=0 && rep_time>=rep_limit)
+		resample_pos += rate;
+		while( resample_pos >= 1.0f )
 		{
-			rep_limit=0;
-			resetSample(true);
-		}
-
-		// frequency envelopes/arpeggios
-		arp_time++;
-		if(arp_limit!=0 && arp_time>=arp_limit)
-		{
-			arp_limit=0;
-			fperiod*=arp_mod;
+			prev_sample = next_sample;
+			next_sample = nextSample();
+			resample_pos -= 1.0f;
 		}
-		fslide+=fdslide;
-		fperiod*=fslide;
-		if(fperiod>fmaxperiod)
+		const sample_t sample = prev_sample + ( next_sample - prev_sample ) * resample_pos;
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
 		{
-			fperiod=fmaxperiod;
-			if(s->m_minFreqModel.value()>0.0f)
-				playing_sample=false;
+			buffer[f][ch] = sample;
 		}
-		float rfperiod=fperiod;
-		if(vib_amp>0.0f)
+	}
+}
+
+
+
+
+sample_t SfxrSynth::nextSample()
+{
+	rep_time++;
+	if(rep_limit!=0 && rep_time>=rep_limit)
+	{
+		rep_limit=0;
+		resetSample(true);
+	}
+
+	// frequency envelopes/arpeggios
+	arp_time++;
+	if(arp_limit!=0 && arp_time>=arp_limit)
+	{
+		arp_limit=0;
+		fperiod*=arp_mod;
+	}
+	fslide+=fdslide;
+	fperiod*=fslide;
+	if(fperiod>fmaxperiod)
+	{
+		fperiod=fmaxperiod;
+		if(s->m_minFreqModel.value()>0.0f)
+			playing_sample=false;
+	}
+	float rfperiod=fperiod;
+	if(vib_amp>0.0f)
+	{
+		vib_phase+=vib_speed;
+		rfperiod=fperiod*(1.0+sin(vib_phase)*vib_amp);
+	}
+	period=(int)rfperiod;
+	if(period<8) period=8;
+	square_duty+=square_slide;
+	if(square_duty<0.0f) square_duty=0.0f;
+	if(square_duty>0.5f) square_duty=0.5f;
+	// volume envelope
+	env_time++;
+	if(env_time>env_length[env_stage])
+	{
+		env_time=0;
+		env_stage++;
+		if(env_stage==3)
+			playing_sample=false;
+	}
+	if(env_stage==0)
+		env_vol=(float)env_time/env_length[0];
+	if(env_stage==1)
+		env_vol=1.0f+pow(1.0f-(float)env_time/env_length[1], 1.0f)*2.0f*s->m_susModel.value();
+	if(env_stage==2)
+		env_vol=1.0f-(float)env_time/env_length[2];
+
+	// phaser step
+	fphase+=fdphase;
+	iphase=abs((int)fphase);
+	if(iphase>1023) iphase=1023;
+
+	if(flthp_d!=0.0f)
+	{
+		flthp*=flthp_d;
+		if(flthp<0.00001f) flthp=0.00001f;
+		if(flthp>0.1f) flthp=0.1f;
+	}
+
+	float ssample=0.0f;
+	for(int si=0;si<8;si++) // 8x supersampling
+	{
+		float sample=0.0f;
+		phase++;
+		if(phase>=period)
 		{
-			vib_phase+=vib_speed;
-			rfperiod=fperiod*(1.0+sin(vib_phase)*vib_amp);
+//				phase=0;
+			phase%=period;
+			if(s->m_waveFormModel.value()==3)
+				for(int i=0;i<32;i++)
+					noise_buffer[i]=frnd(2.0f)-1.0f;
 		}
-		period=(int)rfperiod;
-		if(period<8) period=8;
-		square_duty+=square_slide;
-		if(square_duty<0.0f) square_duty=0.0f;
-		if(square_duty>0.5f) square_duty=0.5f;
-		// volume envelope
-		env_time++;
-		if(env_time>env_length[env_stage])
+		// base waveform
+		float fp=(float)phase/period;
+		switch(s->m_waveFormModel.value())
 		{
-			env_time=0;
-			env_stage++;
-			if(env_stage==3)
-				playing_sample=false;
+		case 0: // square
+			if(fp<square_duty)
+				sample=0.5f;
+			else
+				sample=-0.5f;
+			break;
+		case 1: // sawtooth
+			sample=1.0f-fp*2;
+			break;
+		case 2: // sine
+			sample=(float)sin(fp*2*PI);
+			break;
+		case 3: // noise
+			sample=noise_buffer[phase*32/period];
+			break;
 		}
-		if(env_stage==0)
-			env_vol=(float)env_time/env_length[0];
-		if(env_stage==1)
-			env_vol=1.0f+pow(1.0f-(float)env_time/env_length[1], 1.0f)*2.0f*s->m_susModel.value();
-		if(env_stage==2)
-			env_vol=1.0f-(float)env_time/env_length[2];
-
-		// phaser step
-		fphase+=fdphase;
-		iphase=abs((int)fphase);
-		if(iphase>1023) iphase=1023;
-
-		if(flthp_d!=0.0f)
+		// lp filter
+		float pp=fltp;
+		fltw*=fltw_d;
+		if(fltw<0.0f) fltw=0.0f;
+		if(fltw>0.1f) fltw=0.1f;
+		if(s->m_lpFilCutModel.value()!=1.0f)
 		{
-			flthp*=flthp_d;
-			if(flthp<0.00001f) flthp=0.00001f;
-			if(flthp>0.1f) flthp=0.1f;
+			fltdp+=(sample-fltp)*fltw;
+			fltdp-=fltdp*fltdmp;
 		}
-
-		float ssample=0.0f;
-		for(int si=0;si<8;si++) // 8x supersampling
+		else
 		{
-			float sample=0.0f;
-			phase++;
-			if(phase>=period)
-			{
-//				phase=0;
-				phase%=period;
-				if(s->m_waveFormModel.value()==3)
-					for(int i=0;i<32;i++)
-						noise_buffer[i]=frnd(2.0f)-1.0f;
-			}
-			// base waveform
-			float fp=(float)phase/period;
-			switch(s->m_waveFormModel.value())
-			{
-			case 0: // square
-				if(fp<square_duty)
-					sample=0.5f;
-				else
-					sample=-0.5f;
-				break;
-			case 1: // sawtooth
-				sample=1.0f-fp*2;
-				break;
-			case 2: // sine
-				sample=(float)sin(fp*2*PI);
-				break;
-			case 3: // noise
-				sample=noise_buffer[phase*32/period];
-				break;
-			}
-			// lp filter
-			float pp=fltp;
-			fltw*=fltw_d;
-			if(fltw<0.0f) fltw=0.0f;
-			if(fltw>0.1f) fltw=0.1f;
-			if(s->m_lpFilCutModel.value()!=1.0f)
-			{
-				fltdp+=(sample-fltp)*fltw;
-				fltdp-=fltdp*fltdmp;
-			}
-			else
-			{
-				fltp=sample;
-				fltdp=0.0f;
-			}
-			fltp+=fltdp;
-			// hp filter
-			fltphp+=fltp-pp;
-			fltphp-=fltphp*flthp;
-			sample=fltphp;
-			// phaser
-			phaser_buffer[ipp&1023]=sample;
-			sample+=phaser_buffer[(ipp-iphase+1024)&1023];
-			ipp=(ipp+1)&1023;
-			// final accumulation and envelope application
-			ssample+=sample*env_vol;
+			fltp=sample;
+			fltdp=0.0f;
 		}
-		//ssample=ssample/8*master_vol;
+		fltp+=fltdp;
+		// hp filter
+		fltphp+=fltp-pp;
+		fltphp-=fltphp*flthp;
+		sample=fltphp;
+		// phaser
+		phaser_buffer[ipp&1023]=sample;
+		sample+=phaser_buffer[(ipp-iphase+1024)&1023];
+		ipp=(ipp+1)&1023;
+		// final accumulation and envelope application
+		ssample+=sample*env_vol;
+	}
+	//ssample=ssample/8*master_vol;
 
-		//ssample*=2.0f*sound_vol;
-		ssample*=0.025f;
+	//ssample*=2.0f*sound_vol;
+	ssample*=0.025f;
 
-		if(buffer!=nullptr)
-		{
-			if(ssample>1.0f) ssample=1.0f;
-			if(ssample<-1.0f) ssample=-1.0f;
-			for( ch_cnt_t j=0; j<DEFAULT_CHANNELS; j++ )
-			{
-				buffer[i][j]=ssample;
-			}
-		}
-	}
+	if(ssample>1.0f) ssample=1.0f;
+	if(ssample<-1.0f) ssample=-1.0f;
+	return ssample;
 }
 
 
@@ -354,7 +362,8 @@ sfxrInstrument::sfxrInstrument( InstrumentTrack * _instrument_track ) :
 	m_lpFilResoModel(0.0f, this, "LP Filter Resonance"),
 	m_hpFilCutModel(0.0f, this, "HP Filter Cutoff"),
 	m_hpFilCutSweepModel(0.0f, this, "HP Filter Cutoff Sweep"),
-	m_waveFormModel( SQR_WAVE, 0, WAVES_NUM-1, this, tr( "Wave" ) )
+	m_waveFormModel( SQR_WAVE, 0, WAVES_NUM-1, this, tr( "Wave" ) ),
+	m_voices( voicePoolSize() )
 {
 }
 
@@ -461,7 +470,7 @@ void sfxrInstrument::playNote( NotePlayHandle * _n, sampleFrame * _working_buffe
     const f_cnt_t offset = _n->noteOffset();
 	if ( _n->totalFramesPlayed() == 0 || _n->m_pluginData == nullptr )
 	{
-		_n->m_pluginData = new SfxrSynth( this );
+		_n->m_pluginData = m_voices.acquire( this );
 	}
 	else if( static_cast<SfxrSynth*>(_n->m_pluginData)->isPlaying() == false )
 	{
@@ -470,25 +479,10 @@ void sfxrInstrument::playNote( NotePlayHandle * _n, sampleFrame * _working_buffe
 		return;
 	}
 
+	// sfxr renders at 44.1 kHz
 	const auto baseFreq = instrumentTrack()->baseFreq();
-	int32_t pitchedFrameNum = (_n->frequency() / baseFreq) * frameNum;
-
-	pitchedFrameNum /= ( currentSampleRate / 44100 );
-
-// debug code
-//	qDebug( "pFN %d", pitchedFrameNum );
-
-	sampleFrame * pitchedBuffer = new sampleFrame[pitchedFrameNum];
-	static_cast<SfxrSynth*>(_n->m_pluginData)->update( pitchedBuffer, pitchedFrameNum );
-	for( fpp_t i=0; i<frameNum; i++ )
-	{
-		for( ch_cnt_t j=0; j<DEFAULT_CHANNELS; j++ )
-		{
-			_working_buffer[i+offset][j] = pitchedBuffer[i*pitchedFrameNum/frameNum][j];
-		}
-	}
-
-	delete[] pitchedBuffer;
+	const float rate = _n->frequency() / baseFreq * 44100 / currentSampleRate;
+	static_cast<SfxrSynth*>(_n->m_pluginData)->update( _working_buffer + offset, frameNum, rate );
 
 	applyRelease( _working_buffer, _n );
 
@@ -501,7 +495,7 @@ void sfxrInstrument::playNote( NotePlayHandle * _n, sampleFrame * _working_buffe
 
 void sfxrInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<SfxrSynth *>( _n->m_pluginData );
+	m_voices.release( static_cast<SfxrSynth *>( _n->m_pluginData ) );
 }
 
 
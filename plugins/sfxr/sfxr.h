@@ -35,6 +35,7 @@
 #include "PixmapButton.h"
 #include "LedCheckbox.h"
 #include "MemoryManager.h"
+#include "VoicePool.h"
 
 
 enum SfxrWaves
@@ -76,13 +77,22 @@ public:
 	virtual ~SfxrSynth();
 
 	void resetSample( bool restart );
-	void update( sampleFrame * buffer, const int32_t frameNum );
+	//! Renders @p frames, @p rate sfxr samples (at 44.1 kHz) per frame,
+	//! interpolating between them
+	void update( sampleFrame * buffer, const fpp_t frames, const float rate );
 
 	bool isPlaying() const;
 
 private:
+	//! The next sfxr sample
+	sample_t nextSample();
+
 	const sfxrInstrument * s;
 	bool playing_sample;
+	// the two samples update() interpolates between, and where
+	float prev_sample;
+	float next_sample;
+	float resample_pos;
 	int phase;
 	double fperiod;
 	double fmaxperiod;
@@ -217,6 +227,8 @@ private:
 
 	IntModel m_waveFormModel;
 
+	VoicePool<SfxrSynth> m_voices;
+
 	friend class sfxrInstrumentView;
 	friend class SfxrSynth;
 };
@@ -27,6 +27,7 @@
 #include "mallets.h"
 
 #include <QDir>
+#include <QMutex>
 #include <QMessageBox>
 
 #include "BandedWG.h"
@@ -43,6 +44,19 @@
 #include "embed.h"
 #include "plugin_export.h"
 
+namespace
+{
+
+// STK is not thread-safe, and its sample rate and rawwave path are global
+QMutex stkMutex;
+
+// voices of each type created with the instrument, and kept at most
+const int PreloadedVoices = 4;
+const size_t MaxPooledVoices = 32;
+
+}
+
+
 extern "C"
 {
 
@@ -85,7 +99,8 @@ malletsInstrument::malletsInstrument( InstrumentTrack * _instrument_track ):
 	m_versionModel( MALLETS_PRESET_VERSION, 0, MALLETS_PRESET_VERSION, this, "" ),
 	m_isOldVersionModel( false, this, "" ),
 	m_filesMissing( !QDir( ConfigManager::inst()->stkDir() ).exists() ||
-		!QFileInfo( ConfigManager::inst()->stkDir() + "/sinewave.raw" ).exists() )
+		!QFileInfo( ConfigManager::inst()->stkDir() + "/sinewave.raw" ).exists() ),
+	m_voicesSampleRate( Engine::audioEngine()->processingSampleRate() )
 {
 	// ModalBar
 	m_presetsModel.addItem( tr( "Marimba" ) );
@@ -120,6 +135,22 @@ malletsInstrument::malletsInstrument( InstrumentTrack * _instrument_track ):
 	m_scalers.append( 16.0 );
 	m_presetsModel.addItem( tr( "Tibetan bowl" ) );
 	m_scalers.append( 7.0 );
+
+	if( !m_filesMissing )
+	{
+		QMutexLocker locker( &stkMutex );
+		for( int type = 0; type < VoiceTypeCount; ++type )
+		{
+			m_voices[type].reserve( MaxPooledVoices );
+			for( int i = 0; i < PreloadedVoices; ++i )
+			{
+				if( Instrmnt * voice = createVoice( type, m_voicesSampleRate ) )
+				{
+					m_voices[type].push_back( voice );
+				}
+			}
+		}
+	}
 }
 
 
@@ -127,6 +158,14 @@ malletsInstrument::malletsInstrument( InstrumentTrack * _instrument_track ):
 
 malletsInstrument::~malletsInstrument()
 {
+	QMutexLocker locker( &stkMutex );
+	for( std::vector<Instrmnt *> & voices : m_voices )
+	{
+		for( Instrmnt * voice : voices )
+		{
+			delete voice;
+		}
+	}
 }
 
 
@@ -295,12 +334,15 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 			m_isOldVersionModel.value() ? 100.0 : 200.0;
 		const float vel = _n->getVolume() / velocityAdjust;
 
+		const sample_rate_t sampleRate = Engine::audioEngine()->processingSampleRate();
+
 		// critical section as STK is not thread-safe
-		static QMutex m;
-		m.lock();
+		stkMutex.lock();
+		Instrmnt * voice = acquireVoice( voiceType( p ), sampleRate );
 		if( p < 9 )
 		{
-			_n->m_pluginData = new malletsSynth( freq,
+			_n->m_pluginData = new malletsSynth( voice,
+						freq,
 						vel,
 						m_stickModel.value(),
 						m_hardnessModel.value(),
@@ -309,11 +351,12 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 						m_vibratoFreqModel.value(),
 						p,
 						(uint8_t) m_spreadModel.value(),
-				Engine::audioEngine()->processingSampleRate() );
+						sampleRate );
 		}
 		else if( p == 9 )
 		{
-			_n->m_pluginData = new malletsSynth( freq,
+			_n->m_pluginData = new malletsSynth( voice,
+						freq,
 						vel,
 						p,
 						m_lfoDepthModel.value(),
@@ -322,11 +365,12 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 						m_lfoSpeedModel.value(),
 						m_adsrModel.value(),
 						(uint8_t) m_spreadModel.value(),
-				Engine::audioEngine()->processingSampleRate() );
+						sampleRate );
 		}
 		else
 		{
-			_n->m_pluginData = new malletsSynth( freq,
+			_n->m_pluginData = new malletsSynth( voice,
+						freq,
 						vel,
 						m_pressureModel.value(),
 						m_motionModel.value(),
@@ -335,9 +379,9 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 						m_strikeModel.value() * 128.0,
 						m_velocityModel.value(),
 						(uint8_t) m_spreadModel.value(),
-				Engine::audioEngine()->processingSampleRate() );
+						sampleRate );
 		}
-		m.unlock();
+		stkMutex.unlock();
 		static_cast<malletsSynth *>(_n->m_pluginData)->setPresetIndex(p);
 	}
 
@@ -370,7 +414,97 @@ void malletsInstrument::playNote( NotePlayHandle * _n,
 
 void malletsInstrument::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<malletsSynth *>( _n->m_pluginData );
+	malletsSynth * ps = static_cast<malletsSynth *>( _n->m_pluginData );
+	Instrmnt * voice = ps->voice();
+	const int type = voiceType( ps->presetIndex() );
+	const sample_rate_t sampleRate = ps->sampleRate();
+
+	stkMutex.lock();
+	delete ps;
+	releaseVoice( type, voice, sampleRate );
+	stkMutex.unlock();
+}
+
+
+
+
+int malletsInstrument::voiceType( int preset )
+{
+	return preset < 9 ? ModalBarVoice : preset == 9 ? TubeBellVoice : BandedWGVoice;
+}
+
+
+
+
+Instrmnt * malletsInstrument::acquireVoice( int type, sample_rate_t sampleRate )
+{
+	if( sampleRate != m_voicesSampleRate )
+	{
+		for( std::vector<Instrmnt *> & voices : m_voices )
+		{
+			for( Instrmnt * voice : voices )
+			{
+				delete voice;
+			}
+			voices.clear();
+		}
+		m_voicesSampleRate = sampleRate;
+	}
+
+	std::vector<Instrmnt *> & voices = m_voices[type];
+	if( voices.empty() )
+	{
+		// more notes at once than ever before
+		return createVoice( type, sampleRate );
+	}
+	Instrmnt * voice = voices.back();
+	voices.pop_back();
+	return voice;
+}
+
+
+
+
+void malletsInstrument::releaseVoice( int type, Instrmnt * voice, sample_rate_t sampleRate )
+{
+	if( voice == nullptr )
+	{
+		return;
+	}
+	std::vector<Instrmnt *> & voices = m_voices[type];
+	if( sampleRate != m_voicesSampleRate || voices.size() >= MaxPooledVoices )
+	{
+		delete voice;
+		return;
+	}
+	voices.push_back( voice );
+}
+
+
+
+
+Instrmnt * malletsInstrument::createVoice( int type, sample_rate_t sampleRate )
+{
+	try
+	{
+		Stk::setSampleRate( sampleRate );
+		Stk::setRawwavePath( QDir( ConfigManager::inst()->stkDir() ).absolutePath()
+						.toLocal8Bit().constData() );
+#ifndef LMMS_DEBUG
+		Stk::showWarnings( false );
+#endif
+
+		switch( type )
+		{
+			case ModalBarVoice: return new ModalBar();
+			case TubeBellVoice: return new TubeBell();
+			default: return new BandedWG();
+		}
+	}
+	catch( ... )
+	{
+		return nullptr;
+	}
 }
 
 
@@ -606,7 +740,8 @@ void malletsInstrumentView::changePreset()
 
 
 // ModalBar
-malletsSynth::malletsSynth( const StkFloat _pitch,
+malletsSynth::malletsSynth( Instrmnt * _voice,
+				const StkFloat _pitch,
 				const StkFloat _velocity,
 				const StkFloat _control1,
 				const StkFloat _control2,
@@ -616,19 +751,12 @@ malletsSynth::malletsSynth( const StkFloat _pitch,
 				const int _control16,
 				const uint8_t _delay,
 				const sample_rate_t _sample_rate ) :
-	m_presetIndex(0)
+	m_presetIndex(0),
+	m_voice( _voice ),
+	m_sampleRate( _sample_rate )
 {
-	try
+	if( m_voice )
 	{
-		Stk::setSampleRate( _sample_rate );
-		Stk::setRawwavePath( QDir( ConfigManager::inst()->stkDir() ).absolutePath()
-						.toLocal8Bit().constData() );
-#ifndef LMMS_DEBUG
-		Stk::showWarnings( false );
-#endif
-
-		m_voice = new ModalBar();
-	
 		m_voice->controlChange( 16, _control16 );
 		m_voice->controlChange( 1, _control1 );
 		m_voice->controlChange( 2, _control2 );
@@ -636,28 +764,19 @@ malletsSynth::malletsSynth( const StkFloat _pitch,
 		m_voice->controlChange( 8, _control8 );
 		m_voice->controlChange( 11, _control11 );
 		m_voice->controlChange( 128, 128.0f );
-		
+
 		m_voice->noteOn( _pitch, _velocity );
 	}
-	catch( ... )
-	{
-		m_voice = nullptr;
-	}
-	
-	m_delay = new StkFloat[256];
-	m_delayRead = 0;
-	m_delayWrite = _delay;
-	for( int i = 0; i < 256; i++ )
-	{
-		m_delay[i] = 0.0;
-	}
+
+	init( _delay );
 }
 
 
 
 
 // TubeBell
-malletsSynth::malletsSynth( const StkFloat _pitch,
+malletsSynth::malletsSynth( Instrmnt * _voice,
+				const StkFloat _pitch,
 				const StkFloat _velocity,
 				const int _preset,
 				const StkFloat _control1,
@@ -667,46 +786,30 @@ malletsSynth::malletsSynth( const StkFloat _pitch,
 				const StkFloat _control128,
 				const uint8_t _delay,
 				const sample_rate_t _sample_rate ) :
-	m_presetIndex(0)
+	m_presetIndex(0),
+	m_voice( _voice ),
+	m_sampleRate( _sample_rate )
 {
-	try
+	if( m_voice )
 	{
-		Stk::setSampleRate( _sample_rate );
-		Stk::setRawwavePath( QDir( ConfigManager::inst()->stkDir() ).absolutePath()
-						.toLocal8Bit().constData() );
-#ifndef LMMS_DEBUG
-		Stk::showWarnings( false );
-#endif
-
-		m_voice = new TubeBell();
-	
 		m_voice->controlChange( 1, _control1 );
 		m_voice->controlChange( 2, _control2 );
 		m_voice->controlChange( 4, _control4 );
 		m_voice->controlChange( 11, _control11 );
 		m_voice->controlChange( 128, _control128 );
-	
+
 		m_voice->noteOn( _pitch, _velocity );
 	}
-	catch( ... )
-	{
-		m_voice = nullptr;
-	}
-	
-	m_delay = new StkFloat[256];
-	m_delayRead = 0;
-	m_delayWrite = _delay;
-	for( int i = 0; i < 256; i++ )
-	{
-		m_delay[i] = 0.0;
-	}
+
+	init( _delay );
 }
 
 
 
 
 // BandedWG
-malletsSynth::malletsSynth( const StkFloat _pitch,
+malletsSynth::malletsSynth( Instrmnt * _voice,
+				const StkFloat _pitch,
 				const StkFloat _velocity,
 				const StkFloat _control2,
 				const StkFloat _control4,
@@ -716,19 +819,12 @@ malletsSynth::malletsSynth( const StkFloat _pitch,
 				const StkFloat _control128,
 				const uint8_t _delay,
 				const sample_rate_t _sample_rate ) :
-	m_presetIndex(0)
+	m_presetIndex(0),
+	m_voice( _voice ),
+	m_sampleRate( _sample_rate )
 {
-	try
+	if( m_voice )
 	{
-		Stk::setSampleRate( _sample_rate );
-		Stk::setRawwavePath( QDir( ConfigManager::inst()->stkDir() ).absolutePath()
-						.toLocal8Bit().constData() );
-#ifndef LMMS_DEBUG
-		Stk::showWarnings( false );
-#endif
-
-		m_voice = new BandedWG();
-	
 		m_voice->controlChange( 1, 128.0 );
 		m_voice->controlChange( 2, _control2 );
 		m_voice->controlChange( 4, _control4 );
@@ -736,15 +832,18 @@ malletsSynth::malletsSynth( const StkFloat _pitch,
 		m_voice->controlChange( 16, _control16 );
 		m_voice->controlChange( 64, _control64 );
 		m_voice->controlChange( 128, _control128 );
-	
+
 		m_voice->noteOn( _pitch, _velocity );
 	}
-	catch( ... )
-	{
-		m_voice = nullptr;
-	}
-	
-	m_delay = new StkFloat[256];
+
+	init( _delay );
+}
+
+
+
+
+void malletsSynth::init( const uint8_t _delay )
+{
 	m_delayRead = 0;
 	m_delayWrite = _delay;
 	for( int i = 0; i < 256; i++ )
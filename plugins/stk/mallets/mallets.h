@@ -27,6 +27,8 @@
 #ifndef _MALLET_H
 #define _MALLET_H
 
+#include <vector>
+
 #include "Instrmnt.h"
 
 #include "ComboBox.h"
@@ -48,7 +50,8 @@ class malletsSynth
 {
 public:
 	// ModalBar
-	malletsSynth( const StkFloat _pitch,
+	malletsSynth( Instrmnt * _voice,
+			const StkFloat _pitch,
 			const StkFloat _velocity,
 			const StkFloat _control1,
 			const StkFloat _control2,
@@ -60,7 +63,8 @@ public:
 			const sample_rate_t _sample_rate );
 
 	// TubeBell
-	malletsSynth( const StkFloat _pitch,
+	malletsSynth( Instrmnt * _voice,
+			const StkFloat _pitch,
 			const StkFloat _velocity,
 			const int _preset,
 			const StkFloat _control1,
@@ -72,7 +76,8 @@ public:
 			const sample_rate_t _sample_rate );
 
 	// BandedWG
-	malletsSynth( const StkFloat _pitch,
+	malletsSynth( Instrmnt * _voice,
+			const StkFloat _pitch,
 			const StkFloat _velocity,
 			const StkFloat _control2,
 			const StkFloat _control4,
@@ -83,11 +88,10 @@ public:
 			const uint8_t _delay,
 			const sample_rate_t _sample_rate );
 
+	//! The voice stays with the instrument, see malletsInstrument::releaseVoice()
 	inline ~malletsSynth()
 	{
 		if (m_voice) {m_voice->noteOff(0.0);}
-		delete[] m_delay;
-		delete m_voice;
 	}
 
 	inline sample_t nextSampleLeft()
@@ -130,12 +134,25 @@ public:
 		m_presetIndex = presetIndex;
 	}
 
+	inline Instrmnt * voice()
+	{
+		return m_voice;
+	}
+
+	inline sample_rate_t sampleRate() const
+	{
+		return m_sampleRate;
+	}
+
 
 protected:
+	void init( const uint8_t _delay );
+
 	int m_presetIndex;
 	Instrmnt * m_voice;
+	sample_rate_t m_sampleRate;
 
-	StkFloat * m_delay;
+	StkFloat m_delay[256];
 	uint8_t m_delayRead;
 	uint8_t m_delayWrite;
 };
@@ -192,6 +209,28 @@ private:
 
 	bool m_filesMissing;
 
+	// the STK instruments the presets use
+	enum VoiceTypes
+	{
+		ModalBarVoice,
+		TubeBellVoice,
+		BandedWGVoice,
+		VoiceTypeCount
+	} ;
+
+	static int voiceType( int preset );
+
+	// STK instruments read their rawwaves from disk when they're created,
+	// so they are created before the notes need them and the voices of
+	// ended notes are kept for the next ones. Both have to be called with
+	// the STK mutex held.
+	Instrmnt * acquireVoice( int type, sample_rate_t sampleRate );
+	void releaseVoice( int type, Instrmnt * voice, sample_rate_t sampleRate );
+	static Instrmnt * createVoice( int type, sample_rate_t sampleRate );
+
+	std::vector<Instrmnt *> m_voices[VoiceTypeCount];
+	sample_rate_t m_voicesSampleRate;
+
 
 	friend class malletsInstrumentView;
 
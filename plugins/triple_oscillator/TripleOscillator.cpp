@@ -220,7 +220,10 @@ void OscillatorObject::updateUseWaveTable()
  
 
 TripleOscillator::TripleOscillator( InstrumentTrack * _instrument_track ) :
-	Instrument( _instrument_track, &tripleoscillator_plugin_descriptor )
+	Instrument( _instrument_track, &tripleoscillator_plugin_descriptor ),
+	m_voices( voicePoolSize() ),
+	m_oscillators( voicePoolSize() * NUM_OF_OSCILLATORS * 2,
+			VoicePool<Oscillator>::DefaultCapacity * NUM_OF_OSCILLATORS * 2 )
 {
 	for( int i = 0; i < NUM_OF_OSCILLATORS; ++i )
 	{
@@ -323,7 +326,7 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 			// the last oscs needs no sub-oscs...
 			if( i == NUM_OF_OSCILLATORS - 1 )
 			{
-				oscs_l[i] = new Oscillator(
+				oscs_l[i] = m_oscillators.acquire(
 						&m_osc[i]->m_waveShapeModel,
 						&m_osc[i]->m_modulationAlgoModel,
 						_n->frequency(),
@@ -331,7 +334,7 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 						m_osc[i]->m_phaseOffsetLeft,
 						m_osc[i]->m_volumeLeft );
 				oscs_l[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
-				oscs_r[i] = new Oscillator(
+				oscs_r[i] = m_oscillators.acquire(
 						&m_osc[i]->m_waveShapeModel,
 						&m_osc[i]->m_modulationAlgoModel,
 						_n->frequency(),
@@ -342,7 +345,7 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 			}
 			else
 			{
-				oscs_l[i] = new Oscillator(
+				oscs_l[i] = m_oscillators.acquire(
 						&m_osc[i]->m_waveShapeModel,
 						&m_osc[i]->m_modulationAlgoModel,
 						_n->frequency(),
@@ -351,7 +354,7 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 						m_osc[i]->m_volumeLeft,
 						oscs_l[i + 1] );
 				oscs_l[i]->setUseWaveTable(m_osc[i]->m_useWaveTable);
-				oscs_r[i] = new Oscillator(
+				oscs_r[i] = m_oscillators.acquire(
 						&m_osc[i]->m_waveShapeModel,
 						&m_osc[i]->m_modulationAlgoModel,
 						_n->frequency(),
@@ -364,13 +367,15 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 
 			oscs_l[i]->setUserWave( m_osc[i]->m_sampleBuffer );
 			oscs_r[i]->setUserWave( m_osc[i]->m_sampleBuffer );
+			oscs_l[i]->setRandomSeed( FastRandom::combine( _n->randomSeed(), 2 * i ) );
+			oscs_r[i]->setRandomSeed( FastRandom::combine( _n->randomSeed(), 2 * i + 1 ) );
 
 		}
 
-		_n->m_pluginData = new oscPtr;
-		static_cast<oscPtr *>( _n->m_pluginData )->oscLeft = oscs_l[0];
-		static_cast< oscPtr *>( _n->m_pluginData )->oscRight =
-								oscs_r[0];
+		oscPtr * voice = m_voices.acquire();
+		voice->oscLeft = oscs_l[0];
+		voice->oscRight = oscs_r[0];
+		_n->m_pluginData = voice;
 	}
 
 	Oscillator * osc_l = static_cast<oscPtr *>( _n->m_pluginData )->oscLeft;
@@ -393,11 +398,23 @@ void TripleOscillator::playNote( NotePlayHandle * _n,
 
 void TripleOscillator::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<Oscillator *>( static_cast<oscPtr *>(
-						_n->m_pluginData )->oscLeft );
-	delete static_cast<Oscillator *>( static_cast<oscPtr *>(
-						_n->m_pluginData )->oscRight );
-	delete static_cast<oscPtr *>( _n->m_pluginData );
+	oscPtr * voice = static_cast<oscPtr *>( _n->m_pluginData );
+	releaseOscillators( voice->oscLeft );
+	releaseOscillators( voice->oscRight );
+	m_voices.release( voice );
+}
+
+
+
+
+void TripleOscillator::releaseOscillators( Oscillator * osc )
+{
+	while( osc != nullptr )
+	{
+		Oscillator * subOsc = osc->takeSubOsc();
+		m_oscillators.release( osc );
+		osc = subOsc;
+	}
 }
 
 
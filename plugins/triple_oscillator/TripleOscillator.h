@@ -30,6 +30,7 @@
 #include "InstrumentView.h"
 #include "Oscillator.h"
 #include "AutomatableModel.h"
+#include "VoicePool.h"
 
 
 class automatableButtonGroup;
@@ -110,6 +111,11 @@ public:
 
 	virtual QString nodeName() const;
 
+	virtual Flags flags() const
+	{
+		return PlaysNotesBatched;
+	}
+
 	virtual f_cnt_t desiredReleaseFrames() const
 	{
 		return( 128 );
@@ -127,11 +133,15 @@ private:
 
 	struct oscPtr
 	{
-		MM_OPERATORS
 		Oscillator * oscLeft;
 		Oscillator * oscRight;
 	} ;
 
+	void releaseOscillators( Oscillator * osc );
+
+	VoicePool<oscPtr> m_voices;
+	VoicePool<Oscillator> m_oscillators;
+
 
 	friend class TripleOscillatorView;
 
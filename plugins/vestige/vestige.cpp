@@ -327,6 +327,14 @@ QString vestigeInstrument::nodeName( void ) const
 
 
 
+const RemotePlugin * vestigeInstrument::remotePlugin() const
+{
+	return m_plugin;
+}
+
+
+
+
 void vestigeInstrument::loadFile( const QString & _file )
 {
 	m_pluginMutex.lock();
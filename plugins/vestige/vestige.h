@@ -59,6 +59,8 @@ public:
 
 	virtual QString nodeName( void ) const;
 
+	const RemotePlugin * remotePlugin() const override;
+
 	virtual void loadFile( const QString & _file );
 
 	virtual Flags flags() const
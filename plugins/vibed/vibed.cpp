@@ -34,7 +34,6 @@
 #include "base64.h"
 #include "CaptionMenu.h"
 #include "Oscillator.h"
-#include "string_container.h"
 #include "volume.h"
 #include "Song.h"
 
@@ -62,7 +61,8 @@ Plugin::Descriptor PLUGIN_EXPORT vibedstrings_plugin_descriptor =
 
 
 vibed::vibed( InstrumentTrack * _instrumentTrack ) :
-	Instrument( _instrumentTrack, &vibedstrings_plugin_descriptor )
+	Instrument( _instrumentTrack, &vibedstrings_plugin_descriptor ),
+	m_voices( voicePoolSize() )
 {
 
 	FloatModel * knob;
@@ -275,7 +275,7 @@ void vibed::playNote( NotePlayHandle * _n, sampleFrame * _working_buffer )
 {
 	if ( _n->totalFramesPlayed() == 0 || _n->m_pluginData == nullptr )
 	{
-		_n->m_pluginData = new stringContainer( _n->frequency(),
+		_n->m_pluginData = m_voices.acquire( _n->frequency(),
 				Engine::audioEngine()->processingSampleRate(),
 						__sampleLength );
 		
@@ -309,18 +309,27 @@ void vibed::playNote( NotePlayHandle * _n, sampleFrame * _working_buffer )
 	{
 		_working_buffer[i][0] = 0.0f;
 		_working_buffer[i][1] = 0.0f;
-		int s = 0;
-		for( int string = 0; string < 9; ++string )
+	}
+
+	// one string after the other, so that each string's delay lines stay
+	// in the cache for the whole period
+	int s = 0;
+	for( int string = 0; string < 9; ++string )
+	{
+		if( ps->exists( string ) )
 		{
-			if( ps->exists( string ) )
+			// pan: 0 -> left, 1 -> right
+			const float pan = ( m_panKnobs[string]->value() + 1 ) / 2.0f;
+			const float vol = m_volumeKnobs[string]->value() / 100.0f;
+			const float left = ( 1.0f - pan ) * vol;
+			const float right = pan * vol;
+			for( fpp_t i = offset; i < frames + offset; ++i )
 			{
-				// pan: 0 -> left, 1 -> right
-				const float pan = ( m_panKnobs[string]->value() + 1 ) / 2.0f;
-				const sample_t sample = ps->getStringSample( s ) * m_volumeKnobs[string]->value() / 100.0f;
-				_working_buffer[i][0] += ( 1.0f - pan ) * sample;
-				_working_buffer[i][1] += pan * sample;
-				s++;
+				const sample_t sample = ps->getStringSample( s );
+				_working_buffer[i][0] += left * sample;
+				_working_buffer[i][1] += right * sample;
 			}
+			s++;
 		}
 	}
 
@@ -332,7 +341,7 @@ void vibed::playNote( NotePlayHandle * _n, sampleFrame * _working_buffer )
 
 void vibed::deleteNotePluginData( NotePlayHandle * _n )
 {
-	delete static_cast<stringContainer *>( _n->m_pluginData );
+	m_voices.release( static_cast<stringContainer *>( _n->m_pluginData ) );
 }
 
 
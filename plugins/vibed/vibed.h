@@ -31,6 +31,8 @@
 #include "PixmapButton.h"
 #include "LedCheckbox.h"
 #include "nine_button_selector.h"
+#include "string_container.h"
+#include "VoicePool.h"
 
 class vibedView;
 class NotePlayHandle;
@@ -75,7 +77,9 @@ private:
 	QList<BoolModel*> m_impulses;
 	QList<nineButtonSelectorModel*> m_harmonics;
 
-	static const int __sampleLength = 128;
+	static constexpr int __sampleLength = 128;
+
+	VoicePool<stringContainer> m_voices;
 
 	friend class vibedView;
 } ;
@@ -46,7 +46,6 @@ vibratingString::vibratingString(	float _pitch,
 	m_stringLoss( 1.0f - _string_loss ),
 	m_state( 0.1f )
 {
-	m_outsamp = new sample_t[m_oversample];
 	int string_length;
 	
 	string_length = static_cast<int>( m_oversample * _sample_rate /
@@ -54,29 +53,35 @@ vibratingString::vibratingString(	float _pitch,
 	string_length += static_cast<int>( string_length * -_detune );
 
 	int pick = static_cast<int>( ceil( string_length * _pick ) );
+
+	const int impulse_length = _state ? _len : string_length;
+	m_buffer = MM_ALLOC<sample_t>( 2 * qMax( string_length, 0 ) +
+					impulse_length + m_oversample );
+	m_outsamp = m_buffer;
+	m_impulse = m_outsamp + m_oversample;
 	
 	if( ! _state )
 	{
-		m_impulse = new float[string_length];
 		resample( _impulse, _len, string_length );
 	}
 	else
  	{
-		m_impulse = new float[_len];
 		for( int i = 0; i < _len; i++ )
 		{
 			m_impulse[i] = _impulse[i];
 		}
 	}
 	
-	m_toBridge = vibratingString::initDelayLine( string_length, pick );
-	m_fromBridge = vibratingString::initDelayLine( string_length, pick );
+	sample_t * data = m_impulse + impulse_length;
+	vibratingString::initDelayLine( &m_toBridge, data, string_length );
+	vibratingString::initDelayLine( &m_fromBridge,
+				data + qMax( string_length, 0 ), string_length );
 
 	
-	vibratingString::setDelayLine( m_toBridge, pick, 
+	vibratingString::setDelayLine( &m_toBridge, pick, 
 						m_impulse, _len, 0.5f, 
 						_state );
-	vibratingString::setDelayLine( m_fromBridge, pick, 
+	vibratingString::setDelayLine( &m_fromBridge, pick, 
 						m_impulse, _len, 0.5f,
 						_state);
 	
@@ -89,14 +94,13 @@ vibratingString::vibratingString(	float _pitch,
 
 
 
-vibratingString::delayLine * vibratingString::initDelayLine( int _len,
-								int _pick )
+void vibratingString::initDelayLine( delayLine * dl, sample_t * _data,
+								int _len )
 {
-	delayLine * dl = new vibratingString::delayLine[_len];
 	dl->length = _len;
 	if( _len > 0 )
 	{
-		dl->data = new sample_t[_len];
+		dl->data = _data;
 		float r;
 		float offset = 0.0f;
 		for( int i = 0; i < dl->length; i++ )
@@ -115,20 +119,6 @@ vibratingString::delayLine * vibratingString::initDelayLine( int _len,
 
 	dl->pointer = dl->data;
 	dl->end = dl->data + _len - 1;
-
-	return( dl );
-}
-
-
-
-
-void vibratingString::freeDelayLine( delayLine * _dl )
-{
-	if( _dl )
-	{
-		delete[] _dl->data;
-		delete[] _dl;
-	}
 }
 
 
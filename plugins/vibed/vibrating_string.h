@@ -28,10 +28,11 @@
 #include <stdlib.h>
 
 #include "lmms_basics.h"
+#include "MemoryManager.h"
 
 class vibratingString
 {
-
+	MM_OPERATORS
 public:
 	vibratingString(	float _pitch, 
 				float _pick, 
@@ -47,10 +48,7 @@ public:
 	
 	inline ~vibratingString()
 	{
-		delete[] m_outsamp;
-		delete[] m_impulse;
-		vibratingString::freeDelayLine( m_fromBridge );
-		vibratingString::freeDelayLine( m_toBridge );
+		MM_FREE( m_buffer );
 	}
 
 	inline sample_t nextSample()
@@ -60,24 +58,24 @@ public:
 		for( int i = 0; i < m_oversample; i++)
 		{
 			// Output at pickup position
-			m_outsamp[i] = fromBridgeAccess( m_fromBridge, 
+			m_outsamp[i] = fromBridgeAccess( &m_fromBridge, 
 								m_pickupLoc );
-			m_outsamp[i] += toBridgeAccess( m_toBridge, 
+			m_outsamp[i] += toBridgeAccess( &m_toBridge, 
 								m_pickupLoc );
 		
 			// Sample traveling into "bridge"
-			ym0 = toBridgeAccess( m_toBridge, 1 );
+			ym0 = toBridgeAccess( &m_toBridge, 1 );
 			// Sample to "nut"
-			ypM = fromBridgeAccess( m_fromBridge,
-						m_fromBridge->length - 2 );
+			ypM = fromBridgeAccess( &m_fromBridge,
+						m_fromBridge.length - 2 );
 
 			// String state update
 
 			// Decrement pointer and then update
-			fromBridgeUpdate( m_fromBridge, 
+			fromBridgeUpdate( &m_fromBridge, 
 						-bridgeReflection( ym0 ) );
 			// Update and then increment pointer
-			toBridgeUpdate( m_toBridge, -ypM );
+			toBridgeUpdate( &m_toBridge, -ypM );
 		}
 		return( m_outsamp[m_choice] );
 	}
@@ -91,8 +89,8 @@ private:
 		sample_t * end;
 	} ;
 
-	delayLine * m_fromBridge;
-	delayLine * m_toBridge;
+	delayLine m_fromBridge;
+	delayLine m_toBridge;
 	int m_pickupLoc;
 	int m_oversample;
 	float m_randomize;
@@ -103,9 +101,11 @@ private:
 	float m_state;
 	
 	sample_t * m_outsamp;
+	// one block for the delay lines, the impulse and m_outsamp, so that a
+	// note allocates once for each of its strings
+	sample_t * m_buffer;
 
-	delayLine * initDelayLine( int _len, int _pick );
-	static void freeDelayLine( delayLine * _dl );
+	void initDelayLine( delayLine * _dl, sample_t * _data, int _len );
 	void resample( float *_src, f_cnt_t _src_frames, f_cnt_t _dst_frames );
 	
 	/* setDelayLine initializes the string with an impulse at the pick
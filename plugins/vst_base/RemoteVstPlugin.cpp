@@ -232,14 +232,16 @@ public:
 	// send name of current program back to host
 	void sendCurrentProgramName();
 
-	// do a complete parameter-dump and post it
-	void getParameterDump();
+	// post the values changed since the last dump, or all of them and
+	// their names if @p full
+	void getParameterDump( bool full );
 
 	// read parameter-dump and set it for plugin
 	void setParameterDump( const message & _m );
 
-	// save settings chunk of plugin into file
-	void saveChunkToFile( const std::string & _file );
+	// save settings chunk of plugin into file, returns false if the host
+	// has it already, as it didn't change since it was saved last
+	bool saveChunkToFile( const std::string & _file, bool hostHasLast );
 
 	// restore settings chunk of plugin from file
 	void loadChunkFromFile( const std::string & _file, int _len );
@@ -431,6 +433,21 @@ private:
 
 	int m_shmID;
 	VstSyncData* m_vstSyncData;
+	// the copy of the host's transport audioMasterGetTime works on
+	VstSyncState m_syncState;
+	uint32_t m_syncVersion;
+
+	//! Takes a new copy of the transport when the host published one
+	const VstSyncState & syncState()
+	{
+		m_vstSyncData->read( m_syncState, m_syncVersion );
+		return m_syncState;
+	}
+
+	// the values the host got with the last dump
+	std::vector<float> m_dumpedParameters;
+	// of the chunk saved last
+	uint64_t m_savedChunkHash;
 
 } ;
 
@@ -464,7 +481,10 @@ RemoteVstPlugin::RemoteVstPlugin( const char * socketPath ) :
 	m_currentProgram( -1 ),
 	m_in( nullptr ),
 	m_shmID( -1 ),
-	m_vstSyncData( nullptr )
+	m_vstSyncData( nullptr ),
+	m_syncState(),
+	m_syncVersion( VST_SNC_NO_VERSION ),
+	m_savedChunkHash( 0 )
 {
 	__plugin = this;
 
@@ -497,15 +517,19 @@ RemoteVstPlugin::RemoteVstPlugin( const char * socketPath ) :
 		fprintf(stderr, "RemoteVstPlugin.cpp: "
 			"Failed to initialize shared memory for VST synchronization.\n"
 			" (VST-host synchronization will be disabled)\n");
-		m_vstSyncData = (VstSyncData*) malloc( sizeof( VstSyncData ) );
-		m_vstSyncData->isPlaying = true;
-		m_vstSyncData->timeSigNumer = 4;
-		m_vstSyncData->timeSigDenom = 4;
-		m_vstSyncData->ppqPos = 0;
-		m_vstSyncData->isCycle = false;
+		m_vstSyncData = new VstSyncData();
+		m_vstSyncData->version = 0;
 		m_vstSyncData->hasSHM = false;
-		m_vstSyncData->m_playbackJumped = false;
-		m_vstSyncData->m_sampleRate = sampleRate();
+
+		VstSyncState state;
+		state.isPlaying = true;
+		state.timeSigNumer = 4;
+		state.timeSigDenom = 4;
+		state.ppqPos = 0;
+		state.isCycle = false;
+		state.m_playbackJumped = false;
+		state.m_sampleRate = sampleRate();
+		m_vstSyncData->publish( state );
 	}
 
 	m_in = ( in* ) new char[ sizeof( in ) ];
@@ -616,7 +640,7 @@ bool RemoteVstPlugin::processMessage( const message & _m )
 			break;
 
 		case IdVstGetParameterDump:
-			getParameterDump();
+			getParameterDump( _m.getInt() );
 			break;
 
 		case IdVstSetParameterDump:
@@ -624,9 +648,11 @@ bool RemoteVstPlugin::processMessage( const message & _m )
 			break;
 
 		case IdSaveSettingsToFile:
-			saveChunkToFile( _m.getString() );
-			sendMessage( IdSaveSettingsToFile );
+		{
+			const bool saved = saveChunkToFile( _m.getString( 0 ), _m.getInt( 1 ) );
+			sendMessage( message( IdSaveSettingsToFile ).addInt( saved ) );
 			break;
+		}
 
 		case IdLoadSettingsFromFile:
 			loadChunkFromFile( _m.getString( 0 ), _m.getInt( 1 ) );
@@ -950,14 +976,23 @@ void RemoteVstPlugin::process( const sampleFrame * _in, sampleFrame * _out )
 
 	// now we're ready to fetch sound from VST-plugin
 
+	// the host doesn't clear the outputs, and the memory stays the same
+	// until we get to the next message
+	const auto silence = [&]()
+	{
+		memset( _out, 0, RemotePluginClient::outputCount() * bufferSize() * sizeof( float ) );
+	};
+
 	if( !tryLockShm() )
 	{
+		silence();
 		return;
 	}
 
 	if( !isShmValid() )
 	{
 		unlockShm();
+		silence();
 		return;
 	}
 
@@ -1135,24 +1170,39 @@ void RemoteVstPlugin::sendCurrentProgramName()
 
 
 
-void RemoteVstPlugin::getParameterDump()
+void RemoteVstPlugin::getParameterDump( bool full )
 {
-	message m( IdVstParameterDump );
-	m.addInt( m_plugin->numParams );
-
-	for( int i = 0; i < m_plugin->numParams; ++i )
+	const int params = m_plugin->numParams;
+	if( full || m_dumpedParameters.size() != static_cast<size_t>( params ) )
 	{
-		char paramName[256];
-		memset( paramName, 0, sizeof( paramName ) );
-		pluginDispatch( effGetParamName, i, 0, paramName );
-		paramName[sizeof(paramName)-1] = 0;
+		full = true;
+		m_dumpedParameters.assign( params, 0 );
+	}
 
-		m.addInt( i );
-		m.addString( paramName );
-		m.addFloat( m_plugin->getParameter( m_plugin, i ) );
+	std::string values;
+	std::string names;
+	for( int i = 0; i < params; ++i )
+	{
+		const float value = m_plugin->getParameter( m_plugin, i );
+		if( full || value != m_dumpedParameters[i] )
+		{
+			const VstParameterValue item = { i, value };
+			values.append( reinterpret_cast<const char *>( &item ), sizeof( item ) );
+			m_dumpedParameters[i] = value;
+		}
+		if( full )
+		{
+			char paramName[256];
+			memset( paramName, 0, sizeof( paramName ) );
+			pluginDispatch( effGetParamName, i, 0, paramName );
+			paramName[sizeof(paramName)-1] = 0;
+			names.append( paramName );
+			names.push_back( '\0' );
+		}
 	}
 
-	sendMessage( m );
+	sendMessage( message( IdVstParameterDump ).addInt( full ).addInt( params ).
+						addString( values ).addString( names ) );
 }
 
 
@@ -1160,24 +1210,23 @@ void RemoteVstPlugin::getParameterDump()
 
 void RemoteVstPlugin::setParameterDump( const message & _m )
 {
-	const int n = _m.getInt( 0 );
-	const int params = ( n > m_plugin->numParams ) ?
-					m_plugin->numParams : n;
-	int p = 0;
-	for( int i = 0; i < params; ++i )
+	const std::string values = _m.getString( 0 );
+	for( size_t pos = 0; pos + sizeof( VstParameterValue ) <= values.size();
+						pos += sizeof( VstParameterValue ) )
 	{
-		VstParameterDumpItem item;
-		item.index = _m.getInt( ++p );
-		item.shortLabel = _m.getString( ++p );
-		item.value = _m.getFloat( ++p );
-		m_plugin->setParameter( m_plugin, item.index, item.value );
+		VstParameterValue item;
+		memcpy( &item, values.data() + pos, sizeof( item ) );
+		if( item.index >= 0 && item.index < m_plugin->numParams )
+		{
+			m_plugin->setParameter( m_plugin, item.index, item.value );
+		}
 	}
 }
 
 
 
 
-void RemoteVstPlugin::saveChunkToFile( const std::string & _file )
+bool RemoteVstPlugin::saveChunkToFile( const std::string & _file, bool hostHasLast )
 {
 	if( m_plugin->flags & 32 )
 	{
@@ -1185,12 +1234,24 @@ void RemoteVstPlugin::saveChunkToFile( const std::string & _file )
 		const int len = pluginDispatch( 23, 0, 0, &chunk );
 		if( len > 0 )
 		{
+			// FNV-1a, to tell whether it's the one saved last
+			uint64_t hash = 14695981039346656037ULL;
+			for( int i = 0; i < len; ++i )
+			{
+				hash = ( hash ^ static_cast<const unsigned char *>( chunk )[i] ) *
+										1099511628211ULL;
+			}
+			if( hostHasLast && hash == m_savedChunkHash )
+			{
+				return false;
+			}
+
 			FILE* fp = F_OPEN_UTF8( _file, "wb" );
 			if (!fp)
 			{
 				fprintf( stderr,
 					"Error opening file for saving chunk.\n" );
-				return;
+				return true;
 			}
 			if ( fwrite( chunk, 1, len, fp ) != len )
 			{
@@ -1198,8 +1259,10 @@ void RemoteVstPlugin::saveChunkToFile( const std::string & _file )
 					"Error saving chunk to file.\n" );
 			}
 			close_check( fp );
+			m_savedChunkHash = hash;
 		}
 	}
+	return true;
 }
 
 
@@ -1656,6 +1719,7 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 			return 0;
 
 		case audioMasterGetTime:
+		{
 			SHOW_CALLBACK( "amc: audioMasterGetTime\n" );
 			// returns const VstTimeInfo* (or 0 if not supported)
 			// <value> should contain a mask indicating which
@@ -1665,43 +1729,46 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 			// Shared memory was initialised? - see song.cpp
 			//assert( __plugin->m_vstSyncData != NULL );
 
+			const bool hasSHM = __plugin->m_vstSyncData->hasSHM;
+			const VstSyncState & sync = __plugin->syncState();
+
 			memset( &_timeInfo, 0, sizeof( _timeInfo ) );
 			_timeInfo.samplePos = __plugin->m_currentSamplePos;
-			_timeInfo.sampleRate = __plugin->m_vstSyncData->hasSHM ?
-							__plugin->m_vstSyncData->m_sampleRate :
+			_timeInfo.sampleRate = hasSHM ?
+							sync.m_sampleRate :
 							__plugin->sampleRate();
 			_timeInfo.flags = 0;
-			_timeInfo.tempo = __plugin->m_vstSyncData->hasSHM ?
-							__plugin->m_vstSyncData->m_bpm :
+			_timeInfo.tempo = hasSHM ?
+							sync.m_bpm :
 							__plugin->m_bpm;
-			_timeInfo.timeSigNumerator = __plugin->m_vstSyncData->timeSigNumer;
-			_timeInfo.timeSigDenominator = __plugin->m_vstSyncData->timeSigDenom;
+			_timeInfo.timeSigNumerator = sync.timeSigNumer;
+			_timeInfo.timeSigDenominator = sync.timeSigDenom;
 			_timeInfo.flags |= kVstTempoValid;
 			_timeInfo.flags |= kVstTimeSigValid;
 
-			if( __plugin->m_vstSyncData->isCycle )
+			if( sync.isCycle )
 			{
-				_timeInfo.cycleStartPos = __plugin->m_vstSyncData->cycleStart;
-				_timeInfo.cycleEndPos = __plugin->m_vstSyncData->cycleEnd;
+				_timeInfo.cycleStartPos = sync.cycleStart;
+				_timeInfo.cycleEndPos = sync.cycleEnd;
 				_timeInfo.flags |= kVstCyclePosValid;
 				_timeInfo.flags |= kVstTransportCycleActive;
 			}
 
-			if( __plugin->m_vstSyncData->ppqPos != 
+			if( sync.ppqPos != 
 							__plugin->m_in->m_Timestamp )
 			{
-				_timeInfo.ppqPos = __plugin->m_vstSyncData->ppqPos;
-				__plugin->m_in->lastppqPos = __plugin->m_vstSyncData->ppqPos;
-				__plugin->m_in->m_Timestamp = __plugin->m_vstSyncData->ppqPos;
+				_timeInfo.ppqPos = sync.ppqPos;
+				__plugin->m_in->lastppqPos = sync.ppqPos;
+				__plugin->m_in->m_Timestamp = sync.ppqPos;
 			}
-			else if( __plugin->m_vstSyncData->isPlaying )
+			else if( sync.isPlaying )
 			{
-				if( __plugin->m_vstSyncData->hasSHM )
+				if( hasSHM )
 				{
 					__plugin->m_in->lastppqPos +=
-						__plugin->m_vstSyncData->m_bpm / 60.0
-						* __plugin->m_vstSyncData->m_bufferSize
-						/ __plugin->m_vstSyncData->m_sampleRate;
+						sync.m_bpm / 60.0
+						* sync.m_bufferSize
+						/ sync.m_sampleRate;
 				}
 				else
 				{
@@ -1712,30 +1779,31 @@ intptr_t RemoteVstPlugin::hostCallback( AEffect * _effect, int32_t _opcode,
 				}
 				_timeInfo.ppqPos = __plugin->m_in->lastppqPos;
 			}
-//			_timeInfo.ppqPos = __plugin->m_vstSyncData->ppqPos;
+//			_timeInfo.ppqPos = sync.ppqPos;
 			_timeInfo.flags |= kVstPpqPosValid;
 
-			if( __plugin->m_vstSyncData->isPlaying )
+			if( sync.isPlaying )
 			{
 				_timeInfo.flags |= kVstTransportPlaying;
 			}
 			_timeInfo.barStartPos = ( (int) ( _timeInfo.ppqPos / 
-				( 4 *__plugin->m_vstSyncData->timeSigNumer
-				/ (float) __plugin->m_vstSyncData->timeSigDenom ) ) ) *
-				( 4 * __plugin->m_vstSyncData->timeSigNumer
-				/ (float) __plugin->m_vstSyncData->timeSigDenom );
+				( 4 * sync.timeSigNumer
+				/ (float) sync.timeSigDenom ) ) ) *
+				( 4 * sync.timeSigNumer
+				/ (float) sync.timeSigDenom );
 
 			_timeInfo.flags |= kVstBarsValid;
 
 			if( ( _timeInfo.flags & ( kVstTransportPlaying | kVstTransportCycleActive ) ) !=
 				( __plugin->m_in->m_lastFlags & ( kVstTransportPlaying | kVstTransportCycleActive ) )
-				|| __plugin->m_vstSyncData->m_playbackJumped )
+				|| sync.m_playbackJumped )
 			{
 				_timeInfo.flags |= kVstTransportChanged;
 			}
 			__plugin->m_in->m_lastFlags = _timeInfo.flags;
 
 			return (intptr_t) &_timeInfo;
+		}
 
 		case audioMasterProcessEvents:
 			SHOW_CALLBACK( "amc: audioMasterProcessEvents\n" );
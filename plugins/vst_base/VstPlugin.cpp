@@ -176,6 +176,11 @@ VstPlugin::~VstPlugin()
 
 void VstPlugin::tryLoad( const QString &remoteVstPluginExecutable )
 {
+	// a new process, which sent nothing yet
+	m_parameterDump.clear();
+	m_parameterNames.clear();
+	m_chunk.clear();
+
 	init( remoteVstPluginExecutable, false, {m_embedMethod} );
 
 	waitForHostInfoGotten();
@@ -331,7 +336,8 @@ int VstPlugin::currentProgram()
 const QMap<QString, QString> & VstPlugin::parameterDump()
 {
 	lock();
-	sendMessage( IdVstGetParameterDump );
+	// all of them, or just what changed since
+	sendMessage( message( IdVstGetParameterDump ).addInt( m_parameterDump.isEmpty() ) );
 	waitForMessage( IdVstParameterDump, true );
 	unlock();
 
@@ -343,23 +349,20 @@ const QMap<QString, QString> & VstPlugin::parameterDump()
 
 void VstPlugin::setParameterDump( const QMap<QString, QString> & _pdump )
 {
-	message m( IdVstSetParameterDump );
-	m.addInt( _pdump.size() );
+	std::string values;
+	values.reserve( _pdump.size() * sizeof( VstParameterValue ) );
 	for( QMap<QString, QString>::ConstIterator it = _pdump.begin();
 						it != _pdump.end(); ++it )
 	{
-		const VstParameterDumpItem item =
+		const VstParameterValue value =
 		{
 			( *it ).section( ':', 0, 0 ).toInt(),
-			"",
 			LocaleHelper::toFloat((*it).section(':', 2, -1))
 		} ;
-		m.addInt( item.index );
-		m.addString( item.shortLabel );
-		m.addFloat( item.value );
+		values.append( reinterpret_cast<const char *>( &value ), sizeof( value ) );
 	}
 	lock();
-	sendMessage( m );
+	sendMessage( message( IdVstSetParameterDump ).addString( values ) );
 	unlock();
 }
 
@@ -445,18 +448,38 @@ bool VstPlugin::processMessage( const message & _m )
 
 		case IdVstParameterDump:
 		{
-			m_parameterDump.clear();
-			const int num_params = _m.getInt();
-			int p = 0;
-			for( int i = 0; i < num_params; ++i )
+			// the names come with all values, the values of single
+			// parameters when they changed
+			if( _m.getInt( 0 ) )
+			{
+				m_parameterDump.clear();
+				m_parameterNames.assign( _m.getInt( 1 ), QString() );
+				const std::string names = _m.getString( 3 );
+				size_t pos = 0;
+				for( QString & name : m_parameterNames )
+				{
+					const size_t end = names.find( '\0', pos );
+					if( end == std::string::npos )
+					{
+						break;
+					}
+					name = QString::fromStdString( names.substr( pos, end - pos ) );
+					pos = end + 1;
+				}
+			}
+			const std::string values = _m.getString( 2 );
+			for( size_t pos = 0; pos + sizeof( VstParameterValue ) <= values.size();
+							pos += sizeof( VstParameterValue ) )
 			{
-				VstParameterDumpItem item;
-				item.index = _m.getInt( ++p );
-				item.shortLabel = _m.getString( ++p );
-				item.value = _m.getFloat( ++p );
+				VstParameterValue item;
+				memcpy( &item, values.data() + pos, sizeof( item ) );
+				if( item.index < 0 || static_cast<size_t>( item.index ) >= m_parameterNames.size() )
+				{
+					continue;
+				}
 	m_parameterDump["param" + QString::number( item.index )] =
 				QString::number( item.index ) + ":" +
-/*uncomented*/				/*QString( item.shortLabel )*/ QString::fromStdString(item.shortLabel) + ":" +
+					m_parameterNames[item.index] + ":" +
 					QString::number( item.value );
 			}
 			break;
@@ -653,6 +676,8 @@ void VstPlugin::loadChunk( const QByteArray & _chunk )
 		tf.write( _chunk );
 		tf.flush();
 
+		m_chunk.clear();
+
 		lock();
 		sendMessage( message( IdLoadSettingsFromFile ).
 				addString(
@@ -673,14 +698,21 @@ QByteArray VstPlugin::saveChunk()
 	QTemporaryFile tf;
 	if( tf.open() )
 	{
+		// the plugin only writes the chunk if it changed since
 		lock();
 		sendMessage( message( IdSaveSettingsToFile ).
 				addString(
 					QSTR_TO_STDSTR(
-						QDir::toNativeSeparators( tf.fileName() ) ) ) );
-		waitForMessage( IdSaveSettingsToFile, true );
+						QDir::toNativeSeparators( tf.fileName() ) ) ).
+				addInt( !m_chunk.isEmpty() ) );
+		const message m = waitForMessage( IdSaveSettingsToFile, true );
 		unlock();
+		if( m.id == IdSaveSettingsToFile && m.getInt() == 0 )
+		{
+			return m_chunk;
+		}
 		a = tf.readAll();
+		m_chunk = a;
 	}
 
 	return a;
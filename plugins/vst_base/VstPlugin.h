@@ -165,7 +165,11 @@ private:
 
 	QString p_name;
 
+	// what the plugin sent so far, it sends the values which changed since
 	QMap<QString, QString> m_parameterDump;
+	std::vector<QString> m_parameterNames;
+	// the chunk saved last, the plugin tells if it's still the same
+	QByteArray m_chunk;
 
 	int m_currentProgram;
 
@@ -29,10 +29,11 @@
 
 
 
-struct VstParameterDumpItem
+// how IdVstParameterDump and IdVstSetParameterDump carry the values, as
+// one binary string of them
+struct VstParameterValue
 {
 	int32_t index;
-	std::string shortLabel;
 	float value;
 } ;
 
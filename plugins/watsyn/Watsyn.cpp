@@ -32,7 +32,6 @@
 #include "ToolTip.h"
 #include "Song.h"
 #include "lmms_math.h"
-#include "interpolation.h"
 
 #include "embed.h"
 #include "plugin_export.h"
@@ -59,9 +58,7 @@ Plugin::Descriptor PLUGIN_EXPORT watsyn_plugin_descriptor =
 
 
 
-WatsynObject::WatsynObject( float * _A1wave, float * _A2wave,
-					float * _B1wave, float * _B2wave,
-					int _amod, int _bmod, const sample_rate_t _samplerate, NotePlayHandle * _nph, fpp_t _frames,
+WatsynObject::WatsynObject( int _amod, int _bmod, const sample_rate_t _samplerate, NotePlayHandle * _nph, fpp_t _frames,
 					WatsynInstrument * _w ) :
 				m_amod( _amod ),
 				m_bmod( _bmod ),
@@ -83,12 +80,12 @@ WatsynObject::WatsynObject( float * _A1wave, float * _A2wave,
 	m_rphase[B1_OSC] = 0.0f;
 	m_rphase[B2_OSC] = 0.0f;
 
-	// copy wavegraphs to the synth object to prevent race conditions
+	// keep the waves, the instrument may swap in new ones while we play
 
-	memcpy( &m_A1wave, _A1wave, sizeof( m_A1wave ) );
-	memcpy( &m_A2wave, _A2wave, sizeof( m_A2wave ) );
-	memcpy( &m_B1wave, _B1wave, sizeof( m_B1wave ) );
-	memcpy( &m_B2wave, _B2wave, sizeof( m_B2wave ) );
+	for( int i = 0; i < NUM_OSCS; i++ )
+	{
+		m_waves[i] = std::atomic_load( &_w->m_waves[i] );
+	}
 }
 
 
@@ -107,6 +104,22 @@ void WatsynObject::renderOutput( fpp_t _frames )
 	if( m_bbuf == nullptr )
 		m_bbuf = new sampleFrame[m_fpp];
 
+	// the frequencies don't change within a period, so neither do the
+	// tables to play or the phase increments
+	int ltable [NUM_OSCS];
+	int rtable [NUM_OSCS];
+	float lincr [NUM_OSCS];
+	float rincr [NUM_OSCS];
+	for( int i = 0; i < NUM_OSCS; i++ )
+	{
+		const float lwavelen = m_samplerate / ( m_nph->frequency() * m_parent->m_lfreq[i] );
+		const float rwavelen = m_samplerate / ( m_nph->frequency() * m_parent->m_rfreq[i] );
+		ltable[i] = BandLimitedWave::tableFor( lwavelen );
+		rtable[i] = BandLimitedWave::tableFor( rwavelen );
+		lincr[i] = static_cast<float>( WAVELEN ) / lwavelen;
+		rincr[i] = static_cast<float>( WAVELEN ) / rwavelen;
+	}
+
 	for( fpp_t frame = 0; frame < _frames; frame++ )
 	{
 		// put phases of 1-series oscs into variables because phase modulation might happen
@@ -118,12 +131,8 @@ void WatsynObject::renderOutput( fpp_t _frames )
 		/////////////   A-series   /////////////////
 
 		// A2
-		sample_t A2_L = linearInterpolate( m_A2wave[ static_cast<int>( m_lphase[A2_OSC] ) ],
-							m_A2wave[ static_cast<int>( m_lphase[A2_OSC] + 1 ) % WAVELEN ],
-							fraction( m_lphase[A2_OSC] ) ) * m_parent->m_lvol[A2_OSC];
-		sample_t A2_R = linearInterpolate( m_A2wave[ static_cast<int>( m_rphase[A2_OSC] ) ],
-							m_A2wave[ static_cast<int>( m_rphase[A2_OSC] + 1 ) % WAVELEN ],
-							fraction( m_rphase[A2_OSC] ) ) * m_parent->m_rvol[A2_OSC];
+		sample_t A2_L = wave( A2_OSC, m_lphase[A2_OSC], ltable[A2_OSC] ) * m_parent->m_lvol[A2_OSC];
+		sample_t A2_R = wave( A2_OSC, m_rphase[A2_OSC], rtable[A2_OSC] ) * m_parent->m_rvol[A2_OSC];
 
 		// if phase mod, add to phases
 		if( m_amod == MOD_PM )
@@ -134,22 +143,14 @@ void WatsynObject::renderOutput( fpp_t _frames )
 			if( A1_rphase < 0 ) A1_rphase += WAVELEN;
 		}
 		// A1
-		sample_t A1_L = linearInterpolate( m_A1wave[ static_cast<int>( A1_lphase ) ],
-							m_A1wave[ static_cast<int>( A1_lphase + 1 ) % WAVELEN ],
-							fraction( A1_lphase ) ) * m_parent->m_lvol[A1_OSC];
-		sample_t A1_R = linearInterpolate( m_A1wave[ static_cast<int>( A1_rphase ) ],
-							m_A1wave[ static_cast<int>( A1_rphase + 1 ) % WAVELEN ],
-							fraction( A1_rphase ) ) * m_parent->m_rvol[A1_OSC];
+		sample_t A1_L = wave( A1_OSC, A1_lphase, ltable[A1_OSC] ) * m_parent->m_lvol[A1_OSC];
+		sample_t A1_R = wave( A1_OSC, A1_rphase, rtable[A1_OSC] ) * m_parent->m_rvol[A1_OSC];
 
 		/////////////   B-series   /////////////////
 
 		// B2
-		sample_t B2_L = linearInterpolate( m_B2wave[ static_cast<int>( m_lphase[B2_OSC] ) ],
-							m_B2wave[ static_cast<int>( m_lphase[B2_OSC] + 1 ) % WAVELEN ],
-							fraction( m_lphase[B2_OSC] ) ) * m_parent->m_lvol[B2_OSC];
-		sample_t B2_R = linearInterpolate( m_B2wave[ static_cast<int>( m_rphase[B2_OSC] ) ],
-							m_B2wave[ static_cast<int>( m_rphase[B2_OSC] + 1 ) % WAVELEN ],
-							fraction( m_rphase[B2_OSC] ) ) * m_parent->m_rvol[B2_OSC];
+		sample_t B2_L = wave( B2_OSC, m_lphase[B2_OSC], ltable[B2_OSC] ) * m_parent->m_lvol[B2_OSC];
+		sample_t B2_R = wave( B2_OSC, m_rphase[B2_OSC], rtable[B2_OSC] ) * m_parent->m_rvol[B2_OSC];
 
 		// if crosstalk active, add a1
 		const float xt = m_parent->m_xtalk.value();
@@ -168,12 +169,8 @@ void WatsynObject::renderOutput( fpp_t _frames )
 			if( B1_rphase < 0 ) B1_rphase += WAVELEN;
 		}
 		// B1
-		sample_t B1_L = linearInterpolate( m_B1wave[ static_cast<int>( B1_lphase ) % WAVELEN ],
-							m_B1wave[ static_cast<int>( B1_lphase + 1 ) % WAVELEN ],
-							fraction( B1_lphase ) ) * m_parent->m_lvol[B1_OSC];
-		sample_t B1_R = linearInterpolate( m_B1wave[ static_cast<int>( B1_rphase ) % WAVELEN ],
-							m_B1wave[ static_cast<int>( B1_rphase + 1 ) % WAVELEN ],
-							fraction( B1_rphase ) ) * m_parent->m_rvol[B1_OSC];
+		sample_t B1_L = wave( B1_OSC, B1_lphase, ltable[B1_OSC] ) * m_parent->m_lvol[B1_OSC];
+		sample_t B1_R = wave( B1_OSC, B1_rphase, rtable[B1_OSC] ) * m_parent->m_rvol[B1_OSC];
 
 
 		// A-series modulation)
@@ -217,9 +214,9 @@ void WatsynObject::renderOutput( fpp_t _frames )
 		// update phases
 		for( int i = 0; i < NUM_OSCS; i++ )
 		{
-			m_lphase[i] += ( static_cast<float>( WAVELEN ) / ( m_samplerate / ( m_nph->frequency() * m_parent->m_lfreq[i] ) ) );
+			m_lphase[i] += lincr[i];
 			m_lphase[i] = fmodf( m_lphase[i], WAVELEN );
-			m_rphase[i] += ( static_cast<float>( WAVELEN ) / ( m_samplerate / ( m_nph->frequency() * m_parent->m_rfreq[i] ) ) );
+			m_rphase[i] += rincr[i];
 			m_rphase[i] = fmodf( m_rphase[i], WAVELEN );
 		}
 	}
@@ -333,10 +330,6 @@ void WatsynInstrument::playNote( NotePlayHandle * _n,
 	if ( _n->totalFramesPlayed() == 0 || _n->m_pluginData == nullptr )
 	{
 		WatsynObject * w = new WatsynObject(
-				&A1_wave[0],
-				&A2_wave[0],
-				&B1_wave[0],
-				&B2_wave[0],
 				m_amod.value(), m_bmod.value(),
 				Engine::audioEngine()->processingSampleRate(), _n,
 				Engine::audioEngine()->framesPerPeriod(), this );
@@ -636,29 +629,33 @@ void WatsynInstrument::updateFreqB2()
 
 void WatsynInstrument::updateWaveA1()
 {
-	// do sinc+oversampling on the wavetables to improve quality
-	srccpy( &A1_wave[0], const_cast<float*>( a1_graph.samples() ) );
+	updateWave( A1_OSC, a1_graph );
 }
 
 
 void WatsynInstrument::updateWaveA2()
 {
-	// do sinc+oversampling on the wavetables to improve quality
-	srccpy( &A2_wave[0], const_cast<float*>( a2_graph.samples() ) );
+	updateWave( A2_OSC, a2_graph );
 }
 
 
 void WatsynInstrument::updateWaveB1()
 {
-	// do sinc+oversampling on the wavetables to improve quality
-	srccpy( &B1_wave[0], const_cast<float*>( b1_graph.samples() ) );
+	updateWave( B1_OSC, b1_graph );
 }
 
 
 void WatsynInstrument::updateWaveB2()
 {
-	// do sinc+oversampling on the wavetables to improve quality
-	srccpy( &B2_wave[0], const_cast<float*>( b2_graph.samples() ) );
+	updateWave( B2_OSC, b2_graph );
+}
+
+
+void WatsynInstrument::updateWave( int _osc, const graphModel & _graph )
+{
+	// band-limited mipmaps of the graph, so that the notes don't alias
+	std::atomic_store( &m_waves[_osc], std::shared_ptr<const UserWaveMipMap>(
+			new UserWaveMipMap( _graph.samples(), GRAPHLEN ) ) );
 }
 
 
@@ -26,6 +26,9 @@
 #ifndef WATSYN_H
 #define WATSYN_H
 
+#include <memory>
+
+#include "BandLimitedWave.h"
 #include "Instrument.h"
 #include "InstrumentView.h"
 #include "Graph.h"
@@ -34,7 +37,6 @@
 #include "TempoSyncKnob.h"
 #include "NotePlayHandle.h"
 #include "PixmapButton.h"
-#include <samplerate.h>
 #include "MemoryManager.h"
 
 
@@ -60,9 +62,9 @@
 
 const int GRAPHLEN = 220; // don't change - must be same as the size of the widget
 
-const int WAVERATIO = 32; // oversampling ratio
+const int WAVERATIO = 32;
 
-const int WAVELEN = GRAPHLEN * WAVERATIO;
+const int WAVELEN = GRAPHLEN * WAVERATIO; // phases go from 0 to WAVELEN
 const int PMOD_AMT = WAVELEN / 2;
 
 const int	MOD_MIX = 0;
@@ -83,9 +85,7 @@ class WatsynObject
 {
 	MM_OPERATORS
 public:
-	WatsynObject( 	float * _A1wave, float * _A2wave,
-					float * _B1wave, float * _B2wave,
-					int _amod, int _bmod, const sample_rate_t _samplerate, NotePlayHandle * _nph, fpp_t _frames,
+	WatsynObject( 	int _amod, int _bmod, const sample_rate_t _samplerate, NotePlayHandle * _nph, fpp_t _frames,
 					WatsynInstrument * _w );
 	virtual ~WatsynObject();
 
@@ -105,6 +105,11 @@ public:
 	}
 
 private:
+	inline sample_t wave( int _osc, float _phase, int _table ) const
+	{
+		return m_waves[_osc]->oscillate( _phase / WAVELEN, _table );
+	}
+
 	int m_amod;
 	int m_bmod;
 
@@ -121,10 +126,8 @@ private:
 	float m_lphase [NUM_OSCS];
 	float m_rphase [NUM_OSCS];
 
-	float m_A1wave [WAVELEN];
-	float m_A2wave [WAVELEN];
-	float m_B1wave [WAVELEN];
-	float m_B2wave [WAVELEN];
+	// the waves as they were when the note started
+	std::shared_ptr<const UserWaveMipMap> m_waves [NUM_OSCS];
 };
 
 class WatsynInstrument : public Instrument
@@ -181,30 +184,8 @@ private:
 		return ( _pan >= 0 ? 1.0 : 1.0 + ( _pan / 100.0 ) ) * _vol / 100.0;
 	}
 
-	// memcpy utilizing libsamplerate (src) for sinc interpolation
-	inline void srccpy( float * _dst, float * _src )
-	{
-		int err;
-		const int margin = 64;
-		
-		// copy to temp array
-		float tmps [ GRAPHLEN + margin ]; // temp array in stack
-		float * tmp = &tmps[0];
-
-		memcpy( tmp, _src, sizeof( float ) * GRAPHLEN );
-		memcpy( tmp + GRAPHLEN, _src, sizeof( float ) * margin );
-		SRC_STATE * src_state = src_new( SRC_SINC_FASTEST, 1, &err );
-		SRC_DATA src_data;
-		src_data.data_in = tmp;
-		src_data.input_frames = GRAPHLEN + margin;
-		src_data.data_out = _dst;
-		src_data.output_frames = WAVELEN;
-		src_data.src_ratio = static_cast<double>( WAVERATIO );
-		src_data.end_of_input = 0;
-		err = src_process( src_state, &src_data ); 
-		if( err ) { qDebug( "Watsyn SRC error: %s", src_strerror( err ) ); }
-		src_delete( src_state );
-	}
+	// band-limits the wave of an oscillator for the notes started next
+	void updateWave( int _osc, const graphModel & _graph );
 
 	// memcpy utilizing cubic interpolation
 /*	inline void cipcpy( float * _dst, float * _src )
@@ -283,10 +264,8 @@ private:
 
 	IntModel m_selectedGraph;
 	
-	float A1_wave [WAVELEN];
-	float A2_wave [WAVELEN];
-	float B1_wave [WAVELEN];
-	float B2_wave [WAVELEN];
+	// swapped with std::atomic_store(), shared by the notes
+	std::shared_ptr<const UserWaveMipMap> m_waves [NUM_OSCS];
 
 	friend class WatsynObject;
 	friend class WatsynView;
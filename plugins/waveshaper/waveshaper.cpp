@@ -24,10 +24,13 @@
  */
 
 
+#include <algorithm>
+
 #include "waveshaper.h"
-#include "lmms_math.h"
 #include "embed.h"
-#include "interpolation.h"
+#include "Engine.h"
+#include "AudioEngine.h"
+#include "MixHelpers.h"
 
 #include "plugin_export.h"
 
@@ -55,7 +58,8 @@ Plugin::Descriptor PLUGIN_EXPORT waveshaper_plugin_descriptor =
 waveShaperEffect::waveShaperEffect( Model * _parent,
 			const Descriptor::SubPluginFeatures::Key * _key ) :
 	Effect( &waveshaper_plugin_descriptor, _parent, _key ),
-	m_wsControls( this )
+	m_wsControls( this ),
+	m_shaped( Engine::audioEngine()->framesPerPeriod() )
 {
 }
 
@@ -77,79 +81,23 @@ bool waveShaperEffect::processAudioBuffer( sampleFrame * _buf,
 		return( false );
 	}
 
-// variables for effect
-	int i = 0;
-
-	double out_sum = 0.0;
 	const float d = dryLevel();
 	const float w = wetLevel();
-	float input = m_wsControls.m_inputModel.value();
-	float output = m_wsControls.m_outputModel.value();
 	const float * samples = m_wsControls.m_wavegraphModel.samples();
-	const bool clip = m_wsControls.m_clipModel.value();
 
-	ValueBuffer *inputBuffer = m_wsControls.m_inputModel.valueBuffer();
-	ValueBuffer *outputBufer = m_wsControls.m_outputModel.valueBuffer();
+	// the kernel interpolates from 0 at the magnitude 0
+	m_table[0] = 0.0f;
+	std::copy( samples, samples + GraphPoints, m_table + 1 );
 
-	int inputInc = inputBuffer ? 1 : 0;
-	int outputInc = outputBufer ? 1 : 0;
-
-	const float *inputPtr = inputBuffer ? &( inputBuffer->values()[ 0 ] ) : &input;
-	const float *outputPtr = outputBufer ? &( outputBufer->values()[ 0 ] ) : &output;
-
-	for( fpp_t f = 0; f < _frames; ++f )
-	{
-		float s[2] = { _buf[f][0], _buf[f][1] };
-
-// apply input gain
-		s[0] *= *inputPtr;
-		s[1] *= *inputPtr;
-
-// clip if clip enabled
-		if( clip )
-		{
-			s[0] = qBound( -1.0f, s[0], 1.0f );
-			s[1] = qBound( -1.0f, s[1], 1.0f );
-		}
-
-// start effect
-
-		for( i=0; i <= 1; ++i )
-		{
-			const int lookup = static_cast<int>( qAbs( s[i] ) * 200.0f );
-			const float frac = fraction( qAbs( s[i] ) * 200.0f ); 
-			const float posneg = s[i] < 0 ? -1.0f : 1.0f;
-
-			if( lookup < 1 )
-			{
-				s[i] = frac * samples[0] * posneg;
-			}
-			else if( lookup < 200 )
-			{	
-				s[i] = linearInterpolate( samples[ lookup - 1 ], 
-						samples[ lookup ], frac )
-						* posneg;
-			}
-			else
-			{
-				s[i] *= samples[199];
-			}
-		}
-
-// apply output gain
-		s[0] *= *outputPtr;
-		s[1] *= *outputPtr;
+	MixHelpers::shape( m_shaped.data(), _buf, m_table, GraphPoints,
+				m_wsControls.m_inputModel.value(), m_wsControls.m_inputModel.valueBuffer(),
+				m_wsControls.m_outputModel.value(), m_wsControls.m_outputModel.valueBuffer(),
+				m_wsControls.m_clipModel.value(), _frames );
 
 // mix wet/dry signals
-		_buf[f][0] = d * _buf[f][0] + w * s[0];
-		_buf[f][1] = d * _buf[f][1] + w * s[1];
-		out_sum += _buf[f][0] * _buf[f][0] + _buf[f][1] * _buf[f][1];
-
-		outputPtr += outputInc;
-		inputPtr += inputInc;
-	}
+	MixHelpers::multiplyAndAddMultiplied( _buf, m_shaped.data(), d, w, _frames );
 
-	checkGate( out_sum / _frames );
+	checkGate( MixHelpers::energy( _buf, _frames ) / _frames );
 
 	return( isRunning() );
 }
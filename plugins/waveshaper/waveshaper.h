@@ -27,6 +27,8 @@
 #ifndef _WAVESHAPER_H
 #define _WAVESHAPER_H
 
+#include <vector>
+
 #include "Effect.h"
 #include "waveshaper_controls.h"
 
@@ -46,11 +48,22 @@ public:
 		return( &m_wsControls );
 	}
 
+	bool supportsOversampling() const override
+	{
+		return true;
+	}
+
 
 private:
+	static const int GraphPoints = 200;
 
 	waveShaperControls m_wsControls;
 
+	// the wet signal, before it's mixed in
+	std::vector<sampleFrame> m_shaped;
+	// the graph, after a 0 for the magnitude 0
+	float m_table[GraphPoints + 1];
+
 	friend class waveShaperControls;
 
 } ;
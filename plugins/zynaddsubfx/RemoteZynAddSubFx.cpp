@@ -27,7 +27,12 @@
 #include <winsock2.h>
 #endif
 
+#include <algorithm>
 #include <queue>
+#include <vector>
+#ifndef LMMS_BUILD_WIN32
+#include <csignal>
+#endif
 
 #include <FL/x.H>
 #undef CursorShape // is, by mistake, not undefed in FL
@@ -54,10 +59,10 @@ public:
 #endif
 		LocalZynAddSubFx(),
 		m_guiSleepTime( 100 ),
-		m_guiExit( false )
+		m_guiExit( false ),
+		m_ui( nullptr ),
+		m_exitProgram( 0 )
 	{
-		Nio::start();
-
 		setInputCount( 0 );
 		sendMessage( IdInitDone );
 		waitForMessage( IdInitDone );
@@ -68,7 +73,6 @@ public:
 
 	virtual ~RemoteZynAddSubFx()
 	{
-		Nio::stop();
 	}
 
 	virtual void updateSampleRate()
@@ -158,6 +162,21 @@ public:
 
 	void guiLoop();
 
+	//! Handles what the GUI was asked for, called by the thread running
+	//! FLTK until guiExited()
+	void processGuiMessages();
+	void closeGui();
+
+	bool guiExited() const
+	{
+		return m_guiExit;
+	}
+
+	bool hasGui() const
+	{
+		return m_ui != nullptr;
+	}
+
 private:
 	const int m_guiSleepTime;
 
@@ -166,6 +185,9 @@ private:
 	std::queue<RemotePluginClient::message> m_guiMessages;
 	bool m_guiExit;
 
+	MasterUI * m_ui;
+	int m_exitProgram;
+
 } ;
 
 
@@ -173,12 +195,9 @@ private:
 
 void RemoteZynAddSubFx::guiLoop()
 {
-	int exitProgram = 0;
-	MasterUI * ui = nullptr;
-
 	while( !m_guiExit )
 	{
-		if( ui )
+		if( m_ui )
 		{
 			Fl::wait( m_guiSleepTime / 1000.0 );
 		}
@@ -190,71 +209,182 @@ void RemoteZynAddSubFx::guiLoop()
 			usleep( m_guiSleepTime*1000 );
 #endif
 		}
-		if( exitProgram == 1 )
-		{
-			pthread_mutex_lock( &m_master->mutex );
-			sendMessage( IdHideUI );
-			exitProgram = 0;
-			pthread_mutex_unlock( &m_master->mutex );
-		}
-		pthread_mutex_lock( &m_guiMutex );
-		while( m_guiMessages.size() )
+		processGuiMessages();
+	}
+	Fl::flush();
+
+	closeGui();
+}
+
+
+
+
+void RemoteZynAddSubFx::processGuiMessages()
+{
+	if( m_exitProgram == 1 )
+	{
+		pthread_mutex_lock( &m_master->mutex );
+		sendMessage( IdHideUI );
+		m_exitProgram = 0;
+		pthread_mutex_unlock( &m_master->mutex );
+	}
+	pthread_mutex_lock( &m_guiMutex );
+	while( m_guiMessages.size() )
+	{
+		RemotePluginClient::message m = m_guiMessages.front();
+		m_guiMessages.pop();
+		switch( m.id )
 		{
-			RemotePluginClient::message m = m_guiMessages.front();
-			m_guiMessages.pop();
-			switch( m.id )
+			case IdShowUI:
+				// we only create GUI
+				if( !m_ui )
+				{
+					Fl::scheme( "plastic" );
+					m_ui = new MasterUI( m_master, &m_exitProgram );
+				}
+				m_ui->showUI();
+				m_ui->refresh_master_ui();
+				break;
+
+			case IdLoadSettingsFromFile:
 			{
-				case IdShowUI:
-					// we only create GUI
-					if( !ui )
-					{
-						Fl::scheme( "plastic" );
-						ui = new MasterUI( m_master, &exitProgram );
-					}
-					ui->showUI();
-					ui->refresh_master_ui();
-					break;
-
-				case IdLoadSettingsFromFile:
+				LocalZynAddSubFx::loadXML( m.getString() );
+				if( m_ui )
 				{
-					LocalZynAddSubFx::loadXML( m.getString() );
-					if( ui )
-					{
-						ui->refresh_master_ui();
-					}
-					pthread_mutex_lock( &m_master->mutex );
-					sendMessage( IdLoadSettingsFromFile );
-					pthread_mutex_unlock( &m_master->mutex );
-					break;
+					m_ui->refresh_master_ui();
 				}
+				pthread_mutex_lock( &m_master->mutex );
+				sendMessage( IdLoadSettingsFromFile );
+				pthread_mutex_unlock( &m_master->mutex );
+				break;
+			}
 
-				case IdLoadPresetFile:
+			case IdLoadPresetFile:
+			{
+				LocalZynAddSubFx::loadPreset( m.getString(), m_ui ?
+										m_ui->npartcounter->value()-1 : 0 );
+				if( m_ui )
 				{
-					LocalZynAddSubFx::loadPreset( m.getString(), ui ?
-											ui->npartcounter->value()-1 : 0 );
-					if( ui )
-					{
-						ui->npartcounter->do_callback();
-						ui->updatepanel();
-						ui->refresh_master_ui();
-					}
-					pthread_mutex_lock( &m_master->mutex );
-					sendMessage( IdLoadPresetFile );
-					pthread_mutex_unlock( &m_master->mutex );
-					break;
+					m_ui->npartcounter->do_callback();
+					m_ui->updatepanel();
+					m_ui->refresh_master_ui();
 				}
+				pthread_mutex_lock( &m_master->mutex );
+				sendMessage( IdLoadPresetFile );
+				pthread_mutex_unlock( &m_master->mutex );
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+	pthread_mutex_unlock( &m_guiMutex );
+}
+
+
+
+
+void RemoteZynAddSubFx::closeGui()
+{
+	delete m_ui;
+	m_ui = nullptr;
+}
+
+
+
+
+#ifndef SYNC_WITH_SHM_FIFO
+namespace
+{
 
-				default:
-					break;
+// the instances a process started with RemotePluginHostArgument runs
+pthread_mutex_t s_instancesMutex = PTHREAD_MUTEX_INITIALIZER;
+std::vector<RemoteZynAddSubFx *> s_instances;
+bool s_hostClosed = false;
+
+
+void * acceptInstances( void * _arg )
+{
+	const int hostSocket = *static_cast<int *>( _arg );
+	std::string socketPath;
+	while( RemotePluginClient::nextHostedInstance( hostSocket, socketPath ) )
+	{
+		RemoteZynAddSubFx * instance = new RemoteZynAddSubFx( socketPath.c_str() );
+		pthread_mutex_lock( &s_instancesMutex );
+		s_instances.push_back( instance );
+		pthread_mutex_unlock( &s_instancesMutex );
+	}
+	pthread_mutex_lock( &s_instancesMutex );
+	s_hostClosed = true;
+	pthread_mutex_unlock( &s_instancesMutex );
+	return nullptr;
+}
+
+
+
+
+//! Runs the instances LMMS asks for through @p hostSocketPath, each on a
+//! socket and in memory of its own, with the GUI of all on this thread.
+//! Returns once LMMS closed the socket and the last instance quit.
+void hostInstances( const char * hostSocketPath )
+{
+	// the instances' sockets may be closed before they said goodbye
+	signal( SIGPIPE, SIG_IGN );
+
+	int hostSocket = RemotePluginClient::connectToSocket( hostSocketPath );
+	pthread_t acceptThread;
+	pthread_create( &acceptThread, nullptr, acceptInstances, &hostSocket );
+
+	const int sleepTime = 100;
+	while( true )
+	{
+		pthread_mutex_lock( &s_instancesMutex );
+		if( s_hostClosed && s_instances.empty() )
+		{
+			pthread_mutex_unlock( &s_instancesMutex );
+			break;
+		}
+		const std::vector<RemoteZynAddSubFx *> instances = s_instances;
+		pthread_mutex_unlock( &s_instancesMutex );
+
+		bool gui = false;
+		for( const RemoteZynAddSubFx * instance : instances )
+		{
+			gui |= instance->hasGui();
+		}
+		if( gui )
+		{
+			Fl::wait( sleepTime / 1000.0 );
+		}
+		else
+		{
+			usleep( sleepTime*1000 );
+		}
+
+		for( RemoteZynAddSubFx * instance : instances )
+		{
+			instance->processGuiMessages();
+			if( instance->guiExited() )
+			{
+				instance->closeGui();
+				pthread_mutex_lock( &s_instancesMutex );
+				s_instances.erase( std::find( s_instances.begin(),
+							s_instances.end(), instance ) );
+				pthread_mutex_unlock( &s_instancesMutex );
+				delete instance;
 			}
 		}
-		pthread_mutex_unlock( &m_guiMutex );
 	}
 	Fl::flush();
 
-	delete ui;
+	pthread_join( acceptThread, nullptr );
+	close( hostSocket );
 }
 
+}
+#endif
+
 
 
 
@@ -279,16 +409,31 @@ int main( int _argc, char * * _argv )
 #endif
 
 
+	Nio::start();
+
 #ifdef SYNC_WITH_SHM_FIFO
 	RemoteZynAddSubFx * remoteZASF =
 		new RemoteZynAddSubFx( atoi( _argv[1] ), atoi( _argv[2] ) );
-#else
-	RemoteZynAddSubFx * remoteZASF = new RemoteZynAddSubFx( _argv[1] );
-#endif
 
 	remoteZASF->guiLoop();
 
 	delete remoteZASF;
+#else
+	if( _argc > 2 && strcmp( _argv[1], RemotePluginHostArgument ) == 0 )
+	{
+		hostInstances( _argv[2] );
+	}
+	else
+	{
+		RemoteZynAddSubFx * remoteZASF = new RemoteZynAddSubFx( _argv[1] );
+
+		remoteZASF->guiLoop();
+
+		delete remoteZASF;
+	}
+#endif
+
+	Nio::stop();
 
 
 #ifdef LMMS_BUILD_WIN32
@@ -24,9 +24,11 @@
 
 #include "lmmsconfig.h"
 
+#include <QCoreApplication>
 #include <QDir>
 #include <QDomDocument>
 #include <QTemporaryFile>
+#include <QThread>
 #include <QtGlobal>
 #include <QDropEvent>
 #include <QGridLayout>
@@ -74,9 +76,10 @@ Plugin::Descriptor PLUGIN_EXPORT zynaddsubfx_plugin_descriptor =
 
 
 ZynAddSubFxRemotePlugin::ZynAddSubFxRemotePlugin() :
-	RemotePlugin()
+	RemotePlugin(),
+	m_pendingLoad( IdUndefined )
 {
-	init( "RemoteZynAddSubFx", false );
+	init( "RemoteZynAddSubFx", false, {}, true );
 }
 
 
@@ -95,6 +98,14 @@ bool ZynAddSubFxRemotePlugin::processMessage( const message & _m )
 		case IdHideUI:
 			emit clickedCloseButton();
 			return true;
+		case IdLoadSettingsFromFile:
+		case IdLoadPresetFile:
+		{
+			// read by process() on the audio thread just as well
+			int pending = _m.id;
+			m_pendingLoad.compare_exchange_strong( pending, IdUndefined );
+			return true;
+		}
 		default:
 			break;
 	}
@@ -105,6 +116,32 @@ bool ZynAddSubFxRemotePlugin::processMessage( const message & _m )
 
 
 
+void ZynAddSubFxRemotePlugin::loadFile( RemoteMessageIDs id, const std::string & file )
+{
+	m_pendingLoad = id;
+	lock();
+	sendMessage( message( id ).addString( file ) );
+	unlock();
+
+	// loading PADsynth instruments takes a while, so the lock is only
+	// taken for reading what's there, in case nothing is being played
+	while( m_pendingLoad != IdUndefined && isRunning() && !isInvalid() )
+	{
+		lock();
+		fetchAndProcessAllMessages();
+		unlock();
+		if( m_pendingLoad != IdUndefined )
+		{
+			QCoreApplication::processEvents( QEventLoop::ExcludeUserInputEvents, 10 );
+			QThread::msleep( 1 );
+		}
+	}
+	m_pendingLoad = IdUndefined;
+}
+
+
+
+
 
 ZynAddSubFxInstrument::ZynAddSubFxInstrument(
 									InstrumentTrack * _instrumentTrack ) :
@@ -256,19 +293,17 @@ void ZynAddSubFxInstrument::loadSettings( const QDomElement & _this )
 		tf.flush();
 
 		const std::string fn = QSTR_TO_STDSTR( QDir::toNativeSeparators( tf.fileName() ) );
-		m_pluginMutex.lock();
 		if( m_remotePlugin )
 		{
-			m_remotePlugin->lock();
-			m_remotePlugin->sendMessage( RemotePlugin::message( IdLoadSettingsFromFile ).addString( fn ) );
-			m_remotePlugin->waitForMessage( IdLoadSettingsFromFile );
-			m_remotePlugin->unlock();
+			m_remotePlugin->loadFile( IdLoadSettingsFromFile, fn );
 		}
 		else
 		{
-			m_plugin->loadXML( fn );
+			loadLocalPlugin( [&fn]( LocalZynAddSubFx * plugin )
+			{
+				plugin->loadXML( fn );
+			} );
 		}
-		m_pluginMutex.unlock();
 
 		m_modifiedControllers.clear();
 		for( const QString & c : _this.attribute( "modifiedcontrollers" ).split( ',' ) )
@@ -303,16 +338,29 @@ void ZynAddSubFxInstrument::loadFile( const QString & _file )
 	const std::string fn = QSTR_TO_STDSTR( _file );
 	if( m_remotePlugin )
 	{
-		m_remotePlugin->lock();
-		m_remotePlugin->sendMessage( RemotePlugin::message( IdLoadPresetFile ).addString( fn ) );
-		m_remotePlugin->waitForMessage( IdLoadPresetFile );
-		m_remotePlugin->unlock();
+		m_remotePlugin->loadFile( IdLoadPresetFile, fn );
 	}
 	else
 	{
-		m_pluginMutex.lock();
-		m_plugin->loadPreset( fn );
-		m_pluginMutex.unlock();
+		// the preset only replaces the first part, so the new instance
+		// starts with the state of the current one
+		QTemporaryFile tf;
+		const bool saved = tf.open();
+		const std::string state = QSTR_TO_STDSTR( QDir::toNativeSeparators( tf.fileName() ) );
+		if( saved )
+		{
+			m_pluginMutex.lock();
+			m_plugin->saveXML( state );
+			m_pluginMutex.unlock();
+		}
+		loadLocalPlugin( [&]( LocalZynAddSubFx * plugin )
+		{
+			if( saved )
+			{
+				plugin->loadXML( state );
+			}
+			plugin->loadPreset( fn );
+		} );
 	}
 
 	instrumentTrack()->setName( QFileInfo( _file ).baseName().replace( QRegExp( "^[0-9]{4}-" ), QString() ) );
@@ -479,6 +527,25 @@ void ZynAddSubFxInstrument::initPlugin()
 
 
 
+void ZynAddSubFxInstrument::loadLocalPlugin( const std::function<void( LocalZynAddSubFx * )> & load )
+{
+	// generating the PADsynth samples takes a while, so it's done without
+	// the lock, and the notes of the current instance stop on replacing it
+	LocalZynAddSubFx * plugin = new LocalZynAddSubFx;
+	plugin->setSampleRate( Engine::audioEngine()->processingSampleRate() );
+	plugin->setBufferSize( Engine::audioEngine()->framesPerPeriod() );
+	plugin->setPitchWheelBendRange( instrumentTrack()->midiPitchRange() );
+	load( plugin );
+
+	m_pluginMutex.lock();
+	std::swap( m_plugin, plugin );
+	m_pluginMutex.unlock();
+	delete plugin;
+}
+
+
+
+
 void ZynAddSubFxInstrument::sendControlChange( MidiControllers midiCtl, float value )
 {
 	handleMidiEvent( MidiEvent( MidiControlChange, instrumentTrack()->midiPort()->realOutputChannel(), midiCtl, (int) value, this ) );
@@ -25,6 +25,9 @@
 #ifndef ZYNADDSUBFX_H
 #define ZYNADDSUBFX_H
 
+#include <atomic>
+#include <functional>
+
 #include <QMap>
 #include <QMutex>
 
@@ -53,10 +56,20 @@ public:
 
 	virtual bool processMessage( const message & _m );
 
+	//! Has the remote process load @p file for the message @p id and waits
+	//! for it without keeping the audio engine from processing what was
+	//! loaded before. Main thread.
+	void loadFile( RemoteMessageIDs id, const std::string & file );
+
 
 signals:
 	void clickedCloseButton();
 
+
+private:
+	// the load whose reply hasn't been read yet
+	std::atomic<int> m_pendingLoad;
+
 } ;
 
 
@@ -85,6 +98,12 @@ public:
 		return IsSingleStreamed | IsMidiBased;
 	}
 
+	//! nullptr while ZynAddSubFX runs in LMMS' process
+	const RemotePlugin * remotePlugin() const override
+	{
+		return m_remotePlugin;
+	}
+
 	virtual PluginView * instantiateView( QWidget * _parent );
 
 
@@ -104,6 +123,9 @@ private slots:
 
 private:
 	void initPlugin();
+	//! Lets @p load prepare a new instance while the current one goes on
+	//! playing, and replaces the current one with it
+	void loadLocalPlugin( const std::function<void( LocalZynAddSubFx * )> & load );
 	void sendControlChange( MidiControllers midiCtl, float value );
 
 	bool m_hasGUI;
@@ -24,6 +24,8 @@
 
 #include "AudioEngine.h"
 
+#include <algorithm>
+
 #include "denormals.h"
 
 #include "lmmsconfig.h"
@@ -32,11 +34,20 @@
 #include "AudioPort.h"
 #include "Mixer.h"
 #include "Song.h"
+#include "EngineCounters.h"
 #include "EnvelopeAndLfoParameters.h"
+#include "Instrument.h"
+#include "InstrumentTrack.h"
+#include "LatencyGovernor.h"
 #include "NotePlayHandle.h"
 #include "ConfigManager.h"
 #include "SamplePlayHandle.h"
 #include "MemoryHelper.h"
+#include "Metronome.h"
+#include "MidiPort.h"
+#include "MixHelpers.h"
+#include "RealtimeChecker.h"
+#include "ResamplerPool.h"
 
 // platform-specific audio-interface-classes
 #include "AudioAlsa.h"
@@ -69,16 +80,23 @@ static thread_local bool s_renderingThread;
 
 
 
-AudioEngine::AudioEngine( bool renderOnly ) :
+AudioEngine::AudioEngine( bool renderOnly, fpp_t renderFramesPerPeriod, int renderThreads ) :
 	m_renderOnly( renderOnly ),
 	m_framesPerPeriod( DEFAULT_BUFFER_SIZE ),
-	m_inputBufferRead( 0 ),
-	m_inputBufferWrite( 1 ),
+	m_inputRing( INPUT_RING_FRAMES ),
+	m_inputReader( m_inputRing ),
+	m_inputBuffer( new sampleFrame[INPUT_RING_FRAMES] ),
+	m_inputBufferFrames( 0 ),
+	m_lostInputFrames( 0 ),
+	m_midiEvents( MIDI_QUEUE_EVENTS ),
+	m_lastPeriodStart( 0 ),
+	m_midiOutEvents( MIDI_QUEUE_EVENTS ),
 	m_outputBufferRead(nullptr),
 	m_outputBufferWrite(nullptr),
 	m_workers(),
-	m_numWorkers( QThread::idealThreadCount()-1 ),
+	m_numWorkers( ( renderOnly && renderThreads > 0 ? renderThreads : QThread::idealThreadCount() ) - 1 ),
 	m_newPlayHandles( PlayHandle::MaxNumber ),
+	m_usedPlayHandleBatches( 0 ),
 	m_qualitySettings( qualitySettings::Mode_Draft ),
 	m_masterGain( 1.0f ),
 	m_isProcessing( false ),
@@ -87,19 +105,28 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 	m_audioDevStartFailed( false ),
 	m_profiler(),
 	m_metronomeActive(false),
+	m_metronome(nullptr),
+	m_idle(false),
+	m_panLaw(static_cast<MixHelpers::PanLaw>(qBound(0,
+		ConfigManager::inst()->value("audioengine", "panlaw").toInt(),
+		static_cast<int>(MixHelpers::PanLaw::ConstantPowerUnityCenter)))),
+	m_lfoControlInterval(qBound(1,
+		ConfigManager::inst()->value("audioengine", "lfointerval").toInt(), 256)),
+	m_filterControlInterval(qBound(1,
+		ConfigManager::inst()->value("audioengine", "filterinterval").toInt(), 256)),
+	m_automationControlInterval(qBound(1,
+		ConfigManager::inst()->value("audioengine", "automationinterval").toInt(), 256)),
 	m_clearSignal( false ),
 	m_changesSignal( false ),
 	m_changes( 0 ),
 	m_doChangesMutex( QMutex::Recursive ),
 	m_waitingForWrite( false )
 {
-	for( int i = 0; i < 2; ++i )
-	{
-		m_inputBufferFrames[i] = 0;
-		m_inputBufferSize[i] = DEFAULT_BUFFER_SIZE * 100;
-		m_inputBuffer[i] = new sampleFrame[ DEFAULT_BUFFER_SIZE * 100 ];
-		BufferManager::clear( m_inputBuffer[i], m_inputBufferSize[i] );
-	}
+	// prepares its states before any voice asks for them
+	ResamplerPool::inst();
+
+	m_voiceLimiter.setLimit( ConfigManager::inst()->value( "audioengine", "voicelimit" ).toInt() );
+	m_voiceLimiter.setAdaptive( ConfigManager::inst()->value( "audioengine", "adaptivevoicelimit" ).toInt() );
 
 	// determine FIFO size and number of frames per period
 	int fifoSize = 1;
@@ -128,9 +155,45 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 			m_framesPerPeriod = DEFAULT_BUFFER_SIZE;
 		}
 	}
+	// offline rendering doesn't care about latency, so larger periods only
+	// save per-period overhead - note and automation timing is still
+	// sample accurate as Song::processNextBuffer() splits periods at ticks
+	else if( renderFramesPerPeriod > 0 )
+	{
+		m_framesPerPeriod = qBound( MINIMUM_BUFFER_SIZE, renderFramesPerPeriod,
+						MAXIMUM_RENDER_BUFFER_SIZE );
+	}
+
+	// more periods in the FIFO make dropouts less likely, at the price of
+	// latency
+	const int fifoPeriods = ConfigManager::inst()->value( "audioengine", "fifoperiods" ).toInt();
+	if( !renderOnly && fifoPeriods > 0 )
+	{
+		fifoSize = fifoPeriods;
+	}
+
+	// allocate the FIFO from the determined size, with one more period for
+	// the one being rendered into - the latency governor may use more of
+	// them when the CPU can't keep up, but never less than configured
+	int fifoCapacity = fifoSize + 1;
+	if( !renderOnly && ConfigManager::inst()->value( "audioengine", "latencygovernor" ).toInt() )
+	{
+		const int maxPeriods = qMax( ConfigManager::inst()->value( "audioengine", "governormaxperiods",
+						QString::number( DefaultGovernorMaxPeriods ) ).toInt(), fifoCapacity );
+		m_latencyGovernor.reset( new LatencyGovernor( fifoCapacity, maxPeriods ) );
+		fifoCapacity = maxPeriods;
+	}
+	m_fifo = new Fifo( fifoCapacity, m_framesPerPeriod );
+	m_fifo->setDepth( fifoSize + 1 );
 
-	// allocte the FIFO from the determined size
-	m_fifo = new Fifo( fifoSize );
+	m_dueMidiEvents.reserve( MIDI_QUEUE_EVENTS );
+	m_dueMidiOutEvents.reserve( MIDI_QUEUE_EVENTS );
+	// there are never more batches than notes
+	m_noteBatches.reserve( PlayHandle::MaxNumber );
+	for( int i = 0; i < PLAY_HANDLE_BATCHES; ++i )
+	{
+		m_playHandleBatches.emplace_back( new PlayHandleBatch );
+	}
 
 	// now that framesPerPeriod is fixed initialize global BufferManager
 	BufferManager::init( m_framesPerPeriod );
@@ -142,14 +205,20 @@ AudioEngine::AudioEngine( bool renderOnly ) :
 	BufferManager::clear(m_outputBufferRead, m_framesPerPeriod);
 	BufferManager::clear(m_outputBufferWrite, m_framesPerPeriod);
 
+	// create all workers before starting any of them, as every worker adds
+	// its own deque to the job queue
 	for( int i = 0; i < m_numWorkers+1; ++i )
 	{
-		AudioEngineWorkerThread * wt = new AudioEngineWorkerThread( this );
-		if( i < m_numWorkers )
-		{
-			wt->start( QThread::TimeCriticalPriority );
-		}
-		m_workers.push_back( wt );
+		m_workers.push_back( new AudioEngineWorkerThread( this ) );
+	}
+	// one trace buffer per job queue, the first one is for the thread
+	// calling renderNextBuffer()
+	m_profiler.setThreadCount( m_numWorkers + 2 );
+	// the glitch history is only kept while playing
+	m_profiler.setJobCostsEnabled( !m_renderOnly );
+	for( int i = 0; i < m_numWorkers; ++i )
+	{
+		m_workers[i]->start( QThread::TimeCriticalPriority );
 	}
 }
 
@@ -172,10 +241,6 @@ AudioEngine::~AudioEngine()
 		m_workers[w]->wait( 500 );
 	}
 
-	while( m_fifo->available() )
-	{
-		delete[] m_fifo->read();
-	}
 	delete m_fifo;
 
 	delete m_midiClient;
@@ -184,10 +249,7 @@ AudioEngine::~AudioEngine()
 	MemoryHelper::alignedFree(m_outputBufferRead);
 	MemoryHelper::alignedFree(m_outputBufferWrite);
 
-	for( int i = 0; i < 2; ++i )
-	{
-		delete[] m_inputBuffer[i];
-	}
+	delete[] m_inputBuffer;
 }
 
 
@@ -212,9 +274,48 @@ void AudioEngine::initDevices()
 
 
 
+void AudioEngine::initMetronome()
+{
+	if( m_metronome == nullptr )
+	{
+		m_metronome = new Metronome;
+	}
+}
+
+
+
+
+void AudioEngine::destroyMetronome()
+{
+	if( m_metronome == nullptr )
+	{
+		return;
+	}
+
+	for( int i = 0; i < m_playHandles.size(); )
+	{
+		PlayHandle * ph = m_playHandles[i];
+		if( m_metronome->owns( ph ) )
+		{
+			takePlayHandle( ph );
+			deletePlayHandle( ph );
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	delete m_metronome;
+	m_metronome = nullptr;
+}
+
+
+
+
 void AudioEngine::startProcessing(bool needsFifo)
 {
-	if (needsFifo)
+	if (needsFifo && !m_audioDev->rendersInCallback())
 	{
 		m_fifoWriter = new fifoWriter( this, m_fifo );
 		m_fifoWriter->start( QThread::HighPriority );
@@ -302,28 +403,73 @@ bool AudioEngine::criticalXRuns() const
 
 void AudioEngine::pushInputFrames( sampleFrame * _ab, const f_cnt_t _frames )
 {
-	requestChangeInModel();
+	const f_cnt_t written = static_cast<f_cnt_t>( m_inputRing.write( _ab, _frames ) );
+	if( written < _frames )
+	{
+		m_lostInputFrames.fetch_add( _frames - written, std::memory_order_relaxed );
+	}
+}
 
-	f_cnt_t frames = m_inputBufferFrames[ m_inputBufferWrite ];
-	int size = m_inputBufferSize[ m_inputBufferWrite ];
-	sampleFrame * buf = m_inputBuffer[ m_inputBufferWrite ];
 
-	if( frames + _frames > size )
-	{
-		size = qMax( size * 2, frames + _frames );
-		sampleFrame * ab = new sampleFrame[ size ];
-		memcpy( ab, buf, frames * sizeof( sampleFrame ) );
-		delete [] buf;
 
-		m_inputBufferSize[ m_inputBufferWrite ] = size;
-		m_inputBuffer[ m_inputBufferWrite ] = ab;
 
-		buf = ab;
+void AudioEngine::pushMidiEvent( MidiPort * port, const MidiEvent & event, const TimePos & time,
+					qint64 timestamp )
+{
+	m_midiEvents.push( { port, event, time, timestamp } );
+}
+
+
+
+
+void AudioEngine::pushMidiOutEvent( const MidiPort * port, const MidiEvent & event, const TimePos & time,
+					f_cnt_t offset )
+{
+	m_midiOutEvents.push( { port, event, time, offset } );
+}
+
+
+
+
+namespace
+{
+
+template<typename T>
+void removePortEvents( LocklessList<T> & events, const MidiPort * port )
+{
+	for( typename LocklessList<T>::Element * e = events.first(), * ePrev = nullptr; e; )
+	{
+		typename LocklessList<T>::Element * next = e->next;
+		if( e->value.port == port )
+		{
+			if( ePrev )
+			{
+				ePrev->next = next;
+			}
+			else
+			{
+				events.setFirst( next );
+			}
+			events.free( e );
+		}
+		else
+		{
+			ePrev = e;
+		}
+		e = next;
 	}
+}
+
+}
+
+
 
-	memcpy( &buf[ frames ], _ab, _frames * sizeof( sampleFrame ) );
-	m_inputBufferFrames[ m_inputBufferWrite ] += _frames;
 
+void AudioEngine::removeMidiEvents( MidiPort * port )
+{
+	requestChangeInModel();
+	removePortEvents( m_midiEvents, port );
+	removePortEvents( m_midiOutEvents, port );
 	doneChangeInModel();
 }
 
@@ -332,9 +478,12 @@ void AudioEngine::pushInputFrames( sampleFrame * _ab, const f_cnt_t _frames )
 
 const surroundSampleFrame * AudioEngine::renderNextBuffer()
 {
+	// devices with callbacks render in threads of their own
+	disable_denormals();
 	m_profiler.startPeriod();
 
 	s_renderingThread = true;
+	RealtimeChecker::enter();
 
 	if( m_clearSignal )
 	{
@@ -344,27 +493,30 @@ const surroundSampleFrame * AudioEngine::renderNextBuffer()
 
 	// remove all play-handles that have to be deleted and delete
 	// them if they still exist...
-	// maybe this algorithm could be optimized...
-	ConstPlayHandleList::Iterator it_rem = m_playHandlesToRemove.begin();
-	while( it_rem != m_playHandlesToRemove.end() )
+	for( PlayHandle * ph : m_playHandlesToRemove )
 	{
-		PlayHandleList::Iterator it = std::find( m_playHandles.begin(), m_playHandles.end(), *it_rem );
-
-		if( it != m_playHandles.end() )
+		ph->m_removalRequested = false;
+		if( takePlayHandle( ph ) )
 		{
-			( *it )->audioPort()->removePlayHandle( ( *it ) );
-			if( ( *it )->type() == PlayHandle::TypeNotePlayHandle )
-			{
-				NotePlayHandleManager::release( (NotePlayHandle*) *it );
-			}
-			else delete *it;
-			m_playHandles.erase( it );
+			deletePlayHandle( ph );
 		}
-
-		it_rem = m_playHandlesToRemove.erase( it_rem );
 	}
+	m_playHandlesToRemove.clear();
 
 	swapBuffers();
+	processMidiEvents();
+
+	// while nothing can produce sound, hand out the cleared buffers without
+	// running the graph - any new play handle, input or the transport
+	// starting wakes us up in the next period
+	m_idle = canIdle();
+	if( m_idle )
+	{
+		m_profiler.countSkipped( AudioEngineProfiler::SkippedWork::Period );
+		m_profiler.finishStage( AudioEngineProfiler::Stage::PlayHandles );
+		finishPeriod();
+		return m_outputBufferRead;
+	}
 
 	// prepare master mix (clear internal buffers etc.)
 	Mixer * mixer = Engine::mixer();
@@ -378,51 +530,147 @@ const surroundSampleFrame * AudioEngine::renderNextBuffer()
 	// add all play-handles that have to be added
 	for( LocklessListElement * e = m_newPlayHandles.popList(); e; )
 	{
-		m_playHandles += e->value;
+		appendPlayHandle( e->value );
 		LocklessListElement * next = e->next;
 		m_newPlayHandles.free( e );
 		e = next;
 	}
+	// the load is the one of the last period
+	m_voiceLimiter.process( m_playHandles, m_profiler.cpuLoad() );
+	m_profiler.finishStage( AudioEngineProfiler::Stage::PlayHandles );
+
+	// from here on the graph reads the published audio port list and effect
+	// chains, which writers may replace but won't free until we're done
+	m_renderGracePeriod.enterPeriod();
+	const AudioPortList & audioPorts = m_audioPorts.read();
+
+	// STAGE 1: set up the render graph of this period - play handles feed
+	// audio ports, audio ports feed mixer channels and mixer channels feed
+	// their receivers
+	mixer->prepareChannelDependencies();
+	for( AudioPort * port : audioPorts )
+	{
+		port->prepareProcessing();
+		mixer->addAudioPortInput( port->targetMixerChannel() );
+	}
+	for( PlayHandle * ph : m_playHandles )
+	{
+		if( ph->audioPort() )
+		{
+			ph->audioPort()->addPendingPlayHandle();
+		}
+	}
 
-	// STAGE 1: run and render all play handles
-	AudioEngineWorkerThread::fillJobQueue<PlayHandleList>( m_playHandles );
+	// STAGE 2: render the whole graph - every job gets queued as soon as
+	// all of its inputs are ready, so e.g. a mixer channel doesn't have to
+	// wait for play handles of unrelated tracks
+	AudioEngineWorkerThread::resetJobQueue( AudioEngineWorkerThread::JobQueue::Dynamic );
+	AudioEngineWorkerThread::reserveJobs( audioPorts.size() + m_playHandles.size() +
+							mixer->numChannels() );
+	mixer->queueIndependentChannels();
+	for( AudioPort * port : audioPorts )
+	{
+		if( !port->hasPendingPlayHandles() )
+		{
+			AudioEngineWorkerThread::addJob( port );
+		}
+	}
+	for( PlayHandle * ph : m_playHandles )
+	{
+		// the notes of instruments playing them batched are played by one
+		// job per track
+		if( ph->type() == PlayHandle::TypeNotePlayHandle && ph->requiresProcessing() )
+		{
+			NotePlayHandle * nph = static_cast<NotePlayHandle *>( ph );
+			const Instrument * instrument = nph->instrumentTrack()->instrument();
+			if( instrument && instrument->flags().testFlag( Instrument::PlaysNotesBatched ) )
+			{
+				NoteBatch & batch = nph->instrumentTrack()->noteBatch();
+				if( batch.isEmpty() )
+				{
+					m_noteBatches.push_back( &batch );
+				}
+				batch.add( nph );
+				continue;
+			}
+		}
+		if( batchPlayHandle( ph ) )
+		{
+			continue;
+		}
+		// finished play handles won't be processed but still have to
+		// be accounted for by their audio port
+		if( !AudioEngineWorkerThread::addJob( ph ) && ph->audioPort() )
+		{
+			ph->audioPort()->playHandleProcessed();
+		}
+	}
+	for( NoteBatch * batch : m_noteBatches )
+	{
+		AudioEngineWorkerThread::addJob( batch );
+	}
+	m_noteBatches.clear();
+	// the batches which didn't fill up
+	for( size_t i = 0; i < m_usedPlayHandleBatches; ++i )
+	{
+		PlayHandleBatch * batch = m_playHandleBatches[i].get();
+		if( batch->audioPort()->m_playHandleBatch == batch )
+		{
+			batch->audioPort()->m_playHandleBatch = nullptr;
+			AudioEngineWorkerThread::addJob( batch );
+		}
+	}
+	m_usedPlayHandleBatches = 0;
 	AudioEngineWorkerThread::startAndWaitForJobs();
 
+	// resolve the job names while all jobs are still alive
+	m_profiler.collectJobTraces();
+	RealtimeChecker::collect();
+
+	m_renderGracePeriod.leavePeriod();
+	m_profiler.finishStage( AudioEngineProfiler::Stage::Graph );
+
 	// removed all play handles which are done
-	for( PlayHandleList::Iterator it = m_playHandles.begin();
-						it != m_playHandles.end(); )
+	for( int i = 0; i < m_playHandles.size(); )
 	{
-		if( ( *it )->affinityMatters() &&
-			( *it )->affinity() != QThread::currentThread() )
+		PlayHandle * ph = m_playHandles[i];
+		// handles waiting in m_playHandlesToRemove get deleted there
+		if( ( ph->affinityMatters() &&
+			ph->affinity() != QThread::currentThread() ) ||
+			ph->m_removalRequested )
 		{
-			++it;
+			++i;
 			continue;
 		}
-		if( ( *it )->isFinished() )
+		if( ph->isFinished() )
 		{
-			( *it )->audioPort()->removePlayHandle( ( *it ) );
-			if( ( *it )->type() == PlayHandle::TypeNotePlayHandle )
-			{
-				NotePlayHandleManager::release( (NotePlayHandle*) *it );
-			}
-			else delete *it;
-			it = m_playHandles.erase( it );
+			// the last handle takes the place of the removed one, so
+			// don't advance
+			takePlayHandle( ph );
+			deletePlayHandle( ph );
 		}
 		else
 		{
-			++it;
+			++i;
 		}
 	}
 
-	// STAGE 2: process effects of all instrument- and sampletracks
-	AudioEngineWorkerThread::fillJobQueue<QVector<AudioPort *> >( m_audioPorts );
-	AudioEngineWorkerThread::startAndWaitForJobs();
-
+	m_profiler.finishStage( AudioEngineProfiler::Stage::PlayHandles );
 
-	// STAGE 3: do master mix in mixer
+	// STAGE 3: apply master volume and clear the mixer for the next period
 	mixer->masterMix(m_outputBufferWrite);
+	m_profiler.finishStage( AudioEngineProfiler::Stage::MasterMix );
+
+	finishPeriod();
+
+	return m_outputBufferRead;
+}
+
+
 
 
+void AudioEngine::finishPeriod()
+{
 	emit nextAudioBuffer(m_outputBufferRead);
 
 	runChangesInModel();
@@ -431,12 +679,50 @@ const surroundSampleFrame * AudioEngine::renderNextBuffer()
 	EnvelopeAndLfoParameters::instances()->trigger();
 	Controller::triggerFrameCounter();
 	AutomatableModel::incrementPeriodCounter();
+	m_profiler.finishStage( AudioEngineProfiler::Stage::ModelChanges );
 
+	RealtimeChecker::leave();
 	s_renderingThread = false;
 
-	m_profiler.finishPeriod( processingSampleRate(), m_framesPerPeriod );
+	// clients may lock and make system calls
+	sendMidiOutEvents();
 
-	return m_outputBufferRead;
+	const Song * song = Engine::getSong();
+	m_profiler.finishPeriod( processingSampleRate(), m_framesPerPeriod,
+				!m_renderOnly && !( song && song->isExporting() ) );
+
+	EngineCounters::add( EngineCounters::Counter::PeriodsRendered );
+	EngineCounters::set( EngineCounters::Gauge::PlayHandles, m_playHandles.size() );
+	EngineCounters::set( EngineCounters::Gauge::OutputFifoFill, hasFifoWriter() ? m_fifo->filled() : 0 );
+	EngineCounters::set( EngineCounters::Gauge::InputRingFill,
+				static_cast<qint64>( m_inputRing.capacity() - m_inputRing.free() ) );
+}
+
+
+
+
+bool AudioEngine::canIdle()
+{
+	const Song * song = Engine::getSong();
+	if( song->isPlaying() || song->isExporting() ||
+		!m_playHandles.isEmpty() || m_newPlayHandles.first() ||
+		m_inputBufferFrames > 0 )
+	{
+		return false;
+	}
+
+	// effects may still be ringing out - the effect chains and the port
+	// list may be replaced meanwhile, so check them like the graph does
+	m_renderGracePeriod.enterPeriod();
+	bool running = Engine::mixer()->hasRunningEffects();
+	const AudioPortList & audioPorts = m_audioPorts.read();
+	for( AudioPortList::ConstIterator it = audioPorts.begin(); !running && it != audioPorts.end(); ++it )
+	{
+		running = ( *it )->effects() && ( *it )->effects()->hasRunningEffects();
+	}
+	m_renderGracePeriod.leavePeriod();
+
+	return !running;
 }
 
 
@@ -444,9 +730,13 @@ const surroundSampleFrame * AudioEngine::renderNextBuffer()
 
 void AudioEngine::swapBuffers()
 {
-	m_inputBufferWrite = (m_inputBufferWrite + 1) % 2;
-	m_inputBufferRead = (m_inputBufferRead + 1) % 2;
-	m_inputBufferFrames[m_inputBufferWrite] = 0;
+	// everything captured since the last period
+	auto input = m_inputReader.read_max( INPUT_RING_FRAMES );
+	m_inputBufferFrames = static_cast<f_cnt_t>( input.size() );
+	for( f_cnt_t i = 0; i < m_inputBufferFrames; ++i )
+	{
+		m_inputBuffer[i] = input[i];
+	}
 
 	std::swap(m_outputBufferRead, m_outputBufferWrite);
 	BufferManager::clear(m_outputBufferWrite, m_framesPerPeriod);
@@ -455,6 +745,91 @@ void AudioEngine::swapBuffers()
 
 
 
+void AudioEngine::processMidiEvents()
+{
+	// what was received during the last period is played during this one,
+	// at the same distance from its start - a constant latency of one
+	// period instead of snapping every event to the start of a period
+	const qint64 lastPeriodStart = m_lastPeriodStart;
+	m_lastPeriodStart = m_profiler.periodStart();
+
+	QueuedMidiElement * e = m_midiEvents.popList();
+	if( e == nullptr )
+	{
+		return;
+	}
+	for( ; e; )
+	{
+		m_dueMidiEvents.push_back( e->value );
+		QueuedMidiElement * next = e->next;
+		m_midiEvents.free( e );
+		e = next;
+	}
+
+	// the list is newest first, and the events of different clients may
+	// be out of order - sort them without reordering events received at
+	// the same time, e.g. a note off and the note on following it
+	std::reverse( m_dueMidiEvents.begin(), m_dueMidiEvents.end() );
+	for( auto it = m_dueMidiEvents.begin(); it != m_dueMidiEvents.end(); ++it )
+	{
+		auto pos = std::upper_bound( m_dueMidiEvents.begin(), it, *it,
+			[]( const QueuedMidiEvent & a, const QueuedMidiEvent & b )
+			{
+				return a.timestamp < b.timestamp;
+			} );
+		std::rotate( pos, it, it + 1 );
+	}
+
+	const double framesPerMicrosecond = processingSampleRate() / 1e6;
+	for( const QueuedMidiEvent & queued : m_dueMidiEvents )
+	{
+		const f_cnt_t offset = qBound<f_cnt_t>( 0, static_cast<f_cnt_t>(
+			( queued.timestamp - lastPeriodStart ) * framesPerMicrosecond ),
+			m_framesPerPeriod - 1 );
+		queued.port->dispatchInEvent( queued.event, queued.time, offset );
+	}
+	m_dueMidiEvents.clear();
+}
+
+
+
+
+void AudioEngine::sendMidiOutEvents()
+{
+	if( m_midiClient == nullptr )
+	{
+		return;
+	}
+
+	for( MidiOutElement * e = m_midiOutEvents.popList(); e; )
+	{
+		m_dueMidiOutEvents.push_back( e->value );
+		MidiOutElement * next = e->next;
+		m_midiOutEvents.free( e );
+		e = next;
+	}
+
+	// the list is newest first - sort the events by their offsets without
+	// reordering the ones at the same offset, e.g. a note off and the note
+	// on following it
+	std::reverse( m_dueMidiOutEvents.begin(), m_dueMidiOutEvents.end() );
+	for( auto it = m_dueMidiOutEvents.begin(); it != m_dueMidiOutEvents.end(); ++it )
+	{
+		auto pos = std::upper_bound( m_dueMidiOutEvents.begin(), it, *it,
+			[]( const MidiOutEvent & a, const MidiOutEvent & b )
+			{
+				return a.offset < b.offset;
+			} );
+		std::rotate( pos, it, it + 1 );
+	}
+
+	m_midiClient->processOutEvents( m_dueMidiOutEvents.data(), m_dueMidiOutEvents.size(), m_framesPerPeriod );
+	m_dueMidiOutEvents.clear();
+}
+
+
+
+
 void AudioEngine::handleMetronome()
 {
 	static tick_t lastMetroTicks = -1;
@@ -487,13 +862,16 @@ void AudioEngine::handleMetronome()
 		return;
 	}
 
-	if (ticks % (ticksPerBar / 1) == 0)
-	{
-		addPlayHandle(new SamplePlayHandle("misc/metronome02.ogg"));
-	}
-	else if (ticks % (ticksPerBar / numerator) == 0)
+	const bool strong = ticks % ticksPerBar == 0;
+	if (m_metronome && (strong || ticks % (ticksPerBar / numerator) == 0))
 	{
-		addPlayHandle(new SamplePlayHandle("misc/metronome01.ogg"));
+		// the handle may still be playing the previous click
+		SamplePlayHandle * handle = m_metronome->click(strong);
+		if (handle->m_engineIndex < 0)
+		{
+			handle->audioPort()->addPlayHandle(handle);
+			appendPlayHandle(handle);
+		}
 	}
 
 	lastMetroTicks = ticks;
@@ -515,6 +893,7 @@ void AudioEngine::clearNewPlayHandles()
 	for( LocklessListElement * e = m_newPlayHandles.popList(); e; )
 	{
 		LocklessListElement * next = e->next;
+		e->value->m_queued = false;
 		m_newPlayHandles.free( e );
 		e = next;
 	}
@@ -530,9 +909,11 @@ void AudioEngine::clearInternal()
 	// TODO: m_midiClient->noteOffAll();
 	for (auto ph : m_playHandles)
 	{
-		if (ph->type() != PlayHandle::TypeInstrumentPlayHandle)
+		// these belong to their track rather than to what is playing
+		if (ph->type() != PlayHandle::TypeInstrumentPlayHandle &&
+			ph->type() != PlayHandle::TypeFrozenTrackHandle)
 		{
-			m_playHandlesToRemove.push_back(ph);
+			requestPlayHandleRemoval(ph);
 		}
 	}
 }
@@ -542,25 +923,8 @@ void AudioEngine::clearInternal()
 
 AudioEngine::StereoSample AudioEngine::getPeakValues(sampleFrame * ab, const f_cnt_t frames) const
 {
-	sample_t peakLeft = 0.0f;
-	sample_t peakRight = 0.0f;
-
-	for (f_cnt_t f = 0; f < frames; ++f)
-	{
-		float const absLeft = qAbs(ab[f][0]);
-		float const absRight = qAbs(ab[f][1]);
-		if (absLeft > peakLeft)
-		{
-			peakLeft = absLeft;
-		}
-
-		if (absRight > peakRight)
-		{
-			peakRight = absRight;
-		}
-	}
-
-	return StereoSample(peakLeft, peakRight);
+	const sampleFrame peak = MixHelpers::peak(ab, frames);
+	return StereoSample(peak[0], peak[1]);
 }
 
 
@@ -657,31 +1021,48 @@ void AudioEngine::restoreAudioDevice()
 
 void AudioEngine::removeAudioPort(AudioPort * port)
 {
-	requestChangeInModel();
+	bool removed = false;
+	m_audioPorts.update([port, &removed](AudioPortList & ports) {
+		AudioPortList::Iterator it = std::find(ports.begin(), ports.end(), port);
+		if (it != ports.end())
+		{
+			ports.erase(it);
+			removed = true;
+		}
+	}, m_renderGracePeriod);
 
-	QVector<AudioPort *>::Iterator it = std::find(m_audioPorts.begin(), m_audioPorts.end(), port);
-	if (it != m_audioPorts.end())
+	if (removed)
 	{
-		m_audioPorts.erase(it);
+		m_audioPorts.synchronize(m_renderGracePeriod);
 	}
-	doneChangeInModel();
 }
 
 
 bool AudioEngine::addPlayHandle( PlayHandle* handle )
 {
-	if( criticalXRuns() == false )
+	// NotePlayHandleManager::acquire() fails if its pool ran dry
+	if( handle == nullptr )
+	{
+		return false;
+	}
+
+	// set before the audio thread may take it from the list
+	handle->m_queued = true;
+	if( criticalXRuns() == false && m_newPlayHandles.push( handle ) )
 	{
-		m_newPlayHandles.push( handle );
 		handle->audioPort()->addPlayHandle( handle );
 		return true;
 	}
+	handle->m_queued = false;
 
 	if( handle->type() == PlayHandle::TypeNotePlayHandle )
 	{
 		NotePlayHandleManager::release( (NotePlayHandle*)handle );
 	}
-	else delete handle;
+	else if( !handle->isRecycled() )
+	{
+		delete handle;
+	}
 
 	return false;
 }
@@ -695,32 +1076,12 @@ void AudioEngine::removePlayHandle(PlayHandle * ph)
 	if (ph->affinityMatters() && ph->affinity() == QThread::currentThread())
 	{
 		ph->audioPort()->removePlayHandle(ph);
-		bool removedFromList = false;
 		// Check m_newPlayHandles first because doing it the other way around
 		// creates a race condition
-		for( LocklessListElement * e = m_newPlayHandles.first(),
-				* ePrev = nullptr; e; ePrev = e, e = e->next )
-		{
-			if (e->value == ph)
-			{
-				if( ePrev )
-				{
-					ePrev->next = e->next;
-				}
-				else
-				{
-					m_newPlayHandles.setFirst( e->next );
-				}
-				m_newPlayHandles.free( e );
-				removedFromList = true;
-				break;
-			}
-		}
+		bool removedFromList = takeNewPlayHandle(ph);
 		// Now check m_playHandles
-		PlayHandleList::Iterator it = std::find(m_playHandles.begin(), m_playHandles.end(), ph);
-		if (it != m_playHandles.end())
+		if (takePlayHandle(ph))
 		{
-			m_playHandles.erase(it);
 			removedFromList = true;
 		}
 		// Only deleting PlayHandles that were actually found in the list
@@ -728,16 +1089,12 @@ void AudioEngine::removePlayHandle(PlayHandle * ph)
 		// (See tobydox's 2008 commit 4583e48)
 		if ( removedFromList )
 		{
-			if (ph->type() == PlayHandle::TypeNotePlayHandle)
-			{
-				NotePlayHandleManager::release(dynamic_cast<NotePlayHandle*>(ph));
-			}
-			else { delete ph; }
+			deletePlayHandle(ph);
 		}
 	}
 	else
 	{
-		m_playHandlesToRemove.push_back(ph);
+		requestPlayHandleRemoval(ph);
 	}
 	doneChangeInModel();
 }
@@ -745,25 +1102,39 @@ void AudioEngine::removePlayHandle(PlayHandle * ph)
 
 
 
+void AudioEngine::dropPlayHandle( PlayHandle * handle )
+{
+	takeNewPlayHandle( handle );
+	takePlayHandle( handle );
+	if( handle->m_removalRequested )
+	{
+		handle->m_removalRequested = false;
+		m_playHandlesToRemove.removeOne( handle );
+	}
+	if( handle->audioPort() )
+	{
+		handle->audioPort()->removePlayHandle( handle );
+	}
+}
+
+
+
+
 void AudioEngine::removePlayHandlesOfTypes(Track * track, const quint8 types)
 {
 	requestChangeInModel();
-	PlayHandleList::Iterator it = m_playHandles.begin();
-	while( it != m_playHandles.end() )
+	for( int i = 0; i < m_playHandles.size(); )
 	{
-		if ((*it)->isFromTrack(track) && ((*it)->type() & types))
+		PlayHandle * ph = m_playHandles[i];
+		if (ph->isFromTrack(track) && (ph->type() & types))
 		{
-			( *it )->audioPort()->removePlayHandle( ( *it ) );
-			if( ( *it )->type() == PlayHandle::TypeNotePlayHandle )
-			{
-				NotePlayHandleManager::release( (NotePlayHandle*) *it );
-			}
-			else delete *it;
-			it = m_playHandles.erase( it );
+			// the last handle takes the place of the removed one
+			takePlayHandle( ph );
+			deletePlayHandle( ph );
 		}
 		else
 		{
-			++it;
+			++i;
 		}
 	}
 	doneChangeInModel();
@@ -772,6 +1143,143 @@ void AudioEngine::removePlayHandlesOfTypes(Track * track, const quint8 types)
 
 
 
+void AudioEngine::appendPlayHandle( PlayHandle * handle )
+{
+	handle->m_queued = false;
+	handle->m_engineIndex = m_playHandles.size();
+	m_playHandles.append( handle );
+}
+
+
+
+
+bool AudioEngine::takePlayHandle( PlayHandle * handle )
+{
+	const int index = handle->m_engineIndex;
+	if( index < 0 || index >= m_playHandles.size() || m_playHandles[index] != handle )
+	{
+		return false;
+	}
+
+	// order doesn't matter, so move the last handle into the gap
+	PlayHandle * last = m_playHandles.last();
+	m_playHandles[index] = last;
+	last->m_engineIndex = index;
+	m_playHandles.removeLast();
+	handle->m_engineIndex = -1;
+	return true;
+}
+
+
+
+
+bool AudioEngine::takeNewPlayHandle( PlayHandle * handle )
+{
+	if( !handle->m_queued )
+	{
+		return false;
+	}
+
+	for( LocklessListElement * e = m_newPlayHandles.first(),
+			* ePrev = nullptr; e; ePrev = e, e = e->next )
+	{
+		if( e->value == handle )
+		{
+			if( ePrev )
+			{
+				ePrev->next = e->next;
+			}
+			else
+			{
+				m_newPlayHandles.setFirst( e->next );
+			}
+			m_newPlayHandles.free( e );
+			handle->m_queued = false;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+bool AudioEngine::batchPlayHandle( PlayHandle * handle )
+{
+	// handles which weren't measured yet get a job of their own, like
+	// expensive ones
+	AudioPort * port = handle->audioPort();
+	if( port == nullptr || handle->cost() < 0 ||
+		handle->cost() > PlayHandleBatch::MaxHandleCost ||
+		!handle->requiresProcessing() )
+	{
+		return false;
+	}
+
+	PlayHandleBatch * batch = port->m_playHandleBatch;
+	if( batch == nullptr )
+	{
+		if( m_usedPlayHandleBatches == m_playHandleBatches.size() )
+		{
+			return false;
+		}
+		batch = m_playHandleBatches[m_usedPlayHandleBatches++].get();
+		port->m_playHandleBatch = batch;
+	}
+
+	batch->add( handle );
+	if( batch->isFull() )
+	{
+		// the next cheap handle of the port starts another batch
+		port->m_playHandleBatch = nullptr;
+		AudioEngineWorkerThread::addJob( batch );
+	}
+	return true;
+}
+
+
+
+
+
+void AudioEngine::deletePlayHandle( PlayHandle * handle )
+{
+	if( handle->m_removalRequested )
+	{
+		m_playHandlesToRemove.removeOne( handle );
+	}
+	if( handle->audioPort() )
+	{
+		handle->audioPort()->removePlayHandle( handle );
+	}
+	if( handle->type() == PlayHandle::TypeNotePlayHandle )
+	{
+		NotePlayHandleManager::release( static_cast<NotePlayHandle*>( handle ) );
+	}
+	else if( handle->isRecycled() )
+	{
+		// its owner plays it again
+	}
+	else
+	{
+		delete handle;
+	}
+}
+
+
+
+
+void AudioEngine::requestPlayHandleRemoval( PlayHandle * handle )
+{
+	// the handle gets removed at the beginning of the next period
+	if( !handle->m_removalRequested )
+	{
+		handle->m_removalRequested = true;
+		m_playHandlesToRemove.push_back( handle );
+	}
+}
+
+
+
+
 void AudioEngine::requestChangeInModel()
 {
 	if( s_renderingThread )
@@ -1254,33 +1762,53 @@ void AudioEngine::fifoWriter::run()
 #endif
 #endif
 
+	// the engine mixes right into the FIFO - the buffer it mixes into
+	// becomes the one it returns with the next period, see swapBuffers()
+	surroundSampleFrame * const ownRead = m_audioEngine->m_outputBufferRead;
+	surroundSampleFrame * const ownWrite = m_audioEngine->m_outputBufferWrite;
 	const fpp_t frames = m_audioEngine->framesPerPeriod();
+	m_audioEngine->m_outputBufferWrite = take();
+	BufferManager::clear( m_audioEngine->m_outputBufferWrite, frames );
 	while( m_writing )
 	{
-		surroundSampleFrame * buffer = new surroundSampleFrame[frames];
-		const surroundSampleFrame * b = m_audioEngine->renderNextBuffer();
-		memcpy( buffer, b, frames * sizeof( surroundSampleFrame ) );
-		write( buffer );
+		m_audioEngine->m_outputBufferRead = take();
+		m_audioEngine->renderNextBuffer();
+		m_fifo->write();
+
+		if( LatencyGovernor * governor = m_audioEngine->m_latencyGovernor.get() )
+		{
+			const AudioEngineProfiler & profiler = m_audioEngine->profiler();
+			m_fifo->setDepth( governor->update( profiler.cpuLoad(),
+				profiler.deadlineMisses() + profiler.totalDeviceXruns(), profiler.deadline() ) );
+		}
 	}
 
+	// the period being mixed into is dropped
+	m_audioEngine->m_outputBufferRead = ownRead;
+	m_audioEngine->m_outputBufferWrite = ownWrite;
+	BufferManager::clear( ownRead, frames );
+	BufferManager::clear( ownWrite, frames );
+
 	// Let audio backend stop processing
-	write( nullptr );
+	m_fifo->writeEnd();
 	m_fifo->waitUntilRead();
 }
 
 
 
 
-void AudioEngine::fifoWriter::write( surroundSampleFrame * buffer )
+surroundSampleFrame * AudioEngine::fifoWriter::take()
 {
 	m_audioEngine->m_waitChangesMutex.lock();
 	m_audioEngine->m_waitingForWrite = true;
 	m_audioEngine->m_waitChangesMutex.unlock();
 	m_audioEngine->runChangesInModel();
 
-	m_fifo->write( buffer );
+	surroundSampleFrame * buffer = m_fifo->take();
 
 	m_audioEngine->m_doChangesMutex.lock();
 	m_audioEngine->m_waitingForWrite = false;
 	m_audioEngine->m_doChangesMutex.unlock();
+
+	return buffer;
 }
@@ -24,31 +24,192 @@
 
 #include "AudioEngineProfiler.h"
 
+#include <QDateTime>
+#include <QDebug>
+#include <QThread>
+
+#include <algorithm>
+#include <chrono>
+
+#include "RealtimeChecker.h"
+#include "ThreadableJob.h"
+
+
+static const auto s_profilerEpoch = std::chrono::steady_clock::now();
+
+// the denormal watch compares the times of quiet periods, below -100 dBFS,
+// with the ones of loud periods, above -60 dBFS
+static const float DenormalQuietPeak = 1e-5f;
+static const float DenormalLoudPeak = 1e-3f;
+static const float DenormalSpikeRatio = 4.0f;
+// scheduling hiccups shouldn't count for short jobs
+static const qint64 DenormalMinSpike = 20000;
+static const int DenormalMinLoudPeriods = 16;
+static const int DenormalReportSpikes = 8;
+static const size_t MaxLevelRecords = 1024;
+
+
+class AudioEngineProfiler::DrainThread : public QThread
+{
+public:
+	DrainThread( AudioEngineProfiler * profiler ) :
+		m_profiler( profiler )
+	{
+	}
+
+	void stop()
+	{
+		m_quit = true;
+		wait();
+	}
+
+protected:
+	void run() override
+	{
+		while( !m_quit )
+		{
+			m_profiler->drainTraces();
+			m_profiler->drainPeriods();
+			msleep( 20 );
+		}
+	}
+
+private:
+	AudioEngineProfiler * m_profiler;
+	std::atomic_bool m_quit{ false };
+};
+
 
 AudioEngineProfiler::AudioEngineProfiler() :
 	m_periodTimer(),
 	m_cpuLoad( 0 ),
-	m_outputFile()
+	m_outputFile(),
+	m_periodStart( 0 ),
+	m_stageStart( 0 ),
+	m_periodTime( 0 ),
+	m_jobTracingEnabled( false ),
+	m_jobLoadEnabled( false ),
+	m_jobRecords(),
+	m_droppedJobs( 0 ),
+	m_traceRing( nullptr ),
+	m_periodRing( nullptr ),
+	m_drainThread(),
+	m_periodName( "Period" ),
+	m_traceEvents(),
+	m_traceMutex(),
+	m_outputMutex(),
+	m_jobCostsEnabled( false ),
+	m_jobCosts(),
+	m_periodJobCount( 0 ),
+	m_deadline( 0 ),
+	m_deviceXruns( 0 ),
+	m_totalDeviceXruns( 0 ),
+	m_deadlineMisses( 0 ),
+	m_glitches(),
+	m_nextGlitch( 0 ),
+	m_glitchMutex(),
+	m_glitchLogFile(),
+	m_denormalWatchEnabled( false ),
+	m_jobLevels(),
+	m_levelStats(),
+	m_levelMutex(),
+	m_periodJobQueueDepth( 0 ),
+	m_jobQueueDepth( 0 ),
+	m_maxJobQueueDepth( 0 ),
+	m_jobQueueGrowths( 0 )
 {
+	for( auto & skipped : m_skippedWork )
+	{
+		skipped = 0;
+	}
+	m_periodStageTimes.fill( 0 );
+	m_stageTimes.fill( 0 );
+	// no allocations while recording
+	m_glitches.reserve( MaxGlitches );
 }
 
 
 
 AudioEngineProfiler::~AudioEngineProfiler()
 {
+	if( m_drainThread )
+	{
+		m_drainThread->stop();
+	}
+	drainPeriods();
+	delete m_traceRing.load();
+	delete m_periodRing.load();
+
+	if( !m_glitchLogFile.isEmpty() )
+	{
+		writeGlitchLog( m_glitchLogFile );
+	}
 }
 
 
-void AudioEngineProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPeriod )
+void AudioEngineProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPerPeriod, bool realtime )
 {
 	int periodElapsed = m_periodTimer.elapsed();
+	m_periodTime = now() - m_periodStart;
+	m_stageTimes = m_periodStageTimes;
 
 	const float newCpuLoad = periodElapsed / 10000.0f * sampleRate / framesPerPeriod;
     m_cpuLoad = qBound<int>( 0, ( newCpuLoad * 0.1f + m_cpuLoad * 0.9f ), 100 );
 
-	if( m_outputFile.isOpen() )
+	m_jobQueueDepth.store( m_periodJobQueueDepth, std::memory_order_relaxed );
+	if( m_periodJobQueueDepth > m_maxJobQueueDepth.load( std::memory_order_relaxed ) )
+	{
+		m_maxJobQueueDepth.store( m_periodJobQueueDepth, std::memory_order_relaxed );
+	}
+	m_periodJobQueueDepth = 0;
+
+	m_deadline = 1000000LL * framesPerPeriod / sampleRate;
+	const int xruns = m_deviceXruns.exchange( 0, std::memory_order_relaxed );
+	m_totalDeviceXruns.fetch_add( xruns, std::memory_order_relaxed );
+	const bool missed = m_periodTime > m_deadline;
+	if( realtime && missed )
+	{
+		m_deadlineMisses.fetch_add( 1, std::memory_order_relaxed );
+	}
+	// a glitch isn't worth blocking the audio thread for
+	if( realtime && ( missed || xruns > 0 ) && m_glitchMutex.tryLock() )
+	{
+		Glitch glitch;
+		glitch.time = QDateTime::currentMSecsSinceEpoch();
+		glitch.periodTime = m_periodTime;
+		glitch.deadline = m_deadline;
+		glitch.xruns = xruns;
+		glitch.jobCount = m_periodJobCount;
+		for( int i = 0; i < m_periodJobCount; ++i )
+		{
+			glitch.jobNames[i] = m_periodJobNames[i];
+			glitch.jobTimes[i] = m_periodJobTimes[i];
+		}
+		if( m_glitches.size() < MaxGlitches )
+		{
+			m_glitches.push_back( glitch );
+		}
+		else
+		{
+			m_glitches[m_nextGlitch] = glitch;
+			m_nextGlitch = ( m_nextGlitch + 1 ) % MaxGlitches;
+		}
+		m_glitchMutex.unlock();
+	}
+	m_periodJobCount = 0;
+
+	// the file gets written by the drain thread
+	PeriodRing * periods = m_periodRing.load( std::memory_order_acquire );
+	if( periods )
+	{
+		periods->push( periodElapsed );
+	}
+
+	TraceRing * trace = m_traceRing.load( std::memory_order_acquire );
+	if( trace && jobTracingEnabled() &&
+		!trace->push( { { nullptr, m_periodName }, 0, m_periodStart, now() - m_periodStart } ) )
 	{
-		m_outputFile.write( QString( "%1\n" ).arg( periodElapsed ).toLatin1() );
+		++m_droppedJobs;
 	}
 }
 
@@ -56,8 +217,471 @@ void AudioEngineProfiler::finishPeriod( sample_rate_t sampleRate, fpp_t framesPe
 
 void AudioEngineProfiler::setOutputFile( const QString& outputFile )
 {
-	m_outputFile.close();
-	m_outputFile.setFileName( outputFile );
-	m_outputFile.open( QFile::WriteOnly | QFile::Truncate );
+	{
+		QMutexLocker lock( &m_outputMutex );
+		m_outputFile.close();
+		m_outputFile.setFileName( outputFile );
+		m_outputFile.open( QFile::WriteOnly | QFile::Truncate );
+	}
+	if( m_periodRing.load() == nullptr )
+	{
+		m_periodRing.store( new PeriodRing, std::memory_order_release );
+	}
+	startDrainThread();
+}
+
+
+
+
+void AudioEngineProfiler::startDrainThread()
+{
+	if( !m_drainThread )
+	{
+		m_drainThread.reset( new DrainThread( this ) );
+		m_drainThread->start( QThread::LowPriority );
+	}
+}
+
+
+
+
+void AudioEngineProfiler::drainTraces()
+{
+	TraceRing * trace = m_traceRing.load( std::memory_order_acquire );
+	if( trace == nullptr )
+	{
+		return;
+	}
+	QMutexLocker lock( &m_traceMutex );
+	trace->drain( [this]( TraceEvent & e )
+	{
+		if( m_traceEvents.size() < MaxTraceEvents )
+		{
+			m_traceEvents.push_back( std::move( e ) );
+		}
+		else
+		{
+			++m_droppedJobs;
+		}
+	} );
+}
+
+
+
+
+void AudioEngineProfiler::drainPeriods()
+{
+	PeriodRing * periods = m_periodRing.load( std::memory_order_acquire );
+	if( periods == nullptr )
+	{
+		return;
+	}
+	QMutexLocker lock( &m_outputMutex );
+	periods->drain( [this]( int elapsed )
+	{
+		if( m_outputFile.isOpen() )
+		{
+			m_outputFile.write( QString( "%1\n" ).arg( elapsed ).toLatin1() );
+		}
+	} );
+}
+
+
+
+
+void AudioEngineProfiler::setThreadCount( int threads )
+{
+	// must only be called while no worker thread is running
+	while( static_cast<int>( m_jobRecords.size() ) < threads )
+	{
+		m_jobRecords.emplace_back( new JobRecordRing );
+	}
+	if( static_cast<int>( m_jobCosts.size() ) < threads )
+	{
+		m_jobCosts.resize( threads );
+	}
+	while( static_cast<int>( m_jobLevels.size() ) < threads )
+	{
+		m_jobLevels.emplace_back();
+		m_jobLevels.back().reserve( MaxLevelRecords );
+	}
+}
+
+
+
+
+void AudioEngineProfiler::setJobTracingEnabled( bool enabled )
+{
+	if( enabled )
+	{
+		// allocated here, the audio engine thread only pushes into it
+		if( m_traceRing.load() == nullptr )
+		{
+			m_traceRing.store( new TraceRing, std::memory_order_release );
+		}
+		startDrainThread();
+	}
+	m_jobTracingEnabled = enabled;
+}
+
+
+
+
+qint64 AudioEngineProfiler::now()
+{
+	using namespace std::chrono;
+	return duration_cast<microseconds>( steady_clock::now() - s_profilerEpoch ).count();
+}
+
+
+
+
+void AudioEngineProfiler::recordJob( int thread, const ThreadableJob * job, qint64 start, qint64 end )
+{
+	if( thread < 0 || thread >= static_cast<int>( m_jobRecords.size() ) )
+	{
+		return;
+	}
+
+	JobRecordRing & ring = *m_jobRecords[thread];
+	const size_t written = ring.written.load( std::memory_order_relaxed );
+	// the consumer only runs between periods, so this is a good enough
+	// approximation of its read position
+	if( written - ring.read >= JobRecordRing::Size )
+	{
+		++m_droppedJobs;
+		return;
+	}
+	ring.records[written % JobRecordRing::Size] = { job, start, end };
+	ring.written.store( written + 1, std::memory_order_release );
+}
+
+
+
+
+void AudioEngineProfiler::recordJobCost( int thread, const ThreadableJob * job, qint64 nanoseconds )
+{
+	if( thread >= 0 && thread < static_cast<int>( m_jobCosts.size() ) )
+	{
+		m_jobCosts[thread].insert( job, nanoseconds );
+	}
+}
+
+
+
+
+void AudioEngineProfiler::collectJobCosts()
+{
+	JobCosts top;
+	for( JobCosts & costs : m_jobCosts )
+	{
+		for( int i = 0; i < costs.count; ++i )
+		{
+			top.insert( costs.costs[i].job, costs.costs[i].nanoseconds );
+		}
+		costs.count = 0;
+	}
+
+	// the names are only needed if the period is going to be late, and
+	// resolving them takes time of its own
+	m_periodJobCount = 0;
+	if( top.count == 0 || now() - m_periodStart < m_deadline / 2 )
+	{
+		return;
+	}
+	RealtimeChecker::Suspend suspend;
+	for( int i = 0; i < top.count; ++i )
+	{
+		m_periodJobNames[i] = top.costs[i].job->jobName();
+		m_periodJobTimes[i] = top.costs[i].nanoseconds / 1000;
+	}
+	m_periodJobCount = top.count;
+}
+
+
+
+
+void AudioEngineProfiler::recordJobLevel( int thread, const ThreadableJob * job, qint64 nanoseconds )
+{
+	if( thread < 0 || thread >= static_cast<int>( m_jobLevels.size() ) )
+	{
+		return;
+	}
+	std::vector<LevelRecord> & levels = m_jobLevels[thread];
+	// no allocations here
+	if( levels.size() == levels.capacity() )
+	{
+		return;
+	}
+	const float peak = job->outputPeak();
+	if( peak >= 0.0f )
+	{
+		levels.push_back( { job, nanoseconds, peak } );
+	}
+}
+
+
+
+
+void AudioEngineProfiler::collectJobLevels()
+{
+	bool recorded = false;
+	for( const std::vector<LevelRecord> & levels : m_jobLevels )
+	{
+		recorded = recorded || !levels.empty();
+	}
+	if( !recorded )
+	{
+		return;
+	}
+
+	// if a reader has the stats, this period is left out
+	if( m_levelMutex.tryLock() )
+	{
+		RealtimeChecker::Suspend suspend;
+		for( const std::vector<LevelRecord> & levels : m_jobLevels )
+		{
+			for( const LevelRecord & r : levels )
+			{
+				LevelStats & stats = m_levelStats[r.job->jobName()];
+				if( r.peak >= DenormalLoudPeak )
+				{
+					stats.loudTime = stats.loudPeriods == 0 ? r.nanoseconds
+								: ( stats.loudTime * 15 + r.nanoseconds ) / 16;
+					++stats.loudPeriods;
+				}
+				else if( r.peak > 0.0f && r.peak < DenormalQuietPeak
+						&& stats.loudPeriods >= DenormalMinLoudPeriods
+						&& r.nanoseconds > DenormalSpikeRatio * stats.loudTime
+						&& r.nanoseconds - stats.loudTime > DenormalMinSpike )
+				{
+					const float ratio = static_cast<float>( r.nanoseconds ) / qMax<qint64>( stats.loudTime, 1 );
+					stats.worstRatio = qMax( stats.worstRatio, ratio );
+					if( ++stats.spikes == DenormalReportSpikes )
+					{
+						qWarning() << r.job->jobName() << "takes up to" << stats.worstRatio
+							<< "times as long while it is almost silent, it may be processing denormals";
+					}
+				}
+			}
+		}
+		m_levelMutex.unlock();
+	}
+
+	for( std::vector<LevelRecord> & levels : m_jobLevels )
+	{
+		levels.clear();
+	}
+}
+
+
+
+
+QVector<AudioEngineProfiler::DenormalSuspect> AudioEngineProfiler::denormalSuspects() const
+{
+	QVector<DenormalSuspect> suspects;
+	{
+		QMutexLocker lock( &m_levelMutex );
+		for( auto it = m_levelStats.begin(); it != m_levelStats.end(); ++it )
+		{
+			if( it->spikes >= DenormalReportSpikes )
+			{
+				suspects.push_back( { it.key(), it->spikes, it->worstRatio, it->loudTime / 1000 } );
+			}
+		}
+	}
+	std::sort( suspects.begin(), suspects.end(), []( const DenormalSuspect & a, const DenormalSuspect & b )
+	{
+		return a.spikes * a.worstRatio > b.spikes * b.worstRatio;
+	} );
+	return suspects;
+}
+
+
+
+
+void AudioEngineProfiler::collectJobTraces()
+{
+	collectJobCosts();
+	collectJobLevels();
+
+	// no records without a ring, see setJobTracingEnabled()
+	TraceRing * trace = m_traceRing.load( std::memory_order_acquire );
+	if( trace == nullptr )
+	{
+		return;
+	}
+
+	for( size_t t = 0; t < m_jobRecords.size(); ++t )
+	{
+		JobRecordRing & ring = *m_jobRecords[t];
+		const size_t written = ring.written.load( std::memory_order_acquire );
+		for( ; ring.read < written; ++ring.read )
+		{
+			const JobRecord & r = ring.records[ring.read % JobRecordRing::Size];
+			if( !trace->push( { r.job->jobLabel(), static_cast<int>( t ), r.start, r.end - r.start } ) )
+			{
+				++m_droppedJobs;
+			}
+		}
+	}
+}
+
+
+
+
+void AudioEngineProfiler::clearJobTrace()
+{
+	drainTraces();
+	QMutexLocker lock( &m_traceMutex );
+	m_traceEvents.clear();
+	m_droppedJobs = 0;
 }
 
+
+
+
+int AudioEngineProfiler::jobTraceSize() const
+{
+	const TraceRing * trace = m_traceRing.load( std::memory_order_acquire );
+	QMutexLocker lock( &m_traceMutex );
+	return m_traceEvents.size() + ( trace ? static_cast<int>( trace->size() ) : 0 );
+}
+
+
+
+
+static QByteArray jsonString( const QString & s )
+{
+	QByteArray out = "\"";
+	for( const char c : s.toUtf8() )
+	{
+		switch( c )
+		{
+			case '"': out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n"; break;
+			case '\t': out += "\\t"; break;
+			default:
+				if( static_cast<unsigned char>( c ) < 0x20 )
+				{
+					out += QString( "\\u%1" ).arg( static_cast<int>( c ), 4, 16, QChar( '0' ) ).toLatin1();
+				}
+				else
+				{
+					out += c;
+				}
+		}
+	}
+	return out + "\"";
+}
+
+
+
+
+bool AudioEngineProfiler::writeJobTrace( const QString & fileName )
+{
+	// don't block the drain thread while writing the file
+	drainTraces();
+	QVector<TraceEvent> events;
+	{
+		QMutexLocker lock( &m_traceMutex );
+		events.swap( m_traceEvents );
+	}
+
+	QFile file( fileName );
+	if( !file.open( QFile::WriteOnly | QFile::Truncate ) )
+	{
+		qWarning() << "Could not open" << fileName << "for writing the job trace";
+		return false;
+	}
+
+	if( m_droppedJobs > 0 )
+	{
+		qWarning() << "Job trace is incomplete," << m_droppedJobs << "jobs have been dropped";
+	}
+
+	file.write( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+	for( size_t t = 0; t < m_jobRecords.size(); ++t )
+	{
+		const QString threadName = t == 0 ? QString( "Audio engine" ) : QString( "Worker %1" ).arg( t );
+		file.write( QString( "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%1,\"args\":{\"name\":" )
+				.arg( t ).toLatin1() + jsonString( threadName ) + "}},\n" );
+	}
+	for( int i = 0; i < events.size(); ++i )
+	{
+		const TraceEvent & e = events[i];
+		const QString name = e.label.kind ? ThreadableJob::labelName( e.label ) : e.label.name;
+		file.write( "{\"name\":" + jsonString( name.isEmpty() ? QString( "Job" ) : name ) +
+				QString( ",\"ph\":\"X\",\"pid\":1,\"tid\":%1,\"ts\":%2,\"dur\":%3}" )
+					.arg( e.thread ).arg( e.start ).arg( e.duration ).toLatin1() +
+				( i + 1 < events.size() ? ",\n" : "\n" ) );
+	}
+	file.write( "]}\n" );
+
+	return true;
+}
+
+
+
+
+QVector<AudioEngineProfiler::Glitch> AudioEngineProfiler::glitches() const
+{
+	QMutexLocker lock( &m_glitchMutex );
+	QVector<Glitch> glitches;
+	glitches.reserve( m_glitches.size() );
+	for( int i = 0; i < m_glitches.size(); ++i )
+	{
+		glitches.push_back( m_glitches[( m_nextGlitch + i ) % m_glitches.size()] );
+	}
+	return glitches;
+}
+
+
+
+
+void AudioEngineProfiler::clearGlitches()
+{
+	QMutexLocker lock( &m_glitchMutex );
+	m_glitches.clear();
+	m_glitches.reserve( MaxGlitches );
+	m_nextGlitch = 0;
+	m_deadlineMisses = 0;
+	m_totalDeviceXruns = 0;
+}
+
+
+
+
+bool AudioEngineProfiler::writeGlitchLog( const QString & fileName ) const
+{
+	QFile file( fileName );
+	if( !file.open( QFile::WriteOnly | QFile::Truncate ) )
+	{
+		qWarning() << "Could not open" << fileName << "for writing the glitch log";
+		return false;
+	}
+
+	const QVector<Glitch> history = glitches();
+	file.write( QString( "{\"deadlineMisses\":%1,\"deviceXruns\":%2,\"glitches\":[\n" )
+			.arg( deadlineMisses() ).arg( totalDeviceXruns() ).toLatin1() );
+	for( int i = 0; i < history.size(); ++i )
+	{
+		const Glitch & g = history[i];
+		const QString time = QDateTime::fromMSecsSinceEpoch( g.time ).toString( "yyyy-MM-ddTHH:mm:ss.zzz" );
+		QByteArray jobs;
+		for( int j = 0; j < g.jobCount; ++j )
+		{
+			jobs += "{\"name\":" + jsonString( g.jobNames[j].isEmpty() ? QString( "Job" ) : g.jobNames[j] ) +
+				QString( ",\"time\":%1}" ).arg( g.jobTimes[j] ).toLatin1() +
+				( j + 1 < g.jobCount ? "," : "" );
+		}
+		file.write( "{\"time\":" + jsonString( time ) +
+				QString( ",\"periodTime\":%1,\"deadline\":%2,\"xruns\":%3,\"jobs\":[" )
+					.arg( g.periodTime ).arg( g.deadline ).arg( g.xruns ).toLatin1() +
+				jobs + ( i + 1 < history.size() ? "]},\n" : "]}\n" ) );
+	}
+	file.write( "]}\n" );
+
+	return true;
+}
@@ -28,22 +28,70 @@
 #include <QMutex>
 #include <QWaitCondition>
 
+#include <chrono>
+
 #include "denormals.h"
 #include "AudioEngine.h"
+#include "ConfigManager.h"
+#include "LoadMeter.h"
+#include "RealtimeChecker.h"
 #include "ThreadableJob.h"
 
 #if __SSE__
 #include <xmmintrin.h>
 #endif
 
+#ifdef LMMS_HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#ifdef LMMS_HAVE_SCHED_H
+#include <sched.h>
+#endif
+
+#ifdef LMMS_BUILD_WIN32
+#include <windows.h>
+#endif
+
 AudioEngineWorkerThread::JobQueue AudioEngineWorkerThread::globalJobQueue;
+QMutex * AudioEngineWorkerThread::queueReadyMutex = nullptr;
 QWaitCondition * AudioEngineWorkerThread::queueReadyWaitCond = nullptr;
 QList<AudioEngineWorkerThread *> AudioEngineWorkerThread::workerThreads;
+std::atomic_uint AudioEngineWorkerThread::jobsGeneration( 0 );
+std::atomic_int AudioEngineWorkerThread::sleepingWorkers( 0 );
+
+// index of the deque owned by the current thread - threads which are not
+// worker threads (i.e. the one calling startAndWaitForJobs()) use deque 0
+static thread_local int s_queueIndex = 0;
+
 
 // implementation of internal JobQueue
+AudioEngineWorkerThread::JobQueue::JobQueue() :
+	m_queues(),
+	m_itemsQueued( 0 ),
+	m_itemsDone( 0 ),
+	m_opMode( Static ),
+	m_profiler( nullptr )
+{
+	addThreadQueue();
+}
+
+
+
+
+int AudioEngineWorkerThread::JobQueue::addThreadQueue()
+{
+	// must only be called while no worker thread is running
+	m_queues.emplace_back( new Deque );
+	return static_cast<int>( m_queues.size() ) - 1;
+}
+
+
+
+
 void AudioEngineWorkerThread::JobQueue::reset( OperationMode _opMode )
 {
-	m_writeIndex = 0;
+	m_itemsQueued = 0;
 	m_itemsDone = 0;
 	m_opMode = _opMode;
 }
@@ -51,43 +99,139 @@ void AudioEngineWorkerThread::JobQueue::reset( OperationMode _opMode )
 
 
 
-void AudioEngineWorkerThread::JobQueue::addJob( ThreadableJob * _job )
+void AudioEngineWorkerThread::JobQueue::reserve( size_t jobs )
+{
+	// the workers only look at their deques, they don't push before the
+	// stage starts
+	for( const std::unique_ptr<Deque> & queue : m_queues )
+	{
+		queue->reserve( jobs );
+	}
+}
+
+
+
+
+bool AudioEngineWorkerThread::JobQueue::addJob( ThreadableJob * _job )
 {
 	if( _job->requiresProcessing() )
 	{
 		// update job state
 		_job->queue();
-		// actually queue the job via atomic operations
-		auto index = m_writeIndex++;
-		if (index < JOB_QUEUE_SIZE) {
-			m_items[index] = _job;
-		} else {
-			qWarning() << "Job queue is full!";
-			++m_itemsDone;
+		++m_itemsQueued;
+		// push onto the deque of the calling thread - idle threads will
+		// steal from there
+		Deque & queue = *m_queues[s_queueIndex];
+		const int growths = queue.growths();
+		queue.push( _job );
+		if( queue.growths() != growths && m_profiler )
+		{
+			m_profiler->countJobQueueGrowth();
 		}
+		return true;
 	}
+	return false;
 }
 
 
 
+
+ThreadableJob * AudioEngineWorkerThread::JobQueue::takeJob()
+{
+	const int numQueues = m_queues.size();
+	ThreadableJob * job = m_queues[s_queueIndex]->pop();
+	for( int i = 1; job == nullptr && i < numQueues; ++i )
+	{
+		// start with the neighbour so thieves spread over the deques
+		Deque & victim = *m_queues[( s_queueIndex + i ) % numQueues];
+		while( job == nullptr && !victim.empty() )
+		{
+			job = victim.steal();
+		}
+	}
+	return job;
+}
+
+
+
+
+bool AudioEngineWorkerThread::JobQueue::processNextJob()
+{
+	ThreadableJob * job = takeJob();
+	if( job )
+	{
+		RealtimeChecker::setCurrentJob( job );
+		RealtimeChecker::Scope realtime;
+		LoadMeter * meter = m_profiler && m_profiler->jobLoadEnabled() ? job->loadMeter() : nullptr;
+		const bool costs = m_profiler && m_profiler->jobCostsEnabled();
+		const bool levels = m_profiler && m_profiler->denormalWatchEnabled();
+		if( m_profiler && m_profiler->jobTracingEnabled() )
+		{
+			const qint64 start = AudioEngineProfiler::now();
+			job->process();
+			const qint64 end = AudioEngineProfiler::now();
+			m_profiler->recordJob( s_queueIndex, job, start, end );
+			if( meter )
+			{
+				meter->add( ( end - start ) * 1000 );
+			}
+			if( costs )
+			{
+				m_profiler->recordJobCost( s_queueIndex, job, ( end - start ) * 1000 );
+			}
+			if( levels )
+			{
+				m_profiler->recordJobLevel( s_queueIndex, job, ( end - start ) * 1000 );
+			}
+		}
+		else if( meter || costs || levels )
+		{
+			const qint64 start = LoadMeter::now();
+			job->process();
+			const qint64 time = LoadMeter::now() - start;
+			if( meter )
+			{
+				meter->add( time );
+			}
+			if( costs )
+			{
+				m_profiler->recordJobCost( s_queueIndex, job, time );
+			}
+			if( levels )
+			{
+				m_profiler->recordJobLevel( s_queueIndex, job, time );
+			}
+		}
+		else
+		{
+			job->process();
+		}
+		RealtimeChecker::setCurrentJob( nullptr );
+		++m_itemsDone;
+		return true;
+	}
+	return false;
+}
+
+
+
+
 void AudioEngineWorkerThread::JobQueue::run()
 {
-	bool processedJob = true;
-	while (processedJob && m_itemsDone < m_writeIndex)
+	while( m_itemsDone < m_itemsQueued )
 	{
-		processedJob = false;
-		for( int i = 0; i < m_writeIndex && i < JOB_QUEUE_SIZE; ++i )
+		if( !processNextJob() )
 		{
-			ThreadableJob * job = m_items[i].exchange(nullptr);
-			if( job )
+			// in static mode all remaining jobs are already being
+			// processed by other threads
+			if( m_opMode == Static )
 			{
-				job->process();
-				processedJob = true;
-				++m_itemsDone;
+				break;
 			}
+#ifdef __SSE__
+			_mm_pause();
+#endif
 		}
-		// always exit loop if we're not in dynamic mode
-		processedJob = processedJob && ( m_opMode == Dynamic );
 	}
 }
 
@@ -96,11 +240,20 @@ void AudioEngineWorkerThread::JobQueue::run()
 
 void AudioEngineWorkerThread::JobQueue::wait()
 {
-	while (m_itemsDone < m_writeIndex)
+	// help out with pending jobs instead of just spinning
+	while( m_itemsDone < m_itemsQueued )
 	{
+		if( !processNextJob() )
+		{
 #ifdef __SSE__
-		_mm_pause();
+			_mm_pause();
 #endif
+		}
+	}
+
+	if( m_profiler )
+	{
+		m_profiler->recordJobQueueDepth( m_itemsQueued );
 	}
 }
 
@@ -112,11 +265,19 @@ void AudioEngineWorkerThread::JobQueue::wait()
 
 AudioEngineWorkerThread::AudioEngineWorkerThread( AudioEngine* audioEngine ) :
 	QThread( audioEngine ),
-	m_quit( false )
+	m_quit( false ),
+	m_queueIndex( globalJobQueue.addThreadQueue() ),
+	m_spinTime( qBound( 0, ConfigManager::inst()->value( "audioengine", "workerspintime",
+				QString::number( DEFAULT_SPIN_TIME ) ).toInt(), MAX_SPIN_TIME ) ),
+	m_pinToCpu( ConfigManager::inst()->value( "audioengine", "workeraffinity" ).toInt() ),
+	m_realtimePriority( ConfigManager::inst()->value( "audioengine", "workerrealtime" ).toInt() )
 {
+	globalJobQueue.setProfiler( &audioEngine->profiler() );
+
 	// initialize global static data
 	if( queueReadyWaitCond == nullptr )
 	{
+		queueReadyMutex = new QMutex;
 		queueReadyWaitCond = new QWaitCondition;
 	}
 
@@ -150,7 +311,17 @@ void AudioEngineWorkerThread::quit()
 
 void AudioEngineWorkerThread::startAndWaitForJobs()
 {
-	queueReadyWaitCond->wakeAll();
+	// spinning workers see the new generation by themselves, only those
+	// that went to sleep have to be woken up. Both sides use sequentially
+	// consistent operations: either we see a worker going to sleep or it
+	// sees the new generation before it waits.
+	++jobsGeneration;
+	if( sleepingWorkers > 0 )
+	{
+		queueReadyMutex->lock();
+		queueReadyWaitCond->wakeAll();
+		queueReadyMutex->unlock();
+	}
 	// The last worker-thread is never started. Instead it's processed "inline"
 	// i.e. within the global AudioEngine thread. This way we can reduce latencies
 	// that otherwise would be caused by synchronizing with another thread.
@@ -166,13 +337,94 @@ void AudioEngineWorkerThread::run()
 	MemoryManager::ThreadGuard mmThreadGuard; Q_UNUSED(mmThreadGuard);
 	disable_denormals();
 
-	QMutex m;
+	s_queueIndex = m_queueIndex;
+	setupThread();
+
+	unsigned generation = jobsGeneration;
 	while( m_quit == false )
 	{
-		m.lock();
-		queueReadyWaitCond->wait( &m );
+		waitForJobs( generation );
+		generation = jobsGeneration;
+		// in case a plugin of the last period changed it
+		disable_denormals();
 		globalJobQueue.run();
-		m.unlock();
+	}
+}
+
+
+
+
+void AudioEngineWorkerThread::waitForJobs( unsigned generation )
+{
+	using Clock = std::chrono::steady_clock;
+
+	// a short spin catches the next stage of the same period, which
+	// usually follows within microseconds
+	const Clock::time_point spinEnd = Clock::now() + std::chrono::microseconds( m_spinTime );
+	while( jobsGeneration == generation && Clock::now() < spinEnd )
+	{
+#ifdef __SSE__
+		_mm_pause();
+		_mm_pause();
+		_mm_pause();
+		_mm_pause();
+#endif
+	}
+
+	if( jobsGeneration != generation )
+	{
+		return;
+	}
+
+	queueReadyMutex->lock();
+	++sleepingWorkers;
+	while( jobsGeneration == generation )
+	{
+		queueReadyWaitCond->wait( queueReadyMutex );
+	}
+	--sleepingWorkers;
+	queueReadyMutex->unlock();
+}
+
+
+
+
+void AudioEngineWorkerThread::setupThread()
+{
+	if( m_pinToCpu )
+	{
+		// the engine thread isn't under our control, so spread the
+		// workers over the cores starting with the second one
+		const int cpu = m_queueIndex % QThread::idealThreadCount();
+#if defined(LMMS_BUILD_LINUX) && defined(LMMS_HAVE_PTHREAD_H)
+		cpu_set_t mask;
+		CPU_ZERO( &mask );
+		CPU_SET( cpu, &mask );
+		if( pthread_setaffinity_np( pthread_self(), sizeof( mask ), &mask ) != 0 )
+		{
+			qWarning( "Could not pin worker thread to CPU %d", cpu );
+		}
+#elif defined(LMMS_BUILD_WIN32)
+		if( !SetThreadAffinityMask( GetCurrentThread(), DWORD_PTR( 1 ) << cpu ) )
+		{
+			qWarning( "Could not pin worker thread to CPU %d", cpu );
+		}
+#endif
+	}
+
+	if( m_realtimePriority )
+	{
+#if defined(LMMS_HAVE_PTHREAD_H) && defined(LMMS_HAVE_SCHED_H) && !defined(__OpenBSD__)
+		struct sched_param sparam;
+		sparam.sched_priority = ( sched_get_priority_max( SCHED_FIFO ) +
+					sched_get_priority_min( SCHED_FIFO ) ) / 2;
+		if( pthread_setschedparam( pthread_self(), SCHED_FIFO, &sparam ) != 0 )
+		{
+			qWarning( "Could not set realtime priority for worker thread" );
+		}
+#endif
+		// on Windows, TimeCriticalPriority is already the highest priority
+		// available without a realtime priority class
 	}
 }
 
@@ -0,0 +1,200 @@
+/*
+ * AutoSaver.cpp - writes recovery files in the background
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "AutoSaver.h"
+
+#include <QRunnable>
+
+#include "BBTrackContainer.h"
+#include "DataFile.h"
+#include "Engine.h"
+#include "InstrumentTrack.h"
+#include "ProjectJournal.h"
+#include "Song.h"
+
+
+namespace
+{
+
+// plugins don't tell about all changes of their state, e.g. the ones
+// made in their own editors, so every so often everything is saved; this
+// also drops what the tracks embedded before they were saved again
+const int FullSaveInterval = 10;
+
+
+class WriteJob : public QRunnable
+{
+public:
+	WriteJob( std::unique_ptr<DataFile> dataFile, const QString & fileName ) :
+		m_dataFile( std::move( dataFile ) ),
+		m_fileName( fileName )
+	{
+	}
+
+	void run() override
+	{
+		m_dataFile->writeArchive( m_fileName );
+		m_dataFile.reset();
+	}
+
+private:
+	std::unique_ptr<DataFile> m_dataFile;
+	const QString m_fileName;
+} ;
+
+
+Track * owningTrack( JournallingObject * object )
+{
+	for( Model * model = dynamic_cast<Model *>( object ); model; model = model->parentModel() )
+	{
+		if( Track * track = dynamic_cast<Track *>( model ) )
+		{
+			return track;
+		}
+	}
+	return nullptr;
+}
+
+}
+
+
+
+
+AutoSaver::AutoSaver() :
+	m_allChanged( true ),
+	m_saves( 0 )
+{
+	m_pool.setMaxThreadCount( 1 );
+}
+
+
+
+
+AutoSaver::~AutoSaver()
+{
+	wait();
+}
+
+
+
+
+bool AutoSaver::save( const QString & fileName )
+{
+	if( m_pool.activeThreadCount() > 0 )
+	{
+		return false;
+	}
+
+	collectChanges();
+	if( m_allChanged || !m_cache || ++m_saves >= FullSaveInterval )
+	{
+		m_cache.reset( new DataFile( DataFile::SongProject ) );
+		m_tracks.clear();
+		m_allChanged = false;
+		m_saves = 0;
+	}
+
+	Song * song = Engine::getSong();
+	std::unique_ptr<DataFile> snapshot( new DataFile( DataFile::SongProject ) );
+	song->setTrackSaver( [this]( Track * track, QDomDocument & doc, QDomElement & parent )
+	{
+		saveTrack( track, doc, parent );
+	} );
+	song->saveProject( *snapshot );
+	song->setTrackSaver( nullptr );
+	m_changed.clear();
+
+	// the tracks embedded their samples into the cache
+	snapshot->embedFrom( *m_cache );
+	m_pool.start( new WriteJob( std::move( snapshot ), fileName ) );
+	return true;
+}
+
+
+
+
+void AutoSaver::wait()
+{
+	m_pool.waitForDone();
+}
+
+
+
+
+void AutoSaver::collectChanges()
+{
+	ProjectJournal * journal = Engine::projectJournal();
+	bool bbChanged = false;
+	for( const jo_id_t id : journal->takeChangedIDs() )
+	{
+		JournallingObject * object = journal->journallingObject( id );
+		if( object == nullptr )
+		{
+			// gone, and with it whatever it was part of
+			m_allChanged = true;
+			return;
+		}
+		if( object == Engine::getBBTrackContainer() )
+		{
+			bbChanged = true;
+		}
+		else if( Track * track = owningTrack( object ) )
+		{
+			m_changed.insert( track );
+			bbChanged |= track->trackContainer() == Engine::getBBTrackContainer();
+		}
+	}
+
+	// the first beat/bassline track saves the whole container
+	if( bbChanged )
+	{
+		for( const Track * track : Engine::getSong()->tracks() )
+		{
+			if( track->type() == Track::BBTrack )
+			{
+				m_changed.insert( track );
+			}
+		}
+	}
+}
+
+
+
+
+void AutoSaver::saveTrack( Track * track, QDomDocument & doc, QDomElement & parent )
+{
+	const InstrumentTrack * instrumentTrack = dynamic_cast<const InstrumentTrack *>( track );
+	CachedTrack & cached = m_tracks[track];
+	if( cached.track != track || m_changed.contains( track ) ||
+		( instrumentTrack && instrumentTrack->isInstrumentWindowShown() ) )
+	{
+		m_cache->content().removeChild( cached.element );
+		cached.track = track;
+		cached.element = track->saveState( *m_cache, m_cache->content() );
+	}
+	if( !cached.element.isNull() )
+	{
+		parent.appendChild( doc.importNode( cached.element, true ) );
+	}
+}
@@ -53,7 +53,10 @@ AutomatableModel::AutomatableModel(
 	m_controllerConnection( nullptr ),
 	m_valueBuffer( static_cast<int>( Engine::audioEngine()->framesPerPeriod() ) ),
 	m_lastUpdatedPeriod( -1 ),
-	m_hasSampleExactData(false),
+	m_currentValueBuffer(nullptr),
+	m_ramp{ 0.0f, 0.0f },
+	m_isRamp( false ),
+	m_rampPending( false ),
 	m_useControllerValue(true)
 
 {
@@ -506,7 +509,8 @@ void AutomatableModel::linkModels( AutomatableModel* model1, AutomatableModel* m
 	{
 		// copy data
 		model1->m_value = model2->m_value;
-		if (model1->valueBuffer() && model2->valueBuffer())
+		// a controller's buffer is shared with other models, leave it alone
+		if (model1->valueBuffer() == &model1->m_valueBuffer && model2->valueBuffer())
 		{
 			std::copy_n(model2->valueBuffer()->data(),
 				model1->valueBuffer()->length(),
@@ -596,49 +600,105 @@ float AutomatableModel::controllerValue( int frameOffset ) const
 }
 
 
+bool AutomatableModel::hasSampleExactController() const
+{
+	if (m_controllerConnection)
+	{
+		return m_useControllerValue && m_controllerConnection->getController()->isSampleExact();
+	}
+
+	const AutomatableModel* lm = hasLinkedModels() ? m_linkedModels.first() : nullptr;
+	return lm && lm->controllerConnection() && lm->m_useControllerValue &&
+		lm->controllerConnection()->getController()->isSampleExact();
+}
+
+
+
+
 ValueBuffer * AutomatableModel::valueBuffer()
 {
+	updatePeriod();
+
+	if( m_rampPending.load( std::memory_order_acquire ) )
+	{
+		QMutexLocker m( &m_valueBufferMutex );
+		if( m_rampPending.load( std::memory_order_relaxed ) )
+		{
+			m_valueBuffer.interpolate( m_ramp.start, m_ramp.end );
+			m_rampPending.store( false, std::memory_order_release );
+		}
+	}
+
+	return m_currentValueBuffer;
+}
+
+
+
+
+bool AutomatableModel::valueRamp( ValueRamp & ramp )
+{
+	updatePeriod();
+
+	if( m_currentValueBuffer == nullptr )
+	{
+		const float v = value<float>();
+		ramp = { v, v };
+		return true;
+	}
+	if( m_isRamp )
+	{
+		ramp = m_ramp;
+		return true;
+	}
+	return false;
+}
+
+
+
+
+void AutomatableModel::updatePeriod()
+{
+	// if we've already calculated the valuebuffer this period, there's
+	// nothing to do - this doesn't need the lock, the buffer was complete
+	// before the period was stored
+	if( m_lastUpdatedPeriod.load( std::memory_order_acquire ) == s_periodCounter )
+	{
+		return;
+	}
+
 	QMutexLocker m( &m_valueBufferMutex );
-	// if we've already calculated the valuebuffer this period, return the cached buffer
-	if( m_lastUpdatedPeriod == s_periodCounter )
+	// another thread may have calculated it while we were waiting
+	if( m_lastUpdatedPeriod.load( std::memory_order_relaxed ) != s_periodCounter )
 	{
-		return m_hasSampleExactData
-			? &m_valueBuffer
-			: nullptr;
+		m_isRamp = false;
+		m_rampPending.store( false, std::memory_order_relaxed );
+		m_currentValueBuffer = updateValueBuffer();
+		m_lastUpdatedPeriod.store( s_periodCounter, std::memory_order_release );
 	}
+}
 
+
+
+
+ValueBuffer * AutomatableModel::updateValueBuffer()
+{
 	float val = m_value; // make sure our m_value doesn't change midway
 
 	ValueBuffer * vb;
 	if (m_controllerConnection && m_useControllerValue && m_controllerConnection->getController()->isSampleExact())
 	{
-		vb = m_controllerConnection->valueBuffer();
-		if( vb )
+		// models with the same range share the buffer, the controller
+		// converts it once per period
+		switch( m_scaleType )
 		{
-			float * values = vb->values();
-			float * nvalues = m_valueBuffer.values();
-			switch( m_scaleType )
-			{
-			case Linear:
-				for( int i = 0; i < m_valueBuffer.length(); i++ )
-				{
-					nvalues[i] = minValue<float>() + ( range() * values[i] );
-				}
-				break;
-			case Logarithmic:
-				for( int i = 0; i < m_valueBuffer.length(); i++ )
-				{
-					nvalues[i] = logToLinearScale( values[i] );
-				}
-				break;
-			default:
-				qFatal("AutomatableModel::valueBuffer() "
-					"lacks implementation for a scale type");
-				break;
-			}
-			m_lastUpdatedPeriod = s_periodCounter;
-			m_hasSampleExactData = true;
-			return &m_valueBuffer;
+		case Linear:
+		case Logarithmic:
+			return m_controllerConnection->getController()->scaledValueBuffer(
+				m_scaleType == Logarithmic, minValue<float>(), maxValue<float>() );
+		default:
+			qFatal("AutomatableModel::valueBuffer() "
+				"lacks implementation for a scale type");
+			break;
 		}
 	}
 
@@ -659,25 +719,23 @@ ValueBuffer * AutomatableModel::valueBuffer()
 			{
 				nvalues[i] = fittedValue(values[i]);
 			}
-			m_lastUpdatedPeriod = s_periodCounter;
-			m_hasSampleExactData = true;
 			return &m_valueBuffer;
 		}
 	}
 
 	if( m_oldValue != val )
 	{
-		m_valueBuffer.interpolate( m_oldValue, val );
+		// written when it's asked for, consumers working in sub-blocks
+		// only need the ramp
+		m_ramp = { m_oldValue, val };
+		m_isRamp = true;
+		m_rampPending.store( true, std::memory_order_relaxed );
 		m_oldValue = val;
-		m_lastUpdatedPeriod = s_periodCounter;
-		m_hasSampleExactData = true;
 		return &m_valueBuffer;
 	}
 
 	// if we have no sample-exact source for a ValueBuffer, return NULL to signify that no data is available at the moment
 	// in which case the recipient knows to use the static value() instead
-	m_lastUpdatedPeriod = s_periodCounter;
-	m_hasSampleExactData = false;
 	return nullptr;
 }
 
@@ -34,6 +34,7 @@
 #include "ProjectJournal.h"
 #include "Song.h"
 
+#include <algorithm>
 #include <cmath>
 
 int AutomationClip::s_quantization = 1;
@@ -48,6 +49,8 @@ AutomationClip::AutomationClip( AutomationTrack * _auto_track ) :
 	m_objects(),
 	m_tension( 1.0 ),
 	m_progressionType( DiscreteProgression ),
+	m_playbackNodesChanged( true ),
+	m_playbackCursor( 0 ),
 	m_dragging( false ),
 	m_isRecording( false ),
 	m_lastRecordedValue( 0 )
@@ -79,7 +82,9 @@ AutomationClip::AutomationClip( const AutomationClip & _clip_to_copy ) :
 	m_autoTrack( _clip_to_copy.m_autoTrack ),
 	m_objects( _clip_to_copy.m_objects ),
 	m_tension( _clip_to_copy.m_tension ),
-	m_progressionType( _clip_to_copy.m_progressionType )
+	m_progressionType( _clip_to_copy.m_progressionType ),
+	m_playbackNodesChanged( true ),
+	m_playbackCursor( 0 )
 {
 	// Locks the mutex of the copied AutomationClip to make sure it
 	// doesn't change while it's being copied
@@ -331,6 +336,32 @@ TimePos AutomationClip::putValues(
 
 
 
+void AutomationClip::putValues(
+	const std::vector<std::pair<TimePos, float>> & values,
+	const bool quantPos
+)
+{
+	QMutexLocker m(&m_clipMutex);
+
+	cleanObjects();
+
+	for (const auto & value : values)
+	{
+		TimePos newTime = quantPos ? Note::quantized(value.first, quantization()) : value.first;
+
+		// Create a node or replace the existing one on newTime
+		m_timeMap[newTime] = AutomationNode(this, value.second, newTime);
+	}
+	generateTangents();
+
+	updateLength();
+
+	emit dataChanged();
+}
+
+
+
+
 void AutomationClip::removeNode(const TimePos & time)
 {
 	QMutexLocker m(&m_clipMutex);
@@ -509,34 +540,31 @@ float AutomationClip::valueAt( const TimePos & _time ) const
 {
 	QMutexLocker m(&m_clipMutex);
 
-	if( m_timeMap.isEmpty() )
+	updatePlaybackNodes();
+	if( m_playbackNodes.empty() )
 	{
 		return 0;
 	}
 
-	// If we have a node at that time, just return its value
-	if (m_timeMap.contains(_time))
+	const int index = playbackNodeAt( _time );
+	if( index < 0 )
 	{
-		// When the time is exactly the node's time, we want the inValue
-		return m_timeMap[_time].getInValue();
+		return 0;
 	}
 
-	// lowerBound returns next value with equal or greater key. Since we already
-	// checked if the key contains a node, we know the returned node has a greater
-	// key than _time. Therefore we take the previous element to calculate the current value
-	timeMap::const_iterator v = m_timeMap.lowerBound(_time);
-
-	if( v == m_timeMap.begin() )
+	const PlaybackNode & v = m_playbackNodes[index];
+	// When the time is exactly the node's time, we want the inValue
+	if( v.pos == _time )
 	{
-		return 0;
+		return v.inValue;
 	}
-	if( v == m_timeMap.end() )
+	// When the time is after the last node, we want the outValue of it
+	if( index + 1 == static_cast<int>( m_playbackNodes.size() ) )
 	{
-		// When the time is after the last node, we want the outValue of it
-		return OUTVAL(v - 1);
+		return v.outValue;
 	}
 
-	return valueAt(v - 1, _time - POS(v - 1));
+	return interpolate( v, m_playbackNodes[index + 1], _time - v.pos );
 }
 
 
@@ -552,17 +580,33 @@ float AutomationClip::valueAt( timeMap::const_iterator v, int offset ) const
 	// value if we do
 	if (offset == 0) { return INVAL(v); }
 
+	return interpolate(playbackNode(v), playbackNode(v + 1), offset);
+}
+
+
+
+
+AutomationClip::PlaybackNode AutomationClip::playbackNode( timeMap::const_iterator it )
+{
+	return { POS(it), INVAL(it), OUTVAL(it), INTAN(it), OUTTAN(it) };
+}
+
+
+
+
+float AutomationClip::interpolate( const PlaybackNode & v, const PlaybackNode & next, int offset ) const
+{
 	if (m_progressionType == DiscreteProgression)
 	{
-		return OUTVAL(v);
+		return v.outValue;
 	}
 	else if( m_progressionType == LinearProgression )
 	{
 		float slope =
-			(INVAL(v + 1) - OUTVAL(v))
-			/ (POS(v + 1) - POS(v));
+			(next.inValue - v.outValue)
+			/ (next.pos - v.pos);
 
-		return OUTVAL(v) + offset * slope;
+		return v.outValue + offset * slope;
 	}
 	else /* CubicHermiteProgression */
 	{
@@ -574,16 +618,16 @@ float AutomationClip::valueAt( timeMap::const_iterator v, int offset ) const
 		// value: y.  To make this work we map the values of x that this
 		// segment spans to values of t for t = 0.0 -> 1.0 and scale the
 		// tangents _m1 and _m2
-		int numValues = (POS(v + 1) - POS(v));
+		int numValues = (next.pos - v.pos);
 		float t = (float) offset / (float) numValues;
-		float m1 = OUTTAN(v) * numValues * m_tension;
-		float m2 = INTAN(v + 1) * numValues * m_tension;
+		float m1 = v.outTangent * numValues * m_tension;
+		float m2 = next.inTangent * numValues * m_tension;
 
 		auto t2 = pow(t, 2);
 		auto t3 = pow(t, 3);
-		return (2 * t3 - 3 * t2 + 1) * OUTVAL(v)
+		return (2 * t3 - 3 * t2 + 1) * v.outValue
 			+ (t3 - 2 * t2 + t) * m1
-			+ (-2 * t3 + 3 * t2) * INVAL(v + 1)
+			+ (-2 * t3 + 3 * t2) * next.inValue
 			+ (t3 - t2) * m2;
 	}
 }
@@ -591,6 +635,69 @@ float AutomationClip::valueAt( timeMap::const_iterator v, int offset ) const
 
 
 
+void AutomationClip::updatePlaybackNodes() const
+{
+	if( !m_playbackNodesChanged )
+	{
+		return;
+	}
+
+	m_playbackNodes.clear();
+	m_playbackNodes.reserve( m_timeMap.size() );
+	for( timeMap::const_iterator it = m_timeMap.begin(); it != m_timeMap.end(); ++it )
+	{
+		m_playbackNodes.push_back( playbackNode( it ) );
+	}
+	m_playbackCursor = 0;
+	m_playbackNodesChanged = false;
+}
+
+
+
+
+// Returns the index of the last node at or before the given time, or -1 if
+// the time is before the first node. Starts at the cursor, so playing forward
+// is constant time per call.
+int AutomationClip::playbackNodeAt( int time ) const
+{
+	const int size = static_cast<int>( m_playbackNodes.size() );
+	int index = m_playbackCursor;
+
+	if( m_playbackNodes[index].pos <= time )
+	{
+		// usually we're still in the same segment or just entered the next one
+		if( index + 1 < size && m_playbackNodes[index + 1].pos <= time )
+		{
+			++index;
+			if( index + 1 < size && m_playbackNodes[index + 1].pos <= time )
+			{
+				index = std::upper_bound( m_playbackNodes.begin() + index,
+						m_playbackNodes.end(), time,
+						[]( int t, const PlaybackNode & n ) { return t < n.pos; } )
+					- m_playbackNodes.begin() - 1;
+			}
+		}
+	}
+	else
+	{
+		// jumped back, e.g. looped or rewound
+		index = std::upper_bound( m_playbackNodes.begin(),
+				m_playbackNodes.begin() + index, time,
+				[]( int t, const PlaybackNode & n ) { return t < n.pos; } )
+			- m_playbackNodes.begin() - 1;
+		if( index < 0 )
+		{
+			return -1;
+		}
+	}
+
+	m_playbackCursor = index;
+	return index;
+}
+
+
+
+
 float *AutomationClip::valuesAfter( const TimePos & _time ) const
 {
 	QMutexLocker m(&m_clipMutex);
@@ -1055,6 +1162,7 @@ void AutomationClip::clear()
 	QMutexLocker m(&m_clipMutex);
 
 	m_timeMap.clear();
+	m_playbackNodesChanged = true;
 
 	emit dataChanged();
 }
@@ -1126,6 +1234,9 @@ void AutomationClip::generateTangents(timeMap::iterator it, int numToGenerate)
 {
 	QMutexLocker m(&m_clipMutex);
 
+	// every change of the nodes ends up here
+	m_playbackNodesChanged = true;
+
 	if( m_timeMap.size() < 2 && numToGenerate > 0 )
 	{
 		it.value().setInTangent(0);
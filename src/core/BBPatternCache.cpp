@@ -0,0 +1,513 @@
+/*
+ * BBPatternCache.cpp - renders a beat/bassline pattern once and replays it
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "BBPatternCache.h"
+
+#include <algorithm>
+
+#include <QtCore/QThread>
+
+#include "AudioEngine.h"
+#include "AudioPort.h"
+#include "AutomatableModel.h"
+#include "BBTrack.h"
+#include "BBTrackContainer.h"
+#include "denormals.h"
+#include "Engine.h"
+#include "InstrumentTrack.h"
+#include "MemoryManager.h"
+#include "MixHelpers.h"
+#include "PatternCachePlayHandle.h"
+#include "SampleBuffer.h"
+#include "SampleClip.h"
+#include "SampleTrack.h"
+#include "Song.h"
+
+
+// notes still ringing after the end of the pattern get cut off after this
+static const int MaxTailSeconds = 10;
+
+
+class BBPatternCache::Renderer : public QThread
+{
+public:
+	Renderer( BBPatternCache * cache ) :
+		m_cache( cache )
+	{
+	}
+
+protected:
+	void run() override
+	{
+		MemoryManager::ThreadGuard mmThreadGuard; Q_UNUSED(mmThreadGuard);
+		disable_denormals();
+		m_cache->renderPattern();
+	}
+
+private:
+	BBPatternCache * m_cache;
+};
+
+
+
+
+BBPatternCache::BBPatternCache( BBTrack * bbTrack ) :
+	QObject(),
+	m_bbTrack( bbTrack ),
+	m_enabled( false ),
+	m_valid( false ),
+	m_patternTicks( 0 ),
+	m_repetitionStart( -1 ),
+	m_lastTick( -1 ),
+	m_generation( 0 ),
+	m_renderer( nullptr ),
+	m_abortRender( false ),
+	m_renderTracks(),
+	m_renderPatternTicks( 0 ),
+	m_renderCaptures(),
+	m_renderFrames( 0 ),
+	m_mutedTracks()
+{
+}
+
+
+
+
+BBPatternCache::~BBPatternCache()
+{
+	abortRender();
+	clear();
+}
+
+
+
+
+void BBPatternCache::setEnabled( bool enabled )
+{
+	if( enabled == m_enabled )
+	{
+		return;
+	}
+	m_enabled = enabled;
+	if( !m_enabled )
+	{
+		abortRender();
+		clear();
+	}
+}
+
+
+
+
+bool BBPatternCache::play( const TimePos & start, const TimePos & clipStart,
+				const TimePos & clipLength, f_cnt_t offset )
+{
+	const tick_t tick = start.getTicks();
+	const tick_t lastTick = m_lastTick;
+	m_lastTick = tick;
+
+	if( !m_valid )
+	{
+		return false;
+	}
+
+	if( tick != lastTick + 1 && m_repetitionStart >= 0 &&
+		lastTick + 1 < m_repetitionStart + m_patternTicks )
+	{
+		// the play position left a repetition before its end - like
+		// in a live pattern, the notes in front of the old position
+		// mustn't play anymore
+		m_generation.fetch_add( 1, std::memory_order_acq_rel );
+		m_repetitionStart = -1;
+	}
+
+	const tick_t inClip = tick - clipStart.getTicks();
+	const tick_t inPattern = inClip % m_patternTicks;
+	if( inPattern == 0 )
+	{
+		// the cache holds the whole pattern, so a repetition cut short by
+		// the end of the clip plays live
+		if( inClip + m_patternTicks > clipLength.getTicks() )
+		{
+			m_repetitionStart = -1;
+			return false;
+		}
+		const int generation = m_generation.load( std::memory_order_relaxed );
+		for( const TrackCache & cache : m_caches )
+		{
+			Engine::audioEngine()->addPlayHandle( new PatternCachePlayHandle( this,
+					generation, m_bbTrack, cache.track, cache.port, cache.buffer, offset ) );
+		}
+		m_repetitionStart = tick;
+		return true;
+	}
+
+	// a repetition which started live, e.g. after the play position got
+	// moved into it, continues live
+	return m_repetitionStart >= 0 && tick - inPattern == m_repetitionStart;
+}
+
+
+
+
+void BBPatternCache::invalidate()
+{
+	clear();
+}
+
+
+
+
+bool BBPatternCache::render()
+{
+	Song * song = Engine::getSong();
+	BBTrackContainer * bbContainer = Engine::getBBTrackContainer();
+	AudioEngine * audioEngine = Engine::audioEngine();
+
+	// an automated pattern stays live, and a muted one would only record
+	// silence
+	if( !m_enabled || m_valid || isRendering() || song->isPlaying() || song->isExporting() ||
+		song->isLoadingProject() || m_bbTrack->isMuted() || isAutomated() )
+	{
+		return false;
+	}
+
+	// muted tracks can't be recorded without unmuting them, which would
+	// change what the user set - unmuting them drops the cache instead
+	const int bb = m_bbTrack->index();
+	m_renderTracks.clear();
+	m_mutedTracks.clear();
+	for( Track * track : bbContainer->tracks() )
+	{
+		if( audioPortOf( track ) && bb < track->numOfClips() )
+		{
+			( track->isMuted() ? m_mutedTracks : m_renderTracks ).push_back( track );
+		}
+	}
+
+	// render bypassing the audio device, playing the pattern once and
+	// recording the input of each port until all notes have finished
+	m_renderPatternTicks = bbContainer->lengthOfBB( bb ) * TimePos::ticksPerBar();
+	m_renderCaptures.clear();
+	m_renderCaptures.resize( m_renderTracks.size() );
+	m_renderFrames = 0;
+	m_abortRender = false;
+	audioEngine->stopProcessing();
+	for( int i = 0; i < m_renderTracks.size(); ++i )
+	{
+		audioPortOf( m_renderTracks[i] )->setPatternCapture( &m_renderCaptures[i] );
+	}
+
+	m_renderer = new Renderer( this );
+	connect( m_renderer, SIGNAL( finished() ), this, SLOT( finishRender() ) );
+	m_renderer->start();
+	return true;
+}
+
+
+
+
+void BBPatternCache::abortRender()
+{
+	if( isRendering() )
+	{
+		m_abortRender = true;
+		finishRender();
+	}
+}
+
+
+
+
+void BBPatternCache::renderPattern()
+{
+	BBTrackContainer * bbContainer = Engine::getBBTrackContainer();
+	AudioEngine * audioEngine = Engine::audioEngine();
+
+	const int bb = m_bbTrack->index();
+	const tick_t patternTicks = m_renderPatternTicks;
+	const float framesPerTick = Engine::framesPerTick();
+	const fpp_t fpp = audioEngine->framesPerPeriod();
+	const f_cnt_t maxFrames = static_cast<f_cnt_t>( patternTicks * framesPerTick ) +
+					MaxTailSeconds * audioEngine->processingSampleRate();
+
+	auto hasPlayHandles = [this, audioEngine]()
+	{
+		for( const PlayHandle * handle : audioEngine->playHandles() )
+		{
+			if( handle->type() & ( PlayHandle::TypeNotePlayHandle | PlayHandle::TypeSamplePlayHandle ) )
+			{
+				for( const Track * track : m_renderTracks )
+				{
+					if( handle->isFromTrack( track ) )
+					{
+						return true;
+					}
+				}
+			}
+		}
+		return false;
+	};
+
+	f_cnt_t frames = 0;
+	tick_t tick = 0;
+	int progress = -1;
+	while( frames < maxFrames && !m_abortRender )
+	{
+		// play the ticks starting in this period, like
+		// Song::processNextBuffer() does
+		for( ; tick < patternTicks &&
+			static_cast<f_cnt_t>( tick * framesPerTick ) < frames + fpp; ++tick )
+		{
+			const f_cnt_t tickFrame = static_cast<f_cnt_t>( tick * framesPerTick );
+			const f_cnt_t offset = tickFrame - frames;
+			const f_cnt_t tickFrames = std::min<f_cnt_t>(
+				static_cast<f_cnt_t>( ( tick + 1 ) * framesPerTick ) - tickFrame, fpp - offset );
+			bbContainer->play( TimePos( tick ), tickFrames, offset, bb );
+		}
+
+		audioEngine->nextBuffer();
+		frames += fpp;
+
+		bool silent = true;
+		for( std::vector<sample_t> & capture : m_renderCaptures )
+		{
+			// ports without input haven't been processed at all
+			capture.resize( frames * DEFAULT_CHANNELS );
+			silent = silent && MixHelpers::isSilent(
+				reinterpret_cast<const sampleFrame *>( capture.data() ) + frames - fpp, fpp );
+		}
+		if( tick >= patternTicks && silent && !hasPlayHandles() )
+		{
+			break;
+		}
+
+		// the tail isn't known in advance
+		if( 100 * tick / patternTicks != progress )
+		{
+			progress = 100 * tick / patternTicks;
+			emit renderProgress( progress );
+		}
+	}
+	m_renderFrames = frames;
+}
+
+
+
+
+void BBPatternCache::finishRender()
+{
+	if( !isRendering() )
+	{
+		return;
+	}
+	m_renderer->wait();
+	delete m_renderer;
+	m_renderer = nullptr;
+
+	AudioEngine * audioEngine = Engine::audioEngine();
+	for( Track * track : m_renderTracks )
+	{
+		audioPortOf( track )->setPatternCapture( nullptr );
+		// cut off what's left after the maximum tail
+		audioEngine->removePlayHandlesOfTypes( track,
+			PlayHandle::TypeNotePlayHandle | PlayHandle::TypeSamplePlayHandle );
+	}
+	audioEngine->startProcessing();
+
+	std::vector<std::vector<sample_t>> captures;
+	captures.swap( m_renderCaptures );
+	if( m_abortRender )
+	{
+		m_mutedTracks.clear();
+		emit renderFinished();
+		return;
+	}
+
+	const f_cnt_t frames = m_renderFrames;
+	std::vector<TrackCache> caches;
+	for( size_t i = 0; i < captures.size(); ++i )
+	{
+		const sampleFrame * samples = reinterpret_cast<const sampleFrame *>( captures[i].data() );
+		if( !MixHelpers::isSilent( samples, frames ) )
+		{
+			caches.push_back( { m_renderTracks[i], audioPortOf( m_renderTracks[i] ),
+						new SampleBuffer( samples, frames ) } );
+		}
+	}
+
+	audioEngine->requestChangeInModel();
+	m_caches.swap( caches );
+	m_patternTicks = m_renderPatternTicks;
+	m_valid = true;
+	audioEngine->doneChangeInModel();
+
+	watchForChanges();
+
+	emit renderFinished();
+}
+
+
+
+
+AudioPort * BBPatternCache::audioPortOf( Track * track )
+{
+	if( InstrumentTrack * instrumentTrack = qobject_cast<InstrumentTrack *>( track ) )
+	{
+		return instrumentTrack->audioPort();
+	}
+	if( SampleTrack * sampleTrack = qobject_cast<SampleTrack *>( track ) )
+	{
+		return sampleTrack->audioPort();
+	}
+	return nullptr;
+}
+
+
+
+
+QVector<Model *> BBPatternCache::ignoredModels( Track * track )
+{
+	QVector<Model *> models{ track->getMutedModel(), track->getSoloModel() };
+	if( InstrumentTrack * instrumentTrack = qobject_cast<InstrumentTrack *>( track ) )
+	{
+		models << instrumentTrack->volumeModel() << instrumentTrack->panningModel()
+			<< instrumentTrack->mixerChannelModel();
+	}
+	else if( SampleTrack * sampleTrack = qobject_cast<SampleTrack *>( track ) )
+	{
+		models << sampleTrack->volumeModel() << sampleTrack->panningModel()
+			<< sampleTrack->mixerChannelModel();
+	}
+	return models;
+}
+
+
+
+
+void BBPatternCache::clear()
+{
+	for( const QMetaObject::Connection & connection : m_connections )
+	{
+		disconnect( connection );
+	}
+	m_connections.clear();
+
+	if( !m_valid )
+	{
+		return;
+	}
+
+	// repetitions already playing from the cache stop as well, as the
+	// rest of them is going to be played live
+	AudioEngine * audioEngine = Engine::audioEngine();
+	audioEngine->requestChangeInModel();
+	std::vector<TrackCache> caches;
+	caches.swap( m_caches );
+	m_valid = false;
+	m_repetitionStart = -1;
+	m_generation.fetch_add( 1, std::memory_order_acq_rel );
+	audioEngine->doneChangeInModel();
+
+	// the play handles hold references of their own
+	for( const TrackCache & cache : caches )
+	{
+		sharedObject::unref( cache.buffer );
+	}
+}
+
+
+
+
+bool BBPatternCache::isAutomated() const
+{
+	for( Track * track : Engine::getBBTrackContainer()->tracks() )
+	{
+		const QVector<Model *> ignored = ignoredModels( track );
+		for( AutomatableModel * model : track->findChildren<AutomatableModel *>() )
+		{
+			if( !ignored.contains( model ) && model->isAutomatedOrControlled() )
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+
+
+
+void BBPatternCache::watchForChanges()
+{
+	auto watch = [this]( QObject * object, const char * signal )
+	{
+		m_connections.push_back( connect( object, signal,
+					this, SLOT( invalidate() ) ) );
+	};
+
+	// changing automated models also ends up here, which makes the
+	// pattern play live
+	const int bb = m_bbTrack->index();
+	BBTrackContainer * bbContainer = Engine::getBBTrackContainer();
+	for( Track * track : bbContainer->tracks() )
+	{
+		const QVector<Model *> ignored = ignoredModels( track );
+		for( AutomatableModel * model : track->findChildren<AutomatableModel *>() )
+		{
+			if( !ignored.contains( model ) )
+			{
+				watch( model, SIGNAL( dataChanged() ) );
+			}
+		}
+
+		if( bb < track->numOfClips() )
+		{
+			Clip * clip = track->getClip( bb );
+			watch( clip, SIGNAL( dataChanged() ) );
+			watch( clip, SIGNAL( lengthChanged() ) );
+			watch( clip, SIGNAL( destroyedClip() ) );
+			if( qobject_cast<SampleClip *>( clip ) )
+			{
+				watch( clip, SIGNAL( sampleChanged() ) );
+			}
+		}
+		if( m_mutedTracks.contains( track ) )
+		{
+			watch( track->getMutedModel(), SIGNAL( dataChanged() ) );
+		}
+		watch( track, SIGNAL( clipAdded( Clip * ) ) );
+		watch( track, SIGNAL( destroyedTrack() ) );
+		if( qobject_cast<InstrumentTrack *>( track ) )
+		{
+			watch( track, SIGNAL( instrumentChanged() ) );
+		}
+	}
+	watch( bbContainer, SIGNAL( trackAdded( Track * ) ) );
+
+	// the cache is laid out in frames of the song at render time
+	watch( Engine::getSong(), SIGNAL( tempoChanged( bpm_t ) ) );
+	watch( Engine::getSong(), SIGNAL( timeSignatureChanged( int, int ) ) );
+	watch( Engine::audioEngine(), SIGNAL( sampleRateChanged() ) );
+}
@@ -240,7 +240,7 @@ void BBTrackContainer::createClipsForBB(int bb)
 	}
 }
 
-AutomatedValueMap BBTrackContainer::automatedValuesAt(TimePos time, int clipNum) const
+void BBTrackContainer::collectAutomatedValues(TimePos time, int clipNum, AutomatedValueList & values) const
 {
 	Q_ASSERT(clipNum >= 0);
 	Q_ASSERT(time.getTicks() >= 0);
@@ -252,6 +252,6 @@ AutomatedValueMap BBTrackContainer::automatedValuesAt(TimePos time, int clipNum)
 		time = lengthTicks;
 	}
 
-	return TrackContainer::automatedValuesAt(time + (TimePos::ticksPerBar() * clipNum), clipNum);
+	TrackContainer::collectAutomatedValues(time + (TimePos::ticksPerBar() * clipNum), clipNum, values);
 }
 
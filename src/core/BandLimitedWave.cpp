@@ -25,6 +25,9 @@
 
 #include "BandLimitedWave.h"
 
+#include <cmath>
+#include <vector>
+
 #include <QDataStream>
 
 WaveMipMap BandLimitedWave::s_waveforms[4] = {  };
@@ -270,3 +273,52 @@ moogfile.close();
 */
 
 }
+
+
+
+
+UserWaveMipMap::UserWaveMipMap( const sample_t * _cycle, int _length )
+{
+	// the harmonics of the cycle, drawn cycles are short enough for a plain DFT
+	const int harmonics = _length / 2;
+	std::vector<double> cosAmp( harmonics + 1, 0.0 );
+	std::vector<double> sinAmp( harmonics + 1, 0.0 );
+	for( int harm = 0; harm <= harmonics; harm++ )
+	{
+		for( int i = 0; i < _length; i++ )
+		{
+			const double w = D_2PI * harm * i / _length;
+			cosAmp[harm] += _cycle[i] * cos( w );
+			sinAmp[harm] += _cycle[i] * sin( w );
+		}
+		// the mean and the harmonic at half the length appear only once in the spectrum
+		const double scale = ( harm == 0 || 2 * harm == _length ? 1.0 : 2.0 ) / _length;
+		cosAmp[harm] *= scale;
+		sinAmp[harm] *= scale;
+	}
+
+	for( int tbl = 0; tbl <= MAXTBL; tbl++ )
+	{
+		const int len = TLENS[tbl];
+		// as for the waveforms, only harmonics with more than two samples per cycle
+		const int top = qMin( harmonics, ( len - 1 ) / 2 );
+		for( int ph = 0; ph < len; ph++ )
+		{
+			const double w = D_2PI * ph / len;
+			const double cw = cos( w );
+			const double sw = sin( w );
+			double c = 1.0;
+			double s = 0.0;
+			double sample = cosAmp[0];
+			for( int harm = 1; harm <= top; harm++ )
+			{
+				// rotate by w instead of taking cos() and sin() of each harmonic
+				const double cn = c * cw - s * sw;
+				s = s * cw + c * sw;
+				c = cn;
+				sample += cosAmp[harm] * c + sinAmp[harm] * s;
+			}
+			m_mipmap.setSampleAt( tbl, ph, sample );
+		}
+	}
+}
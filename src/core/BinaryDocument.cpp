@@ -0,0 +1,517 @@
+/*
+ * BinaryDocument.cpp - compact binary encoding of project documents
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "BinaryDocument.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+
+namespace BinaryDocument
+{
+
+namespace
+{
+
+const quint32 FormatVersion = 1;
+// shorter runs of alike elements are written one by one
+const int MinRunLength = 4;
+
+enum NodeKind : quint8
+{
+	ElementNode,
+	RunNode,
+	TextNode,
+	CDataNode,
+	CommentNode,
+	InstructionNode
+} ;
+
+enum ValueType : quint8
+{
+	StringValue,
+	IntValue,
+	FloatValue
+} ;
+
+
+// numbers are only stored as such if they are printed the same way again
+bool fits(ValueType type, const QString & text)
+{
+	bool ok = false;
+	switch (type)
+	{
+		case IntValue:
+		{
+			const int value = text.toInt(&ok);
+			return ok && QString::number(value) == text;
+		}
+		case FloatValue:
+		{
+			const float value = text.toFloat(&ok);
+			return ok && QString::number(value) == text;
+		}
+		default:
+			return true;
+	}
+}
+
+
+ValueType valueType(const QString & text)
+{
+	return fits(IntValue, text) ? IntValue : fits(FloatValue, text) ? FloatValue : StringValue;
+}
+
+
+void setUp(QDataStream & stream)
+{
+	stream.setVersion(QDataStream::Qt_5_0);
+	stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
+
+
+//! Sorted, so that elements with their attributes set in another order
+//! are alike too
+QStringList attributeNames(const QDomElement & element)
+{
+	const QDomNamedNodeMap attributes = element.attributes();
+	QStringList names;
+	for (int i = 0; i < attributes.count(); ++i)
+	{
+		names.append(attributes.item(i).nodeName());
+	}
+	names.sort();
+	return names;
+}
+
+
+
+
+class Encoder
+{
+public:
+	Encoder() :
+		m_out(&m_nodes, QIODevice::WriteOnly)
+	{
+		setUp(m_out);
+	}
+
+	QByteArray encode(const QDomDocument & document)
+	{
+		writeChildren(document);
+
+		QByteArray result;
+		QDataStream out(&result, QIODevice::WriteOnly);
+		setUp(out);
+		out << FormatVersion << document.doctype().name() << static_cast<quint32>(m_names.size());
+		for (const QString & name : m_names)
+		{
+			out << name;
+		}
+		out.writeRawData(m_nodes.constData(), m_nodes.size());
+		return result;
+	}
+
+private:
+	struct Item
+	{
+		int first;
+		int length;
+	} ;
+
+	void writeName(const QString & name)
+	{
+		auto it = m_indices.constFind(name);
+		if (it == m_indices.constEnd())
+		{
+			it = m_indices.insert(name, m_names.size());
+			m_names.append(name);
+		}
+		m_out << it.value();
+	}
+
+	void writeValue(const QString & text)
+	{
+		const ValueType type = valueType(text);
+		m_out << static_cast<quint8>(type);
+		writeValue(type, text);
+	}
+
+	void writeValue(ValueType type, const QString & text)
+	{
+		switch (type)
+		{
+			case IntValue: m_out << static_cast<qint32>(text.toInt()); break;
+			case FloatValue: m_out << text.toFloat(); break;
+			default: m_out << text; break;
+		}
+	}
+
+	void writeChildren(const QDomNode & parent)
+	{
+		QVector<QDomNode> nodes;
+		for (QDomNode node = parent.firstChild(); !node.isNull(); node = node.nextSibling())
+		{
+			nodes.append(node);
+		}
+
+		// runs of leaf elements with the same tag and attributes
+		QVector<Item> items;
+		for (int i = 0; i < nodes.size();)
+		{
+			int end = i + 1;
+			if (nodes[i].isElement() && !nodes[i].hasChildNodes())
+			{
+				const QString tag = nodes[i].nodeName();
+				const QStringList names = attributeNames(nodes[i].toElement());
+				while (end < nodes.size() && nodes[end].isElement() &&
+					!nodes[end].hasChildNodes() && nodes[end].nodeName() == tag &&
+					attributeNames(nodes[end].toElement()) == names)
+				{
+					++end;
+				}
+				if (end - i < MinRunLength)
+				{
+					end = i + 1;
+				}
+			}
+			items.append({i, end - i});
+			i = end;
+		}
+
+		m_out << static_cast<quint32>(items.size());
+		for (const Item & item : items)
+		{
+			if (item.length > 1)
+			{
+				writeRun(nodes.mid(item.first, item.length));
+			}
+			else
+			{
+				writeNode(nodes[item.first]);
+			}
+		}
+	}
+
+	void writeNode(const QDomNode & node)
+	{
+		if (node.isElement())
+		{
+			const QDomElement element = node.toElement();
+			const QDomNamedNodeMap attributes = element.attributes();
+			m_out << static_cast<quint8>(ElementNode);
+			writeName(element.tagName());
+			m_out << static_cast<quint32>(attributes.count());
+			for (int i = 0; i < attributes.count(); ++i)
+			{
+				const QDomAttr attribute = attributes.item(i).toAttr();
+				writeName(attribute.name());
+				writeValue(attribute.value());
+			}
+			writeChildren(element);
+		}
+		else if (node.isCDATASection())
+		{
+			m_out << static_cast<quint8>(CDataNode) << node.nodeValue();
+		}
+		else if (node.isText())
+		{
+			m_out << static_cast<quint8>(TextNode) << node.nodeValue();
+		}
+		else if (node.isComment())
+		{
+			m_out << static_cast<quint8>(CommentNode) << node.nodeValue();
+		}
+		else if (node.isProcessingInstruction())
+		{
+			const QDomProcessingInstruction instruction = node.toProcessingInstruction();
+			m_out << static_cast<quint8>(InstructionNode) << instruction.target() << instruction.data();
+		}
+		else
+		{
+			// entity references and the like don't occur in projects,
+			// but the item still has to be there
+			m_out << static_cast<quint8>(TextNode) << QString();
+		}
+	}
+
+	void writeRun(const QVector<QDomNode> & run)
+	{
+		const QStringList names = attributeNames(run.first().toElement());
+		m_out << static_cast<quint8>(RunNode);
+		writeName(run.first().nodeName());
+		m_out << static_cast<quint32>(names.size());
+		for (const QString & name : names)
+		{
+			writeName(name);
+		}
+		m_out << static_cast<quint32>(run.size());
+
+		// one column per attribute, typed so that all rows fit
+		for (const QString & name : names)
+		{
+			ValueType type = IntValue;
+			for (const QDomNode & node : run)
+			{
+				const QString text = node.toElement().attribute(name);
+				while (!fits(type, text))
+				{
+					type = type == IntValue ? FloatValue : StringValue;
+				}
+			}
+			m_out << static_cast<quint8>(type);
+			for (const QDomNode & node : run)
+			{
+				writeValue(type, node.toElement().attribute(name));
+			}
+		}
+	}
+
+	QHash<QString, quint32> m_indices;
+	QStringList m_names;
+	QByteArray m_nodes;
+	QDataStream m_out;
+} ;
+
+
+
+
+class Decoder
+{
+public:
+	Decoder(const QByteArray & data) :
+		m_in(data)
+	{
+		setUp(m_in);
+	}
+
+	bool decode(QDomDocument & document)
+	{
+		quint32 version = 0;
+		QString doctype;
+		quint32 count = 0;
+		m_in >> version;
+		if (version > FormatVersion)
+		{
+			qWarning() << "BinaryDocument: version" << version << "is not supported";
+			return false;
+		}
+		m_in >> doctype >> count;
+		for (quint32 i = 0; i < count && m_in.status() == QDataStream::Ok; ++i)
+		{
+			QString name;
+			m_in >> name;
+			m_names.append(name);
+		}
+
+		m_document = doctype.isEmpty() ? QDomDocument() :
+			QDomDocument(QDomImplementation().createDocumentType(doctype, QString(), QString()));
+		if (!readChildren(m_document) || m_in.status() != QDataStream::Ok)
+		{
+			return false;
+		}
+		document = m_document;
+		return true;
+	}
+
+private:
+	bool readName(QString & name)
+	{
+		quint32 index = 0;
+		m_in >> index;
+		if (index >= static_cast<quint32>(m_names.size()))
+		{
+			return false;
+		}
+		name = m_names[index];
+		return true;
+	}
+
+	QString readValue(quint8 type)
+	{
+		switch (type)
+		{
+			case IntValue:
+			{
+				qint32 value = 0;
+				m_in >> value;
+				return QString::number(value);
+			}
+			case FloatValue:
+			{
+				float value = 0;
+				m_in >> value;
+				return QString::number(value);
+			}
+			default:
+			{
+				QString value;
+				m_in >> value;
+				return value;
+			}
+		}
+	}
+
+	bool readChildren(QDomNode parent)
+	{
+		quint32 count = 0;
+		m_in >> count;
+		for (quint32 i = 0; i < count; ++i)
+		{
+			if (m_in.status() != QDataStream::Ok || !readNode(parent))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool readNode(QDomNode & parent)
+	{
+		quint8 kind = 0;
+		m_in >> kind;
+		switch (kind)
+		{
+			case ElementNode:
+			{
+				QString tag;
+				quint32 count = 0;
+				if (!readName(tag))
+				{
+					return false;
+				}
+				QDomElement element = m_document.createElement(tag);
+				m_in >> count;
+				for (quint32 i = 0; i < count && m_in.status() == QDataStream::Ok; ++i)
+				{
+					QString name;
+					quint8 type = 0;
+					if (!readName(name))
+					{
+						return false;
+					}
+					m_in >> type;
+					element.setAttribute(name, readValue(type));
+				}
+				parent.appendChild(element);
+				return readChildren(element);
+			}
+			case RunNode:
+			{
+				QString tag;
+				quint32 count = 0;
+				quint32 rows = 0;
+				if (!readName(tag))
+				{
+					return false;
+				}
+				QStringList names;
+				m_in >> count;
+				for (quint32 i = 0; i < count && m_in.status() == QDataStream::Ok; ++i)
+				{
+					QString name;
+					if (!readName(name))
+					{
+						return false;
+					}
+					names.append(name);
+				}
+				m_in >> rows;
+				QVector<QDomElement> run;
+				for (quint32 i = 0; i < rows && m_in.status() == QDataStream::Ok; ++i)
+				{
+					run.append(m_document.createElement(tag));
+					parent.appendChild(run.last());
+				}
+				for (const QString & name : names)
+				{
+					quint8 type = 0;
+					m_in >> type;
+					for (QDomElement & element : run)
+					{
+						element.setAttribute(name, readValue(type));
+					}
+				}
+				return true;
+			}
+			case TextNode:
+			case CDataNode:
+			case CommentNode:
+			{
+				QString value;
+				m_in >> value;
+				if (kind == CDataNode)
+				{
+					parent.appendChild(m_document.createCDATASection(value));
+				}
+				else if (kind == CommentNode)
+				{
+					parent.appendChild(m_document.createComment(value));
+				}
+				else if (!value.isEmpty())
+				{
+					parent.appendChild(m_document.createTextNode(value));
+				}
+				return true;
+			}
+			case InstructionNode:
+			{
+				QString target;
+				QString data;
+				m_in >> target >> data;
+				parent.appendChild(m_document.createProcessingInstruction(target, data));
+				return true;
+			}
+			default:
+				return false;
+		}
+	}
+
+	QDataStream m_in;
+	QStringList m_names;
+	QDomDocument m_document;
+} ;
+
+} // namespace
+
+
+
+
+QByteArray encode(const QDomDocument & document)
+{
+	return Encoder().encode(document);
+}
+
+
+
+
+bool decode(const QByteArray & data, QDomDocument & document)
+{
+	return Decoder(data).decode(document);
+}
+
+} // namespace BinaryDocument
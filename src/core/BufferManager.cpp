@@ -26,20 +26,188 @@
 
 #include "BufferManager.h"
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 #include "Engine.h"
+#include "EngineCounters.h"
 #include "MemoryManager.h"
 
-static fpp_t framesPerPeriod;
+
+namespace
+{
+
+// buffers start on a cache line, which is enough for any SIMD width used
+constexpr size_t BufferAlignment = 64;
+// buffers a thread keeps for itself, half of them move to or from the
+// shared stack at once
+constexpr int ThreadCacheSize = 32;
+
+// in front of every buffer, taking a cache line of its own
+struct BufferHeader
+{
+	void * allocation;
+	unsigned generation;
+} ;
+
+static_assert( sizeof( BufferHeader ) <= BufferAlignment, "the header has to fit in front of the buffer" );
+
+
+std::atomic<fpp_t> framesPerPeriod( 0 );
+// buffers of an older generation are freed instead of being reused, see init()
+std::atomic<unsigned> generation( 1 );
+std::atomic<size_t> allocatedBuffers( 0 );
+
+// the buffers which don't fit into the threads' caches
+std::atomic_flag sharedLock = ATOMIC_FLAG_INIT;
+std::vector<void *> sharedBuffers;
+
+
+BufferHeader * header( void * buffer )
+{
+	return reinterpret_cast<BufferHeader *>( static_cast<char *>( buffer ) - BufferAlignment );
+}
+
+
+void * allocateBuffer()
+{
+	const size_t bytes = framesPerPeriod.load( std::memory_order_relaxed ) * sizeof( sampleFrame );
+	char * allocation = MM_ALLOC<char>( bytes + 2 * BufferAlignment );
+	char * buffer = allocation + BufferAlignment +
+		( BufferAlignment - reinterpret_cast<uintptr_t>( allocation ) % BufferAlignment ) % BufferAlignment;
+	header( buffer )->allocation = allocation;
+	header( buffer )->generation = generation.load( std::memory_order_acquire );
+	allocatedBuffers.fetch_add( 1, std::memory_order_relaxed );
+	return buffer;
+}
+
+
+void freeBuffer( void * buffer )
+{
+	allocatedBuffers.fetch_sub( 1, std::memory_order_relaxed );
+	MM_FREE( static_cast<char *>( header( buffer )->allocation ) );
+}
+
+
+class SharedLocker
+{
+public:
+	SharedLocker()
+	{
+		while( sharedLock.test_and_set( std::memory_order_acquire ) )
+		{
+		}
+	}
+
+	~SharedLocker()
+	{
+		sharedLock.clear( std::memory_order_release );
+	}
+} ;
+
+
+struct ThreadCache
+{
+	void * buffers[ThreadCacheSize];
+	int count = 0;
+	unsigned generation = 0;
+
+	~ThreadCache()
+	{
+		// what's left goes to the other threads
+		if( isCurrent() )
+		{
+			SharedLocker locker;
+			sharedBuffers.insert( sharedBuffers.end(), buffers, buffers + count );
+		}
+		else
+		{
+			drop();
+		}
+	}
+
+	bool isCurrent() const
+	{
+		return generation == ::generation.load( std::memory_order_acquire );
+	}
+
+	//! Frees the buffers of an older generation
+	void update()
+	{
+		if( !isCurrent() )
+		{
+			drop();
+			generation = ::generation.load( std::memory_order_acquire );
+		}
+	}
+
+	void drop()
+	{
+		for( int i = 0; i < count; ++i )
+		{
+			freeBuffer( buffers[i] );
+		}
+		count = 0;
+	}
+
+	void refill()
+	{
+		SharedLocker locker;
+		while( count < ThreadCacheSize / 2 && !sharedBuffers.empty() )
+		{
+			buffers[count++] = sharedBuffers.back();
+			sharedBuffers.pop_back();
+		}
+	}
+
+	void spill()
+	{
+		SharedLocker locker;
+		while( count > ThreadCacheSize / 2 )
+		{
+			sharedBuffers.push_back( buffers[--count] );
+		}
+	}
+} ;
+
+thread_local ThreadCache threadCache;
+
+}
+
+
 
 void BufferManager::init( fpp_t framesPerPeriod )
 {
-	::framesPerPeriod = framesPerPeriod;
+	std::vector<void *> dropped;
+	{
+		SharedLocker locker;
+		dropped.swap( sharedBuffers );
+		::framesPerPeriod.store( framesPerPeriod, std::memory_order_relaxed );
+		// the threads free what they cache once they notice
+		generation.fetch_add( 1, std::memory_order_acq_rel );
+		sharedBuffers.reserve( 1024 );
+	}
+	for( void * buffer : dropped )
+	{
+		freeBuffer( buffer );
+	}
 }
 
 
 sampleFrame * BufferManager::acquire()
 {
-	return MM_ALLOC<sampleFrame>( ::framesPerPeriod );
+	EngineCounters::add( EngineCounters::Counter::BuffersAcquired );
+
+	ThreadCache & cache = threadCache;
+	cache.update();
+	if( cache.count == 0 )
+	{
+		cache.refill();
+	}
+	void * buffer = cache.count > 0 ? cache.buffers[--cache.count] : allocateBuffer();
+	return static_cast<sampleFrame *>( buffer );
 }
 
 void BufferManager::clear( sampleFrame *ab, const f_cnt_t frames, const f_cnt_t offset )
@@ -58,6 +226,53 @@ void BufferManager::clear( surroundSampleFrame * ab, const f_cnt_t frames,
 
 void BufferManager::release( sampleFrame * buf )
 {
-	MM_FREE( buf );
+	if( buf == nullptr )
+	{
+		return;
+	}
+	EngineCounters::add( EngineCounters::Counter::BuffersReleased );
+
+	if( header( buf )->generation != generation.load( std::memory_order_acquire ) )
+	{
+		// of another period size
+		freeBuffer( buf );
+		return;
+	}
+
+	ThreadCache & cache = threadCache;
+	cache.update();
+	if( cache.count == ThreadCacheSize )
+	{
+		cache.spill();
+	}
+	cache.buffers[cache.count++] = buf;
+}
+
+
+size_t BufferManager::allocated()
+{
+	return allocatedBuffers.load( std::memory_order_relaxed );
+}
+
+
+
+// a planar period has the same size as an interleaved one, so both come
+// from the same pool
+PlanarBuffer BufferManager::acquirePlanar()
+{
+	return PlanarBuffer( reinterpret_cast<sample_t *>( acquire() ), framesPerPeriod.load( std::memory_order_relaxed ) );
 }
 
+void BufferManager::clear( const PlanarBuffer & buf )
+{
+	memset( buf.samples(), 0, sizeof( sample_t ) * DEFAULT_CHANNELS * buf.frames() );
+}
+
+void BufferManager::release( PlanarBuffer & buf )
+{
+	if( buf.samples() )
+	{
+		release( reinterpret_cast<sampleFrame *>( buf.samples() ) );
+		buf = PlanarBuffer();
+	}
+}
@@ -32,6 +32,69 @@
 
 namespace Clipboard
 {
+	namespace
+	{
+
+	class PayloadMimeData : public QMimeData
+	{
+	public:
+		//! @param key The key of a string pair, or a null string
+		PayloadMimeData( MimeType mT, const QString & key,
+					std::unique_ptr<Payload> payload ) :
+			m_format( mimeType( mT ) ),
+			m_key( key ),
+			m_payload( std::move( payload ) )
+		{
+		}
+
+		const Payload * payload() const
+		{
+			return m_payload.get();
+		}
+
+		const QString & key() const
+		{
+			return m_key;
+		}
+
+		bool hasFormat( const QString & mimeType ) const override
+		{
+			return mimeType == m_format;
+		}
+
+		QStringList formats() const override
+		{
+			return QStringList( m_format );
+		}
+
+	protected:
+		QVariant retrieveData( const QString & mimeType, QVariant::Type ) const override
+		{
+			if( mimeType != m_format )
+			{
+				return QVariant();
+			}
+			if( m_data.isNull() )
+			{
+				m_data = ( m_key.isNull()
+					? m_payload->toString()
+					: m_key + ":" + m_payload->toString() ).toUtf8();
+			}
+			return m_data;
+		}
+
+	private:
+		QString m_format;
+		QString m_key;
+		std::unique_ptr<Payload> m_payload;
+		mutable QByteArray m_data;
+	} ;
+
+	} // namespace
+
+
+
+
 	const QMimeData * getMimeData()
 	{
 		return QApplication::clipboard()->mimeData( QClipboard::Clipboard );
@@ -81,6 +144,12 @@ namespace Clipboard
 
 	QString decodeKey( const QMimeData * mimeData )
 	{
+		// no need to write the value of a payload for its key
+		auto payloadData = dynamic_cast<const PayloadMimeData *>( mimeData );
+		if( payloadData != nullptr && !payloadData->key().isNull() )
+		{
+			return payloadData->key();
+		}
 		return( QString::fromUtf8( mimeData->data( mimeType( MimeType::StringPair ) ) ).section( ':', 0, 0 ) );
 	}
 
@@ -91,4 +160,33 @@ namespace Clipboard
 	{
 		return( QString::fromUtf8( mimeData->data( mimeType( MimeType::StringPair ) ) ).section( ':', 1, -1 ) );
 	}
+
+
+
+
+	void copyPayload( std::unique_ptr<Payload> payload, MimeType mT )
+	{
+		QMimeData *content = new PayloadMimeData( mT, QString(), std::move( payload ) );
+		QApplication::clipboard()->setMimeData( content, QClipboard::Clipboard );
+	}
+
+
+
+
+	void copyPayloadPair( const QString & key, std::unique_ptr<Payload> payload )
+	{
+		QMimeData *content = new PayloadMimeData( MimeType::StringPair, key,
+								std::move( payload ) );
+		QApplication::clipboard()->setMimeData( content, QClipboard::Clipboard );
+	}
+
+
+
+
+	const Payload * getPayload( const QMimeData * mimeData )
+	{
+		// other applications' data, or our own once they took the clipboard
+		auto payloadData = dynamic_cast<const PayloadMimeData *>( mimeData );
+		return payloadData ? payloadData->payload() : nullptr;
+	}
 }
@@ -0,0 +1,211 @@
+/*
+ * CompactSamples.cpp - sample frames stored at the bit depth of their file
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "CompactSamples.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+namespace
+{
+
+const float Int16Scale = 32768.f;
+const float Int24Scale = 8388608.f;
+
+int bytesPerSample(CompactSamples::Format format)
+{
+	return format == CompactSamples::Format::Int16 ? 2 : 3;
+}
+
+int32_t quantize(float sample, float scale)
+{
+	const float scaled = std::round(sample * scale);
+	return static_cast<int32_t>(std::min(std::max(scaled, -scale), scale - 1));
+}
+
+void readInt16(sampleFrame * dst, const int16_t * src, f_cnt_t count, ch_cnt_t channels)
+{
+	const float gain = 1.f / Int16Scale;
+	f_cnt_t f = 0;
+#ifdef __SSE2__
+	const __m128 g = _mm_set1_ps(gain);
+	if (channels == 2)
+	{
+		// 4 interleaved frames per iteration
+		for (; f + 4 <= count; f += 4)
+		{
+			const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + f * 2));
+			const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+			const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+			_mm_storeu_ps(dst[f].data(), _mm_mul_ps(_mm_cvtepi32_ps(lo), g));
+			_mm_storeu_ps(dst[f + 2].data(), _mm_mul_ps(_mm_cvtepi32_ps(hi), g));
+		}
+	}
+	else
+	{
+		// 8 frames per iteration, each sample played on both channels
+		for (; f + 8 <= count; f += 8)
+		{
+			const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + f));
+			const __m128 lo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16)), g);
+			const __m128 hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16)), g);
+			_mm_storeu_ps(dst[f].data(), _mm_unpacklo_ps(lo, lo));
+			_mm_storeu_ps(dst[f + 2].data(), _mm_unpackhi_ps(lo, lo));
+			_mm_storeu_ps(dst[f + 4].data(), _mm_unpacklo_ps(hi, hi));
+			_mm_storeu_ps(dst[f + 6].data(), _mm_unpackhi_ps(hi, hi));
+		}
+	}
+#endif
+	for (; f < count; ++f)
+	{
+		const int16_t * s = src + f * channels;
+		dst[f][0] = s[0] * gain;
+		dst[f][1] = s[channels - 1] * gain;
+	}
+}
+
+int32_t int24At(const uint8_t * p)
+{
+	// sign extends by shifting the top byte into place
+	return static_cast<int32_t>(static_cast<uint32_t>(p[0]) << 8 |
+		static_cast<uint32_t>(p[1]) << 16 | static_cast<uint32_t>(p[2]) << 24) >> 8;
+}
+
+void readInt24(sampleFrame * dst, const uint8_t * src, f_cnt_t count, ch_cnt_t channels)
+{
+	const float gain = 1.f / Int24Scale;
+	for (f_cnt_t f = 0; f < count; ++f)
+	{
+		const uint8_t * s = src + f * channels * 3;
+		dst[f][0] = int24At(s) * gain;
+		dst[f][1] = int24At(s + (channels - 1) * 3) * gain;
+	}
+}
+
+}
+
+
+
+
+CompactSamples::CompactSamples(const sampleFrame * data, f_cnt_t frames, Format format, ch_cnt_t channels) :
+	m_format(format),
+	m_channels(channels == 1 ? 1 : 2),
+	m_frames(frames),
+	m_frameBytes(bytesPerSample(format) * m_channels),
+	m_data(MM_ALLOC<uint8_t>(bytes()))
+{
+	if (m_format == Format::Int16)
+	{
+		int16_t * dst = reinterpret_cast<int16_t *>(m_data);
+		for (f_cnt_t f = 0; f < m_frames; ++f)
+		{
+			for (ch_cnt_t ch = 0; ch < m_channels; ++ch)
+			{
+				*dst++ = static_cast<int16_t>(quantize(data[f][ch], Int16Scale));
+			}
+		}
+	}
+	else
+	{
+		uint8_t * dst = m_data;
+		for (f_cnt_t f = 0; f < m_frames; ++f)
+		{
+			for (ch_cnt_t ch = 0; ch < m_channels; ++ch)
+			{
+				const uint32_t s = static_cast<uint32_t>(quantize(data[f][ch], Int24Scale));
+				*dst++ = s & 0xff;
+				*dst++ = (s >> 8) & 0xff;
+				*dst++ = (s >> 16) & 0xff;
+			}
+		}
+	}
+}
+
+
+
+
+CompactSamples::CompactSamples(const CompactSamples & other) :
+	m_format(other.m_format),
+	m_channels(other.m_channels),
+	m_frames(other.m_frames),
+	m_frameBytes(other.m_frameBytes),
+	m_data(MM_ALLOC<uint8_t>(bytes()))
+{
+	memcpy(m_data, other.m_data, bytes());
+}
+
+
+
+
+CompactSamples::~CompactSamples()
+{
+	MM_FREE(m_data);
+}
+
+
+
+
+void CompactSamples::read(sampleFrame * dst, f_cnt_t index, f_cnt_t count) const
+{
+	const uint8_t * src = m_data + static_cast<size_t>(index) * m_frameBytes;
+	if (m_format == Format::Int16)
+	{
+		readInt16(dst, reinterpret_cast<const int16_t *>(src), count, m_channels);
+	}
+	else
+	{
+		readInt24(dst, src, count, m_channels);
+	}
+}
+
+
+
+
+void CompactSamples::readBackwards(sampleFrame * dst, f_cnt_t index, f_cnt_t count) const
+{
+	read(dst, index - count + 1, count);
+	std::reverse(dst, dst + count);
+}
+
+
+
+
+void CompactSamples::reverse()
+{
+	uint8_t tmp[6];
+	uint8_t * front = m_data;
+	uint8_t * back = m_data + bytes() - m_frameBytes;
+	for (; front < back; front += m_frameBytes, back -= m_frameBytes)
+	{
+		memcpy(tmp, front, m_frameBytes);
+		memcpy(front, back, m_frameBytes);
+		memcpy(back, tmp, m_frameBytes);
+	}
+}
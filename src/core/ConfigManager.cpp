@@ -219,6 +219,12 @@ bool ConfigManager::hasWorkingDir() const
 }
 
 
+QString ConfigManager::configDir() const
+{
+	return ensureTrailingSlash(QFileInfo(m_lmmsRcFile).absolutePath());
+}
+
+
 void ConfigManager::setWorkingDir(const QString & workingDir)
 {
 	m_workingDir = ensureTrailingSlash(QDir::cleanPath(workingDir));
@@ -316,6 +322,7 @@ void ConfigManager::addRecentlyOpenedProject(const QString & file)
 	QFileInfo recentFile(file);
 	if(recentFile.suffix().toLower() == "mmp" ||
 		recentFile.suffix().toLower() == "mmpz" ||
+		recentFile.suffix().toLower() == "mmpb" ||
 		recentFile.suffix().toLower() == "mpt")
 	{
 		m_recentlyOpenedProjects.removeAll(file);
@@ -384,6 +391,7 @@ void ConfigManager::setValue(const QString & cls,
 	}
 	// not in map yet, so we have to add it...
 	m_settings[cls].push_back(qMakePair(attribute, value));
+	emit valueChanged(cls, attribute, value);
 }
 
 
@@ -30,6 +30,7 @@
 
 
 #include "Song.h"
+#include "lmms_math.h"
 #include "AudioEngine.h"
 #include "ControllerConnection.h"
 #include "ControllerDialog.h"
@@ -112,9 +113,13 @@ float Controller::currentValue( int _offset )
 
 float Controller::value( int offset )
 {
-	if( m_bufferLastUpdated != s_periods )
+	if( m_bufferLastUpdated.load( std::memory_order_acquire ) != s_periods )
 	{
-		updateValueBuffer();
+		QMutexLocker m( &m_valueBufferMutex );
+		if( m_bufferLastUpdated != s_periods )
+		{
+			updateValueBuffer();
+		}
 	}
 	return m_valueBuffer.values()[ offset ];
 }
@@ -122,14 +127,67 @@ float Controller::value( int offset )
 
 ValueBuffer * Controller::valueBuffer()
 {
-	if( m_bufferLastUpdated != s_periods )
+	if( m_bufferLastUpdated.load( std::memory_order_acquire ) != s_periods )
 	{
-		updateValueBuffer();
+		QMutexLocker m( &m_valueBufferMutex );
+		if( m_bufferLastUpdated != s_periods )
+		{
+			updateValueBuffer();
+		}
 	}
 	return &m_valueBuffer;
 }
 
 
+ValueBuffer * Controller::scaledValueBuffer( bool logarithmic, float min, float max )
+{
+	QMutexLocker m( &m_scaledBuffersMutex );
+
+	ScaledBuffer * scaled = nullptr;
+	for( const auto & candidate : m_scaledBuffers )
+	{
+		if( candidate->logarithmic == logarithmic &&
+			candidate->min == min && candidate->max == max )
+		{
+			scaled = candidate.get();
+			break;
+		}
+	}
+	if( scaled == nullptr )
+	{
+		m_scaledBuffers.emplace_back( new ScaledBuffer{ logarithmic, min, max, -1,
+					ValueBuffer( m_valueBuffer.length() ) } );
+		scaled = m_scaledBuffers.back().get();
+	}
+
+	if( scaled->lastUpdated != s_periods )
+	{
+		const float * values = valueBuffer()->values();
+		float * nvalues = scaled->buffer.values();
+		const int frames = scaled->buffer.length();
+		if( logarithmic )
+		{
+			for( int i = 0; i < frames; ++i )
+			{
+				nvalues[i] = logToLinearScale( min, max, values[i] );
+			}
+		}
+		else
+		{
+			const float range = max - min;
+			for( int i = 0; i < frames; ++i )
+			{
+				nvalues[i] = min + range * values[i];
+			}
+		}
+		scaled->lastUpdated = s_periods;
+	}
+
+	return &scaled->buffer;
+}
+
+
+
 void Controller::updateValueBuffer()
 {
 	m_valueBuffer.fill(0.5f);
@@ -160,8 +218,12 @@ void Controller::triggerFrameCounter()
 		// This signal is for updating values for both stubborn knobs and for
 		// painting.  If we ever get all the widgets to use or at least check
 		// currentValue() then we can throttle the signal and only use it for
-		// GUI.
-		emit controller->valueChanged();
+		// GUI. Controllers nothing is connected to would only compute a
+		// value no one reads.
+		if( controller->m_connectionCount > 0 )
+		{
+			emit controller->valueChanged();
+		}
 	}
 
 	s_periods ++;
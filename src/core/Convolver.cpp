@@ -0,0 +1,548 @@
+/*
+ * Convolver.cpp - partitioned FFT convolution with impulse responses
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Convolver.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include "AudioEngine.h"
+#include "Engine.h"
+#include "FftPlanCache.h"
+#include "PathUtil.h"
+#include "SampleBuffer.h"
+#include "SampleCache.h"
+
+
+namespace
+{
+
+// the tail is cut into partitions of at least this many frames, and of
+// at least this many blocks
+const fpp_t TailBlockFramesMin = 2048;
+const int TailBlocksMin = 8;
+
+struct KernelKey
+{
+	SampleCache::Key file;
+	fpp_t blockSize;
+
+	bool operator==( const KernelKey & other ) const
+	{
+		return file == other.file && blockSize == other.blockSize;
+	}
+} ;
+
+// the kernels in use, so that all convolvers of a file share them
+QMutex s_kernelsMutex;
+std::vector<std::pair<KernelKey, std::weak_ptr<const ConvolutionKernel>>> s_kernels;
+
+// with s_kernelsMutex locked
+ConvolutionKernel::Ptr findKernel( const KernelKey & key )
+{
+	for( const auto & entry : s_kernels )
+	{
+		if( entry.first == key )
+		{
+			ConvolutionKernel::Ptr kernel = entry.second.lock();
+			if( kernel )
+			{
+				return kernel;
+			}
+		}
+	}
+	return nullptr;
+}
+
+
+// the floats from one channel's window to the next, padded like
+// ConvolutionKernel::binStride()
+int windowStride( fpp_t size )
+{
+	return ( 2 * size + 15 ) / 16 * 16;
+}
+
+
+FftwArray<float> allocateReal( size_t size )
+{
+	FftwArray<float> array( fftwf_alloc_real( size ) );
+	std::fill( array.get(), array.get() + size, 0.0f );
+	return array;
+}
+
+
+FftwArray<fftwf_complex> allocateComplex( size_t size )
+{
+	FftwArray<fftwf_complex> array( fftwf_alloc_complex( size ) );
+	memset( array.get(), 0, size * sizeof( fftwf_complex ) );
+	return array;
+}
+
+
+// @p sum += @p a * @p b for @p bins complex values
+void multiplyAdd( fftwf_complex * sum, const fftwf_complex * a,
+					const fftwf_complex * b, int bins )
+{
+	for( int i = 0; i < bins; ++i )
+	{
+		const float re = a[i][0] * b[i][0] - a[i][1] * b[i][1];
+		const float im = a[i][0] * b[i][1] + a[i][1] * b[i][0];
+		sum[i][0] += re;
+		sum[i][1] += im;
+	}
+}
+
+
+QThreadPool & pool()
+{
+	static QThreadPool pool;
+	return pool;
+}
+
+} // namespace
+
+
+
+
+ConvolutionKernel::ConvolutionKernel( const sampleFrame * ir, f_cnt_t frames, fpp_t blockSize ) :
+	m_blockSize( blockSize ),
+	m_tailBlockSize( blockSize * qMax<int>( TailBlocksMin,
+				( TailBlockFramesMin + blockSize - 1 ) / blockSize ) ),
+	m_headPartitions( qMax<int>( 1, ( qMin<f_cnt_t>( frames, m_tailBlockSize ) +
+						blockSize - 1 ) / blockSize ) ),
+	// what is left after the head, rounded up to whole partitions
+	m_tailPartitions( frames > m_tailBlockSize ? ( frames - 1 ) / m_tailBlockSize : 0 )
+{
+	// a placeholder partition if there's no tail, so nothing is null
+	m_head = allocateComplex( static_cast<size_t>( m_headPartitions ) *
+					DEFAULT_CHANNELS * binStride( m_blockSize ) );
+	m_tail = allocateComplex( static_cast<size_t>( qMax( m_tailPartitions, 1 ) ) *
+					DEFAULT_CHANNELS * binStride( m_tailBlockSize ) );
+
+	transform( ir, qMin<f_cnt_t>( frames, m_tailBlockSize ),
+					m_blockSize, m_headPartitions, m_head.get() );
+	if( m_tailPartitions > 0 )
+	{
+		transform( ir + m_tailBlockSize, frames - m_tailBlockSize,
+					m_tailBlockSize, m_tailPartitions, m_tail.get() );
+	}
+}
+
+
+
+
+void ConvolutionKernel::transform( const sampleFrame * ir, f_cnt_t frames,
+				fpp_t partitionSize, int partitions, fftwf_complex * out )
+{
+	const int fftSize = 2 * partitionSize;
+	FftwArray<float> window = allocateReal( fftSize );
+	const fftwf_plan plan = FftPlanCache::realToComplex( fftSize, window.get(), out );
+	// FFTW doesn't normalize, so the inverse transform of the products is
+	// scaled here once and for all
+	const float scale = 1.0f / fftSize;
+
+	for( int p = 0; p < partitions; ++p )
+	{
+		const f_cnt_t start = static_cast<f_cnt_t>( p ) * partitionSize;
+		const f_cnt_t count = qMin<f_cnt_t>( partitionSize, frames - start );
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			// the second half stays zero, so the circular convolution
+			// doesn't wrap around
+			for( f_cnt_t f = 0; f < count; ++f )
+			{
+				window[f] = ir[start + f][ch] * scale;
+			}
+			std::fill( window.get() + count, window.get() + partitionSize, 0.0f );
+			fftwf_execute_dft_r2c( plan, window.get(),
+				out + ( p * DEFAULT_CHANNELS + ch ) * binStride( partitionSize ) );
+		}
+	}
+}
+
+
+
+
+ConvolutionKernel::Ptr ConvolutionKernel::load( const QString & file, fpp_t blockSize )
+{
+	const KernelKey key{ SampleCache::keyOf( PathUtil::toAbsolute( file ),
+			Engine::audioEngine()->processingSampleRate() ), blockSize };
+	if( !key.file.isValid() || blockSize == 0 )
+	{
+		return nullptr;
+	}
+
+	{
+		QMutexLocker lock( &s_kernelsMutex );
+		ConvolutionKernel::Ptr kernel = findKernel( key );
+		if( kernel )
+		{
+			return kernel;
+		}
+	}
+
+	// decodes at the engine's sample rate, through the sample cache
+	SampleBuffer buffer( file );
+	if( buffer.frames() == 0 || buffer.data() == nullptr )
+	{
+		return nullptr;
+	}
+	ConvolutionKernel::Ptr kernel = std::make_shared<const ConvolutionKernel>(
+					buffer.data(), buffer.frames(), blockSize );
+
+	QMutexLocker lock( &s_kernelsMutex );
+	// another convolver may have loaded the same file meanwhile
+	ConvolutionKernel::Ptr loaded = findKernel( key );
+	if( loaded )
+	{
+		return loaded;
+	}
+	s_kernels.erase( std::remove_if( s_kernels.begin(), s_kernels.end(),
+		[]( const std::pair<KernelKey, std::weak_ptr<const ConvolutionKernel>> & entry )
+		{
+			return entry.second.expired();
+		} ), s_kernels.end() );
+	s_kernels.emplace_back( key, kernel );
+	return kernel;
+}
+
+
+
+
+Convolver::Convolver( ConvolutionKernel::Ptr kernel ) :
+	m_kernel( std::move( kernel ) ),
+	m_headPosition( 0 ),
+	m_tailPosition( 0 ),
+	m_tailStep( 0 )
+{
+	const fpp_t size = m_kernel->blockSize();
+	const fpp_t tailSize = m_kernel->tailBlockSize();
+	const int bins = ConvolutionKernel::binStride( size );
+	const int tailBins = ConvolutionKernel::binStride( tailSize );
+	const int tailPartitions = qMax( m_kernel->tailPartitions(), 1 );
+
+	m_headWindow = allocateReal( DEFAULT_CHANNELS * windowStride( size ) );
+	m_headHistory = allocateComplex( static_cast<size_t>( m_kernel->headPartitions() ) *
+						DEFAULT_CHANNELS * bins );
+	m_headSpectrum = allocateComplex( bins );
+	m_headOutput = allocateReal( 2 * size );
+	m_headForward = FftPlanCache::realToComplex( 2 * size,
+					m_headWindow.get(), m_headHistory.get() );
+	m_headBackward = FftPlanCache::complexToReal( 2 * size,
+					m_headSpectrum.get(), m_headOutput.get() );
+
+	m_tailWindow = allocateReal( DEFAULT_CHANNELS * windowStride( tailSize ) );
+	m_tailHistory = allocateComplex( static_cast<size_t>( tailPartitions ) *
+						DEFAULT_CHANNELS * tailBins );
+	m_tailSpectrum = allocateComplex( DEFAULT_CHANNELS * tailBins );
+	m_tailOutput = allocateReal( DEFAULT_CHANNELS * tailSize );
+	m_tailScratch = allocateReal( 2 * tailSize );
+	m_tailForward = FftPlanCache::realToComplex( 2 * tailSize,
+					m_tailWindow.get(), m_tailHistory.get() );
+	m_tailBackward = FftPlanCache::complexToReal( 2 * tailSize,
+					m_tailSpectrum.get(), m_tailScratch.get() );
+}
+
+
+
+
+void Convolver::process( const sampleFrame * in, sampleFrame * out, fpp_t frames )
+{
+	const fpp_t size = blockSize();
+	for( fpp_t f = 0; f + size <= frames; f += size )
+	{
+		processBlock( in + f, out + f );
+	}
+}
+
+
+
+
+void Convolver::clear()
+{
+	const fpp_t size = blockSize();
+	const fpp_t tailSize = m_kernel->tailBlockSize();
+	const int bins = ConvolutionKernel::binStride( size );
+	const int tailBins = ConvolutionKernel::binStride( tailSize );
+
+	std::fill( m_headWindow.get(), m_headWindow.get() +
+			DEFAULT_CHANNELS * windowStride( size ), 0.0f );
+	memset( m_headHistory.get(), 0, sizeof( fftwf_complex ) *
+			m_kernel->headPartitions() * DEFAULT_CHANNELS * bins );
+	std::fill( m_tailWindow.get(), m_tailWindow.get() +
+			DEFAULT_CHANNELS * windowStride( tailSize ), 0.0f );
+	memset( m_tailHistory.get(), 0, sizeof( fftwf_complex ) *
+			qMax( m_kernel->tailPartitions(), 1 ) * DEFAULT_CHANNELS * tailBins );
+	memset( m_tailSpectrum.get(), 0, sizeof( fftwf_complex ) * DEFAULT_CHANNELS * tailBins );
+	std::fill( m_tailOutput.get(), m_tailOutput.get() + DEFAULT_CHANNELS * tailSize, 0.0f );
+	m_headPosition = 0;
+	m_tailPosition = 0;
+	m_tailStep = 0;
+}
+
+
+
+
+void Convolver::processBlock( const sampleFrame * in, sampleFrame * out )
+{
+	const ConvolutionKernel & kernel = *m_kernel;
+	const fpp_t size = kernel.blockSize();
+	const fpp_t tailSize = kernel.tailBlockSize();
+	const int bins = ConvolutionKernel::binStride( size );
+	const int partitions = kernel.headPartitions();
+	const bool tail = kernel.tailPartitions() > 0;
+
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		// overlap-save: the transform of the last two blocks gives the
+		// convolution of the newer one, wrapped around into the older one
+		float * window = m_headWindow.get() + ch * windowStride( size );
+		float * tailWindow = m_tailWindow.get() + ch * windowStride( tailSize ) +
+							tailSize + m_tailStep * size;
+		std::copy( window + size, window + 2 * size, window );
+		for( fpp_t f = 0; f < size; ++f )
+		{
+			window[size + f] = in[f][ch];
+			tailWindow[f] = in[f][ch];
+		}
+
+		fftwf_complex * history = m_headHistory.get();
+		fftwf_execute_dft_r2c( m_headForward, window,
+			history + ( m_headPosition * DEFAULT_CHANNELS + ch ) * bins );
+
+		// the spectra of the blocks that went in are kept, so only the
+		// newest is transformed and each is multiplied with the partition
+		// of its age
+		fftwf_complex * spectrum = m_headSpectrum.get();
+		memset( spectrum, 0, sizeof( fftwf_complex ) * ( size + 1 ) );
+		for( int p = 0; p < partitions; ++p )
+		{
+			const int block = ( m_headPosition - p + partitions ) % partitions;
+			multiplyAdd( spectrum, history + ( block * DEFAULT_CHANNELS + ch ) * bins,
+					kernel.headPartition( p, ch ), size + 1 );
+		}
+		fftwf_execute_dft_c2r( m_headBackward, spectrum, m_headOutput.get() );
+
+		const float * head = m_headOutput.get() + size;
+		if( tail )
+		{
+			const float * tailOutput = m_tailOutput.get() + ch * tailSize + m_tailStep * size;
+			for( fpp_t f = 0; f < size; ++f )
+			{
+				out[f][ch] = head[f] + tailOutput[f];
+			}
+		}
+		else
+		{
+			for( fpp_t f = 0; f < size; ++f )
+			{
+				out[f][ch] = head[f];
+			}
+		}
+	}
+	m_headPosition = ( m_headPosition + 1 ) % partitions;
+
+	if( tail )
+	{
+		// the older tail blocks are done a few partitions per block, so
+		// only the newest one is left once the tail block is complete
+		const int blocks = tailSize / size;
+		const int perBlock = ( kernel.tailPartitions() - 1 + blocks - 1 ) / blocks;
+		const int first = 1 + m_tailStep * perBlock;
+		accumulateTail( first, qMin( first + perBlock, kernel.tailPartitions() ) );
+		if( ++m_tailStep == blocks )
+		{
+			finishTailBlock();
+		}
+	}
+}
+
+
+
+
+void Convolver::accumulateTail( int firstPartition, int lastPartition )
+{
+	const ConvolutionKernel & kernel = *m_kernel;
+	const fpp_t tailSize = kernel.tailBlockSize();
+	const int bins = ConvolutionKernel::binStride( tailSize );
+	const int partitions = kernel.tailPartitions();
+
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		fftwf_complex * spectrum = m_tailSpectrum.get() + ch * bins;
+		for( int p = firstPartition; p < lastPartition; ++p )
+		{
+			// the newest tail block goes into m_tailPosition once complete
+			const int block = ( m_tailPosition - p + partitions ) % partitions;
+			multiplyAdd( spectrum, m_tailHistory.get() + ( block * DEFAULT_CHANNELS + ch ) * bins,
+					kernel.tailPartition( p, ch ), tailSize + 1 );
+		}
+	}
+}
+
+
+
+
+void Convolver::finishTailBlock()
+{
+	const ConvolutionKernel & kernel = *m_kernel;
+	const fpp_t tailSize = kernel.tailBlockSize();
+	const int bins = ConvolutionKernel::binStride( tailSize );
+
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		float * window = m_tailWindow.get() + ch * windowStride( tailSize );
+		fftwf_complex * newest = m_tailHistory.get() +
+					( m_tailPosition * DEFAULT_CHANNELS + ch ) * bins;
+		fftwf_complex * spectrum = m_tailSpectrum.get() + ch * bins;
+		fftwf_execute_dft_r2c( m_tailForward, window, newest );
+		multiplyAdd( spectrum, newest, kernel.tailPartition( 0, ch ), tailSize + 1 );
+		fftwf_execute_dft_c2r( m_tailBackward, spectrum, m_tailScratch.get() );
+
+		// the tail starts one tail block into the response, which is
+		// the latency of its blocks, so it's played over the next one
+		std::copy( m_tailScratch.get() + tailSize, m_tailScratch.get() + 2 * tailSize,
+					m_tailOutput.get() + ch * tailSize );
+		memset( spectrum, 0, sizeof( fftwf_complex ) * ( tailSize + 1 ) );
+		std::copy( window + tailSize, window + 2 * tailSize, window );
+	}
+	m_tailPosition = ( m_tailPosition + 1 ) % kernel.tailPartitions();
+	m_tailStep = 0;
+}
+
+
+
+
+struct ConvolverLoader::Request
+{
+	QMutex mutex;
+	// nullptr once the loader is gone or another load was started
+	ConvolverLoader * loader = nullptr;
+	std::unique_ptr<Convolver> convolver;
+	bool finished = false;
+} ;
+
+
+
+
+class ConvolverLoadJob : public QRunnable
+{
+public:
+	ConvolverLoadJob( std::shared_ptr<ConvolverLoader::Request> request,
+				const QString & file, fpp_t blockSize ) :
+		m_request( std::move( request ) ),
+		m_file( file ),
+		m_blockSize( blockSize )
+	{
+	}
+
+	void run() override
+	{
+		std::unique_ptr<Convolver> convolver;
+		ConvolutionKernel::Ptr kernel = ConvolutionKernel::load( m_file, m_blockSize );
+		if( kernel )
+		{
+			convolver.reset( new Convolver( std::move( kernel ) ) );
+		}
+
+		QMutexLocker lock( &m_request->mutex );
+		if( m_request->loader != nullptr )
+		{
+			m_request->convolver = std::move( convolver );
+			m_request->finished = true;
+			// the loader can't be deleted while the mutex is locked,
+			// and Qt drops the call if it is deleted before it's run
+			QMetaObject::invokeMethod( m_request->loader, "finish", Qt::QueuedConnection );
+		}
+	}
+
+private:
+	std::shared_ptr<ConvolverLoader::Request> m_request;
+	QString m_file;
+	fpp_t m_blockSize;
+} ;
+
+
+
+
+ConvolverLoader::ConvolverLoader() = default;
+
+
+
+
+ConvolverLoader::~ConvolverLoader()
+{
+	if( m_request )
+	{
+		QMutexLocker lock( &m_request->mutex );
+		m_request->loader = nullptr;
+	}
+}
+
+
+
+
+void ConvolverLoader::load( const QString & file, fpp_t blockSize )
+{
+	if( m_request )
+	{
+		QMutexLocker lock( &m_request->mutex );
+		m_request->loader = nullptr;
+	}
+	m_request = std::make_shared<Request>();
+	m_request->loader = this;
+	pool().start( new ConvolverLoadJob( m_request, file, blockSize ) );
+}
+
+
+
+
+std::unique_ptr<Convolver> ConvolverLoader::take()
+{
+	return std::move( m_convolver );
+}
+
+
+
+
+void ConvolverLoader::finish()
+{
+	{
+		QMutexLocker lock( &m_request->mutex );
+		// also called for loads that were superseded meanwhile
+		if( !m_request->finished )
+		{
+			return;
+		}
+		m_request->finished = false;
+		m_convolver = std::move( m_request->convolver );
+	}
+	emit loaded();
+}
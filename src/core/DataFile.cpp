@@ -29,13 +29,18 @@
 #include <math.h>
 #include <map>
 
+#include <QDataStream>
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
 #include <QMessageBox>
+#include <QMutex>
+#include <QSaveFile>
+#include <QVector>
 
 #include "base64.h"
+#include "BinaryDocument.h"
 #include "ConfigManager.h"
 #include "Effect.h"
 #include "embed.h"
@@ -51,6 +56,77 @@
 
 static void findIds(const QDomElement& elem, QList<jo_id_t>& idList);
 
+typedef QHash<QString, QVector<QDomElement>> ElementsByName;
+
+//! The elements below @p parent with any of the names, found in one walk
+//! over the tree. Unlike the lists of elementsByTagName(), these don't
+//! follow changes of the document, so they aren't searched again after
+//! each node that is added, removed or renamed while upgrading.
+static ElementsByName elementsByNames( const QDomNode & parent, const QStringList & names )
+{
+	ElementsByName elements;
+	for( const QString & name : names )
+	{
+		elements[name];
+	}
+	QDomNode node = parent.firstChild();
+	while( !node.isNull() )
+	{
+		if( node.isElement() )
+		{
+			auto it = elements.find( node.nodeName() );
+			if( it != elements.end() )
+			{
+				it->append( node.toElement() );
+			}
+		}
+		QDomNode next = node.firstChild();
+		while( next.isNull() && !node.isNull() && node != parent )
+		{
+			next = node.nextSibling();
+			node = node.parentNode();
+		}
+		node = next;
+	}
+	return elements;
+}
+
+static QVector<QDomElement> elementsByName( const QDomNode & parent, const QString & name )
+{
+	return elementsByNames( parent, { name } ).value( name );
+}
+
+
+namespace
+{
+
+const char ArchiveMagic[] = "LMMSARC1";
+const int ArchiveMagicSize = 8;
+const quint32 ArchiveVersion = 1;
+// entries start at multiples of this, for reading them from a mapping
+const qint64 ArchiveAlignment = 16;
+const QString XmlEntry = "project.xml";
+// instead of XmlEntry in binary projects (.mmpb)
+const QString BinaryEntry = "project.bin";
+const QString EmbeddedPrefix = "embedded:";
+
+// for embedded() to find the file an element belongs to
+QMutex s_dataFilesMutex;
+QList<DataFile *> s_dataFiles;
+
+void registerDataFile( DataFile * dataFile )
+{
+	QMutexLocker lock( &s_dataFilesMutex );
+	s_dataFiles.append( dataFile );
+}
+
+qint64 aligned( qint64 offset )
+{
+	return ( offset + ArchiveAlignment - 1 ) / ArchiveAlignment * ArchiveAlignment;
+}
+
+}
+
 
 // QMap with the DOM elements that access file resources
 const DataFile::ResourcesMap DataFile::ELEMENTS_WITH_RESOURCES = {
@@ -123,6 +199,7 @@ DataFile::DataFile( Type type ) :
 	m_content = createElement( typeName( type ) );
 	root.appendChild( m_content );
 
+	registerDataFile( this );
 }
 
 
@@ -135,8 +212,10 @@ DataFile::DataFile( const QString & _fileName ) :
 	m_head(),
 	m_fileVersion( UPGRADE_METHODS.size() )
 {
-	QFile inFile( _fileName );
-	if( !inFile.open( QIODevice::ReadOnly ) )
+	registerDataFile( this );
+
+	auto inFile = std::make_shared<QFile>( _fileName );
+	if( !inFile->open( QIODevice::ReadOnly ) )
 	{
 		if( getGUI() != nullptr )
 		{
@@ -152,7 +231,24 @@ DataFile::DataFile( const QString & _fileName ) :
 		return;
 	}
 
-	loadData( inFile.readAll(), _fileName );
+	if( isArchive( inFile->peek( ArchiveMagicSize ) ) )
+	{
+		// embedded samples are read from the mapping when loading them
+		if( uchar * mapped = inFile->map( 0, inFile->size() ) )
+		{
+			m_archiveFile = inFile;
+			loadData( QByteArray::fromRawData( reinterpret_cast<const char *>( mapped ),
+								inFile->size() ), _fileName );
+			return;
+		}
+	}
+
+	const QByteArray data = inFile->readAll();
+	if( isArchive( data ) )
+	{
+		m_archiveData = data;
+	}
+	loadData( data, _fileName );
 }
 
 
@@ -165,14 +261,51 @@ DataFile::DataFile( const QByteArray & _data ) :
 	m_head(),
 	m_fileVersion( UPGRADE_METHODS.size() )
 {
+	registerDataFile( this );
+	if( isArchive( _data ) )
+	{
+		m_archiveData = _data;
+	}
 	loadData( _data, "<internal data>" );
 }
 
 
 
 
+DataFile::DataFile( const DataFile & other ) :
+	QDomDocument( other ),
+	m_fileName( other.m_fileName ),
+	m_content( other.m_content ),
+	m_head( other.m_head ),
+	m_type( other.m_type ),
+	m_fileVersion( other.m_fileVersion ),
+	m_embedded( other.m_embedded ),
+	m_archiveFile( other.m_archiveFile ),
+	m_archiveData( other.m_archiveData )
+{
+	registerDataFile( this );
+}
+
+
+
+
+DataFile DataFile::clone() const
+{
+	DataFile copy( *this );
+	static_cast<QDomDocument &>( copy ) = cloneNode( true ).toDocument();
+	const QDomElement root = copy.documentElement();
+	copy.m_head = root.elementsByTagName( "head" ).item( 0 ).toElement();
+	copy.m_content = root.elementsByTagName( typeName( m_type ) ).item( 0 ).toElement();
+	return copy;
+}
+
+
+
+
 DataFile::~DataFile()
 {
+	QMutexLocker lock( &s_dataFilesMutex );
+	s_dataFiles.removeOne( this );
 }
 
 
@@ -183,7 +316,7 @@ bool DataFile::validate( QString extension )
 	switch( m_type )
 	{
 	case Type::SongProject:
-		if( extension == "mmp" || extension == "mmpz" )
+		if( extension == "mmp" || extension == "mmpz" || extension == "mmpb" )
 		{
 			return true;
 		}
@@ -207,7 +340,7 @@ bool DataFile::validate( QString extension )
 		}
 		break;
 	case Type::UnknownType:
-		if (! ( extension == "mmp" || extension == "mpt" || extension == "mmpz" ||
+		if (! ( extension == "mmp" || extension == "mpt" || extension == "mmpz" || extension == "mmpb" ||
 				extension == "xpf" || extension == "xml" ||
 				( extension == "xiz" && ! getPluginFactory()->pluginSupportingExtension(extension).isNull()) ||
 				extension == "sf2" || extension == "sf3" || extension == "pat" || extension == "mid" ||
@@ -243,7 +376,8 @@ QString DataFile::nameWithExtension( const QString & _fn ) const
 		case SongProject:
 			if( extension != "mmp" &&
 					extension != "mpt" &&
-					extension != "mmpz" )
+					extension != "mmpz" &&
+					extension != "mmpb" )
 			{
 				if( ConfigManager::inst()->value( "app",
 						"nommpz" ).toInt() == 0 )
@@ -375,7 +509,20 @@ bool DataFile::writeFile(const QString& filename, bool withResources)
 	}
 
 	const QString extension = fullName.section('.', -1);
-	if (extension == "mmpz" || extension == "xptz")
+	const bool compressed = extension == "mmpz" || extension == "xptz";
+	const bool recovery = fullName == ConfigManager::inst()->recoveryFile();
+	// autosaves are only read by this version, so they don't spend their
+	// time on writing and parsing XML text
+	if (extension == "mmpb" || recovery)
+	{
+		outfile.write(archive(true));
+	}
+	// without embedded data, stay readable by older versions
+	else if (!m_embedded.isEmpty() && compressed)
+	{
+		outfile.write(archive());
+	}
+	else if (compressed)
 	{
 		QString xml;
 		QTextStream ts( &xml );
@@ -384,6 +531,7 @@ bool DataFile::writeFile(const QString& filename, bool withResources)
 	}
 	else
 	{
+		inlineEmbedded(documentElement());
 		QTextStream ts( &outfile );
 		write( ts );
 	}
@@ -417,6 +565,241 @@ bool DataFile::writeFile(const QString& filename, bool withResources)
 
 
 
+bool DataFile::writeArchive( const QString & fn )
+{
+	QSaveFile outfile( fn );
+	if( !outfile.open( QIODevice::WriteOnly ) )
+	{
+		qWarning() << "DataFile: could not open" << fn << "for writing";
+		return false;
+	}
+	outfile.write( archive( true ) );
+	return outfile.commit();
+}
+
+
+
+
+QString DataFile::embed( QDomDocument & doc, const QByteArray & data )
+{
+	QMutexLocker lock( &s_dataFilesMutex );
+	for( DataFile * dataFile : s_dataFiles )
+	{
+		// only projects are written as archives, journal and clipboard
+		// data doesn't outlive its DataFile
+		if( *dataFile == doc && ( dataFile->type() == SongProject ||
+						dataFile->type() == SongProjectTemplate ) )
+		{
+			const QString name = QString( "samples/%1" ).arg( dataFile->m_embedded.size() );
+			dataFile->m_embedded.insert( name, data );
+			return EmbeddedPrefix + name;
+		}
+	}
+	return QString::fromLatin1( data.toBase64() );
+}
+
+
+
+
+QByteArray DataFile::embedded( const QDomElement & element, const QString & attribute )
+{
+	const QString value = element.attribute( attribute );
+	if( !value.startsWith( EmbeddedPrefix ) )
+	{
+		return QByteArray::fromBase64( value.toLatin1() );
+	}
+
+	const QString name = value.mid( EmbeddedPrefix.size() );
+	const QDomDocument doc = element.ownerDocument();
+	QMutexLocker lock( &s_dataFilesMutex );
+	for( const DataFile * dataFile : s_dataFiles )
+	{
+		if( *dataFile == doc )
+		{
+			return dataFile->m_embedded.value( name );
+		}
+	}
+	// the element was imported into another document, so take it from
+	// the archive loaded last which has it
+	for( auto it = s_dataFiles.crbegin(); it != s_dataFiles.crend(); ++it )
+	{
+		if( ( *it )->m_embedded.contains( name ) )
+		{
+			return ( *it )->m_embedded.value( name );
+		}
+	}
+	qWarning() << "DataFile: embedded data" << name << "not found";
+	return QByteArray();
+}
+
+
+
+
+void DataFile::embedFrom( const DataFile & other )
+{
+	QMutexLocker lock( &s_dataFilesMutex );
+	m_embedded = other.m_embedded;
+}
+
+
+
+
+QByteArray DataFile::projectXml( const QByteArray & data )
+{
+	if( isArchive( data ) )
+	{
+		const QHash<QString, QByteArray> entries = archiveEntries( data );
+		if( entries.contains( BinaryEntry ) )
+		{
+			QDomDocument document;
+			BinaryDocument::decode( qUncompress( entries.value( BinaryEntry ) ), document );
+			return document.toByteArray();
+		}
+		return qUncompress( entries.value( XmlEntry ) );
+	}
+	const QByteArray uncompressed = qUncompress( data );
+	return uncompressed.isEmpty() ? data : uncompressed;
+}
+
+
+
+
+bool DataFile::isArchive( const QByteArray & data )
+{
+	return data.startsWith( QByteArray::fromRawData( ArchiveMagic, ArchiveMagicSize ) );
+}
+
+
+
+
+QHash<QString, QByteArray> DataFile::archiveEntries( const QByteArray & archive )
+{
+	QHash<QString, QByteArray> entries;
+
+	QDataStream in( archive );
+	in.setVersion( QDataStream::Qt_5_0 );
+	in.skipRawData( ArchiveMagicSize );
+	quint32 version = 0;
+	quint32 count = 0;
+	in >> version >> count;
+	if( version > ArchiveVersion )
+	{
+		qWarning() << "DataFile: archive version" << version << "is not supported";
+		return entries;
+	}
+
+	for( quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i )
+	{
+		QString name;
+		quint64 offset = 0;
+		quint64 size = 0;
+		in >> name >> offset >> size;
+		if( in.status() != QDataStream::Ok || offset + size > static_cast<quint64>( archive.size() ) )
+		{
+			qWarning() << "DataFile: archive entry" << name << "is broken";
+			break;
+		}
+		// no copy, the entry stays in the archive
+		entries.insert( name, QByteArray::fromRawData( archive.constData() + offset, size ) );
+	}
+	return entries;
+}
+
+
+
+
+bool DataFile::isBinaryArchive( const QHash<QString, QByteArray> & entries )
+{
+	return entries.contains( BinaryEntry );
+}
+
+
+
+
+QByteArray DataFile::archive( bool binary )
+{
+	QVector<QPair<QString, QByteArray>> entries;
+	if( binary )
+	{
+		// the fastest level, most of the size is gone with the text anyway
+		entries.append( qMakePair( BinaryEntry, qCompress( BinaryDocument::encode( *this ), 1 ) ) );
+	}
+	else
+	{
+		QString xml;
+		QTextStream ts( &xml );
+		write( ts );
+		ts.flush();
+		entries.append( qMakePair( XmlEntry, qCompress( xml.toUtf8() ) ) );
+	}
+	for( auto it = m_embedded.cbegin(); it != m_embedded.cend(); ++it )
+	{
+		entries.append( qMakePair( it.key(), it.value() ) );
+	}
+
+	auto table = [&entries]( const QVector<quint64> & offsets )
+	{
+		QByteArray header;
+		QDataStream out( &header, QIODevice::WriteOnly );
+		out.setVersion( QDataStream::Qt_5_0 );
+		out.writeRawData( ArchiveMagic, ArchiveMagicSize );
+		out << ArchiveVersion << static_cast<quint32>( entries.size() );
+		for( int i = 0; i < entries.size(); ++i )
+		{
+			out << entries[i].first << offsets[i] << static_cast<quint64>( entries[i].second.size() );
+		}
+		return header;
+	};
+
+	// the table's size doesn't depend on the offsets
+	QVector<quint64> offsets( entries.size(), 0 );
+	qint64 end = aligned( table( offsets ).size() );
+	for( int i = 0; i < entries.size(); ++i )
+	{
+		offsets[i] = end;
+		end = aligned( end + entries[i].second.size() );
+	}
+
+	QByteArray result = table( offsets );
+	result.reserve( end );
+	for( int i = 0; i < entries.size(); ++i )
+	{
+		result.append( QByteArray( offsets[i] - result.size(), '\0' ) );
+		result.append( entries[i].second );
+	}
+	return result;
+}
+
+
+
+
+void DataFile::inlineEmbedded( QDomElement element )
+{
+	if( m_embedded.isEmpty() )
+	{
+		return;
+	}
+
+	QDomNamedNodeMap attributes = element.attributes();
+	for( int i = 0; i < attributes.count(); ++i )
+	{
+		QDomAttr attribute = attributes.item( i ).toAttr();
+		if( attribute.value().startsWith( EmbeddedPrefix ) )
+		{
+			attribute.setValue( QString::fromLatin1( m_embedded.value(
+				attribute.value().mid( EmbeddedPrefix.size() ) ).toBase64() ) );
+		}
+	}
+	for( QDomElement child = element.firstChildElement(); !child.isNull();
+						child = child.nextSiblingElement() )
+	{
+		inlineEmbedded( child );
+	}
+}
+
+
+
+
 bool DataFile::copyResources(const QString& resourcesDir)
 {
 	// List of filenames used so we can append a counter to any
@@ -637,10 +1020,10 @@ void DataFile::cleanMetaNodes( QDomElement _de )
 void DataFile::upgrade_0_2_1_20070501()
 {
 	// Upgrade to version 0.2.1-20070501
-	QDomNodeList list = elementsByTagName( "arpandchords" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	const ElementsByName elements = elementsByNames( *this,
+		{ "arpandchords", "sampletrack", "ladspacontrols" } );
+	for( QDomElement el : elements["arpandchords"] )
 	{
-		QDomElement el = list.item( i ).toElement();
 		if( el.hasAttribute( "arpdir" ) )
 		{
 			int arpdir = el.attribute( "arpdir" ).toInt();
@@ -655,10 +1038,8 @@ void DataFile::upgrade_0_2_1_20070501()
 		}
 	}
 
-	list = elementsByTagName( "sampletrack" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	for( QDomElement el : elements["sampletrack"] )
 	{
-		QDomElement el = list.item( i ).toElement();
 		if( el.attribute( "vol" ) != "" )
 		{
 			el.setAttribute( "vol", LocaleHelper::toFloat(
@@ -676,10 +1057,8 @@ void DataFile::upgrade_0_2_1_20070501()
 		}
 	}
 
-	list = elementsByTagName( "ladspacontrols" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	for( QDomElement el : elements["ladspacontrols"] )
 	{
-		QDomElement el = list.item( i ).toElement();
 		QDomNode anode = el.namedItem( "automation-pattern" );
 		QDomNode node = anode.firstChild();
 		while( !node.isNull() )
@@ -776,9 +1155,8 @@ void DataFile::upgrade_0_2_1_20070508()
 		}
 	}
 
-	while( !( list = elementsByTagName( "channeltrack" ) ).isEmpty() )
+	for( QDomElement el : elementsByName( *this, "channeltrack" ) )
 	{
-		QDomElement el = list.item( 0 ).toElement();
 		el.setTagName( "instrumenttrack" );
 	}
 
@@ -833,25 +1211,21 @@ void DataFile::upgrade_0_3_0_rc2()
 void DataFile::upgrade_0_3_0()
 {
 	// Upgrade to version 0.3.0 (final) from some version greater than or equal to 0.3.0-rc2
-	QDomNodeList list;
-	while( !( list = elementsByTagName(
-				"pluckedstringsynth" ) ).isEmpty() )
+	const ElementsByName elements = elementsByNames( *this,
+		{ "pluckedstringsynth", "lb303", "channelsettings" } );
+	for( QDomElement el : elements["pluckedstringsynth"] )
 	{
-		QDomElement el = list.item( 0 ).toElement();
 		el.setTagName( "vibedstrings" );
 		el.setAttribute( "active0", 1 );
 	}
 
-	while( !( list = elementsByTagName( "lb303" ) ).isEmpty() )
+	for( QDomElement el : elements["lb303"] )
 	{
-		QDomElement el = list.item( 0 ).toElement();
 		el.setTagName( "lb302" );
 	}
 
-	while( !( list = elementsByTagName( "channelsettings" ) ).
-							isEmpty() )
+	for( QDomElement el : elements["channelsettings"] )
 	{
-		QDomElement el = list.item( 0 ).toElement();
 		el.setTagName( "instrumenttracksettings" );
 	}
 }
@@ -876,12 +1250,10 @@ void DataFile::upgrade_0_4_0_20080104()
 void DataFile::upgrade_0_4_0_20080118()
 {
 	// Upgrade to version 0.4.0-20080118 from some version greater than or equal to 0.4.0-20080104
-	QDomNodeList list;
-	while( !( list = elementsByTagName( "fx" ) ).isEmpty() )
+	for( QDomElement fxchain : elementsByName( *this, "fx" ) )
 	{
-		QDomElement fxchain = list.item( 0 ).toElement();
 		fxchain.setTagName( "fxchain" );
-		QDomNode rack = list.item( 0 ).firstChild();
+		QDomNode rack = fxchain.firstChild();
 		QDomNodeList effects = rack.childNodes();
 		// move items one level up
 		while( effects.count() )
@@ -898,11 +1270,8 @@ void DataFile::upgrade_0_4_0_20080118()
 void DataFile::upgrade_0_4_0_20080129()
 {
 	// Upgrade to version 0.4.0-20080129 from some version greater than or equal to 0.4.0-20080118
-	QDomNodeList list;
-	while( !( list =
-		elementsByTagName( "arpandchords" ) ).isEmpty() )
+	for( QDomElement aac : elementsByName( *this, "arpandchords" ) )
 	{
-		QDomElement aac = list.item( 0 ).toElement();
 		aac.setTagName( "arpeggiator" );
 		QDomNode cloned = aac.cloneNode();
 		cloned.toElement().setTagName( "chordcreator" );
@@ -914,24 +1283,20 @@ void DataFile::upgrade_0_4_0_20080129()
 void DataFile::upgrade_0_4_0_20080409()
 {
 	// Upgrade to version 0.4.0-20080409 from some version greater than or equal to 0.4.0-20080129
-	QStringList s;
-	s << "note" << "pattern" << "bbtco" << "sampletco" << "time";
-	for( QStringList::iterator it = s.begin(); it < s.end(); ++it )
+	const QStringList s = { "note", "pattern", "bbtco", "sampletco", "time" };
+	const ElementsByName elements = elementsByNames( *this, QStringList( s ) << "timeline" );
+	for( const QString & name : s )
 	{
-		QDomNodeList list = elementsByTagName( *it );
-		for( int i = 0; !list.item( i ).isNull(); ++i )
+		for( QDomElement el : elements[name] )
 		{
-			QDomElement el = list.item( i ).toElement();
 			el.setAttribute( "pos",
 				el.attribute( "pos" ).toInt()*3 );
 			el.setAttribute( "len",
 				el.attribute( "len" ).toInt()*3 );
 		}
 	}
-	QDomNodeList list = elementsByTagName( "timeline" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	for( QDomElement el : elements["timeline"] )
 	{
-		QDomElement el = list.item( i ).toElement();
 		el.setAttribute( "lp0pos",
 			el.attribute( "lp0pos" ).toInt()*3 );
 		el.setAttribute( "lp1pos",
@@ -943,10 +1308,8 @@ void DataFile::upgrade_0_4_0_20080409()
 void DataFile::upgrade_0_4_0_20080607()
 {
 	// Upgrade to version 0.4.0-20080607 from some version greater than or equal to 0.3.0-20080409
-	QDomNodeList list;
-	while( !( list = elementsByTagName( "midi" ) ).isEmpty() )
+	for( QDomElement el : elementsByName( *this, "midi" ) )
 	{
-		QDomElement el = list.item( 0 ).toElement();
 		el.setTagName( "midiport" );
 	}
 }
@@ -955,18 +1318,15 @@ void DataFile::upgrade_0_4_0_20080607()
 void DataFile::upgrade_0_4_0_20080622()
 {
 	// Upgrade to version 0.4.0-20080622 from some version greater than or equal to 0.3.0-20080607
-	QDomNodeList list;
-	while( !( list = elementsByTagName(
-				"automation-pattern" ) ).isEmpty() )
+	const ElementsByName elements = elementsByNames( *this,
+		{ "automation-pattern", "bbtrack" } );
+	for( QDomElement el : elements["automation-pattern"] )
 	{
-		QDomElement el = list.item( 0 ).toElement();
 		el.setTagName( "automationpattern" );
 	}
 
-	list = elementsByTagName( "bbtrack" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	for( QDomElement el : elements["bbtrack"] )
 	{
-		QDomElement el = list.item( i ).toElement();
 		QString s = el.attribute( "name" );
 		s.replace( QRegExp( "^Beat/Baseline " ),
 						"Beat/Bassline " );
@@ -979,11 +1339,8 @@ void DataFile::upgrade_0_4_0_beta1()
 {
 	// Upgrade to version 0.4.0-beta1 from some version greater than or equal to 0.4.0-20080622
 	// convert binary effect-key-blobs to XML
-	QDomNodeList list;
-	list = elementsByTagName( "effect" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	for( QDomElement el : elementsByName( *this, "effect" ) )
 	{
-		QDomElement el = list.item( i ).toElement();
 		QString k = el.attribute( "key" );
 		if( !k.isEmpty() )
 		{
@@ -1017,20 +1374,18 @@ void DataFile::upgrade_0_4_0_beta1()
 void DataFile::upgrade_0_4_0_rc2()
 {
 	// Upgrade to version 0.4.0-rc2 from some version greater than or equal to 0.4.0-beta1
-	QDomNodeList list = elementsByTagName( "audiofileprocessor" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	const ElementsByName elements = elementsByNames( *this,
+		{ "audiofileprocessor", "lb302" } );
+	for( QDomElement el : elements["audiofileprocessor"] )
 	{
-		QDomElement el = list.item( i ).toElement();
 		QString s = el.attribute( "src" );
 		s.replace( "drumsynth/misc ", "drumsynth/misc_" );
 		s.replace( "drumsynth/r&b", "drumsynth/r_n_b" );
 		s.replace( "drumsynth/r_b", "drumsynth/r_n_b" );
 		el.setAttribute( "src", s );
 	}
-	list = elementsByTagName( "lb302" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	for( QDomElement el : elements["lb302"] )
 	{
-		QDomElement el = list.item( i ).toElement();
 		int s = el.attribute( "shape" ).toInt();
 		if( s >= 1 )
 		{
@@ -1048,10 +1403,9 @@ void DataFile::upgrade_1_0_99()
 	QList<jo_id_t> idList;
 	findIds(documentElement(), idList);
 
-	QDomNodeList list = elementsByTagName("ladspacontrols");
-	for(int i = 0; !list.item(i).isNull(); ++i)
+	for (const QDomElement & controls : elementsByName(*this, "ladspacontrols"))
 	{
-		for(QDomNode node = list.item(i).firstChild(); !node.isNull();
+		for(QDomNode node = controls.firstChild(); !node.isNull();
 			node = node.nextSibling())
 		{
 			QDomElement el = node.toElement();
@@ -1084,10 +1438,10 @@ void DataFile::upgrade_1_0_99()
 
 void DataFile::upgrade_1_1_0()
 {
-	QDomNodeList list = elementsByTagName("fxchannel");
-	for (int i = 1; !list.item(i).isNull(); ++i)
+	const QVector<QDomElement> list = elementsByName(*this, "fxchannel");
+	for (int i = 1; i < list.size(); ++i)
 	{
-		QDomElement el = list.item(i).toElement();
+		QDomElement el = list[i];
 		QDomElement send = createElement("send");
 		send.setAttribute("channel", "0");
 		send.setAttribute("amount", "1");
@@ -1099,28 +1453,24 @@ void DataFile::upgrade_1_1_0()
 void DataFile::upgrade_1_1_91()
 {
 	// Upgrade to version 1.1.91 from some version less than 1.1.91
-	QDomNodeList list = elementsByTagName( "audiofileprocessor" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	const ElementsByName elements = elementsByNames( *this,
+		{ "audiofileprocessor", "attribute", "crossoevereqcontrols", "arpeggiator" } );
+	for( QDomElement el : elements["audiofileprocessor"] )
 	{
-		QDomElement el = list.item( i ).toElement();
 		QString s = el.attribute( "src" );
 		s.replace( QRegExp("/samples/bassloopes/"), "/samples/bassloops/" );
 		el.setAttribute( "src", s );
 	}
 
-	list = elementsByTagName( "attribute" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	for( QDomElement el : elements["attribute"] )
 	{
-		QDomElement el = list.item( i ).toElement();
 		if( el.attribute( "name" ) == "plugin" && el.attribute( "value" ) == "vocoder-lmms" ) {
 			el.setAttribute( "value", "vocoder" );
 		}
 	}
 
-	list = elementsByTagName( "crossoevereqcontrols" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	for( QDomElement el : elements["crossoevereqcontrols"] )
 	{
-		QDomElement el = list.item( i ).toElement();
 		// invert the mute LEDs
 		for( int j = 1; j <= 4; ++j ){
 			QString a = QString( "mute%1" ).arg( j );
@@ -1128,10 +1478,8 @@ void DataFile::upgrade_1_1_91()
 		}
 	}
 
-	list = elementsByTagName( "arpeggiator" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	for( QDomElement el : elements["arpeggiator"] )
 	{
-		QDomElement el = list.item( i ).toElement();
 		// Swap elements ArpDirRandom and ArpDirDownAndUp
 		if( el.attribute( "arpdir" ) == "3" )
 		{
@@ -1273,10 +1621,9 @@ QDebug operator<<(QDebug dbg, const QDomNode& node)
 
 void DataFile::upgrade_1_3_0()
 {
-	QDomNodeList list = elementsByTagName( "instrument" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	const ElementsByName elements = elementsByNames( *this, { "instrument", "effect" } );
+	for( QDomElement el : elements["instrument"] )
 	{
-		QDomElement el = list.item( i ).toElement();
 		if( el.attribute( "name" ) == "papu" )
 		{
 			el.setAttribute( "name", "freeboy" );
@@ -1299,10 +1646,8 @@ void DataFile::upgrade_1_3_0()
 		}
 	}
 
-	list = elementsByTagName( "effect" );
-	for( int i = 0; !list.item( i ).isNull(); ++i )
+	for( QDomElement effect : elements["effect"] )
 	{
-		QDomElement effect = list.item( i ).toElement();
 		if( effect.attribute( "name" ) == "ladspaeffect" )
 		{
 			QDomNodeList keys = effect.elementsByTagName( "key" );
@@ -1763,28 +2108,27 @@ void DataFile::upgrade_defaultTripleOscillatorHQ()
 // Remove FX prefix from mixer and related nodes
 void DataFile::upgrade_mixerRename()
 {
+	const ElementsByName elements = elementsByNames(*this, {"fxmixer", "fxchannel", "instrumenttrack"});
+
 	// Change nodename <fxmixer> to <mixer>
-	QDomNodeList fxmixer = elementsByTagName("fxmixer");
-	for (int i = 0; !fxmixer.item(i).isNull(); ++i)
+	for (QDomElement el : elements["fxmixer"])
 	{
-		fxmixer.item(i).toElement().setTagName("mixer");
+		el.setTagName("mixer");
 	}
 
 	// Change nodename <fxchannel> to <mixerchannel>
-	QDomNodeList fxchannel = elementsByTagName("fxchannel");
-	for (int i = 0; !fxchannel.item(i).isNull(); ++i)
+	for (QDomElement el : elements["fxchannel"])
 	{
-		fxchannel.item(i).toElement().setTagName("mixerchannel");
+		el.setTagName("mixerchannel");
 	}
 
 	// Change the attribute fxch of element <instrumenttrack> to mixch
-	QDomNodeList fxch = elementsByTagName("instrumenttrack");
-	for(int i = 0; !fxch.item(i).isNull(); ++i)
+	for (QDomElement el : elements["instrumenttrack"])
 	{
-		if(fxch.item(i).toElement().hasAttribute("fxch"))
+		if (el.hasAttribute("fxch"))
 		{
-			fxch.item(i).toElement().setAttribute("mixch", fxch.item(i).toElement().attribute("fxch"));
-			fxch.item(i).toElement().removeAttribute("fxch");
+			el.setAttribute("mixch", el.attribute("fxch"));
+			el.removeAttribute("fxch");
 		}
 	}
 }
@@ -1831,9 +2175,29 @@ void DataFile::upgrade()
 
 void DataFile::loadData( const QByteArray & _data, const QString & _sourceFile )
 {
+	bool decoded = false;
+	if( isArchive( _data ) )
+	{
+		m_embedded = archiveEntries( _data );
+		if( isBinaryArchive( m_embedded ) )
+		{
+			decoded = BinaryDocument::decode( qUncompress( m_embedded.take( BinaryEntry ) ), *this );
+		}
+		else
+		{
+			const QByteArray xml = qUncompress( m_embedded.take( XmlEntry ) );
+			if( !xml.isEmpty() )
+			{
+				loadData( xml, _sourceFile );
+				return;
+			}
+		}
+		// the broken archive fails below
+	}
+
 	QString errorMsg;
 	int line = -1, col = -1;
-	if( !setContent( _data, &errorMsg, &line, &col ) )
+	if( !decoded && !setContent( _data, &errorMsg, &line, &col ) )
 	{
 		// parsing failed? then try to uncompress data
 		QByteArray uncompressed = qUncompress( _data );
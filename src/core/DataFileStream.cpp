@@ -0,0 +1,427 @@
+/*
+ * DataFileStream.cpp - reads a project one element at a time
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "DataFileStream.h"
+
+#include <QFile>
+#include <QStringList>
+
+#include "DataFile.h"
+#include "PathUtil.h"
+#include "ProjectVersion.h"
+
+#include "lmmsversion.h"
+
+
+namespace
+{
+
+//! Copies the element @p reader is at, with everything below it
+void copyElement(QXmlStreamReader & reader, QXmlStreamWriter & writer)
+{
+	int depth = 0;
+	do
+	{
+		writer.writeCurrentToken(reader);
+		if (reader.isStartElement()) { ++depth; }
+		else if (reader.isEndElement()) { --depth; }
+	}
+	while (depth > 0 && reader.readNext() != QXmlStreamReader::Invalid);
+}
+
+}
+
+
+
+
+DataFileStream::DataFileStream(const QString & fileName) :
+	m_hasLocalPlugins(false),
+	m_atElement(false),
+	m_atEnd(true)
+{
+	auto file = std::make_shared<QFile>(fileName);
+	if (!file->open(QIODevice::ReadOnly))
+	{
+		return;
+	}
+
+	// loaded the same way as by DataFile, which is also where the
+	// embedded data is found while loading
+	std::unique_ptr<DataFile> header(new DataFile(DataFile::SongProject));
+	header->m_fileName = fileName;
+	QByteArray data;
+	if (DataFile::isArchive(file->peek(16)))
+	{
+		if (uchar * mapped = file->map(0, file->size()))
+		{
+			data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), file->size());
+			header->m_archiveFile = file;
+		}
+		else
+		{
+			data = file->readAll();
+			header->m_archiveData = data;
+		}
+		header->m_embedded = DataFile::archiveEntries(data);
+		if (DataFile::isBinaryArchive(header->m_embedded))
+		{
+			// decoding the whole binary document is faster than streaming XML
+			return;
+		}
+	}
+	else
+	{
+		data = file->readAll();
+	}
+	m_xml = DataFile::projectXml(data);
+	data.clear();
+
+	// one pass over everything, so that loading doesn't fail half way
+	QByteArray xml = m_xml;
+	QBuffer buffer(&xml);
+	buffer.open(QIODevice::ReadOnly);
+	QXmlStreamReader reader(&buffer);
+	const QString localPrefix = PathUtil::basePrefix(PathUtil::Base::LocalDir);
+	int depth = 0;
+	while (!reader.atEnd())
+	{
+		reader.readNext();
+		if (reader.isStartElement())
+		{
+			// as in DataFile, the root's attributes aren't checked
+			if (depth > 0 && !m_hasLocalPlugins &&
+				DataFile::ELEMENTS_WITH_RESOURCES.count(reader.name().toString()) == 0)
+			{
+				for (const QXmlStreamAttribute & attribute : reader.attributes())
+				{
+					if (attribute.value().startsWith(localPrefix, Qt::CaseInsensitive))
+					{
+						m_hasLocalPlugins = true;
+					}
+				}
+			}
+			++depth;
+		}
+		else if (reader.isEndElement())
+		{
+			--depth;
+		}
+	}
+	if (reader.hasError())
+	{
+		return;
+	}
+
+	m_buffer.setBuffer(&m_xml);
+	QByteArray headerXml;
+	QXmlStreamWriter headerWriter(&headerXml);
+	if (!findContent(&headerWriter))
+	{
+		return;
+	}
+
+	// projects of older versions need DataFile's upgrades, which work on
+	// the DOM of the whole file
+	bool versionValid = false;
+	const unsigned int version = m_rootAttributes.value("version").toUInt(&versionValid);
+	if (!versionValid || version < DataFile::UPGRADE_METHODS.size() ||
+		(m_rootAttributes.hasAttribute("creatorversion") &&
+		ProjectVersion(m_rootAttributes.value("creatorversion").toString()) < ProjectVersion(LMMS_VERSION)))
+	{
+		return;
+	}
+
+	// sets the type and version, and tells about files of newer versions
+	header->loadData(headerXml, fileName);
+	if (header->head().isNull() || header->content().isNull())
+	{
+		return;
+	}
+	m_header = std::move(header);
+	m_atEnd = false;
+}
+
+
+
+
+DataFileStream::~DataFileStream()
+{
+}
+
+
+
+
+int DataFileStream::count(const QString & name, const QString & parentName) const
+{
+	QByteArray xml = m_xml;
+	QBuffer buffer(&xml);
+	buffer.open(QIODevice::ReadOnly);
+	QXmlStreamReader reader(&buffer);
+	QStringList path;
+	int count = 0;
+	while (!reader.atEnd())
+	{
+		reader.readNext();
+		if (reader.isStartElement())
+		{
+			if (reader.name() == name && !path.isEmpty() && path.last() == parentName)
+			{
+				++count;
+			}
+			path.append(reader.name().toString());
+		}
+		else if (reader.isEndElement() && !path.isEmpty())
+		{
+			path.removeLast();
+		}
+	}
+	return count;
+}
+
+
+
+
+void DataFileStream::forEachElement(const std::function<void(const QString & name,
+	const QXmlStreamAttributes & attributes)> & func) const
+{
+	QByteArray xml = m_xml;
+	QBuffer buffer(&xml);
+	buffer.open(QIODevice::ReadOnly);
+	QXmlStreamReader reader(&buffer);
+	while (!reader.atEnd())
+	{
+		if (reader.readNext() == QXmlStreamReader::StartElement)
+		{
+			func(reader.name().toString(), reader.attributes());
+		}
+	}
+}
+
+
+
+
+bool DataFileStream::next()
+{
+	if (m_atEnd)
+	{
+		return false;
+	}
+
+	m_element.reset();
+	if (m_atElement)
+	{
+		m_reader.skipCurrentElement();
+		m_atElement = false;
+	}
+
+	while (!m_reader.atEnd())
+	{
+		m_reader.readNext();
+		if (m_reader.isStartElement())
+		{
+			m_atElement = true;
+			return true;
+		}
+		if (m_reader.isEndElement())
+		{
+			if (m_entered.empty())
+			{
+				m_atEnd = true;
+			}
+			else
+			{
+				m_entered.pop_back();
+			}
+			return false;
+		}
+	}
+	m_atEnd = true;
+	return false;
+}
+
+
+
+
+QString DataFileStream::name() const
+{
+	return m_reader.name().toString();
+}
+
+
+
+
+QDomElement DataFileStream::element()
+{
+	QDomElement element;
+	if (m_atElement)
+	{
+		m_element = parse(true, element);
+		m_atElement = false;
+	}
+	return element;
+}
+
+
+
+
+QDomElement DataFileStream::enter()
+{
+	QDomElement element;
+	if (m_atElement)
+	{
+		m_entered.push_back({m_reader.name().toString(), m_reader.attributes(), nullptr});
+		m_entered.back().shell = parse(false, element);
+		m_atElement = false;
+	}
+	return element;
+}
+
+
+
+
+void DataFileStream::leave()
+{
+	const size_t depth = m_entered.size();
+	while (!m_atEnd && m_entered.size() >= depth)
+	{
+		next();
+	}
+}
+
+
+
+
+void DataFileStream::rewind()
+{
+	m_element.reset();
+	m_entered.clear();
+	m_atElement = false;
+	m_atEnd = !isValid() || !findContent(nullptr);
+}
+
+
+
+
+bool DataFileStream::findContent(QXmlStreamWriter * header)
+{
+	m_buffer.close();
+	m_buffer.open(QIODevice::ReadOnly);
+	m_reader.setDevice(&m_buffer);
+
+	if (!m_reader.readNextStartElement())
+	{
+		return false;
+	}
+	m_rootName = m_reader.name().toString();
+	m_rootAttributes = m_reader.attributes();
+	const QString type = m_rootAttributes.value("type").toString();
+	if (type != DataFile::typeName(DataFile::SongProject) &&
+		type != DataFile::typeName(DataFile::SongProjectTemplate))
+	{
+		return false;
+	}
+
+	if (header)
+	{
+		header->writeStartDocument();
+		header->writeStartElement(m_rootName);
+		header->writeAttributes(m_rootAttributes);
+	}
+	while (m_reader.readNextStartElement())
+	{
+		if (m_reader.name() == type)
+		{
+			m_contentName = type;
+			m_contentAttributes = m_reader.attributes();
+			if (header)
+			{
+				header->writeStartElement(m_contentName);
+				header->writeAttributes(m_contentAttributes);
+				header->writeEndDocument();
+			}
+			return true;
+		}
+		if (header && m_reader.name() == "head")
+		{
+			copyElement(m_reader, *header);
+		}
+		else
+		{
+			m_reader.skipCurrentElement();
+		}
+	}
+	return false;
+}
+
+
+
+
+std::unique_ptr<DataFile> DataFileStream::parse(bool withElement, QDomElement & element)
+{
+	QByteArray xml;
+	QXmlStreamWriter writer(&xml);
+	writer.writeStartDocument();
+	writer.writeStartElement(m_rootName);
+	// without the creator's version, so that it isn't checked again
+	writer.writeAttribute("version", m_rootAttributes.value("version").toString());
+	writer.writeAttribute("type", m_rootAttributes.value("type").toString());
+	writer.writeStartElement(m_contentName);
+	writer.writeAttributes(m_contentAttributes);
+	for (const Ancestor & ancestor : m_entered)
+	{
+		writer.writeStartElement(ancestor.name);
+		writer.writeAttributes(ancestor.attributes);
+	}
+	if (withElement)
+	{
+		copyElement(m_reader, writer);
+	}
+	writer.writeEndDocument();
+
+	std::unique_ptr<DataFile> dataFile = fragment(xml);
+	element = dataFile->content();
+	for (size_t i = 0; i < m_entered.size(); ++i)
+	{
+		element = element.firstChildElement();
+	}
+	if (withElement)
+	{
+		element = element.firstChildElement();
+	}
+	return dataFile;
+}
+
+
+
+
+std::unique_ptr<DataFile> DataFileStream::fragment(const QByteArray & xml) const
+{
+	std::unique_ptr<DataFile> dataFile(new DataFile(xml));
+	// for DataFile::embedded()
+	dataFile->m_fileName = m_header->m_fileName;
+	dataFile->m_embedded = m_header->m_embedded;
+	dataFile->m_archiveFile = m_header->m_archiveFile;
+	dataFile->m_archiveData = m_header->m_archiveData;
+	return dataFile;
+}
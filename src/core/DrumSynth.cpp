@@ -49,6 +49,7 @@ const int     ENV   =  1;
 const int     PNT   =  2;
 const int     dENV  =  3;
 const int     NEXTT =  4;
+const float   WaveScale = 1.f / 32767.f; //16 bit full scale to +-1
 
 // Bah, I'll move these into the class once I sepearate DrumsynthFile from DrumSynth
 // llama
@@ -259,7 +260,7 @@ float DrumSynth::GetPrivateProfileFloat(const char *sec, const char *key, float
 //  an associative array or something once we have a datastructure to load in to.
 //  llama
 
-int DrumSynth::GetDSFileSamples(QString dsfile, int16_t *&wave, int channels, sample_rate_t Fs)
+int DrumSynth::GetDSFileSamples(QString dsfile, float *&wave, int channels, sample_rate_t Fs)
 {
   //input file
   char sec[32];
@@ -458,7 +459,7 @@ int DrumSynth::GetDSFileSamples(QString dsfile, int16_t *&wave, int channels, sa
   //allocate the buffer
   //if(wave!=NULL) free(wave);
   //wave = new int16_t[channels * (Length + 1280)]; //wave memory buffer
-  wave = new int16_t[channels * Length]; //wave memory buffer
+  wave = new float[channels * Length]; //wave memory buffer
   if(wave==nullptr) {return 0;}
   wavewords = 0;
 
@@ -708,14 +709,14 @@ int DrumSynth::GetDSFileSamples(QString dsfile, int16_t *&wave, int channels, sa
     }
     else for(j=0; j<1200; j++) DF[j] *= DGain;
 
-    for(j = 0; j<1200; j++) //clipping + output
+    for(j = 0; j<1200; j++) //clipping + output, not truncated to 16 bit
     {
       if(DF[j] > clippoint)
-        wave[wavewords++] = clippoint;
+        wave[wavewords++] = clippoint * WaveScale;
       else if(DF[j] < -clippoint)
-          wave[wavewords++] = -clippoint;
+          wave[wavewords++] = -clippoint * WaveScale;
       else
-          wave[wavewords++] = (short)DF[j];
+          wave[wavewords++] = DF[j] * WaveScale;
 
       for (int c = 1; c < channels; c++)  {
         wave[wavewords] = wave[wavewords-1];
@@ -47,6 +47,8 @@ Effect::Effect( const Plugin::Descriptor * _desc,
 	m_wetDryModel( 1.0f, -1.0f, 1.0f, 0.01f, this, tr( "Wet/Dry mix" ) ),
 	m_gateModel( 0.0f, 0.0f, 1.0f, 0.01f, this, tr( "Gate" ) ),
 	m_autoQuitModel( 1.0f, 1.0f, 8000.0f, 100.0f, 1.0f, this, tr( "Decay" ) ),
+	m_oversamplingModel( this, tr( "Oversampling" ) ),
+	m_oversamplingFactor( 1 ),
 	m_autoQuitDisabled( false )
 {
 	m_srcState[0] = m_srcState[1] = nullptr;
@@ -56,6 +58,16 @@ Effect::Effect( const Plugin::Descriptor * _desc,
 	{
 		m_autoQuitDisabled = true;
 	}
+
+	m_oversamplingModel.addItem( tr( "Off" ) );
+	for( int stages = 1; stages <= Oversampler::MaxStages; ++stages )
+	{
+		m_oversamplingModel.addItem( QString( "%1x" ).arg( 1 << stages ) );
+	}
+	connect( &m_oversamplingModel, SIGNAL( dataChanged() ),
+			this, SLOT( updateOversampling() ), Qt::DirectConnection );
+	connect( Engine::audioEngine(), SIGNAL( sampleRateChanged() ),
+			this, SIGNAL( sampleRateChanged() ) );
 }
 
 
@@ -81,6 +93,10 @@ void Effect::saveSettings( QDomDocument & _doc, QDomElement & _this )
 	m_wetDryModel.saveSettings( _doc, _this, "wet" );
 	m_autoQuitModel.saveSettings( _doc, _this, "autoquit" );
 	m_gateModel.saveSettings( _doc, _this, "gate" );
+	if( supportsOversampling() )
+	{
+		m_oversamplingModel.saveSettings( _doc, _this, "oversampling" );
+	}
 	controls()->saveState( _doc, _this );
 }
 
@@ -93,6 +109,7 @@ void Effect::loadSettings( const QDomElement & _this )
 	m_wetDryModel.loadSettings( _this, "wet" );
 	m_autoQuitModel.loadSettings( _this, "autoquit" );
 	m_gateModel.loadSettings( _this, "gate" );
+	m_oversamplingModel.loadSettings( _this, "oversampling" );
 
 	QDomNode node = _this.firstChild();
 	while( !node.isNull() )
@@ -162,6 +179,57 @@ void Effect::checkGate( double _out_sum )
 
 
 
+bool Effect::processOversampled( sampleFrame * _buf, const fpp_t _frames )
+{
+	if( m_oversampler == nullptr )
+	{
+		return processAudioBuffer( _buf, _frames );
+	}
+
+	// pass at most one period of oversampled frames at a time, so effects
+	// can size their buffers by framesPerPeriod() as usual
+	const int factor = m_oversampler->factor();
+	const fpp_t chunk = Engine::audioEngine()->framesPerPeriod() / factor;
+	bool moreFrames = false;
+	for( fpp_t offset = 0; offset < _frames; offset += chunk )
+	{
+		const fpp_t frames = qMin<fpp_t>( chunk, _frames - offset );
+		sampleFrame * oversampled = m_oversampler->upsample( _buf + offset, frames );
+		moreFrames |= processAudioBuffer( oversampled, frames * factor );
+		m_oversampler->downsample( _buf + offset, frames );
+	}
+	return moreFrames;
+}
+
+
+
+
+void Effect::updateOversampling()
+{
+	const int stages = supportsOversampling() ? m_oversamplingModel.value() : 0;
+	if( ( 1 << stages ) == m_oversamplingFactor )
+	{
+		return;
+	}
+
+	Engine::audioEngine()->requestChangeInModel();
+	if( stages > 0 )
+	{
+		m_oversampler = std::make_unique<Oversampler>( stages,
+					Engine::audioEngine()->framesPerPeriod() );
+	}
+	else
+	{
+		m_oversampler.reset();
+	}
+	m_oversamplingFactor = 1 << stages;
+	emit sampleRateChanged();
+	Engine::audioEngine()->doneChangeInModel();
+}
+
+
+
+
 PluginView * Effect::instantiateView( QWidget * _parent )
 {
 	return new EffectView( this, _parent );
@@ -27,16 +27,24 @@
 #include <QDomElement>
 
 #include "EffectChain.h"
+#include "AudioEngine.h"
+#include "BufferManager.h"
 #include "Effect.h"
 #include "DummyEffect.h"
 #include "MixHelpers.h"
+#include "PlanarEffect.h"
 #include "Song.h"
 
 
 EffectChain::EffectChain( Model * _parent ) :
 	Model( _parent ),
 	SerializingObject(),
-	m_enabledModel( false, nullptr, tr( "Effects enabled" ) )
+	m_enabledModel( false, nullptr, tr( "Effects enabled" ) ),
+	m_planarBuffer( BufferManager::acquirePlanar() ),
+	m_quietPeriods( 0 ),
+	m_sleeping( false ),
+	m_wakeRequested( false ),
+	m_running( false )
 {
 }
 
@@ -46,6 +54,7 @@ EffectChain::EffectChain( Model * _parent ) :
 EffectChain::~EffectChain()
 {
 	clear();
+	BufferManager::release( m_planarBuffer );
 }
 
 
@@ -113,6 +122,8 @@ void EffectChain::loadSettings( const QDomElement & _this )
 		node = node.nextSibling();
 	}
 
+	publishEffects();
+
 	emit dataChanged();
 }
 
@@ -121,9 +132,8 @@ void EffectChain::loadSettings( const QDomElement & _this )
 
 void EffectChain::appendEffect( Effect * _effect )
 {
-	Engine::audioEngine()->requestChangeInModel();
 	m_effects.append( _effect );
-	Engine::audioEngine()->doneChangeInModel();
+	publishEffects();
 
 	m_enabledModel.setValue( true );
 
@@ -135,17 +145,15 @@ void EffectChain::appendEffect( Effect * _effect )
 
 void EffectChain::removeEffect( Effect * _effect )
 {
-	Engine::audioEngine()->requestChangeInModel();
-
 	Effect ** found = std::find( m_effects.begin(), m_effects.end(), _effect );
 	if( found == m_effects.end() )
 	{
-		Engine::audioEngine()->doneChangeInModel();
 		return;
 	}
 	m_effects.erase( found );
 
-	Engine::audioEngine()->doneChangeInModel();
+	// the caller is going to delete the effect
+	publishEffects( true );
 
 	if( m_effects.isEmpty() )
 	{
@@ -164,6 +172,7 @@ void EffectChain::moveDown( Effect * _effect )
 	{
 		int i = m_effects.indexOf(_effect);
 		std::swap(m_effects[i + 1], m_effects[i]);
+		publishEffects();
 	}
 }
 
@@ -176,6 +185,7 @@ void EffectChain::moveUp( Effect * _effect )
 	{
 		int i = m_effects.indexOf(_effect);
 		std::swap(m_effects[i - 1], m_effects[i]);
+		publishEffects();
 	}
 }
 
@@ -189,24 +199,165 @@ bool EffectChain::processAudioBuffer( sampleFrame * _buf, const fpp_t _frames, b
 		return false;
 	}
 
-	MixHelpers::sanitize( _buf, _frames );
+	const EffectList & effects = m_renderEffects.read();
+	if( m_wakeRequested.exchange( false, std::memory_order_acquire ) )
+	{
+		m_quietPeriods = 0;
+		for( Effect * effect : effects )
+		{
+			effect->startRunning();
+		}
+	}
+
+	// the input comes from instruments and effects, whose output has been
+	// sanitized already
+	if( hasInputNoise )
+	{
+		m_quietPeriods = 0;
+		m_sleeping.store( false, std::memory_order_relaxed );
+	}
+	else if( m_sleeping.load( std::memory_order_relaxed ) )
+	{
+		// everything decayed, so not even effects that never quit by
+		// themselves, like remote plugins, are called until there's input
+		Engine::audioEngine()->profiler().countSkipped( AudioEngineProfiler::SkippedWork::EffectChain );
+		return false;
+	}
+
+	// consecutive planar effects share one conversion from and back to
+	// interleaved audio
+	const PlanarBuffer planar = m_planarBuffer.withFrames( _frames );
+	bool isPlanar = false;
 
 	bool moreEffects = false;
-	for( EffectList::Iterator it = m_effects.begin(); it != m_effects.end(); ++it )
+	bool running = false;
+	for( EffectList::ConstIterator it = effects.begin(); it != effects.end(); ++it )
 	{
 		if( hasInputNoise || ( *it )->isRunning() )
 		{
-			moreEffects |= ( *it )->processAudioBuffer( _buf, _frames );
-			MixHelpers::sanitize( _buf, _frames );
+			if( ( *it )->processesPlanar() )
+			{
+				if( !isPlanar )
+				{
+					MixHelpers::deinterleave( planar, _buf );
+					isPlanar = true;
+				}
+				moreEffects |= static_cast<PlanarEffect *>( *it )->processPlanarBuffer( planar );
+				if( MixHelpers::sanitize( planar ) )
+				{
+					( *it )->reportBadOutput();
+				}
+			}
+			else
+			{
+				if( isPlanar )
+				{
+					MixHelpers::interleave( _buf, planar );
+					isPlanar = false;
+				}
+				moreEffects |= ( *it )->processOversampled( _buf, _frames );
+				if( MixHelpers::sanitize( _buf, _frames ) )
+				{
+					( *it )->reportBadOutput();
+				}
+			}
+		}
+		running |= ( *it )->isRunning();
+	}
+
+	if( isPlanar )
+	{
+		MixHelpers::interleave( _buf, planar );
+	}
+
+	if( !hasInputNoise && outputDecayed( effects, _buf, _frames ) )
+	{
+		for( Effect * effect : effects )
+		{
+			effect->stopRunning();
 		}
+		m_running.store( false, std::memory_order_relaxed );
+		m_sleeping.store( true, std::memory_order_relaxed );
+		return false;
 	}
 
+	m_running.store( running, std::memory_order_relaxed );
 	return moreEffects;
 }
 
 
 
 
+bool EffectChain::outputDecayed( const EffectList & effects, const sampleFrame * buf, fpp_t frames )
+{
+	float gate = 0.0f;
+	f_cnt_t timeout = 0;
+	bool running = false;
+	for( const Effect * effect : effects )
+	{
+		if( !effect->isRunning() )
+		{
+			continue;
+		}
+		if( effect->autoQuitDisabled() )
+		{
+			return false;
+		}
+		gate = running ? qMin( gate, effect->gate() ) : effect->gate();
+		timeout = qMax( timeout, effect->timeout() );
+		running = true;
+	}
+	if( !running )
+	{
+		return true;
+	}
+
+	// the same test as Effect::checkGate(), but once for the whole chain
+	if( MixHelpers::energy( buf, frames ) / frames - gate <= typeInfo<float>::minEps() )
+	{
+		return ++m_quietPeriods > timeout;
+	}
+	m_quietPeriods = 0;
+	return false;
+}
+
+
+
+
+f_cnt_t EffectChain::latency() const
+{
+	f_cnt_t frames = 0;
+	for( const Effect * effect : m_effects )
+	{
+		frames += effect->latency();
+	}
+	return frames;
+}
+
+
+
+
+f_cnt_t EffectChain::tailLength() const
+{
+	if( !isEnabled() )
+	{
+		return 0;
+	}
+
+	f_cnt_t frames = latency();
+	for( const Effect * effect : m_effects )
+	{
+		if( effect->isEnabled() )
+		{
+			frames += effect->timeout() * Engine::audioEngine()->framesPerPeriod();
+		}
+	}
+	return frames;
+}
+
+
+
+
 void EffectChain::startRunning()
 {
 	if( m_enabledModel.value() == false )
@@ -214,11 +365,10 @@ void EffectChain::startRunning()
 		return;
 	}
 
-	for( EffectList::Iterator it = m_effects.begin();
-						it != m_effects.end(); it++ )
-	{
-		( *it )->startRunning();
-	}
+	// the effects are started by processAudioBuffer(), which is the only
+	// place that may read m_renderEffects
+	m_wakeRequested.store( true, std::memory_order_release );
+	m_sleeping.store( false, std::memory_order_relaxed );
 }
 
 
@@ -228,16 +378,29 @@ void EffectChain::clear()
 {
 	emit aboutToClear();
 
-	Engine::audioEngine()->requestChangeInModel();
+	EffectList removed;
+	removed.swap( m_effects );
+	publishEffects( !removed.isEmpty() );
 
-	while( m_effects.count() )
+	while( removed.count() )
 	{
-		Effect * e = m_effects[m_effects.count() - 1];
-		m_effects.pop_back();
+		Effect * e = removed[removed.count() - 1];
+		removed.pop_back();
 		delete e;
 	}
 
-	Engine::audioEngine()->doneChangeInModel();
-
 	m_enabledModel.setValue( false );
 }
+
+
+
+
+void EffectChain::publishEffects( bool waitForRender )
+{
+	RenderGracePeriod & grace = Engine::audioEngine()->renderGracePeriod();
+	m_renderEffects.publish( m_effects, grace );
+	if( waitForRender )
+	{
+		m_renderEffects.synchronize( grace );
+	}
+}
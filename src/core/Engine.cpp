@@ -27,12 +27,15 @@
 #include "AudioEngine.h"
 #include "BBTrackContainer.h"
 #include "ConfigManager.h"
+#include "FftPlanCache.h"
 #include "Mixer.h"
+#include "InternalSamples.h"
 #include "Ladspa2LMMS.h"
 #include "Lv2Manager.h"
 #include "Plugin.h"
 #include "PresetPreviewPlayHandle.h"
 #include "ProjectJournal.h"
+#include "RealtimeChecker.h"
 #include "Song.h"
 #include "BandLimitedWave.h"
 #include "Oscillator.h"
@@ -52,19 +55,21 @@ void* LmmsCore::s_dndPluginKey = nullptr;
 
 
 
-void LmmsCore::init( bool renderOnly )
+void LmmsCore::init( bool renderOnly, fpp_t renderFramesPerPeriod, int renderThreads )
 {
 	LmmsCore *engine = inst();
 
 	emit engine->initProgress(tr("Generating wavetables"));
 	// generate (load from file) bandlimited wavetables
 	BandLimitedWave::generateWaves();
+	// load the FFTW wisdom before the first plans are made
+	FftPlanCache::init();
 	//initilize oscillators
 	Oscillator::waveTableInit();
 
 	emit engine->initProgress(tr("Initializing data structures"));
 	s_projectJournal = new ProjectJournal;
-	s_audioEngine = new AudioEngine( renderOnly );
+	s_audioEngine = new AudioEngine( renderOnly, renderFramesPerPeriod, renderThreads );
 	s_song = new Song;
 	s_mixer = new Mixer;
 	s_bbTrackContainer = new BBTrackContainer;
@@ -79,6 +84,7 @@ void LmmsCore::init( bool renderOnly )
 
 	emit engine->initProgress(tr("Opening audio and midi devices"));
 	s_audioEngine->initDevices();
+	s_audioEngine->initMetronome();
 
 	PresetPreviewPlayHandle::init();
 
@@ -95,6 +101,8 @@ void LmmsCore::destroy()
 	s_audioEngine->stopProcessing();
 
 	PresetPreviewPlayHandle::cleanup();
+	s_audioEngine->destroyMetronome();
+	InternalSamples::clear();
 
 	s_song->clearProject();
 
@@ -103,6 +111,8 @@ void LmmsCore::destroy()
 	deleteHelper( &s_mixer );
 	deleteHelper( &s_audioEngine );
 
+	RealtimeChecker::writeReport();
+
 #ifdef LMMS_HAVE_LV2
 	deleteHelper( &s_lv2Manager );
 #endif
@@ -118,6 +128,7 @@ void LmmsCore::destroy()
 	// The oscillator FFT plans remain throughout the application lifecycle
 	// due to being expensive to create, and being used whenever a userwave form is changed
 	Oscillator::destroyFFTPlans();
+	FftPlanCache::cleanup();
 }
 
 
@@ -0,0 +1,83 @@
+/*
+ * EngineCounters.cpp - counters of the engine's hot paths, cheap enough to
+ *                      be always on
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "EngineCounters.h"
+
+#include <algorithm>
+
+
+EngineCounters::Slot EngineCounters::s_slots[EngineCounters::MaxSlots];
+std::atomic_int EngineCounters::s_usedSlots( 0 );
+std::atomic<qint64> EngineCounters::s_gauges[static_cast<int>( EngineCounters::Gauge::Count )];
+std::atomic<qint64> EngineCounters::s_maxRoundTrip( 0 );
+
+
+
+
+void EngineCounters::addRoundTrip( qint64 micros )
+{
+	add( Counter::RemoteRoundTrips );
+	add( Counter::RemoteRoundTripMicros, static_cast<quint64>( std::max<qint64>( micros, 0 ) ) );
+
+	qint64 longest = s_maxRoundTrip.load( std::memory_order_relaxed );
+	while( micros > longest &&
+		!s_maxRoundTrip.compare_exchange_weak( longest, micros, std::memory_order_relaxed ) )
+	{
+	}
+}
+
+
+
+
+EngineCounters::Snapshot EngineCounters::snapshot()
+{
+	Snapshot snapshot;
+	const int slots = std::min( s_usedSlots.load( std::memory_order_acquire ), static_cast<int>( MaxSlots ) );
+	for( int i = 0; i < slots; ++i )
+	{
+		for( int c = 0; c < static_cast<int>( Counter::Count ); ++c )
+		{
+			snapshot.counters[c] += s_slots[i].counters[c].load( std::memory_order_relaxed );
+		}
+	}
+	for( int g = 0; g < static_cast<int>( Gauge::Count ); ++g )
+	{
+		snapshot.gauges[g] = s_gauges[g].load( std::memory_order_relaxed );
+	}
+	snapshot.maxRoundTripMicros = s_maxRoundTrip.exchange( 0, std::memory_order_relaxed );
+	return snapshot;
+}
+
+
+
+
+EngineCounters::Slot & EngineCounters::threadSlot()
+{
+	// slots stay taken when their thread has finished, so that what it
+	// counted isn't lost
+	static thread_local Slot * slot = &s_slots[std::min( s_usedSlots.fetch_add( 1, std::memory_order_acq_rel ),
+								static_cast<int>( MaxSlots ) - 1 )];
+	return *slot;
+}
@@ -0,0 +1,185 @@
+/*
+ * EngineStatsWriter.cpp - keeps a file with the engine's counters up to date
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "EngineStatsWriter.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+#include "AudioEngine.h"
+#include "AudioEngineProfiler.h"
+#include "BufferManager.h"
+#include "Engine.h"
+#include "NotePlayHandle.h"
+
+
+EngineStatsWriter::EngineStatsWriter( const QString & file, int intervalMs ) :
+	m_file( file ),
+	m_intervalMs( qMax( intervalMs, 10 ) ),
+	m_stop( false ),
+	m_last( EngineCounters::snapshot() ),
+	m_lastTime( AudioEngineProfiler::now() )
+{
+	setObjectName( "EngineStatsWriter" );
+	start( QThread::LowPriority );
+}
+
+
+
+
+EngineStatsWriter::~EngineStatsWriter()
+{
+	m_stopMutex.lock();
+	m_stop = true;
+	m_stopCondition.wakeAll();
+	m_stopMutex.unlock();
+	wait();
+
+	// what happened since the last interval, e.g. at the end of a render
+	write();
+}
+
+
+
+
+void EngineStatsWriter::run()
+{
+	QMutexLocker locker( &m_stopMutex );
+	while( !m_stop )
+	{
+		if( !m_stopCondition.wait( &m_stopMutex, m_intervalMs ) )
+		{
+			locker.unlock();
+			write();
+			locker.relock();
+		}
+	}
+}
+
+
+
+
+QJsonObject EngineStatsWriter::collect()
+{
+	const EngineCounters::Snapshot counters = EngineCounters::snapshot();
+	const qint64 time = AudioEngineProfiler::now();
+	const QJsonObject result = stats( counters, m_last, time - m_lastTime );
+
+	m_last = counters;
+	m_lastTime = time;
+	return result;
+}
+
+
+
+
+QJsonObject EngineStatsWriter::stats( const EngineCounters::Snapshot & counters,
+					const EngineCounters::Snapshot & since, qint64 micros )
+{
+	using Counter = EngineCounters::Counter;
+	using Gauge = EngineCounters::Gauge;
+
+	const double seconds = qMax<qint64>( micros, 1 ) / 1000000.0;
+
+	const auto rate = [&]( Counter counter )
+	{
+		return ( counters[counter] - since[counter] ) / seconds;
+	};
+
+	const quint64 roundTrips = counters[Counter::RemoteRoundTrips] - since[Counter::RemoteRoundTrips];
+	const quint64 roundTripMicros = counters[Counter::RemoteRoundTripMicros] -
+						since[Counter::RemoteRoundTripMicros];
+
+	QJsonObject stats{
+		{ "time", QDateTime::currentDateTimeUtc().toString( Qt::ISODate ) },
+		{ "periodsRendered", static_cast<qint64>( counters[Counter::PeriodsRendered] ) },
+		{ "periodsPerSecond", rate( Counter::PeriodsRendered ) },
+		{ "playHandles", counters[Gauge::PlayHandles] },
+		{ "notePlayHandles", QJsonObject{
+			{ "inUse", NotePlayHandleManager::inUse() },
+			{ "highWaterMark", NotePlayHandleManager::highWaterMark() },
+			{ "capacity", NotePlayHandleManager::capacity() },
+			{ "dropped", NotePlayHandleManager::droppedNotes() } } },
+		{ "buffers", QJsonObject{
+			{ "inUse", static_cast<qint64>( counters[Counter::BuffersAcquired] -
+							counters[Counter::BuffersReleased] ) },
+			{ "acquiredPerSecond", rate( Counter::BuffersAcquired ) },
+			{ "allocated", static_cast<qint64>( BufferManager::allocated() ) } } },
+		{ "remotePlugins", QJsonObject{
+			{ "roundTripsPerSecond", rate( Counter::RemoteRoundTrips ) },
+			{ "meanRoundTripUs", roundTrips > 0 ?
+				static_cast<double>( roundTripMicros ) / roundTrips : 0.0 },
+			{ "maxRoundTripUs", counters.maxRoundTripMicros } } },
+		{ "badPluginOutputs", static_cast<qint64>( counters[Counter::BadOutputs] ) },
+		{ "exportCache", QJsonObject{
+			{ "barsRendered", static_cast<qint64>( counters[Counter::ExportBarsRendered] -
+								since[Counter::ExportBarsRendered] ) },
+			{ "barsCached", static_cast<qint64>( counters[Counter::ExportBarsCached] -
+								since[Counter::ExportBarsCached] ) } } },
+		{ "outputFifoPeriods", counters[Gauge::OutputFifoFill] },
+		{ "inputRingFrames", counters[Gauge::InputRingFill] } };
+
+	if( AudioEngine * engine = Engine::audioEngine() )
+	{
+		const AudioEngineProfiler & profiler = engine->profiler();
+		stats["cpuLoad"] = profiler.cpuLoad();
+		stats["deadlineMisses"] = profiler.deadlineMisses();
+		stats["deviceXruns"] = profiler.totalDeviceXruns();
+		stats["jobQueue"] = QJsonObject{
+			{ "depth", profiler.jobQueueDepth() },
+			{ "maxDepth", profiler.maxJobQueueDepth() } };
+		stats["outputFifoDepth"] = engine->outputPeriods();
+		if( profiler.denormalWatchEnabled() )
+		{
+			QJsonArray suspects;
+			for( const AudioEngineProfiler::DenormalSuspect & s : profiler.denormalSuspects() )
+			{
+				suspects.append( QJsonObject{
+					{ "job", s.jobName },
+					{ "spikes", s.spikes },
+					{ "worstRatio", s.worstRatio },
+					{ "usualTimeUs", s.usualTime } } );
+			}
+			stats["denormalSuspects"] = suspects;
+		}
+	}
+
+	return stats;
+}
+
+
+
+
+void EngineStatsWriter::write()
+{
+	const QByteArray json = QJsonDocument( collect() ).toJson();
+
+	QSaveFile file( m_file );
+	if( !file.open( QIODevice::WriteOnly ) || file.write( json ) != json.size() || !file.commit() )
+	{
+		qWarning( "Could not write the engine stats to %s", qPrintable( m_file ) );
+	}
+}
@@ -43,13 +43,7 @@ EnvelopeAndLfoParameters::LfoInstances * EnvelopeAndLfoParameters::s_lfoInstance
 
 void EnvelopeAndLfoParameters::LfoInstances::trigger()
 {
-	QMutexLocker m( &m_lfoListMutex );
-	for( LfoList::Iterator it = m_lfos.begin();
-							it != m_lfos.end(); ++it )
-	{
-		( *it )->m_lfoFrame += Engine::audioEngine()->framesPerPeriod();
-		( *it )->m_bad_lfoShapeData = true;
-	}
+	m_frame += Engine::audioEngine()->framesPerPeriod();
 }
 
 
@@ -58,11 +52,12 @@ void EnvelopeAndLfoParameters::LfoInstances::trigger()
 void EnvelopeAndLfoParameters::LfoInstances::reset()
 {
 	QMutexLocker m( &m_lfoListMutex );
+	m_frame = 0;
 	for( LfoList::Iterator it = m_lfos.begin();
 							it != m_lfos.end(); ++it )
 	{
-		( *it )->m_lfoFrame = 0;
-		( *it )->m_bad_lfoShapeData = true;
+		( *it )->m_lfoFrameOffset = 0;
+		( *it )->m_lfoShapeDataFrame = -1;
 	}
 }
 
@@ -72,6 +67,8 @@ void EnvelopeAndLfoParameters::LfoInstances::reset()
 void EnvelopeAndLfoParameters::LfoInstances::add( EnvelopeAndLfoParameters * lfo )
 {
 	QMutexLocker m( &m_lfoListMutex );
+	// new LFOs start at their first frame
+	lfo->m_lfoFrameOffset = m_frame;
 	m_lfos.append( lfo );
 }
 
@@ -116,8 +113,10 @@ EnvelopeAndLfoParameters::EnvelopeAndLfoParameters(
 	m_x100Model( false, this, tr( "LFO frequency x 100" ) ),
 	m_controlEnvAmountModel( false, this, tr( "Modulate env amount" ) ),
 	m_lfoFrame( 0 ),
+	m_lfoFrameOffset( 0 ),
 	m_lfoAmountIsZero( false ),
-	m_lfoShapeData( nullptr )
+	m_lfoShapeData( nullptr ),
+	m_lfoShapeDataFrame( -1 )
 {
 	m_amountModel.setCenterValue( 0 );
 	m_lfoAmountModel.setCenterValue( 0 );
@@ -242,12 +241,38 @@ inline sample_t EnvelopeAndLfoParameters::lfoShapeSample( fpp_t _frame_offset )
 
 void EnvelopeAndLfoParameters::updateLfoShapeData()
 {
+	m_lfoShapeDataFrame = instances()->frame();
+	m_lfoFrame = m_lfoShapeDataFrame - m_lfoFrameOffset;
+
 	const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
-	for( fpp_t offset = 0; offset < frames; ++offset )
+	const fpp_t interval = Engine::audioEngine()->lfoControlInterval();
+
+	// the random wave only picks a new value on the first frame of an
+	// oscillation, so it has to see each frame
+	if( interval <= 1 || m_lfoWaveModel.value() == RandomWave )
 	{
-		m_lfoShapeData[offset] = lfoShapeSample( offset );
+		for( fpp_t offset = 0; offset < frames; ++offset )
+		{
+			m_lfoShapeData[offset] = lfoShapeSample( offset );
+		}
+		return;
+	}
+
+	// evaluate the shape at the control rate and interpolate linearly
+	const float step = 1.0f / interval;
+	sample_t next = lfoShapeSample( 0 );
+	for( fpp_t start = 0; start < frames; start += interval )
+	{
+		const sample_t current = next;
+		next = lfoShapeSample( start + interval );
+		const sample_t delta = ( next - current ) * step;
+		const fpp_t count = qMin<fpp_t>( interval, frames - start );
+		sample_t * data = m_lfoShapeData + start;
+		for( fpp_t i = 0; i < count; ++i )
+		{
+			data[i] = current + delta * i;
+		}
 	}
-	m_bad_lfoShapeData = false;
 }
 
 
@@ -267,7 +292,7 @@ inline void EnvelopeAndLfoParameters::fillLfoLevel( float * _buf,
 	}
 	_frame -= m_lfoPredelayFrames;
 
-	if( m_bad_lfoShapeData )
+	if( m_lfoShapeDataFrame != instances()->frame() )
 	{
 		updateLfoShapeData();
 	}
@@ -301,6 +326,7 @@ void EnvelopeAndLfoParameters::fillLevel( float * _buf, f_cnt_t _frame,
 
 	fillLfoLevel( _buf, _frame, _frames );
 
+	const bool controlEnvAmount = m_controlEnvAmountModel.value();
 	for( fpp_t offset = 0; offset < _frames; ++offset, ++_buf, ++_frame )
 	{
 		float env_level;
@@ -327,7 +353,7 @@ void EnvelopeAndLfoParameters::fillLevel( float * _buf, f_cnt_t _frame,
 		}
 
 		// at this point, *_buf is LFO level
-		*_buf = m_controlEnvAmountModel.value() ?
+		*_buf = controlEnvAmount ?
 			env_level * ( 0.5f + *_buf ) :
 			env_level + *_buf;
 	}
@@ -528,7 +554,7 @@ void EnvelopeAndLfoParameters::updateSampleVars()
 		m_lfoAmountIsZero = false;
 	}
 
-	m_bad_lfoShapeData = true;
+	m_lfoShapeDataFrame = -1;
 
 	emit dataChanged();
 
@@ -0,0 +1,386 @@
+/*
+ * ExportCache.cpp - keeps the bars of an export, so that a re-export only
+ *                   renders the ones that changed
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ExportCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <set>
+
+#include <QCryptographicHash>
+#include <QDomDocument>
+#include <QFile>
+#include <QSaveFile>
+
+#include "AudioPort.h"
+#include "AutomationClip.h"
+#include "BBClip.h"
+#include "BBTrack.h"
+#include "BBTrackContainer.h"
+#include "EffectChain.h"
+#include "InstrumentTrack.h"
+#include "MidiClip.h"
+#include "Mixer.h"
+#include "SampleTrack.h"
+#include "Song.h"
+
+
+namespace
+{
+
+//! Bumped whenever the files or the keys change meaning
+const char * const CacheVersion = "lmms-export-cache-1";
+
+const char FileMagic[8] = { 'L', 'M', 'M', 'S', 'E', 'X', 'P', '1' };
+
+
+QByteArray serialize( SerializingObject & object )
+{
+	QDomDocument doc;
+	QDomElement root = doc.createElement( "exportcache" );
+	doc.appendChild( root );
+	object.saveState( doc, root );
+	return doc.toByteArray( 0 );
+}
+
+
+
+
+f_cnt_t tailOf( Track * track )
+{
+	if( InstrumentTrack * instrumentTrack = dynamic_cast<InstrumentTrack *>( track ) )
+	{
+		return instrumentTrack->audioPort()->effects()->tailLength();
+	}
+	if( SampleTrack * sampleTrack = dynamic_cast<SampleTrack *>( track ) )
+	{
+		return sampleTrack->audioPort()->effects()->tailLength();
+	}
+	return 0;
+}
+
+}
+
+
+
+
+ExportCache::ExportCache( const QString & directory ) :
+	m_directory( directory ),
+	m_minimumPreRoll( 0 )
+{
+}
+
+
+
+
+bool ExportCache::plan( const AudioEngine::qualitySettings & qualitySettings, sample_rate_t outputSampleRate )
+{
+	m_segments.clear();
+
+	Song * song = Engine::getSong();
+	AudioEngine * audioEngine = Engine::audioEngine();
+
+	// where the frames of a bar are can only be worked out from its ticks
+	// if the song plays straight through at a constant tempo, and the
+	// frames only go unaltered into the files without resampling
+	if( song->getLoopRenderCount() > 1 || song->m_tempoModel.isAutomatedOrControlled() ||
+		outputSampleRate != audioEngine->processingSampleRate() ||
+		!m_directory.mkpath( "." ) )
+	{
+		return false;
+	}
+
+	const tick_t begin = song->m_exportSongBegin.getTicks();
+	const tick_t end = song->m_exportSongEnd.getTicks();
+	const tick_t ticksPerBar = song->ticksPerBar();
+	const fpp_t framesPerPeriod = audioEngine->framesPerPeriod();
+	const double framesPerTick = Engine::framesPerTick();
+	if( end <= begin )
+	{
+		return false;
+	}
+
+	// the song plays a tick from the first frame at or after its start
+	const auto frameOf = [=]( tick_t ticks )
+	{
+		return static_cast<f_cnt_t>( std::ceil( ( ticks - begin ) * framesPerTick ) );
+	};
+
+	const int count = ( end - begin + ticksPerBar - 1 ) / ticksPerBar;
+	m_segments.resize( count );
+	for( int i = 0; i < count; ++i )
+	{
+		Segment & segment = m_segments[i];
+		segment.begin = begin + i * ticksPerBar;
+		segment.end = std::min( segment.begin + ticksPerBar, end );
+		segment.firstFrame = frameOf( segment.begin );
+		segment.endFrame = frameOf( segment.end );
+		segment.preRoll = segment.begin;
+		segment.cached = false;
+	}
+	// the export stops after the period in which the song reached its end
+	m_segments.back().endFrame = ( m_segments.back().endFrame / framesPerPeriod + 1 ) * framesPerPeriod;
+
+	const auto segmentOf = [=]( tick_t ticks )
+	{
+		return qBound( 0, static_cast<int>( ( ticks - begin ) / ticksPerBar ), count - 1 );
+	};
+
+	// everything that is the same for all bars
+	QCryptographicHash global( QCryptographicHash::Sha1 );
+	global.addData( CacheVersion );
+	global.addData( QByteArray::number( audioEngine->processingSampleRate() ) );
+	global.addData( QByteArray::number( framesPerPeriod ) );
+	global.addData( QByteArray::number( qualitySettings.interpolation ) );
+	global.addData( QByteArray::number( qualitySettings.oversampling ) );
+	global.addData( QByteArray::number( song->getTempo() ) );
+	global.addData( QByteArray::number( song->getTimeSigModel().getNumerator() ) );
+	global.addData( QByteArray::number( song->getTimeSigModel().getDenominator() ) );
+	global.addData( QByteArray::number( song->masterPitch() ) );
+	for( Track * track : song->tracks() )
+	{
+		// only the track's settings, its clips go into the bars they
+		// play in
+		track->setSimpleSerializing();
+		global.addData( serialize( *track ) );
+	}
+	global.addData( serialize( *Engine::getBBTrackContainer() ) );
+	global.addData( serialize( *Engine::mixer() ) );
+	global.addData( serialize( *song->m_globalAutomationTrack ) );
+	{
+		QDomDocument doc;
+		QDomElement controllers = doc.createElement( "controllers" );
+		doc.appendChild( controllers );
+		song->saveControllerStates( doc, controllers );
+		global.addData( doc.toByteArray( 0 ) );
+	}
+	const QByteArray globalKey = global.result();
+
+	// whatever a change can still be heard after: the longest effect tail
+	// of a track, and the ones of the mixer channels it's sent through
+	f_cnt_t trackTail = 0;
+	for( Track * track : song->tracks() )
+	{
+		trackTail = std::max( trackTail, tailOf( track ) );
+	}
+	f_cnt_t mixerTail = 0;
+	for( int channel = 1; channel < Engine::mixer()->numChannels(); ++channel )
+	{
+		mixerTail = std::max( mixerTail, Engine::mixer()->mixerChannel( channel )->m_fxChain.tailLength() );
+	}
+	const f_cnt_t tail = trackTail + mixerTail + Engine::mixer()->mixerChannel( 0 )->m_fxChain.tailLength();
+	// plus a bar for the releases of the notes
+	const int tailSegments = static_cast<int>( std::ceil( tail / framesPerTick / ticksPerBar ) ) + 1;
+
+	// what plays in each bar
+	std::vector<QByteArray> contents( count );
+	const auto addToRange = [&]( tick_t from, tick_t to, const QByteArray & data )
+	{
+		if( to <= begin || from >= end )
+		{
+			return;
+		}
+		for( int i = segmentOf( from ), last = segmentOf( std::max( from, to - 1 ) ); i <= last; ++i )
+		{
+			contents[i] += data;
+		}
+	};
+	// notes only start at their first tick, so a render has to start
+	// early enough for the ones that are still sounding
+	const auto addSounding = [&]( tick_t from, tick_t to )
+	{
+		for( int i = segmentOf( from ) + 1; i < count && m_segments[i].begin < to; ++i )
+		{
+			m_segments[i].preRoll = std::min( m_segments[i].preRoll, from );
+		}
+	};
+
+	const TrackContainer::TrackList & tracks = song->tracks();
+	for( int t = 0; t < tracks.size(); ++t )
+	{
+		const QByteArray trackId = QByteArray::number( t ) + ':';
+		for( Clip * clip : tracks[t]->getClips() )
+		{
+			const tick_t clipStart = clip->startPosition().getTicks();
+			const tick_t clipEnd = clip->endPosition().getTicks();
+
+			if( MidiClip * midiClip = dynamic_cast<MidiClip *>( clip ) )
+			{
+				if( midiClip->isMuted() )
+				{
+					continue;
+				}
+				for( Note * note : midiClip->notes() )
+				{
+					// notes past the end of the clip aren't played
+					const tick_t noteStart = clipStart + note->pos().getTicks();
+					if( noteStart >= clipEnd )
+					{
+						continue;
+					}
+					const tick_t noteEnd = noteStart + std::max( 1, note->length().getTicks() );
+					addToRange( noteStart, noteEnd, trackId + QByteArray::number( noteStart ) +
+								serialize( *note ) );
+					addSounding( noteStart, noteEnd );
+				}
+				continue;
+			}
+
+			const QByteArray data = trackId + QByteArray::number( clipStart ) + serialize( *clip );
+			if( dynamic_cast<AutomationClip *>( clip ) )
+			{
+				// the last value stays until something else changes it
+				addToRange( clipStart, end, data );
+			}
+			else
+			{
+				addToRange( clipStart, clipEnd, data );
+			}
+
+			if( BBClip * bbClip = dynamic_cast<BBClip *>( clip ) )
+			{
+				// the notes of a pattern can start as early as in the
+				// repetition before
+				const int bb = static_cast<BBTrack *>( bbClip->getTrack() )->index();
+				const tick_t patternTicks = Engine::getBBTrackContainer()->lengthOfBB( bb ) * ticksPerBar;
+				for( int i = segmentOf( clipStart ) + 1; i < count && m_segments[i].begin < clipEnd; ++i )
+				{
+					m_segments[i].preRoll = std::min( m_segments[i].preRoll,
+							std::max( clipStart, m_segments[i].begin - patternTicks ) );
+				}
+			}
+		}
+	}
+
+	for( int i = 0; i < count; ++i )
+	{
+		Segment & segment = m_segments[i];
+		segment.preRoll = std::max( begin, std::min( { segment.preRoll, segment.begin - tailSegments * ticksPerBar,
+								segment.begin - m_minimumPreRoll } ) );
+		segment.preRollFrame = frameOf( segment.preRoll );
+
+		QCryptographicHash key( QCryptographicHash::Sha1 );
+		key.addData( globalKey );
+		key.addData( QByteArray::number( segment.begin ) + ':' + QByteArray::number( segment.end ) + ':' +
+				QByteArray::number( segment.firstFrame ) + ':' + QByteArray::number( segment.endFrame ) );
+		for( int j = std::max( 0, i - tailSegments ); j <= i; ++j )
+		{
+			key.addData( QCryptographicHash::hash( contents[j], QCryptographicHash::Sha1 ) );
+		}
+		segment.key = key.result().toHex();
+		segment.cached = QFile::exists( fileName( segment ) );
+	}
+
+	return true;
+}
+
+
+
+
+std::vector<surroundSampleFrame> ExportCache::read( const Segment & segment ) const
+{
+	std::vector<surroundSampleFrame> frames;
+
+	QFile file( fileName( segment ) );
+	if( !file.open( QIODevice::ReadOnly ) )
+	{
+		return frames;
+	}
+
+	char magic[sizeof( FileMagic )];
+	qint64 count = 0;
+	if( file.read( magic, sizeof( magic ) ) != sizeof( magic ) ||
+		memcmp( magic, FileMagic, sizeof( magic ) ) != 0 ||
+		file.read( reinterpret_cast<char *>( &count ), sizeof( count ) ) != sizeof( count ) ||
+		count != segment.endFrame - segment.firstFrame )
+	{
+		return frames;
+	}
+
+	frames.resize( count );
+	const qint64 bytes = count * sizeof( surroundSampleFrame );
+	if( file.read( reinterpret_cast<char *>( frames.data() ), bytes ) != bytes )
+	{
+		frames.clear();
+	}
+	return frames;
+}
+
+
+
+
+void ExportCache::write( const Segment & segment, const std::vector<surroundSampleFrame> & frames ) const
+{
+	QSaveFile file( fileName( segment ) );
+	const qint64 count = frames.size();
+	const qint64 bytes = count * sizeof( surroundSampleFrame );
+	if( !file.open( QIODevice::WriteOnly ) ||
+		file.write( FileMagic, sizeof( FileMagic ) ) != sizeof( FileMagic ) ||
+		file.write( reinterpret_cast<const char *>( &count ), sizeof( count ) ) != sizeof( count ) ||
+		file.write( reinterpret_cast<const char *>( frames.data() ), bytes ) != bytes ||
+		!file.commit() )
+	{
+		qWarning( "Could not write the export cache file %s", qPrintable( file.fileName() ) );
+	}
+}
+
+
+
+
+void ExportCache::removeUnused() const
+{
+	std::set<QString> used;
+	for( const Segment & segment : m_segments )
+	{
+		used.insert( fileName( segment ) );
+	}
+
+	for( const QString & name : m_directory.entryList( { "*.segment" }, QDir::Files ) )
+	{
+		const QString path = m_directory.filePath( name );
+		if( used.find( path ) == used.end() )
+		{
+			QFile::remove( path );
+		}
+	}
+}
+
+
+
+
+void ExportCache::seek( tick_t ticks )
+{
+	Engine::getSong()->setPlayPos( ticks, Song::Mode_PlaySong );
+	Engine::audioEngine()->clear();
+}
+
+
+
+
+QString ExportCache::fileName( const Segment & segment ) const
+{
+	return m_directory.filePath( QString::fromLatin1( segment.key ) + ".segment" );
+}
@@ -0,0 +1,150 @@
+/*
+ * FftPlanCache.cpp - FFTW plans shared by the whole application
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "FftPlanCache.h"
+
+#include <map>
+#include <tuple>
+
+#include <QFile>
+#include <QMutex>
+
+#include "ConfigManager.h"
+
+
+namespace
+{
+
+enum class Direction
+{
+	RealToComplex,
+	ComplexToReal
+} ;
+
+struct PlanKey
+{
+	Direction direction;
+	int size;
+	bool aligned;
+
+	bool operator<( const PlanKey & other ) const
+	{
+		return std::tie( direction, size, aligned ) <
+			std::tie( other.direction, other.size, other.aligned );
+	}
+} ;
+
+QMutex s_plannerMutex;
+std::map<PlanKey, fftwf_plan> s_plans;
+QString s_wisdomFile;
+
+
+bool isAligned( const void * array )
+{
+	return fftwf_alignment_of( const_cast<float *>(
+				static_cast<const float *>( array ) ) ) == 0;
+}
+
+
+fftwf_plan plan( Direction direction, int size, bool aligned )
+{
+	QMutexLocker lock( &s_plannerMutex );
+
+	const PlanKey key{ direction, size, aligned };
+	auto it = s_plans.find( key );
+	if( it != s_plans.end() )
+	{
+		return it->second;
+	}
+
+	// measuring overwrites the arrays, so plan on scratch arrays
+	float * real = fftwf_alloc_real( size );
+	fftwf_complex * complex = fftwf_alloc_complex( size / 2 + 1 );
+	const unsigned flags = FFTW_MEASURE | ( aligned ? 0 : FFTW_UNALIGNED );
+	fftwf_plan p = direction == Direction::RealToComplex
+		? fftwf_plan_dft_r2c_1d( size, real, complex, flags )
+		: fftwf_plan_dft_c2r_1d( size, complex, real, flags );
+	fftwf_free( complex );
+	fftwf_free( real );
+
+	if( p != nullptr )
+	{
+		s_plans.emplace( key, p );
+	}
+	return p;
+}
+
+} // namespace
+
+
+
+
+void FftPlanCache::init()
+{
+	s_wisdomFile = ConfigManager::inst()->configDir() + ".lmms-fftw-wisdom";
+
+	QMutexLocker lock( &s_plannerMutex );
+	if( QFile::exists( s_wisdomFile ) )
+	{
+		fftwf_import_wisdom_from_filename(
+					QFile::encodeName( s_wisdomFile ).constData() );
+	}
+}
+
+
+
+
+void FftPlanCache::cleanup()
+{
+	QMutexLocker lock( &s_plannerMutex );
+	if( !s_wisdomFile.isEmpty() )
+	{
+		fftwf_export_wisdom_to_filename(
+					QFile::encodeName( s_wisdomFile ).constData() );
+	}
+
+	for( const auto & entry : s_plans )
+	{
+		fftwf_destroy_plan( entry.second );
+	}
+	s_plans.clear();
+}
+
+
+
+
+fftwf_plan FftPlanCache::realToComplex( int size, const float * in,
+						const fftwf_complex * out )
+{
+	return plan( Direction::RealToComplex, size, isAligned( in ) && isAligned( out ) );
+}
+
+
+
+
+fftwf_plan FftPlanCache::complexToReal( int size, const fftwf_complex * in,
+						const float * out )
+{
+	return plan( Direction::ComplexToReal, size, isAligned( in ) && isAligned( out ) );
+}
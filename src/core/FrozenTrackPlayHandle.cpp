@@ -0,0 +1,93 @@
+/*
+ * FrozenTrackPlayHandle.cpp - plays the cached output of a frozen track
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "FrozenTrackPlayHandle.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "AudioEngine.h"
+#include "Engine.h"
+#include "SampleBuffer.h"
+#include "Song.h"
+
+
+FrozenTrackPlayHandle::FrozenTrackPlayHandle( Track * track, AudioPort * port, SampleBuffer * cache ) :
+	PlayHandle( TypeFrozenTrackHandle ),
+	m_track( track ),
+	m_cache( sharedObject::ref( cache ) ),
+	m_position( 0 ),
+	m_running( false )
+{
+	setAudioPort( port );
+}
+
+
+
+
+FrozenTrackPlayHandle::~FrozenTrackPlayHandle()
+{
+	sharedObject::unref( m_cache );
+}
+
+
+
+
+void FrozenTrackPlayHandle::play( sampleFrame * buffer )
+{
+	const Song * song = Engine::getSong();
+	if( !song->isPlaying() || song->playMode() != Song::Mode_PlaySong )
+	{
+		// the buffer has been cleared already
+		m_running = false;
+		return;
+	}
+	if( !m_running )
+	{
+		return;
+	}
+
+	const f_cnt_t fpp = Engine::audioEngine()->framesPerPeriod();
+	const f_cnt_t first = std::max<f_cnt_t>( m_position, 0 );
+	const f_cnt_t last = std::min<f_cnt_t>( m_position + fpp, m_cache->frames() );
+	if( first < last )
+	{
+		memcpy( buffer + ( first - m_position ), m_cache->data() + first,
+						( last - first ) * sizeof( sampleFrame ) );
+	}
+	m_position += fpp;
+}
+
+
+
+
+void FrozenTrackPlayHandle::sync( f_cnt_t position )
+{
+	if( !m_running || std::abs( position - m_position ) > 1 )
+	{
+		m_position = position;
+		m_running = true;
+	}
+}
@@ -0,0 +1,304 @@
+/*
+ * HeadlessRenderer.cpp - renders projects in the process embedding it,
+ *                        without a GUI
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "HeadlessRenderer.h"
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QTimer>
+
+#include "AudioDevice.h"
+#include "AudioEngineProfiler.h"
+#include "ConfigManager.h"
+#include "Engine.h"
+#include "EngineStatsWriter.h"
+#include "MixHelpers.h"
+#include "NotePlayHandle.h"
+#include "RenderManager.h"
+#include "Song.h"
+
+
+//! Hands the periods of the engine to render(), at the sample rate asked for
+class HeadlessRenderer::BufferDevice : public AudioDevice
+{
+public:
+	BufferDevice( sample_rate_t sampleRate ) :
+		AudioDevice( DEFAULT_CHANNELS, Engine::audioEngine() )
+	{
+		setSampleRate( sampleRate );
+	}
+
+	fpp_t nextPeriod( surroundSampleFrame * frames )
+	{
+		return getNextBuffer( frames );
+	}
+
+} ;
+
+
+
+
+namespace
+{
+
+// QCoreApplication keeps references to them
+int s_argc = 1;
+char s_argv0[] = "lmms";
+char * s_argv[] = { s_argv0, nullptr };
+
+}
+
+
+
+
+HeadlessRenderer::HeadlessRenderer( fpp_t framesPerPeriod, int threads, const QString & configFile ) :
+	m_progress( 0 ),
+	m_aborted( false ),
+	m_statsStart( EngineCounters::snapshot() ),
+	m_statsStartTime( AudioEngineProfiler::now() ),
+	m_device( nullptr ),
+	m_periodFrames( 0 ),
+	m_periodUsed( 0 )
+{
+	Q_ASSERT( Engine::audioEngine() == nullptr );
+
+	if( QCoreApplication::instance() == nullptr )
+	{
+		m_application.reset( new QCoreApplication( s_argc, s_argv ) );
+	}
+
+	// like main() does for "lmms render"
+	ConfigManager::inst()->loadConfigFile( configFile );
+	MixHelpers::setNaNHandler( ConfigManager::inst()->value( "app", "nanhandler", "1" ).toInt() );
+
+	Engine::init( true, framesPerPeriod, threads );
+}
+
+
+
+
+HeadlessRenderer::~HeadlessRenderer()
+{
+	if( m_device )
+	{
+		endRender();
+	}
+
+	Engine::destroy();
+	NotePlayHandleManager::free();
+}
+
+
+
+
+bool HeadlessRenderer::loadProject( const QString & fileName )
+{
+	Engine::getSong()->loadProject( fileName );
+	return !Engine::getSong()->isEmpty();
+}
+
+
+
+
+bool HeadlessRenderer::loadProject( const QByteArray & data, const QString & fileName )
+{
+	Engine::getSong()->loadProjectData( data, fileName );
+	return !Engine::getSong()->isEmpty();
+}
+
+
+
+
+bool HeadlessRenderer::renderToFile( const QString & fileName, ProjectRenderer::ExportFileFormats format,
+					const OutputSettings & outputSettings )
+{
+	if( m_device )
+	{
+		return false;
+	}
+	prepareSong();
+
+	bool finished = false;
+	{
+		RenderManager manager( m_options.quality, outputSettings, format, fileName );
+		QEventLoop loop;
+
+		QObject::connect( &manager, &RenderManager::progressChanged, &loop, [this]( int progress )
+		{
+			m_progress.store( progress, std::memory_order_relaxed );
+		} );
+		QObject::connect( &manager, &RenderManager::finished, &loop, [&]()
+		{
+			finished = true;
+			loop.quit();
+		} );
+
+		// abort() may come from any thread, the render is stopped from
+		// this one
+		QTimer abortTimer;
+		QObject::connect( &abortTimer, &QTimer::timeout, &loop, [&]()
+		{
+			if( m_aborted.load( std::memory_order_relaxed ) )
+			{
+				manager.abortProcessing();
+				loop.quit();
+			}
+		} );
+		abortTimer.start( 50 );
+
+		manager.renderProject();
+		// it's finished right away if the file can't be written
+		if( !finished )
+		{
+			loop.exec();
+		}
+	}
+
+	return finished && !m_aborted.load( std::memory_order_relaxed ) && QFileInfo::exists( fileName );
+}
+
+
+
+
+bool HeadlessRenderer::beginRender( sample_rate_t sampleRate )
+{
+	if( m_device )
+	{
+		return false;
+	}
+	prepareSong();
+
+	AudioEngine * audioEngine = Engine::audioEngine();
+	Song * song = Engine::getSong();
+
+	// the same steps as ProjectRenderer, with a device which is only
+	// pulled from by render()
+	m_device = new BufferDevice( sampleRate );
+	audioEngine->storeAudioDevice();
+	audioEngine->setAudioDevice( m_device, m_options.quality, false, false );
+	song->instantiateDeferredInstruments();
+
+	song->startExport();
+	// Skip first empty buffer.
+	audioEngine->nextBuffer();
+	audioEngine->startProcessing( false );
+
+	m_period.resize( audioEngine->framesPerPeriod() );
+	m_periodFrames = m_periodUsed = 0;
+	return true;
+}
+
+
+
+
+f_cnt_t HeadlessRenderer::render( sampleFrame * buffer, f_cnt_t frames )
+{
+	if( !m_device )
+	{
+		return 0;
+	}
+
+	Song * song = Engine::getSong();
+	f_cnt_t written = 0;
+	while( written < frames && !m_aborted.load( std::memory_order_relaxed ) )
+	{
+		if( m_periodUsed == m_periodFrames )
+		{
+			if( song->isExportDone() )
+			{
+				break;
+			}
+			m_periodFrames = m_device->nextPeriod( m_period.data() );
+			m_periodUsed = 0;
+			m_progress.store( song->getExportProgress(), std::memory_order_relaxed );
+			if( m_periodFrames == 0 )
+			{
+				break;
+			}
+		}
+
+		const fpp_t count = static_cast<fpp_t>( std::min<f_cnt_t>( frames - written, m_periodFrames - m_periodUsed ) );
+		const float gain = Engine::audioEngine()->masterGain();
+		for( fpp_t f = 0; f < count; ++f )
+		{
+			const surroundSampleFrame & frame = m_period[m_periodUsed + f];
+			buffer[written + f][0] = frame[0] * gain;
+			buffer[written + f][1] = frame[1] * gain;
+		}
+		m_periodUsed += count;
+		written += count;
+	}
+	return written;
+}
+
+
+
+
+void HeadlessRenderer::endRender()
+{
+	if( !m_device )
+	{
+		return;
+	}
+
+	AudioEngine * audioEngine = Engine::audioEngine();
+	audioEngine->stopProcessing();
+	Engine::getSong()->stopExport();
+
+	// deletes the device
+	const AudioEngine::qualitySettings quality = audioEngine->currentQualitySettings();
+	audioEngine->restoreAudioDevice();
+	audioEngine->changeQuality( quality );
+	m_device = nullptr;
+	m_period.clear();
+}
+
+
+
+
+QJsonObject HeadlessRenderer::stats() const
+{
+	return EngineStatsWriter::stats( EngineCounters::snapshot(), m_statsStart,
+					AudioEngineProfiler::now() - m_statsStartTime );
+}
+
+
+
+
+void HeadlessRenderer::prepareSong()
+{
+	Song * song = Engine::getSong();
+	song->setExportLoop( m_options.loop );
+	song->setLoopRenderCount( m_options.loopCount );
+	song->setRenderBetweenMarkers( m_options.betweenMarkers );
+
+	m_progress.store( 0, std::memory_order_relaxed );
+	m_aborted.store( false, std::memory_order_relaxed );
+	m_statsStart = EngineCounters::snapshot();
+	m_statsStartTime = AudioEngineProfiler::now();
+}
@@ -46,6 +46,35 @@ void Instrument::play( sampleFrame * )
 
 
 
+int Instrument::voicePoolSize() const
+{
+	// enough for chords played with a sustain pedal
+	const int DefaultVoices = 16;
+	const int limit = m_instrumentTrack ? m_instrumentTrack->voiceLimit() : 0;
+	return limit > 0 ? limit : DefaultVoices;
+}
+
+
+
+
+void Instrument::playPlanar( const PlanarBuffer & )
+{
+}
+
+
+
+
+void Instrument::playNotes( NotePlayHandle * const * _notes, size_t _count )
+{
+	for( size_t i = 0; i < _count; ++i )
+	{
+		playNote( _notes[i], _notes[i]->buffer() );
+	}
+}
+
+
+
+
 void Instrument::deleteNotePluginData( NotePlayHandle * )
 {
 }
@@ -29,7 +29,6 @@
 #include "embed.h"
 #include "Engine.h"
 #include "InstrumentTrack.h"
-#include "PresetPreviewPlayHandle.h"
 
 
 InstrumentFunctionNoteStacking::ChordTable::Init InstrumentFunctionNoteStacking::ChordTable::s_initTable[] =
@@ -354,24 +353,20 @@ void InstrumentFunctionArpeggio::processNote( NotePlayHandle * _n )
 
 	const int selected_arp = m_arpModel.value();
 
-	ConstNotePlayHandleList cnphv = NotePlayHandle::nphsOfInstrumentTrack( _n->instrumentTrack() );
-
-	if( m_arpModeModel.value() != FreeMode && cnphv.size() == 0 )
+	// the track keeps track of its notes, including preset-preview-notes,
+	// and _n is one of them as it hasn't been released yet
+	const InstrumentTrack * track = _n->instrumentTrack();
+	const int active_notes = qMax( track->activeNoteCount(), 1 );
+	const NotePlayHandle * first_note = track->firstActiveNote();
+	if( first_note == nullptr )
 	{
-		// maybe we're playing only a preset-preview-note?
-		cnphv = PresetPreviewPlayHandle::nphsOfInstrumentTrack( _n->instrumentTrack() );
-		if( cnphv.size() == 0 )
-		{
-			// still nothing found here, so lets return
-			//return;
-			cnphv.push_back( _n );
-		}
+		first_note = _n;
 	}
 
 	const InstrumentFunctionNoteStacking::ChordTable & chord_table = InstrumentFunctionNoteStacking::ChordTable::getInstance();
 	const int cur_chord_size = chord_table[selected_arp].size();
 	const int range = static_cast<int>(cur_chord_size * m_arpRangeModel.value() * m_arpRepeatsModel.value());
-	const int total_range = range * cnphv.size();
+	const int total_range = range * active_notes;
 
 	// number of frames that every note should be played
 	const f_cnt_t arp_frames = (f_cnt_t)( m_arpTimeModel.value() / 1000.0f * Engine::audioEngine()->processingSampleRate() );
@@ -381,10 +376,10 @@ void InstrumentFunctionArpeggio::processNote( NotePlayHandle * _n )
 	// arp_frames-1, otherwise the first arp-note will not be setup
 	// correctly... -> arp_frames frames silence at the start of every note!
 	int cur_frame = ( ( m_arpModeModel.value() != FreeMode ) ?
-						cnphv.first()->totalFramesPlayed() :
+						first_note->totalFramesPlayed() :
 						_n->totalFramesPlayed() ) + arp_frames - 1;
 	// used for loop
-	f_cnt_t frames_processed = ( m_arpModeModel.value() != FreeMode ) ? cnphv.first()->noteOffset() : _n->noteOffset();
+	f_cnt_t frames_processed = ( m_arpModeModel.value() != FreeMode ) ? first_note->noteOffset() : _n->noteOffset();
 
 	while( frames_processed < Engine::audioEngine()->framesPerPeriod() )
 	{
@@ -31,4 +31,8 @@ InstrumentPlayHandle::InstrumentPlayHandle( Instrument * instrument, InstrumentT
 		m_instrument( instrument )
 {
 	setAudioPort( instrumentTrack->audioPort() );
+	if( instrument->flags().testFlag( Instrument::RendersPlanar ) )
+	{
+		m_planarBuffer = BufferManager::acquirePlanar();
+	}
 }
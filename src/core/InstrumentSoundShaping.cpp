@@ -113,6 +113,12 @@ InstrumentSoundShaping::~InstrumentSoundShaping()
 
 float InstrumentSoundShaping::volumeLevel( NotePlayHandle* n, const f_cnt_t frame )
 {
+	// processAudioBuffer() leaves the volume alone then
+	if( m_envLfoParameters[Volume]->isUsed() == false )
+	{
+		return 1.0f;
+	}
+
 	f_cnt_t envReleaseBegin = frame - n->releaseFramesDone() + n->framesBeforeRelease();
 
 	if( n->isReleased() == false )
@@ -120,7 +126,7 @@ float InstrumentSoundShaping::volumeLevel( NotePlayHandle* n, const f_cnt_t fram
 		envReleaseBegin += Engine::audioEngine()->framesPerPeriod();
 	}
 
-	float level;
+	float level = 0.0f;
 	m_envLfoParameters[Volume]->fillLevel( &level, frame, envReleaseBegin, 1 );
 
 	return level;
@@ -160,9 +166,10 @@ void InstrumentSoundShaping::processAudioBuffer( sampleFrame* buffer,
 
 		if( n->m_filter == nullptr )
 		{
-			n->m_filter = std::make_unique<BasicFilters<>>( Engine::audioEngine()->processingSampleRate() );
+			n->m_filter = NotePlayHandleManager::filter( n, Engine::audioEngine()->processingSampleRate() );
 		}
-		n->m_filter->setFilterType( m_filterModel.value() );
+		BasicFilters<> * filter = n->m_filter;
+		filter->setFilterType( m_filterModel.value() );
 
 		if( m_envLfoParameters[Cut]->isUsed() )
 		{
@@ -176,6 +183,9 @@ void InstrumentSoundShaping::processAudioBuffer( sampleFrame* buffer,
 		const float fcv = m_filterCutModel.value();
 		const float frv = m_filterResModel.value();
 
+		// the frames between two coefficient changes are filtered in one go
+		fpp_t runStart = 0;
+
 		if( m_envLfoParameters[Cut]->isUsed() &&
 			m_envLfoParameters[Resonance]->isUsed() )
 		{
@@ -189,13 +199,12 @@ void InstrumentSoundShaping::processAudioBuffer( sampleFrame* buffer,
 				if( static_cast<int>( new_cut_val ) != old_filter_cut ||
 					static_cast<int>( new_res_val*RES_PRECISION ) != old_filter_res )
 				{
-					n->m_filter->calcFilterCoeffs( new_cut_val, new_res_val );
+					filter->process( buffer + runStart, frame - runStart );
+					runStart = frame;
+					filter->calcFilterCoeffs( new_cut_val, new_res_val );
 					old_filter_cut = static_cast<int>( new_cut_val );
 					old_filter_res = static_cast<int>( new_res_val*RES_PRECISION );
 				}
-
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
 			}
 		}
 		else if( m_envLfoParameters[Cut]->isUsed() )
@@ -207,12 +216,11 @@ void InstrumentSoundShaping::processAudioBuffer( sampleFrame* buffer,
 
 				if( static_cast<int>( new_cut_val ) != old_filter_cut )
 				{
-					n->m_filter->calcFilterCoeffs( new_cut_val, frv );
+					filter->process( buffer + runStart, frame - runStart );
+					runStart = frame;
+					filter->calcFilterCoeffs( new_cut_val, frv );
 					old_filter_cut = static_cast<int>( new_cut_val );
 				}
-
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
 			}
 		}
 		else if( m_envLfoParameters[Resonance]->isUsed() )
@@ -223,24 +231,19 @@ void InstrumentSoundShaping::processAudioBuffer( sampleFrame* buffer,
 
 				if( static_cast<int>( new_res_val*RES_PRECISION ) != old_filter_res )
 				{
-					n->m_filter->calcFilterCoeffs( fcv, new_res_val );
+					filter->process( buffer + runStart, frame - runStart );
+					runStart = frame;
+					filter->calcFilterCoeffs( fcv, new_res_val );
 					old_filter_res = static_cast<int>( new_res_val*RES_PRECISION );
 				}
-
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
 			}
 		}
 		else
 		{
-			n->m_filter->calcFilterCoeffs( fcv, frv );
-
-			for( fpp_t frame = 0; frame < frames; ++frame )
-			{
-				buffer[frame][0] = n->m_filter->update( buffer[frame][0], 0 );
-				buffer[frame][1] = n->m_filter->update( buffer[frame][1], 1 );
-			}
+			filter->calcFilterCoeffs( fcv, frv );
 		}
+
+		filter->process( buffer + runStart, frames - runStart );
 	}
 
 	if( m_envLfoParameters[Volume]->isUsed() )
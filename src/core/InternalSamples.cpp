@@ -1,7 +1,7 @@
 /*
- * stereodelay.h - declaration of StereoDelay class.
+ * InternalSamples.cpp - pre-decoded samples played by the engine itself
  *
- * Copyright (c) 2014 David French <dave/dot/french3/at/googlemail/dot/com>
+ * Copyright (c) 2026 LMMS Developers
  *
  * This file is part of LMMS - https://lmms.io
  *
@@ -22,39 +22,38 @@
  *
  */
 
-#ifndef STEREODELAY_H
-#define STEREODELAY_H
+#include "InternalSamples.h"
 
-#include "lmms_basics.h"
+#include "SampleBuffer.h"
 
-class StereoDelay
+
+QHash<QString, SampleBuffer *> InternalSamples::s_samples;
+QMutex InternalSamples::s_mutex;
+
+
+
+SampleBuffer * InternalSamples::get( const QString & file )
 {
-public:
-	StereoDelay( int maxLength, int sampleRate );
-	~StereoDelay();
-	inline void setLength( float length )
-	{
-		if( length <= m_maxLength && length >= 0 )
-		{
-			m_length = length;
-		}
-	}
+	QMutexLocker lock( &s_mutex );
 
-	inline void setFeedback( float feedback )
+	SampleBuffer * & sample = s_samples[file];
+	if( sample == nullptr )
 	{
-		m_feedback = feedback;
+		sample = new SampleBuffer( file );
 	}
+	return sample;
+}
 
-	void tick( sampleFrame& frame );
-	void setSampleRate( int sampleRate );
 
-private:
-	sampleFrame* m_buffer;
-	int m_maxLength;
-	float m_length;
-	int m_writeIndex;
-	float m_feedback;
-	float m_maxTime;
-};
 
-#endif // STEREODELAY_H
+
+void InternalSamples::clear()
+{
+	QMutexLocker lock( &s_mutex );
+
+	for( SampleBuffer * sample : s_samples )
+	{
+		sharedObject::unref( sample );
+	}
+	s_samples.clear();
+}
@@ -25,8 +25,10 @@
  */
 
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QDomDocument>
 #include <QLibrary>
 
 #include <math.h>
@@ -34,6 +36,11 @@
 #include "ConfigManager.h"
 #include "LadspaManager.h"
 #include "PluginFactory.h"
+#include "lmmsversion.h"
+
+
+//! Bump this whenever the layout of the scan cache changes
+static const int LADSPA_CACHE_VERSION = 1;
 
 
 
@@ -56,6 +63,11 @@ LadspaManager::LadspaManager()
 	ladspaDirectories.push_back( "/Library/Audio/Plug-Ins/LADSPA" );
 #endif
 
+	// Libraries that did not change since the last start are listed from
+	// the scan cache and only loaded once one of their plugins is used
+	const QHash<QString, CacheEntry> cache = readCache();
+	bool cacheChanged = false;
+
 	for( QStringList::iterator it = ladspaDirectories.begin(); 
 			 		   it != ladspaDirectories.end(); ++it )
 	{
@@ -79,6 +91,15 @@ LadspaManager::LadspaManager()
 				continue;
 			}
 
+			const auto cached = cache.find( f.absoluteFilePath() );
+			if( cached != cache.end() && cached->matches( f ) )
+			{
+				addCachedPlugins( *cached );
+				m_cache.insert( cached->path, *cached );
+				continue;
+			}
+			cacheChanged = true;
+
 			QLibrary plugin_lib( f.absoluteFilePath() );
 
 			if( plugin_lib.load() == true )
@@ -86,11 +107,15 @@ LadspaManager::LadspaManager()
 				LADSPA_Descriptor_Function descriptorFunction =
 			( LADSPA_Descriptor_Function ) plugin_lib.resolve(
 							"ladspa_descriptor" );
+				CacheEntry entry;
+				entry.path = f.absoluteFilePath();
+				entry.modified = f.lastModified().toMSecsSinceEpoch();
+				entry.size = f.size();
 				if( descriptorFunction != nullptr )
 				{
-					addPlugins( descriptorFunction,
-							f.fileName() );
+					addPlugins( descriptorFunction, f, entry );
 				}
+				m_cache.insert( entry.path, entry );
 			}
 			else
 			{
@@ -98,6 +123,11 @@ LadspaManager::LadspaManager()
 			}
 		}
 	}
+
+	if( cacheChanged || cache.size() != m_cache.size() )
+	{
+		writeCache();
+	}
 	
 	l_ladspa_key_t keys = m_ladspaManagerMap.keys();
 	for( l_ladspa_key_t::iterator it = keys.begin();
@@ -141,7 +171,8 @@ ladspaManagerDescription * LadspaManager::getDescription(
 
 void LadspaManager::addPlugins(
 		LADSPA_Descriptor_Function _descriptor_func,
-						const QString & _file )
+						const QFileInfo & _file,
+						CacheEntry & _entry )
 {
 	const LADSPA_Descriptor * descriptor;
 
@@ -149,7 +180,7 @@ void LadspaManager::addPlugins(
 		( descriptor = _descriptor_func( pluginIndex ) ) != nullptr;
 								++pluginIndex )
 	{
-		ladspa_key_t key( _file, QString( descriptor->Label ) );
+		ladspa_key_t key( _file.fileName(), QString( descriptor->Label ) );
 		if( m_ladspaManagerMap.contains( key ) )
 		{
 			continue;
@@ -161,6 +192,9 @@ void LadspaManager::addPlugins(
 		plugIn->index = pluginIndex;
 		plugIn->inputChannels = getPluginInputs( descriptor );
 		plugIn->outputChannels = getPluginOutputs( descriptor );
+		plugIn->filePath = _file.absoluteFilePath();
+		plugIn->name = descriptor->Name;
+		plugIn->properties = descriptor->Properties;
 
 		if( plugIn->inputChannels == 0 && plugIn->outputChannels > 0 )
 		{
@@ -182,6 +216,153 @@ void LadspaManager::addPlugins(
 		}
 
 		m_ladspaManagerMap[key] = plugIn;
+		_entry.plugins.append( qMakePair( key.second, *plugIn ) );
+	}
+}
+
+
+
+
+void LadspaManager::addCachedPlugins( const CacheEntry & _entry )
+{
+	const QString fileName = QFileInfo( _entry.path ).fileName();
+	for( const auto & plugin : _entry.plugins )
+	{
+		ladspa_key_t key( fileName, plugin.first );
+		if( m_ladspaManagerMap.contains( key ) )
+		{
+			continue;
+		}
+
+		ladspaManagerDescription * plugIn =
+				new ladspaManagerDescription( plugin.second );
+		plugIn->descriptorFunction = nullptr;
+		m_ladspaManagerMap[key] = plugIn;
+	}
+}
+
+
+
+
+bool LadspaManager::loadLibrary( const QString & _path )
+{
+	QLibrary plugin_lib( _path );
+	LADSPA_Descriptor_Function descriptorFunction = nullptr;
+	if( plugin_lib.load() )
+	{
+		descriptorFunction = ( LADSPA_Descriptor_Function )
+				plugin_lib.resolve( "ladspa_descriptor" );
+	}
+	if( descriptorFunction == nullptr )
+	{
+		qWarning() << plugin_lib.errorString();
+		return false;
+	}
+
+	for( ladspaManagerDescription * plugIn : m_ladspaManagerMap )
+	{
+		if( plugIn->filePath == _path )
+		{
+			plugIn->descriptorFunction = descriptorFunction;
+		}
+	}
+	return true;
+}
+
+
+
+
+bool LadspaManager::CacheEntry::matches( const QFileInfo & _file ) const
+{
+	return modified == _file.lastModified().toMSecsSinceEpoch() &&
+		size == _file.size();
+}
+
+
+
+
+QHash<QString, LadspaManager::CacheEntry> LadspaManager::readCache() const
+{
+	QHash<QString, CacheEntry> cache;
+
+	QFile file( ConfigManager::inst()->ladspaCacheFile() );
+	QDomDocument doc;
+	if( !file.open( QIODevice::ReadOnly ) || !doc.setContent( &file ) )
+	{
+		return cache;
+	}
+
+	const QDomElement root = doc.documentElement();
+	if( root.tagName() != "ladspacache" ||
+		root.attribute( "version" ).toInt() != LADSPA_CACHE_VERSION ||
+		root.attribute( "lmmsversion" ) != LMMS_VERSION )
+	{
+		return cache;
+	}
+
+	for( QDomElement lib = root.firstChildElement( "library" );
+			!lib.isNull(); lib = lib.nextSiblingElement( "library" ) )
+	{
+		CacheEntry entry;
+		entry.path = lib.attribute( "path" );
+		entry.modified = lib.attribute( "modified" ).toLongLong();
+		entry.size = lib.attribute( "size" ).toLongLong();
+		for( QDomElement p = lib.firstChildElement( "plugin" );
+				!p.isNull(); p = p.nextSiblingElement( "plugin" ) )
+		{
+			ladspaManagerDescription plugIn;
+			plugIn.descriptorFunction = nullptr;
+			plugIn.index = p.attribute( "index" ).toUInt();
+			plugIn.type = static_cast<ladspaPluginType>(
+						p.attribute( "type" ).toInt() );
+			plugIn.inputChannels = p.attribute( "inputs" ).toUShort();
+			plugIn.outputChannels = p.attribute( "outputs" ).toUShort();
+			plugIn.filePath = entry.path;
+			plugIn.name = p.attribute( "name" );
+			plugIn.properties = p.attribute( "properties" ).toInt();
+			entry.plugins.append( qMakePair( p.attribute( "label" ), plugIn ) );
+		}
+		cache.insert( entry.path, entry );
+	}
+	return cache;
+}
+
+
+
+
+void LadspaManager::writeCache() const
+{
+	QDomDocument doc( "lmms-ladspacache" );
+	QDomElement root = doc.createElement( "ladspacache" );
+	root.setAttribute( "version", LADSPA_CACHE_VERSION );
+	root.setAttribute( "lmmsversion", LMMS_VERSION );
+	doc.appendChild( root );
+
+	for( const CacheEntry & entry : m_cache )
+	{
+		QDomElement lib = doc.createElement( "library" );
+		lib.setAttribute( "path", entry.path );
+		lib.setAttribute( "modified", entry.modified );
+		lib.setAttribute( "size", entry.size );
+		for( const auto & plugin : entry.plugins )
+		{
+			QDomElement p = doc.createElement( "plugin" );
+			p.setAttribute( "label", plugin.first );
+			p.setAttribute( "index", plugin.second.index );
+			p.setAttribute( "type", plugin.second.type );
+			p.setAttribute( "inputs", plugin.second.inputChannels );
+			p.setAttribute( "outputs", plugin.second.outputChannels );
+			p.setAttribute( "name", plugin.second.name );
+			p.setAttribute( "properties", plugin.second.properties );
+			lib.appendChild( p );
+		}
+		root.appendChild( lib );
+	}
+
+	QFile file( ConfigManager::inst()->ladspaCacheFile() );
+	if( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+	{
+		file.write( doc.toByteArray() );
 	}
 }
 
@@ -301,8 +482,8 @@ bool LadspaManager::isInplaceBroken( const ladspa_key_t &  _plugin )
 bool LadspaManager::isRealTimeCapable(
 					const ladspa_key_t &  _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
-	return( descriptor ? LADSPA_IS_HARD_RT_CAPABLE( descriptor->Properties )
+	const ladspaManagerDescription * plugIn = getDescription( _plugin );
+	return( plugIn ? LADSPA_IS_HARD_RT_CAPABLE( plugIn->properties )
 					   : false );
 }
 
@@ -311,8 +492,8 @@ bool LadspaManager::isRealTimeCapable(
 
 QString LadspaManager::getName( const ladspa_key_t & _plugin )
 {
-	const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
-	return( descriptor ? descriptor->Name : "" );
+	const ladspaManagerDescription * plugIn = getDescription( _plugin );
+	return( plugIn ? plugIn->name : QString() );
 }
 
 
@@ -531,11 +712,7 @@ bool LadspaManager::isEnum( const ladspa_key_t & _plugin, uint32_t _port )
 	if( m_ladspaManagerMap.contains( _plugin )
 		   && _port < getPortCount( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
-		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
+		const LADSPA_Descriptor * descriptor = getDescriptor( _plugin );
 		LADSPA_PortRangeHintDescriptor hintDescriptor =
 			descriptor->PortRangeHints[_port].HintDescriptor;
 		// This is an LMMS extension to ladspa
@@ -576,12 +753,13 @@ const LADSPA_Descriptor * LadspaManager::getDescriptor(
 {
 	if( m_ladspaManagerMap.contains( _plugin ) )
 	{
-		LADSPA_Descriptor_Function descriptorFunction =
-			m_ladspaManagerMap[_plugin]->descriptorFunction;
-		const LADSPA_Descriptor * descriptor =
-				descriptorFunction(
-					m_ladspaManagerMap[_plugin]->index );
-		return( descriptor );
+		ladspaManagerDescription * plugIn = m_ladspaManagerMap[_plugin];
+		if( plugIn->descriptorFunction == nullptr &&
+			!loadLibrary( plugIn->filePath ) )
+		{
+			return( nullptr );
+		}
+		return( plugIn->descriptorFunction( plugIn->index ) );
 	}
 	else
 	{
@@ -0,0 +1,73 @@
+/*
+ * LatencyGovernor.cpp - queues more periods for the device when needed
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "LatencyGovernor.h"
+
+
+LatencyGovernor::LatencyGovernor( int minPeriods, int maxPeriods ) :
+	m_minPeriods( minPeriods ),
+	m_maxPeriods( qMax( minPeriods, maxPeriods ) ),
+	m_periods( minPeriods ),
+	m_lastGlitches( 0 ),
+	m_sinceStep( 0 ),
+	m_calm( 0 )
+{
+}
+
+
+
+
+int LatencyGovernor::update( int cpuLoad, int glitches, qint64 periodLength )
+{
+	// the counters start over when the history is cleared
+	const bool glitched = glitches > m_lastGlitches;
+	m_lastGlitches = glitches;
+	m_sinceStep += periodLength;
+
+	if( glitched || cpuLoad >= HighLoad )
+	{
+		m_calm = 0;
+		if( m_periods < m_maxPeriods && m_sinceStep >= HoldTime )
+		{
+			++m_periods;
+			m_sinceStep = 0;
+		}
+	}
+	else if( cpuLoad < LowLoad )
+	{
+		m_calm += periodLength;
+		if( m_calm >= CalmTime && m_periods > m_minPeriods )
+		{
+			--m_periods;
+			m_sinceStep = 0;
+			m_calm = 0;
+		}
+	}
+	else
+	{
+		m_calm = 0;
+	}
+
+	return m_periods;
+}
@@ -87,29 +87,50 @@ void LfoController::updateValueBuffer()
 	float phase = m_currentPhase + m_phaseOffset;
 
 	// roll phase up until we're in sync with period counter
-	m_bufferLastUpdated++;
-	if( m_bufferLastUpdated < s_periods )
+	const long skippedPeriods = s_periods - m_bufferLastUpdated - 1;
+	if( skippedPeriods > 0 )
 	{
-		int diff = s_periods - m_bufferLastUpdated;
-		phase += static_cast<float>( Engine::audioEngine()->framesPerPeriod() * diff ) / m_duration;
-		m_bufferLastUpdated += diff;
+		phase += static_cast<float>( Engine::audioEngine()->framesPerPeriod() * skippedPeriods ) / m_duration;
 	}
 
-	float amount = m_amountModel.value();
-	ValueBuffer *amountBuffer = m_amountModel.valueBuffer();
-	int amountInc = amountBuffer ? 1 : 0;
-	float *amountPtr = amountBuffer ? &(amountBuffer->values()[ 0 ] ) : &amount;
-
-	for( float& f : m_valueBuffer )
+	// render the bare wave first, so that neither loop has to check the
+	// shape or the amount's kind per frame
+	const int frames = m_valueBuffer.length();
+	float * values = m_valueBuffer.values();
+	const float phaseInc = 1.0f / m_duration;
+	if( m_sampleFunction != nullptr )
 	{
-		const float currentSample = m_sampleFunction != nullptr
-			? m_sampleFunction( phase )
-			: m_userDefSampleBuffer->userWaveSample( phase );
-
-		f = qBound( 0.0f, m_baseModel.value() + ( *amountPtr * currentSample / 2.0f ), 1.0f );
+		for( int f = 0; f < frames; ++f )
+		{
+			values[f] = m_sampleFunction( phase );
+			phase += phaseInc;
+		}
+	}
+	else
+	{
+		for( int f = 0; f < frames; ++f )
+		{
+			values[f] = m_userDefSampleBuffer->userWaveSample( phase );
+			phase += phaseInc;
+		}
+	}
 
-		phase += 1.0 / m_duration;
-		amountPtr += amountInc;
+	const float base = m_baseModel.value();
+	if( ValueBuffer * amountBuffer = m_amountModel.valueBuffer() )
+	{
+		const float * amounts = amountBuffer->values();
+		for( int f = 0; f < frames; ++f )
+		{
+			values[f] = qBound( 0.0f, base + amounts[f] * values[f] / 2.0f, 1.0f );
+		}
+	}
+	else
+	{
+		const float amount = m_amountModel.value() / 2.0f;
+		for( int f = 0; f < frames; ++f )
+		{
+			values[f] = qBound( 0.0f, base + amount * values[f], 1.0f );
+		}
 	}
 
 	m_currentPhase = absFraction( phase - m_phaseOffset );
@@ -61,6 +61,8 @@ LocklessAllocator::LocklessAllocator( size_t nmemb, size_t size )
 
 	m_available = m_capacity;
 	m_startIndex = 0;
+
+	m_magazines = new Magazine[MaxMagazines];
 }
 
 
@@ -68,6 +70,11 @@ LocklessAllocator::LocklessAllocator( size_t nmemb, size_t size )
 
 LocklessAllocator::~LocklessAllocator()
 {
+	for( int i = 0; i < MaxMagazines; ++i )
+	{
+		freeShared( m_magazines[i].elements, m_magazines[i].count );
+	}
+
 	int available = m_available;
 	if( available != m_capacity )
 	{
@@ -75,6 +82,7 @@ LocklessAllocator::~LocklessAllocator()
 				"Destroying with elements still allocated\n" );
 	}
 
+	delete[] m_magazines;
 	delete[] m_pool;
 	delete[] m_freeState;
 }
@@ -103,62 +111,209 @@ static int ffs( int i )
 
 
 void * LocklessAllocator::alloc()
+{
+	void * element = nullptr;
+	const int thread = threadIndex();
+	Magazine * magazine = thread >= 0 ? &m_magazines[thread] : nullptr;
+	// busy only if another thread is taking the magazine's elements
+	if( magazine && !magazine->busy.exchange( true, std::memory_order_acquire ) )
+	{
+		if( magazine->count == 0 )
+		{
+			magazine->count = allocShared( magazine->elements, MagazineSize / 2 );
+		}
+		if( magazine->count > 0 )
+		{
+			element = magazine->elements[--magazine->count];
+		}
+		magazine->busy.store( false, std::memory_order_release );
+	}
+	else
+	{
+		allocShared( &element, 1 );
+	}
+
+	if( element == nullptr && ( element = steal( thread ) ) == nullptr )
+	{
+		fprintf( stderr, "LocklessAllocator: No free space\n" );
+	}
+	return element;
+}
+
+
+
+
+void LocklessAllocator::free( void * ptr )
+{
+	if( !isValid( ptr ) )
+	{
+		fprintf( stderr, "LocklessAllocator: Invalid pointer\n" );
+		return;
+	}
+
+	const int thread = threadIndex();
+	Magazine * magazine = thread >= 0 ? &m_magazines[thread] : nullptr;
+	if( magazine && !magazine->busy.exchange( true, std::memory_order_acquire ) )
+	{
+		if( magazine->count == MagazineSize )
+		{
+			magazine->count -= MagazineSize / 2;
+			freeShared( magazine->elements + magazine->count, MagazineSize / 2 );
+		}
+		magazine->elements[magazine->count++] = ptr;
+		magazine->busy.store( false, std::memory_order_release );
+		return;
+	}
+	freeShared( &ptr, 1 );
+}
+
+
+
+
+int LocklessAllocator::allocShared( void * * elements, int count )
 {
 	// Some of these CAS loops could probably use relaxed atomics, as discussed
 	// in http://en.cppreference.com/w/cpp/atomic/atomic/compare_exchange.
 	// Let's use sequentially-consistent ops to be safe for now.
 	int available = m_available.load();
+	int reserved;
 	do
 	{
-		if( !available )
+		reserved = std::min( available, count );
+		if( reserved == 0 )
 		{
-			fprintf( stderr, "LocklessAllocator: No free space\n" );
-			return nullptr;
+			return 0;
 		}
 	}
-	while (!m_available.compare_exchange_weak(available, available - 1));
+	while (!m_available.compare_exchange_weak(available, available - reserved));
 
+	// the reserved elements are free somewhere, several of a set are
+	// taken at once
+	int taken = 0;
 	const size_t startIndex = m_startIndex++ % m_freeStateSets;
-	for (size_t set = startIndex;; set = ( set + 1 ) % m_freeStateSets)
+	for (size_t set = startIndex; taken < reserved; set = ( set + 1 ) % m_freeStateSets)
 	{
-		for (int freeState = m_freeState[set]; freeState != -1;)
+		for (int freeState = m_freeState[set]; freeState != -1 && taken < reserved;)
 		{
-			int bit = ffs( ~freeState ) - 1;
-			if (m_freeState[set].compare_exchange_weak(freeState,
-							freeState | 1 << bit ) )
+			int bits[SIZEOF_SET];
+			int claimed = 0;
+			int newState = freeState;
+			while( newState != -1 && taken + claimed < reserved )
+			{
+				bits[claimed] = ffs( ~newState ) - 1;
+				newState |= 1 << bits[claimed++];
+			}
+			if (m_freeState[set].compare_exchange_weak(freeState, newState))
 			{
-				return m_pool + ( SIZEOF_SET * set + bit )
-								* m_elementSize;
+				for( int i = 0; i < claimed; ++i )
+				{
+					elements[taken++] = m_pool + ( SIZEOF_SET * set + bits[i] )
+									* m_elementSize;
+				}
+				freeState = newState;
 			}
 		}
 	}
+	return taken;
 }
 
 
 
 
-void LocklessAllocator::free( void * ptr )
+void LocklessAllocator::freeShared( void * const * elements, int count )
 {
-	ptrdiff_t diff = (char *)ptr - m_pool;
-	if( diff < 0 || diff % m_elementSize )
+	int freed = 0;
+	for( int i = 0; i < count; ++i )
 	{
-invalid:
-		fprintf( stderr, "LocklessAllocator: Invalid pointer\n" );
-		return;
+		size_t offset = ( (char *)elements[i] - m_pool ) / m_elementSize;
+		size_t set = offset / SIZEOF_SET;
+		int bit = offset % SIZEOF_SET;
+		int mask = 1 << bit;
+		int prevState = m_freeState[set].fetch_and(~mask);
+		if ( !( prevState & mask ) )
+		{
+			fprintf( stderr, "LocklessAllocator: Block not in use\n" );
+			continue;
+		}
+		++freed;
 	}
-	size_t offset = diff / m_elementSize;
-	if( offset >= m_capacity )
+	m_available += freed;
+}
+
+
+
+
+void * LocklessAllocator::steal( int thread )
+{
+	for( int i = 0; i < MaxMagazines; ++i )
 	{
-		goto invalid;
+		Magazine & magazine = m_magazines[i];
+		if( i == thread || magazine.busy.exchange( true, std::memory_order_acquire ) )
+		{
+			continue;
+		}
+		void * element = magazine.count > 0 ? magazine.elements[--magazine.count] : nullptr;
+		magazine.busy.store( false, std::memory_order_release );
+		if( element )
+		{
+			return element;
+		}
 	}
-	size_t set = offset / SIZEOF_SET;
-	int bit = offset % SIZEOF_SET;
-	int mask = 1 << bit;
-	int prevState = m_freeState[set].fetch_and(~mask);
-	if ( !( prevState & mask ) )
+	return nullptr;
+}
+
+
+
+
+bool LocklessAllocator::isValid( void * ptr ) const
+{
+	ptrdiff_t diff = (char *)ptr - m_pool;
+	return diff >= 0 && diff % m_elementSize == 0 &&
+		static_cast<size_t>( diff ) / m_elementSize < m_capacity;
+}
+
+
+
+
+int LocklessAllocator::threadIndex()
+{
+	// indices of finished threads are reused, with the elements their
+	// magazines still hold
+	static std::atomic<unsigned long long> used( 0 );
+	static_assert( MaxMagazines <= sizeof( unsigned long long ) * 8, "one bit per magazine" );
+
+	struct Index
 	{
-		fprintf( stderr, "LocklessAllocator: Block not in use\n" );
-		return;
-	}
-	++m_available;
+		int value = -1;
+
+		Index()
+		{
+			unsigned long long state = used.load();
+			do
+			{
+				if( ~state == 0 )
+				{
+					value = -1;
+					return;
+				}
+				value = 0;
+				while( state & 1ULL << value )
+				{
+					++value;
+				}
+			}
+			while( !used.compare_exchange_weak( state, state | 1ULL << value ) );
+		}
+
+		~Index()
+		{
+			if( value >= 0 )
+			{
+				used.fetch_and( ~( 1ULL << value ) );
+			}
+		}
+	} ;
+
+	static thread_local const Index index;
+	return index.value;
 }
@@ -25,6 +25,8 @@
 
 #include "MemoryManager.h"
 
+#include <atomic>
+
 #include <QtCore/QtGlobal>
 #include "rpmalloc.h"
 
@@ -41,6 +43,8 @@ struct MemoryManagerGlobalGuard {
 
 namespace {
 static thread_local size_t thread_guard_depth;
+// only ever read for reports, so the counting needs no ordering
+std::atomic<size_t> allocated_bytes{0};
 }
 
 MemoryManager::ThreadGuard::ThreadGuard()
@@ -65,7 +69,9 @@ void* MemoryManager::alloc(size_t size)
 	// Compilers may optimize the instance away otherwise.
 	Q_UNUSED(&local_mm_thread_guard);
 	Q_ASSERT_X(rpmalloc_is_thread_initialized(), "MemoryManager::alloc", "Thread not initialized");
-	return rpmalloc(size);
+	void * ptr = rpmalloc(size);
+	allocated_bytes.fetch_add(rpmalloc_usable_size(ptr), std::memory_order_relaxed);
+	return ptr;
 }
 
 
@@ -73,5 +79,14 @@ void MemoryManager::free(void * ptr)
 {
 	Q_UNUSED(&local_mm_thread_guard);
 	Q_ASSERT_X(rpmalloc_is_thread_initialized(), "MemoryManager::free", "Thread not initialized");
+	if (ptr) {
+		allocated_bytes.fetch_sub(rpmalloc_usable_size(ptr), std::memory_order_relaxed);
+	}
 	return rpfree(ptr);
 }
+
+
+size_t MemoryManager::allocatedBytes()
+{
+	return allocated_bytes.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,294 @@
+/*
+ * MemoryReport.cpp - what the tracks, plugins and samples of a project use
+ *                    of memory
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "MemoryReport.h"
+
+#include <algorithm>
+
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+
+#include "lmmsconfig.h"
+
+#include "AudioPort.h"
+#include "BBTrackContainer.h"
+#include "Effect.h"
+#include "EffectChain.h"
+#include "Engine.h"
+#include "Instrument.h"
+#include "InstrumentTrack.h"
+#include "MemoryManager.h"
+#include "Mixer.h"
+#include "RemotePlugin.h"
+#include "SampleBuffer.h"
+#include "SampleCache.h"
+#include "SampleClip.h"
+#include "SampleTrack.h"
+#include "Song.h"
+
+#if defined(LMMS_BUILD_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(LMMS_BUILD_APPLE)
+#include <libproc.h>
+#include <unistd.h>
+#elif defined(LMMS_BUILD_LINUX)
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+
+QJsonArray ownersToJson( const std::vector<MemoryReport::OwnerUsage> & owners )
+{
+	QJsonArray array;
+	for( const MemoryReport::OwnerUsage & owner : owners )
+	{
+		QJsonArray plugins;
+		for( const MemoryReport::PluginUsage & plugin : owner.plugins )
+		{
+			plugins.append( QJsonObject{
+				{ "name", plugin.name },
+				{ "bytes", static_cast<qint64>( plugin.bytes ) },
+				{ "processBytes", static_cast<qint64>( plugin.processBytes ) } } );
+		}
+		array.append( QJsonObject{
+			{ "name", owner.name },
+			{ "bytes", static_cast<qint64>( owner.bytes() ) },
+			{ "sampleBytes", static_cast<qint64>( owner.sampleBytes ) },
+			{ "plugins", plugins } } );
+	}
+	return array;
+}
+
+}
+
+
+
+
+size_t MemoryReport::OwnerUsage::bytes() const
+{
+	size_t total = sampleBytes;
+	for( const PluginUsage & plugin : plugins )
+	{
+		total += plugin.bytes + plugin.processBytes;
+	}
+	return total;
+}
+
+
+
+
+MemoryReport MemoryReport::collect()
+{
+	MemoryReport report;
+	report.resident = residentBytes();
+	report.allocated = MemoryManager::allocatedBytes();
+
+	const TrackContainer * containers[] = { Engine::getSong(), Engine::getBBTrackContainer() };
+	for( const TrackContainer * container : containers )
+	{
+		if( container == nullptr )
+		{
+			continue;
+		}
+		for( Track * track : container->tracks() )
+		{
+			OwnerUsage owner;
+			owner.name = track->name();
+			if( InstrumentTrack * instrumentTrack = dynamic_cast<InstrumentTrack *>( track ) )
+			{
+				// not there yet if it's deferred until it's needed
+				if( instrumentTrack->instrument() != nullptr )
+				{
+					owner.plugins.push_back( report.pluginUsage( instrumentTrack->instrument() ) );
+				}
+				report.addEffects( owner, instrumentTrack->audioPort()->effects() );
+			}
+			else if( SampleTrack * sampleTrack = dynamic_cast<SampleTrack *>( track ) )
+			{
+				for( Clip * clip : sampleTrack->getClips() )
+				{
+					owner.sampleBytes += static_cast<SampleClip *>( clip )->sampleBuffer()->bytes();
+				}
+				report.addEffects( owner, sampleTrack->audioPort()->effects() );
+			}
+			else
+			{
+				continue;
+			}
+			report.tracks.push_back( owner );
+		}
+	}
+
+	Mixer * mixer = Engine::mixer();
+	for( mix_ch_t i = 0; mixer != nullptr && i < mixer->numChannels(); ++i )
+	{
+		OwnerUsage owner;
+		owner.name = mixer->mixerChannel( i )->m_name;
+		report.addEffects( owner, &mixer->mixerChannel( i )->m_fxChain );
+		report.mixerChannels.push_back( owner );
+	}
+
+	const std::vector<SampleCache::Entry> entries = SampleCache::entries();
+	QHash<QString, int> copies;
+	for( const SampleCache::Entry & entry : entries )
+	{
+		++copies[entry.key.path];
+	}
+	for( const SampleCache::Entry & entry : entries )
+	{
+		SampleUsage sample;
+		sample.file = entry.key.path;
+		sample.sampleRate = entry.key.sampleRate;
+		sample.bytes = entry.bytes;
+		sample.users = entry.users;
+		sample.duplicated = copies.value( entry.key.path ) > 1;
+		report.samples.push_back( sample );
+
+		report.sampleBytes += entry.bytes;
+		if( entry.users == 0 )
+		{
+			report.unusedSampleBytes += entry.bytes;
+		}
+	}
+	std::sort( report.samples.begin(), report.samples.end(),
+		[]( const SampleUsage & a, const SampleUsage & b ) { return a.bytes > b.bytes; } );
+	report.sharedSampleBytes = SampleCache::bytesSaved();
+
+	return report;
+}
+
+
+
+
+QJsonObject MemoryReport::toJson() const
+{
+	QJsonArray files;
+	for( const SampleUsage & sample : samples )
+	{
+		files.append( QJsonObject{
+			{ "file", sample.file },
+			{ "sampleRate", static_cast<qint64>( sample.sampleRate ) },
+			{ "bytes", static_cast<qint64>( sample.bytes ) },
+			{ "users", sample.users },
+			{ "duplicated", sample.duplicated } } );
+	}
+
+	return QJsonObject{
+		{ "residentBytes", static_cast<qint64>( resident ) },
+		{ "allocatedBytes", static_cast<qint64>( allocated ) },
+		{ "remoteResidentBytes", static_cast<qint64>( remoteResident ) },
+		{ "pluginBytes", static_cast<qint64>( pluginBytes ) },
+		{ "samples", QJsonObject{
+			{ "bytes", static_cast<qint64>( sampleBytes ) },
+			{ "unusedBytes", static_cast<qint64>( unusedSampleBytes ) },
+			{ "sharedBytes", static_cast<qint64>( sharedSampleBytes ) },
+			{ "files", files } } },
+		{ "tracks", ownersToJson( tracks ) },
+		{ "mixerChannels", ownersToJson( mixerChannels ) } };
+}
+
+
+
+
+size_t MemoryReport::residentBytes( qint64 pid )
+{
+#if defined(LMMS_BUILD_WIN32)
+	HANDLE process = pid != 0 ? OpenProcess( PROCESS_QUERY_LIMITED_INFORMATION | PROCESS_VM_READ,
+							FALSE, static_cast<DWORD>( pid ) )
+					: GetCurrentProcess();
+	if( process == nullptr )
+	{
+		return 0;
+	}
+	PROCESS_MEMORY_COUNTERS counters;
+	const bool known = GetProcessMemoryInfo( process, &counters, sizeof( counters ) ) != 0;
+	if( pid != 0 )
+	{
+		CloseHandle( process );
+	}
+	return known ? counters.WorkingSetSize : 0;
+#elif defined(LMMS_BUILD_APPLE)
+	struct proc_taskinfo info;
+	if( proc_pidinfo( pid != 0 ? pid : getpid(), PROC_PIDTASKINFO, 0, &info, sizeof( info ) ) != sizeof( info ) )
+	{
+		return 0;
+	}
+	return info.pti_resident_size;
+#elif defined(LMMS_BUILD_LINUX)
+	// the second number is the resident set, in pages
+	QFile statm( pid != 0 ? QString( "/proc/%1/statm" ).arg( pid ) : QString( "/proc/self/statm" ) );
+	if( !statm.open( QIODevice::ReadOnly ) )
+	{
+		return 0;
+	}
+	const QList<QByteArray> pages = statm.readAll().split( ' ' );
+	return pages.size() > 1 ? pages[1].toULongLong() * sysconf( _SC_PAGESIZE ) : 0;
+#else
+	Q_UNUSED( pid );
+	return 0;
+#endif
+}
+
+
+
+
+MemoryReport::PluginUsage MemoryReport::pluginUsage( const Plugin * plugin )
+{
+	PluginUsage usage;
+	usage.name = plugin->displayName();
+	usage.bytes = plugin->memoryUsage();
+	pluginBytes += usage.bytes;
+
+	if( const RemotePlugin * remote = plugin->remotePlugin() )
+	{
+		usage.process = remote->processId();
+		if( usage.process != 0 )
+		{
+			usage.processBytes = residentBytes( usage.process );
+			// shared processes host several plugins
+			if( std::find( m_processes.begin(), m_processes.end(), usage.process ) == m_processes.end() )
+			{
+				m_processes.push_back( usage.process );
+				remoteResident += usage.processBytes;
+			}
+		}
+	}
+	return usage;
+}
+
+
+
+
+void MemoryReport::addEffects( OwnerUsage & owner, const EffectChain * chain )
+{
+	for( const Effect * effect : chain->m_effects )
+	{
+		owner.plugins.push_back( pluginUsage( effect ) );
+	}
+}
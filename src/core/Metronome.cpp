@@ -0,0 +1,115 @@
+/*
+ * Metronome.cpp - plays the metronome clicks without allocating
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Metronome.h"
+
+#include "InternalSamples.h"
+#include "SamplePlayHandle.h"
+
+
+namespace
+{
+
+class MetronomePlayHandle : public SamplePlayHandle
+{
+public:
+	MetronomePlayHandle( SampleBuffer * sample, AudioPort * port ) :
+		SamplePlayHandle( sample, false )
+	{
+		setAudioPort( port );
+		// the metronome is the only one deleting the handle
+		setRecycled( true );
+	}
+} ;
+
+const char * const ClickSamples[2] =
+{
+	"misc/metronome01.ogg",
+	"misc/metronome02.ogg"
+} ;
+
+} // namespace
+
+
+
+
+Metronome::Metronome() :
+	m_audioPort( "Metronome", false ),
+	m_nextHandle { 0, 0 }
+{
+	for( int sound = 0; sound < 2; ++sound )
+	{
+		SampleBuffer * sample = InternalSamples::get( ClickSamples[sound] );
+		for( auto & handle : m_handles[sound] )
+		{
+			handle = new MetronomePlayHandle( sample, &m_audioPort );
+		}
+	}
+}
+
+
+
+
+Metronome::~Metronome()
+{
+	// the audio engine has to drop the handles before
+	for( auto & handles : m_handles )
+	{
+		for( SamplePlayHandle * handle : handles )
+		{
+			delete handle;
+		}
+	}
+}
+
+
+
+
+SamplePlayHandle * Metronome::click( bool strong )
+{
+	const int sound = strong ? 1 : 0;
+	SamplePlayHandle * handle = m_handles[sound][m_nextHandle[sound]];
+	m_nextHandle[sound] = ( m_nextHandle[sound] + 1 ) % HandlesPerSound;
+
+	handle->rewind();
+	return handle;
+}
+
+
+
+
+bool Metronome::owns( const PlayHandle * handle ) const
+{
+	for( const auto & handles : m_handles )
+	{
+		for( const SamplePlayHandle * h : handles )
+		{
+			if( h == handle )
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <cmath>
+#include <utility>
 
 #include "ConfigManager.h"
 #include "Engine.h"
@@ -52,6 +53,12 @@ Microtuner::Microtuner() :
 	}
 	connect(Engine::getSong(), SIGNAL(scaleListChanged(int)), this, SLOT(updateScaleList(int)));
 	connect(Engine::getSong(), SIGNAL(keymapListChanged(int)), this, SLOT(updateKeymapList(int)));
+
+	connect(Engine::getSong(), SIGNAL(scaleListChanged(int)), this, SLOT(updateFrequencyTable()));
+	connect(Engine::getSong(), SIGNAL(keymapListChanged(int)), this, SLOT(updateFrequencyTable()));
+	connect(&m_scaleModel, SIGNAL(dataChanged()), this, SLOT(updateFrequencyTable()));
+	connect(&m_keymapModel, SIGNAL(dataChanged()), this, SLOT(updateFrequencyTable()));
+	updateFrequencyTable();
 }
 
 
@@ -62,47 +69,70 @@ Microtuner::Microtuner() :
 float Microtuner::keyToFreq(int key, int userBaseNote) const
 {
 	if (key < 0 || key >= NumKeys) {return 0;}
+
+	const std::shared_ptr<const FrequencyTable> table = std::atomic_load(&m_frequencyTable);
+	if (!table || table->ratios[key] == 0) {return 0;}		// key is not mapped, abort
+	if (table->constant) {return table->baseFreq;}
+
+	// the base note (the "A4 reference") plays the base frequency
+	const int baseNote = m_keyRangeImportModel.value() ? table->baseKey : userBaseNote;
+	if (baseNote < 0 || baseNote >= NumKeys || table->ratios[baseNote] == 0) {return 0;}	// base key is not mapped, umm...
+
+	return table->baseFreq * (table->ratios[key] / table->ratios[baseNote]);
+}
+
+
+/** \brief Precompute the frequency ratios of all keys for the selected scale and keymap.
+ *  Called whenever the selection or the selected scale or keymap changes, so that keyToFreq() only has to look
+ *  up the ratios of the key and of the base note.
+ */
+void Microtuner::updateFrequencyTable()
+{
 	Song *song = Engine::getSong();
-	if (!song) {return 0;}
+	if (!song) {return;}
 
 	// Get keymap and scale selected at this moment
 	std::shared_ptr<const Keymap> keymap = song->getKeymap(m_keymapModel.value());
 	std::shared_ptr<const Scale> scale = song->getScale(m_scaleModel.value());
 	const std::vector<Interval> &intervals = scale->getIntervals();
 
-	// Convert MIDI key to scale degree + octave offset.
-	// The octaves are primarily driven by the keymap wraparound: octave count is increased or decreased if the key
-	// goes over or under keymap range. In case the keymap refers to a degree that does not exist in the scale, it is
-	// assumed the keymap is non-repeating or just really big, so the octaves are also driven by the scale wraparound.
-	const int keymapDegree = keymap->getDegree(key);		// which interval should be used according to the keymap
-	if (keymapDegree == -1) {return 0;}						// key is not mapped, abort
-	const int keymapOctave = keymap->getOctave(key);		// how many times did the keymap repeat
-	const int octaveDegree = intervals.size() - 1;			// index of the interval with octave ratio
-	if (octaveDegree == 0) {								// octave interval is 1/1, i.e. constant base frequency
-		return keymap->getBaseFreq();						// → return the baseFreq directly
-	}
-	const int scaleOctave = keymapDegree / octaveDegree;
+	auto table = std::make_shared<FrequencyTable>();
+	table->baseKey = keymap->getBaseKey();
+	table->baseFreq = keymap->getBaseFreq();
 
-	// which interval should be used according to the scale and keymap together
-	const int degree_rem = keymapDegree % octaveDegree;
-	const int scaleDegree = degree_rem >= 0 ? degree_rem : degree_rem + octaveDegree;	// get true modulo
+	const int octaveDegree = intervals.size() - 1;			// index of the interval with octave ratio
+	table->constant = octaveDegree == 0;					// octave interval is 1/1, i.e. constant base frequency
+	const double octaveRatio = intervals[octaveDegree].getRatio();
 
-	// Compute base note (the "A4 reference") degree and octave
-	const int baseNote = m_keyRangeImportModel.value() ? keymap->getBaseKey() : userBaseNote;
-	const int baseKeymapDegree = keymap->getDegree(baseNote);
-	if (baseKeymapDegree == -1) {return 0;}					// base key is not mapped, umm...
-	const int baseKeymapOctave = keymap->getOctave(baseNote);
-	const int baseScaleOctave = baseKeymapDegree / octaveDegree;
+	for (int key = 0; key < NumKeys; key++)
+	{
+		// Convert MIDI key to scale degree + octave offset.
+		// The octaves are primarily driven by the keymap wraparound: octave count is increased or decreased if the
+		// key goes over or under keymap range. In case the keymap refers to a degree that does not exist in the
+		// scale, it is assumed the keymap is non-repeating or just really big, so the octaves are also driven by the
+		// scale wraparound.
+		const int keymapDegree = keymap->getDegree(key);	// which interval should be used according to the keymap
+		if (keymapDegree == -1)								// key is not mapped
+		{
+			table->ratios[key] = 0;
+			continue;
+		}
+		if (table->constant)
+		{
+			table->ratios[key] = 1;
+			continue;
+		}
+		const int keymapOctave = keymap->getOctave(key);	// how many times did the keymap repeat
+		const int scaleOctave = keymapDegree / octaveDegree;
 
-	const int baseDegree_rem = baseKeymapDegree % octaveDegree;
-	const int baseScaleDegree = baseDegree_rem >= 0 ? baseDegree_rem : baseDegree_rem + octaveDegree;
+		// which interval should be used according to the scale and keymap together
+		const int degree_rem = keymapDegree % octaveDegree;
+		const int scaleDegree = degree_rem >= 0 ? degree_rem : degree_rem + octaveDegree;	// get true modulo
 
-	// Compute frequency of the middle note and return the final frequency
-	const double octaveRatio = intervals[octaveDegree].getRatio();
-	const float middleFreq = (keymap->getBaseFreq() / pow(octaveRatio, (baseScaleOctave + baseKeymapOctave)))
-								/ intervals[baseScaleDegree].getRatio();
+		table->ratios[key] = intervals[scaleDegree].getRatio() * pow(octaveRatio, keymapOctave + scaleOctave);
+	}
 
-	return middleFreq * intervals[scaleDegree].getRatio() * pow(octaveRatio, keymapOctave + scaleOctave);
+	std::atomic_store(&m_frequencyTable, std::shared_ptr<const FrequencyTable>(std::move(table)));
 }
 
 
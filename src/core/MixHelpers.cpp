@@ -25,12 +25,13 @@
 #include "MixHelpers.h"
 
 #include <cstdio>
+#include <utility>
 
 #include "lmms_math.h"
+#include "lmmsconfig.h"
+#include "MixKernels.h"
 #include "ValueBuffer.h"
 
-#include <cstdio>
-
 
 static bool s_NaNHandler;
 
@@ -61,7 +62,12 @@ static inline void run( sampleFrame* dst, const sample_t* srcLeft, const sample_
 
 
 
-bool isSilent( const sampleFrame* src, int frames )
+//! Plain C++ implementations of all kernels, used if the CPU has no
+//! supported vector instructions and as reference for the others
+namespace Generic
+{
+
+static bool isSilent( const sampleFrame* src, int frames )
 {
 	const float silenceThreshold = 0.0000001f;
 
@@ -76,35 +82,14 @@ bool isSilent( const sampleFrame* src, int frames )
 	return true;
 }
 
-bool useNaNHandler()
-{
-	return s_NaNHandler;
-}
-
-void setNaNHandler( bool use )
-{
-	s_NaNHandler = use;
-}
-
-/*! \brief Function for sanitizing a buffer of infs/nans - returns true if those are found */
-bool sanitize( sampleFrame * src, int frames )
+static bool sanitize( sampleFrame * src, int frames )
 {
-	if( !useNaNHandler() )
-	{
-		return false;
-	}
-
-	bool found = false;
 	for( int f = 0; f < frames; ++f )
 	{
 		for( int c = 0; c < 2; ++c )
 		{
 			if( std::isinf( src[f][c] ) || std::isnan( src[f][c] ) )
 			{
-				#ifdef LMMS_DEBUG
-					printf("Bad data, clearing buffer. frame: ");
-					printf("%d: value %f\n", f, src[f][c]);
-				#endif
 				for( int f = 0; f < frames; ++f )
 				{
 					for( int c = 0; c < 2; ++c )
@@ -112,8 +97,7 @@ bool sanitize( sampleFrame * src, int frames )
 						src[f][c] = 0.0f;
 					}
 				}
-				found = true;
-				return found;
+				return true;
 			}
 			else
 			{
@@ -121,7 +105,7 @@ bool sanitize( sampleFrame * src, int frames )
 			}
 		}
 	}
-	return found;
+	return false;
 }
 
 
@@ -134,7 +118,7 @@ struct AddOp
 	}
 } ;
 
-void add( sampleFrame* dst, const sampleFrame* src, int frames )
+static void add( sampleFrame* dst, const sampleFrame* src, int frames )
 {
 	run<>( dst, src, frames, AddOp() );
 }
@@ -155,7 +139,7 @@ struct AddMultipliedOp
 } ;
 
 
-void addMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
+static void addMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
 {
 	run<>( dst, src, frames, AddMultipliedOp(coeffSrc) );
 }
@@ -174,64 +158,50 @@ struct AddSwappedMultipliedOp
 	const float m_coeff;
 };
 
-void addSwappedMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
+static void addSwappedMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
 {
 	run<>( dst, src, frames, AddSwappedMultipliedOp(coeffSrc) );
 }
 
 
-void addMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coeffSrc, ValueBuffer * coeffSrcBuf, int frames )
+static void addMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coeffSrc, const float * coeffSrcBuf, int frames )
 {
 	for( int f = 0; f < frames; ++f )
 	{
-		dst[f][0] += src[f][0] * coeffSrc * coeffSrcBuf->values()[f];
-		dst[f][1] += src[f][1] * coeffSrc * coeffSrcBuf->values()[f];
+		dst[f][0] += src[f][0] * coeffSrc * coeffSrcBuf[f];
+		dst[f][1] += src[f][1] * coeffSrc * coeffSrcBuf[f];
 	}
 }
 
-void addMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames )
+static void addMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, const float * coeffSrcBuf1, const float * coeffSrcBuf2, int frames )
 {
 	for( int f = 0; f < frames; ++f )
 	{
-		dst[f][0] += src[f][0] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f];
-		dst[f][1] += src[f][1] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f];
+		dst[f][0] += src[f][0] * coeffSrcBuf1[f] * coeffSrcBuf2[f];
+		dst[f][1] += src[f][1] * coeffSrcBuf1[f] * coeffSrcBuf2[f];
 	}
 
 }
 
-void addSanitizedMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coeffSrc, ValueBuffer * coeffSrcBuf, int frames )
+static void addSanitizedMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coeffSrc, const float * coeffSrcBuf, int frames )
 {
-	if ( !useNaNHandler() )
-	{
-		addMultipliedByBuffer( dst, src, coeffSrc, coeffSrcBuf,
-								frames );
-		return;
-	}
-
 	for( int f = 0; f < frames; ++f )
 	{
-		dst[f][0] += ( std::isinf( src[f][0] ) || std::isnan( src[f][0] ) ) ? 0.0f : src[f][0] * coeffSrc * coeffSrcBuf->values()[f];
-		dst[f][1] += ( std::isinf( src[f][1] ) || std::isnan( src[f][1] ) ) ? 0.0f : src[f][1] * coeffSrc * coeffSrcBuf->values()[f];
+		dst[f][0] += ( std::isinf( src[f][0] ) || std::isnan( src[f][0] ) ) ? 0.0f : src[f][0] * coeffSrc * coeffSrcBuf[f];
+		dst[f][1] += ( std::isinf( src[f][1] ) || std::isnan( src[f][1] ) ) ? 0.0f : src[f][1] * coeffSrc * coeffSrcBuf[f];
 	}
 }
 
-void addSanitizedMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames )
+static void addSanitizedMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, const float * coeffSrcBuf1, const float * coeffSrcBuf2, int frames )
 {
-	if ( !useNaNHandler() )
-	{
-		addMultipliedByBuffers( dst, src, coeffSrcBuf1, coeffSrcBuf2,
-								frames );
-		return;
-	}
-
 	for( int f = 0; f < frames; ++f )
 	{
 		dst[f][0] += ( std::isinf( src[f][0] ) || std::isnan( src[f][0] ) )
 			? 0.0f
-			: src[f][0] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f];
+			: src[f][0] * coeffSrcBuf1[f] * coeffSrcBuf2[f];
 		dst[f][1] += ( std::isinf( src[f][1] ) || std::isnan( src[f][1] ) )
 			? 0.0f
-			: src[f][1] * coeffSrcBuf1->values()[f] * coeffSrcBuf2->values()[f];
+			: src[f][1] * coeffSrcBuf1[f] * coeffSrcBuf2[f];
 	}
 
 }
@@ -250,14 +220,8 @@ struct AddSanitizedMultipliedOp
 	const float m_coeff;
 };
 
-void addSanitizedMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
+static void addSanitizedMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
 {
-	if ( !useNaNHandler() )
-	{
-		addMultiplied( dst, src, coeffSrc, frames );
-		return;
-	}
-
 	run<>( dst, src, frames, AddSanitizedMultipliedOp(coeffSrc) );
 }
 
@@ -281,7 +245,7 @@ struct AddMultipliedStereoOp
 } ;
 
 
-void addMultipliedStereo( sampleFrame* dst, const sampleFrame* src, float coeffSrcLeft, float coeffSrcRight, int frames )
+static void addMultipliedStereo( sampleFrame* dst, const sampleFrame* src, float coeffSrcLeft, float coeffSrcRight, int frames )
 {
 
 	run<>( dst, src, frames, AddMultipliedStereoOp(coeffSrcLeft, coeffSrcRight) );
@@ -309,14 +273,14 @@ struct MultiplyAndAddMultipliedOp
 } ;
 
 
-void multiplyAndAddMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffDst, float coeffSrc, int frames )
+static void multiplyAndAddMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffDst, float coeffSrc, int frames )
 {
 	run<>( dst, src, frames, MultiplyAndAddMultipliedOp(coeffDst, coeffSrc) );
 }
 
 
 
-void multiplyAndAddMultipliedJoined( sampleFrame* dst,
+static void multiplyAndAddMultipliedJoined( sampleFrame* dst,
 										const sample_t* srcLeft,
 										const sample_t* srcRight,
 										float coeffDst, float coeffSrc, int frames )
@@ -324,5 +288,666 @@ void multiplyAndAddMultipliedJoined( sampleFrame* dst,
 	run<>( dst, srcLeft, srcRight, frames, MultiplyAndAddMultipliedOp(coeffDst, coeffSrc) );
 }
 
+static sampleFrame peak( const sampleFrame* src, int frames )
+{
+	sample_t peakLeft = 0.0f;
+	sample_t peakRight = 0.0f;
+
+	for( int f = 0; f < frames; ++f )
+	{
+		const float absLeft = fabsf( src[f][0] );
+		const float absRight = fabsf( src[f][1] );
+		if( absLeft > peakLeft )
+		{
+			peakLeft = absLeft;
+		}
+		if( absRight > peakRight )
+		{
+			peakRight = absRight;
+		}
+	}
+
+	return { peakLeft, peakRight };
+}
+
+static float energy( const sampleFrame* src, int frames )
+{
+	float sum = 0.0f;
+	for( int f = 0; f < frames; ++f )
+	{
+		sum += src[f][0] * src[f][0] + src[f][1] * src[f][1];
+	}
+	return sum;
+}
+
+static float signedEnergy( const sampleFrame* src, int frames )
+{
+	float sum = 0.0f;
+	for( int f = 0; f < frames; ++f )
+	{
+		sum += src[f][0] * fabsf( src[f][0] ) + src[f][1] * fabsf( src[f][1] );
+	}
+	return sum;
+}
+
+
+
+static void interleave( sampleFrame* dst, const sample_t* srcLeft, const sample_t* srcRight, int frames )
+{
+	for( int f = 0; f < frames; ++f )
+	{
+		dst[f][0] = srcLeft[f];
+		dst[f][1] = srcRight[f];
+	}
+}
+
+
+
+static void deinterleave( sample_t* dstLeft, sample_t* dstRight, const sampleFrame* src, int frames )
+{
+	for( int f = 0; f < frames; ++f )
+	{
+		dstLeft[f] = src[f][0];
+		dstRight[f] = src[f][1];
+	}
+}
+
+
+
+static sampleFrame addMultipliedWithPeak( sampleFrame* dst, const sampleFrame* src, float coeffSrc,
+	const float * coeffSrcBuf1, const float * coeffSrcBuf2, bool sanitized, int frames )
+{
+	sampleFrame peakFrame = { 0.0f, 0.0f };
+
+	for( int f = 0; f < frames; ++f )
+	{
+		for( int c = 0; c < 2; ++c )
+		{
+			float mixed = src[f][c] * coeffSrc;
+			if( coeffSrcBuf1 )
+			{
+				mixed *= coeffSrcBuf1[f];
+			}
+			if( coeffSrcBuf2 )
+			{
+				mixed *= coeffSrcBuf2[f];
+			}
+			if( sanitized && ( std::isinf( src[f][c] ) || std::isnan( src[f][c] ) ) )
+			{
+				mixed = 0.0f;
+			}
+			dst[f][c] += mixed;
+
+			const float absMixed = fabsf( dst[f][c] );
+			if( absMixed > peakFrame[c] )
+			{
+				peakFrame[c] = absMixed;
+			}
+		}
+	}
+
+	return peakFrame;
+}
+
+static float panningGain( float side, PanLaw law )
+{
+	switch( law )
+	{
+		case PanLaw::Linear:
+			return qBound( 0.0f, side, 1.0f );
+		case PanLaw::ConstantPower:
+			return sqrtf( qBound( 0.0f, side, 2.0f ) * 0.5f );
+		case PanLaw::ConstantPowerUnityCenter:
+			return sqrtf( qBound( 0.0f, side, 2.0f ) );
+	}
+	return 1.0f;
+}
+
+
+
+static void applyVolumeAndPanning( sampleFrame* dst, float volume, const float * volumeBuf,
+					float panning, const float * panningBuf, PanLaw law, int frames )
+{
+	for( int f = 0; f < frames; ++f )
+	{
+		const float v = ( volumeBuf ? volumeBuf[f] : volume ) * 0.01f;
+		const float p = ( panningBuf ? panningBuf[f] : panning ) * 0.01f;
+		dst[f][0] *= panningGain( 1.0f - p, law ) * v;
+		dst[f][1] *= panningGain( 1.0f + p, law ) * v;
+	}
+}
+
+
+
+static void copyMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
+{
+	for( int f = 0; f < frames; ++f )
+	{
+		dst[f][0] = src[f][0] * coeffSrc;
+		dst[f][1] = src[f][1] * coeffSrc;
+	}
+}
+
+
+
+//! Same operations as MixKernels::convert(), so that the results match
+template<typename STORE>
+static void convert( const sampleFrame* src, float gain, float scale, const float * dither,
+				float ditherScale, int frames, const STORE& store )
+{
+	const float * s = reinterpret_cast<const float *>( src );
+	const float g = gain * scale;
+	for( int i = 0; i < frames * DEFAULT_CHANNELS; ++i )
+	{
+		float v = s[i] * g;
+		if( dither )
+		{
+			v += dither[i] * ditherScale;
+		}
+		v = v < scale ? v : scale;
+		v = v > -scale ? v : -scale;
+		store( i, v );
+	}
+}
+
+
+
+static void convertToS16( int_sample_t* dst, const sampleFrame* src, float gain, const float * dither,
+				bool swapBytes, int frames )
+{
+	convert( src, gain, S16Scale, dither, 1.0f, frames, [dst, swapBytes]( int i, float v )
+	{
+		const uint16_t x = static_cast<uint16_t>( static_cast<int_sample_t>( v ) );
+		dst[i] = static_cast<int_sample_t>( swapBytes ? ( x << 8 | x >> 8 ) : x );
+	} );
+}
+
+
+
+static void convertToS24( int32_t* dst, const sampleFrame* src, float gain, const float * dither, int frames )
+{
+	convert( src, gain, S24Scale, dither, S24DitherScale, frames, [dst]( int i, float v )
+	{
+		dst[i] = static_cast<int32_t>( v );
+	} );
+}
+
+
+
+//! Same operations as MixKernels::shape()
+static void shape( sampleFrame* dst, const sampleFrame* src, const float * table, int points,
+			float inputGain, const float * inputGainBuf, float outputGain, const float * outputGainBuf,
+			bool clip, int frames )
+{
+	const float top = static_cast<float>( points );
+	const float lastIndex = static_cast<float>( points - 1 );
+	for( int f = 0; f < frames; ++f )
+	{
+		const float in = inputGainBuf ? inputGainBuf[f] : inputGain;
+		const float out = outputGainBuf ? outputGainBuf[f] : outputGain;
+		for( int c = 0; c < DEFAULT_CHANNELS; ++c )
+		{
+			float s = src[f][c] * in;
+			if( clip )
+			{
+				s = s < 1.0f ? s : 1.0f;
+				s = s > -1.0f ? s : -1.0f;
+			}
+			const float magnitude = fabsf( s );
+			float x = magnitude * top;
+			x = x < top ? x : top;
+			float index = truncf( x );
+			index = index < lastIndex ? index : lastIndex;
+			const int i = static_cast<int>( index );
+			float shaped = table[i] + ( table[i + 1] - table[i] ) * ( x - index );
+			float excess = magnitude - 1.0f;
+			excess = excess > 0.0f ? excess : 0.0f;
+			shaped += excess * table[points];
+			dst[f][c] = ( std::signbit( s ) ? -shaped : shaped ) * out;
+		}
+	}
+}
+
+
+
+static void quantize( sampleFrame* buf, const sampleFrame* noise, float gain, float noiseAmount,
+			float levels, int frames )
+{
+	const float ratio = levels > 0.0f ? 1.0f / levels : 1.0f;
+	for( int f = 0; f < frames; ++f )
+	{
+		for( int c = 0; c < DEFAULT_CHANNELS; ++c )
+		{
+			float v = buf[f][c] * gain;
+			if( noise )
+			{
+				v += noise[f][c] * ( buf[f][c] * noiseAmount );
+			}
+			if( levels > 0.0f )
+			{
+				v = roundf( v * levels ) * ratio;
+			}
+			buf[f][c] = v;
+		}
+	}
+}
+
+
+
+static const KernelTable table = {
+	&isSilent,
+	&sanitize,
+	&add,
+	&addMultiplied,
+	&addSwappedMultiplied,
+	&addMultipliedByBuffer,
+	&addMultipliedByBuffers,
+	&addSanitizedMultiplied,
+	&addSanitizedMultipliedByBuffer,
+	&addSanitizedMultipliedByBuffers,
+	&addMultipliedStereo,
+	&multiplyAndAddMultiplied,
+	&multiplyAndAddMultipliedJoined,
+	&peak,
+	&energy,
+	&signedEnergy,
+	&interleave,
+	&deinterleave,
+	&addMultipliedWithPeak,
+	&applyVolumeAndPanning,
+	&copyMultiplied,
+	&convertToS16,
+	&convertToS24,
+	&shape,
+	&quantize
+};
+
+} // namespace Generic
+
+
+
+
+static const KernelTable * s_kernelTable = &Generic::table;
+static Kernels s_kernels = Kernels::Generic;
+
+
+static bool cpuSupports( Kernels k )
+{
+#if ( defined(LMMS_HOST_X86) || defined(LMMS_HOST_X86_64) ) && ( defined(__GNUC__) || defined(__clang__) )
+	__builtin_cpu_init();
+	switch( k )
+	{
+		case Kernels::SSE2: return __builtin_cpu_supports( "sse2" );
+		case Kernels::AVX: return __builtin_cpu_supports( "avx" );
+		case Kernels::AVX512: return __builtin_cpu_supports( "avx512f" );
+		default: break;
+	}
+#endif
+	// NEON is part of every AArch64 CPU
+	return k == Kernels::Generic || k == Kernels::NEON;
+}
+
+
+
+
+static const KernelTable * kernelTable( Kernels k )
+{
+	if( !cpuSupports( k ) )
+	{
+		return nullptr;
+	}
+	switch( k )
+	{
+		case Kernels::Generic: return &Generic::table;
+		case Kernels::SSE2: return sse2Kernels();
+		case Kernels::AVX: return avxKernels();
+		case Kernels::AVX512: return avx512Kernels();
+		case Kernels::NEON: return neonKernels();
+	}
+	return nullptr;
+}
+
+
+
+
+// pick the best kernels before main() runs, until then the generic ones are used
+static const bool s_kernelsSelected = []
+{
+	for( Kernels k : { Kernels::AVX512, Kernels::AVX, Kernels::SSE2, Kernels::NEON } )
+	{
+		if( setKernels( k ) )
+		{
+			break;
+		}
+	}
+	return true;
+}();
+
+
+
+
+Kernels kernels()
+{
+	return s_kernels;
+}
+
+
+
+
+bool setKernels( Kernels k )
+{
+	const KernelTable * table = kernelTable( k );
+	if( table == nullptr )
+	{
+		return false;
+	}
+	s_kernelTable = table;
+	s_kernels = k;
+	return true;
+}
+
+
+
+
+bool isSilent( const sampleFrame* src, int frames )
+{
+	return s_kernelTable->isSilent( src, frames );
+}
+
+bool useNaNHandler()
+{
+	return s_NaNHandler;
+}
+
+void setNaNHandler( bool use )
+{
+	s_NaNHandler = use;
+}
+
+/*! \brief Function for sanitizing a buffer of infs/nans - returns true if those are found */
+bool sanitize( sampleFrame * src, int frames )
+{
+	if( !useNaNHandler() )
+	{
+		return false;
+	}
+
+	const bool found = s_kernelTable->sanitize( src, frames );
+#ifdef LMMS_DEBUG
+	if( found )
+	{
+		printf( "Bad data, clearing buffer.\n" );
+	}
+#endif
+	return found;
+}
+
+
+void add( sampleFrame* dst, const sampleFrame* src, int frames )
+{
+	s_kernelTable->add( dst, src, frames );
+}
+
+
+void addMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
+{
+	s_kernelTable->addMultiplied( dst, src, coeffSrc, frames );
+}
+
+
+void addSwappedMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
+{
+	s_kernelTable->addSwappedMultiplied( dst, src, coeffSrc, frames );
+}
+
+
+void addMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coeffSrc, ValueBuffer * coeffSrcBuf, int frames )
+{
+	s_kernelTable->addMultipliedByBuffer( dst, src, coeffSrc, coeffSrcBuf->values(), frames );
+}
+
+void addMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames )
+{
+	s_kernelTable->addMultipliedByBuffers( dst, src, coeffSrcBuf1->values(), coeffSrcBuf2->values(), frames );
+}
+
+void addSanitizedMultipliedByBuffer( sampleFrame* dst, const sampleFrame* src, float coeffSrc, ValueBuffer * coeffSrcBuf, int frames )
+{
+	if ( !useNaNHandler() )
+	{
+		addMultipliedByBuffer( dst, src, coeffSrc, coeffSrcBuf,
+								frames );
+		return;
+	}
+
+	s_kernelTable->addSanitizedMultipliedByBuffer( dst, src, coeffSrc, coeffSrcBuf->values(), frames );
+}
+
+void addSanitizedMultipliedByBuffers( sampleFrame* dst, const sampleFrame* src, ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames )
+{
+	if ( !useNaNHandler() )
+	{
+		addMultipliedByBuffers( dst, src, coeffSrcBuf1, coeffSrcBuf2,
+								frames );
+		return;
+	}
+
+	s_kernelTable->addSanitizedMultipliedByBuffers( dst, src, coeffSrcBuf1->values(), coeffSrcBuf2->values(), frames );
+}
+
+
+void addSanitizedMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
+{
+	if ( !useNaNHandler() )
+	{
+		addMultiplied( dst, src, coeffSrc, frames );
+		return;
+	}
+
+	s_kernelTable->addSanitizedMultiplied( dst, src, coeffSrc, frames );
+}
+
+
+void addMultipliedStereo( sampleFrame* dst, const sampleFrame* src, float coeffSrcLeft, float coeffSrcRight, int frames )
+{
+	s_kernelTable->addMultipliedStereo( dst, src, coeffSrcLeft, coeffSrcRight, frames );
+}
+
+
+void multiplyAndAddMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffDst, float coeffSrc, int frames )
+{
+	s_kernelTable->multiplyAndAddMultiplied( dst, src, coeffDst, coeffSrc, frames );
+}
+
+
+void multiplyAndAddMultipliedJoined( sampleFrame* dst,
+										const sample_t* srcLeft,
+										const sample_t* srcRight,
+										float coeffDst, float coeffSrc, int frames )
+{
+	s_kernelTable->multiplyAndAddMultipliedJoined( dst, srcLeft, srcRight, coeffDst, coeffSrc, frames );
+}
+
+
+
+
+bool sanitize( const PlanarBuffer & buf )
+{
+	// sanitizing works on each sample on its own, so the channels can be
+	// passed as if they were frames
+	return sanitize( reinterpret_cast<sampleFrame *>( buf.samples() ),
+						buf.frames() * DEFAULT_CHANNELS / 2 );
+}
+
+
+void deinterleave( const PlanarBuffer & dst, const sampleFrame* src )
+{
+	s_kernelTable->deinterleave( dst.channel( 0 ), dst.channel( 1 ), src, dst.frames() );
 }
 
+
+void interleave( sampleFrame* dst, const PlanarBuffer & src )
+{
+	s_kernelTable->interleave( dst, src.channel( 0 ), src.channel( 1 ), src.frames() );
+}
+
+
+sampleFrame peak( const sampleFrame* src, int frames )
+{
+	return s_kernelTable->peak( src, frames );
+}
+
+float energy( const sampleFrame* src, int frames )
+{
+	return s_kernelTable->energy( src, frames );
+}
+
+float signedEnergy( const sampleFrame* src, int frames )
+{
+	return s_kernelTable->signedEnergy( src, frames );
+}
+
+
+sampleFrame addSanitizedMultipliedWithPeak( sampleFrame* dst, const sampleFrame* src, float coeffSrc,
+					ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames )
+{
+	if( !coeffSrcBuf1 )
+	{
+		std::swap( coeffSrcBuf1, coeffSrcBuf2 );
+	}
+	return s_kernelTable->addMultipliedWithPeak( dst, src, coeffSrc,
+						coeffSrcBuf1 ? coeffSrcBuf1->values() : nullptr,
+						coeffSrcBuf2 ? coeffSrcBuf2->values() : nullptr,
+						useNaNHandler(), frames );
+}
+
+
+sampleFrame addMultipliedWithPeak( sampleFrame* dst, const sampleFrame* src, float coeffSrc,
+					ValueBuffer * coeffSrcBuf1, ValueBuffer * coeffSrcBuf2, int frames )
+{
+	if( !coeffSrcBuf1 )
+	{
+		std::swap( coeffSrcBuf1, coeffSrcBuf2 );
+	}
+	return s_kernelTable->addMultipliedWithPeak( dst, src, coeffSrc,
+						coeffSrcBuf1 ? coeffSrcBuf1->values() : nullptr,
+						coeffSrcBuf2 ? coeffSrcBuf2->values() : nullptr,
+						false, frames );
+}
+
+
+
+//! Calls @p block with the offset, the length and the middle of every
+//! sub-block of up to @p interval frames, or once for all of the frames if
+//! @p constant
+template<typename F>
+static void forSubBlocks( bool constant, int interval, int frames, const F & block )
+{
+	if( constant || interval >= frames )
+	{
+		block( 0, frames, frames * 0.5f );
+		return;
+	}
+	for( int offset = 0; offset < frames; offset += interval )
+	{
+		const int length = qMin( interval, frames - offset );
+		block( offset, length, offset + length * 0.5f );
+	}
+}
+
+
+
+void applyVolumeAndPanning( sampleFrame* dst, float volume, ValueBuffer * volumeBuf,
+							float panning, ValueBuffer * panningBuf, PanLaw law, int frames )
+{
+	// nothing to do at unity gain
+	if( !volumeBuf && !panningBuf && volume == 100.0f && panning == 0.0f
+		&& law != PanLaw::ConstantPower )
+	{
+		return;
+	}
+	s_kernelTable->applyVolumeAndPanning( dst, volume, volumeBuf ? volumeBuf->values() : nullptr,
+						panning, panningBuf ? panningBuf->values() : nullptr, law, frames );
+}
+
+
+
+
+void applyVolumeAndPanning( sampleFrame* dst, const ValueRamp & volume, const ValueRamp & panning,
+							PanLaw law, int interval, int frames )
+{
+	forSubBlocks( volume.isConstant() && panning.isConstant(), interval, frames,
+		[&]( int offset, int length, float middle )
+	{
+		applyVolumeAndPanning( dst + offset, volume.valueAt( middle, frames ), nullptr,
+					panning.valueAt( middle, frames ), nullptr, law, length );
+	} );
+}
+
+
+
+
+sampleFrame addMultipliedWithPeak( sampleFrame* dst, const sampleFrame* src, const ValueRamp & coeffSrc1,
+							const ValueRamp & coeffSrc2, int interval, int frames )
+{
+	sampleFrame peak = { 0.0f, 0.0f };
+	forSubBlocks( coeffSrc1.isConstant() && coeffSrc2.isConstant(), interval, frames,
+		[&]( int offset, int length, float middle )
+	{
+		const sampleFrame blockPeak = addMultipliedWithPeak( dst + offset, src + offset,
+				coeffSrc1.valueAt( middle, frames ) * coeffSrc2.valueAt( middle, frames ),
+				nullptr, nullptr, length );
+		peak[0] = qMax( peak[0], blockPeak[0] );
+		peak[1] = qMax( peak[1], blockPeak[1] );
+	} );
+	return peak;
+}
+
+
+
+
+void addMultiplied( sampleFrame* dst, const sampleFrame* src, const ValueRamp & coeffSrc,
+							int interval, int frames )
+{
+	forSubBlocks( coeffSrc.isConstant(), interval, frames, [&]( int offset, int length, float middle )
+	{
+		addMultiplied( dst + offset, src + offset, coeffSrc.valueAt( middle, frames ), length );
+	} );
+}
+
+
+
+
+void copyMultiplied( sampleFrame* dst, const sampleFrame* src, float coeffSrc, int frames )
+{
+	s_kernelTable->copyMultiplied( dst, src, coeffSrc, frames );
+}
+
+
+void convertToS16( int_sample_t* dst, const sampleFrame* src, float gain, const float * dither,
+					bool swapBytes, int frames )
+{
+	s_kernelTable->convertToS16( dst, src, gain, dither, swapBytes, frames );
+}
+
+
+void convertToS24( int32_t* dst, const sampleFrame* src, float gain, const float * dither, int frames )
+{
+	s_kernelTable->convertToS24( dst, src, gain, dither, frames );
+}
+
+
+void shape( sampleFrame* dst, const sampleFrame* src, const float * table, int points, float inputGain,
+		ValueBuffer * inputGainBuf, float outputGain, ValueBuffer * outputGainBuf, bool clip, int frames )
+{
+	s_kernelTable->shape( dst, src, table, points, inputGain, inputGainBuf ? inputGainBuf->values() : nullptr,
+				outputGain, outputGainBuf ? outputGainBuf->values() : nullptr, clip, frames );
+}
+
+
+void quantize( sampleFrame* buf, const sampleFrame* noise, float gain, float noiseAmount, float levels, int frames )
+{
+	s_kernelTable->quantize( buf, noise, gain, noiseAmount, levels, frames );
+}
+
+}
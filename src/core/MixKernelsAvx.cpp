@@ -0,0 +1,152 @@
+/*
+ * MixKernelsAvx.cpp - AVX mix kernels
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "MixKernels.h"
+
+// built with -mavx where the compiler supports it
+#ifdef __AVX__
+#include <immintrin.h>
+
+namespace MixHelpers
+{
+
+namespace
+{
+
+struct AvxOps
+{
+	using Reg = __m256;
+	static constexpr int Width = 8;
+
+	static Reg load(const float * p) { return _mm256_loadu_ps(p); }
+	static void store(float * p, Reg a) { _mm256_storeu_ps(p, a); }
+	static Reg set1(float a) { return _mm256_set1_ps(a); }
+	static Reg setPair(float left, float right)
+	{
+		return _mm256_setr_ps(left, right, left, right, left, right, left, right);
+	}
+
+	static Reg combine(__m128 lo, __m128 hi)
+	{
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+	}
+
+	static Reg loadDup(const float * p)
+	{
+		const __m128 c = _mm_loadu_ps(p);
+		return combine(_mm_unpacklo_ps(c, c), _mm_unpackhi_ps(c, c));
+	}
+
+	static Reg loadJoined(const float * left, const float * right)
+	{
+		const __m128 l = _mm_loadu_ps(left);
+		const __m128 r = _mm_loadu_ps(right);
+		return combine(_mm_unpacklo_ps(l, r), _mm_unpackhi_ps(l, r));
+	}
+
+	static void storeSplit(float * left, float * right, Reg a)
+	{
+		const __m128 lo = _mm256_castps256_ps128(a);
+		const __m128 hi = _mm256_extractf128_ps(a, 1);
+		_mm_storeu_ps(left, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(right, _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+
+	static Reg add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+	static Reg sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+	static Reg mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+	static Reg swapPairs(Reg a) { return _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1)); }
+	static Reg max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+	static Reg min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+	static Reg sqrt(Reg a) { return _mm256_sqrt_ps(a); }
+
+	static Reg truncate(Reg a) { return _mm256_round_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+	static Reg round(Reg a)
+	{
+		// adding 0.5 before truncating would round 0.49999997 up
+		const Reg magnitude = abs(a);
+		const Reg t = truncate(magnitude);
+		const Reg up = _mm256_cmp_ps(_mm256_sub_ps(magnitude, t), _mm256_set1_ps(0.5f), _CMP_GE_OQ);
+		return flipSign(_mm256_add_ps(t, _mm256_and_ps(up, _mm256_set1_ps(1.0f))), a);
+	}
+	static Reg flipSign(Reg a, Reg sign) { return _mm256_xor_ps(a, _mm256_and_ps(sign, _mm256_set1_ps(-0.0f))); }
+	// gathering needs AVX2
+	static Reg gather(const float * table, Reg index)
+	{
+		alignas(32) int32_t i[Width];
+		_mm256_store_si256(reinterpret_cast<__m256i *>(i), _mm256_cvttps_epi32(index));
+		return _mm256_setr_ps(table[i[0]], table[i[1]], table[i[2]], table[i[3]],
+			table[i[4]], table[i[5]], table[i[6]], table[i[7]]);
+	}
+
+	static Reg clamp(Reg a, float lo, float hi)
+	{
+		return _mm256_max_ps(_mm256_min_ps(a, _mm256_set1_ps(hi)), _mm256_set1_ps(lo));
+	}
+
+	static Reg abs(Reg a) { return _mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))); }
+	static Reg finite(Reg a)
+	{
+		return _mm256_cmp_ps(abs(a), _mm256_set1_ps(__builtin_huge_valf()), _CMP_LT_OQ);
+	}
+
+	static Reg zeroUnlessFinite(Reg test, Reg a) { return _mm256_and_ps(finite(test), a); }
+	static bool hasNonFinite(Reg a) { return _mm256_movemask_ps(finite(a)) != 0xff; }
+	static bool hasAbove(Reg a, float threshold)
+	{
+		return _mm256_movemask_ps(_mm256_cmp_ps(abs(a), _mm256_set1_ps(threshold), _CMP_GE_OQ)) != 0;
+	}
+
+	static void storeS16(int_sample_t * p, Reg a, bool swapBytes)
+	{
+		// packing 256 bit integers needs AVX2
+		const __m256i i = _mm256_cvttps_epi32(a);
+		__m128i s = _mm_packs_epi32(_mm256_castsi256_si128(i), _mm256_extractf128_si256(i, 1));
+		if (swapBytes) { s = _mm_or_si128(_mm_slli_epi16(s, 8), _mm_srli_epi16(s, 8)); }
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(p), s);
+	}
+	static void storeS32(int32_t * p, Reg a)
+	{
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(p), _mm256_cvttps_epi32(a));
+	}
+} ;
+
+} // namespace
+
+const KernelTable * avxKernels()
+{
+	return MixKernels<AvxOps>::table();
+}
+
+} // namespace MixHelpers
+
+#else
+
+const MixHelpers::KernelTable * MixHelpers::avxKernels()
+{
+	return nullptr;
+}
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * MixKernelsAvx512.cpp - AVX-512 mix kernels
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "MixKernels.h"
+
+// built with -mavx512f where the compiler supports it
+#ifdef __AVX512F__
+#include <immintrin.h>
+
+namespace MixHelpers
+{
+
+namespace
+{
+
+struct Avx512Ops
+{
+	using Reg = __m512;
+	static constexpr int Width = 16;
+
+	static Reg load(const float * p) { return _mm512_loadu_ps(p); }
+	static void store(float * p, Reg a) { _mm512_storeu_ps(p, a); }
+	static Reg set1(float a) { return _mm512_set1_ps(a); }
+	static Reg setPair(float left, float right)
+	{
+		return _mm512_broadcast_f32x4(_mm_setr_ps(left, right, left, right));
+	}
+
+	static Reg loadDup(const float * p)
+	{
+		const __m512i index = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+		return _mm512_permutexvar_ps(index, _mm512_castps256_ps512(_mm256_loadu_ps(p)));
+	}
+
+	static Reg loadJoined(const float * left, const float * right)
+	{
+		const __m512i index = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+		return _mm512_permutex2var_ps(_mm512_castps256_ps512(_mm256_loadu_ps(left)), index,
+			_mm512_castps256_ps512(_mm256_loadu_ps(right)));
+	}
+
+	static void storeSplit(float * left, float * right, Reg a)
+	{
+		const __m512i index = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+		const __m512d split = _mm512_castps_pd(_mm512_permutexvar_ps(index, a));
+		// _mm512_extractf32x8_ps needs AVX512DQ
+		_mm256_storeu_ps(left, _mm256_castpd_ps(_mm512_castpd512_pd256(split)));
+		_mm256_storeu_ps(right, _mm256_castpd_ps(_mm512_extractf64x4_pd(split, 1)));
+	}
+
+	static Reg add(Reg a, Reg b) { return _mm512_add_ps(a, b); }
+	static Reg sub(Reg a, Reg b) { return _mm512_sub_ps(a, b); }
+	static Reg mul(Reg a, Reg b) { return _mm512_mul_ps(a, b); }
+	static Reg swapPairs(Reg a) { return _mm512_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1)); }
+	static Reg max(Reg a, Reg b) { return _mm512_max_ps(a, b); }
+	static Reg min(Reg a, Reg b) { return _mm512_min_ps(a, b); }
+	static Reg sqrt(Reg a) { return _mm512_sqrt_ps(a); }
+
+	static Reg truncate(Reg a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); }
+	static Reg round(Reg a)
+	{
+		// adding 0.5 before truncating would round 0.49999997 up
+		const Reg magnitude = abs(a);
+		const Reg t = truncate(magnitude);
+		const __mmask16 up = _mm512_cmp_ps_mask(_mm512_sub_ps(magnitude, t), _mm512_set1_ps(0.5f), _CMP_GE_OQ);
+		return flipSign(_mm512_mask_add_ps(t, up, t, _mm512_set1_ps(1.0f)), a);
+	}
+	static Reg flipSign(Reg a, Reg sign)
+	{
+		const __m512i signBits = _mm512_and_si512(_mm512_castps_si512(sign), _mm512_set1_epi32(static_cast<int>(0x80000000)));
+		return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), signBits));
+	}
+	static Reg gather(const float * table, Reg index)
+	{
+		return _mm512_i32gather_ps(_mm512_cvttps_epi32(index), table, sizeof(float));
+	}
+
+	static Reg clamp(Reg a, float lo, float hi)
+	{
+		return _mm512_max_ps(_mm512_min_ps(a, _mm512_set1_ps(hi)), _mm512_set1_ps(lo));
+	}
+
+	// _mm512_and_ps needs AVX512DQ
+	static Reg abs(Reg a)
+	{
+		return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a), _mm512_set1_epi32(0x7fffffff)));
+	}
+	static __mmask16 finite(Reg a)
+	{
+		return _mm512_cmp_ps_mask(abs(a), _mm512_set1_ps(__builtin_huge_valf()), _CMP_LT_OQ);
+	}
+
+	static Reg zeroUnlessFinite(Reg test, Reg a) { return _mm512_maskz_mov_ps(finite(test), a); }
+	static bool hasNonFinite(Reg a) { return finite(a) != 0xffff; }
+	static bool hasAbove(Reg a, float threshold)
+	{
+		return _mm512_cmp_ps_mask(abs(a), _mm512_set1_ps(threshold), _CMP_GE_OQ) != 0;
+	}
+
+	static void storeS16(int_sample_t * p, Reg a, bool swapBytes)
+	{
+		// -mavx512f implies AVX2 for the swapping
+		__m256i s = _mm512_cvtsepi32_epi16(_mm512_cvttps_epi32(a));
+		if (swapBytes) { s = _mm256_or_si256(_mm256_slli_epi16(s, 8), _mm256_srli_epi16(s, 8)); }
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(p), s);
+	}
+	static void storeS32(int32_t * p, Reg a)
+	{
+		_mm512_storeu_si512(p, _mm512_cvttps_epi32(a));
+	}
+} ;
+
+} // namespace
+
+const KernelTable * avx512Kernels()
+{
+	return MixKernels<Avx512Ops>::table();
+}
+
+} // namespace MixHelpers
+
+#else
+
+const MixHelpers::KernelTable * MixHelpers::avx512Kernels()
+{
+	return nullptr;
+}
+
+#endif
@@ -0,0 +1,140 @@
+/*
+ * MixKernelsNeon.cpp - NEON mix kernels
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "MixKernels.h"
+
+// 32 bit ARM NEON flushes denormals and is not IEEE compliant, so only
+// AArch64 gets these
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+
+namespace MixHelpers
+{
+
+namespace
+{
+
+struct NeonOps
+{
+	using Reg = float32x4_t;
+	static constexpr int Width = 4;
+
+	static Reg load(const float * p) { return vld1q_f32(p); }
+	static void store(float * p, Reg a) { vst1q_f32(p, a); }
+	static Reg set1(float a) { return vdupq_n_f32(a); }
+	static Reg setPair(float left, float right)
+	{
+		const float32x2_t pair = vset_lane_f32(right, vdup_n_f32(left), 1);
+		return vcombine_f32(pair, pair);
+	}
+
+	static Reg loadDup(const float * p)
+	{
+		const float32x2_t c = vld1_f32(p);
+		return vcombine_f32(vdup_lane_f32(c, 0), vdup_lane_f32(c, 1));
+	}
+
+	static Reg loadJoined(const float * left, const float * right)
+	{
+		const float32x2x2_t zipped = vzip_f32(vld1_f32(left), vld1_f32(right));
+		return vcombine_f32(zipped.val[0], zipped.val[1]);
+	}
+
+	static void storeSplit(float * left, float * right, Reg a)
+	{
+		const float32x2x2_t split = vuzp_f32(vget_low_f32(a), vget_high_f32(a));
+		vst1_f32(left, split.val[0]);
+		vst1_f32(right, split.val[1]);
+	}
+
+	static Reg add(Reg a, Reg b) { return vaddq_f32(a, b); }
+	static Reg sub(Reg a, Reg b) { return vsubq_f32(a, b); }
+	static Reg mul(Reg a, Reg b) { return vmulq_f32(a, b); }
+	static Reg swapPairs(Reg a) { return vrev64q_f32(a); }
+	static Reg abs(Reg a) { return vabsq_f32(a); }
+	// vmaxq_f32() and vminq_f32() would return NaNs
+	static Reg max(Reg a, Reg b) { return vbslq_f32(vcgtq_f32(a, b), a, b); }
+	static Reg min(Reg a, Reg b) { return vbslq_f32(vcltq_f32(a, b), a, b); }
+	static Reg sqrt(Reg a) { return vsqrtq_f32(a); }
+
+	static Reg truncate(Reg a) { return vrndq_f32(a); }
+	static Reg round(Reg a) { return vrndaq_f32(a); }
+	static Reg flipSign(Reg a, Reg sign)
+	{
+		const uint32x4_t signBits = vandq_u32(vreinterpretq_u32_f32(sign), vdupq_n_u32(0x80000000));
+		return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), signBits));
+	}
+	static Reg gather(const float * table, Reg index)
+	{
+		int32_t i[Width];
+		vst1q_s32(i, vcvtq_s32_f32(index));
+		const float values[Width] = { table[i[0]], table[i[1]], table[i[2]], table[i[3]] };
+		return vld1q_f32(values);
+	}
+
+	// only used on finite values, where vminq/vmaxq match qBound
+	static Reg clamp(Reg a, float lo, float hi)
+	{
+		return vmaxq_f32(vminq_f32(a, vdupq_n_f32(hi)), vdupq_n_f32(lo));
+	}
+
+	static uint32x4_t finite(Reg a) { return vcltq_f32(abs(a), vdupq_n_f32(__builtin_huge_valf())); }
+
+	static Reg zeroUnlessFinite(Reg test, Reg a)
+	{
+		return vreinterpretq_f32_u32(vandq_u32(finite(test), vreinterpretq_u32_f32(a)));
+	}
+	static bool hasNonFinite(Reg a) { return vminvq_u32(finite(a)) == 0; }
+	static bool hasAbove(Reg a, float threshold)
+	{
+		return vmaxvq_u32(vcgeq_f32(abs(a), vdupq_n_f32(threshold))) != 0;
+	}
+
+	static void storeS16(int_sample_t * p, Reg a, bool swapBytes)
+	{
+		int16x4_t s = vqmovn_s32(vcvtq_s32_f32(a));
+		if (swapBytes) { s = vreinterpret_s16_u8(vrev16_u8(vreinterpret_u8_s16(s))); }
+		vst1_s16(p, s);
+	}
+	static void storeS32(int32_t * p, Reg a) { vst1q_s32(p, vcvtq_s32_f32(a)); }
+} ;
+
+} // namespace
+
+const KernelTable * neonKernels()
+{
+	return MixKernels<NeonOps>::table();
+}
+
+} // namespace MixHelpers
+
+#else
+
+const MixHelpers::KernelTable * MixHelpers::neonKernels()
+{
+	return nullptr;
+}
+
+#endif
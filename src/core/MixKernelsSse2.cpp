@@ -0,0 +1,139 @@
+/*
+ * MixKernelsSse2.cpp - SSE2 mix kernels
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "MixKernels.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+namespace MixHelpers
+{
+
+namespace
+{
+
+struct Sse2Ops
+{
+	using Reg = __m128;
+	static constexpr int Width = 4;
+
+	static Reg load(const float * p) { return _mm_loadu_ps(p); }
+	static void store(float * p, Reg a) { _mm_storeu_ps(p, a); }
+	static Reg set1(float a) { return _mm_set1_ps(a); }
+	static Reg setPair(float left, float right) { return _mm_setr_ps(left, right, left, right); }
+
+	static Reg loadDup(const float * p)
+	{
+		const Reg c = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(p));
+		return _mm_unpacklo_ps(c, c);
+	}
+
+	static Reg loadJoined(const float * left, const float * right)
+	{
+		return _mm_unpacklo_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(left)),
+			_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(right)));
+	}
+
+	static void storeSplit(float * left, float * right, Reg a)
+	{
+		_mm_storel_pi(reinterpret_cast<__m64 *>(left), _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storel_pi(reinterpret_cast<__m64 *>(right), _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+
+	static Reg add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+	static Reg sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+	static Reg mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+	static Reg swapPairs(Reg a) { return _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)); }
+	static Reg max(Reg a, Reg b) { return _mm_max_ps(a, b); }
+	static Reg min(Reg a, Reg b) { return _mm_min_ps(a, b); }
+	static Reg sqrt(Reg a) { return _mm_sqrt_ps(a); }
+
+	static Reg truncate(Reg a) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a)); }
+	static Reg round(Reg a)
+	{
+		// adding 0.5 before truncating would round 0.49999997 up
+		const Reg magnitude = abs(a);
+		const Reg t = truncate(magnitude);
+		Reg r = _mm_add_ps(t, _mm_and_ps(_mm_cmpge_ps(_mm_sub_ps(magnitude, t), _mm_set1_ps(0.5f)),
+			_mm_set1_ps(1.0f)));
+		// from 2^23 on all values are integers, too large ones and NaNs
+		// don't survive the conversion
+		const Reg integral = _mm_cmpnlt_ps(magnitude, _mm_set1_ps(8388608.0f));
+		r = _mm_or_ps(_mm_and_ps(integral, magnitude), _mm_andnot_ps(integral, r));
+		return flipSign(r, a);
+	}
+	static Reg flipSign(Reg a, Reg sign) { return _mm_xor_ps(a, _mm_and_ps(sign, _mm_set1_ps(-0.0f))); }
+	static Reg gather(const float * table, Reg index)
+	{
+		alignas(16) int32_t i[Width];
+		_mm_store_si128(reinterpret_cast<__m128i *>(i), _mm_cvttps_epi32(index));
+		return _mm_setr_ps(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+	}
+
+	static Reg clamp(Reg a, float lo, float hi)
+	{
+		return _mm_max_ps(_mm_min_ps(a, _mm_set1_ps(hi)), _mm_set1_ps(lo));
+	}
+
+	static Reg abs(Reg a) { return _mm_and_ps(a, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))); }
+	static Reg finite(Reg a) { return _mm_cmplt_ps(abs(a), _mm_set1_ps(__builtin_huge_valf())); }
+
+	static Reg zeroUnlessFinite(Reg test, Reg a) { return _mm_and_ps(finite(test), a); }
+	static bool hasNonFinite(Reg a) { return _mm_movemask_ps(finite(a)) != 0xf; }
+	static bool hasAbove(Reg a, float threshold)
+	{
+		return _mm_movemask_ps(_mm_cmpge_ps(abs(a), _mm_set1_ps(threshold))) != 0;
+	}
+
+	static void storeS16(int_sample_t * p, Reg a, bool swapBytes)
+	{
+		const __m128i i = _mm_cvttps_epi32(a);
+		__m128i s = _mm_packs_epi32(i, i);
+		if (swapBytes) { s = _mm_or_si128(_mm_slli_epi16(s, 8), _mm_srli_epi16(s, 8)); }
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(p), s);
+	}
+	static void storeS32(int32_t * p, Reg a)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_cvttps_epi32(a));
+	}
+} ;
+
+} // namespace
+
+const KernelTable * sse2Kernels()
+{
+	return MixKernels<Sse2Ops>::table();
+}
+
+} // namespace MixHelpers
+
+#else
+
+const MixHelpers::KernelTable * MixHelpers::sse2Kernels()
+{
+	return nullptr;
+}
+
+#endif
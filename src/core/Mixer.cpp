@@ -22,9 +22,12 @@
  *
  */
 
+#include <algorithm>
+
 #include <QDomElement>
 
 #include "AudioEngine.h"
+#include "AudioDevice.h"
 #include "AudioEngineWorkerThread.h"
 #include "BufferManager.h"
 #include "Mixer.h"
@@ -36,6 +39,20 @@
 #include "BBTrackContainer.h"
 #include "TrackContainer.h" // For TrackContainer::TrackList typedef
 
+
+namespace
+{
+
+// whether a send or fader lets the signal through as it is for the whole
+// period
+bool isUnity( FloatModel * model )
+{
+	return model->valueBuffer() == nullptr && model->value() == 1.0f;
+}
+
+}
+
+
 MixerRoute::MixerRoute( MixerChannel * from, MixerChannel * to, float amount ) :
 	m_from( from ),
 	m_to( to ),
@@ -66,6 +83,7 @@ MixerChannel::MixerChannel( int idx, Model * _parent ) :
 	m_peakLeft( 0.0f ),
 	m_peakRight( 0.0f ),
 	m_buffer( new sampleFrame[Engine::audioEngine()->framesPerPeriod()] ),
+	m_bufferSilent( true ),
 	m_muteModel( false, _parent ),
 	m_soloModel( false, _parent ),
 	m_volumeModel( 1.0, 0.0, 2.0, 0.001, _parent ),
@@ -73,7 +91,10 @@ MixerChannel::MixerChannel( int idx, Model * _parent ) :
 	m_lock(),
 	m_channelIndex( idx ),
 	m_queued( false ),
+	m_muted( false ),
+	m_extOutputEnabled( false ),
 	m_hasColor( false ),
+	m_numInputs( 0 ),
 	m_dependenciesMet(0)
 {
 	BufferManager::clear( m_buffer, Engine::audioEngine()->framesPerPeriod() );
@@ -102,13 +123,23 @@ inline void MixerChannel::processed()
 void MixerChannel::incrementDeps()
 {
 	int i = m_dependenciesMet++ + 1;
-	if( i >= m_receives.size() && ! m_queued )
+	if( i >= m_numInputs && ! m_queued )
 	{
 		m_queued = true;
 		AudioEngineWorkerThread::addJob( this );
 	}
 }
 
+float MixerChannel::outputPeak() const
+{
+	if( m_muted || m_bufferSilent )
+	{
+		return 0.0f;
+	}
+	const sampleFrame peak = MixHelpers::peak( m_buffer, Engine::audioEngine()->framesPerPeriod() );
+	return qMax( peak[0], peak[1] );
+}
+
 void MixerChannel::unmuteForSolo()
 {
 	//TODO: Recursively activate every channel, this channel sends to
@@ -120,44 +151,63 @@ void MixerChannel::unmuteForSolo()
 void MixerChannel::doProcessing()
 {
 	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
+	const fpp_t interval = Engine::audioEngine()->automationControlInterval();
 
 	if( m_muted == false )
 	{
+		// each mix returns the peak values of m_buffer, so unless an effect
+		// changes the buffer afterwards, it doesn't have to be scanned again
+		sampleFrame peak = { 0.0f, 0.0f };
+		bool peakKnown = false;
+		// nothing was mixed into m_buffer yet, it only holds zeros
+		bool empty = m_bufferSilent;
+
 		for( MixerRoute * senderRoute : m_receives )
 		{
 			MixerChannel * sender = senderRoute->sender();
 			FloatModel * sendModel = senderRoute->amount();
 			if( ! sendModel ) qFatal( "Error: no send model found from %d to %d", senderRoute->senderIndex(), m_channelIndex );
 
-			if( sender->m_hasInput || sender->m_stillRunning )
+			if( sender->m_bufferSilent )
 			{
-				// figure out if we're getting sample-exact input
-				ValueBuffer * sendBuf = sendModel->valueBuffer();
-				ValueBuffer * volBuf = sender->m_volumeModel.valueBuffer();
-
-				// mix it's output with this one's output
-				sampleFrame * ch_buf = sender->m_buffer;
-
-				// use sample-exact mixing if sample-exact values are available
-				if( ! volBuf && ! sendBuf ) // neither volume nor send has sample-exact data...
-				{
-					const float v = sender->m_volumeModel.value() * sendModel->value();
-					MixHelpers::addSanitizedMultiplied( m_buffer, ch_buf, v, fpp );
-				}
-				else if( volBuf && sendBuf ) // both volume and send have sample-exact data
-				{
-					MixHelpers::addSanitizedMultipliedByBuffers( m_buffer, ch_buf, volBuf, sendBuf, fpp );
-				}
-				else if( volBuf ) // volume has sample-exact data but send does not
+				Engine::audioEngine()->profiler().countSkipped( AudioEngineProfiler::SkippedWork::Mix );
+			}
+			else if( ( sender->m_hasInput || sender->m_stillRunning ) && empty &&
+					sender->m_sends.size() == 1 && !sender->m_extOutputEnabled &&
+					isUnity( sendModel ) && isUnity( &sender->m_volumeModel ) )
+			{
+				// the only receiver of the sender at unity gain takes its
+				// buffer instead of adding it to zeros. Nothing reads the
+				// sender's buffer anymore this period, it gets the zeros.
+				std::swap( m_buffer, sender->m_buffer );
+				sender->m_bufferSilent = true;
+				Engine::audioEngine()->profiler().countSkipped( AudioEngineProfiler::SkippedWork::Mix );
+				empty = false;
+				m_hasInput = true;
+			}
+			else if( sender->m_hasInput || sender->m_stillRunning )
+			{
+				ValueRamp send;
+				ValueRamp volume;
+				if( interval > 1 && sendModel->valueRamp( send ) && sender->m_volumeModel.valueRamp( volume ) )
 				{
-					const float v = sendModel->value();
-					MixHelpers::addSanitizedMultipliedByBuffer( m_buffer, ch_buf, v, volBuf, fpp );
+					peak = MixHelpers::addMultipliedWithPeak( m_buffer, sender->m_buffer,
+											volume, send, interval, fpp );
 				}
-				else // vice versa
+				else
 				{
-					const float v = sender->m_volumeModel.value();
-					MixHelpers::addSanitizedMultipliedByBuffer( m_buffer, ch_buf, v, sendBuf, fpp );
+					// use sample-exact mixing if sample-exact values are available
+					ValueBuffer * sendBuf = sendModel->valueBuffer();
+					ValueBuffer * volBuf = sender->m_volumeModel.valueBuffer();
+					const float v = ( volBuf ? 1.0f : sender->m_volumeModel.value() )
+							* ( sendBuf ? 1.0f : sendModel->value() );
+
+					// mix it's output with this one's output
+					peak = MixHelpers::addMultipliedWithPeak( m_buffer, sender->m_buffer, v,
+											volBuf, sendBuf, fpp );
 				}
+				peakKnown = true;
+				empty = false;
 				m_hasInput = true;
 			}
 		}
@@ -171,11 +221,45 @@ void MixerChannel::doProcessing()
 			m_fxChain.startRunning();
 		}
 
+		if( m_hasInput || m_fxChain.hasRunningEffects() )
+		{
+			m_bufferSilent = false;
+		}
+
+		// asking before and after processing also catches the chain getting
+		// enabled or disabled meanwhile
+		const bool fxEnabled = m_fxChain.isEnabled();
 		m_stillRunning = m_fxChain.processAudioBuffer( m_buffer, fpp, m_hasInput );
+		if( fxEnabled || m_fxChain.isEnabled() )
+		{
+			peakKnown = false;
+		}
+
+		if( m_bufferSilent )
+		{
+			Engine::audioEngine()->profiler().countSkipped( AudioEngineProfiler::SkippedWork::PeakScan );
+		}
+		else
+		{
+			if( peakKnown )
+			{
+				Engine::audioEngine()->profiler().countSkipped( AudioEngineProfiler::SkippedWork::FusedPeakScan );
+			}
+			else
+			{
+				peak = MixHelpers::peak( m_buffer, fpp );
+			}
+			m_peakLeft = qMax( m_peakLeft.load(), peak[0] * v );
+			m_peakRight = qMax( m_peakRight.load(), peak[1] * v );
 
-		AudioEngine::StereoSample peakSamples = Engine::audioEngine()->getPeakValues(m_buffer, fpp);
-		m_peakLeft = qMax( m_peakLeft, peakSamples.left * v );
-		m_peakRight = qMax( m_peakRight, peakSamples.right * v );
+			if( peak[0] == 0.0f && peak[1] == 0.0f )
+			{
+				// written, but still silent - make sure there are only
+				// zeros (and no NaNs) left, so receivers can skip us
+				BufferManager::clear( m_buffer, fpp );
+				m_bufferSilent = true;
+			}
+		}
 	}
 	else
 	{
@@ -327,6 +411,7 @@ void Mixer::deleteChannel( int index )
 	}
 
 	MixerChannel * ch = m_mixerChannels[index];
+	setExtOutputEnabled( index, false );
 
 	// delete all of this channel's sends and receives
 	while( ! ch->m_sends.isEmpty() )
@@ -350,6 +435,10 @@ void Mixer::deleteChannel( int index )
 	for( int i = index; i < m_mixerChannels.size(); ++i )
 	{
 		validateChannelName( i, i + 1 );
+		if( m_mixerChannels[i]->m_extOutputEnabled )
+		{
+			Engine::audioEngine()->audioDev()->renameChannel( m_mixerChannels[i] );
+		}
 
 		// set correct channel index
 		m_mixerChannels[i]->m_channelIndex = i;
@@ -582,11 +671,20 @@ FloatModel * Mixer::channelSendModel( mix_ch_t fromChannel, mix_ch_t toChannel )
 
 void Mixer::mixToChannel( const sampleFrame * _buf, mix_ch_t _ch )
 {
-	if( m_mixerChannels[_ch]->m_muteModel.value() == false )
+	if( m_mixerChannels[_ch]->m_muted == false )
 	{
 		m_mixerChannels[_ch]->m_lock.lock();
-		MixHelpers::add( m_mixerChannels[_ch]->m_buffer, _buf, Engine::audioEngine()->framesPerPeriod() );
+		// the first port writing to the channel needn't add to zeros
+		if( m_mixerChannels[_ch]->m_bufferSilent )
+		{
+			std::copy( _buf, _buf + Engine::audioEngine()->framesPerPeriod(), m_mixerChannels[_ch]->m_buffer );
+		}
+		else
+		{
+			MixHelpers::add( m_mixerChannels[_ch]->m_buffer, _buf, Engine::audioEngine()->framesPerPeriod() );
+		}
 		m_mixerChannels[_ch]->m_hasInput = true;
+		m_mixerChannels[_ch]->m_bufferSilent = false;
 		m_mixerChannels[_ch]->m_lock.unlock();
 	}
 }
@@ -596,92 +694,155 @@ void Mixer::mixToChannel( const sampleFrame * _buf, mix_ch_t _ch )
 
 void Mixer::prepareMasterMix()
 {
-	BufferManager::clear( m_mixerChannels[0]->m_buffer,
-					Engine::audioEngine()->framesPerPeriod() );
+	clearChannelBuffer( m_mixerChannels[0] );
 }
 
 
 
-void Mixer::masterMix( sampleFrame * _buf )
+void Mixer::prepareChannelDependencies()
 {
-	const int fpp = Engine::audioEngine()->framesPerPeriod();
+	for( MixerChannel * ch : m_mixerChannels )
+	{
+		ch->m_muted = ch->m_muteModel.value();
+		ch->m_numInputs = ch->m_receives.size();
+		ch->m_dependenciesMet = 0;
+		ch->m_queued = false;
+	}
+}
+
+
 
-	// add the channels that have no dependencies (no incoming senders, ie.
-	// no receives) to the jobqueue. The channels that have receives get
-	// added when their senders get processed, which is detected by
+
+void Mixer::addAudioPortInput( mix_ch_t _ch )
+{
+	if( _ch >= 0 && _ch < m_mixerChannels.size() )
+	{
+		++m_mixerChannels[_ch]->m_numInputs;
+	}
+}
+
+
+
+
+void Mixer::queueIndependentChannels()
+{
+	// add the channels that have no dependencies (neither receives nor
+	// audio ports sending to them) to the job queue. The other channels get
+	// added when their last input gets processed, which is detected by
 	// dependency counting.
 	// also instantly add all muted channels as they don't need to care
-	// about their senders, and can just increment the deps of their
+	// about their inputs, and can just increment the deps of their
 	// recipients right away.
-	AudioEngineWorkerThread::resetJobQueue( AudioEngineWorkerThread::JobQueue::Dynamic );
 	for( MixerChannel * ch : m_mixerChannels )
 	{
-		ch->m_muted = ch->m_muteModel.value();
 		if( ch->m_muted ) // instantly "process" muted channels
 		{
 			ch->processed();
 			ch->done();
 		}
-		else if( ch->m_receives.size() == 0 )
+		else if( ch->m_numInputs == 0 )
 		{
 			ch->m_queued = true;
 			AudioEngineWorkerThread::addJob( ch );
 		}
 	}
-	while (m_mixerChannels[0]->state() != ThreadableJob::ProcessingState::Done)
+}
+
+
+
+
+void Mixer::audioPortProcessed( mix_ch_t _ch )
+{
+	if( _ch >= 0 && _ch < m_mixerChannels.size()
+		&& m_mixerChannels[_ch]->m_muted == false )
 	{
-		bool found = false;
-		for( MixerChannel * ch : m_mixerChannels )
-		{
-			const auto s = ch->state();
-			if (s == ThreadableJob::ProcessingState::Queued
-				|| s == ThreadableJob::ProcessingState::InProgress)
-			{
-				found = true;
-				break;
-			}
-		}
-		if( !found )
-		{
-			break;
-		}
-		AudioEngineWorkerThread::startAndWaitForJobs();
+		m_mixerChannels[_ch]->incrementDeps();
 	}
+}
+
 
-	// handle sample-exact data in master volume fader
-	ValueBuffer * volBuf = m_mixerChannels[0]->m_volumeModel.valueBuffer();
 
-	if( volBuf )
+
+void Mixer::masterMix( sampleFrame * _buf )
+{
+	const int fpp = Engine::audioEngine()->framesPerPeriod();
+
+	// handle sample-exact data in master volume fader, in sub-blocks if
+	// the engine applies automation that way
+	const fpp_t interval = Engine::audioEngine()->automationControlInterval();
+	ValueRamp volume;
+	const bool ramp = interval > 1 && m_mixerChannels[0]->m_volumeModel.valueRamp( volume );
+	ValueBuffer * volBuf = ramp ? nullptr : m_mixerChannels[0]->m_volumeModel.valueBuffer();
+
+	if( m_mixerChannels[0]->m_bufferSilent )
 	{
-		for( int f = 0; f < fpp; f++ )
-		{
-			m_mixerChannels[0]->m_buffer[f][0] *= volBuf->values()[f];
-			m_mixerChannels[0]->m_buffer[f][1] *= volBuf->values()[f];
-		}
+		Engine::audioEngine()->profiler().countSkipped( AudioEngineProfiler::SkippedWork::Mix );
+	}
+	else if( ramp )
+	{
+		MixHelpers::addMultiplied( _buf, m_mixerChannels[0]->m_buffer, volume, interval, fpp );
+	}
+	else if( volBuf )
+	{
+		// apply the volume while mixing instead of in an extra pass
+		MixHelpers::addMultipliedByBuffer( _buf, m_mixerChannels[0]->m_buffer, 1.0f, volBuf, fpp );
+	}
+	else
+	{
+		MixHelpers::addMultiplied( _buf, m_mixerChannels[0]->m_buffer,
+						m_mixerChannels[0]->m_volumeModel.value(), fpp );
 	}
-
-	const float v = volBuf
-		? 1.0f
-		: m_mixerChannels[0]->m_volumeModel.value();
-	MixHelpers::addSanitizedMultiplied( _buf, m_mixerChannels[0]->m_buffer, v, fpp );
 
 	// clear all channel buffers and
 	// reset channel process state
+	AudioDevice * audioDev = Engine::audioEngine()->audioDev();
 	for( int i = 0; i < numChannels(); ++i)
 	{
-		BufferManager::clear( m_mixerChannels[i]->m_buffer,
-				Engine::audioEngine()->framesPerPeriod() );
+		MixerChannel * ch = m_mixerChannels[i];
+		if( ch->m_extOutputEnabled )
+		{
+			// silent buffers are all zeros, so they can be written as well
+			audioDev->writeChannel( ch, ch->m_buffer, ch->m_volumeModel.value(), fpp );
+		}
+		clearChannelBuffer( m_mixerChannels[i] );
 		m_mixerChannels[i]->reset();
-		m_mixerChannels[i]->m_queued = false;
 		// also reset hasInput
 		m_mixerChannels[i]->m_hasInput = false;
-		m_mixerChannels[i]->m_dependenciesMet = 0;
 	}
 }
 
 
 
 
+bool Mixer::hasRunningEffects() const
+{
+	for( const MixerChannel * ch : m_mixerChannels )
+	{
+		if( ch->m_stillRunning || ch->m_fxChain.hasRunningEffects() )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
+void Mixer::clearChannelBuffer( MixerChannel * ch )
+{
+	if( ch->m_bufferSilent )
+	{
+		Engine::audioEngine()->profiler().countSkipped( AudioEngineProfiler::SkippedWork::BufferClear );
+		return;
+	}
+	BufferManager::clear( ch->m_buffer, Engine::audioEngine()->framesPerPeriod() );
+	ch->m_bufferSilent = true;
+}
+
+
+
+
 void Mixer::clear()
 {
 	while( m_mixerChannels.size() > 1 )
@@ -690,6 +851,28 @@ void Mixer::clear()
 	}
 
 	clearChannel(0);
+	setExtOutputEnabled( 0, false );
+}
+
+
+
+
+void Mixer::setExtOutputEnabled( mix_ch_t index, bool enabled )
+{
+	MixerChannel * ch = m_mixerChannels[index];
+	if( enabled == ch->m_extOutputEnabled )
+	{
+		return;
+	}
+	ch->m_extOutputEnabled = enabled;
+	if( enabled )
+	{
+		Engine::audioEngine()->audioDev()->registerChannel( ch );
+	}
+	else
+	{
+		Engine::audioEngine()->audioDev()->unregisterChannel( ch );
+	}
 }
 
 
@@ -743,6 +926,7 @@ void Mixer::saveSettings( QDomDocument & _doc, QDomElement & _this )
 		mixch.setAttribute( "num", i );
 		mixch.setAttribute( "name", ch->m_name );
 		if( ch->m_hasColor ) mixch.setAttribute( "color", ch->m_color.name() );
+		if( ch->m_extOutputEnabled ) mixch.setAttribute( "extoutput", 1 );
 
 		// add the channel sends
 		for( int si = 0; si < ch->m_sends.size(); ++si )
@@ -793,6 +977,7 @@ void Mixer::loadSettings( const QDomElement & _this )
 			m_mixerChannels[num]->m_hasColor = true;
 			m_mixerChannels[num]->m_color.setNamedColor( mixch.attribute( "color" ) );
 		}
+		setExtOutputEnabled( num, mixch.attribute( "extoutput" ).toInt() );
 
 		m_mixerChannels[num]->m_fxChain.restoreState( mixch.firstChildElement(
 			m_mixerChannels[num]->m_fxChain.nodeName() ) );
@@ -26,6 +26,7 @@
 #include "NotePlayHandle.h"
 
 #include "lmms_constants.h"
+#include "lmms_math.h"
 #include "AudioEngine.h"
 #include "BasicFilters.h"
 #include "DetuningHelper.h"
@@ -33,6 +34,24 @@
 #include "InstrumentTrack.h"
 #include "Instrument.h"
 #include "Song.h"
+#include "TrackContainer.h"
+
+#include <QMutex>
+#include <QThread>
+
+
+namespace
+{
+
+// stolen notes fade out within 5 ms, long enough not to click and short
+// enough to free the voice soon
+f_cnt_t stealFadeFrames()
+{
+	return Engine::audioEngine()->processingSampleRate() / 200;
+}
+
+}
+
 
 NotePlayHandle::BaseDetuning::BaseDetuning( DetuningHelper *detuning ) :
 	m_value( detuning ? detuning->automationClip()->valueAt( 0 ) : 0 )
@@ -54,42 +73,58 @@ NotePlayHandle::NotePlayHandle( InstrumentTrack* instrumentTrack,
 	PlayHandle( TypeNotePlayHandle, _offset ),
 	Note( n.length(), n.pos(), n.key(), n.getVolume(), n.getPanning(), n.detuning() ),
 	m_pluginData( nullptr ),
+	m_filter( nullptr ),
 	m_instrumentTrack( instrumentTrack ),
 	m_frames( 0 ),
 	m_totalFramesPlayed( 0 ),
 	m_framesBeforeRelease( 0 ),
 	m_releaseFramesToDo( 0 ),
 	m_releaseFramesDone( 0 ),
-	m_subNotes(),
+	m_framesThisPeriod( 0 ),
+	m_stealFramesLeft( 0 ),
+	m_frequency( 0 ),
+	m_unpitchedFrequency( 0 ),
+	m_tempoEpoch( Engine::getSong()->tempoEpoch() ),
 	m_released( false ),
 	m_releaseStarted( false ),
-	m_hasMidiNote( false ),
-	m_hasParent( parent != nullptr  ),
-	m_parent( parent ),
-	m_hadChildren( false ),
 	m_muted( false ),
+	m_playing( false ),
+	m_stolen( false ),
+	m_frequencyNeedsUpdate( false ),
+	m_firstSubNote( nullptr ),
+	m_prevSubNote( nullptr ),
+	m_nextSubNote( nullptr ),
+	m_parent( parent ),
 	m_bbTrack( nullptr ),
-	m_origTempo( Engine::getSong()->getTempo() ),
-	m_origBaseNote( instrumentTrack->baseNote() ),
-	m_frequency( 0 ),
-	m_unpitchedFrequency( 0 ),
 	m_baseDetuning( nullptr ),
 	m_songGlobalParentOffset( 0 ),
+	m_origTempo( Engine::getSong()->getTempo() ),
+	m_origBaseNote( instrumentTrack->baseNote() ),
 	m_midiChannel( midiEventChannel >= 0 ? midiEventChannel : instrumentTrack->midiPort()->realOutputChannel() ),
+	m_activeNoteIndex( -1 ),
 	m_origin( origin ),
-	m_frequencyNeedsUpdate( false )
+	m_hasMidiNote( false ),
+	m_hasParent( parent != nullptr  ),
+	m_hadChildren( false )
 {
 	lock();
 	if( hasParent() == false )
 	{
 		m_baseDetuning = new BaseDetuning( detuning() );
 		m_instrumentTrack->m_processHandles.push_back( this );
+		addToActiveNotes();
 	}
 	else
 	{
 		m_baseDetuning = parent->m_baseDetuning;
 
-		parent->m_subNotes.push_back( this );
+		// sub-notes link into their parent, so adding them never allocates
+		m_nextSubNote = parent->m_firstSubNote;
+		if( m_nextSubNote )
+		{
+			m_nextSubNote->m_prevSubNote = this;
+		}
+		parent->m_firstSubNote = this;
 		parent->m_hadChildren = true;
 
 		m_bbTrack = parent->m_bbTrack;
@@ -128,9 +163,20 @@ NotePlayHandle::~NotePlayHandle()
 		delete m_baseDetuning;
 		m_instrumentTrack->m_processHandles.removeAll( this );
 	}
-	else
+	else if( m_parent )
 	{
-		m_parent->m_subNotes.removeOne( this );
+		if( m_prevSubNote )
+		{
+			m_prevSubNote->m_nextSubNote = m_nextSubNote;
+		}
+		else
+		{
+			m_parent->m_firstSubNote = m_nextSubNote;
+		}
+		if( m_nextSubNote )
+		{
+			m_nextSubNote->m_prevSubNote = m_prevSubNote;
+		}
 	}
 
 	if( m_pluginData != nullptr )
@@ -142,8 +188,21 @@ NotePlayHandle::~NotePlayHandle()
 	{
 		m_instrumentTrack->m_notes[key()] = nullptr;
 	}
+	// other notes are kept alive by the sustain pedal as long as it is held
+	if( m_stolen )
+	{
+		m_instrumentTrack->m_sustainedNotes.removeAll( this );
+	}
 
-	m_subNotes.clear();
+	// sub-notes outliving us mustn't unlink from us anymore
+	for( NotePlayHandle * n = m_firstSubNote; n; )
+	{
+		NotePlayHandle * next = n->m_nextSubNote;
+		n->m_parent = nullptr;
+		n->m_prevSubNote = n->m_nextSubNote = nullptr;
+		n = next;
+	}
+	m_firstSubNote = nullptr;
 
 	if( buffer() ) releaseBuffer();
 
@@ -182,21 +241,45 @@ int NotePlayHandle::midiKey() const
 
 
 void NotePlayHandle::play( sampleFrame * _working_buffer )
+{
+	if( startPlaying() )
+	{
+		// play note!
+		m_instrumentTrack->playNote( this, _working_buffer );
+	}
+	finishPlaying();
+}
+
+
+
+
+bool NotePlayHandle::startPlaying()
 {
 	if (m_muted)
 	{
-		return;
+		return false;
 	}
 
 	// if the note offset falls over to next period, then don't start playback yet
 	if( offset() >= Engine::audioEngine()->framesPerPeriod() )
 	{
 		setOffset( offset() - Engine::audioEngine()->framesPerPeriod() );
-		return;
+		return false;
 	}
 
 	lock();
 
+	// catch up with the tempo changes since the last period
+	const int tempoEpoch = Engine::getSong()->tempoEpoch();
+	if( m_tempoEpoch != tempoEpoch )
+	{
+		m_tempoEpoch = tempoEpoch;
+		if( !isReleased() )
+		{
+			resize( Engine::getSong()->getTempo() );
+		}
+	}
+
 	// Don't play the note if it falls outside of the user defined key range
 	// TODO: handle the range check by Microtuner, and if the key becomes "not mapped", save the current frequency
 	// so that the note release can finish playing using a valid frequency instead of a 1 Hz placeholder
@@ -209,7 +292,7 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 		if (m_totalFramesPlayed == 0)
 		{
 			unlock();
-			return;
+			return false;
 		}
 	}
 
@@ -238,9 +321,11 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 	}
 
 	// number of frames that can be played this period
-	f_cnt_t framesThisPeriod = m_totalFramesPlayed == 0
+	const f_cnt_t framesThisPeriod = m_totalFramesPlayed == 0
 		? Engine::audioEngine()->framesPerPeriod() - offset()
 		: Engine::audioEngine()->framesPerPeriod();
+	m_framesThisPeriod = framesThisPeriod;
+	m_playing = true;
 
 	// check if we start release during this period
 	if( m_released == false &&
@@ -255,10 +340,24 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 	// under some circumstances we're called even if there's nothing to play
 	// therefore do an additional check which fixes crash e.g. when
 	// decreasing release of an instrument-track while the note is active
-	if( framesLeft() > 0 )
+	return framesLeft() > 0;
+}
+
+
+
+
+void NotePlayHandle::finishPlaying()
+{
+	if( !m_playing )
 	{
-		// play note!
-		m_instrumentTrack->playNote( this, _working_buffer );
+		return;
+	}
+	m_playing = false;
+	const f_cnt_t framesThisPeriod = m_framesThisPeriod;
+
+	if( m_stolen )
+	{
+		fadeOutStolen();
 	}
 
 	if( m_released && (!instrumentTrack()->isSustainPedalPressed() ||
@@ -273,7 +372,7 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 		// because we do not allow NotePlayHandle::isFinished() to be true
 		// until all sub-notes are completely played and no new ones
 		// are inserted by arpAndChordsTabWidget::processNote()
-		if( ! m_subNotes.isEmpty() )
+		if( m_firstSubNote )
 		{
 			m_releaseFramesToDo = m_releaseFramesDone + 2 * Engine::audioEngine()->framesPerPeriod();
 		}
@@ -326,7 +425,11 @@ void NotePlayHandle::play( sampleFrame * _working_buffer )
 
 f_cnt_t NotePlayHandle::framesLeft() const
 {
-	if( instrumentTrack()->isSustainPedalPressed() )
+	if( m_stolen )
+	{
+		return m_stealFramesLeft;
+	}
+	else if( instrumentTrack()->isSustainPedalPressed() )
 	{
 		return 4 * Engine::audioEngine()->framesPerPeriod();
 	}
@@ -371,9 +474,13 @@ void NotePlayHandle::noteOff( const f_cnt_t _s )
 		return;
 	}
 	m_released = true;
+	if( hasParent() == false )
+	{
+		removeFromActiveNotes();
+	}
 
 	// first note-off all sub-notes
-	for( NotePlayHandle * n : m_subNotes )
+	for( NotePlayHandle * n = m_firstSubNote; n; n = n->m_nextSubNote )
 	{
 		n->lock();
 		n->noteOff( _s );
@@ -409,6 +516,46 @@ void NotePlayHandle::noteOff( const f_cnt_t _s )
 
 
 
+void NotePlayHandle::steal()
+{
+	lock();
+	if( !m_stolen )
+	{
+		noteOff( 0 );
+		m_stolen = true;
+		m_stealFramesLeft = stealFadeFrames();
+	}
+	unlock();
+}
+
+
+
+
+void NotePlayHandle::fadeOutStolen()
+{
+	const f_cnt_t fadeFrames = stealFadeFrames();
+	const f_cnt_t frames = qMin<f_cnt_t>( m_stealFramesLeft, m_framesThisPeriod );
+	sampleFrame * buf = usesBuffer() ? buffer() : nullptr;
+	if( buf != nullptr )
+	{
+		buf += noteOffset();
+		for( f_cnt_t f = 0; f < frames; ++f )
+		{
+			const float gain = static_cast<float>( m_stealFramesLeft - f ) / fadeFrames;
+			buf[f][0] *= gain;
+			buf[f][1] *= gain;
+		}
+		for( f_cnt_t f = frames; f < m_framesThisPeriod; ++f )
+		{
+			buf[f][0] = buf[f][1] = 0.0f;
+		}
+	}
+	m_stealFramesLeft -= frames;
+}
+
+
+
+
 f_cnt_t NotePlayHandle::actualReleaseFramesToDo() const
 {
 	return m_instrumentTrack->m_soundShaping.releaseFrames();
@@ -441,9 +588,9 @@ float NotePlayHandle::volumeLevel( const f_cnt_t _frame )
 void NotePlayHandle::mute()
 {
 	// mute all sub-notes
-	for( NotePlayHandleList::Iterator it = m_subNotes.begin(); it != m_subNotes.end(); ++it )
+	for( NotePlayHandle * n = m_firstSubNote; n; n = n->m_nextSubNote )
 	{
-		( *it )->mute();
+		n->mute();
 	}
 	m_muted = true;
 }
@@ -451,24 +598,32 @@ void NotePlayHandle::mute()
 
 
 
-int NotePlayHandle::index() const
+void NotePlayHandle::addToActiveNotes()
 {
-	const PlayHandleList & playHandles = Engine::audioEngine()->playHandles();
-	int idx = 0;
-	for( PlayHandleList::ConstIterator it = playHandles.begin(); it != playHandles.end(); ++it )
+	QMutexLocker locker( &m_instrumentTrack->m_activeNotesMutex );
+	m_activeNoteIndex = m_instrumentTrack->m_activeNotes.size();
+	m_instrumentTrack->m_activeNotes.push_back( this );
+}
+
+
+
+
+void NotePlayHandle::removeFromActiveNotes()
+{
+	QMutexLocker locker( &m_instrumentTrack->m_activeNotesMutex );
+	if( m_activeNoteIndex < 0 )
 	{
-		const NotePlayHandle * nph = dynamic_cast<const NotePlayHandle *>( *it );
-		if( nph == nullptr || nph->m_instrumentTrack != m_instrumentTrack || nph->isReleased() || nph->hasParent() )
-		{
-			continue;
-		}
-		if( nph == this )
-		{
-			return idx;
-		}
-		++idx;
+		return;
 	}
-	return -1;
+
+	// keep the order, the notes behind us move up by one
+	std::vector<NotePlayHandle *> & notes = m_instrumentTrack->m_activeNotes;
+	notes.erase( notes.begin() + m_activeNoteIndex );
+	for( int i = m_activeNoteIndex; i < static_cast<int>( notes.size() ); ++i )
+	{
+		notes[i]->m_activeNoteIndex = i;
+	}
+	m_activeNoteIndex = -1;
 }
 
 
@@ -546,15 +701,27 @@ void NotePlayHandle::updateFrequency()
 		m_unpitchedFrequency = DefaultBaseFreq * powf(2.0f, pitch);
 	}
 
-	for (auto it : m_subNotes)
+	for (NotePlayHandle * n = m_firstSubNote; n; n = n->m_nextSubNote)
 	{
-		it->updateFrequency();
+		n->updateFrequency();
 	}
 }
 
 
 
 
+uint32_t NotePlayHandle::randomSeed() const
+{
+	const TrackContainer * container = m_instrumentTrack->trackContainer();
+	uint32_t seed = static_cast<uint32_t>( container ? container->tracks().indexOf( m_instrumentTrack ) : 0 );
+	seed = FastRandom::combine( seed, static_cast<uint32_t>( m_songGlobalParentOffset + pos() ) );
+	seed = FastRandom::combine( seed, static_cast<uint32_t>( key() ) );
+	return FastRandom::combine( seed, static_cast<uint32_t>( m_hasParent ) );
+}
+
+
+
+
 void NotePlayHandle::processTimePos( const TimePos& time )
 {
 	if( detuning() && time >= songGlobalParentOffset()+pos() )
@@ -574,7 +741,7 @@ void NotePlayHandle::processTimePos( const TimePos& time )
 void NotePlayHandle::resize( const bpm_t _new_tempo )
 {
 	if (origin() == OriginMidiInput ||
-		(origin() == OriginNoteStacking && m_parent->origin() == OriginMidiInput))
+		(origin() == OriginNoteStacking && m_parent && m_parent->origin() == OriginMidiInput))
 	{
 		// Don't resize notes from MIDI input - they should continue to play
 		// until the key is released, and their large duration can cause
@@ -586,33 +753,128 @@ void NotePlayHandle::resize( const bpm_t _new_tempo )
 	double new_frames = m_origFrames * m_origTempo / (double) _new_tempo;
 	m_frames = (f_cnt_t)new_frames;
 	m_totalFramesPlayed = (f_cnt_t)( completed * new_frames );
+	// the sub notes are play handles of their own and catch up by
+	// themselves
+}
+
+
+
+
+NoteBatch::NoteBatch( InstrumentTrack * instrumentTrack ) :
+	m_instrumentTrack( instrumentTrack )
+{
+	// filled by the audio engine, which must not allocate
+	m_notes.reserve( PlayHandle::MaxNumber );
+	m_playing.reserve( PlayHandle::MaxNumber );
+}
+
+
+
+
+ThreadableJob::Label NoteBatch::jobLabel() const
+{
+	return { "Notes", m_instrumentTrack->audioPort()->name() };
+}
+
+
+
 
-	for( NotePlayHandleList::Iterator it = m_subNotes.begin(); it != m_subNotes.end(); ++it )
+LoadMeter * NoteBatch::loadMeter()
+{
+	return &m_instrumentTrack->audioPort()->playHandleLoad();
+}
+
+
+
+
+void NoteBatch::doProcessing()
+{
+	m_playing.clear();
+	for( NotePlayHandle * nph : m_notes )
 	{
-		( *it )->resize( _new_tempo );
+		nph->startProcessing();
+		if( nph->startPlaying() && m_instrumentTrack->prepareNote( nph ) )
+		{
+			m_playing.push_back( nph );
+		}
 	}
-}
 
+	if( !m_playing.empty() )
+	{
+		m_instrumentTrack->instrument()->playNotes( m_playing.data(), m_playing.size() );
+	}
 
-NotePlayHandle ** NotePlayHandleManager::s_available;
-QReadWriteLock NotePlayHandleManager::s_mutex;
-std::atomic_int NotePlayHandleManager::s_availableIndex;
-int NotePlayHandleManager::s_size;
+	for( NotePlayHandle * nph : m_notes )
+	{
+		nph->finishPlaying();
+		nph->finishProcessing();
+	}
+	m_notes.clear();
+}
 
 
-void NotePlayHandleManager::init()
+// Storage for one handle; the handle lives at the start of its slot, so
+// release() can find the slot from the handle
+struct NotePlayHandleManager::Slot
+{
+	// starting on a cache line, so that the hot head of the handle takes
+	// as few lines as possible
+	alignas( 64 ) unsigned char storage[sizeof( NotePlayHandle )];
+	std::atomic<uint32_t> next;
+	uint32_t index;
+	// outlives the handles, see filter()
+	std::unique_ptr<BasicFilters<>> filter;
+	sample_rate_t filterSampleRate = 0;
+};
+
+static const uint32_t NO_SLOT = 0xffffffff;
+
+std::atomic<NotePlayHandleManager::Slot *> NotePlayHandleManager::s_segments[MAX_NPH_CACHE_SEGMENTS];
+std::atomic_int NotePlayHandleManager::s_segmentCount( 0 );
+std::atomic<uint64_t> NotePlayHandleManager::s_freeList( NO_SLOT );
+std::atomic_int NotePlayHandleManager::s_inUse( 0 );
+std::atomic_int NotePlayHandleManager::s_highWaterMark( 0 );
+std::atomic_int NotePlayHandleManager::s_droppedNotes( 0 );
+
+static QMutex s_growMutex;
+
+
+//! Keeps a quarter of the pool free so the audio threads don't have to grow it
+class NotePlayHandlePoolGrower : public QThread
 {
-	s_available = MM_ALLOC<NotePlayHandle*>( INITIAL_NPH_CACHE );
+public:
+	void stop()
+	{
+		m_quit = true;
+		wait();
+	}
+
+protected:
+	void run() override
+	{
+		while( !m_quit )
+		{
+			NotePlayHandleManager::reserve();
+			msleep( 20 );
+		}
+	}
+
+private:
+	std::atomic_bool m_quit{ false };
+};
+
+static NotePlayHandlePoolGrower * s_poolGrower = nullptr;
 
-	NotePlayHandle * n = MM_ALLOC<NotePlayHandle>( INITIAL_NPH_CACHE );
 
-	for( int i=0; i < INITIAL_NPH_CACHE; ++i )
+void NotePlayHandleManager::init()
+{
+	while( capacity() < INITIAL_NPH_CACHE )
 	{
-		s_available[ i ] = n;
-		++n;
+		extend();
 	}
-	s_availableIndex = INITIAL_NPH_CACHE - 1;
-	s_size = INITIAL_NPH_CACHE;
+
+	s_poolGrower = new NotePlayHandlePoolGrower;
+	s_poolGrower->start( QThread::LowPriority );
 }
 
 
@@ -624,12 +886,23 @@ NotePlayHandle * NotePlayHandleManager::acquire( InstrumentTrack* instrumentTrac
 				int midiEventChannel,
 				NotePlayHandle::Origin origin )
 {
-	// TODO: use some lockless data structures
-	s_mutex.lockForWrite();
-	if (s_availableIndex < 0) { extend(NPH_CACHE_INCREMENT); }
-	NotePlayHandle * nph = s_available[s_availableIndex--];
-	s_mutex.unlock();
+	Slot * s = pop();
+	if( s == nullptr )
+	{
+		// the grower thread could not keep up - growing here would
+		// allocate on an audio thread
+		++s_droppedNotes;
+		return nullptr;
+	}
+
+	const int used = ++s_inUse;
+	int highWaterMark = s_highWaterMark.load( std::memory_order_relaxed );
+	while( used > highWaterMark &&
+		!s_highWaterMark.compare_exchange_weak( highWaterMark, used, std::memory_order_relaxed ) )
+	{
+	}
 
+	NotePlayHandle * nph = reinterpret_cast<NotePlayHandle *>( s->storage );
 	new( (void*)nph ) NotePlayHandle( instrumentTrack, offset, frames, noteToPlay, parent, midiEventChannel, origin );
 	return nph;
 }
@@ -638,29 +911,120 @@ NotePlayHandle * NotePlayHandleManager::acquire( InstrumentTrack* instrumentTrac
 void NotePlayHandleManager::release( NotePlayHandle * nph )
 {
 	nph->NotePlayHandle::~NotePlayHandle();
-	s_mutex.lockForRead();
-	s_available[++s_availableIndex] = nph;
-	s_mutex.unlock();
+	--s_inUse;
+	push( reinterpret_cast<Slot *>( nph ) );
 }
 
 
-void NotePlayHandleManager::extend( int c )
+BasicFilters<> * NotePlayHandleManager::filter( NotePlayHandle * nph, sample_rate_t sampleRate )
 {
-	s_size += c;
-	NotePlayHandle ** tmp = MM_ALLOC<NotePlayHandle*>( s_size );
-	MM_FREE( s_available );
-	s_available = tmp;
+	Slot * s = reinterpret_cast<Slot *>( nph );
+	if( s->filter == nullptr || s->filterSampleRate != sampleRate )
+	{
+		s->filter = std::make_unique<BasicFilters<>>( sampleRate );
+		s->filterSampleRate = sampleRate;
+	}
+	else
+	{
+		s->filter->clearHistory();
+	}
+	return s->filter.get();
+}
 
-	NotePlayHandle * n = MM_ALLOC<NotePlayHandle>( c );
 
-	for( int i=0; i < c; ++i )
+void NotePlayHandleManager::reserve()
+{
+	while( capacity() - inUse() < capacity() / 4 &&
+		s_segmentCount.load( std::memory_order_relaxed ) < MAX_NPH_CACHE_SEGMENTS )
 	{
-		s_available[++s_availableIndex] = n;
-		++n;
+		extend();
+	}
+}
+
+
+NotePlayHandleManager::Slot * NotePlayHandleManager::slot( uint32_t index )
+{
+	return s_segments[index / NPH_CACHE_INCREMENT].load( std::memory_order_acquire )
+						+ index % NPH_CACHE_INCREMENT;
+}
+
+
+NotePlayHandleManager::Slot * NotePlayHandleManager::pop()
+{
+	uint64_t head = s_freeList.load( std::memory_order_acquire );
+	while( true )
+	{
+		const uint32_t index = static_cast<uint32_t>( head );
+		if( index == NO_SLOT )
+		{
+			return nullptr;
+		}
+		// slots are never freed, so reading a slot that another thread has
+		// popped in the meantime is harmless - the tag makes the CAS fail
+		Slot * s = slot( index );
+		const uint64_t next = ( ( head >> 32 ) + 1 ) << 32 |
+					s->next.load( std::memory_order_relaxed );
+		if( s_freeList.compare_exchange_weak( head, next,
+				std::memory_order_acquire, std::memory_order_acquire ) )
+		{
+			return s;
+		}
+	}
+}
+
+
+void NotePlayHandleManager::push( Slot * s )
+{
+	uint64_t head = s_freeList.load( std::memory_order_relaxed );
+	do
+	{
+		s->next.store( static_cast<uint32_t>( head ), std::memory_order_relaxed );
+	}
+	while( !s_freeList.compare_exchange_weak( head,
+				( ( head >> 32 ) + 1 ) << 32 | s->index,
+				std::memory_order_release, std::memory_order_relaxed ) );
+}
+
+
+void NotePlayHandleManager::extend()
+{
+	QMutexLocker lock( &s_growMutex );
+
+	const int segment = s_segmentCount.load( std::memory_order_relaxed );
+	if( segment >= MAX_NPH_CACHE_SEGMENTS )
+	{
+		qFatal( "NotePlayHandleManager: more than %d note play handles",
+				MAX_NPH_CACHE_SEGMENTS * NPH_CACHE_INCREMENT );
+	}
+
+	Slot * slots = new Slot[NPH_CACHE_INCREMENT];
+	for( int i = 0; i < NPH_CACHE_INCREMENT; ++i )
+	{
+		slots[i].index = segment * NPH_CACHE_INCREMENT + i;
+	}
+	s_segments[segment].store( slots, std::memory_order_release );
+	s_segmentCount.store( segment + 1, std::memory_order_relaxed );
+
+	for( int i = 0; i < NPH_CACHE_INCREMENT; ++i )
+	{
+		push( &slots[i] );
 	}
 }
 
 void NotePlayHandleManager::free()
 {
-	MM_FREE(s_available);
+	if( s_poolGrower )
+	{
+		s_poolGrower->stop();
+		delete s_poolGrower;
+		s_poolGrower = nullptr;
+	}
+
+	const int segments = s_segmentCount.load( std::memory_order_relaxed );
+	for( int i = 0; i < segments; ++i )
+	{
+		delete[] s_segments[i].exchange( nullptr );
+	}
+	s_segmentCount = 0;
+	s_freeList = NO_SLOT;
 }
@@ -26,27 +26,48 @@
 #include "Oscillator.h"
 
 #include <algorithm>
+#include <cstring>
+#include <vector>
 #if !defined(__MINGW32__) && !defined(__MINGW64__)
 	#include <thread>
 #endif
 
+#include <QMutex>
+
 #include "BufferManager.h"
 #include "Engine.h"
 #include "AudioEngine.h"
 #include "AutomatableModel.h"
 #include "fftw3.h"
+#include "FftPlanCache.h"
 #include "fft_helpers.h"
 
 
+// Guards the FFT plans and their buffers, which are shared between the wavetable
+// generation and the user wave tables
+static QMutex s_fftMutex;
+
+#if !defined(__MINGW32__) && !defined(__MINGW64__)
+static std::thread s_waveTableThread;
+#endif
+
+
 
 void Oscillator::waveTableInit()
 {
+	// The plans are made before the generator threads start using them
 	createFFTPlans();
-	generateWaveTables();
 	// The oscillator FFT plans remain throughout the application lifecycle
 	// due to being expensive to create, and being used whenever a userwave form is changed
 	// deleted in main.cpp main()
 
+	// The tables are generated in the background. Until a shape's tables are
+	// ready, oscillators fall back to the non band-limited wave.
+#if !defined(__MINGW32__) && !defined(__MINGW64__)
+	s_waveTableThread = std::thread(generateWaveTables);
+#else
+	generateWaveTables();
+#endif
 }
 
 Oscillator::Oscillator(const IntModel *wave_shape_model,
@@ -67,6 +88,8 @@ Oscillator::Oscillator(const IntModel *wave_shape_model,
 	m_phase(phase_offset),
 	m_userWave(nullptr),
 	m_useWaveTable(false),
+	// distinct, but not reproducible, until the owner seeds it
+	m_random(s_oscillatorCount.fetch_add(1, std::memory_order_relaxed)),
 	m_isModulator(false)
 {
 }
@@ -173,23 +196,26 @@ void Oscillator::generateFromFFT(int bands, sample_t* table)
 		s_specBuf[i][1] = 0.0f;
 	}
 	//ifft
-	fftwf_execute(s_ifftPlan);
+	fftwf_execute_dft_c2r(s_ifftPlan, s_specBuf, s_sampleBuffer);
 	//normalize and copy to result buffer
 	normalize(s_sampleBuffer, table, OscillatorConstants::WAVETABLE_LENGTH, 2*OscillatorConstants::WAVETABLE_LENGTH + 1);
 }
 
-void Oscillator::generateAntiAliasUserWaveTable(SampleBuffer *sampleBuffer)
+void Oscillator::generateAntiAliasUserWaveTable(const sample_t* wave, OscillatorConstants::waveform_t& table)
 {
-	if (sampleBuffer->m_userAntiAliasWaveTable == nullptr) {return;}
+	const int bins = OscillatorConstants::WAVETABLE_LENGTH * 2 + 1;
+	std::vector<float> spectrum(2 * bins);
 
+	QMutexLocker lock(&s_fftMutex);
+	std::copy(wave, wave + OscillatorConstants::WAVETABLE_LENGTH, s_sampleBuffer);
+	fftwf_execute_dft_r2c(s_fftPlan, s_sampleBuffer, s_specBuf);
+	// the inverse transform overwrites the spectrum, every band starts from
+	// this copy
+	std::memcpy(spectrum.data(), s_specBuf, spectrum.size() * sizeof(float));
 	for (int i = 0; i < OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT; ++i)
 	{
-		for (int i = 0; i < OscillatorConstants::WAVETABLE_LENGTH; ++i)
-		{
-			s_sampleBuffer[i] = sampleBuffer->userWaveSample((float)i / (float)OscillatorConstants::WAVETABLE_LENGTH);
-		}
-		fftwf_execute(s_fftPlan);
-		Oscillator::generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), (*(sampleBuffer->m_userAntiAliasWaveTable))[i].data());
+		std::memcpy(s_specBuf, spectrum.data(), spectrum.size() * sizeof(float));
+		Oscillator::generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), table[i].data());
 	}
 }
 
@@ -202,6 +228,8 @@ sample_t Oscillator::s_waveTables
 fftwf_plan Oscillator::s_fftPlan;
 fftwf_plan Oscillator::s_ifftPlan;
 fftwf_complex * Oscillator::s_specBuf;
+std::atomic<bool> Oscillator::s_waveTableReady[Oscillator::WaveShapes::NumWaveShapeTables];
+std::atomic<uint32_t> Oscillator::s_oscillatorCount(0);
 float Oscillator::s_sampleBuffer[OscillatorConstants::WAVETABLE_LENGTH];
 
 
@@ -209,8 +237,8 @@ float Oscillator::s_sampleBuffer[OscillatorConstants::WAVETABLE_LENGTH];
 void Oscillator::createFFTPlans()
 {
 	Oscillator::s_specBuf = ( fftwf_complex * ) fftwf_malloc( ( OscillatorConstants::WAVETABLE_LENGTH * 2 + 1 ) * sizeof( fftwf_complex ) );
-	Oscillator::s_fftPlan = fftwf_plan_dft_r2c_1d(OscillatorConstants::WAVETABLE_LENGTH, s_sampleBuffer, s_specBuf, FFTW_MEASURE );
-	Oscillator::s_ifftPlan = fftwf_plan_dft_c2r_1d(OscillatorConstants::WAVETABLE_LENGTH, s_specBuf, s_sampleBuffer, FFTW_MEASURE);
+	Oscillator::s_fftPlan = FftPlanCache::realToComplex(OscillatorConstants::WAVETABLE_LENGTH, s_sampleBuffer, s_specBuf);
+	Oscillator::s_ifftPlan = FftPlanCache::complexToReal(OscillatorConstants::WAVETABLE_LENGTH, s_specBuf, s_sampleBuffer);
 	// initialize s_specBuf content to zero, since the values are used in a condition inside generateFromFFT()
 	for (int i = 0; i < OscillatorConstants::WAVETABLE_LENGTH * 2 + 1; i++)
 	{
@@ -221,8 +249,13 @@ void Oscillator::createFFTPlans()
 
 void Oscillator::destroyFFTPlans()
 {
-	fftwf_destroy_plan(s_fftPlan);
-	fftwf_destroy_plan(s_ifftPlan);
+#if !defined(__MINGW32__) && !defined(__MINGW64__)
+	if (s_waveTableThread.joinable())
+	{
+		s_waveTableThread.join();
+	}
+#endif
+	// the plans belong to the FftPlanCache
 	fftwf_free(s_specBuf);
 }
 
@@ -256,12 +289,15 @@ void Oscillator::generateWaveTables()
 					s_waveTables[shapeID][i - 1]);
 			}
 		}
+		s_waveTableReady[shapeID].store(true, std::memory_order_release);
 	};
 
 	// FFT-based wave shapes: make standard wave table without band limit, convert to frequency domain, remove bands
 	// above maximum frequency and convert back to time domain.
 	auto fftGen = []()
 	{
+		QMutexLocker lock(&s_fftMutex);
+
 		// Generate moogSaw tables
 		for (int i = 0; i < OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT; ++i)
 		{
@@ -269,9 +305,10 @@ void Oscillator::generateWaveTables()
 			{
 				Oscillator::s_sampleBuffer[i] = moogSawSample((float)i / (float)OscillatorConstants::WAVETABLE_LENGTH);
 			}
-			fftwf_execute(s_fftPlan);
+			fftwf_execute_dft_r2c(s_fftPlan, s_sampleBuffer, s_specBuf);
 			generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), s_waveTables[WaveShapes::MoogSawWave - FirstWaveShapeTable][i]);
 		}
+		s_waveTableReady[WaveShapes::MoogSawWave - FirstWaveShapeTable].store(true, std::memory_order_release);
 
 		// Generate exponential tables
 		for (int i = 0; i < OscillatorConstants::WAVE_TABLES_PER_WAVEFORM_COUNT; ++i)
@@ -280,9 +317,10 @@ void Oscillator::generateWaveTables()
 			{
 				s_sampleBuffer[i] = expSample((float)i / (float)OscillatorConstants::WAVETABLE_LENGTH);
 			}
-			fftwf_execute(s_fftPlan);
+			fftwf_execute_dft_r2c(s_fftPlan, s_sampleBuffer, s_specBuf);
 			generateFromFFT(OscillatorConstants::MAX_FREQ / freqFromWaveTableBand(i), s_waveTables[WaveShapes::ExponentialWave - FirstWaveShapeTable][i]);
 		}
+		s_waveTableReady[WaveShapes::ExponentialWave - FirstWaveShapeTable].store(true, std::memory_order_release);
 	};
 
 // TODO: Mingw compilers currently do not support std::thread. There are some 3rd-party workarounds available,
@@ -564,6 +602,33 @@ float Oscillator::syncInit( sampleFrame * _ab, const fpp_t _frames,
 
 
 
+// fills the phases of up to SAMPLE_BLOCK frames at a time, renders the
+// samples for the whole block and hands them to write()
+template<Oscillator::WaveShapes W, typename PhaseFn, typename WriteFn>
+inline void Oscillator::renderBlocks( const fpp_t _frames, PhaseFn _phase,
+							WriteFn _write )
+{
+	float phases[SAMPLE_BLOCK];
+	sample_t samples[SAMPLE_BLOCK];
+
+	for( fpp_t start = 0; start < _frames; start += SAMPLE_BLOCK )
+	{
+		const fpp_t count = std::min<fpp_t>( SAMPLE_BLOCK, _frames - start );
+		for( fpp_t i = 0; i < count; ++i )
+		{
+			phases[i] = _phase( start + i );
+		}
+		getSamples<W>( phases, samples, count );
+		for( fpp_t i = 0; i < count; ++i )
+		{
+			_write( start + i, samples[i] );
+		}
+	}
+}
+
+
+
+
 // if we have no sub-osc, we can't do any modulation... just get our samples
 template<Oscillator::WaveShapes W>
 void Oscillator::updateNoSub( sampleFrame * _ab, const fpp_t _frames,
@@ -572,11 +637,9 @@ void Oscillator::updateNoSub( sampleFrame * _ab, const fpp_t _frames,
 	recalcPhase();
 	const float osc_coeff = m_freq * m_detuning_div_samplerate;
 
-	for( fpp_t frame = 0; frame < _frames; ++frame )
-	{
-		_ab[frame][_chnl] = getSample<W>( m_phase ) * m_volume;
-		m_phase += osc_coeff;
-	}
+	renderBlocks<W>( _frames,
+		[&]( fpp_t ) { const float p = m_phase; m_phase += osc_coeff; return p; },
+		[&]( fpp_t frame, sample_t s ) { _ab[frame][_chnl] = s * m_volume; } );
 }
 
 
@@ -591,13 +654,14 @@ void Oscillator::updatePM( sampleFrame * _ab, const fpp_t _frames,
 	recalcPhase();
 	const float osc_coeff = m_freq * m_detuning_div_samplerate;
 
-	for( fpp_t frame = 0; frame < _frames; ++frame )
-	{
-		_ab[frame][_chnl] = getSample<W>( m_phase +
-					_ab[frame][_chnl] )
-							* m_volume;
-		m_phase += osc_coeff;
-	}
+	renderBlocks<W>( _frames,
+		[&]( fpp_t frame )
+		{
+			const float p = m_phase + _ab[frame][_chnl];
+			m_phase += osc_coeff;
+			return p;
+		},
+		[&]( fpp_t frame, sample_t s ) { _ab[frame][_chnl] = s * m_volume; } );
 }
 
 
@@ -612,11 +676,9 @@ void Oscillator::updateAM( sampleFrame * _ab, const fpp_t _frames,
 	recalcPhase();
 	const float osc_coeff = m_freq * m_detuning_div_samplerate;
 
-	for( fpp_t frame = 0; frame < _frames; ++frame )
-	{
-		_ab[frame][_chnl] *= getSample<W>( m_phase ) * m_volume;
-		m_phase += osc_coeff;
-	}
+	renderBlocks<W>( _frames,
+		[&]( fpp_t ) { const float p = m_phase; m_phase += osc_coeff; return p; },
+		[&]( fpp_t frame, sample_t s ) { _ab[frame][_chnl] *= s * m_volume; } );
 }
 
 
@@ -631,11 +693,9 @@ void Oscillator::updateMix( sampleFrame * _ab, const fpp_t _frames,
 	recalcPhase();
 	const float osc_coeff = m_freq * m_detuning_div_samplerate;
 
-	for( fpp_t frame = 0; frame < _frames; ++frame )
-	{
-		_ab[frame][_chnl] += getSample<W>( m_phase ) * m_volume;
-		m_phase += osc_coeff;
-	}
+	renderBlocks<W>( _frames,
+		[&]( fpp_t ) { const float p = m_phase; m_phase += osc_coeff; return p; },
+		[&]( fpp_t frame, sample_t s ) { _ab[frame][_chnl] += s * m_volume; } );
 }
 
 
@@ -651,15 +711,18 @@ void Oscillator::updateSync( sampleFrame * _ab, const fpp_t _frames,
 	recalcPhase();
 	const float osc_coeff = m_freq * m_detuning_div_samplerate;
 
-	for( fpp_t frame = 0; frame < _frames ; ++frame )
-	{
-		if( m_subOsc->syncOk( sub_osc_coeff ) )
+	renderBlocks<W>( _frames,
+		[&]( fpp_t )
 		{
-			m_phase = m_phaseOffset;
-		}
-		_ab[frame][_chnl] = getSample<W>( m_phase ) * m_volume;
-		m_phase += osc_coeff;
-	}
+			if( m_subOsc->syncOk( sub_osc_coeff ) )
+			{
+				m_phase = m_phaseOffset;
+			}
+			const float p = m_phase;
+			m_phase += osc_coeff;
+			return p;
+		},
+		[&]( fpp_t frame, sample_t s ) { _ab[frame][_chnl] = s * m_volume; } );
 }
 
 
@@ -675,143 +738,79 @@ void Oscillator::updateFM( sampleFrame * _ab, const fpp_t _frames,
 	const float osc_coeff = m_freq * m_detuning_div_samplerate;
 	const float sampleRateCorrection = 44100.0f / Engine::audioEngine()->processingSampleRate();
 
-	for( fpp_t frame = 0; frame < _frames; ++frame )
-	{
-		m_phase += _ab[frame][_chnl] * sampleRateCorrection;
-		_ab[frame][_chnl] = getSample<W>( m_phase ) * m_volume;
-		m_phase += osc_coeff;
-	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::SineWave>(const float sample)
-{
-	const float current_freq = m_freq * m_detuning_div_samplerate * Engine::audioEngine()->processingSampleRate();
-
-	if (!m_useWaveTable || current_freq < OscillatorConstants::MAX_FREQ)
-	{
-		return sinSample(sample);
-	}
-	else
-	{
-		return 0;
-	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::TriangleWave>(
-		const float _sample )
-{
-	if (m_useWaveTable && !m_isModulator)
-	{
-		return wtSample(s_waveTables[WaveShapes::TriangleWave - FirstWaveShapeTable],_sample);
-	}
-	else
-	{
-		return triangleSample(_sample);
-	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::SawWave>(
-		const float _sample )
-{
-	if (m_useWaveTable && !m_isModulator)
-	{
-		return wtSample(s_waveTables[WaveShapes::SawWave - FirstWaveShapeTable], _sample);
-	}
-	else
-	{
-		return sawSample(_sample);
-	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::SquareWave>(
-		const float _sample )
-{
-	if (m_useWaveTable && !m_isModulator)
-	{
-		return wtSample(s_waveTables[WaveShapes::SquareWave - FirstWaveShapeTable], _sample);
-	}
-	else
-	{
-		return squareSample(_sample);
-	}
+	renderBlocks<W>( _frames,
+		[&]( fpp_t frame )
+		{
+			m_phase += _ab[frame][_chnl] * sampleRateCorrection;
+			const float p = m_phase;
+			m_phase += osc_coeff;
+			return p;
+		},
+		[&]( fpp_t frame, sample_t s ) { _ab[frame][_chnl] = s * m_volume; } );
 }
 
 
 
 
-template<>
-inline sample_t Oscillator::getSample<Oscillator::MoogSawWave>(
-							const float _sample )
+// the wave shape, the wavetable and its band are the same for every sample
+// of a block, so they are only looked up once per block
+template<Oscillator::WaveShapes W>
+inline void Oscillator::getSamples( const float * _phases, sample_t * _samples,
+							const fpp_t _count )
 {
-	if (m_useWaveTable && !m_isModulator)
+	if constexpr( W == SineWave )
 	{
-		return wtSample(s_waveTables[WaveShapes::MoogSawWave - FirstWaveShapeTable], _sample);
-	}
-	else
-	{
-		return moogSawSample(_sample);
+		const float current_freq = m_freq * m_detuning_div_samplerate * Engine::audioEngine()->processingSampleRate();
+		if( !m_useWaveTable || current_freq < OscillatorConstants::MAX_FREQ )
+		{
+			for( fpp_t i = 0; i < _count; ++i )
+			{
+				_samples[i] = sinSample( _phases[i] );
+			}
+		}
+		else
+		{
+			std::fill_n( _samples, _count, 0.0f );
+		}
 	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::ExponentialWave>(
-							const float _sample )
-{
-	if (m_useWaveTable && !m_isModulator)
+	else if constexpr( W == WhiteNoise )
 	{
-		return wtSample(s_waveTables[WaveShapes::ExponentialWave - FirstWaveShapeTable], _sample);
+		for( fpp_t i = 0; i < _count; ++i )
+		{
+			_samples[i] = m_random.nextBipolar();
+		}
 	}
-	else
+	else if constexpr( W == UserDefinedWave )
 	{
-		return expSample(_sample);
+		// the wave itself plays until its tables are generated
+		const OscillatorConstants::waveform_t * table = m_userWave->userAntiAliasWaveTable();
+		if( m_useWaveTable && !m_isModulator && table != nullptr )
+		{
+			wtSamples( ( *table )[waveTableBand()].data(), _phases, _samples, _count );
+		}
+		else
+		{
+			for( fpp_t i = 0; i < _count; ++i )
+			{
+				_samples[i] = userWaveSample( _phases[i] );
+			}
+		}
 	}
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::WhiteNoise>(
-							const float _sample )
-{
-	return( noiseSample( _sample ) );
-}
-
-
-
-
-template<>
-inline sample_t Oscillator::getSample<Oscillator::UserDefinedWave>(
-							const float _sample )
-{
-	if (m_useWaveTable && !m_isModulator)
+	else if( m_useWaveTable && !m_isModulator && waveTableReady( W ) )
 	{
-		return wtSample(m_userWave->m_userAntiAliasWaveTable, _sample);
+		wtSamples( s_waveTables[W - FirstWaveShapeTable][waveTableBand()],
+							_phases, _samples, _count );
 	}
 	else
 	{
-		return userWaveSample(_sample);
+		for( fpp_t i = 0; i < _count; ++i )
+		{
+			const float ph = _phases[i];
+			_samples[i] = W == TriangleWave ? triangleSample( ph ) :
+					W == SawWave ? sawSample( ph ) :
+					W == SquareWave ? squareSample( ph ) :
+					W == MoogSawWave ? moogSawSample( ph ) :
+					expSample( ph );
+		}
 	}
 }
-
-
-
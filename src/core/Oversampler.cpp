@@ -0,0 +1,242 @@
+/*
+ * Oversampler.cpp - polyphase half-band up- and downsampling
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Oversampler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "lmms_constants.h"
+
+
+namespace
+{
+
+// taps of the branch carrying the filter, the half-band FIR has 2 * Taps - 1
+constexpr int Taps = 32;
+// the other branch is the center tap, delaying by this many frames
+constexpr int CenterDelay = Taps / 2;
+
+//! Even taps of a Blackman windowed half-band FIR, normalised so the
+//! branch has a DC gain of 0.5 like the center tap
+std::array<float, Taps> halfBandTaps()
+{
+	const int length = 2 * Taps - 1;
+	const int center = Taps - 1;
+	std::array<float, Taps> taps;
+	double sum = 0;
+	for( int k = 0; k < Taps; ++k )
+	{
+		const int n = 2 * k;
+		const double x = ( n - center ) * 0.5;
+		const double sinc = std::sin( D_PI * x ) / ( D_PI * x );
+		const double window = 0.42 - 0.5 * std::cos( 2 * D_PI * n / ( length - 1 ) )
+					+ 0.08 * std::cos( 4 * D_PI * n / ( length - 1 ) );
+		taps[k] = 0.5 * sinc * window;
+		sum += taps[k];
+	}
+	for( float & tap : taps )
+	{
+		tap *= 0.5 / sum;
+	}
+	return taps;
+}
+
+const std::array<float, Taps> s_taps = halfBandTaps();
+
+} // namespace
+
+
+
+
+//! One factor of two. The histories keep the last input frames in front of
+//! the new ones, so the filters read one contiguous array.
+class Oversampler::Stage
+{
+public:
+	explicit Stage( fpp_t maxInputFrames ) :
+		m_upLine( Taps - 1 + maxInputFrames ),
+		m_evenLine( Taps - 1 + maxInputFrames ),
+		m_oddLine( CenterDelay + maxInputFrames )
+	{
+		reset();
+	}
+
+	void upsample( const sampleFrame * in, sampleFrame * out, fpp_t frames )
+	{
+		std::copy( in, in + frames, m_upLine.begin() + Taps - 1 );
+		const sampleFrame * x = m_upLine.data() + Taps - 1;
+
+		for( fpp_t n = 0; n < frames; ++n )
+		{
+			for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				float sum = 0;
+				for( int k = 0; k < Taps; ++k )
+				{
+					sum += s_taps[k] * x[n - k][ch];
+				}
+				// zero stuffing halves the level
+				out[2 * n][ch] = 2 * sum;
+				out[2 * n + 1][ch] = x[n - CenterDelay + 1][ch];
+			}
+		}
+
+		std::copy( m_upLine.begin() + frames, m_upLine.begin() + frames + Taps - 1,
+							m_upLine.begin() );
+	}
+
+	//! @p frames is the number of output frames
+	void downsample( const sampleFrame * in, sampleFrame * out, fpp_t frames )
+	{
+		for( fpp_t n = 0; n < frames; ++n )
+		{
+			m_evenLine[Taps - 1 + n] = in[2 * n];
+			m_oddLine[CenterDelay + n] = in[2 * n + 1];
+		}
+		const sampleFrame * even = m_evenLine.data() + Taps - 1;
+		const sampleFrame * odd = m_oddLine.data() + CenterDelay;
+
+		for( fpp_t n = 0; n < frames; ++n )
+		{
+			for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				float sum = 0;
+				for( int k = 0; k < Taps; ++k )
+				{
+					sum += s_taps[k] * even[n - k][ch];
+				}
+				out[n][ch] = sum + 0.5f * odd[n - CenterDelay][ch];
+			}
+		}
+
+		std::copy( m_evenLine.begin() + frames, m_evenLine.begin() + frames + Taps - 1,
+							m_evenLine.begin() );
+		std::copy( m_oddLine.begin() + frames, m_oddLine.begin() + frames + CenterDelay,
+							m_oddLine.begin() );
+	}
+
+	void reset()
+	{
+		const sampleFrame silence = { 0, 0 };
+		std::fill( m_upLine.begin(), m_upLine.end(), silence );
+		std::fill( m_evenLine.begin(), m_evenLine.end(), silence );
+		std::fill( m_oddLine.begin(), m_oddLine.end(), silence );
+	}
+
+private:
+	std::vector<sampleFrame> m_upLine;
+	std::vector<sampleFrame> m_evenLine;
+	std::vector<sampleFrame> m_oddLine;
+} ;
+
+
+
+
+Oversampler::Oversampler( int stages, fpp_t maxFrames ) :
+	m_stages( std::min( std::max( stages, 1 ), MaxStages ) )
+{
+	for( int i = 0; i < m_stages; ++i )
+	{
+		m_stageList.emplace_back( maxFrames >> ( m_stages - i ) );
+	}
+	m_buffers[0].resize( maxFrames );
+	m_buffers[1].resize( maxFrames );
+}
+
+
+
+
+Oversampler::~Oversampler() = default;
+
+
+
+
+f_cnt_t Oversampler::latency( int stages )
+{
+	// both filters of a stage delay by Taps - 1 frames at twice the rate
+	// the stage is fed with
+	double frames = 0;
+	for( int i = 0; i < stages; ++i )
+	{
+		frames += static_cast<double>( Taps - 1 ) / ( 1 << i );
+	}
+	return static_cast<f_cnt_t>( std::lround( frames ) );
+}
+
+
+
+
+sampleFrame * Oversampler::upsample( const sampleFrame * in, fpp_t frames )
+{
+	const sampleFrame * src = in;
+	sampleFrame * dst = nullptr;
+	for( int i = 0; i < m_stages; ++i )
+	{
+		dst = m_buffers[i % 2].data();
+		m_stageList[i].upsample( src, dst, frames );
+		src = dst;
+		frames *= 2;
+	}
+	return dst;
+}
+
+
+
+
+void Oversampler::downsample( sampleFrame * out, fpp_t frames )
+{
+	for( int i = m_stages - 1; i >= 0; --i )
+	{
+		const sampleFrame * src = m_buffers[i % 2].data();
+		sampleFrame * dst = i > 0 ? m_buffers[( i - 1 ) % 2].data() : out;
+		m_stageList[i].downsample( src, dst, frames << i );
+	}
+}
+
+
+
+
+void Oversampler::decimate( const sampleFrame * in, sampleFrame * out, fpp_t frames )
+{
+	const sampleFrame * src = in;
+	for( int i = m_stages - 1; i >= 0; --i )
+	{
+		sampleFrame * dst = i > 0 ? m_buffers[( i - 1 ) % 2].data() : out;
+		m_stageList[i].downsample( src, dst, frames << i );
+		src = dst;
+	}
+}
+
+
+
+
+void Oversampler::reset()
+{
+	for( Stage & stage : m_stageList )
+	{
+		stage.reset();
+	}
+}
@@ -0,0 +1,103 @@
+/*
+ * PatternCachePlayHandle.cpp - plays one repetition of a cached BB pattern
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "PatternCachePlayHandle.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "AudioEngine.h"
+#include "AudioPort.h"
+#include "BBPatternCache.h"
+#include "BBTrack.h"
+#include "EffectChain.h"
+#include "Engine.h"
+#include "SampleBuffer.h"
+#include "Song.h"
+
+
+PatternCachePlayHandle::PatternCachePlayHandle( const BBPatternCache * cache, int generation,
+		BBTrack * bbTrack, Track * track, AudioPort * port, SampleBuffer * buffer, f_cnt_t offset ) :
+	PlayHandle( TypePatternCacheHandle, offset ),
+	m_cache( cache ),
+	m_generation( generation ),
+	m_bbTrack( bbTrack ),
+	m_track( track ),
+	m_buffer( sharedObject::ref( buffer ) ),
+	m_position( 0 )
+{
+	setAudioPort( port );
+}
+
+
+
+
+PatternCachePlayHandle::~PatternCachePlayHandle()
+{
+	sharedObject::unref( m_buffer );
+}
+
+
+
+
+void PatternCachePlayHandle::play( sampleFrame * buffer )
+{
+	const Song * song = Engine::getSong();
+	if( !song->isPlaying() || song->playMode() != Song::Mode_PlaySong ||
+		m_cache->generation() != m_generation )
+	{
+		// the buffer has been cleared already
+		m_position = m_buffer->frames();
+		return;
+	}
+
+	f_cnt_t frames = Engine::audioEngine()->framesPerPeriod();
+	if( m_position == 0 )
+	{
+		buffer += offset();
+		frames -= offset();
+	}
+	frames = std::min( frames, m_buffer->frames() - m_position );
+
+	// the live notes of a muted BB track keep running silently as well
+	if( !m_bbTrack->isMuted() )
+	{
+		// if effects "went to sleep" because there was no input, wake
+		// them up now
+		if( EffectChain * effects = audioPort()->effects() )
+		{
+			effects->startRunning();
+		}
+		memcpy( buffer, m_buffer->data() + m_position, frames * sizeof( sampleFrame ) );
+	}
+	m_position += frames;
+}
+
+
+
+
+bool PatternCachePlayHandle::isFinished() const
+{
+	return m_position >= m_buffer->frames();
+}
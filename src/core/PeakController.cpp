@@ -74,11 +74,24 @@ PeakController::~PeakController()
 
 void PeakController::updateValueBuffer()
 {
-	if( m_coeffNeedsUpdate )
+	const f_cnt_t frames = Engine::audioEngine()->framesPerPeriod();
+	if( m_coeffNeedsUpdate || static_cast<f_cnt_t>( m_attackPowers.size() ) != frames )
 	{
 		const float ratio = 44100.0f / Engine::audioEngine()->processingSampleRate();
 		m_attackCoeff = 1.0f - powf( 2.0f, -0.3f * ( 1.0f - m_peakEffect->attackModel()->value() ) * ratio );
 		m_decayCoeff = 1.0f -  powf( 2.0f, -0.3f * ( 1.0f - m_peakEffect->decayModel()->value()  ) * ratio );
+
+		m_attackPowers.resize( frames );
+		m_decayPowers.resize( frames );
+		float attack = 1.0f;
+		float decay = 1.0f;
+		for( f_cnt_t f = 0; f < frames; ++f )
+		{
+			attack *= 1.0f - m_attackCoeff;
+			decay *= 1.0f - m_decayCoeff;
+			m_attackPowers[f] = attack;
+			m_decayPowers[f] = decay;
+		}
 		m_coeffNeedsUpdate = false;
 	}
 
@@ -87,22 +100,18 @@ void PeakController::updateValueBuffer()
 		float targetSample = m_peakEffect->lastSample();
 		if( m_currentSample != targetSample )
 		{
-			const f_cnt_t frames = Engine::audioEngine()->framesPerPeriod();
+			// the follower approaches the target exponentially, by the
+			// same ratio every frame, so the frames don't depend on each
+			// other
+			const float * powers = m_currentSample < targetSample ? m_attackPowers.data() : m_decayPowers.data();
+			const float distance = m_currentSample - targetSample;
 			float * values = m_valueBuffer.values();
 
 			for( f_cnt_t f = 0; f < frames; ++f )
 			{
-				const float diff = ( targetSample - m_currentSample );
-				if( m_currentSample < targetSample ) // going up...
-				{
-					m_currentSample += diff * m_attackCoeff;
-				}
-				else if( m_currentSample > targetSample ) // going down
-				{
-					m_currentSample += diff * m_decayCoeff;
-				}
-				values[f] = m_currentSample;
+				values[f] = targetSample + distance * powers[f];
 			}
+			m_currentSample = values[frames - 1];
 		}
 		else
 		{
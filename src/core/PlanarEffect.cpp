@@ -0,0 +1,58 @@
+/*
+ * PlanarEffect.cpp - base class for effects processing planar audio
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "PlanarEffect.h"
+
+#include "BufferManager.h"
+#include "MixHelpers.h"
+
+
+PlanarEffect::PlanarEffect( const Plugin::Descriptor * _desc,
+			Model * _parent,
+			const Descriptor::SubPluginFeatures::Key * _key ) :
+	Effect( _desc, _parent, _key ),
+	m_buffer( BufferManager::acquirePlanar() )
+{
+}
+
+
+
+
+PlanarEffect::~PlanarEffect()
+{
+	BufferManager::release( m_buffer );
+}
+
+
+
+
+bool PlanarEffect::processAudioBuffer( sampleFrame * _buf, const fpp_t _frames )
+{
+	const PlanarBuffer buf = m_buffer.withFrames( _frames );
+	MixHelpers::deinterleave( buf, _buf );
+	const bool running = processPlanarBuffer( buf );
+	MixHelpers::interleave( _buf, buf );
+	return running;
+}
@@ -24,8 +24,10 @@
  
 #include "PlayHandle.h"
 #include "AudioEngine.h"
+#include "AudioPort.h"
 #include "BufferManager.h"
 #include "Engine.h"
+#include "LoadMeter.h"
 
 #include <QtCore/QThread>
 #include <QDebug>
@@ -35,10 +37,17 @@
 PlayHandle::PlayHandle(const Type type, f_cnt_t offset) :
 		m_type(type),
 		m_offset(offset),
-		m_affinity(QThread::currentThread()),
 		m_playHandleBuffer(BufferManager::acquire()),
+		m_audioPort(nullptr),
+		m_cost(-1),
+		m_engineIndex(-1),
 		m_bufferReleased(true),
-		m_usesBuffer(true)
+		m_usesBuffer(true),
+		m_removalRequested(false),
+		m_queued(false),
+		m_recycled(false),
+		m_affinity(QThread::currentThread()),
+		m_audioPortIndex(-1)
 {
 }
 
@@ -50,20 +59,52 @@ PlayHandle::~PlayHandle()
 
 
 void PlayHandle::doProcessing()
+{
+	const qint64 start = LoadMeter::now();
+	play( startProcessing() );
+	finishProcessing();
+	const qint64 time = LoadMeter::now() - start;
+
+	// smoothed, so that one slow period doesn't take the handle out of
+	// its batch
+	m_cost = m_cost < 0 ? time : m_cost + ( time - m_cost ) / 4;
+}
+
+
+sampleFrame * PlayHandle::startProcessing()
 {
 	if( m_usesBuffer )
 	{
 		m_bufferReleased = false;
 		BufferManager::clear(m_playHandleBuffer, Engine::audioEngine()->framesPerPeriod());
-		play( buffer() );
+		return buffer();
 	}
-	else
+	return nullptr;
+}
+
+
+void PlayHandle::finishProcessing()
+{
+	// let the audio port know that our buffer is ready to be mixed
+	if( m_audioPort )
 	{
-		play( nullptr );
+		m_audioPort->playHandleProcessed();
 	}
 }
 
 
+ThreadableJob::Label PlayHandle::jobLabel() const
+{
+	return { "Play handle", m_audioPort ? m_audioPort->name() : QString() };
+}
+
+
+LoadMeter * PlayHandle::loadMeter()
+{
+	return m_audioPort ? &m_audioPort->playHandleLoad() : nullptr;
+}
+
+
 void PlayHandle::releaseBuffer()
 {
 	m_bufferReleased = true;
@@ -73,3 +114,47 @@ sampleFrame* PlayHandle::buffer()
 {
 	return m_bufferReleased ? nullptr : reinterpret_cast<sampleFrame*>(m_playHandleBuffer);
 };
+
+
+
+PlayHandleBatch::PlayHandleBatch() :
+	m_audioPort(nullptr),
+	m_cost(0)
+{
+	// filled by the audio engine, which must not allocate
+	m_handles.reserve( MaxHandles );
+}
+
+
+void PlayHandleBatch::add( PlayHandle * handle )
+{
+	m_audioPort = handle->audioPort();
+	m_handles.push_back( handle );
+	m_cost += handle->cost();
+	// like AudioEngineWorkerThread::addJob(), so that others waiting for
+	// the handle, like InstrumentPlayHandle, may process it themselves
+	handle->queue();
+}
+
+
+ThreadableJob::Label PlayHandleBatch::jobLabel() const
+{
+	return { "Play handles", m_audioPort ? m_audioPort->name() : QString() };
+}
+
+
+LoadMeter * PlayHandleBatch::loadMeter()
+{
+	return m_audioPort ? &m_audioPort->playHandleLoad() : nullptr;
+}
+
+
+void PlayHandleBatch::doProcessing()
+{
+	for( PlayHandle * handle : m_handles )
+	{
+		handle->process();
+	}
+	m_handles.clear();
+	m_cost = 0;
+}
@@ -35,6 +35,7 @@
 #include "GuiApplication.h"
 #include "DummyPlugin.h"
 #include "AutomatableModel.h"
+#include "EngineCounters.h"
 #include "Song.h"
 
 
@@ -60,6 +61,7 @@ Plugin::Plugin(const Descriptor * descriptor, Model * parent, const
 	Model(parent),
 	JournallingObject(),
 	m_descriptor(descriptor),
+	m_badOutput(false),
 	m_key(key ? *key : Descriptor::SubPluginFeatures::Key(m_descriptor))
 {
 	if( m_descriptor == nullptr )
@@ -78,6 +80,28 @@ Plugin::~Plugin()
 
 
 
+void Plugin::reportBadOutput()
+{
+	EngineCounters::add( EngineCounters::Counter::BadOutputs );
+	// the audio threads only ever tell about the first time
+	if( !m_badOutput.exchange( true, std::memory_order_relaxed ) )
+	{
+		QMetaObject::invokeMethod( this, "warnAboutBadOutput", Qt::QueuedConnection );
+	}
+}
+
+
+
+
+void Plugin::warnAboutBadOutput()
+{
+	qWarning( "%s produced invalid samples (NaN or infinity), they were replaced by silence",
+			qPrintable( displayName() ) );
+}
+
+
+
+
 template<class T>
 T use_this_or(T this_param, T or_param)
 {
@@ -214,7 +238,7 @@ Plugin * Plugin::instantiateWithKey(const QString& pluginName, Model * parent,
 Plugin * Plugin::instantiate(const QString& pluginName, Model * parent,
 								void *data)
 {
-	const PluginFactory::PluginInfo& pi = getPluginFactory()->pluginInfo(pluginName.toUtf8());
+	const PluginFactory::PluginInfo& pi = getPluginFactory()->loadPlugin(pluginName.toUtf8());
 
 	Plugin* inst;
 	if( pi.isNull() )
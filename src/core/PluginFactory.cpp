@@ -25,11 +25,14 @@
 #include "PluginFactory.h"
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
 #include <QtCore/QLibrary>
+#include <QDomDocument>
 #include <memory>
 #include "lmmsconfig.h"
+#include "lmmsversion.h"
 
 #include "ConfigManager.h"
 #include "Plugin.h"
@@ -41,6 +44,9 @@
 	QStringList nameFilters("lib*.so");
 #endif
 
+//! Bump this whenever the layout of the plugin cache changes
+static const int PLUGIN_CACHE_VERSION = 1;
+
 qint64 qHash(const QFileInfo& fi)
 {
 	return qHash(fi.absoluteFilePath());
@@ -48,7 +54,74 @@ qint64 qHash(const QFileInfo& fi)
 
 std::unique_ptr<PluginFactory> PluginFactory::s_instance;
 
-PluginFactory::PluginFactory()
+
+
+struct PluginFactory::CachedDescriptor
+{
+	//! Stands in for the library's logo until the library is loaded
+	class Logo : public PixmapLoader
+	{
+	public:
+		Logo(const QString& name, const QByteArray& pluginName) :
+			PixmapLoader(name),
+			m_pluginName(pluginName)
+		{
+		}
+
+		QPixmap pixmap() const override
+		{
+			// loading replaces the descriptor's logo by the library's one
+			const PluginInfo info = getPluginFactory()->loadPlugin(m_pluginName.constData());
+			if (info.isNull() || !info.descriptor->logo || info.descriptor->logo == this)
+			{
+				return QPixmap();
+			}
+			return info.descriptor->logo->pixmap();
+		}
+
+		QString pixmapName() const override
+		{
+			return m_name;
+		}
+
+	private:
+		QByteArray m_pluginName;
+	};
+
+	CachedDescriptor(const CacheEntry& cacheEntry) :
+		entry(cacheEntry),
+		logo(entry.logo, entry.name)
+	{
+		descriptor.name = entry.name.constData();
+		descriptor.displayName = entry.displayName.constData();
+		descriptor.description = entry.description.constData();
+		descriptor.author = entry.author.constData();
+		descriptor.version = entry.version;
+		descriptor.type = entry.type;
+		descriptor.logo = &logo;
+		descriptor.supportedFileTypes = entry.supportedFileTypes.isNull()
+			? nullptr
+			: entry.supportedFileTypes.constData();
+		descriptor.subPluginFeatures = nullptr;
+	}
+
+	const CacheEntry entry;
+	Logo logo;
+	Plugin::Descriptor descriptor;
+};
+
+
+
+bool PluginFactory::CacheEntry::matches(const QFileInfo& file) const
+{
+	return modified == file.lastModified().toMSecsSinceEpoch()
+		&& size == file.size();
+}
+
+
+
+PluginFactory::PluginFactory() :
+	m_cacheFile(ConfigManager::inst()->pluginCacheFile())
 {
 	setupSearchPaths();
 	discoverPlugins();
@@ -56,6 +129,20 @@ PluginFactory::PluginFactory()
 
 PluginFactory::~PluginFactory()
 {
+	// nobody needed the rescanned plugins, but the next start will
+	if (rescanPending())
+	{
+		joinRescan();
+		for (const ScanResult& result : m_rescanResults)
+		{
+			if (result.error.isEmpty())
+			{
+				const CacheEntry entry = cacheEntry(result.file, result.descriptor);
+				m_cache.insert(entry.path, entry);
+			}
+		}
+		writeCache();
+	}
 }
 
 void PluginFactory::setupSearchPaths()
@@ -105,47 +192,96 @@ PluginFactory* getPluginFactory()
 	return PluginFactory::instance();
 }
 
-const Plugin::DescriptorList PluginFactory::descriptors() const
+const Plugin::DescriptorList PluginFactory::descriptors()
 {
+	finishRescan();
 	return m_descriptors.values();
 }
 
-const Plugin::DescriptorList PluginFactory::descriptors(Plugin::PluginTypes type) const
+const Plugin::DescriptorList PluginFactory::descriptors(Plugin::PluginTypes type)
 {
+	finishRescan();
 	return m_descriptors.values(type);
 }
 
-const PluginFactory::PluginInfoList& PluginFactory::pluginInfos() const
+const Plugin::Descriptor::SubPluginFeatures::KeyList PluginFactory::subPluginKeys(
+	const Plugin::Descriptor* desc)
+{
+	finishRescan();
+	return m_subPluginKeys.value(desc);
+}
+
+int PluginFactory::revision()
 {
+	finishRescan();
+	return m_revision;
+}
+
+const PluginFactory::PluginInfoList& PluginFactory::pluginInfos()
+{
+	finishRescan();
 	return m_pluginInfos;
 }
 
 const PluginFactory::PluginInfoAndKey PluginFactory::pluginSupportingExtension(const QString& ext)
 {
+	finishRescan();
 	return m_pluginByExt.value(ext, PluginInfoAndKey());
 }
 
-const PluginFactory::PluginInfo PluginFactory::pluginInfo(const char* name) const
+const PluginFactory::PluginInfo PluginFactory::pluginInfo(const char* name)
 {
 	for (const PluginInfo& info : m_pluginInfos)
 	{
 		if (qstrcmp(info.descriptor->name, name) == 0)
 			return info;
 	}
+
+	// the plugin may be one whose cache entry is being rebuilt
+	if (rescanPending())
+	{
+		finishRescan();
+		return pluginInfo(name);
+	}
+	return PluginInfo();
+}
+
+const PluginFactory::PluginInfo PluginFactory::loadPlugin(const char* name)
+{
+	const PluginInfo found = pluginInfo(name);
+	if (found.isNull() || found.isLoaded())
+	{
+		return found;
+	}
+
+	for (PluginInfo& info : m_pluginInfos)
+	{
+		if (info.descriptor == found.descriptor)
+		{
+			return loadLibrary(info) ? info : PluginInfo();
+		}
+	}
 	return PluginInfo();
 }
 
-QString PluginFactory::errorString(QString pluginName) const
+QString PluginFactory::errorString(QString pluginName)
 {
 	static QString notfound = qApp->translate("PluginFactory", "Plugin not found.");
+	finishRescan();
 	return m_errors.value(pluginName, notfound);
 }
 
 void PluginFactory::discoverPlugins()
 {
-	DescriptorMap descriptors;
-	PluginInfoList pluginInfos;
+	finishRescan();
+
+	m_descriptors.clear();
+	m_pluginInfos.clear();
+	m_subPluginKeys.clear();
 	m_pluginByExt.clear();
+	++m_revision;
+	m_dependencies.clear();
+	m_dependenciesLoaded = false;
 
 	QSet<QFileInfo> files;
 	for (const QString& searchPath : QDir::searchPaths("plugins"))
@@ -158,92 +294,390 @@ void PluginFactory::discoverPlugins()
 #endif
 	}
 
+	// Plugins with an up to date cache entry are listed without loading
+	// their library. Sub plugins can only be listed by the library itself,
+	// and files that are new or changed are rescanned in the background.
+	const QHash<QString, CacheEntry> cache = readCache();
+	m_cache.clear();
+
+	QFileInfoList withSubPlugins;
+	QFileInfoList stale;
+	for (const QFileInfo& file : files)
+	{
+		const auto it = cache.find(file.absoluteFilePath());
+		if (it == cache.end() || !it->matches(file))
+		{
+			stale << file;
+			continue;
+		}
+
+		m_cache.insert(it->path, *it);
+		if (!it->isPlugin)
+		{
+			m_dependencies << it->path;
+		}
+		else if (it->hasSubPlugins)
+		{
+			withSubPlugins << file;
+		}
+		else
+		{
+			// descriptors are handed out by pointer, so they are never freed
+			m_cachedDescriptors.push_back(std::make_unique<CachedDescriptor>(*it));
+
+			PluginInfo info;
+			info.file = file;
+			info.descriptor = &m_cachedDescriptors.back()->descriptor;
+			addPlugin(info);
+		}
+	}
+
+	if (!withSubPlugins.isEmpty())
+	{
+		addScanResults(scanLibraries(m_dependencies, withSubPlugins));
+	}
+
+	if (!stale.isEmpty())
+	{
+		const QStringList dependencies = m_dependencies;
+#if !defined(__MINGW32__) && !defined(__MINGW64__)
+		m_rescanThread = std::thread([this, dependencies, stale]() {
+			m_rescanResults = scanLibraries(dependencies, stale);
+		});
+#else
+		// no std::thread on MinGW, see Oscillator::generateWaveTables()
+		addScanResults(scanLibraries(dependencies, stale));
+		writeCache();
+#endif
+	}
+	else if (cache.size() != m_cache.size())
+	{
+		// some libraries were removed
+		writeCache();
+	}
+}
+
+std::vector<PluginFactory::ScanResult> PluginFactory::scanLibraries(
+	const QStringList& dependencies, const QFileInfoList& files)
+{
 	// Cheap dependency handling: zynaddsubfx needs ZynAddSubFxCore. By loading
 	// all libraries twice we ensure that libZynAddSubFxCore is found.
+	for (const QString& dependency : dependencies)
+	{
+		QLibrary(dependency).load();
+	}
 	for (const QFileInfo& file : files)
 	{
 		QLibrary(file.absoluteFilePath()).load();
 	}
 
+	std::vector<ScanResult> results;
 	for (const QFileInfo& file : files)
 	{
-		auto library = std::make_shared<QLibrary>(file.absoluteFilePath());
-		if (! library->load()) {
-			m_errors[file.baseName()] = library->errorString();
-			qWarning("%s", library->errorString().toLocal8Bit().data());
-			continue;
+		ScanResult result;
+		result.file = file;
+		result.library = std::make_shared<QLibrary>(file.absoluteFilePath());
+		if (result.library->load())
+		{
+			result.descriptor = resolveDescriptor(*result.library, file);
+		}
+		else
+		{
+			result.error = result.library->errorString();
 		}
+		results.push_back(result);
+	}
+	return results;
+}
 
-		Plugin::Descriptor* pluginDescriptor = nullptr;
-		if (library->resolve("lmms_plugin_main"))
+Plugin::Descriptor* PluginFactory::resolveDescriptor(QLibrary& library, const QFileInfo& file)
+{
+	if (!library.resolve("lmms_plugin_main"))
+	{
+		return nullptr;
+	}
+
+	QString descriptorName = file.baseName() + "_plugin_descriptor";
+	if( descriptorName.left(3) == "lib" )
+	{
+		descriptorName = descriptorName.mid(3);
+	}
+
+	auto pluginDescriptor = reinterpret_cast<Plugin::Descriptor*>(library.resolve(descriptorName.toUtf8().constData()));
+	if(pluginDescriptor == nullptr)
+	{
+		qWarning() << qApp->translate("PluginFactory", "LMMS plugin %1 does not have a plugin descriptor named %2!").
+					  arg(file.absoluteFilePath()).arg(descriptorName);
+	}
+	return pluginDescriptor;
+}
+
+PluginFactory::CacheEntry PluginFactory::cacheEntry(const QFileInfo& file,
+	const Plugin::Descriptor* descriptor)
+{
+	CacheEntry entry;
+	entry.path = file.absoluteFilePath();
+	entry.modified = file.lastModified().toMSecsSinceEpoch();
+	entry.size = file.size();
+	if (descriptor)
+	{
+		entry.isPlugin = true;
+		entry.hasSubPlugins = descriptor->subPluginFeatures != nullptr;
+		entry.name = descriptor->name;
+		entry.displayName = descriptor->displayName;
+		entry.description = descriptor->description;
+		entry.author = descriptor->author;
+		entry.version = descriptor->version;
+		entry.type = descriptor->type;
+		entry.logo = descriptor->logo ? descriptor->logo->pixmapName() : QString();
+		entry.supportedFileTypes = descriptor->supportedFileTypes;
+	}
+	return entry;
+}
+
+void PluginFactory::addPlugin(const PluginInfo& info)
+{
+	m_pluginInfos << info;
+
+	auto addSupportedFileTypes =
+		[this](QString supportedFileTypes,
+			const PluginInfo& info,
+			const Plugin::Descriptor::SubPluginFeatures::Key* key = nullptr)
+	{
+		if(!supportedFileTypes.isNull())
 		{
-			QString descriptorName = file.baseName() + "_plugin_descriptor";
-			if( descriptorName.left(3) == "lib" )
+			for (const QString& ext : supportedFileTypes.split(','))
 			{
-				descriptorName = descriptorName.mid(3);
+				//qDebug() << "Plugin " << info.name()
+				//	<< "supports" << ext;
+				PluginInfoAndKey infoAndKey;
+				infoAndKey.info = info;
+				infoAndKey.key = key
+					? *key
+					: Plugin::Descriptor::SubPluginFeatures::Key();
+				m_pluginByExt.insert(ext, infoAndKey);
 			}
+		}
+	};
 
-			pluginDescriptor = reinterpret_cast<Plugin::Descriptor*>(library->resolve(descriptorName.toUtf8().constData()));
-			if(pluginDescriptor == nullptr)
-			{
-				qWarning() << qApp->translate("PluginFactory", "LMMS plugin %1 does not have a plugin descriptor named %2!").
-							  arg(file.absoluteFilePath()).arg(descriptorName);
-				continue;
-			}
+	if (info.descriptor->supportedFileTypes)
+		addSupportedFileTypes(QString(info.descriptor->supportedFileTypes), info);
+
+	if (info.descriptor->subPluginFeatures)
+	{
+		Plugin::Descriptor::SubPluginFeatures::KeyList
+			subPluginKeys;
+		info.descriptor->subPluginFeatures->listSubPluginKeys(
+			info.descriptor,
+			subPluginKeys);
+		for(const Plugin::Descriptor::SubPluginFeatures::Key& key
+			: subPluginKeys)
+		{
+			addSupportedFileTypes(key.additionalFileExtensions(), info, &key);
+		}
+		m_subPluginKeys.insert(info.descriptor, subPluginKeys);
+	}
+
+	m_descriptors.insert(info.descriptor->type, info.descriptor);
+}
+
+void PluginFactory::addScanResults(const std::vector<ScanResult>& results)
+{
+	for (const ScanResult& result : results)
+	{
+		if (!result.error.isEmpty())
+		{
+			// not cached, the library may load fine next time
+			m_errors[result.file.baseName()] = result.error;
+			qWarning("%s", result.error.toLocal8Bit().data());
+			continue;
 		}
 
-		if(pluginDescriptor)
+		const CacheEntry entry = cacheEntry(result.file, result.descriptor);
+		m_cache.insert(entry.path, entry);
+
+		if (result.descriptor)
 		{
 			PluginInfo info;
-			info.file = file;
-			info.library = library;
-			info.descriptor = pluginDescriptor;
-			pluginInfos << info;
-
-			auto addSupportedFileTypes =
-				[this](QString supportedFileTypes,
-					const PluginInfo& info,
-					const Plugin::Descriptor::SubPluginFeatures::Key* key = nullptr)
-			{
-				if(!supportedFileTypes.isNull())
-				{
-					for (const QString& ext : supportedFileTypes.split(','))
-					{
-						//qDebug() << "Plugin " << info.name()
-						//	<< "supports" << ext;
-						PluginInfoAndKey infoAndKey;
-						infoAndKey.info = info;
-						infoAndKey.key = key
-							? *key
-							: Plugin::Descriptor::SubPluginFeatures::Key();
-						m_pluginByExt.insert(ext, infoAndKey);
-					}
-				}
-			};
-
-			if (info.descriptor->supportedFileTypes)
-				addSupportedFileTypes(QString(info.descriptor->supportedFileTypes), info);
-
-			if (info.descriptor->subPluginFeatures)
+			info.file = result.file;
+			info.library = result.library;
+			info.descriptor = result.descriptor;
+			addPlugin(info);
+			++m_revision;
+		}
+		else
+		{
+			m_dependencies << entry.path;
+		}
+	}
+}
+
+bool PluginFactory::rescanPending() const
+{
+#if !defined(__MINGW32__) && !defined(__MINGW64__)
+	return m_rescanThread.joinable();
+#else
+	return false;
+#endif
+}
+
+void PluginFactory::joinRescan()
+{
+#if !defined(__MINGW32__) && !defined(__MINGW64__)
+	m_rescanThread.join();
+#endif
+}
+
+void PluginFactory::finishRescan()
+{
+	if (!rescanPending())
+	{
+		return;
+	}
+
+	joinRescan();
+	addScanResults(m_rescanResults);
+	m_rescanResults.clear();
+	writeCache();
+}
+
+void PluginFactory::loadDependencies()
+{
+	if (!m_dependenciesLoaded)
+	{
+		for (const QString& dependency : m_dependencies)
+		{
+			QLibrary(dependency).load();
+		}
+		m_dependenciesLoaded = true;
+	}
+}
+
+bool PluginFactory::loadLibrary(PluginInfo& info)
+{
+	loadDependencies();
+
+	auto library = std::make_shared<QLibrary>(info.file.absoluteFilePath());
+	if (!library->load())
+	{
+		m_errors[info.file.baseName()] = library->errorString();
+		qWarning("%s", library->errorString().toLocal8Bit().data());
+		return false;
+	}
+
+	const Plugin::Descriptor* descriptor = resolveDescriptor(*library, info.file);
+	if (!descriptor)
+	{
+		m_errors[info.file.baseName()] = qApp->translate("PluginFactory", "Plugin descriptor not found.");
+		return false;
+	}
+
+	// Fill the cached descriptor in, so everyone who already holds it gets
+	// the library's logo and sub plugin features from now on
+	*info.descriptor = *descriptor;
+	info.library = library;
+
+	for (PluginInfoAndKey& infoAndKey : m_pluginByExt)
+	{
+		if (infoAndKey.info.descriptor == info.descriptor)
+		{
+			infoAndKey.info.library = library;
+		}
+	}
+	return true;
+}
+
+QHash<QString, PluginFactory::CacheEntry> PluginFactory::readCache() const
+{
+	QHash<QString, CacheEntry> cache;
+
+	QFile file(m_cacheFile);
+	QDomDocument doc;
+	if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file))
+	{
+		return cache;
+	}
+
+	const QDomElement root = doc.documentElement();
+	if (root.tagName() != "plugincache"
+		|| root.attribute("version").toInt() != PLUGIN_CACHE_VERSION
+		|| root.attribute("lmmsversion") != LMMS_VERSION)
+	{
+		// plugins of another LMMS version may have other descriptors
+		return cache;
+	}
+
+	for (QDomElement element = root.firstChildElement(); !element.isNull();
+		element = element.nextSiblingElement())
+	{
+		CacheEntry entry;
+		entry.path = element.attribute("path");
+		entry.modified = element.attribute("modified").toLongLong();
+		entry.size = element.attribute("size").toLongLong();
+		if (element.tagName() == "plugin")
+		{
+			entry.isPlugin = true;
+			entry.hasSubPlugins = element.attribute("subplugins").toInt();
+			entry.name = element.attribute("name").toUtf8();
+			entry.displayName = element.attribute("displayname").toUtf8();
+			entry.description = element.attribute("description").toUtf8();
+			entry.author = element.attribute("author").toUtf8();
+			entry.version = element.attribute("pluginversion").toInt();
+			entry.type = static_cast<Plugin::PluginTypes>(element.attribute("type").toInt());
+			entry.logo = element.attribute("logo");
+			if (element.hasAttribute("filetypes"))
 			{
-				Plugin::Descriptor::SubPluginFeatures::KeyList
-					subPluginKeys;
-				info.descriptor->subPluginFeatures->listSubPluginKeys(
-					info.descriptor,
-					subPluginKeys);
-				for(const Plugin::Descriptor::SubPluginFeatures::Key& key
-					: subPluginKeys)
-				{
-					addSupportedFileTypes(key.additionalFileExtensions(), info, &key);
-				}
+				entry.supportedFileTypes = element.attribute("filetypes").toUtf8();
 			}
+		}
+		else if (element.tagName() != "library")
+		{
+			continue;
+		}
+		cache.insert(entry.path, entry);
+	}
+	return cache;
+}
+
+void PluginFactory::writeCache() const
+{
+	QDomDocument doc("lmms-plugincache");
+	QDomElement root = doc.createElement("plugincache");
+	root.setAttribute("version", PLUGIN_CACHE_VERSION);
+	root.setAttribute("lmmsversion", LMMS_VERSION);
+	doc.appendChild(root);
 
-			descriptors.insert(info.descriptor->type, info.descriptor);
+	for (const CacheEntry& entry : m_cache)
+	{
+		QDomElement element = doc.createElement(entry.isPlugin ? "plugin" : "library");
+		element.setAttribute("path", entry.path);
+		element.setAttribute("modified", entry.modified);
+		element.setAttribute("size", entry.size);
+		if (entry.isPlugin)
+		{
+			element.setAttribute("subplugins", entry.hasSubPlugins ? 1 : 0);
+			element.setAttribute("name", QString::fromUtf8(entry.name));
+			element.setAttribute("displayname", QString::fromUtf8(entry.displayName));
+			element.setAttribute("description", QString::fromUtf8(entry.description));
+			element.setAttribute("author", QString::fromUtf8(entry.author));
+			element.setAttribute("pluginversion", entry.version);
+			element.setAttribute("type", entry.type);
+			element.setAttribute("logo", entry.logo);
+			if (!entry.supportedFileTypes.isNull())
+			{
+				element.setAttribute("filetypes", QString::fromUtf8(entry.supportedFileTypes));
+			}
 		}
+		root.appendChild(element);
 	}
 
-	m_pluginInfos = pluginInfos;
-	m_descriptors = descriptors;
+	QFile file(m_cacheFile);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "Could not write plugin cache" << m_cacheFile;
+		return;
+	}
+	file.write(doc.toByteArray());
 }
 
 
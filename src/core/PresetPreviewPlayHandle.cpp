@@ -125,6 +125,9 @@ PresetPreviewPlayHandle::PresetPreviewPlayHandle( const QString & _preset_file,
 	Engine::audioEngine()->requestChangeInModel();
 	s_previewTC->setPreviewNote( nullptr );
 	s_previewTC->previewInstrumentTrack()->silenceAllNotes();
+	// loading a preset or starting a plugin may hold the instrument's locks
+	// for a while, which the engine would wait for if it played it
+	s_previewTC->previewInstrumentTrack()->setSuspended( true );
 	Engine::audioEngine()->doneChangeInModel();
 
 	const bool j = Engine::projectJournal()->isJournalling();
@@ -171,7 +174,9 @@ PresetPreviewPlayHandle::PresetPreviewPlayHandle( const QString & _preset_file,
 				midiPort()->setMode( MidiPort::Disabled );
 
 	Engine::audioEngine()->requestChangeInModel();
-	// create note-play-handle for it
+	// create note-play-handle for it - this isn't an audio thread, so
+	// make sure the pool has one
+	NotePlayHandleManager::reserve();
 	m_previewNote = NotePlayHandleManager::acquire(
 			s_previewTC->previewInstrumentTrack(), 0,
 			typeInfo<f_cnt_t>::max() / 2,
@@ -181,6 +186,8 @@ PresetPreviewPlayHandle::PresetPreviewPlayHandle( const QString & _preset_file,
 
 	s_previewTC->setPreviewNote( m_previewNote );
 
+	// the loaded instrument and its note start with the same period
+	s_previewTC->previewInstrumentTrack()->setSuspended( false );
 	Engine::audioEngine()->addPlayHandle( m_previewNote );
 
 	Engine::audioEngine()->doneChangeInModel();
@@ -0,0 +1,157 @@
+/*
+ * ProjectGenerator.cpp - builds synthetic songs of a given size
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ProjectGenerator.h"
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "AudioPort.h"
+#include "AutomationClip.h"
+#include "Effect.h"
+#include "EffectChain.h"
+#include "Engine.h"
+#include "InstrumentTrack.h"
+#include "MidiClip.h"
+#include "Mixer.h"
+#include "PluginFactory.h"
+#include "Song.h"
+
+
+ProjectGenerator::ProjectGenerator( const Settings & settings ) :
+	m_settings( settings )
+{
+}
+
+
+
+
+bool ProjectGenerator::generate( Song * song )
+{
+	for( const QString & plugin : { m_settings.instrument, m_settings.effect } )
+	{
+		if( getPluginFactory()->pluginInfo( plugin.toUtf8().constData() ).isNull() )
+		{
+			m_error = QString( "The plugin %1 wasn't found" ).arg( plugin );
+			return false;
+		}
+	}
+
+	// the mixer tree, from the master down to the channels the tracks
+	// send to. Tracks have to be created after it, as they only accept
+	// channels which already exist.
+	Mixer * mixer = Engine::mixer();
+	const int fanIn = qMax( m_settings.mixerFanIn, 1 );
+	std::vector<int> levelSizes;
+	for( int senders = m_settings.tracks, level = 0; level < m_settings.mixerDepth; ++level )
+	{
+		senders = qMax( ( senders + fanIn - 1 ) / fanIn, 1 );
+		levelSizes.insert( levelSizes.begin(), senders );
+	}
+	std::vector<int> parents( 1, 0 );
+	for( int size : levelSizes )
+	{
+		std::vector<int> channels;
+		for( int i = 0; i < size; ++i )
+		{
+			const int channel = mixer->createChannel();
+			// new channels send to the master
+			const int parent = parents[qMin<int>( i / fanIn, parents.size() - 1 )];
+			if( parent != 0 )
+			{
+				mixer->deleteChannelSend( channel, 0 );
+				mixer->createChannelSend( channel, parent );
+			}
+			addEffects( &mixer->mixerChannel( channel )->m_fxChain );
+			channels.push_back( channel );
+		}
+		parents = std::move( channels );
+	}
+
+	const int ticksPerBar = TimePos::ticksPerBar();
+	const int length = m_settings.bars * ticksPerBar;
+	const int notesPerBar = qBound( 1, m_settings.notesPerBar, ticksPerBar );
+	const int noteLength = ticksPerBar / notesPerBar;
+
+	for( int t = 0; t < m_settings.tracks; ++t )
+	{
+		InstrumentTrack * track = dynamic_cast<InstrumentTrack *>(
+					Track::create( Track::InstrumentTrack, song ) );
+		track->loadInstrument( m_settings.instrument );
+		track->setName( QString( "Track %1" ).arg( t + 1 ) );
+		track->mixerChannelModel()->setValue( parents[qMin<int>( t / fanIn, parents.size() - 1 )] );
+		addEffects( track->audioPort()->effects() );
+
+		// stacked major thirds, moving up with every onset and starting on
+		// another key on every track
+		std::vector<Note> notes;
+		const int root = 36 + ( t * 7 ) % 24;
+		for( int pos = 0; pos + noteLength <= length; pos += noteLength )
+		{
+			for( int p = 0; p < m_settings.polyphony; ++p )
+			{
+				const int key = root + ( p * 4 + pos / noteLength ) % 48;
+				notes.emplace_back( TimePos( noteLength ), TimePos( pos ), key );
+			}
+		}
+		MidiClip * clip = dynamic_cast<MidiClip *>( track->createClip( 0 ) );
+		clip->addNotes( notes, false );
+		clip->changeLength( length );
+
+		if( m_settings.automationPerBar > 0 )
+		{
+			AutomationClip * automation = dynamic_cast<AutomationClip *>(
+				Track::create( Track::AutomationTrack, song )->createClip( 0 ) );
+			automation->setProgressionType( AutomationClip::LinearProgression );
+			automation->addObject( track->panningModel() );
+
+			const int nodes = m_settings.bars * m_settings.automationPerBar;
+			std::vector<std::pair<TimePos, float>> values;
+			for( int n = 0; n <= nodes; ++n )
+			{
+				values.emplace_back( static_cast<int>( static_cast<qint64>( n ) * length / nodes ),
+							50.0f * std::sin( n * 0.7f + t ) );
+			}
+			automation->putValues( values, false );
+		}
+	}
+
+	return true;
+}
+
+
+
+
+void ProjectGenerator::addEffects( EffectChain * chain )
+{
+	for( int i = 0; i < m_settings.effects; ++i )
+	{
+		Effect * effect = Effect::instantiate( m_settings.effect, chain, nullptr );
+		if( effect != nullptr )
+		{
+			chain->appendEffect( effect );
+		}
+	}
+}
@@ -25,6 +25,9 @@
 #include <cstdlib>
 
 #include "ProjectJournal.h"
+#include "AutomatableModel.h"
+#include "BinaryDocument.h"
+#include "ConfigManager.h"
 #include "Engine.h"
 #include "JournallingObject.h"
 #include "Song.h"
@@ -33,14 +36,21 @@
 //! and newly created IDs (have the bit set)
 static const int EO_ID_MSB = 1 << 23;
 
+//! Changes of the same value following each other within this are one
+//! undo step, e.g. when turning the mouse wheel over a knob
+static const qint64 COALESCE_INTERVAL = 500;
+static const int DEFAULT_UNDO_MEMORY = 64; // MB
+
 const int ProjectJournal::MAX_UNDO_STATES = 100; // TODO: make this configurable in settings
 
 ProjectJournal::ProjectJournal() :
 	m_joIDs(),
 	m_undoCheckPoints(),
 	m_redoCheckPoints(),
+	m_size( 0 ),
 	m_journalling( false )
 {
+	m_clock.start();
 }
 
 
@@ -58,17 +68,19 @@ void ProjectJournal::undo()
 	while( !m_undoCheckPoints.isEmpty() )
 	{
 		CheckPoint c = m_undoCheckPoints.pop();
+		m_size -= size( c );
 		JournallingObject *jo = m_joIDs[c.joID];
 
 		if( jo )
 		{
-			DataFile curState( DataFile::JournalData );
-			jo->saveState( curState, curState.content() );
-			m_redoCheckPoints.push( CheckPoint( c.joID, curState ) );
+			m_changedIDs.insert( c.joID );
+			const CheckPoint cur = checkPoint( jo );
+			m_size += size( cur );
+			m_redoCheckPoints.push( cur );
 
 			bool prev = isJournalling();
 			setJournalling( false );
-			jo->restoreState( c.data.content().firstChildElement() );
+			restore( jo, c );
 			setJournalling( prev );
 			Engine::getSong()->setModified();
 			break;
@@ -83,17 +95,19 @@ void ProjectJournal::redo()
 	while( !m_redoCheckPoints.isEmpty() )
 	{
 		CheckPoint c = m_redoCheckPoints.pop();
+		m_size -= size( c );
 		JournallingObject *jo = m_joIDs[c.joID];
 
 		if( jo )
 		{
-			DataFile curState( DataFile::JournalData );
-			jo->saveState( curState, curState.content() );
-			m_undoCheckPoints.push( CheckPoint( c.joID, curState ) );
+			m_changedIDs.insert( c.joID );
+			const CheckPoint cur = checkPoint( jo );
+			m_size += size( cur );
+			m_undoCheckPoints.push( cur );
 
 			bool prev = isJournalling();
 			setJournalling( false );
-			jo->restoreState( c.data.content().firstChildElement() );
+			restore( jo, c );
 			setJournalling( prev );
 			Engine::getSong()->setModified();
 			break;
@@ -115,24 +129,48 @@ bool ProjectJournal::canRedo() const
 
 void ProjectJournal::addJournalCheckPoint( JournallingObject *jo )
 {
+	m_changedIDs.insert( jo->id() );
 	if( isJournalling() )
 	{
+		for( const CheckPoint & c : m_redoCheckPoints )
+		{
+			m_size -= size( c );
+		}
 		m_redoCheckPoints.clear();
 
-		DataFile dataFile( DataFile::JournalData );
-		jo->saveState( dataFile, dataFile.content() );
-
-		m_undoCheckPoints.push( CheckPoint( jo->id(), dataFile ) );
-		if( m_undoCheckPoints.size() > MAX_UNDO_STATES )
+		CheckPoint c = checkPoint( jo );
+		c.time = m_clock.elapsed();
+		if( c.data.isEmpty() && !m_undoCheckPoints.isEmpty() )
 		{
-			m_undoCheckPoints.remove( 0, m_undoCheckPoints.size() - MAX_UNDO_STATES );
+			CheckPoint & last = m_undoCheckPoints.top();
+			if( last.joID == c.joID && last.data.isEmpty() &&
+				c.time - last.time < COALESCE_INTERVAL )
+			{
+				// undo goes back to before the first of the changes
+				last.time = c.time;
+				return;
+			}
 		}
+
+		m_size += size( c );
+		m_undoCheckPoints.push( c );
+		trim();
 	}
 }
 
 
 
 
+QSet<jo_id_t> ProjectJournal::takeChangedIDs()
+{
+	QSet<jo_id_t> changed;
+	changed.swap( m_changedIDs );
+	return changed;
+}
+
+
+
+
 jo_id_t ProjectJournal::allocID( JournallingObject * _obj )
 {
 	jo_id_t id;
@@ -178,6 +216,7 @@ void ProjectJournal::clearJournal()
 {
 	m_undoCheckPoints.clear();
 	m_redoCheckPoints.clear();
+	m_size = 0;
 
 	for( JoIdMap::Iterator it = m_joIDs.begin(); it != m_joIDs.end(); )
 	{
@@ -206,3 +245,68 @@ void ProjectJournal::stopAllJournalling()
 
 
 
+
+ProjectJournal::CheckPoint ProjectJournal::checkPoint( JournallingObject * jo ) const
+{
+	CheckPoint c( jo->id() );
+	// what AutomatableModel::saveSettings() would save as plain attribute
+	const AutomatableModel * model = dynamic_cast<AutomatableModel *>( jo );
+	if( model && !model->isScaleLogarithmic() && !model->isAutomatedOrControlled() )
+	{
+		c.value = model->value<float>();
+		return c;
+	}
+
+	DataFile dataFile( DataFile::JournalData );
+	jo->saveState( dataFile, dataFile.content() );
+	c.data = qCompress( BinaryDocument::encode( dataFile ), 1 );
+	return c;
+}
+
+
+
+
+void ProjectJournal::restore( JournallingObject * jo, const CheckPoint & c )
+{
+	if( c.data.isEmpty() )
+	{
+		// as AutomatableModel::loadSettings() does for plain attributes
+		if( AutomatableModel * model = dynamic_cast<AutomatableModel *>( jo ) )
+		{
+			model->setInitValue( c.value );
+		}
+		return;
+	}
+
+	QDomDocument doc;
+	if( BinaryDocument::decode( qUncompress( c.data ), doc ) )
+	{
+		jo->restoreState( doc.documentElement().firstChildElement( "journaldata" ).firstChildElement() );
+	}
+}
+
+
+
+
+qint64 ProjectJournal::size( const CheckPoint & c )
+{
+	return sizeof( CheckPoint ) + c.data.size();
+}
+
+
+
+
+void ProjectJournal::trim()
+{
+	const qint64 maxSize = qint64( ConfigManager::inst()->value( "app", "undomemory",
+		QString::number( DEFAULT_UNDO_MEMORY ) ).toInt() ) << 20;
+	int drop = 0;
+	// the last step is kept, however large
+	while( m_undoCheckPoints.size() - drop > MAX_UNDO_STATES ||
+		( m_size > maxSize && m_undoCheckPoints.size() - drop > 1 ) )
+	{
+		m_size -= size( m_undoCheckPoints[drop] );
+		++drop;
+	}
+	m_undoCheckPoints.remove( 0, drop );
+}
@@ -23,9 +23,15 @@
  */
 
 
+#include <cmath>
+
 #include <QFile>
 
 #include "ProjectRenderer.h"
+#include "denormals.h"
+#include "EngineCounters.h"
+#include "ExportCache.h"
+#include "lmms_math.h"
 #include "Song.h"
 #include "PerfLog.h"
 
@@ -84,31 +90,76 @@ ProjectRenderer::ProjectRenderer( const AudioEngine::qualitySettings & qualitySe
 	QThread( Engine::audioEngine() ),
 	m_fileDev( nullptr ),
 	m_qualitySettings( qualitySettings ),
+	m_minimumPreRoll( 0 ),
+	m_part( 0 ),
+	m_parts( 0 ),
+	m_seamParts( 0 ),
 	m_progress( 0 ),
-	m_abort( false )
+	m_abort( false ),
+	m_framesRendered( 0 )
 {
-	AudioFileDeviceInstantiaton audioEncoderFactory = fileEncodeDevices[exportFileFormat].m_getDevInst;
+	m_fileDev = createFileDevice( exportFileFormat, outputSettings, outputFilename );
+}
+
+
 
-	if (audioEncoderFactory)
+
+ProjectRenderer::~ProjectRenderer()
+{
+	// the first device is deleted by the audio engine
+	for( AudioFileDevice * copy : m_copies )
 	{
-		bool successful = false;
+		delete copy;
+	}
+}
 
-		m_fileDev = audioEncoderFactory(
-					outputFilename, outputSettings, DEFAULT_CHANNELS,
-					Engine::audioEngine(), successful );
-		if( !successful )
-		{
-			delete m_fileDev;
-			m_fileDev = nullptr;
-		}
+
+
+
+bool ProjectRenderer::addOutput( ExportFileFormats fileFormat,
+					const OutputSettings & outputSettings,
+					const QString & outputFilename )
+{
+	if( !isReady() )
+	{
+		return false;
+	}
+
+	// all outputs are fed from a single render
+	OutputSettings settings = outputSettings;
+	settings.setSampleRate( m_fileDev->sampleRate() );
+	AudioFileDevice * copy = createFileDevice( fileFormat, settings, outputFilename );
+	if( copy == nullptr )
+	{
+		return false;
 	}
+	m_copies.push_back( copy );
+	return true;
 }
 
 
 
 
-ProjectRenderer::~ProjectRenderer()
+AudioFileDevice * ProjectRenderer::createFileDevice( ExportFileFormats fileFormat,
+					const OutputSettings & outputSettings,
+					const QString & outputFilename )
 {
+	AudioFileDeviceInstantiaton audioEncoderFactory = fileEncodeDevices[fileFormat].m_getDevInst;
+	if( !audioEncoderFactory )
+	{
+		return nullptr;
+	}
+
+	bool successful = false;
+	AudioFileDevice * fileDev = audioEncoderFactory(
+				outputFilename, outputSettings, DEFAULT_CHANNELS,
+				Engine::audioEngine(), successful );
+	if( !successful )
+	{
+		delete fileDev;
+		return nullptr;
+	}
+	return fileDev;
 }
 
 
@@ -152,6 +203,7 @@ void ProjectRenderer::startProcessing()
 		// Have to do audio engine stuff with GUI-thread affinity in order to
 		// make slots connected to sampleRateChanged()-signals being called immediately.
 		Engine::audioEngine()->setAudioDevice( m_fileDev, m_qualitySettings, false, false );
+		Engine::getSong()->instantiateDeferredInstruments();
 
 		start(
 #ifndef LMMS_BUILD_WIN32
@@ -166,6 +218,7 @@ void ProjectRenderer::startProcessing()
 void ProjectRenderer::run()
 {
 	MemoryManager::ThreadGuard mmThreadGuard; Q_UNUSED(mmThreadGuard);
+	disable_denormals();
 #if 0
 #if defined(LMMS_BUILD_LINUX) || defined(LMMS_BUILD_FREEBSD)
 #ifdef LMMS_HAVE_SCHED_H
@@ -180,6 +233,22 @@ void ProjectRenderer::run()
 	PerfLogTimer perfLog("Project Render");
 
 	Engine::getSong()->startExport();
+
+	ExportCache cache( m_cacheDirectory );
+	cache.setMinimumPreRoll( m_minimumPreRoll );
+	const bool useCache = !m_cacheDirectory.isEmpty() &&
+				cache.plan( m_qualitySettings, m_fileDev->sampleRate() );
+	if( m_parts > 0 && !useCache )
+	{
+		// the process putting the parts together renders all of it
+		qWarning( "The export cache can't be used for this export, so it can't be split into parts" );
+		m_abort = true;
+	}
+	else if( !m_cacheDirectory.isEmpty() && !useCache )
+	{
+		qWarning( "The export cache can't be used for this export, rendering all of it" );
+	}
+
 	// Skip first empty buffer.
 	Engine::audioEngine()->nextBuffer();
 
@@ -188,16 +257,28 @@ void ProjectRenderer::run()
 	// Now start processing
 	Engine::audioEngine()->startProcessing(false);
 
+	const fpp_t framesPerPeriod = Engine::audioEngine()->framesPerPeriod();
+	m_framesRendered = 0;
+	m_renderTimer.start();
+
+	if( useCache )
+	{
+		renderWithCache( cache );
+	}
+
 	// Continually track and emit progress percentage to listeners.
-	while (!Engine::getSong()->isExportDone() && !m_abort)
+	while (!useCache && !Engine::getSong()->isExportDone() && !m_abort)
 	{
-		m_fileDev->processNextBuffer();
-		const int nprog = Engine::getSong()->getExportProgress();
-		if (m_progress != nprog)
-		{
-			m_progress = nprog;
-			emit progressChanged( m_progress );
-		}
+		// encoded and written on another thread meanwhile
+		m_fileDev->renderNextBuffer( m_copies );
+		m_framesRendered += framesPerPeriod;
+		setProgress( Engine::getSong()->getExportProgress() );
+	}
+
+	m_fileDev->finishEncoding( m_abort );
+	for( AudioFileDevice * copy : m_copies )
+	{
+		copy->finishEncoding( m_abort );
 	}
 
 	// Notify the audio engine of the end of processing.
@@ -207,11 +288,216 @@ void ProjectRenderer::run()
 
 	perfLog.end();
 
-	// If the user aborted export-process, the file has to be deleted.
-	const QString f = m_fileDev->outputFile();
+	// If the user aborted export-process, the files have to be deleted,
+	// like the file of a part, which only went into the cache.
+	if( m_abort || m_parts > 0 )
+	{
+		QFile( m_fileDev->outputFile() ).remove();
+		for( AudioFileDevice * copy : m_copies )
+		{
+			QFile( copy->outputFile() ).remove();
+		}
+	}
+	else if( useCache )
+	{
+		cache.removeUnused();
+	}
+}
+
+
+
+
+void ProjectRenderer::renderWithCache( ExportCache & cache )
+{
+	const std::vector<ExportCache::Segment> & segments = cache.segments();
+	const f_cnt_t totalFrames = segments.back().endFrame;
+
+	// a part of a distributed render only fills the cache
+	const bool partOnly = m_parts > 0;
+	const int firstSegment = partOnly ? cache.partBegin( m_part, m_parts ) : 0;
+	const int endSegment = partOnly ? cache.partBegin( m_part + 1, m_parts ) : static_cast<int>( segments.size() );
+
+	// the engine starts at the beginning
+	RenderCursor cursor;
+	cursor.period.resize( Engine::audioEngine()->framesPerPeriod() );
+
+	for( int i = firstSegment; i < endSegment; ++i )
+	{
+		const ExportCache::Segment & segment = segments[i];
+		if( m_abort )
+		{
+			return;
+		}
+
+		std::vector<surroundSampleFrame> frames;
+		if( segment.cached && !partOnly )
+		{
+			frames = cache.read( segment );
+		}
+
+		// render it if it isn't cached, or its file is broken
+		if( frames.empty() && !( segment.cached && partOnly ) )
+		{
+			if( !renderFrames( cursor, segment.preRoll, segment.preRollFrame,
+						segment.firstFrame, segment.endFrame, frames ) )
+			{
+				return;
+			}
+			cache.write( segment, frames );
+			EngineCounters::add( EngineCounters::Counter::ExportBarsRendered );
+		}
+		else
+		{
+			EngineCounters::add( EngineCounters::Counter::ExportBarsCached );
+		}
+
+		if( !partOnly )
+		{
+			m_fileDev->encodeFrames( frames.data(), frames.size(), m_copies );
+			m_framesRendered += frames.size();
+			setProgress( static_cast<int>( segment.endFrame * 100 / totalFrames ) );
+		}
+		else
+		{
+			m_framesRendered += segment.endFrame - segment.firstFrame;
+			setProgress( ( i + 1 - firstSegment ) * 100 / ( endSegment - firstSegment ) );
+		}
+	}
+
+	if( m_seamParts > 1 && !partOnly )
+	{
+		verifySeams( cache, cursor );
+	}
+}
+
+
+
+
+bool ProjectRenderer::renderFrames( RenderCursor & cursor, tick_t preRoll, f_cnt_t preRollFrame,
+					f_cnt_t first, f_cnt_t end, std::vector<surroundSampleFrame> & frames )
+{
+	// carrying on from where the engine is is cheaper than a jump, as long
+	// as the effects are still settled
+	if( cursor.nextFrame > first || cursor.nextFrame < preRollFrame )
+	{
+		ExportCache::seek( preRoll );
+		cursor.nextFrame = preRollFrame;
+		cursor.periodFrames = cursor.periodUsed = 0;
+	}
+
+	frames.reserve( end - first );
+	while( cursor.nextFrame < end && !m_abort )
+	{
+		if( cursor.periodUsed == cursor.periodFrames )
+		{
+			cursor.periodFrames = m_fileDev->renderPeriod( cursor.period.data() );
+			cursor.periodUsed = 0;
+			if( cursor.periodFrames == 0 )
+			{
+				break;
+			}
+		}
+
+		const f_cnt_t available = cursor.periodFrames - cursor.periodUsed;
+		if( cursor.nextFrame < first )
+		{
+			// pre-roll
+			const fpp_t skipped = std::min( available, first - cursor.nextFrame );
+			cursor.periodUsed += skipped;
+			cursor.nextFrame += skipped;
+			continue;
+		}
+
+		const fpp_t used = std::min( available, end - cursor.nextFrame );
+		const auto from = cursor.period.begin() + cursor.periodUsed;
+		frames.insert( frames.end(), from, from + used );
+		cursor.periodUsed += used;
+		cursor.nextFrame += used;
+	}
 	if( m_abort )
 	{
-		QFile( f ).remove();
+		return false;
+	}
+
+	// whatever the engine didn't render is silence
+	frames.resize( end - first, surroundSampleFrame{} );
+	return true;
+}
+
+
+
+
+void ProjectRenderer::verifySeams( ExportCache & cache, RenderCursor & cursor )
+{
+	const std::vector<ExportCache::Segment> & segments = cache.segments();
+	// what is compared on either side of a seam
+	const f_cnt_t seamFrames = Engine::audioEngine()->processingSampleRate() / 10;
+	// -60 dBFS, the seams are only expected to be bit exact if all
+	// instruments and effects are deterministic
+	const float tolerance = 0.001f;
+
+	int previous = 0;
+	for( int part = 1; part < m_seamParts && !m_abort; ++part )
+	{
+		const int i = cache.partBegin( part, m_seamParts );
+		if( i == previous || i >= static_cast<int>( segments.size() ) )
+		{
+			continue;
+		}
+		previous = i;
+
+		const ExportCache::Segment & before = segments[i - 1];
+		const ExportCache::Segment & after = segments[i];
+		const int bar = after.begin / Engine::getSong()->ticksPerBar() + 1;
+
+		// what went into the file: the end of one part and the start of
+		// the next one
+		std::vector<surroundSampleFrame> spliced = cache.read( before );
+		const std::vector<surroundSampleFrame> next = cache.read( after );
+		if( spliced.empty() || next.empty() )
+		{
+			qWarning( "Could not verify the seam at bar %d, it isn't in the export cache", bar );
+			continue;
+		}
+		spliced.insert( spliced.end(), next.begin(), next.end() );
+
+		// the reference plays through the seam, the way the part before
+		// it got there
+		const f_cnt_t first = std::max( before.firstFrame, after.firstFrame - seamFrames );
+		const f_cnt_t end = std::min( after.endFrame, after.firstFrame + seamFrames );
+		std::vector<surroundSampleFrame> reference;
+		if( !renderFrames( cursor, before.preRoll, before.preRollFrame, first, end, reference ) )
+		{
+			return;
+		}
+
+		float difference = 0;
+		for( f_cnt_t f = first; f < end; ++f )
+		{
+			for( ch_cnt_t ch = 0; ch < SURROUND_CHANNELS; ++ch )
+			{
+				difference = std::max( difference,
+					std::abs( reference[f - first][ch] - spliced[f - before.firstFrame][ch] ) );
+			}
+		}
+
+		if( difference > tolerance )
+		{
+			qWarning( "The parts of the render don't match at bar %d, they differ by up to %.1f dBFS",
+					bar, ampToDbfs( difference ) );
+		}
+	}
+}
+
+
+
+
+void ProjectRenderer::setProgress( int progress )
+{
+	if( m_progress != progress )
+	{
+		m_progress = progress;
+		emit progressChanged( m_progress );
 	}
 }
 
@@ -230,7 +516,7 @@ void ProjectRenderer::updateConsoleProgress()
 {
 	const int cols = 50;
 	static int rot = 0;
-	char buf[80];
+	char buf[120];
 	char prog[cols+1];
 
 	for( int i = 0; i < cols; ++i )
@@ -241,8 +527,14 @@ void ProjectRenderer::updateConsoleProgress()
 
 	const char * activity = (const char *) "|/-\\";
 	memset( buf, 0, sizeof( buf ) );
-	sprintf( buf, "\r|%s|    %3d%%   %c  ", prog, m_progress,
-							activity[rot] );
+	// rendered audio time relative to the time it took
+	const qint64 elapsed = m_renderTimer.isValid() ? m_renderTimer.elapsed() : 0;
+	const float speed = elapsed > 0 ?
+		m_framesRendered * 1000.0f / ( elapsed * Engine::audioEngine()->processingSampleRate() ) : 0.0f;
+
+	sprintf( buf, "\r|%s|    %3d%%   %c  %6.1fx realtime (%d frames/period)  ",
+				prog, m_progress, activity[rot], speed,
+				Engine::audioEngine()->framesPerPeriod() );
 	rot = ( rot+1 ) % 4;
 
 	fprintf( stderr, "%s", buf );
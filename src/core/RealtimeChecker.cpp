@@ -0,0 +1,395 @@
+/*
+ * RealtimeChecker.cpp - finds allocations, locks and file I/O on audio threads
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "RealtimeChecker.h"
+
+#ifdef LMMS_DEBUG_REALTIME
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/syscall.h>
+
+#include "ThreadableJob.h"
+
+
+namespace
+{
+
+constexpr int MaxFrames = 24;
+constexpr int MaxRecords = 4096;
+
+struct Record
+{
+	RealtimeChecker::Violation violation;
+	const ThreadableJob * job;
+	int frameCount;
+	void * frames[MaxFrames];
+	std::atomic_bool ready;
+} ;
+
+// filled lock-free by the audio threads, emptied by collect()
+Record s_records[MaxRecords];
+std::atomic_int s_recordCount( 0 );
+std::atomic_int s_droppedRecords( 0 );
+
+// plain thread locals, so accessing them never allocates
+thread_local int t_realtimeDepth = 0;
+thread_local bool t_inHook = false;
+thread_local const ThreadableJob * t_currentJob = nullptr;
+
+struct Location
+{
+	RealtimeChecker::Violation violation;
+	int count;
+	QVector<void *> frames;
+} ;
+
+struct JobReport
+{
+	int counts[static_cast<int>( RealtimeChecker::Violation::Count )] = {};
+	QHash<QByteArray, Location> locations;
+} ;
+
+// only touched by the audio engine thread in collect() and at the end
+QHash<QString, JobReport> s_report;
+
+
+struct WarmUp
+{
+	WarmUp()
+	{
+		// the first backtrace() loads libgcc, which allocates
+		void * frames[1];
+		backtrace( frames, 1 );
+	}
+} ;
+
+WarmUp s_warmUp;
+
+
+template<typename F>
+F nextSymbol( const char * name )
+{
+	return reinterpret_cast<F>( dlsym( RTLD_NEXT, name ) );
+}
+
+} // namespace
+
+
+
+
+void RealtimeChecker::enter()
+{
+	++t_realtimeDepth;
+}
+
+
+
+
+void RealtimeChecker::leave()
+{
+	--t_realtimeDepth;
+}
+
+
+
+
+void RealtimeChecker::setCurrentJob( const ThreadableJob * job )
+{
+	t_currentJob = job;
+}
+
+
+
+
+void RealtimeChecker::record( Violation violation )
+{
+	if( t_realtimeDepth <= 0 || t_inHook )
+	{
+		return;
+	}
+	t_inHook = true;
+
+	const int index = s_recordCount.fetch_add( 1, std::memory_order_relaxed );
+	if( index < MaxRecords )
+	{
+		Record & r = s_records[index];
+		r.violation = violation;
+		r.job = t_currentJob;
+		// skip record() and the hook
+		void * frames[MaxFrames + 2];
+		const int count = backtrace( frames, MaxFrames + 2 ) - 2;
+		r.frameCount = count > 0 ? count : 0;
+		memcpy( r.frames, frames + 2, r.frameCount * sizeof( void * ) );
+		r.ready.store( true, std::memory_order_release );
+	}
+	else
+	{
+		s_droppedRecords.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	t_inHook = false;
+}
+
+
+
+
+void RealtimeChecker::collect()
+{
+	// no worker processes jobs now, so nobody writes records
+	const int count = qMin( s_recordCount.load( std::memory_order_acquire ), MaxRecords );
+	if( count == 0 )
+	{
+		return;
+	}
+
+	Suspend suspend;
+	for( int i = 0; i < count; ++i )
+	{
+		Record & r = s_records[i];
+		if( !r.ready.load( std::memory_order_acquire ) )
+		{
+			continue;
+		}
+
+		const QString job = r.job ? r.job->jobName() : QString( "Audio engine" );
+		JobReport & report = s_report[job.isEmpty() ? QString( "Unnamed job" ) : job];
+		++report.counts[static_cast<int>( r.violation )];
+
+		QByteArray key( reinterpret_cast<const char *>( r.frames ),
+				r.frameCount * sizeof( void * ) );
+		key.append( static_cast<char>( r.violation ) );
+		auto location = report.locations.find( key );
+		if( location == report.locations.end() )
+		{
+			Location l { r.violation, 0, QVector<void *>() };
+			for( int f = 0; f < r.frameCount; ++f )
+			{
+				l.frames.push_back( r.frames[f] );
+			}
+			location = report.locations.insert( key, l );
+		}
+		++location->count;
+
+		r.ready.store( false, std::memory_order_relaxed );
+	}
+	s_recordCount.store( 0, std::memory_order_release );
+}
+
+
+
+
+void RealtimeChecker::writeReport()
+{
+	Suspend suspend;
+
+	QFile file( QString::fromLocal8Bit( qgetenv( "LMMS_REALTIME_REPORT" ) ) );
+	if( file.fileName().isEmpty() || !file.open( QFile::WriteOnly | QFile::Truncate ) )
+	{
+		file.open( stderr, QFile::WriteOnly );
+	}
+
+	static const char * names[] = { "allocations", "blocking locks", "file accesses" };
+
+	QByteArray out = "Realtime violations on audio threads\n";
+	if( s_report.isEmpty() )
+	{
+		out += "  none\n";
+	}
+	for( auto job = s_report.begin(); job != s_report.end(); ++job )
+	{
+		out += QString( "\n%1: %2 %3, %4 %5, %6 %7\n" ).arg( job.key() )
+			.arg( job->counts[0] ).arg( names[0] )
+			.arg( job->counts[1] ).arg( names[1] )
+			.arg( job->counts[2] ).arg( names[2] ).toUtf8();
+		for( const Location & l : job->locations )
+		{
+			out += QString( "  %1 %2 at\n" ).arg( l.count )
+				.arg( names[static_cast<int>( l.violation )] ).toUtf8();
+			char ** symbols = backtrace_symbols( l.frames.data(), l.frames.size() );
+			for( int f = 0; symbols && f < l.frames.size(); ++f )
+			{
+				out += "    ";
+				out += symbols[f];
+				out += '\n';
+			}
+			::free( symbols );
+		}
+	}
+	if( s_droppedRecords > 0 )
+	{
+		out += QString( "\n%1 violations were not recorded, the buffer was full\n" )
+			.arg( s_droppedRecords.load() ).toUtf8();
+	}
+	file.write( out );
+}
+
+
+
+
+// The hooks - they interpose the C library's functions, since they are
+// defined in the executable.
+extern "C"
+{
+
+void * __libc_malloc( size_t size );
+void * __libc_calloc( size_t count, size_t size );
+void * __libc_realloc( void * ptr, size_t size );
+void * __libc_memalign( size_t alignment, size_t size );
+void __libc_free( void * ptr );
+
+void * malloc( size_t size )
+{
+	RealtimeChecker::record( RealtimeChecker::Violation::Allocation );
+	return __libc_malloc( size );
+}
+
+void * calloc( size_t count, size_t size )
+{
+	RealtimeChecker::record( RealtimeChecker::Violation::Allocation );
+	return __libc_calloc( count, size );
+}
+
+void * realloc( void * ptr, size_t size )
+{
+	RealtimeChecker::record( RealtimeChecker::Violation::Allocation );
+	return __libc_realloc( ptr, size );
+}
+
+void free( void * ptr )
+{
+	if( ptr )
+	{
+		RealtimeChecker::record( RealtimeChecker::Violation::Allocation );
+	}
+	__libc_free( ptr );
+}
+
+int posix_memalign( void ** ptr, size_t alignment, size_t size )
+{
+	RealtimeChecker::record( RealtimeChecker::Violation::Allocation );
+	void * p = __libc_memalign( alignment, size );
+	if( !p )
+	{
+		return ENOMEM;
+	}
+	*ptr = p;
+	return 0;
+}
+
+void * aligned_alloc( size_t alignment, size_t size )
+{
+	RealtimeChecker::record( RealtimeChecker::Violation::Allocation );
+	return __libc_memalign( alignment, size );
+}
+
+int pthread_mutex_lock( pthread_mutex_t * mutex )
+{
+	static auto next = nextSymbol<int (*)( pthread_mutex_t * )>( "pthread_mutex_lock" );
+	RealtimeChecker::record( RealtimeChecker::Violation::Lock );
+	return next( mutex );
+}
+
+int pthread_rwlock_rdlock( pthread_rwlock_t * lock )
+{
+	static auto next = nextSymbol<int (*)( pthread_rwlock_t * )>( "pthread_rwlock_rdlock" );
+	RealtimeChecker::record( RealtimeChecker::Violation::Lock );
+	return next( lock );
+}
+
+int pthread_rwlock_wrlock( pthread_rwlock_t * lock )
+{
+	static auto next = nextSymbol<int (*)( pthread_rwlock_t * )>( "pthread_rwlock_wrlock" );
+	RealtimeChecker::record( RealtimeChecker::Violation::Lock );
+	return next( lock );
+}
+
+int sem_wait( sem_t * sem )
+{
+	static auto next = nextSymbol<int (*)( sem_t * )>( "sem_wait" );
+	RealtimeChecker::record( RealtimeChecker::Violation::Lock );
+	return next( sem );
+}
+
+// QMutex and QWaitCondition only enter the kernel through futex() when they
+// have to wait, so that's where contended Qt locks show up
+long syscall( long number, ... )
+{
+	static auto next = nextSymbol<long (*)( long, ... )>( "syscall" );
+
+	va_list args;
+	va_start( args, number );
+	long a[6];
+	for( long & arg : a )
+	{
+		arg = va_arg( args, long );
+	}
+	va_end( args );
+
+	if( number == SYS_futex && ( ( a[1] & FUTEX_CMD_MASK ) == FUTEX_WAIT ||
+				( a[1] & FUTEX_CMD_MASK ) == FUTEX_WAIT_BITSET ) )
+	{
+		RealtimeChecker::record( RealtimeChecker::Violation::Lock );
+	}
+	return next( number, a[0], a[1], a[2], a[3], a[4], a[5] );
+}
+
+int open( const char * path, int flags, ... )
+{
+	static auto next = nextSymbol<int (*)( const char *, int, ... )>( "open" );
+	va_list args;
+	va_start( args, flags );
+	const mode_t mode = ( flags & O_CREAT ) ? va_arg( args, mode_t ) : 0;
+	va_end( args );
+	RealtimeChecker::record( RealtimeChecker::Violation::FileAccess );
+	return next( path, flags, mode );
+}
+
+FILE * fopen( const char * path, const char * mode )
+{
+	static auto next = nextSymbol<FILE * (*)( const char *, const char * )>( "fopen" );
+	RealtimeChecker::record( RealtimeChecker::Violation::FileAccess );
+	return next( path, mode );
+}
+
+}
+
+#endif
@@ -31,10 +31,17 @@
 #include "BufferManager.h"
 #include "RemotePlugin.h"
 #include "AudioEngine.h"
+#include "ConfigManager.h"
 #include "Engine.h"
+#include "EngineCounters.h"
+#include "MixHelpers.h"
+#include "PlanarBuffer.h"
 
 #include <QDebug>
 #include <QDir>
+#include <QHash>
+
+#include <algorithm>
 
 #ifndef SYNC_WITH_SHM_FIFO
 #include <QtCore/QUuid>
@@ -43,6 +50,81 @@
 #endif
 
 
+#ifndef SYNC_WITH_SHM_FIFO
+namespace
+{
+
+//! Listens on a new socket, whose path is stored in @p socketFile
+int listenOnSocket( QString & socketFile )
+{
+	struct sockaddr_un sa;
+	sa.sun_family = AF_LOCAL;
+
+	socketFile = QDir::tempPath() + QDir::separator() +
+						QUuid::createUuid().toString();
+	auto path = socketFile.toUtf8();
+	size_t length = path.length();
+	if ( length >= sizeof sa.sun_path )
+	{
+		length = sizeof sa.sun_path - 1;
+		qWarning( "Socket path too long." );
+	}
+	memcpy(sa.sun_path, path.constData(), length );
+	sa.sun_path[length] = '\0';
+
+	const int server = socket( PF_LOCAL, SOCK_STREAM, 0 );
+	if ( server == -1 )
+	{
+		qWarning( "Unable to start the server." );
+	}
+	remove(path.constData());
+	int ret = bind( server, (struct sockaddr *) &sa, sizeof sa );
+	if ( ret == -1 || listen( server, 1 ) == -1 )
+	{
+		qWarning( "Unable to start the server." );
+	}
+	return server;
+}
+
+
+
+
+//! Waits for the process to connect to @p server
+int acceptConnection( int server )
+{
+	struct pollfd pollin;
+	pollin.fd = server;
+	pollin.events = POLLIN;
+
+	switch ( poll( &pollin, 1, 30000 ) )
+	{
+		case -1:
+			qWarning( "Unexpected poll error." );
+			break;
+
+		case 0:
+			qWarning( "Remote plugin did not connect." );
+			break;
+
+		default:
+		{
+			const int s = accept( server, nullptr, nullptr );
+			if ( s == -1 )
+			{
+				qWarning( "Unexpected socket error." );
+			}
+			return s;
+		}
+	}
+	return -1;
+}
+
+}
+#endif
+
+
+
+
 // simple helper thread monitoring our RemotePlugin - if process terminates
 // unexpectedly invalidate plugin so LMMS doesn't lock up
 ProcessWatcher::ProcessWatcher( RemotePlugin * _p ) :
@@ -75,6 +157,131 @@ void ProcessWatcher::run()
 
 
 
+#ifndef SYNC_WITH_SHM_FIFO
+std::shared_ptr<RemotePluginHost> RemotePluginHost::acquire( const QString & exec )
+{
+	static QMutex hostsMutex;
+	static QHash<QString, std::weak_ptr<RemotePluginHost>> hosts;
+
+	QMutexLocker locker( &hostsMutex );
+	std::shared_ptr<RemotePluginHost> host = hosts.value( exec ).lock();
+	if( !host || !host->processRunning() )
+	{
+		host.reset( new RemotePluginHost( exec ) );
+		hosts[exec] = host;
+	}
+	return host;
+}
+
+
+
+
+RemotePluginHost::RemotePluginHost( const QString & exec ) :
+	QThread(),
+	m_exec( exec ),
+	m_socket( -1 ),
+	m_quit( false )
+{
+	m_server = listenOnSocket( m_socketFile );
+
+	connect( &m_process, SIGNAL( finished( int, QProcess::ExitStatus ) ),
+		this, SLOT( quit() ), Qt::DirectConnection );
+
+	m_process.setProcessChannelMode( QProcess::ForwardedChannels );
+	m_process.setWorkingDirectory( QCoreApplication::applicationDirPath() );
+	// started on our thread for the same reason as by ProcessWatcher
+	m_process.moveToThread( this );
+	start( QThread::LowestPriority );
+
+	m_socket = acceptConnection( m_server );
+}
+
+
+
+
+RemotePluginHost::~RemotePluginHost()
+{
+	m_quit = true;
+	quit();
+	wait();
+
+	// the process quits once it has nothing more to host
+	if( m_socket != -1 )
+	{
+		close( m_socket );
+	}
+	m_process.waitForFinished( 1000 );
+	if( m_process.state() != QProcess::NotRunning )
+	{
+		m_process.terminate();
+		m_process.kill();
+	}
+
+	if ( close( m_server ) == -1)
+	{
+		qWarning( "Error freeing resources." );
+	}
+	remove( m_socketFile.toUtf8().constData() );
+}
+
+
+
+
+bool RemotePluginHost::addInstance( RemotePlugin * plugin, const QString & socketFile )
+{
+	if( m_socket == -1 || !processRunning() )
+	{
+		return false;
+	}
+
+	const QByteArray path = socketFile.toUtf8();
+	const int32_t length = path.size();
+	if( ::write( m_socket, &length, sizeof( length ) ) != sizeof( length ) ||
+		::write( m_socket, path.constData(), length ) != length )
+	{
+		return false;
+	}
+
+	QMutexLocker locker( &m_instancesMutex );
+	m_instances.push_back( plugin );
+	return true;
+}
+
+
+
+
+void RemotePluginHost::removeInstance( RemotePlugin * plugin )
+{
+	QMutexLocker locker( &m_instancesMutex );
+	m_instances.erase( std::remove( m_instances.begin(), m_instances.end(), plugin ),
+				m_instances.end() );
+}
+
+
+
+
+void RemotePluginHost::run()
+{
+	m_process.start( m_exec, QStringList() << RemotePluginHostArgument << m_socketFile );
+	exec();
+	m_process.moveToThread( thread() );
+	if( !m_quit )
+	{
+		fprintf( stderr,
+				"remote plugin host died! invalidating its plugins now.\n" );
+
+		QMutexLocker locker( &m_instancesMutex );
+		for( RemotePlugin * plugin : m_instances )
+		{
+			plugin->invalidate();
+		}
+	}
+}
+#endif
+
+
+
+
 RemotePlugin::RemotePlugin() :
 	QObject(),
 #ifdef SYNC_WITH_SHM_FIFO
@@ -95,34 +302,15 @@ RemotePlugin::RemotePlugin() :
 	m_shm( nullptr ),
 	m_inputCount( DEFAULT_CHANNELS ),
 	m_outputCount( DEFAULT_CHANNELS )
+#ifdef SYNC_WITH_FUTEX
+	, m_syncShmID( -1 ),
+	m_sharedProcessing( false ),
+	m_clientMessages( 0 ),
+	m_pipelined( ConfigManager::inst()->value( "ui", "pipelineremoteplugins" ).toInt() )
+#endif
 {
 #ifndef SYNC_WITH_SHM_FIFO
-	struct sockaddr_un sa;
-	sa.sun_family = AF_LOCAL;
-
-	m_socketFile = QDir::tempPath() + QDir::separator() +
-						QUuid::createUuid().toString();
-	auto path = m_socketFile.toUtf8();
-	size_t length = path.length();
-	if ( length >= sizeof sa.sun_path )
-	{
-		length = sizeof sa.sun_path - 1;
-		qWarning( "Socket path too long." );
-	}
-	memcpy(sa.sun_path, path.constData(), length );
-	sa.sun_path[length] = '\0';
-
-	m_server = socket( PF_LOCAL, SOCK_STREAM, 0 );
-	if ( m_server == -1 )
-	{
-		qWarning( "Unable to start the server." );
-	}
-	remove(path.constData());
-	int ret = bind( m_server, (struct sockaddr *) &sa, sizeof sa );
-	if ( ret == -1 || listen( m_server, 1 ) == -1 )
-	{
-		qWarning( "Unable to start the server." );
-	}
+	m_server = listenOnSocket( m_socketFile );
 #endif
 
 	connect( &m_process, SIGNAL( finished( int, QProcess::ExitStatus ) ),
@@ -150,11 +338,17 @@ RemotePlugin::~RemotePlugin()
 			lock();
 			sendMessage( IdQuit );
 
-			m_process.waitForFinished( 1000 );
-			if( m_process.state() != QProcess::NotRunning )
+#ifndef SYNC_WITH_SHM_FIFO
+			// the host quits the process along with its last instance
+			if( !m_host )
+#endif
 			{
-				m_process.terminate();
-				m_process.kill();
+				m_process.waitForFinished( 1000 );
+				if( m_process.state() != QProcess::NotRunning )
+				{
+					m_process.terminate();
+					m_process.kill();
+				}
 			}
 			unlock();
 		}
@@ -165,7 +359,17 @@ RemotePlugin::~RemotePlugin()
 #endif
 	}
 
+#ifdef SYNC_WITH_FUTEX
+	destroyProcessingSync();
+#endif
+
 #ifndef SYNC_WITH_SHM_FIFO
+	if( m_host )
+	{
+		m_host->removeInstance( this );
+		m_host.reset();
+	}
+
 	if ( close( m_server ) == -1)
 	{
 		qWarning( "Error freeing resources." );
@@ -178,7 +382,7 @@ RemotePlugin::~RemotePlugin()
 
 
 bool RemotePlugin::init(const QString &pluginExecutable,
-							bool waitForInitDoneMsg , QStringList extraArgs)
+							bool waitForInitDoneMsg , QStringList extraArgs, bool shareProcess)
 {
 	lock();
 	if( m_failed )
@@ -229,42 +433,46 @@ bool RemotePlugin::init(const QString &pluginExecutable,
 #endif
 	args << extraArgs;
 #ifndef DEBUG_REMOTE_PLUGIN
-	m_process.setProcessChannelMode( QProcess::ForwardedChannels );
-	m_process.setWorkingDirectory( QCoreApplication::applicationDirPath() );
-	m_exec = exec;
-	m_args = args;
-	// we start the process on the watcher thread to work around QTBUG-8819
-	m_process.moveToThread( &m_watcher );
-	m_watcher.start( QThread::LowestPriority );
+#ifndef SYNC_WITH_SHM_FIFO
+	// the arguments are the process's, so only instances without any
+	// can share one
+	if( m_host )
+	{
+		m_host->removeInstance( this );
+		m_host.reset();
+	}
+	if( shareProcess && extraArgs.isEmpty() &&
+		ConfigManager::inst()->value( "ui", "shareremoteprocesses" ).toInt() )
+	{
+		m_host = RemotePluginHost::acquire( exec );
+		if( !m_host->addInstance( this, m_socketFile ) )
+		{
+			m_host.reset();
+		}
+	}
+	if( !m_host )
+#endif
+	{
+		m_process.setProcessChannelMode( QProcess::ForwardedChannels );
+		m_process.setWorkingDirectory( QCoreApplication::applicationDirPath() );
+		m_exec = exec;
+		m_args = args;
+		// we start the process on the watcher thread to work around QTBUG-8819
+		m_process.moveToThread( &m_watcher );
+		m_watcher.start( QThread::LowestPriority );
+	}
 #else
 	qDebug() << exec << args;
 #endif
 
 #ifndef SYNC_WITH_SHM_FIFO
-	struct pollfd pollin;
-	pollin.fd = m_server;
-	pollin.events = POLLIN;
-
-	switch ( poll( &pollin, 1, 30000 ) )
-	{
-		case -1:
-			qWarning( "Unexpected poll error." );
-			break;
-
-		case 0:
-			qWarning( "Remote plugin did not connect." );
-			break;
-
-		default:
-			m_socket = accept( m_server, nullptr, nullptr );
-			if ( m_socket == -1 )
-			{
-				qWarning( "Unexpected socket error." );
-			}
-	}
+	m_socket = acceptConnection( m_server );
 #endif
 
 	resizeSharedProcessingMemory();
+#ifdef SYNC_WITH_FUTEX
+	enableSharedProcessing();
+#endif
 
 	if( waitForInitDoneMsg )
 	{
@@ -310,30 +518,59 @@ bool RemotePlugin::process( const sampleFrame * _in_buf, sampleFrame * _out_buf
 		return false;
 	}
 
-	memset( m_shm, 0, m_shmSize );
+	// the period submitted now, and the one whose output is taken - the
+	// one submitted with the last call if the plugin is pipelined
+	uint32_t request = 0;
+	uint32_t result = 0;
+#ifdef SYNC_WITH_FUTEX
+	if( m_sharedProcessing )
+	{
+		request = m_sync->request.load( std::memory_order_relaxed ) + 1;
+		result = request + 1 - m_sync->buffers;
+		// the part written now may still be processed if the output of
+		// a period wasn't asked for
+		waitForProcessingDone( request - m_sync->buffers );
+	}
+#endif
+	float * buffer = m_shm + ( request % processingBuffers() ) *
+				( m_shmSize / processingBuffers() / sizeof( float ) );
 
 	ch_cnt_t inputs = qMin<ch_cnt_t>( m_inputCount, DEFAULT_CHANNELS );
 
+	// only the inputs which aren't overwritten below have to be cleared,
+	// the plugin writes all of its outputs
+	const size_t inputSamples = _in_buf != nullptr && inputs > 0 &&
+		( m_splitChannels || inputs == DEFAULT_CHANNELS ) ? inputs * frames : 0;
+	const size_t inputRegion = static_cast<size_t>( m_inputCount ) * frames;
+	if( inputRegion > inputSamples )
+	{
+		memset( buffer + inputSamples, 0, ( inputRegion - inputSamples ) * sizeof( float ) );
+	}
+
 	if( _in_buf != nullptr && inputs > 0 )
 	{
-		if( m_splitChannels )
+		if( m_splitChannels && inputs == DEFAULT_CHANNELS )
+		{
+			MixHelpers::deinterleave( PlanarBuffer( buffer, frames ), _in_buf );
+		}
+		else if( m_splitChannels )
 		{
 			for( ch_cnt_t ch = 0; ch < inputs; ++ch )
 			{
 				for( fpp_t frame = 0; frame < frames; ++frame )
 				{
-					m_shm[ch * frames + frame] =
+					buffer[ch * frames + frame] =
 							_in_buf[frame][ch];
 				}
 			}
 		}
 		else if( inputs == DEFAULT_CHANNELS )
 		{
-			memcpy( m_shm, _in_buf, frames * BYTES_PER_FRAME );
+			memcpy( buffer, _in_buf, frames * BYTES_PER_FRAME );
 		}
 		else
 		{
-			sampleFrame * o = (sampleFrame *) m_shm;
+			sampleFrame * o = (sampleFrame *) buffer;
 			for( ch_cnt_t ch = 0; ch < inputs; ++ch )
 			{
 				for( fpp_t frame = 0; frame < frames; ++frame )
@@ -344,39 +581,81 @@ bool RemotePlugin::process( const sampleFrame * _in_buf, sampleFrame * _out_buf
 		}
 	}
 
+	const qint64 submitted = AudioEngineProfiler::now();
 	lock();
-	sendMessage( IdStartProcessing );
-
-	if( m_failed || _out_buf == nullptr || m_outputCount == 0 )
+#ifdef SYNC_WITH_FUTEX
+	if( m_sharedProcessing )
 	{
-		unlock();
-		return false;
+		// the messages sent so far are the plugin's before it processes
+		m_sync->requestMessages[request % 2].store(
+			m_sync->hostMessages.load( std::memory_order_acquire ), std::memory_order_relaxed );
+		m_sync->request.store( request, std::memory_order_release );
+		m_sync->hostSignals.fetch_add( 1 );
+		RemoteSync::wake( m_sync->hostSignals, m_sync->clientWaiting );
+
+		if( m_failed || _out_buf == nullptr || m_outputCount == 0 )
+		{
+			unlock();
+			return false;
+		}
+
+		waitForProcessingDone( result );
+
+		// what the plugin told us while processing, as waitForMessage()
+		// would have done
+		const uint32_t clientMessages = m_sync->clientMessages.load( std::memory_order_acquire );
+		if( clientMessages != m_clientMessages )
+		{
+			m_clientMessages = clientMessages;
+			fetchAndProcessAllMessages();
+		}
 	}
+	else
+#endif
+	{
+		sendMessage( IdStartProcessing );
+
+		if( m_failed || _out_buf == nullptr || m_outputCount == 0 )
+		{
+			unlock();
+			return false;
+		}
 
-	waitForMessage( IdProcessingDone );
+		waitForMessage( IdProcessingDone );
+	}
 	unlock();
+	EngineCounters::addRoundTrip( AudioEngineProfiler::now() - submitted );
+
+	// the messages may have resized the memory
+	const float * shm = m_shm + ( result % processingBuffers() ) *
+				( m_shmSize / processingBuffers() / sizeof( float ) );
 
 	const ch_cnt_t outputs = qMin<ch_cnt_t>( m_outputCount,
 							DEFAULT_CHANNELS );
-	if( m_splitChannels )
+	if( m_splitChannels && outputs == DEFAULT_CHANNELS )
+	{
+		MixHelpers::interleave( _out_buf, PlanarBuffer(
+				const_cast<float *>( shm ) + m_inputCount * frames, frames ) );
+	}
+	else if( m_splitChannels )
 	{
 		for( ch_cnt_t ch = 0; ch < outputs; ++ch )
 		{
 			for( fpp_t frame = 0; frame < frames; ++frame )
 			{
-				_out_buf[frame][ch] = m_shm[( m_inputCount+ch )*
+				_out_buf[frame][ch] = shm[( m_inputCount+ch )*
 								frames + frame];
 			}
 		}
 	}
 	else if( outputs == DEFAULT_CHANNELS )
 	{
-		memcpy( _out_buf, m_shm + m_inputCount * frames,
+		memcpy( _out_buf, shm + m_inputCount * frames,
 						frames * BYTES_PER_FRAME );
 	}
 	else
 	{
-		sampleFrame * o = (sampleFrame *) ( m_shm +
+		const sampleFrame * o = (const sampleFrame *) ( shm +
 							m_inputCount*frames );
 		// clear buffer, if plugin didn't fill up both channels
 		BufferManager::clear( _out_buf, frames );
@@ -430,9 +709,17 @@ void RemotePlugin::hideUI()
 
 void RemotePlugin::resizeSharedProcessingMemory()
 {
-	const size_t s = ( m_inputCount+m_outputCount ) * Engine::audioEngine()->framesPerPeriod() * sizeof( float );
+	const size_t s = ( m_inputCount+m_outputCount ) * Engine::audioEngine()->framesPerPeriod() *
+						sizeof( float ) * processingBuffers();
 	if( m_shm != nullptr )
 	{
+#ifdef SYNC_WITH_FUTEX
+		// a pipelined plugin may still work on the memory
+		if( m_sharedProcessing )
+		{
+			waitForProcessingDone( m_sync->request.load( std::memory_order_relaxed ) );
+		}
+#endif
 #ifdef USE_QT_SHMEM
 		m_shmObj.detach();
 #else
@@ -466,6 +753,93 @@ void RemotePlugin::resizeSharedProcessingMemory()
 
 
 
+#ifdef SYNC_WITH_FUTEX
+void RemotePlugin::enableSharedProcessing()
+{
+	destroyProcessingSync();
+
+	static int sync_key = 0;
+	while( ( m_syncShmID = shmget( ++sync_key, sizeof( RemoteProcessingSync ),
+					IPC_CREAT | IPC_EXCL | 0600 ) ) == -1 )
+	{
+	}
+
+	void * sync = shmat( m_syncShmID, 0, 0 );
+	if( sync == (void *) -1 )
+	{
+		shmctl( m_syncShmID, IPC_RMID, nullptr );
+		m_syncShmID = -1;
+		return;
+	}
+
+	// the plugin answers once it waits on it, until then the periods are
+	// started with messages
+	memset( sync, 0, sizeof( RemoteProcessingSync ) );
+	static_cast<RemoteProcessingSync *>( sync )->buffers = processingBuffers();
+	setProcessingSync( static_cast<RemoteProcessingSync *>( sync ),
+			message( IdEnableSharedProcessing ).addInt( sync_key ) );
+}
+
+
+
+
+void RemotePlugin::waitForProcessingDone( uint32_t request )
+{
+	// the watcher invalidates us if the plugin dies meanwhile
+	uint32_t done;
+	while( static_cast<int32_t>( request -
+			( done = m_sync->done.load( std::memory_order_acquire ) ) ) > 0 &&
+		!isInvalid() )
+	{
+		RemoteSync::wait( m_sync->done, done, m_sync->hostWaiting, 100 );
+	}
+}
+
+
+
+
+void RemotePlugin::destroyProcessingSync()
+{
+	m_sharedProcessing = false;
+	if( m_sync != nullptr )
+	{
+		shmdt( m_sync );
+		m_sync = nullptr;
+		shmctl( m_syncShmID, IPC_RMID, nullptr );
+		m_syncShmID = -1;
+	}
+}
+#endif
+
+
+
+
+int RemotePlugin::processingBuffers() const
+{
+#ifdef SYNC_WITH_FUTEX
+	return m_pipelined ? 2 : 1;
+#else
+	return 1;
+#endif
+}
+
+
+
+
+f_cnt_t RemotePlugin::latency() const
+{
+#ifdef SYNC_WITH_FUTEX
+	if( m_sharedProcessing && m_pipelined )
+	{
+		return Engine::audioEngine()->framesPerPeriod();
+	}
+#endif
+	return 0;
+}
+
+
+
+
 void RemotePlugin::processFinished( int exitCode,
 					QProcess::ExitStatus exitStatus )
 {
@@ -536,6 +910,13 @@ bool RemotePlugin::processMessage( const message & _m )
 						_m.getString( 0 ).c_str() );
 			break;
 
+#ifdef SYNC_WITH_FUTEX
+		case IdEnableSharedProcessing:
+			m_clientMessages = m_sync->clientMessages.load( std::memory_order_acquire );
+			m_sharedProcessing = true;
+			break;
+#endif
+
 		case IdProcessingDone:
 		case IdQuit:
 		default:
@@ -0,0 +1,207 @@
+/*
+ * RenderBenchmark.cpp - renders a project repeatedly and reports timings
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "RenderBenchmark.h"
+
+#include <algorithm>
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+
+#include "AudioDevice.h"
+#include "denormals.h"
+#include "Engine.h"
+#include "MemoryManager.h"
+#include "MemoryReport.h"
+#include "Song.h"
+#include "lmmsconfig.h"
+
+#ifndef LMMS_BUILD_WIN32
+#include <sys/resource.h>
+#endif
+
+
+namespace
+{
+
+const char * const StageNames[] = { "playHandles", "graph", "masterMix", "modelChanges" };
+
+
+//! The periods fastest to slowest, for percentiles
+qint64 percentile( const std::vector<qint64> & sorted, double fraction )
+{
+	if( sorted.empty() )
+	{
+		return 0;
+	}
+	return sorted[static_cast<size_t>( fraction * ( sorted.size() - 1 ) + 0.5 )];
+}
+
+
+//! The most memory the process ever used, in KiB, or -1 if not known
+qint64 peakMemory()
+{
+#ifndef LMMS_BUILD_WIN32
+	struct rusage usage;
+	if( getrusage( RUSAGE_SELF, &usage ) == 0 )
+	{
+#ifdef LMMS_BUILD_APPLE
+		// bytes instead of KiB there
+		return usage.ru_maxrss / 1024;
+#else
+		return usage.ru_maxrss;
+#endif
+	}
+#endif
+	return -1;
+}
+
+}
+
+
+
+
+RenderBenchmark::RenderBenchmark( const AudioEngine::qualitySettings & qualitySettings, int runs ) :
+	QThread( Engine::audioEngine() ),
+	m_qualitySettings( qualitySettings ),
+	m_runs( runs ),
+	m_sampleRate( 0 ),
+	m_framesPerPeriod( 0 )
+{
+	Engine::audioEngine()->storeAudioDevice();
+}
+
+
+
+
+RenderBenchmark::~RenderBenchmark()
+{
+	wait();
+	Engine::audioEngine()->restoreAudioDevice();  // Also deletes our device.
+}
+
+
+
+
+void RenderBenchmark::startProcessing()
+{
+	// the base class writes nothing anywhere, so only the engine is measured
+	AudioEngine * audioEngine = Engine::audioEngine();
+	audioEngine->setAudioDevice( new AudioDevice( DEFAULT_CHANNELS, audioEngine ),
+					m_qualitySettings, false, false );
+	Engine::getSong()->instantiateDeferredInstruments();
+
+	start(
+#ifndef LMMS_BUILD_WIN32
+		QThread::HighPriority
+#endif
+			);
+}
+
+
+
+
+QJsonObject RenderBenchmark::report() const
+{
+	QJsonArray runs;
+	for( const Run & result : m_results )
+	{
+		std::vector<qint64> sorted = result.periods;
+		std::sort( sorted.begin(), sorted.end() );
+
+		QJsonObject stages;
+		for( int i = 0; i < NumStages; ++i )
+		{
+			stages[StageNames[i]] = QJsonObject{
+				{ "totalMs", result.stages[i] / 1000.0 },
+				{ "share", result.time > 0 ? result.stages[i] / static_cast<double>( result.time * 1000 ) : 0.0 } };
+		}
+
+		const double audioSeconds = result.frames / static_cast<double>( m_sampleRate );
+		runs.append( QJsonObject{
+			{ "timeMs", result.time },
+			{ "audioSeconds", audioSeconds },
+			{ "realtimeFactor", result.time > 0 ? audioSeconds * 1000 / result.time : 0.0 },
+			{ "periods", static_cast<qint64>( sorted.size() ) },
+			{ "periodUs", QJsonObject{
+				{ "p50", percentile( sorted, 0.5 ) },
+				{ "p99", percentile( sorted, 0.99 ) },
+				{ "max", sorted.empty() ? 0 : sorted.back() } } },
+			{ "stages", stages } } );
+	}
+
+	return QJsonObject{
+		{ "sampleRate", static_cast<qint64>( m_sampleRate ) },
+		{ "framesPerPeriod", static_cast<qint64>( m_framesPerPeriod ) },
+		{ "threads", Engine::audioEngine()->jobThreads() },
+		{ "peakMemoryKiB", peakMemory() },
+		{ "memory", MemoryReport::collect().toJson() },
+		{ "runs", runs } };
+}
+
+
+
+
+void RenderBenchmark::run()
+{
+	MemoryManager::ThreadGuard mmThreadGuard; Q_UNUSED(mmThreadGuard);
+	disable_denormals();
+
+	AudioEngine * audioEngine = Engine::audioEngine();
+	const AudioEngineProfiler & profiler = audioEngine->profiler();
+	Song * song = Engine::getSong();
+	m_sampleRate = audioEngine->processingSampleRate();
+	m_framesPerPeriod = audioEngine->framesPerPeriod();
+
+	for( int i = 0; i < m_runs; ++i )
+	{
+		Run result;
+
+		song->startExport();
+		// Skip first empty buffer, as ProjectRenderer does.
+		audioEngine->nextBuffer();
+		audioEngine->startProcessing( false );
+
+		QElapsedTimer timer;
+		timer.start();
+		while( !song->isExportDone() )
+		{
+			audioEngine->nextBuffer();
+			result.frames += m_framesPerPeriod;
+			result.periods.push_back( profiler.periodTime() );
+			for( int s = 0; s < NumStages; ++s )
+			{
+				result.stages[s] += profiler.stageTime( static_cast<AudioEngineProfiler::Stage>( s ) );
+			}
+		}
+		result.time = timer.elapsed();
+
+		audioEngine->stopProcessing();
+		song->stopExport();
+
+		fprintf( stderr, "Run %d of %d: %.1fx realtime\n", i + 1, m_runs,
+			result.time > 0 ? result.frames * 1000.0 / ( result.time * m_sampleRate ) : 0.0 );
+		m_results.push_back( std::move( result ) );
+	}
+}
@@ -22,6 +22,7 @@
  *
  */
 
+#include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
 
@@ -40,7 +41,14 @@ RenderManager::RenderManager(
 	m_oldQualitySettings( Engine::audioEngine()->currentQualitySettings() ),
 	m_outputSettings(outputSettings),
 	m_format(fmt),
-	m_outputPath(outputPath)
+	m_outputPath(outputPath),
+	m_minimumPreRoll(0),
+	m_maxWorkers(0),
+	m_jobsDone(0),
+	m_jobsFailed(0),
+	m_part(-1),
+	m_parts(0),
+	m_verifySeams(false)
 {
 	Engine::audioEngine()->storeAudioDevice();
 }
@@ -51,6 +59,12 @@ RenderManager::~RenderManager()
 	Engine::audioEngine()->changeQuality( m_oldQualitySettings );
 }
 
+void RenderManager::addOutput( ProjectRenderer::ExportFileFormats fmt,
+		const OutputSettings & outputSettings, const QString & outputPath )
+{
+	m_moreOutputs.push_back( { fmt, outputSettings, outputPath } );
+}
+
 void RenderManager::abortProcessing()
 {
 	if ( m_activeRenderer ) {
@@ -58,6 +72,15 @@ void RenderManager::abortProcessing()
 				this, SLOT( renderNextTrack() ) );
 		m_activeRenderer->abortProcessing();
 	}
+	m_pendingJobs.clear();
+	for( auto it = m_workers.begin(); it != m_workers.end(); ++it )
+	{
+		disconnect( it.key(), nullptr, this, nullptr );
+		it.key()->kill();
+		it.key()->waitForFinished();
+		it.key()->deleteLater();
+	}
+	m_workers.clear();
 	restoreMutedState();
 }
 
@@ -85,14 +108,14 @@ void RenderManager::renderNextTrack()
 		}
 
 		// for multi-render, prefix each output file with a different number
-		int trackNum = m_tracksToRender.size() + 1;
+		int trackNum = m_unmuted.indexOf( renderTrack ) + 1;
 
 		render( pathForTrack(renderTrack, trackNum) );
 	}
 }
 
-// Render the song into individual tracks
-void RenderManager::renderTracks()
+// Find the tracks to export separately
+void RenderManager::collectUnmutedTracks()
 {
 	const TrackContainer::TrackList & tl = Engine::getSong()->tracks();
 
@@ -123,27 +146,186 @@ void RenderManager::renderTracks()
 			m_unmuted.push_back(tk);
 		}
 	}
+}
+
+// Render the song into individual tracks
+void RenderManager::renderTracks()
+{
+	collectUnmutedTracks();
 
 	// copy the list of unmuted tracks into our rendering queue.
 	// we need to remember which tracks were unmuted to restore state at the end.
-	m_tracksToRender = m_unmuted;
+	for( int i = 0; i < m_unmuted.size(); ++i )
+	{
+		if( m_stemSelection.isEmpty() || m_stemSelection.contains( i + 1 ) )
+		{
+			m_tracksToRender.push_back( m_unmuted[i] );
+		}
+	}
 
 	renderNextTrack();
 }
 
+void RenderManager::setStemSelection( const QVector<int> & stems )
+{
+	m_stemSelection = stems;
+}
+
+// Render the song into individual tracks, using worker processes
+void RenderManager::renderTracksInParallel( int jobs, const QStringList & workerArgs )
+{
+	collectUnmutedTracks();
+
+	for( int i = 0; i < m_unmuted.size(); ++i )
+	{
+		m_pendingJobs.push_back( i + 1 );
+	}
+	// the workers decide on their own what to mute
+	m_unmuted.clear();
+
+	m_workerArgs = workerArgs;
+	m_maxWorkers = qMax( 1, jobs );
+	m_jobsDone = 0;
+	m_jobsFailed = 0;
+
+	if( m_pendingJobs.isEmpty() )
+	{
+		emit finished();
+		return;
+	}
+	startWorkers();
+}
+
+// Render the song into a single file, rendering parts of it in worker processes
+void RenderManager::renderProjectInParts( int parts, const QStringList & workerArgs )
+{
+	m_parts = qMax( 1, parts );
+	// the workers hand their parts over through the cache
+	if( m_cacheDirectory.isEmpty() )
+	{
+		m_partsDirectory = std::make_unique<QTemporaryDir>( QDir::temp().filePath( "lmms-parts-XXXXXX" ) );
+		m_cacheDirectory = m_partsDirectory->path();
+	}
+
+	for( int i = 0; i < m_parts; ++i )
+	{
+		m_pendingJobs.push_back( i + 1 );
+	}
+	m_workerArgs = QStringList( workerArgs ) << "--cache" << m_cacheDirectory
+						<< "--parts" << QString::number( m_parts );
+	m_maxWorkers = m_parts;
+	m_jobsDone = 0;
+	m_jobsFailed = 0;
+	startWorkers();
+}
+
+// Start worker processes until as many as allowed are running
+void RenderManager::startWorkers()
+{
+	const int totalNum = m_jobsDone + m_workers.size() + m_pendingJobs.size();
+	while( m_workers.size() < m_maxWorkers && !m_pendingJobs.isEmpty() )
+	{
+		const int job = m_pendingJobs.takeFirst();
+
+		QProcess * worker = new QProcess( this );
+		worker->setProgram( QCoreApplication::applicationFilePath() );
+		worker->setArguments( QStringList( m_workerArgs )
+				<< ( m_parts > 0 ? "--part" : "--stems" ) << QString::number( job ) );
+		worker->setStandardOutputFile( QProcess::nullDevice() );
+		worker->setStandardErrorFile( QProcess::nullDevice() );
+		connect( worker, SIGNAL( finished( int, QProcess::ExitStatus ) ),
+				this, SLOT( workerFinished( int, QProcess::ExitStatus ) ) );
+
+		m_workers.insert( worker, job );
+		worker->start();
+		if( !worker->waitForStarted() )
+		{
+			disconnect( worker, nullptr, this, nullptr );
+			workerDone( worker, false );
+			continue;
+		}
+	}
+
+	if( m_workers.isEmpty() && m_pendingJobs.isEmpty() )
+	{
+		if( m_parts > 0 )
+		{
+			if( m_jobsFailed > 0 )
+			{
+				qWarning( "Failed to render %d of %d parts, rendering them here", m_jobsFailed, totalNum );
+			}
+			// splice the parts together, from now on the progress is
+			// the one of the renderer
+			m_maxWorkers = 0;
+			render( m_outputPath, m_moreOutputs, m_cacheDirectory );
+			return;
+		}
+		if( m_jobsFailed > 0 )
+		{
+			qWarning( "Failed to render %d of %d tracks", m_jobsFailed, totalNum );
+		}
+		emit finished();
+	}
+}
+
+void RenderManager::workerFinished( int exitCode, QProcess::ExitStatus exitStatus )
+{
+	QProcess * worker = qobject_cast<QProcess *>( sender() );
+	if( worker && m_workers.contains( worker ) )
+	{
+		workerDone( worker, exitStatus == QProcess::NormalExit && exitCode == 0 );
+		startWorkers();
+	}
+}
+
+void RenderManager::workerDone( QProcess * worker, bool successful )
+{
+	const int job = m_workers.take( worker );
+	worker->deleteLater();
+
+	if( !successful )
+	{
+		qWarning( m_parts > 0 ? "Rendering part %d failed" : "Rendering track %d failed", job );
+		++m_jobsFailed;
+	}
+	++m_jobsDone;
+
+	const int totalNum = m_jobsDone + m_workers.size() + m_pendingJobs.size();
+	emit progressChanged( m_jobsDone * 100 / totalNum );
+}
+
 // Render the song into a single track
 void RenderManager::renderProject()
 {
-	render( m_outputPath );
+	render( m_outputPath, m_moreOutputs, m_cacheDirectory );
 }
 
-void RenderManager::render(QString outputPath)
+void RenderManager::render(QString outputPath, const std::vector<Output> & moreOutputs,
+				const QString & cacheDirectory)
 {
 	m_activeRenderer = std::make_unique<ProjectRenderer>(
 			m_qualitySettings,
 			m_outputSettings,
 			m_format,
 			outputPath);
+	m_activeRenderer->setCacheDirectory( cacheDirectory );
+	m_activeRenderer->setMinimumPreRoll( m_minimumPreRoll );
+	if( m_part >= 0 )
+	{
+		m_activeRenderer->setPart( m_part, m_parts );
+	}
+	else if( m_verifySeams )
+	{
+		m_activeRenderer->setVerifySeams( m_parts );
+	}
+
+	for( const Output & output : moreOutputs )
+	{
+		if( !m_activeRenderer->addOutput( output.format, output.outputSettings, output.path ) )
+		{
+			qWarning( "Could not write to %s", qPrintable( output.path ) );
+		}
+	}
 
 	if( m_activeRenderer->isReady() )
 	{
@@ -188,11 +370,20 @@ QString RenderManager::pathForTrack(const Track *track, int num)
 
 void RenderManager::updateConsoleProgress()
 {
-	if ( m_activeRenderer )
+	if ( m_maxWorkers > 0 )
+	{
+		// parallel export - count finished jobs, the workers are silent
+		const int totalNum = m_jobsDone + m_workers.size() + m_pendingJobs.size();
+		fprintf( stderr, "\rRendering %s: %d/%d done, %d running   ",
+				m_parts > 0 ? "parts" : "tracks",
+				m_jobsDone, totalNum, static_cast<int>( m_workers.size() ) );
+		fflush( stderr );
+	}
+	else if ( m_activeRenderer )
 	{
 		m_activeRenderer->updateConsoleProgress();
 
-		int totalNum = m_unmuted.size();
+		int totalNum = m_stemSelection.isEmpty() ? m_unmuted.size() : m_stemSelection.size();
 		if ( totalNum > 0 )
 		{
 			// we are rendering multiple tracks, append a track counter to the output
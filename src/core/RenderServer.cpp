@@ -0,0 +1,175 @@
+/*
+ * RenderServer.cpp - renders projects dropped into a queue directory
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "RenderServer.h"
+
+#include <QFileInfo>
+
+#include "Engine.h"
+#include "RenderManager.h"
+#include "Song.h"
+
+
+static const char * DoneDir = "done";
+static const char * FailedDir = "failed";
+static const char * QuitFile = "quit";
+
+
+RenderServer::RenderServer( const QString & queuePath,
+		const AudioEngine::qualitySettings & qualitySettings,
+		const OutputSettings & outputSettings,
+		ProjectRenderer::ExportFileFormats fmt,
+		bool renderLoop ) :
+	m_queue( queuePath ),
+	m_qualitySettings( qualitySettings ),
+	m_outputSettings( outputSettings ),
+	m_format( fmt ),
+	m_renderLoop( renderLoop ),
+	m_renderManager( nullptr ),
+	m_loadTime( 0 ),
+	m_jobsDone( 0 ),
+	m_jobsFailed( 0 )
+{
+	connect( &m_pollTimer, SIGNAL( timeout() ), this, SLOT( checkQueue() ) );
+}
+
+
+
+
+RenderServer::~RenderServer()
+{
+	delete m_renderManager;
+}
+
+
+
+
+bool RenderServer::start()
+{
+	if( !m_queue.exists() || !m_queue.mkpath( DoneDir ) || !m_queue.mkpath( FailedDir ) )
+	{
+		fprintf( stderr, "Can't use %s as render queue\n",
+				m_queue.absolutePath().toUtf8().constData() );
+		return false;
+	}
+
+	printf( "Waiting for projects in %s\n", m_queue.absolutePath().toUtf8().constData() );
+	m_pollTimer.start( 500 );
+	return true;
+}
+
+
+
+
+void RenderServer::checkQueue()
+{
+	if( m_renderManager )
+	{
+		return;
+	}
+
+	if( m_queue.exists( QuitFile ) )
+	{
+		m_queue.remove( QuitFile );
+		m_pollTimer.stop();
+		printf( "Stopping after %d jobs (%d failed)\n", m_jobsDone, m_jobsFailed );
+		emit finished();
+		return;
+	}
+
+	// oldest project first
+	const QFileInfoList jobs = m_queue.entryInfoList(
+			QStringList() << "*.mmp" << "*.mmpz" << "*.mmpb",
+			QDir::Files | QDir::Readable, QDir::Time | QDir::Reversed );
+	if( jobs.isEmpty() )
+	{
+		return;
+	}
+
+	m_jobFile = jobs.first().absoluteFilePath();
+	printf( "Loading %s...\n", jobs.first().fileName().toUtf8().constData() );
+	m_jobTimer.start();
+
+	Song * song = Engine::getSong();
+	song->loadProject( m_jobFile );
+	if( song->isEmpty() )
+	{
+		printf( "The project is empty, skipping it\n" );
+		finishJob( FailedDir );
+		return;
+	}
+	song->setExportLoop( m_renderLoop );
+	m_loadTime = m_jobTimer.elapsed();
+
+	const QString output = m_queue.filePath( QString( DoneDir ) + "/" +
+			jobs.first().completeBaseName() +
+			ProjectRenderer::getFileExtensionFromFormat( m_format ) );
+
+	m_renderManager = new RenderManager( m_qualitySettings, m_outputSettings, m_format, output );
+	connect( m_renderManager, SIGNAL( finished() ), this, SLOT( jobFinished() ) );
+	connect( &m_progressTimer, SIGNAL( timeout() ),
+			m_renderManager, SLOT( updateConsoleProgress() ) );
+	m_progressTimer.start( 200 );
+	m_renderManager->renderProject();
+}
+
+
+
+
+void RenderServer::jobFinished()
+{
+	m_progressTimer.stop();
+	m_renderManager->deleteLater();
+	m_renderManager = nullptr;
+
+	const qint64 total = m_jobTimer.elapsed();
+	printf( "\nDone in %.2f s (loading %.2f s, rendering %.2f s)\n",
+			total / 1000.0, m_loadTime / 1000.0, ( total - m_loadTime ) / 1000.0 );
+
+	finishJob( DoneDir );
+}
+
+
+
+
+void RenderServer::finishJob( const QString & dir )
+{
+	if( dir == FailedDir )
+	{
+		++m_jobsFailed;
+	}
+	++m_jobsDone;
+
+	// move the project out of the queue, replacing an older one
+	const QFileInfo job( m_jobFile );
+	const QString target = m_queue.filePath( dir + "/" + job.fileName() );
+	QFile::remove( target );
+	if( !QFile::rename( m_jobFile, target ) )
+	{
+		// don't render it again and again
+		QFile::remove( m_jobFile );
+	}
+	m_jobFile.clear();
+}
+
@@ -0,0 +1,136 @@
+/*
+ * Resampler.cpp - interpolating resampler for sample playback
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "interpolation.h"
+
+
+namespace
+{
+
+// positions are computed for a block at a time, so the interpolation loops
+// only read precomputed indices and weights
+constexpr fpp_t BlockSize = 64;
+
+} // namespace
+
+
+
+
+Resampler::Resampler( Mode mode ) :
+	m_mode( mode )
+{
+	reset();
+}
+
+
+
+
+void Resampler::reset()
+{
+	m_position = 0;
+	m_previous = { 0, 0 };
+}
+
+
+
+
+f_cnt_t Resampler::process( const sampleFrame * in, sampleFrame * out,
+						fpp_t frames, double step )
+{
+	switch( m_mode )
+	{
+		case Mode::ZeroOrderHold:
+			render<Mode::ZeroOrderHold>( in, out, frames, step );
+			break;
+		case Mode::Linear:
+			render<Mode::Linear>( in, out, frames, step );
+			break;
+		case Mode::CubicHermite:
+			render<Mode::CubicHermite>( in, out, frames, step );
+			break;
+	}
+
+	const double end = m_position + frames * step;
+	const f_cnt_t used = static_cast<f_cnt_t>( end );
+	m_position = end - used;
+	if( used > 0 )
+	{
+		m_previous = in[used - 1];
+	}
+	return used;
+}
+
+
+
+
+template<Resampler::Mode M>
+void Resampler::render( const sampleFrame * in, sampleFrame * out,
+					fpp_t frames, double step ) const
+{
+	f_cnt_t index[BlockSize];
+	float weight[BlockSize];
+
+	for( fpp_t start = 0; start < frames; start += BlockSize )
+	{
+		const fpp_t count = std::min<fpp_t>( BlockSize, frames - start );
+
+		// the position is computed from the block start instead of being
+		// accumulated, so rounding errors don't add up over a note
+		const double base = m_position + start * step;
+		for( fpp_t i = 0; i < count; ++i )
+		{
+			const double position = base + i * step;
+			index[i] = static_cast<f_cnt_t>( position );
+			weight[i] = static_cast<float>( position - index[i] );
+		}
+
+		sampleFrame * dst = out + start;
+		for( fpp_t i = 0; i < count; ++i )
+		{
+			const f_cnt_t n = index[i];
+			for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+			{
+				if( M == Mode::ZeroOrderHold )
+				{
+					dst[i][ch] = in[n][ch];
+				}
+				else if( M == Mode::Linear )
+				{
+					dst[i][ch] = linearInterpolate( in[n][ch], in[n + 1][ch], weight[i] );
+				}
+				else
+				{
+					const float before = n > 0 ? in[n - 1][ch] : m_previous[ch];
+					dst[i][ch] = hermiteInterpolate( before, in[n][ch],
+							in[n + 1][ch], in[n + 2][ch], weight[i] );
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,136 @@
+/*
+ * ResamplerPool.cpp - recycled libsamplerate states
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ResamplerPool.h"
+
+#include <QtGlobal>
+
+#include "lmms_basics.h"
+
+
+namespace
+{
+
+// States prepared per mode. Sinc states need 100 kB to 1 MB each, so only
+// the mode AudioFileProcessor uses gets some before they're asked for. The
+// linear ones are small, GigPlayer takes one for each sample of a note.
+const int Prepared[] = { 0, 8, 0, 0, 16 };
+
+SRC_STATE * create(int mode)
+{
+	int error;
+	SRC_STATE * state = src_new(mode, DEFAULT_CHANNELS, &error);
+	if (state == nullptr)
+	{
+		qWarning("ResamplerPool: src_new() failed: %s", src_strerror(error));
+	}
+	return state;
+}
+
+}
+
+
+
+
+ResamplerPool & ResamplerPool::inst()
+{
+	static ResamplerPool pool;
+	return pool;
+}
+
+
+
+
+ResamplerPool::ResamplerPool()
+{
+	for (int mode = 0; mode < Modes; ++mode)
+	{
+		for (int i = 0; i < Capacity; ++i)
+		{
+			m_states[mode][i].store(i < Prepared[mode] ? create(mode) : nullptr,
+				std::memory_order_relaxed);
+		}
+	}
+}
+
+
+
+
+ResamplerPool::~ResamplerPool()
+{
+	for (auto & states : m_states)
+	{
+		for (auto & state : states)
+		{
+			if (SRC_STATE * s = state.load(std::memory_order_relaxed))
+			{
+				src_delete(s);
+			}
+		}
+	}
+}
+
+
+
+
+SRC_STATE * ResamplerPool::take(int mode)
+{
+	if (mode >= 0 && mode < Modes)
+	{
+		for (auto & slot : m_states[mode])
+		{
+			// cheap test before claiming the slot
+			if (slot.load(std::memory_order_relaxed) == nullptr) { continue; }
+			if (SRC_STATE * state = slot.exchange(nullptr, std::memory_order_acquire))
+			{
+				return state;
+			}
+		}
+	}
+	return create(mode);
+}
+
+
+
+
+void ResamplerPool::give(int mode, SRC_STATE * state)
+{
+	if (state == nullptr) { return; }
+
+	src_reset(state);
+	if (mode >= 0 && mode < Modes)
+	{
+		for (auto & slot : m_states[mode])
+		{
+			SRC_STATE * empty = nullptr;
+			if (slot.load(std::memory_order_relaxed) == nullptr &&
+				slot.compare_exchange_strong(empty, state, std::memory_order_release, std::memory_order_relaxed))
+			{
+				return;
+			}
+		}
+	}
+	// more states in use than the pool holds
+	src_delete(state);
+}
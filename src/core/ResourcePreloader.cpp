@@ -0,0 +1,174 @@
+/*
+ * ResourcePreloader.cpp - reads the files of a project ahead of its plugins
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "ResourcePreloader.h"
+
+#include <QDomElement>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QThread>
+
+#include <algorithm>
+#include <vector>
+
+#include "DataFileStream.h"
+#include "PathUtil.h"
+
+
+namespace
+{
+
+// reading more than what fits into the file cache would only push out
+// what was read first
+const qint64 PreloadBytesMax = qint64(2) << 30;
+const qint64 ChunkSize = 1 << 20;
+// the disk is the limit, not the CPU
+const int ThreadsMax = 4;
+
+// the elements of samples, which are decoded in the background anyway
+const char * const SampleElements[] = { "sampletco", "audiofileprocessor" };
+// the attributes files are referred to by
+const char * const FileAttributes[] = { "src", "plugin" };
+
+
+class PreloadJob : public QRunnable
+{
+public:
+	PreloadJob(const QString & file, const std::atomic<bool> & cancelled) :
+		m_file(file),
+		m_cancelled(cancelled)
+	{
+	}
+
+	void run() override
+	{
+		QFile file(m_file);
+		if (!file.open(QIODevice::ReadOnly))
+		{
+			return;
+		}
+		std::vector<char> buffer(ChunkSize);
+		while (!m_cancelled && file.read(buffer.data(), ChunkSize) > 0)
+		{
+		}
+	}
+
+private:
+	const QString m_file;
+	const std::atomic<bool> & m_cancelled;
+} ;
+
+}
+
+
+
+
+ResourcePreloader::ResourcePreloader() :
+	m_bytes(0),
+	m_cancelled(false)
+{
+	m_pool.setMaxThreadCount(std::min(ThreadsMax, QThread::idealThreadCount()));
+}
+
+
+
+
+ResourcePreloader::~ResourcePreloader()
+{
+	m_cancelled = true;
+	m_pool.clear();
+	m_pool.waitForDone();
+}
+
+
+
+
+void ResourcePreloader::add(const QDomElement & element)
+{
+	QXmlStreamAttributes attributes;
+	for (const char * name : FileAttributes)
+	{
+		if (element.hasAttribute(name))
+		{
+			attributes.append(name, element.attribute(name));
+		}
+	}
+	add(element.tagName(), attributes);
+
+	for (QDomElement child = element.firstChildElement(); !child.isNull();
+		child = child.nextSiblingElement())
+	{
+		add(child);
+	}
+}
+
+
+
+
+void ResourcePreloader::add(const DataFileStream & stream)
+{
+	stream.forEachElement([this](const QString & name, const QXmlStreamAttributes & attributes)
+	{
+		add(name, attributes);
+	});
+}
+
+
+
+
+void ResourcePreloader::add(const QString & tagName, const QXmlStreamAttributes & attributes)
+{
+	for (const char * element : SampleElements)
+	{
+		if (tagName == element)
+		{
+			return;
+		}
+	}
+	for (const char * name : FileAttributes)
+	{
+		const QString value = attributes.value(name).toString();
+		if (!value.isEmpty())
+		{
+			addFile(PathUtil::toAbsolute(value));
+		}
+	}
+}
+
+
+
+
+void ResourcePreloader::addFile(const QString & file)
+{
+	const QFileInfo info(file);
+	if (m_files.contains(file) || !info.isFile() || m_bytes + info.size() > PreloadBytesMax)
+	{
+		return;
+	}
+	m_files.insert(file);
+	m_bytes += info.size();
+	// the files of the first tracks are needed first
+	m_pool.start(new PreloadJob(file, m_cancelled));
+}
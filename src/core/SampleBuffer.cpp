@@ -28,10 +28,16 @@
 #include <algorithm>
 
 #include <QBuffer>
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QMessageBox>
 #include <QPainter>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThreadPool>
 
 
 #include <sndfile.h>
@@ -52,23 +58,129 @@
 
 #include "AudioEngine.h"
 #include "base64.h"
+#include "CompactSamples.h"
 #include "ConfigManager.h"
 #include "DrumSynth.h"
 #include "endian_handling.h"
 #include "Engine.h"
 #include "GuiApplication.h"
 #include "lmms_constants.h"
+#include "MixHelpers.h"
 #include "PathUtil.h"
+#include "ResamplerPool.h"
+#include "SampleCache.h"
+#include "SampleStream.h"
+#include "WaveformOverview.h"
 
 #include "FileDialog.h"
+#include "Song.h"
+
+
+namespace
+{
+
+// File size and sample length limits
+const int fileSizeMax = 300; // MB
+const int sampleLengthMax = 90; // Minutes
+
+// DrumSynth patches are a few lines of text, anything larger isn't one
+const qint64 drumSynthFileMax = 64 * 1024;
+// how much of the DrumSynth renders are kept in memory before dropping them
+const size_t drumSynthCacheMax = 32 * 1024 * 1024;
+
+//! The DrumSynth renders of the patches loaded, by the hash of the patch
+//! and the sample rate, so that a patch used from several files or
+//! dropped by SampleCache doesn't have to be synthesized again. Only used
+//! with decodeSampleDS()'s lock held.
+QHash<QByteArray, std::vector<float>> s_drumSynthRenders;
+size_t s_drumSynthRenderBytes = 0;
+
+//! Where the renders are kept across sessions, empty if they aren't
+QString drumSynthCacheDir()
+{
+	if (!ConfigManager::inst()->value("app", "drumsynthcache").toInt())
+	{
+		return QString();
+	}
+	return ConfigManager::inst()->workingDir() + "drumsynth/";
+}
+
+//! One thread, the tables are generated with Oscillator's FFT buffers anyway
+QThreadPool & userWaveTablePool()
+{
+	static QThreadPool * pool = []
+	{
+		auto p = new QThreadPool;
+		p->setMaxThreadCount(1);
+		return p;
+	}();
+	return *pool;
+}
+
+}
+
+
+std::vector<SampleBuffer *> SampleBuffer::s_backgroundDecoding;
+std::vector<SampleBuffer *> SampleBuffer::s_userWaveTables;
+
+
+struct SampleBuffer::UserWaveTableRequest
+{
+	QMutex mutex;
+	// nullptr once the buffer is gone or its frames changed again
+	SampleBuffer * buffer = nullptr;
+	std::unique_ptr<OscillatorConstants::waveform_t> table;
+};
+
+
+class UserWaveTableJob : public QRunnable
+{
+public:
+	UserWaveTableJob(std::shared_ptr<SampleBuffer::UserWaveTableRequest> request,
+		std::vector<sample_t> wave) :
+		m_request(std::move(request)),
+		m_wave(std::move(wave))
+	{
+	}
+
+	void run() override
+	{
+		auto table = std::make_unique<OscillatorConstants::waveform_t>();
+		Oscillator::generateAntiAliasUserWaveTable(m_wave.data(), *table);
+
+		QMutexLocker lock(&m_request->mutex);
+		if (m_request->buffer != nullptr)
+		{
+			m_request->table = std::move(table);
+			// Qt drops the call if the buffer is deleted before it's run
+			QMetaObject::invokeMethod(m_request->buffer, "userWaveTableFinished", Qt::QueuedConnection);
+		}
+	}
+
+private:
+	std::shared_ptr<SampleBuffer::UserWaveTableRequest> m_request;
+	std::vector<sample_t> m_wave;
+};
 
 
 SampleBuffer::SampleBuffer() :
-	m_userAntiAliasWaveTable(nullptr),
+	SampleBuffer(Unconnected{})
+{
+	connect(Engine::audioEngine(), SIGNAL(sampleRateChanged()), this, SLOT(sampleRateChanged()));
+	connect(SampleCache::inst(), SIGNAL(decodingFinished()), this, SLOT(backgroundDecodingFinished()));
+	update();
+}
+
+
+
+
+SampleBuffer::SampleBuffer(Unconnected) :
 	m_audioFile(""),
 	m_origData(nullptr),
 	m_origFrames(0),
 	m_data(nullptr),
+	m_compact(nullptr),
+	m_sharedData(nullptr),
 	m_frames(0),
 	m_startFrame(0),
 	m_endFrame(0),
@@ -77,11 +189,16 @@ SampleBuffer::SampleBuffer() :
 	m_amplification(1.0f),
 	m_reversed(false),
 	m_frequency(DefaultBaseFreq),
-	m_sampleRate(audioEngineSampleRate())
+	m_sampleRate(audioEngineSampleRate()),
+	m_streamingAllowed(false),
+	m_backgroundDecodingAllowed(false),
+	m_backgroundDecoding(false),
+	m_resampling(false),
+	m_compactStorageAllowed(false),
+	m_sourceBits(0),
+	m_sourceChannels(DEFAULT_CHANNELS),
+	m_userAntiAliasWaveTable(nullptr)
 {
-
-	connect(Engine::audioEngine(), SIGNAL(sampleRateChanged()), this, SLOT(sampleRateChanged()));
-	update();
 }
 
 
@@ -141,7 +258,25 @@ SampleBuffer::SampleBuffer(const SampleBuffer& orig)
 	m_origFrames = orig.m_origFrames;
 	m_origData = (m_origFrames > 0) ? MM_ALLOC<sampleFrame>( m_origFrames) : nullptr;
 	m_frames = orig.m_frames;
-	m_data = (m_frames > 0) ? MM_ALLOC<sampleFrame>( m_frames) : nullptr;
+	// a streamed sample only holds a single silent frame
+	const f_cnt_t dataFrames = orig.m_stream ? 1 : m_frames;
+	// cached data is never modified, so copies share it until they edit it
+	m_sharedData = orig.m_sharedData ? sharedObject::ref(orig.m_sharedData) : nullptr;
+	if (m_sharedData)
+	{
+		m_data = m_sharedData->frames();
+		m_compact = m_sharedData->compact();
+	}
+	else if (orig.m_compact)
+	{
+		m_data = nullptr;
+		m_compact = new CompactSamples(*orig.m_compact);
+	}
+	else
+	{
+		m_data = (dataFrames > 0) ? MM_ALLOC<sampleFrame>( dataFrames) : nullptr;
+		m_compact = nullptr;
+	}
 	m_startFrame = orig.m_startFrame;
 	m_endFrame = orig.m_endFrame;
 	m_loopStartFrame = orig.m_loopStartFrame;
@@ -150,15 +285,47 @@ SampleBuffer::SampleBuffer(const SampleBuffer& orig)
 	m_reversed = orig.m_reversed;
 	m_frequency = orig.m_frequency;
 	m_sampleRate = orig.m_sampleRate;
+	m_streamingAllowed = orig.m_streamingAllowed;
+	m_backgroundDecodingAllowed = orig.m_backgroundDecodingAllowed;
+	m_backgroundDecoding = false;
+	m_resampling = false;
+	m_compactStorageAllowed = orig.m_compactStorageAllowed;
+	m_sourceBits = orig.m_sourceBits;
+	m_sourceChannels = orig.m_sourceChannels;
+	m_userAntiAliasWaveTable = nullptr;
 
 	//Deep copy m_origData and m_data from original
 	const auto origFrameBytes = m_origFrames * BYTES_PER_FRAME;
-	const auto frameBytes = m_frames * BYTES_PER_FRAME;
+	const auto frameBytes = dataFrames * BYTES_PER_FRAME;
 	if (orig.m_origData != nullptr && origFrameBytes > 0)
 		{ memcpy(m_origData, orig.m_origData, origFrameBytes); }
-	if (orig.m_data != nullptr && frameBytes > 0)
+	if (!m_sharedData && orig.m_data != nullptr && frameBytes > 0)
 		{ memcpy(m_data, orig.m_data, frameBytes); }
 
+	// the copy gets a stream of its own, as it may play somewhere else
+	if (orig.m_stream && !(m_stream = SampleStream::open(PathUtil::toAbsolute(m_audioFile))))
+	{
+		m_frames = 1;
+		m_loopStartFrame = m_startFrame = 0;
+		m_loopEndFrame = m_endFrame = 1;
+	}
+
+	// a copy of a buffer still decoding in the background waits for it
+	if (orig.m_backgroundDecoding)
+	{
+		const SampleCache::Key key = fileKey();
+		SampleCache::waitForDecoding(key);
+		if ((m_sharedData = SampleCache::find(key)))
+		{
+			MM_FREE(m_data);
+			m_data = m_sharedData->frames();
+			m_compact = m_sharedData->compact();
+			m_frames = m_sharedData->count();
+			m_loopStartFrame = m_startFrame = 0;
+			m_loopEndFrame = m_endFrame = m_frames;
+		}
+	}
+
 	orig.m_varLock.unlock();
 }
 
@@ -185,6 +352,9 @@ void swap(SampleBuffer& first, SampleBuffer& second) noexcept
 	first.m_audioFile.swap(second.m_audioFile);
 	swap(first.m_origData, second.m_origData);
 	swap(first.m_data, second.m_data);
+	swap(first.m_compact, second.m_compact);
+	swap(first.m_sharedData, second.m_sharedData);
+	swap(first.m_overview, second.m_overview);
 	swap(first.m_origFrames, second.m_origFrames);
 	swap(first.m_frames, second.m_frames);
 	swap(first.m_startFrame, second.m_startFrame);
@@ -195,6 +365,11 @@ void swap(SampleBuffer& first, SampleBuffer& second) noexcept
 	swap(first.m_frequency, second.m_frequency);
 	swap(first.m_reversed, second.m_reversed);
 	swap(first.m_sampleRate, second.m_sampleRate);
+	swap(first.m_streamingAllowed, second.m_streamingAllowed);
+	swap(first.m_stream, second.m_stream);
+	swap(first.m_compactStorageAllowed, second.m_compactStorageAllowed);
+	swap(first.m_sourceBits, second.m_sourceBits);
+	swap(first.m_sourceChannels, second.m_sourceChannels);
 
 	// Unlock again
 	first.m_varLock.unlock();
@@ -207,6 +382,11 @@ void swap(SampleBuffer& first, SampleBuffer& second) noexcept
 SampleBuffer& SampleBuffer::operator=(SampleBuffer that)
 {
 	swap(*this, that);
+	// the frames may be of a buffer still resampling
+	if (m_sharedData && m_sampleRate != audioEngineSampleRate())
+	{
+		sampleRateChanged();
+	}
 	return *this;
 }
 
@@ -215,14 +395,37 @@ SampleBuffer& SampleBuffer::operator=(SampleBuffer that)
 
 SampleBuffer::~SampleBuffer()
 {
+	stopBackgroundDecoding();
+	stopUserWaveTable();
+	delete m_userAntiAliasWaveTable.load();
 	MM_FREE(m_origData);
-	MM_FREE(m_data);
+	releaseData();
 }
 
 
 
 void SampleBuffer::sampleRateChanged()
 {
+	// cached frames of a file are decoded again at the new rate on
+	// SampleCache's thread pool, unless they are cached at that rate
+	// already. The old ones keep playing at their rate until then.
+	if (m_sharedData && !m_backgroundDecoding)
+	{
+		const SampleCache::Key key = fileKey();
+		if (key.isValid())
+		{
+			SampleCache::decodeInBackground(key, &SampleBuffer::decodeFile);
+		}
+		if (SampleCache::isDecoding(key))
+		{
+			if (!m_resampling)
+			{
+				m_resampling = true;
+				s_backgroundDecoding.push_back(this);
+			}
+			return;
+		}
+	}
 	update(true);
 }
 
@@ -232,22 +435,179 @@ sample_rate_t SampleBuffer::audioEngineSampleRate()
 }
 
 
+void SampleBuffer::releaseData()
+{
+	if (m_sharedData)
+	{
+		SampleCache::release(m_sharedData);
+		m_sharedData = nullptr;
+	}
+	else
+	{
+		MM_FREE(m_data);
+		delete m_compact;
+	}
+	m_data = nullptr;
+	m_compact = nullptr;
+	m_overview.reset();
+}
+
+
+void SampleBuffer::detachData()
+{
+	if (m_sharedData && m_compact)
+	{
+		m_compact = new CompactSamples(*m_compact);
+		SampleCache::release(m_sharedData);
+		m_sharedData = nullptr;
+	}
+	else if (m_sharedData)
+	{
+		sampleFrame * data = MM_ALLOC<sampleFrame>( m_frames);
+		memcpy(data, m_data, m_frames * BYTES_PER_FRAME);
+		SampleCache::release(m_sharedData);
+		m_sharedData = nullptr;
+		m_data = data;
+	}
+}
+
+
+const WaveformOverview & SampleBuffer::overview()
+{
+	if (m_sharedData) { return m_sharedData->overview(); }
+	if (!m_overview)
+	{
+		m_overview.reset(m_compact ? new WaveformOverview(*m_compact) : new WaveformOverview(m_data, m_frames));
+	}
+	return *m_overview;
+}
+
+
+size_t SampleBuffer::bytes() const
+{
+	QReadLocker lock(&m_varLock);
+	size_t bytes = m_origFrames * BYTES_PER_FRAME;
+	if (m_sharedData) { bytes += m_sharedData->bytes(); }
+	else if (m_compact) { bytes += m_compact->bytes(); }
+	else if (m_data) { bytes += m_frames * BYTES_PER_FRAME; }
+	if (m_userAntiAliasWaveTable) { bytes += sizeof(OscillatorConstants::waveform_t); }
+	return bytes;
+}
+
+
+SampleCache::Key SampleBuffer::fileKey() const
+{
+	return SampleCache::keyOf(PathUtil::toAbsolute(m_audioFile), audioEngineSampleRate(), compactStorage());
+}
+
+
+bool SampleBuffer::compactStorage() const
+{
+	return m_compactStorageAllowed &&
+		ConfigManager::inst()->value("audioengine", "compactsamples", "1").toInt();
+}
+
+
+void SampleBuffer::compactData()
+{
+	if (!m_compactStorageAllowed || m_sourceBits == 0 || m_sourceBits > 24)
+	{
+		return;
+	}
+
+	const CompactSamples::Format format = m_sourceBits > 16
+		? CompactSamples::Format::Int24
+		: CompactSamples::Format::Int16;
+	// resampled frames are quantized again, at the file's bit depth
+	m_compact = new CompactSamples(m_data, m_frames, format, m_sourceChannels);
+	MM_FREE(m_data);
+	m_data = nullptr;
+}
+
+
+const sampleFrame * SampleBuffer::floatFrames(std::vector<sampleFrame> & storage) const
+{
+	if (!m_compact) { return m_data; }
+	storage.resize(m_frames);
+	m_compact->read(storage.data(), 0, m_frames);
+	return storage.data();
+}
+
+
+void SampleBuffer::copyFrames(sampleFrame * dst, f_cnt_t index, f_cnt_t count) const
+{
+	if (m_compact) { m_compact->read(dst, index, count); }
+	else { memcpy(dst, m_data + index, count * BYTES_PER_FRAME); }
+}
+
+
+void SampleBuffer::copyFramesBackwards(sampleFrame * dst, f_cnt_t index, f_cnt_t count) const
+{
+	if (m_compact)
+	{
+		m_compact->readBackwards(dst, index, count);
+		return;
+	}
+	for (f_cnt_t i = 0; i < count; ++i)
+	{
+		dst[i][0] = m_data[index - i][0];
+		dst[i][1] = m_data[index - i][1];
+	}
+}
+
+
 void SampleBuffer::update(bool keepSettings)
 {
-	const bool lock = (m_data != nullptr);
+	const bool lock = (m_data != nullptr || m_compact != nullptr);
 	if (lock)
 	{
 		Engine::audioEngine()->requestChangeInModel();
 		m_varLock.lockForWrite();
-		MM_FREE(m_data);
+		releaseData();
 	}
-
-	// File size and sample length limits
-	const int fileSizeMax = 300; // MB
-	const int sampleLengthMax = 90; // Minutes
+	// the old tables don't match the new frames, the wave itself plays
+	// until the tables of the new ones are generated
+	delete m_userAntiAliasWaveTable.exchange(nullptr);
 
 	bool fileLoadError = false;
-	if (m_audioFile.isEmpty() && m_origData != nullptr && m_origFrames > 0)
+	stopBackgroundDecoding();
+	m_stream.reset();
+	if (m_streamingAllowed && !m_reversed && !m_audioFile.isEmpty())
+	{
+		m_stream = SampleStream::open(PathUtil::toAbsolute(m_audioFile));
+	}
+
+	// reversed samples are decoded backwards, so they aren't shared
+	SampleCache::Key cacheKey;
+	if (!m_stream && !m_reversed && !m_audioFile.isEmpty())
+	{
+		cacheKey = fileKey();
+		m_sharedData = SampleCache::find(cacheKey);
+	}
+	// don't keep the GUI waiting for all samples of a project
+	const bool backgroundDecoding = m_backgroundDecodingAllowed && !m_sharedData &&
+		cacheKey.isValid() && Engine::getSong() != nullptr && Engine::getSong()->isLoadingProject();
+
+	if (m_stream)
+	{
+		// long files are decoded while playing, already at the engine's
+		// sample rate, so there's nothing to keep in memory
+		m_data = MM_ALLOC<sampleFrame>( 1);
+		memset(m_data, 0, sizeof(*m_data));
+		m_frames = m_stream->frames();
+		m_sampleRate = audioEngineSampleRate();
+		m_loopStartFrame = m_startFrame = 0;
+		m_loopEndFrame = m_endFrame = m_frames;
+	}
+	else if (m_sharedData)
+	{
+		// already decoded for another buffer, at the engine's sample rate
+		m_data = m_sharedData->frames();
+		m_compact = m_sharedData->compact();
+		m_frames = m_sharedData->count();
+		normalizeSampleRate(audioEngineSampleRate(), keepSettings);
+	}
+	else if (m_audioFile.isEmpty() && m_origData != nullptr && m_origFrames > 0)
 	{
 		// TODO: reverse- and amplification-property is not covered
 		// by following code...
@@ -260,66 +620,22 @@ void SampleBuffer::update(bool keepSettings)
 			m_loopEndFrame = m_endFrame = m_frames;
 		}
 	}
+	else if (!m_audioFile.isEmpty() && backgroundDecoding)
+	{
+		// decoded on SampleCache's thread pool, silent until then
+		SampleCache::decodeInBackground(cacheKey, &SampleBuffer::decodeFile);
+		m_data = MM_ALLOC<sampleFrame>( 1);
+		memset(m_data, 0, sizeof(*m_data));
+		m_frames = 1;
+		m_loopStartFrame = m_startFrame = 0;
+		m_loopEndFrame = m_endFrame = 1;
+		m_backgroundDecoding = true;
+		s_backgroundDecoding.push_back(this);
+	}
 	else if (!m_audioFile.isEmpty())
 	{
-		QString file = PathUtil::toAbsolute(m_audioFile);
-		int_sample_t * buf = nullptr;
-		sample_t * fbuf = nullptr;
-		ch_cnt_t channels = DEFAULT_CHANNELS;
 		sample_rate_t samplerate = audioEngineSampleRate();
-		m_frames = 0;
-
-		const QFileInfo fileInfo(file);
-		if (fileInfo.size() > fileSizeMax * 1024 * 1024)
-		{
-			fileLoadError = true;
-		}
-		else
-		{
-			// Use QFile to handle unicode file names on Windows
-			QFile f(file);
-			SNDFILE * sndFile;
-			SF_INFO sfInfo;
-			sfInfo.format = 0;
-			if (f.open(QIODevice::ReadOnly) && (sndFile = sf_open_fd(f.handle(), SFM_READ, &sfInfo, false)))
-			{
-				f_cnt_t frames = sfInfo.frames;
-				int rate = sfInfo.samplerate;
-				if (frames / rate > sampleLengthMax * 60)
-				{
-					fileLoadError = true;
-				}
-				sf_close(sndFile);
-			}
-			f.close();
-		}
-
-		if (!fileLoadError)
-		{
-#ifdef LMMS_HAVE_OGGVORBIS
-			// workaround for a bug in libsndfile or our libsndfile decoder
-			// causing some OGG files to be distorted -> try with OGG Vorbis
-			// decoder first if filename extension matches "ogg"
-			if (m_frames == 0 && fileInfo.suffix() == "ogg")
-			{
-				m_frames = decodeSampleOGGVorbis(file, buf, channels, samplerate);
-			}
-#endif
-			if (m_frames == 0)
-			{
-				m_frames = decodeSampleSF(file, fbuf, channels, samplerate);
-			}
-#ifdef LMMS_HAVE_OGGVORBIS
-			if (m_frames == 0)
-			{
-				m_frames = decodeSampleOGGVorbis(file, buf, channels, samplerate);
-			}
-#endif
-			if (m_frames == 0)
-			{
-				m_frames = decodeSampleDS(file, buf, channels, samplerate);
-			}
-		}
+		m_frames = decode(PathUtil::toAbsolute(m_audioFile), samplerate, fileLoadError);
 
 		if (m_frames == 0 || fileLoadError)  // if still no frames, bail
 		{
@@ -334,6 +650,18 @@ void SampleBuffer::update(bool keepSettings)
 		else // otherwise normalize sample rate
 		{
 			normalizeSampleRate(samplerate, keepSettings);
+			if (compactStorage())
+			{
+				compactData();
+			}
+			if (cacheKey.isValid())
+			{
+				m_sharedData = m_compact
+					? SampleCache::insert(cacheKey, m_compact)
+					: SampleCache::insert(cacheKey, m_data, m_frames);
+				m_data = m_sharedData->frames();
+				m_compact = m_sharedData->compact();
+			}
 		}
 	}
 	else
@@ -355,12 +683,7 @@ void SampleBuffer::update(bool keepSettings)
 
 	emit sampleUpdated();
 
-	// allocate space for anti-aliased wave table
-	if (m_userAntiAliasWaveTable == nullptr)
-	{
-		m_userAntiAliasWaveTable = std::make_unique<OscillatorConstants::waveform_t>();
-	}
-	Oscillator::generateAntiAliasUserWaveTable(this);
+	generateUserWaveTable();
 
 	if (fileLoadError)
 	{
@@ -381,6 +704,258 @@ void SampleBuffer::update(bool keepSettings)
 }
 
 
+f_cnt_t SampleBuffer::decode(const QString & file, sample_rate_t & samplerate, bool & fileLoadError)
+{
+	int_sample_t * buf = nullptr;
+	sample_t * fbuf = nullptr;
+	ch_cnt_t channels = DEFAULT_CHANNELS;
+	m_frames = 0;
+	// the other decoders deliver 16 bit samples
+	m_sourceBits = 16;
+
+	const QFileInfo fileInfo(file);
+	if (fileInfo.size() > fileSizeMax * 1024 * 1024)
+	{
+		fileLoadError = true;
+	}
+	else
+	{
+		// Use QFile to handle unicode file names on Windows
+		QFile f(file);
+		SNDFILE * sndFile;
+		SF_INFO sfInfo;
+		sfInfo.format = 0;
+		if (f.open(QIODevice::ReadOnly) && (sndFile = sf_open_fd(f.handle(), SFM_READ, &sfInfo, false)))
+		{
+			f_cnt_t frames = sfInfo.frames;
+			int rate = sfInfo.samplerate;
+			if (frames / rate > sampleLengthMax * 60)
+			{
+				fileLoadError = true;
+			}
+			sf_close(sndFile);
+		}
+		f.close();
+	}
+
+	if (!fileLoadError)
+	{
+#ifdef LMMS_HAVE_OGGVORBIS
+		// workaround for a bug in libsndfile or our libsndfile decoder
+		// causing some OGG files to be distorted -> try with OGG Vorbis
+		// decoder first if filename extension matches "ogg"
+		if (m_frames == 0 && fileInfo.suffix() == "ogg")
+		{
+			m_frames = decodeSampleOGGVorbis(file, buf, channels, samplerate);
+		}
+#endif
+		if (m_frames == 0)
+		{
+			m_frames = decodeSampleSF(file, fbuf, channels, samplerate);
+		}
+#ifdef LMMS_HAVE_OGGVORBIS
+		if (m_frames == 0)
+		{
+			m_frames = decodeSampleOGGVorbis(file, buf, channels, samplerate);
+		}
+#endif
+		if (m_frames == 0)
+		{
+			// rendered in float, like a float file
+			m_sourceBits = 0;
+			m_frames = decodeSampleDS(file, fbuf, channels, samplerate);
+		}
+	}
+	m_sourceChannels = channels;
+
+	return m_frames;
+}
+
+
+
+
+SampleData * SampleBuffer::decodeFile(const SampleCache::Key & key)
+{
+	// a buffer of its own, so that this can run on any thread
+	SampleBuffer decoder(Unconnected{});
+	decoder.m_compactStorageAllowed = key.compact;
+	sample_rate_t samplerate = key.sampleRate;
+	bool fileLoadError = false;
+	if (decoder.decode(key.path, samplerate, fileLoadError) == 0 || fileLoadError)
+	{
+		return nullptr;
+	}
+	// not normalizeSampleRate(), the engine's rate may have changed since
+	if (samplerate != key.sampleRate)
+	{
+		f_cnt_t frames = 0;
+		sampleFrame * resampled = resampleFrames(decoder.m_data, decoder.m_frames,
+			samplerate, key.sampleRate, frames);
+		MM_FREE(decoder.m_data);
+		decoder.m_data = resampled;
+		decoder.m_frames = frames;
+	}
+	decoder.compactData();
+
+	SampleData * data = decoder.m_compact
+		? new SampleData(decoder.m_compact)
+		: new SampleData(decoder.m_data, decoder.m_frames);
+	decoder.m_data = nullptr;
+	decoder.m_compact = nullptr;
+	return data;
+}
+
+
+
+
+void SampleBuffer::waitForDecoding()
+{
+	if (m_backgroundDecoding || m_resampling)
+	{
+		SampleCache::waitForDecoding(fileKey());
+		backgroundDecodingFinished();
+	}
+}
+
+
+
+
+void SampleBuffer::waitForAllDecoding()
+{
+	if (!s_backgroundDecoding.empty())
+	{
+		SampleCache::waitForDecoding();
+		// finishing removes the buffer from the list
+		const auto buffers = s_backgroundDecoding;
+		for (SampleBuffer * buffer : buffers)
+		{
+			buffer->backgroundDecodingFinished();
+		}
+	}
+	if (!s_userWaveTables.empty())
+	{
+		userWaveTablePool().waitForDone();
+		const auto buffers = s_userWaveTables;
+		for (SampleBuffer * buffer : buffers)
+		{
+			buffer->userWaveTableFinished();
+		}
+	}
+}
+
+
+
+
+void SampleBuffer::prefetch(const QString & audioFile)
+{
+	const SampleCache::Key key = SampleCache::keyOf(PathUtil::toAbsolute(audioFile), audioEngineSampleRate());
+	if (key.isValid())
+	{
+		SampleCache::decodeInBackground(key, &SampleBuffer::decodeFile, true);
+	}
+}
+
+
+
+
+void SampleBuffer::backgroundDecodingFinished()
+{
+	if ((!m_backgroundDecoding && !m_resampling) || SampleCache::isDecoding(fileKey()))
+	{
+		return;
+	}
+
+	// resampled frames keep the start and end of the old ones
+	const bool keepSettings = m_resampling;
+	stopBackgroundDecoding();
+	// takes the frames from the cache, or tries again in this thread
+	// if they couldn't be decoded
+	const bool allowed = m_backgroundDecodingAllowed;
+	m_backgroundDecodingAllowed = false;
+	update(keepSettings);
+	m_backgroundDecodingAllowed = allowed;
+}
+
+
+
+
+void SampleBuffer::stopBackgroundDecoding()
+{
+	if (m_backgroundDecoding || m_resampling)
+	{
+		m_backgroundDecoding = false;
+		m_resampling = false;
+		s_backgroundDecoding.erase(std::remove(s_backgroundDecoding.begin(),
+			s_backgroundDecoding.end(), this), s_backgroundDecoding.end());
+	}
+}
+
+
+
+
+void SampleBuffer::generateUserWaveTable()
+{
+	stopUserWaveTable();
+	if (m_stream != nullptr || m_compact != nullptr || m_frames <= 0)
+	{
+		return;
+	}
+
+	std::vector<sample_t> wave(OscillatorConstants::WAVETABLE_LENGTH);
+	for (int i = 0; i < OscillatorConstants::WAVETABLE_LENGTH; ++i)
+	{
+		wave[i] = userWaveSample(static_cast<float>(i) / OscillatorConstants::WAVETABLE_LENGTH);
+	}
+
+	m_userWaveTableRequest = std::make_shared<UserWaveTableRequest>();
+	m_userWaveTableRequest->buffer = this;
+	s_userWaveTables.push_back(this);
+	userWaveTablePool().start(new UserWaveTableJob(m_userWaveTableRequest, std::move(wave)));
+}
+
+
+
+
+void SampleBuffer::stopUserWaveTable()
+{
+	if (m_userWaveTableRequest)
+	{
+		QMutexLocker lock(&m_userWaveTableRequest->mutex);
+		m_userWaveTableRequest->buffer = nullptr;
+	}
+	m_userWaveTableRequest.reset();
+	s_userWaveTables.erase(std::remove(s_userWaveTables.begin(),
+		s_userWaveTables.end(), this), s_userWaveTables.end());
+}
+
+
+
+
+void SampleBuffer::userWaveTableFinished()
+{
+	if (!m_userWaveTableRequest)
+	{
+		return;
+	}
+	std::unique_ptr<OscillatorConstants::waveform_t> table;
+	{
+		QMutexLocker lock(&m_userWaveTableRequest->mutex);
+		table = std::move(m_userWaveTableRequest->table);
+	}
+	if (!table)
+	{
+		// queued for a request before the current one
+		return;
+	}
+	stopUserWaveTable();
+
+	// update() dropped the old tables
+	m_userAntiAliasWaveTable.store(table.release(), std::memory_order_release);
+}
+
+
+
+
 void SampleBuffer::convertIntToFloat(
 	int_sample_t * & ibuf,
 	f_cnt_t frames,
@@ -424,6 +999,9 @@ void SampleBuffer::directFloatWrite(
 		m_data[frame][1] = fbuf[idx+ch];
 		idx += isReversed ? -channels : channels;
 	}
+	// float files may hold NaNs or infinite values, which are better
+	// cleared once here than while mixing
+	MixHelpers::sanitize( m_data, frames );
 
 	delete[] fbuf;
 }
@@ -435,14 +1013,14 @@ void SampleBuffer::normalizeSampleRate(const sample_rate_t srcSR, bool keepSetti
 	// do samplerate-conversion to our default-samplerate
 	if (srcSR != audioEngineSampleRate())
 	{
-		SampleBuffer * resampled = resample(srcSR, audioEngineSampleRate());
+		f_cnt_t frames = 0;
+		std::vector<sampleFrame> storage;
+		sampleFrame * resampled = resampleFrames(floatFrames(storage), m_frames, srcSR, audioEngineSampleRate(), frames);
 
 		m_sampleRate = audioEngineSampleRate();
-		MM_FREE(m_data);
-		m_frames = resampled->frames();
-		m_data = MM_ALLOC<sampleFrame>( m_frames);
-		memcpy(m_data, resampled->data(), m_frames * sizeof(sampleFrame));
-		delete resampled;
+		releaseData();
+		m_frames = frames;
+		m_data = resampled;
 	}
 
 	if (keepSettings == false)
@@ -499,6 +1077,22 @@ f_cnt_t SampleBuffer::decodeSampleSF(
 		channels = sfInfo.channels;
 		samplerate = sfInfo.samplerate;
 
+		switch (sfInfo.format & SF_FORMAT_SUBMASK)
+		{
+			case SF_FORMAT_PCM_S8:
+			case SF_FORMAT_PCM_U8:
+			case SF_FORMAT_PCM_16:
+				m_sourceBits = 16;
+				break;
+			case SF_FORMAT_PCM_24:
+				m_sourceBits = 24;
+				break;
+			default:
+				// floats, or no bit depth to keep
+				m_sourceBits = 0;
+				break;
+		}
+
 		sf_close(sndFile);
 	}
 	else
@@ -678,21 +1272,78 @@ f_cnt_t SampleBuffer::decodeSampleOGGVorbis(
 
 f_cnt_t SampleBuffer::decodeSampleDS(
 	QString fileName,
-	int_sample_t * & buf,
+	sample_t * & buf,
 	ch_cnt_t & channels,
 	sample_rate_t & samplerate
 )
 {
-	DrumSynth ds;
-	f_cnt_t frames = ds.GetDSFileSamples(fileName, buf, channels, samplerate);
+	QFile file(fileName);
+	if (file.size() > drumSynthFileMax || !file.open(QIODevice::ReadOnly))
+	{
+		return 0;
+	}
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(file.readAll());
+	const QByteArray key = hash.result().toHex() + '-' + QByteArray::number(samplerate);
+	file.close();
 
-	if (frames > 0 && buf != nullptr)
+	// DrumSynth keeps its state in globals
+	static QMutex mutex;
+	QMutexLocker lock(&mutex);
+
+	auto render = s_drumSynthRenders.find(key);
+	if (render == s_drumSynthRenders.end())
 	{
-		convertIntToFloat(buf, frames, channels);
+		std::vector<float> frames;
+		const QString cacheDir = drumSynthCacheDir();
+		QFile cached(cacheDir + key + ".f32");
+		if (!cacheDir.isEmpty() && cached.open(QIODevice::ReadOnly))
+		{
+			frames.resize(cached.size() / sizeof(float));
+			cached.read(reinterpret_cast<char *>(frames.data()), frames.size() * sizeof(float));
+		}
+		if (frames.empty())
+		{
+			float * wave = nullptr;
+			DrumSynth ds;
+			const int length = ds.GetDSFileSamples(fileName, wave, 1, samplerate);
+			if (length > 0 && wave != nullptr)
+			{
+				frames.assign(wave, wave + length);
+			}
+			delete[] wave;
+
+			if (!cacheDir.isEmpty() && !frames.empty() && QDir().mkpath(cacheDir))
+			{
+				QSaveFile out(cached.fileName());
+				if (out.open(QIODevice::WriteOnly))
+				{
+					out.write(reinterpret_cast<const char *>(frames.data()), frames.size() * sizeof(float));
+					out.commit();
+				}
+			}
+		}
+		if (frames.empty())
+		{
+			return 0;
+		}
+
+		if (s_drumSynthRenderBytes > drumSynthCacheMax)
+		{
+			s_drumSynthRenders.clear();
+			s_drumSynthRenderBytes = 0;
+		}
+		s_drumSynthRenderBytes += frames.size() * sizeof(float);
+		render = s_drumSynthRenders.insert(key, std::move(frames));
 	}
 
-	return frames;
+	const f_cnt_t frames = static_cast<f_cnt_t>(render->size());
+	buf = new sample_t[frames];
+	std::copy(render->begin(), render->end(), buf);
+	channels = 1;
+	directFloatWrite(buf, frames, channels);
 
+	return frames;
 }
 
 
@@ -739,6 +1390,29 @@ bool SampleBuffer::play(
 	// this holds the index of the first frame to play
 	f_cnt_t playFrame = qMax(state->m_frameIndex, startFrame);
 
+	if (m_stream)
+	{
+		// streamed samples only play forward at their original pitch
+		if (playFrame >= endFrame)
+		{
+			return false;
+		}
+		const fpp_t streamed = static_cast<fpp_t>(qMin<f_cnt_t>(frames, endFrame - playFrame));
+		m_stream->read(ab, playFrame, streamed);
+		if (streamed < frames)
+		{
+			memset(ab + streamed, 0, (frames - streamed) * BYTES_PER_FRAME);
+		}
+		state->setFrameIndex(playFrame + frames);
+
+		for (fpp_t i = 0; i < frames; ++i)
+		{
+			ab[i][0] *= m_amplification;
+			ab[i][1] *= m_amplification;
+		}
+		return true;
+	}
+
 	if (loopMode == LoopOff)
 	{
 		if (playFrame >= endFrame || (endFrame - playFrame) / freqFactor == 0)
@@ -763,43 +1437,52 @@ bool SampleBuffer::play(
 	// check whether we have to change pitch...
 	if (freqFactor != 1.0 || state->m_varyingPitch)
 	{
-		SRC_DATA srcData;
 		// Generate output
-		srcData.data_in =
-			getSampleFragment(playFrame, fragmentSize, loopMode, &tmp, &isBackwards,
-			loopStartFrame, loopEndFrame, endFrame )->data();
-		srcData.data_out = ab->data();
-		srcData.input_frames = fragmentSize;
-		srcData.output_frames = frames;
-		srcData.src_ratio = 1.0 / freqFactor;
-		srcData.end_of_input = 0;
-		int error = src_process(state->m_resamplingData, &srcData);
-		if (error)
+		const sampleFrame * fragment = getSampleFragment(playFrame, fragmentSize, loopMode, &tmp,
+			&isBackwards, loopStartFrame, loopEndFrame, endFrame);
+		f_cnt_t framesUsed = 0;
+		if (state->m_resampler)
 		{
-			printf("SampleBuffer: error while resampling: %s\n",
-							src_strerror(error));
+			framesUsed = state->m_resampler->process(fragment, ab, frames, freqFactor);
 		}
-		if (srcData.output_frames_gen > frames)
+		else
 		{
-			printf("SampleBuffer: not enough frames: %ld / %d\n",
-					srcData.output_frames_gen, frames);
+			SRC_DATA srcData;
+			srcData.data_in = fragment->data();
+			srcData.data_out = ab->data();
+			srcData.input_frames = fragmentSize;
+			srcData.output_frames = frames;
+			srcData.src_ratio = 1.0 / freqFactor;
+			srcData.end_of_input = 0;
+			int error = src_process(state->m_resamplingData, &srcData);
+			if (error)
+			{
+				printf("SampleBuffer: error while resampling: %s\n",
+								src_strerror(error));
+			}
+			if (srcData.output_frames_gen > frames)
+			{
+				printf("SampleBuffer: not enough frames: %ld / %d\n",
+						srcData.output_frames_gen, frames);
+			}
+			framesUsed = srcData.input_frames_used;
 		}
 		// Advance
 		switch (loopMode)
 		{
 			case LoopOff:
-				playFrame += srcData.input_frames_used;
+				playFrame += framesUsed;
 				break;
 			case LoopOn:
-				playFrame += srcData.input_frames_used;
+				playFrame += framesUsed;
 				playFrame = getLoopedIndex(playFrame, loopStartFrame, loopEndFrame);
 				break;
 			case LoopPingPong:
 			{
-				f_cnt_t left = srcData.input_frames_used;
+				f_cnt_t left = framesUsed;
 				if (state->isBackwards())
 				{
-					playFrame -= srcData.input_frames_used;
+					playFrame -= framesUsed;
 					if (playFrame < loopStartFrame)
 					{
 						left -= (loopStartFrame - playFrame);
@@ -884,25 +1567,29 @@ sampleFrame * SampleBuffer::getSampleFragment(
 	f_cnt_t end
 ) const
 {
-	if (loopMode == LoopOff)
+	// compact frames always have to be converted
+	if (m_compact == nullptr)
 	{
-		if (index + frames <= end)
+		if (loopMode == LoopOff)
 		{
-			return m_data + index;
+			if (index + frames <= end)
+			{
+				return m_data + index;
+			}
 		}
-	}
-	else if (loopMode == LoopOn)
-	{
-		if (index + frames <= loopEnd)
+		else if (loopMode == LoopOn)
 		{
-			return m_data + index;
+			if (index + frames <= loopEnd)
+			{
+				return m_data + index;
+			}
 		}
-	}
-	else
-	{
-		if (!*backwards && index + frames < loopEnd)
+		else
 		{
-			return m_data + index;
+			if (!*backwards && index + frames < loopEnd)
+			{
+				return m_data + index;
+			}
 		}
 	}
 
@@ -911,18 +1598,18 @@ sampleFrame * SampleBuffer::getSampleFragment(
 	if (loopMode == LoopOff)
 	{
 		f_cnt_t available = end - index;
-		memcpy(*tmp, m_data + index, available * BYTES_PER_FRAME);
+		copyFrames(*tmp, index, available);
 		memset(*tmp + available, 0, (frames - available) * BYTES_PER_FRAME);
 	}
 	else if (loopMode == LoopOn)
 	{
 		f_cnt_t copied = qMin(frames, loopEnd - index);
-		memcpy(*tmp, m_data + index, copied * BYTES_PER_FRAME);
+		copyFrames(*tmp, index, copied);
 		f_cnt_t loopFrames = loopEnd - loopStart;
 		while (copied < frames)
 		{
 			f_cnt_t todo = qMin(frames - copied, loopFrames);
-			memcpy(*tmp + copied, m_data + loopStart, todo * BYTES_PER_FRAME);
+			copyFrames(*tmp + copied, loopStart, todo);
 			copied += todo;
 		}
 	}
@@ -938,18 +1625,14 @@ sampleFrame * SampleBuffer::getSampleFragment(
 		if (currentBackwards)
 		{
 			copied = qMin(frames, pos - loopStart);
-			for (int i = 0; i < copied; i++)
-			{
-				(*tmp)[i][0] = m_data[pos - i][0];
-				(*tmp)[i][1] = m_data[pos - i][1];
-			}
+			copyFramesBackwards(*tmp, pos, copied);
 			pos -= copied;
 			if (pos == loopStart) { currentBackwards = false; }
 		}
 		else
 		{
 			copied = qMin(frames, loopEnd - pos);
-			memcpy(*tmp, m_data + pos, copied * BYTES_PER_FRAME);
+			copyFrames(*tmp, pos, copied);
 			pos += copied;
 			if (pos == loopEnd) { currentBackwards = true; }
 		}
@@ -959,11 +1642,7 @@ sampleFrame * SampleBuffer::getSampleFragment(
 			if (currentBackwards)
 			{
 				f_cnt_t todo = qMin(frames - copied, pos - loopStart);
-				for (int i = 0; i < todo; i++)
-				{
-					(*tmp)[copied + i][0] = m_data[pos - i][0];
-					(*tmp)[copied + i][1] = m_data[pos - i][1];
-				}
+				copyFramesBackwards(*tmp + copied, pos, todo);
 				pos -= todo;
 				copied += todo;
 				if (pos <= loopStart) { currentBackwards = false; }
@@ -971,7 +1650,7 @@ sampleFrame * SampleBuffer::getSampleFragment(
 			else
 			{
 				f_cnt_t todo = qMin(frames - copied, loopEnd - pos);
-				memcpy(*tmp + copied, m_data + pos, todo * BYTES_PER_FRAME);
+				copyFrames(*tmp + copied, pos, todo);
 				pos += todo;
 				copied += todo;
 				if (pos >= loopEnd) { currentBackwards = true; }
@@ -1028,6 +1707,15 @@ void SampleBuffer::visualize(
 {
 	if (m_frames == 0) { return; }
 
+	if (m_stream || m_backgroundDecoding)
+	{
+		// streamed samples aren't in memory and the others may not be
+		// decoded yet, so there's no waveform to draw
+		const int y = dr.y() + dr.height() / 2;
+		p.drawLine(dr.x(), y, dr.x() + dr.width(), y);
+		return;
+	}
+
 	const bool focusOnRange = toFrame <= m_frames && 0 <= fromFrame && fromFrame < toFrame;
 	//TODO: If the clip QRect is not being used we should remove it
 	//p.setClipRect(clip);
@@ -1063,28 +1751,60 @@ void SampleBuffer::visualize(
 		? fromFrame + visibleFrames - 1
 		: visibleFrames - 1;
 
+	// When zoomed out, collect the peaks from precomputed bins instead of
+	// the frames, so that drawing doesn't get slower with the length
+	const WaveformOverview::Level * level = overview().levelFor(fpp);
+
+	// compact frames are converted for the range shown only
+	const sampleFrame * data = m_data;
+	std::vector<sampleFrame> converted;
+	int dataStart = 0;
+	if (m_compact && !level)
+	{
+		converted.resize(last - first + 1);
+		m_compact->read(converted.data(), first, last - first + 1);
+		data = converted.data();
+		dataStart = first;
+	}
+
 	for (double frame = first; frame <= last && frame <= lastVisibleFrame; frame += fpp)
 	{
 		float maxData = -1;
 		float minData = 1;
+		float trueRmsData = 0;
 
-		float rmsData[2] = {0, 0};
-
-		// Find maximum and minimum samples within range
-		for (int i = 0; i < fpp && frame + i <= last; ++i)
+		if (level)
 		{
-			for (int j = 0; j < 2; ++j)
+			const f_cnt_t from = static_cast<f_cnt_t>(frame);
+			const f_cnt_t to = std::min<f_cnt_t>(static_cast<f_cnt_t>(frame + fpp) - 1, last);
+			const WaveformOverview::Bin bin = WaveformOverview::combine(*level, from, to);
+			maxData = bin.max;
+			minData = bin.min;
+			// the bins at the edges may reach past this pixel
+			const f_cnt_t binFrames = (to / level->binFrames - from / level->binFrames + 1) * level->binFrames;
+			trueRmsData = bin.squares / binFrames;
+		}
+		else
+		{
+			float rmsData[2] = {0, 0};
+
+			// Find maximum and minimum samples within range
+			for (int i = 0; i < fpp && frame + i <= last; ++i)
 			{
-				auto curData = m_data[static_cast<int>(frame) + i][j];
+				for (int j = 0; j < 2; ++j)
+				{
+					auto curData = data[static_cast<int>(frame) + i - dataStart][j];
 
-				if (curData > maxData) { maxData = curData; }
-				if (curData < minData) { minData = curData; }
+					if (curData > maxData) { maxData = curData; }
+					if (curData < minData) { minData = curData; }
 
-				rmsData[j] += curData * curData;
+					rmsData[j] += curData * curData;
+				}
 			}
+
+			trueRmsData = (rmsData[0] + rmsData[1]) / 2 / fpp;
 		}
 
-		const float trueRmsData = (rmsData[0] + rmsData[1]) / 2 / fpp;
 		const float sqrtRmsData = sqrt(trueRmsData);
 		const float maxRmsData = qBound(minData, sqrtRmsData, maxData);
 		const float minRmsData = qBound(minData, -sqrtRmsData, maxData);
@@ -1263,6 +1983,19 @@ void flacStreamEncoderMetadataCallback(
 
 QString & SampleBuffer::toBase64(QString & dst) const
 {
+	const QByteArray data = toData();
+	base64::encode(data.constData(), data.size(), dst);
+	return dst;
+}
+
+
+
+
+QByteArray SampleBuffer::toData() const
+{
+	std::vector<sampleFrame> storage;
+	const sampleFrame * data = floatFrames(storage);
+
 #ifdef LMMS_HAVE_FLAC_STREAM_ENCODER_H
 	const f_cnt_t FRAMES_PER_BUF = 1152;
 
@@ -1299,7 +2032,7 @@ QString & SampleBuffer::toBase64(QString & dst) const
 			for (ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch)
 			{
 				buf[f*DEFAULT_CHANNELS+ch] = (FLAC__int32)(
-					AudioEngine::clip(m_data[f+frameCnt][ch]) *
+					AudioEngine::clip(data[f+frameCnt][ch]) *
 						OUTPUT_SAMPLE_MULTIPLIER);
 			}
 		}
@@ -1311,16 +2044,13 @@ QString & SampleBuffer::toBase64(QString & dst) const
 	printf("%d %d\n", frameCnt, (int)baWriter.size());
 	baWriter.close();
 
-	base64::encode(baWriter.buffer().data(), baWriter.buffer().size(), dst);
+	return baWriter.buffer();
 
 #else	/* LMMS_HAVE_FLAC_STREAM_ENCODER_H */
 
-	base64::encode((const char *) m_data,
-		m_frames * sizeof(sampleFrame), dst);
+	return QByteArray((const char *) data, m_frames * sizeof(sampleFrame));
 
 #endif	/* LMMS_HAVE_FLAC_STREAM_ENCODER_H */
-
-	return dst;
 }
 
 
@@ -1328,11 +2058,23 @@ QString & SampleBuffer::toBase64(QString & dst) const
 
 SampleBuffer * SampleBuffer::resample(const sample_rate_t srcSR, const sample_rate_t dstSR )
 {
-	sampleFrame * data = m_data;
-	const f_cnt_t frames = m_frames;
-	const f_cnt_t dstFrames = static_cast<f_cnt_t>((frames / (float) srcSR) * (float) dstSR);
-	SampleBuffer * dstSB = new SampleBuffer(dstFrames);
-	sampleFrame * dstBuf = dstSB->m_origData;
+	f_cnt_t dstFrames = 0;
+	std::vector<sampleFrame> storage;
+	sampleFrame * dstBuf = resampleFrames(floatFrames(storage), m_frames, srcSR, dstSR, dstFrames);
+	SampleBuffer * dstSB = new SampleBuffer(dstBuf, dstFrames);
+	MM_FREE(dstBuf);
+	return dstSB;
+}
+
+
+
+
+sampleFrame * SampleBuffer::resampleFrames(const sampleFrame * data, const f_cnt_t frames,
+	const sample_rate_t srcSR, const sample_rate_t dstSR, f_cnt_t & dstFrames)
+{
+	dstFrames = static_cast<f_cnt_t>((frames / (float) srcSR) * (float) dstSR);
+	sampleFrame * dstBuf = MM_ALLOC<sampleFrame>( dstFrames);
+	memset(dstBuf, 0, dstFrames * BYTES_PER_FRAME);
 
 	// yeah, libsamplerate, let's rock with sinc-interpolation!
 	int error;
@@ -1356,8 +2098,7 @@ SampleBuffer * SampleBuffer::resample(const sample_rate_t srcSR, const sample_ra
 	{
 		printf("Error: src_new() failed in sample_buffer.cpp!\n");
 	}
-	dstSB->update();
-	return dstSB;
+	return dstBuf;
 }
 
 
@@ -1468,10 +2209,18 @@ void SampleBuffer::loadFromBase64(const QString & data)
 	char * dst = nullptr;
 	int dsize = 0;
 	base64::decode(data, &dst, &dsize);
+	loadFromData(QByteArray::fromRawData(dst, dsize));
+	delete[] dst;
+}
+
+
 
+
+void SampleBuffer::loadFromData(const QByteArray & data)
+{
 #ifdef LMMS_HAVE_FLAC_STREAM_DECODER_H
 
-	QByteArray origData = QByteArray::fromRawData(dst, dsize);
+	QByteArray origData = data;
 	QBuffer baReader(&origData);
 	baReader.open(QBuffer::ReadOnly);
 
@@ -1511,15 +2260,13 @@ void SampleBuffer::loadFromBase64(const QString & data)
 
 #else /* LMMS_HAVE_FLAC_STREAM_DECODER_H */
 
-	m_origFrames = dsize / sizeof(sampleFrame);
+	m_origFrames = data.size() / sizeof(sampleFrame);
 	MM_FREE(m_origData);
 	m_origData = MM_ALLOC<sampleFrame>( m_origFrames);
-	memcpy(m_origData, dst, dsize);
+	memcpy(m_origData, data.constData(), m_origFrames * sizeof(sampleFrame));
 
 #endif
 
-	delete[] dst;
-
 	m_audioFile = QString();
 	update();
 }
@@ -1554,9 +2301,23 @@ void SampleBuffer::setAmplification(float a)
 
 void SampleBuffer::setReversed(bool on)
 {
+	if (m_stream && on)
+	{
+		// streams only play forward, so decode the whole file reversed
+		m_reversed = true;
+		update();
+		return;
+	}
+
 	Engine::audioEngine()->requestChangeInModel();
 	m_varLock.lockForWrite();
-	if (m_reversed != on) { std::reverse(m_data, m_data + m_frames); }
+	if (m_reversed != on)
+	{
+		detachData();
+		if (m_compact) { m_compact->reverse(); }
+		else { std::reverse(m_data, m_data + m_frames); }
+		m_overview.reset();
+	}
 	m_reversed = on;
 	m_varLock.unlock();
 	Engine::audioEngine()->doneChangeInModel();
@@ -1570,14 +2331,25 @@ void SampleBuffer::setReversed(bool on)
 SampleBuffer::handleState::handleState(bool varyingPitch, int interpolationMode) :
 	m_frameIndex(0),
 	m_varyingPitch(varyingPitch),
-	m_isBackwards(false)
+	m_isBackwards(false),
+	m_resamplingData(nullptr)
 {
-	int error;
 	m_interpolationMode = interpolationMode;
 
-	if ((m_resamplingData = src_new(interpolationMode, DEFAULT_CHANNELS, &error)) == nullptr)
+	// The cheap modes are rendered by our own resampler. Above draft quality,
+	// linear interpolation is upgraded to cubic, which costs about the same.
+	const bool draft = Engine::audioEngine()->currentQualitySettings().interpolation ==
+		AudioEngine::qualitySettings::Interpolation_Linear;
+	switch (interpolationMode)
 	{
-		qDebug("Error: src_new() failed in sample_buffer.cpp!\n");
+		case SRC_ZERO_ORDER_HOLD:
+			m_resampler.emplace(Resampler::Mode::ZeroOrderHold);
+			break;
+		case SRC_LINEAR:
+			m_resampler.emplace(draft ? Resampler::Mode::Linear : Resampler::Mode::CubicHermite);
+			break;
+		default:
+			m_resamplingData = ResamplerPool::inst().take(interpolationMode);
 	}
 }
 
@@ -1586,5 +2358,22 @@ SampleBuffer::handleState::handleState(bool varyingPitch, int interpolationMode)
 
 SampleBuffer::handleState::~handleState()
 {
-	src_delete(m_resamplingData);
+	ResamplerPool::inst().give(m_interpolationMode, m_resamplingData);
+}
+
+
+
+
+void SampleBuffer::handleState::reset()
+{
+	m_frameIndex = 0;
+	m_isBackwards = false;
+	if (m_resamplingData)
+	{
+		src_reset(m_resamplingData);
+	}
+	if (m_resampler)
+	{
+		m_resampler->reset();
+	}
 }
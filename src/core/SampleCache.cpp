@@ -0,0 +1,429 @@
+/*
+ * SampleCache.cpp - shares decoded samples between all buffers loading them
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SampleCache.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include "AudioEngine.h"
+#include "CompactSamples.h"
+#include "Engine.h"
+#include "MemoryManager.h"
+#include "WaveformOverview.h"
+
+
+SampleData::SampleData( sampleFrame * frames, f_cnt_t count ) :
+	m_frames( frames ),
+	m_count( count )
+{
+}
+
+
+
+
+SampleData::SampleData( CompactSamples * compact ) :
+	m_frames( nullptr ),
+	m_compact( compact ),
+	m_count( compact->frames() )
+{
+}
+
+
+
+
+SampleData::~SampleData()
+{
+	MM_FREE( m_frames );
+}
+
+
+
+
+size_t SampleData::bytes() const
+{
+	return m_compact ? m_compact->bytes() : m_count * sizeof( sampleFrame );
+}
+
+
+
+
+const WaveformOverview & SampleData::overview()
+{
+	if( !m_overview )
+	{
+		m_overview.reset( m_compact ? new WaveformOverview( *m_compact )
+						: new WaveformOverview( m_frames, m_count ) );
+	}
+	return *m_overview;
+}
+
+
+
+
+uint qHash( const SampleCache::Key & key, uint seed = 0 )
+{
+	return qHash( key.path, seed ) ^ qHash( key.modified, seed ) ^
+		qHash( key.sampleRate, seed ) ^ qHash( key.compact, seed );
+}
+
+
+namespace
+{
+
+// unused entries kept at other rates or prefetched
+const size_t RetainedBytesMax = 256 * 1024 * 1024;
+
+QMutex s_mutex;
+QHash<SampleCache::Key, SampleData *> s_entries;
+// unused entries kept, the most recently used first
+QList<SampleCache::Key> s_retained;
+// files decoding in the background, and its end
+QSet<SampleCache::Key> s_decoding;
+QWaitCondition s_decoded;
+
+QThreadPool & pool()
+{
+	static QThreadPool pool;
+	return pool;
+}
+
+// with s_mutex locked. Drops the entries kept longest once they exceed
+// RetainedBytesMax.
+void trimRetained()
+{
+	size_t retained = 0;
+	for( auto it = s_retained.begin(); it != s_retained.end(); )
+	{
+		retained += s_entries.value( *it )->bytes();
+		if( retained > RetainedBytesMax )
+		{
+			sharedObject::unref( s_entries.take( *it ) );
+			it = s_retained.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+// with s_mutex locked. Drops the unused entry of @p key, or keeps it if
+// it's at another rate than the engine's.
+void dropOrRetain( const SampleCache::Key & key )
+{
+	const AudioEngine * engine = Engine::audioEngine();
+	if( engine != nullptr && key.sampleRate != engine->processingSampleRate() )
+	{
+		s_retained.prepend( key );
+		trimRetained();
+	}
+	else
+	{
+		sharedObject::unref( s_entries.take( key ) );
+	}
+}
+
+}
+
+
+
+
+class SampleDecodeJob : public QRunnable
+{
+public:
+	SampleDecodeJob( const SampleCache::Key & key, SampleCache::DecodeFunction decode, bool prefetch ) :
+		m_key( key ),
+		m_decode( decode ),
+		m_prefetch( prefetch )
+	{
+	}
+
+	void run() override
+	{
+		SampleData * data = m_decode( m_key );
+		if( data )
+		{
+			// spare the GUI thread from building it when drawing
+			data->overview();
+		}
+
+		{
+			QMutexLocker lock( &s_mutex );
+			if( data && !s_entries.contains( m_key ) )
+			{
+				// the cache holds the only reference until a buffer
+				// takes the data, and deletes it in the GUI thread
+				data->moveToThread( SampleCache::inst()->thread() );
+				s_entries.insert( m_key, data );
+				if( m_prefetch )
+				{
+					s_retained.prepend( m_key );
+					trimRetained();
+				}
+			}
+			else
+			{
+				delete data;
+			}
+			s_decoding.remove( m_key );
+			s_decoded.wakeAll();
+		}
+
+		emit SampleCache::inst()->decodingFinished();
+		// queued after the buffers' slots, which take the data
+		QMetaObject::invokeMethod( SampleCache::inst(), "dropUnused", Qt::QueuedConnection );
+	}
+
+private:
+	const SampleCache::Key m_key;
+	const SampleCache::DecodeFunction m_decode;
+	const bool m_prefetch;
+} ;
+
+
+
+
+SampleCache::Key SampleCache::keyOf( const QString & file, sample_rate_t sampleRate, bool compact )
+{
+	const QFileInfo info( file );
+	// resolves symlinks and relative paths, empty if the file doesn't exist
+	return { info.canonicalFilePath(), info.lastModified().toMSecsSinceEpoch(), sampleRate, compact };
+}
+
+
+
+
+SampleData * SampleCache::find( const Key & key )
+{
+	if( !key.isValid() )
+	{
+		return nullptr;
+	}
+
+	QMutexLocker lock( &s_mutex );
+	SampleData * data = s_entries.value( key, nullptr );
+	if( data == nullptr )
+	{
+		return nullptr;
+	}
+	s_retained.removeOne( key );
+	return sharedObject::ref( data );
+}
+
+
+
+
+SampleData * SampleCache::insert( const Key & key, sampleFrame * frames, f_cnt_t count )
+{
+	QMutexLocker lock( &s_mutex );
+	if( SampleData * data = s_entries.value( key, nullptr ) )
+	{
+		MM_FREE( frames );
+		s_retained.removeOne( key );
+		return sharedObject::ref( data );
+	}
+
+	// the cache holds the first reference
+	SampleData * data = new SampleData( frames, count );
+	s_entries.insert( key, data );
+	return sharedObject::ref( data );
+}
+
+
+
+
+SampleData * SampleCache::insert( const Key & key, CompactSamples * compact )
+{
+	QMutexLocker lock( &s_mutex );
+	if( SampleData * data = s_entries.value( key, nullptr ) )
+	{
+		delete compact;
+		s_retained.removeOne( key );
+		return sharedObject::ref( data );
+	}
+
+	SampleData * data = new SampleData( compact );
+	s_entries.insert( key, data );
+	return sharedObject::ref( data );
+}
+
+
+
+
+void SampleCache::release( SampleData * data )
+{
+	QMutexLocker lock( &s_mutex );
+	sharedObject::unref( data );
+	if( data->referenceCount() == 1 )
+	{
+		// only the cache is left
+		const SampleCache::Key key = s_entries.key( data );
+		if( key.isValid() )
+		{
+			dropOrRetain( key );
+		}
+	}
+}
+
+
+
+
+void SampleCache::decodeInBackground( const Key & key, DecodeFunction decode, bool prefetch )
+{
+	QMutexLocker lock( &s_mutex );
+	if( s_entries.contains( key ) || s_decoding.contains( key ) )
+	{
+		return;
+	}
+	s_decoding.insert( key );
+	pool().start( new SampleDecodeJob( key, decode, prefetch ) );
+}
+
+
+
+
+bool SampleCache::isDecoding( const Key & key )
+{
+	QMutexLocker lock( &s_mutex );
+	return s_decoding.contains( key );
+}
+
+
+
+
+void SampleCache::waitForDecoding( const Key & key )
+{
+	QMutexLocker lock( &s_mutex );
+	while( key.isValid() ? s_decoding.contains( key ) : !s_decoding.isEmpty() )
+	{
+		s_decoded.wait( &s_mutex );
+	}
+}
+
+
+
+
+int SampleCache::files()
+{
+	QMutexLocker lock( &s_mutex );
+	return s_entries.size();
+}
+
+
+
+
+size_t SampleCache::bytes()
+{
+	QMutexLocker lock( &s_mutex );
+	size_t total = 0;
+	for( const SampleData * data : s_entries )
+	{
+		total += data->bytes();
+	}
+	return total;
+}
+
+
+
+
+size_t SampleCache::bytesSaved()
+{
+	QMutexLocker lock( &s_mutex );
+	size_t total = 0;
+	for( const SampleData * data : s_entries )
+	{
+		// one reference is the cache's, one the first buffer's
+		total += qMax( data->referenceCount() - 2, 0 ) * data->bytes();
+	}
+	return total;
+}
+
+
+
+
+std::vector<SampleCache::Entry> SampleCache::entries()
+{
+	QMutexLocker lock( &s_mutex );
+	std::vector<Entry> entries;
+	for( auto it = s_entries.constBegin(); it != s_entries.constEnd(); ++it )
+	{
+		entries.push_back( { it.key(), it.value()->bytes(), it.value()->referenceCount() - 1 } );
+	}
+	return entries;
+}
+
+
+
+
+size_t SampleCache::dropRetained()
+{
+	QMutexLocker lock( &s_mutex );
+	size_t freed = 0;
+	for( const Key & key : s_retained )
+	{
+		SampleData * data = s_entries.take( key );
+		freed += data->bytes();
+		sharedObject::unref( data );
+	}
+	s_retained.clear();
+	return freed;
+}
+
+
+
+
+SampleCache * SampleCache::inst()
+{
+	// created by the first SampleBuffer, in the GUI thread
+	static SampleCache cache;
+	return &cache;
+}
+
+
+
+
+void SampleCache::dropUnused()
+{
+	QMutexLocker lock( &s_mutex );
+	QList<Key> unused;
+	for( auto it = s_entries.begin(); it != s_entries.end(); ++it )
+	{
+		if( it.value()->referenceCount() == 1 && !s_retained.contains( it.key() ) )
+		{
+			unused.append( it.key() );
+		}
+	}
+	for( const Key & key : unused )
+	{
+		dropOrRetain( key );
+	}
+}
@@ -26,14 +26,21 @@
 
 #include <QDomElement>
 
+#include "DataFile.h"
 #include "SampleClipView.h"
+#include "SamplePlayHandle.h"
+#include "SampleStream.h"
 #include "TimeLineWidget.h"
 
 SampleClip::SampleClip( Track * _track ) :
 	Clip( _track ),
 	m_sampleBuffer( new SampleBuffer ),
-	m_isPlaying( false )
+	m_isPlaying( false ),
+	m_voice( nullptr )
 {
+	m_sampleBuffer->setBackgroundDecodingAllowed( true );
+	connect( m_sampleBuffer, SIGNAL( sampleUpdated() ), this, SIGNAL( sampleChanged() ) );
+
 	saveJournallingState( false );
 	setSampleFile( "" );
 	restoreJournallingState();
@@ -64,6 +71,10 @@ SampleClip::SampleClip( Track * _track ) :
 			this, SLOT( playbackPositionChanged() ), Qt::DirectConnection );
 	//care about Clip position
 	connect( this, SIGNAL( positionChanged() ), this, SLOT( updateTrackClips() ) );
+	//tell streamed samples where to prefetch
+	connect( this, SIGNAL( positionChanged() ), this, SLOT( updateStreamPosition() ) );
+	connect( this, SIGNAL( lengthChanged() ), this, SLOT( updateStreamPosition() ) );
+	connect( this, SIGNAL( sampleChanged() ), this, SLOT( updateStreamPosition() ) );
 
 	switch( getTrack()->trackContainer()->type() )
 	{
@@ -72,6 +83,8 @@ SampleClip::SampleClip( Track * _track ) :
 			break;
 
 		case TrackContainer::SongContainer:
+			// long samples in the song editor are played from disk
+			m_sampleBuffer->setStreamingAllowed( true );
 			// move down
 		default:
 			setAutoResize( false );
@@ -83,9 +96,8 @@ SampleClip::SampleClip( Track * _track ) :
 SampleClip::SampleClip(const SampleClip& orig) :
 	SampleClip(orig.getTrack())
 {
-	// TODO: This creates a new SampleBuffer for the new Clip, eating up memory
-	// & eventually causing performance issues. Letting tracks share buffers
-	// when they're identical would fix this, but isn't possible right now.
+	// The copied buffer shares its decoded frames with the original through
+	// the SampleCache, until one of them is edited.
 	*m_sampleBuffer = *orig.m_sampleBuffer;
 	m_isPlaying = orig.m_isPlaying;
 }
@@ -101,6 +113,7 @@ SampleClip::~SampleClip()
 		sampletrack->updateClips();
 	}
 	Engine::audioEngine()->requestChangeInModel();
+	releaseVoice();
 	sharedObject::unref( m_sampleBuffer );
 	Engine::audioEngine()->doneChangeInModel();
 }
@@ -126,9 +139,12 @@ const QString & SampleClip::sampleFile() const
 void SampleClip::setSampleBuffer( SampleBuffer* sb )
 {
 	Engine::audioEngine()->requestChangeInModel();
+	// the voice keeps playing the buffer it was created for
+	releaseVoice();
 	sharedObject::unref( m_sampleBuffer );
 	Engine::audioEngine()->doneChangeInModel();
 	m_sampleBuffer = sb;
+	connect( m_sampleBuffer, SIGNAL( sampleUpdated() ), this, SIGNAL( sampleChanged() ) );
 	updateLength();
 
 	emit sampleChanged();
@@ -175,6 +191,20 @@ void SampleClip::playbackPositionChanged()
 	Engine::audioEngine()->removePlayHandlesOfTypes( getTrack(), PlayHandle::TypeSamplePlayHandle );
 	SampleTrack * st = dynamic_cast<SampleTrack*>( getTrack() );
 	st->setPlayingClips( false );
+	updateStreamPosition();
+}
+
+
+
+
+void SampleClip::updateStreamPosition()
+{
+	// the start time offset changes without a signal, so this is also
+	// called whenever playback starts or stops
+	if( SampleStream * stream = m_sampleBuffer->stream() )
+	{
+		stream->setClipPosition( startPosition(), endPosition(), startTimeOffset() );
+	}
 }
 
 
@@ -208,6 +238,32 @@ void SampleClip::setIsPlaying(bool isPlaying)
 
 
 
+SamplePlayHandle * SampleClip::voice()
+{
+	if( m_voice == nullptr )
+	{
+		m_voice = new SamplePlayHandle( this );
+		m_voice->setRecycled( true );
+	}
+	return m_voice;
+}
+
+
+
+
+void SampleClip::releaseVoice()
+{
+	if( m_voice )
+	{
+		Engine::audioEngine()->dropPlayHandle( m_voice );
+		delete m_voice;
+		m_voice = nullptr;
+	}
+}
+
+
+
+
 void SampleClip::updateLength()
 {
 	emit sampleChanged();
@@ -256,8 +312,7 @@ void SampleClip::saveSettings( QDomDocument & _doc, QDomElement & _this )
 	_this.setAttribute( "off", startTimeOffset() );
 	if( sampleFile() == "" )
 	{
-		QString s;
-		_this.setAttribute( "data", m_sampleBuffer->toBase64( s ) );
+		_this.setAttribute( "data", DataFile::embed( _doc, m_sampleBuffer->toData() ) );
 	}
 
 	_this.setAttribute( "sample_rate", m_sampleBuffer->sampleRate());
@@ -284,11 +339,12 @@ void SampleClip::loadSettings( const QDomElement & _this )
 	setSampleFile( _this.attribute( "src" ) );
 	if( sampleFile().isEmpty() && _this.hasAttribute( "data" ) )
 	{
-		m_sampleBuffer->loadFromBase64( _this.attribute( "data" ) );
+		m_sampleBuffer->loadFromData( DataFile::embedded( _this, "data" ) );
 	}
 	changeLength( _this.attribute( "len" ).toInt() );
 	setMuted( _this.attribute( "muted" ).toInt() );
 	setStartTimeOffset( _this.attribute( "off" ).toInt() );
+	updateStreamPosition();
 
 	if ( _this.hasAttribute( "sample_rate" ) ) {
 		m_sampleBuffer->setSampleRate( _this.attribute( "sample_rate" ).toInt() );
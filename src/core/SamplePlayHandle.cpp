@@ -141,6 +141,15 @@ bool SamplePlayHandle::isFromTrack( const Track * _track ) const
 
 
 
+void SamplePlayHandle::rewind()
+{
+	m_frame = 0;
+	m_state.reset();
+}
+
+
+
+
 f_cnt_t SamplePlayHandle::totalFrames() const
 {
 	return ( m_sampleBuffer->endFrame() - m_sampleBuffer->startFrame() ) *
@@ -24,23 +24,190 @@
 
 
 #include "SampleRecordHandle.h"
+
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QThread>
+
+#include <sndfile.h>
+
 #include "AudioEngine.h"
 #include "BBTrack.h"
+#include "ConfigManager.h"
 #include "Engine.h"
 #include "InstrumentTrack.h"
+#include "LocklessRingBuffer.h"
 #include "SampleBuffer.h"
 #include "SampleTrack.h"
 #include "debug.h"
 
 
+namespace
+{
+
+//! How much the writer thread may fall behind the audio thread
+const int QueueSeconds = 4;
+
+//! How long the writer thread sleeps when there's nothing to write
+const unsigned long IdleMilliseconds = 10;
+
+}
+
+
+
+
+//! Writes the frames the audio thread queues into a WAV file, as 32 bit
+//! floats, so the file holds exactly what was recorded
+class SampleRecordWriter : public QThread
+{
+public:
+	//! Returns nullptr if the file can't be created
+	static std::unique_ptr<SampleRecordWriter> create( sample_rate_t sampleRate )
+	{
+		const QString dir = ConfigManager::inst()->userSamplesDir() + "recordings/";
+		if( !QDir().mkpath( dir ) )
+		{
+			return nullptr;
+		}
+		const QString base = dir + "recording-" +
+			QDateTime::currentDateTime().toString( "yyyyMMdd-hhmmss" );
+		QString fileName = base + ".wav";
+		for( int i = 2; QFile::exists( fileName ); ++i )
+		{
+			fileName = base + QString( "-%1.wav" ).arg( i );
+		}
+
+		// Use QFile to handle unicode file names on Windows
+		auto file = std::make_unique<QFile>( fileName );
+		SF_INFO info;
+		info.frames = 0;
+		info.samplerate = sampleRate;
+		info.channels = DEFAULT_CHANNELS;
+		info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+		info.sections = 0;
+		info.seekable = 0;
+		SNDFILE * sndFile = nullptr;
+		if( !file->open( QIODevice::WriteOnly ) ||
+			( sndFile = sf_open_fd( file->handle(), SFM_WRITE, &info, false ) ) == nullptr )
+		{
+			file->close();
+			QFile::remove( fileName );
+			return nullptr;
+		}
+
+		std::unique_ptr<SampleRecordWriter> writer(
+			new SampleRecordWriter( std::move( file ), sndFile, sampleRate ) );
+		writer->start();
+		return writer;
+	}
+
+	~SampleRecordWriter() override
+	{
+		finish();
+	}
+
+	//! Audio thread. Frames which don't fit into the queue are lost.
+	void write( const sampleFrame * frames, f_cnt_t count )
+	{
+		const f_cnt_t written = static_cast<f_cnt_t>( m_queue.write( frames, count ) );
+		if( written < count )
+		{
+			m_lostFrames.fetch_add( count - written, std::memory_order_relaxed );
+		}
+	}
+
+	//! Writes what's still queued and closes the file. The audio thread
+	//! mustn't write() anymore.
+	void finish()
+	{
+		if( m_sndFile == nullptr )
+		{
+			return;
+		}
+		requestInterruption();
+		wait();
+		sf_close( m_sndFile );
+		m_sndFile = nullptr;
+		m_file->close();
+
+		if( const f_cnt_t lost = m_lostFrames.load( std::memory_order_relaxed ) )
+		{
+			fprintf( stderr, "Recording to %s lost %d frames, the disk didn't keep up\n",
+				m_file->fileName().toUtf8().constData(), lost );
+		}
+	}
+
+	QString fileName() const
+	{
+		return m_file->fileName();
+	}
+
+protected:
+	void run() override
+	{
+		LocklessRingBufferReader<sampleFrame> reader( m_queue );
+		std::vector<sampleFrame> block;
+		while( true )
+		{
+			// everything queued before the request is still written
+			const bool finishing = isInterruptionRequested();
+			if( reader.empty() )
+			{
+				if( finishing )
+				{
+					break;
+				}
+				msleep( IdleMilliseconds );
+				continue;
+			}
+
+			auto frames = reader.read_max( m_queue.capacity() );
+			block.resize( frames.size() );
+			for( std::size_t i = 0; i < frames.size(); ++i )
+			{
+				block[i][0] = frames[i][0];
+				block[i][1] = frames[i][1];
+			}
+			sf_writef_float( m_sndFile, block.data()[0], block.size() );
+		}
+	}
+
+private:
+	SampleRecordWriter( std::unique_ptr<QFile> file, SNDFILE * sndFile, sample_rate_t sampleRate ) :
+		m_file( std::move( file ) ),
+		m_sndFile( sndFile ),
+		m_queue( static_cast<std::size_t>( QueueSeconds ) * sampleRate ),
+		m_lostFrames( 0 )
+	{
+	}
+
+	std::unique_ptr<QFile> m_file;
+	SNDFILE * m_sndFile;
+	LocklessRingBuffer<sampleFrame> m_queue;
+	std::atomic<f_cnt_t> m_lostFrames;
+} ;
+
+
 SampleRecordHandle::SampleRecordHandle( SampleClip* clip ) :
 	PlayHandle( TypeSamplePlayHandle ),
 	m_framesRecorded( 0 ),
+	m_latency( -1 ),
 	m_minLength( clip->length() ),
 	m_track( clip->getTrack() ),
 	m_bbTrack( nullptr ),
 	m_clip( clip )
 {
+	// streamed to disk, so long takes don't pile up in memory and don't
+	// have to be copied into a SampleBuffer when recording stops
+	if( ConfigManager::inst()->value( "audioengine", "recordtodisk", "1" ).toInt() )
+	{
+		m_writer = SampleRecordWriter::create( Engine::audioEngine()->inputSampleRate() );
+	}
 }
 
 
@@ -48,7 +215,22 @@ SampleRecordHandle::SampleRecordHandle( SampleClip* clip ) :
 
 SampleRecordHandle::~SampleRecordHandle()
 {
-	if( !m_buffers.empty() )
+	if( m_writer )
+	{
+		m_writer->finish();
+		const QString fileName = m_writer->fileName();
+		m_writer.reset();
+		if( m_framesRecorded > 0 )
+		{
+			// long takes are streamed from the file, see SampleStream
+			m_clip->sampleBuffer()->setAudioFile( fileName );
+		}
+		else
+		{
+			QFile::remove( fileName );
+		}
+	}
+	else if( !m_buffers.empty() )
 	{
 		SampleBuffer* sb;
 		createSampleBuffer( &sb );
@@ -69,8 +251,27 @@ SampleRecordHandle::~SampleRecordHandle()
 void SampleRecordHandle::play( sampleFrame * /*_working_buffer*/ )
 {
 	const sampleFrame * recbuf = Engine::audioEngine()->inputBuffer();
-	const f_cnt_t frames = Engine::audioEngine()->inputBufferFrames();
-	writeBuffer( recbuf, frames );
+	f_cnt_t frames = Engine::audioEngine()->inputBufferFrames();
+
+	// what was played while the clip's start was on its way to the
+	// speakers belongs before the clip
+	if( m_latency < 0 )
+	{
+		m_latency = Engine::audioEngine()->inputLatency();
+	}
+	const f_cnt_t skipped = qMin( frames, m_latency );
+	recbuf += skipped;
+	frames -= skipped;
+	m_latency -= skipped;
+
+	if( m_writer )
+	{
+		m_writer->write( recbuf, frames );
+	}
+	else
+	{
+		writeBuffer( recbuf, frames );
+	}
 	m_framesRecorded += frames;
 
 	TimePos len = (tick_t)( m_framesRecorded / Engine::framesPerTick() );
@@ -0,0 +1,562 @@
+/*
+ * SampleStream.cpp - plays long samples from disk instead of from memory
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "SampleStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QThread>
+
+#include "AudioEngine.h"
+#include "ConfigManager.h"
+#include "Engine.h"
+#include "Song.h"
+#include "TimeLineWidget.h"
+
+
+namespace
+{
+
+//! Frames decoded per stream and pass of the I/O thread, so that one stream
+//! can't keep the others waiting
+const f_cnt_t ChunkFrames = 8192;
+
+//! How much is queued ahead of the play position
+const int QueueSeconds = 4;
+
+//! How long before a clip starts its stream is cued
+const int PrefetchSeconds = 2;
+
+//! How long the I/O thread sleeps when no stream needs decoding
+const unsigned long IdleMilliseconds = 5;
+
+//! While exporting, how long to wait for the I/O thread
+const int ExportWaitMicroseconds = 100;
+const int ExportWaits = 10000;
+
+
+uint64_t packRequest(uint32_t generation, f_cnt_t frame)
+{
+	return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(frame);
+}
+
+uint32_t requestGeneration(uint64_t request)
+{
+	return static_cast<uint32_t>(request >> 32);
+}
+
+f_cnt_t requestFrame(uint64_t request)
+{
+	return static_cast<f_cnt_t>(static_cast<uint32_t>(request));
+}
+
+size_t queueSize(sample_rate_t sampleRate)
+{
+	size_t size = 1;
+	while (size < static_cast<size_t>(QueueSeconds) * sampleRate)
+	{
+		size <<= 1;
+	}
+	return size;
+}
+
+}
+
+
+
+
+//! Decodes for all streams. Runs while there is at least one stream.
+class SampleStreamThread : public QThread
+{
+public:
+	static QMutex s_streamsMutex;
+	static std::vector<SampleStream *> s_streams;
+	static SampleStreamThread * s_thread;
+
+protected:
+	void run() override
+	{
+		while (!isInterruptionRequested())
+		{
+			bool busy = false;
+			{
+				QMutexLocker lock(&s_streamsMutex);
+				for (SampleStream * stream : s_streams)
+				{
+					stream->cue();
+					busy = stream->service() || busy;
+				}
+			}
+			if (!busy)
+			{
+				msleep(IdleMilliseconds);
+			}
+		}
+	}
+} ;
+
+QMutex SampleStreamThread::s_streamsMutex;
+std::vector<SampleStream *> SampleStreamThread::s_streams;
+SampleStreamThread * SampleStreamThread::s_thread = nullptr;
+
+
+
+
+std::unique_ptr<SampleStream> SampleStream::open(const QString & file)
+{
+	// samples shorter than this are decoded into memory as before,
+	// 0 disables streaming
+	const int minimumSeconds = ConfigManager::inst()->value(
+		"audioengine", "streamsamplesover", "60").toInt();
+	// SampleBuffer decodes OGG files with libvorbis to work around
+	// distortion in libsndfile's decoder, so don't stream those
+	if (minimumSeconds <= 0 || QFileInfo(file).suffix().toLower() == "ogg")
+	{
+		return nullptr;
+	}
+
+	// Use QFile to handle unicode file names on Windows
+	auto qfile = std::make_unique<QFile>(file);
+	SF_INFO info;
+	info.format = 0;
+	SNDFILE * sndFile = nullptr;
+	if (!qfile->open(QIODevice::ReadOnly) ||
+		(sndFile = sf_open_fd(qfile->handle(), SFM_READ, &info, false)) == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (info.channels < 1 || info.samplerate <= 0 || !info.seekable ||
+		info.frames < static_cast<sf_count_t>(minimumSeconds) * info.samplerate)
+	{
+		sf_close(sndFile);
+		return nullptr;
+	}
+
+	return std::unique_ptr<SampleStream>(new SampleStream(std::move(qfile), sndFile, info));
+}
+
+
+
+
+SampleStream::SampleStream(std::unique_ptr<QFile> file, SNDFILE * sndFile, const SF_INFO & info) :
+	m_file(std::move(file)),
+	m_sndFile(sndFile),
+	m_channels(info.channels),
+	m_fileRate(info.samplerate),
+	m_engineRate(Engine::audioEngine()->processingSampleRate()),
+	m_frames(static_cast<f_cnt_t>(static_cast<double>(info.frames) * m_engineRate / m_fileRate)),
+	m_ring(queueSize(m_engineRate)),
+	m_ringMask(static_cast<int64_t>(m_ring.size()) - 1),
+	m_readIndex(0),
+	m_writeIndex(0),
+	m_request(packRequest(1, 0)),
+	m_served(0),
+	m_startIndex(0),
+	m_endOfFile(false),
+	m_resampler(nullptr),
+	m_fileBuffer(ChunkFrames * m_channels),
+	m_input(ChunkFrames),
+	m_inputFrames(0),
+	m_endOfInput(false),
+	m_output(ChunkFrames),
+	m_decodeFrame(0),
+	m_clipStart(0),
+	m_clipEnd(0),
+	m_clipOffset(0)
+{
+	if (m_fileRate != m_engineRate)
+	{
+		int error;
+		if ((m_resampler = src_new(SRC_SINC_MEDIUM_QUALITY, DEFAULT_CHANNELS, &error)) == nullptr)
+		{
+			qWarning("SampleStream: src_new() failed: %s", src_strerror(error));
+		}
+	}
+
+	registerStream();
+}
+
+
+
+
+SampleStream::~SampleStream()
+{
+	unregisterStream();
+
+	if (m_resampler != nullptr)
+	{
+		src_delete(m_resampler);
+	}
+	sf_close(m_sndFile);
+}
+
+
+
+
+void SampleStream::read(sampleFrame * dst, f_cnt_t frame, fpp_t frames)
+{
+	f_cnt_t copied = tryRead(dst, frame, frames);
+
+	// rendering offline doesn't have to keep up with real time, so give
+	// the I/O thread the time it needs instead of exporting gaps
+	if (copied < frames && Engine::getSong()->isExporting())
+	{
+		for (int i = 0; i < ExportWaits && copied < frames; ++i)
+		{
+			if (m_endOfFile && m_request.load() == m_served.load())
+			{
+				break;
+			}
+			QThread::usleep(ExportWaitMicroseconds);
+			copied += tryRead(dst + copied, frame + copied, frames - copied);
+		}
+	}
+
+	if (copied < frames)
+	{
+		memset(dst + copied, 0, (frames - copied) * sizeof(sampleFrame));
+	}
+}
+
+
+
+
+void SampleStream::setClipPosition(tick_t start, tick_t end, tick_t offset)
+{
+	m_clipStart = start;
+	m_clipEnd = end;
+	m_clipOffset = offset;
+}
+
+
+
+
+f_cnt_t SampleStream::tryRead(sampleFrame * dst, f_cnt_t frame, fpp_t frames)
+{
+	// the I/O thread clears m_served while it moves m_startIndex
+	const uint64_t served = m_served.load();
+	const int64_t start = m_startIndex.load();
+	f_cnt_t queuedFrame = -1;
+	f_cnt_t copied = 0;
+
+	if (served != 0 && m_served.load() == served)
+	{
+		// frames before m_startIndex belong to an older request
+		int64_t read = m_readIndex.load();
+		const int64_t first = std::max(read, start);
+		const int64_t available = m_writeIndex.load() - first;
+		queuedFrame = requestFrame(served) + static_cast<f_cnt_t>(first - start);
+
+		const int64_t skip = frame - queuedFrame;
+		if (skip >= 0 && skip < available)
+		{
+			copied = static_cast<f_cnt_t>(std::min<int64_t>(frames, available - skip));
+			for (f_cnt_t i = 0; i < copied; ++i)
+			{
+				dst[i] = m_ring[(first + skip + i) & m_ringMask];
+			}
+			// if the I/O thread seeked meanwhile, the frames may be
+			// overwritten already
+			if (!m_readIndex.compare_exchange_strong(read, first + skip + copied) ||
+				m_served.load() != served)
+			{
+				copied = 0;
+			}
+		}
+	}
+
+	if (copied == 0)
+	{
+		// seek, unless the frames are about to be decoded anyway
+		const uint64_t request = m_request.load();
+		const f_cnt_t next = request == served && queuedFrame >= 0
+			? queuedFrame : requestFrame(request);
+		if (frame < next || frame - next >= static_cast<f_cnt_t>(m_ring.size() / 2))
+		{
+			requestSeek(frame);
+		}
+	}
+
+	return copied;
+}
+
+
+
+
+void SampleStream::requestSeek(f_cnt_t frame)
+{
+	uint32_t generation = requestGeneration(m_request.load()) + 1;
+	// a request of 0 would look like none was served yet
+	if (generation == 0)
+	{
+		generation = 1;
+	}
+	m_request = packRequest(generation, frame);
+}
+
+
+
+
+void SampleStream::cue()
+{
+	const tick_t start = m_clipStart;
+	const tick_t end = m_clipEnd;
+	const tick_t offset = m_clipOffset;
+	const Song * song = Engine::getSong();
+	if (end <= start || song == nullptr)
+	{
+		return;
+	}
+
+	const tick_t playPosition = song->getPlayPos(Song::Mode_PlaySong).getTicks();
+	const bool playing = song->isPlaying() && song->playMode() == Song::Mode_PlaySong;
+	if (playing && playPosition >= start && playPosition < end)
+	{
+		// the clip plays, so its play handle moves the stream
+		return;
+	}
+
+	const float framesPerTick = Engine::framesPerTick(m_engineRate);
+	tick_t position = playPosition;
+	const TimeLineWidget * timeLine = song->getPlayPos(Song::Mode_PlaySong).m_timeLine;
+	if (playing && timeLine && timeLine->loopPointsEnabled())
+	{
+		// if the loop jumps back before playback reaches the clip, it
+		// enters the clip from the beginning of the loop
+		const tick_t loopBegin = timeLine->loopBegin().getTicks();
+		const tick_t loopEnd = timeLine->loopEnd().getTicks();
+		const bool reachedFirst = start > playPosition && start < loopEnd;
+		if (!reachedFirst && playPosition < loopEnd &&
+			(loopEnd - playPosition) * framesPerTick <= PrefetchSeconds * m_engineRate)
+		{
+			position = loopBegin;
+		}
+	}
+	const bool inside = position >= start && position < end;
+
+	// like SampleTrack::play() computes the frame a clip starts playing at
+	if (!inside && (position > start ||
+		(start - position) * framesPerTick > PrefetchSeconds * m_engineRate))
+	{
+		return;
+	}
+	const tick_t entry = std::max(inside ? position : start, start + offset);
+	const f_cnt_t frame = static_cast<f_cnt_t>(framesPerTick * (entry - start - offset));
+	if (frame >= m_frames)
+	{
+		return;
+	}
+
+	const uint64_t request = m_request.load();
+	const uint64_t served = m_served.load();
+	f_cnt_t queuedFrame = requestFrame(request);
+	if (request == served)
+	{
+		queuedFrame += static_cast<f_cnt_t>(
+			std::max<int64_t>(m_readIndex.load() - m_startIndex.load(), 0));
+	}
+	if (queuedFrame != frame)
+	{
+		requestSeek(frame);
+	}
+}
+
+
+
+
+bool SampleStream::service()
+{
+	const uint64_t request = m_request.load();
+	if (request != m_served.load())
+	{
+		seek(requestFrame(request));
+
+		const int64_t start = m_writeIndex.load();
+		m_served = 0;
+		m_startIndex = start;
+		m_served = request;
+
+		// give the space of the frames queued for the old request back
+		int64_t read = m_readIndex.load();
+		while (read < start && !m_readIndex.compare_exchange_weak(read, start))
+		{
+		}
+	}
+
+	if (m_endOfFile)
+	{
+		return false;
+	}
+
+	const int64_t write = m_writeIndex.load();
+	const int64_t space = static_cast<int64_t>(m_ring.size()) - (write - m_readIndex.load());
+	if (space <= 0)
+	{
+		return false;
+	}
+
+	const f_cnt_t decoded = decode(m_output.data(),
+		static_cast<f_cnt_t>(std::min<int64_t>(space, ChunkFrames)));
+	for (f_cnt_t i = 0; i < decoded; ++i)
+	{
+		m_ring[(write + i) & m_ringMask] = m_output[i];
+	}
+	m_writeIndex = write + decoded;
+
+	return decoded > 0;
+}
+
+
+
+
+void SampleStream::seek(f_cnt_t frame)
+{
+	m_decodeFrame = qBound(0, frame, m_frames);
+	const sf_count_t fileFrame = static_cast<sf_count_t>(
+		static_cast<double>(m_decodeFrame) * m_fileRate / m_engineRate);
+	m_endOfFile = sf_seek(m_sndFile, fileFrame, SEEK_SET) < 0;
+
+	m_inputFrames = 0;
+	m_endOfInput = false;
+	if (m_resampler != nullptr)
+	{
+		src_reset(m_resampler);
+	}
+}
+
+
+
+
+f_cnt_t SampleStream::decode(sampleFrame * dst, f_cnt_t frames)
+{
+	frames = std::min(frames, m_frames - m_decodeFrame);
+	if (frames <= 0)
+	{
+		m_endOfFile = true;
+		return 0;
+	}
+
+	f_cnt_t decoded = 0;
+	if (m_resampler == nullptr)
+	{
+		decoded = readFile(dst, frames);
+		m_endOfFile = decoded == 0;
+	}
+	else
+	{
+		if (!m_endOfInput && m_inputFrames < ChunkFrames)
+		{
+			const f_cnt_t wanted = ChunkFrames - m_inputFrames;
+			const f_cnt_t got = readFile(m_input.data() + m_inputFrames, wanted);
+			m_inputFrames += got;
+			m_endOfInput = got < wanted;
+		}
+
+		SRC_DATA srcData;
+		srcData.data_in = m_input.data()->data();
+		srcData.input_frames = m_inputFrames;
+		srcData.data_out = dst->data();
+		srcData.output_frames = frames;
+		srcData.src_ratio = static_cast<double>(m_engineRate) / m_fileRate;
+		srcData.end_of_input = m_endOfInput ? 1 : 0;
+		const int error = src_process(m_resampler, &srcData);
+		if (error)
+		{
+			qWarning("SampleStream: error while resampling: %s", src_strerror(error));
+			m_endOfFile = true;
+			return 0;
+		}
+
+		std::copy(m_input.begin() + srcData.input_frames_used,
+			m_input.begin() + m_inputFrames, m_input.begin());
+		m_inputFrames -= srcData.input_frames_used;
+		decoded = srcData.output_frames_gen;
+		m_endOfFile = decoded == 0 && m_endOfInput;
+	}
+
+	m_decodeFrame += decoded;
+	return decoded;
+}
+
+
+
+
+f_cnt_t SampleStream::readFile(sampleFrame * dst, f_cnt_t frames)
+{
+	const sf_count_t got = std::max<sf_count_t>(
+		sf_readf_float(m_sndFile, m_fileBuffer.data(), frames), 0);
+
+	// like SampleBuffer, only play the first two channels
+	const int right = m_channels > 1 ? 1 : 0;
+	for (sf_count_t i = 0; i < got; ++i)
+	{
+		dst[i][0] = m_fileBuffer[i * m_channels];
+		dst[i][1] = m_fileBuffer[i * m_channels + right];
+	}
+	return static_cast<f_cnt_t>(got);
+}
+
+
+
+
+void SampleStream::registerStream()
+{
+	QMutexLocker lock(&SampleStreamThread::s_streamsMutex);
+	SampleStreamThread::s_streams.push_back(this);
+	if (SampleStreamThread::s_thread == nullptr)
+	{
+		SampleStreamThread::s_thread = new SampleStreamThread;
+		SampleStreamThread::s_thread->start(QThread::HighPriority);
+	}
+}
+
+
+
+
+void SampleStream::unregisterStream()
+{
+	SampleStreamThread * finished = nullptr;
+	{
+		QMutexLocker lock(&SampleStreamThread::s_streamsMutex);
+		auto & streams = SampleStreamThread::s_streams;
+		streams.erase(std::remove(streams.begin(), streams.end(), this), streams.end());
+		if (streams.empty())
+		{
+			std::swap(finished, SampleStreamThread::s_thread);
+		}
+	}
+
+	// the thread needs the mutex to notice the interruption
+	if (finished != nullptr)
+	{
+		finished->requestInterruption();
+		finished->wait();
+		delete finished;
+	}
+}
@@ -34,6 +34,7 @@
 #include <cmath>
 #include <functional>
 
+#include "AudioEngineWorkerThread.h"
 #include "AutomationTrack.h"
 #include "AutomationEditor.h"
 #include "BBEditor.h"
@@ -42,6 +43,7 @@
 #include "ConfigManager.h"
 #include "ControllerRackView.h"
 #include "ControllerConnection.h"
+#include "DataFileStream.h"
 #include "embed.h"
 #include "EnvelopeAndLfoParameters.h"
 #include "Mixer.h"
@@ -54,6 +56,8 @@
 #include "PianoRoll.h"
 #include "ProjectJournal.h"
 #include "ProjectNotes.h"
+#include "ResourcePreloader.h"
+#include "SampleClip.h"
 #include "SongEditor.h"
 #include "TimeLineWidget.h"
 #include "PeakController.h"
@@ -69,6 +73,7 @@ Song::Song() :
 				Track::create( Track::HiddenAutomationTrack,
 								this ) ) ),
 	m_tempoModel( DefaultTempo, MinTempo, MaxTempo, this, tr( "Tempo" ) ),
+	m_tempoEpoch( 0 ),
 	m_timeSigModel( this ),
 	m_oldTicksPerBar( DefaultTicksPerBar ),
 	m_masterVolumeModel( 100, 0, 200, this, tr( "Master volume" ) ),
@@ -82,6 +87,7 @@ Song::Song() :
 	m_exporting( false ),
 	m_exportLoop( false ),
 	m_renderBetweenMarkers( false ),
+	m_exportTracks(),
 	m_playing( false ),
 	m_paused( false ),
 	m_savingProject( false ),
@@ -143,23 +149,12 @@ void Song::masterVolumeChanged()
 
 void Song::setTempo()
 {
-	Engine::audioEngine()->requestChangeInModel();
 	const bpm_t tempo = ( bpm_t ) m_tempoModel.value();
-	PlayHandleList & playHandles = Engine::audioEngine()->playHandles();
-	for( PlayHandleList::Iterator it = playHandles.begin();
-						it != playHandles.end(); ++it )
-	{
-		NotePlayHandle * nph = dynamic_cast<NotePlayHandle *>( *it );
-		if( nph && !nph->isReleased() )
-		{
-			nph->lock();
-			nph->resize( tempo );
-			nph->unlock();
-		}
-	}
-	Engine::audioEngine()->doneChangeInModel();
 
+	// the notes playing resize themselves when they play next, so that a
+	// tempo automated every tick doesn't cost anything per note
 	Engine::updateFramesPerTick();
+	m_tempoEpoch.fetch_add( 1, std::memory_order_release );
 
 	m_vstSyncController.setTempo( tempo );
 
@@ -199,6 +194,16 @@ void Song::savePos()
 void Song::processNextBuffer()
 {
 	m_vstSyncController.setPlaybackJumped(false);
+	playNextBuffer();
+	// one update of the VST plugins' transport for the whole period
+	m_vstSyncController.publish();
+}
+
+
+
+
+void Song::playNextBuffer()
+{
 
 	// If nothing is playing, there is nothing to do
 	if (!m_playing) { return; }
@@ -216,7 +221,8 @@ void Song::processNextBuffer()
 	switch (m_playMode)
 	{
 		case Mode_PlaySong:
-			trackList = tracks();
+			// automation is processed for the whole song anyway
+			trackList = m_exporting && !m_exportTracks.empty() ? m_exportTracks : tracks();
 			break;
 
 		case Mode_PlayBB:
@@ -331,17 +337,13 @@ void Song::processNextBuffer()
 			// but before actually playing any frames.
 			m_vstSyncController.setAbsolutePosition(getPlayPos().getTicks()
 				+ getPlayPos().currentFrame() / static_cast<double>(framesPerTick));
-			m_vstSyncController.update();
 		}
 
 		if (static_cast<f_cnt_t>(frameOffsetInTick) == 0)
 		{
 			// First frame of tick: process automation and play tracks
 			processAutomations(trackList, getPlayPos(), framesToPlay);
-			for (const auto track : trackList)
-			{
-				track->play(getPlayPos(), framesToPlay, frameOffsetInPeriod, clipNum);
-			}
+			playTracks(trackList, getPlayPos(), framesToPlay, frameOffsetInPeriod, clipNum);
 		}
 
 		// Update frame counters
@@ -357,10 +359,6 @@ void Song::processNextBuffer()
 
 void Song::processAutomations(const TrackList &tracklist, TimePos timeStart, fpp_t)
 {
-	AutomatedValueMap values;
-
-	QSet<const AutomatableModel*> recordedModels;
-
 	TrackContainer* container = this;
 	int clipNum = -1;
 
@@ -382,57 +380,130 @@ void Song::processAutomations(const TrackList &tracklist, TimePos timeStart, fpp
 		return;
 	}
 
-	values = container->automatedValuesAt(timeStart, clipNum);
-	TrackList tracks = container->tracks();
-
-	Track::clipVector clips;
-	for (Track* track : tracks)
-	{
-		if (track->type() == Track::AutomationTrack) {
-			track->getClipsInRange(clips, 0, timeStart);
-		}
-	}
+	m_automatedValues.clear();
+	container->collectAutomatedValues(timeStart, clipNum, m_automatedValues);
 
 	// Process recording
-	for (Clip* clip : clips)
+	m_recordedModels.clear();
+	container->forEachStartedClip(timeStart, [&](Clip* clip)
 	{
-		auto p = dynamic_cast<AutomationClip *>(clip);
+		if (clip->getTrack()->type() != Track::AutomationTrack) { return; }
+
+		auto p = static_cast<AutomationClip *>(clip);
 		TimePos relTime = timeStart - p->startPosition();
 		if (p->isRecording() && relTime >= 0 && relTime < p->length())
 		{
 			const AutomatableModel* recordedModel = p->firstObject();
 			p->recordValue(relTime, recordedModel->value<float>());
 
-			recordedModels << recordedModel;
+			m_recordedModels.push_back(recordedModel);
 		}
-	}
+	});
 
 	// Checks if an automated model stopped being automated by automation clip
 	// so we can move the control back to any connected controller again
-	for (auto it = m_oldAutomatedValues.begin(); it != m_oldAutomatedValues.end(); it++)
+	for (const auto& oldValue : m_oldAutomatedValues)
 	{
-		AutomatableModel * am = it.key();
-		if (am->controllerConnection() && !values.contains(am))
+		AutomatableModel * am = oldValue.first;
+		auto it = std::lower_bound(m_automatedValues.begin(), m_automatedValues.end(), am,
+			[](const AutomatedValueList::value_type& v, const AutomatableModel* m) { return v.first < m; });
+		if (am->controllerConnection() && (it == m_automatedValues.end() || it->first != am))
 		{
 			am->setUseControllerValue(true);
 		}
 	}
-	m_oldAutomatedValues = values;
+	std::swap(m_oldAutomatedValues, m_automatedValues);
 
 	// Apply values
-	for (auto it = values.begin(); it != values.end(); it++)
+	for (const auto& value : m_oldAutomatedValues)
 	{
-		if (! recordedModels.contains(it.key()))
+		if (std::find(m_recordedModels.begin(), m_recordedModels.end(), value.first) == m_recordedModels.end())
 		{
-			it.key()->setAutomatedValue(it.value());
+			value.first->setAutomatedValue(value.second);
 		}
-		else if (!it.key()->useControllerValue())
+		else if (!value.first->useControllerValue())
 		{
-			it.key()->setUseControllerValue(true);
+			value.first->setUseControllerValue(true);
 		}
 	}
 }
 
+void Song::playTracks(const TrackList& tracks, const TimePos& start, fpp_t frames, f_cnt_t offset, int clipNum)
+{
+	if (tracks.size() < 2)
+	{
+		for (const auto track : tracks)
+		{
+			track->play(start, frames, offset, clipNum);
+		}
+		return;
+	}
+
+	// one job per track, except for BB tracks: they all play the tracks of
+	// the BB container, so they have to take turns in a single job. The
+	// jobs are reserved when tracks are added, they aren't allocated here.
+	if (m_trackPlayJobs.size() < static_cast<size_t>(tracks.size()) + 1 ||
+		m_trackPlayJobs[0]->capacity() < static_cast<size_t>(tracks.size()))
+	{
+		for (const auto track : tracks)
+		{
+			track->play(start, frames, offset, clipNum);
+		}
+		return;
+	}
+	for (auto& job : m_trackPlayJobs)
+	{
+		job->setTick(start, frames, offset, clipNum);
+	}
+
+	size_t jobs = 1;
+	for (const auto track : tracks)
+	{
+		switch (track->type())
+		{
+		case Track::BBTrack:
+			m_trackPlayJobs[0]->addTrack(track);
+			break;
+		case Track::AutomationTrack:
+		case Track::HiddenAutomationTrack:
+			// nothing to play, automation is done by processAutomations()
+			break;
+		default:
+			m_trackPlayJobs[jobs++]->addTrack(track);
+			break;
+		}
+	}
+
+	AudioEngineWorkerThread::resetJobQueue();
+	AudioEngineWorkerThread::reserveJobs(jobs);
+	for (size_t i = 0; i < jobs; ++i)
+	{
+		AudioEngineWorkerThread::addJob(m_trackPlayJobs[i].get());
+	}
+	AudioEngineWorkerThread::startAndWaitForJobs();
+}
+
+void Song::reserveTrackPlayJobs(int tracks)
+{
+	const size_t jobs = static_cast<size_t>(tracks) + 1;
+	if (m_trackPlayJobs.size() >= jobs && m_trackPlayJobs[0]->capacity() >= static_cast<size_t>(tracks))
+	{
+		return;
+	}
+
+	// grown in steps, so that adding tracks one by one only rarely has to
+	// wait for the audio thread
+	const size_t size = std::max(jobs, m_trackPlayJobs.size() * 2);
+	Engine::audioEngine()->requestChangeInModel();
+	while (m_trackPlayJobs.size() < size)
+	{
+		m_trackPlayJobs.emplace_back(new TrackPlayJob);
+		m_trackPlayJobs.back()->reserve(1);
+	}
+	m_trackPlayJobs[0]->reserve(size - 1);
+	Engine::audioEngine()->doneChangeInModel();
+}
+
 void Song::setModified(bool value)
 {
 	if( !m_loadingProject && m_modified != value)
@@ -570,7 +641,8 @@ void Song::updateLength()
 	m_tracksMutex.lockForRead();
 	for (auto track : tracks())
 	{
-		if (m_exporting && track->isMuted())
+		if (m_exporting && (track->isMuted() || (!m_exportTracks.empty() && !m_exportTracks.contains(track) &&
+			track->type() != Track::AutomationTrack && track->type() != Track::HiddenAutomationTrack)))
 		{
 			continue;
 		}
@@ -691,10 +763,9 @@ void Song::stop()
 
 	// Moves the control of the models that were processed on the last frame
 	// back to their controllers.
-	for (auto it = m_oldAutomatedValues.begin(); it != m_oldAutomatedValues.end(); it++)
+	for (const auto& value : m_oldAutomatedValues)
 	{
-		AutomatableModel * am = it.key();
-		am->setUseControllerValue(true);
+		value.first->setUseControllerValue(true);
 	}
 	m_oldAutomatedValues.clear();
 
@@ -713,6 +784,9 @@ void Song::startExport()
 {
 	stop();
 
+	// the export mustn't miss samples still decoding
+	SampleBuffer::waitForAllDecoding();
+
 	m_exporting = true;
 	updateLength();
 
@@ -763,6 +837,36 @@ void Song::startExport()
 
 
 
+void Song::setExportTrack( Track * track )
+{
+	m_exportTracks.clear();
+	if( track )
+	{
+		m_exportTracks.push_back( track );
+	}
+}
+
+
+
+
+void Song::instantiateDeferredInstruments()
+{
+	for( TrackContainer * container : { static_cast<TrackContainer *>( this ),
+			static_cast<TrackContainer *>( Engine::getBBTrackContainer() ) } )
+	{
+		for( Track * track : container->tracks() )
+		{
+			if( track->type() == Track::InstrumentTrack )
+			{
+				static_cast<InstrumentTrack *>( track )->instantiateInstrument();
+			}
+		}
+	}
+}
+
+
+
+
 void Song::stopExport()
 {
 	stop();
@@ -841,9 +945,9 @@ AutomationClip * Song::tempoAutomationClip()
 }
 
 
-AutomatedValueMap Song::automatedValuesAt(TimePos time, int clipNum) const
+TrackContainer::TrackList Song::automationSourceTracks() const
 {
-	return TrackContainer::automatedValuesFromTracks(TrackList{m_globalAutomationTrack} << tracks(), time, clipNum);
+	return TrackList{m_globalAutomationTrack} << tracks();
 }
 
 
@@ -899,7 +1003,7 @@ void Song::clearProject()
 	m_masterPitchModel.reset();
 	m_timeSigModel.reset();
 
-	// Clear the m_oldAutomatedValues AutomatedValueMap
+	// Clear the m_oldAutomatedValues AutomatedValueList
 	m_oldAutomatedValues.clear();
 
 	AutomationClip::globalAutomationClip( &m_tempoModel )->clear();
@@ -994,7 +1098,16 @@ void Song::createNewProject()
 
 void Song::createNewProjectFromTemplate( const QString & templ )
 {
-	loadProject( templ );
+	// File > New, the templates menu and the start up load the same few
+	// templates over and over, so they are only parsed when they changed
+	const QDateTime modified = QFileInfo( templ ).lastModified();
+	ParsedTemplate & parsed = m_templates[templ];
+	if( !parsed.dataFile || parsed.modified != modified )
+	{
+		parsed.dataFile = std::make_shared<DataFile>( templ );
+		parsed.modified = modified;
+	}
+	loadProject( templ, std::unique_ptr<DataFile>( new DataFile( parsed.dataFile->clone() ) ) );
 	// clear file-name so that user doesn't overwrite template when
 	// saving...
 	m_oldFileName = "";
@@ -1008,6 +1121,22 @@ void Song::createNewProjectFromTemplate( const QString & templ )
 
 // load given song
 void Song::loadProject( const QString & fileName )
+{
+	loadProject( fileName, nullptr );
+}
+
+
+
+
+void Song::loadProjectData( const QByteArray & data, const QString & fileName )
+{
+	loadProject( fileName, std::unique_ptr<DataFile>( new DataFile( data ) ) );
+}
+
+
+
+
+void Song::loadProject( const QString & fileName, std::unique_ptr<DataFile> document )
 {
 	QDomNode node;
 
@@ -1018,7 +1147,15 @@ void Song::loadProject( const QString & fileName )
 	m_oldFileName = m_fileName;
 	setProjectFileName(fileName);
 
-	DataFile dataFile( m_fileName );
+	// projects of this version are read one track at a time, older ones
+	// need the upgrades of the whole document
+	std::unique_ptr<DataFileStream> stream( document ? nullptr : new DataFileStream( m_fileName ) );
+	if( stream && !stream->isValid() )
+	{
+		stream.reset();
+		document.reset( new DataFile( m_fileName ) );
+	}
+	DataFile & dataFile = stream ? stream->header() : *document;
 
 	bool cantLoadProject = false;
 	// if file could not be opened, head-node is null and we create
@@ -1031,7 +1168,7 @@ void Song::loadProject( const QString & fileName )
 	{
 		// We check if plugins contain local paths to prevent malicious code being
 		// added to project bundles and loaded with "local:" paths
-		if (dataFile.hasLocalPlugins())
+		if (stream ? stream->hasLocalPlugins() : dataFile.hasLocalPlugins())
 		{
 			cantLoadProject = true;
 
@@ -1079,96 +1216,123 @@ void Song::loadProject( const QString & fileName )
 		m_playPos[Mode_PlaySong].m_timeLine->toggleLoopPoints( 0 );
 	}
 
-	if( !dataFile.content().firstChildElement( "track" ).isNull() )
-	{
-		m_globalAutomationTrack->restoreState( dataFile.content().
-						firstChildElement( "track" ) );
-	}
-
-	//Backward compatibility for LMMS <= 0.4.15
-	PeakController::initGetControllerBySetting();
+	// the plugins open their files one after another while the tracks load
+	std::unique_ptr<ResourcePreloader> preloader( new ResourcePreloader );
 
-	// Load mixer first to be able to set the correct range for mixer channels
-	node = dataFile.content().firstChildElement( Engine::mixer()->nodeName() );
-	if( !node.isNull() )
+	if( stream )
 	{
-		Engine::mixer()->restoreState( node.toElement() );
-		if( getGUI() != nullptr )
+		preloader->add( *stream );
+		m_nLoadingTrack = stream->count( "track", TrackContainer::classNodeName() );
+
+		// same order as below: the global automation, the mixer, the rest
+		while( stream->next() )
 		{
-			// refresh MixerView
-			getGUI()->mixerView()->refreshDisplay();
+			if( stream->name() == "track" )
+			{
+				m_globalAutomationTrack->restoreState( stream->element() );
+				break;
+			}
 		}
-	}
+		stream->rewind();
 
-	node = dataFile.content().firstChild();
+		//Backward compatibility for LMMS <= 0.4.15
+		PeakController::initGetControllerBySetting();
 
-	QDomNodeList tclist=dataFile.content().elementsByTagName("trackcontainer");
-	m_nLoadingTrack=0;
-	for( int i=0,n=tclist.count(); i<n; ++i )
-	{
-		QDomNode nd=tclist.at(i).firstChild();
-		while(!nd.isNull())
+		while( stream->next() )
 		{
-			if( nd.isElement() && nd.nodeName() == "track" )
+			if( stream->name() == Engine::mixer()->nodeName() )
 			{
-				++m_nLoadingTrack;
-				if( nd.toElement().attribute("type").toInt() == Track::BBTrack )
+				Engine::mixer()->restoreState( stream->element() );
+				if( getGUI() != nullptr )
 				{
-					n += nd.toElement().elementsByTagName("bbtrack").at(0)
-						.toElement().firstChildElement().childNodes().count();
+					// refresh MixerView
+					getGUI()->mixerView()->refreshDisplay();
 				}
-				nd=nd.nextSibling();
+				break;
 			}
 		}
-	}
+		stream->rewind();
 
-	while( !node.isNull() && !isCancelled() )
-	{
-		if( node.isElement() )
+		while( !isCancelled() && stream->next() )
 		{
-			if( node.nodeName() == "trackcontainer" )
+			const QString name = stream->name();
+			if( name == TrackContainer::classNodeName() )
 			{
-				( (JournallingObject *)( this ) )->restoreState( node.toElement() );
+				loadTracks( *stream );
 			}
-			else if( node.nodeName() == "controllers" )
+			else if( name != "track" && name != Engine::mixer()->nodeName() )
 			{
-				restoreControllerStates( node.toElement() );
+				loadContentElement( stream->element() );
 			}
-			else if (node.nodeName() == "scales")
-			{
-				restoreScaleStates(node.toElement());
-			}
-			else if (node.nodeName() == "keymaps")
+		}
+		stream.reset();
+	}
+	else
+	{
+		preloader->add( dataFile.content() );
+
+		if( !dataFile.content().firstChildElement( "track" ).isNull() )
+		{
+			m_globalAutomationTrack->restoreState( dataFile.content().
+							firstChildElement( "track" ) );
+		}
+
+		//Backward compatibility for LMMS <= 0.4.15
+		PeakController::initGetControllerBySetting();
+
+		// Load mixer first to be able to set the correct range for mixer channels
+		node = dataFile.content().firstChildElement( Engine::mixer()->nodeName() );
+		if( !node.isNull() )
+		{
+			Engine::mixer()->restoreState( node.toElement() );
+			if( getGUI() != nullptr )
 			{
-				restoreKeymapStates(node.toElement());
+				// refresh MixerView
+				getGUI()->mixerView()->refreshDisplay();
 			}
-			else if( getGUI() != nullptr )
+		}
+
+		node = dataFile.content().firstChild();
+
+		QDomNodeList tclist=dataFile.content().elementsByTagName("trackcontainer");
+		m_nLoadingTrack=0;
+		for( int i=0,n=tclist.count(); i<n; ++i )
+		{
+			QDomNode nd=tclist.at(i).firstChild();
+			while(!nd.isNull())
 			{
-				if( node.nodeName() == getGUI()->getControllerRackView()->nodeName() )
-				{
-					getGUI()->getControllerRackView()->restoreState( node.toElement() );
-				}
-				else if( node.nodeName() == getGUI()->pianoRoll()->nodeName() )
-				{
-					getGUI()->pianoRoll()->restoreState( node.toElement() );
-				}
-				else if( node.nodeName() == getGUI()->automationEditor()->m_editor->nodeName() )
+				if( nd.isElement() && nd.nodeName() == "track" )
 				{
-					getGUI()->automationEditor()->m_editor->restoreState( node.toElement() );
+					++m_nLoadingTrack;
+					if( nd.toElement().attribute("type").toInt() == Track::BBTrack )
+					{
+						n += nd.toElement().elementsByTagName("bbtrack").at(0)
+							.toElement().firstChildElement().childNodes().count();
+					}
+					nd=nd.nextSibling();
 				}
-				else if( node.nodeName() == getGUI()->getProjectNotes()->nodeName() )
+			}
+		}
+
+		while( !node.isNull() && !isCancelled() )
+		{
+			if( node.isElement() )
+			{
+				if( node.nodeName() == "trackcontainer" )
 				{
-					 getGUI()->getProjectNotes()->SerializingObject::restoreState( node.toElement() );
+					( (JournallingObject *)( this ) )->restoreState( node.toElement() );
 				}
-				else if( node.nodeName() == m_playPos[Mode_PlaySong].m_timeLine->nodeName() )
+				else
 				{
-					m_playPos[Mode_PlaySong].m_timeLine->restoreState( node.toElement() );
+					loadContentElement( node.toElement() );
 				}
 			}
+			node = node.nextSibling();
 		}
-		node = node.nextSibling();
 	}
 
+	preloader.reset();
+
 	// quirk for fixing projects with broken positions of Clips inside
 	// BB-tracks
 	Engine::getBBTrackContainer()->fixIncorrectPositions();
@@ -1188,6 +1352,24 @@ void Song::loadProject( const QString & fileName )
 
 	Engine::audioEngine()->doneChangeInModel();
 
+	// samples are decoded in the background, but those at the play
+	// position are needed as soon as playback starts
+	const TimePos & playPos = m_playPos[Mode_PlaySong];
+	for( Track * track : tracks() )
+	{
+		if( track->type() != Track::SampleTrack )
+		{
+			continue;
+		}
+		for( Clip * clip : track->getClips() )
+		{
+			if( clip->startPosition() <= playPos && playPos < clip->endPosition() )
+			{
+				static_cast<SampleClip *>( clip )->sampleBuffer()->waitForDecoding();
+			}
+		}
+	}
+
 	ConfigManager::inst()->addRecentlyOpenedProject( fileName );
 
 	Engine::projectJournal()->setJournalling( true );
@@ -1224,10 +1406,61 @@ void Song::loadProject( const QString & fileName )
 }
 
 
+void Song::loadContentElement( const QDomElement & element )
+{
+	if( element.nodeName() == "controllers" )
+	{
+		restoreControllerStates( element );
+	}
+	else if (element.nodeName() == "scales")
+	{
+		restoreScaleStates(element);
+	}
+	else if (element.nodeName() == "keymaps")
+	{
+		restoreKeymapStates(element);
+	}
+	else if( getGUI() != nullptr )
+	{
+		if( element.nodeName() == getGUI()->getControllerRackView()->nodeName() )
+		{
+			getGUI()->getControllerRackView()->restoreState( element );
+		}
+		else if( element.nodeName() == getGUI()->pianoRoll()->nodeName() )
+		{
+			getGUI()->pianoRoll()->restoreState( element );
+		}
+		else if( element.nodeName() == getGUI()->automationEditor()->m_editor->nodeName() )
+		{
+			getGUI()->automationEditor()->m_editor->restoreState( element );
+		}
+		else if( element.nodeName() == getGUI()->getProjectNotes()->nodeName() )
+		{
+			 getGUI()->getProjectNotes()->SerializingObject::restoreState( element );
+		}
+		else if( element.nodeName() == m_playPos[Mode_PlaySong].m_timeLine->nodeName() )
+		{
+			m_playPos[Mode_PlaySong].m_timeLine->restoreState( element );
+		}
+	}
+}
+
+
+
+
 // only save current song as filename and do nothing else
 bool Song::saveProjectFile(const QString & filename, bool withResources)
 {
 	DataFile dataFile( DataFile::SongProject );
+	saveProject( dataFile );
+	return dataFile.writeFile(filename, withResources);
+}
+
+
+
+
+void Song::saveProject(DataFile & dataFile)
+{
 	m_savingProject = true;
 
 	m_tempoModel.saveSettings( dataFile, dataFile.head(), "bpm" );
@@ -1254,8 +1487,6 @@ bool Song::saveProjectFile(const QString & filename, bool withResources)
 	saveKeymapStates(dataFile, dataFile.content());
 
 	m_savingProject = false;
-
-	return dataFile.writeFile(filename, withResources);
 }
 
 
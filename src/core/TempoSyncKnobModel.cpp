@@ -41,9 +41,6 @@ TempoSyncKnobModel::TempoSyncKnobModel( const float _val, const float _min,
 	m_scale( _scale ),
 	m_custom( _parent )
 {
-	connect( Engine::getSong(), SIGNAL( tempoChanged( bpm_t ) ),
-			this, SLOT( calculateTempoSyncTime( bpm_t ) ),
-			Qt::DirectConnection );
 }
 
 
@@ -151,6 +148,19 @@ void TempoSyncKnobModel::setSyncMode( TempoSyncMode _new_mode )
 {
 	if( m_tempoSyncMode != _new_mode )
 	{
+		// only synced knobs follow the tempo, so that a tempo change
+		// isn't passed to every knob that could be synced
+		if( _new_mode == SyncNone )
+		{
+			disconnect( Engine::getSong(), SIGNAL( tempoChanged( bpm_t ) ),
+					this, SLOT( calculateTempoSyncTime( bpm_t ) ) );
+		}
+		else if( m_tempoSyncMode == SyncNone )
+		{
+			connect( Engine::getSong(), SIGNAL( tempoChanged( bpm_t ) ),
+					this, SLOT( calculateTempoSyncTime( bpm_t ) ),
+					Qt::DirectConnection );
+		}
 		m_tempoSyncMode = _new_mode;
 		if( _new_mode == SyncCustom )
 		{
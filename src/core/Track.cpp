@@ -29,6 +29,9 @@
 
 #include "Track.h"
 
+#include <algorithm>
+#include <limits>
+
 #include <QVariant>
 
 #include "AutomationClip.h"
@@ -61,6 +64,7 @@ Track::Track( TrackTypes type, TrackContainer * tc ) :
 	m_soloModel( false, this, tr( "Solo" ) ), /*!< For controlling track soloing */
 	m_simpleSerializingMode( false ),
 	m_clips(),        /*!< The clips (segments) */
+	m_clipIndexChanged( true ),
 	m_color( 0, 0, 0 ),
 	m_hasColor( false )
 {
@@ -339,6 +343,15 @@ Clip * Track::addClip( Clip * clip )
 {
 	m_clips.push_back( clip );
 
+	connect( clip, SIGNAL( positionChanged() ),
+			m_trackContainer, SLOT( invalidateAutomationIndex() ) );
+	connect( clip, SIGNAL( positionChanged() ),
+			this, SLOT( invalidateClipIndex() ) );
+	connect( clip, SIGNAL( lengthChanged() ),
+			this, SLOT( invalidateClipIndex() ) );
+	m_trackContainer->invalidateAutomationIndex();
+	invalidateClipIndex();
+
 	emit clipAdded( clip );
 
 	return clip; // just for convenience
@@ -357,6 +370,8 @@ void Track::removeClip( Clip * clip )
 	if( it != m_clips.end() )
 	{
 		m_clips.erase( it );
+		m_trackContainer->invalidateAutomationIndex();
+		invalidateClipIndex();
 		if( Engine::getSong() )
 		{
 			Engine::getSong()->updateLength();
@@ -453,18 +468,71 @@ int Track::getClipNum( const Clip * clip )
 void Track::getClipsInRange( clipVector & clipV, const TimePos & start,
 							const TimePos & end )
 {
-	for( Clip* clip : m_clips )
+	forEachClipInRange( start, end, [&clipV]( Clip * clip )
 	{
-		int s = clip->startPosition();
-		int e = clip->endPosition();
-		if( ( s <= end ) && ( e >= start ) )
-		{
-			// Clip is within given range
-			// Insert sorted by Clip's position
-			clipV.insert(std::upper_bound(clipV.begin(), clipV.end(), clip, Clip::comparePosition),
-						clip);
-		}
+		// Insert sorted by Clip's position
+		clipV.insert(std::upper_bound(clipV.begin(), clipV.end(), clip, Clip::comparePosition),
+					clip);
+	} );
+}
+
+
+
+
+void Track::invalidateClipIndex()
+{
+	m_clipIndexChanged = true;
+}
+
+
+
+
+void Track::updateClipIndex()
+{
+	if( !m_clipIndexChanged.exchange( false ) )
+	{
+		return;
+	}
+
+	m_clipIndex.clear();
+	m_clipIndex.reserve( m_clips.size() );
+	for( Clip * clip : m_clips )
+	{
+		m_clipIndex.push_back( { clip->startPosition(), clip->endPosition(), 0, clip } );
 	}
+	// stable, so clips at the same position keep their order
+	std::stable_sort( m_clipIndex.begin(), m_clipIndex.end(),
+		[]( const ClipIndexEntry & a, const ClipIndexEntry & b ) { return a.start < b.start; } );
+
+	int maxEnd = std::numeric_limits<int>::min();
+	for( ClipIndexEntry & entry : m_clipIndex )
+	{
+		maxEnd = qMax( maxEnd, entry.end );
+		entry.maxEnd = maxEnd;
+	}
+}
+
+
+
+
+/*! \brief Find the part of the clip index which can intersect [start, end]
+ *
+ *  All clips before the returned range end before start, all clips after
+ *  it begin after end. Clips inside the range may still end before start
+ *  if an earlier, longer clip overlaps them.
+ */
+std::pair<const Track::ClipIndexEntry *, const Track::ClipIndexEntry *> Track::clipIndexRange( int start, int end )
+{
+	updateClipIndex();
+
+	const ClipIndexEntry * first = m_clipIndex.data();
+	const ClipIndexEntry * last = first + m_clipIndex.size();
+
+	const ClipIndexEntry * from = std::lower_bound( first, last, start,
+		[]( const ClipIndexEntry & entry, int t ) { return entry.maxEnd < t; } );
+	const ClipIndexEntry * to = std::upper_bound( from, last, end,
+		[]( int t, const ClipIndexEntry & entry ) { return t < entry.start; } );
+	return std::make_pair( from, to );
 }
 
 
@@ -662,3 +730,11 @@ BoolModel *Track::getMutedModel()
 	return &m_mutedModel;
 }
 
+
+
+
+BoolModel *Track::getSoloModel()
+{
+	return &m_soloModel;
+}
+
@@ -24,6 +24,8 @@
  */
 
 
+#include <algorithm>
+
 #include <QApplication>
 #include <QProgressDialog>
 #include <QDomElement>
@@ -33,6 +35,7 @@
 #include "AutomationTrack.h"
 #include "BBTrack.h"
 #include "BBTrackContainer.h"
+#include "DataFileStream.h"
 #include "embed.h"
 #include "TrackContainer.h"
 #include "InstrumentTrack.h"
@@ -42,11 +45,18 @@
 #include "MainWindow.h"
 #include "TextFloat.h"
 
+
+// shared by nested track containers, so that the tracks of beat/bassline
+// containers are shown in the progress of the song's
+static QProgressDialog * s_loadingProgress = nullptr;
+
+
 TrackContainer::TrackContainer() :
 	Model( nullptr ),
 	JournallingObject(),
 	m_tracksMutex(),
-	m_tracks()
+	m_tracks(),
+	m_automationIndexChanged(true)
 {
 }
 
@@ -70,7 +80,14 @@ void TrackContainer::saveSettings( QDomDocument & _doc, QDomElement & _this )
 	m_tracksMutex.lockForRead();
 	for( int i = 0; i < m_tracks.size(); ++i )
 	{
-		m_tracks[i]->saveState( _doc, _this );
+		if( m_trackSaver )
+		{
+			m_trackSaver( m_tracks[i], _doc, _this );
+		}
+		else
+		{
+			m_tracks[i]->saveState( _doc, _this );
+		}
 	}
 	m_tracksMutex.unlock();
 }
@@ -86,68 +103,110 @@ void TrackContainer::loadSettings( const QDomElement & _this )
 		clearAllTracks();
 	}
 
-	static QProgressDialog * pd = nullptr;
-	bool was_null = ( pd == nullptr );
-	if( !journalRestore && getGUI() != nullptr )
+	const bool created = !journalRestore && showLoadingProgress();
+
+	QDomNode node = _this.firstChild();
+	while( !node.isNull() )
 	{
-		if( pd == nullptr )
+		if( node.isElement() && !loadTrack( node.toElement() ) )
 		{
-			pd = new QProgressDialog( tr( "Loading project..." ),
-						tr( "Cancel" ), 0,
-						Engine::getSong()->getLoadingTrackCount(),
-						getGUI()->mainWindow() );
-			pd->setWindowModality( Qt::ApplicationModal );
-			pd->setWindowTitle( tr( "Please wait..." ) );
-			pd->show();
+			break;
 		}
+		node = node.nextSibling();
 	}
 
-	QDomNode node = _this.firstChild();
-	while( !node.isNull() )
+	hideLoadingProgress( created );
+}
+
+
+
+
+void TrackContainer::loadTracks( DataFileStream & stream )
+{
+	stream.enter();
+	const bool created = showLoadingProgress();
+
+	while( stream.next() )
 	{
-		if( pd != nullptr )
+		if( !loadTrack( stream.element() ) )
 		{
-			pd->setValue( pd->value() + 1 );
-			QCoreApplication::instance()->processEvents(
-						QEventLoop::AllEvents, 100 );
-			if( pd->wasCanceled() )
-			{
-				if ( getGUI() != nullptr )
-				{
-					TextFloat::displayMessage( tr( "Loading cancelled" ),
-					tr( "Project loading was cancelled." ),
-					embed::getIconPixmap( "project_file", 24, 24 ),
-					2000 );
-				}
-				Engine::getSong()->loadingCancelled();
-				break;
-			}
+			stream.leave();
+			break;
 		}
+	}
+
+	hideLoadingProgress( created );
+}
+
 
-		if( node.isElement() &&
-			!node.toElement().attribute( "metadata" ).toInt() )
+
+
+bool TrackContainer::showLoadingProgress()
+{
+	if( s_loadingProgress != nullptr || getGUI() == nullptr )
+	{
+		return false;
+	}
+	s_loadingProgress = new QProgressDialog( tr( "Loading project..." ),
+				tr( "Cancel" ), 0,
+				Engine::getSong()->getLoadingTrackCount(),
+				getGUI()->mainWindow() );
+	s_loadingProgress->setWindowModality( Qt::ApplicationModal );
+	s_loadingProgress->setWindowTitle( tr( "Please wait..." ) );
+	s_loadingProgress->show();
+	return true;
+}
+
+
+
+
+void TrackContainer::hideLoadingProgress( bool created )
+{
+	if( created )
+	{
+		delete s_loadingProgress;
+		s_loadingProgress = nullptr;
+	}
+}
+
+
+
+
+bool TrackContainer::loadTrack( const QDomElement & element )
+{
+	QProgressDialog * pd = s_loadingProgress;
+	if( pd != nullptr )
+	{
+		pd->setValue( pd->value() + 1 );
+		QCoreApplication::instance()->processEvents(
+					QEventLoop::AllEvents, 100 );
+		if( pd->wasCanceled() )
 		{
-			QString trackName = node.toElement().hasAttribute( "name" ) ?
-						node.toElement().attribute( "name" ) :
-						node.firstChild().toElement().attribute( "name" );
-			if( pd != nullptr )
+			if ( getGUI() != nullptr )
 			{
-				pd->setLabelText( tr("Loading Track %1 (%2/Total %3)").arg( trackName ).
-						  arg( pd->value() + 1 ).arg( Engine::getSong()->getLoadingTrackCount() ) );
+				TextFloat::displayMessage( tr( "Loading cancelled" ),
+				tr( "Project loading was cancelled." ),
+				embed::getIconPixmap( "project_file", 24, 24 ),
+				2000 );
 			}
-			Track::create( node.toElement(), this );
+			Engine::getSong()->loadingCancelled();
+			return false;
 		}
-		node = node.nextSibling();
 	}
 
-	if( pd != nullptr )
+	if( !element.attribute( "metadata" ).toInt() )
 	{
-		if( was_null )
+		QString trackName = element.hasAttribute( "name" ) ?
+					element.attribute( "name" ) :
+					element.firstChild().toElement().attribute( "name" );
+		if( pd != nullptr )
 		{
-			delete pd;
-			pd = nullptr;
+			pd->setLabelText( tr("Loading Track %1 (%2/Total %3)").arg( trackName ).
+					  arg( pd->value() + 1 ).arg( Engine::getSong()->getLoadingTrackCount() ) );
 		}
+		Track::create( element, this );
 	}
+	return true;
 }
 
 
@@ -178,8 +237,15 @@ void TrackContainer::addTrack( Track * _track )
 		_track->lock();
 		m_tracksMutex.lockForWrite();
 		m_tracks.push_back( _track );
+		const int tracks = m_tracks.size();
 		m_tracksMutex.unlock();
+		invalidateAutomationIndex();
 		_track->unlock();
+		// may wait for the audio thread, which may be waiting for the track
+		if( Engine::getSong() )
+		{
+			Engine::getSong()->reserveTrackPlayJobs( tracks );
+		}
 		emit trackAdded( _track );
 	}
 }
@@ -202,6 +268,7 @@ void TrackContainer::removeTrack( Track * _track )
 		}
 		m_tracks.remove( index );
 		lockTracksAccess.unlock();
+		invalidateAutomationIndex();
 
 		if( Engine::getSong() )
 		{
@@ -250,84 +317,137 @@ bool TrackContainer::isEmpty() const
 
 AutomatedValueMap TrackContainer::automatedValuesAt(TimePos time, int clipNum) const
 {
-	return automatedValuesFromTracks(tracks(), time, clipNum);
+	AutomatedValueList values;
+	collectAutomatedValues(time, clipNum, values);
+
+	AutomatedValueMap valueMap;
+	for (const auto& value : values)
+	{
+		valueMap[value.first] = value.second;
+	}
+	return valueMap;
 }
 
 
-AutomatedValueMap TrackContainer::automatedValuesFromTracks(const TrackList &tracks, TimePos time, int clipNum)
+
+
+void TrackContainer::collectAutomatedValues(TimePos time, int clipNum, AutomatedValueList & values) const
 {
-	Track::clipVector clips;
+	updateAutomationIndex();
+
+	if (clipNum >= 0)
+	{
+		for (Track* track : m_automationTracks)
+		{
+			if (track->isMuted()) {
+				continue;
+			}
+			Q_ASSERT(track->numOfClips() > clipNum);
+			collectClipValues(track->getClip(clipNum), time, values);
+		}
+		return;
+	}
 
-	for (Track* track: tracks)
+	for (auto it = m_automationClips.begin(), end = startedClipsEnd(time); it != end; ++it)
 	{
-		if (track->isMuted()) {
-			continue;
+		if (!(*it)->getTrack()->isMuted()) {
+			collectClipValues(*it, time, values);
 		}
+	}
+}
 
+
+
+
+void TrackContainer::invalidateAutomationIndex()
+{
+	m_automationIndexChanged = true;
+}
+
+
+
+
+void TrackContainer::updateAutomationIndex() const
+{
+	if (!m_automationIndexChanged.exchange(false)) {
+		return;
+	}
+
+	m_automationTracks.clear();
+	m_automationClips.clear();
+	for (Track* track : automationSourceTracks())
+	{
 		switch(track->type())
 		{
 		case Track::AutomationTrack:
 		case Track::HiddenAutomationTrack:
 		case Track::BBTrack:
-			if (clipNum < 0) {
-				track->getClipsInRange(clips, 0, time);
-			} else {
-				Q_ASSERT(track->numOfClips() > clipNum);
-				clips << track->getClip(clipNum);
-			}
+			m_automationTracks.push_back(track);
+			m_automationClips.insert(m_automationClips.end(),
+				track->getClips().begin(), track->getClips().end());
 		default:
 			break;
 		}
 	}
+	// stable, so clips at the same position keep the order of their tracks
+	std::stable_sort(m_automationClips.begin(), m_automationClips.end(), Clip::comparePosition);
+}
+
+
+
+
+std::vector<Clip *>::const_iterator TrackContainer::startedClipsEnd(TimePos time) const
+{
+	return std::upper_bound(m_automationClips.cbegin(), m_automationClips.cend(), time,
+		[](const TimePos& t, const Clip* clip) { return t < clip->startPosition(); });
+}
+
 
-	AutomatedValueMap valueMap;
 
-	Q_ASSERT(std::is_sorted(clips.begin(), clips.end(), Clip::comparePosition));
 
-	for(Clip* clip : clips)
+void TrackContainer::collectClipValues(Clip * clip, TimePos time, AutomatedValueList & values) const
+{
+	if (clip->isMuted() || clip->startPosition() > time) {
+		return;
+	}
+
+	if (clip->getTrack()->type() == Track::BBTrack)
 	{
-		if (clip->isMuted() || clip->startPosition() > time) {
-			continue;
-		}
+		auto bbIndex = static_cast<BBTrack*>(clip->getTrack())->index();
+		auto bbContainer = Engine::getBBTrackContainer();
 
-		if (auto* p = dynamic_cast<AutomationClip *>(clip))
-		{
-			if (! p->hasAutomation()) {
-				continue;
-			}
-			TimePos relTime = time - p->startPosition();
-			if (! p->getAutoResize()) {
-				relTime = qMin(relTime, p->length());
-			}
-			float value = p->valueAt(relTime);
+		TimePos bbTime = time - clip->startPosition();
+		bbTime = std::min(bbTime, clip->length());
+		bbTime = bbTime % (bbContainer->lengthOfBB(bbIndex) * TimePos::ticksPerBar());
 
-			for (AutomatableModel* model : p->objects())
-			{
-				valueMap[model] = value;
-			}
-		}
-		else if (auto* bb = dynamic_cast<BBClip *>(clip))
-		{
-			auto bbIndex = dynamic_cast<class BBTrack*>(bb->getTrack())->index();
-			auto bbContainer = Engine::getBBTrackContainer();
+		// override old values, bb track with the highest index takes precedence
+		bbContainer->collectAutomatedValues(bbTime, bbIndex, values);
+		return;
+	}
 
-			TimePos bbTime = time - clip->startPosition();
-			bbTime = std::min(bbTime, clip->length());
-			bbTime = bbTime % (bbContainer->lengthOfBB(bbIndex) * TimePos::ticksPerBar());
+	auto p = static_cast<AutomationClip *>(clip);
+	if (! p->hasAutomation()) {
+		return;
+	}
+	TimePos relTime = time - p->startPosition();
+	if (! p->getAutoResize()) {
+		relTime = qMin(relTime, p->length());
+	}
+	const float value = p->valueAt(relTime);
 
-			auto bbValues = bbContainer->automatedValuesAt(bbTime, bbIndex);
-			for (auto it=bbValues.begin(); it != bbValues.end(); it++)
-			{
-				// override old values, bb track with the highest index takes precedence
-				valueMap[it.key()] = it.value();
-			}
+	for (AutomatableModel* model : p->objects())
+	{
+		// keep the values sorted by model, later clips override earlier ones
+		auto it = std::lower_bound(values.begin(), values.end(), model,
+			[](const AutomatedValueList::value_type& v, const AutomatableModel* m) { return v.first < m; });
+		if (it != values.end() && it->first == model)
+		{
+			it->second = value;
 		}
 		else
 		{
-			continue;
+			values.insert(it, {model, value});
 		}
 	}
-
-	return valueMap;
-};
+}
 
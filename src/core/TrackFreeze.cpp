@@ -0,0 +1,393 @@
+/*
+ * TrackFreeze.cpp - renders a track into a cache that plays instead of it
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "TrackFreeze.h"
+
+#include <QtCore/QThread>
+
+#include "AudioEngine.h"
+#include "AudioPort.h"
+#include "AutomatableModel.h"
+#include "AutomationClip.h"
+#include "denormals.h"
+#include "EffectChain.h"
+#include "Engine.h"
+#include "FrozenTrackPlayHandle.h"
+#include "InstrumentTrack.h"
+#include "MemoryManager.h"
+#include "SampleBuffer.h"
+#include "SampleClip.h"
+#include "Song.h"
+
+
+class TrackFreeze::Renderer : public QThread
+{
+public:
+	Renderer( TrackFreeze * freeze ) :
+		m_freeze( freeze )
+	{
+	}
+
+protected:
+	void run() override
+	{
+		MemoryManager::ThreadGuard mmThreadGuard; Q_UNUSED(mmThreadGuard);
+		disable_denormals();
+		m_freeze->render();
+	}
+
+private:
+	TrackFreeze * m_freeze;
+};
+
+
+
+
+TrackFreeze::TrackFreeze( Track * track, AudioPort * port ) :
+	QObject(),
+	m_track( track ),
+	m_port( port ),
+	m_cache( nullptr ),
+	m_playHandle( nullptr ),
+	m_tickFrames(),
+	m_renderer( nullptr ),
+	m_renderSamples(),
+	m_renderTickFrames(),
+	m_abortRender( false ),
+	m_tempo( 0 ),
+	m_tempoClips()
+{
+	addIgnoredModel( m_track->getMutedModel() );
+	addIgnoredModel( m_track->getSoloModel() );
+}
+
+
+
+
+TrackFreeze::~TrackFreeze()
+{
+	abortFreeze();
+	unfreeze();
+}
+
+
+
+
+bool TrackFreeze::freeze()
+{
+	Song * song = Engine::getSong();
+	AudioEngine * audioEngine = Engine::audioEngine();
+	// a muted track would only record silence, and unmuting it here would
+	// change what the user set
+	if( isFrozen() || isFreezing() || song->isExporting() ||
+		m_track->trackContainer() != song || m_track->isMuted() )
+	{
+		return false;
+	}
+
+	if( InstrumentTrack * track = qobject_cast<InstrumentTrack *>( m_track ) )
+	{
+		track->instantiateInstrument();
+	}
+
+	song->setRenderBetweenMarkers( false );
+	song->setExportLoop( false );
+	song->setLoopRenderCount( 1 );
+
+	// make this the only audible track, like when exporting tracks
+	// separately - automation keeps running though, so that automated
+	// models of this track get recorded as well
+	song->setExportTrack( m_track );
+
+	// render bypassing the audio device, and record the port's output of
+	// every period, starting at the beginning of the song
+	m_renderSamples.clear();
+	m_renderTickFrames.clear();
+	m_abortRender = false;
+	audioEngine->stopProcessing();
+	m_port->setFreezeCapture( &m_renderSamples );
+
+	m_renderer = new Renderer( this );
+	connect( m_renderer, SIGNAL( finished() ), this, SLOT( renderFinished() ) );
+	m_renderer->start();
+	return true;
+}
+
+
+
+
+void TrackFreeze::abortFreeze()
+{
+	if( isFreezing() )
+	{
+		m_abortRender = true;
+		renderFinished();
+	}
+}
+
+
+
+
+void TrackFreeze::render()
+{
+	Song * song = Engine::getSong();
+	AudioEngine * audioEngine = Engine::audioEngine();
+
+	song->startExport();
+	int progress = -1;
+	while( !song->isExportDone() && !m_abortRender )
+	{
+		audioEngine->nextBuffer();
+		if( song->getExportProgress() != progress )
+		{
+			progress = song->getExportProgress();
+			emit freezeProgress( progress );
+		}
+	}
+	song->stopExport();
+}
+
+
+
+
+void TrackFreeze::renderFinished()
+{
+	if( !isFreezing() )
+	{
+		return;
+	}
+	m_renderer->wait();
+	delete m_renderer;
+	m_renderer = nullptr;
+
+	Song * song = Engine::getSong();
+	AudioEngine * audioEngine = Engine::audioEngine();
+	m_port->setFreezeCapture( nullptr );
+	song->setExportTrack( nullptr );
+	audioEngine->startProcessing();
+
+	std::vector<sample_t> samples;
+	std::vector<f_cnt_t> tickFrames;
+	samples.swap( m_renderSamples );
+	tickFrames.swap( m_renderTickFrames );
+	if( m_abortRender )
+	{
+		emit freezeFinished();
+		return;
+	}
+
+	SampleBuffer * cache = new SampleBuffer( reinterpret_cast<const sampleFrame *>( samples.data() ),
+						samples.size() / DEFAULT_CHANNELS );
+	FrozenTrackPlayHandle * playHandle = new FrozenTrackPlayHandle( m_track, m_port, cache );
+	if( !audioEngine->addPlayHandle( playHandle ) )
+	{
+		sharedObject::unref( cache );
+		emit freezeFinished();
+		return;
+	}
+
+	audioEngine->requestChangeInModel();
+	m_cache = cache;
+	m_playHandle = playHandle;
+	m_tickFrames.swap( tickFrames );
+	m_port->setFrozen( true );
+	audioEngine->doneChangeInModel();
+
+	watchForChanges();
+
+	emit frozenChanged();
+	emit freezeFinished();
+}
+
+
+
+
+void TrackFreeze::unfreeze()
+{
+	if( !isFrozen() )
+	{
+		return;
+	}
+
+	for( const QMetaObject::Connection & connection : m_connections )
+	{
+		disconnect( connection );
+	}
+	m_connections.clear();
+
+	// the audio thread uses the play handle from Track::play(), so drop it
+	// while it's not rendering
+	AudioEngine * audioEngine = Engine::audioEngine();
+	audioEngine->requestChangeInModel();
+	SampleBuffer * cache = m_cache;
+	m_cache = nullptr;
+	m_playHandle->stop();
+	m_playHandle = nullptr;
+	m_tickFrames.clear();
+	m_port->setFrozen( false );
+	audioEngine->doneChangeInModel();
+
+	audioEngine->removePlayHandlesOfTypes( m_track, PlayHandle::TypeFrozenTrackHandle );
+	sharedObject::unref( cache );
+
+	emit frozenChanged();
+}
+
+
+
+
+bool TrackFreeze::play( const TimePos & start, f_cnt_t offset, int clipNum )
+{
+	if( isFreezing() )
+	{
+		// the port has captured the periods before this one so far
+		const f_cnt_t frame = m_renderSamples.size() / DEFAULT_CHANNELS + offset;
+		while( static_cast<tick_t>( m_renderTickFrames.size() ) <= start.getTicks() )
+		{
+			m_renderTickFrames.push_back( frame );
+		}
+		return false;
+	}
+	if( !isFrozen() )
+	{
+		return false;
+	}
+
+	// the cache only covers the song - anything else stays silent until
+	// the track gets unfrozen
+	if( m_playHandle && clipNum < 0 &&
+		Engine::getSong()->playMode() == Song::Mode_PlaySong )
+	{
+		// the frames of the ticks were recorded, as the tempo may be
+		// automated - past the end of the song the cache is silent anyway
+		const tick_t tick = start.getTicks();
+		const tick_t last = static_cast<tick_t>( m_tickFrames.size() ) - 1;
+		const f_cnt_t frame = tick <= last ? m_tickFrames[tick] :
+			( last >= 0 ? m_tickFrames[last] : 0 ) +
+				static_cast<f_cnt_t>( ( tick - qMax<tick_t>( last, 0 ) ) * Engine::framesPerTick() );
+		m_playHandle->sync( frame - offset );
+	}
+	return true;
+}
+
+
+
+
+void TrackFreeze::addIgnoredModel( Model * model )
+{
+	m_ignoredModels.push_back( model );
+}
+
+
+
+
+void TrackFreeze::modelChanged()
+{
+	// automation and controllers were recorded at freeze time
+	AutomatableModel * model = qobject_cast<AutomatableModel *>( sender() );
+	if( model && model->isAutomatedOrControlled() )
+	{
+		return;
+	}
+	unfreeze();
+}
+
+
+
+
+void TrackFreeze::tempoChanged()
+{
+	// tempo automation plays the same as at freeze time, it's only edits of
+	// the tempo or of its automation which move the ticks
+	IntModel & tempo = Engine::getSong()->tempoModel();
+	if( AutomationClip::clipsForModel( &tempo ) != m_tempoClips ||
+		( !tempo.isAutomatedOrControlled() && Engine::getSong()->getTempo() != m_tempo ) )
+	{
+		unfreeze();
+	}
+}
+
+
+
+
+void TrackFreeze::watchForChanges()
+{
+	auto watch = [this]( QObject * object, const char * signal )
+	{
+		m_connections.push_back( connect( object, signal,
+					this, SLOT( modelChanged() ) ) );
+	};
+
+	auto watchModels = [this, &watch]( QObject * parent )
+	{
+		for( AutomatableModel * model : parent->findChildren<AutomatableModel *>() )
+		{
+			if( !m_ignoredModels.contains( model ) )
+			{
+				watch( model, SIGNAL( dataChanged() ) );
+			}
+		}
+	};
+
+	// the instrument and the clips are children of the track, so this
+	// covers their models as well
+	watchModels( m_track );
+	for( Clip * clip : m_track->getClips() )
+	{
+		watch( clip, SIGNAL( dataChanged() ) );
+		watch( clip, SIGNAL( positionChanged() ) );
+		watch( clip, SIGNAL( lengthChanged() ) );
+		watch( clip, SIGNAL( destroyedClip() ) );
+		if( qobject_cast<SampleClip *>( clip ) )
+		{
+			watch( clip, SIGNAL( sampleChanged() ) );
+		}
+	}
+	watch( m_track, SIGNAL( clipAdded( Clip * ) ) );
+	if( qobject_cast<InstrumentTrack *>( m_track ) )
+	{
+		watch( m_track, SIGNAL( instrumentChanged() ) );
+	}
+
+	if( EffectChain * effects = m_port->effects() )
+	{
+		watchModels( effects );
+		watch( effects, SIGNAL( dataChanged() ) );
+	}
+
+	// the cache is laid out in frames of the song at freeze time
+	Song * song = Engine::getSong();
+	m_tempo = song->getTempo();
+	m_tempoClips = AutomationClip::clipsForModel( &song->tempoModel() );
+	m_connections.push_back( connect( song, SIGNAL( tempoChanged( bpm_t ) ),
+					this, SLOT( tempoChanged() ) ) );
+	for( AutomationClip * clip : m_tempoClips )
+	{
+		watch( clip, SIGNAL( dataChanged() ) );
+		watch( clip, SIGNAL( positionChanged() ) );
+		watch( clip, SIGNAL( lengthChanged() ) );
+		watch( clip, SIGNAL( destroyedClip() ) );
+	}
+	watch( Engine::audioEngine(), SIGNAL( sampleRateChanged() ) );
+}
@@ -0,0 +1,225 @@
+/*
+ * VoiceLimiter.cpp - stops voices beyond the voice limits
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "VoiceLimiter.h"
+
+#include <algorithm>
+
+#include "Engine.h"
+#include "InstrumentTrack.h"
+#include "NotePlayHandle.h"
+#include "Song.h"
+
+
+namespace
+{
+
+// in adaptive mode, the limit is lowered above and raised again below
+// these loads
+const int HighLoad = 90;
+const int LowLoad = 70;
+// the adaptive limit never goes below this
+const int MinAdaptiveLimit = 8;
+
+}
+
+
+
+
+VoiceLimiter::VoiceLimiter() :
+	m_limit( 0 ),
+	m_adaptive( false ),
+	m_adaptiveLimit( PlayHandle::MaxNumber )
+{
+	m_voices.reserve( PlayHandle::MaxNumber );
+}
+
+
+
+
+void VoiceLimiter::setLimit( int voices )
+{
+	m_limit = qMax( voices, 0 );
+	m_adaptiveLimit = m_limit > 0 ? m_limit : PlayHandle::MaxNumber;
+}
+
+
+
+
+void VoiceLimiter::setAdaptive( bool adaptive )
+{
+	m_adaptive = adaptive;
+	m_adaptiveLimit = m_limit > 0 ? m_limit : PlayHandle::MaxNumber;
+}
+
+
+
+
+void VoiceLimiter::process( const PlayHandleList & playHandles, int cpuLoad )
+{
+	m_voices.clear();
+	bool trackLimits = false;
+	for( PlayHandle * ph : playHandles )
+	{
+		// the note pool can hand out more handles than m_voices has room
+		// for, and it mustn't grow here - the oldest voices come first,
+		// which are the ones worth considering anyway
+		if( m_voices.size() == m_voices.capacity() )
+		{
+			break;
+		}
+		if( ph->type() != PlayHandle::TypeNotePlayHandle )
+		{
+			continue;
+		}
+		NotePlayHandle * nph = static_cast<NotePlayHandle *>( ph );
+		// master notes of chords and arpeggios don't sound themselves
+		if( nph->isFinished() || nph->isStolen() || nph->isMasterNote() || nph->isMuted() )
+		{
+			continue;
+		}
+		m_voices.push_back( { nph, nph->instrumentTrack(), 0, 0.0f } );
+		trackLimits |= nph->instrumentTrack()->voiceLimit() > 0;
+	}
+
+	Voice * first = m_voices.data();
+	Voice * last = first + m_voices.size();
+
+	if( trackLimits )
+	{
+		std::sort( first, last, []( const Voice & a, const Voice & b )
+		{
+			return a.track < b.track;
+		} );
+		Voice * kept = first;
+		for( Voice * begin = first; begin != last; )
+		{
+			Voice * end = begin;
+			while( end != last && end->track == begin->track )
+			{
+				++end;
+			}
+			const int limit = begin->track->voiceLimit();
+			Voice * keptEnd = end;
+			if( limit > 0 && end - begin > limit )
+			{
+				rate( begin, end );
+				keptEnd = steal( begin, end, limit );
+			}
+			// keep the voices not stolen together for the global limit
+			kept = kept == begin ? keptEnd : std::move( begin, keptEnd, kept );
+			begin = end;
+		}
+		last = kept;
+	}
+
+	const int voices = static_cast<int>( last - first );
+	// the CPU doesn't have to keep up with the rendering of an export
+	const bool adaptive = m_adaptive && !Engine::getSong()->isExporting();
+	if( adaptive )
+	{
+		adapt( voices, cpuLoad );
+	}
+	const int limit = adaptive ? m_adaptiveLimit : m_limit;
+	if( limit > 0 && voices > limit )
+	{
+		// the tracks' policies don't compare with each other, so the
+		// released and then the oldest voices go first
+		for( Voice * voice = first; voice != last; ++voice )
+		{
+			voice->rank = voice->note->isReleased() ? 1 : 0;
+			voice->score = voice->note->totalFramesPlayed();
+		}
+		steal( first, last, limit );
+	}
+}
+
+
+
+
+void VoiceLimiter::rate( Voice * first, Voice * last )
+{
+	const InstrumentTrack::VoiceStealing stealing = first->track->voiceStealing();
+
+	for( Voice * voice = first; voice != last; ++voice )
+	{
+		NotePlayHandle * nph = voice->note;
+		// voices in their release are the first to go
+		voice->rank = nph->isReleased() ? 1 : 0;
+		voice->score = stealing == InstrumentTrack::VoiceStealing::Quietest
+			? -nph->volumeLevel( nph->totalFramesPlayed() ) * nph->getVolume()
+			: nph->totalFramesPlayed();
+	}
+
+	if( stealing == InstrumentTrack::VoiceStealing::SameKey )
+	{
+		// all but the newest voice of a key go before everything else
+		std::sort( first, last, []( const Voice & a, const Voice & b )
+		{
+			return a.note->key() < b.note->key() ||
+				( a.note->key() == b.note->key() && a.score < b.score );
+		} );
+		for( Voice * voice = first + 1; voice < last; ++voice )
+		{
+			if( voice->note->key() == ( voice - 1 )->note->key() )
+			{
+				voice->rank += 2;
+			}
+		}
+	}
+}
+
+
+
+
+VoiceLimiter::Voice * VoiceLimiter::steal( Voice * first, Voice * last, int keep )
+{
+	Voice * keptEnd = first + keep;
+	std::nth_element( first, keptEnd, last, []( const Voice & a, const Voice & b )
+	{
+		return a.rank < b.rank || ( a.rank == b.rank && a.score < b.score );
+	} );
+	for( Voice * voice = keptEnd; voice != last; ++voice )
+	{
+		voice->note->steal();
+	}
+	return keptEnd;
+}
+
+
+
+
+void VoiceLimiter::adapt( int voices, int cpuLoad )
+{
+	const int maxLimit = m_limit > 0 ? m_limit : PlayHandle::MaxNumber;
+	if( cpuLoad > HighLoad )
+	{
+		// shed an eighth of the voices each period until the load is fine
+		m_adaptiveLimit = qMax( qMin( m_adaptiveLimit, voices ) * 7 / 8, MinAdaptiveLimit );
+	}
+	else if( cpuLoad < LowLoad && m_adaptiveLimit < maxLimit )
+	{
+		m_adaptiveLimit = qMin( m_adaptiveLimit + 1, maxLimit );
+	}
+}
@@ -43,6 +43,8 @@
 
 VstSyncController::VstSyncController() :
 	m_syncData( nullptr ),
+	m_state(),
+	m_changed( false ),
 	m_shmID( -1 ),
 	m_shm( "/usr/bin/lmms" )
 {
@@ -89,20 +91,23 @@ VstSyncController::VstSyncController() :
 
 	if( m_syncData == nullptr )
 	{
-		m_syncData = new VstSyncData;
+		m_syncData = new VstSyncData();
 		m_syncData->hasSHM = false;
 	}
 	else
 	{
 		m_syncData->hasSHM = true;
 	}
+	m_syncData->version.store( 0, std::memory_order_relaxed );
 
-	m_syncData->isPlaying = false;
-	m_syncData->m_bufferSize = Engine::audioEngine()->framesPerPeriod();
-	m_syncData->timeSigNumer = 4;
-	m_syncData->timeSigDenom = 4;
+	m_state.isPlaying = false;
+	m_state.m_bufferSize = Engine::audioEngine()->framesPerPeriod();
+	m_state.timeSigNumer = 4;
+	m_state.timeSigDenom = 4;
+	m_state.m_sampleRate = Engine::audioEngine()->processingSampleRate();
 
-	updateSampleRate();
+	m_changed = true;
+	publish();
 }
 
 
@@ -139,9 +144,9 @@ VstSyncController::~VstSyncController()
 void VstSyncController::setAbsolutePosition( double ticks )
 {
 #ifdef VST_SNC_LATENCY
-	m_syncData->ppqPos = ( ( ticks + 0 ) / 48.0 ) - m_syncData->m_latency;
+	change( m_state.ppqPos, ( ( ticks + 0 ) / 48.0 ) - m_state.m_latency );
 #else
-	m_syncData->ppqPos = ( ( ticks + 0 ) / 48.0 );
+	change( m_state.ppqPos, ( ( ticks + 0 ) / 48.0 ) );
 #endif
 }
 
@@ -149,43 +154,43 @@ void VstSyncController::setAbsolutePosition( double ticks )
 
 void VstSyncController::setTempo( int newTempo )
 {
-	m_syncData->m_bpm = newTempo;
-
-#ifdef VST_SNC_LATENCY
-	m_syncData->m_latency = m_syncData->m_bufferSize * newTempo / ( (float) m_syncData->m_sampleRate * 60 );
-#endif
-
+	change( m_state.m_bpm, newTempo );
 }
 
 
 
 void VstSyncController::startCycle( int startTick, int endTick )
 {
-	m_syncData->isCycle = true;
-	m_syncData->cycleStart = startTick / (float)48;
-	m_syncData->cycleEnd = endTick / (float)48;
+	// called for every tick, but only changes when the loop points move
+	change( m_state.isCycle, true );
+	change( m_state.cycleStart, startTick / (float)48 );
+	change( m_state.cycleEnd, endTick / (float)48 );
 }
 
 
 
-void VstSyncController::update()
+void VstSyncController::publish()
 {
-	m_syncData->m_bufferSize = Engine::audioEngine()->framesPerPeriod();
+	change( m_state.m_bufferSize, static_cast<int>( Engine::audioEngine()->framesPerPeriod() ) );
+
+	// the plugins are polling the shared memory, it must only be written
+	// to when something changed
+	if( !m_changed.exchange( false, std::memory_order_relaxed ) )
+	{
+		return;
+	}
 
 #ifdef VST_SNC_LATENCY
-	m_syncData->m_latency = m_syncData->m_bufferSize * m_syncData->m_bpm / ( (float) m_syncData->m_sampleRate * 60 );
+	m_state.m_latency = m_state.m_bufferSize * m_state.m_bpm / ( (float) m_state.m_sampleRate * 60 );
 #endif
+	m_syncData->publish( m_state );
 }
 
 
 
 void VstSyncController::updateSampleRate()
 {
-	m_syncData->m_sampleRate = Engine::audioEngine()->processingSampleRate();
-
-#ifdef VST_SNC_LATENCY
-	m_syncData->m_latency = m_syncData->m_bufferSize * m_syncData->m_bpm / ( (float) m_syncData->m_sampleRate * 60 );
-#endif
+	change( m_state.m_sampleRate, static_cast<int>( Engine::audioEngine()->processingSampleRate() ) );
 }
 
 
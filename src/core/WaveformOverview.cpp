@@ -0,0 +1,151 @@
+/*
+ * WaveformOverview.cpp - precomputed peaks of a sample for drawing it
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "WaveformOverview.h"
+
+#include <algorithm>
+
+#include "CompactSamples.h"
+
+
+namespace
+{
+
+//! Each level's bins span this many bins of the level below
+const f_cnt_t LevelFactor = 16;
+const int Levels = 3;
+
+}
+
+
+
+
+WaveformOverview::WaveformOverview(const sampleFrame * data, f_cnt_t frames)
+{
+	m_levels.resize(1);
+	m_levels[0].bins.reserve(frames / MinBinFrames + 1);
+	addBins(data, frames);
+	buildLevels();
+}
+
+
+
+
+WaveformOverview::WaveformOverview(const CompactSamples & samples)
+{
+	m_levels.resize(1);
+	m_levels[0].bins.reserve(samples.frames() / MinBinFrames + 1);
+
+	// converted a few bins at a time, to not need the float frames at once
+	const f_cnt_t chunkFrames = MinBinFrames * 16;
+	std::vector<sampleFrame> chunk(chunkFrames);
+	for (f_cnt_t start = 0; start < samples.frames(); start += chunkFrames)
+	{
+		const f_cnt_t frames = std::min(chunkFrames, samples.frames() - start);
+		samples.read(chunk.data(), start, frames);
+		addBins(chunk.data(), frames);
+	}
+	buildLevels();
+}
+
+
+
+
+void WaveformOverview::addBins(const sampleFrame * data, f_cnt_t frames)
+{
+	Level & first = m_levels[0];
+	first.binFrames = MinBinFrames;
+	for (f_cnt_t start = 0; start < frames; start += MinBinFrames)
+	{
+		const f_cnt_t end = std::min(start + MinBinFrames, frames);
+		Bin bin = { 1, -1, 0 };
+		for (f_cnt_t f = start; f < end; ++f)
+		{
+			for (int ch = 0; ch < DEFAULT_CHANNELS; ++ch)
+			{
+				const float sample = data[f][ch];
+				bin.min = std::min(bin.min, sample);
+				bin.max = std::max(bin.max, sample);
+				bin.squares += sample * sample;
+			}
+		}
+		bin.squares /= DEFAULT_CHANNELS;
+		first.bins.push_back(bin);
+	}
+}
+
+
+
+
+void WaveformOverview::buildLevels()
+{
+	m_levels.reserve(Levels);
+	for (int i = 1; i < Levels; ++i)
+	{
+		const Level & below = m_levels.back();
+		Level level;
+		level.binFrames = below.binFrames * LevelFactor;
+		level.bins.reserve(below.bins.size() / LevelFactor + 1);
+		for (size_t start = 0; start < below.bins.size(); start += LevelFactor)
+		{
+			level.bins.push_back(combine(below, start * below.binFrames,
+				(start + LevelFactor) * below.binFrames - 1));
+		}
+		m_levels.push_back(std::move(level));
+	}
+}
+
+
+
+
+const WaveformOverview::Level * WaveformOverview::levelFor(double frames) const
+{
+	const Level * found = nullptr;
+	for (const Level & level : m_levels)
+	{
+		if (level.binFrames > frames)
+		{
+			break;
+		}
+		found = &level;
+	}
+	return found;
+}
+
+
+
+
+WaveformOverview::Bin WaveformOverview::combine(const Level & level, f_cnt_t from, f_cnt_t to)
+{
+	Bin result = { 1, -1, 0 };
+	const size_t last = std::min<size_t>(to / level.binFrames, level.bins.size() - 1);
+	for (size_t i = from / level.binFrames; i <= last; ++i)
+	{
+		const Bin & bin = level.bins[i];
+		result.min = std::min(result.min, bin.min);
+		result.max = std::max(result.max, bin.max);
+		result.squares += bin.squares;
+	}
+	return result;
+}
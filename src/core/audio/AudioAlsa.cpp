@@ -44,6 +44,10 @@ AudioAlsa::AudioAlsa( bool & _success_ful, AudioEngine*  _audioEngine ) :
 	m_handle( nullptr ),
 	m_hwParams( nullptr ),
 	m_swParams( nullptr ),
+	m_periods( qBound( 2, ConfigManager::inst()->value( "audioalsa", "periods",
+						QString::number( DefaultPeriods ) ).toInt(), MaxPeriods ) ),
+	m_availMin( qMax( 0, ConfigManager::inst()->value( "audioalsa", "availmin" ).toInt() ) ),
+	m_mmap( ConfigManager::inst()->value( "audioalsa", "mmap" ).toInt() ),
 	m_convertEndian( false )
 {
 	_success_ful = false;
@@ -68,17 +72,8 @@ AudioAlsa::AudioAlsa( bool & _success_ful, AudioEngine*  _audioEngine ) :
 	snd_pcm_hw_params_malloc( &m_hwParams );
 	snd_pcm_sw_params_malloc( &m_swParams );
 
-	if( ( err = setHWParams( channels(),
-					SND_PCM_ACCESS_RW_INTERLEAVED ) ) < 0 )
-	{
-		printf( "Setting of hwparams failed: %s\n",
-							snd_strerror( err ) );
-		return;
-	}
-	if( ( err = setSWParams() ) < 0 )
+	if( ( err = setParams() ) < 0 )
 	{
-		printf( "Setting of swparams failed: %s\n",
-							snd_strerror( err ) );
 		return;
 	}
 
@@ -201,6 +196,7 @@ int AudioAlsa::handleError( int _err )
 	if( _err == -EPIPE )
 	{
 		// under-run
+		audioEngine()->profiler().countDeviceXrun();
 		_err = snd_pcm_prepare( m_handle );
 		if( _err < 0 )
 			printf( "Can't recover from underrun, prepare "
@@ -273,17 +269,8 @@ void AudioAlsa::applyQualitySettings()
 			return;
 		}
 
-		if( ( err = setHWParams( channels(),
-					SND_PCM_ACCESS_RW_INTERLEAVED ) ) < 0 )
+		if( ( err = setParams() ) < 0 )
 		{
-			printf( "Setting of hwparams failed: %s\n",
-							snd_strerror( err ) );
-			return;
-		}
-		if( ( err = setSWParams() ) < 0 )
-		{
-			printf( "Setting of swparams failed: %s\n",
-							snd_strerror( err ) );
 			return;
 		}
 	}
@@ -296,6 +283,12 @@ void AudioAlsa::applyQualitySettings()
 
 void AudioAlsa::run()
 {
+	if( m_mmap )
+	{
+		runMmap();
+		return;
+	}
+
 	surroundSampleFrame * temp = new surroundSampleFrame[audioEngine()->framesPerPeriod()];
 	int_sample_t * outbuf = new int_sample_t[audioEngine()->framesPerPeriod() * channels()];
 	int_sample_t * pcmbuf = new int_sample_t[m_periodSize * channels()];
@@ -372,6 +365,141 @@ void AudioAlsa::run()
 
 
 
+void AudioAlsa::runMmap()
+{
+	surroundSampleFrame * temp = new surroundSampleFrame[audioEngine()->framesPerPeriod()];
+	fpp_t tempFrames = 0;
+	fpp_t tempPos = 0;
+
+	bool quit = false;
+	while( quit == false )
+	{
+		const snd_pcm_sframes_t avail = snd_pcm_avail_update( m_handle );
+		if( avail < 0 )
+		{
+			if( handleError( avail ) < 0 )
+			{
+				printf( "Avail update error: %s\n",
+							snd_strerror( avail ) );
+				break;
+			}
+			continue;
+		}
+		if( avail < (snd_pcm_sframes_t) m_periodSize )
+		{
+			// the start threshold is a period, so once one is written
+			// the device runs and wakes us up after avail_min frames
+			const int err = snd_pcm_wait( m_handle, 1000 );
+			if( err < 0 && handleError( err ) < 0 )
+			{
+				printf( "Wait error: %s\n", snd_strerror( err ) );
+				break;
+			}
+			continue;
+		}
+
+		// whole periods only, so that the wakeups stay period-aligned
+		snd_pcm_uframes_t todo = avail - avail % m_periodSize;
+		while( todo > 0 && quit == false )
+		{
+			const snd_pcm_channel_area_t * areas;
+			snd_pcm_uframes_t offset;
+			snd_pcm_uframes_t frames = todo;
+			int err = snd_pcm_mmap_begin( m_handle, &areas, &offset, &frames );
+			if( err < 0 )
+			{
+				if( handleError( err ) < 0 )
+				{
+					printf( "Mmap begin error: %s\n",
+							snd_strerror( err ) );
+					quit = true;
+				}
+				break;
+			}
+
+			// interleaved, so the first area describes all channels
+			int_sample_t * out = reinterpret_cast<int_sample_t *>(
+				static_cast<char *>( areas[0].addr ) +
+					( areas[0].first + offset * areas[0].step ) / 8 );
+			snd_pcm_uframes_t done = 0;
+			while( done < frames )
+			{
+				if( tempPos == tempFrames )
+				{
+					// frames depend on the sample rate
+					tempFrames = getNextBuffer( temp );
+					tempPos = 0;
+					if( !tempFrames )
+					{
+						quit = true;
+						memset( out + done * channels(), 0,
+							( frames - done ) * channels() *
+							sizeof( int_sample_t ) );
+						break;
+					}
+				}
+				const fpp_t n = qMin<snd_pcm_uframes_t>(
+						tempFrames - tempPos, frames - done );
+				convertToS16( temp + tempPos, n,
+						audioEngine()->masterGain(),
+						out + done * channels(),
+						m_convertEndian );
+				tempPos += n;
+				done += n;
+			}
+
+			const snd_pcm_sframes_t committed =
+				snd_pcm_mmap_commit( m_handle, offset, frames );
+			if( committed < 0 || (snd_pcm_uframes_t) committed != frames )
+			{
+				err = committed < 0 ? committed : -EPIPE;
+				if( handleError( err ) < 0 )
+				{
+					printf( "Mmap commit error: %s\n",
+							snd_strerror( err ) );
+					quit = true;
+				}
+				break;
+			}
+			todo -= frames;
+		}
+	}
+
+	delete[] temp;
+}
+
+
+
+
+int AudioAlsa::setParams()
+{
+	int err = -1;
+	if( m_mmap && ( err = setHWParams( channels(),
+					SND_PCM_ACCESS_MMAP_INTERLEAVED ) ) < 0 )
+	{
+		printf( "No mmap access for playback, using read/write: %s\n",
+							snd_strerror( err ) );
+		m_mmap = false;
+	}
+	if( !m_mmap && ( err = setHWParams( channels(),
+					SND_PCM_ACCESS_RW_INTERLEAVED ) ) < 0 )
+	{
+		printf( "Setting of hwparams failed: %s\n",
+							snd_strerror( err ) );
+		return err;
+	}
+	if( ( err = setSWParams() ) < 0 )
+	{
+		printf( "Setting of swparams failed: %s\n",
+							snd_strerror( err ) );
+		return err;
+	}
+	return 0;
+}
+
+
+
+
 int AudioAlsa::setHWParams( const ch_cnt_t _channels, snd_pcm_access_t _access )
 {
 	int err, dir;
@@ -435,7 +563,7 @@ int AudioAlsa::setHWParams( const ch_cnt_t _channels, snd_pcm_access_t _access )
 	}
 
 	m_periodSize = audioEngine()->framesPerPeriod();
-	m_bufferSize = m_periodSize * 8;
+	m_bufferSize = m_periodSize * m_periods;
 	dir = 0;
 	err = snd_pcm_hw_params_set_period_size_near( m_handle, m_hwParams,
 							&m_periodSize, &dir );
@@ -509,9 +637,11 @@ int AudioAlsa::setSWParams()
 	}
 
 	// allow the transfer when at least m_periodSize samples can be
-	// processed
+	// processed, unless something else was configured
+	const snd_pcm_uframes_t availMin = m_availMin > 0 ?
+		qMin( m_availMin, m_bufferSize ) : m_periodSize;
 	if( ( err = snd_pcm_sw_params_set_avail_min( m_handle, m_swParams,
-							m_periodSize ) ) < 0 )
+							availMin ) ) < 0 )
 	{
 		printf( "Unable to set avail min for playback: %s\n",
 							snd_strerror( err ) );
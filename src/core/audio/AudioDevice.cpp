@@ -23,20 +23,73 @@
  */
 
 #include <cstring>
+#include <random>
+#include <vector>
 
 #include "AudioDevice.h"
 #include "AudioEngine.h"
 #include "ConfigManager.h"
+#include "MixHelpers.h"
+#include "Oversampler.h"
 #include "debug.h"
 
 
+namespace
+{
+
+// TPDF noise of up to +-1 LSB, read from random offsets. It is long enough
+// that it doesn't repeat audibly.
+const int DitherNoiseSize = 1 << 16;
+// frames converted with one piece of the noise
+const fpp_t DitherFrames = DitherNoiseSize / ( 4 * DEFAULT_CHANNELS );
+
+//! The stages of half-band decimation from @p srcRate to @p dstRate, or 0
+//! if they aren't apart by a factor Oversampler can handle
+int decimatorStages( const sample_rate_t srcRate, const sample_rate_t dstRate )
+{
+	// the stages only filter stereo frames
+	if( SURROUND_CHANNELS != DEFAULT_CHANNELS )
+	{
+		return 0;
+	}
+	for( int stages = 1; stages <= Oversampler::MaxStages; ++stages )
+	{
+		if( srcRate == dstRate << stages )
+		{
+			return stages;
+		}
+	}
+	return 0;
+}
+
+const float * ditherNoiseTable()
+{
+	static const std::vector<float> noise = []
+	{
+		std::vector<float> n( DitherNoiseSize );
+		std::minstd_rand random( 1 );
+		std::uniform_real_distribution<float> uniform( -0.5f, 0.5f );
+		for( float & v : n )
+		{
+			v = uniform( random ) + uniform( random );
+		}
+		return n;
+	}();
+	return noise.data();
+}
+
+}
+
+
 
 AudioDevice::AudioDevice( const ch_cnt_t _channels, AudioEngine*  _audioEngine ) :
 	m_supportsCapture( false ),
 	m_sampleRate( _audioEngine->processingSampleRate() ),
 	m_channels( _channels ),
 	m_audioEngine( _audioEngine ),
-	m_buffer( new surroundSampleFrame[audioEngine()->framesPerPeriod()] )
+	m_buffer( new surroundSampleFrame[audioEngine()->framesPerPeriod()] ),
+	m_dither( ConfigManager::inst()->value( "audioengine", "dither" ).toInt() ),
+	m_ditherPos( 0 )
 {
 	int error;
 	if( ( m_srcState = src_new(
@@ -64,14 +117,27 @@ AudioDevice::~AudioDevice()
 
 void AudioDevice::processNextBuffer()
 {
-	const fpp_t frames = getNextBuffer( m_buffer );
-	if( frames )
+	const surroundSampleFrame * b = audioEngine()->nextBuffer();
+	if( !b )
+	{
+		m_inProcess = false;
+		return;
+	}
+
+	// written right from the engine's buffer, unless it has to be resampled
+	if( audioEngine()->processingSampleRate() != m_sampleRate )
 	{
+		lock();
+		const fpp_t frames = resample( b, audioEngine()->framesPerPeriod(), m_buffer,
+					audioEngine()->processingSampleRate(), m_sampleRate );
+		unlock();
+		audioEngine()->releaseBuffer();
 		writeBuffer( m_buffer, frames, audioEngine()->masterGain() );
 	}
 	else
 	{
-		m_inProcess = false;
+		writeBuffer( b, audioEngine()->framesPerPeriod(), audioEngine()->masterGain() );
+		audioEngine()->releaseBuffer();
 	}
 }
 
@@ -103,10 +169,7 @@ fpp_t AudioDevice::getNextBuffer( surroundSampleFrame * _ab )
 	// release lock
 	unlock();
 
-	if( audioEngine()->hasFifoWriter() )
-	{
-		delete[] b;
-	}
+	audioEngine()->releaseBuffer();
 
 	return frames;
 }
@@ -147,6 +210,8 @@ void AudioDevice::stopProcessingThread( QThread * thread )
 void AudioDevice::applyQualitySettings()
 {
 	src_delete( m_srcState );
+	// made again by resample(), for the new rate and without the old history
+	m_decimator.reset();
 
 	int error;
 	if( ( m_srcState = src_new(
@@ -187,6 +252,21 @@ fpp_t AudioDevice::resample( const surroundSampleFrame * _src,
 						const sample_rate_t _src_sr,
 						const sample_rate_t _dst_sr )
 {
+	// oversampling only needs to be undone, which the half-band stages do
+	// for far less than a sinc of libsamplerate
+	const int stages = decimatorStages( _src_sr, _dst_sr );
+	if( stages > 0 && _frames % ( 1 << stages ) == 0 )
+	{
+		if( !m_decimator || m_decimator->stages() != stages )
+		{
+			m_decimator.reset( new Oversampler( stages, audioEngine()->framesPerPeriod() ) );
+		}
+		const fpp_t frames = _frames >> stages;
+		m_decimator->decimate( reinterpret_cast<const sampleFrame *>( _src ),
+					reinterpret_cast<sampleFrame *>( _dst ), frames );
+		return frames;
+	}
+
 	if( m_srcState == nullptr )
 	{
 		return _frames;
@@ -214,7 +294,19 @@ int AudioDevice::convertToS16( const surroundSampleFrame * _ab,
 								int_sample_t * _output_buffer,
 								const bool _convert_endian )
 {
-	if( _convert_endian )
+	if( SURROUND_CHANNELS == DEFAULT_CHANNELS && channels() == DEFAULT_CHANNELS )
+	{
+		const sampleFrame * src = reinterpret_cast<const sampleFrame *>( _ab );
+		for( fpp_t done = 0; done < _frames; done += DitherFrames )
+		{
+			const fpp_t frames = qMin<fpp_t>( _frames - done, DitherFrames );
+			MixHelpers::convertToS16( _output_buffer + done * DEFAULT_CHANNELS,
+					src + done, _master_gain,
+					ditherNoise( frames * DEFAULT_CHANNELS ),
+					_convert_endian, frames );
+		}
+	}
+	else if( _convert_endian )
 	{
 		int_sample_t temp;
 		for( fpp_t frame = 0; frame < _frames; ++frame )
@@ -250,6 +342,79 @@ int AudioDevice::convertToS16( const surroundSampleFrame * _ab,
 
 
 
+void AudioDevice::convertToS24( const surroundSampleFrame * _ab,
+								const fpp_t _frames,
+								const float _master_gain,
+								int32_t * _output_buffer )
+{
+	if( SURROUND_CHANNELS == DEFAULT_CHANNELS && channels() == DEFAULT_CHANNELS )
+	{
+		const sampleFrame * src = reinterpret_cast<const sampleFrame *>( _ab );
+		for( fpp_t done = 0; done < _frames; done += DitherFrames )
+		{
+			const fpp_t frames = qMin<fpp_t>( _frames - done, DitherFrames );
+			MixHelpers::convertToS24( _output_buffer + done * DEFAULT_CHANNELS,
+					src + done, _master_gain,
+					ditherNoise( frames * DEFAULT_CHANNELS ), frames );
+		}
+		return;
+	}
+
+	for( fpp_t frame = 0; frame < _frames; ++frame )
+	{
+		for( ch_cnt_t chnl = 0; chnl < channels(); ++chnl )
+		{
+			( _output_buffer + frame * channels() )[chnl] =
+				static_cast<int32_t>( qBound( -MixHelpers::S24Scale,
+					_ab[frame][chnl] * _master_gain * MixHelpers::S24Scale,
+					MixHelpers::S24Scale ) );
+		}
+	}
+}
+
+
+
+
+void AudioDevice::convertToFloat( const surroundSampleFrame * _ab,
+								const fpp_t _frames,
+								const float _master_gain,
+								float * _output_buffer )
+{
+	if( SURROUND_CHANNELS == DEFAULT_CHANNELS && channels() == DEFAULT_CHANNELS )
+	{
+		MixHelpers::copyMultiplied( reinterpret_cast<sampleFrame *>( _output_buffer ),
+				reinterpret_cast<const sampleFrame *>( _ab ),
+				_master_gain, _frames );
+		return;
+	}
+
+	for( fpp_t frame = 0; frame < _frames; ++frame )
+	{
+		for( ch_cnt_t chnl = 0; chnl < channels(); ++chnl )
+		{
+			( _output_buffer + frame * channels() )[chnl] =
+						_ab[frame][chnl] * _master_gain;
+		}
+	}
+}
+
+
+
+
+const float * AudioDevice::ditherNoise( const int _samples )
+{
+	if( !m_dither )
+	{
+		return nullptr;
+	}
+	// a cheap LCG is random enough for picking the offset
+	m_ditherPos = m_ditherPos * 1664525u + 1013904223u;
+	return ditherNoiseTable() + ( m_ditherPos >> 8 ) % ( DitherNoiseSize - _samples + 1 );
+}
+
+
+
+
 void AudioDevice::clearS16Buffer( int_sample_t * _outbuf, const fpp_t _frames )
 {
 
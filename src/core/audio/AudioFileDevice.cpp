@@ -23,13 +23,119 @@
  *
  */
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
 #include <QMessageBox>
+#include <QThread>
 
+#include "AudioEngine.h"
 #include "AudioFileDevice.h"
 #include "ExportProjectDialog.h"
 #include "GuiApplication.h"
 
 
+namespace
+{
+
+//! How many periods the encoder may fall behind the rendering
+const std::size_t QueuePeriods = 64;
+
+//! How long either side sleeps while the other one has to catch up
+const unsigned long WaitMicroseconds = 200;
+
+}
+
+
+
+
+//! Encodes and writes the periods rendered for an AudioFileDevice. They
+//! are passed through a ring of buffers with one writer and one reader, so
+//! neither side ever locks.
+class AudioFileEncoder : public QThread
+{
+public:
+	AudioFileEncoder( AudioFileDevice * device, fpp_t framesPerPeriod ) :
+		m_device( device ),
+		m_periods( QueuePeriods ),
+		m_written( 0 ),
+		m_read( 0 ),
+		m_discard( false )
+	{
+		for( Period & period : m_periods )
+		{
+			period.frames.reset( new surroundSampleFrame[framesPerPeriod] );
+		}
+	}
+
+	//! Render thread: the buffer of the next period, waits until it's free
+	surroundSampleFrame * nextPeriod()
+	{
+		const std::size_t written = m_written.load( std::memory_order_relaxed );
+		while( written - m_read.load( std::memory_order_acquire ) >= QueuePeriods )
+		{
+			usleep( WaitMicroseconds );
+		}
+		return m_periods[written % QueuePeriods].frames.get();
+	}
+
+	//! Render thread: hands the buffer of nextPeriod() to the encoder
+	void queue( fpp_t count, float gain )
+	{
+		const std::size_t written = m_written.load( std::memory_order_relaxed );
+		Period & period = m_periods[written % QueuePeriods];
+		period.count = count;
+		period.gain = gain;
+		m_written.store( written + 1, std::memory_order_release );
+	}
+
+	void finish( bool discard )
+	{
+		m_discard = discard;
+		requestInterruption();
+		wait();
+	}
+
+protected:
+	void run() override
+	{
+		std::size_t read = 0;
+		while( !m_discard )
+		{
+			// everything rendered before the request is still written
+			const bool finishing = isInterruptionRequested();
+			if( read == m_written.load( std::memory_order_acquire ) )
+			{
+				if( finishing )
+				{
+					break;
+				}
+				usleep( WaitMicroseconds );
+				continue;
+			}
+			const Period & period = m_periods[read % QueuePeriods];
+			m_device->writeBuffer( period.frames.get(), period.count, period.gain );
+			m_read.store( ++read, std::memory_order_release );
+		}
+	}
+
+private:
+	struct Period
+	{
+		std::unique_ptr<surroundSampleFrame[]> frames;
+		fpp_t count = 0;
+		float gain = 1.0f;
+	} ;
+
+	AudioFileDevice * m_device;
+	std::vector<Period> m_periods;
+	std::atomic<std::size_t> m_written;
+	std::atomic<std::size_t> m_read;
+	std::atomic<bool> m_discard;
+} ;
+
+
 AudioFileDevice::AudioFileDevice( OutputSettings const & outputSettings,
 					const ch_cnt_t _channels,
 					const QString & _file,
@@ -39,6 +145,7 @@ AudioFileDevice::AudioFileDevice( OutputSettings const & outputSettings,
 	m_outputSettings(outputSettings)
 {
 	setSampleRate( outputSettings.getSampleRate() );
+	setDither( outputSettings.getDither() );
 
 	if( m_outputFile.open( QFile::WriteOnly | QFile::Truncate ) == false )
 	{
@@ -71,12 +178,95 @@ AudioFileDevice::AudioFileDevice( OutputSettings const & outputSettings,
 
 AudioFileDevice::~AudioFileDevice()
 {
+	// the encoder would be left with a partly destroyed device
+	Q_ASSERT( !m_encoder );
 	m_outputFile.close();
 }
 
 
 
 
+bool AudioFileDevice::renderNextBuffer( const std::vector<AudioFileDevice *> & copies )
+{
+	startEncoding();
+	surroundSampleFrame * frames = m_encoder->nextPeriod();
+	const fpp_t count = getNextBuffer( frames );
+	if( count == 0 )
+	{
+		return false;
+	}
+	const float gain = audioEngine()->masterGain();
+
+	// every copy is encoded on a thread of its own
+	for( AudioFileDevice * copy : copies )
+	{
+		copy->startEncoding();
+		std::copy( frames, frames + count, copy->m_encoder->nextPeriod() );
+		copy->m_encoder->queue( count, gain );
+	}
+	m_encoder->queue( count, gain );
+	return true;
+}
+
+
+
+
+void AudioFileDevice::encodeFrames( const surroundSampleFrame * frames, f_cnt_t count,
+					const std::vector<AudioFileDevice *> & copies )
+{
+	const fpp_t framesPerPeriod = audioEngine()->framesPerPeriod();
+	const float gain = audioEngine()->masterGain();
+
+	startEncoding();
+	for( AudioFileDevice * copy : copies )
+	{
+		copy->startEncoding();
+	}
+
+	// the encoders take a period at most at a time
+	while( count > 0 )
+	{
+		const fpp_t chunk = static_cast<fpp_t>( std::min<f_cnt_t>( count, framesPerPeriod ) );
+		for( AudioFileDevice * copy : copies )
+		{
+			std::copy( frames, frames + chunk, copy->m_encoder->nextPeriod() );
+			copy->m_encoder->queue( chunk, gain );
+		}
+		std::copy( frames, frames + chunk, m_encoder->nextPeriod() );
+		m_encoder->queue( chunk, gain );
+
+		frames += chunk;
+		count -= chunk;
+	}
+}
+
+
+
+
+void AudioFileDevice::finishEncoding( bool discard )
+{
+	if( m_encoder )
+	{
+		m_encoder->finish( discard );
+		m_encoder.reset();
+	}
+}
+
+
+
+
+void AudioFileDevice::startEncoding()
+{
+	if( !m_encoder )
+	{
+		m_encoder.reset( new AudioFileEncoder( this, audioEngine()->framesPerPeriod() ) );
+		m_encoder->start();
+	}
+}
+
+
+
+
 int AudioFileDevice::writeData( const void* data, int len )
 {
 	if( m_outputFile.isOpen() )
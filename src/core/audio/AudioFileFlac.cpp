@@ -24,7 +24,6 @@
 
 #include <QtGlobal>
 
-#include <cmath>
 #include <memory>
 
 #include "AudioFileFlac.h"
@@ -89,22 +88,15 @@ bool AudioFileFlac::startEncoding()
 void AudioFileFlac::writeBuffer(surroundSampleFrame const* _ab, fpp_t const frames, float master_gain)
 {
 	OutputSettings::BitDepth depth = getOutputSettings().getBitDepth();
-	float clipvalue = std::nextafterf( -1.0f, 0.0f );
 
-	if (depth == OutputSettings::Depth_24Bit || depth == OutputSettings::Depth_32Bit) // Float encoding
+	if (depth == OutputSettings::Depth_24Bit || depth == OutputSettings::Depth_32Bit)
 	{
-		std::unique_ptr<sample_t[]> buf{ new sample_t[frames*channels()] };
-		for(fpp_t frame = 0; frame < frames; ++frame)
-		{
-			for(ch_cnt_t channel=0; channel<channels(); ++channel)
-			{
-				// Clip the negative side to just above -1.0 in order to prevent it from changing sign
-				// Upstream issue: https://github.com/erikd/libsndfile/issues/309
-				// When this commit is reverted libsndfile-1.0.29 must be made a requirement for FLAC
-				buf[frame*channels() + channel] = qMax( clipvalue, _ab[frame][channel] * master_gain );
-			}
-		}
-		sf_writef_float(m_sf,static_cast<float*>(buf.get()),frames);
+		// converted to integers here, which also avoids the sign change of
+		// libsndfile before 1.0.29 when it converts -1.0 itself
+		// (https://github.com/erikd/libsndfile/issues/309)
+		std::unique_ptr<int32_t[]> buf{ new int32_t[frames*channels()] };
+		convertToS24(_ab, frames, master_gain, buf.get());
+		sf_writef_int(m_sf, buf.get(), frames);
 	}
 	else // integer PCM encoding
 	{
@@ -102,20 +102,20 @@ void AudioFileWave::writeBuffer( const surroundSampleFrame * _ab,
 {
 	OutputSettings::BitDepth bitDepth = getOutputSettings().getBitDepth();
 
-	if( bitDepth == OutputSettings::Depth_32Bit || bitDepth == OutputSettings::Depth_24Bit )
+	if( bitDepth == OutputSettings::Depth_32Bit )
 	{
 		float *  buf = new float[_frames*channels()];
-		for( fpp_t frame = 0; frame < _frames; ++frame )
-		{
-			for( ch_cnt_t chnl = 0; chnl < channels(); ++chnl )
-			{
-				buf[frame*channels()+chnl] = _ab[frame][chnl] *
-								_master_gain;
-			}
-		}
+		convertToFloat( _ab, _frames, _master_gain, buf );
 		sf_writef_float( m_sf, buf, _frames );
 		delete[] buf;
 	}
+	else if( bitDepth == OutputSettings::Depth_24Bit )
+	{
+		int32_t * buf = new int32_t[_frames * channels()];
+		convertToS24( _ab, _frames, _master_gain, buf );
+		sf_writef_int( m_sf, buf, _frames );
+		delete[] buf;
+	}
 	else
 	{
 		int_sample_t * buf = new int_sample_t[_frames * channels()];
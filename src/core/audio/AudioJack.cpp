@@ -29,6 +29,7 @@
 #include <QLineEdit>
 #include <QLabel>
 #include <QMessageBox>
+#include <QThread>
 
 #include "Engine.h"
 #include "GuiApplication.h"
@@ -39,6 +40,7 @@
 #include "MainWindow.h"
 #include "AudioEngine.h"
 #include "MidiJack.h"
+#include "Mixer.h"
 
 
 
@@ -53,9 +55,11 @@ AudioJack::AudioJack( bool & _success_ful, AudioEngine*  _audioEngine ) :
 	m_tempOutBufs( new jack_default_audio_sample_t *[channels()] ),
 	m_outBuf( new surroundSampleFrame[audioEngine()->framesPerPeriod()] ),
 	m_framesDoneInCurBuf( 0 ),
-	m_framesToDoInCurBuf( 0 )
+	m_framesToDoInCurBuf( 0 ),
+	m_channelBuffer( 0 )
 {
 	m_stopped = true;
+	m_inCallback = false;
 
 	_success_ful = initJackClient();
 	if( _success_ful )
@@ -79,6 +83,10 @@ AudioJack::~AudioJack()
 		unregisterPort( m_portMap.begin().key() );
 	}
 #endif
+	while( !m_channelOutputs.isEmpty() )
+	{
+		unregisterChannel( m_channelOutputs.begin().key() );
+	}
 
 	if( m_client != nullptr )
 	{
@@ -101,6 +109,13 @@ void AudioJack::restartAfterZombified()
 {
 	if( initJackClient() )
 	{
+		// the ports of the channels went with the old client
+		const QList<const MixerChannel *> channels = m_channelOutputs.keys();
+		m_channelOutputs.clear();
+		for( const MixerChannel * channel : channels )
+		{
+			registerChannel( channel );
+		}
 		m_active = false;
 		startProcessing();
 		QMessageBox::information( getGUI()->mainWindow(),
@@ -171,6 +186,8 @@ bool AudioJack::initJackClient()
 	// set shutdown-callback
 	jack_on_shutdown( m_client, shutdownCallback, this );
 
+	jack_set_xrun_callback( m_client, xrunCallback, this );
+
 
 
 	if( jack_get_sample_rate( m_client ) != sampleRate() )
@@ -255,6 +272,24 @@ void AudioJack::startProcessing()
 void AudioJack::stopProcessing()
 {
 	m_stopped = true;
+	// without a FIFO the callback renders, which has to be done before the
+	// audio engine may change
+	while( m_inCallback )
+	{
+		QThread::yieldCurrentThread();
+	}
+}
+
+
+
+
+bool AudioJack::rendersInCallback() const
+{
+	// only if every callback gets exactly one period, which can then be
+	// written right from the audio engine's buffer
+	return m_client != nullptr &&
+		jack_get_buffer_size( m_client ) == audioEngine()->framesPerPeriod() &&
+		sampleRate() == audioEngine()->processingSampleRate();
 }
 
 
@@ -344,6 +379,162 @@ void AudioJack::renamePort( AudioPort * _port )
 
 
 
+bool AudioJack::supportsChannelOutputs() const
+{
+	return m_client != nullptr;
+}
+
+
+
+
+static QString channelPortName( const MixerChannel * _channel, ch_cnt_t _ch )
+{
+	return _channel->m_name + ( _ch == 0 ? " L" : " R" );
+}
+
+
+
+
+void AudioJack::registerChannel( const MixerChannel * _channel )
+{
+	unregisterChannel( _channel );
+
+	ChannelOutput output;
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		output.ports[ch] = jack_port_register( m_client,
+				channelPortName( _channel, ch ).toLatin1().constData(),
+				JACK_DEFAULT_AUDIO_TYPE, JackPortIsOutput, 0 );
+		if( output.ports[ch] == nullptr )
+		{
+			printf( "Couldn't register JACK port for mixer channel "
+				"\"%s\"!\n", _channel->m_name.toUtf8().constData() );
+		}
+	}
+	for( QVector<sampleFrame> & buffer : output.buffers )
+	{
+		buffer.fill( sampleFrame{ 0, 0 }, audioEngine()->framesPerPeriod() );
+	}
+
+	QMutexLocker lock( &m_channelMutex );
+	m_channelOutputs.insert( _channel, output );
+}
+
+
+
+
+void AudioJack::unregisterChannel( const MixerChannel * _channel )
+{
+	m_channelMutex.lock();
+	if( !m_channelOutputs.contains( _channel ) )
+	{
+		m_channelMutex.unlock();
+		return;
+	}
+	const ChannelOutput output = m_channelOutputs.take( _channel );
+	m_channelMutex.unlock();
+
+	for( jack_port_t * port : output.ports )
+	{
+		if( port != nullptr )
+		{
+			jack_port_unregister( m_client, port );
+		}
+	}
+}
+
+
+
+
+void AudioJack::renameChannel( const MixerChannel * _channel )
+{
+	QMutexLocker lock( &m_channelMutex );
+	if( !m_channelOutputs.contains( _channel ) )
+	{
+		return;
+	}
+	const ChannelOutput & output = m_channelOutputs[_channel];
+	for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+	{
+		if( output.ports[ch] == nullptr )
+		{
+			continue;
+		}
+		const QByteArray name = channelPortName( _channel, ch ).toLatin1();
+#ifdef LMMS_HAVE_JACK_PRENAME
+		jack_port_rename( m_client, output.ports[ch], name.constData() );
+#else
+		jack_port_set_name( output.ports[ch], name.constData() );
+#endif
+	}
+}
+
+
+
+
+void AudioJack::writeChannel( const MixerChannel * _channel, const sampleFrame * _buf,
+						const float _gain, const fpp_t _frames )
+{
+	// in step with the master output only if the period is rendered in
+	// the callback, which is also the only one to wait for
+	if( audioEngine()->hasFifoWriter() || !m_channelMutex.tryLock() )
+	{
+		return;
+	}
+	ChannelOutput * output = m_channelOutputs.contains( _channel ) ?
+					&m_channelOutputs[_channel] : nullptr;
+	if( output )
+	{
+		QVector<sampleFrame> & buffer = output->buffers[m_channelBuffer];
+		const fpp_t frames = qMin<fpp_t>( _frames, buffer.size() );
+		for( fpp_t f = 0; f < frames; ++f )
+		{
+			buffer[f][0] = _buf[f][0] * _gain;
+			buffer[f][1] = _buf[f][1] * _gain;
+		}
+	}
+	m_channelMutex.unlock();
+}
+
+
+
+
+void AudioJack::writeChannelPorts( jack_nframes_t _nframes, bool aligned )
+{
+	if( m_channelOutputs.isEmpty() || !m_channelMutex.tryLock() )
+	{
+		return;
+	}
+	for( ChannelOutput & output : m_channelOutputs )
+	{
+		// what was mixed in the last period, like the master output
+		QVector<sampleFrame> & buffer = output.buffers[m_channelBuffer ^ 1];
+		const jack_nframes_t frames = aligned ?
+			qMin<jack_nframes_t>( _nframes, buffer.size() ) : 0;
+		for( ch_cnt_t ch = 0; ch < DEFAULT_CHANNELS; ++ch )
+		{
+			if( output.ports[ch] == nullptr )
+			{
+				continue;
+			}
+			jack_default_audio_sample_t * o =
+				(jack_default_audio_sample_t *) jack_port_get_buffer(
+							output.ports[ch], _nframes );
+			for( jack_nframes_t frame = 0; frame < frames; ++frame )
+			{
+				o[frame] = buffer[frame][ch];
+			}
+			memset( o + frames, 0, sizeof( *o ) * ( _nframes - frames ) );
+		}
+		// silent if the channel isn't mixed in the next period
+		memset( buffer.data(), 0, sizeof( sampleFrame ) * buffer.size() );
+	}
+	m_channelMutex.unlock();
+}
+
+
+
+
 int AudioJack::processCallback( jack_nframes_t _nframes, void * _udata )
 {
 
@@ -385,7 +576,39 @@ int AudioJack::processCallback( jack_nframes_t _nframes, void * _udata )
 	}
 #endif
 
+	m_inCallback = true;
+
 	jack_nframes_t done = 0;
+	bool channelsAligned = false;
+	if( !audioEngine()->hasFifoWriter() && m_stopped == false &&
+		_nframes == audioEngine()->framesPerPeriod() &&
+		m_framesDoneInCurBuf == m_framesToDoInCurBuf &&
+		sampleRate() == audioEngine()->processingSampleRate() )
+	{
+		// render the period right here and deinterleave it into the ports
+		m_channelBuffer ^= 1;
+		const surroundSampleFrame * b = audioEngine()->nextBuffer();
+		if( b )
+		{
+			const float gain = audioEngine()->masterGain();
+			for( int c = 0; c < channels(); ++c )
+			{
+				jack_default_audio_sample_t * o = m_tempOutBufs[c];
+				for( jack_nframes_t frame = 0; frame < _nframes; ++frame )
+				{
+					o[frame] = b[frame][c] * gain;
+				}
+			}
+			audioEngine()->releaseBuffer();
+			done = _nframes;
+			channelsAligned = true;
+		}
+		else
+		{
+			m_stopped = true;
+		}
+	}
+
 	while( done < _nframes && m_stopped == false )
 	{
 		jack_nframes_t todo = qMin<jack_nframes_t>(
@@ -424,6 +647,10 @@ int AudioJack::processCallback( jack_nframes_t _nframes, void * _udata )
 		}
 	}
 
+	writeChannelPorts( _nframes, channelsAligned );
+
+	m_inCallback = false;
+
 	return 0;
 }
 
@@ -449,6 +676,15 @@ void AudioJack::shutdownCallback( void * _udata )
 
 
 
+int AudioJack::xrunCallback( void * _udata )
+{
+	static_cast<AudioJack *>( _udata )->audioEngine()->profiler().countDeviceXrun();
+	return 0;
+}
+
+
+
+
 
 AudioJack::setupWidget::setupWidget( QWidget * _parent ) :
 	AudioDeviceSetupWidget( AudioJack::name(), _parent )
@@ -25,6 +25,7 @@
 #include "AudioPort.h"
 #include "AudioDevice.h"
 #include "AudioEngine.h"
+#include "AudioEngineWorkerThread.h"
 #include "EffectChain.h"
 #include "Mixer.h"
 #include "Engine.h"
@@ -37,8 +38,15 @@ AudioPort::AudioPort( const QString & _name, bool _has_effect_chain,
 		BoolModel * mutedModel ) :
 	m_bufferUsage( false ),
 	m_portBuffer( BufferManager::acquire() ),
+	m_portBufferSilent( false ),
 	m_extOutputEnabled( false ),
+	m_frozen( false ),
+	m_freezeCapture( nullptr ),
+	m_patternCapture( nullptr ),
 	m_nextMixerChannel( 0 ),
+	m_targetMixerChannel( 0 ),
+	m_pendingPlayHandles( 0 ),
+	m_playHandleBatch( nullptr ),
 	m_name( "unnamed port" ),
 	m_effects( _has_effect_chain ? new EffectChain( nullptr ) : nullptr ),
 	m_volumeModel( volumeModel ),
@@ -103,15 +111,61 @@ bool AudioPort::processEffects()
 
 void AudioPort::doProcessing()
 {
-	if( m_mutedModel && m_mutedModel->value() )
+	const bool muted = m_mutedModel && m_mutedModel->value();
+	if( !muted )
 	{
-		return;
+		processBuffer();
+	}
+
+	if( m_freezeCapture )
+	{
+		const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
+		if( muted )
+		{
+			m_freezeCapture->resize( m_freezeCapture->size() + fpp * DEFAULT_CHANNELS );
+		}
+		else
+		{
+			const sample_t * samples = &m_portBuffer[0][0];
+			m_freezeCapture->insert( m_freezeCapture->end(), samples, samples + fpp * DEFAULT_CHANNELS );
+		}
 	}
 
+	// our output is ready, let the mixer-channel know
+	Engine::mixer()->audioPortProcessed( m_targetMixerChannel );
+}
+
+
+
+
+float AudioPort::outputPeak() const
+{
+	if( m_portBufferSilent )
+	{
+		return 0.0f;
+	}
+	const sampleFrame peak = MixHelpers::peak( m_portBuffer, Engine::audioEngine()->framesPerPeriod() );
+	return qMax( peak[0], peak[1] );
+}
+
+
+
+
+void AudioPort::processBuffer()
+{
 	const fpp_t fpp = Engine::audioEngine()->framesPerPeriod();
 
-	// clear the buffer
-	BufferManager::clear( m_portBuffer, fpp );
+	// clear the buffer, unless nothing has been written to it since the
+	// last time
+	if( m_portBufferSilent )
+	{
+		Engine::audioEngine()->profiler().countSkipped( AudioEngineProfiler::SkippedWork::BufferClear );
+	}
+	else
+	{
+		BufferManager::clear( m_portBuffer, fpp );
+		m_portBufferSilent = true;
+	}
 
 	//qDebug( "Playhandles: %d", m_playHandles.size() );
 	for( PlayHandle * ph : m_playHandles ) // now we mix all playhandle buffers into the audioport buffer
@@ -130,108 +184,91 @@ void AudioPort::doProcessing()
 		}
 	}
 
-	if( m_bufferUsage )
+	if( m_patternCapture )
 	{
-		// handle volume and panning
-		// has both vol and pan models
-		if( m_volumeModel && m_panningModel )
-		{
-			ValueBuffer * volBuf = m_volumeModel->valueBuffer();
-			ValueBuffer * panBuf = m_panningModel->valueBuffer();
-
-			// both vol and pan have s.ex.data:
-			if( volBuf && panBuf )
-			{
-				for( f_cnt_t f = 0; f < fpp; ++f )
-				{
-					float v = volBuf->values()[ f ] * 0.01f;
-					float p = panBuf->values()[ f ] * 0.01f;
-					m_portBuffer[f][0] *= ( p <= 0 ? 1.0f : 1.0f - p ) * v;
-					m_portBuffer[f][1] *= ( p >= 0 ? 1.0f : 1.0f + p ) * v;
-				}
-			}
-
-			// only vol has s.ex.data:
-			else if( volBuf )
-			{
-				float p = m_panningModel->value() * 0.01f;
-				float l = ( p <= 0 ? 1.0f : 1.0f - p );
-				float r = ( p >= 0 ? 1.0f : 1.0f + p );
-				for( f_cnt_t f = 0; f < fpp; ++f )
-				{
-					float v = volBuf->values()[ f ] * 0.01f;
-					m_portBuffer[f][0] *= v * l;
-					m_portBuffer[f][1] *= v * r;
-				}
-			}
-
-			// only pan has s.ex.data:
-			else if( panBuf )
-			{
-				float v = m_volumeModel->value() * 0.01f;
-				for( f_cnt_t f = 0; f < fpp; ++f )
-				{
-					float p = panBuf->values()[ f ] * 0.01f;
-					m_portBuffer[f][0] *= ( p <= 0 ? 1.0f : 1.0f - p ) * v;
-					m_portBuffer[f][1] *= ( p >= 0 ? 1.0f : 1.0f + p ) * v;
-				}
-			}
-
-			// neither has s.ex.data:
-			else
-			{
-				float p = m_panningModel->value() * 0.01f;
-				float v = m_volumeModel->value() * 0.01f;
-				for( f_cnt_t f = 0; f < fpp; ++f )
-				{
-					m_portBuffer[f][0] *= ( p <= 0 ? 1.0f : 1.0f - p ) * v;
-					m_portBuffer[f][1] *= ( p >= 0 ? 1.0f : 1.0f + p ) * v;
-				}
-			}
-		}
+		const sample_t * samples = &m_portBuffer[0][0];
+		m_patternCapture->insert( m_patternCapture->end(), samples, samples + fpp * DEFAULT_CHANNELS );
+	}
 
-		// has vol model only
-		else if( m_volumeModel )
+	if( m_frozen )
+	{
+		// the frozen track's cache has been through all of the below
+		if( m_bufferUsage )
 		{
-			ValueBuffer * volBuf = m_volumeModel->valueBuffer();
-
-			if( volBuf )
-			{
-				for( f_cnt_t f = 0; f < fpp; ++f )
-				{
-					float v = volBuf->values()[ f ] * 0.01f;
-					m_portBuffer[f][0] *= v;
-					m_portBuffer[f][1] *= v;
-				}
-			}
-			else
-			{
-				float v = m_volumeModel->value() * 0.01f;
-				for( f_cnt_t f = 0; f < fpp; ++f )
-				{
-					m_portBuffer[f][0] *= v;
-					m_portBuffer[f][1] *= v;
-				}
-			}
+			m_portBufferSilent = false;
+			Engine::mixer()->mixToChannel( m_portBuffer, m_targetMixerChannel );
+			m_bufferUsage = false;
 		}
+		return;
 	}
-	// as of now there's no situation where we only have panning model but no volume model
-	// if we have neither, we don't have to do anything here - just pass the audio as is
 
-	// handle effects
+	// handle volume and panning - there's no situation where we only have
+	// a panning model but no volume model. If we have neither, we just pass
+	// the audio as is
+	ValueRamp volume;
+	ValueRamp panning = { 0.0f, 0.0f };
+	const fpp_t interval = Engine::audioEngine()->automationControlInterval();
+	if( m_bufferUsage && m_volumeModel && interval > 1 && m_volumeModel->valueRamp( volume )
+		&& ( !m_panningModel || m_panningModel->valueRamp( panning ) ) )
+	{
+		// without filling the models' value buffers
+		MixHelpers::applyVolumeAndPanning( m_portBuffer, volume, panning,
+			m_panningModel ? Engine::audioEngine()->panLaw() : MixHelpers::PanLaw::Linear,
+			interval, fpp );
+	}
+	else if( m_bufferUsage && m_volumeModel )
+	{
+		MixHelpers::applyVolumeAndPanning( m_portBuffer,
+			m_volumeModel->value(), m_volumeModel->valueBuffer(),
+			m_panningModel ? m_panningModel->value() : 0.0f,
+			m_panningModel ? m_panningModel->valueBuffer() : nullptr,
+			// ports without panning must not be attenuated by the pan law
+			m_panningModel ? Engine::audioEngine()->panLaw() : MixHelpers::PanLaw::Linear,
+			fpp );
+	}
+
+	// handle effects - running effects may write to the buffer even
+	// without input (e.g. reverb tails)
+	if( m_bufferUsage || ( m_effects && m_effects->hasRunningEffects() ) )
+	{
+		m_portBufferSilent = false;
+	}
 	const bool me = processEffects();
 	if( me || m_bufferUsage )
 	{
-		Engine::mixer()->mixToChannel( m_portBuffer, m_nextMixerChannel ); 	// send output to mixer
+		Engine::mixer()->mixToChannel( m_portBuffer, m_targetMixerChannel ); 	// send output to mixer
 																			// TODO: improve the flow here - convert to pull model
 		m_bufferUsage = false;
 	}
 }
 
 
+void AudioPort::prepareProcessing()
+{
+	// the mixer-channel must not change while the period is rendered, as
+	// the channel counts our output as one of its inputs
+	m_targetMixerChannel = m_nextMixerChannel;
+	m_pendingPlayHandles = 0;
+}
+
+
+
+
+void AudioPort::playHandleProcessed()
+{
+	if( --m_pendingPlayHandles == 0 )
+	{
+		AudioEngineWorkerThread::addJob( this );
+	}
+}
+
+
+
+
 void AudioPort::addPlayHandle( PlayHandle * handle )
 {
 	m_playHandleLock.lock();
+		handle->m_audioPortIndex = m_playHandles.size();
 		m_playHandles.append( handle );
 	m_playHandleLock.unlock();
 }
@@ -240,10 +277,15 @@ void AudioPort::addPlayHandle( PlayHandle * handle )
 void AudioPort::removePlayHandle( PlayHandle * handle )
 {
 	m_playHandleLock.lock();
-		PlayHandleList::Iterator it =	std::find( m_playHandles.begin(), m_playHandles.end(), handle );
-		if( it != m_playHandles.end() )
+		const int index = handle->m_audioPortIndex;
+		if( index >= 0 && index < m_playHandles.size() && m_playHandles[index] == handle )
 		{
-			m_playHandles.erase( it );
+			// move the last handle into the gap
+			PlayHandle * last = m_playHandles.last();
+			m_playHandles[index] = last;
+			last->m_audioPortIndex = index;
+			m_playHandles.removeLast();
+			handle->m_audioPortIndex = -1;
 		}
 	m_playHandleLock.unlock();
 }
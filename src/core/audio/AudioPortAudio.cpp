@@ -224,6 +224,16 @@ void AudioPortAudio::stopProcessing()
 
 
 
+bool AudioPortAudio::rendersInCallback() const
+{
+	// the stream is opened with one period per buffer, which PortAudio
+	// keeps to whatever the host's buffers are
+	return sampleRate() == audioEngine()->processingSampleRate();
+}
+
+
+
+
 void AudioPortAudio::applyQualitySettings()
 {
 	if( hqAudio() )
@@ -271,6 +281,35 @@ int AudioPortAudio::process_callback(
 		return paComplete;
 	}
 
+	const float master_gain = audioEngine()->masterGain();
+
+	if( !audioEngine()->hasFifoWriter() && m_outBufPos == 0 &&
+		_framesPerBuffer == audioEngine()->framesPerPeriod() &&
+		sampleRate() == audioEngine()->processingSampleRate() )
+	{
+		// render the period right here and write it without a copy
+		const surroundSampleFrame * b = audioEngine()->nextBuffer();
+		if( !b )
+		{
+			m_stopped = true;
+			memset( _outputBuffer, 0, _framesPerBuffer *
+				channels() * sizeof(float) );
+			return paComplete;
+		}
+		for( fpp_t frame = 0; frame < _framesPerBuffer; ++frame )
+		{
+			for( ch_cnt_t chnl = 0; chnl < channels(); ++chnl )
+			{
+				( _outputBuffer + frame * channels() )[chnl] =
+						AudioEngine::clip( b[frame][chnl] * master_gain );
+			}
+		}
+		audioEngine()->releaseBuffer();
+		return paContinue;
+	}
+
+	// otherwise the buffers are filled from a period that may have to be
+	// split across them
 	while( _framesPerBuffer )
 	{
 		if( m_outBufPos == 0 )
@@ -289,8 +328,6 @@ int AudioPortAudio::process_callback(
 		const int min_len = qMin( (int)_framesPerBuffer,
 			m_outBufSize - m_outBufPos );
 
-		float master_gain = audioEngine()->masterGain();
-
 		for( fpp_t frame = 0; frame < min_len; ++frame )
 		{
 			for( ch_cnt_t chnl = 0; chnl < channels(); ++chnl )
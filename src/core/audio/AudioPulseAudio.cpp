@@ -147,6 +147,14 @@ static void stream_state_callback( pa_stream *s, void * userdata )
 
 
 
+/* This is called whenever the server ran out of data to play */
+static void stream_underflow_callback( pa_stream *, void * )
+{
+	Engine::audioEngine()->profiler().countDeviceXrun();
+}
+
+
+
 /* This is called whenever the context status changes */
 static void context_state_callback(pa_context *c, void *userdata)
 {
@@ -164,6 +172,7 @@ static void context_state_callback(pa_context *c, void *userdata)
 			_this->m_s = pa_stream_new( c, "lmms", &_this->m_sampleSpec,  nullptr);
 			pa_stream_set_state_callback( _this->m_s, stream_state_callback, _this );
 			pa_stream_set_write_callback( _this->m_s, stream_write_callback, _this );
+			pa_stream_set_underflow_callback( _this->m_s, stream_underflow_callback, _this );
 
 			pa_buffer_attr buffer_attr;
 
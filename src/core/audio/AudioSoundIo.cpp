@@ -28,6 +28,7 @@
 
 #include <QLabel>
 #include <QLineEdit>
+#include <QThread>
 
 #include "Engine.h"
 #include "debug.h"
@@ -50,6 +51,7 @@ AudioSoundIo::AudioSoundIo( bool & outSuccessful, AudioEngine * _audioEngine ) :
 	m_outBufFrameIndex = 0;
 	m_outBufFramesTotal = 0;
 	m_stopped = true;
+	m_inCallback = false;
 	m_outstreamStarted = false;
 
 	m_soundio = soundio_create();
@@ -258,6 +260,13 @@ void AudioSoundIo::stopProcessing()
 		}
 	}
 
+	// without a FIFO the callback renders, which has to be done before the
+	// audio engine may change
+	while (m_inCallback)
+	{
+		QThread::yieldCurrentThread();
+	}
+
 	if (m_outBuf)
 	{
 		delete[] m_outBuf;
@@ -265,6 +274,12 @@ void AudioSoundIo::stopProcessing()
 	}
 }
 
+bool AudioSoundIo::rendersInCallback() const
+{
+	// the callback writes whole periods when it may, see writeFrames()
+	return sampleRate() == audioEngine()->processingSampleRate();
+}
+
 void AudioSoundIo::errorCallback(int err)
 {
 	fprintf(stderr, "soundio: error streaming: %s\n", soundio_strerror(err));
@@ -273,11 +288,21 @@ void AudioSoundIo::errorCallback(int err)
 void AudioSoundIo::underflowCallback()
 {
 	fprintf(stderr, "soundio: buffer underflow reported\n");
+	audioEngine()->profiler().countDeviceXrun();
 }
 
 void AudioSoundIo::writeCallback(int frameCountMin, int frameCountMax)
 {
-	if (m_stopped) {return;}
+	m_inCallback = true;
+	if (!m_stopped)
+	{
+		writeFrames(frameCountMin, frameCountMax);
+	}
+	m_inCallback = false;
+}
+
+void AudioSoundIo::writeFrames(int frameCountMin, int frameCountMax)
+{
 	const struct SoundIoChannelLayout *layout = &m_outstream->layout;
 	SoundIoChannelArea *areas;
 	int bytesPerSample = m_outstream->bytes_per_sample;
@@ -285,7 +310,16 @@ void AudioSoundIo::writeCallback(int frameCountMin, int frameCountMax)
 
 	const float gain = audioEngine()->masterGain();
 
+	// whole periods are rendered right into the stream's buffer, so only
+	// as many of them as fit are asked for, unless more are needed
+	const int period = audioEngine()->framesPerPeriod();
+	const bool direct = !audioEngine()->hasFifoWriter() &&
+		sampleRate() == audioEngine()->processingSampleRate();
 	int framesLeft = frameCountMax;
+	if (direct && frameCountMax >= period)
+	{
+		framesLeft = qMax(frameCountMax / period * period, frameCountMin);
+	}
 
 	while (framesLeft > 0)
 	{
@@ -310,7 +344,32 @@ void AudioSoundIo::writeCallback(int frameCountMin, int frameCountMax)
 			continue;
 		}
 
-		for (int frame = 0; frame < frameCount; frame += 1)
+		int frame = 0;
+		if (direct && m_outBufFrameIndex >= m_outBufFramesTotal)
+		{
+			for (; frame + period <= frameCount; frame += period)
+			{
+				const surroundSampleFrame * b = audioEngine()->nextBuffer();
+				if (!b)
+				{
+					m_stopped = true;
+					break;
+				}
+				for (int f = 0; f < period; ++f)
+				{
+					for (int channel = 0; channel < layout->channel_count; channel += 1)
+					{
+						float sample = gain * b[f][channel];
+						memcpy(areas[channel].ptr, &sample, bytesPerSample);
+						areas[channel].ptr += areas[channel].step;
+					}
+				}
+				audioEngine()->releaseBuffer();
+			}
+		}
+
+		// the rest comes from a period which may be split across callbacks
+		for (; frame < frameCount && !m_stopped; frame += 1)
 		{
 			if (m_outBufFrameIndex >= m_outBufFramesTotal)
 			{
@@ -144,6 +144,57 @@ void Lv2ControlBase::copyBuffersToLmms(sampleFrame *buf, fpp_t frames) const {
 
 
 
+void Lv2ControlBase::copyBuffersFromLmms(const PlanarBuffer &buf, fpp_t frames) {
+	unsigned firstChan = 0;
+	for (auto& c : m_procs) {
+		c->copyBuffersFromCore(buf, firstChan, m_channelsPerProc, frames);
+		firstChan += m_channelsPerProc;
+	}
+}
+
+
+
+
+void Lv2ControlBase::copyBuffersToLmms(const PlanarBuffer &buf, fpp_t frames) const {
+	unsigned firstChan = 0;
+	for (const auto& c : m_procs) {
+		c->copyBuffersToCore(buf, firstChan, m_channelsPerProc, frames);
+		firstChan += m_channelsPerProc;
+	}
+}
+
+
+
+
+bool Lv2ControlBase::connectBuffersOfLmms(const PlanarBuffer &in, const PlanarBuffer &out)
+{
+	unsigned firstChan = 0;
+	for (auto& c : m_procs) {
+		if (!c->connectBuffersOfCore(in, out, firstChan, m_channelsPerProc))
+		{
+			for (auto& d : m_procs) { d->disconnectBuffersOfCore(); }
+			return false;
+		}
+		firstChan += m_channelsPerProc;
+	}
+	return true;
+}
+
+
+
+
+bool Lv2ControlBase::canProcessInPlace() const
+{
+	for (const auto& c : m_procs)
+	{
+		if (!c->canProcessInPlace()) { return false; }
+	}
+	return true;
+}
+
+
+
+
 void Lv2ControlBase::run(fpp_t frames) {
 	for (auto& c : m_procs) { c->run(frames); }
 }
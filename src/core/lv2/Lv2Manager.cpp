@@ -33,8 +33,11 @@
 #include <lv2.h>
 #include <lv2/lv2plug.in/ns/ext/buf-size/buf-size.h>
 #include <lv2/lv2plug.in/ns/ext/options/options.h>
+#include <lv2/lv2plug.in/ns/ext/worker/worker.h>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
+#include <QDomDocument>
 #include <QLibrary>
 #include <QElapsedTimer>
 
@@ -45,6 +48,30 @@
 #include "Lv2ControlBase.h"
 #include "Lv2Options.h"
 #include "PluginIssue.h"
+#include "lmmsversion.h"
+
+
+//! Bump this whenever the layout of the scan cache changes
+static const int LV2_CACHE_VERSION = 1;
+
+
+
+//! Newest modification time of the files in a bundle, or -1 if unknown
+static qint64 bundleModified(const QString& bundleUri)
+{
+	char* path = lilv_file_uri_parse(bundleUri.toUtf8().constData(), nullptr);
+	if (!path) { return -1; }
+	const QDir bundle(QString::fromUtf8(path));
+	lilv_free(path);
+
+	if (!bundle.exists()) { return -1; }
+	qint64 newest = QFileInfo(bundle.absolutePath()).lastModified().toMSecsSinceEpoch();
+	for (const QFileInfo& file : bundle.entryInfoList(QDir::Files))
+	{
+		newest = std::max(newest, file.lastModified().toMSecsSinceEpoch());
+	}
+	return newest;
+}
 
 
 
@@ -83,6 +110,8 @@ Lv2Manager::Lv2Manager() :
 	m_supportedFeatureURIs.insert(LV2_BUF_SIZE__boundedBlockLength);
 	// block length is only changed initially in AudioEngine CTOR
 	m_supportedFeatureURIs.insert(LV2_BUF_SIZE__fixedBlockLength);
+	// work is done by Lv2Worker
+	m_supportedFeatureURIs.insert(LV2_WORKER__schedule);
 
 	auto supportOpt = [this](Lv2UridCache::Id id)
 	{
@@ -138,27 +167,58 @@ void Lv2Manager::initPlugins()
 	QElapsedTimer timer;
 	timer.start();
 
+	// Checking a plugin makes lilv load all of its data. Plugins from
+	// bundles that did not change since the last start are taken from the
+	// scan cache instead.
+	const QHash<QString, CacheEntry> cache = readCache();
+	QHash<QString, qint64> bundleTimes;
+	m_cache.clear();
+	bool cacheChanged = false;
+
 	unsigned blacklisted = 0;
 	LILV_FOREACH(plugins, itr, plugins)
 	{
 		const LilvPlugin* curPlug = lilv_plugins_get(plugins, itr);
+		const QString uri = QString::fromUtf8(lilv_node_as_uri(lilv_plugin_get_uri(curPlug)));
+		const QString bundle = QString::fromUtf8(lilv_node_as_uri(lilv_plugin_get_bundle_uri(curPlug)));
+		if (!bundleTimes.contains(bundle))
+		{
+			bundleTimes.insert(bundle, bundleModified(bundle));
+		}
+
+		CacheEntry entry;
+		const auto cached = cache.find(uri);
+		if (cached != cache.end() && cached->bundle == bundle
+			&& cached->modified != -1 && cached->modified == bundleTimes[bundle])
+		{
+			entry = *cached;
+		}
+		else
+		{
+			entry.bundle = bundle;
+			entry.modified = bundleTimes[bundle];
+			entry.type = Lv2ControlBase::check(curPlug, entry.issues);
+			std::sort(entry.issues.begin(), entry.issues.end());
+			auto last = std::unique(entry.issues.begin(), entry.issues.end());
+			entry.issues.erase(last, entry.issues.end());
+			entry.name = qStringFromPluginNode(curPlug, lilv_plugin_get_name);
+			cacheChanged = true;
+		}
+		m_cache.insert(uri, entry);
 
-		std::vector<PluginIssue> issues;
-		Plugin::PluginTypes type = Lv2ControlBase::check(curPlug, issues);
-		std::sort(issues.begin(), issues.end());
-		auto last = std::unique(issues.begin(), issues.end());
-		issues.erase(last, issues.end());
+		const std::vector<PluginIssue>& issues = entry.issues;
+		const Plugin::PluginTypes type = entry.type;
 		if (m_debug && issues.size())
 		{
 			qDebug() << "Lv2 plugin"
-				<< qStringFromPluginNode(curPlug, lilv_plugin_get_name)
+				<< entry.name
 				<< "(URI:"
 				<< lilv_node_as_uri(lilv_plugin_get_uri(curPlug))
 				<< ") can not be loaded:";
 			for (const PluginIssue& iss : issues) { qDebug() << "  - " << iss; }
 		}
 
-		Lv2Info info(curPlug, type, issues.empty());
+		Lv2Info info(curPlug, type, issues.empty(), entry.name);
 
 		m_lv2InfoMap[lilv_node_as_uri(lilv_plugin_get_uri(curPlug))]
 			= std::move(info);
@@ -175,6 +235,11 @@ void Lv2Manager::initPlugins()
 		++pluginCount;
 	}
 
+	if (cacheChanged || cache.size() != m_cache.size())
+	{
+		writeCache();
+	}
+
 	qDebug() << "Lv2 plugin SUMMARY:"
 		<< pluginsLoaded << "of" << pluginCount << " loaded in"
 		<< timer.elapsed() << "msecs.";
@@ -240,6 +305,87 @@ AutoLilvNodes Lv2Manager::findNodes(const LilvNode *subject,
 
 
 
+QHash<QString, Lv2Manager::CacheEntry> Lv2Manager::readCache() const
+{
+	QHash<QString, CacheEntry> cache;
+
+	QFile file(ConfigManager::inst()->lv2CacheFile());
+	QDomDocument doc;
+	if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file))
+	{
+		return cache;
+	}
+
+	// blacklisting is one of the issues, so it must match, too
+	const QDomElement root = doc.documentElement();
+	if (root.tagName() != "lv2cache"
+		|| root.attribute("version").toInt() != LV2_CACHE_VERSION
+		|| root.attribute("lmmsversion") != LMMS_VERSION
+		|| root.attribute("ignoreblacklist").toInt() != Engine::ignorePluginBlacklist())
+	{
+		return cache;
+	}
+
+	for (QDomElement plugin = root.firstChildElement("plugin"); !plugin.isNull();
+		plugin = plugin.nextSiblingElement("plugin"))
+	{
+		CacheEntry entry;
+		entry.bundle = plugin.attribute("bundle");
+		entry.modified = plugin.attribute("modified").toLongLong();
+		entry.type = static_cast<Plugin::PluginTypes>(plugin.attribute("type").toInt());
+		entry.name = plugin.attribute("name");
+		for (QDomElement issue = plugin.firstChildElement("issue"); !issue.isNull();
+			issue = issue.nextSiblingElement("issue"))
+		{
+			entry.issues.emplace_back(
+				static_cast<PluginIssueType>(issue.attribute("type").toInt()),
+				issue.attribute("info").toStdString());
+		}
+		cache.insert(plugin.attribute("uri"), entry);
+	}
+	return cache;
+}
+
+
+
+
+void Lv2Manager::writeCache() const
+{
+	QDomDocument doc("lmms-lv2cache");
+	QDomElement root = doc.createElement("lv2cache");
+	root.setAttribute("version", LV2_CACHE_VERSION);
+	root.setAttribute("lmmsversion", LMMS_VERSION);
+	root.setAttribute("ignoreblacklist", Engine::ignorePluginBlacklist() ? 1 : 0);
+	doc.appendChild(root);
+
+	for (auto it = m_cache.begin(); it != m_cache.end(); ++it)
+	{
+		QDomElement plugin = doc.createElement("plugin");
+		plugin.setAttribute("uri", it.key());
+		plugin.setAttribute("bundle", it->bundle);
+		plugin.setAttribute("modified", it->modified);
+		plugin.setAttribute("type", it->type);
+		plugin.setAttribute("name", it->name);
+		for (const PluginIssue& iss : it->issues)
+		{
+			QDomElement issue = doc.createElement("issue");
+			issue.setAttribute("type", iss.type());
+			issue.setAttribute("info", QString::fromStdString(iss.info()));
+			plugin.appendChild(issue);
+		}
+		root.appendChild(plugin);
+	}
+
+	QFile file(ConfigManager::inst()->lv2CacheFile());
+	if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		file.write(doc.toByteArray());
+	}
+}
+
+
+
+
 // unused + untested yet
 bool Lv2Manager::isSubclassOf(const LilvPluginClass* clvss, const char* uriStr)
 {
@@ -27,6 +27,7 @@
 
 #ifdef LMMS_HAVE_LV2
 
+#include <algorithm>
 #include <lv2/lv2plug.in/ns/ext/atom/atom.h>
 #include <lv2/lv2plug.in/ns/ext/port-props/port-props.h>
 
@@ -345,6 +346,33 @@ void Audio::copyBuffersToCore(sampleFrame *lmmsBuf,
 
 
 
+void Audio::copyBuffersFromCore(const sample_t *lmmsBuf, fpp_t frames)
+{
+	std::copy_n(lmmsBuf, frames, m_buffer.begin());
+}
+
+
+
+
+void Audio::averageWithBuffersFromCore(const sample_t *lmmsBuf, fpp_t frames)
+{
+	for (std::size_t f = 0; f < static_cast<unsigned>(frames); ++f)
+	{
+		m_buffer[f] = (m_buffer[f] + lmmsBuf[f]) / 2.0f;
+	}
+}
+
+
+
+
+void Audio::copyBuffersToCore(sample_t *lmmsBuf, fpp_t frames) const
+{
+	std::copy_n(m_buffer.begin(), frames, lmmsBuf);
+}
+
+
+
+
 void AtomSeq::Lv2EvbufDeleter::operator()(LV2_Evbuf *n) { lv2_evbuf_free(n); }
 
 
@@ -326,9 +326,96 @@ void Lv2Proc::copyBuffersToCore(sampleFrame* buf,
 
 
 
+void Lv2Proc::copyBuffersFromCore(const PlanarBuffer &buf,
+									unsigned firstChan, unsigned num,
+									fpp_t frames)
+{
+	inPorts().m_left->copyBuffersFromCore(buf.channel(firstChan), frames);
+	if (num > 1)
+	{
+		// see the interleaved version
+		if (inPorts().m_right)
+		{
+			inPorts().m_right->copyBuffersFromCore(
+				buf.channel(firstChan + 1), frames);
+		}
+		else
+		{
+			inPorts().m_left->averageWithBuffersFromCore(
+				buf.channel(firstChan + 1), frames);
+		}
+	}
+}
+
+
+
+
+void Lv2Proc::copyBuffersToCore(const PlanarBuffer &buf,
+								unsigned firstChan, unsigned num,
+								fpp_t frames) const
+{
+	outPorts().m_left->copyBuffersToCore(buf.channel(firstChan + 0), frames);
+	if (num > 1)
+	{
+		Lv2Ports::Audio* ap = outPorts().m_right
+			? outPorts().m_right : outPorts().m_left;
+		ap->copyBuffersToCore(buf.channel(firstChan + 1), frames);
+	}
+}
+
+
+
+
+bool Lv2Proc::connectBuffersOfCore(const PlanarBuffer &in, const PlanarBuffer &out,
+									unsigned firstChan, unsigned num)
+{
+	const bool stereo = inPorts().m_right && outPorts().m_right;
+	const bool mono = !inPorts().m_right && !outPorts().m_right;
+	if (!inPorts().m_left || !outPorts().m_left ||
+		!(num == 1 ? mono : num == 2 && stereo) ||
+		(in.samples() == out.samples() && m_inPlaceBroken))
+	{
+		disconnectBuffersOfCore();
+		return false;
+	}
+
+	auto connect = [this](const Lv2Ports::Audio* port, sample_t* location)
+	{
+		lilv_instance_connect_port(m_instance,
+			lilv_port_get_index(m_plugin, port->m_port), location);
+	};
+	connect(inPorts().m_left, in.channel(firstChan));
+	connect(outPorts().m_left, out.channel(firstChan));
+	if (stereo)
+	{
+		connect(inPorts().m_right, in.channel(firstChan + 1));
+		connect(outPorts().m_right, out.channel(firstChan + 1));
+	}
+	m_buffersOfCore = true;
+	return true;
+}
+
+
+
+
+void Lv2Proc::disconnectBuffersOfCore()
+{
+	if (!m_buffersOfCore) { return; }
+	for (std::size_t num = 0; num < m_ports.size(); ++num)
+	{
+		Lv2Ports::Audio* audio = Lv2Ports::dcast<Lv2Ports::Audio>(m_ports[num].get());
+		if (audio) { connectPort(num); }
+	}
+	m_buffersOfCore = false;
+}
+
+
+
+
 void Lv2Proc::run(fpp_t frames)
 {
 	lilv_instance_run(m_instance, static_cast<uint32_t>(frames));
+	if (m_worker) { m_worker->emitResponses(); }
 }
 
 
@@ -398,6 +485,12 @@ void Lv2Proc::initPlugin()
 	{
 		for (std::size_t portNum = 0; portNum < m_ports.size(); ++portNum)
 			connectPort(portNum);
+		m_worker->setInstance(static_cast<const LV2_Worker_Interface*>(
+			lilv_instance_get_extension_data(m_instance, LV2_WORKER__interface)),
+			lilv_instance_get_handle(m_instance));
+		m_buffersOfCore = false;
+		AutoLilvNode inPlaceBroken(Engine::getLv2Manager()->uri(LV2_CORE__inPlaceBroken));
+		m_inPlaceBroken = lilv_plugin_has_feature(m_plugin, inPlaceBroken.get());
 		lilv_instance_activate(m_instance);
 	}
 	else
@@ -416,6 +509,8 @@ void Lv2Proc::initPlugin()
 
 void Lv2Proc::shutdownPlugin()
 {
+	// no work may be done for a deactivated instance
+	m_worker.reset();
 	if (m_valid)
 	{
 		lilv_instance_deactivate(m_instance);
@@ -471,6 +566,8 @@ void Lv2Proc::initPluginSpecificFeatures()
 {
 	initMOptions();
 	m_features[LV2_OPTIONS__options] = const_cast<LV2_Options_Option*>(m_options.feature());
+	m_worker.reset(new Lv2Worker);
+	m_features[LV2_WORKER__schedule] = m_worker->feature();
 }
 
 
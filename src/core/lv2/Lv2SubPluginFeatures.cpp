@@ -171,9 +171,7 @@ void Lv2SubPluginFeatures::listSubPluginKeys(const Plugin::Descriptor *desc,
 				Plugin::Descriptor::SubPluginFeatures::Key;
 			KeyType::AttributeMap atm;
 			atm["uri"] = QString::fromUtf8(uriInfoPair.first.c_str());
-			const LilvPlugin* plug = uriInfoPair.second.plugin();
-
-			kl.push_back(KeyType(desc, pluginName(plug), atm));
+			kl.push_back(KeyType(desc, uriInfoPair.second.name(), atm));
 			//qDebug() << "Found LV2 sub plugin key of type" <<
 			//	m_type << ":" << pr.first.c_str();
 		}
@@ -39,60 +39,65 @@ static const char* staticUnmap(LV2_URID_Unmap_Handle handle, LV2_URID urid)
 	return map->unmap(urid);
 }
 
-UridMap::UridMap()
+UridMap::UridMap() :
+	m_table(new std::atomic<const Entry*>[TableSize]),
+	m_unMap(new std::atomic<const char*>[MaxUrids])
 {
+	for (std::size_t i = 0; i < TableSize; ++i) { m_table[i] = nullptr; }
+	for (std::size_t i = 0; i < MaxUrids; ++i) { m_unMap[i] = nullptr; }
+
 	m_mapFeature.handle = static_cast<LV2_URID_Map_Handle>(this);
 	m_mapFeature.map = staticMap;
 	m_unmapFeature.handle = static_cast<LV2_URID_Unmap_Handle>(this);
 	m_unmapFeature.unmap = staticUnmap;
 }
 
+const UridMap::Entry* UridMap::find(const char* uri, std::size_t& slot) const
+{
+	// FNV-1a
+	std::size_t hash = 2166136261u;
+	for (const char* c = uri; *c; ++c)
+	{
+		hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+	}
+
+	for (slot = hash % TableSize; ; slot = (slot + 1) % TableSize)
+	{
+		const Entry* entry = m_table[slot].load(std::memory_order_acquire);
+		if (!entry || entry->m_uri == uri) { return entry; }
+	}
+}
+
 LV2_URID UridMap::map(const char *uri)
 {
-	LV2_URID result = 0u;
+	std::size_t slot;
+	if (const Entry* entry = find(uri, slot)) { return entry->m_urid; }
 
 	// the Lv2 docs say that 0 should be returned in any case
 	// where creating an ID for the given URI fails
 	try
 	{
-		// TODO:
-		// when using C++14, we can get around any string allocation
-		// in the case the URI is already inside the map:
-		// * use `m_map.find(uri)` instead of `m_map.find(uriStr)`
-		// * to avoid temporary string construction in the `find` call, create
-		//   m_map like this:
-		//   std::unordered_map<std::string, LV2_URID,
-		//     std::hash<std::string>, std::equal<>> m_map;
-		// * move the try block inside the case where the URI is not in the map
-		const std::string uriStr = uri;
-
 		std::lock_guard<std::mutex> guard (m_MapMutex);
 
-		auto itr = m_map.find(uriStr);
-		if (itr == m_map.end())
-		{
-			// 1 is the first free URID
-			std::size_t index = 1u + m_unMap.size();
-			auto pr = m_map.emplace(std::move(uriStr), index);
-			if (pr.second)
-			{
-				m_unMap.emplace_back(pr.first->first.c_str());
-				result = static_cast<LV2_URID>(index);
-			}
-		}
-		else { result = itr->second; }
-	}
-	catch(...) { /* result variable is already 0 */ }
+		// another thread may have added it meanwhile
+		if (const Entry* entry = find(uri, slot)) { return entry->m_urid; }
+		if (m_entries.size() >= MaxUrids) { return 0u; }
 
-	return result;
+		// 1 is the first free URID
+		const LV2_URID urid = static_cast<LV2_URID>(m_entries.size() + 1);
+		m_entries.push_back(Entry{uri, urid});
+		const Entry* entry = &m_entries.back();
+		m_unMap[urid - 1].store(entry->m_uri.c_str(), std::memory_order_release);
+		m_table[slot].store(entry, std::memory_order_release);
+		return urid;
+	}
+	catch(...) { return 0u; }
 }
 
 const char *UridMap::unmap(LV2_URID urid)
 {
 	std::size_t idx = static_cast<std::size_t>(urid) - 1;
-
-	std::lock_guard<std::mutex> guard (m_MapMutex);
-	return (idx < m_unMap.size()) ? m_unMap[idx] : nullptr;
+	return (idx < MaxUrids) ? m_unMap[idx].load(std::memory_order_acquire) : nullptr;
 }
 
 #endif // LMMS_HAVE_LV2
@@ -0,0 +1,299 @@
+/*
+ * Lv2Worker.cpp - Lv2Worker implementation
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Lv2Worker.h"
+
+#ifdef LMMS_HAVE_LV2
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThread>
+#include <QtGlobal>
+
+#include "denormals.h"
+#include "Engine.h"
+#include "Song.h"
+
+
+namespace
+{
+
+// plugins send pointers or file names, not the data itself
+constexpr std::size_t RingBufferSize = 1 << 13;
+// the work is mostly loading files, so more threads wouldn't help
+constexpr int PoolThreads = 2;
+
+}
+
+
+
+
+//! Threads doing the work of all Lv2Workers
+class Lv2WorkerPool
+{
+public:
+	Lv2WorkerPool()
+	{
+		for (int i = 0; i < PoolThreads; ++i)
+		{
+			m_threads.emplace_back(new Thread(this));
+			m_threads.back()->start();
+		}
+	}
+
+	~Lv2WorkerPool()
+	{
+		m_exit = true;
+		m_sem.release(PoolThreads);
+		for (std::unique_ptr<Thread>& thread : m_threads) { thread->wait(); }
+	}
+
+	//! The pool of all workers, created for the first one
+	static std::shared_ptr<Lv2WorkerPool> acquire()
+	{
+		static QMutex mutex;
+		static std::weak_ptr<Lv2WorkerPool> pool;
+		QMutexLocker guard(&mutex);
+		std::shared_ptr<Lv2WorkerPool> result = pool.lock();
+		if (!result)
+		{
+			result = std::make_shared<Lv2WorkerPool>();
+			pool = result;
+		}
+		return result;
+	}
+
+	void add(Lv2Worker* worker)
+	{
+		QMutexLocker guard(&m_workersMutex);
+		m_workers.push_back(worker);
+	}
+
+	//! After this, no thread starts working for @p worker
+	void remove(Lv2Worker* worker)
+	{
+		QMutexLocker guard(&m_workersMutex);
+		m_workers.erase(std::remove(m_workers.begin(), m_workers.end(), worker),
+			m_workers.end());
+	}
+
+	//! Wake a thread, realtime safe enough for the run thread
+	void notify() { m_sem.release(); }
+
+private:
+	// no std::thread on MinGW, see Oscillator::generateWaveTables()
+	class Thread : public QThread
+	{
+	public:
+		Thread(Lv2WorkerPool* pool) : m_pool(pool) {}
+
+	protected:
+		void run() override { m_pool->workerFunc(); }
+
+	private:
+		Lv2WorkerPool* m_pool;
+	};
+
+	void workerFunc()
+	{
+		// plugins may render samples or impulse responses here
+		disable_denormals();
+		while (true)
+		{
+			m_sem.acquire();
+			if (m_exit) { break; }
+
+			// there may be less requests than wake-ups, e.g. if another
+			// thread took two requests of a worker at once
+			QMutexLocker lock(&m_workersMutex);
+			for (Lv2Worker* worker : m_workers)
+			{
+				if (worker->hasRequests() && worker->m_workMutex.tryLock())
+				{
+					lock.unlock();
+					// the worker can't go before m_workMutex is unlocked
+					worker->work();
+					worker->m_workMutex.unlock();
+					// a request may have come after the work was done, while
+					// its wake-up found the worker busy and went elsewhere
+					notify();
+					break;
+				}
+			}
+		}
+	}
+
+	std::vector<std::unique_ptr<Thread>> m_threads;
+	QSemaphore m_sem;
+	std::atomic<bool> m_exit{false};
+
+	QMutex m_workersMutex;
+	std::vector<Lv2Worker*> m_workers;
+};
+
+
+
+
+Lv2Worker::Lv2Worker() :
+	m_requests(RingBufferSize),
+	m_responses(RingBufferSize),
+	m_requestsReader(m_requests),
+	m_responsesReader(m_responses),
+	m_scheduled(RingBufferSize),
+	m_request(RingBufferSize),
+	m_responded(RingBufferSize),
+	m_response(RingBufferSize)
+{
+	m_scheduleFeature.handle = this;
+	m_scheduleFeature.schedule_work = &Lv2Worker::scheduleWork;
+}
+
+
+
+
+Lv2Worker::~Lv2Worker()
+{
+	if (m_pool)
+	{
+		m_pool->remove(this);
+		// wait until the current work is done
+		QMutexLocker guard(&m_workMutex);
+	}
+}
+
+
+
+
+void Lv2Worker::setInstance(const LV2_Worker_Interface* iface, LV2_Handle handle)
+{
+	Q_ASSERT(!m_pool);
+	m_iface = iface;
+	m_handle = handle;
+	if (m_iface && m_iface->work)
+	{
+		m_pool = Lv2WorkerPool::acquire();
+		m_pool->add(this);
+	}
+}
+
+
+
+
+LV2_Worker_Status Lv2Worker::scheduleWork(LV2_Worker_Schedule_Handle handle,
+	uint32_t size, const void* data)
+{
+	Lv2Worker* worker = static_cast<Lv2Worker*>(handle);
+	if (!worker->m_pool) { return LV2_WORKER_ERR_UNKNOWN; }
+
+	// rendering doesn't need to be realtime, but the work must be done in
+	// time for the next run
+	if (Engine::getSong()->isExporting())
+	{
+		QMutexLocker guard(&worker->m_workMutex);
+		return worker->m_iface->work(worker->m_handle, &Lv2Worker::respond,
+			worker, size, data);
+	}
+
+	if (!write(worker->m_requests, worker->m_scheduled, size, data))
+	{
+		return LV2_WORKER_ERR_NO_SPACE;
+	}
+	worker->m_pool->notify();
+	return LV2_WORKER_SUCCESS;
+}
+
+
+
+
+LV2_Worker_Status Lv2Worker::respond(LV2_Worker_Respond_Handle handle,
+	uint32_t size, const void* data)
+{
+	Lv2Worker* worker = static_cast<Lv2Worker*>(handle);
+	return write(worker->m_responses, worker->m_responded, size, data)
+		? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
+}
+
+
+
+
+bool Lv2Worker::write(ringbuffer_t<char>& ring, std::vector<char>& buffer,
+	uint32_t size, const void* data)
+{
+	if (ring.free() < sizeof(size) + size) { return false; }
+	// written at once, so that the reader never finds a size without data
+	std::memcpy(buffer.data(), &size, sizeof(size));
+	std::memcpy(buffer.data() + sizeof(size), data, size);
+	ring.write(buffer.data(), sizeof(size) + size);
+	return true;
+}
+
+
+
+
+bool Lv2Worker::hasRequests()
+{
+	return m_requestsReader.read_space() > 0;
+}
+
+
+
+
+void Lv2Worker::work()
+{
+	uint32_t size;
+	while (m_requestsReader.read_space() >= sizeof(size))
+	{
+		m_requestsReader.read(sizeof(size)).copy(reinterpret_cast<char*>(&size),
+			sizeof(size));
+		if (size) { m_requestsReader.read(size).copy(m_request.data(), size); }
+		m_iface->work(m_handle, &Lv2Worker::respond, this, size, m_request.data());
+	}
+}
+
+
+
+
+void Lv2Worker::emitResponses()
+{
+	if (!m_pool) { return; }
+
+	uint32_t size;
+	while (m_responsesReader.read_space() >= sizeof(size))
+	{
+		m_responsesReader.read(sizeof(size)).copy(reinterpret_cast<char*>(&size),
+			sizeof(size));
+		if (size) { m_responsesReader.read(size).copy(m_response.data(), size); }
+		if (m_iface->work_response)
+		{
+			m_iface->work_response(m_handle, size, m_response.data());
+		}
+	}
+	if (m_iface->end_run) { m_iface->end_run(m_handle); }
+}
+
+
+#endif // LMMS_HAVE_LV2
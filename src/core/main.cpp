@@ -30,7 +30,9 @@
 #include "denormals.h"
 
 #include <QDebug>
+#include <QDir>
 #include <QFileInfo>
+#include <QJsonDocument>
 #include <QLocale>
 #include <QTimer>
 #include <QTranslator>
@@ -38,6 +40,9 @@
 #include <QMessageBox>
 #include <QPushButton>
 #include <QTextStream>
+#include <QVector>
+#include <map>
+#include <vector>
 
 #ifdef LMMS_BUILD_WIN32
 #include <windows.h>
@@ -63,13 +68,17 @@
 #include "NotePlayHandle.h"
 #include "embed.h"
 #include "Engine.h"
+#include "EngineStatsWriter.h"
 #include "GuiApplication.h"
 #include "ImportFilter.h"
 #include "MainWindow.h"
 #include "MixHelpers.h"
 #include "OutputSettings.h"
+#include "ProjectGenerator.h"
 #include "ProjectRenderer.h"
+#include "RenderBenchmark.h"
 #include "RenderManager.h"
+#include "RenderServer.h"
 #include "Song.h"
 #include "SetupDialog.h"
 
@@ -162,11 +171,21 @@ void printHelp()
 		"Usage: lmms [global options...] [<action> [action parameters...]]\n\n"
 		"Actions:\n"
 		"  <no action> [options...] [<project>]  Start LMMS in normal GUI mode\n"
-		"  dump <in>                             Dump XML of compressed file <in>\n"
+		"  dump <in>                             Dump XML of compressed or binary\n"
+		"                                        file <in>\n"
 		"  compress <in>                         Compress file <in>\n"
 		"  render <project> [options...]         Render given project file\n"
 		"  rendertracks <project> [options...]   Render each track to a different file\n"
-		"  upgrade <in> [out]                    Upgrade file <in> and save as <out>\n"
+		"  bench <project> [options...]          Render given project without writing\n"
+		"                                        it and print the timings and memory\n"
+		"                                        use as JSON\n"
+		"  generate <out> [options...]           Save a synthetic project of the size\n"
+		"                                        given by the options for \"generate\"\n"
+		"                                        as <out>, e.g. to \"bench\" it\n"
+		"  serve <dir> [options...]              Keep running and render every project\n"
+		"                                        put into <dir>, see \"serve\" below\n"
+		"  upgrade <in> [out]                    Upgrade file <in> and save as <out>,\n"
+		"                                        which is binary if it ends in .mmpb\n"
 		"                                        Standard out is used if no output file\n"
 		"                                        is specified\n"
 		"  makebundle <in> [out]                 Make a project bundle from the project\n"
@@ -178,16 +197,31 @@ void printHelp()
 		"  -c, --config <configfile>      Get the configuration from <configfile>\n"
 		"  -h, --help                     Show this usage information and exit.\n"
 		"  -v, --version                  Show version information and exit.\n"
+		"      --stats <out>              Keep the counters of the engine, e.g.\n"
+		"          periods rendered, deadline misses, play handles and remote\n"
+		"          plugin round trips, in file <out> as JSON, rewritten at every\n"
+		"          interval\n"
+		"      --stats-interval <ms>      Rewrite the stats every <ms>\n"
+		"          milliseconds, Default: 1000\n"
 		"\nOptions if no action is given:\n"
 		"      --geometry <geometry>      Specify the size and position of\n"
 		"          the main window\n"
 		"          geometry is <xsizexysize+xoffset+yoffsety>.\n"
+		"      --glitchlog <out>          Write the periods which were late and\n"
+		"          the xruns of the audio device to file <out> as JSON on exit\n"
 		"      --import <in> [-e]         Import MIDI or Hydrogen file <in>.\n"
 		"          If -e is specified lmms exits after importing the file.\n"
-		"\nOptions for \"render\" and \"rendertracks\":\n"
+		"\nOptions for \"render\", \"rendertracks\", \"serve\" and \"bench\":\n"
 		"  -a, --float                    Use 32bit float bit depth\n"
 		"  -b, --bitrate <bitrate>        Specify output bitrate in KBit/s\n"
 		"          Default: 160.\n"
+		"      --cache <dir>              For \"render\", keep the rendered bars in\n"
+		"          <dir>, and only render the ones that changed since the last\n"
+		"          render with the same <dir>\n"
+		"      --denormalwatch            Warn about tracks and mixer channels\n"
+		"          whose effects slow down while their sound decays, which\n"
+		"          hints at denormal numbers\n"
+		"      --dither                   Dither 16 and 24 bit integer samples\n"
 		"  -f, --format <format>         Specify format of render-output where\n"
 		"          Format is either 'wav', 'flac', 'ogg' or 'mp3'.\n"
 		"  -i, --interpolation <method>   Specify interpolation method\n"
@@ -196,6 +230,8 @@ void printHelp()
 		"            - sincfastest (default)\n"
 		"            - sincmedium\n"
 		"            - sincbest\n"
+		"  -j, --jobs <count>             For \"rendertracks\", render up to <count>\n"
+		"          tracks at once in separate processes\n"
 		"  -l, --loop                     Render as a loop\n"
 		"  -m, --mode                     Stereo mode used for MP3 export\n"
 		"          Possible values: s, j, m\n"
@@ -208,12 +244,67 @@ void printHelp()
 		"          For \"rendertracks\", provide a directory path\n"
 		"          If not specified, render will overwrite the input file\n"
 		"          For \"rendertracks\", this might be required\n"
+		"          For \"render\", can be given several times to encode a\n"
+		"          single render into several files; -a, -b, -f and -m\n"
+		"          after an --output only apply to that file\n"
+		"      --part <number>            For \"render\" with --parts and --cache, only\n"
+		"          render part <number> (counting from 1) into the cache, e.g. on\n"
+		"          another machine sharing the cache directory, and no file\n"
+		"      --parts <count>            For \"render\", split the song into <count>\n"
+		"          parts, rendered at once by separate processes and spliced\n"
+		"          through the --cache directory, or a temporary one. Parts\n"
+		"          already rendered with --part aren't rendered again. Only\n"
+		"          for songs the export cache works for\n"
+		"      --preroll <bars>           With --cache, start rendering every part\n"
+		"          or bar at least <bars> bars early, so that effects whose tail\n"
+		"          isn't known settle, Default: 0\n"
 		"  -p, --profile <out>            Dump profiling information to file <out>\n"
+		"          and, without --stats, the engine's counters to\n"
+		"          <out>.stats.json\n"
+		"      --runs <count>             For \"bench\", render the project <count>\n"
+		"          times, Default: 3\n"
+		"      --period <frames>          Render in periods of <frames> frames.\n"
+		"          Larger periods render faster, timing stays the same.\n"
+		"          Range: 32 to 4096, Default: 256\n"
+		"      --threads <count>          Process jobs on <count> threads, including\n"
+		"          the main audio thread. Default: one per core\n"
+		"      --trace <out>              Dump timing of every processed job to\n"
+		"          file <out> in Chrome trace format\n"
 		"  -s, --samplerate <samplerate>  Specify output samplerate in Hz\n"
 		"          Range: 44100 (default) to 192000\n"
+		"      --stems <numbers>          For \"rendertracks\", only render the\n"
+		"          tracks with the given comma separated numbers\n"
+		"          (as in the output file names)\n"
+		"      --verify-seams             With --parts, render across the seams\n"
+		"          between the parts again and warn if they differ from the\n"
+		"          spliced render by more than -60 dBFS\n"
 		"  -x, --oversampling <value>     Specify oversampling\n"
 		"          Possible values: 1, 2, 4, 8\n"
-		"          Default: 2\n\n",
+		"          Default: 2\n"
+		"\nOptions for \"generate\":\n"
+		"      --tracks <count>           Instrument tracks, Default: 8\n"
+		"      --bars <count>             Length of the song, Default: 16\n"
+		"      --notes <count>            Notes per bar on every track, each one\n"
+		"          lasting until the next, Default: 8\n"
+		"      --polyphony <count>        Notes played at once on every track,\n"
+		"          Default: 1\n"
+		"      --effects <count>          Effects on every track and mixer channel,\n"
+		"          Default: 0\n"
+		"      --effect <plugin>          The effect to use, Default: amplifier\n"
+		"      --instrument <plugin>      The instrument to use,\n"
+		"          Default: tripleoscillator\n"
+		"      --mixer-depth <levels>     Levels of mixer channels between the\n"
+		"          tracks and the master, Default: 0\n"
+		"      --mixer-fanin <count>      Tracks or channels sending to one\n"
+		"          channel of the next level, Default: 2\n"
+		"      --automation <nodes>       Automation nodes per bar on the panning\n"
+		"          of every track, Default: 0\n"
+		"\nUsing \"serve\":\n"
+		"  Projects (.mmp, .mmpz or .mmpb) copied into <dir> are rendered one after\n"
+		"  another, oldest first, reusing the initialized engine and plugins.\n"
+		"  The rendered file and the project are moved to <dir>/done, projects\n"
+		"  that can't be loaded to <dir>/failed. Creating a file named \"quit\"\n"
+		"  in <dir> stops the server.\n\n",
 		LMMS_VERSION, LMMS_PROJECT_COPYRIGHT );
 }
 
@@ -306,8 +397,33 @@ int main( int argc, char * * argv )
 	bool exitAfterImport = false;
 	bool allowRoot = false;
 	bool renderLoop = false;
+	bool denormalWatch = false;
 	bool renderTracks = false;
-	QString fileToLoad, fileToImport, renderOut, profilerOutputFile, configFile;
+	bool bench = false;
+	int benchRuns = 3;
+	int renderJobs = 1;
+	int renderParts = 0;
+	int renderPart = 0;
+	int renderPreRoll = 0;
+	bool verifySeams = false;
+	int renderPeriod = 0;
+	int renderThreads = 0;
+	int statsInterval = 1000;
+	ProjectGenerator::Settings generatorSettings;
+	// the options of "generate" taking a number
+	const std::map<QString, int ProjectGenerator::Settings::*> generatorOptions = {
+		{ "--tracks", &ProjectGenerator::Settings::tracks },
+		{ "--bars", &ProjectGenerator::Settings::bars },
+		{ "--notes", &ProjectGenerator::Settings::notesPerBar },
+		{ "--polyphony", &ProjectGenerator::Settings::polyphony },
+		{ "--effects", &ProjectGenerator::Settings::effects },
+		{ "--mixer-depth", &ProjectGenerator::Settings::mixerDepth },
+		{ "--mixer-fanin", &ProjectGenerator::Settings::mixerFanIn },
+		{ "--automation", &ProjectGenerator::Settings::automationPerBar } };
+	QVector<int> renderStems;
+	// arguments for the processes of a parallel "rendertracks" or "render"
+	QStringList workerArgs;
+	QString fileToLoad, fileToImport, renderOut, serveDir, generateOut, profilerOutputFile, traceOutputFile, glitchLogFile, statsFile, cacheDirectory, configFile;
 
 	// first of two command-line parsing stages
 	for( int i = 1; i < argc; ++i )
@@ -325,6 +441,19 @@ int main( int argc, char * * argv )
 			coreOnly = true;
 			renderTracks = true;
 		}
+		else if( arg == "serve" )
+		{
+			coreOnly = true;
+		}
+		else if( arg == "bench" )
+		{
+			coreOnly = true;
+			bench = true;
+		}
+		else if( arg == "generate" )
+		{
+			coreOnly = true;
+		}
 		else if( arg == "--allowroot" )
 		{
 			allowRoot = true;
@@ -363,9 +492,21 @@ int main( int argc, char * * argv )
 					new MainApplication( argc, argv );
 
 	AudioEngine::qualitySettings qs( AudioEngine::qualitySettings::Mode_HighQuality );
-	OutputSettings os( 44100, OutputSettings::BitRateSettings(160, false), OutputSettings::Depth_16Bit, OutputSettings::StereoMode_JointStereo );
+	const OutputSettings defaultOs( 44100, OutputSettings::BitRateSettings(160, false), OutputSettings::Depth_16Bit, OutputSettings::StereoMode_JointStereo );
+	OutputSettings os = defaultOs;
 	ProjectRenderer::ExportFileFormats eff = ProjectRenderer::WaveFile;
 
+	// the outputs given before the last --output, which has renderOut,
+	// eff and os; the project is rendered once for all of them
+	struct RenderOutput
+	{
+		QString file;
+		ProjectRenderer::ExportFileFormats format;
+		OutputSettings settings;
+	} ;
+	std::vector<RenderOutput> moreOutputs;
+	bool outputGiven = false;
+
 	// second of two command-line parsing stages
 	for( int i = 1; i < argc; ++i )
 	{
@@ -451,8 +592,8 @@ int main( int argc, char * * argv )
 
 			QFile f( QString::fromLocal8Bit( argv[i] ) );
 			f.open( QIODevice::ReadOnly );
-			QString d = qUncompress( f.readAll() );
-			printf( "%s\n", d.toUtf8().constData() );
+			const QByteArray d = DataFile::projectXml( f.readAll() );
+			printf( "%s\n", d.constData() );
 
 			return EXIT_SUCCESS;
 		}
@@ -486,10 +627,112 @@ int main( int argc, char * * argv )
 			fileToLoad = QString::fromLocal8Bit( argv[i] );
 			renderOut = fileToLoad;
 		}
+		else if( arg == "bench" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return noInputFileError();
+			}
+
+
+			fileToLoad = QString::fromLocal8Bit( argv[i] );
+		}
+		else if( arg == "generate" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No output file specified" );
+			}
+
+
+			generateOut = QString::fromLocal8Bit( argv[i] );
+		}
+		else if( generatorOptions.count( arg ) )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( QString( "No value for %1 specified" ).arg( arg ) );
+			}
+
+
+			bool ok = false;
+			const int value = QString( argv[i] ).toInt( &ok );
+			if( !ok || value < 0 )
+			{
+				return usageError( QString( "Invalid value %1 for %2" ).arg( argv[i] ).arg( arg ) );
+			}
+			generatorSettings.*generatorOptions.at( arg ) = value;
+		}
+		else if( arg == "--instrument" || arg == "--effect" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No plugin specified" );
+			}
+
+
+			( arg == "--effect" ? generatorSettings.effect : generatorSettings.instrument ) = argv[i];
+		}
+		else if( arg == "--threads" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No number of threads specified" );
+			}
+
+
+			renderThreads = QString( argv[i] ).toInt();
+			if( renderThreads < 1 )
+			{
+				return usageError( QString( "Invalid number of threads %1" ).arg( argv[i] ) );
+			}
+		}
+		else if( arg == "--runs" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No number of runs specified" );
+			}
+
+
+			benchRuns = QString( argv[i] ).toInt();
+			if( benchRuns < 1 )
+			{
+				return usageError( QString( "Invalid number of runs %1" ).arg( argv[i] ) );
+			}
+		}
+		else if( arg == "serve" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No queue directory specified" );
+			}
+
+
+			serveDir = QString::fromLocal8Bit( argv[i] );
+		}
 		else if( arg == "--loop" || arg == "-l" )
 		{
 			renderLoop = true;
 		}
+		else if( arg == "--denormalwatch" )
+		{
+			denormalWatch = true;
+		}
 		else if( arg == "--output" || arg == "-o" )
 		{
 			++i;
@@ -499,6 +742,17 @@ int main( int argc, char * * argv )
 				return usageError( "No output file specified" );
 			}
 
+			// the format options that follow are for this output
+			if( outputGiven )
+			{
+				moreOutputs.push_back( { renderOut, eff, os } );
+				eff = ProjectRenderer::WaveFile;
+				const sample_rate_t sampleRate = os.getSampleRate();
+				os = defaultOs;
+				os.setSampleRate( sampleRate );
+			}
+			outputGiven = true;
+
 
 			renderOut = QString::fromLocal8Bit( argv[i] );
 		}
@@ -614,6 +868,10 @@ int main( int argc, char * * argv )
 		{
 			os.setBitDepth(OutputSettings::Depth_32Bit);
 		}
+		else if( arg == "--dither" )
+		{
+			os.setDither(true);
+		}
 		else if( arg == "--interpolation" || arg == "-i" )
 		{
 			++i;
@@ -677,6 +935,17 @@ int main( int argc, char * * argv )
 				return usageError( QString( "Invalid oversampling %1" ).arg( argv[i] ) );
 			}
 		}
+		else if( arg == "--glitchlog" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No glitch log file specified" );
+			}
+
+			glitchLogFile = QString::fromLocal8Bit( argv[i] );
+		}
 		else if( arg == "--import" )
 		{
 			++i;
@@ -707,6 +976,160 @@ int main( int argc, char * * argv )
 
 			profilerOutputFile = QString::fromLocal8Bit( argv[i] );
 		}
+		else if( arg == "--trace" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No trace file specified" );
+			}
+
+
+			traceOutputFile = QString::fromLocal8Bit( argv[i] );
+		}
+		else if( arg == "--cache" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No cache directory specified" );
+			}
+
+			cacheDirectory = QString::fromLocal8Bit( argv[i] );
+		}
+		else if( arg == "--stats" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No stats file specified" );
+			}
+
+			statsFile = QString::fromLocal8Bit( argv[i] );
+		}
+		else if( arg == "--stats-interval" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No stats interval specified" );
+			}
+
+			statsInterval = QString( argv[i] ).toInt();
+			if( statsInterval <= 0 )
+			{
+				return usageError( QString( "Invalid stats interval %1" ).arg( argv[i] ) );
+			}
+		}
+		else if( arg == "--period" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No period size specified" );
+			}
+
+
+			renderPeriod = QString( argv[i] ).toInt();
+			if( renderPeriod < MINIMUM_BUFFER_SIZE || renderPeriod > MAXIMUM_RENDER_BUFFER_SIZE )
+			{
+				return usageError( QString( "Invalid period size %1" ).arg( argv[i] ) );
+			}
+		}
+		else if( arg == "--jobs" || arg == "-j" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No number of jobs specified" );
+			}
+
+
+			renderJobs = QString( argv[i] ).toInt();
+			if( renderJobs < 1 )
+			{
+				return usageError( QString( "Invalid number of jobs %1" ).arg( argv[i] ) );
+			}
+		}
+		else if( arg == "--parts" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No number of parts specified" );
+			}
+
+
+			renderParts = QString( argv[i] ).toInt();
+			if( renderParts < 1 )
+			{
+				return usageError( QString( "Invalid number of parts %1" ).arg( argv[i] ) );
+			}
+		}
+		else if( arg == "--part" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No part specified" );
+			}
+
+
+			renderPart = QString( argv[i] ).toInt();
+			if( renderPart < 1 )
+			{
+				return usageError( QString( "Invalid part %1" ).arg( argv[i] ) );
+			}
+		}
+		else if( arg == "--preroll" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No pre-roll specified" );
+			}
+
+
+			bool ok = false;
+			renderPreRoll = QString( argv[i] ).toInt( &ok );
+			if( !ok || renderPreRoll < 0 )
+			{
+				return usageError( QString( "Invalid pre-roll %1" ).arg( argv[i] ) );
+			}
+		}
+		else if( arg == "--verify-seams" )
+		{
+			verifySeams = true;
+		}
+		else if( arg == "--stems" )
+		{
+			++i;
+
+			if( i == argc )
+			{
+				return usageError( "No track numbers specified" );
+			}
+
+
+			for( const QString & stem : QString( argv[i] ).split( ',', QString::SkipEmptyParts ) )
+			{
+				bool ok = false;
+				renderStems.push_back( stem.toInt( &ok ) );
+				if( !ok )
+				{
+					return usageError( QString( "Invalid track number %1" ).arg( stem ) );
+				}
+			}
+		}
 		else if( arg == "--config" || arg == "-c" )
 		{
 			++i;
@@ -728,6 +1151,20 @@ int main( int argc, char * * argv )
 		}
 	}
 
+	if( !moreOutputs.empty() && ( renderTracks || !serveDir.isEmpty() ) )
+	{
+		return usageError( "Several outputs are only supported for \"render\"" );
+	}
+
+	if( renderParts > 0 && ( renderTracks || !serveDir.isEmpty() || bench ) )
+	{
+		return usageError( "Parts are only supported for \"render\"" );
+	}
+	if( renderPart > 0 && ( renderPart > renderParts || cacheDirectory.isEmpty() ) )
+	{
+		return usageError( "--part needs --parts with at least as many parts, and --cache" );
+	}
+
 	// Test file argument before continuing
 	if( !fileToLoad.isEmpty() )
 	{
@@ -801,11 +1238,58 @@ int main( int argc, char * * argv )
 
 	bool destroyEngine = false;
 
+	if( !generateOut.isEmpty() )
+	{
+		Engine::init( true, renderPeriod );
+		ProjectGenerator generator( generatorSettings );
+		bool generated = generator.generate( Engine::getSong() );
+		if( !generated )
+		{
+			fprintf( stderr, "%s\n", generator.error().toUtf8().constData() );
+		}
+		else if( !( generated = Engine::getSong()->saveProjectFile( generateOut ) ) )
+		{
+			fprintf( stderr, "Could not save %s\n", generateOut.toUtf8().constData() );
+		}
+		delete app;
+		Engine::destroy();
+		return generated ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if( bench )
+	{
+		Engine::init( true, renderPeriod, renderThreads );
+		destroyEngine = true;
+		Engine::audioEngine()->profiler().setDenormalWatchEnabled( denormalWatch );
+
+		fprintf( stderr, "Loading project...\n" );
+		Engine::getSong()->loadProject( fileToLoad );
+		if( Engine::getSong()->isEmpty() )
+		{
+			fprintf( stderr, "The project %s is empty, aborting!\n", fileToLoad.toUtf8().constData() );
+			exit( EXIT_FAILURE );
+		}
+
+		Engine::getSong()->setExportLoop( renderLoop );
+
+		// the report goes to standard out, everything else to standard error
+		RenderBenchmark * benchmark = new RenderBenchmark( qs, benchRuns );
+		QObject::connect( benchmark, &QThread::finished, QCoreApplication::instance(), [benchmark]()
+		{
+			QJsonObject report = benchmark->report();
+			report["project"] = Engine::getSong()->projectFileName();
+			fputs( QJsonDocument( report ).toJson().constData(), stdout );
+			fflush( stdout );
+			delete benchmark;
+			QCoreApplication::quit();
+		} );
+		benchmark->startProcessing();
+	}
 	// if we have an output file for rendering, just render the song
 	// without starting the GUI
-	if( !renderOut.isEmpty() )
+	else if( !renderOut.isEmpty() )
 	{
-		Engine::init( true );
+		Engine::init( true, renderPeriod, renderThreads );
 		destroyEngine = true;
 
 		printf( "Loading project...\n" );
@@ -819,6 +1303,14 @@ int main( int argc, char * * argv )
 
 		Engine::getSong()->setExportLoop( renderLoop );
 
+		if( renderPart > 0 )
+		{
+			// a part only goes into the cache, its file is thrown away
+			QDir().mkpath( cacheDirectory );
+			renderOut = QDir( cacheDirectory ).filePath( QString( "part-%1" ).arg( renderPart ) );
+			moreOutputs.clear();
+		}
+
 		// when rendering multiple tracks, renderOut is a directory
 		// otherwise, it is a file, so we need to append the file extension
 		if ( !renderTracks )
@@ -829,6 +1321,18 @@ int main( int argc, char * * argv )
 
 		// create renderer
 		RenderManager * r = new RenderManager( qs, os, eff, renderOut );
+		r->setCacheDirectory( cacheDirectory );
+		r->setMinimumPreRoll( renderPreRoll * Engine::getSong()->ticksPerBar() );
+		r->setVerifySeams( verifySeams );
+		if( renderPart > 0 )
+		{
+			r->setPart( renderPart - 1, renderParts );
+		}
+		for( const RenderOutput & output : moreOutputs )
+		{
+			r->addOutput( output.format, output.settings, baseName( output.file ) +
+				ProjectRenderer::getFileExtensionFromFormat( output.format ) );
+		}
 		QCoreApplication::instance()->connect( r,
 				SIGNAL( finished() ), SLOT( quit() ) );
 
@@ -841,11 +1345,62 @@ int main( int argc, char * * argv )
 		if( profilerOutputFile.isEmpty() == false )
 		{
 			Engine::audioEngine()->profiler().setOutputFile( profilerOutputFile );
+			if( statsFile.isEmpty() )
+			{
+				statsFile = profilerOutputFile + ".stats.json";
+			}
+		}
+
+		if( traceOutputFile.isEmpty() == false )
+		{
+			Engine::audioEngine()->profiler().setJobTracingEnabled( true );
 		}
+		Engine::audioEngine()->profiler().setDenormalWatchEnabled( denormalWatch );
 
 		// start now!
-		if ( renderTracks )
+		if ( renderTracks && renderJobs > 1 )
+		{
+			// the workers get the same arguments, except for the ones
+			// that can't be shared between processes
+			for( int i = 1; i < argc; ++i )
+			{
+				const QString arg = argv[i];
+				if( arg == "--jobs" || arg == "-j" || arg == "--stems" ||
+					arg == "--profile" || arg == "-p" || arg == "--trace" ||
+					arg == "--stats" )
+				{
+					++i;
+					continue;
+				}
+				workerArgs << QString::fromLocal8Bit( argv[i] );
+			}
+			r->renderTracksInParallel( renderJobs, workerArgs );
+		}
+		else if ( renderParts > 1 && renderPart == 0 )
+		{
+			// the workers render into the cache, and get it and the
+			// number of parts from the renderer
+			for( int i = 1; i < argc; ++i )
+			{
+				const QString arg = argv[i];
+				if( arg == "--parts" || arg == "--cache" || arg == "--output" || arg == "-o" ||
+					arg == "--profile" || arg == "-p" || arg == "--trace" ||
+					arg == "--stats" )
+				{
+					++i;
+					continue;
+				}
+				if( arg == "--verify-seams" )
+				{
+					continue;
+				}
+				workerArgs << QString::fromLocal8Bit( argv[i] );
+			}
+			r->renderProjectInParts( renderParts, workerArgs );
+		}
+		else if ( renderTracks )
 		{
+			r->setStemSelection( renderStems );
 			r->renderTracks();
 		}
 		else
@@ -853,10 +1408,28 @@ int main( int argc, char * * argv )
 			r->renderProject();
 		}
 	}
+	else if( !serveDir.isEmpty() )
+	{
+		Engine::init( true, renderPeriod, renderThreads );
+		destroyEngine = true;
+
+		RenderServer * server = new RenderServer( serveDir, qs, os, eff, renderLoop );
+		QCoreApplication::instance()->connect( server,
+				SIGNAL( finished() ), SLOT( quit() ) );
+		if( !server->start() )
+		{
+			return EXIT_FAILURE;
+		}
+	}
 	else // otherwise, start the GUI
 	{
 		new GuiApplication();
 
+		if( glitchLogFile.isEmpty() == false )
+		{
+			Engine::audioEngine()->profiler().setGlitchLogFile( glitchLogFile );
+		}
+
 		// re-intialize RNG - shared libraries might have srand() or
 		// srandom() calls in their init procedure
 		srand( getpid() + time( 0 ) );
@@ -1012,7 +1585,19 @@ int main( int argc, char * * argv )
 		}
 	}
 
+	// the engine exists in every mode which gets here
+	EngineStatsWriter * statsWriter = statsFile.isEmpty() ? nullptr :
+					new EngineStatsWriter( statsFile, statsInterval );
+
 	const int ret = app->exec();
+
+	delete statsWriter;
+
+	if( coreOnly && traceOutputFile.isEmpty() == false )
+	{
+		Engine::audioEngine()->profiler().writeJobTrace( traceOutputFile );
+	}
+
 	delete app;
 
 	if( destroyEngine )
@@ -23,6 +23,7 @@
  */
 
 #include "MidiAlsaSeq.h"
+#include "AudioEngine.h"
 #include "ConfigManager.h"
 #include "Engine.h"
 #include "gui_templates.h"
@@ -158,19 +159,70 @@ QString MidiAlsaSeq::probeDevice()
 
 
 void MidiAlsaSeq::processOutEvent( const MidiEvent& event, const TimePos& time, const MidiPort* port )
+{
+	snd_seq_event_t ev;
+	if( !prepareOutEvent( ev, event, port ) )
+	{
+		return;
+	}
+	snd_seq_ev_schedule_tick( &ev, m_queueID, 1, static_cast<int>( time ) );
+
+	m_seqMutex.lock();
+	snd_seq_event_output( m_seqHandle, &ev );
+	snd_seq_drain_output( m_seqHandle );
+	m_seqMutex.unlock();
+
+}
+
+
+
+
+void MidiAlsaSeq::processOutEvents( const MidiOutEvent * events, size_t count, fpp_t )
+{
+	if( count == 0 )
+	{
+		return;
+	}
+
+	const double sampleRate = Engine::audioEngine()->processingSampleRate();
+
+	m_seqMutex.lock();
+	for( size_t i = 0; i < count; ++i )
+	{
+		snd_seq_event_t ev;
+		if( !prepareOutEvent( ev, events[i].event, events[i].port ) )
+		{
+			continue;
+		}
+
+		// keep the distances the events had within the period, instead of
+		// sending them all at once
+		const double offset = events[i].offset / sampleRate;
+		snd_seq_real_time_t time;
+		time.tv_sec = static_cast<unsigned int>( offset );
+		time.tv_nsec = static_cast<unsigned int>( ( offset - time.tv_sec ) * 1e9 );
+		snd_seq_ev_schedule_real( &ev, m_queueID, 1, &time );
+
+		snd_seq_event_output( m_seqHandle, &ev );
+	}
+	snd_seq_drain_output( m_seqHandle );
+	m_seqMutex.unlock();
+}
+
+
+
+
+bool MidiAlsaSeq::prepareOutEvent( snd_seq_event_t & ev, const MidiEvent& event, const MidiPort* port ) const
 {
 	// HACK!!! - need a better solution which isn't that easy since we
 	// cannot store const-ptrs in our map because we need to call non-const
 	// methods of MIDI-port - it's a mess...
-	MidiPort* p = const_cast<MidiPort *>( port );
+	// value() doesn't add ports which aren't known (anymore)
+	Ports ports = m_portIDs.value( const_cast<MidiPort *>( port ) );
 
-	snd_seq_event_t ev;
 	snd_seq_ev_clear( &ev );
-	snd_seq_ev_set_source( &ev, ( m_portIDs[p][1] != -1 ) ?
-					m_portIDs[p][1] : m_portIDs[p][0] );
+	snd_seq_ev_set_source( &ev, ( ports[1] != -1 ) ? ports[1] : ports[0] );
 	snd_seq_ev_set_subs( &ev );
-	snd_seq_ev_schedule_tick( &ev, m_queueID, 1, static_cast<int>( time ) );
-	ev.queue =  m_queueID;
 	switch( event.type() )
 	{
 		case MidiNoteOn:
@@ -221,14 +273,10 @@ void MidiAlsaSeq::processOutEvent( const MidiEvent& event, const TimePos& time,
 
 		default:
 			qWarning( "MidiAlsaSeq: unhandled output event %d\n", (int) event.type() );
-			return;
+			return false;
 	}
 
-	m_seqMutex.lock();
-	snd_seq_event_output( m_seqHandle, &ev );
-	snd_seq_drain_output( m_seqHandle );
-	m_seqMutex.unlock();
-
+	return true;
 }
 
 
@@ -47,6 +47,17 @@ MidiClient::~MidiClient()
 
 
 
+void MidiClient::processOutEvents( const MidiOutEvent * events, size_t count, fpp_t )
+{
+	for( size_t i = 0; i < count; ++i )
+	{
+		processOutEvent( events[i].event, events[i].time, events[i].port );
+	}
+}
+
+
+
+
 void MidiClient::applyPortMode( MidiPort* )
 {
 }
@@ -118,8 +129,10 @@ MidiClientRaw::~MidiClientRaw()
 
 
 
-void MidiClientRaw::parseData( const unsigned char c )
+void MidiClientRaw::parseData( const unsigned char c, qint64 timestamp )
 {
+	m_midiParseData.m_timestamp = timestamp;
+
 	/*********************************************************************/
 	/* 'Process' system real-time messages                               */
 	/*********************************************************************/
@@ -255,7 +268,8 @@ void MidiClientRaw::processParsedEvent()
 {
 	for( int i = 0; i < m_midiPorts.size(); ++i )
 	{
-		m_midiPorts[i]->processInEvent( m_midiParseData.m_midiEvent );
+		m_midiPorts[i]->processInEvent( m_midiParseData.m_midiEvent, TimePos(),
+						m_midiParseData.m_timestamp );
 	}
 }
 
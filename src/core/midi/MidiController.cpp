@@ -23,6 +23,8 @@
  *
  */
 
+#include <algorithm>
+
 #include <QDomElement>
 #include <QObject>
 
@@ -37,7 +39,10 @@ MidiController::MidiController( Model * _parent ) :
 	MidiEventProcessor(),
 	m_midiPort( tr( "unnamed_midi_controller" ), Engine::audioEngine()->midiClient(), this, this, MidiPort::Input ),
 	m_lastValue( 0.0f ),
-	m_previousValue( 0.0f )
+	m_previousValue( 0.0f ),
+	m_eventsWritten( 0 ),
+	m_eventsRead( 0 ),
+	m_eventsDropped( false )
 {
 	setSampleExact( true );
 	connect( &m_midiPort, SIGNAL( modeChanged() ),
@@ -56,15 +61,37 @@ MidiController::~MidiController()
 
 void MidiController::updateValueBuffer()
 {
-	if( m_previousValue != m_lastValue )
+	// the values ramp from one control change to the next, reaching each
+	// one's value at its offset, and stay at the last one
+	float * values = m_valueBuffer.values();
+	const f_cnt_t frames = m_valueBuffer.length();
+	float value = m_previousValue;
+	f_cnt_t frame = 0;
+	const size_t written = m_eventsWritten.load( std::memory_order_acquire );
+	size_t read = m_eventsRead.load( std::memory_order_relaxed );
+	for( ; read != written; ++read )
 	{
-		m_valueBuffer.interpolate( m_previousValue, m_lastValue );
-		m_previousValue = m_lastValue;
+		const ControlEvent & event = m_events[read % MaxEvents];
+		// events received after the buffer of their period was updated
+		// already take effect right away
+		const f_cnt_t offset = event.period == s_periods
+			? qBound<f_cnt_t>( frame, event.offset, frames - 1 ) : frame;
+		for( f_cnt_t f = frame; f < offset; ++f )
+		{
+			values[f] = value + ( event.value - value ) * ( f - frame ) / ( offset - frame );
+		}
+		frame = offset;
+		value = event.value;
 	}
-	else
+	m_eventsRead.store( read, std::memory_order_release );
+	// the events dropped came after all of the ones kept
+	if( m_eventsDropped.exchange( false, std::memory_order_acquire ) )
 	{
-		m_valueBuffer.fill( m_lastValue );
+		value = m_lastValue.load( std::memory_order_relaxed );
 	}
+	std::fill( values + frame, values + frames, value );
+
+	m_previousValue = value;
 	m_bufferLastUpdated = s_periods;
 }
 
@@ -92,9 +119,22 @@ void MidiController::processInEvent( const MidiEvent& event, const TimePos& time
 					  m_midiPort.inputChannel() == 0 ) )
 			{
 				unsigned char val = event.controllerValue();
-				m_previousValue = m_lastValue;
-				m_lastValue = (float)( val ) / 127.0f;
-				emit valueChanged();
+				const float value = (float)( val ) / 127.0f;
+				m_lastValue.store( value, std::memory_order_relaxed );
+				// taken into the value buffer at the offset, the connected
+				// models and the GUI follow with the period's valueChanged().
+				// Nothing may read the buffer for a while, e.g. if nothing
+				// is connected, then only the last value is kept.
+				const size_t written = m_eventsWritten.load( std::memory_order_relaxed );
+				if( written - m_eventsRead.load( std::memory_order_acquire ) < MaxEvents )
+				{
+					m_events[written % MaxEvents] = { s_periods, offset, value };
+					m_eventsWritten.store( written + 1, std::memory_order_release );
+				}
+				else
+				{
+					m_eventsDropped.store( true, std::memory_order_release );
+				}
 			}
 			break;
 
@@ -26,6 +26,8 @@
 
 #ifdef LMMS_HAVE_JACK
 
+#include <algorithm>
+
 #include <QCompleter>
 #include <QMessageBox>
 
@@ -64,6 +66,11 @@ MidiJack::MidiJack() :
 	m_jackClient( nullptr ),
 	m_input_port( nullptr ),
 	m_output_port( nullptr ),
+	m_outWrite( 0 ),
+	m_outRead( 0 ),
+	m_outFrames( 0 ),
+	m_outSynced( false ),
+	m_outShift( 0 ),
 	m_quit( false )
 {
 	// if jack is currently used for audio then we share the connection
@@ -92,15 +99,9 @@ MidiJack::MidiJack() :
 
 	if(jackClient())
 	{
-		/* jack midi out not implemented
-		   JackMidiWrite and sendByte needs to be functional
-		   before enabling this
-		   If you enable this, also enable the
-		   corresponding jack_port_unregister line below
 		m_output_port = jack_port_register(
 				jackClient(), "MIDI out", JACK_DEFAULT_MIDI_TYPE,
 				JackPortIsOutput, 0);
-		*/
 
 		m_input_port = jack_port_register(
 				jackClient(), "MIDI in", JACK_DEFAULT_MIDI_TYPE,
@@ -127,11 +128,9 @@ MidiJack::~MidiJack()
 			printf("Failed to unregister jack midi input\n");
 		}
 
-		/* Unused yet, see the corresponding jack_port_register call
-		if( jack_port_unregister( jackClient(), m_output_port) != 0){
+		if( m_output_port && jack_port_unregister( jackClient(), m_output_port) != 0){
 			printf("Failed to unregister jack midi output\n");
 		}
-		*/
 
 		if(m_jackClient)
 		{
@@ -183,6 +182,13 @@ void MidiJack::JackMidiRead(jack_nframes_t nframes)
 	jack_nframes_t event_index = 0;
 	jack_nframes_t event_count = jack_midi_get_event_count(port_buf);
 
+	// the events of this cycle were received during the last one, at their
+	// frames from its start
+	jack_client_t* client = jackClient();
+	const double microsecondsPerFrame = 1e6 / jack_get_sample_rate(client);
+	const qint64 lastCycleStart = AudioEngineProfiler::now() - static_cast<qint64>(
+		(jack_frames_since_cycle_start(client) + nframes) * microsecondsPerFrame);
+
 	int rval = jack_midi_event_get(&in_event, port_buf, 0);
 	if (rval == 0 /* 0 = success */)
 	{
@@ -193,7 +199,8 @@ void MidiJack::JackMidiRead(jack_nframes_t nframes)
 				// lmms is setup to parse bytes coming from a device
 				// parse it byte by byte as it expects
 				for(b=0;b<in_event.size;b++)
-					parseData( *(in_event.buffer + b) );
+					parseData( *(in_event.buffer + b), lastCycleStart +
+						static_cast<qint64>(in_event.time * microsecondsPerFrame) );
 
 				event_index++;
 				if(event_index < event_count)
@@ -203,9 +210,9 @@ void MidiJack::JackMidiRead(jack_nframes_t nframes)
 	}
 }
 
-/* jack midi out is not implemented
-   sending plain bytes to jack midi outputs doesn't work
-   once working the output port needs to be enabled in the constructor
+/* sending plain bytes to jack midi outputs doesn't work, as jack wants
+   whole messages at their frames - the events come through
+   processOutEvents() instead
  */
 
 void MidiJack::sendByte( const unsigned char c )
@@ -213,10 +220,122 @@ void MidiJack::sendByte( const unsigned char c )
 	//m_midiDev.putChar( c );
 }
 
+uint8_t MidiJack::toBytes(const MidiEvent& event, uint8_t* data)
+{
+	data[0] = event.type() | event.channel();
+	switch (event.type())
+	{
+		case MidiNoteOn:
+		case MidiNoteOff:
+		case MidiKeyPressure:
+			data[1] = event.key();
+			data[2] = event.velocity();
+			return 3;
+
+		case MidiControlChange:
+			data[1] = event.controllerNumber();
+			data[2] = event.controllerValue();
+			return 3;
+
+		case MidiProgramChange:
+			data[1] = event.program();
+			return 2;
+
+		case MidiChannelPressure:
+			data[1] = event.channelPressure();
+			return 2;
+
+		case MidiPitchBend:
+			data[1] = event.param(0) & 0x7f;
+			data[2] = (event.param(0) >> 7) & 0x7f;
+			return 3;
+
+		default:
+			return 0;
+	}
+}
+
+// called by the audio engine at the end of every period
+void MidiJack::processOutEvents(const MidiOutEvent* events, size_t count, fpp_t frames)
+{
+	size_t write = m_outWrite.load(std::memory_order_relaxed);
+	const size_t read = m_outRead.load(std::memory_order_acquire);
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (write - read >= OutMessages)
+		{
+			// jack doesn't run, drop what doesn't fit
+			break;
+		}
+		OutMessage& message = m_outMessages[write % OutMessages];
+		message.size = toBytes(events[i].event, message.data);
+		if (message.size == 0)
+		{
+			continue;
+		}
+		message.frame = m_outFrames + static_cast<jack_nframes_t>(events[i].offset);
+		++write;
+	}
+	m_outWrite.store(write, std::memory_order_release);
+	m_outFrames += frames;
+}
+
 // we write data to jack
 void MidiJack::JackMidiWrite(jack_nframes_t nframes)
 {
-	// TODO: write midi data to jack port
+	if (m_output_port == nullptr)
+	{
+		return;
+	}
+
+	void* port_buf = jack_port_get_buffer(m_output_port, nframes);
+	jack_midi_clear_buffer(port_buf);
+
+	jack_client_t* client = jackClient();
+	const jack_nframes_t cycleStart = jack_last_frame_time(client);
+	const jack_nframes_t maxAhead = jack_get_sample_rate(client);
+
+	size_t read = m_outRead.load(std::memory_order_relaxed);
+	const size_t write = m_outWrite.load(std::memory_order_acquire);
+	jack_nframes_t lastTime = 0;
+	for (; read != write; ++read)
+	{
+		const OutMessage& message = m_outMessages[read % OutMessages];
+
+		// the messages keep the distances they had in the engine's periods,
+		// one period and a bit later. The frame counters wrap, so only
+		// their differences count.
+		auto ahead = static_cast<int32_t>(message.frame + m_outShift - cycleStart);
+		if (!m_outSynced || ahead > static_cast<int32_t>(maxAhead))
+		{
+			// the first message, or the engine rendered ahead, e.g. when
+			// exporting - start over at this cycle
+			m_outShift = cycleStart - message.frame;
+			m_outSynced = true;
+			ahead = 0;
+		}
+		else if (ahead < 0)
+		{
+			// late - the engine took longer than before, so delay this
+			// message and the following ones by as much
+			m_outShift -= ahead;
+			ahead = 0;
+		}
+
+		if (ahead >= static_cast<int32_t>(nframes))
+		{
+			break;
+		}
+
+		// the times have to increase
+		lastTime = std::max(lastTime, static_cast<jack_nframes_t>(ahead));
+		if (jack_midi_event_write(port_buf, lastTime, message.data, message.size) != 0)
+		{
+			// the buffer is full, try again in the next cycle
+			break;
+		}
+	}
+	m_outRead.store(read, std::memory_order_release);
 }
 
 void MidiJack::run()
@@ -26,6 +26,8 @@
 #include <QDomElement>
 
 #include "MidiPort.h"
+#include "AudioEngine.h"
+#include "Engine.h"
 #include "MidiClient.h"
 #include "MidiDummy.h"
 #include "Note.h"
@@ -97,6 +99,11 @@ MidiPort::~MidiPort()
 
 	// and finally unregister ourself
 	m_midiClient->removePort( this );
+
+	if( AudioEngine * audioEngine = Engine::audioEngine() )
+	{
+		audioEngine->removeMidiEvents( this );
+	}
 }
 
 
@@ -120,7 +127,7 @@ void MidiPort::setMode( Mode mode )
 
 
 
-void MidiPort::processInEvent( const MidiEvent& event, const TimePos& time )
+void MidiPort::processInEvent( const MidiEvent& event, const TimePos& time, qint64 timestamp )
 {
 	// mask event
 	if( isInputEnabled() &&
@@ -142,14 +149,29 @@ void MidiPort::processInEvent( const MidiEvent& event, const TimePos& time )
 			}
 		}
 
-		m_midiEventProcessor->processInEvent( inEvent, time );
+		AudioEngine * audioEngine = Engine::audioEngine();
+		if( audioEngine == nullptr )
+		{
+			m_midiEventProcessor->processInEvent( inEvent, time );
+			return;
+		}
+		audioEngine->pushMidiEvent( this, inEvent, time,
+			timestamp < 0 ? AudioEngineProfiler::now() : timestamp );
 	}
 }
 
 
 
 
-void MidiPort::processOutEvent( const MidiEvent& event, const TimePos& time )
+void MidiPort::dispatchInEvent( const MidiEvent& event, const TimePos& time, f_cnt_t offset )
+{
+	m_midiEventProcessor->processInEvent( event, time, offset );
+}
+
+
+
+
+void MidiPort::processOutEvent( const MidiEvent& event, const TimePos& time, f_cnt_t offset )
 {
 	// When output is enabled, route midi events if the selected channel matches
 	// the event channel or if there's no selected channel (value 0, represented by "--")
@@ -163,7 +185,14 @@ void MidiPort::processOutEvent( const MidiEvent& event, const TimePos& time )
 			outEvent.setVelocity( fixedOutputVelocity() );
 		}
 
-		m_midiClient->processOutEvent( outEvent, time, this );
+		if( AudioEngine * audioEngine = Engine::audioEngine() )
+		{
+			audioEngine->pushMidiOutEvent( this, outEvent, time, offset );
+		}
+		else
+		{
+			m_midiClient->processOutEvent( outEvent, time, this );
+		}
 	}
 }
 
@@ -31,6 +31,7 @@
 
 #include "ConfigManager.h"
 #include "LcdSpinBox.h"
+#include "LedCheckbox.h"
 #include "gui_templates.h"
 
 
@@ -80,6 +81,32 @@ AudioAlsaSetupWidget::AudioAlsaSetupWidget( QWidget * _parent ) :
 	m_channels->setLabel( tr( "CHANNELS" ) );
 	m_channels->move( 180, 20 );
 
+	LcdSpinBoxModel * periods = new LcdSpinBoxModel( /* this */ );
+	periods->setRange( 2, AudioAlsa::MaxPeriods );
+	periods->setValue( ConfigManager::inst()->value( "audioalsa", "periods",
+				QString::number( AudioAlsa::DefaultPeriods ) ).toInt() );
+
+	m_periods = new LcdSpinBox( 2, this );
+	m_periods->setModel( periods );
+	m_periods->setLabel( tr( "PERIODS" ) );
+	m_periods->move( 220, 20 );
+
+	// 0 wakes the device thread up once a period is free
+	LcdSpinBoxModel * availMin = new LcdSpinBoxModel( /* this */ );
+	availMin->setRange( 0, 9999 );
+	availMin->setValue( ConfigManager::inst()->value( "audioalsa",
+							"availmin" ).toInt() );
+
+	m_availMin = new LcdSpinBox( 4, this );
+	m_availMin->setModel( availMin );
+	m_availMin->setLabel( tr( "AVAIL MIN" ) );
+	m_availMin->setToolTip( tr( "Frames that have to be free in the device's "
+				"buffer before more are written, 0 for one period" ) );
+	m_availMin->move( 270, 20 );
+
+	m_mmap = new LedCheckBox( tr( "Write directly into the device's buffer (mmap)" ), this );
+	m_mmap->move( 10, 60 );
+	m_mmap->setChecked( ConfigManager::inst()->value( "audioalsa", "mmap" ).toInt() );
 }
 
 
@@ -88,6 +115,8 @@ AudioAlsaSetupWidget::AudioAlsaSetupWidget( QWidget * _parent ) :
 AudioAlsaSetupWidget::~AudioAlsaSetupWidget()
 {
 	delete m_channels->model();
+	delete m_periods->model();
+	delete m_availMin->model();
 }
 
 
@@ -106,6 +135,12 @@ void AudioAlsaSetupWidget::saveSettings()
 	ConfigManager::inst()->setValue( "audioalsa", "device", deviceText );
 	ConfigManager::inst()->setValue( "audioalsa", "channels",
 				QString::number( m_channels->value<int>() ) );
+	ConfigManager::inst()->setValue( "audioalsa", "periods",
+				QString::number( m_periods->value<int>() ) );
+	ConfigManager::inst()->setValue( "audioalsa", "availmin",
+				QString::number( m_availMin->value<int>() ) );
+	ConfigManager::inst()->setValue( "audioalsa", "mmap",
+				QString::number( m_mmap->isChecked() ) );
 }
 
 
@@ -46,8 +46,7 @@ QPixmap * AutomationClipView::s_clip_rec = nullptr;
 AutomationClipView::AutomationClipView( AutomationClip * _clip,
 						TrackView * _parent ) :
 	ClipView( _clip, _parent ),
-	m_clip( _clip ),
-	m_paintPixmap()
+	m_clip( _clip )
 {
 	connect( m_clip, SIGNAL( dataChanged() ),
 			this, SLOT( update() ) );
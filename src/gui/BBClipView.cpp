@@ -38,8 +38,7 @@
 
 BBClipView::BBClipView( Clip * _clip, TrackView * _tv ) :
 	ClipView( _clip, _tv ),
-	m_bbClip( dynamic_cast<BBClip *>( _clip ) ),
-	m_paintPixmap()
+	m_bbClip( dynamic_cast<BBClip *>( _clip ) )
 {
 	connect( _clip->getTrack(), SIGNAL( dataChanged() ), 
 			this, SLOT( update() ) );
@@ -134,7 +134,6 @@ ClipView::ClipView( Clip * clip,
 
 	m_trackView->getTrackContentWidget()->addClipView( this );
 	updateLength();
-	updatePosition();
 }
 
 
@@ -293,6 +292,21 @@ void ClipView::remove()
 
 
 
+/*! \brief Drops the painted pixmap of a hidden ClipView
+ *
+ *  Views of clips outside the visible part of the song are hidden, so
+ *  long arrangements don't keep a pixmap for every clip around.
+ */
+void ClipView::hideEvent( QHideEvent * he )
+{
+	m_paintPixmap = QPixmap();
+	m_needsUpdate = true;
+	selectableObject::hideEvent( he );
+}
+
+
+
+
 /*! \brief Updates a ClipView's length
  *
  *  If this ClipView has a fixed Clip, then we must
@@ -328,7 +342,7 @@ void ClipView::updateLength()
  */
 void ClipView::updatePosition()
 {
-	m_trackView->getTrackContentWidget()->changePosition();
+	m_trackView->getTrackContentWidget()->changePosition( this );
 	// moving a Clip can result in change of song-length etc.,
 	// therefore we update the track-container
 	m_trackView->trackContainerView()->update();
@@ -1177,15 +1191,16 @@ void ClipView::remove( QVector<ClipView *> clipvs )
 
 void ClipView::copy( QVector<ClipView *> clipvs )
 {
-	// For copyStringPair()
+	// For copyPayloadPair()
 	using namespace Clipboard;
 
 	// Write the Clips to a DataFile for copying
 	DataFile dataFile = createClipDataFiles( clipvs );
 
-	// Copy the Clip type as a key and the Clip data file to the clipboard
-	copyStringPair( QString( "clip_%1" ).arg( m_clip->getTrack()->type() ),
-		dataFile.toString() );
+	// Copy the Clip type as a key and the Clip data file to the clipboard,
+	// which is only written as text if another application asks for it
+	copyPayloadPair( QString( "clip_%1" ).arg( m_clip->getTrack()->type() ),
+		std::make_unique<DataFilePayload>( dataFile ) );
 }
 
 void ClipView::cut( QVector<ClipView *> clipvs )
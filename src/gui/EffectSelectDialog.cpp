@@ -34,44 +34,63 @@
 #include <QLabel>
 
 
-EffectSelectDialog::EffectSelectDialog( QWidget * _parent ) :
-	QDialog( _parent ),
-	ui( new Ui::EffectSelectDialog ),
-	m_sourceModel(),
-	m_model(),
-	m_descriptionWidget( nullptr )
+namespace
 {
-	ui->setupUi( this );
 
-	setWindowIcon( embed::getIconPixmap( "setup_audio" ) );
+//! Holds the case folded name and type the filter is matched against
+const int SearchRole = Qt::UserRole + 1;
 
-	// query effects
 
+//! The effects and their model, shared by all dialogs. They are only built
+//! again when plugins have been discovered since, as listing LADSPA and LV2
+//! effects takes long for large collections.
+struct EffectList
+{
+	EffectKeyList keys;
+	QStandardItemModel model;
+	int revision = -1;
+} ;
+
+
+EffectList & effectList()
+{
+	// never freed, like the file browser's pixmaps, as Qt objects can't be
+	// destroyed safely once the application is gone
+	static EffectList * list = new EffectList;
+	if( list->revision == getPluginFactory()->revision() )
+	{
+		return *list;
+	}
+	list->revision = getPluginFactory()->revision();
+
+	// query effects
+	EffectKeyList & keys = list->keys;
 	EffectKeyList subPluginEffectKeys;
 
+	keys.clear();
 	for (const Plugin::Descriptor* desc: getPluginFactory()->descriptors(Plugin::Effect))
 	{
 		if( desc->subPluginFeatures )
 		{
-			desc->subPluginFeatures->listSubPluginKeys(
-							desc,
-							subPluginEffectKeys );
+			subPluginEffectKeys += getPluginFactory()->subPluginKeys( desc );
 		}
 		else
 		{
-			m_effectKeys << EffectKey( desc, desc->name );
+			keys << EffectKey( desc, desc->name );
 
 		}
 	}
 
-	m_effectKeys += subPluginEffectKeys;
+	keys += subPluginEffectKeys;
 
-	// and fill our source model
-	m_sourceModel.setHorizontalHeaderItem( 0, new QStandardItem( tr( "Name" ) ) );
-	m_sourceModel.setHorizontalHeaderItem( 1, new QStandardItem( tr( "Type" ) ) );
+	// and fill the model
+	QStandardItemModel & model = list->model;
+	model.clear();
+	model.setHorizontalHeaderItem( 0, new QStandardItem( EffectSelectDialog::tr( "Name" ) ) );
+	model.setHorizontalHeaderItem( 1, new QStandardItem( EffectSelectDialog::tr( "Type" ) ) );
 	int row = 0;
-	for( EffectKeyList::ConstIterator it = m_effectKeys.begin();
-						it != m_effectKeys.end(); ++it )
+	for( EffectKeyList::ConstIterator it = keys.begin();
+						it != keys.end(); ++it )
 	{
 		QString name;
 		QString type;
@@ -85,17 +104,39 @@ EffectSelectDialog::EffectSelectDialog( QWidget * _parent ) :
 			name = it->desc->displayName;
 			type = "LMMS";
 		}
-		m_sourceModel.setItem( row, 0, new QStandardItem( name ) );
-		m_sourceModel.setItem( row, 1, new QStandardItem( type ) );
+		QStandardItem * nameItem = new QStandardItem( name );
+		nameItem->setData( ( name + ' ' + type ).toCaseFolded(), SearchRole );
+		model.setItem( row, 0, nameItem );
+		model.setItem( row, 1, new QStandardItem( type ) );
 		++row;
 	}
 
-	// setup filtering
-	m_model.setSourceModel( &m_sourceModel );
-	m_model.setFilterCaseSensitivity( Qt::CaseInsensitive );
+	return *list;
+}
+
+} // namespace
+
+
+
+
+EffectSelectDialog::EffectSelectDialog( QWidget * _parent ) :
+	QDialog( _parent ),
+	ui( new Ui::EffectSelectDialog ),
+	m_effectKeys( effectList().keys ),
+	m_model(),
+	m_descriptionWidget( nullptr )
+{
+	ui->setupUi( this );
+
+	setWindowIcon( embed::getIconPixmap( "setup_audio" ) );
+
+	// setup filtering, against the prepared search texts
+	m_model.setSourceModel( &effectList().model );
+	m_model.setFilterRole( SearchRole );
+	m_model.setFilterCaseSensitivity( Qt::CaseSensitive );
 
 	connect( ui->filterEdit, SIGNAL( textChanged( const QString & ) ),
-				&m_model, SLOT( setFilterFixedString( const QString & ) ) );
+				this, SLOT( setFilter( const QString & ) ) );
 	connect( ui->filterEdit, SIGNAL( textChanged( const QString & ) ),
 					this, SLOT( updateSelection() ) );
 	connect( ui->filterEdit, SIGNAL( textChanged( const QString & ) ),
@@ -249,6 +290,14 @@ void EffectSelectDialog::rowChanged( const QModelIndex & _idx,
 
 
 
+void EffectSelectDialog::setFilter( const QString & filter )
+{
+	m_model.setFilterFixedString( filter.toCaseFolded() );
+}
+
+
+
+
 void EffectSelectDialog::sortAgain()
 {
 	ui->pluginList->setSortingEnabled( ui->pluginList->isSortingEnabled() );
@@ -69,6 +69,13 @@ ExportProjectDialog::ExportProjectDialog( const QString & _file_name,
 				QVariant( ProjectRenderer::fileEncodeDevices[i].m_fileFormat ) // Format tag; later used for identification.
 			);
 
+			// The same render can be encoded into more files.
+			QListWidgetItem * moreItem = new QListWidgetItem( ProjectRenderer::tr(
+				ProjectRenderer::fileEncodeDevices[i].m_description ), moreFormatsLW );
+			moreItem->setData( Qt::UserRole, QVariant( ProjectRenderer::fileEncodeDevices[i].m_fileFormat ) );
+			moreItem->setFlags( moreItem->flags() | Qt::ItemIsUserCheckable );
+			moreItem->setCheckState( Qt::Unchecked );
+
 			// If this is our extension, select it.
 			if( QString::compare( renderExt, fileExt,
 									Qt::CaseInsensitive ) == 0 )
@@ -93,6 +100,8 @@ ExportProjectDialog::ExportProjectDialog( const QString & _file_name,
 		);
 	}
 	compLevelCB->setCurrentIndex(5);
+	// every track gets a file of its own already
+	moreFormatsWidget->setVisible( !m_multiExport );
 #ifndef LMMS_HAVE_SF_COMPLEVEL
 	// Disable this widget; the setting would be ignored by the renderer.
 	compressionWidget->setVisible(false);
@@ -171,6 +180,8 @@ void ExportProjectDialog::startExport()
 			static_cast<OutputSettings::BitDepth>( depthCB->currentIndex() ),
 			mapToStereoMode(stereoModeComboBox->currentIndex()) );
 
+	os.setDither(ditherCB->isChecked());
+
 	if (compressionWidget->isVisible())
 	{
 		double level = compLevelCB->itemData(compLevelCB->currentIndex()).toDouble();
@@ -186,6 +197,21 @@ void ExportProjectDialog::startExport()
 	}
 	m_renderManager.reset(new RenderManager( qs, os, m_ft, output_name ));
 
+	// rendered once, with the sample rate and settings chosen above
+	const QFileInfo outputInfo( output_name );
+	for( int i = 0; !m_multiExport && i < moreFormatsLW->count(); ++i )
+	{
+		const QListWidgetItem * item = moreFormatsLW->item( i );
+		auto format = static_cast<ProjectRenderer::ExportFileFormats>(
+			item->data( Qt::UserRole ).toInt() );
+		if( item->checkState() == Qt::Checked && format != m_ft )
+		{
+			m_renderManager->addOutput( format, os,
+				outputInfo.dir().filePath( outputInfo.completeBaseName() +
+					ProjectRenderer::getFileExtensionFromFormat( format ) ) );
+		}
+	}
+
 	Engine::getSong()->setExportLoop( exportLoopCB->isChecked() );
 	Engine::getSong()->setRenderBetweenMarkers( renderMarkersCB->isChecked() );
 	Engine::getSong()->setLoopRenderCount(loopCountSB->value());
@@ -25,6 +25,8 @@
 
 
 #include <QDesktopServices>
+#include <QFileInfo>
+#include <QHash>
 #include <QHBoxLayout>
 #include <QKeyEvent>
 #include <QLineEdit>
@@ -37,6 +39,7 @@
 #include <QStringList>
 
 #include "FileBrowser.h"
+#include "FileBrowserIndex.h"
 #include "AudioEngine.h"
 #include "BBTrackContainer.h"
 #include "ConfigManager.h"
@@ -52,6 +55,7 @@
 #include "MainWindow.h"
 #include "PluginFactory.h"
 #include "PresetPreviewPlayHandle.h"
+#include "SampleBuffer.h"
 #include "SamplePlayHandle.h"
 #include "SampleTrack.h"
 #include "Song.h"
@@ -64,6 +68,16 @@ enum TreeWidgetItemTypes
 	TypeDirectoryItem
 } ;
 
+//! How many decoded samples a file browser keeps for previewing them again
+const int PreviewSamplesMax = 16;
+
+//! Larger samples next to the previewed one aren't prefetched, they're
+//! likely whole songs rather than one-shots or loops
+const qint64 PrefetchBytesMax = 16 * 1024 * 1024;
+
+//! How long to wait for more directories to be read before filtering again
+const int RefilterInterval = 250;
+
 
 
 void FileBrowser::addContentCheckBox()
@@ -77,7 +91,7 @@ void FileBrowser::addContentCheckBox()
 	auto configCheckBox = [this, &filterWidgetLayout](QCheckBox* box)
 	{
 		box->setCheckState(Qt::Checked);
-		connect(box, SIGNAL(stateChanged(int)), this, SLOT(reloadTree()));
+		connect(box, SIGNAL(stateChanged(int)), this, SLOT(populateTree()));
 		filterWidgetLayout->addWidget(box);
 	};
 
@@ -96,6 +110,7 @@ FileBrowser::FileBrowser(const QString & directories, const QString & filter,
 			const QString& userDir,
 			const QString& factoryDir):
 	SideBarWidget( title, pm, parent ),
+	m_index( new FileBrowserIndex( filter, this ) ),
 	m_directories( directories ),
 	m_filter( filter ),
 	m_dirsAsItems( dirs_as_items ),
@@ -137,6 +152,23 @@ FileBrowser::FileBrowser(const QString & directories, const QString & filter,
 
 	m_fileBrowserTreeWidget = new FileBrowserTreeWidget( contentParent() );
 	addContentWidget( m_fileBrowserTreeWidget );
+	// connected after the tree widget's own connection, which adds the items
+	connect( m_fileBrowserTreeWidget, SIGNAL( itemExpanded( QTreeWidgetItem * ) ),
+			this, SLOT( filterAdded( QTreeWidgetItem * ) ) );
+
+	connect( m_index, SIGNAL( listed( const QStringList & ) ),
+			this, SLOT( updateListed( const QStringList & ) ) );
+	if( m_recurse )
+	{
+		for( const QString & path : m_directories.split( '*' ) )
+		{
+			m_index->addRecursive( path );
+		}
+	}
+
+	m_refilterTimer.setSingleShot( true );
+	m_refilterTimer.setInterval( RefilterInterval );
+	connect( &m_refilterTimer, SIGNAL( timeout() ), this, SLOT( refilter() ) );
 
 	// Whenever the FileBrowser has focus, Ctrl+F should direct focus to its filter box.
 	QShortcut *filterFocusShortcut = new QShortcut( QKeySequence( QKeySequence::Find ), this, SLOT(giveFocusToFilter()) );
@@ -149,6 +181,13 @@ FileBrowser::FileBrowser(const QString & directories, const QString & filter,
 bool FileBrowser::filterItems( const QString & filter, QTreeWidgetItem * item )
 {
 	// call with item=NULL to filter the entire tree
+	if( item == nullptr )
+	{
+		m_filterExtended = !m_lastFilter.isNull() &&
+					filter.contains( m_lastFilter, Qt::CaseInsensitive );
+		m_lastFilter = filter;
+	}
+
 	bool anyMatched = false;
 
 	int numChildren = item ? item->childCount() : m_fileBrowserTreeWidget->topLevelItemCount();
@@ -156,8 +195,14 @@ bool FileBrowser::filterItems( const QString & filter, QTreeWidgetItem * item )
 	{
 		QTreeWidgetItem * it = item ? item->child( i ) : m_fileBrowserTreeWidget->topLevelItem(i);
 
+		// nothing hidden matches an extended filter either
+		if( m_filterExtended && it->isHidden() )
+		{
+			continue;
+		}
+
 		// is directory?
-		if( it->childCount() )
+		if( it->type() == TypeDirectoryItem )
 		{
 			// matches filter?
 			if( it->text( 0 ).
@@ -170,8 +215,13 @@ bool FileBrowser::filterItems( const QString & filter, QTreeWidgetItem * item )
 			}
 			else
 			{
-				// only show if item below matches filter
-				bool didMatch = filterItems( filter, it );
+				// only show if anything below matches filter, including
+				// what hasn't been added to the tree yet
+				bool didMatch = static_cast<Directory *>( it )->hasMatch( filter );
+				if( didMatch )
+				{
+					filterItems( filter, it );
+				}
 				it->setHidden( !didMatch );
 				anyMatched = anyMatched || didMatch;
 			}
@@ -196,9 +246,113 @@ bool FileBrowser::filterItems( const QString & filter, QTreeWidgetItem * item )
 }
 
 
+void FileBrowser::refilter()
+{
+	m_lastFilter = QString();
+	filterItems( m_filterEdit->text() );
+}
+
+
+
+
+void FileBrowser::filterAdded( QTreeWidgetItem * item )
+{
+	const QString filter = m_filterEdit->text();
+	if( filter.isEmpty() )
+	{
+		return;
+	}
+	// everything below a directory matching the filter is shown
+	for( QTreeWidgetItem * it = item; it != nullptr; it = it->parent() )
+	{
+		if( it->text( 0 ).contains( filter, Qt::CaseInsensitive ) )
+		{
+			return;
+		}
+	}
+	filterItems( filter, item );
+}
+
+
+
+
+void FileBrowser::updateListed( const QStringList & paths )
+{
+	QSet<QString> listed;
+	for( const QString & path : paths )
+	{
+		listed.insert( path );
+	}
+
+	if( !m_dirsAsItems )
+	{
+		for( const QString & path : m_directories.split( '*' ) )
+		{
+			if( listed.contains( QDir::cleanPath( path ) ) )
+			{
+				populateTree();
+				return;
+			}
+		}
+	}
+
+	updateDirectories( nullptr, listed );
+	if( !m_filterEdit->text().isEmpty() && !m_refilterTimer.isActive() )
+	{
+		m_refilterTimer.start();
+	}
+}
+
+
+
+
+void FileBrowser::updateDirectories( QTreeWidgetItem * item, const QSet<QString> & paths )
+{
+	int numChildren = item ? item->childCount() : m_fileBrowserTreeWidget->topLevelItemCount();
+	for( int i = 0; i < numChildren; ++i )
+	{
+		QTreeWidgetItem * it = item ? item->child( i ) : m_fileBrowserTreeWidget->topLevelItem( i );
+		// directories come before files
+		if( it->type() != TypeDirectoryItem )
+		{
+			break;
+		}
+
+		Directory * d = static_cast<Directory *>( it );
+		if( d->shows( paths ) )
+		{
+			const QList<QString> expandedDirs = d->childCount()
+				? m_fileBrowserTreeWidget->expandedDirs( d ) : m_expandedDirs;
+			d->reload();
+			expandItems( d, expandedDirs );
+			filterAdded( d );
+		}
+		else if( d->isExpanded() )
+		{
+			updateDirectories( d, paths );
+		}
+	}
+}
+
+
+
+
 void FileBrowser::reloadTree( void )
 {
-	QList<QString> expandedDirs = m_fileBrowserTreeWidget->expandedDirs();
+	m_index->clear();
+	populateTree();
+}
+
+
+
+
+void FileBrowser::populateTree()
+{
+	// keep the expanded directories while the tree is still being read
+	if( m_fileBrowserTreeWidget->topLevelItemCount() > 0 )
+	{
+		m_expandedDirs = m_fileBrowserTreeWidget->expandedDirs();
+	}
 	const QString text = m_filterEdit->text();
 	m_filterEdit->clear();
 	m_fileBrowserTreeWidget->clear();
@@ -219,8 +373,9 @@ void FileBrowser::reloadTree( void )
 			addItems(*it);
 		}
 	}
-	expandItems(nullptr, expandedDirs);
+	expandItems(nullptr, m_expandedDirs);
 	m_filterEdit->setText( text );
+	m_lastFilter = QString();
 	filterItems( text );
 }
 
@@ -232,20 +387,17 @@ void FileBrowser::expandItems( QTreeWidgetItem * item, QList<QString> expandedDi
 	for (int i = 0; i < numChildren; ++i)
 	{
 		QTreeWidgetItem * it = item ? item->child( i ) : m_fileBrowserTreeWidget->topLevelItem(i);
-		if ( m_recurse )
-		{
-			it->setExpanded( true );
-		}
 		Directory *d = dynamic_cast<Directory *> ( it );
 		if (d)
 		{
+			// adds its items if they have been read already, otherwise
+			// updateListed() expands what's below once they are
+			d->setExpanded( expandedDirs.contains( d->fullName() ) );
 			d->update();
-			bool expand = expandedDirs.contains( d->fullName() );
-			d->setExpanded( expand );
-		}
-		if (m_recurse && it->childCount())
-		{
-			expandItems(it, expandedDirs);
+			if (d->childCount())
+			{
+				expandItems(d, expandedDirs);
+			}
 		}
 	}
 }
@@ -268,13 +420,19 @@ void FileBrowser::addItems(const QString & path )
 {
 	if( m_dirsAsItems )
 	{
-		m_fileBrowserTreeWidget->addTopLevelItem( new Directory( path, QString(), m_filter ) );
+		m_fileBrowserTreeWidget->addTopLevelItem( new Directory( path, QString(), m_index ) );
+		return;
+	}
+
+	// updateListed() adds the items once the directory has been read
+	const FileBrowserIndex::Listing * listing = m_index->listing( path );
+	if( listing == nullptr )
+	{
 		return;
 	}
 
 	// try to add all directories from file system alphabetically into the tree
-	QDir cdir( path );
-	QStringList files = cdir.entryList( QDir::Dirs, QDir::Name );
+	QStringList files = listing->dirs;
 	files.sort(Qt::CaseInsensitive);
 	for( QStringList::const_iterator it = files.constBegin();
 						it != files.constEnd(); ++it )
@@ -291,7 +449,7 @@ void FileBrowser::addItems(const QString & path )
 				{
 					// insert before item, we're done
 					Directory *dd = new Directory( cur_file, path,
-												   m_filter );
+												   m_index );
 					m_fileBrowserTreeWidget->insertTopLevelItem( i,dd );
 					dd->update(); // add files to the directory
 					orphan = false;
@@ -315,14 +473,14 @@ void FileBrowser::addItems(const QString & path )
 				// it has not yet been added yet, so it's (lexically)
 				// larger than all other dirs => append it at the bottom
 				Directory *d = new Directory( cur_file,
-											  path, m_filter );
+											  path, m_index );
 				d->update();
 				m_fileBrowserTreeWidget->addTopLevelItem( d );
 			}
 		}
 	}
 
-	files = cdir.entryList( QDir::Files, QDir::Name );
+	files = listing->files;
 	for( QStringList::const_iterator it = files.constBegin();
 						it != files.constEnd(); ++it )
 	{
@@ -393,6 +551,17 @@ FileBrowserTreeWidget::FileBrowserTreeWidget(QWidget * parent ) :
 
 
 
+FileBrowserTreeWidget::~FileBrowserTreeWidget()
+{
+	for (const auto & sample : m_previewSamples)
+	{
+		sharedObject::unref(sample.second);
+	}
+}
+
+
+
+
 QList<QString> FileBrowserTreeWidget::expandedDirs( QTreeWidgetItem * item ) const
 {
 	int numChildren = item ? item->childCount() : topLevelItemCount();
@@ -613,16 +782,10 @@ void FileBrowserTreeWidget::previewFileItem(FileItem* file)
 	// handling() rather than directly creating a SamplePlayHandle
 	if (file->type() == FileItem::SampleFile)
 	{
-		TextFloat * tf = TextFloat::displayMessage(
-			tr("Loading sample"),
-			tr("Please wait, loading sample for preview..."),
-			embed::getIconPixmap("sample_file", 24, 24), 0);
-		// TODO: this can be removed once we do this outside the event thread
-		qApp->processEvents(QEventLoop::ExcludeUserInputEvents);
-		SamplePlayHandle* s = new SamplePlayHandle(fileName);
+		SamplePlayHandle* s = new SamplePlayHandle(previewSample(file));
 		s->setDoneMayReturnTrue(false);
 		newPPH = s;
-		delete tf;
+		prefetchNeighbours(file);
 	}
 	else if (
 		(ext == "xiz" || ext == "sf2" || ext == "sf3" ||
@@ -662,6 +825,55 @@ void FileBrowserTreeWidget::previewFileItem(FileItem* file)
 
 
 
+SampleBuffer* FileBrowserTreeWidget::previewSample(FileItem* file)
+{
+	const QString fileName = file->fullName();
+	for (int i = 0; i < m_previewSamples.size(); ++i)
+	{
+		if (m_previewSamples[i].first == fileName)
+		{
+			m_previewSamples.move(i, 0);
+			return m_previewSamples.front().second;
+		}
+	}
+
+	TextFloat * tf = TextFloat::displayMessage(
+		tr("Loading sample"),
+		tr("Please wait, loading sample for preview..."),
+		embed::getIconPixmap("sample_file", 24, 24), 0);
+	// TODO: this can be removed once we do this outside the event thread
+	qApp->processEvents(QEventLoop::ExcludeUserInputEvents);
+	// quick if the sample was prefetched
+	SampleBuffer* sample = new SampleBuffer(fileName);
+	delete tf;
+
+	m_previewSamples.prepend(qMakePair(fileName, sample));
+	while (m_previewSamples.size() > PreviewSamplesMax)
+	{
+		sharedObject::unref(m_previewSamples.takeLast().second);
+	}
+	return sample;
+}
+
+
+
+
+void FileBrowserTreeWidget::prefetchNeighbours(FileItem* file)
+{
+	for (QTreeWidgetItem* item : {itemAbove(file), itemBelow(file)})
+	{
+		auto neighbour = dynamic_cast<FileItem*>(item);
+		if (neighbour != nullptr && neighbour->type() == FileItem::SampleFile &&
+			QFileInfo(neighbour->fullName()).size() <= PrefetchBytesMax)
+		{
+			SampleBuffer::prefetch(neighbour->fullName());
+		}
+	}
+}
+
+
+
+
 void FileBrowserTreeWidget::stopPreview()
 {
 	QMutexLocker previewLocker(&m_pphMutex);
@@ -765,6 +977,7 @@ void FileBrowserTreeWidget::handleFile(FileItem * f, InstrumentTrack * it)
 		case FileItem::LoadByPlugin:
 		{
 			const QString e = f->extension();
+			it->instantiateInstrument();
 			Instrument * i = it->instrument();
 			if( i == nullptr ||
 				!i->descriptor()->supportsFileType( e ) )
@@ -929,17 +1142,17 @@ QPixmap * Directory::s_folderLockedPixmap = nullptr;
 
 
 Directory::Directory(const QString & filename, const QString & path,
-						const QString & filter ) :
+						FileBrowserIndex * index ) :
 	QTreeWidgetItem( QStringList( filename ), TypeDirectoryItem ),
 	m_directories( path ),
-	m_filter( filter ),
+	m_index( index ),
 	m_dirCount( 0 )
 {
 	initPixmaps();
 
 	setChildIndicatorPolicy( QTreeWidgetItem::ShowIndicator );
 
-	if( !QDir( fullName() ).isReadable() )
+	if( m_index->isUnreadable( fullName() ) )
 	{
 		setIcon( 0, *s_folderLockedPixmap );
 	}
@@ -1019,10 +1232,51 @@ void Directory::update( void )
 
 
 
+void Directory::reload()
+{
+	qDeleteAll( takeChildren() );
+	m_dirCount = 0;
+	update();
+}
+
+
+
+
+bool Directory::shows( const QSet<QString> & paths )
+{
+	for( const QString & path : m_directories )
+	{
+		if( paths.contains( QDir::cleanPath( fullName( path ) ) ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
+bool Directory::hasMatch( const QString & text )
+{
+	for( const QString & path : m_directories )
+	{
+		if( m_index->hasMatch( fullName( path ), text ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
 bool Directory::addItems(const QString & path )
 {
-	QDir thisDir( path );
-	if( !thisDir.isReadable() )
+	// FileBrowser::updateListed() reloads this once the directory is read
+	const FileBrowserIndex::Listing * listing = m_index->listing( path );
+	if( listing == nullptr || !listing->readable )
 	{
 		return false;
 	}
@@ -1032,7 +1286,7 @@ bool Directory::addItems(const QString & path )
 	bool added_something = false;
 
 	// try to add all directories from file system alphabetically into the tree
-	QStringList files = thisDir.entryList( QDir::Dirs, QDir::Name );
+	QStringList files = listing->dirs;
 	for( QStringList::const_iterator it = files.constBegin();
 						it != files.constEnd(); ++it )
 	{
@@ -1048,7 +1302,7 @@ bool Directory::addItems(const QString & path )
 				{
 					// insert before item, we're done
 					insertChild( i, new Directory( cur_file,
-							path, m_filter ) );
+							path, m_index ) );
 					orphan = false;
 					m_dirCount++;
 					break;
@@ -1071,7 +1325,7 @@ bool Directory::addItems(const QString & path )
 				// it has not yet been added yet, so it's (lexically)
 				// larger than all other dirs => append it at the bottom
 				addChild( new Directory( cur_file, path,
-								m_filter ) );
+								m_index ) );
 				m_dirCount++;
 			}
 
@@ -1084,18 +1338,13 @@ bool Directory::addItems(const QString & path )
 		sortChildren(0, Qt::AscendingOrder);
 
 	QList<QTreeWidgetItem*> items;
-	files = thisDir.entryList( QDir::Files, QDir::Name );
+	files = listing->filteredFiles;
 	files.sort(Qt::CaseInsensitive);
 	for( QStringList::const_iterator it = files.constBegin();
 						it != files.constEnd(); ++it )
 	{
-		QString cur_file = *it;
-		if( cur_file[0] != '.' &&
-				thisDir.match( m_filter, cur_file.toLower() ) )
-		{
-			items << new FileItem( cur_file, path );
-			added_something = true;
-		}
+		items << new FileItem( *it, path );
+		added_something = true;
 	}
 	addChildren( items );
 
@@ -1216,10 +1465,21 @@ void FileItem::initPixmaps( void )
 
 void FileItem::determineFileType( void )
 {
-	m_handling = NotSupported;
+	// the type only depends on the extension, but looking for plugins
+	// supporting it is too slow for directories with many files
+	static QHash<QString, QPair<FileTypes, FileHandling>> types;
 
 	const QString ext = extension();
-	if( ext == "mmp" || ext == "mpt" || ext == "mmpz" )
+	auto type = types.constFind( ext );
+	if( type != types.constEnd() )
+	{
+		m_type = type->first;
+		m_handling = type->second;
+		return;
+	}
+
+	m_handling = NotSupported;
+	if( ext == "mmp" || ext == "mpt" || ext == "mmpz" || ext == "mmpb" )
 	{
 		m_type = ProjectFile;
 		m_handling = LoadAsProject;
@@ -1273,6 +1533,8 @@ void FileItem::determineFileType( void )
 			m_type = SampleFile;
 		}
 	}
+
+	types.insert( ext, qMakePair( m_type, m_handling ) );
 }
 
 
@@ -0,0 +1,460 @@
+/*
+ * FileBrowserIndex.cpp - directory listings of a file browser, read in the
+ *                        background
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "FileBrowserIndex.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+#include <QtCore/QRegExp>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+
+namespace
+{
+
+QThreadPool & pool()
+{
+	static QThreadPool pool;
+	return pool;
+}
+
+
+
+
+QString childPath(const QString & path, const QString & name)
+{
+	// roots like "/" or "C:/" already end with a separator
+	return path.endsWith('/') ? path + name : path + '/' + name;
+}
+
+} // namespace
+
+
+
+
+struct FileBrowserIndex::Request
+{
+	QMutex mutex;
+	// nullptr once the index is gone or was cleared
+	FileBrowserIndex * index = nullptr;
+	QList<QPair<QString, Listing>> listings;
+} ;
+
+
+
+
+class FileBrowserReadJob : public QRunnable
+{
+public:
+	FileBrowserReadJob(std::shared_ptr<FileBrowserIndex::Request> request,
+			const QString & path, const QString & filter, bool recursive) :
+		m_request(std::move(request)),
+		m_path(path),
+		m_filter(filter),
+		m_recursive(recursive)
+	{
+	}
+
+	void run() override
+	{
+		// QDir::match() would compile the filter again for each file
+		QList<QRegExp> filters;
+		for (const QString & pattern : QDir::nameFiltersFromString(m_filter))
+		{
+			filters << QRegExp(pattern, Qt::CaseInsensitive, QRegExp::Wildcard);
+		}
+
+		QStringList pending(m_path);
+		while (!pending.isEmpty())
+		{
+			const QString path = pending.takeLast();
+			const FileBrowserIndex::Listing listing = read(path, filters);
+			if (m_recursive)
+			{
+				for (const QString & dir : listing.dirs)
+				{
+					pending << childPath(path, dir);
+				}
+			}
+
+			QMutexLocker lock(&m_request->mutex);
+			if (m_request->index == nullptr)
+			{
+				return;
+			}
+			// one call takes all listings that arrived until it's run
+			if (m_request->listings.isEmpty())
+			{
+				QMetaObject::invokeMethod(m_request->index, "addListings",
+								Qt::QueuedConnection);
+			}
+			m_request->listings.append(qMakePair(path, listing));
+		}
+	}
+
+private:
+	static FileBrowserIndex::Listing read(const QString & path,
+						QList<QRegExp> & filters)
+	{
+		FileBrowserIndex::Listing listing;
+		QDir dir(path);
+		if (!dir.isReadable())
+		{
+			listing.readable = false;
+			return listing;
+		}
+
+		for (const QString & name : dir.entryList(QDir::Dirs, QDir::Name))
+		{
+			if (name[0] != '.')
+			{
+				listing.dirs << name;
+				if (!QDir(dir.filePath(name)).isReadable())
+				{
+					listing.unreadableDirs << name;
+				}
+			}
+		}
+
+		for (const QString & name : dir.entryList(QDir::Files, QDir::Name))
+		{
+			if (name[0] != '.')
+			{
+				listing.files << name;
+				for (QRegExp & filter : filters)
+				{
+					if (filter.exactMatch(name))
+					{
+						listing.filteredFiles << name;
+						break;
+					}
+				}
+			}
+		}
+
+		return listing;
+	}
+
+	std::shared_ptr<FileBrowserIndex::Request> m_request;
+	QString m_path;
+	QString m_filter;
+	bool m_recursive;
+} ;
+
+
+
+
+FileBrowserIndex::FileBrowserIndex(const QString & filter, QObject * parent) :
+	QObject(parent),
+	m_filter(filter),
+	m_request(std::make_shared<Request>())
+{
+	m_request->index = this;
+	connect(&m_watcher, SIGNAL(directoryChanged(const QString &)),
+			this, SLOT(directoryChanged(const QString &)));
+}
+
+
+
+
+FileBrowserIndex::~FileBrowserIndex()
+{
+	QMutexLocker lock(&m_request->mutex);
+	m_request->index = nullptr;
+}
+
+
+
+
+const FileBrowserIndex::Listing * FileBrowserIndex::listing(const QString & path)
+{
+	const QString key = QDir::cleanPath(path);
+	auto it = m_listings.constFind(key);
+	if (it != m_listings.constEnd())
+	{
+		return &*it;
+	}
+	read(key, false);
+	return nullptr;
+}
+
+
+
+
+void FileBrowserIndex::addRecursive(const QString & path)
+{
+	const QString key = QDir::cleanPath(path);
+	if (!m_recursive.contains(key))
+	{
+		m_recursive << key;
+		read(key, true);
+	}
+}
+
+
+
+
+bool FileBrowserIndex::hasMatch(const QString & path, const QString & text)
+{
+	if (text != m_matchText)
+	{
+		if (!m_matchText.isEmpty() && text.contains(m_matchText, Qt::CaseInsensitive))
+		{
+			if (!m_matchText.contains(m_noMatchText, Qt::CaseInsensitive))
+			{
+				m_noMatches.clear();
+			}
+			for (auto it = m_matches.constBegin(); it != m_matches.constEnd(); ++it)
+			{
+				if (!it.value())
+				{
+					m_noMatches.insert(it.key());
+				}
+			}
+			m_noMatchText = m_matchText;
+		}
+		else if (!text.contains(m_noMatchText, Qt::CaseInsensitive))
+		{
+			m_noMatches.clear();
+			m_noMatchText.clear();
+		}
+		m_matchText = text;
+		m_matches.clear();
+	}
+	return hasMatch(QDir::cleanPath(path));
+}
+
+
+
+
+bool FileBrowserIndex::isUnreadable(const QString & path) const
+{
+	return m_unreadable.contains(QDir::cleanPath(path));
+}
+
+
+
+
+void FileBrowserIndex::clear()
+{
+	{
+		QMutexLocker lock(&m_request->mutex);
+		m_request->index = nullptr;
+	}
+	m_request = std::make_shared<Request>();
+	m_request->index = this;
+
+	m_listings.clear();
+	m_reading.clear();
+	m_unreadable.clear();
+	if (!m_watcher.directories().isEmpty())
+	{
+		m_watcher.removePaths(m_watcher.directories());
+	}
+	m_matches.clear();
+	m_noMatches.clear();
+	m_noMatchText.clear();
+
+	for (const QString & path : m_recursive)
+	{
+		read(path, true);
+	}
+}
+
+
+
+
+void FileBrowserIndex::addListings()
+{
+	QList<QPair<QString, Listing>> listings;
+	{
+		QMutexLocker lock(&m_request->mutex);
+		listings.swap(m_request->listings);
+	}
+	if (listings.isEmpty())
+	{
+		return;
+	}
+
+	QStringList paths;
+	for (const auto & listing : listings)
+	{
+		const QString & path = listing.first;
+		m_reading.remove(path);
+
+		auto old = m_listings.constFind(path);
+		if (old != m_listings.constEnd())
+		{
+			if (old->readable == listing.second.readable && old->dirs == listing.second.dirs &&
+				old->files == listing.second.files &&
+				old->unreadableDirs == listing.second.unreadableDirs)
+			{
+				// read again by a recursive read, or a change of a file
+				continue;
+			}
+			for (const QString & dir : old->dirs)
+			{
+				m_unreadable.remove(childPath(path, dir));
+				if (!listing.second.dirs.contains(dir))
+				{
+					remove(childPath(path, dir));
+				}
+			}
+			// the recursive read of the directory didn't reach new ones
+			if (isBelowRecursive(path))
+			{
+				for (const QString & dir : listing.second.dirs)
+				{
+					if (!old->dirs.contains(dir))
+					{
+						read(childPath(path, dir), true);
+					}
+				}
+			}
+		}
+		else if (listing.second.readable)
+		{
+			m_watcher.addPath(path);
+		}
+
+		for (const QString & dir : listing.second.unreadableDirs)
+		{
+			m_unreadable.insert(childPath(path, dir));
+		}
+		m_listings.insert(path, listing.second);
+		paths << path;
+	}
+
+	// new names may match
+	m_matches.clear();
+	m_noMatches.clear();
+	m_noMatchText.clear();
+
+	emit listed(paths);
+}
+
+
+
+
+void FileBrowserIndex::directoryChanged(const QString & path)
+{
+	if (m_listings.contains(path))
+	{
+		read(path, false);
+	}
+}
+
+
+
+
+void FileBrowserIndex::read(const QString & path, bool recursive)
+{
+	if (!recursive && m_reading.contains(path))
+	{
+		return;
+	}
+	m_reading.insert(path);
+	pool().start(new FileBrowserReadJob(m_request, path, m_filter, recursive));
+}
+
+
+
+
+bool FileBrowserIndex::isBelowRecursive(const QString & path) const
+{
+	for (const QString & root : m_recursive)
+	{
+		if (path == root || path.startsWith(childPath(root, QString())))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
+
+void FileBrowserIndex::remove(const QString & path)
+{
+	const QString prefix = childPath(path, QString());
+	QStringList removed;
+	for (auto it = m_listings.begin(); it != m_listings.end();)
+	{
+		if (it.key() == path || it.key().startsWith(prefix))
+		{
+			removed << it.key();
+			it = m_listings.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+	if (!removed.isEmpty())
+	{
+		m_watcher.removePaths(removed);
+	}
+}
+
+
+
+
+bool FileBrowserIndex::hasMatch(const QString & path)
+{
+	if (m_noMatches.contains(path))
+	{
+		return false;
+	}
+	auto cached = m_matches.constFind(path);
+	if (cached != m_matches.constEnd())
+	{
+		return cached.value();
+	}
+
+	bool match = false;
+	auto it = m_listings.constFind(path);
+	if (it != m_listings.constEnd())
+	{
+		for (const QString & file : it->filteredFiles)
+		{
+			if (file.contains(m_matchText, Qt::CaseInsensitive))
+			{
+				match = true;
+				break;
+			}
+		}
+		for (int i = 0; !match && i < it->dirs.size(); ++i)
+		{
+			const QString & dir = it->dirs[i];
+			match = dir.contains(m_matchText, Qt::CaseInsensitive) ||
+					hasMatch(childPath(path, dir));
+		}
+	}
+	m_matches.insert(path, match);
+	return match;
+}
@@ -42,6 +42,7 @@
 #include "GuiApplication.h"
 #include "InstrumentTrack.h"
 #include "InstrumentTrackWindow.h"
+#include "LoadIndicator.h"
 #include "MainWindow.h"
 #include "MidiClient.h"
 #include "MidiPortMenu.h"
@@ -67,6 +68,8 @@ InstrumentTrackView::InstrumentTrackView( InstrumentTrack * _it, TrackContainerV
 
 	connect( _it, SIGNAL( nameChanged() ),
 			m_tlb, SLOT( update() ) );
+	connect( _it, SIGNAL( instrumentLoaded() ),
+			m_tlb, SLOT( update() ) );
 
 	connect(ConfigManager::inst(), SIGNAL(valueChanged(QString, QString, QString)),
 			this, SLOT(handleConfigChange(QString, QString, QString)));
@@ -159,6 +162,13 @@ InstrumentTrackView::InstrumentTrackView( InstrumentTrack * _it, TrackContainerV
 	connect( _it, SIGNAL( endNote() ),
 	 		m_activityIndicator, SLOT( noteEnd() ) );
 
+	// CPU load of the instrument and its effects, shown while the
+	// profiler measures it
+	m_loadIndicator = new LoadIndicator( getTrackSettingsWidget() );
+	m_loadIndicator->setGeometry( widgetWidth-4, 2, 3, 28 );
+	connect( getGUI()->mainWindow(), SIGNAL( periodicUpdate() ),
+			this, SLOT( updateLoad() ) );
+
 	setModel( _it );
 }
 
@@ -177,6 +187,34 @@ InstrumentTrackView::~InstrumentTrackView()
 
 
 
+void InstrumentTrackView::updateLoad()
+{
+	// hidden or scrolled out of sight, the load keeps adding up till then
+	if( visibleRegion().isEmpty() )
+	{
+		return;
+	}
+
+	const bool showLoad = Engine::audioEngine()->profiler().jobLoadEnabled();
+	if( showLoad )
+	{
+		AudioPort * port = model()->audioPort();
+		const float instrument = port->playHandleLoad().takeLoad();
+		const float effects = port->effectsLoad().takeLoad();
+		QString details = tr( "Instrument: %1%\nEffects: %2%" )
+				.arg( instrument, 0, 'f', 1 ).arg( effects, 0, 'f', 1 );
+		if( port->effects() && port->effects()->isSleeping() )
+		{
+			details += "\n" + tr( "Effects asleep until there's input" );
+		}
+		m_loadIndicator->setLoad( instrument + effects, details );
+	}
+	m_loadIndicator->setVisible( showLoad );
+}
+
+
+
+
 void InstrumentTrackView::toggleMidiCCRack()
 {
 	// Lazy creation: midiCCRackView is only created when accessed the first time.
@@ -287,6 +325,14 @@ void InstrumentTrackView::dropEvent( QDropEvent * _de )
 
 void InstrumentTrackView::toggleInstrumentWindow( bool _on )
 {
+	InstrumentTrack * track = model();
+	if( _on )
+	{
+		// the window shows the instrument's own controls
+		track->instantiateInstrument();
+	}
+	track->setInstrumentWindowShown( _on );
+
 	if (_on && ConfigManager::inst()->value("ui", "oneinstrumenttrackwindow").toInt())
 	{
 		if (topLevelInstrumentTrackWindow())
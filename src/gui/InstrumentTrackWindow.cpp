@@ -330,11 +330,14 @@ void InstrumentTrackWindow::modelChanged()
 
 	m_track->disconnect( SIGNAL( nameChanged() ), this );
 	m_track->disconnect( SIGNAL( instrumentChanged() ), this );
+	m_track->disconnect( SIGNAL( instrumentLoaded() ), this );
 
 	connect( m_track, SIGNAL( nameChanged() ),
 			this, SLOT( updateName() ) );
 	connect( m_track, SIGNAL( instrumentChanged() ),
 			this, SLOT( updateInstrumentView() ) );
+	connect( m_track, SIGNAL( instrumentLoaded() ),
+			this, SLOT( updateInstrumentView() ) );
 
 	m_volumeKnob->setModel( &m_track->m_volumeModel );
 	m_panningKnob->setModel( &m_track->m_panningModel );
@@ -379,6 +382,9 @@ void InstrumentTrackWindow::modelChanged()
 	m_miscView->scaleCombo()->setModel(m_track->m_microtuner.scaleModel());
 	m_miscView->keymapCombo()->setModel(m_track->m_microtuner.keymapModel());
 	m_miscView->rangeImportCheckbox()->setModel(m_track->m_microtuner.keyRangeImportModel());
+	m_miscView->voiceLimitGroupBox()->setModel(&m_track->m_voiceLimitEnabledModel);
+	m_miscView->voiceLimitSpinBox()->setModel(&m_track->m_voiceLimitModel);
+	m_miscView->voiceStealingCombo()->setModel(&m_track->m_voiceStealingModel);
 	updateName();
 }
 
@@ -26,6 +26,7 @@
 
 #include <QApplication>
 #include <QCloseEvent>
+#include <QDateTime>
 #include <QDesktopServices>
 #include <QDomElement>
 #include <QFileInfo>
@@ -53,7 +54,9 @@
 #include "ImportFilter.h"
 #include "InstrumentTrackView.h"
 #include "InstrumentTrackWindow.h"
+#include "MemoryUsageDialog.h"
 #include "MicrotunerConfig.h"
+#include "ModelView.h"
 #include "PianoRoll.h"
 #include "PianoView.h"
 #include "PluginBrowser.h"
@@ -131,7 +134,7 @@ MainWindow::MainWindow() :
 	sideBar->appendTab( new FileBrowser(
 				confMgr->userProjectsDir() + "*" +
 				confMgr->factoryProjectsDir(),
-					"*.mmp *.mmpz *.xml *.mid",
+					"*.mmp *.mmpz *.mmpb *.xml *.mid",
 							tr( "My Projects" ),
 					embed::getIconPixmap( "project_file" ).transformed( QTransform().rotate( 90 ) ),
 							splitter, false, true,
@@ -232,7 +235,7 @@ MainWindow::MainWindow() :
 	vbox->addWidget( w );
 	setCentralWidget( main_widget );
 
-	m_updateTimer.start( 1000 / 60, this );  // 60 fps
+	updateFrameRate();
 
 	if( ConfigManager::inst()->value( "ui", "enableautosave" ).toInt() )
 	{
@@ -423,6 +426,30 @@ void MainWindow::finalize()
 							this, SLOT( help() ) );
 	}
 
+	help_menu->addSeparator();
+	QAction * jobTraceAction = help_menu->addAction( tr( "Record engine job trace" ) );
+	jobTraceAction->setCheckable( true );
+	connect( jobTraceAction, SIGNAL( toggled( bool ) ),
+			this, SLOT( onToggleJobTrace( bool ) ) );
+	help_menu->addAction( tr( "Export engine job trace..." ),
+					this, SLOT( onExportJobTrace() ) );
+	help_menu->addAction( tr( "Show audio glitches..." ),
+					this, SLOT( onShowGlitches() ) );
+	help_menu->addAction( tr( "Export audio glitch log..." ),
+					this, SLOT( onExportGlitchLog() ) );
+	QAction * jobLoadAction = help_menu->addAction( tr( "Show CPU load of tracks and mixer channels" ) );
+	jobLoadAction->setCheckable( true );
+	connect( jobLoadAction, SIGNAL( toggled( bool ) ),
+			this, SLOT( onToggleJobLoad( bool ) ) );
+	QAction * denormalWatchAction = help_menu->addAction( tr( "Watch for denormals" ) );
+	denormalWatchAction->setCheckable( true );
+	connect( denormalWatchAction, SIGNAL( toggled( bool ) ),
+			this, SLOT( onToggleDenormalWatch( bool ) ) );
+	help_menu->addAction( tr( "Show denormal suspects..." ),
+					this, SLOT( onShowDenormalSuspects() ) );
+	help_menu->addAction( tr( "Show memory usage..." ),
+					this, SLOT( onShowMemoryUsage() ) );
+
 // Prevent dangling separator at end of menu per https://bugreports.qt.io/browse/QTBUG-40071
 #if !(defined(LMMS_BUILD_APPLE) && (QT_VERSION < 0x050600))
 	help_menu->addSeparator();
@@ -835,7 +862,7 @@ void MainWindow::openProject()
 {
 	if( mayChangeProject(false) )
 	{
-		FileDialog ofd( this, tr( "Open Project" ), "", tr( "LMMS (*.mmp *.mmpz)" ) );
+		FileDialog ofd( this, tr( "Open Project" ), "", tr( "LMMS (*.mmp *.mmpz *.mmpb)" ) );
 
 		ofd.setDirectory( ConfigManager::inst()->userProjectsDir() );
 		ofd.setFileMode( FileDialog::ExistingFiles );
@@ -879,7 +906,7 @@ bool MainWindow::saveProjectAs()
 {
 	auto optionsWidget = new SaveOptionsWidget(Engine::getSong()->getSaveOptions());
 	VersionedSaveDialog sfd( this, optionsWidget, tr( "Save Project" ), "",
-			tr( "LMMS Project" ) + " (*.mmpz *.mmp);;" +
+			tr( "LMMS Project" ) + " (*.mmpz *.mmp *.mmpb);;" +
 				tr( "LMMS Project Template" ) + " (*.mpt)" );
 	QString f = Engine::getSong()->projectFileName();
 	if( f != "" )
@@ -1359,6 +1386,7 @@ void MainWindow::closeEvent( QCloseEvent * _ce )
 void MainWindow::sessionCleanup()
 {
 	// delete recover session files
+	m_autoSaver.wait();
 	QFile::remove( ConfigManager::inst()->recoveryFile() );
 	setSession( Normal );
 }
@@ -1429,12 +1457,26 @@ void MainWindow::keyReleaseEvent( QKeyEvent * _ke )
 
 void MainWindow::timerEvent( QTimerEvent * _te)
 {
+	ModelView::updateChangedViews();
 	emit periodicUpdate();
 }
 
 
 
 
+void MainWindow::updateFrameRate()
+{
+	int fps = ConfigManager::inst()->value( "ui", "framerate" ).toInt();
+	if( fps < MIN_FRAME_RATE || fps > MAX_FRAME_RATE )
+	{
+		fps = DEFAULT_FRAME_RATE;
+	}
+	m_updateTimer.start( 1000 / fps, this );
+}
+
+
+
+
 
 void MainWindow::showTool( QAction * _idx )
 {
@@ -1466,9 +1508,9 @@ void MainWindow::autoSave()
 		!QApplication::mouseButtons() &&
 		( ConfigManager::inst()->value( "ui",
 				"enablerunningautosave" ).toInt() ||
-			! Engine::getSong()->isPlaying() ) )
+			! Engine::getSong()->isPlaying() ) &&
+		m_autoSaver.save(ConfigManager::inst()->recoveryFile()))
 	{
-		Engine::getSong()->saveProjectFile(ConfigManager::inst()->recoveryFile());
 		autoSaveTimerReset();  // Reset timer
 	}
 	else
@@ -1520,6 +1562,148 @@ void MainWindow::onExportProjectMidi()
 	}
 }
 
+void MainWindow::onToggleJobTrace( bool enabled )
+{
+	AudioEngineProfiler & profiler = Engine::audioEngine()->profiler();
+	if( enabled )
+	{
+		profiler.clearJobTrace();
+	}
+	profiler.setJobTracingEnabled( enabled );
+}
+
+void MainWindow::onToggleJobLoad( bool enabled )
+{
+	Engine::audioEngine()->profiler().setJobLoadEnabled( enabled );
+}
+
+void MainWindow::onToggleDenormalWatch( bool enabled )
+{
+	Engine::audioEngine()->profiler().setDenormalWatchEnabled( enabled );
+}
+
+void MainWindow::onExportJobTrace()
+{
+	if( Engine::audioEngine()->profiler().jobTraceSize() == 0 )
+	{
+		QMessageBox::information( this, tr( "Export engine job trace" ),
+			tr( "No jobs have been recorded yet. Enable \"Record engine job trace\" "
+				"in the help menu and play the project first." ) );
+		return;
+	}
+
+	FileDialog efd( this );
+	efd.setFileMode( FileDialog::AnyFile );
+	efd.setNameFilters( QStringList( tr( "Chrome trace (*.json)" ) ) );
+	efd.setDirectory( ConfigManager::inst()->userProjectsDir() );
+	efd.selectFile( "lmms-trace.json" );
+	efd.setDefaultSuffix( "json" );
+	efd.setWindowTitle( tr( "Select file for job trace export..." ) );
+	efd.setAcceptMode( FileDialog::AcceptSave );
+
+	if( efd.exec() == QDialog::Accepted && !efd.selectedFiles().isEmpty() && !efd.selectedFiles()[0].isEmpty() )
+	{
+		if( !Engine::audioEngine()->profiler().writeJobTrace( efd.selectedFiles()[0] ) )
+		{
+			QMessageBox::warning( this, tr( "Export engine job trace" ),
+				tr( "Could not write %1." ).arg( efd.selectedFiles()[0] ) );
+		}
+	}
+}
+
+void MainWindow::onShowGlitches()
+{
+	AudioEngineProfiler & profiler = Engine::audioEngine()->profiler();
+	const QVector<AudioEngineProfiler::Glitch> glitches = profiler.glitches();
+
+	QString details;
+	for( const AudioEngineProfiler::Glitch & g : glitches )
+	{
+		details += tr( "%1: period took %2 ms of %3 ms, %4 device xruns" )
+				.arg( QDateTime::fromMSecsSinceEpoch( g.time ).toString( "HH:mm:ss.zzz" ) )
+				.arg( g.periodTime / 1000.0, 0, 'f', 2 )
+				.arg( g.deadline / 1000.0, 0, 'f', 2 )
+				.arg( g.xruns ) + "\n";
+		for( int i = 0; i < g.jobCount; ++i )
+		{
+			details += QString( "    %1: %2 ms\n" )
+				.arg( g.jobNames[i].isEmpty() ? tr( "Job" ) : g.jobNames[i] )
+				.arg( g.jobTimes[i] / 1000.0, 0, 'f', 2 );
+		}
+	}
+
+	QMessageBox box( QMessageBox::Information, tr( "Audio glitches" ),
+		tr( "Periods which took longer than the audio device could wait: %1\n"
+			"Xruns reported by the audio device: %2\n"
+			"The last %3 glitches are kept, together with the jobs which "
+			"took longest in their period." )
+			.arg( profiler.deadlineMisses() )
+			.arg( profiler.totalDeviceXruns() )
+			.arg( glitches.size() ),
+		QMessageBox::Close | QMessageBox::Reset, this );
+	box.setDetailedText( details );
+	if( box.exec() == QMessageBox::Reset )
+	{
+		profiler.clearGlitches();
+	}
+}
+
+void MainWindow::onShowDenormalSuspects()
+{
+	AudioEngineProfiler & profiler = Engine::audioEngine()->profiler();
+	const QVector<AudioEngineProfiler::DenormalSuspect> suspects = profiler.denormalSuspects();
+
+	QString details;
+	for( const AudioEngineProfiler::DenormalSuspect & s : suspects )
+	{
+		details += tr( "%1: %2 quiet periods took up to %3 times the usual %4 ms" )
+				.arg( s.jobName.isEmpty() ? tr( "Job" ) : s.jobName )
+				.arg( s.spikes )
+				.arg( s.worstRatio, 0, 'f', 1 )
+				.arg( s.usualTime / 1000.0, 0, 'f', 2 ) + "\n";
+	}
+
+	QMessageBox box( QMessageBox::Information, tr( "Denormal suspects" ),
+		profiler.denormalWatchEnabled() || !suspects.isEmpty()
+			? tr( "Tracks and mixer channels whose effects take much longer while "
+				"their sound decays to almost nothing, which is typical for "
+				"denormal numbers: %1" ).arg( suspects.size() )
+			: tr( "Turn on \"Watch for denormals\" and play the project to find "
+				"the tracks and mixer channels whose effects slow down on "
+				"denormal numbers." ),
+		QMessageBox::Close, this );
+	box.setDetailedText( details );
+	box.exec();
+}
+
+void MainWindow::onExportGlitchLog()
+{
+	FileDialog efd( this );
+	efd.setFileMode( FileDialog::AnyFile );
+	efd.setNameFilters( QStringList( tr( "JSON (*.json)" ) ) );
+	efd.setDirectory( ConfigManager::inst()->userProjectsDir() );
+	efd.selectFile( "lmms-glitches.json" );
+	efd.setDefaultSuffix( "json" );
+	efd.setWindowTitle( tr( "Select file for glitch log export..." ) );
+	efd.setAcceptMode( FileDialog::AcceptSave );
+
+	if( efd.exec() == QDialog::Accepted && !efd.selectedFiles().isEmpty() && !efd.selectedFiles()[0].isEmpty() )
+	{
+		if( !Engine::audioEngine()->profiler().writeGlitchLog( efd.selectedFiles()[0] ) )
+		{
+			QMessageBox::warning( this, tr( "Export audio glitch log" ),
+				tr( "Could not write %1." ).arg( efd.selectedFiles()[0] ) );
+		}
+	}
+}
+
+void MainWindow::onShowMemoryUsage()
+{
+	MemoryUsageDialog * dialog = new MemoryUsageDialog( this );
+	dialog->setAttribute( Qt::WA_DeleteOnClose );
+	dialog->show();
+}
+
 void MainWindow::exportProject(bool multiExport)
 {
 	QString const & projectFileName = Engine::getSong()->projectFileName();
@@ -0,0 +1,197 @@
+/*
+ * MemoryUsageDialog.cpp - shows what the tracks, plugins and samples of the
+ *                         project use of memory
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "MemoryUsageDialog.h"
+
+#include <algorithm>
+
+#include <QDialogButtonBox>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "MemoryReport.h"
+#include "SampleCache.h"
+
+
+namespace
+{
+
+enum Columns
+{
+	NameColumn,
+	BytesColumn,
+	DetailsColumn
+} ;
+
+
+void setBytes( QTreeWidgetItem * item, size_t bytes )
+{
+	item->setText( BytesColumn, MemoryUsageDialog::formatBytes( bytes ) );
+	item->setTextAlignment( BytesColumn, Qt::AlignRight | Qt::AlignVCenter );
+}
+
+
+void addOwners( QTreeWidgetItem * parent, std::vector<MemoryReport::OwnerUsage> owners )
+{
+	std::stable_sort( owners.begin(), owners.end(),
+		[]( const MemoryReport::OwnerUsage & a, const MemoryReport::OwnerUsage & b )
+			{ return a.bytes() > b.bytes(); } );
+
+	size_t total = 0;
+	for( const MemoryReport::OwnerUsage & owner : owners )
+	{
+		QTreeWidgetItem * item = new QTreeWidgetItem( parent );
+		item->setText( NameColumn, owner.name );
+		setBytes( item, owner.bytes() );
+		if( owner.sampleBytes > 0 )
+		{
+			item->setText( DetailsColumn, MemoryUsageDialog::tr( "%1 in samples" )
+							.arg( MemoryUsageDialog::formatBytes( owner.sampleBytes ) ) );
+		}
+		for( const MemoryReport::PluginUsage & plugin : owner.plugins )
+		{
+			QTreeWidgetItem * pluginItem = new QTreeWidgetItem( item );
+			pluginItem->setText( NameColumn, plugin.name );
+			setBytes( pluginItem, plugin.bytes + plugin.processBytes );
+			if( plugin.process != 0 )
+			{
+				pluginItem->setText( DetailsColumn, MemoryUsageDialog::tr( "Process %1" )
+								.arg( plugin.process ) );
+			}
+		}
+		total += owner.bytes();
+	}
+	setBytes( parent, total );
+}
+
+}
+
+
+
+
+MemoryUsageDialog::MemoryUsageDialog( QWidget * parent ) :
+	QDialog( parent ),
+	m_summary( new QLabel( this ) ),
+	m_tree( new QTreeWidget( this ) )
+{
+	setWindowTitle( tr( "Memory usage" ) );
+	resize( 640, 480 );
+
+	m_summary->setWordWrap( true );
+	m_summary->setTextInteractionFlags( Qt::TextSelectableByMouse );
+
+	m_tree->setColumnCount( 3 );
+	m_tree->setHeaderLabels( { tr( "Name" ), tr( "Memory" ), tr( "Details" ) } );
+	m_tree->header()->setSectionResizeMode( NameColumn, QHeaderView::Stretch );
+	m_tree->header()->setStretchLastSection( false );
+
+	QDialogButtonBox * buttons = new QDialogButtonBox( QDialogButtonBox::Close, this );
+	QPushButton * purge = buttons->addButton( tr( "Purge unused samples" ), QDialogButtonBox::ActionRole );
+	QPushButton * refreshButton = buttons->addButton( tr( "Refresh" ), QDialogButtonBox::ActionRole );
+	connect( purge, SIGNAL( clicked() ), this, SLOT( purgeUnusedSamples() ) );
+	connect( refreshButton, SIGNAL( clicked() ), this, SLOT( refresh() ) );
+	connect( buttons, SIGNAL( rejected() ), this, SLOT( reject() ) );
+
+	QVBoxLayout * layout = new QVBoxLayout( this );
+	layout->addWidget( m_summary );
+	layout->addWidget( m_tree );
+	layout->addWidget( buttons );
+
+	refresh();
+}
+
+
+
+
+void MemoryUsageDialog::refresh()
+{
+	const MemoryReport report = MemoryReport::collect();
+
+	m_summary->setText( tr( "LMMS: %1 resident, %2 of it allocated by the engine. "
+				"Remote plugins: %3 resident. Plugin data: %4. "
+				"Samples: %5, %6 of them unused, %7 saved by sharing them." )
+			.arg( formatBytes( report.resident ) )
+			.arg( formatBytes( report.allocated ) )
+			.arg( formatBytes( report.remoteResident ) )
+			.arg( formatBytes( report.pluginBytes ) )
+			.arg( formatBytes( report.sampleBytes ) )
+			.arg( formatBytes( report.unusedSampleBytes ) )
+			.arg( formatBytes( report.sharedSampleBytes ) ) );
+
+	m_tree->clear();
+
+	QTreeWidgetItem * tracks = new QTreeWidgetItem( m_tree, { tr( "Tracks" ) } );
+	addOwners( tracks, report.tracks );
+	QTreeWidgetItem * channels = new QTreeWidgetItem( m_tree, { tr( "Mixer channels" ) } );
+	addOwners( channels, report.mixerChannels );
+
+	QTreeWidgetItem * samples = new QTreeWidgetItem( m_tree, { tr( "Samples" ) } );
+	setBytes( samples, report.sampleBytes );
+	for( const MemoryReport::SampleUsage & sample : report.samples )
+	{
+		QTreeWidgetItem * item = new QTreeWidgetItem( samples );
+		item->setText( NameColumn, QFileInfo( sample.file ).fileName() );
+		item->setToolTip( NameColumn, sample.file );
+		setBytes( item, sample.bytes );
+
+		QStringList details;
+		details << ( sample.users == 0 ? tr( "unused" ) : tr( "%n user(s)", "", sample.users ) );
+		details << tr( "%1 Hz" ).arg( sample.sampleRate );
+		if( sample.duplicated )
+		{
+			details << tr( "duplicated" );
+		}
+		item->setText( DetailsColumn, details.join( ", " ) );
+	}
+
+	m_tree->expandToDepth( 0 );
+	m_tree->resizeColumnToContents( BytesColumn );
+	m_tree->resizeColumnToContents( DetailsColumn );
+}
+
+
+
+
+void MemoryUsageDialog::purgeUnusedSamples()
+{
+	SampleCache::dropRetained();
+	refresh();
+}
+
+
+
+
+QString MemoryUsageDialog::formatBytes( size_t bytes )
+{
+	if( bytes >= 1024 * 1024 )
+	{
+		return tr( "%1 MB" ).arg( bytes / ( 1024.0 * 1024.0 ), 0, 'f', 1 );
+	}
+	return tr( "%1 KB" ).arg( bytes / 1024.0, 0, 'f', 1 );
+}
@@ -40,6 +40,7 @@
 
 #include "MixerView.h"
 #include "Knob.h"
+#include "LoadIndicator.h"
 #include "MixerLine.h"
 #include "Mixer.h"
 #include "GuiApplication.h"
@@ -590,37 +591,44 @@ void MixerView::clear()
 
 void MixerView::updateFaders()
 {
+	// the engine keeps collecting the peaks until we're shown again
+	if( !isVisible() )
+	{
+		return;
+	}
+
 	Mixer * m = Engine::mixer();
+	const float masterGain = Engine::audioEngine()->masterGain();
 
-	// apply master gain
-	m->mixerChannel(0)->m_peakLeft *= Engine::audioEngine()->masterGain();
-	m->mixerChannel(0)->m_peakRight *= Engine::audioEngine()->masterGain();
+	const bool showLoad = Engine::audioEngine()->profiler().jobLoadEnabled();
 
 	for( int i = 0; i < m_mixerChannelViews.size(); ++i )
 	{
-		const float opl = m_mixerChannelViews[i]->m_fader->getPeak_L();
-		const float opr = m_mixerChannelViews[i]->m_fader->getPeak_R();
-		const float fallOff = 1.25;
-		if( m->mixerChannel(i)->m_peakLeft >= opl/fallOff )
+		MixerChannel * ch = m->mixerChannel( i );
+		LoadIndicator * loadIndicator = m_mixerChannelViews[i]->m_mixerLine->m_loadIndicator;
+		if( showLoad )
 		{
-			m_mixerChannelViews[i]->m_fader->setPeak_L( m->mixerChannel(i)->m_peakLeft );
-			// Set to -1 so later we'll know if this value has been refreshed yet.
-			m->mixerChannel(i)->m_peakLeft = -1;
+			loadIndicator->setLoad( ch->m_loadMeter.takeLoad(),
+				ch->m_fxChain.isSleeping()
+					? tr( "Effects asleep until there's input" ) : QString() );
 		}
-		else if( m->mixerChannel(i)->m_peakLeft != -1 )
-		{
-			m_mixerChannelViews[i]->m_fader->setPeak_L( opl/fallOff );
-		}
-
-		if( m->mixerChannel(i)->m_peakRight >= opr/fallOff )
+		loadIndicator->setVisible( showLoad );
+
+		// take the peaks of all periods since the last frame at once, and
+		// keep the meters where they are if there were none
+		const float peakLeft = ch->m_peakLeft.exchange( -1 );
+		const float peakRight = ch->m_peakRight.exchange( -1 );
+		// apply master gain
+		const float gain = i == 0 ? masterGain : 1.0f;
+		Fader * fader = m_mixerChannelViews[i]->m_fader;
+		const float fallOff = 1.25;
+		if( peakLeft != -1 )
 		{
-			m_mixerChannelViews[i]->m_fader->setPeak_R( m->mixerChannel(i)->m_peakRight );
-			// Set to -1 so later we'll know if this value has been refreshed yet.
-			m->mixerChannel(i)->m_peakRight = -1;
+			fader->setPeak_L( qMax( peakLeft * gain, fader->getPeak_L() / fallOff ) );
 		}
-		else if( m->mixerChannel(i)->m_peakRight != -1 )
+		if( peakRight != -1 )
 		{
-			m_mixerChannelViews[i]->m_fader->setPeak_R( opr/fallOff );
+			fader->setPeak_R( qMax( peakRight * gain, fader->getPeak_R() / fallOff ) );
 		}
 	}
 }
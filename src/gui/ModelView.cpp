@@ -22,16 +22,34 @@
  *
  */
 
+#include <QCoreApplication>
+#include <QSet>
+#include <QThread>
 #include <QWidget>
 
 #include "ModelView.h"
 
 
+namespace
+{
+
+// all views, only touched by the GUI thread
+QSet<ModelView*> s_views;
+// set with the flag of a view, so that frames without changes don't look
+// at every view
+std::atomic<bool> s_viewsChanged( false );
+
+}
+
+
+
 
 ModelView::ModelView( Model* model, QWidget* widget ) :
 	m_widget( widget ),
-	m_model( model )
+	m_model( model ),
+	m_changed( false )
 {
+	s_views.insert( this );
 }
 
 
@@ -39,10 +57,34 @@ ModelView::ModelView( Model* model, QWidget* widget ) :
 
 ModelView::~ModelView()
 {
+	s_views.remove( this );
 	if( m_model != nullptr && m_model->isDefaultConstructed() )
 	{
 		delete m_model;
 	}
+	else if( m_model != nullptr )
+	{
+		// the widget is still there, but this isn't
+		m_model->disconnect( widget() );
+	}
+}
+
+
+
+
+void ModelView::updateChangedViews()
+{
+	if( !s_viewsChanged.exchange( false ) )
+	{
+		return;
+	}
+	for( ModelView* view : s_views )
+	{
+		if( view->m_changed.exchange( false ) )
+		{
+			view->widget()->update();
+		}
+	}
 }
 
 
@@ -88,9 +130,28 @@ void ModelView::doConnections()
 {
 	if( m_model != nullptr )
 	{
-		QObject::connect( m_model, SIGNAL( dataChanged() ), widget(), SLOT( update() ) );
+		// direct, so that a change on another thread doesn't queue a
+		// repaint
+		QObject::connect( m_model, &Model::dataChanged, widget(),
+					[this]() { modelDataChanged(); }, Qt::DirectConnection );
 		QObject::connect( m_model, SIGNAL( propertiesChanged() ), widget(), SLOT( update() ) );
 	}
 }
 
 
+
+
+void ModelView::modelDataChanged()
+{
+	if( QThread::currentThread() == QCoreApplication::instance()->thread() )
+	{
+		widget()->update();
+	}
+	else
+	{
+		m_changed.store( true );
+		s_viewsChanged.store( true );
+	}
+}
+
+
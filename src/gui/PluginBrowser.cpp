@@ -39,6 +39,10 @@
 #include "PluginFactory.h"
 
 
+//! Holds the case folded name the filter is matched against
+const int SearchRole = Qt::UserRole + 1;
+
+
 PluginBrowser::PluginBrowser( QWidget * _parent ) :
 	SideBarWidget( tr( "Instrument Plugins" ),
 				embed::getIconPixmap( "plugins" ).transformed( QTransform().rotate( 90 ) ), _parent )
@@ -109,6 +113,7 @@ void PluginBrowser::updateRootVisibilities()
 
 void PluginBrowser::onFilterChanged( const QString & filter )
 {
+	const QString folded = filter.toCaseFolded();
 	int rootCount = m_descTree->topLevelItemCount();
 	for (int rootIndex = 0; rootIndex < rootCount; ++rootIndex)
 	{
@@ -118,16 +123,7 @@ void PluginBrowser::onFilterChanged( const QString & filter )
 		for (int itemIndex = 0; itemIndex < itemCount; ++itemIndex)
 		{
 			QTreeWidgetItem * item = root->child( itemIndex );
-			PluginDescWidget * descWidget = static_cast<PluginDescWidget *>
-							(m_descTree->itemWidget( item, 0));
-			if (descWidget->name().contains(filter, Qt::CaseInsensitive))
-			{
-				item->setHidden( false );
-			}
-			else
-			{
-				item->setHidden( true );
-			}
+			item->setHidden( !item->data( 0, SearchRole ).toString().contains( folded ) );
 		}
 	}
 }
@@ -148,6 +144,7 @@ void PluginBrowser::addPlugins()
 	const auto addPlugin = [this](const auto& key, auto root)
 	{
 		const auto item = new QTreeWidgetItem();
+		item->setData(0, SearchRole, key.displayName().toCaseFolded());
 		root->addChild(item);
 		m_descTree->setItemWidget(item, 0, new PluginDescWidget(key, m_descTree));
 	};
@@ -174,8 +171,7 @@ void PluginBrowser::addPlugins()
 		if (desc->subPluginFeatures)
 		{
 			// Fetch and sort all subplugins for this plugin descriptor
-			auto subPluginKeys = Plugin::Descriptor::SubPluginFeatures::KeyList{};
-			desc->subPluginFeatures->listSubPluginKeys(desc, subPluginKeys);
+			auto subPluginKeys = getPluginFactory()->subPluginKeys(desc);
 			std::sort(subPluginKeys.begin(), subPluginKeys.end(),
 				[](const auto& l, const auto& r)
 				{
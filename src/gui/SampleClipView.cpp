@@ -36,8 +36,7 @@
 
 SampleClipView::SampleClipView( SampleClip * _clip, TrackView * _tv ) :
 	ClipView( _clip, _tv ),
-	m_clip( _clip ),
-	m_paintPixmap()
+	m_clip( _clip )
 {
 	// update UI and tooltip
 	updateSample();
@@ -33,10 +33,12 @@
 
 #include "AudioDeviceSetupWidget.h"
 #include "AudioEngine.h"
+#include "AudioEngineWorkerThread.h"
 #include "debug.h"
 #include "embed.h"
 #include "Engine.h"
 #include "FileDialog.h"
+#include "GuiApplication.h"
 #include "gui_templates.h"
 #include "MainWindow.h"
 #include "MidiSetupWidget.h"
@@ -131,19 +133,36 @@ SetupDialog::SetupDialog(ConfigTabs tab_to_open) :
 			"ui", "smoothscroll").toInt()),
 	m_animateAFP(ConfigManager::inst()->value(
 			"ui", "animateafp", "1").toInt()),
+	m_frameRate(ConfigManager::inst()->value(
+			"ui", "framerate").toInt()),
 	m_vstEmbedMethod(ConfigManager::inst()->vstEmbedMethod()),
 	m_vstAlwaysOnTop(ConfigManager::inst()->value(
 			"ui", "vstalwaysontop").toInt()),
 	m_syncVSTPlugins(ConfigManager::inst()->value(
 			"ui", "syncvstplugins", "1").toInt()),
+	m_pipelineRemotePlugins(ConfigManager::inst()->value(
+			"ui", "pipelineremoteplugins").toInt()),
+	m_shareRemoteProcesses(ConfigManager::inst()->value(
+			"ui", "shareremoteprocesses").toInt()),
 	m_disableAutoQuit(ConfigManager::inst()->value(
 			"ui", "disableautoquit", "1").toInt()),
 	m_NaNHandler(ConfigManager::inst()->value(
 			"app", "nanhandler", "1").toInt()),
 	m_hqAudioDev(ConfigManager::inst()->value(
 			"audioengine", "hqaudio").toInt()),
+	m_adaptiveVoiceLimit(ConfigManager::inst()->value(
+			"audioengine", "adaptivevoicelimit").toInt()),
 	m_bufferSize(ConfigManager::inst()->value(
 			"audioengine", "framesperaudiobuffer").toInt()),
+	m_latencyGovernor(ConfigManager::inst()->value(
+			"audioengine", "latencygovernor").toInt()),
+	m_workerSpinTime(ConfigManager::inst()->value(
+			"audioengine", "workerspintime",
+			QString::number(AudioEngineWorkerThread::DEFAULT_SPIN_TIME)).toInt()),
+	m_workerAffinity(ConfigManager::inst()->value(
+			"audioengine", "workeraffinity").toInt()),
+	m_workerRealtime(ConfigManager::inst()->value(
+			"audioengine", "workerrealtime").toInt()),
 	m_workingDir(QDir::toNativeSeparators(ConfigManager::inst()->workingDir())),
 	m_vstDir(QDir::toNativeSeparators(ConfigManager::inst()->vstDir())),
 	m_ladspaDir(QDir::toNativeSeparators(ConfigManager::inst()->ladspaDir())),
@@ -387,7 +406,26 @@ SetupDialog::SetupDialog(ConfigTabs tab_to_open) :
 	addLedCheckBox(tr("Display playback cursor in AudioFileProcessor"), ui_fx_tw, counter,
 		m_animateAFP, SLOT(toggleAnimateAFP(bool)), false);
 
-	ui_fx_tw->setFixedHeight(YDelta + YDelta * counter);
+	m_frameRateSlider = new QSlider(Qt::Horizontal, ui_fx_tw);
+	m_frameRateSlider->setRange(MainWindow::MIN_FRAME_RATE / 5, MainWindow::MAX_FRAME_RATE / 5);
+	m_frameRateSlider->setTickInterval(2);
+	m_frameRateSlider->setPageStep(2);
+	m_frameRateSlider->setGeometry(10, YDelta * ++counter + 6, 340, 18);
+	m_frameRateSlider->setTickPosition(QSlider::TicksBelow);
+
+	connect(m_frameRateSlider, SIGNAL(valueChanged(int)),
+			this, SLOT(setFrameRate(int)));
+
+	m_frameRateLbl = new QLabel(ui_fx_tw);
+	m_frameRateLbl->setGeometry(10, YDelta * ++counter + 10, 340, 24);
+	if (m_frameRate < MainWindow::MIN_FRAME_RATE || m_frameRate > MainWindow::MAX_FRAME_RATE)
+	{
+		m_frameRate = MainWindow::DEFAULT_FRAME_RATE;
+	}
+	m_frameRateSlider->setValue(m_frameRate / 5);
+	setFrameRate(m_frameRateSlider->value());
+
+	ui_fx_tw->setFixedHeight(YDelta + YDelta * counter + 20);
 
 
 	counter = 0;
@@ -434,6 +472,12 @@ SetupDialog::SetupDialog(ConfigTabs tab_to_open) :
 	addLedCheckBox(tr("Sync VST plugins to host playback"), plugins_tw, counter,
 		m_syncVSTPlugins, SLOT(toggleSyncVSTPlugins(bool)), false);
 
+	addLedCheckBox(tr("Let VST and ZynAddSubFX plugins run one period behind"), plugins_tw, counter,
+		m_pipelineRemotePlugins, SLOT(togglePipelineRemotePlugins(bool)), false);
+
+	addLedCheckBox(tr("Run all ZynAddSubFX instances in one process"), plugins_tw, counter,
+		m_shareRemoteProcesses, SLOT(toggleShareRemoteProcesses(bool)), false);
+
 	addLedCheckBox(tr("Keep effects running even without input"), plugins_tw, counter,
 		m_disableAutoQuit, SLOT(toggleDisableAutoQuit(bool)), false);
 
@@ -563,10 +607,119 @@ SetupDialog::SetupDialog(ConfigTabs tab_to_open) :
 			this, SLOT(toggleHQAudioDev(bool)));
 
 
+	// Panning law tab.
+	TabWidget * panLaw_tw = new TabWidget(
+			tr("Panning law"), audio_w);
+	panLaw_tw->setFixedHeight(56);
+
+	m_panLawComboBox = new QComboBox(panLaw_tw);
+	m_panLawComboBox->setGeometry(10, 20, 340, 22);
+	m_panLawComboBox->addItem(tr("Linear, 0 dB at the center"),
+			static_cast<int>(MixHelpers::PanLaw::Linear));
+	m_panLawComboBox->addItem(tr("Constant power, -3 dB at the center"),
+			static_cast<int>(MixHelpers::PanLaw::ConstantPower));
+	m_panLawComboBox->addItem(tr("Constant power, 0 dB at the center"),
+			static_cast<int>(MixHelpers::PanLaw::ConstantPowerUnityCenter));
+	m_panLawComboBox->setCurrentIndex(m_panLawComboBox->findData(
+			static_cast<int>(Engine::audioEngine()->panLaw())));
+	ToolTip::add(m_panLawComboBox,
+			tr("How the panning knobs of the tracks distribute the sound "
+				"between the left and the right channel."));
+
+
+	// LFO control rate tab.
+	TabWidget * lfoInterval_tw = new TabWidget(
+			tr("Envelope/LFO control rate"), audio_w);
+	lfoInterval_tw->setFixedHeight(56);
+
+	m_lfoIntervalComboBox = new QComboBox(lfoInterval_tw);
+	m_lfoIntervalComboBox->setGeometry(10, 20, 340, 22);
+	m_lfoIntervalComboBox->addItem(tr("Every frame"), 1);
+	m_lfoIntervalComboBox->addItem(tr("Every 8 frames"), 8);
+	m_lfoIntervalComboBox->addItem(tr("Every 32 frames"), 32);
+	const int lfoIntervalIndex = m_lfoIntervalComboBox->findData(
+			Engine::audioEngine()->lfoControlInterval());
+	m_lfoIntervalComboBox->setCurrentIndex(qMax(lfoIntervalIndex, 0));
+	ToolTip::add(m_lfoIntervalComboBox,
+			tr("How often the LFOs of the instruments are computed. "
+				"Lower rates save CPU time, the values in between "
+				"are interpolated."));
+
+
+	// Filter control rate tab.
+	TabWidget * filterInterval_tw = new TabWidget(
+			tr("Filter control rate"), audio_w);
+	filterInterval_tw->setFixedHeight(56);
+
+	m_filterIntervalComboBox = new QComboBox(filterInterval_tw);
+	m_filterIntervalComboBox->setGeometry(10, 20, 340, 22);
+	m_filterIntervalComboBox->addItem(tr("Every frame"), 1);
+	m_filterIntervalComboBox->addItem(tr("Every 8 frames"), 8);
+	m_filterIntervalComboBox->addItem(tr("Every 32 frames"), 32);
+	const int filterIntervalIndex = m_filterIntervalComboBox->findData(
+			Engine::audioEngine()->filterControlInterval());
+	m_filterIntervalComboBox->setCurrentIndex(qMax(filterIntervalIndex, 0));
+	ToolTip::add(m_filterIntervalComboBox,
+			tr("How often filters with automated cutoff or resonance "
+				"compute their coefficients. Lower rates save CPU "
+				"time."));
+
+
+	// Automation control rate tab.
+	TabWidget * automationInterval_tw = new TabWidget(
+			tr("Automation control rate"), audio_w);
+	automationInterval_tw->setFixedHeight(56);
+
+	m_automationIntervalComboBox = new QComboBox(automationInterval_tw);
+	m_automationIntervalComboBox->setGeometry(10, 20, 340, 22);
+	m_automationIntervalComboBox->addItem(tr("Every frame"), 1);
+	m_automationIntervalComboBox->addItem(tr("Every 8 frames"), 8);
+	m_automationIntervalComboBox->addItem(tr("Every 32 frames"), 32);
+	const int automationIntervalIndex = m_automationIntervalComboBox->findData(
+			Engine::audioEngine()->automationControlInterval());
+	m_automationIntervalComboBox->setCurrentIndex(qMax(automationIntervalIndex, 0));
+	ToolTip::add(m_automationIntervalComboBox,
+			tr("How often automated volumes, panning and mixer sends "
+				"change while they move. Lower rates save CPU time, "
+				"changes still start at the exact frame."));
+
+
+	// Voice limit tab.
+	TabWidget * voiceLimit_tw = new TabWidget(
+			tr("Voice limit"), audio_w);
+	voiceLimit_tw->setFixedHeight(80);
+
+	m_voiceLimitComboBox = new QComboBox(voiceLimit_tw);
+	m_voiceLimitComboBox->setGeometry(10, 20, 340, 22);
+	m_voiceLimitComboBox->addItem(tr("No limit"), 0);
+	for (int voices : {64, 128, 256, 512})
+	{
+		m_voiceLimitComboBox->addItem(tr("%1 voices").arg(voices), voices);
+	}
+	const int voiceLimitIndex = m_voiceLimitComboBox->findData(
+			Engine::audioEngine()->voiceLimiter().limit());
+	m_voiceLimitComboBox->setCurrentIndex(qMax(voiceLimitIndex, 0));
+	ToolTip::add(m_voiceLimitComboBox,
+			tr("The number of notes all instruments play at most. More "
+				"notes stop the released and then the oldest ones, which "
+				"fade out quickly. The instrument tracks have limits of "
+				"their own too."));
+
+	LedCheckBox * adaptiveVoiceLimit = new LedCheckBox(
+			tr("Lower the limit when the CPU can't keep up"), voiceLimit_tw);
+	adaptiveVoiceLimit->move(10, 54);
+	adaptiveVoiceLimit->setChecked(m_adaptiveVoiceLimit);
+	ToolTip::add(adaptiveVoiceLimit,
+			tr("Fewer notes are played while the CPU load is high, and "
+				"more again once it went down. Exports aren't affected."));
+	connect(adaptiveVoiceLimit, SIGNAL(toggled(bool)),
+			this, SLOT(toggleAdaptiveVoiceLimit(bool)));
+
+
 	// Buffer size tab.
 	TabWidget * bufferSize_tw = new TabWidget(
 			tr("Buffer size"), audio_w);
-	bufferSize_tw->setFixedHeight(76);
+	bufferSize_tw->setFixedHeight(98);
 
 	m_bufferSizeSlider = new QSlider(Qt::Horizontal, bufferSize_tw);
 	m_bufferSizeSlider->setRange(1, 128);
@@ -593,12 +746,76 @@ SetupDialog::SetupDialog(ConfigTabs tab_to_open) :
 	ToolTip::add(bufferSize_reset_btn,
 			tr("Reset to default value"));
 
+	LedCheckBox * latencyGovernor = new LedCheckBox(
+			tr("Raise the latency when the CPU can't keep up"), bufferSize_tw);
+	latencyGovernor->move(10, 74);
+	latencyGovernor->setChecked(m_latencyGovernor);
+	ToolTip::add(latencyGovernor,
+			tr("More periods are queued for the audio device while periods "
+				"are late or the device reports xruns, and less again once "
+				"the load has been low for a while."));
+	connect(latencyGovernor, SIGNAL(toggled(bool)),
+			this, SLOT(toggleLatencyGovernor(bool)));
+	connect(latencyGovernor, SIGNAL(toggled(bool)),
+			this, SLOT(showRestartWarning()));
+
+
+	// Worker threads tab.
+	TabWidget * workers_tw = new TabWidget(
+			tr("Worker threads"), audio_w);
+	workers_tw->setFixedHeight(118);
+
+	m_workerSpinTimeSlider = new QSlider(Qt::Horizontal, workers_tw);
+	m_workerSpinTimeSlider->setRange(0, AudioEngineWorkerThread::MAX_SPIN_TIME / 50);
+	m_workerSpinTimeSlider->setTickInterval(2);
+	m_workerSpinTimeSlider->setPageStep(2);
+	m_workerSpinTimeSlider->setValue(m_workerSpinTime / 50);
+	m_workerSpinTimeSlider->setGeometry(10, 18, 340, 18);
+	m_workerSpinTimeSlider->setTickPosition(QSlider::TicksBelow);
+	ToolTip::add(m_workerSpinTimeSlider,
+			tr("Idle worker threads wait this long for more work before "
+				"they go to sleep. Longer times lower the latency at small "
+				"buffer sizes but use more CPU time."));
+
+	connect(m_workerSpinTimeSlider, SIGNAL(valueChanged(int)),
+			this, SLOT(setWorkerSpinTime(int)));
+	connect(m_workerSpinTimeSlider, SIGNAL(valueChanged(int)),
+			this, SLOT(showRestartWarning()));
+
+	m_workerSpinTimeLbl = new QLabel(workers_tw);
+	m_workerSpinTimeLbl->setGeometry(10, 40, 200, 18);
+	setWorkerSpinTime(m_workerSpinTimeSlider->value());
+
+	LedCheckBox * workerAffinity = new LedCheckBox(
+			tr("Pin worker threads to CPU cores"), workers_tw);
+	workerAffinity->move(10, 66);
+	workerAffinity->setChecked(m_workerAffinity);
+	connect(workerAffinity, SIGNAL(toggled(bool)),
+			this, SLOT(toggleWorkerAffinity(bool)));
+	connect(workerAffinity, SIGNAL(toggled(bool)),
+			this, SLOT(showRestartWarning()));
+
+	LedCheckBox * workerRealtime = new LedCheckBox(
+			tr("Use realtime priority for worker threads"), workers_tw);
+	workerRealtime->move(10, 88);
+	workerRealtime->setChecked(m_workerRealtime);
+	connect(workerRealtime, SIGNAL(toggled(bool)),
+			this, SLOT(toggleWorkerRealtime(bool)));
+	connect(workerRealtime, SIGNAL(toggled(bool)),
+			this, SLOT(showRestartWarning()));
+
 
 	// Audio layout ordering.
 	audio_layout->addWidget(audioiface_tw);
 	audio_layout->addWidget(as_w);
 	audio_layout->addWidget(hqaudio);
+	audio_layout->addWidget(panLaw_tw);
+	audio_layout->addWidget(lfoInterval_tw);
+	audio_layout->addWidget(filterInterval_tw);
+	audio_layout->addWidget(automationInterval_tw);
+	audio_layout->addWidget(voiceLimit_tw);
 	audio_layout->addWidget(bufferSize_tw);
+	audio_layout->addWidget(workers_tw);
 	audio_layout->addStretch();
 
 
@@ -942,12 +1159,18 @@ void SetupDialog::accept()
 					QString::number(m_smoothScroll));
 	ConfigManager::inst()->setValue("ui", "animateafp",
 					QString::number(m_animateAFP));
+	ConfigManager::inst()->setValue("ui", "framerate",
+					QString::number(m_frameRate));
 	ConfigManager::inst()->setValue("ui", "vstembedmethod",
 					m_vstEmbedComboBox->currentData().toString());
 	ConfigManager::inst()->setValue("ui", "vstalwaysontop",
 					QString::number(m_vstAlwaysOnTop));
 	ConfigManager::inst()->setValue("ui", "syncvstplugins",
 					QString::number(m_syncVSTPlugins));
+	ConfigManager::inst()->setValue("ui", "pipelineremoteplugins",
+					QString::number(m_pipelineRemotePlugins));
+	ConfigManager::inst()->setValue("ui", "shareremoteprocesses",
+					QString::number(m_shareRemoteProcesses));
 	ConfigManager::inst()->setValue("ui", "disableautoquit",
 					QString::number(m_disableAutoQuit));
 	ConfigManager::inst()->setValue("audioengine", "audiodev",
@@ -956,8 +1179,39 @@ void SetupDialog::accept()
 					QString::number(m_NaNHandler));
 	ConfigManager::inst()->setValue("audioengine", "hqaudio",
 					QString::number(m_hqAudioDev));
+	ConfigManager::inst()->setValue("audioengine", "panlaw",
+					QString::number(m_panLawComboBox->currentData().toInt()));
+	Engine::audioEngine()->setPanLaw(static_cast<MixHelpers::PanLaw>(
+					m_panLawComboBox->currentData().toInt()));
+	ConfigManager::inst()->setValue("audioengine", "lfointerval",
+					QString::number(m_lfoIntervalComboBox->currentData().toInt()));
+	Engine::audioEngine()->setLfoControlInterval(
+					m_lfoIntervalComboBox->currentData().toInt());
+	ConfigManager::inst()->setValue("audioengine", "filterinterval",
+					QString::number(m_filterIntervalComboBox->currentData().toInt()));
+	Engine::audioEngine()->setFilterControlInterval(
+					m_filterIntervalComboBox->currentData().toInt());
+	ConfigManager::inst()->setValue("audioengine", "automationinterval",
+					QString::number(m_automationIntervalComboBox->currentData().toInt()));
+	Engine::audioEngine()->setAutomationControlInterval(
+					m_automationIntervalComboBox->currentData().toInt());
+	ConfigManager::inst()->setValue("audioengine", "voicelimit",
+					QString::number(m_voiceLimitComboBox->currentData().toInt()));
+	ConfigManager::inst()->setValue("audioengine", "adaptivevoicelimit",
+					QString::number(m_adaptiveVoiceLimit));
+	Engine::audioEngine()->voiceLimiter().setLimit(
+					m_voiceLimitComboBox->currentData().toInt());
+	Engine::audioEngine()->voiceLimiter().setAdaptive(m_adaptiveVoiceLimit);
 	ConfigManager::inst()->setValue("audioengine", "framesperaudiobuffer",
 					QString::number(m_bufferSize));
+	ConfigManager::inst()->setValue("audioengine", "latencygovernor",
+					QString::number(m_latencyGovernor));
+	ConfigManager::inst()->setValue("audioengine", "workerspintime",
+					QString::number(m_workerSpinTime));
+	ConfigManager::inst()->setValue("audioengine", "workeraffinity",
+					QString::number(m_workerAffinity));
+	ConfigManager::inst()->setValue("audioengine", "workerrealtime",
+					QString::number(m_workerRealtime));
 	ConfigManager::inst()->setValue("audioengine", "mididev",
 					m_midiIfaceNames[m_midiInterfaces->currentText()]);
 	ConfigManager::inst()->setValue("midi", "midiautoassign",
@@ -988,6 +1242,11 @@ void SetupDialog::accept()
 		it.value()->saveSettings();
 	}
 	ConfigManager::inst()->saveConfigFile();
+
+	if (getGUI() != nullptr && getGUI()->mainWindow() != nullptr)
+	{
+		getGUI()->mainWindow()->updateFrameRate();
+	}
 }
 
 
@@ -1128,12 +1387,32 @@ void SetupDialog::toggleAnimateAFP(bool enabled)
 }
 
 
+void SetupDialog::setFrameRate(int value)
+{
+	m_frameRate = value * 5;
+	m_frameRateLbl->setText(tr("Meter and display refresh rate: %1 fps")
+		.arg(m_frameRate));
+}
+
+
 void SetupDialog::toggleSyncVSTPlugins(bool enabled)
 {
 	m_syncVSTPlugins = enabled;
 }
 
 
+void SetupDialog::togglePipelineRemotePlugins(bool enabled)
+{
+	m_pipelineRemotePlugins = enabled;
+}
+
+
+void SetupDialog::toggleShareRemoteProcesses(bool enabled)
+{
+	m_shareRemoteProcesses = enabled;
+}
+
+
 void SetupDialog::vstEmbedMethodChanged()
 {
 	m_vstEmbedMethod = m_vstEmbedComboBox->currentData().toString();
@@ -1209,6 +1488,39 @@ void SetupDialog::resetBufferSize()
 }
 
 
+void SetupDialog::toggleLatencyGovernor(bool enabled)
+{
+	m_latencyGovernor = enabled;
+}
+
+
+void SetupDialog::toggleAdaptiveVoiceLimit(bool enabled)
+{
+	m_adaptiveVoiceLimit = enabled;
+}
+
+
+void SetupDialog::setWorkerSpinTime(int value)
+{
+	m_workerSpinTime = value * 50;
+	m_workerSpinTimeLbl->setText(m_workerSpinTime == 0
+		? tr("Spin time: off")
+		: tr("Spin time: %1 microseconds").arg(m_workerSpinTime));
+}
+
+
+void SetupDialog::toggleWorkerAffinity(bool enabled)
+{
+	m_workerAffinity = enabled;
+}
+
+
+void SetupDialog::toggleWorkerRealtime(bool enabled)
+{
+	m_workerRealtime = enabled;
+}
+
+
 // MIDI settings slots.
 
 void SetupDialog::midiInterfaceChanged(const QString & iface)
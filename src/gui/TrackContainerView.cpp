@@ -27,6 +27,7 @@
 #include <cmath>
 
 #include <QApplication>
+#include <QElapsedTimer>
 #include <QLayout>
 #include <QMdiArea>
 #include <QScrollBar>
@@ -85,8 +86,13 @@ TrackContainerView::TrackContainerView( TrackContainer * _tc ) :
 	connect( Engine::getSong(), SIGNAL( timeSignatureChanged( int, int ) ),
 						this, SLOT( realignTracks() ) );
 	connect( m_tc, SIGNAL( trackAdded( Track * ) ),
-			this, SLOT( createTrackView( Track * ) ),
+			this, SLOT( queueTrackView( Track * ) ),
 			Qt::QueuedConnection );
+
+	m_trackViewTimer.setSingleShot( true );
+	m_trackViewTimer.setInterval( 0 );
+	connect( &m_trackViewTimer, SIGNAL( timeout() ),
+			this, SLOT( createQueuedTrackViews() ) );
 }
 
 
@@ -260,6 +266,43 @@ TrackView * TrackContainerView::createTrackView( Track * _t )
 
 
 
+void TrackContainerView::queueTrackView( Track * _t )
+{
+	m_queuedTracks.push_back( _t );
+	if( !m_trackViewTimer.isActive() )
+	{
+		m_trackViewTimer.start();
+	}
+}
+
+
+
+
+void TrackContainerView::createQueuedTrackViews()
+{
+	// the tracks of a project can be played while their views are built,
+	// a batch is kept short enough not to stall the GUI
+	const qint64 budget = 15; // ms
+	QElapsedTimer elapsed;
+	elapsed.start();
+	while( !m_queuedTracks.isEmpty() && elapsed.elapsed() < budget )
+	{
+		// null if the track was deleted before its turn
+		Track * t = m_queuedTracks.takeFirst();
+		if( t != nullptr )
+		{
+			createTrackView( t );
+		}
+	}
+	if( !m_queuedTracks.isEmpty() )
+	{
+		m_trackViewTimer.start();
+	}
+}
+
+
+
+
 void TrackContainerView::deleteTrackView( TrackView * _tv )
 {
 	//m_tc->addJournalCheckPoint();
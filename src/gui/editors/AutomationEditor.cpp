@@ -27,6 +27,7 @@
 
 #include "AutomationEditor.h"
 
+#include <climits>
 #include <cmath>
 
 #include <QApplication>
@@ -1145,32 +1146,63 @@ void AutomationEditor::paintEvent(QPaintEvent * pe )
 		//Don't bother doing/rendering anything if there is no automation points
 		if( time_map.size() > 0 )
 		{
-			timeMap::iterator it = time_map.begin();
-			while( it+1 != time_map.end() )
+			// start with the section that reaches into the visible area
+			const int firstTick = m_currentPosition - VALUES_WIDTH * TimePos::ticksPerBar() / m_ppb;
+			timeMap::iterator it = time_map.upperBound( firstTick );
+			if( it != time_map.begin() )
+			{
+				--it;
+			}
+
+			// Recorded automation can have many nodes per pixel when zoomed
+			// out, so the outline only keeps the first, lowest, highest and
+			// last point in each pixel column. The polygon then traces the
+			// values of all visible sections, which are filled at once.
+			QPolygonF outline;
+			int column = INT_MIN;
+			float first = 0, lowest = 0, highest = 0, last = 0;
+			auto flushColumn = [&]()
 			{
-				// skip this section if it occurs completely before the
-				// visible area
-				int next_x = xCoordOfTick(POS(it+1));
-				if( next_x < 0 )
+				if( column != INT_MIN )
 				{
-					++it;
-					continue;
+					outline << QPointF( column, first ) << QPointF( column, lowest )
+						<< QPointF( column, highest ) << QPointF( column, last );
 				}
-
+			};
+			auto addPoint = [&]( int x, float y )
+			{
+				if( x != column )
+				{
+					flushColumn();
+					column = x;
+					first = lowest = highest = y;
+				}
+				lowest = qMin( lowest, y );
+				highest = qMax( highest, y );
+				last = y;
+			};
+
+			// a curve needs a point per pixel, straight sections only their ends
+			const int ticksPerPixel = qMax( 1, TimePos::ticksPerBar() / m_ppb );
+			const bool curved = m_clip->progressionType() == AutomationClip::CubicHermiteProgression;
+
+			QVector<timeMap::iterator> points;
+			int lastPointX = INT_MIN;
+			const int startX = xCoordOfTick( POS(it) );
+			while( it+1 != time_map.end() )
+			{
 				int x = xCoordOfTick(POS(it));
 				if( x > width() )
 				{
 					break;
 				}
 
-				float *values = m_clip->valuesAfter(POS(it));
-
-				// We are creating a path to draw a polygon representing the values between two
-				// nodes. When we have two nodes with discrete progression, we will basically have
-				// a rectangle with the outValue of the first node (that's why nextValue will match
-				// the outValue of the current node). When we have nodes with linear or cubic progression
-				// the value of the end of the shape between the two nodes will be the inValue of
-				// the next node.
+				// We are tracing the values between two nodes. When we have two nodes with
+				// discrete progression, we will basically have a rectangle with the outValue
+				// of the first node (that's why nextValue will match the outValue of the
+				// current node). When we have nodes with linear or cubic progression the value
+				// of the end of the shape between the two nodes will be the inValue of the
+				// next node.
 				float nextValue;
 				if( m_clip->progressionType() == AutomationClip::DiscreteProgression )
 				{
@@ -1181,38 +1213,50 @@ void AutomationEditor::paintEvent(QPaintEvent * pe )
 					nextValue = INVAL(it + 1);
 				}
 
-				p.setRenderHints( QPainter::Antialiasing, true );
-				QPainterPath path;
-				path.moveTo(QPointF(xCoordOfTick(POS(it)), yCoordOfLevel(0)));
-				for (int i = 0; i < POS(it + 1) - POS(it); i++)
+				addPoint( x, yCoordOfLevel( INVAL(it) ) );
+				const int length = POS(it + 1) - POS(it);
+				for( int i = 1; i < length; i += curved ? ticksPerPixel : length )
 				{
-					path.lineTo(QPointF(xCoordOfTick(POS(it) + i), yCoordOfLevel(values[i])));
+					addPoint( xCoordOfTick( POS(it) + i ),
+						yCoordOfLevel( m_clip->valueAt( POS(it) + i ) ) );
 				}
-				path.lineTo(QPointF(xCoordOfTick(POS(it + 1)), yCoordOfLevel(nextValue)));
-				path.lineTo(QPointF(xCoordOfTick(POS(it + 1)), yCoordOfLevel(0)));
-				path.lineTo(QPointF(xCoordOfTick(POS(it)), yCoordOfLevel(0)));
-				p.fillPath(path, m_graphColor);
-				p.setRenderHints( QPainter::Antialiasing, false );
-				delete [] values;
+				addPoint( xCoordOfTick( POS(it + 1) ), yCoordOfLevel( nextValue ) );
 
-				// Draw circle
-				drawAutomationPoint(p, it);
+				// circles of nodes in the same pixel column would just cover each other
+				if( x != lastPointX )
+				{
+					points.push_back( it );
+					lastPointX = x;
+				}
 
 				++it;
 			}
+			flushColumn();
+
+			if( !outline.isEmpty() )
+			{
+				outline << QPointF( outline.last().x(), yCoordOfLevel(0) )
+					<< QPointF( startX, yCoordOfLevel(0) );
+				QPainterPath path;
+				path.addPolygon( outline );
+				p.setRenderHints( QPainter::Antialiasing, true );
+				p.fillPath( path, m_graphColor );
+				p.setRenderHints( QPainter::Antialiasing, false );
+			}
+
+			// Draws the rectangle representing the value after the last node (for
+			// that reason we use outValue).
+			if( it+1 == time_map.end() )
+			{
+				drawLevelFrom( p, POS(it), OUTVAL(it) );
+				points.push_back( it );
+			}
 
-			for (
-				int i = POS(it), x = xCoordOfTick(i);
-				x <= width();
-				i++, x = xCoordOfTick(i)
-			)
+			// Draw circles
+			for( timeMap::iterator point : points )
 			{
-				// Draws the rectangle representing the value after the last node (for
-				// that reason we use outValue).
-				drawLevelTick(p, i, OUTVAL(it));
+				drawAutomationPoint( p, point );
 			}
-			// Draw circle(the last one)
-			drawAutomationPoint(p, it);
 		}
 	}
 	else
@@ -1303,11 +1347,12 @@ float AutomationEditor::yCoordOfLevel(float level )
 
 
 
-void AutomationEditor::drawLevelTick(QPainter & p, int tick, float value)
+// draws the level from the tick to the end of the view
+void AutomationEditor::drawLevelFrom(QPainter & p, int tick, float value)
 {
 	int grid_bottom = height() - SCROLLBAR_SIZE - 1;
 	const int x = xCoordOfTick( tick );
-	int rect_width = xCoordOfTick( tick+1 ) - x;
+	int rect_width = width() - x;
 
 	// is the level in visible area?
 	if( ( value >= m_bottomLevel && value <= m_topLevel )
@@ -45,8 +45,11 @@
 #define __USE_XOPEN
 #endif
 
+#include <algorithm>
 #include <math.h>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "AutomationEditor.h"
 #include "ActionGroup.h"
@@ -130,6 +133,54 @@ static QString getNoteString(int key)
 	return s_noteStrings[key % 12] + QString::number(static_cast<int>(FirstOctave + key / KeysPerOctave));
 }
 
+
+//! Notes on the clipboard, which are pasted without writing and parsing
+//! their XML within this instance
+class NoteClipboardPayload : public Clipboard::Payload
+{
+public:
+	struct CopiedNote
+	{
+		TimePos pos;
+		TimePos length;
+		int key;
+		volume_t volume;
+		panning_t panning;
+	} ;
+
+	void add(const Note & note, const TimePos & startPos)
+	{
+		m_notes.push_back({note.pos(startPos), note.length(), note.key(),
+					note.getVolume(), note.getPanning()});
+	}
+
+	std::vector<Note> notes() const
+	{
+		std::vector<Note> notes;
+		notes.reserve(m_notes.size());
+		for (const CopiedNote & n : m_notes)
+		{
+			notes.emplace_back(n.length, n.pos, n.key, n.volume, n.panning);
+		}
+		return notes;
+	}
+
+	QString toString() const override
+	{
+		DataFile dataFile(DataFile::ClipboardData);
+		QDomElement noteList = dataFile.createElement("note-list");
+		dataFile.content().appendChild(noteList);
+		for (Note & note : notes())
+		{
+			note.saveState(dataFile, noteList);
+		}
+		return dataFile.toString();
+	}
+
+private:
+	std::vector<CopiedNote> m_notes;
+} ;
+
 // used for drawing of piano
 PianoRoll::PianoRollKeyTypes PianoRoll::prKeyOrder[] =
 {
@@ -907,7 +958,7 @@ void PianoRoll::setCurrentMidiClip( MidiClip* newMidiClip )
 	connect( m_midiClip->instrumentTrack(), SIGNAL( midiNoteOn( const Note& ) ), this, SLOT( startRecordNote( const Note& ) ) );
 	connect( m_midiClip->instrumentTrack(), SIGNAL( midiNoteOff( const Note& ) ), this, SLOT( finishRecordNote( const Note& ) ) );
 	connect( m_midiClip, SIGNAL(dataChanged()), this, SLOT(update()));
-	connect( m_midiClip->instrumentTrack()->pianoModel(), SIGNAL( dataChanged() ), this, SLOT( update() ) );
+	connect( m_midiClip->instrumentTrack()->pianoModel(), SIGNAL( dataChanged() ), this, SLOT( updatePianoKeys() ) );
 
 	connect(m_midiClip->instrumentTrack()->firstKeyModel(), SIGNAL(dataChanged()), this, SLOT(update()));
 	connect(m_midiClip->instrumentTrack()->lastKeyModel(), SIGNAL(dataChanged()), this, SLOT(update()));
@@ -3106,19 +3157,93 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 				(tick - m_currentPosition) * m_ppb / TimePos::ticksPerBar()
 			);
 		};
-		p.setPen(m_lineColor);
-		for (tick = m_currentPosition - m_currentPosition % q,
-			x = xCoordOfTick(tick);
-			x <= width();
-			tick += q, x = xCoordOfTick(tick))
+		const int topKeyLine = keyAreaTop() + m_keyLineHeight - 1;
+		const int lastKey = qMax(0, topKey - m_pianoKeysVisible);
+
+		// the grid only changes with scrolling, zooming and resizing, so
+		// it's kept in a pixmap and just copied while keys light up
+		const TimeSig timeSig(Engine::getSong()->getTimeSigModel());
+		const GridLayout gridLayout = std::make_tuple(size(), devicePixelRatioF(),
+			static_cast<int>(m_currentPosition), m_startKey, m_zoomingModel.value(), m_keyLineHeight,
+			m_pianoKeysVisible, m_notesEditHeight, m_whiteKeyWidth, q,
+			timeSig.numerator(), timeSig.denominator());
+		if (m_gridCache.isNull() || gridLayout != m_gridLayout)
 		{
-			p.drawLine(x, keyAreaTop(), x, noteEditBottom());
+			m_gridLayout = gridLayout;
+			m_gridCache = QPixmap(size() * devicePixelRatioF());
+			m_gridCache.setDevicePixelRatio(devicePixelRatioF());
+			QPainter g(&m_gridCache);
+			g.fillRect(0, 0, width(), height(), bgColor);
+
+			// draw vertical quantization lines
+			g.setPen(m_lineColor);
+			for (tick = m_currentPosition - m_currentPosition % q,
+				x = xCoordOfTick(tick);
+				x <= width();
+				tick += q, x = xCoordOfTick(tick))
+			{
+				g.drawLine(x, keyAreaTop(), x, noteEditBottom());
+			}
+
+			// draw horizontal grid lines, one below each key
+			g.setClipRect(0, keyAreaTop(), width(), keyAreaBottom() - keyAreaTop());
+			for (int key = topKey, y = topKeyLine; key >= lastKey; --key, y += m_keyLineHeight)
+			{
+				g.setPen(key % KeysPerOctave == Key_C ? m_beatLineColor : m_lineColor);
+				g.drawLine(m_whiteKeyWidth, y, width(), y);
+			}
+
+			// don't draw over keys
+			g.setClipRect(m_whiteKeyWidth, keyAreaTop(), width(), noteEditBottom() - keyAreaTop());
+
+			// draw alternating shading on bars
+			float timeSignature = static_cast<float>(timeSig.numerator()) /
+				static_cast<float>(timeSig.denominator());
+			float zoomFactor = m_zoomLevels[m_zoomingModel.value()];
+			//the bars which disappears at the left side by scrolling
+			int leftBars = m_currentPosition * zoomFactor / TimePos::ticksPerBar();
+			//iterates the visible bars and draw the shading on uneven bars
+			for (int x = m_whiteKeyWidth, barCount = leftBars;
+				x < width() + m_currentPosition * zoomFactor / timeSignature;
+				x += m_ppb, ++barCount)
+			{
+				if ((barCount + leftBars) % 2 != 0)
+				{
+					g.fillRect(x - m_currentPosition * zoomFactor / timeSignature,
+						PR_TOP_MARGIN,
+						m_ppb,
+						height() - (PR_BOTTOM_MARGIN + PR_TOP_MARGIN),
+						m_backgroundShade);
+				}
+			}
+
+			// draw vertical beat lines
+			int ticksPerBeat = DefaultTicksPerBar / timeSig.denominator();
+			g.setPen(m_beatLineColor);
+			for(tick = m_currentPosition - m_currentPosition % ticksPerBeat,
+				x = xCoordOfTick( tick );
+				x <= width();
+				tick += ticksPerBeat, x = xCoordOfTick(tick))
+			{
+				g.drawLine(x, PR_TOP_MARGIN, x, noteEditBottom());
+			}
+
+			// draw vertical bar lines
+			g.setPen(m_barLineColor);
+			for(tick = m_currentPosition - m_currentPosition % TimePos::ticksPerBar(),
+				x = xCoordOfTick( tick );
+				x <= width();
+				tick += TimePos::ticksPerBar(), x = xCoordOfTick(tick))
+			{
+				g.drawLine(x, PR_TOP_MARGIN, x, noteEditBottom());
+			}
 		}
+		p.drawPixmap(0, 0, m_gridCache);
 
-		// draw horizontal grid lines and piano notes
+		// draw piano notes
 		p.setClipRect(0, keyAreaTop(), width(), keyAreaBottom() - keyAreaTop());
 		// the first grid line from the top Y position
-		int grid_line_y = keyAreaTop() + m_keyLineHeight - 1;
+		int grid_line_y = topKeyLine;
 
 		// lambda function for returning the height of a key
 		auto keyHeight = [&](
@@ -3231,16 +3356,6 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 				p.drawText(textRect, Qt::AlignRight | Qt::AlignHCenter, noteString);
 			}
 		};
-		// lambda for drawing the horizontal grid line
-		auto drawHorizontalLine = [&](
-			const int key,
-			const int y
-		)
-		{
-			if (key % KeysPerOctave == Key_C) { p.setPen(m_beatLineColor); }
-			else { p.setPen(m_lineColor); }
-			p.drawLine(m_whiteKeyWidth, y, width(), y);
-		};
 		// correct y offset of the top key
 		switch (prKeyOrder[topNote])
 		{
@@ -3252,24 +3367,20 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 			drawKey(topKey + 1, grid_line_y - m_keyLineHeight);
 		}
 		// loop through visible keys
-		const int lastKey = qMax(0, topKey - m_pianoKeysVisible);
 		for (int key = topKey; key > lastKey; --key)
 		{
 			bool whiteKey = Piano::isWhiteKey(key);
 			if (whiteKey)
 			{
 				drawKey(key, grid_line_y);
-				drawHorizontalLine(key, grid_line_y);
 				grid_line_y += m_keyLineHeight;
 			}
 			else
 			{
 				// draw next white key
 				drawKey(key - 1, grid_line_y + m_keyLineHeight);
-				drawHorizontalLine(key - 1, grid_line_y + m_keyLineHeight);
 				// draw black key over previous and next white key
 				drawKey(key, grid_line_y);
-				drawHorizontalLine(key, grid_line_y);
 				// drew two grid keys so skip ahead properly
 				grid_line_y += m_keyLineHeight + m_keyLineHeight;
 				// capture double key draw
@@ -3280,50 +3391,6 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 		// don't draw over keys
 		p.setClipRect(m_whiteKeyWidth, keyAreaTop(), width(), noteEditBottom() - keyAreaTop());
 
-		// draw alternating shading on bars
-		float timeSignature =
-			static_cast<float>(Engine::getSong()->getTimeSigModel().getNumerator()) /
-			static_cast<float>(Engine::getSong()->getTimeSigModel().getDenominator());
-		float zoomFactor = m_zoomLevels[m_zoomingModel.value()];
-		//the bars which disappears at the left side by scrolling
-		int leftBars = m_currentPosition * zoomFactor / TimePos::ticksPerBar();
-		//iterates the visible bars and draw the shading on uneven bars
-		for (int x = m_whiteKeyWidth, barCount = leftBars;
-			x < width() + m_currentPosition * zoomFactor / timeSignature;
-			x += m_ppb, ++barCount)
-		{
-			if ((barCount + leftBars) % 2 != 0)
-			{
-				p.fillRect(x - m_currentPosition * zoomFactor / timeSignature,
-					PR_TOP_MARGIN,
-					m_ppb,
-					height() - (PR_BOTTOM_MARGIN + PR_TOP_MARGIN),
-					m_backgroundShade);
-			}
-		}
-
-		// draw vertical beat lines
-		int ticksPerBeat = DefaultTicksPerBar /
-			Engine::getSong()->getTimeSigModel().getDenominator();
-		p.setPen(m_beatLineColor);
-		for(tick = m_currentPosition - m_currentPosition % ticksPerBeat,
-			x = xCoordOfTick( tick );
-			x <= width();
-			tick += ticksPerBeat, x = xCoordOfTick(tick))
-		{
-			p.drawLine(x, PR_TOP_MARGIN, x, noteEditBottom());
-		}
-
-		// draw vertical bar lines
-		p.setPen(m_barLineColor);
-		for(tick = m_currentPosition - m_currentPosition % TimePos::ticksPerBar(),
-			x = xCoordOfTick( tick );
-			x <= width();
-			tick += TimePos::ticksPerBar(), x = xCoordOfTick(tick))
-		{
-			p.drawLine(x, PR_TOP_MARGIN, x, noteEditBottom());
-		}
-
 		// draw marked semitones after the grid
 		for(x = 0; x < m_markedSemiTones.size(); ++x)
 		{
@@ -3384,7 +3451,21 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 	}
 
 	int y_base = keyAreaBottom() - 1;
-	if( hasValidMidiClip() )
+	if (!hasValidMidiClip())
+	{
+		QFont f = p.font();
+		f.setBold( true );
+		p.setFont( pointSize<14>( f ) );
+		p.setPen( QApplication::palette().color( QPalette::Active,
+							QPalette::BrightText ) );
+		p.drawText(m_whiteKeyWidth + 20, PR_TOP_MARGIN + 40,
+				tr( "Please open a clip by double-clicking "
+								"on it!" ) );
+	}
+	// while playing, usually just some keys light up, so skip the notes
+	// when only the keyboard needs repainting
+	else if (pe->region().intersects(QRect(m_whiteKeyWidth, PR_TOP_MARGIN,
+		width() - m_whiteKeyWidth, height() - PR_TOP_MARGIN)))
 	{
 		p.setClipRect(
 			m_whiteKeyWidth,
@@ -3605,17 +3686,6 @@ void PianoRoll::paintEvent(QPaintEvent * pe )
 		p.drawPoints( editHandles );
 
 	}
-	else
-	{
-		QFont f = p.font();
-		f.setBold( true );
-		p.setFont( pointSize<14>( f ) );
-		p.setPen( QApplication::palette().color( QPalette::Active,
-							QPalette::BrightText ) );
-		p.drawText(m_whiteKeyWidth + 20, PR_TOP_MARGIN + 40,
-				tr( "Please open a clip by double-clicking "
-								"on it!" ) );
-	}
 
 	p.setClipRect(
 		m_whiteKeyWidth,
@@ -3725,6 +3795,19 @@ void PianoRoll::updateScrollbars()
 	m_topBottomScroll->setValue(m_totalKeysToScroll - m_startKey);
 }
 
+void PianoRoll::changeEvent(QEvent* ev)
+{
+	// the grid's colors may have changed
+	if (ev->type() == QEvent::StyleChange)
+	{
+		m_gridCache = QPixmap();
+	}
+	QWidget::changeEvent(ev);
+}
+
+
+
+
 // responsible for moving/resizing scrollbars after window-resizing
 void PianoRoll::resizeEvent(QResizeEvent* re)
 {
@@ -4309,14 +4392,28 @@ void PianoRoll::updateYScroll()
 
 void PianoRoll::copyToClipboard( const NoteVector & notes ) const
 {
-	// For copyString() and MimeType enum class
+	// For copyString(), copyPayload() and MimeType enum class
 	using namespace Clipboard;
 
+	TimePos start_pos( notes.front()->pos().getBar(), 0 );
+
+	// detuning automation isn't kept by the payload
+	if( std::none_of( notes.begin(), notes.end(),
+			[]( const Note * note ) { return note->hasDetuningInfo(); } ) )
+	{
+		auto payload = std::make_unique<NoteClipboardPayload>();
+		for( const Note *note : notes )
+		{
+			payload->add( *note, start_pos );
+		}
+		copyPayload( std::move( payload ), MimeType::Default );
+		return;
+	}
+
 	DataFile dataFile( DataFile::ClipboardData );
 	QDomElement note_list = dataFile.createElement( "note-list" );
 	dataFile.content().appendChild( note_list );
 
-	TimePos start_pos( notes.front()->pos().getBar(), 0 );
 	for( const Note *note : notes )
 	{
 		Note clip_note( *note );
@@ -4377,7 +4474,7 @@ void PianoRoll::cutSelectedNotes()
 
 void PianoRoll::pasteNotes()
 {
-	// For getString() and MimeType enum class
+	// For getString(), getPayload() and MimeType enum class
 	using namespace Clipboard;
 
 	if( ! hasValidMidiClip() )
@@ -4385,42 +4482,51 @@ void PianoRoll::pasteNotes()
 		return;
 	}
 
-	QString value = getString( MimeType::Default );
-
-	if( ! value.isEmpty() )
+	std::vector<Note> notes;
+	auto payload = dynamic_cast<const NoteClipboardPayload *>( getPayload( getMimeData() ) );
+	if( payload != nullptr )
 	{
-		DataFile dataFile( value.toUtf8() );
-
-		QDomNodeList list = dataFile.elementsByTagName( Note::classNodeName() );
-
-		// remove selection and select the newly pasted notes
-		clearSelectedNotes();
-
-		if( ! list.isEmpty() )
+		notes = payload->notes();
+	}
+	else
+	{
+		// copied by another instance
+		QString value = getString( MimeType::Default );
+		if( value.isEmpty() )
 		{
-			m_midiClip->addJournalCheckPoint();
+			return;
 		}
 
+		DataFile dataFile( value.toUtf8() );
+		QDomNodeList list = dataFile.elementsByTagName( Note::classNodeName() );
 		for( int i = 0; ! list.item( i ).isNull(); ++i )
 		{
-			// create the note
-			Note cur_note;
-			cur_note.restoreState( list.item( i ).toElement() );
-			cur_note.setPos( cur_note.pos() + Note::quantized( m_timeLine->pos(), quantization() ) );
+			notes.emplace_back();
+			notes.back().restoreState( list.item( i ).toElement() );
+		}
+	}
 
-			// select it
-			cur_note.setSelected( true );
+	// remove selection and select the newly pasted notes
+	clearSelectedNotes();
 
-			// add to MIDI clip
-			m_midiClip->addNote( cur_note, false );
-		}
+	if( notes.empty() )
+	{
+		return;
+	}
 
-		// we only have to do the following lines if we pasted at
-		// least one note...
-		Engine::getSong()->setModified();
-		update();
-		getGUI()->songEditor()->update();
+	m_midiClip->addJournalCheckPoint();
+
+	const TimePos offset = Note::quantized( m_timeLine->pos(), quantization() );
+	for( Note & note : notes )
+	{
+		note.setPos( note.pos() + offset );
+		note.setSelected( true );
 	}
+	m_midiClip->addNotes( notes, false );
+
+	Engine::getSong()->setModified();
+	update();
+	getGUI()->songEditor()->update();
 }
 
 
@@ -4501,6 +4607,14 @@ void PianoRoll::updatePositionLineHeight()
 
 
 
+void PianoRoll::updatePianoKeys()
+{
+	update(0, keyAreaTop(), m_whiteKeyWidth, keyAreaBottom() - keyAreaTop());
+}
+
+
+
+
 void PianoRoll::updatePositionAccompany( const TimePos & t )
 {
 	Song * s = Engine::getSong();
@@ -30,6 +30,8 @@
 #include "CPULoadWidget.h"
 #include "embed.h"
 #include "Engine.h"
+#include "NotePlayHandle.h"
+#include "SampleCache.h"
 
 
 CPULoadWidget::CPULoadWidget( QWidget * _parent ) :
@@ -99,6 +101,37 @@ void CPULoadWidget::updateCpuLoad()
 		m_changed = true;
 		update();
 	}
+
+	const AudioEngineProfiler & profiler = Engine::audioEngine()->profiler();
+	setToolTip( tr( "CPU load: %1%\n"
+			"Skipped for silent buffers: %2 clears, %3 mixes, %4 peak scans\n"
+			"Notes playing: %5 (at most %6, %7 preallocated)\n"
+			"Jobs per stage: %8 (at most %9), job queue grown %10 times\n"
+			"Idle periods: %11, peak scans done while mixing: %12\n"
+			"Sample cache: %13 files, %14 MB (%15 MB saved by sharing)\n"
+			"Periods late: %16, xruns reported by the device: %17\n"
+			"Periods queued for the device: %18, input frames lost: %19\n"
+			"Periods effect chains slept: %20" )
+			.arg( m_currentLoad )
+			.arg( profiler.skipped( AudioEngineProfiler::SkippedWork::BufferClear ) )
+			.arg( profiler.skipped( AudioEngineProfiler::SkippedWork::Mix ) )
+			.arg( profiler.skipped( AudioEngineProfiler::SkippedWork::PeakScan ) )
+			.arg( NotePlayHandleManager::inUse() )
+			.arg( NotePlayHandleManager::highWaterMark() )
+			.arg( NotePlayHandleManager::capacity() )
+			.arg( profiler.jobQueueDepth() )
+			.arg( profiler.maxJobQueueDepth() )
+			.arg( profiler.jobQueueGrowths() )
+			.arg( profiler.skipped( AudioEngineProfiler::SkippedWork::Period ) )
+			.arg( profiler.skipped( AudioEngineProfiler::SkippedWork::FusedPeakScan ) )
+			.arg( SampleCache::files() )
+			.arg( SampleCache::bytes() / ( 1024.0 * 1024.0 ), 0, 'f', 1 )
+			.arg( SampleCache::bytesSaved() / ( 1024.0 * 1024.0 ), 0, 'f', 1 )
+			.arg( profiler.deadlineMisses() )
+			.arg( profiler.totalDeviceXruns() )
+			.arg( Engine::audioEngine()->outputPeriods() )
+			.arg( Engine::audioEngine()->lostInputFrames() )
+			.arg( profiler.skipped( AudioEngineProfiler::SkippedWork::EffectChain ) ) );
 }
 
 
@@ -92,30 +92,7 @@ EffectView::EffectView( Effect * _model, QWidget * _parent ) :
 		ctls_btn->setGeometry( 150, 14, 50, 20 );
 		connect( ctls_btn, SIGNAL( clicked() ),
 					this, SLOT( editControls() ) );
-
-		m_controlView = effect()->controls()->createView();
-		if( m_controlView )
-		{
-			m_subWindow = getGUI()->mainWindow()->addWindowedWidget( m_controlView );
-
-			if ( !m_controlView->isResizable() )
-			{
-				m_subWindow->setSizePolicy( QSizePolicy::Fixed, QSizePolicy::Fixed );
-				if (m_subWindow->layout())
-				{
-					m_subWindow->layout()->setSizeConstraint(QLayout::SetFixedSize);
-				}
-			}
-
-			Qt::WindowFlags flags = m_subWindow->windowFlags();
-			flags &= ~Qt::WindowMaximizeButtonHint;
-			m_subWindow->setWindowFlags( flags );
-
-			connect( m_controlView, SIGNAL( closed() ),
-					this, SLOT( closeEffects() ) );
-
-			m_subWindow->hide();
-		}
+		// the control dialog is only created when it's first shown
 	}
 
 
@@ -134,8 +111,42 @@ EffectView::~EffectView()
 
 
 
+void EffectView::createControlView()
+{
+	m_controlView = effect()->controls()->createView();
+	if( m_controlView )
+	{
+		m_subWindow = getGUI()->mainWindow()->addWindowedWidget( m_controlView );
+
+		if ( !m_controlView->isResizable() )
+		{
+			m_subWindow->setSizePolicy( QSizePolicy::Fixed, QSizePolicy::Fixed );
+			if (m_subWindow->layout())
+			{
+				m_subWindow->layout()->setSizeConstraint(QLayout::SetFixedSize);
+			}
+		}
+
+		Qt::WindowFlags flags = m_subWindow->windowFlags();
+		flags &= ~Qt::WindowMaximizeButtonHint;
+		m_subWindow->setWindowFlags( flags );
+
+		connect( m_controlView, SIGNAL( closed() ),
+				this, SLOT( closeEffects() ) );
+
+		m_subWindow->hide();
+	}
+}
+
+
+
+
 void EffectView::editControls()
 {
+	if( m_subWindow == nullptr )
+	{
+		createControlView();
+	}
 	if( m_subWindow )
 	{
 		if( !m_subWindow->isVisible() )
@@ -199,6 +210,22 @@ void EffectView::contextMenuEvent( QContextMenuEvent * )
 						tr( "Move &down" ),
 						this, SLOT( moveDown() ) );
 	contextMenu->addSeparator();
+	if( effect()->supportsOversampling() )
+	{
+		ComboBoxModel * oversampling = &effect()->m_oversamplingModel;
+		QMenu * oversamplingMenu = contextMenu->addMenu( tr( "&Oversampling" ) );
+		for( int stages = 0; stages < oversampling->size(); ++stages )
+		{
+			const QString text = stages == 0 ? oversampling->itemText( stages ) :
+				tr( "%1 (%2 frames latency)" ).arg( oversampling->itemText( stages ) )
+							.arg( Oversampler::latency( stages ) );
+			QAction * action = oversamplingMenu->addAction( text );
+			action->setCheckable( true );
+			action->setChecked( oversampling->value() == stages );
+			connect( action, &QAction::triggered, [oversampling, stages]() { oversampling->setValue( stages ); } );
+		}
+		contextMenu->addSeparator();
+	}
 	contextMenu->addAction( embed::getIconPixmap( "cancel" ),
 						tr( "&Remove this plugin" ),
 						this, SLOT( deletePlugin() ) );
@@ -280,6 +280,9 @@ void Fader::setPeak( float fPeak, float &targetPeak, float &persistentPeak, QEla
 		fPeak = m_fMaxPeak;
 	}
 
+	const int shownLevel = levelHeight( targetPeak );
+	const int shownMarker = peakMarker( persistentPeak );
+
 	if( targetPeak != fPeak)
 	{
 		targetPeak = fPeak;
@@ -288,12 +291,16 @@ void Fader::setPeak( float fPeak, float &targetPeak, float &persistentPeak, QEla
 			persistentPeak = targetPeak;
 			lastPeakTimer.restart();
 		}
-		update();
 	}
 
 	if( persistentPeak > 0 && lastPeakTimer.elapsed() > 1500 )
 	{
 		persistentPeak = qMax<float>( 0, persistentPeak-0.05 );
+	}
+
+	// meters get new peaks every frame, but most don't move a pixel
+	if( levelHeight( targetPeak ) != shownLevel || peakMarker( persistentPeak ) != shownMarker )
+	{
 		update();
 	}
 }
@@ -338,6 +345,39 @@ inline int Fader::calculateDisplayPeak( float fPeak )
 }
 
 
+
+int Fader::levelHeight( float fPeak )
+{
+	if( getLevelsDisplayedInDBFS() )
+	{
+		float const maxDB = ampToDbfs( m_fMaxPeak );
+		float const minDB = ampToDbfs( m_fMinPeak );
+		return m_back->height() * ( ampToDbfs( qMax<float>( 0.0001, fPeak ) ) - minDB ) / ( maxDB - minDB );
+	}
+	return calculateDisplayPeak( fPeak - m_fMinPeak );
+}
+
+
+
+
+int Fader::peakMarker( float fPeak )
+{
+	// the marker's height and color, which changes at these levels as well
+	int color;
+	if( getLevelsDisplayedInDBFS() )
+	{
+		float const peakDBFS = ampToDbfs( qMax<float>( 0.0001, fPeak ) );
+		color = peakDBFS <= ampToDbfs( m_fMinPeak ) ? 0 :
+			clips( fPeak ) ? 3 : peakDBFS >= -6 ? 2 : 1;
+	}
+	else
+	{
+		color = fPeak <= 0.05 ? 0 : clips( fPeak ) ? 3 : 1;
+	}
+	return levelHeight( fPeak ) * 4 + color;
+}
+
+
 void Fader::paintEvent( QPaintEvent * ev)
 {
 	QPainter painter(this);
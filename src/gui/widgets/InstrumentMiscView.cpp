@@ -32,6 +32,7 @@
 #include "GroupBox.h"
 #include "gui_templates.h"
 #include "InstrumentTrack.h"
+#include "LcdSpinBox.h"
 #include "LedCheckbox.h"
 
 
@@ -81,6 +82,25 @@ InstrumentMiscView::InstrumentMiscView(InstrumentTrack *it, QWidget *parent) :
 	m_rangeImportCheckbox->setCheckable(true);
 	microtunerLayout->addWidget(m_rangeImportCheckbox);
 
+	// Voice limit settings
+	m_voiceLimitGroupBox = new GroupBox(tr("VOICE LIMIT"));
+	m_voiceLimitGroupBox->setModel(&it->m_voiceLimitEnabledModel);
+	layout->addWidget(m_voiceLimitGroupBox);
+
+	QHBoxLayout *voiceLimitLayout = new QHBoxLayout(m_voiceLimitGroupBox);
+	voiceLimitLayout->setContentsMargins(8, 18, 8, 8);
+
+	m_voiceLimitSpinBox = new LcdSpinBox(3, m_voiceLimitGroupBox, tr("Voices"));
+	m_voiceLimitSpinBox->setModel(&it->m_voiceLimitModel);
+	m_voiceLimitSpinBox->setLabel(tr("VOICES"));
+	m_voiceLimitSpinBox->setToolTip(tr("The number of notes the instrument plays at most. More notes stop the ones chosen below, which fade out quickly."));
+	voiceLimitLayout->addWidget(m_voiceLimitSpinBox);
+
+	m_voiceStealingCombo = new ComboBox();
+	m_voiceStealingCombo->setModel(&it->m_voiceStealingModel);
+	m_voiceStealingCombo->setToolTip(tr("Which notes are stopped first"));
+	voiceLimitLayout->addWidget(m_voiceStealingCombo);
+
 	// Fill remaining space
 	layout->addStretch();
 }
@@ -0,0 +1,70 @@
+/*
+ * LoadIndicator.cpp - small bar showing the CPU load of a track or channel
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "LoadIndicator.h"
+
+#include <QPainter>
+
+
+LoadIndicator::LoadIndicator( QWidget * parent ) :
+	QWidget( parent ),
+	m_load( 0.0f )
+{
+	setAttribute( Qt::WA_OpaquePaintEvent, true );
+	hide();
+}
+
+
+
+
+void LoadIndicator::setLoad( float load, const QString & details )
+{
+	// the meters are read at the GUI rate, so smooth them a bit
+	const float smoothed = m_load * 0.7f + load * 0.3f;
+	if( qAbs( smoothed - m_load ) >= 0.1f )
+	{
+		m_load = smoothed;
+		update();
+	}
+	setToolTip( tr( "CPU load: %1%" ).arg( m_load, 0, 'f', 1 ) +
+			( details.isEmpty() ? QString() : "\n" + details ) );
+}
+
+
+
+
+void LoadIndicator::paintEvent( QPaintEvent * )
+{
+	QPainter p( this );
+	p.fillRect( rect(), palette().color( QPalette::Window ).darker( 150 ) );
+
+	// a quarter of a core fills the bar, anything above is a hot spot
+	const float fill = qMin( m_load / 25.0f, 1.0f );
+	const int h = qRound( fill * height() );
+	if( h > 0 )
+	{
+		const QColor color = QColor::fromHsvF( ( 1.0f - fill ) / 3.0f, 1.0f, 0.9f );
+		p.fillRect( 0, height() - h, width(), h, color );
+	}
+}
@@ -29,10 +29,13 @@
 
 #include <QGraphicsProxyWidget>
 
+#include "AudioDevice.h"
+#include "AudioEngine.h"
 #include "CaptionMenu.h"
 #include "Mixer.h"
 #include "gui_templates.h"
 #include "GuiApplication.h"
+#include "LoadIndicator.h"
 #include "Song.h"
 
 bool MixerLine::eventFilter( QObject *dist, QEvent *event )
@@ -96,6 +99,10 @@ MixerLine::MixerLine( QWidget * _parent, MixerView * _mv, int _channelIndex ) :
 	m_lcd->setValue( m_channelIndex );
 	m_lcd->move( 4, 58 );
 	m_lcd->setMarginWidth( 1 );
+
+	// CPU load of the channel, shown while the profiler measures it
+	m_loadIndicator = new LoadIndicator( this );
+	m_loadIndicator->setGeometry( 28, 58, 3, 16 );
 	
 	QString name = Engine::mixer()->mixerChannel( m_channelIndex )->m_name;
 	setToolTip( name );
@@ -242,6 +249,13 @@ void MixerLine::contextMenuEvent( QContextMenuEvent * )
 		contextMenu->addAction( tr( "Move &right" ), this, SLOT( moveChannelRight() ) );
 	}
 	contextMenu->addAction( tr( "Rename &channel" ), this, SLOT( renameChannel() ) );
+	if( m_channelIndex != 0 && Engine::audioEngine()->audioDev()->supportsChannelOutputs() )
+	{
+		QAction * extOutput = contextMenu->addAction( tr( "Output to own device port" ),
+							this, SLOT( toggleExtOutput() ) );
+		extOutput->setCheckable( true );
+		extOutput->setChecked( Engine::mixer()->mixerChannel( m_channelIndex )->m_extOutputEnabled );
+	}
 	contextMenu->addSeparator();
 
 	if( m_channelIndex != 0 ) // no remove-option in master
@@ -293,7 +307,12 @@ void MixerLine::renameFinished()
 	setFocus();
 	if( !newName.isEmpty() && Engine::mixer()->mixerChannel( m_channelIndex )->m_name != newName )
 	{
-		Engine::mixer()->mixerChannel( m_channelIndex )->m_name = newName;
+		MixerChannel * channel = Engine::mixer()->mixerChannel( m_channelIndex );
+		channel->m_name = newName;
+		if( channel->m_extOutputEnabled )
+		{
+			Engine::audioEngine()->audioDev()->renameChannel( channel );
+		}
 		m_renameLineEdit->setText( elideName( newName ) );
 		Engine::getSong()->setModified();
 	}
@@ -304,6 +323,17 @@ void MixerLine::renameFinished()
 
 
 
+void MixerLine::toggleExtOutput()
+{
+	Mixer * mixer = Engine::mixer();
+	mixer->setExtOutputEnabled( m_channelIndex,
+			!mixer->mixerChannel( m_channelIndex )->m_extOutputEnabled );
+	Engine::getSong()->setModified();
+}
+
+
+
+
 void MixerLine::removeChannel()
 {
 	MixerView * mix = getGUI()->mixerView();
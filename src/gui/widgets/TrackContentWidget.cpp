@@ -49,6 +49,24 @@
 const int BARS_PER_GROUP = 4;
 
 
+/*! \brief Returns the data file with the Clips in @p md
+ *
+ *  Clips copied within this instance are taken as they are, without
+ *  writing and parsing their XML.
+ */
+static DataFile clipDataFile( const QMimeData * md )
+{
+	auto payload = dynamic_cast<const Clipboard::DataFilePayload *>(
+						Clipboard::getPayload( md ) );
+	if( payload != nullptr )
+	{
+		return payload->dataFile();
+	}
+	// value contains XML needed to reconstruct Clips and place them
+	return DataFile( Clipboard::decodeValue( md ).toUtf8() );
+}
+
+
 /*! \brief Create a new trackContentWidget
  *
  *  Creates a new track content widget for the given track.
@@ -135,19 +153,16 @@ void TrackContentWidget::updateBackground()
 /*! \brief Adds a ClipView to this widget.
  *
  *  Adds a(nother) ClipView to our list of views.  We also
- *  check that our position is up-to-date.
+ *  place it in the visible range or hide it.
  *
  * \param clipv The ClipView to add.
  */
 void TrackContentWidget::addClipView( ClipView * clipv )
 {
-	Clip * clip = clipv->getClip();
-
 	m_clipViews.push_back( clipv );
 
-	clip->saveJournallingState( false );
-	changePosition();
-	clip->restoreJournallingState();
+	// placing all views for each new one made loading long songs quadratic
+	changePosition( clipv );
 }
 
 
@@ -248,29 +263,7 @@ void TrackContentWidget::changePosition( const TimePos & newPos )
 	for( clipViewVector::iterator it = m_clipViews.begin();
 						it != m_clipViews.end(); ++it )
 	{
-		ClipView * clipv = *it;
-		Clip * clip = clipv->getClip();
-
-		clip->changeLength( clip->length() );
-
-		const int ts = clip->startPosition();
-		const int te = clip->endPosition()-3;
-		if( ( ts >= begin && ts <= end ) ||
-			( te >= begin && te <= end ) ||
-			( ts <= begin && te >= end ) )
-		{
-			clipv->move( static_cast<int>( ( ts - begin ) * ppb /
-						TimePos::ticksPerBar() ),
-								clipv->y() );
-			if( !clipv->isVisible() )
-			{
-				clipv->show();
-			}
-		}
-		else
-		{
-			clipv->move( -clipv->width()-10, clipv->y() );
-		}
+		placeClipView( *it, begin, end, ppb );
 	}
 	setUpdatesEnabled( true );
 
@@ -281,6 +274,70 @@ void TrackContentWidget::changePosition( const TimePos & newPos )
 
 
 
+/*! \brief Move a single ClipView to its place after its clip moved
+ *
+ * \param clipv The ClipView to place.
+ */
+void TrackContentWidget::changePosition( ClipView * clipv )
+{
+	const TrackContainerView * tcv = m_trackView->trackContainerView();
+	if( tcv == getGUI()->getBBEditor()->trackContainerView() )
+	{
+		// the BB editor shows the views of the current BB in front
+		changePosition();
+		return;
+	}
+	const TimePos pos = tcv->currentPosition();
+	placeClipView( clipv, pos, endPosition( pos ), tcv->pixelsPerBar() );
+}
+
+
+
+
+/*! \brief Show a ClipView at its place or hide it, if it's out of view
+ *
+ *  Only views in the visible range are shown and kept up to date, the
+ *  others don't paint nor keep their pixmaps.
+ *
+ * \param clipv The ClipView to place.
+ * \param begin The first visible tick.
+ * \param end The last visible tick.
+ * \param ppb The pixels per bar.
+ */
+void TrackContentWidget::placeClipView( ClipView * clipv, int begin, int end, float ppb )
+{
+	Clip * clip = clipv->getClip();
+
+	const int ts = clip->startPosition();
+	const int te = clip->endPosition()-3;
+	if( ( ts >= begin && ts <= end ) ||
+		( te >= begin && te <= end ) ||
+		( ts <= begin && te >= end ) )
+	{
+		// the length may have changed with the zoom while it was hidden
+		clipv->updateLength();
+		clipv->move( static_cast<int>( ( ts - begin ) * ppb /
+					TimePos::ticksPerBar() ),
+							clipv->y() );
+		if( !clipv->isVisible() )
+		{
+			clipv->show();
+		}
+	}
+	else if( QWidget::mouseGrabber() == clipv )
+	{
+		// hiding would end a drag, so just move it out of sight
+		clipv->move( -clipv->width()-10, clipv->y() );
+	}
+	else
+	{
+		clipv->hide();
+	}
+}
+
+
+
+
 /*! \brief Return the position of the trackContentWidget in bars.
  *
  * \param mouseX the mouse's current X position in pixels.
@@ -337,12 +394,11 @@ bool TrackContentWidget::canPasteSelection( TimePos clipPos, const QDropEvent* d
 // Overloaded method to make it possible to call this method without a Drag&Drop event
 bool TrackContentWidget::canPasteSelection( TimePos clipPos, const QMimeData* md , bool allowSameBar )
 {
-	// For decodeKey() and decodeValue()
+	// For decodeKey()
 	using namespace Clipboard;
 
 	Track * t = getTrack();
 	QString type = decodeKey( md );
-	QString value = decodeValue( md );
 
 	// We can only paste into tracks of the same type
 	if( type != ( "clip_" + QString::number( t->type() ) ) ||
@@ -351,8 +407,7 @@ bool TrackContentWidget::canPasteSelection( TimePos clipPos, const QMimeData* md
 		return false;
 	}
 
-	// value contains XML needed to reconstruct Clips and place them
-	DataFile dataFile( value.toUtf8() );
+	DataFile dataFile = clipDataFile( md );
 
 	// Extract the metadata and which Clip was grabbed
 	QDomElement metadata = dataFile.content().firstChildElement( "copyMetadata" );
@@ -426,22 +481,15 @@ bool TrackContentWidget::pasteSelection( TimePos clipPos, QDropEvent * de )
 // Overloaded method so we can call it without a Drag&Drop event
 bool TrackContentWidget::pasteSelection( TimePos clipPos, const QMimeData * md, bool skipSafetyCheck )
 {
-	// For decodeKey() and decodeValue()
-	using namespace Clipboard;
-
 	// When canPasteSelection was already called before, skipSafetyCheck will skip this
 	if( !skipSafetyCheck && canPasteSelection( clipPos, md ) == false )
 	{
 		return false;
 	}
 
-	QString type = decodeKey( md );
-	QString value = decodeValue( md );
-
 	getTrack()->addJournalCheckPoint();
 
-	// value contains XML needed to reconstruct Clips and place them
-	DataFile dataFile( value.toUtf8() );
+	DataFile dataFile = clipDataFile( md );
 
 	// Extract the clip data
 	QDomElement clipParent = dataFile.content().firstChildElement("clips");
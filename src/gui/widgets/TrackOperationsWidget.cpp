@@ -28,11 +28,13 @@
 #include <QMessageBox>
 #include <QMouseEvent>
 #include <QPainter>
+#include <QProgressDialog>
 #include <QPushButton>
 #include <QCheckBox>
 
 #include "AutomationClip.h"
 #include "AutomationTrackView.h"
+#include "BBTrack.h"
 #include "ColorChooser.h"
 #include "ConfigManager.h"
 #include "DataFile.h"
@@ -43,6 +45,7 @@
 #include "PixmapButton.h"
 #include "Song.h"
 #include "StringPairDrag.h"
+#include "TrackFreeze.h"
 #include "ToolTip.h"
 #include "Track.h"
 #include "TrackContainerView.h"
@@ -258,6 +261,84 @@ void TrackOperationsWidget::clearTrack()
 
 
 
+/*! \brief Render this track into a cache that plays instead of it */
+void TrackOperationsWidget::freezeTrack()
+{
+	TrackFreeze * freeze = m_trackView->getTrack()->trackFreeze();
+	if (!freeze->freeze())
+	{
+		return;
+	}
+
+	// the song mustn't change while it's being rendered
+	QProgressDialog progress(tr("Freezing %1...").arg(m_trackView->getTrack()->name()),
+		tr("Cancel"), 0, 100, this);
+	progress.setWindowModality(Qt::ApplicationModal);
+	progress.setAutoClose(false);
+	progress.setMinimumDuration(0);
+	connect(freeze, SIGNAL(freezeProgress(int)), &progress, SLOT(setValue(int)));
+	connect(freeze, SIGNAL(freezeFinished()), &progress, SLOT(accept()));
+	connect(&progress, SIGNAL(canceled()), freeze, SLOT(abortFreeze()));
+	if (freeze->isFreezing())
+	{
+		progress.exec();
+	}
+}
+
+
+
+
+void TrackOperationsWidget::unfreezeTrack()
+{
+	m_trackView->getTrack()->trackFreeze()->unfreeze();
+}
+
+
+
+
+/*! \brief Replay repetitions of this BB track's pattern from a rendering */
+void TrackOperationsWidget::togglePatternCache(bool on)
+{
+	if (BBTrack * bbTrack = qobject_cast<BBTrack *>(m_trackView->getTrack()))
+	{
+		bbTrack->patternCache()->setEnabled(on);
+		Engine::getSong()->setModified();
+		if (on)
+		{
+			renderPatternCache();
+		}
+	}
+}
+
+
+
+
+/*! \brief Render the pattern of this BB track, which stops playback meanwhile */
+void TrackOperationsWidget::renderPatternCache()
+{
+	BBTrack * bbTrack = qobject_cast<BBTrack *>(m_trackView->getTrack());
+	if (!bbTrack || !bbTrack->patternCache()->render())
+	{
+		return;
+	}
+
+	// the pattern mustn't change while it's being rendered
+	BBPatternCache * cache = bbTrack->patternCache();
+	QProgressDialog progress(tr("Rendering %1...").arg(bbTrack->name()), tr("Cancel"), 0, 100, this);
+	progress.setWindowModality(Qt::ApplicationModal);
+	progress.setAutoClose(false);
+	progress.setMinimumDuration(0);
+	connect(cache, SIGNAL(renderProgress(int)), &progress, SLOT(setValue(int)));
+	connect(cache, SIGNAL(renderFinished()), &progress, SLOT(accept()));
+	connect(&progress, SIGNAL(canceled()), cache, SLOT(abortRender()));
+	if (cache->isRendering())
+	{
+		progress.exec();
+	}
+}
+
+
+
 /*! \brief Remove this track from the track list
  *
  */
@@ -342,6 +423,33 @@ void TrackOperationsWidget::updateMenu()
 		toMenu->addMenu(mixerMenu);
 	}
 
+	Track * track = m_trackView->getTrack();
+	if (track->trackFreeze() && track->trackContainer() == Engine::getSong())
+	{
+		if (track->trackFreeze()->isFrozen())
+		{
+			toMenu->addAction(tr("Unfreeze this track"), this, SLOT(unfreezeTrack()));
+		}
+		else
+		{
+			toMenu->addAction(tr("Freeze this track"), this, SLOT(freezeTrack()));
+		}
+	}
+	if (BBTrack * bbTrack = qobject_cast<BBTrack *>(track))
+	{
+		QAction * cacheAction = toMenu->addAction(tr("Cache pattern playback"),
+						this, SLOT(togglePatternCache(bool)));
+		cacheAction->setCheckable(true);
+		cacheAction->setChecked(bbTrack->patternCache()->isEnabled());
+		// edits drop the rendering, until the user asks for a new one
+		if (bbTrack->patternCache()->isEnabled() && !bbTrack->patternCache()->isRendered())
+		{
+			QAction * renderAction = toMenu->addAction(tr("Render cached pattern"),
+							this, SLOT(renderPatternCache()));
+			renderAction->setEnabled(!Engine::getSong()->isPlaying());
+		}
+	}
+
 	if (InstrumentTrackView * trackView = dynamic_cast<InstrumentTrackView *>(m_trackView))
 	{
 		toMenu->addSeparator();
@@ -37,7 +37,8 @@ BBTrack::infoMap BBTrack::s_infoMap;
 
 
 BBTrack::BBTrack( TrackContainer* tc ) :
-	Track( Track::BBTrack, tc )
+	Track( Track::BBTrack, tc ),
+	m_patternCache( this )
 {
 	int bbNum = s_infoMap.size();
 	s_infoMap[this] = bbNum;
@@ -59,7 +60,8 @@ BBTrack::~BBTrack()
 	Engine::audioEngine()->removePlayHandlesOfTypes( this,
 					PlayHandle::TypeNotePlayHandle
 					| PlayHandle::TypeInstrumentPlayHandle
-					| PlayHandle::TypeSamplePlayHandle );
+					| PlayHandle::TypeSamplePlayHandle
+					| PlayHandle::TypePatternCacheHandle );
 
 	const int bb = s_infoMap[this];
 	Engine::getBBTrackContainer()->removeBB( bb );
@@ -96,28 +98,25 @@ bool BBTrack::play( const TimePos & _start, const fpp_t _frames,
 		return Engine::getBBTrackContainer()->play( _start, _frames, _offset, s_infoMap[this] );
 	}
 
-	clipVector clips;
-	getClipsInRange( clips, _start, _start + static_cast<int>( _frames / Engine::framesPerTick() ) );
-
-	if( clips.size() == 0 )
-	{
-		return false;
-	}
-
 	TimePos lastPosition;
 	TimePos lastLen;
-	for( clipVector::iterator it = clips.begin(); it != clips.end(); ++it )
+	forEachClipInRange( _start, _start + static_cast<int>( _frames / Engine::framesPerTick() ),
+		[&lastPosition, &lastLen]( Clip * clip )
 	{
-		if( !( *it )->isMuted() &&
-				( *it )->startPosition() >= lastPosition )
+		if( !clip->isMuted() &&
+				clip->startPosition() >= lastPosition )
 		{
-			lastPosition = ( *it )->startPosition();
-			lastLen = ( *it )->length();
+			lastPosition = clip->startPosition();
+			lastLen = clip->length();
 		}
-	}
+	} );
 
 	if( _start - lastPosition < lastLen )
 	{
+		if( m_patternCache.play( _start, lastPosition, lastLen, _offset ) )
+		{
+			return true;
+		}
 		return Engine::getBBTrackContainer()->play( _start - lastPosition, _frames, _offset, s_infoMap[this] );
 	}
 	return false;
@@ -161,6 +160,10 @@ void BBTrack::saveTrackSpecificSettings( QDomDocument & _doc,
 	{
 		_this.setAttribute( "clonebbt", s_infoMap[this] );
 	}
+	if( m_patternCache.isEnabled() )
+	{
+		_this.setAttribute( "patterncache", 1 );
+	}
 }
 
 
@@ -173,6 +176,8 @@ void BBTrack::loadTrackSpecificSettings( const QDomElement & _this )
 		m_trackLabel->setPixmapFile( _this.attribute( "icon" ) );
 	}*/
 
+	m_patternCache.setEnabled( _this.attribute( "patterncache" ).toInt() );
+
 	if( _this.hasAttribute( "clonebbt" ) )
 	{
 		const int src = _this.attribute( "clonebbt" ).toInt();
@@ -23,21 +23,60 @@
  */
 #include "InstrumentTrack.h"
 
+#include <algorithm>
+
 #include "AudioEngine.h"
 #include "AutomationClip.h"
 #include "BBTrack.h"
+#include "BBTrackContainer.h"
 #include "ConfigManager.h"
 #include "ControllerConnection.h"
 #include "DataFile.h"
 #include "Mixer.h"
 #include "InstrumentTrackView.h"
 #include "Instrument.h"
+#include "InstrumentPlayHandle.h"
 #include "MidiClient.h"
 #include "MidiClip.h"
 #include "MixHelpers.h"
 #include "Song.h"
 
 
+namespace
+{
+
+// plugins whose instances take long to create or keep a lot of memory or
+// a process of their own, the only ones worth deferring
+const char * const DeferrableInstruments[] = {
+	"vestige", "zynaddsubfx", "sf2player", "gigplayer", "lv2instrument",
+	"carlarack", "carlapatchbay"
+};
+
+// unloadIdleInstrument() counts minutes
+const int IdleCheckInterval = 60 * 1000;
+
+bool refersToModels( const QDomElement & element )
+{
+	if( element.hasAttribute( "id" ) || element.tagName() == ControllerConnection::classNodeName() )
+	{
+		return true;
+	}
+	for( QDomElement child = element.firstChildElement(); !child.isNull();
+					child = child.nextSiblingElement() )
+	{
+		if( refersToModels( child ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+}
+
+
+
+
 InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	Track( Track::InstrumentTrack, tc ),
 	MidiEventProcessor(),
@@ -54,14 +93,25 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	m_volumeModel( DefaultVolume, MinVolume, MaxVolume, 0.1f, this, tr( "Volume" ) ),
 	m_panningModel( DefaultPanning, PanningLeft, PanningRight, 0.1f, this, tr( "Panning" ) ),
 	m_audioPort( tr( "unnamed_track" ), true, &m_volumeModel, &m_panningModel, &m_mutedModel ),
+	m_freeze( this, &m_audioPort ),
 	m_pitchModel( 0, MinPitchDefault, MaxPitchDefault, 1, this, tr( "Pitch" ) ),
 	m_pitchRangeModel( 1, 1, 60, this, tr( "Pitch range" ) ),
 	m_mixerChannelModel( 0, 0, 0, this, tr( "Mixer channel" ) ),
 	m_useMasterPitchModel( true, this, tr( "Master pitch") ),
+	m_voiceLimitEnabledModel( false, this, tr( "Voice limit" ) ),
+	m_voiceLimitModel( 16, 1, PlayHandle::MaxNumber, this, tr( "Voices" ) ),
+	m_voiceStealingModel( this, tr( "Voice stealing" ) ),
 	m_instrument( nullptr ),
+	m_instrumentDeferred( false ),
+	m_instrumentRequested( false ),
+	m_instrumentActive( false ),
+	m_suspended( false ),
+	m_idleMinutes( 0 ),
+	m_instrumentWindowShown( false ),
 	m_soundShaping( this ),
 	m_arpeggio( this ),
 	m_noteStacking( this ),
+	m_noteBatch( this ),
 	m_piano(this),
 	m_microtuner()
 {
@@ -72,12 +122,19 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	m_lastKeyModel.setInitValue(NumKeys - 1);
 
 	m_mixerChannelModel.setRange( 0, Engine::mixer()->numChannels()-1, 1);
+	m_freeze.addIgnoredModel( &m_mixerChannelModel );
+
+	// in the order of VoiceStealing
+	m_voiceStealingModel.addItem( tr( "Oldest" ) );
+	m_voiceStealingModel.addItem( tr( "Quietest" ) );
+	m_voiceStealingModel.addItem( tr( "Same key" ) );
 
 	for( int i = 0; i < NumKeys; ++i )
 	{
 		m_notes[i] = nullptr;
 		m_runningMidiNotes[i] = 0;
 	}
+	m_activeNotes.reserve( NumKeys );
 
 
 	// Initialize the m_midiCCEnabled variable, but it's actually going to be connected
@@ -101,6 +158,11 @@ InstrumentTrack::InstrumentTrack( TrackContainer* tc ) :
 	connect(&m_pitchModel, SIGNAL(dataChanged()), this, SLOT(updatePitch()), Qt::DirectConnection);
 	connect(&m_pitchRangeModel, SIGNAL(dataChanged()), this, SLOT(updatePitchRange()), Qt::DirectConnection);
 	connect(&m_mixerChannelModel, SIGNAL(dataChanged()), this, SLOT(updateMixerChannel()), Qt::DirectConnection);
+
+	connect(&m_idleTimer, SIGNAL(timeout()), this, SLOT(unloadIdleInstrument()));
+	connect(ConfigManager::inst(), SIGNAL(valueChanged(QString, QString, QString)),
+		this, SLOT(updateIdleTimer(QString, QString)));
+	updateIdleTimer("app", "unloadinstrumentsafter");
 }
 
 
@@ -125,6 +187,20 @@ bool InstrumentTrack::isKeyMapped(int key) const
 }
 
 
+int InstrumentTrack::activeNoteCount() const
+{
+	QMutexLocker locker( &m_activeNotesMutex );
+	return m_activeNotes.size();
+}
+
+
+const NotePlayHandle * InstrumentTrack::firstActiveNote() const
+{
+	QMutexLocker locker( &m_activeNotesMutex );
+	return m_activeNotes.empty() ? nullptr : m_activeNotes.front();
+}
+
+
 /** \brief Return first mapped key, based on currently selected keymap or user selection.
  *	\return Number ranging from 0 to NumKeys -1
  */
@@ -201,11 +277,18 @@ InstrumentTrack::~InstrumentTrack()
 		s_autoAssignedTrack = nullptr;
 	}
 
+	m_freeze.unfreeze();
+	Engine::audioEngine()->removePlayHandlesOfTypes( this, PlayHandle::TypePatternCacheHandle );
+
 	// kill all running notes and the iph
 	silenceAllNotes( true );
 
 	// now we're save deleting the instrument
 	if( m_instrument ) delete m_instrument;
+	for( Instrument * instrument : m_warmInstruments )
+	{
+		delete instrument;
+	}
 }
 
 
@@ -220,6 +303,13 @@ void InstrumentTrack::processAudioBuffer( sampleFrame* buf, const fpp_t frames,
 		return;
 	}
 
+	// the instrument's output is checked here, once, so that the mixer
+	// can mix it without checking every sample again
+	if( MixHelpers::sanitize( buf, frames ) )
+	{
+		m_instrument->reportBadOutput();
+	}
+
 	// Test for silent input data if instrument provides a single stream only (i.e. driven by InstrumentPlayHandle)
 	// We could do that in all other cases as well but the overhead for silence test is bigger than
 	// what we potentially save. While playing a note, a NotePlayHandle-driven instrument will produce sound in
@@ -317,6 +407,20 @@ void InstrumentTrack::processInEvent( const MidiEvent& event, const TimePos& tim
 	{
 		return;
 	}
+	// a frozen track only plays its cache
+	if (m_freeze.isFrozen() && event.type() == MidiNoteOn)
+	{
+		return;
+	}
+	if (event.type() == MidiNoteOn)
+	{
+		m_instrumentActive = true;
+		if (m_instrumentDeferred)
+		{
+			// the note itself stays silent
+			requestInstrument();
+		}
+	}
 
 	bool eventHandled = false;
 
@@ -510,7 +614,7 @@ void InstrumentTrack::processOutEvent( const MidiEvent& event, const TimePos& ti
 	}
 
 	// if appropriate, midi-port does futher routing
-	m_midiPort.processOutEvent( event, time );
+	m_midiPort.processOutEvent( event, time, offset );
 }
 
 
@@ -559,17 +663,25 @@ f_cnt_t InstrumentTrack::beatLen( NotePlayHandle * _n ) const
 
 
 void InstrumentTrack::playNote( NotePlayHandle* n, sampleFrame* workingBuffer )
+{
+	if( prepareNote( n ) )
+	{
+		// all is done, so now lets play the note!
+		m_instrument->playNote( n, workingBuffer );
+	}
+}
+
+
+
+
+bool InstrumentTrack::prepareNote( NotePlayHandle* n )
 {
 	// arpeggio- and chord-widget has to do its work -> adding sub-notes
 	// for chords/arpeggios
 	m_noteStacking.processNote( n );
 	m_arpeggio.processNote( n );
 
-	if( n->isMasterNote() == false && m_instrument != nullptr )
-	{
-		// all is done, so now lets play the note!
-		m_instrument->playNote( n, workingBuffer );
-	}
+	return n->isMasterNote() == false && m_instrument != nullptr;
 }
 
 
@@ -681,27 +793,44 @@ void InstrumentTrack::removeMidiPortNode( DataFile & _dataFile )
 bool InstrumentTrack::play( const TimePos & _start, const fpp_t _frames,
 							const f_cnt_t _offset, int _clip_num )
 {
-	if( ! m_instrument || ! tryLock() )
+	if( m_freeze.play( _start, _offset, _clip_num ) )
 	{
 		return false;
 	}
-	const float frames_per_tick = Engine::framesPerTick();
-
-	clipVector clips;
-	::BBTrack * bb_track = nullptr;
-	if( _clip_num >= 0 )
+	if( m_instrument == nullptr && m_instrumentDeferred )
 	{
-		Clip * clip = getClip( _clip_num );
-		clips.push_back( clip );
-		if (trackContainer() == (TrackContainer*)Engine::getBBTrackContainer())
+		// a bar ahead, so that the instrument is there before its notes
+		// most of the time
+		bool hasNotes = false;
+		auto findNotes = [&hasNotes]( Clip * clip )
+		{
+			const MidiClip * c = dynamic_cast<MidiClip *>( clip );
+			hasNotes = hasNotes || ( c && !c->isMuted() && !c->notes().empty() );
+		};
+		if( _clip_num >= 0 )
+		{
+			findNotes( getClip( _clip_num ) );
+		}
+		else
+		{
+			forEachClipInRange( _start, _start + TimePos::ticksPerBar(), findNotes );
+		}
+		if( hasNotes )
 		{
-			bb_track = BBTrack::findBBTrack( _clip_num );
+			requestInstrument();
 		}
+		return false;
 	}
-	else
+	if( ! m_instrument || ! tryLock() )
 	{
-		getClipsInRange( clips, _start, _start + static_cast<int>(
-					_frames / frames_per_tick ) );
+		return false;
+	}
+	const float frames_per_tick = Engine::framesPerTick();
+
+	::BBTrack * bb_track = nullptr;
+	if( _clip_num >= 0 && trackContainer() == (TrackContainer*)Engine::getBBTrackContainer() )
+	{
+		bb_track = BBTrack::findBBTrack( _clip_num );
 	}
 
 	// Handle automation: detuning
@@ -711,24 +840,18 @@ bool InstrumentTrack::play( const TimePos & _start, const fpp_t _frames,
 		( *it )->processTimePos( _start );
 	}
 
-	if ( clips.size() == 0 )
-	{
-		unlock();
-		return false;
-	}
-
 	bool played_a_note = false;	// will be return variable
 
-	for( clipVector::Iterator it = clips.begin(); it != clips.end(); ++it )
+	auto playClip = [&]( Clip * clip )
 	{
-		MidiClip* c = dynamic_cast<MidiClip*>( *it );
+		MidiClip* c = dynamic_cast<MidiClip*>( clip );
 		// everything which is not a MIDI clip won't be played
 		// A MIDI clip playing in the Piano Roll window will always play
 		if(c == nullptr ||
 			(Engine::getSong()->playMode() != Song::Mode_PlayMidiClip
-			&& (*it)->isMuted()))
+			&& clip->isMuted()))
 		{
-			continue;
+			return;
 		}
 		TimePos cur_start = _start;
 		if( _clip_num < 0 )
@@ -736,32 +859,20 @@ bool InstrumentTrack::play( const TimePos & _start, const fpp_t _frames,
 			cur_start -= c->startPosition();
 		}
 
-		// get all notes from the given clip...
-		const NoteVector & notes = c->notes();
-		// ...and set our index to zero
-		NoteVector::ConstIterator nit = notes.begin();
-
-		// very effective algorithm for playing notes that are
-		// posated within the current sample-frame
-
-
-		if( cur_start > 0 )
-		{
-			// skip notes which are posated before start-bar
-			while( nit != notes.end() && ( *nit )->pos() < cur_start )
-			{
-				++nit;
-			}
-		}
-
-		Note * cur_note;
-		while( nit != notes.end() &&
-					( cur_note = *nit )->pos() == cur_start )
+		// get the notes starting at the current position - the clip
+		// continues from where the last tick ended
+		const auto notes = c->notesStartingAt( cur_start );
+		for( NoteVector::ConstIterator nit = notes.first; nit != notes.second; ++nit )
 		{
+			Note * cur_note = *nit;
 			const f_cnt_t note_frames =
 				cur_note->length().frames( frames_per_tick );
 
 			NotePlayHandle* notePlayHandle = NotePlayHandleManager::acquire( this, _offset, note_frames, *cur_note );
+			if( notePlayHandle == nullptr )
+			{
+				continue;
+			}
 			notePlayHandle->setBBTrack( bb_track );
 			// are we playing global song?
 			if( _clip_num < 0 )
@@ -773,8 +884,18 @@ bool InstrumentTrack::play( const TimePos & _start, const fpp_t _frames,
 
 			Engine::audioEngine()->addPlayHandle( notePlayHandle );
 			played_a_note = true;
-			++nit;
+			m_instrumentActive = true;
 		}
+	};
+
+	if( _clip_num >= 0 )
+	{
+		playClip( getClip( _clip_num ) );
+	}
+	else
+	{
+		forEachClipInRange( _start, _start + static_cast<int>(
+					_frames / frames_per_tick ), playClip );
 	}
 	unlock();
 	return played_a_note;
@@ -813,6 +934,9 @@ void InstrumentTrack::saveTrackSpecificSettings( QDomDocument& doc, QDomElement
 	m_firstKeyModel.saveSettings(doc, thisElement, "firstkey");
 	m_lastKeyModel.saveSettings(doc, thisElement, "lastkey");
 	m_useMasterPitchModel.saveSettings( doc, thisElement, "usemasterpitch");
+	m_voiceLimitEnabledModel.saveSettings( doc, thisElement, "voicelimited" );
+	m_voiceLimitModel.saveSettings( doc, thisElement, "voicelimit" );
+	m_voiceStealingModel.saveSettings( doc, thisElement, "voicestealing" );
 	m_microtuner.saveSettings(doc, thisElement);
 
 	// Save MIDI CC stuff
@@ -824,15 +948,13 @@ void InstrumentTrack::saveTrackSpecificSettings( QDomDocument& doc, QDomElement
 		m_midiCCModel[i]->saveSettings(doc, midiCC, "cc" + QString::number(i));
 	}
 
-	if( m_instrument != nullptr )
+	if( m_instrumentDeferred )
 	{
-		QDomElement i = doc.createElement( "instrument" );
-		i.setAttribute( "name", m_instrument->descriptor()->name );
-		QDomElement ins = m_instrument->saveState( doc, i );
-		if(m_instrument->key().isValid()) {
-			ins.appendChild( m_instrument->key().saveXML( doc ) );
-		}
-		thisElement.appendChild( i );
+		thisElement.appendChild( doc.importNode( m_deferredInstrument.documentElement(), true ) );
+	}
+	else if( m_instrument != nullptr )
+	{
+		thisElement.appendChild( saveInstrumentState( doc ) );
 	}
 	m_soundShaping.saveState( doc, thisElement );
 	m_noteStacking.saveState( doc, thisElement );
@@ -880,6 +1002,9 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 	m_firstKeyModel.loadSettings(thisElement, "firstkey");
 	m_lastKeyModel.loadSettings(thisElement, "lastkey");
 	m_useMasterPitchModel.loadSettings( thisElement, "usemasterpitch");
+	m_voiceLimitEnabledModel.loadSettings( thisElement, "voicelimited" );
+	m_voiceLimitModel.loadSettings( thisElement, "voicelimit" );
+	m_voiceStealingModel.loadSettings( thisElement, "voicestealing" );
 	m_microtuner.loadSettings(thisElement);
 
 	// clear effect-chain just in case we load an old preset without FX-data
@@ -923,12 +1048,19 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 				{
 					m_instrument->restoreState(node.firstChildElement());
 				}
+				else if (Engine::getSong()->isLoadingProject() && canDeferInstrument(node.toElement()) &&
+					ConfigManager::inst()->value("app", "deferinstruments").toInt())
+				{
+					// instantiated once it's needed
+					switchInstrument(QString(), nullptr);
+					m_deferredInstrument = QDomDocument();
+					m_deferredInstrument.appendChild(m_deferredInstrument.importNode(node, true));
+					m_instrumentDeferred = true;
+					emit instrumentChanged();
+				}
 				else
 				{
-					delete m_instrument;
-					m_instrument = nullptr;
-					m_instrument = Instrument::instantiate(
-						node.toElement().attribute("name"), this, &key);
+					switchInstrument(node.toElement().attribute("name"), &key);
 					m_instrument->restoreState(node.firstChildElement());
 					emit instrumentChanged();
 				}
@@ -947,10 +1079,7 @@ void InstrumentTrack::loadTrackSpecificSettings( const QDomElement & thisElement
 					ControllerConnection::classNodeName() != node.nodeName() &&
 					!node.toElement().hasAttribute( "id" ))
 			{
-				delete m_instrument;
-				m_instrument = nullptr;
-				m_instrument = Instrument::instantiate(
-					node.nodeName(), this, nullptr, true);
+				switchInstrument(node.nodeName(), nullptr, true);
 				if (m_instrument->nodeName() == node.nodeName())
 				{
 					m_instrument->restoreState(node.toElement());
@@ -1027,9 +1156,7 @@ Instrument * InstrumentTrack::loadInstrument(const QString & _plugin_name,
 	silenceAllNotes( true );
 
 	lock();
-	delete m_instrument;
-	m_instrument = Instrument::instantiate(_plugin_name, this,
-					key, keyFromDnd);
+	switchInstrument(_plugin_name, key, keyFromDnd);
 	unlock();
 	setName(m_instrument->displayName());
 
@@ -1040,6 +1167,191 @@ Instrument * InstrumentTrack::loadInstrument(const QString & _plugin_name,
 
 
 
+Instrument * InstrumentTrack::switchInstrument(const QString & pluginName,
+	const Plugin::Descriptor::SubPluginFeatures::Key * key, bool keyFromDnd)
+{
+	// how many replaced instruments a preview track keeps
+	const size_t WarmInstrumentsMax = 3;
+
+	m_instrumentDeferred = false;
+	m_deferredInstrument = QDomDocument();
+
+	if (!m_previewMode)
+	{
+		delete m_instrument;
+		m_instrument = nullptr;
+		if (!pluginName.isEmpty())
+		{
+			m_instrument = Instrument::instantiate(pluginName, this, key, keyFromDnd);
+		}
+		return m_instrument;
+	}
+
+	if (m_instrument != nullptr)
+	{
+		// its instrument play handle went with the notes
+		m_warmInstruments.insert(m_warmInstruments.begin(), m_instrument);
+		m_instrument = nullptr;
+	}
+
+	// plugins guessed from a dropped file aren't known by name yet
+	const auto warm = keyFromDnd ? m_warmInstruments.end() : std::find_if(
+		m_warmInstruments.begin(), m_warmInstruments.end(), [&](const Instrument * instrument)
+		{
+			return instrument->nodeName() == pluginName &&
+				instrument->key().attributes == (key ? key->attributes : Plugin::Descriptor::SubPluginFeatures::Key::AttributeMap());
+		});
+	if (warm != m_warmInstruments.end())
+	{
+		m_instrument = *warm;
+		m_warmInstruments.erase(warm);
+		if (m_instrument->flags().testFlag(Instrument::IsSingleStreamed))
+		{
+			Engine::audioEngine()->addPlayHandle(new InstrumentPlayHandle(m_instrument, this));
+		}
+	}
+	else
+	{
+		m_instrument = Instrument::instantiate(pluginName, this, key, keyFromDnd);
+	}
+
+	while (m_warmInstruments.size() > WarmInstrumentsMax)
+	{
+		delete m_warmInstruments.back();
+		m_warmInstruments.pop_back();
+	}
+	return m_instrument;
+}
+
+
+
+
+void InstrumentTrack::instantiateInstrument()
+{
+	m_instrumentRequested = false;
+	if (!m_instrumentDeferred)
+	{
+		return;
+	}
+
+	// switchInstrument() drops m_deferredInstrument
+	const QDomDocument state = m_deferredInstrument;
+	const QDomElement instrument = state.documentElement();
+	typedef Plugin::Descriptor::SubPluginFeatures::Key PluginKey;
+	PluginKey key(instrument.elementsByTagName("key").item(0).toElement());
+
+	silenceAllNotes(true);
+	lock();
+	switchInstrument(instrument.attribute("name"), &key);
+	m_instrument->restoreState(instrument.firstChildElement());
+	unlock();
+
+	emit instrumentLoaded();
+}
+
+
+
+
+void InstrumentTrack::updateIdleTimer(const QString & cls, const QString & attribute)
+{
+	if (cls != "app" || attribute != "unloadinstrumentsafter")
+	{
+		return;
+	}
+
+	// most setups never unload instruments, so their tracks don't need a timer
+	m_idleMinutes = 0;
+	if (ConfigManager::inst()->value(cls, attribute).toInt() > 0)
+	{
+		m_idleTimer.start(IdleCheckInterval);
+	}
+	else
+	{
+		m_idleTimer.stop();
+	}
+}
+
+
+
+
+void InstrumentTrack::unloadIdleInstrument()
+{
+	const int minutes = ConfigManager::inst()->value("app", "unloadinstrumentsafter").toInt();
+	if (m_instrumentActive.exchange(false) || minutes <= 0)
+	{
+		m_idleMinutes = 0;
+		return;
+	}
+	++m_idleMinutes;
+
+	const Song * song = Engine::getSong();
+	if (m_idleMinutes < minutes || m_instrument == nullptr || m_instrumentWindowShown ||
+		m_freeze.isFrozen() || song->isPlaying() || song->isExporting() || activeNoteCount() > 0)
+	{
+		return;
+	}
+
+	QDomDocument state;
+	state.appendChild(saveInstrumentState(state));
+	if (!canDeferInstrument(state.documentElement()))
+	{
+		return;
+	}
+
+	silenceAllNotes(true);
+	lock();
+	switchInstrument(QString(), nullptr);
+	m_deferredInstrument = state;
+	m_instrumentDeferred = true;
+	unlock();
+
+	emit instrumentLoaded();
+}
+
+
+
+
+QDomElement InstrumentTrack::saveInstrumentState( QDomDocument & doc )
+{
+	QDomElement i = doc.createElement( "instrument" );
+	i.setAttribute( "name", m_instrument->descriptor()->name );
+	QDomElement ins = m_instrument->saveState( doc, i );
+	if(m_instrument->key().isValid()) {
+		ins.appendChild( m_instrument->key().saveXML( doc ) );
+	}
+	return i;
+}
+
+
+
+
+bool InstrumentTrack::canDeferInstrument( const QDomElement & state ) const
+{
+	// beat/bassline tracks are rendered into a cache ahead of playing
+	if( m_previewMode || trackContainer() == Engine::getBBTrackContainer() )
+	{
+		return false;
+	}
+	const QString name = state.attribute( "name" );
+	return std::any_of( std::begin( DeferrableInstruments ), std::end( DeferrableInstruments ),
+				[&name]( const char * instrument ) { return name == instrument; } ) &&
+		!refersToModels( state );
+}
+
+
+
+
+void InstrumentTrack::requestInstrument()
+{
+	if( !m_instrumentRequested.exchange( true ) )
+	{
+		QMetaObject::invokeMethod( this, "instantiateInstrument", Qt::QueuedConnection );
+	}
+}
+
+
+
+
 InstrumentTrack *InstrumentTrack::s_autoAssignedTrack = nullptr;
 
 /*! \brief Automatically assign a midi controller to this track, based on the midiautoassign setting
@@ -30,6 +30,7 @@
 #include "InstrumentTrack.h"
 #include "PianoRoll.h"
 
+#include <algorithm>
 #include <limits>
 
 
@@ -44,7 +45,8 @@ MidiClip::MidiClip( InstrumentTrack * _instrument_track ) :
 	Clip( _instrument_track ),
 	m_instrumentTrack( _instrument_track ),
 	m_clipType( BeatClip ),
-	m_steps( TimePos::stepsPerBar() )
+	m_steps( TimePos::stepsPerBar() ),
+	m_playbackCursor( 0 )
 {
 	if( _instrument_track->trackContainer()
 					== Engine::getBBTrackContainer() )
@@ -62,7 +64,8 @@ MidiClip::MidiClip( const MidiClip& other ) :
 	Clip( other.m_instrumentTrack ),
 	m_instrumentTrack( other.m_instrumentTrack ),
 	m_clipType( other.m_clipType ),
-	m_steps( other.m_steps )
+	m_steps( other.m_steps ),
+	m_playbackCursor( 0 )
 {
 	for( NoteVector::ConstIterator it = other.m_notes.begin(); it != other.m_notes.end(); ++it )
 	{
@@ -216,6 +219,42 @@ Note * MidiClip::addNote( const Note & _new_note, const bool _quant_pos )
 
 
 
+void MidiClip::addNotes( const std::vector<Note> & newNotes, const bool quantPos )
+{
+	if( newNotes.empty() )
+	{
+		return;
+	}
+
+	NoteVector added;
+	added.reserve( static_cast<int>( newNotes.size() ) );
+	for( const Note & note : newNotes )
+	{
+		Note * newNote = new Note( note );
+		if( quantPos && getGUI()->pianoRoll() )
+		{
+			newNote->quantizePos( getGUI()->pianoRoll()->quantization() );
+		}
+		added.push_back( newNote );
+	}
+	// like addNote(), new notes go after existing ones at the same position
+	std::stable_sort( added.begin(), added.end(), Note::lessThan );
+
+	instrumentTrack()->lock();
+	const int oldSize = m_notes.size();
+	m_notes += added;
+	std::inplace_merge( m_notes.begin(), m_notes.begin() + oldSize, m_notes.end(), Note::lessThan );
+	instrumentTrack()->unlock();
+
+	checkType();
+	updateLength();
+
+	emit dataChanged();
+}
+
+
+
+
 void MidiClip::removeNote( Note * _note_to_del )
 {
 	instrumentTrack()->lock();
@@ -265,6 +304,37 @@ void MidiClip::rearrangeAllNotes()
 
 
 
+std::pair<NoteVector::ConstIterator, NoteVector::ConstIterator> MidiClip::notesStartingAt( const TimePos & time )
+{
+	const NoteVector & notes = m_notes;
+	const int size = notes.size();
+
+	// keep the cursor if it still separates the earlier notes from the
+	// ones at or after time, which is the case when time advanced by one
+	// tick since the last call; search the notes otherwise
+	int index = m_playbackCursor;
+	if( index > size
+		|| ( index > 0 && notes[index - 1]->pos() >= time )
+		|| ( index < size && notes[index]->pos() < time ) )
+	{
+		index = std::lower_bound( notes.begin(), notes.end(), time,
+			[]( const Note * note, const TimePos & t ) { return note->pos() < t; } )
+			- notes.begin();
+	}
+
+	int end = index;
+	while( end < size && notes[end]->pos() == time )
+	{
+		++end;
+	}
+	m_playbackCursor = end;
+
+	return std::make_pair( notes.begin() + index, notes.begin() + end );
+}
+
+
+
+
 void MidiClip::clearNotes()
 {
 	instrumentTrack()->lock();
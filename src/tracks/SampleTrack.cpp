@@ -25,12 +25,15 @@
  
 #include "SampleTrack.h"
 
+#include <cmath>
+
 #include <QDomElement>
 
 #include "BBTrack.h"
 #include "SamplePlayHandle.h"
 #include "SampleRecordHandle.h"
 #include "Song.h"
+#include "TimeLineWidget.h"
 
 
 
@@ -40,11 +43,13 @@ SampleTrack::SampleTrack(TrackContainer* tc) :
 	m_panningModel(DefaultPanning, PanningLeft, PanningRight, 0.1f, this, tr("Panning")),
 	m_mixerChannelModel(0, 0, 0, this, tr("Mixer channel")),
 	m_audioPort(tr("Sample track"), true, &m_volumeModel, &m_panningModel, &m_mutedModel),
+	m_freeze(this, &m_audioPort),
 	m_isPlaying(false)
 {
 	setName(tr("Sample track"));
 	m_panningModel.setCenterValue(DefaultPanning);
 	m_mixerChannelModel.setRange(0, Engine::mixer()->numChannels()-1, 1);
+	m_freeze.addIgnoredModel(&m_mixerChannelModel);
 
 	connect(&m_mixerChannelModel, SIGNAL(dataChanged()), this, SLOT(updateMixerChannel()));
 }
@@ -54,7 +59,18 @@ SampleTrack::SampleTrack(TrackContainer* tc) :
 
 SampleTrack::~SampleTrack()
 {
-	Engine::audioEngine()->removePlayHandlesOfTypes( this, PlayHandle::TypeSamplePlayHandle );
+	m_freeze.unfreeze();
+	Engine::audioEngine()->removePlayHandlesOfTypes( this, PlayHandle::TypeSamplePlayHandle
+							| PlayHandle::TypePatternCacheHandle );
+
+	// the voices play through m_audioPort, which is gone when ~Track()
+	// deletes the clips
+	Engine::audioEngine()->requestChangeInModel();
+	for( int i = 0; i < numOfClips(); ++i )
+	{
+		static_cast<SampleClip *>( getClip( i ) )->releaseVoice();
+	}
+	Engine::audioEngine()->doneChangeInModel();
 }
 
 
@@ -63,6 +79,11 @@ SampleTrack::~SampleTrack()
 bool SampleTrack::play( const TimePos & _start, const fpp_t _frames,
 					const f_cnt_t _offset, int _clip_num )
 {
+	if( m_freeze.play( _start, _offset, _clip_num ) )
+	{
+		return false;
+	}
+
 	m_audioPort.effects()->startRunning();
 	bool played_a_note = false; // will be return variable
 
@@ -87,12 +108,40 @@ bool SampleTrack::play( const TimePos & _start, const fpp_t _frames,
 	}
 	else
 	{
+		// clips starting within the next period get their voices ready,
+		// also the ones the loop is going to jump back to
+		const Song * song = Engine::getSong();
+		const TimeLineWidget * timeLine = song->getPlayPos( Song::Mode_PlaySong ).m_timeLine;
+		const tick_t periodTicks = static_cast<tick_t>( std::ceil(
+			Engine::audioEngine()->framesPerPeriod() / Engine::framesPerTick() ) );
+		const tick_t preRollEnd = _start.getTicks() + periodTicks;
+		tick_t loopPreRollBegin = 0;
+		tick_t loopPreRollEnd = -1;
+		if( !song->isExporting() && timeLine && timeLine->loopPointsEnabled() &&
+			preRollEnd >= timeLine->loopEnd().getTicks() )
+		{
+			loopPreRollBegin = timeLine->loopBegin().getTicks();
+			loopPreRollEnd = loopPreRollBegin + preRollEnd - timeLine->loopEnd().getTicks();
+		}
+
 		bool nowPlaying = false;
 		for( int i = 0; i < numOfClips(); ++i )
 		{
 			Clip * clip = getClip( i );
 			SampleClip * sClip = dynamic_cast<SampleClip*>( clip );
 
+			const tick_t entry = sClip->startPosition() + qMax( sClip->startTimeOffset(), TimePos( 0 ) );
+			if( !sClip->isPlaying() && !sClip->isMuted() && !sClip->isRecord() &&
+				( ( entry > _start.getTicks() && entry <= preRollEnd ) ||
+				( entry >= loopPreRollBegin && entry <= loopPreRollEnd ) ) )
+			{
+				SamplePlayHandle * voice = sClip->voice();
+				if( !voice->isPlaying() )
+				{
+					voice->rewind();
+				}
+			}
+
 			if( _start >= sClip->startPosition() && _start < sClip->endPosition() )
 			{
 				if( sClip->isPlaying() == false && _start >= (sClip->startPosition() + sClip->startTimeOffset()) )
@@ -141,7 +190,17 @@ bool SampleTrack::play( const TimePos & _start, const fpp_t _frames,
 			}
 			else
 			{
-				SamplePlayHandle* smpHandle = new SamplePlayHandle( st );
+				// the clip's voice is reused, unless it's still playing
+				// the tail of the previous pass
+				SamplePlayHandle* smpHandle = st->voice();
+				if( smpHandle->isPlaying() )
+				{
+					smpHandle = new SamplePlayHandle( st );
+				}
+				else
+				{
+					smpHandle->rewind();
+				}
 				smpHandle->setVolumeModel( &m_volumeModel );
 				smpHandle->setBBTrack( bb_track );
 				handle = smpHandle;
@@ -0,0 +1,98 @@
+/*
+ * AutomationClipBenchmark.cpp - benchmarks of automation lookups
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Benchmark.h"
+
+#include <utility>
+#include <vector>
+
+#include "AutomationClip.h"
+
+
+class AutomationClipBenchmark : BenchmarkSuite
+{
+public:
+	void run(BenchmarkRunner & runner) override
+	{
+		const struct
+		{
+			AutomationClip::ProgressionTypes type;
+			const char * name;
+		} progressions[] = {
+			{ AutomationClip::DiscreteProgression, "discrete" },
+			{ AutomationClip::LinearProgression, "linear" },
+			{ AutomationClip::CubicHermiteProgression, "cubicHermite" } };
+
+		// a node every sixteenth over 64 bars
+		const int nodes = 1024;
+		const int nodeDistance = TimePos::ticksPerBar() / 16;
+		const int length = nodes * nodeDistance;
+
+		BenchmarkNoise noise;
+		std::vector<std::pair<TimePos, float>> values;
+		for (int i = 0; i < nodes; ++i)
+		{
+			values.emplace_back(TimePos(i * nodeDistance), 0.5f + 0.5f * noise.next());
+		}
+
+		// playback reads one position after the other, seeking and the
+		// editors read anywhere
+		std::vector<TimePos> randomPositions;
+		for (int i = 0; i < 1024; ++i)
+		{
+			randomPositions.emplace_back(static_cast<int>((0.5f + 0.5f * noise.next()) * length));
+		}
+
+		for (const auto & progression : progressions)
+		{
+			AutomationClip clip(nullptr);
+			clip.setProgressionType(progression.type);
+			clip.putValues(values, false);
+
+			int tick = 0;
+			runner.measure(QString("AutomationClip/%1/sequential").arg(progression.name),
+						TimePos::ticksPerBar(), [&]
+			{
+				float sum = 0.0f;
+				for (int i = 0; i < TimePos::ticksPerBar(); ++i)
+				{
+					sum += clip.valueAt(tick);
+					tick = (tick + 1) % length;
+				}
+				BenchmarkRunner::keep(sum);
+			});
+
+			runner.measure(QString("AutomationClip/%1/random").arg(progression.name),
+						randomPositions.size(), [&]
+			{
+				float sum = 0.0f;
+				for (const TimePos & position : randomPositions)
+				{
+					sum += clip.valueAt(position);
+				}
+				BenchmarkRunner::keep(sum);
+			});
+		}
+	}
+} AutomationClipBenchmarks;
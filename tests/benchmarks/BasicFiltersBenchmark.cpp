@@ -0,0 +1,90 @@
+/*
+ * BasicFiltersBenchmark.cpp - benchmarks of the basic filter types
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "AudioEngine.h"
+#include "BasicFilters.h"
+#include "Engine.h"
+
+
+class BasicFiltersBenchmark : BenchmarkSuite
+{
+public:
+	void run(BenchmarkRunner & runner) override
+	{
+		using Filters = BasicFilters<>;
+		const char * const typeNames[] = { "lowPass", "hiPass", "bandPassCsg", "bandPassCzpg",
+			"notch", "allPass", "moog", "doubleLowPass", "lowpassRc12", "bandpassRc12",
+			"highpassRc12", "lowpassRc24", "bandpassRc24", "highpassRc24", "formant",
+			"doubleMoog", "lowpassSv", "bandpassSv", "highpassSv", "notchSv", "fastFormant",
+			"tripole" };
+		static_assert(sizeof(typeNames) / sizeof(*typeNames) == Filters::NumFilters, "");
+
+		const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
+		const sample_rate_t sampleRate = Engine::audioEngine()->processingSampleRate();
+
+		BenchmarkNoise noise;
+		std::vector<sampleFrame> input(frames), buf(frames);
+		for (sampleFrame & frame : input)
+		{
+			frame[0] = noise.next();
+			frame[1] = noise.next();
+		}
+
+		// envelopes and LFOs move the cutoff, so the coefficients are
+		// calculated for frequencies spread over the audible range
+		std::vector<float> cutoffs(64);
+		for (size_t i = 0; i < cutoffs.size(); ++i)
+		{
+			cutoffs[i] = 40.0f * std::pow(500.0f, i / static_cast<float>(cutoffs.size()));
+		}
+
+		for (int type = 0; type < Filters::NumFilters; ++type)
+		{
+			Filters filter(sampleRate);
+			filter.setFilterType(type);
+			filter.calcFilterCoeffs(1000.0f, 0.5f);
+
+			// filtering the same input every time keeps the state from
+			// decaying into denormals or growing with resonance
+			runner.measure(QString("BasicFilters/%1/process").arg(typeNames[type]), frames, [&]
+			{
+				std::copy(input.begin(), input.end(), buf.begin());
+				filter.process(buf.data(), frames);
+			});
+
+			size_t cutoff = 0;
+			runner.measure(QString("BasicFilters/%1/calcFilterCoeffs").arg(typeNames[type]), 1, [&]
+			{
+				filter.calcFilterCoeffs(cutoffs[cutoff], 0.5f);
+				cutoff = (cutoff + 1) % cutoffs.size();
+			});
+		}
+	}
+} BasicFiltersBenchmarks;
@@ -0,0 +1,109 @@
+/*
+ * Benchmark.cpp - micro-benchmarks of engine components
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Benchmark.h"
+
+#include <algorithm>
+
+#include <QJsonObject>
+
+
+volatile float BenchmarkRunner::s_sink = 0.0f;
+
+
+BenchmarkRunner::BenchmarkRunner(const QRegularExpression & filter, int samples,
+					qint64 minSampleTimeMs, qint64 iterations) :
+	m_filter(filter),
+	m_samples(std::max(samples, 1)),
+	m_minSampleTime(minSampleTimeMs * 1000000),
+	m_iterations(iterations)
+{
+}
+
+
+
+
+void BenchmarkRunner::addResult(const QString & name, qint64 items, qint64 iterations,
+					std::vector<qint64> & samples)
+{
+	std::sort(samples.begin(), samples.end());
+	const auto perIteration = [iterations](qint64 ns)
+	{
+		return ns / static_cast<double>(iterations);
+	};
+	const double median = perIteration(samples[samples.size() / 2]);
+
+	m_results.append(QJsonObject{
+		{ "name", name },
+		{ "iterations", iterations },
+		{ "samples", static_cast<qint64>(samples.size()) },
+		{ "nsPerIteration", QJsonObject{
+			{ "min", perIteration(samples.front()) },
+			{ "median", median },
+			{ "max", perIteration(samples.back()) } } },
+		{ "itemsPerIteration", items },
+		{ "itemsPerSecond", median > 0 ? items * 1e9 / median : 0.0 } });
+}
+
+
+
+
+BenchmarkSuite::BenchmarkSuite()
+{
+	suites() << this;
+}
+
+
+
+
+BenchmarkSuite::~BenchmarkSuite()
+{
+	suites().removeAll(this);
+}
+
+
+
+
+QList<BenchmarkSuite *> & BenchmarkSuite::suites()
+{
+	// a function-local static, as the suites are created during static
+	// initialization of the other translation units
+	static QList<BenchmarkSuite *> suites;
+	return suites;
+}
+
+
+
+
+const char * kernelsName(MixHelpers::Kernels kernels)
+{
+	switch (kernels)
+	{
+		case MixHelpers::Kernels::SSE2: return "sse2";
+		case MixHelpers::Kernels::AVX: return "avx";
+		case MixHelpers::Kernels::AVX512: return "avx512";
+		case MixHelpers::Kernels::NEON: return "neon";
+		default: return "generic";
+	}
+}
@@ -0,0 +1,174 @@
+/*
+ * Benchmark.h - micro-benchmarks of engine components
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstdint>
+#include <vector>
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+
+#include "MixHelpers.h"
+
+
+//! Measures single operations and collects the results. An operation is run
+//! in batches of a fixed number of iterations, which the first batch finds
+//! unless it's given, and the time of each batch becomes a sample.
+class BenchmarkRunner
+{
+public:
+	BenchmarkRunner(const QRegularExpression & filter, int samples, qint64 minSampleTimeMs,
+			qint64 iterations);
+
+	//! Whether the benchmark @p name matches the filter
+	bool selected(const QString & name) const
+	{
+		return m_filter.match(name).hasMatch();
+	}
+
+	//! Measures @p iteration, which processes @p items items (e.g. frames)
+	//! each time it's called
+	template<typename F>
+	void measure(const QString & name, qint64 items, F && iteration)
+	{
+		m_names << name;
+		if (!selected(name))
+		{
+			return;
+		}
+
+		auto batch = [&iteration](qint64 iterations)
+		{
+			QElapsedTimer timer;
+			timer.start();
+			for (qint64 i = 0; i < iterations; ++i)
+			{
+				iteration();
+			}
+			return timer.nsecsElapsed();
+		};
+
+		// finding the iterations warms up caches and branch predictors, too
+		qint64 iterations = m_iterations;
+		if (iterations > 0)
+		{
+			batch(iterations);
+		}
+		else
+		{
+			iterations = 1;
+			while (batch(iterations) < m_minSampleTime)
+			{
+				iterations *= 2;
+			}
+		}
+
+		std::vector<qint64> samples;
+		for (int i = 0; i < m_samples; ++i)
+		{
+			samples.push_back(batch(iterations));
+		}
+		addResult(name, items, iterations, samples);
+	}
+
+	//! Keeps the compiler from dropping computations whose results are unused
+	static void keep(float value)
+	{
+		s_sink = value;
+	}
+
+	const QJsonArray & results() const
+	{
+		return m_results;
+	}
+
+	//! The names of all benchmarks, whether they were run or not
+	const QStringList & names() const
+	{
+		return m_names;
+	}
+
+private:
+	void addResult(const QString & name, qint64 items, qint64 iterations,
+			std::vector<qint64> & samples);
+
+	const QRegularExpression m_filter;
+	const int m_samples;
+	const qint64 m_minSampleTime;
+	const qint64 m_iterations;
+	QJsonArray m_results;
+	QStringList m_names;
+
+	static volatile float s_sink;
+} ;
+
+
+
+
+//! A group of benchmarks. Instances register themselves, like QTestSuite.
+class BenchmarkSuite
+{
+public:
+	BenchmarkSuite();
+	virtual ~BenchmarkSuite();
+
+	virtual void run(BenchmarkRunner & runner) = 0;
+
+	static QList<BenchmarkSuite *> & suites();
+} ;
+
+
+
+
+//! Deterministic noise in [-1, 1], so that every run measures the same input
+class BenchmarkNoise
+{
+public:
+	explicit BenchmarkNoise(std::uint32_t seed = 1) :
+		m_state(seed)
+	{
+	}
+
+	float next()
+	{
+		m_state = m_state * 1664525u + 1013904223u;
+		return static_cast<std::int32_t>(m_state) / 2147483648.0f;
+	}
+
+private:
+	std::uint32_t m_state;
+} ;
+
+
+//! Short name of @p kernels for benchmark names and reports
+const char * kernelsName(MixHelpers::Kernels kernels);
+
+
+#endif
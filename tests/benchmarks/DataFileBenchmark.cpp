@@ -0,0 +1,106 @@
+/*
+ * DataFileBenchmark.cpp - benchmarks of loading and saving projects
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Benchmark.h"
+
+#include <QTextStream>
+
+#include "DataFile.h"
+
+
+//! A project of LMMS 0.4.0 with @p tracks tracks of 64 notes each, which goes
+//! through all of the upgrades since then
+static QByteArray legacyProject(int tracks)
+{
+	QByteArray xml =
+		"<?xml version=\"1.0\"?>\n"
+		"<!DOCTYPE multimediaproject>\n"
+		"<multimediaproject type=\"song\" creatorversion=\"0.4.0-20080601\">\n"
+		"<head bpm=\"140\"/>\n"
+		"<song>\n"
+		"<trackcontainer type=\"song\">\n";
+	for (int i = 0; i < tracks; ++i)
+	{
+		xml += "<track type=\"0\" name=\"Track\">\n"
+			"<instrumenttrack vol=\"100\" basenote=\"57\">\n"
+			"<instrument name=\"tripleoscillator\"><tripleoscillator/></instrument>\n"
+			"<midi inputcontroller=\"0\"/>\n"
+			"<automation-pattern/>\n"
+			"</instrumenttrack>\n"
+			"<pattern pos=\"0\" len=\"768\" name=\"Track\">\n";
+		for (int note = 0; note < 64; ++note)
+		{
+			xml += "<note pos=\"" + QByteArray::number(note * 12) + "\" len=\"12\" key=\"" +
+				QByteArray::number(48 + note % 24) + "\" vol=\"100\"/>\n";
+		}
+		xml += "</pattern>\n"
+			"</track>\n";
+	}
+	xml += "</trackcontainer>\n"
+		"</song>\n"
+		"</multimediaproject>\n";
+	return xml;
+}
+
+
+
+
+static QString save(DataFile & dataFile)
+{
+	QString xml;
+	QTextStream stream(&xml);
+	dataFile.write(stream);
+	stream.flush();
+	return xml;
+}
+
+
+
+
+class DataFileBenchmark : BenchmarkSuite
+{
+public:
+	void run(BenchmarkRunner & runner) override
+	{
+		// the items are bytes of XML
+		const QByteArray legacy = legacyProject(100);
+		DataFile upgraded(legacy);
+		const QByteArray current = save(upgraded).toUtf8();
+
+		runner.measure("DataFile/loadLegacy", legacy.size(), [&]
+		{
+			DataFile dataFile(legacy);
+			BenchmarkRunner::keep(dataFile.content().childNodes().count());
+		});
+		runner.measure("DataFile/load", current.size(), [&]
+		{
+			DataFile dataFile(current);
+			BenchmarkRunner::keep(dataFile.content().childNodes().count());
+		});
+		runner.measure("DataFile/save", current.size(), [&]
+		{
+			BenchmarkRunner::keep(save(upgraded).size());
+		});
+	}
+} DataFileBenchmarks;
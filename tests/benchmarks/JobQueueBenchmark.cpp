@@ -0,0 +1,108 @@
+/*
+ * JobQueueBenchmark.cpp - benchmarks of the worker threads' job scheduling
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Benchmark.h"
+
+#include <memory>
+#include <vector>
+
+#include <QVector>
+
+#include "AudioEngineWorkerThread.h"
+#include "ThreadableJob.h"
+
+
+namespace
+{
+
+//! A job doing a fixed amount of arithmetic, like a small play handle
+class BenchmarkJob : public ThreadableJob
+{
+public:
+	explicit BenchmarkJob(int work) :
+		m_work(work)
+	{
+	}
+
+	bool requiresProcessing() const override
+	{
+		return true;
+	}
+
+protected:
+	void doProcessing() override
+	{
+		float y = 0.0f;
+		for (int i = 0; i < m_work; ++i)
+		{
+			y = y * 0.999f + i * 1e-6f;
+		}
+		m_result = y;
+	}
+
+private:
+	const int m_work;
+	float m_result = 0.0f;
+} ;
+
+}
+
+
+
+
+class JobQueueBenchmark : BenchmarkSuite
+{
+public:
+	void run(BenchmarkRunner & runner) override
+	{
+		// the cost of starting a stage and waiting for it, without any work
+		const QVector<BenchmarkJob *> none;
+		runner.measure("JobQueue/empty", 1, [&]
+		{
+			AudioEngineWorkerThread::fillJobQueue(none);
+			AudioEngineWorkerThread::startAndWaitForJobs();
+		});
+
+		// few jobs keep most workers idle, many short ones make the
+		// scheduling itself the bottleneck
+		for (int count : { 1, 16, 64, 256 })
+		{
+			for (int work : { 64, 4096 })
+			{
+				std::vector<std::unique_ptr<BenchmarkJob>> jobs;
+				QVector<BenchmarkJob *> queue;
+				for (int i = 0; i < count; ++i)
+				{
+					jobs.emplace_back(new BenchmarkJob(work));
+					queue << jobs.back().get();
+				}
+				runner.measure(QString("JobQueue/%1x%2").arg(count).arg(work), count, [&]
+				{
+					AudioEngineWorkerThread::fillJobQueue(queue);
+					AudioEngineWorkerThread::startAndWaitForJobs();
+				});
+			}
+		}
+	}
+} JobQueueBenchmarks;
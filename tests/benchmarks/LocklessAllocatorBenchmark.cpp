@@ -0,0 +1,123 @@
+/*
+ * LocklessAllocatorBenchmark.cpp - benchmarks of the lockless allocator and
+ *                                  list with several threads
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Benchmark.h"
+
+#include <thread>
+#include <vector>
+
+#include "LocklessAllocator.h"
+#include "LocklessList.h"
+
+
+namespace
+{
+
+// like the engine's queues of new play handles and MIDI events
+constexpr size_t Capacity = 1024;
+constexpr int OpsPerThread = 20000;
+
+//! Runs @p work on @p threads threads at once and waits for them
+template<typename F>
+void runThreads(int threads, F && work)
+{
+	std::vector<std::thread> running;
+	for (int t = 0; t < threads; ++t)
+	{
+		running.emplace_back(work);
+	}
+	for (std::thread & thread : running)
+	{
+		thread.join();
+	}
+}
+
+}
+
+
+
+
+class LocklessAllocatorBenchmark : BenchmarkSuite
+{
+public:
+	void run(BenchmarkRunner & runner) override
+	{
+		for (int threads : { 1, 2, 4, 8 })
+		{
+			// bursts of allocations freed by the same thread
+			LocklessAllocator allocator(Capacity, sizeof(void *) * 2);
+			runner.measure(QString("LocklessAllocator/burst/%1").arg(threads),
+				static_cast<qint64>(threads) * OpsPerThread, [&]
+			{
+				runThreads(threads, [&]
+				{
+					void * burst[8];
+					for (int i = 0; i < OpsPerThread; i += 8)
+					{
+						for (void * & element : burst)
+						{
+							element = allocator.alloc();
+						}
+						for (void * element : burst)
+						{
+							allocator.free(element);
+						}
+					}
+				});
+			});
+
+			// threads pushing events, one of them taking and freeing the
+			// list every now and then, like the audio thread does
+			LocklessList<int> list(Capacity);
+			runner.measure(QString("LocklessList/pushPop/%1").arg(threads),
+				static_cast<qint64>(threads) * OpsPerThread, [&]
+			{
+				runThreads(threads, [&]
+				{
+					for (int i = 0; i < OpsPerThread; ++i)
+					{
+						if (!list.push(i) || i % 64 == 0)
+						{
+							auto e = list.popList();
+							while (e)
+							{
+								auto next = e->next;
+								list.free(e);
+								e = next;
+							}
+						}
+					}
+				});
+				auto e = list.popList();
+				while (e)
+				{
+					auto next = e->next;
+					list.free(e);
+					e = next;
+				}
+			});
+		}
+	}
+} LocklessAllocatorBenchmarks;
@@ -0,0 +1,139 @@
+/*
+ * MixHelpersBenchmark.cpp - benchmarks of the mixing helpers
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Benchmark.h"
+
+#include <vector>
+
+#include "AudioEngine.h"
+#include "Engine.h"
+#include "MixHelpers.h"
+#include "ValueBuffer.h"
+
+
+class MixHelpersBenchmark : BenchmarkSuite
+{
+public:
+	void run(BenchmarkRunner & runner) override
+	{
+		using MixHelpers::Kernels;
+		const int frames = Engine::audioEngine()->framesPerPeriod();
+
+		BenchmarkNoise noise;
+		std::vector<sampleFrame> src(frames), dst(frames);
+		ValueBuffer coeffs1(frames), coeffs2(frames);
+		std::vector<sample_t> left(frames), right(frames);
+		for (int f = 0; f < frames; ++f)
+		{
+			src[f][0] = noise.next();
+			src[f][1] = noise.next();
+			dst[f][0] = noise.next();
+			dst[f][1] = noise.next();
+			coeffs1[f] = 0.5f + 0.5f * noise.next();
+			coeffs2[f] = 0.5f + 0.5f * noise.next();
+			left[f] = src[f][0];
+			right[f] = src[f][1];
+		}
+		std::vector<int_sample_t> s16(frames * DEFAULT_CHANNELS);
+		std::vector<int32_t> s24(frames * DEFAULT_CHANNELS);
+
+		// the helpers add to dst over and over, which only grows linearly
+		const Kernels initial = MixHelpers::kernels();
+		for (Kernels k : { Kernels::Generic, Kernels::SSE2, Kernels::AVX, Kernels::AVX512,
+					Kernels::NEON })
+		{
+			if (!MixHelpers::setKernels(k))
+			{
+				continue;
+			}
+			const QString prefix = QString("MixHelpers/%1/").arg(kernelsName(k));
+			sampleFrame * d = dst.data();
+			const sampleFrame * s = src.data();
+
+			runner.measure(prefix + "add", frames, [&]
+			{
+				MixHelpers::add(d, s, frames);
+			});
+			runner.measure(prefix + "addMultiplied", frames, [&]
+			{
+				MixHelpers::addMultiplied(d, s, 0.7f, frames);
+			});
+			runner.measure(prefix + "addSanitizedMultiplied", frames, [&]
+			{
+				MixHelpers::addSanitizedMultiplied(d, s, 0.7f, frames);
+			});
+			runner.measure(prefix + "addMultipliedByBuffers", frames, [&]
+			{
+				MixHelpers::addMultipliedByBuffers(d, s, &coeffs1, &coeffs2, frames);
+			});
+			runner.measure(prefix + "addSanitizedMultipliedWithPeak", frames, [&]
+			{
+				const sampleFrame peak = MixHelpers::addSanitizedMultipliedWithPeak(
+								d, s, 0.7f, &coeffs1, nullptr, frames);
+				BenchmarkRunner::keep(peak[0]);
+			});
+			runner.measure(prefix + "multiplyAndAddMultipliedJoined", frames, [&]
+			{
+				MixHelpers::multiplyAndAddMultipliedJoined(d, left.data(), right.data(),
+										0.5f, 0.7f, frames);
+			});
+			runner.measure(prefix + "copyMultiplied", frames, [&]
+			{
+				MixHelpers::copyMultiplied(d, s, 0.7f, frames);
+			});
+			runner.measure(prefix + "applyVolumeAndPanning", frames, [&]
+			{
+				MixHelpers::copyMultiplied(d, s, 1.0f, frames);
+				MixHelpers::applyVolumeAndPanning(d, 0.7f, nullptr, 0.3f, nullptr,
+								MixHelpers::PanLaw::ConstantPower, frames);
+			});
+			runner.measure(prefix + "peak", frames, [&]
+			{
+				BenchmarkRunner::keep(MixHelpers::peak(s, frames)[0]);
+			});
+			runner.measure(prefix + "energy", frames, [&]
+			{
+				BenchmarkRunner::keep(MixHelpers::energy(s, frames));
+			});
+			runner.measure(prefix + "isSilent", frames, [&]
+			{
+				BenchmarkRunner::keep(MixHelpers::isSilent(s, frames));
+			});
+			runner.measure(prefix + "sanitize", frames, [&]
+			{
+				BenchmarkRunner::keep(MixHelpers::sanitize(d, frames));
+			});
+			runner.measure(prefix + "convertToS16", frames, [&]
+			{
+				MixHelpers::convertToS16(s16.data(), s, 1.0f, nullptr, false, frames);
+			});
+			runner.measure(prefix + "convertToS24", frames, [&]
+			{
+				MixHelpers::convertToS24(s24.data(), s, 1.0f, nullptr, frames);
+			});
+		}
+		MixHelpers::setKernels(initial);
+	}
+
+} MixHelpersBenchmarks;
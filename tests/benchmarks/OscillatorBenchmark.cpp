@@ -0,0 +1,118 @@
+/*
+ * OscillatorBenchmark.cpp - benchmarks of the oscillator's wave shapes and
+ *                           modulations
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Benchmark.h"
+
+#include <cmath>
+#include <vector>
+
+#include <QThread>
+
+#include "AudioEngine.h"
+#include "AutomatableModel.h"
+#include "Engine.h"
+#include "Oscillator.h"
+#include "SampleBuffer.h"
+#include "lmms_constants.h"
+
+
+class OscillatorBenchmark : BenchmarkSuite
+{
+public:
+	void run(BenchmarkRunner & runner) override
+	{
+		const char * const shapeNames[] = { "sine", "triangle", "saw", "square", "moogSaw",
+						"exponential", "whiteNoise", "userDefined" };
+		const char * const algoNames[] = { "phase", "amplitude", "mix", "sync", "frequency" };
+		static_assert(sizeof(shapeNames) / sizeof(*shapeNames) == Oscillator::NumWaveShapes, "");
+		static_assert(sizeof(algoNames) / sizeof(*algoNames) == Oscillator::NumModulationAlgos, "");
+
+		// the band-limited tables are built in the background after start
+		for (int shape = Oscillator::FirstWaveShapeTable;
+			shape < Oscillator::FirstWaveShapeTable + Oscillator::NumWaveShapeTables; ++shape)
+		{
+			while (!Oscillator::waveTableReady(static_cast<Oscillator::WaveShapes>(shape)))
+			{
+				QThread::msleep(10);
+			}
+		}
+
+		const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
+		std::vector<sampleFrame> buf(frames);
+
+		std::vector<sampleFrame> cycle(256);
+		for (size_t f = 0; f < cycle.size(); ++f)
+		{
+			cycle[f][0] = cycle[f][1] = std::sin(F_2PI * f / cycle.size());
+		}
+		SampleBuffer userWave(cycle.data(), cycle.size());
+
+		const float freq = 440.0f;
+		const float detuning = 1.0f / Engine::audioEngine()->processingSampleRate();
+		const float phaseOffset = 0.0f;
+		const float volume = 1.0f;
+		IntModel algoModel(Oscillator::SignalMix, 0, Oscillator::NumModulationAlgos - 1);
+
+		for (int shape = 0; shape < Oscillator::NumWaveShapes; ++shape)
+		{
+			const bool hasTable = shape >= Oscillator::FirstWaveShapeTable &&
+				shape < Oscillator::FirstWaveShapeTable + Oscillator::NumWaveShapeTables;
+			IntModel shapeModel(shape, 0, Oscillator::NumWaveShapes - 1);
+			for (bool bandLimited : { false, true })
+			{
+				if (bandLimited && !hasTable)
+				{
+					continue;
+				}
+				Oscillator osc(&shapeModel, &algoModel, freq, detuning, phaseOffset, volume);
+				osc.setUserWave(&userWave);
+				osc.setUseWaveTable(bandLimited);
+				runner.measure(QString("Oscillator/%1/%2").arg(shapeNames[shape],
+							bandLimited ? "bandLimited" : "plain"), frames, [&]
+				{
+					osc.update(buf.data(), frames, 0);
+				});
+			}
+		}
+
+		// a saw modulated by a sine, with the tables as instruments use them
+		IntModel sawModel(Oscillator::SawWave, 0, Oscillator::NumWaveShapes - 1);
+		IntModel sineModel(Oscillator::SineWave, 0, Oscillator::NumWaveShapes - 1);
+		const float modulatorFreq = 220.0f;
+		for (int algo = 0; algo < Oscillator::NumModulationAlgos; ++algo)
+		{
+			IntModel carrierAlgo(algo, 0, Oscillator::NumModulationAlgos - 1);
+			Oscillator * modulator = new Oscillator(&sineModel, &algoModel, modulatorFreq,
+							detuning, phaseOffset, volume);
+			Oscillator osc(&sawModel, &carrierAlgo, freq, detuning, phaseOffset, volume, modulator);
+			osc.setUseWaveTable(true);
+			modulator->setUseWaveTable(true);
+			runner.measure(QString("Oscillator/modulation/%1").arg(algoNames[algo]), frames, [&]
+			{
+				osc.update(buf.data(), frames, 0);
+			});
+		}
+	}
+} OscillatorBenchmarks;
@@ -0,0 +1,91 @@
+/*
+ * SampleBufferBenchmark.cpp - benchmarks of sample playback per interpolation
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Benchmark.h"
+
+#include <vector>
+
+#include "AudioEngine.h"
+#include "Engine.h"
+#include "Note.h"
+#include "SampleBuffer.h"
+
+
+class SampleBufferBenchmark : BenchmarkSuite
+{
+public:
+	void run(BenchmarkRunner & runner) override
+	{
+		const struct
+		{
+			int mode;
+			const char * name;
+		} interpolations[] = {
+			{ SRC_ZERO_ORDER_HOLD, "zeroOrderHold" },
+			// upgraded to cubic unless the engine renders in draft quality
+			{ SRC_LINEAR, "linear" },
+			{ SRC_SINC_FASTEST, "sincFastest" },
+			{ SRC_SINC_MEDIUM_QUALITY, "sincMedium" },
+			{ SRC_SINC_BEST_QUALITY, "sincBest" } };
+
+		const fpp_t frames = Engine::audioEngine()->framesPerPeriod();
+		std::vector<sampleFrame> buf(frames);
+
+		// two seconds, so playback runs through memory instead of the cache
+		BenchmarkNoise noise;
+		std::vector<sampleFrame> data(2 * Engine::audioEngine()->processingSampleRate());
+		for (sampleFrame & frame : data)
+		{
+			frame[0] = noise.next();
+			frame[1] = noise.next();
+		}
+		SampleBuffer sample(data.data(), data.size());
+
+		for (const auto & interpolation : interpolations)
+		{
+			// a fifth up, and a pitch bend which changes the ratio every period
+			for (bool varyingPitch : { false, true })
+			{
+				SampleBuffer::handleState state(varyingPitch, interpolation.mode);
+				float freq = DefaultBaseFreq * 1.5f;
+				runner.measure(QString("SampleBuffer/%1/%2").arg(interpolation.name,
+						varyingPitch ? "varyingPitch" : "constantPitch"), frames, [&]
+				{
+					sample.play(buf.data(), &state, frames, freq, SampleBuffer::LoopOn);
+					if (varyingPitch)
+					{
+						freq = freq < DefaultBaseFreq * 1.6f ? freq * 1.001f : DefaultBaseFreq * 1.4f;
+					}
+				});
+			}
+		}
+
+		// without resampling, as for samples at the engine's rate and pitch
+		SampleBuffer::handleState state;
+		runner.measure("SampleBuffer/basePitch", frames, [&]
+		{
+			sample.play(buf.data(), &state, frames, DefaultBaseFreq, SampleBuffer::LoopOn);
+		});
+	}
+} SampleBufferBenchmarks;
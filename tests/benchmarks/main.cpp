@@ -0,0 +1,127 @@
+/*
+ * main.cpp - runs the engine micro-benchmarks and writes the results as JSON
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "Benchmark.h"
+
+#include <cstdio>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+
+#include "AudioEngine.h"
+#include "Engine.h"
+#include "MixHelpers.h"
+#include "denormals.h"
+#include "lmmsversion.h"
+
+
+int main(int argc, char * argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Runs micro-benchmarks of the engine and writes "
+					"the results as JSON to standard output");
+	parser.addHelpOption();
+	const QCommandLineOption filterOption("filter",
+		"Only run the benchmarks whose names match <regexp>.", "regexp", ".");
+	const QCommandLineOption samplesOption("samples",
+		"Measure <n> batches of each benchmark.", "n", "15");
+	const QCommandLineOption minTimeOption("min-time",
+		"Make a batch take at least <ms> milliseconds.", "ms", "20");
+	const QCommandLineOption iterationsOption("iterations",
+		"Run <n> iterations per batch instead of finding them, so that runs to be "
+		"compared do the same work.", "n", "0");
+	const QCommandLineOption outputOption("output",
+		"Write the results to <file> instead.", "file");
+	const QCommandLineOption listOption("list", "List the benchmarks without running them.");
+	parser.addOptions({ filterOption, samplesOption, minTimeOption, iterationsOption,
+				outputOption, listOption });
+	parser.process(app);
+
+	const QRegularExpression filter(parser.value(filterOption));
+	if (!filter.isValid())
+	{
+		fprintf(stderr, "Invalid filter: %s\n", filter.errorString().toUtf8().constData());
+		return EXIT_FAILURE;
+	}
+
+	// like the engine's threads, so that denormals don't distort the results
+	disable_denormals();
+	Engine::init(true);
+
+	// listing runs the suites with a filter nothing matches, which only
+	// asks for the names
+	const bool list = parser.isSet(listOption);
+	BenchmarkRunner runner(filter, parser.value(samplesOption).toInt(),
+				parser.value(minTimeOption).toLongLong(),
+				parser.value(iterationsOption).toLongLong());
+	BenchmarkRunner lister(QRegularExpression("(?!)"), 1, 0, 1);
+	for (BenchmarkSuite * suite : BenchmarkSuite::suites())
+	{
+		suite->run(list ? lister : runner);
+	}
+	if (list)
+	{
+		for (const QString & name : lister.names())
+		{
+			if (filter.match(name).hasMatch())
+			{
+				printf("%s\n", name.toUtf8().constData());
+			}
+		}
+		Engine::destroy();
+		return EXIT_SUCCESS;
+	}
+
+	const QJsonObject report{
+		{ "version", LMMS_VERSION },
+		{ "kernels", kernelsName(MixHelpers::kernels()) },
+		{ "sampleRate", static_cast<qint64>(Engine::audioEngine()->processingSampleRate()) },
+		{ "framesPerPeriod", Engine::audioEngine()->framesPerPeriod() },
+		{ "threads", QThread::idealThreadCount() },
+		{ "benchmarks", runner.results() } };
+	const QByteArray json = QJsonDocument(report).toJson();
+
+	Engine::destroy();
+
+	if (parser.isSet(outputOption))
+	{
+		QFile file(parser.value(outputOption));
+		if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size())
+		{
+			fprintf(stderr, "Could not write %s\n", file.fileName().toUtf8().constData());
+			return EXIT_FAILURE;
+		}
+	}
+	else
+	{
+		fputs(json.constData(), stdout);
+	}
+	return EXIT_SUCCESS;
+}
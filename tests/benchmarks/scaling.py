@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+#
+# scaling.py - measures how rendering scales with the size of a project and
+#              the number of threads
+#
+# Copyright (c) 2026 LMMS Developers
+#
+# This file is part of LMMS - https://lmms.io
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public
+# License as published by the Free Software Foundation; either
+# version 2 of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# General Public License for more details.
+#
+# You should have received a copy of the GNU General Public
+# License along with this program (see COPYING); if not, write to the
+# Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+# Boston, MA 02110-1301 USA.
+#
+
+"""Generates synthetic projects with "lmms generate", renders each of them
+with "lmms bench" on every given number of threads and writes the realtime
+factors and the shares of the engine's stages to results.json and
+results.csv. If matplotlib is installed, the results are plotted, too.
+
+Every project option takes a comma separated list, and all combinations
+are measured, e.g.
+
+    scaling.py --lmms build/lmms --tracks 8,32,128 --threads 1,2,4,8
+"""
+
+import argparse
+import csv
+import itertools
+import json
+import os
+import statistics
+import subprocess
+import sys
+
+# the options of "lmms generate"
+PROJECT_OPTIONS = ["tracks", "bars", "notes", "polyphony", "effects",
+                   "mixer-depth", "mixer-fanin", "automation"]
+STAGES = ["playHandles", "graph", "masterMix", "modelChanges"]
+
+
+def numbers(text):
+    return [int(n) for n in text.split(",") if n]
+
+
+def run(command):
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                            universal_newlines=True)
+    if result.returncode != 0:
+        sys.exit("{} failed:\n{}".format(" ".join(command), result.stderr))
+    return result.stdout
+
+
+def measure(args):
+    sizes = [dict(zip(PROJECT_OPTIONS, values)) for values in
+             itertools.product(*(getattr(args, o.replace("-", "_")) for o in PROJECT_OPTIONS))]
+    results = []
+    for size in sizes:
+        name = "-".join("{}{}".format(o, size[o]) for o in PROJECT_OPTIONS)
+        project = os.path.join(args.output, name + ".mmp")
+        command = [args.lmms, "generate", project]
+        for option in PROJECT_OPTIONS:
+            command += ["--" + option, str(size[option])]
+        command += ["--instrument", args.instrument, "--effect", args.effect]
+        run(command)
+
+        for threads in args.threads:
+            print("{}, {} threads".format(name, threads), file=sys.stderr)
+            out = run([args.lmms, "bench", project, "--threads", str(threads),
+                       "--runs", str(args.runs), "--period", str(args.period)])
+            # notices before the report go to standard out, too
+            report = json.loads(out[out.index("{"):])
+            runs = report["runs"]
+            results.append({
+                "project": size,
+                "threads": report.get("threads", threads),
+                "realtimeFactor": statistics.median(r["realtimeFactor"] for r in runs),
+                "periodUsP99": statistics.median(r["periodUs"]["p99"] for r in runs),
+                "stageShares": {s: statistics.median(r["stages"][s]["share"] for r in runs)
+                                for s in STAGES},
+            })
+    return results
+
+
+def write(results, output):
+    with open(os.path.join(output, "results.json"), "w") as f:
+        json.dump(results, f, indent=2)
+    with open(os.path.join(output, "results.csv"), "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(PROJECT_OPTIONS + ["threads", "realtimeFactor", "periodUsP99"] + STAGES)
+        for r in results:
+            writer.writerow([r["project"][o] for o in PROJECT_OPTIONS] +
+                            [r["threads"], r["realtimeFactor"], r["periodUsP99"]] +
+                            [r["stageShares"][s] for s in STAGES])
+
+
+def plot(results, output):
+    try:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+    except ImportError:
+        print("matplotlib isn't installed, not plotting", file=sys.stderr)
+        return
+
+    # a project's size is told by the options which differ between them
+    varying = [o for o in PROJECT_OPTIONS if len({r["project"][o] for r in results}) > 1]
+
+    def label(project):
+        return ", ".join("{} {}".format(o, project[o]) for o in varying) or "project"
+
+    def series(key, x):
+        lines = {}
+        for r in results:
+            lines.setdefault(key(r), []).append((x(r), r["realtimeFactor"]))
+        return lines
+
+    figure, (byThreads, bySize) = plt.subplots(1, 2, figsize=(12, 5))
+    for name, points in series(lambda r: label(r["project"]), lambda r: r["threads"]).items():
+        byThreads.plot(*zip(*sorted(points)), marker="o", label=name)
+    byThreads.set_xlabel("threads")
+    byThreads.set_ylabel("realtime factor")
+    byThreads.legend(fontsize="small")
+
+    # along the first option that changes, for every number of threads
+    if varying:
+        for threads, points in series(lambda r: r["threads"],
+                                      lambda r: r["project"][varying[0]]).items():
+            bySize.plot(*zip(*sorted(points)), marker="o", label="{} threads".format(threads))
+        bySize.set_xlabel(varying[0])
+        bySize.set_ylabel("realtime factor")
+        bySize.legend(fontsize="small")
+    figure.tight_layout()
+    figure.savefig(os.path.join(output, "realtime-factor.png"))
+
+    # where the time goes, for every measurement
+    figure, stages = plt.subplots(figsize=(max(6, len(results) * 0.5), 5))
+    names = ["{}\n{} threads".format(label(r["project"]), r["threads"]) for r in results]
+    bottom = [0.0] * len(results)
+    for s in STAGES:
+        shares = [r["stageShares"][s] for r in results]
+        stages.bar(range(len(results)), shares, bottom=bottom, label=s)
+        bottom = [b + v for b, v in zip(bottom, shares)]
+    stages.set_xticks(range(len(results)))
+    stages.set_xticklabels(names, rotation=90, fontsize="x-small")
+    stages.set_ylabel("share of the render time")
+    stages.legend(fontsize="small")
+    figure.tight_layout()
+    figure.savefig(os.path.join(output, "stages.png"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--lmms", default="lmms", help="the LMMS executable")
+    parser.add_argument("--output", default="scaling", help="directory for projects and results")
+    parser.add_argument("--threads", type=numbers, default=[1, 2, 4],
+                        help="numbers of threads to render on")
+    parser.add_argument("--runs", type=int, default=3, help="renders per measurement")
+    parser.add_argument("--period", type=int, default=256, help="frames per period")
+    defaults = {"tracks": "8,32", "bars": "8", "notes": "8", "polyphony": "1", "effects": "0",
+                "mixer-depth": "0", "mixer-fanin": "2", "automation": "0"}
+    for option in PROJECT_OPTIONS:
+        parser.add_argument("--" + option, type=numbers, default=numbers(defaults[option]),
+                            help="values for \"lmms generate --{}\"".format(option))
+    parser.add_argument("--instrument", default="tripleoscillator")
+    parser.add_argument("--effect", default="amplifier")
+    args = parser.parse_args()
+
+    os.makedirs(args.output, exist_ok=True)
+    results = measure(args)
+    write(results, args.output)
+    plot(results, args.output)
+
+
+if __name__ == "__main__":
+    main()
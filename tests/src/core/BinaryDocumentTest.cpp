@@ -0,0 +1,102 @@
+/*
+ * BinaryDocumentTest.cpp
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include "BinaryDocument.h"
+
+//! Attributes are compared by name, their order isn't part of the DOM
+static bool sameNode(const QDomNode & a, const QDomNode & b)
+{
+	if (a.nodeType() != b.nodeType() || a.nodeName() != b.nodeName() ||
+		a.nodeValue() != b.nodeValue() || a.attributes().count() != b.attributes().count())
+	{
+		return false;
+	}
+	for (int i = 0; i < a.attributes().count(); ++i)
+	{
+		const QDomAttr attribute = a.attributes().item(i).toAttr();
+		if (b.toElement().attribute(attribute.name(), "?") != attribute.value())
+		{
+			return false;
+		}
+	}
+	QDomNode childA = a.firstChild();
+	QDomNode childB = b.firstChild();
+	for (; !childA.isNull() && !childB.isNull(); childA = childA.nextSibling(), childB = childB.nextSibling())
+	{
+		if (!sameNode(childA, childB))
+		{
+			return false;
+		}
+	}
+	return childA.isNull() && childB.isNull();
+}
+
+class BinaryDocumentTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void RoundTripsTheDom()
+	{
+		const QString xml =
+			"<?xml version=\"1.0\"?>\n"
+			"<!DOCTYPE lmms-project>\n"
+			"<lmms-project version=\"27\" type=\"song\" creatorversion=\"1.3.0\">\n"
+			"<head bpm=\"140\" masterpitch=\"-0\"/>\n"
+			"<song>\n"
+			"<pattern pos=\"0\" name=\"a &amp; b\">\n"
+			"<note pos=\"0\" len=\"48\" key=\"57\" vol=\"100\" pan=\"0.5\"/>\n"
+			"<note pos=\"48\" len=\"48\" key=\"2147483647\" vol=\"100\" pan=\"0\"/>\n"
+			"<note pos=\"96\" len=\"48\" key=\"60\" vol=\"100\" pan=\"-0.25\"/>\n"
+			"<note pos=\"144\" len=\"-192\" key=\"62\" vol=\"1e-07\" pan=\"0.333333333\"/>\n"
+			"<note pos=\"192\" len=\"48\" key=\"64\" vol=\"100\"><automationclip/></note>\n"
+			"</pattern>\n"
+			"<projectnotes><![CDATA[<b>notes</b>]]></projectnotes>\n"
+			"<!-- a comment -->\n"
+			"</song>\n"
+			"</lmms-project>\n";
+
+		QDomDocument original;
+		QVERIFY(original.setContent(xml));
+
+		QDomDocument decoded;
+		QVERIFY(BinaryDocument::decode(BinaryDocument::encode(original), decoded));
+		QVERIFY(sameNode(decoded, original));
+		QCOMPARE(decoded.doctype().name(), QString("lmms-project"));
+	}
+
+	void RejectsBrokenData()
+	{
+		QDomDocument original;
+		QVERIFY(original.setContent(QString("<a><b c=\"1\"/><b c=\"2\"/></a>")));
+		const QByteArray data = BinaryDocument::encode(original);
+
+		QDomDocument decoded;
+		QVERIFY(!BinaryDocument::decode(data.left(data.size() - 3), decoded));
+		QVERIFY(!BinaryDocument::decode(QByteArray(), decoded));
+	}
+} BinaryDocumentTests;
+
+#include "BinaryDocumentTest.moc"
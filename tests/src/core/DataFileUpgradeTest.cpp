@@ -0,0 +1,96 @@
+/*
+ * DataFileUpgradeTest.cpp
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "QTestSuite.h"
+
+#include "DataFile.h"
+
+//! A project of LMMS 0.4.0 before 20080607, which goes through all of the
+//! upgrades since then
+static QByteArray legacyProject(int tracks)
+{
+	QByteArray xml =
+		"<?xml version=\"1.0\"?>\n"
+		"<!DOCTYPE multimediaproject>\n"
+		"<multimediaproject type=\"song\" creatorversion=\"0.4.0-20080601\">\n"
+		"<head bpm=\"140\"/>\n"
+		"<song>\n"
+		"<trackcontainer type=\"song\">\n";
+	for (int i = 0; i < tracks; ++i)
+	{
+		xml += "<track type=\"0\" name=\"Track\">\n"
+			"<instrumenttrack vol=\"100\" basenote=\"57\">\n"
+			"<instrument name=\"tripleoscillator\"><tripleoscillator/></instrument>\n"
+			"<midi inputcontroller=\"0\"/>\n"
+			"<automation-pattern/>\n"
+			"</instrumenttrack>\n"
+			"<pattern pos=\"0\" len=\"192\" name=\"Track\">\n";
+		for (int note = 0; note < 16; ++note)
+		{
+			xml += "<note pos=\"" + QByteArray::number(note * 12) + "\" len=\"12\" key=\"57\" vol=\"100\"/>\n";
+		}
+		xml += "</pattern>\n"
+			"</track>\n";
+	}
+	xml += "</trackcontainer>\n"
+		"</song>\n"
+		"</multimediaproject>\n";
+	return xml;
+}
+
+class DataFileUpgradeTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void UpgradesLegacyProjects()
+	{
+		DataFile dataFile(legacyProject(3));
+		QCOMPARE(dataFile.elementsByTagName("midi").count(), 0);
+		QCOMPARE(dataFile.elementsByTagName("midiport").count(), 3);
+		QCOMPARE(dataFile.elementsByTagName("automation-pattern").count(), 0);
+		QCOMPARE(dataFile.elementsByTagName("automationpattern").count(), 3);
+
+		const QDomNodeList notes = dataFile.elementsByTagName("note");
+		QCOMPARE(notes.count(), 3 * 16);
+		for (int i = 0; i < notes.count(); ++i)
+		{
+			QCOMPARE(notes.item(i).toElement().attribute("key"), QString("69"));
+		}
+		QCOMPARE(dataFile.elementsByTagName("pattern").item(0).toElement().attribute("name"), QString());
+		QCOMPARE(dataFile.elementsByTagName("tripleoscillator").item(0).toElement()
+			.attribute("useWaveTable1"), QString("0"));
+	}
+
+	void UpgradeBenchmark()
+	{
+		const QByteArray xml = legacyProject(2000);
+		QBENCHMARK
+		{
+			DataFile dataFile(xml);
+		}
+	}
+} DataFileUpgradeTests;
+
+#include "DataFileUpgradeTest.moc"
@@ -0,0 +1,334 @@
+/*
+ * MixHelpersTest.cpp - compares the vectorised mix kernels to the generic ones
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "QTestSuite.h"
+
+#include <cmath>
+#include <vector>
+
+#include "MixHelpers.h"
+#include "ValueBuffer.h"
+
+class MixHelpersTest : QTestSuite
+{
+	Q_OBJECT
+private:
+	using Buffer = std::vector<sampleFrame>;
+
+	//! Runs every helper on a copy of @p dst and collects the results
+	static std::vector<Buffer> mixAll(const Buffer & dst, const Buffer & src, int frames)
+	{
+		std::vector<Buffer> results;
+		ValueBuffer coeffs1(frames + 1), coeffs2(frames + 1), volumes(frames + 1), pannings(frames + 1);
+		std::vector<sample_t> left(frames + 1), right(frames + 1);
+		for (int f = 0; f <= frames; ++f)
+		{
+			coeffs1[f] = 0.01f * f;
+			coeffs2[f] = 1.0f / (f + 1);
+			volumes[f] = 200.0f / (f + 1);
+			pannings[f] = 100.0f * std::sin(f * 0.3f);
+			left[f] = src[f][0] * 0.3f;
+			right[f] = src[f][1] * 1.7f;
+		}
+
+		auto mix = [&](auto op)
+		{
+			Buffer out = dst;
+			op(out.data());
+			results.push_back(out);
+		};
+		mix([&](sampleFrame * d) { MixHelpers::add(d, src.data(), frames); });
+		mix([&](sampleFrame * d) { MixHelpers::addMultiplied(d, src.data(), 0.7f, frames); });
+		mix([&](sampleFrame * d) { MixHelpers::addSwappedMultiplied(d, src.data(), 0.7f, frames); });
+		mix([&](sampleFrame * d) { MixHelpers::addMultipliedByBuffer(d, src.data(), 0.7f, &coeffs1, frames); });
+		mix([&](sampleFrame * d) { MixHelpers::addMultipliedByBuffers(d, src.data(), &coeffs1, &coeffs2, frames); });
+		mix([&](sampleFrame * d) { MixHelpers::addSanitizedMultiplied(d, src.data(), 0.7f, frames); });
+		mix([&](sampleFrame * d)
+		{
+			MixHelpers::addSanitizedMultipliedByBuffer(d, src.data(), 0.7f, &coeffs1, frames);
+		});
+		mix([&](sampleFrame * d)
+		{
+			MixHelpers::addSanitizedMultipliedByBuffers(d, src.data(), &coeffs1, &coeffs2, frames);
+		});
+		mix([&](sampleFrame * d) { MixHelpers::addMultipliedStereo(d, src.data(), 0.7f, -1.3f, frames); });
+		mix([&](sampleFrame * d) { MixHelpers::multiplyAndAddMultiplied(d, src.data(), 0.5f, 0.7f, frames); });
+		mix([&](sampleFrame * d)
+		{
+			MixHelpers::multiplyAndAddMultipliedJoined(d, left.data(), right.data(), 0.5f, 0.7f, frames);
+		});
+		mix([&](sampleFrame * d) { d[frames] = MixHelpers::peak(src.data(), frames); });
+		mix([&](sampleFrame * d)
+		{
+			d[frames] = MixHelpers::addSanitizedMultipliedWithPeak(d, src.data(), 0.7f, nullptr, nullptr, frames);
+		});
+		mix([&](sampleFrame * d)
+		{
+			d[frames] = MixHelpers::addSanitizedMultipliedWithPeak(d, src.data(), 0.7f, nullptr, &coeffs2, frames);
+		});
+		mix([&](sampleFrame * d)
+		{
+			d[frames] = MixHelpers::addSanitizedMultipliedWithPeak(d, src.data(), 1.0f, &coeffs1, &coeffs2, frames);
+		});
+		mix([&](sampleFrame * d)
+		{
+			d[frames] = MixHelpers::addMultipliedWithPeak(d, src.data(), 1.0f, &coeffs1, &coeffs2, frames);
+		});
+		using MixHelpers::PanLaw;
+		for (PanLaw law : {PanLaw::Linear, PanLaw::ConstantPower, PanLaw::ConstantPowerUnityCenter})
+		{
+			mix([&](sampleFrame * d) { MixHelpers::applyVolumeAndPanning(d, 80.0f, nullptr, -30.0f, nullptr, law, frames); });
+			mix([&](sampleFrame * d) { MixHelpers::applyVolumeAndPanning(d, 80.0f, &volumes, 60.0f, nullptr, law, frames); });
+			mix([&](sampleFrame * d) { MixHelpers::applyVolumeAndPanning(d, 80.0f, nullptr, 0.0f, &pannings, law, frames); });
+			mix([&](sampleFrame * d)
+			{
+				MixHelpers::applyVolumeAndPanning(d, 80.0f, &volumes, 0.0f, &pannings, law, frames);
+			});
+		}
+		const float table[] = {0.0f, 0.3f, 0.4f, 0.2f, -0.5f, 0.9f, 1.0f, 0.7f, 0.8f};
+		mix([&](sampleFrame * d)
+		{
+			MixHelpers::shape(d, src.data(), table, 8, 1.5f, nullptr, 0.7f, nullptr, false, frames);
+		});
+		mix([&](sampleFrame * d)
+		{
+			MixHelpers::shape(d, src.data(), table, 8, 1.5f, &volumes, 0.7f, &coeffs2, false, frames);
+		});
+		mix([&](sampleFrame * d) { MixHelpers::shape(d, d, table, 8, 3.0f, nullptr, 0.7f, nullptr, true, frames); });
+		mix([&](sampleFrame * d) { MixHelpers::shape(d, d, table, 8, 3.0f, &volumes, 0.7f, nullptr, true, frames); });
+		mix([&](sampleFrame * d) { MixHelpers::shape(d, d, table, 8, 3.0f, nullptr, 0.7f, &coeffs1, true, frames); });
+		mix([&](sampleFrame * d) { MixHelpers::quantize(d, nullptr, 1.3f, 0.0f, 0.0f, frames); });
+		mix([&](sampleFrame * d) { MixHelpers::quantize(d, nullptr, 1.3f, 0.0f, 15.0f, frames); });
+		mix([&](sampleFrame * d) { MixHelpers::quantize(d, src.data(), 1.3f, 0.2f, 0.0f, frames); });
+		mix([&](sampleFrame * d) { MixHelpers::quantize(d, src.data(), 1.3f, 0.2f, 15.0f, frames); });
+		mix([&](sampleFrame * d)
+		{
+			for (int f = 0; f < frames; ++f) { d[f][0] *= 1000.0f; }
+			d[frames][0] = MixHelpers::sanitize(d, frames);
+		});
+		mix([&](sampleFrame * d)
+		{
+			if (frames > 0) { d[frames - 1][1] = NAN; }
+			d[frames][0] = MixHelpers::sanitize(d, frames);
+		});
+		return results;
+	}
+
+	static Buffer makeBuffer(int frames, float scale)
+	{
+		Buffer buffer(frames + 1);
+		for (int f = 0; f <= frames; ++f)
+		{
+			buffer[f] = {std::sin(f * scale), std::cos(f * scale * 1.3f)};
+		}
+		return buffer;
+	}
+
+private slots:
+	void VectorKernelsMatchGeneric()
+	{
+		using MixHelpers::Kernels;
+		const Kernels initial = MixHelpers::kernels();
+		const bool nanHandler = MixHelpers::useNaNHandler();
+		MixHelpers::setNaNHandler(true);
+
+		// odd sizes leave frames behind the last full vector, the extra
+		// frame at the end must stay untouched
+		for (int frames : {0, 1, 7, 37, 256})
+		{
+			const Buffer dst = makeBuffer(frames, 0.1f);
+			Buffer src = makeBuffer(frames, 0.37f);
+			if (frames > 4)
+			{
+				src[2][1] = NAN;
+				src[frames - 1][0] = INFINITY;
+			}
+
+			QVERIFY(MixHelpers::setKernels(Kernels::Generic));
+			const std::vector<Buffer> expected = mixAll(dst, src, frames);
+			const float energy = MixHelpers::energy(dst.data(), frames);
+			const float signedEnergy = MixHelpers::signedEnergy(dst.data(), frames);
+			Buffer silent(frames + 1, sampleFrame{1e-8f, -1e-8f});
+			silent[frames] = {1.0f, 1.0f};
+			QVERIFY(MixHelpers::isSilent(silent.data(), frames));
+
+			for (Kernels k : {Kernels::SSE2, Kernels::AVX, Kernels::AVX512, Kernels::NEON})
+			{
+				if (!MixHelpers::setKernels(k)) { continue; }
+
+				const std::vector<Buffer> results = mixAll(dst, src, frames);
+				for (size_t i = 0; i < results.size(); ++i)
+				{
+					for (int f = 0; f <= frames; ++f)
+					{
+						for (int c = 0; c < 2; ++c)
+						{
+							// equal unless the compiler fused multiplies and adds
+							const float e = expected[i][f][c];
+							const float r = results[i][f][c];
+							const bool equal = e == r || (std::isnan(e) && std::isnan(r))
+								|| std::fabs(e - r) <= 1e-6f * (std::fabs(e) + 1.0f);
+							QVERIFY2(equal, qPrintable(QString("kernels %1, helper %2, frame %3")
+								.arg(int(k)).arg(i).arg(f)));
+						}
+					}
+				}
+
+				// the sums are rounded differently
+				QVERIFY(std::fabs(MixHelpers::energy(dst.data(), frames) - energy) <= 1e-5f * energy);
+				QVERIFY(std::fabs(MixHelpers::signedEnergy(dst.data(), frames) - signedEnergy) <= 1e-5f * energy);
+
+				QVERIFY(MixHelpers::isSilent(silent.data(), frames));
+				silent[frames / 2][1] = 1e-6f;
+				QCOMPARE(MixHelpers::isSilent(silent.data(), frames), frames == 0);
+				silent[frames / 2][1] = -1e-8f;
+			}
+		}
+
+		MixHelpers::setKernels(initial);
+		MixHelpers::setNaNHandler(nanHandler);
+	}
+
+	void ConversionsMatchGeneric()
+	{
+		using MixHelpers::Kernels;
+		const Kernels initial = MixHelpers::kernels();
+
+		// the samples land around +-2, so that some get clipped
+		const int frames = 37;
+		const Buffer src = makeBuffer(frames, 0.37f);
+		std::vector<float> dither(2 * frames);
+		for (int i = 0; i < 2 * frames; ++i) { dither[i] = std::sin(i * 2.1f); }
+
+		auto convertAll = [&]
+		{
+			std::vector<std::vector<int32_t>> results;
+			for (const float * d : {static_cast<const float *>(nullptr), dither.data()})
+			{
+				for (bool swapBytes : {false, true})
+				{
+					std::vector<int_sample_t> s16(2 * frames);
+					MixHelpers::convertToS16(s16.data(), src.data(), 2.0f, d, swapBytes, frames);
+					results.emplace_back(s16.begin(), s16.end());
+				}
+				std::vector<int32_t> s24(2 * frames);
+				MixHelpers::convertToS24(s24.data(), src.data(), 2.0f, d, frames);
+				results.push_back(s24);
+			}
+			Buffer copy(frames);
+			MixHelpers::copyMultiplied(copy.data(), src.data(), 0.7f, frames);
+			for (const sampleFrame & f : copy)
+			{
+				results.push_back({static_cast<int32_t>(f[0] * 1e6f), static_cast<int32_t>(f[1] * 1e6f)});
+			}
+			return results;
+		};
+
+		QVERIFY(MixHelpers::setKernels(Kernels::Generic));
+		const auto expected = convertAll();
+		// the first frame is {0, 2}, which gets clipped
+		QCOMPARE(int(expected[0][0]), 0);
+		QCOMPARE(int(expected[0][1]), 32767);
+		QCOMPARE(int(expected[1][1]), int(int_sample_t(0xff7f)));
+		QCOMPARE(expected[2][1], int32_t(MixHelpers::S24Scale));
+		for (int i = 0; i < 2 * frames; ++i)
+		{
+			QVERIFY(expected[0][i] >= -32767 && expected[0][i] <= 32767);
+		}
+
+		for (Kernels k : {Kernels::SSE2, Kernels::AVX, Kernels::AVX512, Kernels::NEON})
+		{
+			if (!MixHelpers::setKernels(k)) { continue; }
+			QVERIFY2(convertAll() == expected, qPrintable(QString("kernels %1").arg(int(k))));
+		}
+
+		MixHelpers::setKernels(initial);
+	}
+
+	void PanLaws()
+	{
+		using MixHelpers::PanLaw;
+		auto gains = [](float panning, PanLaw law)
+		{
+			Buffer buffer(1, sampleFrame{1.0f, 1.0f});
+			MixHelpers::applyVolumeAndPanning(buffer.data(), 50.0f, nullptr, panning, nullptr, law, 1);
+			return buffer[0];
+		};
+
+		// the linear law only attenuates the opposite side
+		QCOMPARE(gains(0.0f, PanLaw::Linear)[0], 0.5f);
+		QCOMPARE(gains(0.0f, PanLaw::Linear)[1], 0.5f);
+		QCOMPARE(gains(-40.0f, PanLaw::Linear)[0], 0.5f);
+		QCOMPARE(gains(-40.0f, PanLaw::Linear)[1], 0.3f);
+		QCOMPARE(gains(100.0f, PanLaw::Linear)[0], 0.0f);
+
+		for (float panning : {-100.0f, -35.0f, 0.0f, 20.0f, 100.0f})
+		{
+			const sampleFrame g = gains(panning, PanLaw::ConstantPower);
+			QVERIFY(std::fabs(g[0] * g[0] + g[1] * g[1] - 0.25f) < 1e-6f);
+			const sampleFrame u = gains(panning, PanLaw::ConstantPowerUnityCenter);
+			QVERIFY(std::fabs(u[0] * u[0] + u[1] * u[1] - 0.5f) < 1e-6f);
+		}
+		QCOMPARE(gains(0.0f, PanLaw::ConstantPowerUnityCenter)[0], 0.5f);
+	}
+
+	void RampsInSubBlocks()
+	{
+		const int frames = 37;
+		const Buffer src = makeBuffer(frames, 0.1f);
+
+		// constant ramps are a single block with the constant values
+		Buffer ramped = src;
+		Buffer constant = src;
+		MixHelpers::applyVolumeAndPanning(ramped.data(), ValueRamp{80.0f, 80.0f}, ValueRamp{-30.0f, -30.0f},
+			MixHelpers::PanLaw::Linear, 8, frames);
+		MixHelpers::applyVolumeAndPanning(constant.data(), 80.0f, nullptr, -30.0f, nullptr,
+			MixHelpers::PanLaw::Linear, frames);
+		QVERIFY(ramped == constant);
+
+		// every sub-block has the value of its middle, the last one is shorter
+		const ValueRamp volume{0.0f, 100.0f};
+		ramped = src;
+		MixHelpers::applyVolumeAndPanning(ramped.data(), volume, ValueRamp{0.0f, 0.0f},
+			MixHelpers::PanLaw::Linear, 8, frames);
+		for (int f = 0; f < frames; ++f)
+		{
+			const int offset = f / 8 * 8;
+			const float middle = offset + qMin(8, frames - offset) * 0.5f;
+			const float gain = volume.valueAt(middle, frames) * 0.01f;
+			QCOMPARE(ramped[f][0], src[f][0] * gain);
+			QCOMPARE(ramped[f][1], src[f][1] * gain);
+		}
+		QVERIFY(ramped[frames] == src[frames]);
+
+		// the peak covers all sub-blocks
+		Buffer mixed(frames + 1, sampleFrame{0.0f, 0.0f});
+		const sampleFrame peak = MixHelpers::addMultipliedWithPeak(mixed.data(), src.data(),
+			ValueRamp{1.0f, 0.2f}, ValueRamp{0.5f, 0.5f}, 8, frames);
+		QVERIFY(peak == MixHelpers::peak(mixed.data(), frames));
+	}
+} MixHelpersTests;
+
+#include "MixHelpersTest.moc"
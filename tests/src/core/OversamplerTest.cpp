@@ -0,0 +1,76 @@
+/*
+ * OversamplerTest.cpp
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include <cmath>
+#include <vector>
+
+#include "Oversampler.h"
+
+class OversamplerTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void RoundTripDelaysByLatency()
+	{
+		// a single stage delays by a whole number of frames
+		Oversampler oversampler(1, 128);
+		QCOMPARE(oversampler.factor(), 2);
+		QCOMPARE(oversampler.latency(), f_cnt_t(31));
+
+		const int frames = 64;
+		const int blocks = 16;
+		std::vector<sampleFrame> in(frames * blocks);
+		std::vector<sampleFrame> out(frames * blocks);
+		for (size_t i = 0; i < in.size(); ++i)
+		{
+			in[i][0] = std::sin(0.1f * i);
+			in[i][1] = 0.5f * std::cos(0.1f * i);
+		}
+
+		for (int b = 0; b < blocks; ++b)
+		{
+			const sampleFrame * up = oversampler.upsample(in.data() + b * frames, frames);
+			QVERIFY(up != nullptr);
+			oversampler.downsample(out.data() + b * frames, frames);
+		}
+
+		const f_cnt_t latency = oversampler.latency();
+		for (size_t i = 2 * latency; i < out.size(); ++i)
+		{
+			QVERIFY(std::fabs(out[i][0] - in[i - latency][0]) < 1e-4f);
+			QVERIFY(std::fabs(out[i][1] - in[i - latency][1]) < 1e-4f);
+		}
+	}
+
+	void Latency()
+	{
+		QCOMPARE(Oversampler::latency(0), f_cnt_t(0));
+		QVERIFY(Oversampler::latency(2) > Oversampler::latency(1));
+		QVERIFY(Oversampler::latency(3) > Oversampler::latency(2));
+	}
+} OversamplerTests;
+
+#include "OversamplerTest.moc"
@@ -0,0 +1,87 @@
+/*
+ * VoicePoolTest.cpp
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include "VoicePool.h"
+
+namespace
+{
+
+struct Voice
+{
+	Voice(int value, int& alive) : value(value), alive(alive) { ++alive; }
+	~Voice() { --alive; }
+	int value;
+	int& alive;
+};
+
+}
+
+class VoicePoolTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void ReusesStorage()
+	{
+		int alive = 0;
+		VoicePool<Voice> pool(1);
+
+		Voice* first = pool.acquire(1, alive);
+		QCOMPARE(first->value, 1);
+		QCOMPARE(alive, 1);
+		pool.release(first);
+		QCOMPARE(alive, 0);
+
+		Voice* second = pool.acquire(2, alive);
+		QCOMPARE(second, first);
+		QCOMPARE(second->value, 2);
+		pool.release(second);
+		pool.release(nullptr);
+		QCOMPARE(alive, 0);
+	}
+
+	void KeepsStorageUpToCapacity()
+	{
+		int alive = 0;
+		VoicePool<Voice> pool(1, 2);
+
+		// more voices than prepared
+		Voice* voices[3];
+		for (int i = 0; i < 3; ++i) { voices[i] = pool.acquire(i, alive); }
+		QCOMPARE(alive, 3);
+		for (Voice* voice : voices) { pool.release(voice); }
+		QCOMPARE(alive, 0);
+
+		Voice* a = pool.acquire(0, alive);
+		Voice* b = pool.acquire(1, alive);
+		QVERIFY(a != b);
+		QVERIFY(a == voices[0] || a == voices[1]);
+		QVERIFY(b == voices[0] || b == voices[1]);
+		pool.release(a);
+		pool.release(b);
+	}
+} VoicePoolTests;
+
+#include "VoicePoolTest.moc"
@@ -0,0 +1,87 @@
+/*
+ * WorkStealingDequeTest.cpp
+ *
+ * Copyright (c) 2026 LMMS Developers
+ *
+ * This file is part of LMMS - https://lmms.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "QTestSuite.h"
+
+#include "WorkStealingDeque.h"
+
+class WorkStealingDequeTest : QTestSuite
+{
+	Q_OBJECT
+private slots:
+	void OwnerIsLifoThiefIsFifo()
+	{
+		WorkStealingDeque<int, 4> deque;
+		int items[3] = {0, 1, 2};
+
+		QVERIFY(deque.empty());
+		QVERIFY(deque.pop() == nullptr);
+		QVERIFY(deque.steal() == nullptr);
+
+		for (int & i : items) { deque.push(&i); }
+		QCOMPARE(deque.pop(), &items[2]);
+		QCOMPARE(deque.steal(), &items[0]);
+		QCOMPARE(deque.pop(), &items[1]);
+		QVERIFY(deque.empty());
+	}
+
+	void GrowsWhenFull()
+	{
+		WorkStealingDeque<int, 2> deque;
+		int items[5] = {0, 1, 2, 3, 4};
+
+		deque.push(&items[0]);
+		deque.push(&items[1]);
+		QCOMPARE(deque.steal(), &items[0]);
+		QCOMPARE(deque.growths(), 0);
+
+		// wraps around the initial array before it has to grow
+		deque.push(&items[2]);
+		deque.push(&items[3]);
+		deque.push(&items[4]);
+		QCOMPARE(deque.growths(), 1);
+		QCOMPARE(deque.capacity(), size_t(4));
+
+		QCOMPARE(deque.steal(), &items[1]);
+		QCOMPARE(deque.pop(), &items[4]);
+		QCOMPARE(deque.steal(), &items[2]);
+		QCOMPARE(deque.pop(), &items[3]);
+		QVERIFY(deque.empty());
+	}
+
+	void ReserveAvoidsGrowing()
+	{
+		WorkStealingDeque<int, 2> deque;
+		int items[5] = {0, 1, 2, 3, 4};
+
+		deque.reserve(5);
+		QCOMPARE(deque.capacity(), size_t(8));
+		for (int & i : items) { deque.push(&i); }
+		QCOMPARE(deque.growths(), 0);
+		for (int & i : items) { QCOMPARE(deque.steal(), &i); }
+		QVERIFY(deque.empty());
+	}
+} WorkStealingDequeTests;
+
+#include "WorkStealingDequeTest.moc"